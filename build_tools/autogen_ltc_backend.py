@@ -1,4 +1,5 @@
 import argparse
+import dataclasses
 import hashlib
 import importlib.util
 import logging
@@ -9,6 +10,7 @@ import warnings
 from collections import defaultdict
 from dataclasses import dataclass
 from pathlib import Path
+from typing import ClassVar, Set
 from shutil import which
 from textwrap import dedent, indent
 
@@ -99,6 +101,24 @@ class GenMlirLazyIr(torchgen.dest.GenLazyIR):
         )
 
 
+def without_meta_kernel(func):
+    """Returns `func` as if it had no structured kernel, so that the codegen
+    declares and calls a `compute_shape_*` function for it."""
+    return dataclasses.replace(func, structured=False, structured_delegate=None)
+
+
+@dataclass(frozen=True)
+class GenMlirLazyNativeFuncDefinition(torchgen.dest.GenLazyNativeFuncDefinition):
+    # The structured ops whose shapes are computed by the functions in
+    # `shape_inference.cpp` instead of by their meta kernel.
+    ops_with_native_shape_inference: ClassVar[Set[str]] = set()
+
+    def shape_inference(self, func, schema: LazyIrSchema) -> str:
+        if str(func.func.name) in self.ops_with_native_shape_inference:
+            func = without_meta_kernel(func)
+        return super().shape_inference(func, schema)
+
+
 class GenTorchMlirLTC:
     def __init__(self, binary_dir):
         self.script_path = Path(__file__).resolve()
@@ -267,6 +287,11 @@ class GenTorchMlirLTC:
         # List of ops that will take in symints for its size
         symint = set(config.get("symint", []))
 
+        # List of structured ops whose shapes are computed natively
+        GenMlirLazyNativeFuncDefinition.ops_with_native_shape_inference = set(
+            config.get("native_shape_inference", [])
+        )
+
         self.ops = sorted(ops)
 
         with self.source_yaml.open("w") as f:
@@ -359,6 +384,8 @@ class GenTorchMlirLTC:
         shape_inference_decls = []
         for op in self.ops:
             f = self.native_functions[op]
+            if op in GenMlirLazyNativeFuncDefinition.ops_with_native_shape_inference:
+                f = without_meta_kernel(f)
             shape_sig = shape_gen(f)
             shape_inference_decls.extend(shape_sig)
 
@@ -470,6 +497,7 @@ class GenTorchMlirLTC:
             tensor_class_hdr="torch/csrc/lazy/core/tensor.h",
             shape_inference_hdr=str(self.generated_path.joinpath("shape_inference.h")),
             lazy_ir_generator=GenMlirLazyIr,
+            native_func_definition_generator=GenMlirLazyNativeFuncDefinition,
         )
 
     def __call__(self):
@@ -0,0 +1,175 @@
+"""Benchmarks the step time of training loops on the reference LTC backend.
+
+Each step traces the forward and backward passes and the optimizer update,
+calls `torch._lazy.mark_step`, and reads the loss back, which waits for any
+asynchronous execution. The wall time of those three parts is broken down
+with the `TorchMlir*` timers of the lazy backend, which are also listed by
+`torch._lazy.metrics.metrics_report()`, so that the overhead around the
+execution itself can be followed as caching and async execution change.
+
+Example:
+    python build_tools/benchmark_ltc_step_time.py --model transformer \\
+        --steps 50 --async-execution
+"""
+import argparse
+import time
+
+import torch
+import torch._lazy
+import torch._lazy.metrics
+import torch_mlir._mlir_libs._REFERENCE_LAZY_BACKEND as lazy_backend
+
+# The timers of the lazy backend, in the order of a step.
+_TIMERS = [
+    ("TorchMlirBuild", "build"),
+    ("TorchMlirImport", "  import"),
+    ("TorchMlirVerify", "  verify"),
+    ("TorchMlirCompile", "compile"),
+    ("TorchMlirCompileWait", "compile wait"),
+    ("TorchMlirExecute", "execute"),
+    ("TorchMlirPendingDataWait", "pending data wait"),
+]
+_COUNTERS = [
+    "TorchMlirComputationCacheHit",
+    "TorchMlirComputationCacheMiss",
+    "TorchMlirPartitionedComputations",
+    "TorchMlirJitFallbacks",
+]
+
+
+class _Mlp(torch.nn.Module):
+
+    def __init__(self, features: int):
+        super().__init__()
+        self.layers = torch.nn.Sequential(
+            torch.nn.Linear(features, 4 * features),
+            torch.nn.ReLU(),
+            torch.nn.Linear(4 * features, 4 * features),
+            torch.nn.ReLU(),
+            torch.nn.Linear(4 * features, features),
+        )
+
+    def forward(self, x):
+        return self.layers(x)
+
+
+class _Transformer(torch.nn.Module):
+
+    def __init__(self, features: int):
+        super().__init__()
+        # Dropout would add randomness that LTC traces as separate ops.
+        self.encoder = torch.nn.TransformerEncoder(
+            torch.nn.TransformerEncoderLayer(
+                features, nhead=4, dim_feedforward=2 * features, dropout=0.0,
+                batch_first=True),
+            num_layers=2)
+        self.head = torch.nn.Linear(features, features)
+
+    def forward(self, x):
+        return self.head(self.encoder(x))
+
+
+def _make_model_and_inputs(model: str, batch_size: int, features: int):
+    if model == "mlp":
+        return _Mlp(features), torch.rand(batch_size, features)
+    return _Transformer(features), torch.rand(batch_size, 16, features)
+
+
+def _get_timer_totals():
+    totals = lazy_backend.get_metric_totals()
+    # The timers accumulate nanoseconds.
+    return {name: totals.get(name, (0, 0.0))[1] * 1e-9 for name, _ in _TIMERS}
+
+
+def _get_counter_totals():
+    names = set(torch._lazy.metrics.counter_names())
+    return {name: torch._lazy.metrics.counter_value(name) if name in names else 0
+            for name in _COUNTERS}
+
+
+def _subtract(after, before):
+    return {name: after[name] - before[name] for name in after}
+
+
+def _run_step(model, optimizer, inputs, targets):
+    """Runs a training step and returns the wall time of its parts, and how
+    much each timer and counter of the backend advanced during it."""
+    timers, counters = _get_timer_totals(), _get_counter_totals()
+    start = time.perf_counter()
+    optimizer.zero_grad()
+    loss = torch.nn.functional.mse_loss(model(inputs), targets)
+    loss.backward()
+    optimizer.step()
+    traced = time.perf_counter()
+    torch._lazy.mark_step()
+    marked = time.perf_counter()
+    loss.item()
+    synced = time.perf_counter()
+    times = {
+        "trace": traced - start,
+        "mark_step": marked - traced,
+        "sync": synced - marked,
+        "total": synced - start,
+    }
+    return (times, _subtract(_get_timer_totals(), timers),
+            _subtract(_get_counter_totals(), counters))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--model", choices=["mlp", "transformer"],
+                        default="mlp")
+    parser.add_argument("--steps", type=int, default=20,
+                        help="The number of timed steps.")
+    parser.add_argument("--warmup-steps", type=int, default=3,
+                        help="The number of steps run before the timed ones, "
+                        "which compile the computations of the loop.")
+    parser.add_argument("--batch-size", type=int, default=32)
+    parser.add_argument("--features", type=int, default=64)
+    parser.add_argument("--async-execution", action="store_true",
+                        help="Compile and execute on the LTC thread pool.")
+    args = parser.parse_args()
+
+    lazy_backend._initialize()
+    lazy_backend.set_async_execution(args.async_execution)
+    torch.manual_seed(0)
+    model, inputs = _make_model_and_inputs(args.model, args.batch_size,
+                                           args.features)
+    model = model.to("lazy")
+    inputs = inputs.to("lazy")
+    targets = torch.rand_like(inputs)
+    optimizer = torch.optim.SGD(model.parameters(), lr=0.01)
+
+    print(f"Warming up with {args.warmup_steps} steps")
+    for _ in range(args.warmup_steps):
+        _run_step(model, optimizer, inputs, targets)
+
+    times, timers, counters = {}, {}, {}
+    for _ in range(args.steps):
+        step_times, step_timers, step_counters = _run_step(
+            model, optimizer, inputs, targets)
+        for totals, step in ((times, step_times), (timers, step_timers),
+                             (counters, step_counters)):
+            for name, value in step.items():
+                totals[name] = totals.get(name, 0) + value
+
+    def per_step_ms(seconds):
+        return 1000 * seconds / args.steps
+
+    print(f"Mean over {args.steps} steps of {args.model}:")
+    for name in ("total", "trace", "mark_step", "sync"):
+        print(f"  {name:<20} {per_step_ms(times[name]):10.3f} ms")
+    print("Backend timers:")
+    for metric, label in _TIMERS:
+        print(f"  {label:<20} {per_step_ms(timers[metric]):10.3f} ms")
+    # With async execution, the execution overlaps the Python side of the step,
+    # so this is a lower bound.
+    overhead = times["total"] - timers["TorchMlirExecute"]
+    print(f"  {'overhead':<20} {per_step_ms(overhead):10.3f} ms")
+    print("Backend counters per step:")
+    for name in _COUNTERS:
+        print(f"  {name:<36} {counters[name] / args.steps:8.2f}")
+
+
+if __name__ == "__main__":
+    main()
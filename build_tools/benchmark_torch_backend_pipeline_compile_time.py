@@ -0,0 +1,199 @@
+"""Benchmarks how the compile time of the Torch backend pipeline scales with the model size.
+
+This script builds synthetic deep models (a stack of transformer layers, or of
+ResNet basic blocks) at several depths, imports each of them, and runs
+`torchscript-module-to-torch-backend-pipeline` on it with `torch-mlir-opt
+-mlir-timing`. For every pass, it reports the time at each depth, and the
+exponent of the power law that best fits the time as a function of the number
+of ops. Passes with an exponent well above 1 scale super-linearly, and are the
+ones that make large models slow to compile.
+
+Example:
+    python build_tools/benchmark_torch_backend_pipeline_compile_time.py \
+        --torch-mlir-opt build/bin/torch-mlir-opt --model transformer \
+        --depths 4,8,16,32 --json compile_time.json
+"""
+import argparse
+import json
+import math
+import os
+import re
+import subprocess
+import tempfile
+from typing import Dict, List, Tuple
+
+import torch
+import torch_mlir
+
+
+class _TransformerLayer(torch.nn.Module):
+    def __init__(self, hidden: int, heads: int):
+        super().__init__()
+        self.heads = heads
+        self.norm1 = torch.nn.LayerNorm(hidden)
+        self.qkv = torch.nn.Linear(hidden, 3 * hidden)
+        self.proj = torch.nn.Linear(hidden, hidden)
+        self.norm2 = torch.nn.LayerNorm(hidden)
+        self.fc1 = torch.nn.Linear(hidden, 4 * hidden)
+        self.fc2 = torch.nn.Linear(4 * hidden, hidden)
+
+    def forward(self, x):
+        batch, seq, hidden = x.shape
+        q, k, v = self.qkv(self.norm1(x)).chunk(3, dim=-1)
+        q = q.reshape(batch, seq, self.heads, -1).transpose(1, 2)
+        k = k.reshape(batch, seq, self.heads, -1).transpose(1, 2)
+        v = v.reshape(batch, seq, self.heads, -1).transpose(1, 2)
+        scores = torch.matmul(q, k.transpose(-2, -1)) / math.sqrt(q.shape[-1])
+        attention = torch.matmul(torch.softmax(scores, dim=-1), v)
+        attention = attention.transpose(1, 2).reshape(batch, seq, hidden)
+        x = x + self.proj(attention)
+        return x + self.fc2(torch.nn.functional.gelu(self.fc1(self.norm2(x))))
+
+
+class _BasicBlock(torch.nn.Module):
+    def __init__(self, channels: int):
+        super().__init__()
+        self.conv1 = torch.nn.Conv2d(channels, channels, 3, padding=1,
+                                     bias=False)
+        self.bn1 = torch.nn.BatchNorm2d(channels)
+        self.conv2 = torch.nn.Conv2d(channels, channels, 3, padding=1,
+                                     bias=False)
+        self.bn2 = torch.nn.BatchNorm2d(channels)
+
+    def forward(self, x):
+        y = torch.relu(self.bn1(self.conv1(x)))
+        return torch.relu(x + self.bn2(self.conv2(y)))
+
+
+def _build_model(model: str, depth: int) -> Tuple[torch.nn.Module,
+                                                  torch.Tensor]:
+    if model == "transformer":
+        layers = [_TransformerLayer(hidden=64, heads=4) for _ in range(depth)]
+        example = torch.rand(2, 16, 64)
+    else:
+        layers = [_BasicBlock(channels=16) for _ in range(depth)]
+        example = torch.rand(1, 16, 32, 32)
+    return torch.nn.Sequential(*layers).eval(), example
+
+
+def _count_ops(operation) -> int:
+    count = 1
+    for region in operation.regions:
+        for block in region.blocks:
+            for op in block.operations:
+                count += _count_ops(op.operation)
+    return count
+
+
+# Matches the lines of the `-mlir-timing-display=list` report, e.g.
+# `    0.0040 ( 29.7%)  Canonicalizer`. The wall time is the last time column.
+_TIMING_LINE = re.compile(r"^\s*(?:[\d.]+\s+\(\s*[\d.]+%\)\s+)*"
+                          r"([\d.]+)\s+\(\s*[\d.]+%\)\s+(\S.*)$")
+
+
+def _time_passes(torch_mlir_opt: str, input_file: str,
+                 pipeline: str) -> Dict[str, float]:
+    process = subprocess.run(
+        [torch_mlir_opt, input_file, f"--pass-pipeline={pipeline}",
+         "--mlir-timing", "--mlir-timing-display=list",
+         "--mlir-disable-threading", "-o", os.devnull],
+        check=True, stderr=subprocess.PIPE, text=True)
+    times = {}
+    for line in process.stderr.splitlines():
+        match = _TIMING_LINE.match(line)
+        if match:
+            times[match.group(2).strip()] = float(match.group(1))
+    return times
+
+
+def _fit_exponent(num_ops: List[int], times: List[float]) -> float:
+    """Least-squares slope of log(time) against log(#ops)."""
+    points = [(math.log(n), math.log(t)) for n, t in zip(num_ops, times)
+              if t > 0]
+    if len(points) < 2:
+        return float("nan")
+    mean_x = sum(x for x, _ in points) / len(points)
+    mean_y = sum(y for _, y in points) / len(points)
+    variance = sum((x - mean_x)**2 for x, _ in points)
+    if variance == 0:
+        return float("nan")
+    return sum((x - mean_x) * (y - mean_y) for x, y in points) / variance
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--torch-mlir-opt", default="torch-mlir-opt",
+                        help="Path to the torch-mlir-opt binary.")
+    parser.add_argument("--model", choices=["transformer", "resnet"],
+                        default="transformer",
+                        help="The kind of layer that the model stacks.")
+    parser.add_argument("--depths", default="2,4,8,16",
+                        help="Comma-separated numbers of layers to stack.")
+    parser.add_argument("--backend-legal-ops", default="",
+                        help="Comma-separated ops to keep undecomposed, "
+                        "as for `torch_mlir.compile`.")
+    parser.add_argument("--min-time", type=float, default=0.01,
+                        help="Passes that never take longer than this many "
+                        "seconds are not reported.")
+    parser.add_argument("--json", default=None,
+                        help="Also write the results to this file as JSON.")
+    args = parser.parse_args()
+
+    depths = [int(depth) for depth in args.depths.split(",")]
+    pipeline = ("builtin.module(torchscript-module-to-torch-backend-pipeline{"
+                f"backend-legal-ops={args.backend_legal_ops}}})")
+    num_ops = []
+    pass_times: Dict[str, List[float]] = {}
+    for index, depth in enumerate(depths):
+        model, example = _build_model(args.model, depth)
+        module = torch_mlir.compile(model, example, output_type="raw")
+        num_ops.append(_count_ops(module.operation))
+        with tempfile.NamedTemporaryFile("wb", suffix=".mlirbc",
+                                         delete=False) as f:
+            module.operation.write_bytecode(f)
+            input_file = f.name
+        try:
+            times = _time_passes(args.torch_mlir_opt, input_file, pipeline)
+        finally:
+            os.remove(input_file)
+        for name, time in times.items():
+            # A pass that only shows up at some depths took no measurable time
+            # at the others.
+            pass_times.setdefault(name, [0.0] * len(depths))[index] = time
+        print(f"depth {depth}: {num_ops[-1]} ops, "
+              f"{times.get('Total', float('nan')):.3f}s")
+
+    results = []
+    for name, times in pass_times.items():
+        if max(times) < args.min_time and name != "Total":
+            continue
+        results.append({
+            "pass": name,
+            "times": times,
+            "exponent": _fit_exponent(num_ops, times),
+        })
+    results.sort(key=lambda result: -max(result["times"]))
+
+    print()
+    print(f"{'exponent':>8}  " +
+          "".join(f"{n:>10}" for n in num_ops) + "  pass (seconds per #ops)")
+    for result in results:
+        print(f"{result['exponent']:>8.2f}  " +
+              "".join(f"{t:>10.3f}" for t in result["times"]) +
+              f"  {result['pass']}")
+    super_linear = [r["pass"] for r in results if r["exponent"] > 1.2]
+    if super_linear:
+        print("\nsuper-linear passes: " + ", ".join(super_linear))
+
+    if args.json is not None:
+        with open(args.json, "w") as f:
+            json.dump({
+                "model": args.model,
+                "depths": depths,
+                "num_ops": num_ops,
+                "passes": results,
+            }, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
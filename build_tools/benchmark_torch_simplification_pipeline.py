@@ -0,0 +1,94 @@
+"""Benchmarks the Torch simplification pipeline on a synthetic many-function module.
+
+Most of `torch-simplification-pipeline` runs nested on `func.func` ops, so its
+wall time should scale down with the number of threads as long as the module
+has many functions. This script generates such a module and times
+`torch-mlir-opt` on it with and without MLIR multithreading.
+
+Example:
+    python build_tools/benchmark_torch_simplification_pipeline.py \
+        --torch-mlir-opt build/bin/torch-mlir-opt --num-functions 256
+"""
+import argparse
+import os
+import subprocess
+import tempfile
+import time
+
+# Each function is a chain of ops whose result shapes and dtypes are unknown,
+# so the whole refinement machinery has to run on every one of them.
+_FUNCTION_TEMPLATE = """\
+func.func @forward{index}(%arg0: !torch.vtensor<[{dim0},{dim1}],f32>) -> !torch.vtensor {{
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[{dim0},{dim1}],f32> -> !torch.vtensor
+{body}  return %{last} : !torch.vtensor
+}}
+"""
+
+
+def _generate_module(num_functions: int, ops_per_function: int) -> str:
+    functions = []
+    for index in range(num_functions):
+        body = []
+        for i in range(1, ops_per_function):
+            # Alternate between a few ops with different shape functions.
+            if i % 3 == 0:
+                body.append(f"  %{i} = torch.aten.add.Tensor %{i - 1}, %{i - 1}, %int1 : "
+                            f"!torch.vtensor, !torch.vtensor, !torch.int -> !torch.vtensor\n")
+            elif i % 3 == 1:
+                body.append(f"  %{i} = torch.aten.relu %{i - 1} : "
+                            f"!torch.vtensor -> !torch.vtensor\n")
+            else:
+                body.append(f"  %{i} = torch.aten.mul.Tensor %{i - 1}, %{i - 1} : "
+                            f"!torch.vtensor, !torch.vtensor -> !torch.vtensor\n")
+        # Vary the shapes so that functions don't all look identical.
+        functions.append(_FUNCTION_TEMPLATE.format(
+            index=index, dim0=2 + index % 7, dim1=3 + index % 5,
+            body="".join(body), last=ops_per_function - 1))
+    return "\n".join(functions)
+
+
+def _time_pipeline(torch_mlir_opt: str, input_file: str, extra_args, repetitions: int) -> float:
+    best = float("inf")
+    for _ in range(repetitions):
+        start = time.perf_counter()
+        subprocess.run(
+            [torch_mlir_opt, "-torch-simplification-pipeline", input_file,
+             "-o", os.devnull] + extra_args,
+            check=True)
+        best = min(best, time.perf_counter() - start)
+    return best
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--torch-mlir-opt", default="torch-mlir-opt",
+                        help="Path to the torch-mlir-opt binary.")
+    parser.add_argument("--num-functions", type=int, default=128,
+                        help="Number of functions in the generated module.")
+    parser.add_argument("--ops-per-function", type=int, default=32,
+                        help="Number of ops in each generated function.")
+    parser.add_argument("--repetitions", type=int, default=3,
+                        help="Number of timed runs; the best one is reported.")
+    args = parser.parse_args()
+
+    with tempfile.NamedTemporaryFile("w", suffix=".mlir", delete=False) as f:
+        f.write(_generate_module(args.num_functions, args.ops_per_function))
+        input_file = f.name
+    try:
+        serial = _time_pipeline(args.torch_mlir_opt, input_file,
+                                ["--mlir-disable-threading"], args.repetitions)
+        parallel = _time_pipeline(args.torch_mlir_opt, input_file, [],
+                                  args.repetitions)
+    finally:
+        os.remove(input_file)
+
+    print(f"functions: {args.num_functions}, ops per function: {args.ops_per_function}, "
+          f"cores: {os.cpu_count()}")
+    print(f"single-threaded: {serial:.3f}s")
+    print(f"multi-threaded:  {parallel:.3f}s")
+    print(f"speedup:         {serial / parallel:.2f}x")
+
+
+if __name__ == "__main__":
+    main()
@@ -7,6 +7,8 @@
 #     which register custom PyTorch operators upon being imported.
 #   TORCH_MLIR_EXT_PYTHONPATH: colon-separated list of paths necessary
 #     for importing PyTorch extensions specified in TORCH_MLIR_EXT_MODULES.
+#   TORCH_MLIR_ABSTRACT_INTERP_LIB_BYTECODE: if set to 1, embed the library
+#     as MLIR bytecode instead of textual MLIR.
 # For more information on supporting custom operators, see:
 #   ${TORCH_MLIR}/python/torch_mlir/_torch_mlir_custom_op_example/README.md
 
@@ -41,7 +43,13 @@ if [ ! -z ${TORCH_MLIR_EXT_MODULES} ]; then
   ext_module="${TORCH_MLIR_EXT_MODULES} "
 fi
 
+emit_bytecode_flag=""
+if [[ "${TORCH_MLIR_ABSTRACT_INTERP_LIB_BYTECODE:-0}" == "1" ]]; then
+  emit_bytecode_flag="--emit_bytecode"
+fi
+
 PYTHONPATH="${pypath}" python \
   -m torch_mlir.dialects.torch.importer.jit_ir.build_tools.abstract_interp_lib_gen \
   --pytorch_op_extensions=${ext_module:-""} \
-  --torch_transforms_cpp_dir="${torch_transforms_cpp_dir}"
+  --torch_transforms_cpp_dir="${torch_transforms_cpp_dir}" \
+  ${emit_bytecode_flag}
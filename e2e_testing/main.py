@@ -4,11 +4,14 @@
 # Also available under a BSD-style license. See LICENSE.
 
 import argparse
+import os
 import re
 import sys
 
-from torch_mlir_e2e_test.framework import run_tests
+from torch_mlir.compile_cache import CACHE_DIR_ENV_VAR
+from torch_mlir_e2e_test.framework import run_tests, shard_tests
 from torch_mlir_e2e_test.reporting import report_results
+from torch_mlir_e2e_test.benchmarking import report_benchmarks, run_benchmarks
 from torch_mlir_e2e_test.registry import GLOBAL_TEST_REGISTRY
 
 
@@ -23,6 +26,7 @@ from torch_mlir_e2e_test.configs import (
     TorchDynamoTestConfig,
 )
 
+from torch_mlir_e2e_test.linalg_on_tensors_backends.gpubackend import GpuLinalgOnTensorsBackend
 from torch_mlir_e2e_test.linalg_on_tensors_backends.refbackend import RefBackendLinalgOnTensorsBackend
 from torch_mlir_e2e_test.stablehlo_backends.linalg_on_tensors import LinalgOnTensorsStablehloBackend
 from torch_mlir_e2e_test.tosa_backends.linalg_on_tensors import LinalgOnTensorsTosaBackend
@@ -41,7 +45,7 @@ from torch_mlir_e2e_test.test_suite import register_all_tests
 register_all_tests()
 
 def _get_argparse():
-    config_choices = ["native_torch", "torchscript", "linalg", "stablehlo", "tosa", "lazy_tensor_core", "torchdynamo"]
+    config_choices = ["native_torch", "torchscript", "linalg", "linalg_optimized", "linalg_gpu", "stablehlo", "tosa", "lazy_tensor_core", "torchdynamo"]
     parser = argparse.ArgumentParser(description="Run torchscript e2e tests.")
     parser.add_argument("-c", "--config",
         choices=config_choices,
@@ -49,6 +53,8 @@ def _get_argparse():
         help=f"""
 Meaning of options:
 "linalg": run through torch-mlir"s default Linalg-on-Tensors backend.
+"linalg_optimized": like "linalg", but with the RefBackend tiling and vectorizing linalg ops.
+"linalg_gpu": like "linalg", but running the linalg ops as GPU kernels (see `--gpu_target`).
 "stablehlo": run through torch-mlir"s default StableHLO backend.
 "tosa": run through torch-mlir"s default TOSA backend.
 "native_torch": run the torch.nn.Module as-is without compiling (useful for verifying model is deterministic; ALL tests should pass in this configuration).
@@ -56,6 +62,14 @@ Meaning of options:
 "lazy_tensor_core": run the model through the Lazy Tensor Core frontend and execute the traced graph.
 "torchdynamo": run the model through the TorchDynamo frontend and execute the graph using Linalg-on-Tensors.
 """)
+    parser.add_argument("--gpu_target",
+                        choices=["cuda", "rocm"],
+                        default="cuda",
+                        help="The GPU runtime that the linalg_gpu config runs the kernels with.")
+    parser.add_argument("--gpu_chip",
+                        default=None,
+                        help="""The GPU architecture that the linalg_gpu config
+compiles the kernels for, e.g. sm_80 or gfx90a.""")
     parser.add_argument("-f", "--filter", default=".*", help="""
 Regular expression specifying which tests to include in this run.
 """)
@@ -69,6 +83,45 @@ Regular expression specifying which tests to include in this run.
                         help="""Run tests sequentially rather than in parallel.
 This can be useful for debugging, since it runs the tests in the same process,
 which make it easier to attach a debugger or get a stack trace.""")
+    parser.add_argument("-j", "--num_processes",
+                        type=int,
+                        default=None,
+                        help="""The number of processes to run the tests in.
+Defaults to one per core.""")
+    parser.add_argument("--num_shards",
+                        type=int,
+                        default=1,
+                        help="""Split the selected tests into this many shards,
+and only run one of them (see `--shard_index`). Tests are assigned to shards by
+a hash of their name, so the shards are the same on every machine.""")
+    parser.add_argument("--shard_index",
+                        type=int,
+                        default=0,
+                        help="The shard to run, from 0 to `--num_shards` - 1.")
+    parser.add_argument("--cache_dir",
+                        default=None,
+                        help=f"""A directory in which to cache the compiled
+modules across runs, as with the `{CACHE_DIR_ENV_VAR}` environment variable.
+The Torch backend IR is shared by the configs that lower it with the same
+backend legal ops, so running another such config over the same tests skips
+the frontend pipeline.""")
+    parser.add_argument("--benchmark",
+                        default=False,
+                        action="store_true",
+                        help="""Instead of checking the results of the tests,
+time compiling them and running them, with the selected config and in PyTorch
+eager mode, and report the times as JSON. The tests are run one at a time.""")
+    parser.add_argument("--benchmark_warmup",
+                        type=int,
+                        default=3,
+                        help="The number of untimed runs of each test before the timed ones.")
+    parser.add_argument("--benchmark_repetitions",
+                        type=int,
+                        default=10,
+                        help="The number of timed runs of each test.")
+    parser.add_argument("--benchmark_output",
+                        default=None,
+                        help="The file to write the benchmark report to. Defaults to stdout.")
     parser.add_argument("--crashing_tests_to_not_attempt_to_run_and_a_bug_is_filed",
                         metavar="TEST", type=str, nargs="+",
                         help="A set of tests to not attempt to run, since they crash and cannot be XFAILed.")
@@ -76,6 +129,9 @@ which make it easier to attach a debugger or get a stack trace.""")
 
 def main():
     args = _get_argparse().parse_args()
+    if args.cache_dir is not None:
+        # Set through the environment, so that the test processes use it too.
+        os.environ[CACHE_DIR_ENV_VAR] = args.cache_dir
 
     all_test_unique_names = set(
         test.unique_name for test in GLOBAL_TEST_REGISTRY)
@@ -85,6 +141,16 @@ def main():
         config = LinalgOnTensorsBackendTestConfig(RefBackendLinalgOnTensorsBackend())
         xfail_set = LINALG_XFAIL_SET
         crashing_set = set()
+    elif args.config == "linalg_optimized":
+        config = LinalgOnTensorsBackendTestConfig(
+            RefBackendLinalgOnTensorsBackend(optimize=True))
+        xfail_set = LINALG_XFAIL_SET
+        crashing_set = set()
+    elif args.config == "linalg_gpu":
+        config = LinalgOnTensorsBackendTestConfig(
+            GpuLinalgOnTensorsBackend(args.gpu_target, args.gpu_chip))
+        xfail_set = LINALG_XFAIL_SET
+        crashing_set = set()
     elif args.config == "tosa":
         config = TosaBackendTestConfig(LinalgOnTensorsTosaBackend())
         xfail_set = all_test_unique_names - TOSA_PASS_SET
@@ -132,8 +198,23 @@ def main():
             print(test.unique_name)
         sys.exit(1)
 
+    tests = shard_tests(tests, args.num_shards, args.shard_index)
+
+    if args.benchmark:
+        results = run_benchmarks(tests, config, args.benchmark_warmup,
+                                 args.benchmark_repetitions, args.verbose)
+        if args.benchmark_output is None:
+            report_benchmarks(results, args.config, args.benchmark_warmup,
+                              args.benchmark_repetitions, sys.stdout)
+        else:
+            with open(args.benchmark_output, "w") as f:
+                report_benchmarks(results, args.config, args.benchmark_warmup,
+                                  args.benchmark_repetitions, f)
+        sys.exit(0)
+
     # Run the tests.
-    results = run_tests(tests, config, args.sequential, args.verbose)
+    results = run_tests(tests, config, args.sequential, args.verbose,
+                        num_processes=args.num_processes)
 
     # Report the test results.
     failed = report_results(results, xfail_set, args.verbose)
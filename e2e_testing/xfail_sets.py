@@ -50,6 +50,9 @@ TORCHDYNAMO_XFAIL_SET = {
     # %6:4 = torch.operator "aten._embedding_bag_forward_only"(%1, %3, %5, %false, %int0, %false, %none, %false, %int-1) : (!torch.tensor<*,f32>, !torch.tensor<*,si64>, !torch.tensor<*,si64>, !torch.bool, !torch.int, !torch.bool, !torch.none, !torch.bool, !torch.int) -> (!torch.tensor, !torch.tensor, !torch.tensor, !torch.tensor)
     # See also: https://github.com/pytorch/torchdynamo/issues/327
     "AtenEmbeddingBagSumExample_basic",
+    "AtenEmbeddingBagMeanExample_basic",
+    "AtenEmbeddingBagMaxExample_basic",
+    "AtenEmbeddingBagPerSampleWeightsExample_basic",
     # %1 = torch.operator "aten.scalar_tensor"(%float8.000000e00, %int6, %int0, %cpu, %none) : (!torch.float, !torch.int, !torch.int, !torch.Device, !torch.none) -> !torch.tensor
     "ElementwiseWhereScalarModule_basic",
     "ElementwiseWhereScalarOtherModule_basic",
@@ -117,6 +120,7 @@ TORCHDYNAMO_XFAIL_SET = {
     'EqIntModule_basic',
     'GeIntModule_basic',
     'GtIntModule_basic',
+    'KVCacheDecodeModule_basic',
     'MulIntModule_basic',
     'NeIntModule_basic',
     'SqrtIntModule_basic',
@@ -138,6 +142,8 @@ TORCHDYNAMO_XFAIL_SET = {
     'AtenIntBoolOpModule_basic',
     'OneHotModule_basic',
     'QuantizedMLP_basic',
+    'QuantizedLinearModule_basic',
+    'QuantizedLinearPerChannelModule_basic',
     'ScalarImplicitFloatModule_basic',
     'ScalarImplicitIntModule_basic',
     # END tests failing due to: torch._dynamo.exc.Unsupported: data dependent operator: aten._local_scalar_dense.default
@@ -148,6 +154,15 @@ TORCHDYNAMO_XFAIL_SET = {
     'BincountStaticSizeModule_basic',
     # END tests failing due to: torch._dynamo.exc.Unsupported: dynamic shape operator: aten.bincount.default
 
+    # START tests failing due to: torch._dynamo.exc.Unsupported: dynamic shape operator: aten.nonzero.default
+    'NonzeroFloatStaticSizeModule_basic',
+    'NonzeroModule_basic',
+    # END tests failing due to: torch._dynamo.exc.Unsupported: dynamic shape operator: aten.nonzero.default
+
+    # START tests failing due to: torch._dynamo.exc.Unsupported: dynamic shape operator: aten.masked_select.default
+    'MaskedSelectModule_basic',
+    # END tests failing due to: torch._dynamo.exc.Unsupported: dynamic shape operator: aten.masked_select.default
+
     # ERROR: torch._dynamo.exc.Unsupported: torch.* op returned non-Tensor bool call_function aten.Bool
     'BoolFloatConstantModule_basic',
     'BoolIntConstantModule_basic',
@@ -214,6 +229,8 @@ TORCHDYNAMO_XFAIL_SET = {
     "BatchNorm2DModule_basic",
     "BatchNorm3DModule_basic",
     "BatchNorm1DStaticShapeModule_basic",
+    "Conv2dBatchNormModule_basic",
+    "LinearBatchNorm1DModule_basic",
     "ElementwiseAddScalarFloatModule_basic",
     "ElementwiseAddScalarInt64Module_basic",
     "ElementwiseAddScalarIntModule_basic",
@@ -222,7 +239,6 @@ TORCHDYNAMO_XFAIL_SET = {
     "NativeBatchNorm2DModule_basic",
     "NativeBatchNorm3DModule_basic",
     "NativeBatchNormNoneWeightModule_basic",
-    "NativeGroupNormModule_basic",
     "ResNet18Module_basic",
     "ResNet18StaticModule_basic",
     # END tests failing due to: 'torch.aten.add.Tensor' op operand #1 must be Any Torch tensor type, but got '!torch.float'
@@ -1073,6 +1089,7 @@ LTC_XFAIL_SET = {
     "_ConvolutionDeprecated2DBenchmarkModule_basic",
     "_ConvolutionDeprecated2DCudnnModule_basic",
     "_ConvolutionDeprecated2DDeterministicModule_basic",
+    "AdaptiveAvgPool2dNonDivisibleOutputSizeModule_basic",
     "AdaptiveAvgPool2dNonUnitOutputSizeDynamicModule_basic",
     "AdaptiveAvgPool2dNonUnitOutputSizeStaticModule_basic",
     "AddIntModule_basic",
@@ -1126,6 +1143,7 @@ LTC_XFAIL_SET = {
     "IndexPutImpl1DIntAccumulateModule_basic",
     "IndexPutImpl1DIntNonAccumulateModule_basic",
     "IndexPutImpl2DFloatAccumulateModule_basic",
+    "IndexPutImpl2DFloatAccumulateRepeatedModule_basic",
     "IndexPutImpl2DFloatNonAccumulateModule_basic",
     "IndexPutImpl2DIndexModule_basic",
     "IndexPutImpl3DFloatAccumulateModule_basic",
@@ -1149,12 +1167,17 @@ LTC_XFAIL_SET = {
     "IndexTensorHackedTwinModule3dInput_basic",
     "IndexTensorHackedTwinMultiInputNonContiguousMultipleStaticDims_basic",
     "LiftFreshCopyModule_basic",
+    "MaskedSelectModule_basic",
     "Matmul_dot",
     "MulIntModule_basic",
     "DivIntModule_basic",
     "NeFloatIntModule_basic",
     "NeIntModule_basic",
+    "NonzeroFloatStaticSizeModule_basic",
+    "NonzeroModule_basic",
     "QuantizedMLP_basic",
+    "QuantizedLinearModule_basic",
+    "QuantizedLinearPerChannelModule_basic",
     "RandLikeDtypeModule_basic",
     "RandLikeModule_basic",
     "RollModule_basic",
@@ -1183,6 +1206,9 @@ LTC_XFAIL_SET = {
     "UnsafeViewCollapseDynamicWithAtenSizeIntModule_basic",
     "ViewCollapseDynamicWithAtenSizeIntModule_basic",
     "AtenEmbeddingBagSumExample_basic",
+    "AtenEmbeddingBagMeanExample_basic",
+    "AtenEmbeddingBagMaxExample_basic",
+    "AtenEmbeddingBagPerSampleWeightsExample_basic",
     "Aten_EmbeddingBagExample_basic",
     "ElementwiseRemainderScalarModule_Int_Float_basic",
     "ElementwiseRemainderScalarModule_Float_basic",
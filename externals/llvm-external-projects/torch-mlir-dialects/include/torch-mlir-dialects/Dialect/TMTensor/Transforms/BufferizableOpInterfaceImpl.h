@@ -0,0 +1,27 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TORCH_MLIR_DIALECTS_DIALECT_TMTENSOR_TRANSFORMS_BUFFERIZABLEOPINTERFACEIMPL_H_
+#define TORCH_MLIR_DIALECTS_DIALECT_TMTENSOR_TRANSFORMS_BUFFERIZABLEOPINTERFACEIMPL_H_
+
+namespace mlir {
+class DialectRegistry;
+
+namespace torch {
+namespace TMTensor {
+
+// Registers the `BufferizableOpInterface` models of the TMTensor ops, which
+// let one-shot bufferization write their outputs in place.
+void registerBufferizableOpInterfaceExternalModels(DialectRegistry &registry);
+
+} // namespace TMTensor
+} // namespace torch
+} // namespace mlir
+
+#endif // TORCH_MLIR_DIALECTS_DIALECT_TMTENSOR_TRANSFORMS_BUFFERIZABLEOPINTERFACEIMPL_H_
@@ -19,6 +19,7 @@ namespace TMTensor {
 
 std::unique_ptr<OperationPass<func::FuncOp>> createTMTensorToLoopsPass();
 std::unique_ptr<OperationPass<func::FuncOp>> createTMTensorBufferizePass();
+std::unique_ptr<OperationPass<func::FuncOp>> createTMTensorTilePass();
 
 void registerPasses();
 
@@ -16,6 +16,7 @@
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include "mlir/Dialect/Utils/StructuredOpsUtils.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
@@ -35,6 +36,8 @@
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/SMLoc.h"
 
+#include <limits>
+
 using namespace mlir;
 using namespace mlir::torch;
 using namespace mlir::torch::TMTensor;
@@ -84,20 +87,74 @@ OpFoldResult TMTensor::getDim(OpBuilder &builder, Location loc, Value v,
   return builder.getI64IntegerAttr(t.getDimSize(dim));
 }
 
+// Returns the slice of `source` at `offsets` with `sizes` and `strides`, as a
+// tensor or a memref like `source`.
+static Value getSlice(OpBuilder &b, Location loc, Value source,
+                      ArrayRef<OpFoldResult> offsets,
+                      ArrayRef<OpFoldResult> sizes,
+                      ArrayRef<OpFoldResult> strides) {
+  return TypeSwitch<Type, Value>(source.getType())
+      .Case<RankedTensorType>([&](RankedTensorType t) -> Value {
+        return b.create<tensor::ExtractSliceOp>(loc, source, offsets, sizes,
+                                                strides);
+      })
+      .Case<MemRefType>([&](MemRefType t) -> Value {
+        return b.create<memref::SubViewOp>(loc, source, offsets, sizes,
+                                           strides);
+      })
+      .Default([&](Type t) { return nullptr; });
+}
+
 //===----------------------------------------------------------------------===//
 // AttentionOp
 //===----------------------------------------------------------------------===//
 
 LogicalResult AttentionOp::verify() {
   Operation *op = getOperation();
+  if (getNumInputs() != 3 && getNumInputs() != 4)
+    return op->emitOpError("expected 3 or 4 input operands");
   ShapedType queryType = getQueryType();
   ShapedType keyType = getKeyType();
+  ShapedType valueType = getValueType();
+  int64_t rank = queryType.getRank();
+  if (rank < 2 || keyType.getRank() != rank || valueType.getRank() != rank)
+    return op->emitOpError(
+        "expected query, key and value of the same rank, at least 2");
   ArrayRef<int64_t> queryShape = queryType.getShape();
   ArrayRef<int64_t> keyShape = keyType.getShape();
-  if (keyShape[0] != queryShape[0])
-    return op->emitOpError("query and key batch mismatch");
-  if (keyShape[2] != queryShape[2])
+  ArrayRef<int64_t> valueShape = valueType.getShape();
+  auto isMismatch = [](int64_t a, int64_t b) {
+    return !ShapedType::isDynamic(a) && !ShapedType::isDynamic(b) && a != b;
+  };
+  for (int64_t dim = 0; dim < rank - 2; ++dim) {
+    if (isMismatch(queryShape[dim], keyShape[dim]) ||
+        isMismatch(queryShape[dim], valueShape[dim]))
+      return op->emitOpError("query, key and value batch mismatch");
+  }
+  if (isMismatch(queryShape[rank - 1], keyShape[rank - 1]))
     return op->emitOpError("query and key head dimension mismatch");
+  if (isMismatch(keyShape[rank - 2], valueShape[rank - 2]))
+    return op->emitOpError("key and value sequence length mismatch");
+  if (Value mask = getMask()) {
+    auto maskType = mask.getType().cast<ShapedType>();
+    int64_t maskRank = maskType.getRank();
+    if (maskRank < 2 || maskRank > rank)
+      return op->emitOpError(
+          "expected a mask of rank at least 2 and at most the query rank");
+    Type maskElementType = maskType.getElementType();
+    if (!maskElementType.isInteger(1) &&
+        maskElementType != queryType.getElementType())
+      return op->emitOpError(
+          "expected a mask of i1 or of the element type of the query");
+    // The mask broadcasts to the scores, of shape BxNxM.
+    SmallVector<int64_t> scoresShape(queryShape.drop_back());
+    scoresShape.push_back(keyShape[rank - 2]);
+    for (auto [dim, maskSize] : llvm::enumerate(maskType.getShape())) {
+      if (maskSize != 1 &&
+          isMismatch(maskSize, scoresShape[rank - maskRank + dim]))
+        return op->emitOpError("mask does not broadcast to the scores");
+    }
+  }
   return success();
 }
 
@@ -122,196 +179,643 @@ SmallVector<utils::IteratorType> AttentionOp::getLoopIteratorTypes() {
   return iteratorTypes;
 }
 
+// Returns the slice of `source`, whose leading dims are the batch dims of an
+// attention, at the batch `offsets` and `sizes`. The trailing sequence and
+// head dims are taken whole.
+static Value getBatchSlice(OpBuilder &b, Location loc, Value source,
+                           ArrayRef<OpFoldResult> offsets,
+                           ArrayRef<OpFoldResult> sizes) {
+  int64_t rank = source.getType().cast<ShapedType>().getRank();
+  SmallVector<OpFoldResult> sliceOffsets(offsets);
+  SmallVector<OpFoldResult> sliceSizes(sizes);
+  for (int64_t dim = offsets.size(); dim < rank; ++dim) {
+    sliceOffsets.push_back(b.getI64IntegerAttr(0));
+    sliceSizes.push_back(getDim(b, loc, source, dim));
+  }
+  SmallVector<OpFoldResult> strides(rank, b.getI64IntegerAttr(1));
+  return getSlice(b, loc, source, sliceOffsets, sliceSizes, strides);
+}
+
+// Returns the slice of `mask`, which broadcasts to the scores of an attention,
+// for the batch `offsets` and `sizes` of the attention. The broadcast dims
+// and the trailing query and key dims are taken whole.
+static Value getMaskBatchSlice(OpBuilder &b, Location loc, Value mask,
+                               ArrayRef<OpFoldResult> offsets,
+                               ArrayRef<OpFoldResult> sizes) {
+  auto maskType = mask.getType().cast<ShapedType>();
+  int64_t rank = maskType.getRank();
+  // The batch dims of the mask are the trailing batch dims of the attention.
+  int64_t numLeadingBatchDims = offsets.size() - (rank - 2);
+  SmallVector<OpFoldResult> sliceOffsets;
+  SmallVector<OpFoldResult> sliceSizes;
+  for (int64_t dim = 0; dim < rank; ++dim) {
+    if (dim >= rank - 2 || maskType.getDimSize(dim) == 1) {
+      sliceOffsets.push_back(b.getI64IntegerAttr(0));
+      sliceSizes.push_back(getDim(b, loc, mask, dim));
+      continue;
+    }
+    sliceOffsets.push_back(offsets[numLeadingBatchDims + dim]);
+    sliceSizes.push_back(sizes[numLeadingBatchDims + dim]);
+  }
+  SmallVector<OpFoldResult> strides(rank, b.getI64IntegerAttr(1));
+  return getSlice(b, loc, mask, sliceOffsets, sliceSizes, strides);
+}
+
+FailureOr<TilingResult>
+AttentionOp::getTiledImplementation(OpBuilder &builder,
+                                    ArrayRef<OpFoldResult> offsets,
+                                    ArrayRef<OpFoldResult> sizes) {
+  assert(offsets.size() == static_cast<size_t>(getIterationDomainRank()) &&
+         sizes.size() == static_cast<size_t>(getIterationDomainRank()));
+  // The loops are over the batch dims, and each batch is computed from the
+  // same batch of the query, key, value and mask.
+  Location loc = getLoc();
+  SmallVector<Value> tiledOperands;
+  for (Value operand : {getQuery(), getKey(), getValue()})
+    tiledOperands.push_back(
+        getBatchSlice(builder, loc, operand, offsets, sizes));
+  if (Value mask = getMask())
+    tiledOperands.push_back(
+        getMaskBatchSlice(builder, loc, mask, offsets, sizes));
+  tiledOperands.push_back(
+      getBatchSlice(builder, loc, getOutput(), offsets, sizes));
+
+  SmallVector<Type> resultTypes;
+  if (hasTensorSemantics())
+    resultTypes.push_back(tiledOperands.back().getType());
+  Operation *tiledAttentionOp =
+      mlir::clone(builder, getOperation(), resultTypes, tiledOperands);
+  return TilingResult{{tiledAttentionOp},
+                      SmallVector<Value>(tiledAttentionOp->getResults())};
+}
+
+LogicalResult AttentionOp::getResultTilePosition(
+    OpBuilder &builder, unsigned resultNumber, ArrayRef<OpFoldResult> offsets,
+    ArrayRef<OpFoldResult> sizes, SmallVector<OpFoldResult> &resultOffsets,
+    SmallVector<OpFoldResult> &resultSizes) {
+  if (resultNumber != 0)
+    return failure();
+  resultOffsets.assign(offsets.begin(), offsets.end());
+  resultSizes.assign(sizes.begin(), sizes.end());
+  for (int64_t dim = offsets.size(), rank = getOutputRank(); dim < rank;
+       ++dim) {
+    resultOffsets.push_back(builder.getI64IntegerAttr(0));
+    resultSizes.push_back(getDim(builder, getLoc(), getOutput(), dim));
+  }
+  return success();
+}
+
 bool AttentionOp::payloadUsesValueFromOperand(OpOperand *opOperand) {
-  Value operand = opOperand->get();
-  return operand == getQuery() || operand == getKey() || operand == getValue();
+  return opOperand->getOperandNumber() < getNumInputs();
 }
 
-// Performs a matmul between lhs and rhs
-// Note that "transposed" means the last two dims of rhs are swapped
-static void matmul(OpBuilder &b, Location loc, Value lhs, ValueRange lhsSizes,
-                   Value rhs, ValueRange rhsSizes, Value output,
-                   ValueRange outputSizes, bool transposed = false) {
-  auto elementType = lhs.getType().cast<MemRefType>().getElementType();
+// The scores are computed for a tile of this many queries and keys at a time.
+// The keys and values of a tile are used by each of its queries, so they stay
+// in cache, and the scores of a tile are all that is kept of the otherwise
+// NxN score matrix.
+static constexpr int64_t kAttentionQueryTileSize = 32;
+static constexpr int64_t kAttentionKeyTileSize = 64;
+
+// Builds an scf.for loop from `lb` to `ub` with unit step.
+static void buildLoop(OpBuilder &b, Location loc, Value lb, Value ub,
+                      function_ref<void(OpBuilder &, Location, Value)> body) {
   Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+  b.create<scf::ForOp>(loc, lb, ub, one, ValueRange{},
+                       [&](OpBuilder &b, Location loc, Value iv,
+                           ValueRange args) {
+                         body(b, loc, iv);
+                         b.create<scf::YieldOp>(loc);
+                       });
+}
+
+// Builds an scf.for loop from `lb` to `ub` with unit step that reduces a
+// single value, starting from `init`, and returns the result.
+static Value
+buildReductionLoop(OpBuilder &b, Location loc, Value lb, Value ub, Value init,
+                   function_ref<Value(OpBuilder &, Location, Value, Value)>
+                       body) {
+  Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+  return b
+      .create<scf::ForOp>(loc, lb, ub, one, ValueRange{init},
+                          [&](OpBuilder &b, Location loc, Value iv,
+                              ValueRange args) {
+                            b.create<scf::YieldOp>(
+                                loc, body(b, loc, iv, args[0]));
+                          })
+      ->getResult(0);
+}
+
+// Returns the scale of the scores of an attention, `scaleAttr` if given and
+// 1/sqrt(`headDim`) otherwise.
+static Value getAttentionScale(OpBuilder &b, Location loc, FloatAttr scaleAttr,
+                               Value headDim, Type elementType) {
+  if (scaleAttr) {
+    return b.create<arith::ConstantOp>(
+        loc, elementType,
+        b.getFloatAttr(elementType, scaleAttr.getValueAsDouble()));
+  }
+  Value oneF = b.create<arith::ConstantOp>(loc, elementType,
+                                           b.getFloatAttr(elementType, 1.0));
+  Value headDimF = b.create<arith::UIToFPOp>(
+      loc, elementType,
+      b.create<arith::IndexCastUIOp>(loc, b.getI64Type(), headDim));
+  return b.create<arith::DivFOp>(loc, oneF,
+                                 b.create<math::SqrtOp>(loc, headDimF));
+}
+
+// Returns the indices of the element at `index` of the vector at `indices`.
+static SmallVector<Value> getIndicesOfElement(ValueRange indices,
+                                              Value index) {
+  SmallVector<Value> elementIndices(indices);
+  elementIndices.push_back(index);
+  return elementIndices;
+}
+
+// Builds the attention of `queryLength` queries to `keyLength` keys into
+// `output`, a tile of queries and keys at a time. The vectors of query `row`
+// in `query` and `output` are at `getQueryIndices(row)`, and the vectors of
+// key `col` in `key` and `value` are at `getKeyIndices(col)`. With a
+// `causalOffset`, query `row` only attends to the keys up to
+// `row + causalOffset`. With `maskScore`, the scaled score of query `row` for
+// key `col` is replaced with `maskScore(row, col, score)`.
+static void buildTiledAttention(
+    OpBuilder &b, Location loc, Value query, Value key, Value value,
+    Value output, Value queryLength, Value keyLength, Value headDim,
+    Value valueDim, Value scale, Value causalOffset,
+    function_ref<SmallVector<Value>(OpBuilder &, Location, Value)>
+        getQueryIndices,
+    function_ref<SmallVector<Value>(OpBuilder &, Location, Value)>
+        getKeyIndices,
+    function_ref<Value(OpBuilder &, Location, Value, Value, Value)>
+        maskScore) {
+  Type elementType = query.getType().cast<MemRefType>().getElementType();
   Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
-  auto rank = outputSizes.size();
-  Value reductionDimSize = lhsSizes[lhsSizes.size() - 1];
-
-  // Loop over output
-  b.create<scf::ParallelOp>(
-      loc, SmallVector<Value>(rank, zero), outputSizes,
-      SmallVector<Value>(rank, one),
-      [&](OpBuilder &b, Location loc, ValueRange localIVs) {
-        Value acc = b.create<arith::ConstantOp>(
-            loc, elementType, b.getFloatAttr(elementType, 0.0));
-        Value sum =
-            b.create<scf::ForOp>(
-                 loc, zero, reductionDimSize, one, SmallVector<Value>{acc},
-                 [&](OpBuilder &b, Location loc, Value i, ValueRange accs) {
-                   SmallVector<Value> lhsIVs(localIVs), rhsIVs(localIVs);
-                   lhsIVs[lhsIVs.size() - 1] = i;
-                   rhsIVs[rhsIVs.size() - 2] = i;
-                   if (transposed)
-                     std::swap(rhsIVs[rhsIVs.size() - 1],
-                               rhsIVs[rhsIVs.size() - 2]);
-
-                   Value acc = accs[0];
-                   Value rElem = b.create<memref::LoadOp>(loc, lhs, lhsIVs);
-                   Value cElem = b.create<memref::LoadOp>(loc, rhs, rhsIVs);
-                   Value x = b.create<arith::MulFOp>(loc, rElem, cElem);
-                   x = b.create<arith::AddFOp>(loc, x, acc);
-
-                   b.create<scf::YieldOp>(loc, x);
-                 })
-                ->getResult(0);
-        b.create<memref::StoreOp>(loc, sum, output, localIVs);
+  Value queryTileSize =
+      b.create<arith::ConstantIndexOp>(loc, kAttentionQueryTileSize);
+  Value keyTileSize =
+      b.create<arith::ConstantIndexOp>(loc, kAttentionKeyTileSize);
+  Value zeroF = b.create<arith::ConstantOp>(loc, elementType,
+                                            b.getFloatAttr(elementType, 0.0));
+  Value negInfF = b.create<arith::ConstantOp>(
+      loc, elementType,
+      b.getFloatAttr(elementType, -std::numeric_limits<double>::infinity()));
+
+  // The scores of the current tile, and the running max and sum of the
+  // exponentials of the scores of each query of the tile. The output is used
+  // as the accumulator.
+  Value scores = b.create<memref::AllocOp>(
+      loc, MemRefType::get({kAttentionQueryTileSize, kAttentionKeyTileSize},
+                           elementType));
+  auto rowType = MemRefType::get({kAttentionQueryTileSize}, elementType);
+  Value rowMax = b.create<memref::AllocOp>(loc, rowType);
+  Value rowSum = b.create<memref::AllocOp>(loc, rowType);
+
+  b.create<scf::ForOp>(
+      loc, zero, queryLength, queryTileSize, ValueRange{},
+      [&](OpBuilder &b, Location loc, Value rowBegin, ValueRange) {
+        Value rowEnd = b.create<arith::MinSIOp>(
+            loc, b.create<arith::AddIOp>(loc, rowBegin, queryTileSize),
+            queryLength);
+        Value numRows = b.create<arith::SubIOp>(loc, rowEnd, rowBegin);
+        buildLoop(b, loc, zero, numRows,
+                  [&](OpBuilder &b, Location loc, Value r) {
+                    b.create<memref::StoreOp>(loc, negInfF, rowMax, r);
+                    b.create<memref::StoreOp>(loc, zeroF, rowSum, r);
+                    Value row = b.create<arith::AddIOp>(loc, rowBegin, r);
+                    SmallVector<Value> rowIndices =
+                        getQueryIndices(b, loc, row);
+                    buildLoop(b, loc, zero, valueDim,
+                              [&](OpBuilder &b, Location loc, Value c) {
+                                b.create<memref::StoreOp>(
+                                    loc, zeroF, output,
+                                    getIndicesOfElement(rowIndices, c));
+                              });
+                  });
+
+        // With causal masking, none of the queries of the tile attends to
+        // the keys after its last query.
+        Value keyEnd = keyLength;
+        if (causalOffset) {
+          keyEnd = b.create<arith::MinSIOp>(
+              loc, b.create<arith::AddIOp>(loc, rowEnd, causalOffset),
+              keyLength);
+        }
+        b.create<scf::ForOp>(
+            loc, zero, keyEnd, keyTileSize, ValueRange{},
+            [&](OpBuilder &b, Location loc, Value colBegin, ValueRange) {
+              Value colEnd = b.create<arith::MinSIOp>(
+                  loc, b.create<arith::AddIOp>(loc, colBegin, keyTileSize),
+                  keyEnd);
+              Value numCols = b.create<arith::SubIOp>(loc, colEnd, colBegin);
+              buildLoop(b, loc, zero, numRows, [&](OpBuilder &b, Location loc,
+                                                   Value r) {
+                Value row = b.create<arith::AddIOp>(loc, rowBegin, r);
+                SmallVector<Value> rowIndices = getQueryIndices(b, loc, row);
+                Value lastCol;
+                if (causalOffset)
+                  lastCol = b.create<arith::AddIOp>(loc, row, causalOffset);
+
+                // scores = scale * query @ transpose(key), and their max.
+                Value tileMax = buildReductionLoop(
+                    b, loc, zero, numCols, negInfF,
+                    [&](OpBuilder &b, Location loc, Value c, Value acc) {
+                      Value col = b.create<arith::AddIOp>(loc, colBegin, c);
+                      SmallVector<Value> colIndices =
+                          getKeyIndices(b, loc, col);
+                      Value dot = buildReductionLoop(
+                          b, loc, zero, headDim, zeroF,
+                          [&](OpBuilder &b, Location loc, Value k, Value sum) {
+                            Value q = b.create<memref::LoadOp>(
+                                loc, query, getIndicesOfElement(rowIndices, k));
+                            Value kv = b.create<memref::LoadOp>(
+                                loc, key, getIndicesOfElement(colIndices, k));
+                            Value x = b.create<arith::MulFOp>(loc, q, kv);
+                            return b.create<arith::AddFOp>(loc, x, sum);
+                          });
+                      Value score = b.create<arith::MulFOp>(loc, dot, scale);
+                      if (maskScore)
+                        score = maskScore(b, loc, row, col, score);
+                      if (causalOffset) {
+                        Value masked = b.create<arith::CmpIOp>(
+                            loc, arith::CmpIPredicate::ugt, col, lastCol);
+                        score = b.create<arith::SelectOp>(loc, masked, negInfF,
+                                                          score);
+                      }
+                      b.create<memref::StoreOp>(loc, score, scores,
+                                                ValueRange{r, c});
+                      return b.create<arith::MaxFOp>(loc, acc, score);
+                    });
+
+                // Without a mask, every query attends to at least the
+                // first key, so the running max is finite from the first
+                // tile on, and the correction of the previous tiles is
+                // exp(-inf) = 0 there.
+                Value oldMax = b.create<memref::LoadOp>(loc, rowMax, r);
+                Value newMax = b.create<arith::MaxFOp>(loc, oldMax, tileMax);
+                // A mask can mask out all the keys seen so far, which leaves
+                // a max of -inf. Subtracting 0 instead keeps the
+                // exponentials and the correction at 0 rather than NaN.
+                Value subtractedMax = newMax;
+                if (maskScore) {
+                  Value isNegInf = b.create<arith::CmpFOp>(
+                      loc, arith::CmpFPredicate::OEQ, newMax, negInfF);
+                  subtractedMax =
+                      b.create<arith::SelectOp>(loc, isNegInf, zeroF, newMax);
+                }
+                Value correction = b.create<math::ExpOp>(
+                    loc, b.create<arith::SubFOp>(loc, oldMax, subtractedMax));
+                b.create<memref::StoreOp>(loc, newMax, rowMax, r);
+
+                // scores = exp(scores - max), and their sum.
+                Value tileSum = buildReductionLoop(
+                    b, loc, zero, numCols, zeroF,
+                    [&](OpBuilder &b, Location loc, Value c, Value acc) {
+                      Value score = b.create<memref::LoadOp>(
+                          loc, scores, ValueRange{r, c});
+                      Value p = b.create<math::ExpOp>(
+                          loc,
+                          b.create<arith::SubFOp>(loc, score, subtractedMax));
+                      b.create<memref::StoreOp>(loc, p, scores,
+                                                ValueRange{r, c});
+                      return b.create<arith::AddFOp>(loc, acc, p);
+                    });
+                Value oldSum = b.create<memref::LoadOp>(loc, rowSum, r);
+                Value newSum = b.create<arith::AddFOp>(
+                    loc, b.create<arith::MulFOp>(loc, oldSum, correction),
+                    tileSum);
+                b.create<memref::StoreOp>(loc, newSum, rowSum, r);
+
+                // output = output * correction + scores @ value
+                buildLoop(
+                    b, loc, zero, valueDim,
+                    [&](OpBuilder &b, Location loc, Value vc) {
+                      SmallVector<Value> outputIndices =
+                          getIndicesOfElement(rowIndices, vc);
+                      Value init = b.create<arith::MulFOp>(
+                          loc,
+                          b.create<memref::LoadOp>(loc, output, outputIndices),
+                          correction);
+                      Value acc = buildReductionLoop(
+                          b, loc, zero, numCols, init,
+                          [&](OpBuilder &b, Location loc, Value c, Value acc) {
+                            Value col =
+                                b.create<arith::AddIOp>(loc, colBegin, c);
+                            Value p = b.create<memref::LoadOp>(
+                                loc, scores, ValueRange{r, c});
+                            Value v = b.create<memref::LoadOp>(
+                                loc, value,
+                                getIndicesOfElement(getKeyIndices(b, loc, col),
+                                                    vc));
+                            Value x = b.create<arith::MulFOp>(loc, p, v);
+                            return b.create<arith::AddFOp>(loc, acc, x);
+                          });
+                      b.create<memref::StoreOp>(loc, acc, output,
+                                                outputIndices);
+                    });
+              });
+              b.create<scf::YieldOp>(loc);
+            });
+
+        // output = output / sum(exp(scores - max))
+        buildLoop(b, loc, zero, numRows,
+                  [&](OpBuilder &b, Location loc, Value r) {
+                    Value row = b.create<arith::AddIOp>(loc, rowBegin, r);
+                    SmallVector<Value> rowIndices =
+                        getQueryIndices(b, loc, row);
+                    Value sum = b.create<memref::LoadOp>(loc, rowSum, r);
+                    buildLoop(b, loc, zero, valueDim,
+                              [&](OpBuilder &b, Location loc, Value vc) {
+                                SmallVector<Value> indices =
+                                    getIndicesOfElement(rowIndices, vc);
+                                Value x = b.create<memref::LoadOp>(
+                                    loc, output, indices);
+                                x = b.create<arith::DivFOp>(loc, x, sum);
+                                b.create<memref::StoreOp>(loc, x, output,
+                                                          indices);
+                              });
+                  });
         b.create<scf::YieldOp>(loc);
       });
+
+  b.create<memref::DeallocOp>(loc, scores);
+  b.create<memref::DeallocOp>(loc, rowMax);
+  b.create<memref::DeallocOp>(loc, rowSum);
 }
 
 LogicalResult AttentionOp::generateScalarImplementation(OpBuilder &b,
                                                         Location loc,
                                                         ValueRange ivs) {
-
   Value query = getQuery();
   Value key = getKey();
   Value value = getValue();
-  Value output = getOutput();
   auto queryType = query.getType().cast<MemRefType>();
-  auto keyType = key.getType().cast<MemRefType>();
-  auto valueType = value.getType().cast<MemRefType>();
-  auto queryRank = queryType.getRank();
-  auto keyRank = keyType.getRank();
-  auto valueRank = valueType.getRank();
-  auto keySizes = keyType.getShape();
-  Type elementType = queryType.getElementType();
+  int64_t rank = queryType.getRank();
+
+  Value queryLength = b.create<memref::DimOp>(loc, query, rank - 2);
+  Value keyLength = b.create<memref::DimOp>(loc, key, rank - 2);
+  Value headDim = b.create<memref::DimOp>(loc, query, rank - 1);
+  Value valueDim = b.create<memref::DimOp>(loc, value, rank - 1);
+  Value scale = getAttentionScale(b, loc, getScaleAttr(), headDim,
+                                  queryType.getElementType());
+  Value causalOffset;
+  if (getIsCausal())
+    causalOffset = b.create<arith::ConstantIndexOp>(loc, 0);
+
+  // The vectors of the queries and keys are the rows of the matrices at
+  // `ivs`.
+  auto getIndices = [&](OpBuilder &b, Location loc, Value row) {
+    return getIndicesOfElement(ivs, row);
+  };
+  Value mask = getMask();
+  auto maskScore = [&](OpBuilder &b, Location loc, Value row, Value col,
+                       Value score) -> Value {
+    auto maskType = mask.getType().cast<MemRefType>();
+    int64_t maskRank = maskType.getRank();
+    // The mask is broadcast along its dims of size 1, and its batch dims are
+    // the trailing batch dims of the attention.
+    SmallVector<Value> maskIndices;
+    for (int64_t dim = 0; dim < maskRank; ++dim) {
+      Value index;
+      if (maskType.getDimSize(dim) == 1)
+        index = b.create<arith::ConstantIndexOp>(loc, 0);
+      else if (dim == maskRank - 2)
+        index = row;
+      else if (dim == maskRank - 1)
+        index = col;
+      else
+        index = ivs[rank - maskRank + dim];
+      maskIndices.push_back(index);
+    }
+    Value maskElement = b.create<memref::LoadOp>(loc, mask, maskIndices);
+    if (!maskType.getElementType().isInteger(1))
+      return b.create<arith::AddFOp>(loc, score, maskElement);
+    Type elementType = queryType.getElementType();
+    Value negInfF = b.create<arith::ConstantOp>(
+        loc, elementType,
+        b.getFloatAttr(elementType, -std::numeric_limits<double>::infinity()));
+    return b.create<arith::SelectOp>(loc, maskElement, score, negInfF);
+  };
+  function_ref<Value(OpBuilder &, Location, Value, Value, Value)>
+      maskScoreOrNull;
+  if (mask)
+    maskScoreOrNull = maskScore;
+  buildTiledAttention(b, loc, query, key, value, getOutput(), queryLength,
+                      keyLength, headDim, valueDim, scale, causalOffset,
+                      getIndices, getIndices, maskScoreOrNull);
+  return success();
+}
 
-  Value zeroF = b.create<arith::ConstantOp>(loc, elementType,
-                                            b.getFloatAttr(elementType, 0.0));
+//===----------------------------------------------------------------------===//
+// VarlenAttentionOp
+//===----------------------------------------------------------------------===//
 
-  SmallVector<Value> queryDynSizes, keyDynSizes, valueDynSizes, outputDynSizes;
-  for (auto i = 0; i < queryRank; i++)
-    queryDynSizes.push_back(b.create<memref::DimOp>(loc, query, i));
-  for (auto i = 0; i < keyRank; i++)
-    keyDynSizes.push_back(b.create<memref::DimOp>(loc, key, i));
-  for (auto i = 0; i < valueRank; i++)
-    valueDynSizes.push_back(b.create<memref::DimOp>(loc, value, i));
-  for (auto i = 0; i < queryRank; i++)
-    outputDynSizes.push_back(b.create<memref::DimOp>(loc, output, i));
-
-  // weight = query @ key
-  auto weightRank = queryRank;
-  auto weightSizes = SmallVector<int64_t>(queryType.getShape());
-  weightSizes[weightRank - 1] = keySizes[keyRank - 2];
-  auto weightType = MemRefType::get(weightSizes, queryType.getElementType());
-  SmallVector<Value> weightDynSizes(queryDynSizes);
-  weightDynSizes[weightRank - 1] = keyDynSizes[keyRank - 2];
-  Value weight = b.create<memref::AllocOp>(loc, weightType, weightDynSizes);
-  matmul(b, loc, query, queryDynSizes, key, keyDynSizes, weight, weightDynSizes,
-         /*transposed=*/true);
-
-  // weight = softmax(weight)
-  Value one = b.create<arith::ConstantIndexOp>(loc, 1);
-  Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
-  Value dim = weightDynSizes[weightRank - 1];
-  Value scaleFactor = b.create<math::SqrtOp>(
-      loc, b.create<arith::UIToFPOp>(
-               loc, elementType,
-               b.create<arith::IndexCastUIOp>(loc, b.getI32Type(),
-                                              queryDynSizes[queryRank - 1])));
-  // calculate max(weight)
-  Value init = b.create<memref::LoadOp>(loc, weight,
-                                        SmallVector<Value>(weightRank, zero));
-  Value globalMax =
-      b.create<scf::ParallelOp>(
-           loc, SmallVector<Value>(weightRank, zero), weightDynSizes,
-           SmallVector<Value>(weightRank, one), init,
-           [&](OpBuilder &b, Location loc, ValueRange localIVs,
-               ValueRange accs) {
-             b.create<scf::ReduceOp>(
-                 loc, init,
-                 [&](OpBuilder &b, Location loc, Value elem, Value acc) {
-                   Value x = b.create<memref::LoadOp>(loc, weight, localIVs);
-                   Value max = b.create<arith::MaxFOp>(loc, x, acc);
-                   b.create<scf::ReduceReturnOp>(loc, max);
-                 });
-           })
-          .getResult(0);
-  // weight = (weight - max(weight)) / math.sqrt(querySizes[-1])
-  b.create<scf::ParallelOp>(
-      loc, SmallVector<Value>(weightRank, zero), weightDynSizes,
-      SmallVector<Value>(weightRank, one),
-      [&](OpBuilder &b, Location loc, ValueRange localIVs) {
-        Value x = b.create<memref::LoadOp>(loc, weight, localIVs);
-        x = b.create<arith::SubFOp>(loc, x, globalMax);
-        x = b.create<arith::DivFOp>(loc, x, scaleFactor);
-        b.create<memref::StoreOp>(loc, x, weight, localIVs);
-        b.create<scf::YieldOp>(loc);
-      });
-  // calculate exp(weight)
-  SmallVector<Value> min(weightRank, zero),
-      max(weightDynSizes.begin(), weightDynSizes.end()), steps(weightRank, one);
-  b.create<scf::ParallelOp>(
-      loc, min, max, steps,
-      [&](OpBuilder &b, Location loc, ValueRange localIVs) {
-        Value x = b.create<memref::LoadOp>(loc, weight, localIVs);
-        x = b.create<math::ExpOp>(loc, x);
-        b.create<memref::StoreOp>(loc, x, weight, localIVs);
-        b.create<scf::YieldOp>(loc);
-      });
-  Value expWeightSum = b.create<memref::AllocOp>(
-      loc,
-      MemRefType::get(
-          SmallVector<int64_t>(weightSizes.begin(), weightSizes.end() - 1),
-          elementType),
-      SmallVector<Value>{weightDynSizes.begin(), weightDynSizes.end() - 1});
-  b.create<scf::ParallelOp>(
-      loc, SmallVector<Value>(weightRank - 1, zero),
-      SmallVector<Value>{weightDynSizes.begin(), weightDynSizes.end() - 1},
-      SmallVector<Value>(weightRank - 1, one),
-      [&](OpBuilder &b, Location loc, ValueRange localIVs) {
-        b.create<memref::StoreOp>(loc, zeroF, expWeightSum, localIVs);
-      });
-  // Loop over all dims but -1
-  b.create<scf::ParallelOp>(
-      loc, SmallVector<Value>(weightRank - 1, zero),
-      SmallVector<Value>(weightDynSizes.begin(), weightDynSizes.end() - 1),
-      SmallVector<Value>(weightRank - 1, one),
-      [&](OpBuilder &b, Location loc, ValueRange outsideDims) {
-        // Sum over last dim
-        b.create<scf::ParallelOp>(
-            loc, zero, dim, one,
-            [&](OpBuilder &b, Location loc, ValueRange localIVs) {
-              SmallVector<Value> coords(outsideDims);
-              coords.push_back(localIVs[0]);
-              Value x =
-                  b.create<memref::LoadOp>(loc, expWeightSum, outsideDims);
-              Value y = b.create<memref::LoadOp>(loc, weight, coords);
-              Value sum = b.create<arith::AddFOp>(loc, x, y);
-              b.create<memref::StoreOp>(loc, sum, expWeightSum, outsideDims);
-              b.create<scf::YieldOp>(loc);
-            });
-      });
-  // calculate exp(weight) / sum(exp(weight))
-  b.create<scf::ParallelOp>(
-      loc, SmallVector<Value>(weightRank, zero),
-      SmallVector<Value>(weightDynSizes.begin(), weightDynSizes.end()),
-      SmallVector<Value>(weightRank, one),
-      [&](OpBuilder &b, Location loc, ValueRange localIVs) {
-        SmallVector<Value> sumIVs(localIVs);
-        sumIVs.pop_back();
-        Value x = b.create<memref::LoadOp>(loc, weight, localIVs);
-        Value sum = b.create<memref::LoadOp>(loc, expWeightSum, sumIVs);
-        x = b.create<arith::DivFOp>(loc, x, sum);
-        b.create<memref::StoreOp>(loc, x, weight, localIVs);
-        b.create<scf::YieldOp>(loc);
-      });
+LogicalResult VarlenAttentionOp::verify() {
+  Operation *op = getOperation();
+  if (getNumInputs() != 5 && getNumInputs() != 6)
+    return op->emitOpError("expected 5 or 6 input operands");
+  if (getNumOutputs() != 1)
+    return op->emitOpError("expected one output operand");
+  int64_t kvRank = isPaged() ? 4 : 3;
+  if (getQueryType().getRank() != 3 || getOutputType().getRank() != 3)
+    return op->emitOpError("expected query and output of rank 3");
+  if (getKeyType().getRank() != kvRank || getValueType().getRank() != kvRank)
+    return op->emitOpError("expected key and value of rank ") << kvRank;
+  auto isIntegerTensor = [](Value v, int64_t rank) {
+    auto type = v.getType().cast<ShapedType>();
+    return type.getRank() == rank &&
+           type.getElementType().isSignlessIntOrIndex();
+  };
+  if (!isIntegerTensor(getCuSeqlensQ(), 1) ||
+      !isIntegerTensor(getCuSeqlensK(), 1))
+    return op->emitOpError(
+        "expected integer cumulative sequence lengths of rank 1");
+  if (isPaged() && !isIntegerTensor(getBlockTable(), 2))
+    return op->emitOpError("expected an integer block table of rank 2");
+
+  ArrayRef<int64_t> queryShape = getQueryType().getShape();
+  ArrayRef<int64_t> keyShape = getKeyType().getShape();
+  ArrayRef<int64_t> valueShape = getValueType().getShape();
+  ArrayRef<int64_t> outputShape = getOutputType().getShape();
+  auto isMismatch = [](int64_t a, int64_t b) {
+    return !ShapedType::isDynamic(a) && !ShapedType::isDynamic(b) && a != b;
+  };
+  int64_t cuSeqlensSize =
+      getCuSeqlensQ().getType().cast<ShapedType>().getDimSize(0);
+  if (isMismatch(cuSeqlensSize,
+                 getCuSeqlensK().getType().cast<ShapedType>().getDimSize(0)))
+    return op->emitOpError("query and key number of sequences mismatch");
+  if (isPaged() &&
+      isMismatch(getBlockTable().getType().cast<ShapedType>().getDimSize(0) +
+                     1,
+                 cuSeqlensSize))
+    return op->emitOpError("block table and number of sequences mismatch");
+  if (isMismatch(queryShape[1], keyShape[kvRank - 2]) ||
+      isMismatch(queryShape[1], valueShape[kvRank - 2]) ||
+      isMismatch(queryShape[1], outputShape[1]))
+    return op->emitOpError("query, key, value and output heads mismatch");
+  if (isMismatch(queryShape[2], keyShape[kvRank - 1]))
+    return op->emitOpError("query and key head dimension mismatch");
+  if (isMismatch(valueShape[kvRank - 1], outputShape[2]))
+    return op->emitOpError("value and output head dimension mismatch");
+  for (int64_t dim = 0; dim < kvRank - 2; ++dim) {
+    if (isMismatch(keyShape[dim], valueShape[dim]))
+      return op->emitOpError("key and value tokens mismatch");
+  }
+  if (isMismatch(queryShape[0], outputShape[0]))
+    return op->emitOpError("query and output tokens mismatch");
+  return success();
+}
 
-  // output = weight @ value
-  matmul(b, loc, weight, weightDynSizes, value, valueDynSizes, output,
-         outputDynSizes, /*transposed=*/false);
+SmallVector<Range> VarlenAttentionOp::getIterationDomain(OpBuilder &builder) {
+  Location loc = getLoc();
+  Value zero = builder.create<arith::ConstantIndexOp>(loc, 0);
+  Value one = builder.create<arith::ConstantIndexOp>(loc, 1);
+  Value numSequences = builder.create<arith::SubIOp>(
+      loc, getDimValue(builder, loc, getCuSeqlensQ(), 0), one);
+  Value numHeads = getDimValue(builder, loc, getQuery(), 1);
+  return {Range{zero, numSequences, one}, Range{zero, numHeads, one}};
+}
+
+SmallVector<utils::IteratorType> VarlenAttentionOp::getLoopIteratorTypes() {
+  return SmallVector<utils::IteratorType>(getIterationDomainRank(),
+                                          utils::IteratorType::parallel);
+}
 
+// Returns the slice of `source` at `offset` and `size` along `dim`, which is
+// taken whole along the other dims.
+static Value getSliceAlongDim(OpBuilder &b, Location loc, Value source,
+                              int64_t dim, OpFoldResult offset,
+                              OpFoldResult size) {
+  int64_t rank = source.getType().cast<ShapedType>().getRank();
+  SmallVector<OpFoldResult> offsets(rank, b.getI64IntegerAttr(0));
+  SmallVector<OpFoldResult> sizes;
+  for (int64_t d = 0; d < rank; ++d)
+    sizes.push_back(getDim(b, loc, source, d));
+  offsets[dim] = offset;
+  sizes[dim] = size;
+  SmallVector<OpFoldResult> strides(rank, b.getI64IntegerAttr(1));
+  return getSlice(b, loc, source, offsets, sizes, strides);
+}
+
+FailureOr<TilingResult>
+VarlenAttentionOp::getTiledImplementation(OpBuilder &builder,
+                                          ArrayRef<OpFoldResult> offsets,
+                                          ArrayRef<OpFoldResult> sizes) {
+  assert(offsets.size() == 2 && sizes.size() == 2);
+  // A tile of sequences keeps the whole tokens, since the cumulative
+  // sequence lengths are offsets into them, and only writes the tokens of
+  // its sequences into the output. A tile of heads is a slice of the heads.
+  Location loc = getLoc();
+  int64_t kvRank = getKeyType().getRank();
+  OpFoldResult numCuSeqlens;
+  if (std::optional<int64_t> numSequences = getConstantIntValue(sizes[0])) {
+    numCuSeqlens = builder.getI64IntegerAttr(*numSequences + 1);
+  } else {
+    numCuSeqlens = builder
+                       .create<arith::AddIOp>(
+                           loc, sizes[0].get<Value>(),
+                           builder.create<arith::ConstantIndexOp>(loc, 1))
+                       .getResult();
+  }
+  SmallVector<Value> tiledOperands = {
+      getSliceAlongDim(builder, loc, getQuery(), 1, offsets[1], sizes[1]),
+      getSliceAlongDim(builder, loc, getKey(), kvRank - 2, offsets[1],
+                       sizes[1]),
+      getSliceAlongDim(builder, loc, getValue(), kvRank - 2, offsets[1],
+                       sizes[1]),
+      getSliceAlongDim(builder, loc, getCuSeqlensQ(), 0, offsets[0],
+                       numCuSeqlens),
+      getSliceAlongDim(builder, loc, getCuSeqlensK(), 0, offsets[0],
+                       numCuSeqlens)};
+  if (isPaged())
+    tiledOperands.push_back(getSliceAlongDim(builder, loc, getBlockTable(), 0,
+                                             offsets[0], sizes[0]));
+  tiledOperands.push_back(
+      getSliceAlongDim(builder, loc, getOutput(), 1, offsets[1], sizes[1]));
+
+  SmallVector<Type> resultTypes;
+  if (hasTensorSemantics())
+    resultTypes.push_back(tiledOperands.back().getType());
+  Operation *tiledAttentionOp =
+      mlir::clone(builder, getOperation(), resultTypes, tiledOperands);
+  return TilingResult{{tiledAttentionOp},
+                      SmallVector<Value>(tiledAttentionOp->getResults())};
+}
+
+LogicalResult VarlenAttentionOp::getResultTilePosition(
+    OpBuilder &builder, unsigned resultNumber, ArrayRef<OpFoldResult> offsets,
+    ArrayRef<OpFoldResult> sizes, SmallVector<OpFoldResult> &resultOffsets,
+    SmallVector<OpFoldResult> &resultSizes) {
+  if (resultNumber != 0)
+    return failure();
+  Location loc = getLoc();
+  Value output = getOutput();
+  resultOffsets = {builder.getI64IntegerAttr(0), offsets[1],
+                   builder.getI64IntegerAttr(0)};
+  resultSizes = {getDim(builder, loc, output, 0), sizes[1],
+                 getDim(builder, loc, output, 2)};
+  return success();
+}
+
+bool VarlenAttentionOp::payloadUsesValueFromOperand(OpOperand *opOperand) {
+  return opOperand->getOperandNumber() < getNumInputs();
+}
+
+// Loads the element of the integer `memref` at `indices` as an index.
+static Value loadIndex(OpBuilder &b, Location loc, Value memref,
+                       ValueRange indices) {
+  Value element = b.create<memref::LoadOp>(loc, memref, indices);
+  if (element.getType().isIndex())
+    return element;
+  return b.create<arith::IndexCastOp>(loc, b.getIndexType(), element);
+}
+
+LogicalResult VarlenAttentionOp::generateScalarImplementation(OpBuilder &b,
+                                                              Location loc,
+                                                              ValueRange ivs) {
+  Value query = getQuery();
+  Value key = getKey();
+  Value value = getValue();
+  Value sequence = ivs[0];
+  Value head = ivs[1];
+  auto queryType = query.getType().cast<MemRefType>();
+  int64_t kvRank = getKeyType().getRank();
+
+  Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+  Value nextSequence = b.create<arith::AddIOp>(loc, sequence, one);
+  Value queryBegin = loadIndex(b, loc, getCuSeqlensQ(), sequence);
+  Value queryLength = b.create<arith::SubIOp>(
+      loc, loadIndex(b, loc, getCuSeqlensQ(), nextSequence), queryBegin);
+  Value keyBegin = loadIndex(b, loc, getCuSeqlensK(), sequence);
+  Value keyLength = b.create<arith::SubIOp>(
+      loc, loadIndex(b, loc, getCuSeqlensK(), nextSequence), keyBegin);
+  Value headDim = b.create<memref::DimOp>(loc, query, 2);
+  Value valueDim = b.create<memref::DimOp>(loc, value, kvRank - 1);
+  Value scale = getAttentionScale(b, loc, getScaleAttr(), headDim,
+                                  queryType.getElementType());
+  // The last query is aligned with the last key.
+  Value causalOffset;
+  if (getIsCausal())
+    causalOffset = b.create<arith::SubIOp>(loc, keyLength, queryLength);
+
+  auto getQueryIndices = [&](OpBuilder &b, Location loc,
+                             Value row) -> SmallVector<Value> {
+    return {b.create<arith::AddIOp>(loc, queryBegin, row), head};
+  };
+  auto getKeyIndices = [&](OpBuilder &b, Location loc,
+                           Value col) -> SmallVector<Value> {
+    if (!isPaged())
+      return {b.create<arith::AddIOp>(loc, keyBegin, col), head};
+    Value blockSize = b.create<memref::DimOp>(loc, key, 1);
+    Value block = loadIndex(
+        b, loc, getBlockTable(),
+        {sequence, b.create<arith::DivUIOp>(loc, col, blockSize)});
+    return {block, b.create<arith::RemUIOp>(loc, col, blockSize), head};
+  };
+  buildTiledAttention(b, loc, query, key, value, getOutput(), queryLength,
+                      keyLength, headDim, valueDim, scale, causalOffset,
+                      getQueryIndices, getKeyIndices,
+                      /*maskScore=*/nullptr);
   return success();
 }
 
@@ -409,6 +913,72 @@ bool ScanOp::payloadUsesValueFromOperand(OpOperand *opOperand) {
   }
 }
 
+FailureOr<TilingResult>
+ScanOp::getTiledImplementation(OpBuilder &builder,
+                               ArrayRef<OpFoldResult> offsets,
+                               ArrayRef<OpFoldResult> sizes) {
+  int64_t rank = getOperandRank();
+  assert(offsets.size() == static_cast<size_t>(rank) &&
+         sizes.size() == static_cast<size_t>(rank));
+  // Each element depends on all the previous ones along the scan dimension,
+  // so only the other dimensions can be tiled.
+  uint64_t scanDim = getDimension();
+  if (!isConstantIntValue(offsets[scanDim], 0))
+    return failure();
+
+  Location loc = getLoc();
+  SmallVector<OpFoldResult> strides(rank, builder.getI64IntegerAttr(1));
+  SmallVector<Value> tiledOperands;
+  tiledOperands.push_back(
+      getSlice(builder, loc, input(), offsets, sizes, strides));
+  tiledOperands.push_back(
+      getSlice(builder, loc, output(), offsets, sizes, strides));
+  SmallVector<OpFoldResult> accumulatorOffsets, accumulatorSizes;
+  for (int64_t dim = 0; dim < rank; ++dim) {
+    if (dim == static_cast<int64_t>(scanDim))
+      continue;
+    accumulatorOffsets.push_back(offsets[dim]);
+    accumulatorSizes.push_back(sizes[dim]);
+  }
+  SmallVector<OpFoldResult> accumulatorStrides(rank - 1,
+                                               builder.getI64IntegerAttr(1));
+  tiledOperands.push_back(getSlice(builder, loc, accumulator(),
+                                   accumulatorOffsets, accumulatorSizes,
+                                   accumulatorStrides));
+
+  SmallVector<Type> resultTypes;
+  if (hasTensorSemantics()) {
+    resultTypes.push_back(tiledOperands[1].getType());
+    resultTypes.push_back(tiledOperands[2].getType());
+  }
+  Operation *tiledScanOp =
+      mlir::clone(builder, getOperation(), resultTypes, tiledOperands);
+  return TilingResult{{tiledScanOp},
+                      SmallVector<Value>(tiledScanOp->getResults())};
+}
+
+LogicalResult ScanOp::getResultTilePosition(
+    OpBuilder &builder, unsigned resultNumber, ArrayRef<OpFoldResult> offsets,
+    ArrayRef<OpFoldResult> sizes, SmallVector<OpFoldResult> &resultOffsets,
+    SmallVector<OpFoldResult> &resultSizes) {
+  if (resultNumber == 0) {
+    resultOffsets.assign(offsets.begin(), offsets.end());
+    resultSizes.assign(sizes.begin(), sizes.end());
+    return success();
+  }
+  if (resultNumber == 1) {
+    // The accumulator has all the dimensions but the scan dimension.
+    for (int64_t dim = 0, rank = getOperandRank(); dim < rank; ++dim) {
+      if (dim == static_cast<int64_t>(getDimension()))
+        continue;
+      resultOffsets.push_back(offsets[dim]);
+      resultSizes.push_back(sizes[dim]);
+    }
+    return success();
+  }
+  return failure();
+}
+
 // Generates naive scalar implementation of scan for a given operator f.
 // For inclusive,
 //     output[0] = input[0]
@@ -660,11 +1230,80 @@ SmallVector<Range> ScatterOp::getIterationDomain(OpBuilder &builder) {
   return ranges;
 }
 
-LogicalResult ScatterOp::generateScalarImplementation(OpBuilder &b,
-                                                      Location loc,
-                                                      ValueRange ivs) {
+FailureOr<TilingResult>
+ScatterOp::getTiledImplementation(OpBuilder &builder,
+                                  ArrayRef<OpFoldResult> offsets,
+                                  ArrayRef<OpFoldResult> sizes) {
+  int64_t updateRank = getUpdateType().getRank();
+  assert(offsets.size() == static_cast<size_t>(updateRank) &&
+         sizes.size() == static_cast<size_t>(updateRank));
+  // The slice of the original that the tile of the updates can write to.
+  SmallVector<OpFoldResult> originalOffsets, originalSizes;
+  if (failed(getResultTilePosition(builder, /*resultNumber=*/0, offsets, sizes,
+                                   originalOffsets, originalSizes)))
+    return failure();
+
+  Location loc = getLoc();
+  OpFoldResult one = builder.getI64IntegerAttr(1);
+  SmallVector<Value> tiledOperands;
+  tiledOperands.push_back(getSlice(builder, loc, updates(), offsets, sizes,
+                                   SmallVector<OpFoldResult>(updateRank, one)));
+  // The rows of the indices are the updates along the first update dim.
+  SmallVector<OpFoldResult> indicesOffsets{offsets[0],
+                                           builder.getI64IntegerAttr(0)};
+  SmallVector<OpFoldResult> indicesSizes{
+      sizes[0], getDim(builder, loc, indices(), 1)};
+  tiledOperands.push_back(getSlice(builder, loc, indices(), indicesOffsets,
+                                   indicesSizes, {one, one}));
+  int64_t originalRank = getOriginalType().getRank();
+  tiledOperands.push_back(
+      getSlice(builder, loc, original(), originalOffsets, originalSizes,
+               SmallVector<OpFoldResult>(originalRank, one)));
+
+  SmallVector<Type> resultTypes;
+  if (hasTensorSemantics())
+    resultTypes.push_back(tiledOperands.back().getType());
+  Operation *tiledScatterOp =
+      mlir::clone(builder, getOperation(), resultTypes, tiledOperands);
+  return TilingResult{{tiledScatterOp},
+                      SmallVector<Value>(tiledScatterOp->getResults())};
+}
+
+LogicalResult ScatterOp::getResultTilePosition(
+    OpBuilder &builder, unsigned resultNumber, ArrayRef<OpFoldResult> offsets,
+    ArrayRef<OpFoldResult> sizes, SmallVector<OpFoldResult> &resultOffsets,
+    SmallVector<OpFoldResult> &resultSizes) {
+  if (resultNumber != 0)
+    return failure();
+  // The updates along the first update dim can write anywhere in the
+  // original, and the other update dims are the trailing dims of the
+  // original (see getOriginalIndices). The indices are added to the update
+  // ivs in the leading `indexDepth` dims of the original, so the tile of the
+  // original only follows the tile of the updates in the other dims, and the
+  // updates can't be tiled along the first ones.
+  Location loc = getLoc();
+  int64_t originalRank = getOriginalType().getRank();
+  int64_t updateRank = getUpdateType().getRank();
+  int64_t firstUpdateDim = originalRank - updateRank + 1;
+  int64_t indexDepth = getIndexDepth();
+  for (int64_t dim = 0; dim < originalRank; ++dim) {
+    int64_t updateDim = dim - firstUpdateDim + 1;
+    if (dim >= firstUpdateDim && dim >= indexDepth) {
+      resultOffsets.push_back(offsets[updateDim]);
+      resultSizes.push_back(sizes[updateDim]);
+      continue;
+    }
+    if (dim >= firstUpdateDim && !isConstantIntValue(offsets[updateDim], 0))
+      return failure();
+    resultOffsets.push_back(builder.getI64IntegerAttr(0));
+    resultSizes.push_back(getDim(builder, loc, original(), dim));
+  }
+  return success();
+}
+
+SmallVector<Value> ScatterOp::getOriginalIndices(OpBuilder &b, Location loc,
+                                                 ValueRange ivs) {
   auto indexDepth = getIndexDepth();
-  Value update = b.create<memref::LoadOp>(loc, updates(), ivs);
   SmallVector<Value> starts;
   SmallVector<Value> loadIndices;
   loadIndices.push_back(ivs.front());
@@ -689,6 +1328,14 @@ LogicalResult ScatterOp::generateScalarImplementation(OpBuilder &b,
       cast = b.create<arith::AddIOp>(loc, cast, starts[i]);
     starts[i] = cast;
   }
+  return starts;
+}
+
+LogicalResult ScatterOp::generateScalarImplementation(OpBuilder &b,
+                                                      Location loc,
+                                                      ValueRange ivs) {
+  Value update = b.create<memref::LoadOp>(loc, updates(), ivs);
+  SmallVector<Value> starts = getOriginalIndices(b, loc, ivs);
 
   Value init = b.create<memref::LoadOp>(loc, original(), starts);
 
@@ -791,6 +1438,45 @@ SmallVector<Range> SortOp::getIterationDomain(OpBuilder &builder) {
   return loopBounds;
 }
 
+FailureOr<TilingResult>
+SortOp::getTiledImplementation(OpBuilder &builder,
+                               ArrayRef<OpFoldResult> offsets,
+                               ArrayRef<OpFoldResult> sizes) {
+  int64_t rank = getOperandRank();
+  assert(offsets.size() == static_cast<size_t>(rank) &&
+         sizes.size() == static_cast<size_t>(rank));
+  // Each sorted slice is permuted as a whole, so only the other dimensions
+  // can be tiled.
+  if (!isConstantIntValue(offsets[getDimension()], 0))
+    return failure();
+
+  Location loc = getLoc();
+  SmallVector<OpFoldResult> strides(rank, builder.getI64IntegerAttr(1));
+  SmallVector<Value> tiledOperands;
+  SmallVector<Type> resultTypes;
+  for (OpOperand *output : getOutputOperands()) {
+    tiledOperands.push_back(
+        getSlice(builder, loc, output->get(), offsets, sizes, strides));
+    if (hasTensorSemantics())
+      resultTypes.push_back(tiledOperands.back().getType());
+  }
+  Operation *tiledSortOp =
+      mlir::clone(builder, getOperation(), resultTypes, tiledOperands);
+  return TilingResult{{tiledSortOp},
+                      SmallVector<Value>(tiledSortOp->getResults())};
+}
+
+LogicalResult SortOp::getResultTilePosition(
+    OpBuilder &builder, unsigned resultNumber, ArrayRef<OpFoldResult> offsets,
+    ArrayRef<OpFoldResult> sizes, SmallVector<OpFoldResult> &resultOffsets,
+    SmallVector<OpFoldResult> &resultSizes) {
+  if (resultNumber >= static_cast<unsigned>(getNumOutputs()))
+    return failure();
+  resultOffsets.assign(offsets.begin(), offsets.end());
+  resultSizes.assign(sizes.begin(), sizes.end());
+  return success();
+}
+
 LogicalResult SortOp::generateScalarImplementation(OpBuilder &b, Location loc,
                                                    ValueRange ivs) {
   auto sortDim = getDimension();
@@ -887,6 +1573,7 @@ DEFINE_OP_GET_EFFECTS(AttentionOp)
 DEFINE_OP_GET_EFFECTS(ScanOp)
 DEFINE_OP_GET_EFFECTS(ScatterOp)
 DEFINE_OP_GET_EFFECTS(SortOp)
+DEFINE_OP_GET_EFFECTS(VarlenAttentionOp)
 
 namespace {
 /// This is derived from mlir/lib/Dialect/Linalg/IR/LinalgOps.cpp without any
@@ -0,0 +1,101 @@
+//===- BufferizableOpInterfaceImpl.cpp - One-shot bufferization of tmtensor ===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "torch-mlir-dialects/Dialect/TMTensor/Transforms/BufferizableOpInterfaceImpl.h"
+
+#include "mlir/Dialect/Bufferization/IR/BufferizableOpInterface.h"
+#include "mlir/Dialect/Bufferization/IR/Bufferization.h"
+#include "mlir/IR/Dialect.h"
+#include "mlir/IR/Operation.h"
+#include "torch-mlir-dialects/Dialect/TMTensor/IR/TMTensorDialect.h"
+#include "torch-mlir-dialects/Dialect/TMTensor/IR/TMTensorOps.h"
+
+using namespace ::mlir;
+using namespace ::mlir::bufferization;
+using namespace ::mlir::torch::TMTensor;
+
+namespace {
+/// Bufferization of the TMTensor ops. Each output is tied to the result of
+/// the same index, so that one-shot bufferization can update the buffer of
+/// the output in place, e.g. the destination of a scatter, rather than
+/// allocating a new buffer and copying the output into it as
+/// `tm-tensor-bufferize` does.
+template <typename OpTy>
+struct TMTensorOpInterface
+    : public BufferizableOpInterface::ExternalModel<TMTensorOpInterface<OpTy>,
+                                                    OpTy> {
+  bool bufferizesToMemoryRead(Operation *op, OpOperand &opOperand,
+                              const AnalysisState &state) const {
+    auto tmtensorOp = cast<TMTensorOp>(op);
+    if (!tmtensorOp.isOutputTensor(&opOperand))
+      return true;
+    // Scatter and sort update their output in place, so the elements that
+    // they don't write are read. The other ops only read their outputs from
+    // their payload.
+    if (isa<ScatterOp, SortOp>(op))
+      return true;
+    return tmtensorOp.payloadUsesValueFromOperand(&opOperand);
+  }
+
+  bool bufferizesToMemoryWrite(Operation *op, OpOperand &opOperand,
+                               const AnalysisState &state) const {
+    return cast<TMTensorOp>(op).isOutputTensor(&opOperand);
+  }
+
+  AliasingOpResultList getAliasingOpResults(Operation *op,
+                                            OpOperand &opOperand,
+                                            const AnalysisState &state) const {
+    auto tmtensorOp = cast<TMTensorOp>(op);
+    if (!tmtensorOp.isOutputTensor(&opOperand))
+      return {};
+    int64_t resultNumber =
+        opOperand.getOperandNumber() - tmtensorOp.getNumInputs();
+    return {{op->getOpResult(resultNumber), BufferRelation::Equivalent}};
+  }
+
+  LogicalResult bufferize(Operation *op, RewriterBase &rewriter,
+                          const BufferizationOptions &options) const {
+    auto tmtensorOp = cast<TMTensorOp>(op);
+    if (tmtensorOp.hasBufferSemantics())
+      return success();
+    OpBuilder::InsertionGuard g(rewriter);
+    rewriter.setInsertionPoint(op);
+
+    SmallVector<Value> newOperands;
+    for (OpOperand *opOperand : tmtensorOp.getInputAndOutputOperands()) {
+      Value operand = opOperand->get();
+      if (!operand.getType().isa<TensorType>()) {
+        newOperands.push_back(operand);
+        continue;
+      }
+      FailureOr<Value> buffer = getBuffer(rewriter, operand, options);
+      if (failed(buffer))
+        return failure();
+      newOperands.push_back(*buffer);
+    }
+    SmallVector<Value> outputBuffers(
+        newOperands.begin() + tmtensorOp.getNumInputs(), newOperands.end());
+    tmtensorOp.clone(rewriter, op->getLoc(), /*resultTypes=*/{}, newOperands);
+    replaceOpWithBufferizedValues(rewriter, op, outputBuffers);
+    return success();
+  }
+};
+} // namespace
+
+template <typename... OpTys>
+static void attachInterfaces(MLIRContext *ctx) {
+  (OpTys::template attachInterface<TMTensorOpInterface<OpTys>>(*ctx), ...);
+}
+
+void torch::TMTensor::registerBufferizableOpInterfaceExternalModels(
+    DialectRegistry &registry) {
+  registry.addExtension(+[](MLIRContext *ctx, TMTensorDialect *dialect) {
+    attachInterfaces<AttentionOp, ScanOp, ScatterOp, SortOp,
+                     VarlenAttentionOp>(ctx);
+  });
+}
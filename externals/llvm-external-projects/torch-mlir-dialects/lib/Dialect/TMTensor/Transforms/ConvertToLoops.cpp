@@ -15,6 +15,7 @@
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/IRMapping.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
@@ -25,6 +26,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/TypeSwitch.h"
 
 using namespace mlir;
 using namespace mlir::torch::TMTensor;
@@ -93,6 +95,515 @@ struct ScalarLoopOpInterfaceLowerToLoopsPattern : public RewritePattern {
 };
 } // namespace
 
+/// The scan dimension of `tm_tensor.scan` is split into blocks of this many
+/// elements, which are scanned in parallel.
+static constexpr int64_t kScanBlockSize = 512;
+
+/// Combines `lhs` (the running value of the scan) and `rhs` with the region of
+/// `scanOp`.
+static Value combineWithScanRegion(OpBuilder &b, ScanOp scanOp, Value lhs,
+                                   Value rhs) {
+  Block &srcBlock = scanOp.getRegion().front();
+  IRMapping bvm;
+  bvm.map(srcBlock.getArgument(0), lhs);
+  bvm.map(srcBlock.getArgument(1), rhs);
+  for (Operation &op : srcBlock.without_terminator())
+    b.clone(op, bvm);
+  return bvm.lookupOrDefault(srcBlock.getTerminator()->getOperand(0));
+}
+
+namespace {
+/// Lowers `tm_tensor.scan` to loops that run in parallel over all the
+/// dimensions but the scan dimension, and over blocks of the scan dimension:
+///   1. each block is scanned on its own,
+///   2. the last element of each block is combined with the last element of
+///      the previous block, in order, which makes it the scan of everything up
+///      to it,
+///   3. the other elements of each block are combined with the last element
+///      of the previous block.
+/// This is only valid because the combiner is associative.
+struct ScanOpLowerToParallelLoopsPattern : public OpRewritePattern<ScanOp> {
+  ScanOpLowerToParallelLoopsPattern(MLIRContext *context,
+                                    PatternBenefit benefit = 2)
+      : OpRewritePattern<ScanOp>(context, benefit) {}
+
+  LogicalResult matchAndRewrite(ScanOp scanOp,
+                                PatternRewriter &rewriter) const override {
+    if (!scanOp.hasBufferSemantics()) {
+      return rewriter.notifyMatchFailure(
+          scanOp, "lower to loops needs to have buffer semantics");
+    }
+    Location loc = scanOp.getLoc();
+    Value input = scanOp.input();
+    Value output = scanOp.output();
+    Value accumulator = scanOp.accumulator();
+    int64_t scanDim = scanOp.getDimension();
+    bool isInclusive = scanOp.getInclusive();
+
+    Value zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+    Value one = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+    Value blockSize =
+        rewriter.create<arith::ConstantIndexOp>(loc, kScanBlockSize);
+    Value length = getDimValue(rewriter, loc, input, scanDim);
+    Value numBlocks =
+        rewriter.create<arith::CeilDivUIOp>(loc, length, blockSize);
+
+    auto scanLine = [&](OpBuilder &b, Location loc, ValueRange outerIVs) {
+      // `outerIVs` index the accumulator, and with `iv` inserted the input
+      // and the output.
+      auto getIndices = [&](Value iv) {
+        SmallVector<Value> indices(outerIVs);
+        indices.insert(indices.begin() + scanDim, iv);
+        return indices;
+      };
+      // The scan reads element `iv - 1` of the input for element `iv` of an
+      // exclusive scan.
+      auto loadInput = [&](OpBuilder &b, Location loc, Value iv) -> Value {
+        if (!isInclusive)
+          iv = b.create<arith::SubIOp>(loc, iv, one);
+        return b.create<memref::LoadOp>(loc, input, getIndices(iv));
+      };
+      auto getBlockBounds = [&](OpBuilder &b, Location loc, Value block,
+                                Value &begin, Value &end) {
+        begin = b.create<arith::MulIOp>(loc, block, blockSize);
+        end = b.create<arith::MinUIOp>(
+            loc, b.create<arith::AddIOp>(loc, begin, blockSize), length);
+      };
+
+      // 1. Scan each block.
+      b.create<scf::ParallelOp>(
+          loc, zero, numBlocks, one,
+          [&](OpBuilder &b, Location loc, ValueRange blockIVs) {
+            Value begin, end;
+            getBlockBounds(b, loc, blockIVs[0], begin, end);
+            Value first;
+            if (isInclusive) {
+              first = loadInput(b, loc, begin);
+            } else {
+              // The first element of an exclusive scan is the initial value
+              // of the accumulator. Load a valid element of the input in any
+              // case, and select.
+              Value isFirst = b.create<arith::CmpIOp>(
+                  loc, arith::CmpIPredicate::eq, begin, zero);
+              Value previousInput = b.create<memref::LoadOp>(
+                  loc, input,
+                  getIndices(b.create<arith::SubIOp>(
+                      loc, b.create<arith::MaxUIOp>(loc, begin, one), one)));
+              Value init =
+                  b.create<memref::LoadOp>(loc, accumulator, outerIVs);
+              first = b.create<arith::SelectOp>(loc, isFirst, init,
+                                                previousInput);
+            }
+            b.create<memref::StoreOp>(loc, first, output, getIndices(begin));
+            Value second = b.create<arith::AddIOp>(loc, begin, one);
+            b.create<scf::ForOp>(
+                loc, second, end, one, ValueRange{first},
+                [&](OpBuilder &b, Location loc, Value iv, ValueRange args) {
+                  Value x = combineWithScanRegion(b, scanOp, args[0],
+                                                  loadInput(b, loc, iv));
+                  b.create<memref::StoreOp>(loc, x, output, getIndices(iv));
+                  b.create<scf::YieldOp>(loc, x);
+                });
+            b.create<scf::YieldOp>(loc);
+          });
+
+      // 2. Propagate the last element of each block to the next one.
+      b.create<scf::ForOp>(
+          loc, one, numBlocks, one, ValueRange{},
+          [&](OpBuilder &b, Location loc, Value block, ValueRange args) {
+            Value begin, end;
+            getBlockBounds(b, loc, block, begin, end);
+            Value previous = b.create<memref::LoadOp>(
+                loc, output,
+                getIndices(b.create<arith::SubIOp>(loc, begin, one)));
+            SmallVector<Value> lastIndices =
+                getIndices(b.create<arith::SubIOp>(loc, end, one));
+            Value last = b.create<memref::LoadOp>(loc, output, lastIndices);
+            Value x = combineWithScanRegion(b, scanOp, previous, last);
+            b.create<memref::StoreOp>(loc, x, output, lastIndices);
+            b.create<scf::YieldOp>(loc);
+          });
+
+      // 3. Combine the other elements of each block with the previous block.
+      b.create<scf::ParallelOp>(
+          loc, one, numBlocks, one,
+          [&](OpBuilder &b, Location loc, ValueRange blockIVs) {
+            Value begin, end;
+            getBlockBounds(b, loc, blockIVs[0], begin, end);
+            Value previous = b.create<memref::LoadOp>(
+                loc, output,
+                getIndices(b.create<arith::SubIOp>(loc, begin, one)));
+            Value last = b.create<arith::SubIOp>(loc, end, one);
+            b.create<scf::ForOp>(
+                loc, begin, last, one, ValueRange{},
+                [&](OpBuilder &b, Location loc, Value iv, ValueRange args) {
+                  SmallVector<Value> indices = getIndices(iv);
+                  Value y = b.create<memref::LoadOp>(loc, output, indices);
+                  Value x = combineWithScanRegion(b, scanOp, previous, y);
+                  b.create<memref::StoreOp>(loc, x, output, indices);
+                  b.create<scf::YieldOp>(loc);
+                });
+            b.create<scf::YieldOp>(loc);
+          });
+
+      // Like the scalar implementation, only update the accumulator if the
+      // scan dimension has more than one element.
+      Value updatesAccumulator = b.create<arith::CmpIOp>(
+          loc, arith::CmpIPredicate::ugt, length, one);
+      b.create<scf::IfOp>(loc, updatesAccumulator, [&](OpBuilder &b,
+                                                       Location loc) {
+        Value last = b.create<memref::LoadOp>(
+            loc, output, getIndices(b.create<arith::SubIOp>(loc, length, one)));
+        b.create<memref::StoreOp>(loc, last, accumulator, outerIVs);
+        b.create<scf::YieldOp>(loc);
+      });
+    };
+
+    SmallVector<Value> lbs, ubs, steps;
+    for (int64_t dim = 0, rank = scanOp.getOperandRank(); dim < rank; ++dim) {
+      if (dim == scanDim)
+        continue;
+      lbs.push_back(zero);
+      ubs.push_back(getDimValue(rewriter, loc, input, dim));
+      steps.push_back(one);
+    }
+    if (lbs.empty()) {
+      scanLine(rewriter, loc, ValueRange{});
+    } else {
+      rewriter.create<scf::ParallelOp>(
+          loc, lbs, ubs, steps,
+          [&](OpBuilder &b, Location loc, ValueRange outerIVs) {
+            scanLine(b, loc, outerIVs);
+            b.create<scf::YieldOp>(loc);
+          });
+    }
+    rewriter.eraseOp(scanOp);
+    return success();
+  }
+};
+} // namespace
+
+/// Returns the result of the comparator of `sortOp` on `lhs` and `rhs`, which
+/// hold the values of one element of each operand.
+static Value compareWithSortRegion(OpBuilder &b, SortOp sortOp, ValueRange lhs,
+                                   ValueRange rhs) {
+  Block &srcBlock = sortOp.getRegion().front();
+  IRMapping bvm;
+  for (auto [index, values] : llvm::enumerate(llvm::zip(lhs, rhs))) {
+    bvm.map(srcBlock.getArgument(2 * index), std::get<0>(values));
+    bvm.map(srcBlock.getArgument(2 * index + 1), std::get<1>(values));
+  }
+  for (Operation &op : srcBlock.without_terminator())
+    b.clone(op, bvm);
+  return bvm.lookupOrDefault(srcBlock.getTerminator()->getOperand(0));
+}
+
+namespace {
+/// Lowers `tm_tensor.sort` to a bottom-up merge sort, which runs in parallel
+/// over all the dimensions but the sort dimension, and over the pairs of runs
+/// merged by each pass. Each pass merges runs of `width` elements from one
+/// buffer into the other, alternating between the operands and scratch
+/// buffers of the same shape.
+///
+/// An element of the right run is only taken before one of the left run if
+/// the comparator says the left one must not come first, so the sort is
+/// stable, as the scalar implementation is.
+struct SortOpLowerToParallelLoopsPattern : public OpRewritePattern<SortOp> {
+  SortOpLowerToParallelLoopsPattern(MLIRContext *context,
+                                    PatternBenefit benefit = 2)
+      : OpRewritePattern<SortOp>(context, benefit) {}
+
+  LogicalResult matchAndRewrite(SortOp sortOp,
+                                PatternRewriter &rewriter) const override {
+    if (!sortOp.hasBufferSemantics()) {
+      return rewriter.notifyMatchFailure(
+          sortOp, "lower to loops needs to have buffer semantics");
+    }
+    Location loc = sortOp.getLoc();
+    SmallVector<Value> operands(sortOp.getOutputs());
+    int64_t sortDim = sortOp.getDimension();
+
+    Value zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+    Value one = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+    Value two = rewriter.create<arith::ConstantIndexOp>(loc, 2);
+    Value falseValue = rewriter.create<arith::ConstantIntOp>(loc, 0, 1);
+    Value trueValue = rewriter.create<arith::ConstantIntOp>(loc, 1, 1);
+    Value length = getDimValue(rewriter, loc, operands[0], sortDim);
+
+    SmallVector<Value> scratch;
+    for (Value operand : operands) {
+      auto type = operand.getType().cast<MemRefType>();
+      SmallVector<Value> dynamicSizes;
+      for (int64_t dim = 0, rank = type.getRank(); dim < rank; ++dim) {
+        if (type.isDynamicDim(dim))
+          dynamicSizes.push_back(getDimValue(rewriter, loc, operand, dim));
+      }
+      scratch.push_back(rewriter.create<memref::AllocOp>(
+          loc, MemRefType::get(type.getShape(), type.getElementType()),
+          dynamicSizes));
+    }
+
+    auto sortLine = [&](OpBuilder &b, Location loc, ValueRange outerIVs) {
+      auto getIndices = [&](Value iv) {
+        SmallVector<Value> indices(outerIVs);
+        indices.insert(indices.begin() + sortDim, iv);
+        return indices;
+      };
+      auto load = [&](OpBuilder &b, Location loc, ValueRange buffers,
+                      Value iv) {
+        SmallVector<Value> values;
+        for (Value buffer : buffers)
+          values.push_back(
+              b.create<memref::LoadOp>(loc, buffer, getIndices(iv)));
+        return values;
+      };
+
+      // Each iteration merges the runs of `width` elements, from the scratch
+      // buffers if `inScratch` is set and from the operands otherwise.
+      auto whileOp = b.create<scf::WhileOp>(
+          loc, TypeRange{b.getIndexType(), b.getI1Type()},
+          ValueRange{one, falseValue},
+          [&](OpBuilder &b, Location loc, ValueRange args) {
+            Value notDone = b.create<arith::CmpIOp>(
+                loc, arith::CmpIPredicate::ult, args[0], length);
+            b.create<scf::ConditionOp>(loc, notDone, args);
+          },
+          [&](OpBuilder &b, Location loc, ValueRange args) {
+            Value width = args[0];
+            Value inScratch = args[1];
+            SmallVector<Value> src, dst;
+            for (auto [operand, buffer] : llvm::zip(operands, scratch)) {
+              src.push_back(
+                  b.create<arith::SelectOp>(loc, inScratch, buffer, operand));
+              dst.push_back(
+                  b.create<arith::SelectOp>(loc, inScratch, operand, buffer));
+            }
+            Value mergedWidth = b.create<arith::MulIOp>(loc, width, two);
+            Value numMerges =
+                b.create<arith::CeilDivUIOp>(loc, length, mergedWidth);
+            b.create<scf::ParallelOp>(
+                loc, zero, numMerges, one,
+                [&](OpBuilder &b, Location loc, ValueRange mergeIVs) {
+                  Value begin =
+                      b.create<arith::MulIOp>(loc, mergeIVs[0], mergedWidth);
+                  Value mid = b.create<arith::MinUIOp>(
+                      loc, b.create<arith::AddIOp>(loc, begin, width), length);
+                  Value end = b.create<arith::MinUIOp>(
+                      loc, b.create<arith::AddIOp>(loc, begin, mergedWidth),
+                      length);
+                  b.create<scf::ForOp>(
+                      loc, begin, end, one, ValueRange{begin, mid},
+                      [&](OpBuilder &b, Location loc, Value iv,
+                          ValueRange args) {
+                        Value left = args[0];
+                        Value right = args[1];
+                        Value hasLeft = b.create<arith::CmpIOp>(
+                            loc, arith::CmpIPredicate::ult, left, mid);
+                        Value hasRight = b.create<arith::CmpIOp>(
+                            loc, arith::CmpIPredicate::ult, right, end);
+                        Value hasBoth =
+                            b.create<arith::AndIOp>(loc, hasLeft, hasRight);
+                        Value takeRight =
+                            b.create<scf::IfOp>(
+                                 loc, b.getI1Type(), hasBoth,
+                                 [&](OpBuilder &b, Location loc) {
+                                   Value leftFirst = compareWithSortRegion(
+                                       b, sortOp, load(b, loc, src, left),
+                                       load(b, loc, src, right));
+                                   b.create<scf::YieldOp>(
+                                       loc, ValueRange{b.create<arith::XOrIOp>(
+                                                loc, leftFirst, trueValue)});
+                                 },
+                                 [&](OpBuilder &b, Location loc) {
+                                   b.create<scf::YieldOp>(
+                                       loc, ValueRange{b.create<arith::XOrIOp>(
+                                                loc, hasLeft, trueValue)});
+                                 })
+                                .getResult(0);
+                        Value next = b.create<arith::SelectOp>(loc, takeRight,
+                                                               right, left);
+                        for (auto [from, to] : llvm::zip(src, dst)) {
+                          Value x = b.create<memref::LoadOp>(loc, from,
+                                                             getIndices(next));
+                          b.create<memref::StoreOp>(loc, x, to, getIndices(iv));
+                        }
+                        Value nextLeft = b.create<arith::SelectOp>(
+                            loc, takeRight, left,
+                            b.create<arith::AddIOp>(loc, left, one));
+                        Value nextRight = b.create<arith::SelectOp>(
+                            loc, takeRight,
+                            b.create<arith::AddIOp>(loc, right, one), right);
+                        b.create<scf::YieldOp>(
+                            loc, ValueRange{nextLeft, nextRight});
+                      });
+                  b.create<scf::YieldOp>(loc);
+                });
+            Value notInScratch =
+                b.create<arith::XOrIOp>(loc, inScratch, trueValue);
+            b.create<scf::YieldOp>(loc, ValueRange{mergedWidth, notInScratch});
+          });
+
+      // Copy the line back if the last pass left it in the scratch buffers.
+      b.create<scf::IfOp>(
+          loc, whileOp.getResult(1), [&](OpBuilder &b, Location loc) {
+            b.create<scf::ForOp>(
+                loc, zero, length, one, ValueRange{},
+                [&](OpBuilder &b, Location loc, Value iv, ValueRange args) {
+                  for (auto [operand, buffer] :
+                       llvm::zip(operands, scratch)) {
+                    Value x = b.create<memref::LoadOp>(loc, buffer,
+                                                       getIndices(iv));
+                    b.create<memref::StoreOp>(loc, x, operand, getIndices(iv));
+                  }
+                  b.create<scf::YieldOp>(loc);
+                });
+            b.create<scf::YieldOp>(loc);
+          });
+    };
+
+    SmallVector<Value> lbs, ubs, steps;
+    for (int64_t dim = 0, rank = sortOp.getOperandRank(); dim < rank; ++dim) {
+      if (dim == sortDim)
+        continue;
+      lbs.push_back(zero);
+      ubs.push_back(getDimValue(rewriter, loc, operands[0], dim));
+      steps.push_back(one);
+    }
+    if (lbs.empty()) {
+      sortLine(rewriter, loc, ValueRange{});
+    } else {
+      rewriter.create<scf::ParallelOp>(
+          loc, lbs, ubs, steps,
+          [&](OpBuilder &b, Location loc, ValueRange outerIVs) {
+            sortLine(b, loc, outerIVs);
+            b.create<scf::YieldOp>(loc);
+          });
+    }
+    for (Value buffer : scratch)
+      rewriter.create<memref::DeallocOp>(loc, buffer);
+    rewriter.eraseOp(sortOp);
+    return success();
+  }
+};
+} // namespace
+
+/// Returns the kind of `memref.atomic_rmw` that performs the update of
+/// `scatterOp`, if its region combines the update and the original value with
+/// a single operation that has a lock-free lowering.
+static std::optional<arith::AtomicRMWKind>
+getScatterAtomicKind(ScatterOp scatterOp) {
+  Block &block = scatterOp.getRegion().front();
+  Operation *terminator = block.getTerminator();
+  if (block.getOperations().size() != 2 || terminator->getNumOperands() != 1)
+    return std::nullopt;
+  Operation *op = &block.front();
+  if (op->getNumOperands() != 2 || op->getNumResults() != 1 ||
+      terminator->getOperand(0) != op->getResult(0))
+    return std::nullopt;
+  // All the supported operations are commutative, so the order of the
+  // arguments doesn't matter.
+  Value update = block.getArgument(0);
+  Value original = block.getArgument(1);
+  if (!(op->getOperand(0) == update && op->getOperand(1) == original) &&
+      !(op->getOperand(0) == original && op->getOperand(1) == update))
+    return std::nullopt;
+  return llvm::TypeSwitch<Operation *, std::optional<arith::AtomicRMWKind>>(op)
+      .Case([](arith::AddFOp) { return arith::AtomicRMWKind::addf; })
+      .Case([](arith::AddIOp) { return arith::AtomicRMWKind::addi; })
+      .Case([](arith::MaxSIOp) { return arith::AtomicRMWKind::maxs; })
+      .Case([](arith::MinSIOp) { return arith::AtomicRMWKind::mins; })
+      .Case([](arith::MaxUIOp) { return arith::AtomicRMWKind::maxu; })
+      .Case([](arith::MinUIOp) { return arith::AtomicRMWKind::minu; })
+      .Case([](arith::OrIOp) { return arith::AtomicRMWKind::ori; })
+      .Case([](arith::AndIOp) { return arith::AtomicRMWKind::andi; })
+      .Default([](Operation *) { return std::nullopt; });
+}
+
+namespace {
+/// Lowers `tm_tensor.scatter` to loops that run in parallel wherever updates
+/// can't conflict:
+///   - with unique indices, all the loops are parallel,
+///   - with repeated indices, updates whose region maps to an atomic
+///     read-modify-write (e.g. the additions of an embedding backward) are
+///     applied with `memref.atomic_rmw` from fully parallel loops,
+///   - otherwise, the updates are applied in order, and only the elements of
+///     each update slice are updated in parallel.
+struct ScatterOpLowerToParallelLoopsPattern
+    : public OpRewritePattern<ScatterOp> {
+  ScatterOpLowerToParallelLoopsPattern(MLIRContext *context,
+                                       PatternBenefit benefit = 2)
+      : OpRewritePattern<ScatterOp>(context, benefit) {}
+
+  LogicalResult matchAndRewrite(ScatterOp scatterOp,
+                                PatternRewriter &rewriter) const override {
+    if (!scatterOp.hasBufferSemantics()) {
+      return rewriter.notifyMatchFailure(
+          scatterOp, "lower to loops needs to have buffer semantics");
+    }
+    Location loc = scatterOp.getLoc();
+    std::optional<arith::AtomicRMWKind> atomicKind;
+    if (!scatterOp.getUniqueIndices())
+      atomicKind = getScatterAtomicKind(scatterOp);
+    bool inOrder = !scatterOp.getUniqueIndices() && !atomicKind;
+    if (inOrder && scatterOp.getUpdateType().getRank() == 1) {
+      return rewriter.notifyMatchFailure(
+          scatterOp, "scalar updates with repeated indices are sequential");
+    }
+
+    SmallVector<Value> lbs, ubs, steps;
+    for (Range range : scatterOp.getIterationDomain(rewriter)) {
+      lbs.push_back(
+          getValueOrCreateConstantIndexOp(rewriter, loc, range.offset));
+      ubs.push_back(getValueOrCreateConstantIndexOp(rewriter, loc, range.size));
+      steps.push_back(
+          getValueOrCreateConstantIndexOp(rewriter, loc, range.stride));
+    }
+
+    LogicalResult status = success();
+    auto update = [&](OpBuilder &b, Location loc, ValueRange ivs) {
+      if (!atomicKind) {
+        status = scatterOp.generateScalarImplementation(b, loc, ivs);
+        return;
+      }
+      Value value = b.create<memref::LoadOp>(loc, scatterOp.updates(), ivs);
+      SmallVector<Value> indices = scatterOp.getOriginalIndices(b, loc, ivs);
+      b.create<memref::AtomicRMWOp>(loc, value.getType(), *atomicKind, value,
+                                    scatterOp.original(), indices);
+    };
+
+    if (inOrder) {
+      // Updates at different indices of the first loop may conflict, but
+      // the elements of a single update slice can't.
+      rewriter.create<scf::ForOp>(
+          loc, lbs.front(), ubs.front(), steps.front(), ValueRange{},
+          [&](OpBuilder &b, Location loc, Value iv, ValueRange args) {
+            b.create<scf::ParallelOp>(
+                loc, ArrayRef(lbs).drop_front(), ArrayRef(ubs).drop_front(),
+                ArrayRef(steps).drop_front(),
+                [&](OpBuilder &b, Location loc, ValueRange sliceIVs) {
+                  SmallVector<Value> ivs{iv};
+                  ivs.append(sliceIVs.begin(), sliceIVs.end());
+                  update(b, loc, ivs);
+                  b.create<scf::YieldOp>(loc);
+                });
+            b.create<scf::YieldOp>(loc);
+          });
+    } else {
+      rewriter.create<scf::ParallelOp>(
+          loc, lbs, ubs, steps,
+          [&](OpBuilder &b, Location loc, ValueRange ivs) {
+            update(b, loc, ivs);
+            b.create<scf::YieldOp>(loc);
+          });
+    }
+    if (failed(status))
+      return failure();
+    rewriter.eraseOp(scatterOp);
+    return success();
+  }
+};
+} // namespace
+
 //===----------------------------------------------------------------------===//
 // Pass
 //===----------------------------------------------------------------------===//
@@ -109,7 +620,10 @@ struct TMTensorToLoopsPass : public TMTensorToLoopsBase<TMTensorToLoopsPass> {
     MLIRContext *context = &getContext();
 
     RewritePatternSet patterns(context);
-    patterns.insert<ScalarLoopOpInterfaceLowerToLoopsPattern>(context);
+    patterns.insert<ScalarLoopOpInterfaceLowerToLoopsPattern,
+                    ScanOpLowerToParallelLoopsPattern,
+                    ScatterOpLowerToParallelLoopsPattern,
+                    SortOpLowerToParallelLoopsPattern>(context);
     if (failed(applyPatternsAndFoldGreedily(getOperation(),
                                             std::move(patterns)))) {
       return signalPassFailure();
@@ -0,0 +1,113 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/SCF/Transforms/TileUsingInterface.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Interfaces/TilingInterface.h"
+#include "mlir/Pass/Pass.h"
+#include "torch-mlir-dialects/Dialect/TMTensor/IR/TMTensorDialect.h"
+#include "torch-mlir-dialects/Dialect/TMTensor/IR/TMTensorOps.h"
+#include "torch-mlir-dialects/Dialect/TMTensor/Transforms/PassDetail.h"
+#include "torch-mlir-dialects/Dialect/TMTensor/Transforms/Passes.h"
+#include "llvm/ADT/SmallVector.h"
+
+using namespace mlir;
+using namespace mlir::torch::TMTensor;
+
+/// TMTensor ops aren't destination-style ops, so the loops produced by tiling
+/// them start from empty tensors and their tiles write to slices of the
+/// original outputs. Threads the outputs through the loops instead, like
+/// tiling does for destination-style ops, since the tiles of some ops (e.g. a
+/// scatter tiled along its updates) only write parts of the slices they yield.
+static void threadOutputsThroughLoops(RewriterBase &rewriter, TMTensorOp op,
+                                      scf::SCFTilingResult &tilingResult) {
+  if (tilingResult.loops.empty() || tilingResult.tiledOps.size() != 1)
+    return;
+  Operation *outerLoop = tilingResult.loops.front();
+  Operation *innerLoop = tilingResult.loops.back();
+  auto outer = cast<scf::ForOp>(outerLoop);
+  auto inner = cast<scf::ForOp>(innerLoop);
+  auto tiledOp = cast<TMTensorOp>(tilingResult.tiledOps.front());
+  for (auto [index, output] : llvm::enumerate(op.getOutputs())) {
+    rewriter.updateRootInPlace(outer, [&]() {
+      outer->setOperand(outer.getNumControlOperands() + index, output);
+    });
+    auto slice =
+        tiledOp.getOutputs()[index].getDefiningOp<tensor::ExtractSliceOp>();
+    if (!slice || slice.getSource() != output)
+      continue;
+    rewriter.updateRootInPlace(slice, [&]() {
+      slice.getSourceMutable().assign(inner.getRegionIterArgs()[index]);
+    });
+  }
+}
+
+/// Tiles `op` with `tileSizes`, which are truncated or padded with zeros to
+/// the rank of its iteration domain, and replaces it with the tiled loops.
+static LogicalResult tileOp(RewriterBase &rewriter, TilingInterface op,
+                            ArrayRef<int64_t> tileSizes) {
+  size_t numLoops = op.getLoopIteratorTypes().size();
+  SmallVector<int64_t> loopTileSizes(
+      tileSizes.take_front(std::min(numLoops, tileSizes.size())));
+  loopTileSizes.resize(numLoops, 0);
+  if (llvm::all_of(loopTileSizes, [](int64_t size) { return size == 0; }))
+    return success();
+
+  scf::SCFTilingOptions options;
+  options.setTileSizes(loopTileSizes);
+  rewriter.setInsertionPoint(op);
+  FailureOr<scf::SCFTilingResult> tilingResult =
+      scf::tileUsingSCFForOp(rewriter, op, options);
+  if (failed(tilingResult))
+    return op->emitError("failed to tile the op");
+  // With buffer semantics there are no results to replace.
+  if (op->getNumResults() == 0) {
+    rewriter.eraseOp(op);
+    return success();
+  }
+  threadOutputsThroughLoops(rewriter, cast<TMTensorOp>(op.getOperation()),
+                            *tilingResult);
+  rewriter.replaceOp(op, tilingResult->replacements);
+  return success();
+}
+
+namespace {
+struct TMTensorTilePass : public TMTensorTileBase<TMTensorTilePass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<affine::AffineDialect, mlir::arith::ArithDialect,
+                    memref::MemRefDialect, scf::SCFDialect,
+                    tensor::TensorDialect>();
+  }
+
+  void runOnOperation() override {
+    // Collect the ops first, so that the tiled ops aren't tiled again.
+    SmallVector<TilingInterface> ops;
+    getOperation().walk([&](TilingInterface op) {
+      if (isa<TMTensorDialect>(op->getDialect()))
+        ops.push_back(op);
+    });
+    IRRewriter rewriter(&getContext());
+    for (TilingInterface op : ops) {
+      if (failed(tileOp(rewriter, op, tileSizes)))
+        return signalPassFailure();
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+torch::TMTensor::createTMTensorTilePass() {
+  return std::make_unique<TMTensorTilePass>();
+}
@@ -10,26 +10,39 @@ func.func @scan_1d_inclusive(%0: memref<128xi32>, %1: memref<128xi32>) {
   }
   return
 }
+// The scan dimension is split into blocks of 512 elements that are scanned
+// in parallel, then the last element of each block is propagated to the next
+// blocks.
 // CHECK-LABEL: func.func @scan_1d_inclusive
 // CHECK-SAME:    %[[BUFI:[a-zA-Z0-9]+]]
 // CHECK-SAME:    %[[BUFO:[a-zA-Z0-9]+]]
-// CHECK-DAG:     %[[C128:.+]] = arith.constant 128 : index
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[C512:.+]] = arith.constant 512 : index
 // CHECK-DAG:     %[[ACC:.+]] = memref.alloc() : memref<i32>
-// CHECK:         scf.for %[[ARG1:.+]] = %[[C0]] to %[[C128]] step %[[C1]]
-// CHECK:           %[[COND:.+]] = arith.cmpi eq, %[[ARG1]], %[[C0]] : index
-// CHECK:           scf.if %[[COND]] {
-// CHECK:             %[[V1:.+]] = memref.load %[[BUFI]][%[[ARG1]]]
-// CHECK:             memref.store %[[V1]], %[[BUFO]][%[[ARG1]]]
-// CHECK:           } else {
-// CHECK:             %[[T1:.+]] = arith.subi %[[ARG1]], %[[C1]] : index
-// CHECK:             %[[V2:.+]] = memref.load %[[BUFO]][%[[T1]]]
-// CHECK:             %[[V3:.+]] = memref.load %[[BUFI]][%[[ARG1]]]
-// CHECK:             %[[V4:.+]] = arith.addi %[[V2]], %[[V3]] : i32
-// CHECK:             memref.store %[[V4]], %[[BUFO]][%[[ARG1]]]
-// CHECK:             memref.store %[[V4]], %[[ACC]][]
-// CHECK:           }
+// CHECK:         scf.parallel (%[[BLOCK:[a-zA-Z0-9_]+]]) = (%[[C0]]) to (%{{.+}}) step (%[[C1]]) {
+// CHECK:           %[[BEGIN:.+]] = arith.muli %[[BLOCK]], %[[C512]] : index
+// CHECK:           %[[END:.+]] = arith.minui
+// CHECK:           %[[FIRST:.+]] = memref.load %[[BUFI]][%[[BEGIN]]]
+// CHECK:           memref.store %[[FIRST]], %[[BUFO]][%[[BEGIN]]]
+// CHECK:           %[[SECOND:.+]] = arith.addi %[[BEGIN]], %[[C1]] : index
+// CHECK:           scf.for %[[IV:[a-zA-Z0-9_]+]] = %[[SECOND]] to %[[END]] step %[[C1]] iter_args(%[[RUNNING:[a-zA-Z0-9_]+]] = %[[FIRST]]) -> (i32) {
+// CHECK:             %[[X:.+]] = memref.load %[[BUFI]][%[[IV]]]
+// CHECK:             %[[SUM:.+]] = arith.addi %[[RUNNING]], %[[X]] : i32
+// CHECK:             memref.store %[[SUM]], %[[BUFO]][%[[IV]]]
+// CHECK:             scf.yield %[[SUM]] : i32
+// CHECK:         scf.for %[[BLOCK:[a-zA-Z0-9_]+]] = %[[C1]] to %{{.+}} step %[[C1]] {
+// CHECK:           %[[PREVIOUS:.+]] = memref.load %[[BUFO]]
+// CHECK:           %[[LAST:.+]] = memref.load %[[BUFO]]
+// CHECK:           %[[SUM:.+]] = arith.addi %[[PREVIOUS]], %[[LAST]] : i32
+// CHECK:           memref.store %[[SUM]], %[[BUFO]]
+// CHECK:         scf.parallel (%[[BLOCK:[a-zA-Z0-9_]+]]) = (%[[C1]]) to (%{{.+}}) step (%[[C1]]) {
+// CHECK:           %[[PREVIOUS:.+]] = memref.load %[[BUFO]]
+// CHECK:           scf.for
+// CHECK:             %[[Y:.+]] = memref.load %[[BUFO]]
+// CHECK:             %[[SUM:.+]] = arith.addi %[[PREVIOUS]], %[[Y]] : i32
+// CHECK:             memref.store %[[SUM]], %[[BUFO]]
+// CHECK:         memref.store %{{.+}}, %[[ACC]][] : memref<i32>
 
 // -----
 
@@ -46,23 +59,25 @@ func.func @scan_1d_exclusive(%0: memref<128xi32>, %1: memref<128xi32>) {
 // CHECK-LABEL: func.func @scan_1d_exclusive
 // CHECK-SAME:    %[[BUFI:[a-zA-Z0-9]+]]
 // CHECK-SAME:    %[[BUFO:[a-zA-Z0-9]+]]
-// CHECK-DAG:     %[[C128:.+]] = arith.constant 128 : index
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[C512:.+]] = arith.constant 512 : index
 // CHECK-DAG:     %[[ACC:.+]] = memref.alloc() : memref<i32>
-// CHECK:         scf.for %[[ARG1:.+]] = %[[C0]] to %[[C128]] step %[[C1]]
-// CHECK:           %[[COND:.+]] = arith.cmpi eq, %[[ARG1]], %[[C0]] : index
-// CHECK:           scf.if %[[COND]] {
-// CHECK:             %[[V0:.+]] = memref.load %[[ACC]][] : memref<i32>
-// CHECK:             memref.store %[[V0]], %[[BUFO]][%[[ARG1]]]
-// CHECK:           } else {
-// CHECK:             %[[T1:.+]] = arith.subi %[[ARG1]], %[[C1]] : index
-// CHECK:             %[[V2:.+]] = memref.load %[[BUFO]][%[[T1]]]
-// CHECK:             %[[V3:.+]] = memref.load %[[BUFI]][%[[T1]]]
-// CHECK:             %[[V4:.+]] = arith.addi %[[V2]], %[[V3]] : i32
-// CHECK:             memref.store %[[V4]], %[[BUFO]][%[[ARG1]]]
-// CHECK:             memref.store %[[V4]], %[[ACC]][]
-// CHECK:           }
+// CHECK:         scf.parallel (%[[BLOCK:[a-zA-Z0-9_]+]]) = (%[[C0]]) to (%{{.+}}) step (%[[C1]]) {
+// CHECK:           %[[BEGIN:.+]] = arith.muli %[[BLOCK]], %[[C512]] : index
+// CHECK:           %[[IS_FIRST:.+]] = arith.cmpi eq, %[[BEGIN]], %[[C0]] : index
+// CHECK:           %[[CLAMPED:.+]] = arith.maxui %[[BEGIN]], %[[C1]] : index
+// CHECK:           %[[PREV:.+]] = arith.subi %[[CLAMPED]], %[[C1]] : index
+// CHECK:           %[[INPUT:.+]] = memref.load %[[BUFI]][%[[PREV]]]
+// CHECK:           %[[INIT:.+]] = memref.load %[[ACC]][] : memref<i32>
+// CHECK:           %[[FIRST:.+]] = arith.select %[[IS_FIRST]], %[[INIT]], %[[INPUT]] : i32
+// CHECK:           memref.store %[[FIRST]], %[[BUFO]][%[[BEGIN]]]
+// CHECK:           scf.for %[[IV:[a-zA-Z0-9_]+]] = {{.*}} iter_args(%[[RUNNING:[a-zA-Z0-9_]+]] = %[[FIRST]]) -> (i32) {
+// CHECK:             %[[IV_PREV:.+]] = arith.subi %[[IV]], %[[C1]] : index
+// CHECK:             %[[X:.+]] = memref.load %[[BUFI]][%[[IV_PREV]]]
+// CHECK:             %[[SUM:.+]] = arith.addi %[[RUNNING]], %[[X]] : i32
+// CHECK:             memref.store %[[SUM]], %[[BUFO]][%[[IV]]]
+// CHECK:         memref.store %{{.+}}, %[[ACC]][] : memref<i32>
 
 // -----
 
@@ -76,29 +91,25 @@ func.func @scan_2d(%0: memref<16x32xi32>, %1: memref<16x32xi32>) {
   }
   return
 }
+// The dimensions other than the scan dimension are parallel.
 // CHECK-LABEL: func.func @scan_2d
 // CHECK-SAME:    %[[BUFI:[a-zA-Z0-9]+]]
 // CHECK-SAME:    %[[BUFO:[a-zA-Z0-9]+]]
-// CHECK-DAG:     %[[C16:.+]] = arith.constant 16 : index
-// CHECK-DAG:     %[[C32:.+]] = arith.constant 32 : index
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[C32:.+]] = arith.constant 32 : index
+// CHECK-DAG:     %[[C512:.+]] = arith.constant 512 : index
 // CHECK-DAG:     %[[ACC:.+]] = memref.alloc() : memref<32xi32>
-// CHECK:         scf.for %[[ARG1:.+]] = %[[C0]] to %[[C16]] step %[[C1]]
-// CHECK:           scf.for %[[ARG2:.+]] = %[[C0]] to %[[C32]] step %[[C1]]
-// CHECK:             %[[COND:.+]] = arith.cmpi eq, %[[ARG1]], %[[C0]] : index
-// CHECK:             scf.if %[[COND]] {
-// CHECK:               %[[V1:.+]] = memref.load %[[BUFI]][%[[ARG1]], %[[ARG2]]]
-// CHECK:               memref.store %[[V1]], %[[BUFO]][%[[ARG1]], %[[ARG2]]]
-// CHECK:             } else {
-// CHECK:               %[[T1:.+]] = arith.subi %[[ARG1]], %[[C1]] : index
-// CHECK:               %[[V2:.+]] = memref.load %[[BUFO]][%[[T1]], %[[ARG2]]]
-// CHECK:               %[[V3:.+]] = memref.load %[[BUFI]][%[[ARG1]], %[[ARG2]]]
-// CHECK:               %[[V4:.+]] = arith.addi %[[V2]], %[[V3]] : i32
-// CHECK:               memref.store %[[V4]], %[[BUFO]][%[[ARG1]], %[[ARG2]]]
-// CHECK:               memref.store %[[V4]], %[[ACC]][%[[ARG2]]]
-// CHECK:             }
-
+// CHECK:         scf.parallel (%[[J:[a-zA-Z0-9_]+]]) = (%[[C0]]) to (%[[C32]]) step (%[[C1]]) {
+// CHECK:           scf.parallel (%[[BLOCK:[a-zA-Z0-9_]+]]) = (%[[C0]]) to (%{{.+}}) step (%[[C1]]) {
+// CHECK:             %[[BEGIN:.+]] = arith.muli %[[BLOCK]], %[[C512]] : index
+// CHECK:             %[[FIRST:.+]] = memref.load %[[BUFI]][%[[BEGIN]], %[[J]]]
+// CHECK:             memref.store %[[FIRST]], %[[BUFO]][%[[BEGIN]], %[[J]]]
+// CHECK:             scf.for %[[IV:[a-zA-Z0-9_]+]] = {{.*}} iter_args(%[[RUNNING:[a-zA-Z0-9_]+]] = %[[FIRST]]) -> (i32) {
+// CHECK:               %[[X:.+]] = memref.load %[[BUFI]][%[[IV]], %[[J]]]
+// CHECK:               %[[SUM:.+]] = arith.addi %[[RUNNING]], %[[X]] : i32
+// CHECK:               memref.store %[[SUM]], %[[BUFO]][%[[IV]], %[[J]]]
+// CHECK:           memref.store %{{.+}}, %[[ACC]][%[[J]]] : memref<32xi32>
 
 // -----
 
@@ -120,7 +131,7 @@ func.func @scatter_update_scalar_1D(
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[C3:.+]] = arith.constant 3 : index
-// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[C3]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[I:.+]]) = (%[[C0]]) to (%[[C3]]) step (%[[C1]]) {
 // CHECK:           %[[T1:.+]] = memref.load %[[UPDATES]][%[[I]]] : memref<3xi32>
 // CHECK:           %[[T2:.+]] =  memref.load %[[INDICES]][%[[I]], %[[C0]]] : memref<3x1xi32>
 // CHECK:           %[[IDX:.+]] = arith.index_cast %[[T2]] : i32 to index
@@ -147,7 +158,7 @@ func.func @scatter_add_scalar_2D(
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[C3:.+]] = arith.constant 3 : index
-// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[C3]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[I:.+]]) = (%[[C0]]) to (%[[C3]]) step (%[[C1]]) {
 // CHECK:           %[[T1:.+]] = memref.load %[[UPDATES]][%[[I]]] : memref<3xi32>
 // CHECK:           %[[T2:.+]] = memref.load %[[INDICES]][%[[I]], %[[C0]]] : memref<3x2xi32>
 // CHECK:           %[[IDX1:.+]] = arith.index_cast %[[T2]] : i32 to index
@@ -178,8 +189,7 @@ func.func @scatter_update_slice_2D(
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[C2:.+]] = arith.constant 2 : index
 // CHECK-DAG:     %[[C3:.+]] = arith.constant 3 : index
-// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[C2]] step %[[C1]] {
-// CHECK:           scf.for %[[J:.+]] = %[[C0]] to %[[C3]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[I:.+]], %[[J:.+]]) = (%[[C0]], %[[C0]]) to (%[[C2]], %[[C3]]) step (%[[C1]], %[[C1]]) {
 // CHECK:             %[[UPDATE:.+]] = memref.load %[[UPDATES]][%[[I]], %[[J]]]
 // CHECK:             %[[INDEX:.+]] = memref.load %[[INDICES]][%[[I]], %[[C0]]]
 // CHECK:             %[[LOC:.+]] = arith.index_cast %[[INDEX]] : i32 to index
@@ -208,7 +218,7 @@ func.func @scatter_add_scalar_1D(
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[C3:.+]] = arith.constant 3 : index
-// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[C3]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[I:.+]]) = (%[[C0]]) to (%[[C3]]) step (%[[C1]]) {
 // CHECK:           %[[T1:.+]] = memref.load %[[UPDATES]][%[[I]]] : memref<3xi32>
 // CHECK:           %[[T2:.+]] =  memref.load %[[INDICES]][%[[I]], %[[C0]]] : memref<3x1xi32>
 // CHECK:           %[[IDX:.+]] = arith.index_cast %[[T2]] : i32 to index
@@ -237,8 +247,7 @@ func.func @scatter_add_slice_2D(
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[C2:.+]] = arith.constant 2 : index
-// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[C2]] step %[[C1]] {
-// CHECK:           scf.for %[[J:.+]] = %[[C0]] to %[[C3]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[I:.+]], %[[J:.+]]) = (%[[C0]], %[[C0]]) to (%[[C2]], %[[C3]]) step (%[[C1]], %[[C1]]) {
 // CHECK:             %[[UPDATEVAL:.+]] = memref.load %[[UPDATES]][%[[I]], %[[J]]]
 // CHECK:             %[[INDEXVAL:.+]] = memref.load %[[INDICES]][%[[I]], %[[C0]]]
 // CHECK:             %[[INDEX:.+]] = arith.index_cast %[[INDEXVAL]] : i32 to index
@@ -266,7 +275,7 @@ func.func @scatter_update_scalar_dynamic_1D(
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[UB:.+]] = memref.dim %[[UPDATES]], %[[C0]] : memref<?xi32>
-// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[UB]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[I:.+]]) = (%[[C0]]) to (%[[UB]]) step (%[[C1]]) {
 // CHECK:           %[[T1:.+]] = memref.load %[[UPDATES]][%[[I]]] : memref<?xi32>
 // CHECK:           %[[T2:.+]] =  memref.load %[[INDICES]][%[[I]], %[[C0]]] : memref<?x1xi32>
 // CHECK:           %[[IDX:.+]] = arith.index_cast %[[T2]] : i32 to index
@@ -293,7 +302,7 @@ func.func @scatter_add_scalar_dynamic_2D(
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[UB:.+]] = memref.dim %[[UPDATES]], %[[C0]] : memref<?xi32>
-// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[UB]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[I:.+]]) = (%[[C0]]) to (%[[UB]]) step (%[[C1]]) {
 // CHECK:           %[[T1:.+]] = memref.load %[[UPDATES]][%[[I]]] : memref<?xi32>
 // CHECK:           %[[T2:.+]] = memref.load %[[INDICES]][%[[I]], %[[C0]]] : memref<?x2xi32>
 // CHECK:           %[[IDX1:.+]] = arith.index_cast %[[T2]] : i32 to index
@@ -324,8 +333,7 @@ func.func @scatter_update_slice_dynamic_2D(
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[UB1:.+]] = memref.dim %[[UPDATES]], %[[C0]] : memref<?x?xi32>
 // CHECK-DAG:     %[[UB2:.+]] = memref.dim %[[UPDATES]], %[[C1]] : memref<?x?xi32>
-// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[UB1]] step %[[C1]] {
-// CHECK:           scf.for %[[J:.+]] = %[[C0]] to %[[UB2]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[I:.+]], %[[J:.+]]) = (%[[C0]], %[[C0]]) to (%[[UB1]], %[[UB2]]) step (%[[C1]], %[[C1]]) {
 // CHECK:             %[[UPDATEVAL:.+]] = memref.load %[[UPDATES]][%[[I]], %[[J]]]
 // CHECK:             %[[INDEXVAL:.+]] = memref.load %[[INDICES]][%[[I]], %[[C0]]]
 // CHECK:             %[[INDEX:.+]] = arith.index_cast %[[INDEXVAL]] : i32 to index
@@ -352,9 +360,7 @@ func.func @scatter_partial_slices(%arg0: memref<2x64x12xf32>, %arg1: memref<2x3x
 // CHECK-DAG:     %[[C1:.+]] = arith.constant
 // CHECK-DAG:     %[[C2:.+]] = arith.constant
 // CHECK-DAG:     %[[C12:.+]] = arith.constant
-// CHECK:         scf.for %[[ARG3:.+]] = %[[C0]] to %[[C2]] step %[[C1]] {
-// CHECK-NEXT:       scf.for %[[ARG4:.+]] = %[[C0]] to %[[C1]] step %[[C1]] {
-// CHECK-NEXT:         scf.for %[[ARG5:.+]] = %[[C0]] to %[[C12]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[ARG3:.+]], %[[ARG4:.+]], %[[ARG5:.+]]) = (%[[C0]], %[[C0]], %[[C0]]) to (%[[C2]], %[[C1]], %[[C12]]) step (%[[C1]], %[[C1]], %[[C1]]) {
 // CHECK-NEXT:           %[[LOAD0:.+]] = memref.load %[[ARG1]][%[[ARG3]], %[[C0]]] : memref<2x3xi32>
 // CHECK-NEXT:           %[[CAST0:.+]] = arith.index_cast %[[LOAD0]] : i32 to index
 // CHECK-NEXT:           %[[LOAD1:.+]] = memref.load %[[ARG1]][%[[ARG3]], %[[C1]]] : memref<2x3xi32>
@@ -365,3 +371,245 @@ func.func @scatter_partial_slices(%arg0: memref<2x64x12xf32>, %arg1: memref<2x3x
 // CHECK-NEXT:           %[[ADD2:.+]] = arith.addi %[[CAST2]], %[[ARG5]] : index
 // CHECK-NEXT:           %[[LOAD3:.+]] = memref.load %[[ARG0]][%[[CAST0]], %[[ADD1]], %[[ADD2]]] : memref<2x64x12xf32>
 // CHECK-NEXT:           memref.store %[[LOAD3]], %[[ARG0]][%[[CAST0]], %[[ADD1]], %[[ADD2]]] : memref<2x64x12xf32>
+
+// -----
+
+func.func @scatter_add_repeated_indices(
+    %original: memref<8x16xf32>, %indices: memref<100x1xi32>,
+    %updates: memref<100x16xf32>) {
+  tm_tensor.scatter unique_indices(false)
+    ins(%updates, %indices : memref<100x16xf32>, memref<100x1xi32>)
+    outs(%original : memref<8x16xf32>)  {
+  ^bb0(%arg0: f32, %arg1: f32):
+    %0 = arith.addf %arg1, %arg0 : f32
+    tm_tensor.yield %0 : f32
+  }
+  return
+}
+// Additions at repeated indices are applied atomically from parallel loops.
+// CHECK-LABEL: func.func @scatter_add_repeated_indices
+// CHECK-SAME:    %[[ORIGINAL:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[INDICES:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[UPDATES:[a-zA-Z0-9]+]]
+// CHECK:         scf.parallel (%[[I:.+]], %[[J:.+]]) =
+// CHECK:           %[[UPDATE:.+]] = memref.load %[[UPDATES]][%[[I]], %[[J]]]
+// CHECK:           %[[INDEXVAL:.+]] = memref.load %[[INDICES]][%[[I]], %{{.+}}]
+// CHECK:           %[[INDEX:.+]] = arith.index_cast %[[INDEXVAL]] : i32 to index
+// CHECK:           memref.atomic_rmw addf %[[UPDATE]], %[[ORIGINAL]][%[[INDEX]], %[[J]]] : (f32, memref<8x16xf32>) -> f32
+
+// -----
+
+func.func @scatter_update_repeated_indices(
+    %original: memref<8x16xf32>, %indices: memref<100x1xi32>,
+    %updates: memref<100x16xf32>) {
+  tm_tensor.scatter unique_indices(false)
+    ins(%updates, %indices : memref<100x16xf32>, memref<100x1xi32>)
+    outs(%original : memref<8x16xf32>)  {
+  ^bb0(%arg0: f32, %arg1: f32):
+    tm_tensor.yield %arg0 : f32
+  }
+  return
+}
+// Other updates at repeated indices are applied in order, but the elements of
+// each slice are updated in parallel.
+// CHECK-LABEL: func.func @scatter_update_repeated_indices
+// CHECK-SAME:    %[[ORIGINAL:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[INDICES:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[UPDATES:[a-zA-Z0-9]+]]
+// CHECK:         scf.for %[[I:.+]] =
+// CHECK:           scf.parallel (%[[J:.+]]) =
+// CHECK:             %[[UPDATE:.+]] = memref.load %[[UPDATES]][%[[I]], %[[J]]]
+// CHECK:             %[[INDEXVAL:.+]] = memref.load %[[INDICES]][%[[I]], %{{.+}}]
+// CHECK:             %[[INDEX:.+]] = arith.index_cast %[[INDEXVAL]] : i32 to index
+// CHECK:             memref.store %[[UPDATE]], %[[ORIGINAL]][%[[INDEX]], %[[J]]]
+
+// -----
+
+func.func @attention(%arg0: memref<2x128x16xf32>, %arg1: memref<2x256x16xf32>,
+                     %arg2: memref<2x256x8xf32>, %arg3: memref<2x128x8xf32>) {
+  tm_tensor.attention ins(%arg0, %arg1, %arg2 : memref<2x128x16xf32>, memref<2x256x16xf32>, memref<2x256x8xf32>) outs(%arg3 : memref<2x128x8xf32>)
+  return
+}
+
+// The scores are only ever computed for a 32x64 tile of queries and keys.
+// CHECK-LABEL: func.func @attention
+// CHECK-SAME:    %[[QUERY:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[KEY:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[VALUE:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[OUTPUT:[a-zA-Z0-9]+]]
+// CHECK-NOT:     memref<2x128x256xf32>
+// CHECK-DAG:     %[[C32:.+]] = arith.constant 32 : index
+// CHECK-DAG:     %[[C64:.+]] = arith.constant 64 : index
+// CHECK:         scf.for %[[B:.+]] = %{{.+}} to %{{.+}} step %{{.+}} {
+// CHECK:           %[[SCORES:.+]] = memref.alloc() : memref<32x64xf32>
+// CHECK:           %[[MAX:.+]] = memref.alloc() : memref<32xf32>
+// CHECK:           %[[SUM:.+]] = memref.alloc() : memref<32xf32>
+// CHECK:           scf.for %[[ROWS:.+]] = %{{.+}} to %{{.+}} step %[[C32]] {
+// CHECK:             scf.for %[[COLS:.+]] = %{{.+}} to %{{.+}} step %[[C64]] {
+// CHECK:               memref.load %[[QUERY]][%[[B]], %{{.+}}, %{{.+}}] : memref<2x128x16xf32>
+// CHECK:               memref.load %[[KEY]][%[[B]], %{{.+}}, %{{.+}}] : memref<2x256x16xf32>
+// CHECK:               memref.store %{{.+}}, %[[SCORES]]
+// CHECK:               arith.maxf
+// CHECK:               math.exp
+// CHECK:               memref.store %{{.+}}, %[[MAX]]
+// CHECK:               memref.store %{{.+}}, %[[SUM]]
+// CHECK:               memref.load %[[VALUE]][%[[B]], %{{.+}}, %{{.+}}] : memref<2x256x8xf32>
+// CHECK:               memref.store %{{.+}}, %[[OUTPUT]][%[[B]], %{{.+}}, %{{.+}}] : memref<2x128x8xf32>
+// CHECK:             arith.divf
+// CHECK:           memref.dealloc %[[SCORES]]
+// CHECK-NOT:     memref<2x128x256xf32>
+
+// -----
+
+func.func @attention_causal(%arg0: memref<4x64x8xf32>, %arg1: memref<4x64x8xf32>,
+                            %arg2: memref<4x64x8xf32>, %arg3: memref<4x64x8xf32>) {
+  tm_tensor.attention {is_causal = true, scale = 5.000000e-01 : f64} ins(%arg0, %arg1, %arg2 : memref<4x64x8xf32>, memref<4x64x8xf32>, memref<4x64x8xf32>) outs(%arg3 : memref<4x64x8xf32>)
+  return
+}
+
+// The key loop stops after the last query of the tile, and later keys within
+// the tile are masked out.
+// CHECK-LABEL: func.func @attention_causal
+// CHECK-DAG:     %[[SCALE:.+]] = arith.constant 5.000000e-01 : f32
+// CHECK-DAG:     %[[NEG_INF:.+]] = arith.constant 0xFF800000 : f32
+// CHECK:         scf.for %[[ROWS:.+]] = %{{.+}} to %{{.+}} step %{{.+}} {
+// CHECK:           %[[ROW_END:.+]] = arith.minsi
+// CHECK:           %[[KEY_END:.+]] = arith.minsi %[[ROW_END]]
+// CHECK:           scf.for %[[COLS:.+]] = %{{.+}} to %[[KEY_END]] step %{{.+}} {
+// CHECK:             arith.mulf %{{.+}}, %[[SCALE]] : f32
+// CHECK:             %[[MASKED:.+]] = arith.cmpi ugt
+// CHECK:             arith.select %[[MASKED]], %[[NEG_INF]], %{{.+}} : f32
+
+// -----
+
+func.func @attention_mask(%arg0: memref<2x4x64x8xf32>, %arg1: memref<2x4x128x8xf32>,
+                          %arg2: memref<2x4x128x8xf32>, %arg3: memref<2x1x64x128xi1>,
+                          %arg4: memref<2x4x64x8xf32>) {
+  tm_tensor.attention ins(%arg0, %arg1, %arg2, %arg3 : memref<2x4x64x8xf32>, memref<2x4x128x8xf32>, memref<2x4x128x8xf32>, memref<2x1x64x128xi1>) outs(%arg4 : memref<2x4x64x8xf32>)
+  return
+}
+
+// The mask is broadcast along its dims of size 1, and the running max of a
+// row whose keys are all masked out so far is not subtracted.
+// CHECK-LABEL: func.func @attention_mask
+// CHECK-SAME:    %[[QUERY:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[KEY:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[VALUE:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[MASK:[a-zA-Z0-9]+]]
+// CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG:     %[[ZERO:.+]] = arith.constant 0.000000e+00 : f32
+// CHECK-DAG:     %[[NEG_INF:.+]] = arith.constant 0xFF800000 : f32
+// CHECK:         scf.for %[[B:.+]] = %{{.+}} to %{{.+}} step %{{.+}} {
+// CHECK:           scf.for %[[H:.+]] = %{{.+}} to %{{.+}} step %{{.+}} {
+// CHECK:             %[[KEEP:.+]] = memref.load %[[MASK]][%[[B]], %[[C0]], %{{.+}}, %{{.+}}] : memref<2x1x64x128xi1>
+// CHECK:             arith.select %[[KEEP]], %{{.+}}, %[[NEG_INF]] : f32
+// CHECK:             %[[IS_NEG_INF:.+]] = arith.cmpf oeq, %[[MAX:.+]], %[[NEG_INF]]
+// CHECK:             %[[SUBTRACTED:.+]] = arith.select %[[IS_NEG_INF]], %[[ZERO]], %[[MAX]]
+// CHECK:             arith.subf %{{.+}}, %[[SUBTRACTED]]
+
+// -----
+
+func.func @varlen_attention(%arg0: memref<10x2x16xf32>, %arg1: memref<12x2x16xf32>,
+                            %arg2: memref<12x2x8xf32>, %arg3: memref<4xi32>,
+                            %arg4: memref<4xi32>, %arg5: memref<10x2x8xf32>) {
+  tm_tensor.varlen_attention ins(%arg0, %arg1, %arg2, %arg3, %arg4 : memref<10x2x16xf32>, memref<12x2x16xf32>, memref<12x2x8xf32>, memref<4xi32>, memref<4xi32>) outs(%arg5 : memref<10x2x8xf32>)
+  return
+}
+
+// Each sequence only loops over its own queries and keys, from their offsets
+// in the packed tokens.
+// CHECK-LABEL: func.func @varlen_attention
+// CHECK-SAME:    %[[QUERY:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[KEY:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[VALUE:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[CU_Q:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[CU_K:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[OUTPUT:[a-zA-Z0-9]+]]
+// CHECK:         scf.for %[[SEQ:.+]] = %{{.+}} to %{{.+}} step %{{.+}} {
+// CHECK:           scf.for %[[HEAD:.+]] = %{{.+}} to %{{.+}} step %{{.+}} {
+// CHECK:             %[[NEXT:.+]] = arith.addi %[[SEQ]]
+// CHECK:             %[[Q_BEGIN_I32:.+]] = memref.load %[[CU_Q]][%[[SEQ]]] : memref<4xi32>
+// CHECK:             %[[Q_BEGIN:.+]] = arith.index_cast %[[Q_BEGIN_I32]] : i32 to index
+// CHECK:             %[[Q_END_I32:.+]] = memref.load %[[CU_Q]][%[[NEXT]]] : memref<4xi32>
+// CHECK:             %[[Q_END:.+]] = arith.index_cast %[[Q_END_I32]] : i32 to index
+// CHECK:             %[[Q_LENGTH:.+]] = arith.subi %[[Q_END]], %[[Q_BEGIN]]
+// CHECK:             memref.load %[[CU_K]][%[[SEQ]]] : memref<4xi32>
+// CHECK:             scf.for %[[ROWS:.+]] = %{{.+}} to %[[Q_LENGTH]] step %{{.+}} {
+// CHECK:               scf.for %[[COLS:.+]] = %{{.+}} to %{{.+}} step %{{.+}} {
+// CHECK:                 %[[ROW:.+]] = arith.addi %[[Q_BEGIN]], %{{.+}}
+// CHECK:                 memref.load %[[QUERY]][%[[ROW]], %[[HEAD]], %{{.+}}] : memref<10x2x16xf32>
+// CHECK:                 memref.load %[[KEY]][%{{.+}}, %[[HEAD]], %{{.+}}] : memref<12x2x16xf32>
+// CHECK:                 memref.load %[[VALUE]][%{{.+}}, %[[HEAD]], %{{.+}}] : memref<12x2x8xf32>
+// CHECK:                 memref.store %{{.+}}, %[[OUTPUT]][%{{.+}}, %[[HEAD]], %{{.+}}] : memref<10x2x8xf32>
+
+// -----
+
+func.func @varlen_attention_paged(%arg0: memref<3x2x16xf32>, %arg1: memref<8x4x2x16xf32>,
+                                  %arg2: memref<8x4x2x16xf32>, %arg3: memref<4xi64>,
+                                  %arg4: memref<4xi64>, %arg5: memref<3x2xi32>,
+                                  %arg6: memref<3x2x16xf32>) {
+  tm_tensor.varlen_attention {is_causal = true} ins(%arg0, %arg1, %arg2, %arg3, %arg4, %arg5 : memref<3x2x16xf32>, memref<8x4x2x16xf32>, memref<8x4x2x16xf32>, memref<4xi64>, memref<4xi64>, memref<3x2xi32>) outs(%arg6 : memref<3x2x16xf32>)
+  return
+}
+
+// The keys are looked up in the blocks of the sequence, and the last query is
+// aligned with the last key.
+// CHECK-LABEL: func.func @varlen_attention_paged
+// CHECK-SAME:    %[[QUERY:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[KEY:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[VALUE:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[CU_Q:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[CU_K:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[BLOCK_TABLE:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[OUTPUT:[a-zA-Z0-9]+]]
+// CHECK-DAG:     %[[C4:.+]] = arith.constant 4 : index
+// CHECK:         scf.for %[[SEQ:.+]] = %{{.+}} to %{{.+}} step %{{.+}} {
+// CHECK:           scf.for %[[HEAD:.+]] = %{{.+}} to %{{.+}} step %{{.+}} {
+// CHECK:             %[[Q_LENGTH:.+]] = arith.subi
+// CHECK:             %[[K_LENGTH:.+]] = arith.subi
+// CHECK:             %[[OFFSET:.+]] = arith.subi %[[K_LENGTH]], %[[Q_LENGTH]]
+// CHECK:             scf.for %[[COLS:.+]] = %{{.+}} to %{{.+}} step %{{.+}} {
+// CHECK:               %[[BLOCK_INDEX:.+]] = arith.divui %[[COL:[a-zA-Z0-9_]+]], %[[C4]]
+// CHECK:               %[[BLOCK_I32:.+]] = memref.load %[[BLOCK_TABLE]][%[[SEQ]], %[[BLOCK_INDEX]]] : memref<3x2xi32>
+// CHECK:               %[[BLOCK:.+]] = arith.index_cast %[[BLOCK_I32]] : i32 to index
+// CHECK:               %[[SLOT:.+]] = arith.remui %[[COL]], %[[C4]]
+// CHECK:               memref.load %[[KEY]][%[[BLOCK]], %[[SLOT]], %[[HEAD]], %{{.+}}] : memref<8x4x2x16xf32>
+// CHECK:               arith.cmpi ugt
+
+// -----
+
+func.func @sort_2d(%arg0: memref<4x1000xf32>, %arg1: memref<4x1000xi64>) {
+  tm_tensor.sort dimension(1) outs(%arg0, %arg1 : memref<4x1000xf32>, memref<4x1000xi64>) {
+  ^bb0(%arg2: f32, %arg3: f32, %arg4: i64, %arg5: i64):
+    %0 = arith.cmpf ole, %arg2, %arg3 : f32
+    tm_tensor.yield %0 : i1
+  }
+  return
+}
+
+// The rows are sorted in parallel with a bottom-up merge sort, which merges
+// runs back and forth between the operands and scratch buffers.
+// CHECK-LABEL: func.func @sort_2d
+// CHECK-SAME:      %[[VALUES:[a-zA-Z0-9_]+]]
+// CHECK-SAME:      %[[INDICES:[a-zA-Z0-9_]+]]
+// CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[FALSE:.+]] = arith.constant false
+// CHECK-DAG:     %[[C1000:.+]] = arith.constant 1000 : index
+// CHECK:         %[[VALUES_SCRATCH:.+]] = memref.alloc() : memref<4x1000xf32>
+// CHECK:         %[[INDICES_SCRATCH:.+]] = memref.alloc() : memref<4x1000xi64>
+// CHECK:         scf.parallel (%[[ROW:.+]]) =
+// CHECK:           %[[RESULT:.+]]:2 = scf.while (%[[WIDTH:.+]] = %[[C1]], %[[IN_SCRATCH:.+]] = %[[FALSE]])
+// CHECK:             arith.cmpi ult, %[[WIDTH]], %[[C1000]]
+// CHECK:           } do {
+// CHECK:             %[[SRC:.+]] = arith.select %{{.+}}, %[[VALUES_SCRATCH]], %[[VALUES]] : memref<4x1000xf32>
+// CHECK:             %[[DST:.+]] = arith.select %{{.+}}, %[[VALUES]], %[[VALUES_SCRATCH]] : memref<4x1000xf32>
+// CHECK:             scf.parallel
+// CHECK:               scf.for %[[K:.+]] = %{{.+}} to %{{.+}} step %[[C1]] iter_args(%[[LEFT:.+]] = %{{.+}}, %[[RIGHT:.+]] = %{{.+}}) -> (index, index) {
+// CHECK:                 %[[TAKE_RIGHT:.+]] = scf.if %{{.+}} -> (i1) {
+// CHECK:                   arith.cmpf ole
+// CHECK:                 %[[NEXT:.+]] = arith.select %[[TAKE_RIGHT]], %[[RIGHT]], %[[LEFT]] : index
+// CHECK:                 %[[V:.+]] = memref.load %[[SRC]][%[[ROW]], %[[NEXT]]]
+// CHECK:                 memref.store %[[V]], %[[DST]][%[[ROW]], %[[K]]]
+// CHECK:           scf.if %[[RESULT]]#1 {
+// CHECK:         memref.dealloc %[[VALUES_SCRATCH]]
+// CHECK:         memref.dealloc %[[INDICES_SCRATCH]]
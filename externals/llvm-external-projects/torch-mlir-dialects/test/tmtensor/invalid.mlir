@@ -326,3 +326,43 @@ func.func @scatter_original_rank_mismatch(
     } -> tensor<?x?xi64>
   return %0 : tensor<?x?xi64>
 }
+
+// -----
+
+func.func @varlen_attention_head_dim_mismatch(
+    %query : tensor<?x2x16xf32>, %key : tensor<?x2x8xf32>,
+    %value : tensor<?x2x8xf32>, %cu_seqlens_q : tensor<4xi32>,
+    %cu_seqlens_k : tensor<4xi32>, %init : tensor<?x2x8xf32>) -> tensor<?x2x8xf32> {
+  // expected-error @+1 {{op query and key head dimension mismatch}}
+  %0 = tm_tensor.varlen_attention
+    ins(%query, %key, %value, %cu_seqlens_q, %cu_seqlens_k : tensor<?x2x16xf32>, tensor<?x2x8xf32>, tensor<?x2x8xf32>, tensor<4xi32>, tensor<4xi32>)
+    outs(%init : tensor<?x2x8xf32>) -> tensor<?x2x8xf32>
+  return %0 : tensor<?x2x8xf32>
+}
+
+// -----
+
+func.func @varlen_attention_block_table_mismatch(
+    %query : tensor<?x2x16xf32>, %key : tensor<8x4x2x16xf32>,
+    %value : tensor<8x4x2x16xf32>, %cu_seqlens_q : tensor<4xi32>,
+    %cu_seqlens_k : tensor<4xi32>, %block_table : tensor<2x2xi32>,
+    %init : tensor<?x2x16xf32>) -> tensor<?x2x16xf32> {
+  // expected-error @+1 {{op block table and number of sequences mismatch}}
+  %0 = tm_tensor.varlen_attention
+    ins(%query, %key, %value, %cu_seqlens_q, %cu_seqlens_k, %block_table : tensor<?x2x16xf32>, tensor<8x4x2x16xf32>, tensor<8x4x2x16xf32>, tensor<4xi32>, tensor<4xi32>, tensor<2x2xi32>)
+    outs(%init : tensor<?x2x16xf32>) -> tensor<?x2x16xf32>
+  return %0 : tensor<?x2x16xf32>
+}
+
+// -----
+
+func.func @attention_mask_broadcast_mismatch(
+    %query : tensor<2x16x8xf32>, %key : tensor<2x32x8xf32>,
+    %value : tensor<2x32x8xf32>, %mask : tensor<16x16xf32>,
+    %init : tensor<2x16x8xf32>) -> tensor<2x16x8xf32> {
+  // expected-error @+1 {{op mask does not broadcast to the scores}}
+  %0 = tm_tensor.attention
+    ins(%query, %key, %value, %mask : tensor<2x16x8xf32>, tensor<2x32x8xf32>, tensor<2x32x8xf32>, tensor<16x16xf32>)
+    outs(%init : tensor<2x16x8xf32>) -> tensor<2x16x8xf32>
+  return %0 : tensor<2x16x8xf32>
+}
@@ -0,0 +1,85 @@
+// RUN: torch-mlir-dialects-opt -split-input-file -one-shot-bufferize="bufferize-function-boundaries function-boundary-type-conversion=identity-layout-map" %s | FileCheck %s
+
+// The destination of the scatter is updated in place.
+// CHECK-LABEL:   func.func @scatter_in_place(
+// CHECK-SAME:            %[[ORIG:.*]]: memref<8xi32>, %[[INDICES:.*]]: memref<3x1xi32>,
+// CHECK-SAME:            %[[UPDATES:.*]]: memref<3xi32>) -> memref<8xi32> {
+// CHECK-NOT:       memref.alloc
+// CHECK-NOT:       memref.copy
+// CHECK:           tm_tensor.scatter unique_indices(true) ins(%[[UPDATES]], %[[INDICES]]
+// CHECK-SAME:        : memref<3xi32>, memref<3x1xi32>) outs(%[[ORIG]] : memref<8xi32>) {
+// CHECK:           return %[[ORIG]] : memref<8xi32>
+func.func @scatter_in_place(
+    %original: tensor<8xi32>, %indices: tensor<3x1xi32>,
+    %updates: tensor<3xi32>) -> tensor<8xi32> {
+  %0 = tm_tensor.scatter unique_indices(true)
+    ins(%updates, %indices : tensor<3xi32>, tensor<3x1xi32>)
+    outs(%original : tensor<8xi32>)  {
+  ^bb0(%update: i32, %orig: i32):
+    tm_tensor.yield %update: i32
+  } -> tensor<8xi32>
+  return %0 : tensor<8xi32>
+}
+
+// -----
+
+// The values and indices are sorted in place.
+// CHECK-LABEL:   func.func @sort_in_place(
+// CHECK-SAME:            %[[VALUES:.*]]: memref<4x8xf32>, %[[INDICES:.*]]: memref<4x8xi64>) -> (memref<4x8xf32>, memref<4x8xi64>) {
+// CHECK-NOT:       memref.alloc
+// CHECK-NOT:       memref.copy
+// CHECK:           tm_tensor.sort dimension(1) outs(%[[VALUES]], %[[INDICES]] : memref<4x8xf32>, memref<4x8xi64>) {
+// CHECK:           return %[[VALUES]], %[[INDICES]] : memref<4x8xf32>, memref<4x8xi64>
+func.func @sort_in_place(%values: tensor<4x8xf32>, %indices: tensor<4x8xi64>) -> (tensor<4x8xf32>, tensor<4x8xi64>) {
+  %0:2 = tm_tensor.sort dimension(1) outs(%values, %indices : tensor<4x8xf32>, tensor<4x8xi64>) {
+  ^bb0(%lhs: f32, %rhs: f32, %lhs_index: i64, %rhs_index: i64):
+    %1 = arith.cmpf ole, %lhs, %rhs : f32
+    tm_tensor.yield %1 : i1
+  } -> tensor<4x8xf32>, tensor<4x8xi64>
+  return %0#0, %0#1 : tensor<4x8xf32>, tensor<4x8xi64>
+}
+
+// -----
+
+// The output and the accumulator of the scan are written in place.
+// CHECK-LABEL:   func.func @scan_in_place(
+// CHECK-SAME:            %[[IN:.*]]: memref<128xi32>, %[[OUT:.*]]: memref<128xi32>,
+// CHECK-SAME:            %[[ACC:.*]]: memref<i32>) -> (memref<128xi32>, memref<i32>) {
+// CHECK-NOT:       memref.alloc
+// CHECK-NOT:       memref.copy
+// CHECK:           tm_tensor.scan dimension(0) inclusive(false) ins(%[[IN]] : memref<128xi32>)
+// CHECK-SAME:        outs(%[[OUT]], %[[ACC]] : memref<128xi32>, memref<i32>) {
+// CHECK:           return %[[OUT]], %[[ACC]] : memref<128xi32>, memref<i32>
+func.func @scan_in_place(%in: tensor<128xi32>, %out: tensor<128xi32>, %acc: tensor<i32>) -> (tensor<128xi32>, tensor<i32>) {
+  %ret_out, %ret_acc = tm_tensor.scan dimension(0) inclusive(false)
+    ins(%in : tensor<128xi32>) outs(%out, %acc: tensor<128xi32>, tensor<i32>) {
+    ^bb0(%arg0 : i32, %arg1 : i32):
+      %sum = arith.addi %arg0, %arg1 : i32
+      tm_tensor.yield %sum : i32
+  } -> tensor<128xi32>, tensor<i32>
+  return %ret_out, %ret_acc: tensor<128xi32>, tensor<i32>
+}
+
+// -----
+
+// The destination of the scatter is still read by the subtraction after the
+// scatter, so the scatter updates a copy of it.
+// CHECK-LABEL:   func.func @scatter_copy_of_live_destination(
+// CHECK-SAME:            %[[ORIG:.*]]: memref<8xi32>, %[[INDICES:.*]]: memref<3x1xi32>,
+// CHECK-SAME:            %[[UPDATES:.*]]: memref<3xi32>) -> (memref<8xi32>, memref<8xi32>) {
+// CHECK:           %[[COPY:.*]] = memref.alloc() {{.*}} : memref<8xi32>
+// CHECK:           memref.copy %[[ORIG]], %[[COPY]] : memref<8xi32> to memref<8xi32>
+// CHECK:           tm_tensor.scatter unique_indices(true) ins(%[[UPDATES]], %[[INDICES]]
+// CHECK-SAME:        : memref<3xi32>, memref<3x1xi32>) outs(%[[COPY]] : memref<8xi32>) {
+// CHECK:           return %[[COPY]], %[[ORIG]] : memref<8xi32>, memref<8xi32>
+func.func @scatter_copy_of_live_destination(
+    %original: tensor<8xi32>, %indices: tensor<3x1xi32>,
+    %updates: tensor<3xi32>) -> (tensor<8xi32>, tensor<8xi32>) {
+  %0 = tm_tensor.scatter unique_indices(true)
+    ins(%updates, %indices : tensor<3xi32>, tensor<3x1xi32>)
+    outs(%original : tensor<8xi32>)  {
+  ^bb0(%update: i32, %orig: i32):
+    tm_tensor.yield %update: i32
+  } -> tensor<8xi32>
+  return %0, %original : tensor<8xi32>, tensor<8xi32>
+}
@@ -0,0 +1,186 @@
+// RUN: torch-mlir-dialects-opt -split-input-file -tm-tensor-tile="tile-sizes=2" -canonicalize -scf-for-loop-canonicalization -canonicalize %s | FileCheck %s
+// RUN: torch-mlir-dialects-opt -split-input-file -tm-tensor-tile="tile-sizes=0,2" -canonicalize -scf-for-loop-canonicalization -canonicalize %s | FileCheck %s --check-prefix=INNER
+
+// The rows of the indices follow the tile of the updates, which can write
+// anywhere in the original.
+// CHECK-LABEL: func.func @scatter_2d(
+// CHECK-SAME:      %[[ORIGINAL:.*]]: tensor<8x16xf32>, %[[INDICES:.*]]: tensor<4x1xi32>, %[[UPDATES:.*]]: tensor<4x16xf32>)
+// CHECK-DAG:     %[[C0:.*]] = arith.constant 0 : index
+// CHECK-DAG:     %[[C2:.*]] = arith.constant 2 : index
+// CHECK-DAG:     %[[C4:.*]] = arith.constant 4 : index
+// CHECK:         %[[RESULT:.*]] = scf.for %[[IV:.*]] = %[[C0]] to %[[C4]] step %[[C2]] iter_args(%[[ACC:.*]] = %[[ORIGINAL]]) -> (tensor<8x16xf32>) {
+// CHECK:           %[[UPDATES_TILE:.*]] = tensor.extract_slice %[[UPDATES]][%[[IV]], 0] [2, 16] [1, 1] : tensor<4x16xf32> to tensor<2x16xf32>
+// CHECK:           %[[INDICES_TILE:.*]] = tensor.extract_slice %[[INDICES]][%[[IV]], 0] [2, 1] [1, 1] : tensor<4x1xi32> to tensor<2x1xi32>
+// CHECK:           %[[SCATTER:.*]] = tm_tensor.scatter unique_indices(true) ins(%[[UPDATES_TILE]], %[[INDICES_TILE]] : tensor<2x16xf32>, tensor<2x1xi32>) outs(%[[ACC]] : tensor<8x16xf32>)
+// CHECK:             arith.addf
+// CHECK:           } -> tensor<8x16xf32>
+// CHECK:           scf.yield %[[SCATTER]] : tensor<8x16xf32>
+// CHECK:         return %[[RESULT]] : tensor<8x16xf32>
+
+// The trailing dims of the original follow the tile of the updates, and all
+// the indices are used by each tile.
+// INNER-LABEL: func.func @scatter_2d(
+// INNER-SAME:      %[[ORIGINAL:.*]]: tensor<8x16xf32>, %[[INDICES:.*]]: tensor<4x1xi32>, %[[UPDATES:.*]]: tensor<4x16xf32>)
+// INNER-DAG:     %[[C0:.*]] = arith.constant 0 : index
+// INNER-DAG:     %[[C2:.*]] = arith.constant 2 : index
+// INNER-DAG:     %[[C16:.*]] = arith.constant 16 : index
+// INNER:         %[[RESULT:.*]] = scf.for %[[IV:.*]] = %[[C0]] to %[[C16]] step %[[C2]] iter_args(%[[ACC:.*]] = %[[ORIGINAL]]) -> (tensor<8x16xf32>) {
+// INNER:           %[[UPDATES_TILE:.*]] = tensor.extract_slice %[[UPDATES]][0, %[[IV]]] [4, 2] [1, 1] : tensor<4x16xf32> to tensor<4x2xf32>
+// INNER:           %[[ORIGINAL_TILE:.*]] = tensor.extract_slice %[[ACC]][0, %[[IV]]] [8, 2] [1, 1] : tensor<8x16xf32> to tensor<8x2xf32>
+// INNER:           %[[SCATTER:.*]] = tm_tensor.scatter unique_indices(true) ins(%[[UPDATES_TILE]], %[[INDICES]] : tensor<4x2xf32>, tensor<4x1xi32>) outs(%[[ORIGINAL_TILE]] : tensor<8x2xf32>)
+// INNER:           } -> tensor<8x2xf32>
+// INNER:           %[[INSERT:.*]] = tensor.insert_slice %[[SCATTER]] into %[[ACC]][0, %[[IV]]] [8, 2] [1, 1] : tensor<8x2xf32> into tensor<8x16xf32>
+// INNER:           scf.yield %[[INSERT]] : tensor<8x16xf32>
+// INNER:         return %[[RESULT]] : tensor<8x16xf32>
+func.func @scatter_2d(%original: tensor<8x16xf32>, %indices: tensor<4x1xi32>,
+                      %updates: tensor<4x16xf32>) -> tensor<8x16xf32> {
+  %0 = tm_tensor.scatter unique_indices(true)
+    ins(%updates, %indices : tensor<4x16xf32>, tensor<4x1xi32>)
+    outs(%original : tensor<8x16xf32>) {
+  ^bb0(%update: f32, %orig: f32):
+    %1 = arith.addf %orig, %update : f32
+    tm_tensor.yield %1 : f32
+  } -> tensor<8x16xf32>
+  return %0 : tensor<8x16xf32>
+}
+
+// -----
+
+// Each tile sorts whole slices along the sorted dim.
+// CHECK-LABEL: func.func @sort_3d(
+// CHECK-SAME:      %[[VALUES:.*]]: tensor<4x8x1000xf32>, %[[INDICES:.*]]: tensor<4x8x1000xi64>)
+// CHECK-DAG:     %[[C0:.*]] = arith.constant 0 : index
+// CHECK-DAG:     %[[C2:.*]] = arith.constant 2 : index
+// CHECK-DAG:     %[[C4:.*]] = arith.constant 4 : index
+// CHECK:         %[[RESULT:.*]]:2 = scf.for %[[IV:.*]] = %[[C0]] to %[[C4]] step %[[C2]] iter_args(%[[VALUES_ACC:.*]] = %[[VALUES]], %[[INDICES_ACC:.*]] = %[[INDICES]]) -> (tensor<4x8x1000xf32>, tensor<4x8x1000xi64>) {
+// CHECK:           %[[VALUES_TILE:.*]] = tensor.extract_slice %[[VALUES_ACC]][%[[IV]], 0, 0] [2, 8, 1000] [1, 1, 1] : tensor<4x8x1000xf32> to tensor<2x8x1000xf32>
+// CHECK:           %[[INDICES_TILE:.*]] = tensor.extract_slice %[[INDICES_ACC]][%[[IV]], 0, 0] [2, 8, 1000] [1, 1, 1] : tensor<4x8x1000xi64> to tensor<2x8x1000xi64>
+// CHECK:           %[[SORT:.*]]:2 = tm_tensor.sort dimension(2) outs(%[[VALUES_TILE]], %[[INDICES_TILE]] : tensor<2x8x1000xf32>, tensor<2x8x1000xi64>)
+// CHECK:           } -> tensor<2x8x1000xf32>, tensor<2x8x1000xi64>
+// CHECK:           %[[VALUES_INSERT:.*]] = tensor.insert_slice %[[SORT]]#0 into %[[VALUES_ACC]][%[[IV]], 0, 0] [2, 8, 1000] [1, 1, 1]
+// CHECK:           %[[INDICES_INSERT:.*]] = tensor.insert_slice %[[SORT]]#1 into %[[INDICES_ACC]][%[[IV]], 0, 0] [2, 8, 1000] [1, 1, 1]
+// CHECK:           scf.yield %[[VALUES_INSERT]], %[[INDICES_INSERT]] : tensor<4x8x1000xf32>, tensor<4x8x1000xi64>
+// CHECK:         return %[[RESULT]]#0, %[[RESULT]]#1
+
+// INNER-LABEL: func.func @sort_3d(
+// INNER-SAME:      %[[VALUES:.*]]: tensor<4x8x1000xf32>, %[[INDICES:.*]]: tensor<4x8x1000xi64>)
+// INNER-DAG:     %[[C0:.*]] = arith.constant 0 : index
+// INNER-DAG:     %[[C2:.*]] = arith.constant 2 : index
+// INNER-DAG:     %[[C8:.*]] = arith.constant 8 : index
+// INNER:         scf.for %[[IV:.*]] = %[[C0]] to %[[C8]] step %[[C2]] iter_args(%[[VALUES_ACC:.*]] = %[[VALUES]], %[[INDICES_ACC:.*]] = %[[INDICES]])
+// INNER:           tensor.extract_slice %[[VALUES_ACC]][0, %[[IV]], 0] [4, 2, 1000] [1, 1, 1] : tensor<4x8x1000xf32> to tensor<4x2x1000xf32>
+// INNER:           tensor.extract_slice %[[INDICES_ACC]][0, %[[IV]], 0] [4, 2, 1000] [1, 1, 1] : tensor<4x8x1000xi64> to tensor<4x2x1000xi64>
+// INNER:           tm_tensor.sort dimension(2)
+// INNER:           } -> tensor<4x2x1000xf32>, tensor<4x2x1000xi64>
+func.func @sort_3d(%values: tensor<4x8x1000xf32>, %indices: tensor<4x8x1000xi64>)
+    -> (tensor<4x8x1000xf32>, tensor<4x8x1000xi64>) {
+  %0:2 = tm_tensor.sort dimension(2)
+    outs(%values, %indices : tensor<4x8x1000xf32>, tensor<4x8x1000xi64>) {
+  ^bb0(%arg0: f32, %arg1: f32, %arg2: i64, %arg3: i64):
+    %1 = arith.cmpf ole, %arg0, %arg1 : f32
+    tm_tensor.yield %1 : i1
+  } -> tensor<4x8x1000xf32>, tensor<4x8x1000xi64>
+  return %0#0, %0#1 : tensor<4x8x1000xf32>, tensor<4x8x1000xi64>
+}
+
+// -----
+
+// Each tile of the batch dims keeps the whole sequences, and the mask is only
+// sliced along its batch dims that aren't broadcast.
+// CHECK-LABEL: func.func @attention_4d(
+// CHECK-SAME:      %[[QUERY:[a-zA-Z0-9]+]]: tensor<4x4x64x8xf32>, %[[KEY:[a-zA-Z0-9]+]]: tensor<4x4x128x8xf32>, %[[VALUE:[a-zA-Z0-9]+]]: tensor<4x4x128x8xf32>, %[[MASK:[a-zA-Z0-9]+]]: tensor<4x1x64x128xi1>, %[[OUTPUT:[a-zA-Z0-9]+]]: tensor<4x4x64x8xf32>)
+// CHECK-DAG:     %[[C0:.*]] = arith.constant 0 : index
+// CHECK-DAG:     %[[C2:.*]] = arith.constant 2 : index
+// CHECK-DAG:     %[[C4:.*]] = arith.constant 4 : index
+// CHECK:         %[[RESULT:.*]] = scf.for %[[IV:.*]] = %[[C0]] to %[[C4]] step %[[C2]] iter_args(%[[ACC:.*]] = %[[OUTPUT]]) -> (tensor<4x4x64x8xf32>) {
+// CHECK:           %[[QUERY_TILE:.*]] = tensor.extract_slice %[[QUERY]][%[[IV]], 0, 0, 0] [2, 4, 64, 8] [1, 1, 1, 1] : tensor<4x4x64x8xf32> to tensor<2x4x64x8xf32>
+// CHECK:           %[[KEY_TILE:.*]] = tensor.extract_slice %[[KEY]][%[[IV]], 0, 0, 0] [2, 4, 128, 8] [1, 1, 1, 1] : tensor<4x4x128x8xf32> to tensor<2x4x128x8xf32>
+// CHECK:           %[[VALUE_TILE:.*]] = tensor.extract_slice %[[VALUE]][%[[IV]], 0, 0, 0] [2, 4, 128, 8] [1, 1, 1, 1] : tensor<4x4x128x8xf32> to tensor<2x4x128x8xf32>
+// CHECK:           %[[MASK_TILE:.*]] = tensor.extract_slice %[[MASK]][%[[IV]], 0, 0, 0] [2, 1, 64, 128] [1, 1, 1, 1] : tensor<4x1x64x128xi1> to tensor<2x1x64x128xi1>
+// CHECK:           %[[OUTPUT_TILE:.*]] = tensor.extract_slice %[[ACC]][%[[IV]], 0, 0, 0] [2, 4, 64, 8] [1, 1, 1, 1] : tensor<4x4x64x8xf32> to tensor<2x4x64x8xf32>
+// CHECK:           %[[ATTENTION:.*]] = tm_tensor.attention ins(%[[QUERY_TILE]], %[[KEY_TILE]], %[[VALUE_TILE]], %[[MASK_TILE]] : tensor<2x4x64x8xf32>, tensor<2x4x128x8xf32>, tensor<2x4x128x8xf32>, tensor<2x1x64x128xi1>) outs(%[[OUTPUT_TILE]] : tensor<2x4x64x8xf32>) -> tensor<2x4x64x8xf32>
+// CHECK:           %[[INSERT:.*]] = tensor.insert_slice %[[ATTENTION]] into %[[ACC]][%[[IV]], 0, 0, 0] [2, 4, 64, 8] [1, 1, 1, 1] : tensor<2x4x64x8xf32> into tensor<4x4x64x8xf32>
+// CHECK:           scf.yield %[[INSERT]] : tensor<4x4x64x8xf32>
+// CHECK:         return %[[RESULT]] : tensor<4x4x64x8xf32>
+
+// INNER-LABEL: func.func @attention_4d(
+// INNER-SAME:      %[[QUERY:[a-zA-Z0-9]+]]: tensor<4x4x64x8xf32>, %[[KEY:[a-zA-Z0-9]+]]: tensor<4x4x128x8xf32>, %[[VALUE:[a-zA-Z0-9]+]]: tensor<4x4x128x8xf32>, %[[MASK:[a-zA-Z0-9]+]]: tensor<4x1x64x128xi1>, %[[OUTPUT:[a-zA-Z0-9]+]]: tensor<4x4x64x8xf32>)
+// INNER:         scf.for %[[IV:.*]] = %{{.*}} to %{{.*}} step %{{.*}} iter_args(%[[ACC:.*]] = %[[OUTPUT]])
+// INNER:           tensor.extract_slice %[[QUERY]][0, %[[IV]], 0, 0] [4, 2, 64, 8] [1, 1, 1, 1] : tensor<4x4x64x8xf32> to tensor<4x2x64x8xf32>
+// INNER-NOT:       tensor.extract_slice %[[MASK]]
+// INNER:           tm_tensor.attention ins(%{{.*}}, %{{.*}}, %{{.*}}, %[[MASK]] : tensor<4x2x64x8xf32>, tensor<4x2x128x8xf32>, tensor<4x2x128x8xf32>, tensor<4x1x64x128xi1>) outs(%{{.*}} : tensor<4x2x64x8xf32>) -> tensor<4x2x64x8xf32>
+func.func @attention_4d(%query: tensor<4x4x64x8xf32>, %key: tensor<4x4x128x8xf32>,
+                        %value: tensor<4x4x128x8xf32>, %mask: tensor<4x1x64x128xi1>,
+                        %output: tensor<4x4x64x8xf32>) -> tensor<4x4x64x8xf32> {
+  %0 = tm_tensor.attention
+    ins(%query, %key, %value, %mask : tensor<4x4x64x8xf32>, tensor<4x4x128x8xf32>, tensor<4x4x128x8xf32>, tensor<4x1x64x128xi1>)
+    outs(%output : tensor<4x4x64x8xf32>) -> tensor<4x4x64x8xf32>
+  return %0 : tensor<4x4x64x8xf32>
+}
+
+// -----
+
+// A tile of sequences keeps the whole tokens, which the cumulative sequence
+// lengths of its sequences index, and writes its tokens into the whole
+// output.
+// CHECK-LABEL: func.func @varlen_attention(
+// CHECK-SAME:      %[[QUERY:[a-zA-Z0-9_]+]]: tensor<10x4x16xf32>, %[[KEY:[a-zA-Z0-9_]+]]: tensor<12x4x16xf32>, %[[VALUE:[a-zA-Z0-9_]+]]: tensor<12x4x8xf32>, %[[CU_SEQLENS_Q:[a-zA-Z0-9_]+]]: tensor<5xi32>, %[[CU_SEQLENS_K:[a-zA-Z0-9_]+]]: tensor<5xi32>, %[[OUTPUT:[a-zA-Z0-9_]+]]: tensor<10x4x8xf32>)
+// CHECK-DAG:     %[[C0:.*]] = arith.constant 0 : index
+// CHECK-DAG:     %[[C2:.*]] = arith.constant 2 : index
+// CHECK-DAG:     %[[C4:.*]] = arith.constant 4 : index
+// CHECK:         %[[RESULT:.*]] = scf.for %[[IV:.*]] = %[[C0]] to %[[C4]] step %[[C2]] iter_args(%[[ACC:.*]] = %[[OUTPUT]]) -> (tensor<10x4x8xf32>) {
+// CHECK:           %[[CU_SEQLENS_Q_TILE:.*]] = tensor.extract_slice %[[CU_SEQLENS_Q]][%[[IV]]] [3] [1] : tensor<5xi32> to tensor<3xi32>
+// CHECK:           %[[CU_SEQLENS_K_TILE:.*]] = tensor.extract_slice %[[CU_SEQLENS_K]][%[[IV]]] [3] [1] : tensor<5xi32> to tensor<3xi32>
+// CHECK:           %[[ATTENTION:.*]] = tm_tensor.varlen_attention ins(%[[QUERY]], %[[KEY]], %[[VALUE]], %[[CU_SEQLENS_Q_TILE]], %[[CU_SEQLENS_K_TILE]] : tensor<10x4x16xf32>, tensor<12x4x16xf32>, tensor<12x4x8xf32>, tensor<3xi32>, tensor<3xi32>) outs(%[[ACC]] : tensor<10x4x8xf32>) -> tensor<10x4x8xf32>
+// CHECK:           scf.yield %[[ATTENTION]] : tensor<10x4x8xf32>
+// CHECK:         return %[[RESULT]] : tensor<10x4x8xf32>
+
+// A tile of heads slices the heads of the tokens and of the output.
+// INNER-LABEL: func.func @varlen_attention(
+// INNER-SAME:      %[[QUERY:[a-zA-Z0-9_]+]]: tensor<10x4x16xf32>, %[[KEY:[a-zA-Z0-9_]+]]: tensor<12x4x16xf32>, %[[VALUE:[a-zA-Z0-9_]+]]: tensor<12x4x8xf32>, %[[CU_SEQLENS_Q:[a-zA-Z0-9_]+]]: tensor<5xi32>, %[[CU_SEQLENS_K:[a-zA-Z0-9_]+]]: tensor<5xi32>, %[[OUTPUT:[a-zA-Z0-9_]+]]: tensor<10x4x8xf32>)
+// INNER:         %[[RESULT:.*]] = scf.for %[[IV:.*]] = %{{.*}} to %{{.*}} step %{{.*}} iter_args(%[[ACC:.*]] = %[[OUTPUT]]) -> (tensor<10x4x8xf32>) {
+// INNER:           %[[QUERY_TILE:.*]] = tensor.extract_slice %[[QUERY]][0, %[[IV]], 0] [10, 2, 16] [1, 1, 1] : tensor<10x4x16xf32> to tensor<10x2x16xf32>
+// INNER:           %[[KEY_TILE:.*]] = tensor.extract_slice %[[KEY]][0, %[[IV]], 0] [12, 2, 16] [1, 1, 1] : tensor<12x4x16xf32> to tensor<12x2x16xf32>
+// INNER:           %[[VALUE_TILE:.*]] = tensor.extract_slice %[[VALUE]][0, %[[IV]], 0] [12, 2, 8] [1, 1, 1] : tensor<12x4x8xf32> to tensor<12x2x8xf32>
+// INNER:           %[[OUTPUT_TILE:.*]] = tensor.extract_slice %[[ACC]][0, %[[IV]], 0] [10, 2, 8] [1, 1, 1] : tensor<10x4x8xf32> to tensor<10x2x8xf32>
+// INNER:           %[[ATTENTION:.*]] = tm_tensor.varlen_attention ins(%[[QUERY_TILE]], %[[KEY_TILE]], %[[VALUE_TILE]], %[[CU_SEQLENS_Q]], %[[CU_SEQLENS_K]] : tensor<10x2x16xf32>, tensor<12x2x16xf32>, tensor<12x2x8xf32>, tensor<5xi32>, tensor<5xi32>) outs(%[[OUTPUT_TILE]] : tensor<10x2x8xf32>) -> tensor<10x2x8xf32>
+// INNER:           %[[INSERT:.*]] = tensor.insert_slice %[[ATTENTION]] into %[[ACC]][0, %[[IV]], 0] [10, 2, 8] [1, 1, 1] : tensor<10x2x8xf32> into tensor<10x4x8xf32>
+// INNER:           scf.yield %[[INSERT]] : tensor<10x4x8xf32>
+// INNER:         return %[[RESULT]] : tensor<10x4x8xf32>
+func.func @varlen_attention(%query: tensor<10x4x16xf32>, %key: tensor<12x4x16xf32>,
+                            %value: tensor<12x4x8xf32>, %cu_seqlens_q: tensor<5xi32>,
+                            %cu_seqlens_k: tensor<5xi32>, %output: tensor<10x4x8xf32>)
+    -> tensor<10x4x8xf32> {
+  %0 = tm_tensor.varlen_attention
+    ins(%query, %key, %value, %cu_seqlens_q, %cu_seqlens_k : tensor<10x4x16xf32>, tensor<12x4x16xf32>, tensor<12x4x8xf32>, tensor<5xi32>, tensor<5xi32>)
+    outs(%output : tensor<10x4x8xf32>) -> tensor<10x4x8xf32>
+  return %0 : tensor<10x4x8xf32>
+}
+
+// -----
+
+// The rows of the block table follow the tile of sequences, and the heads of
+// the paged key and value are their second to last dim.
+// CHECK-LABEL: func.func @paged_varlen_attention(
+// CHECK-SAME:      %[[QUERY:[a-zA-Z0-9_]+]]: tensor<4x4x16xf32>, %[[KEY:[a-zA-Z0-9_]+]]: tensor<8x4x4x16xf32>, %[[VALUE:[a-zA-Z0-9_]+]]: tensor<8x4x4x16xf32>, %[[CU_SEQLENS_Q:[a-zA-Z0-9_]+]]: tensor<5xi64>, %[[CU_SEQLENS_K:[a-zA-Z0-9_]+]]: tensor<5xi64>, %[[BLOCK_TABLE:[a-zA-Z0-9_]+]]: tensor<4x2xi32>, %[[OUTPUT:[a-zA-Z0-9_]+]]: tensor<4x4x16xf32>)
+// CHECK:         scf.for %[[IV:.*]] = %{{.*}} to %{{.*}} step %{{.*}} iter_args(%[[ACC:.*]] = %[[OUTPUT]]) -> (tensor<4x4x16xf32>) {
+// CHECK:           %[[CU_SEQLENS_Q_TILE:.*]] = tensor.extract_slice %[[CU_SEQLENS_Q]][%[[IV]]] [3] [1] : tensor<5xi64> to tensor<3xi64>
+// CHECK:           %[[CU_SEQLENS_K_TILE:.*]] = tensor.extract_slice %[[CU_SEQLENS_K]][%[[IV]]] [3] [1] : tensor<5xi64> to tensor<3xi64>
+// CHECK:           %[[BLOCK_TABLE_TILE:.*]] = tensor.extract_slice %[[BLOCK_TABLE]][%[[IV]], 0] [2, 2] [1, 1] : tensor<4x2xi32> to tensor<2x2xi32>
+// CHECK:           tm_tensor.varlen_attention ins(%[[QUERY]], %[[KEY]], %[[VALUE]], %[[CU_SEQLENS_Q_TILE]], %[[CU_SEQLENS_K_TILE]], %[[BLOCK_TABLE_TILE]] : tensor<4x4x16xf32>, tensor<8x4x4x16xf32>, tensor<8x4x4x16xf32>, tensor<3xi64>, tensor<3xi64>, tensor<2x2xi32>) outs(%[[ACC]] : tensor<4x4x16xf32>) -> tensor<4x4x16xf32>
+
+// INNER-LABEL: func.func @paged_varlen_attention(
+// INNER-SAME:      %[[QUERY:[a-zA-Z0-9_]+]]: tensor<4x4x16xf32>, %[[KEY:[a-zA-Z0-9_]+]]: tensor<8x4x4x16xf32>, %[[VALUE:[a-zA-Z0-9_]+]]: tensor<8x4x4x16xf32>, %[[CU_SEQLENS_Q:[a-zA-Z0-9_]+]]: tensor<5xi64>, %[[CU_SEQLENS_K:[a-zA-Z0-9_]+]]: tensor<5xi64>, %[[BLOCK_TABLE:[a-zA-Z0-9_]+]]: tensor<4x2xi32>, %[[OUTPUT:[a-zA-Z0-9_]+]]: tensor<4x4x16xf32>)
+// INNER:         scf.for %[[IV:.*]] = %{{.*}} to %{{.*}} step %{{.*}} iter_args(%[[ACC:.*]] = %[[OUTPUT]]) -> (tensor<4x4x16xf32>) {
+// INNER:           tensor.extract_slice %[[KEY]][0, 0, %[[IV]], 0] [8, 4, 2, 16] [1, 1, 1, 1] : tensor<8x4x4x16xf32> to tensor<8x4x2x16xf32>
+// INNER:           tensor.extract_slice %[[VALUE]][0, 0, %[[IV]], 0] [8, 4, 2, 16] [1, 1, 1, 1] : tensor<8x4x4x16xf32> to tensor<8x4x2x16xf32>
+// INNER:           tm_tensor.varlen_attention ins(%{{.*}}, %{{.*}}, %{{.*}}, %[[CU_SEQLENS_Q]], %[[CU_SEQLENS_K]], %[[BLOCK_TABLE]] : tensor<4x2x16xf32>, tensor<8x4x2x16xf32>, tensor<8x4x2x16xf32>, tensor<5xi64>, tensor<5xi64>, tensor<4x2xi32>) outs(%{{.*}} : tensor<4x2x16xf32>) -> tensor<4x2x16xf32>
+func.func @paged_varlen_attention(%query: tensor<4x4x16xf32>, %key: tensor<8x4x4x16xf32>,
+                                  %value: tensor<8x4x4x16xf32>, %cu_seqlens_q: tensor<5xi64>,
+                                  %cu_seqlens_k: tensor<5xi64>, %block_table: tensor<4x2xi32>,
+                                  %output: tensor<4x4x16xf32>) -> tensor<4x4x16xf32> {
+  %0 = tm_tensor.varlen_attention
+    ins(%query, %key, %value, %cu_seqlens_q, %cu_seqlens_k, %block_table : tensor<4x4x16xf32>, tensor<8x4x4x16xf32>, tensor<8x4x4x16xf32>, tensor<5xi64>, tensor<5xi64>, tensor<4x2xi32>)
+    outs(%output : tensor<4x4x16xf32>) -> tensor<4x4x16xf32>
+  return %0 : tensor<4x4x16xf32>
+}
@@ -0,0 +1,35 @@
+/*===-- torch-mlir-c/Instrumentation.h - Pass instrumentations ----*- C -*-===*\
+|*                                                                            *|
+|* Part of the LLVM Project, under the Apache License v2.0 with LLVM          *|
+|* Exceptions.                                                                *|
+|* See https://llvm.org/LICENSE.txt for license information.                  *|
+|* SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception                    *|
+|*                                                                            *|
+\*===----------------------------------------------------------------------===*/
+
+#ifndef TORCHMLIR_C_INSTRUMENTATION_H
+#define TORCHMLIR_C_INSTRUMENTATION_H
+
+#include "mlir-c/Pass.h"
+#include "mlir-c/Support.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Makes `passManager` emit a remark after each pass with the resident set
+ * size of the process, its peak, and the attributes that the pass added to the
+ * IR. Passes adding at least `largeAttributeCount` attributes, or elements
+ * attributes of at least `largeAttributeBytes` bytes, are flagged as creating
+ * many attributes. */
+MLIR_CAPI_EXPORTED void torchMlirPassManagerAddMemoryUsageInstrumentation(
+    MlirPassManager passManager, int64_t largeAttributeCount,
+    int64_t largeAttributeBytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TORCHMLIR_C_INSTRUMENTATION_H
@@ -0,0 +1,58 @@
+/*===-- torch-mlir-c/Pipeline.h - Reusable pass pipelines ---------*- C -*-===*\
+|*                                                                            *|
+|* Part of the LLVM Project, under the Apache License v2.0 with LLVM          *|
+|* Exceptions.                                                                *|
+|* See https://llvm.org/LICENSE.txt for license information.                  *|
+|* SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception                    *|
+|*                                                                            *|
+\*===----------------------------------------------------------------------===*/
+
+#ifndef TORCHMLIR_C_PIPELINE_H
+#define TORCHMLIR_C_PIPELINE_H
+
+#include "mlir-c/IR.h"
+#include "mlir-c/Support.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** A pass pipeline that is parsed once and then run on any number of
+ * operations, from any number of threads at once. Each run reuses the passes,
+ * and so the pattern sets they froze, of an earlier run that has finished, so
+ * that the cost of building the passes is only paid once per concurrent run
+ * rather than once per run. */
+typedef struct TorchMlirPipeline {
+  void *ptr;
+} TorchMlirPipeline;
+
+/** Parses the textual pass pipeline `pipeline`, such as
+ * "builtin.module(torch-backend-to-linalg-on-tensors-backend-pipeline)", for
+ * running on operations in `context`. On failure, the error is passed to
+ * `errorCallback` and the returned pipeline is null.
+ *
+ * Running a pipeline from several threads at once requires multithreading to
+ * be enabled on `context`. */
+MLIR_CAPI_EXPORTED TorchMlirPipeline torchMlirPipelineCreate(
+    MlirContext context, MlirStringRef pipeline,
+    MlirStringCallback errorCallback, void *userData);
+
+/** Destroys `pipeline`, which must not be running. */
+MLIR_CAPI_EXPORTED void torchMlirPipelineDestroy(TorchMlirPipeline pipeline);
+
+/** Runs `pipeline` on `op`. The diagnostics are emitted to the handlers of the
+ * context. This can be called from several threads at once, on different
+ * operations. */
+MLIR_CAPI_EXPORTED MlirLogicalResult
+torchMlirPipelineRunOnOp(TorchMlirPipeline pipeline, MlirOperation op);
+
+/** Returns true if `pipeline` is null, that is, it failed to parse. */
+static inline bool torchMlirPipelineIsNull(TorchMlirPipeline pipeline) {
+  return !pipeline.ptr;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TORCHMLIR_C_PIPELINE_H
@@ -0,0 +1,45 @@
+/*===-- torch-mlir-c/Threading.h - Context threading functions ----*- C -*-===*\
+|*                                                                            *|
+|* Part of the LLVM Project, under the Apache License v2.0 with LLVM          *|
+|* Exceptions.                                                                *|
+|* See https://llvm.org/LICENSE.txt for license information.                  *|
+|* SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception                    *|
+|*                                                                            *|
+\*===----------------------------------------------------------------------===*/
+
+#ifndef TORCHMLIR_C_THREADING_H
+#define TORCHMLIR_C_THREADING_H
+
+#include "mlir-c/IR.h"
+#include "mlir-c/Support.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Makes `context` run its multithreaded work, such as running passes on
+ * several functions at once, on a thread pool of at most `numThreads` threads
+ * instead of one thread per core. The pool is shared by all the contexts that
+ * ask for the same number of threads, and lives until the end of the process.
+ * A `numThreads` of 0 uses one thread per core.
+ *
+ * This enables multithreading on `context`. It must not be called while a
+ * pass manager is running on `context`.
+ */
+MLIR_CAPI_EXPORTED void torchMlirContextSetThreadPoolSize(MlirContext context,
+                                                          unsigned numThreads);
+
+/** Returns the number of threads of the thread pool used by `context`, or 0
+ * if multithreading is disabled on `context`. */
+MLIR_CAPI_EXPORTED unsigned
+torchMlirContextGetThreadPoolSize(MlirContext context);
+
+/** Returns true if multithreading is enabled on `context`. */
+MLIR_CAPI_EXPORTED bool
+torchMlirContextIsMultithreadingEnabled(MlirContext context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TORCHMLIR_C_THREADING_H
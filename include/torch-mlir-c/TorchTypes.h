@@ -197,6 +197,13 @@ MLIR_CAPI_EXPORTED MlirType torchMlirTorchNonValueTensorTypeGet(
     MlirContext context, intptr_t numSizes, const int64_t *optionalSizes,
     MlirType optionalDtype);
 
+/// Gets a sparse !torch.tensor type, see `torchMlirTorchNonValueTensorTypeGet`.
+/// `optionalSparsity` is a `#sparse_tensor.encoding` attribute, or null for a
+/// dense tensor.
+MLIR_CAPI_EXPORTED MlirType torchMlirTorchNonValueTensorTypeGetWithSparsity(
+    MlirContext context, intptr_t numSizes, const int64_t *optionalSizes,
+    MlirType optionalDtype, MlirAttribute optionalSparsity);
+
 /// Gets the !torch.tensor type with the least static information.
 MLIR_CAPI_EXPORTED MlirType
 torchMlirTorchNonValueTensorTypeGetWithLeastStaticInformation(
@@ -240,6 +247,13 @@ MLIR_CAPI_EXPORTED MlirType torchMlirTorchValueTensorTypeGet(
     MlirContext context, intptr_t numSizes, const int64_t *optionalSizes,
     MlirType optionalDtype);
 
+/// Gets a sparse !torch.vtensor type, see `torchMlirTorchValueTensorTypeGet`.
+/// `optionalSparsity` is a `#sparse_tensor.encoding` attribute, or null for a
+/// dense tensor.
+MLIR_CAPI_EXPORTED MlirType torchMlirTorchValueTensorTypeGetWithSparsity(
+    MlirContext context, intptr_t numSizes, const int64_t *optionalSizes,
+    MlirType optionalDtype, MlirAttribute optionalSparsity);
+
 /// Gets the !torch.tensor type with the least static information.
 MLIR_CAPI_EXPORTED MlirType
 torchMlirTorchValueTensorTypeGetWithLeastStaticInformation(MlirContext context);
@@ -33,6 +33,14 @@ bool isConstantIntListMatching(Value value, SmallVectorImpl<int64_t> &expects);
 void checkDimEqualHelper(OpBuilder &b, Location loc, Value lhsDim,
                          Value rhsDim);
 
+// Returns true if dimension `lhsDim` of `lhs` is known to have the same size as
+// dimension `rhsDim` of `rhs`, because both sizes were created from the size of
+// the same dimension of the same tensor, or from the same size value. This
+// looks through casts and through the linalg ops and `tensor.empty` ops that
+// the lowering creates, so the results of an elementwise chain are known to
+// have the sizes of its inputs.
+bool areDimSizesEqual(Value lhs, int64_t lhsDim, Value rhs, int64_t rhsDim);
+
 // Creates a tensor with required `sizes` and `elemTy` and fills it with
 // initElem.
 Value createInitTensor(OpBuilder &b, Location loc, ValueRange sizes,
@@ -100,6 +108,30 @@ void computeBroadcastShape(ConversionPatternRewriter &rewriter, Location loc,
                            SmallVector<int64_t> &resultShape,
                            SmallVector<Value> &resultShapeValue);
 
+// Applies a partial conversion of `root` like `applyPartialConversion`, but
+// converts the illegal ops one at a time to profile the conversion. For each
+// kind of converted op, prints to `os` the time spent converting it and the
+// number and kinds of ops its conversion emitted, so that the ops that are
+// expensive to convert or that expand into large IR can be found.
+LogicalResult
+applyPartialConversionWithProfile(Operation *root, ConversionTarget &target,
+                                  const FrozenRewritePatternSet &patterns,
+                                  StringRef name, raw_ostream &os);
+
+// Returns `elements` transposed by `perms`, with dimension `i` of the result
+// being dimension `perms[i]` of `elements`, or null if `elements` isn't a
+// dense attribute of a static shape, or has more than `maxNumElements`
+// elements. The conversions use it to lay constant weights out at compile
+// time.
+DenseElementsAttr transposeDenseElements(ElementsAttr elements,
+                                         ArrayRef<int64_t> perms,
+                                         int64_t maxNumElements);
+
+// Permutes the dimensions of `tensor` with a linalg.generic that copies it, so
+// that dimension `i` of the result is dimension `permutation[i]` of `tensor`.
+Value permuteTensor(OpBuilder &b, Location loc, Value tensor,
+                    ArrayRef<int64_t> permutation);
+
 } // namespace Torch
 } // namespace torch
 } // namespace mlir
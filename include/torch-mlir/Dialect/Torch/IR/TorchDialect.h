@@ -10,7 +10,47 @@
 #ifndef TORCHMLIR_DIALECT_TORCH_IR_TORCHDIALECT_H
 #define TORCHMLIR_DIALECT_TORCH_IR_TORCHDIALECT_H
 
+#include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Dialect.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/IR/SymbolTable.h"
+#include "llvm/ADT/StringMap.h"
+
+#include <memory>
+#include <mutex>
+
+namespace mlir {
+namespace torch {
+namespace Torch {
+
+/// A cache of parsed abstract interpretation library modules, keyed by the
+/// filename of the extra library spliced into the builtin one (the empty
+/// string denotes the builtin library alone).
+///
+/// Cached modules are never mutated after they have been inserted; clients
+/// clone the functions they need out of them. This makes it safe to share a
+/// single parsed library across all pass runs in a context.
+class AbstractInterpLibraryCache {
+public:
+  /// Returns the symbol table of the library cached under `key`, calling
+  /// `parse` to populate the cache on first use. Returns nullptr if `parse`
+  /// fails, in which case nothing is cached.
+  SymbolTable *
+  getOrParse(StringRef key,
+             llvm::function_ref<OwningOpRef<ModuleOp>()> parse);
+
+private:
+  struct Entry {
+    OwningOpRef<ModuleOp> module;
+    std::unique_ptr<SymbolTable> symbolTable;
+  };
+  std::mutex mutex;
+  llvm::StringMap<Entry> entries;
+};
+
+} // namespace Torch
+} // namespace torch
+} // namespace mlir
 
 #include "torch-mlir/Dialect/Torch/IR/TorchDialect.h.inc"
 
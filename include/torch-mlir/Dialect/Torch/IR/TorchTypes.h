@@ -32,11 +32,13 @@ class ValueTensorType;
 /// Common getter function signature that covers all tensor types.
 /// Used for sharing code between NonValueTensorType and ValueTensorType.
 using GetTensorTypeFn = llvm::function_ref<Type(
-    MLIRContext *, std::optional<ArrayRef<int64_t>>, Type)>;
+    MLIRContext *, std::optional<ArrayRef<int64_t>>, Type, Attribute)>;
 
 /// The representation of an unknown dimension size in an ArrayRef<int64_t>.
 constexpr static int64_t kUnknownSize = -1;
 
+struct TensorStaticInfo;
+
 class BaseTensorType : public Type {
 public:
   using Type::Type;
@@ -53,6 +55,10 @@ public:
   /// convenient API.
   Type getOptionalDtype() const;
 
+  /// Get the raw nullable `#sparse_tensor.encoding` attribute describing the
+  /// sparse layout of this tensor type. Tensors without it are dense.
+  Attribute getOptionalSparsity() const;
+
   /// Return true if this type has a list of sizes.
   bool hasSizes() const { return getOptionalSizes().has_value(); }
 
@@ -89,15 +95,60 @@ public:
   Type getWithSizesAndDtypeFrom(BaseTensorType other) const;
 
   /// Return a type of the same kind as this one, but with given raw optional
-  /// sizes and raw optional dtype.
+  /// sizes and raw optional dtype. The sparsity of this type is kept as long
+  /// as the rank is.
   Type getWithSizesAndDtype(std::optional<ArrayRef<int64_t>> optionalSizes,
                             Type optionalDtype) const;
 
-  /// Return a type with the same shape and dtype as this one, but with
-  /// value semantics.
+  /// Return a type of the same kind as this one, but with the sizes and dtype
+  /// of `info`. If those are already the ones of this type, this type is
+  /// returned without looking it up in the context.
+  Type getWithStaticInfo(const TensorStaticInfo &info) const;
+
+  /// Return a type with the same shape, dtype and sparsity as this one, but
+  /// with value semantics.
   ValueTensorType getWithValueSemantics() const;
 };
 
+/// The static information of a tensor type, that is, its raw optional sizes
+/// and raw optional dtype.
+///
+/// Types are never freed from their context. Combining the static information
+/// of types, rather than the types themselves, only creates the final type in
+/// the context, and not the types in between.
+struct TensorStaticInfo {
+  TensorStaticInfo() = default;
+  TensorStaticInfo(BaseTensorType type)
+      : TensorStaticInfo(type.getOptionalSizes(), type.getOptionalDtype()) {}
+  TensorStaticInfo(std::optional<ArrayRef<int64_t>> optionalSizes,
+                   Type optionalDtype)
+      : optionalDtype(optionalDtype) {
+    if (optionalSizes)
+      this->optionalSizes.emplace(optionalSizes->begin(), optionalSizes->end());
+  }
+
+  bool operator==(const TensorStaticInfo &other) const {
+    return optionalSizes == other.optionalSizes &&
+           optionalDtype == other.optionalDtype;
+  }
+  bool operator!=(const TensorStaticInfo &other) const {
+    return !(*this == other);
+  }
+
+  std::optional<SmallVector<int64_t>> optionalSizes;
+  Type optionalDtype;
+};
+
+/// Return the static information assumed by both `lhs` and `rhs`, or
+/// std::nullopt if they conflict. See `meetTensorTypes`.
+std::optional<TensorStaticInfo>
+meetTensorStaticInfo(const TensorStaticInfo &lhs, const TensorStaticInfo &rhs);
+
+/// Return the static information common to `lhs` and `rhs`. See
+/// `joinTensorTypes`.
+TensorStaticInfo joinTensorStaticInfo(const TensorStaticInfo &lhs,
+                                      const TensorStaticInfo &rhs);
+
 /// Return the tensor type which assumes the static information from both types.
 ///
 /// For example, if `lhs = !torch.vtensor<[100],unk>` and
@@ -112,6 +163,18 @@ public:
 /// ways in different situations.
 Type meetTensorTypes(BaseTensorType lhs, BaseTensorType rhs);
 
+/// Return the tensor type which only assumes the static information that is
+/// common to both types.
+///
+/// For example, if `lhs = !torch.vtensor<[2,3],f32>` and
+/// `rhs = !torch.vtensor<[4,3],f32>` then this function would return
+/// `!torch.vtensor<[?,3],f32>`.
+///
+/// This is the type of a value that can come from either `lhs` or `rhs`, such
+/// as the result of a `torch.prim.If`. Like `meetTensorTypes`, this function
+/// requires both types to have the same sense of value semantics.
+Type joinTensorTypes(BaseTensorType lhs, BaseTensorType rhs);
+
 } // namespace Torch
 } // namespace torch
 } // namespace mlir
@@ -144,6 +207,14 @@ inline Type BaseTensorType::getOptionalDtype() const {
   llvm_unreachable("not a BaseTensorType!");
 }
 
+inline Attribute BaseTensorType::getOptionalSparsity() const {
+  if (auto tensor = dyn_cast<NonValueTensorType>())
+    return tensor.getOptionalSparsity();
+  if (auto tensor = dyn_cast<ValueTensorType>())
+    return tensor.getOptionalSparsity();
+  llvm_unreachable("not a BaseTensorType!");
+}
+
 inline bool BaseTensorType::classof(Type type) {
   return type.isa<NonValueTensorType, ValueTensorType>();
 }
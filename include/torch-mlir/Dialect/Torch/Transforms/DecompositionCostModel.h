@@ -0,0 +1,79 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TORCHMLIR_DIALECT_TORCH_TRANSFORMS_DECOMPOSITIONCOSTMODEL_H
+#define TORCHMLIR_DIALECT_TORCH_TRANSFORMS_DECOMPOSITIONCOSTMODEL_H
+
+#include "mlir/IR/Operation.h"
+#include "llvm/ADT/StringMap.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace mlir {
+namespace torch {
+namespace Torch {
+
+/// The work done by an op.
+struct OpCost {
+  /// The number of arithmetic operations, counting a multiply-add as two.
+  double flops = 0;
+  /// The number of bytes read and written, assuming that the op reads all of
+  /// its tensor operands and writes all of its tensor results to memory.
+  double bytes = 0;
+};
+
+/// Estimates the work done by `op` from the static sizes and dtypes of its
+/// tensors. Ops that only change the metadata of a tensor, such as views,
+/// and ops without tensor results, such as constants, do no work. Returns
+/// std::nullopt if a tensor of `op` doesn't have static sizes or a dtype.
+std::optional<OpCost> estimateOpCost(Operation *op);
+
+/// Estimates the cost of running ops, which `DecomposeComplexOps` uses to
+/// choose between the alternative decompositions of an op. Backends can
+/// subclass this with a model of their own hardware and kernels.
+class DecompositionCostModel {
+public:
+  virtual ~DecompositionCostModel() = default;
+
+  /// Returns the estimated cost of `op`, in units of the model's choosing, or
+  /// std::nullopt if it can't be estimated.
+  virtual std::optional<double> getCost(Operation *op) const = 0;
+};
+
+/// A roofline model, in which an op takes
+///
+///   max(bytes, flops / (flopsPerByte * efficiency))
+///
+/// where `flopsPerByte` is the ratio of the peak arithmetic throughput of the
+/// hardware to its memory bandwidth, and `efficiency` is the fraction of the
+/// peak throughput that the backend reaches for the op, 1 by default.
+class RooflineCostModel : public DecompositionCostModel {
+public:
+  explicit RooflineCostModel(double flopsPerByte,
+                             llvm::StringMap<double> opEfficiencies = {});
+
+  /// Parses `opEfficiencies` entries of the form "aten.foo=0.5".
+  static FailureOr<std::unique_ptr<RooflineCostModel>>
+  parse(double flopsPerByte, ArrayRef<std::string> opEfficiencies);
+
+  std::optional<double> getCost(Operation *op) const override;
+
+private:
+  double flopsPerByte;
+  // By op name, without the "torch." prefix.
+  llvm::StringMap<double> opEfficiencies;
+};
+
+} // namespace Torch
+} // namespace torch
+} // namespace mlir
+
+#endif // TORCHMLIR_DIALECT_TORCH_TRANSFORMS_DECOMPOSITIONCOSTMODEL_H
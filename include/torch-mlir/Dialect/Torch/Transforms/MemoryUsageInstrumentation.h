@@ -0,0 +1,50 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TORCHMLIR_DIALECT_TORCH_TRANSFORMS_MEMORYUSAGEINSTRUMENTATION_H
+#define TORCHMLIR_DIALECT_TORCH_TRANSFORMS_MEMORYUSAGEINSTRUMENTATION_H
+
+#include "mlir/Pass/PassManager.h"
+
+#include <cstdint>
+
+namespace mlir {
+namespace torch {
+namespace Torch {
+
+struct MemoryUsageInstrumentationOptions {
+  /// A pass is flagged as creating many attributes if it adds at least this
+  /// many attributes to the IR it runs on...
+  int64_t largeAttributeCount = 10000;
+  /// ...or if the elements attributes it adds hold at least this many bytes,
+  /// such as when folding literals or cloning weights.
+  int64_t largeAttributeBytes = 64 << 20;
+};
+
+/// Makes `pm` emit a remark on the operation of each pass it runs, including
+/// the passes of the dynamic pipelines run by its passes, with:
+/// - the resident set size of the process after the pass, and its change;
+/// - the peak resident set size after the pass, and its change, which shows
+///   the passes that drove the process to its peak;
+/// - the number of attributes that the pass added to the IR of the operation,
+///   and the bytes of the elements of the ones that are elements attributes.
+///   Attributes are uniqued in the MLIRContext and live as long as it does,
+///   so they are storage that the pass added to the context.
+///
+/// The memory of the process is shared by the passes running at once on
+/// different operations, so their deltas are only meaningful with
+/// multithreading disabled.
+void addMemoryUsageInstrumentation(
+    PassManager &pm, const MemoryUsageInstrumentationOptions &options = {});
+
+} // namespace Torch
+} // namespace torch
+} // namespace mlir
+
+#endif // TORCHMLIR_DIALECT_TORCH_TRANSFORMS_MEMORYUSAGEINSTRUMENTATION_H
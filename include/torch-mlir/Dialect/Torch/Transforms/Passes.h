@@ -21,6 +21,8 @@ class ModuleOp;
 namespace torch {
 namespace Torch {
 
+class DecompositionCostModel;
+
 #include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
 
 std::unique_ptr<OperationPass<ModuleOp>> createGlobalizeObjectGraphPass();
@@ -59,9 +61,93 @@ struct TorchLoweringPipelineOptions
       llvm::cl::desc("List of ops to be considered legal for the backend, such "
                      "as 'aten.foo'.")};
 
+  // If this option is set, the tensor literals of the global slots are moved
+  // to external storage and written to this file, see ExternalizeWeights.
+  Option<std::string> externalWeightsFile{
+      *this, "external-weights-file",
+      llvm::cl::desc("Move the weights out of the program, and write their "
+                     "contents to this safetensors file."),
+      llvm::cl::init("")};
   Option<std::string> extraLibrary{
       *this, "extra-library",
       llvm::cl::desc("Filename of MLIR module for splicing into the abstract interpretation library.")};
+  // If this option is true, the shape and dtype refinement pipelines compute
+  // the result types of the most common ops natively rather than with the
+  // abstract interpretation library when their operands are static enough.
+  Option<bool> nativeAbstractInterp{
+      *this, "native-abstract-interp",
+      llvm::cl::desc("Refine the result types of common ops natively rather "
+                     "than with the abstract interpretation library when "
+                     "possible."),
+      llvm::cl::init(false)};
+
+  // If this option is true, only the functions that do not yet satisfy the
+  // backend contract are re-simplified after the first iteration of the
+  // simplification pipeline in LowerToBackendContract.
+  Option<bool> incremental{
+      *this, "incremental",
+      llvm::cl::desc("Only re-simplify functions that do not yet satisfy the "
+                     "backend contract."),
+      llvm::cl::init(false)};
+  // If this option is true, LowerToBackendContract emits a remark describing
+  // the progress made by each iteration of the simplification pipeline.
+  Option<bool> reportIterations{
+      *this, "report-iterations",
+      llvm::cl::desc("Emit a remark describing the progress made by each "
+                     "iteration of the simplification pipeline."),
+      llvm::cl::init(false)};
+  // If this option is set, the matmuls, convolutions and attention are
+  // computed in this dtype, see AutoMixedPrecision.
+  Option<std::string> mixedPrecision{
+      *this, "mixed-precision",
+      llvm::cl::desc("Compute the matmuls, convolutions and attention in this "
+                     "dtype ('bf16' or 'f16') instead of f32."),
+      llvm::cl::init("")};
+  ListOption<std::string> mixedPrecisionOps{
+      *this, "mixed-precision-ops",
+      llvm::cl::desc("List of ops to compute in the `mixed-precision` dtype, "
+                     "such as 'aten.mm', instead of the default ones.")};
+  // If this option is set, the linear ops and matmuls of an input with
+  // literal weights are fused into wider ones, see FuseSiblingLinears.
+  Option<bool> fuseSiblingLinears{
+      *this, "fuse-sibling-linears",
+      llvm::cl::desc("Fuse the linear ops and matmuls that share an input "
+                     "and have literal weights into wider ones."),
+      llvm::cl::init(false)};
+  // If this option is set, the 2:4 sparse literal weights of the linear ops
+  // are compressed, see CompressSparseLinearWeights.
+  Option<bool> compressSparseLinearWeights{
+      *this, "compress-sparse-linear-weights",
+      llvm::cl::desc("Compress the literal weights of the linear ops that "
+                     "have at most 2 nonzeros in each group of 4."),
+      llvm::cl::init(false)};
+  // If this option is set, the literal weights of the linear ops are quantized
+  // to this number of bits, see QuantizeLinearWeights.
+  Option<int> weightQuantizationBits{
+      *this, "weight-quantization-bits",
+      llvm::cl::desc("Quantize the literal weights of the linear ops to this "
+                     "number of bits (4 or 8), or 0 to keep them as is."),
+      llvm::cl::init(0)};
+  Option<int> weightQuantizationGroupSize{
+      *this, "weight-quantization-group-size",
+      llvm::cl::desc("The number of consecutive weights of a row sharing a "
+                     "scale with `weight-quantization-bits`."),
+      llvm::cl::init(128)};
+  // The fraction of the peak arithmetic throughput that the backend reaches
+  // for some ops, which DecomposeComplexOps uses to choose between the
+  // alternative decompositions of an op.
+  ListOption<std::string> decompositionOpEfficiencies{
+      *this, "decomposition-op-efficiencies",
+      llvm::cl::desc("List of the efficiencies of the backend for ops, such "
+                     "as 'aten.convolution=0.5', for choosing between "
+                     "decompositions.")};
+  // If this option is true, the ops of the backend contract are reordered to
+  // reduce the peak activation memory, see ReorderForPeakMemory.
+  Option<bool> reorderForPeakMemory{
+      *this, "reorder-for-peak-memory",
+      llvm::cl::desc("Reorder independent ops to reduce the peak activation "
+                     "memory."),
+      llvm::cl::init(false)};
 };
 
 /// Creates a pipeline that lowers the object graph IR that is produced by
@@ -92,32 +178,71 @@ void createTorchDtypeRefinementPipeline(
 
 std::unique_ptr<OperationPass<ModuleOp>> createAdjustCallingConventionsPass();
 
+std::unique_ptr<OperationPass<ModuleOp>>
+createExternalizeWeightsPass(StringRef weightsFile);
+
 std::unique_ptr<OperationPass<ModuleOp>> createInlineGlobalSlotsPass();
 
+std::unique_ptr<OperationPass<ModuleOp>> createPromoteMutableGlobalSlotsPass();
+
 std::unique_ptr<OperationPass<func::FuncOp>>
 createReduceOpVariantsPass(StringRef extraLibrary);
 
 std::unique_ptr<OperationPass<func::FuncOp>> createMaximizeValueSemanticsPass();
 
+std::unique_ptr<OperationPass<func::FuncOp>> createEliminateTensorCopiesPass();
+
 std::unique_ptr<OperationPass<ModuleOp>> createRefinePublicReturnPass();
 
+/// Creates a pass decomposing the ops that aren't in `legalOps`, which
+/// chooses between the alternative decompositions of an op with a
+/// `RooflineCostModel` configured by `opEfficiencies`.
+std::unique_ptr<OperationPass<func::FuncOp>>
+createDecomposeComplexOpsPass(ArrayRef<std::string> legalOps,
+                              ArrayRef<std::string> opEfficiencies = {});
+
+/// Same as above, but with the cost model of a backend.
+std::unique_ptr<OperationPass<func::FuncOp>>
+createDecomposeComplexOpsPass(
+    ArrayRef<std::string> legalOps,
+    std::shared_ptr<const DecompositionCostModel> costModel);
+
 std::unique_ptr<OperationPass<func::FuncOp>>
-createDecomposeComplexOpsPass(ArrayRef<std::string> legalOps);
+createFoldBatchNormIntoWeightsPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createFoldTensorLiteralsPass(int64_t maxElements = 1 << 20);
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createAutoMixedPrecisionPass(StringRef dtype, ArrayRef<std::string> ops);
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createQuantizeLinearWeightsPass(int64_t bits, int64_t groupSize);
+
+std::unique_ptr<OperationPass<func::FuncOp>> createFuseSiblingLinearsPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createCompressSparseLinearWeightsPass();
 
 std::unique_ptr<OperationPass<func::FuncOp>> createRecomposeComplexOpsPass();
 
 std::unique_ptr<OperationPass<ModuleOp>>
-createReifyShapeCalculationsPass(StringRef extraLibrary);
+createReifyShapeCalculationsPass(StringRef extraLibrary,
+                                 bool nativeFastPath = false);
 
 std::unique_ptr<OperationPass<func::FuncOp>>
 createSimplifyShapeCalculationsPass();
 
 std::unique_ptr<OperationPass<ModuleOp>>
-createReifyDtypeCalculationsPass(StringRef extraLibrary);
+createReifyDtypeCalculationsPass(StringRef extraLibrary,
+                                 bool nativeFastPath = false);
 
 std::unique_ptr<OperationPass<func::FuncOp>>
 createSimplifyDtypeCalculationsPass();
 
+std::unique_ptr<OperationPass<ModuleOp>>
+createInlineAbstractInterpCalculationsPass();
+
 std::unique_ptr<OperationPass<func::FuncOp>>
 createDropAbstractInterpCalculationsPass();
 
@@ -127,11 +252,47 @@ createEraseModuleInitializerPass();
 std::unique_ptr<OperationPass<ModuleOp>>
 createLowerToBackendContractPass(int maxIterations, bool decompose,
                                  ArrayRef<std::string> backendLegalOps,
-                                 StringRef extraLibrary);
+                                 StringRef extraLibrary,
+                                 bool incremental = false,
+                                 bool reportIterations = false,
+                                 StringRef mixedPrecision = "",
+                                 ArrayRef<std::string> mixedPrecisionOps = {},
+                                 ArrayRef<std::string>
+                                     decompositionOpEfficiencies = {});
 
 std::unique_ptr<OperationPass<ModuleOp>>
 createVerifyBackendContractNoDecompositionsPass();
 
+std::unique_ptr<OperationPass<ModuleOp>> createEstimateCostsPass(bool perOp);
+
+/// The canonicalization patterns of the Torch backend IR, which are built once
+/// and shared by all the `createCanonicalizePass` passes given them, rather
+/// than built by each pass.
+struct SharedCanonicalizationPatterns;
+
+std::shared_ptr<SharedCanonicalizationPatterns>
+createSharedCanonicalizationPatterns();
+
+std::unique_ptr<OperationPass<func::FuncOp>> createCanonicalizePass(
+    std::shared_ptr<SharedCanonicalizationPatterns> patterns = nullptr);
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createReorderForPeakMemoryPass(bool report);
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createRematerializePass(int64_t memoryBudget, double maxFlopsPerByte);
+
+std::unique_ptr<OperationPass<ModuleOp>>
+createPartitionPipelineStagesPass(int64_t numStages, double flopsPerByte);
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createEliminateTensorStaticInfoCastsPass();
+
+std::unique_ptr<OperationPass<ModuleOp>> createDeduplicateFunctionsPass();
+
+/// Returns the abstract interpretation library, either as textual MLIR or as
+/// MLIR bytecode, depending on how `AbstractInterpLibrary.cpp` was generated.
+/// Both forms can be handed to `parseSourceString`.
 StringRef getAbstractInterpLibrary();
 
 static const char kTorchOpPrefix[] = R"(torch.)";
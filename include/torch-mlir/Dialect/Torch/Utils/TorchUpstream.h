@@ -103,7 +103,14 @@ enum class TypeKind {
   _(c10::qint32, QInt32)                  /* 14 */                             \
   _(at::BFloat16, BFloat16)               /* 15 */                             \
   _(c10::quint4x2, QUInt4x2)              /* 16 */                             \
-  _(c10::quint2x4, QUInt2x4)              /* 17 */
+  _(c10::quint2x4, QUInt2x4)              /* 17 */                             \
+  _(c10::bits1x8, Bits1x8)                /* 18 */                             \
+  _(c10::bits2x4, Bits2x4)                /* 19 */                             \
+  _(c10::bits4x2, Bits4x2)                /* 20 */                             \
+  _(c10::bits8, Bits8)                    /* 21 */                             \
+  _(c10::bits16, Bits16)                  /* 22 */                             \
+  _(c10::Float8_e5m2, Float8_e5m2)        /* 23 */                             \
+  _(c10::Float8_e4m3fn, Float8_e4m3fn)    /* 24 */
 
 enum class ScalarType : int8_t {
 #define DEFINE_ENUM(_1, n) n,
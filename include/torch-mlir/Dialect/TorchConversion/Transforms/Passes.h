@@ -22,9 +22,49 @@ class ModuleOp;
 namespace torch {
 namespace TorchConversion {
 
+struct LinalgOnTensorsBackendPipelineOptions
+    : public PassPipelineOptions<LinalgOnTensorsBackendPipelineOptions> {
+  Option<bool> channelsLast{
+      *this, "channels-last",
+      llvm::cl::desc("Keep 2D convolutions, pooling and the elementwise ops "
+                     "between them in the NHWC layout."),
+      llvm::cl::init(false)};
+  Option<bool> fuseElementwise{
+      *this, "fuse-elementwise",
+      llvm::cl::desc("Fuse producer-consumer chains of elementwise linalg "
+                     "ops into single linalg.generic ops, and fold bias and "
+                     "residual adds into matmul accumulators."),
+      llvm::cl::init(false)};
+  Option<bool> trustShapes{
+      *this, "trust-shapes",
+      llvm::cl::desc("Erase all the runtime asserts that guard the shape "
+                     "assumptions of the lowering, not only the ones that are "
+                     "known to hold."),
+      llvm::cl::init(false)};
+  Option<bool> hoistConstants{
+      *this, "hoist-constants",
+      llvm::cl::desc("Store the large tensor constants once as ml_program "
+                     "globals loaded by the functions, instead of inlining "
+                     "them into each function that uses them."),
+      llvm::cl::init(false)};
+  Option<bool> hoistWeightComputations{
+      *this, "hoist-weight-computations",
+      llvm::cl::desc("Compute the tensors that only depend on constants once, "
+                     "on the first call of the module, and cache them in "
+                     "ml_program globals."),
+      llvm::cl::init(false)};
+  Option<bool> narrowScalars{
+      *this, "narrow-scalars",
+      llvm::cl::desc("Compute the i64 and f64 scalars that !torch.int and "
+                     "!torch.float are lowered to in i32 and f32 wherever "
+                     "their ranges show that this gives the same results."),
+      llvm::cl::init(false)};
+};
+
 /// Creates a pipeline that lowers from the torch backend contract to the
 /// linalg-on-tensors backend contract.
-void createTorchBackendToLinalgOnTensorsBackendPipeline(OpPassManager &pm);
+void createTorchBackendToLinalgOnTensorsBackendPipeline(
+    OpPassManager &pm, const LinalgOnTensorsBackendPipelineOptions &options);
 
 /// Creates a pipeline that lowers from the torch backend contract to the
 /// TOSA backend contract.
@@ -57,6 +97,31 @@ std::unique_ptr<OperationPass<ModuleOp>> createFuncBackendTypeConversionPass();
 std::unique_ptr<OperationPass<func::FuncOp>>
 createFinalizingBackendTypeConversionPass();
 
+std::unique_ptr<OperationPass<func::FuncOp>>
+createPropagateLinalgTransposesPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createPropagateTosaTransposesPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createFoldLinalgContractionEpiloguesPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createFoldLinalgProducersIntoInsertSlicesPass();
+
+std::unique_ptr<OperationPass<ModuleOp>> createHoistConstantComputationsPass();
+
+std::unique_ptr<OperationPass<ModuleOp>>
+createHoistTensorConstantsToGlobalsPass(int64_t minElements = 16);
+
+std::unique_ptr<OperationPass<func::FuncOp>> createSimplifyIndexCastsPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createNarrowScalarArithmeticPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createSimplifyRuntimeAssertsPass(bool trustShapes = false);
+
 std::unique_ptr<OperationPass<ModuleOp>>
 createVerifyLinalgOnTensorsBackendContractPass();
 
@@ -32,6 +32,16 @@ std::unique_ptr<OperationPass<ModuleOp>> createMLProgramBufferizePass();
 std::unique_ptr<OperationPass<func::FuncOp>> createMungeMemrefCopyPass();
 
 std::unique_ptr<OperationPass<func::FuncOp>> createGeneralizeTensorPadPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>> createTileAndVectorizePass();
+
+std::unique_ptr<OperationPass<func::FuncOp>> createPackConstantWeightsPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>> createPlanStaticBuffersPass();
+
+std::unique_ptr<OperationPass<ModuleOp>> createInsertOpTimersPass();
+
+std::unique_ptr<OperationPass<ModuleOp>> createRegisterHostBuffersForGpuPass();
 } // namespace RefBackend
 } // namespace torch
 } // namespace mlir
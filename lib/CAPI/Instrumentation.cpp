@@ -0,0 +1,24 @@
+//===- Instrumentation.cpp - C Interface for pass instrumentations --------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "torch-mlir-c/Instrumentation.h"
+
+#include "mlir/CAPI/Pass.h"
+#include "torch-mlir/Dialect/Torch/Transforms/MemoryUsageInstrumentation.h"
+
+using namespace mlir;
+
+void torchMlirPassManagerAddMemoryUsageInstrumentation(
+    MlirPassManager passManager, int64_t largeAttributeCount,
+    int64_t largeAttributeBytes) {
+  torch::Torch::MemoryUsageInstrumentationOptions options;
+  options.largeAttributeCount = largeAttributeCount;
+  options.largeAttributeBytes = largeAttributeBytes;
+  torch::Torch::addMemoryUsageInstrumentation(*unwrap(passManager), options);
+}
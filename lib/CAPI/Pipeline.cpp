@@ -0,0 +1,107 @@
+//===- Pipeline.cpp - C Interface for reusable pass pipelines -------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "torch-mlir-c/Pipeline.h"
+
+#include "mlir/CAPI/IR.h"
+#include "mlir/CAPI/Support.h"
+#include "mlir/CAPI/Utils.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassRegistry.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace mlir;
+
+namespace {
+// A parsed pipeline and the pass managers running it. A pass manager can only
+// run on one operation at a time, so each run takes an idle pass manager, or
+// parses a new one if all of them are running, and gives it back when done.
+// Pass managers only initialize their passes on their first run, so the
+// pattern sets frozen by the passes are reused by the later runs.
+class Pipeline {
+public:
+  static std::unique_ptr<Pipeline> create(MLIRContext *context,
+                                          StringRef pipeline,
+                                          raw_ostream &errorStream) {
+    std::unique_ptr<Pipeline> result(new Pipeline(context, pipeline));
+    std::unique_ptr<PassManager> pm = result->parse(errorStream);
+    if (!pm)
+      return nullptr;
+    // Load the dialects of the pipeline now, since a dialect can't be loaded
+    // while another run is in progress.
+    DialectRegistry registry;
+    pm->getDependentDialects(registry);
+    context->appendDialectRegistry(registry);
+    for (StringRef name : registry.getDialectNames())
+      context->getOrLoadDialect(name);
+    result->idlePassManagers.push_back(std::move(pm));
+    return result;
+  }
+
+  LogicalResult run(Operation *op) {
+    std::unique_ptr<PassManager> pm;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!idlePassManagers.empty()) {
+        pm = std::move(idlePassManagers.back());
+        idlePassManagers.pop_back();
+      }
+    }
+    // The pipeline already parsed once, so this can't fail.
+    if (!pm)
+      pm = parse(llvm::nulls());
+    LogicalResult result = pm->run(op);
+    std::lock_guard<std::mutex> lock(mutex);
+    idlePassManagers.push_back(std::move(pm));
+    return result;
+  }
+
+private:
+  Pipeline(MLIRContext *context, StringRef pipeline)
+      : context(context), pipeline(pipeline.str()) {}
+
+  std::unique_ptr<PassManager> parse(raw_ostream &errorStream) {
+    FailureOr<OpPassManager> parsed = parsePassPipeline(pipeline, errorStream);
+    if (failed(parsed))
+      return nullptr;
+    auto pm =
+        std::make_unique<PassManager>(context, parsed->getOpAnchorName());
+    static_cast<OpPassManager &>(*pm) = std::move(*parsed);
+    return pm;
+  }
+
+  MLIRContext *context;
+  std::string pipeline;
+  std::mutex mutex;
+  std::vector<std::unique_ptr<PassManager>> idlePassManagers;
+};
+} // namespace
+
+TorchMlirPipeline torchMlirPipelineCreate(MlirContext context,
+                                          MlirStringRef pipeline,
+                                          MlirStringCallback errorCallback,
+                                          void *userData) {
+  detail::CallbackOstream errorStream(errorCallback, userData);
+  std::unique_ptr<Pipeline> result =
+      Pipeline::create(unwrap(context), unwrap(pipeline), errorStream);
+  errorStream.flush();
+  return {result.release()};
+}
+
+void torchMlirPipelineDestroy(TorchMlirPipeline pipeline) {
+  delete static_cast<Pipeline *>(pipeline.ptr);
+}
+
+MlirLogicalResult torchMlirPipelineRunOnOp(TorchMlirPipeline pipeline,
+                                           MlirOperation op) {
+  return wrap(static_cast<Pipeline *>(pipeline.ptr)->run(unwrap(op)));
+}
@@ -0,0 +1,54 @@
+//===- Threading.cpp - C Interface for context threading ------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "torch-mlir-c/Threading.h"
+
+#include "mlir/CAPI/IR.h"
+#include "mlir/IR/MLIRContext.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+
+#include <memory>
+#include <mutex>
+
+// Returns the thread pool shared by the contexts that use `numThreads`
+// threads. The pools are never destroyed, since a context doesn't own the
+// pool it is given and may outlive any other owner.
+static llvm::ThreadPool &getSharedThreadPool(unsigned numThreads) {
+  static std::mutex mutex;
+  static auto *pools =
+      new llvm::DenseMap<unsigned, std::unique_ptr<llvm::ThreadPool>>();
+  std::lock_guard<std::mutex> lock(mutex);
+  std::unique_ptr<llvm::ThreadPool> &pool = (*pools)[numThreads];
+  if (!pool)
+    pool = std::make_unique<llvm::ThreadPool>(
+        llvm::hardware_concurrency(numThreads));
+  return *pool;
+}
+
+void torchMlirContextSetThreadPoolSize(MlirContext context,
+                                       unsigned numThreads) {
+  mlir::MLIRContext *ctx = unwrap(context);
+  // A context only accepts a new thread pool with multithreading disabled,
+  // and enables it again itself.
+  ctx->disableMultithreading();
+  ctx->setThreadPool(getSharedThreadPool(numThreads));
+}
+
+unsigned torchMlirContextGetThreadPoolSize(MlirContext context) {
+  mlir::MLIRContext *ctx = unwrap(context);
+  if (!ctx->isMultithreadingEnabled())
+    return 0;
+  return ctx->getNumThreads();
+}
+
+bool torchMlirContextIsMultithreadingEnabled(MlirContext context) {
+  return unwrap(context)->isMultithreadingEnabled();
+}
@@ -239,6 +239,17 @@ MlirType torchMlirTorchNonValueTensorTypeGet(MlirContext context,
       unwrap(context), optionalSizesArrayRef, unwrap(optionalDtype)));
 }
 
+MlirType torchMlirTorchNonValueTensorTypeGetWithSparsity(
+    MlirContext context, intptr_t numSizes, const int64_t *optionalSizes,
+    MlirType optionalDtype, MlirAttribute optionalSparsity) {
+  std::optional<ArrayRef<int64_t>> optionalSizesArrayRef = std::nullopt;
+  if (numSizes > -1)
+    optionalSizesArrayRef = llvm::ArrayRef(optionalSizes, numSizes);
+  return wrap(Torch::NonValueTensorType::get(
+      unwrap(context), optionalSizesArrayRef, unwrap(optionalDtype),
+      unwrap(optionalSparsity)));
+}
+
 MlirType torchMlirTorchNonValueTensorTypeGetWithLeastStaticInformation(
     MlirContext context) {
   return wrap(Torch::NonValueTensorType::getWithLeastStaticInformation(
@@ -302,6 +313,17 @@ MlirType torchMlirTorchValueTensorTypeGet(MlirContext context,
       unwrap(context), optionalSizesArrayRef, unwrap(optionalDtype)));
 }
 
+MlirType torchMlirTorchValueTensorTypeGetWithSparsity(
+    MlirContext context, intptr_t numSizes, const int64_t *optionalSizes,
+    MlirType optionalDtype, MlirAttribute optionalSparsity) {
+  std::optional<ArrayRef<int64_t>> optionalSizesArrayRef = std::nullopt;
+  if (numSizes > -1)
+    optionalSizesArrayRef = llvm::ArrayRef(optionalSizes, numSizes);
+  return wrap(Torch::ValueTensorType::get(
+      unwrap(context), optionalSizesArrayRef, unwrap(optionalDtype),
+      unwrap(optionalSparsity)));
+}
+
 MlirType torchMlirTorchValueTensorTypeGetWithLeastStaticInformation(
     MlirContext context) {
   return wrap(
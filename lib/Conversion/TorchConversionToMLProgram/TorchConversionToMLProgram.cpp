@@ -16,7 +16,9 @@
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/DialectResourceBlobManager.h"
 #include "mlir/IR/MLIRContext.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/TorchConversion/IR/TorchConversionOps.h"
 #include "torch-mlir/Dialect/TorchConversion/Transforms/BackendTypeConversion.h"
 
@@ -26,27 +28,30 @@ using namespace mlir::torch::Torch;
 using namespace mlir::torch::TorchConversion;
 
 static constexpr StringRef getSeedGobalVarName() { return "global_seed"; }
+static constexpr StringRef getRngOffsetGobalVarName() {
+  return "global_rng_offset";
+}
 
-// Declare a tensor<i64> global variable for the seed.
-static LogicalResult getOrCreateGlobalVariableForSeed(OpBuilder &b,
-                                                      ModuleOp module) {
-  auto globalSeedSymbol =
-      SymbolTable::lookupSymbolIn(module, getSeedGobalVarName());
+// Declare a tensor<i64> global variable named `name` for the RNG state.
+static LogicalResult getOrCreateGlobalVariableForRngState(OpBuilder &b,
+                                                          ModuleOp module,
+                                                          StringRef name) {
+  auto globalSymbol = SymbolTable::lookupSymbolIn(module, name);
 
   Type elemTy = b.getI64Type();
   auto tensorType = RankedTensorType::get({}, elemTy);
 
-  if (globalSeedSymbol) {
-    auto globalSeed = dyn_cast<ml_program::GlobalOp>(globalSeedSymbol);
-    if (!globalSeed || globalSeed.getType() != tensorType)
-      return module.emitError("Unexpected type for global seed.");
+  if (globalSymbol) {
+    auto global = dyn_cast<ml_program::GlobalOp>(globalSymbol);
+    if (!global || global.getType() != tensorType)
+      return module.emitError("Unexpected type for global ") << name << ".";
     return success();
   }
 
   b.setInsertionPointToStart(module.getBody());
   b.create<ml_program::GlobalOp>(
       UnknownLoc::get(b.getContext()),
-      /*sym_name=*/getSeedGobalVarName(),
+      /*sym_name=*/name,
       /*type=*/tensorType,
       /*is_mutable=*/true,
       /*value=*/DenseIntElementsAttr::get(tensorType, {APInt(64, 0)}),
@@ -92,6 +97,198 @@ public:
 };
 } // namespace
 
+namespace {
+class ConvertGetNextRngOffsetOp
+    : public OpConversionPattern<GetNextRngOffsetOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(GetNextRngOffsetOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op.getLoc();
+    // The seed is only read. The offset is advanced by the number of random
+    // numbers reserved:
+    //    nextOffset = (offset + increment) mod 2^64.
+    auto tensorType = RankedTensorType::get({}, rewriter.getI64Type());
+    Value globalSeed = rewriter.create<ml_program::GlobalLoadOp>(
+        loc, tensorType,
+        SymbolRefAttr::get(op->getContext(), getSeedGobalVarName()));
+    Value seed = rewriter.create<tensor::ExtractOp>(loc, globalSeed);
+    Value globalOffset = rewriter.create<ml_program::GlobalLoadOp>(
+        loc, tensorType,
+        SymbolRefAttr::get(op->getContext(), getRngOffsetGobalVarName()));
+    Value offset = rewriter.create<tensor::ExtractOp>(loc, globalOffset);
+    Value nextOffset =
+        rewriter.create<arith::AddIOp>(loc, offset, adaptor.getIncrement());
+    globalOffset = rewriter.create<tensor::InsertOp>(
+        loc, nextOffset, globalOffset, ValueRange());
+    rewriter.create<ml_program::GlobalStoreOp>(
+        loc, SymbolRefAttr::get(op->getContext(), getRngOffsetGobalVarName()),
+        globalOffset);
+    rewriter.replaceOp(op, {seed, offset});
+    return success();
+  }
+};
+} // namespace
+
+// Declare an immutable global with external storage for each distinct name
+// used by a `torch.vtensor.external` op.
+static LogicalResult
+createGlobalsForExternalTensors(OpBuilder &b, ModuleOp module,
+                                const TypeConverter &typeConverter) {
+  SymbolTable symbolTable(module);
+  auto walkResult = module.walk([&](ValueTensorExternalOp op) {
+    auto tensorType =
+        typeConverter.convertType(op.getType()).dyn_cast<RankedTensorType>();
+    if (!tensorType) {
+      op.emitError("unsupported type for external tensor");
+      return WalkResult::interrupt();
+    }
+    if (Operation *symbol = symbolTable.lookup(op.getName())) {
+      auto global = dyn_cast<ml_program::GlobalOp>(symbol);
+      if (!global || global.getType() != tensorType ||
+          !global.getValueAttr().dyn_cast_or_null<ml_program::ExternAttr>()) {
+        op.emitError("conflicting definition of external tensor '")
+            << op.getName() << "'";
+        return WalkResult::interrupt();
+      }
+      return WalkResult::advance();
+    }
+    b.setInsertionPointToStart(module.getBody());
+    auto global = b.create<ml_program::GlobalOp>(
+        op.getLoc(),
+        /*sym_name=*/op.getName(),
+        /*type=*/tensorType,
+        /*is_mutable=*/false,
+        /*value=*/ml_program::ExternAttr::get(b.getContext(), tensorType),
+        /*sym_visibility=*/b.getStringAttr("private"));
+    symbolTable.insert(global);
+    return WalkResult::advance();
+  });
+  return failure(walkResult.wasInterrupted());
+}
+
+namespace {
+class ConvertValueTensorExternalOp
+    : public OpConversionPattern<ValueTensorExternalOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(ValueTensorExternalOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Type tensorType = getTypeConverter()->convertType(op.getType());
+    rewriter.replaceOpWithNewOp<ml_program::GlobalLoadConstOp>(
+        op, tensorType,
+        SymbolRefAttr::get(op->getContext(), op.getName()));
+    return success();
+  }
+};
+} // namespace
+
+// Returns `elements` with signless integer elements, as expected by builtin
+// tensors.
+static Attribute getBuiltinElementsAttr(ElementsAttr elements) {
+  MLIRContext *context = elements.getContext();
+  if (auto intElements = elements.dyn_cast<DenseIntElementsAttr>()) {
+    unsigned bitWidth = intElements.getElementType().getIntOrFloatBitWidth();
+    return intElements.mapValues(
+        IntegerType::get(context, bitWidth),
+        [&](const APInt &v) { return APInt(bitWidth, v.getSExtValue()); });
+  }
+  if (auto resourceElements = elements.dyn_cast<DenseResourceElementsAttr>()) {
+    auto type = resourceElements.getType().cast<RankedTensorType>();
+    if (auto intType = type.getElementType().dyn_cast<IntegerType>()) {
+      auto builtinType = RankedTensorType::get(
+          type.getShape(),
+          IntegerType::get(context, intType.getIntOrFloatBitWidth()));
+      AsmResourceBlob *blob = resourceElements.getRawHandle().getBlob();
+      assert(blob && "Expecting dense resource with a valid blob");
+      return DenseElementsAttr::get(builtinType, blob->getData());
+    }
+  }
+  return elements;
+}
+
+// Replace each `torch.global_slot` holding tensor state, as allowed by the
+// backend contract, with a mutable global of the same name initialized with
+// the literal initializing the slot, and erase the module initializer.
+static LogicalResult
+createGlobalsForGlobalSlots(OpBuilder &b, ModuleOp module,
+                            const TypeConverter &typeConverter) {
+  auto initializers = module.getOps<GlobalSlotModuleInitializerOp>();
+  if (initializers.empty())
+    return success();
+  GlobalSlotModuleInitializerOp initializer = *initializers.begin();
+  auto initialize =
+      cast<InitializeGlobalSlotsOp>(initializer.getBody()->getTerminator());
+  for (auto [symName, initialValue] :
+       llvm::zip(initialize.getSlotSymNames(), initialize.getInitialValues())) {
+    auto slot = SymbolTable::lookupNearestSymbolFrom<GlobalSlotOp>(
+        module, symName.cast<FlatSymbolRefAttr>());
+    auto literal = initialValue.getDefiningOp<ValueTensorLiteralOp>();
+    auto tensorType = slot ? typeConverter.convertType(slot.getTypeBound())
+                                 .dyn_cast<RankedTensorType>()
+                           : RankedTensorType();
+    if (!literal || !tensorType)
+      return initialize.emitError("unsupported global slot ") << symName;
+    b.setInsertionPoint(slot);
+    b.create<ml_program::GlobalOp>(
+        slot.getLoc(),
+        /*sym_name=*/slot.getSymName(),
+        /*type=*/tensorType,
+        /*is_mutable=*/true,
+        /*value=*/getBuiltinElementsAttr(literal.getValueAttr()),
+        /*sym_visibility=*/b.getStringAttr("private"));
+    slot.erase();
+  }
+  initializer.erase();
+  return success();
+}
+
+namespace {
+class ConvertGlobalSlotGetOp : public OpConversionPattern<GlobalSlotGetOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(GlobalSlotGetOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto global = SymbolTable::lookupNearestSymbolFrom<ml_program::GlobalOp>(
+        op, op.getSlotAttr());
+    if (!global)
+      return rewriter.notifyMatchFailure(op, "expected a global for the slot");
+    Type tensorType = getTypeConverter()->convertType(op.getType());
+    Value load = rewriter.create<ml_program::GlobalLoadOp>(
+        op.getLoc(), global.getType(), op.getSlotAttr());
+    if (load.getType() != tensorType)
+      load = rewriter.create<tensor::CastOp>(op.getLoc(), tensorType, load);
+    rewriter.replaceOp(op, load);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+class ConvertGlobalSlotSetOp : public OpConversionPattern<GlobalSlotSetOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(GlobalSlotSetOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto global = SymbolTable::lookupNearestSymbolFrom<ml_program::GlobalOp>(
+        op, op.getSlotAttr());
+    if (!global)
+      return rewriter.notifyMatchFailure(op, "expected a global for the slot");
+    Value value = adaptor.getValue();
+    if (value.getType() != global.getType())
+      value =
+          rewriter.create<tensor::CastOp>(op.getLoc(), global.getType(), value);
+    rewriter.replaceOpWithNewOp<ml_program::GlobalStoreOp>(
+        op, op.getSlotAttr(), value);
+    return success();
+  }
+};
+} // namespace
+
 // -----------------------------------------------------------------------------
 // The pass
 // -----------------------------------------------------------------------------
@@ -120,12 +317,26 @@ public:
 
     auto module = getOperation();
     OpBuilder b(module.getBodyRegion());
-    if (failed(getOrCreateGlobalVariableForSeed(b, module)))
-      signalPassFailure();
+    if (failed(getOrCreateGlobalVariableForRngState(b, module,
+                                                    getSeedGobalVarName())) ||
+        failed(getOrCreateGlobalVariableForRngState(
+            b, module, getRngOffsetGobalVarName())))
+      return signalPassFailure();
+    if (failed(createGlobalsForExternalTensors(b, module, typeConverter)))
+      return signalPassFailure();
+    if (failed(createGlobalsForGlobalSlots(b, module, typeConverter)))
+      return signalPassFailure();
 
     RewritePatternSet patterns(context);
     target.addIllegalOp<GetNextSeedOp>();
     patterns.add<ConvertGetNextSeedOp>(typeConverter, context);
+    target.addIllegalOp<GetNextRngOffsetOp>();
+    patterns.add<ConvertGetNextRngOffsetOp>(typeConverter, context);
+    target.addIllegalOp<ValueTensorExternalOp>();
+    patterns.add<ConvertValueTensorExternalOp>(typeConverter, context);
+    target.addIllegalOp<GlobalSlotGetOp, GlobalSlotSetOp>();
+    patterns.add<ConvertGlobalSlotGetOp, ConvertGlobalSlotSetOp>(typeConverter,
+                                                                 context);
 
     FrozenRewritePatternSet frozenPatterns(std::move(patterns));
 
@@ -171,8 +171,8 @@ namespace {
 /// one `linalg.TensorExpandShape` op for all expanded dimensions and one
 /// `linalg.TensorCollapseShape` op for all collapsed dimensions. Cases where
 /// there is neither an expand or collapse of dimensions (e.g. [2, 3] -> [3, 2])
-/// is not handled. Additionally, certain dynamic dimension cases rely on naive
-/// assumptions or aren't supported.
+/// are left to `ConvertAtenViewOpByFlattening`. Additionally, certain dynamic
+/// dimension cases rely on naive assumptions or aren't supported.
 /// TODO: Handle all the other cases of `aten.View` op.
 class ConvertAtenViewOp : public OpConversionPattern<AtenViewOp> {
 public:
@@ -405,6 +405,14 @@ public:
       }
     }
 
+    // The boundaries are matched in order, so a size list that reorders the
+    // sizes of the input, e.g. [size(x, 1), size(x, 0)], isn't a reassociation.
+    for (size_t i = 1; i < unchangedDims.size(); i++) {
+      if (unchangedDims[i][0] <= unchangedDims[i - 1][0])
+        return rewriter.notifyMatchFailure(
+            op, "sizes of the input dims are not in order");
+    }
+
     // Mark the end of the input/output shapes
     unchangedDims.emplace_back();
     unchangedDims.back().push_back(inputRank);
@@ -682,6 +690,218 @@ public:
 };
 } // namespace
 
+// Appends to `dims` the dims of `self` whose sizes multiply to `size`, if
+// `size` is computed from `aten.size.int` ops on `self` with `aten.mul.int`.
+static bool getSymbolicSizeProduct(Value size, Value self, int64_t rank,
+                                   SmallVectorImpl<int64_t> &dims) {
+  int64_t dim;
+  if (matchPattern(size, m_TorchTensorSizeInt(self, &dim))) {
+    dim = toPositiveDim(dim, rank);
+    if (!isValidDim(dim, rank))
+      return false;
+    dims.push_back(dim);
+    return true;
+  }
+  auto mul = size.getDefiningOp<AtenMulIntOp>();
+  return mul && getSymbolicSizeProduct(mul.getA(), self, rank, dims) &&
+         getSymbolicSizeProduct(mul.getB(), self, rank, dims);
+}
+
+namespace {
+/// Converts an `aten.view` whose sizes are products of the sizes of
+/// consecutive dims of the input, e.g. `[size(x, 0) * size(x, 1), size(x, 2)]`,
+/// to a `tensor.collapse_shape`. The sizes prove how the dims are grouped even
+/// when they are dynamic, which `ConvertAtenViewOp` has to guess. Static sizes
+/// are matched with a static dim of the same size.
+class ConvertAtenViewOpOfSymbolicSizes
+    : public OpConversionPattern<AtenViewOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenViewOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Value input = adaptor.getSelf();
+    auto inputType = input.getType().cast<RankedTensorType>();
+    int64_t inputRank = inputType.getRank();
+    SmallVector<Value> sizes;
+    if (!getListConstructElements(op.getSize(), sizes))
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: the target size is not constructed from "
+              "ListConstruct");
+
+    SmallVector<ReassociationIndices> reassociation;
+    int64_t nextDim = 0;
+    for (Value size : sizes) {
+      ReassociationIndices dims;
+      int64_t staticSize;
+      if (matchPattern(size, m_TorchConstantInt(&staticSize))) {
+        if (nextDim >= inputRank ||
+            inputType.getDimSize(nextDim) != staticSize)
+          return rewriter.notifyMatchFailure(
+              op, "static size doesn't match the next dim of the input");
+        dims.push_back(nextDim);
+      } else if (!getSymbolicSizeProduct(size, op.getSelf(), inputRank,
+                                         dims)) {
+        return rewriter.notifyMatchFailure(
+            op, "size is not a product of the sizes of the input");
+      }
+      llvm::sort(dims);
+      for (int64_t dim : dims) {
+        if (dim != nextDim++)
+          return rewriter.notifyMatchFailure(
+              op, "size is not a product of the sizes of consecutive dims");
+      }
+      reassociation.push_back(dims);
+    }
+    if (nextDim != inputRank)
+      return rewriter.notifyMatchFailure(
+          op, "sizes don't cover all the dims of the input");
+    if (llvm::all_of(reassociation, [](const ReassociationIndices &dims) {
+          return dims.size() == 1;
+        }))
+      return rewriter.notifyMatchFailure(op, "no dims are collapsed");
+
+    auto resultType = getTypeConverter()
+                          ->convertType(op.getType())
+                          .cast<RankedTensorType>();
+    Value collapsed = rewriter.create<tensor::CollapseShapeOp>(
+        op.getLoc(), input, reassociation);
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, collapsed);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+/// Converts the `aten.view` ops that `ConvertAtenViewOp` can't match dim by
+/// dim, e.g. [2, 3] -> [3, 2]. The input is collapsed to a single dim, which
+/// is expanded to the result shape when that shape has at most one dynamic
+/// dim, so that the view stays metadata-only. Otherwise the view is converted
+/// to a `tensor.reshape`, which can copy the input, and is counted in the
+/// `num-copied-views` statistic of the pass.
+class ConvertAtenViewOpByFlattening : public OpConversionPattern<AtenViewOp> {
+public:
+  ConvertAtenViewOpByFlattening(
+      TypeConverter &typeConverter, MLIRContext *context,
+      const torch_to_linalg::DataMovementStatistics &statistics)
+      : OpConversionPattern(typeConverter, context, /*benefit=*/0),
+        statistics(statistics) {}
+  LogicalResult
+  matchAndRewrite(AtenViewOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Location loc = op.getLoc();
+    Value input = adaptor.getSelf();
+    auto inputType = input.getType().cast<RankedTensorType>();
+    int64_t inputRank = inputType.getRank();
+    TypeConverter *typeConverter = getTypeConverter();
+    auto resultType =
+        typeConverter->convertType(op.getType()).cast<RankedTensorType>();
+    int64_t resultRank = resultType.getRank();
+    Type elementType = resultType.getElementType();
+    if (inputRank == 0 || resultRank == 0)
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: input or result of rank 0");
+    SmallVector<Value> sizes;
+    if (!getListConstructElements(op.getSize(), sizes))
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: the target size is not constructed from "
+              "ListConstruct");
+    if (resultRank != (int64_t)sizes.size())
+      return rewriter.notifyMatchFailure(
+          op, "desired size list length mismatches with the result type rank");
+
+    // Complete the result shape with the constant sizes.
+    SmallVector<int64_t> resultShape =
+        makeShapeTorchCompatible(resultType.getShape());
+    for (auto en : llvm::enumerate(sizes)) {
+      int64_t size;
+      if (matchPattern(en.value(), m_TorchConstantInt(&size)) && size >= 0)
+        resultShape[en.index()] = size;
+    }
+
+    int64_t numDynamicDims = llvm::count(resultShape, kUnknownSize);
+    if (numDynamicDims <= 1) {
+      Value flat = input;
+      if (inputRank > 1) {
+        ReassociationIndices allDims =
+            llvm::to_vector(llvm::seq<int64_t>(0, inputRank));
+        flat = rewriter.create<tensor::CollapseShapeOp>(
+            loc, input, ArrayRef<ReassociationIndices>{allDims});
+      }
+      if (resultRank == 1) {
+        rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, flat);
+        return success();
+      }
+      // The flat tensor is dynamic iff the result has a dynamic dim, as
+      // `tensor.expand_shape` requires.
+      int64_t numElements = kUnknownSize;
+      if (numDynamicDims == 0)
+        numElements = std::accumulate(resultShape.begin(), resultShape.end(),
+                                      (int64_t)1, std::multiplies<int64_t>());
+      auto flatType = RankedTensorType::get(
+          makeShapeLLVMCompatible({numElements}), elementType);
+      if (flat.getType() != flatType)
+        flat = rewriter.create<tensor::CastOp>(loc, flatType, flat);
+      ReassociationIndices allDims =
+          llvm::to_vector(llvm::seq<int64_t>(0, resultRank));
+      Value expanded = rewriter.create<tensor::ExpandShapeOp>(
+          loc,
+          RankedTensorType::get(makeShapeLLVMCompatible(resultShape),
+                                elementType),
+          flat, ArrayRef<ReassociationIndices>{allDims});
+      rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, expanded);
+      return success();
+    }
+
+    // The sizes of a result with several dynamic dims can't be inferred by
+    // `tensor.expand_shape`, so they are given to a `tensor.reshape`. The size
+    // given as -1 is the number of elements divided by the other sizes.
+    SmallVector<Value> shape;
+    std::optional<int64_t> inferredDim;
+    Value knownNumElements =
+        rewriter.create<arith::ConstantIndexOp>(loc, 1);
+    for (auto en : llvm::enumerate(
+             getTypeConvertedValues(rewriter, loc, typeConverter, sizes))) {
+      int64_t size;
+      if (matchPattern(sizes[en.index()], m_TorchConstantInt(&size)) &&
+          size == -1) {
+        inferredDim = en.index();
+        shape.push_back(nullptr);
+        continue;
+      }
+      Value dimSize = castIntToIndex(rewriter, loc, en.value());
+      knownNumElements =
+          rewriter.create<arith::MulIOp>(loc, knownNumElements, dimSize);
+      shape.push_back(dimSize);
+    }
+    if (inferredDim) {
+      Value numElements = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+      for (Value dimSize : getTensorSizes(rewriter, loc, input))
+        numElements = rewriter.create<arith::MulIOp>(loc, numElements, dimSize);
+      shape[*inferredDim] =
+          rewriter.create<arith::DivSIOp>(loc, numElements, knownNumElements);
+    }
+    Value shapeTensor = rewriter.create<tensor::FromElementsOp>(loc, shape);
+    Value reshaped = rewriter.create<tensor::ReshapeOp>(
+        loc,
+        RankedTensorType::get(makeShapeLLVMCompatible(resultShape),
+                              elementType),
+        input, shapeTensor);
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, reshaped);
+    if (statistics.numCopiedViews)
+      ++*statistics.numCopiedViews;
+    return success();
+  }
+
+private:
+  torch_to_linalg::DataMovementStatistics statistics;
+};
+} // namespace
+
 namespace {
 class ConvertAtenSqueezeOp : public OpConversionPattern<AtenSqueezeOp> {
 public:
@@ -1162,6 +1382,125 @@ public:
 };
 } // namespace
 
+namespace {
+// Lowers `aten.roll` by copying each block of the input that the roll moves
+// as a whole straight to its place in the result. Rolling a dim of size `n`
+// by `s`, taken modulo `n`, moves `input[0:n-s]` to `result[s:n]` and
+// `input[n-s:n]` to `result[0:s]`. Rolling `k` dims thus copies `2^k` blocks,
+// which together read the input and write the result once, whereas slicing
+// and concatenating copies the whole tensor twice for each dim.
+class ConvertAtenRollOp : public OpConversionPattern<AtenRollOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenRollOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Location loc = op.getLoc();
+    TypeConverter *typeConverter = getTypeConverter();
+
+    SmallVector<Value> shifts, dims;
+    if (!getListConstructElements(op.getShifts(), shifts) ||
+        !getListConstructElements(op.getDims(), dims))
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: shifts and dims must be lists");
+    // Without dims, the roll is of the flattened input.
+    if (dims.empty() || shifts.size() != dims.size())
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: expected a shift for each dim");
+
+    Value input = adaptor.getSelf();
+    auto inputType = input.getType().cast<RankedTensorType>();
+    int64_t rank = inputType.getRank();
+    RankedTensorType resultType =
+        typeConverter->convertType(op.getType()).cast<RankedTensorType>();
+
+    // The total shift of each dim, which is null for the dims that aren't
+    // rolled. A dim can be rolled several times.
+    SmallVector<Value> dimShifts(rank);
+    for (auto [dimValue, shift] : llvm::zip_equal(dims, shifts)) {
+      int64_t dim;
+      if (!matchPattern(dimValue, m_TorchConstantInt(&dim)))
+        return rewriter.notifyMatchFailure(
+            op, "unimplemented: dims must be constants");
+      dim = toPositiveDim(dim, rank);
+      if (!isValidDim(dim, rank))
+        return rewriter.notifyMatchFailure(op, "dim is statically invalid");
+      int64_t constantShift;
+      Value shiftIndex =
+          matchPattern(shift, m_TorchConstantInt(&constantShift))
+              ? rewriter.create<arith::ConstantIndexOp>(loc, constantShift)
+              : castIntToIndex(rewriter, loc,
+                               typeConverter->materializeTargetConversion(
+                                   rewriter, loc,
+                                   typeConverter->convertType(shift.getType()),
+                                   shift));
+      dimShifts[dim] = dimShifts[dim] ? rewriter.createOrFold<arith::AddIOp>(
+                                            loc, dimShifts[dim], shiftIndex)
+                                      : shiftIndex;
+    }
+
+    // For each dim, the offsets in the input and the result, and the sizes,
+    // of the blocks it is split into: one for the dims that aren't rolled and
+    // two for the others.
+    struct RollBlock {
+      Value inputOffset;
+      Value resultOffset;
+      Value size;
+    };
+    SmallVector<SmallVector<RollBlock, 2>> dimBlocks;
+    SmallVector<Value> sizes = getTensorSizes(rewriter, loc, input);
+    Value zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+    Value one = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+    for (int64_t dim = 0; dim < rank; ++dim) {
+      Value size = sizes[dim];
+      if (!dimShifts[dim]) {
+        dimBlocks.push_back({{zero, zero, size}});
+        continue;
+      }
+      // shift = ((shift % size) + size) % size, with a size of at least one
+      // so that empty dims don't divide by zero.
+      Value divisor = rewriter.createOrFold<arith::MaxSIOp>(loc, size, one);
+      Value shift =
+          rewriter.createOrFold<arith::RemSIOp>(loc, dimShifts[dim], divisor);
+      shift = rewriter.createOrFold<arith::AddIOp>(loc, shift, divisor);
+      shift = rewriter.createOrFold<arith::RemSIOp>(loc, shift, divisor);
+      Value rest = rewriter.createOrFold<arith::SubIOp>(loc, size, shift);
+      dimBlocks.push_back({{zero, shift, rest}, {rest, zero, shift}});
+    }
+
+    Value result = rewriter.create<tensor::EmptyOp>(
+        loc, getAsOpFoldResult(sizes), resultType.getElementType());
+    SmallVector<OpFoldResult> strides(rank, rewriter.getIndexAttr(1));
+    // Copy each combination of the blocks of the dims.
+    SmallVector<unsigned> blockIndices(rank, 0);
+    while (true) {
+      SmallVector<OpFoldResult> inputOffsets, resultOffsets, blockSizes;
+      for (int64_t dim = 0; dim < rank; ++dim) {
+        const RollBlock &block = dimBlocks[dim][blockIndices[dim]];
+        inputOffsets.push_back(getAsOpFoldResult(block.inputOffset));
+        resultOffsets.push_back(getAsOpFoldResult(block.resultOffset));
+        blockSizes.push_back(getAsOpFoldResult(block.size));
+      }
+      Value slice = rewriter.create<tensor::ExtractSliceOp>(
+          loc, input, inputOffsets, blockSizes, strides);
+      result = rewriter.create<tensor::InsertSliceOp>(
+          loc, slice, result, resultOffsets, blockSizes, strides);
+
+      int64_t dim = rank - 1;
+      while (dim >= 0 && ++blockIndices[dim] == dimBlocks[dim].size())
+        blockIndices[dim--] = 0;
+      if (dim < 0)
+        break;
+    }
+
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, result);
+    return success();
+  }
+};
+} // namespace
+
 namespace {
 class ConvertAtenBroadcastToOp : public OpConversionPattern<AtenBroadcastToOp> {
 public:
@@ -1332,6 +1671,12 @@ public:
 } // namespace
 
 namespace {
+// The real and imaginary parts are read through two slices of the input along
+// its last dimension, which bufferize to strided views of it rather than
+// copies. The generic op combining them is elementwise, so it fuses with the
+// elementwise ops consuming the complex tensor, e.g. the complex
+// multiplication and `aten.real`/`aten.imag` of rotary embeddings, and the
+// complex tensor is not materialized.
 class ConvertAtenViewAsComplexOp
     : public OpConversionPattern<AtenViewAsComplexOp> {
 public:
@@ -1345,62 +1690,42 @@ public:
 
     Location loc = op.getLoc();
     TypeConverter *typeConverter = getTypeConverter();
-    MLIRContext *context = rewriter.getContext();
 
     auto input = adaptor.getSelf();
+    auto inputType = input.getType().cast<RankedTensorType>();
+    int64_t inputRank = inputType.getRank();
 
     RankedTensorType resultType =
         typeConverter->convertType(op.getType()).cast<RankedTensorType>();
-
     auto elementType = resultType.getElementType();
-    SmallVector<Value> resultShape;
-    for (int64_t i = 0; i < resultType.getRank(); i++) {
-      auto currentDimSize = rewriter.create<tensor::DimOp>(loc, input, i);
-      resultShape.push_back(currentDimSize);
-    }
-
-    Value outTensor = rewriter.create<tensor::EmptyOp>(
-        loc, getAsOpFoldResult(resultShape), elementType);
 
-    SmallVector<AffineExpr> outputExpr;
-    for (unsigned i = 0; i < resultType.getRank(); i++) {
-      outputExpr.push_back(getAffineDimExpr(i, context));
-    }
-
-    Value constantZero =
-        getConstant(rewriter, loc, 0, mlir::IndexType::get(context));
-    Value constantOne =
-        getConstant(rewriter, loc, 1, mlir::IndexType::get(context));
-
-    AffineMap outputMap =
-        AffineMap::get(resultType.getRank(), 0, outputExpr, op->getContext());
-
-    SmallVector<AffineMap> indexingMaps{outputMap};
+    SmallVector<OpFoldResult> offsets(inputRank, rewriter.getIndexAttr(0));
+    SmallVector<OpFoldResult> sizes =
+        tensor::getMixedSizes(rewriter, loc, input);
+    sizes.back() = rewriter.getIndexAttr(1);
+    SmallVector<OpFoldResult> strides(inputRank, rewriter.getIndexAttr(1));
+    auto partType = RankedTensorType::get(inputType.getShape().drop_back(),
+                                          inputType.getElementType());
+    Value realPart = rewriter.create<tensor::ExtractSliceOp>(
+        loc, partType, input, offsets, sizes, strides);
+    offsets.back() = rewriter.getIndexAttr(1);
+    Value imagPart = rewriter.create<tensor::ExtractSliceOp>(
+        loc, partType, input, offsets, sizes, strides);
+
+    sizes.pop_back();
+    Value outTensor = rewriter.create<tensor::EmptyOp>(loc, sizes, elementType);
+    SmallVector<AffineMap> indexingMaps(
+        3, rewriter.getMultiDimIdentityMap(partType.getRank()));
     SmallVector<utils::IteratorType> iteratorTypes(
-        resultType.getRank(), utils::IteratorType::parallel);
+        partType.getRank(), utils::IteratorType::parallel);
     auto complexVar =
         rewriter
             .create<linalg::GenericOp>(
-                loc, outTensor.getType(), ValueRange{}, outTensor, indexingMaps,
-                iteratorTypes,
+                loc, outTensor.getType(), ValueRange{realPart, imagPart},
+                outTensor, indexingMaps, iteratorTypes,
                 [&](OpBuilder &b, Location loc, ValueRange args) {
-                  SmallVector<Value> indicesZero;
-                  SmallVector<Value> indicesOne;
-
-                  for (int i = 0; i < resultType.getRank(); i++) {
-                    indicesZero.push_back(b.create<linalg::IndexOp>(loc, i));
-                    indicesOne.push_back(b.create<linalg::IndexOp>(loc, i));
-                  }
-
-                  indicesZero.push_back(constantZero);
-                  indicesOne.push_back(constantOne);
-
-                  Value realVal =
-                      b.create<tensor::ExtractOp>(loc, input, indicesZero);
-                  Value imagVal =
-                      b.create<tensor::ExtractOp>(loc, input, indicesOne);
                   Value complexVal = b.create<complex::CreateOp>(
-                      loc, elementType, realVal, imagVal);
+                      loc, elementType, args[0], args[1]);
                   b.create<linalg::YieldOp>(loc, complexVal);
                 })
             .getResult(0);
@@ -1412,12 +1737,16 @@ public:
 
 void mlir::torch::torch_to_linalg::populateDataMovementPatternsAndLegality(
     TypeConverter &typeConverter, RewritePatternSet &patterns,
-    ConversionTarget &target) {
+    ConversionTarget &target, const DataMovementStatistics &statistics) {
   MLIRContext *context = patterns.getContext();
   target.addIllegalOp<AtenFlattenUsingIntsOp>();
   patterns.add<ConvertAtenFlattenUsingIntsOp>(typeConverter, context);
   target.addIllegalOp<AtenViewOp>();
+  patterns.add<ConvertAtenViewOpOfSymbolicSizes>(typeConverter, context,
+                                                 /*benefit=*/2);
   patterns.add<ConvertAtenViewOp>(typeConverter, context);
+  patterns.add<ConvertAtenViewOpByFlattening>(typeConverter, context,
+                                              statistics);
   target.addIllegalOp<AtenSqueezeOp>();
   patterns.add<ConvertAtenSqueezeOp>(typeConverter, context);
   target.addIllegalOp<AtenSqueezeDimOp>();
@@ -1432,6 +1761,8 @@ void mlir::torch::torch_to_linalg::populateDataMovementPatternsAndLegality(
   patterns.add<ConvertAtenSliceTensorOp>(typeConverter, context);
   target.addIllegalOp<AtenCatOp>();
   patterns.add<ConvertAtenCatOp>(typeConverter, context);
+  target.addIllegalOp<AtenRollOp>();
+  patterns.add<ConvertAtenRollOp>(typeConverter, context);
   target.addIllegalOp<AtenBroadcastToOp>();
   patterns.add<ConvertAtenBroadcastToOp>(typeConverter, context);
   target.addIllegalOp<AtenContiguousOp>();
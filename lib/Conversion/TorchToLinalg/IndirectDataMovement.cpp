@@ -16,6 +16,7 @@
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/Matchers.h"
 #include "torch-mlir/Conversion/Utils/Utils.h"
@@ -64,6 +65,89 @@ static void createLinalgPayloadCalculationForGatherOps(
   b.create<linalg::YieldOp>(loc, extract);
 }
 
+// Gathers the slices of `input` along its dimension `dim` given by `indices`:
+//
+//   result[j_0, ..., j_dim-1, i_1, ..., i_k, ...] =
+//       input[j_0, ..., j_dim-1, indices[i_1, ..., i_k], ...]
+//
+// Rather than extracting every element of the result, a loop nest over the
+// dims of `input` before `dim` and over `indices` copies each slice of the
+// trailing dims with a tensor.extract_slice and a tensor.insert_slice, so that
+// the copy of the contiguous slice can be vectorized or turned into a memcpy
+// by the backend.
+static Value createSliceGather(OpBuilder &b, Location loc, Value input,
+                               Value indices, int64_t dim, Type elementType) {
+  auto inputType = input.getType().cast<RankedTensorType>();
+  auto indicesType = indices.getType().cast<RankedTensorType>();
+  int64_t inputRank = inputType.getRank();
+  int64_t indicesRank = indicesType.getRank();
+  int64_t sliceRank = inputRank - dim - 1;
+  int64_t loopCount = dim + indicesRank;
+
+  SmallVector<OpFoldResult> inputSizes = tensor::getMixedSizes(b, loc, input);
+  SmallVector<OpFoldResult> sliceSizes(inputSizes.begin() + dim + 1,
+                                       inputSizes.end());
+  SmallVector<OpFoldResult> resultSizes(inputSizes.begin(),
+                                        inputSizes.begin() + dim);
+  resultSizes.append(tensor::getMixedSizes(b, loc, indices));
+  resultSizes.append(sliceSizes);
+  Value init = b.create<tensor::EmptyOp>(loc, resultSizes, elementType);
+
+  Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
+  Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+  SmallVector<Value> lbs(loopCount, zero), steps(loopCount, one);
+  SmallVector<Value> ubs = getTensorSizes(b, loc, input);
+  ubs.resize(dim);
+  ubs.append(getTensorSizes(b, loc, indices));
+  Value inputDimSize = getDimOp(b, loc, input, dim);
+  scf::LoopNest loopNest = scf::buildLoopNest(
+      b, loc, lbs, ubs, steps, init,
+      [&](OpBuilder &b, Location loc, ValueRange ivs,
+          ValueRange iterArgs) -> scf::ValueVector {
+        Value index = castIntToIndex(
+            b, loc,
+            b.create<tensor::ExtractOp>(loc, indices, ivs.drop_front(dim)));
+        Value indexLTInputDim = b.create<arith::CmpIOp>(
+            loc, arith::CmpIPredicate::slt, index, inputDimSize);
+        b.create<cf::AssertOp>(
+            loc, indexLTInputDim,
+            b.getStringAttr("index must be smaller than dim size"));
+        Value indexGEThanZero = b.create<arith::CmpIOp>(
+            loc, arith::CmpIPredicate::sge, index, zero);
+        b.create<cf::AssertOp>(
+            loc, indexGEThanZero,
+            b.getStringAttr("index must be larger or equal to 0"));
+
+        // The slice is extracted and inserted with the unit dims dropped.
+        SmallVector<OpFoldResult> extractOffsets =
+            getAsOpFoldResult(ivs.take_front(dim));
+        extractOffsets.push_back(index);
+        extractOffsets.append(sliceRank, b.getIndexAttr(0));
+        SmallVector<OpFoldResult> extractSizes(dim + 1, b.getIndexAttr(1));
+        extractSizes.append(sliceSizes);
+        SmallVector<OpFoldResult> extractStrides(inputRank, b.getIndexAttr(1));
+        auto sliceType =
+            tensor::ExtractSliceOp::inferCanonicalRankReducedResultType(
+                sliceRank, inputType, extractOffsets, extractSizes,
+                extractStrides);
+        Value slice = b.create<tensor::ExtractSliceOp>(
+            loc, sliceType, input, extractOffsets, extractSizes,
+            extractStrides);
+
+        SmallVector<OpFoldResult> insertOffsets = getAsOpFoldResult(ivs);
+        insertOffsets.append(sliceRank, b.getIndexAttr(0));
+        SmallVector<OpFoldResult> insertSizes(loopCount, b.getIndexAttr(1));
+        insertSizes.append(sliceSizes);
+        SmallVector<OpFoldResult> insertStrides(loopCount + sliceRank,
+                                                b.getIndexAttr(1));
+        Value inserted = b.create<tensor::InsertSliceOp>(
+            loc, slice, iterArgs[0], insertOffsets, insertSizes,
+            insertStrides);
+        return {inserted};
+      });
+  return loopNest.results[0];
+}
+
 namespace {
 class ConvertAtenGatherOp : public OpConversionPattern<AtenGatherOp> {
 public:
@@ -132,41 +216,9 @@ public:
     auto weightTy = weight.getType().cast<RankedTensorType>();
     if (weightTy.getRank() != 2)
       return rewriter.notifyMatchFailure(op, "weight must be rank 2");
-    Value embeddingDim = getDimOp(rewriter, loc, weight, 1);
-    Type elemTy = weightTy.getElementType();
-
-    SmallVector<Value> sizes = getTensorSizes(rewriter, loc, indices);
-    sizes.push_back(embeddingDim);
-    int64_t resultRank = sizes.size();
-
-    auto indicesTy = indices.getType().cast<RankedTensorType>();
-    int64_t indicesRank = indicesTy.getRank();
-    SmallVector<AffineExpr> indicesExprs;
-    for (int i = 0; i < indicesRank; i++)
-      indicesExprs.push_back(rewriter.getAffineDimExpr(i));
-    auto indicesAffineMap = AffineMap::get(
-        /*dimCount=*/resultRank,
-        /*symbolCount=*/0, indicesExprs, op->getContext());
-    SmallVector<AffineMap, 2> indexingMaps = {
-        indicesAffineMap,
-        rewriter.getMultiDimIdentityMap(resultRank),
-    };
-    SmallVector<utils::IteratorType> iteratorTypes(
-        sizes.size(), utils::IteratorType::parallel);
-    Value initTensor =
-        rewriter.create<tensor::EmptyOp>(loc, getAsOpFoldResult(sizes), elemTy);
     Value embeddingResult =
-        rewriter
-            .create<linalg::GenericOp>(
-                loc, initTensor.getType(), indices, initTensor,
-                /*indexingMaps=*/indexingMaps, /*iteratorTypes=*/iteratorTypes,
-                [&](OpBuilder &b, Location loc, ValueRange args) {
-                  Value index = args[0];
-                  createLinalgPayloadCalculationForGatherOps(
-                      b, loc, weight, weightTy.getRank(), index, /*dim=*/0,
-                      resultRank);
-                })
-            .getResult(0);
+        createSliceGather(rewriter, loc, weight, indices, /*dim=*/0,
+                          weightTy.getElementType());
     rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType,
                                                 embeddingResult);
     return success();
@@ -175,10 +227,9 @@ public:
 } // namespace
 
 namespace {
-// AtenEmbeddingPaddingIdxOp
-// SUM mode == integer 0
-// Sums bags of embeddings together from a weight tensor based on an index and
-// offset Vector. Example arguments weight = [[1, 3, 5, 3],
+// AtenEmbeddingBagPaddingIdxOp
+// Reduces bags of embeddings from a weight tensor, given by an index and an
+// offset vector. Example arguments weight = [[1, 3, 5, 3],
 //           [3, 4, 2, 1],
 //           [2, 2, 3, 2],
 //           [0, 4, 2, 1]]
@@ -186,29 +237,28 @@ namespace {
 // indices = [0, 2, 3, 1, 2, 3, 2, 1, 0, 1]
 // offsets = [0, 3, 5]
 //
-// output_tensor = initZeroTensor(offsets_length, embedding_size)
-//
-// for i in range(offsets_length):         <- dim0
-//     for j in range(indices_length):     <- dim1
-//         for k in range(embedding_size): <- dim2
-//             if(offsets[i] <= j and j < offsets[i+1]):
-//                 output_tensor[i][k] = output_tensor[i][k] +
-//                 weight[indices[j]][k]
-//             else:
-//                 break
+// Every bag is gathered and reduced in a single pass over its own indices,
+// by a linalg.generic over [num_bags x embedding_size] whose payload loops
+// over the bag:
 //
-// Indexing maps for linalg::Generic ops
+// for i in range(num_bags):                     <- dim0
+//     for k in range(embedding_size):           <- dim1
+//         acc, count = 0, 0
+//         for j in range(offsets[i], end(i)):   <- scf.for in the payload
+//             if indices[j] != padding_idx:
+//                 acc = reduce(acc,
+//                              weight[indices[j]][k] * per_sample_weights[j])
+//                 count += 1
+//         output_tensor[i][k] = mode == MEAN ? acc / count : acc
 //
+// where end(i) is offsets[i + 1], or the number of indices for the last bag if
+// include_last_offset is false, and `reduce` is an addition in the SUM and
+// MEAN modes and a maximum in the MAX mode. Empty bags produce zeros.
 //
-// indices_indexing_map  = (d0, d1, d2) -> (d1)
-// offset_indexing_map   = (d0, d1, d2) -> (d0)
-// output_indexing_map   = (d0, d1, d2) -> (d0, d2)
-//
-// TODO: Find an optimal lowering.
-//       current lowering is not optimal for bags of large embeddings.
-//       Since it traverses the output tensor multiple times. 
-//      
-//
+// In the MEAN and MAX modes, the bag sizes are the number of indices in each
+// bag that are not padding_idx, and in the MAX mode, the max indices are the
+// indices of the embeddings the maxima were taken from. In the SUM mode both
+// are vectors of zeros.
 
 class ConvertAtenEmbeddingBagPaddingIdxOp
     : public OpConversionPattern<AtenEmbeddingBagPaddingIdxOp> {
@@ -220,7 +270,6 @@ public:
     if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
       return failure();
     Location loc = op->getLoc();
-    auto context = op->getContext();
     Value weight = adaptor.getWeight();
     Value indices = adaptor.getIndices();
     Value offsets = adaptor.getOffsets();
@@ -247,10 +296,11 @@ public:
           op, "mode is expected to be a constant integer value.");
     }
 
-    if (modeInt != torch_upstream::EmbeddingBagMode::MODE_SUM) {
+    if (modeInt != torch_upstream::EmbeddingBagMode::MODE_SUM &&
+        modeInt != torch_upstream::EmbeddingBagMode::MODE_MEAN &&
+        modeInt != torch_upstream::EmbeddingBagMode::MODE_MAX) {
       return rewriter.notifyMatchFailure(
-          op,
-          "Unimplemented: Mean and Max mode are not supported yet for EmbeddingBag.");
+          op, "mode is expected to be 0 (sum), 1 (mean) or 2 (max).");
     }
 
     bool isSparse;
@@ -265,14 +315,33 @@ public:
           "Unimplemented: Sparse mode is not supported yet for EmbeddingBag.");
     }
 
-    bool discardLastOffset;
+    bool includeLastOffsetBool;
     if (!matchPattern(includeLastOffset,
-                      m_TorchConstantBool(&discardLastOffset))) {
+                      m_TorchConstantBool(&includeLastOffsetBool))) {
       return rewriter.notifyMatchFailure(
           op,
           "include_last_offset is expected to be a constant boolean value.");
     }
 
+    // A negative padding_idx, as passed by `aten._embedding_bag`, means that
+    // there is no padding.
+    int64_t paddingIdx = -1;
+    if (!op.getPaddingIdx().getType().isa<Torch::NoneType>() &&
+        !matchPattern(op.getPaddingIdx(), m_TorchConstantInt(&paddingIdx))) {
+      return rewriter.notifyMatchFailure(
+          op,
+          "padding_idx is expected to be None or a constant integer value.");
+    }
+
+    bool hasPerSampleWeights =
+        !op.getPerSampleWeights().getType().isa<Torch::NoneType>();
+    Value perSampleWeights = adaptor.getPerSampleWeights();
+    if (hasPerSampleWeights &&
+        modeInt != torch_upstream::EmbeddingBagMode::MODE_SUM) {
+      return rewriter.notifyMatchFailure(
+          op, "per_sample_weights are only supported in the sum mode.");
+    }
+
     auto weightTy = weight.getType().cast<RankedTensorType>();
     if (weightTy.getRank() != 2)
       return rewriter.notifyMatchFailure(op, "weight must be rank 2");
@@ -285,134 +354,149 @@ public:
     if (offsetsTy.getRank() != 1)
       return rewriter.notifyMatchFailure(op, "offsets much be a vector");
 
-    Type weightElemTy = weightTy.getElementType();
-
-    int64_t iterationMapDimension = weightTy.getRank() + indicesTy.getRank();
-    SmallVector<AffineExpr> indicesExpr;
-    indicesExpr.push_back(mlir::getAffineDimExpr(1, context));
-    auto indicesIndexingMap =
-          AffineMap::get(/*dimCount=*/iterationMapDimension, /*symbolCount=*/0,
-                         indicesExpr, context);
-
-    SmallVector<AffineExpr> offsetsExpr;
-    offsetsExpr.push_back(mlir::getAffineDimExpr(0, context));
+    if (hasPerSampleWeights &&
+        perSampleWeights.getType().cast<RankedTensorType>().getRank() != 1)
+      return rewriter.notifyMatchFailure(op,
+                                         "per_sample_weights must be a vector");
 
-    auto offsetIndexingMap =
-          AffineMap::get(/*dimCount=*/iterationMapDimension, /*symbolCount=*/0,
-                         offsetsExpr, context);
-
-    SmallVector<AffineExpr> outputExpr;
-    outputExpr.push_back(mlir::getAffineDimExpr(0, context));
-    outputExpr.push_back(mlir::getAffineDimExpr(2, context));
-
-    auto outputIndexingMap =
-          AffineMap::get(/*dimCount=*/iterationMapDimension, /*symbolCount=*/0,
-                         outputExpr, context);
+    Type weightElemTy = weightTy.getElementType();
+    if (!weightElemTy.isa<mlir::FloatType>())
+      return rewriter.notifyMatchFailure(op, "weight must be floating point");
+    Type indicesElemTy = indicesTy.getElementType();
+    Type offsetElemTy = offsetsTy.getElementType();
 
-    SmallVector<AffineMap, 3> indexingMaps = {
-          indicesIndexingMap,
-          offsetIndexingMap,
-          outputIndexingMap,
+    Value embeddingDim = getDimOp(rewriter, loc, weight, 1);
+    Value offsetsLength = getDimOp(rewriter, loc, offsets, 0);
+    Value indicesLength = getDimOp(rewriter, loc, indices, 0);
+    Value oneIndex = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+    Value numBags = offsetsLength;
+    if (includeLastOffsetBool)
+      numBags = rewriter.create<arith::SubIOp>(loc, offsetsLength, oneIndex);
+
+    // Computes the range of `indices` that make up the bag `bag`.
+    auto getBagBounds = [&](OpBuilder &b, Location loc, Value bag,
+                            Value &begin, Value &end) {
+      begin = castIntToIndex(b, loc,
+                             b.create<tensor::ExtractOp>(loc, offsets, bag));
+      Value next = b.create<arith::AddIOp>(loc, bag, oneIndex);
+      if (includeLastOffsetBool) {
+        end = castIntToIndex(b, loc,
+                             b.create<tensor::ExtractOp>(loc, offsets, next));
+        return;
+      }
+      // Clamp the offset that is extracted for the last bag, which ends with
+      // the indices instead.
+      Value isLast = b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::eq,
+                                             next, offsetsLength);
+      Value nextOffset = b.create<tensor::ExtractOp>(
+          loc, offsets, ValueRange{b.create<arith::SelectOp>(loc, isLast, bag,
+                                                             next)});
+      end = b.create<arith::SelectOp>(loc, isLast, indicesLength,
+                                      castIntToIndex(b, loc, nextOffset));
+    };
+    // Returns true if `index` is not padding_idx.
+    auto isNotPadding = [&](OpBuilder &b, Location loc, Value index) -> Value {
+      if (paddingIdx < 0)
+        return b.create<arith::ConstantOp>(loc, b.getBoolAttr(true));
+      return b.create<arith::CmpIOp>(
+          loc, arith::CmpIPredicate::ne, index,
+          getConstant(b, loc, paddingIdx, indicesElemTy));
     };
 
-    // Reduce along the indices dim
+    bool isMax = modeInt == torch_upstream::EmbeddingBagMode::MODE_MAX;
+    SmallVector<Value> outputSizes{numBags, embeddingDim};
+    SmallVector<Value> outputs{rewriter.create<tensor::EmptyOp>(
+        loc, getAsOpFoldResult(outputSizes), weightElemTy)};
+    if (isMax) {
+      outputs.push_back(rewriter.create<tensor::EmptyOp>(
+          loc, getAsOpFoldResult(outputSizes), indicesElemTy));
+    }
+    SmallVector<AffineMap> indexingMaps(outputs.size(),
+                                        rewriter.getMultiDimIdentityMap(2));
     SmallVector<utils::IteratorType> iteratorTypes(
-        {utils::IteratorType::parallel, utils::IteratorType::reduction,
-         utils::IteratorType::parallel});
+        2, utils::IteratorType::parallel);
+    auto embeddingBagOp = rewriter.create<linalg::GenericOp>(
+        loc, ValueRange(outputs).getTypes(), /*inputs=*/ValueRange{}, outputs,
+        /*indexingMaps=*/indexingMaps,
+        /*iteratorTypes=*/iteratorTypes,
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value bag = b.create<linalg::IndexOp>(loc, /*value=*/0);
+          Value column = b.create<linalg::IndexOp>(loc, /*value=*/1);
+          Value begin, end;
+          getBagBounds(b, loc, bag, begin, end);
+
+          Value zero = b.create<arith::ConstantOp>(
+              loc, b.getFloatAttr(weightElemTy, 0.0));
+          Value zeroIndex = b.create<arith::ConstantIndexOp>(loc, 0);
+          SmallVector<Value> inits{zero, zeroIndex};
+          if (isMax)
+            inits.push_back(getConstant(b, loc, 0, indicesElemTy));
+          auto bagLoop = b.create<scf::ForOp>(
+              loc, begin, end, oneIndex, inits,
+              [&](OpBuilder &b, Location loc, Value i, ValueRange iterArgs) {
+                Value acc = iterArgs[0];
+                Value count = iterArgs[1];
+                Value index = b.create<tensor::ExtractOp>(loc, indices, i);
+                Value elem = b.create<tensor::ExtractOp>(
+                    loc, weight,
+                    ValueRange{castIntToIndex(b, loc, index), column});
+                if (hasPerSampleWeights) {
+                  Value sampleWeight = convertScalarToDtype(
+                      b, loc,
+                      b.create<tensor::ExtractOp>(loc, perSampleWeights, i),
+                      weightElemTy);
+                  elem = b.create<arith::MulFOp>(loc, elem, sampleWeight);
+                }
+                Value isValid = isNotPadding(b, loc, index);
+                SmallVector<Value> results;
+                if (isMax) {
+                  Value isFirst = b.create<arith::CmpIOp>(
+                      loc, arith::CmpIPredicate::eq, count, zeroIndex);
+                  Value isGreater = b.create<arith::CmpFOp>(
+                      loc, arith::CmpFPredicate::OGT, elem, acc);
+                  Value takesElem = b.create<arith::AndIOp>(
+                      loc, isValid,
+                      b.create<arith::OrIOp>(loc, isFirst, isGreater));
+                  results.push_back(
+                      b.create<arith::SelectOp>(loc, takesElem, elem, acc));
+                  results.push_back(b.create<arith::SelectOp>(
+                      loc, isValid,
+                      b.create<arith::AddIOp>(loc, count, oneIndex), count));
+                  results.push_back(b.create<arith::SelectOp>(
+                      loc, takesElem, index, iterArgs[2]));
+                } else {
+                  results.push_back(b.create<arith::SelectOp>(
+                      loc, isValid, b.create<arith::AddFOp>(loc, acc, elem),
+                      acc));
+                  results.push_back(b.create<arith::SelectOp>(
+                      loc, isValid,
+                      b.create<arith::AddIOp>(loc, count, oneIndex), count));
+                }
+                b.create<scf::YieldOp>(loc, results);
+              });
+
+          SmallVector<Value> yieldValues(bagLoop.getResults());
+          yieldValues.erase(yieldValues.begin() + 1);
+          if (modeInt == torch_upstream::EmbeddingBagMode::MODE_MEAN) {
+            Value count = bagLoop.getResult(1);
+            Value isEmpty = b.create<arith::CmpIOp>(
+                loc, arith::CmpIPredicate::eq, count, zeroIndex);
+            Value countFloat = b.create<arith::SIToFPOp>(
+                loc, weightElemTy, castIndexToInt64(b, loc, count));
+            Value mean =
+                b.create<arith::DivFOp>(loc, bagLoop.getResult(0), countFloat);
+            yieldValues[0] =
+                b.create<arith::SelectOp>(loc, isEmpty, zero, mean);
+          }
+          b.create<linalg::YieldOp>(loc, yieldValues);
+        });
 
-    Value embeddingDim = getDimOp(rewriter, loc, weight, 1);
-    Value initTensor;
-    Value offsetsLength;
-    Value indicesLength;
-    if (!discardLastOffset) {
-      SmallVector<Value> sizes{getDimOp(rewriter, loc, offsets, 0),
-                                 embeddingDim};
-
-      initTensor = createZeroInitTensor(rewriter, loc, sizes, weightElemTy);
-      offsetsLength = getDimOp(rewriter, loc, offsets, 0);
-      indicesLength = getDimOp(rewriter, loc, indices, 0);
-    } else {
-      return rewriter.notifyMatchFailure(
-            op, "Unimplemented: include last offset is not yet "
-                "supported for EmbeddingBag.");
-    }
+    auto resultType0 = typeConverter->convertType(op->getResult(0).getType());
+    Value castedEmbeddingBagResult = rewriter.create<tensor::CastOp>(
+        loc, resultType0, embeddingBagOp.getResult(0));
 
-    Value embeddingBagResult =
-        rewriter
-            .create<linalg::GenericOp>(
-                loc, initTensor.getType(), ValueRange{indices, offsets},
-                initTensor,
-                /*indexingMaps=*/indexingMaps,
-                /*iteratorTypes=*/iteratorTypes,
-                [&](OpBuilder &b, Location loc, ValueRange args) {
-                  Value indexInIndices = args[0];
-                  Value offsetsI = args[1];
-                  Value initTensorElem = args[2];
-
-                  Value indexI = b.create<linalg::IndexOp>(loc, /*value=*/0);
-                  Value indexIToInt = castIndexToInt64(b, loc, indexI);
-                  Value one = getConstant(
-                      b, loc, 1,
-                      mlir::IntegerType::get(getContext(), 64,
-                                             IntegerType::Signless));
-                  Value offsetIndexPlusOneInt =
-                      b.create<arith::AddIOp>(loc, indexIToInt, one);
-
-                  Value offsetIndexPlusOne =
-                      castIntToIndex(b, loc, offsetIndexPlusOneInt);
-                  Value checkLast = b.create<arith::CmpIOp>(
-                      loc, arith::CmpIPredicate::eq,
-                      castIndexToInt64(b, loc, offsetsLength),
-                      offsetIndexPlusOneInt);
-                  Value nextOffset = b.create<arith::SelectOp>(
-                      loc, checkLast, castIndexToInt64(b, loc, indicesLength),
-                      b.create<tensor::ExtractOp>(loc, offsets,
-                                                  offsetIndexPlusOne));
-
-                  Value indicesIndex = castIndexToInt64(
-                      b, loc, b.create<linalg::IndexOp>(loc, /*value=*/1));
-
-                  Value offsetLessThanIndicesIndex = b.create<arith::CmpIOp>(
-                      loc, arith::CmpIPredicate::slt, offsetsI, indicesIndex);
-                  Value offsetEqualToIndicesIndex = b.create<arith::CmpIOp>(
-                      loc, arith::CmpIPredicate::eq, offsetsI, indicesIndex);
-                  Value offsetLessThanOrEqualToIndicesIndex =
-                      b.create<arith::OrIOp>(loc, offsetLessThanIndicesIndex,
-                                               offsetEqualToIndicesIndex);
-
-                  Value indicesIndexLessThanNextOffset =
-                      b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::slt,
-                                              indicesIndex, nextOffset);
-
-                  Value indicesIndexWithinBounds = b.create<arith::AndIOp>(
-                      loc, offsetLessThanOrEqualToIndicesIndex,
-                      indicesIndexLessThanNextOffset);
-
-                  SmallVector<Value> indexIntoWeight;
-                  indexIntoWeight.push_back(
-                      castIntToIndex(b, loc, indexInIndices));
-                  indexIntoWeight.push_back(
-                      b.create<linalg::IndexOp>(loc, /*value=*/2));
-                  Value weightElem = b.create<tensor::ExtractOp>(
-                      loc, weight, indexIntoWeight);
-
-                  Value addResult = b.create<arith::AddFOp>(loc, weightElem,
-                                                            initTensorElem);
-                  Value select =
-                      b.create<arith::SelectOp>(loc, indicesIndexWithinBounds,
-                                                  addResult, initTensorElem);
-                  b.create<linalg::YieldOp>(loc, select);
-              })
-          .getResult(0);
-
-      // cast outputType.
-    auto restulType0 = typeConverter->convertType(op->getResult(0).getType());
-    Value castedEmbeddingBagResult =
-        rewriter.create<tensor::CastOp>(loc, restulType0, embeddingBagResult);
-
-    // offset2 tensor, this should be an empty tensor for the sum mode
+    // offset2bag tensor, this is an empty tensor.
     SmallVector<Value> offsetResultSize;
-    Type offsetElemTy = offsetsTy.getElementType();
     Value zeroDim = rewriter.create<arith::ConstantIndexOp>(loc, /*value=*/0);
     offsetResultSize.push_back(zeroDim);
     Value offsetResult = rewriter.create<tensor::EmptyOp>(
@@ -422,24 +506,67 @@ public:
         rewriter.create<tensor::CastOp>(loc, resultType1, offsetResult);
 
     SmallVector<Value> offsetSize = getTensorSizes(rewriter, loc, offsets);
-    // bagsize, vector of size offset with zeros, I think this is always just
-    // a vector of zeros in the sum mode
-    Value bagSize =
-        createZeroInitTensor(rewriter, loc, offsetSize, offsetElemTy);
+    Value bagSize;
+    if (modeInt == torch_upstream::EmbeddingBagMode::MODE_SUM) {
+      bagSize = createZeroInitTensor(rewriter, loc, offsetSize, offsetElemTy);
+    } else {
+      Value bagSizeInit = rewriter.create<tensor::EmptyOp>(
+          loc, getAsOpFoldResult(ValueRange{numBags}), offsetElemTy);
+      bagSize =
+          rewriter
+              .create<linalg::GenericOp>(
+                  loc, bagSizeInit.getType(), /*inputs=*/ValueRange{},
+                  bagSizeInit,
+                  /*indexingMaps=*/rewriter.getMultiDimIdentityMap(1),
+                  /*iteratorTypes=*/utils::IteratorType::parallel,
+                  [&](OpBuilder &b, Location loc, ValueRange args) {
+                    Value bag = b.create<linalg::IndexOp>(loc, /*value=*/0);
+                    Value begin, end;
+                    getBagBounds(b, loc, bag, begin, end);
+                    Value count = b.create<arith::SubIOp>(loc, end, begin);
+                    if (paddingIdx >= 0) {
+                      count =
+                          b.create<scf::ForOp>(
+                               loc, begin, end, oneIndex, ValueRange{count},
+                               [&](OpBuilder &b, Location loc, Value i,
+                                   ValueRange iterArgs) {
+                                 Value index = b.create<tensor::ExtractOp>(
+                                     loc, indices, i);
+                                 Value isPadding = b.create<arith::XOrIOp>(
+                                     loc, isNotPadding(b, loc, index),
+                                     b.create<arith::ConstantOp>(
+                                         loc, b.getBoolAttr(true)));
+                                 Value newCount = b.create<arith::SelectOp>(
+                                     loc, isPadding,
+                                     b.create<arith::SubIOp>(loc, iterArgs[0],
+                                                             oneIndex),
+                                     iterArgs[0]);
+                                 b.create<scf::YieldOp>(loc, newCount);
+                               })
+                              .getResult(0);
+                    }
+                    b.create<linalg::YieldOp>(
+                        loc, convertScalarToDtype(
+                                 b, loc, castIndexToInt64(b, loc, count),
+                                 offsetElemTy));
+                  })
+              .getResult(0);
+    }
     auto resultType2 = typeConverter->convertType(op->getResult(2).getType());
     Value castedBagSizeResult =
         rewriter.create<tensor::CastOp>(loc, resultType2, bagSize);
 
-    // max indices, vector of size offset with zeros, this is also always a
-    // vector of zeros in the sum mode. Its mainly used in the max mode.
-    Value indicesOut =
-        createZeroInitTensor(rewriter, loc, offsetSize, offsetElemTy);
+    // max indices, the indices of the maxima in the MAX mode, and a vector of
+    // zeros otherwise.
+    Value maxIndices =
+        isMax ? embeddingBagOp.getResult(1)
+              : createZeroInitTensor(rewriter, loc, offsetSize, offsetElemTy);
     auto resultType3 = typeConverter->convertType(op->getResult(3).getType());
     Value castedMaxIndices =
-        rewriter.create<tensor::CastOp>(loc, resultType3, indicesOut);
+        rewriter.create<tensor::CastOp>(loc, resultType3, maxIndices);
 
     rewriter.replaceOp(op, {castedEmbeddingBagResult, castedOffsetResult,
-                              castedBagSizeResult, castedMaxIndices});
+                            castedBagSizeResult, castedMaxIndices});
 
     return success();
   }
@@ -484,6 +611,16 @@ public:
     if (!isValidDim(dimInt, inputRank))
       return rewriter.notifyMatchFailure(op, "dim is statically invalid");
 
+    // Selecting along any dim but the last copies contiguous slices of the
+    // input.
+    if (dimInt < inputRank - 1 &&
+        indices.getType().cast<RankedTensorType>().getRank() == 1) {
+      Value slices = createSliceGather(rewriter, loc, input, indices, dimInt,
+                                       elementType);
+      rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, slices);
+      return success();
+    }
+
     SmallVector<Value> resultShape = getTensorSizes(rewriter, loc, input);
     resultShape[dimInt] = getTensorSizes(rewriter, loc, indices)[0];
     Value initTensor = rewriter.create<tensor::EmptyOp>(
@@ -590,6 +727,20 @@ public:
     Type elementType = resultType.getElementType();
     int inputRank = inputType.getRank();
     int resultRank = resultType.getRank();
+
+    // A single integer index tensor that isn't indexing the last dim, as in
+    // `x[idx]` or `x[:, idx]`, selects contiguous slices of the input, which
+    // are copied whole.
+    Type indexElementType =
+        indexTensors[0].getType().cast<RankedTensorType>().getElementType();
+    if (indexTensors.size() == 1 && indexTensorDims[0] < inputRank - 1 &&
+        indexElementType.isa<mlir::IntegerType>() &&
+        !indexElementType.isInteger(1)) {
+      Value slices = createSliceGather(rewriter, loc, input, indexTensors[0],
+                                       indexTensorDims[0], elementType);
+      rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, slices);
+      return success();
+    }
     int firstIndexDim = indexTensorDims[0];
     int replacedIndexCount = indexTensorDims.size();
     int64_t startIndex = contiguous ? firstIndexDim : 0;
@@ -776,6 +927,31 @@ static Value getScaleFactor(OpBuilder &builder, Location loc, Value dim,
   return scaleFactorInt;
 }
 
+// Creates a tensor of shape `sizes` holding `computeElement(indices)` at each
+// `indices`. The upsampling ops use it to compute the source indices once per
+// row and per column, rather than once per element of the result.
+static Value createIndexTable(
+    OpBuilder &b, Location loc, ArrayRef<Value> sizes, Type elementType,
+    function_ref<Value(OpBuilder &, Location, ValueRange)> computeElement) {
+  Value table =
+      b.create<tensor::EmptyOp>(loc, getAsOpFoldResult(sizes), elementType);
+  int64_t rank = sizes.size();
+  SmallVector<utils::IteratorType> iteratorTypes(
+      rank, utils::IteratorType::parallel);
+  return b
+      .create<linalg::GenericOp>(
+          loc, table.getType(), ValueRange{}, table,
+          /*indexingMaps=*/b.getMultiDimIdentityMap(rank),
+          /*iteratorTypes=*/iteratorTypes,
+          [&](OpBuilder &b, Location loc, ValueRange args) {
+            SmallVector<Value> indices;
+            for (int64_t i = 0; i < rank; i++)
+              indices.push_back(b.create<linalg::IndexOp>(loc, i));
+            b.create<linalg::YieldOp>(loc, computeElement(b, loc, indices));
+          })
+      .getResult(0);
+}
+
 // N, C, H, W = input_tensor.shape
 // N, C, H_scaled, W_scaled = out_tensor.shape
 // H_factor, W_factor = H_scaled/H, W_scaled/W
@@ -857,25 +1033,38 @@ public:
     Value outTensor = rewriter.create<tensor::EmptyOp>(
         loc, getAsOpFoldResult(dims), elementType);
 
+    // The source row and column of each row and column of the result.
+    SmallVector<Value, 2> indexTables;
+    for (unsigned i = 0; i < (inputRank - hDimOffset); i++) {
+      Value scaleFactor = castIntToIndex(rewriter, loc, scaleFactorsInt[i]);
+      indexTables.push_back(createIndexTable(
+          rewriter, loc, dims[i + hDimOffset], rewriter.getIndexType(),
+          [&](OpBuilder &b, Location loc, ValueRange indices) {
+            return b.create<arith::FloorDivSIOp>(loc, indices[0], scaleFactor);
+          }));
+    }
+
     AffineMap idMap = rewriter.getMultiDimIdentityMap(inputRank);
+    SmallVector<AffineMap> indexingMaps;
+    for (unsigned i = hDimOffset; i < inputRank; i++)
+      indexingMaps.push_back(AffineMap::get(inputRank, /*symbolCount=*/0,
+                                            rewriter.getAffineDimExpr(i)));
+    indexingMaps.push_back(idMap);
     SmallVector<utils::IteratorType> iteratorTypes(
         inputRank, utils::IteratorType::parallel);
 
     Value finalRes =
         rewriter
             .create<linalg::GenericOp>(
-                loc, outTensor.getType(), ValueRange{}, outTensor,
-                /*indexingMaps=*/idMap,
+                loc, outTensor.getType(), indexTables, outTensor,
+                /*indexingMaps=*/indexingMaps,
                 /*iteratorTypes=*/iteratorTypes,
                 [&](OpBuilder &b, Location loc, ValueRange args) {
                   SmallVector<Value> indices;
-                  for (unsigned i = 0; i < inputRank; i++)
+                  for (unsigned i = 0; i < hDimOffset; i++)
                     indices.push_back(b.create<linalg::IndexOp>(loc, i));
-
                   for (unsigned i = 0; i < (inputRank - hDimOffset); i++)
-                    indices[i + hDimOffset] = b.create<arith::FloorDivSIOp>(
-                        loc, indices[i + hDimOffset],
-                        castIntToIndex(rewriter, loc, scaleFactorsInt[i]));
+                    indices.push_back(args[i]);
 
                   Value retVal =
                       b.create<tensor::ExtractOp>(loc, input, indices);
@@ -889,51 +1078,6 @@ public:
 };
 } // namespace
 
-static Value getGradOutputValue(OpBuilder &builder, Location loc,
-                                Value gradOutput, Type gradOutputElemType,
-                                Value numBatch, Value numChannel,
-                                Value inputIndexH, Value inputIndexW,
-                                Value kernelIndexH, Value kernelIndexW,
-                                SmallVector<Value> &gradOutputSizeIndexValues,
-                                SmallVector<Value, 2> &scaleFactorsIntValues) {
-  Value constantOne = builder.create<arith::ConstantIndexOp>(loc, 1);
-
-  Value outputIndexH = builder.create<arith::MulIOp>(
-      loc, inputIndexH, castIntToIndex(builder, loc, scaleFactorsIntValues[0]));
-  outputIndexH = builder.create<arith::AddIOp>(loc, outputIndexH, kernelIndexH);
-
-  Value outputIndexW = builder.create<arith::MulIOp>(
-      loc, inputIndexW, castIntToIndex(builder, loc, scaleFactorsIntValues[1]));
-  outputIndexW = builder.create<arith::AddIOp>(loc, outputIndexW, kernelIndexW);
-
-  // Handling corner cases.
-  Value gradOutputHMinusOne = builder.create<arith::SubIOp>(
-      loc, gradOutputSizeIndexValues[2], constantOne);
-  Value predH = builder.create<arith::CmpIOp>(
-      loc, arith::CmpIPredicate::sle, outputIndexH, gradOutputHMinusOne);
-  outputIndexH = builder.create<arith::SelectOp>(loc, predH, outputIndexH,
-                                                 gradOutputHMinusOne);
-
-  Value gradOutputWMinusOne = builder.create<arith::SubIOp>(
-      loc, gradOutputSizeIndexValues[3], constantOne);
-  Value predW = builder.create<arith::CmpIOp>(
-      loc, arith::CmpIPredicate::sle, outputIndexW, gradOutputWMinusOne);
-  outputIndexW = builder.create<arith::SelectOp>(loc, predW, outputIndexW,
-                                                 gradOutputWMinusOne);
-
-  Value gradOutputValue = builder.create<tensor::ExtractOp>(
-      loc, gradOutput,
-      ValueRange{numBatch, numChannel, outputIndexH, outputIndexW});
-  Value constantZero =
-      builder.create<arith::ConstantOp>(loc, builder.getF32FloatAttr(0.0));
-  Value pred = builder.create<arith::AndIOp>(loc, predH, predW);
-  Value result = builder.create<arith::SelectOp>(
-      loc, pred, gradOutputValue,
-      convertScalarToDtype(builder, loc, constantZero, gradOutputElemType));
-
-  return result;
-}
-
 // The implementation of the `aten.upsample_nearest2d_backward.vec` op's
 // lowering is as follows:
 // gradOutput: Tensor of size [n, c, oh, ow]
@@ -1044,32 +1188,75 @@ public:
         AffineMap::get(gradOutputRank + kernelRank,
                        /*symbolCount=*/0, affineExprs, op->getContext());
 
-    SmallVector<AffineMap> indexingMaps{kernelMap, outputMap};
+    // For each row (resp. column) `i` of the result and each `k` in the
+    // kernel, the row of `gradOutput` read, `i * kh + k`, clamped to the last
+    // row, and whether it is in bounds. These tables are computed once per
+    // axis instead of once per element.
+    SmallVector<Value> indexTables;
+    SmallVector<AffineMap> indexingMaps{kernelMap};
+    SmallVector<Value> inputSizeIndexValues =
+        castIntVectorToIndexVector(rewriter, loc, inputSizeIntValues);
+    for (unsigned i = 0; i < kernelRank; i++) {
+      Value scaleFactor =
+          castIntToIndex(rewriter, loc, scaleFactorsIntValues[i]);
+      Value lastIndex = rewriter.create<arith::SubIOp>(
+          loc, gradOutputSizeIndexValues[hDimOffset + i],
+          rewriter.create<arith::ConstantIndexOp>(loc, 1));
+      SmallVector<Value> tableSizes{inputSizeIndexValues[hDimOffset + i],
+                                    scaleFactor};
+      auto computeIndex = [&](OpBuilder &b, Location loc,
+                              ValueRange indices) -> Value {
+        Value index = b.create<arith::MulIOp>(loc, indices[0], scaleFactor);
+        return b.create<arith::AddIOp>(loc, index, indices[1]);
+      };
+      indexTables.push_back(createIndexTable(
+          rewriter, loc, tableSizes, rewriter.getIndexType(),
+          [&](OpBuilder &b, Location loc, ValueRange indices) {
+            return b.create<arith::MinSIOp>(
+                loc, computeIndex(b, loc, indices), lastIndex);
+          }));
+      indexTables.push_back(createIndexTable(
+          rewriter, loc, tableSizes, rewriter.getI1Type(),
+          [&](OpBuilder &b, Location loc, ValueRange indices) {
+            return b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::sle,
+                                           computeIndex(b, loc, indices),
+                                           lastIndex);
+          }));
+      AffineMap tableMap = AffineMap::get(
+          gradOutputRank + kernelRank, /*symbolCount=*/0,
+          {rewriter.getAffineDimExpr(hDimOffset + i),
+           rewriter.getAffineDimExpr(gradOutputRank + i)},
+          op->getContext());
+      indexingMaps.append({tableMap, tableMap});
+    }
+    indexingMaps.push_back(outputMap);
+
     SmallVector<utils::IteratorType> iteratorTypes(
         gradOutputRank, utils::IteratorType::parallel);
     iteratorTypes.push_back(utils::IteratorType::reduction);
     iteratorTypes.push_back(utils::IteratorType::reduction);
 
+    SmallVector<Value> inputs{kernelTensor};
+    inputs.append(indexTables);
     Value finalRes =
         rewriter
             .create<linalg::GenericOp>(
-                loc, outTensor.getType(), ValueRange{kernelTensor},
-                ValueRange{outTensor},
+                loc, outTensor.getType(), inputs, ValueRange{outTensor},
                 /*indexingMaps=*/indexingMaps,
                 /*iteratorTypes=*/iteratorTypes,
                 [&](OpBuilder &b, Location loc, ValueRange args) {
-                  Value n = rewriter.create<linalg::IndexOp>(loc, 0);
-                  Value c = rewriter.create<linalg::IndexOp>(loc, 1);
-                  Value ih = rewriter.create<linalg::IndexOp>(loc, 2);
-                  Value iw = rewriter.create<linalg::IndexOp>(loc, 3);
-                  Value kh = rewriter.create<linalg::IndexOp>(loc, 4);
-                  Value kw = rewriter.create<linalg::IndexOp>(loc, 5);
-                  Value accValue = getGradOutputValue(
-                      rewriter, loc, gradOutput, elementType, n, c, ih, iw, kh,
-                      kw, gradOutputSizeIndexValues, scaleFactorsIntValues);
-                  Value outputVal = args[1];
-                  outputVal =
-                      rewriter.create<arith::AddFOp>(loc, outputVal, accValue);
+                  Value n = b.create<linalg::IndexOp>(loc, 0);
+                  Value c = b.create<linalg::IndexOp>(loc, 1);
+                  Value gradOutputValue = b.create<tensor::ExtractOp>(
+                      loc, gradOutput, ValueRange{n, c, args[1], args[3]});
+                  Value inBounds =
+                      b.create<arith::AndIOp>(loc, args[2], args[4]);
+                  Value zero = b.create<arith::ConstantOp>(
+                      loc, b.getZeroAttr(elementType));
+                  Value accValue = b.create<arith::SelectOp>(
+                      loc, inBounds, gradOutputValue, zero);
+                  Value outputVal =
+                      b.create<arith::AddFOp>(loc, args[5], accValue);
                   b.create<linalg::YieldOp>(loc, outputVal);
                 })
             ->getResult(0);
@@ -1080,6 +1267,135 @@ public:
 };
 } // namespace
 
+// Lowers `aten.bucketize.Tensor` to a binary search over the sorted
+// boundaries for each element of the input, which takes O(N log B) steps
+// instead of the O(N * B) comparisons of the decomposition:
+//
+// for i in input.indices:
+//    lo, hi = 0, boundaries.size[0]
+//    while lo < hi:
+//       mid = (lo + hi) / 2
+//       if boundaries[mid] < input[i]  (<= if right):
+//          lo = mid + 1
+//       else:
+//          hi = mid
+//    output[i] = lo
+namespace {
+class ConvertAtenBucketizeTensorOp
+    : public OpConversionPattern<AtenBucketizeTensorOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenBucketizeTensorOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+
+    Location loc = op.getLoc();
+    Value input = adaptor.getSelf();
+    Value boundaries = adaptor.getBoundaries();
+    auto inputType = input.getType().cast<RankedTensorType>();
+    auto boundariesType = boundaries.getType().cast<RankedTensorType>();
+    if (boundariesType.getRank() != 1)
+      return rewriter.notifyMatchFailure(op, "boundaries must be a 1D tensor");
+    bool right;
+    if (!matchPattern(op.getRight(), m_TorchConstantBool(&right)))
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: right must be a constant bool");
+
+    // Compare in the wider of the two element types, floats winning over
+    // integers, as the comparison ops would after type promotion.
+    Type inputElementType = inputType.getElementType();
+    Type boundariesElementType = boundariesType.getElementType();
+    if (inputElementType.isInteger(1) || boundariesElementType.isInteger(1))
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: bool input or boundaries");
+    Type compareType = inputElementType;
+    if (inputElementType.isa<mlir::FloatType>() !=
+        boundariesElementType.isa<mlir::FloatType>()) {
+      if (boundariesElementType.isa<mlir::FloatType>())
+        compareType = boundariesElementType;
+    } else if (boundariesElementType.getIntOrFloatBitWidth() >
+               inputElementType.getIntOrFloatBitWidth()) {
+      compareType = boundariesElementType;
+    }
+
+    RankedTensorType resultType = getTypeConverter()
+                                      ->convertType(op->getResult(0).getType())
+                                      .cast<RankedTensorType>();
+    Type resultElementType = resultType.getElementType();
+    int64_t inputRank = inputType.getRank();
+    Value initTensor = rewriter.create<tensor::EmptyOp>(
+        loc, getAsOpFoldResult(getTensorSizes(rewriter, loc, input)),
+        resultElementType);
+    Value c0 = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+    Value c1 = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+    Value numBoundaries = getDimOp(rewriter, loc, boundaries, 0);
+
+    SmallVector<AffineMap> indexingMaps(
+        2, rewriter.getMultiDimIdentityMap(inputRank));
+    SmallVector<utils::IteratorType> iteratorTypes(
+        inputRank, utils::IteratorType::parallel);
+    Value result =
+        rewriter
+            .create<linalg::GenericOp>(
+                loc, initTensor.getType(), input, initTensor, indexingMaps,
+                iteratorTypes,
+                [&](OpBuilder &b, Location loc, ValueRange args) {
+                  Value value =
+                      convertScalarToDtype(b, loc, args[0], compareType);
+                  Type indexType = b.getIndexType();
+                  auto search = b.create<scf::WhileOp>(
+                      loc, TypeRange{indexType, indexType},
+                      ValueRange{c0, numBoundaries},
+                      [&](OpBuilder &b, Location loc, ValueRange bounds) {
+                        Value notEmpty = b.create<arith::CmpIOp>(
+                            loc, arith::CmpIPredicate::ult, bounds[0],
+                            bounds[1]);
+                        b.create<scf::ConditionOp>(loc, notEmpty, bounds);
+                      },
+                      [&](OpBuilder &b, Location loc, ValueRange bounds) {
+                        Value lo = bounds[0], hi = bounds[1];
+                        Value mid = b.create<arith::ShRUIOp>(
+                            loc, b.create<arith::AddIOp>(loc, lo, hi), c1);
+                        Value boundary = convertScalarToDtype(
+                            b, loc,
+                            b.create<tensor::ExtractOp>(loc, boundaries, mid),
+                            compareType);
+                        Value below;
+                        if (compareType.isa<mlir::FloatType>()) {
+                          below = b.create<arith::CmpFOp>(
+                              loc,
+                              right ? arith::CmpFPredicate::OLE
+                                    : arith::CmpFPredicate::OLT,
+                              boundary, value);
+                        } else {
+                          below = b.create<arith::CmpIOp>(
+                              loc,
+                              right ? arith::CmpIPredicate::sle
+                                    : arith::CmpIPredicate::slt,
+                              boundary, value);
+                        }
+                        Value midPlusOne =
+                            b.create<arith::AddIOp>(loc, mid, c1);
+                        Value newLo = b.create<arith::SelectOp>(
+                            loc, below, midPlusOne, lo);
+                        Value newHi =
+                            b.create<arith::SelectOp>(loc, below, hi, mid);
+                        b.create<scf::YieldOp>(loc, ValueRange{newLo, newHi});
+                      });
+                  Value bucket = b.create<arith::IndexCastOp>(
+                      loc, resultElementType, search.getResult(0));
+                  b.create<linalg::YieldOp>(loc, bucket);
+                })
+            .getResult(0);
+
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, result);
+    return success();
+  }
+};
+} // namespace
+
 void mlir::torch::torch_to_linalg::
     populateIndirectDataMovementPatternsAndLegality(
         TypeConverter &typeConverter, RewritePatternSet &patterns,
@@ -1099,4 +1415,6 @@ void mlir::torch::torch_to_linalg::
   patterns.add<ConvertAtenUpsampleNearest2dOp>(typeConverter, context);
   target.addIllegalOp<AtenUpsampleNearest2dBackwardOp>();
   patterns.add<ConvertAtenUpsampleNearest2dBackwardOp>(typeConverter, context);
+  target.addIllegalOp<AtenBucketizeTensorOp>();
+  patterns.add<ConvertAtenBucketizeTensorOp>(typeConverter, context);
 }
@@ -28,10 +28,141 @@ using namespace mlir;
 using namespace mlir::torch;
 using namespace mlir::torch::Torch;
 
+// Returns the element type in which a contraction with results of
+// `elementType` accumulates: f32 for FP8 results, which are too coarse to
+// accumulate in, and for bf16 and f16 results when `accumulateInF32` is set,
+// and `elementType` otherwise. The linalg named contractions extend their
+// inputs to the type of their accumulator.
+static Type getAccumulatorElementType(bool accumulateInF32, Type elementType) {
+  if (elementType.isFloat8E5M2() || elementType.isFloat8E4M3FN() ||
+      (accumulateInF32 && (elementType.isBF16() || elementType.isF16())))
+    return Float32Type::get(elementType.getContext());
+  return elementType;
+}
+
+// Truncates `accumulator`, the result of a contraction, to `elementType` if it
+// was accumulated in a wider type.
+static Value truncateAccumulator(OpBuilder &b, Location loc, Value accumulator,
+                                 Type elementType) {
+  auto accumulatorType = accumulator.getType().cast<RankedTensorType>();
+  if (accumulatorType.getElementType() == elementType)
+    return accumulator;
+  int64_t rank = accumulatorType.getRank();
+  Value init = b.create<tensor::EmptyOp>(
+      loc, tensor::getMixedSizes(b, loc, accumulator), elementType);
+  SmallVector<AffineMap> indexingMaps(2, b.getMultiDimIdentityMap(rank));
+  SmallVector<utils::IteratorType> iteratorTypes(rank,
+                                                 utils::IteratorType::parallel);
+  return b
+      .create<linalg::GenericOp>(
+          loc, init.getType(), accumulator, init, indexingMaps, iteratorTypes,
+          [&](OpBuilder &b, Location loc, ValueRange args) {
+            b.create<linalg::YieldOp>(
+                loc, convertScalarToDtype(b, loc, args[0], elementType));
+          })
+      .getResult(0);
+}
+
+// Returns the tensor that `tensor` is extended from if it is produced by a
+// floating-point extension, like the lowering of `aten.to.dtype` from bf16 to
+// f32, and `tensor` otherwise. The linalg named contractions extend their
+// inputs to the type of their accumulator themselves, so they can read it
+// instead of `tensor`.
+static Value lookThroughFloatExtension(Value tensor) {
+  linalg::GenericOp producer =
+      torch_to_linalg::getBroadcastOrCastProducer(tensor);
+  if (!producer || !producer.getIndexingMapsArray()[0].isIdentity())
+    return tensor;
+  Block *body = producer.getBody();
+  if (body->getOperations().size() != 2)
+    return tensor;
+  auto extension = dyn_cast<arith::ExtFOp>(body->front());
+  if (!extension || extension.getIn() != body->getArgument(0))
+    return tensor;
+  return producer.getDpsInputOperand(0)->get();
+}
+
+// Computes the (batch) matmul of `lhs` and `rhs` into `init`, reading the
+// operands whose `transpose` flag is set with their last two dims swapped, as
+// a `linalg.generic` whose indexing maps do the transposes.
+static Value createTransposedMatmul(OpBuilder &b, Location loc, Value lhs,
+                                    bool transposeLhs, Value rhs,
+                                    bool transposeRhs, Value init) {
+  int64_t numBatchDims = init.getType().cast<RankedTensorType>().getRank() - 2;
+  // The loops are the batch dims, M, N and K.
+  int64_t numLoops = numBatchDims + 3;
+  AffineExpr m = b.getAffineDimExpr(numBatchDims),
+             n = b.getAffineDimExpr(numBatchDims + 1),
+             k = b.getAffineDimExpr(numBatchDims + 2);
+  auto getMap = [&](AffineExpr row, AffineExpr col) {
+    SmallVector<AffineExpr> exprs;
+    for (int64_t i = 0; i < numBatchDims; i++)
+      exprs.push_back(b.getAffineDimExpr(i));
+    exprs.append({row, col});
+    return AffineMap::get(numLoops, /*symbolCount=*/0, exprs, b.getContext());
+  };
+  SmallVector<AffineMap> indexingMaps{
+      transposeLhs ? getMap(k, m) : getMap(m, k),
+      transposeRhs ? getMap(n, k) : getMap(k, n), getMap(m, n)};
+  SmallVector<utils::IteratorType> iteratorTypes(numLoops - 1,
+                                                 utils::IteratorType::parallel);
+  iteratorTypes.push_back(utils::IteratorType::reduction);
+  return b
+      .create<linalg::GenericOp>(
+          loc, init.getType(), ValueRange{lhs, rhs}, init, indexingMaps,
+          iteratorTypes,
+          [](OpBuilder &b, Location loc, ValueRange args) {
+            Value acc = args[2];
+            Value l = convertScalarToDtype(b, loc, args[0], acc.getType());
+            Value r = convertScalarToDtype(b, loc, args[1], acc.getType());
+            Value mul = b.create<arith::MulFOp>(loc, l, r);
+            b.create<linalg::YieldOp>(
+                loc, b.create<arith::AddFOp>(loc, mul, acc).getResult());
+          })
+      .getResult(0);
+}
+
+// Returns the floating point (batch) matmul of `lhs` and `rhs` into `init`
+// computed on the sources of those of them that are transposes, see
+// `getTransposeSource`, so that the transposes are not materialized. Returns
+// null if neither is a transpose.
+static Value createMatmulOfTransposes(OpBuilder &b, Location loc, Value lhs,
+                                      Value rhs, Value init) {
+  auto initType = init.getType().cast<RankedTensorType>();
+  if (!initType.getElementType().isa<FloatType>())
+    return nullptr;
+  Value lhsSource = torch_to_linalg::getTransposeSource(lhs);
+  Value rhsSource = torch_to_linalg::getTransposeSource(rhs);
+  if (!lhsSource && !rhsSource)
+    return nullptr;
+  return createTransposedMatmul(
+      b, loc, lhsSource ? lhsSource : lhs, /*transposeLhs=*/bool(lhsSource),
+      rhsSource ? rhsSource : rhs, /*transposeRhs=*/bool(rhsSource), init);
+}
+
 namespace {
-class ConvertAtenMmOp : public OpConversionPattern<AtenMmOp> {
+// A pattern lowering `OpTy` to linalg contractions, according to the
+// `LinearLoweringOptions` of the pass.
+template <typename OpTy>
+class ConvertContractionOp : public OpConversionPattern<OpTy> {
 public:
-  using OpConversionPattern::OpConversionPattern;
+  ConvertContractionOp(TypeConverter &typeConverter, MLIRContext *context,
+                       const torch_to_linalg::LinearLoweringOptions &options)
+      : OpConversionPattern<OpTy>(typeConverter, context), options(options) {}
+
+protected:
+  Type getAccumulatorElementType(Type elementType) const {
+    return ::getAccumulatorElementType(options.accumulateInF32, elementType);
+  }
+
+  torch_to_linalg::LinearLoweringOptions options;
+};
+} // namespace
+
+namespace {
+class ConvertAtenMmOp : public ConvertContractionOp<AtenMmOp> {
+public:
+  using ConvertContractionOp::ConvertContractionOp;
   LogicalResult
   matchAndRewrite(AtenMmOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
@@ -70,16 +201,23 @@ public:
 
     Type newResultType = getTypeConverter()->convertType(op.getType());
     Type elementType = newResultType.cast<TensorType>().getElementType();
+    Type accumulatorType = getAccumulatorElementType(elementType);
     Value initTensor = rewriter.create<tensor::EmptyOp>(
-        loc, ArrayRef<OpFoldResult>{lhsDim0, rhsDim1}, elementType);
+        loc, ArrayRef<OpFoldResult>{lhsDim0, rhsDim1}, accumulatorType);
     Value c0 = rewriter.create<arith::ConstantOp>(
-        loc, FloatAttr::get(elementType, 0.0));
+        loc, FloatAttr::get(accumulatorType, 0.0));
     Value zeroFill =
         rewriter.create<linalg::FillOp>(loc, c0, initTensor).getResult(0);
-    Value matmul = rewriter
-                       .create<linalg::MatmulOp>(loc, zeroFill.getType(),
-                                                 ValueRange{lhs, rhs}, zeroFill)
-                       .getResult(0);
+    Value matmul = createMatmulOfTransposes(rewriter, loc, lhs, rhs, zeroFill);
+    if (!matmul)
+      matmul = rewriter
+                   .create<linalg::MatmulOp>(
+                       loc, zeroFill.getType(),
+                       ValueRange{lookThroughFloatExtension(lhs),
+                                  lookThroughFloatExtension(rhs)},
+                       zeroFill)
+                   .getResult(0);
+    matmul = truncateAccumulator(rewriter, loc, matmul, elementType);
     // When constructed with just dynamic sizes, EmptyOp will have a result
     // type which has all `?`'s for dimensions, which might not be the result
     // type of `op`. The constraints on later linalg ops means that the result
@@ -152,10 +290,112 @@ public:
 };
 } // namespace
 
+// Infers the indexing maps of a linalg op from the expressions of each of its
+// operands.
+static SmallVector<AffineMap, 4>
+inferIndexingMaps(ArrayRef<ArrayRef<AffineExpr>> exprsList) {
+  return AffineMap::inferFromExprList(exprsList);
+}
+
+// Returns true if the batch dims of `lhs` and `rhs`, of ranks at least 2,
+// don't match, so that one of them must be broadcast. Like
+// `broadcastToGivenShape`, only dims of static size 1 are broadcast, and
+// dynamic dims must be equal at runtime.
+static bool batchMatmulNeedsBroadcast(RankedTensorType lhsType,
+                                      RankedTensorType rhsType) {
+  if (lhsType.getRank() != rhsType.getRank())
+    return true;
+  for (int64_t i = 0, e = lhsType.getRank() - 2; i < e; i++) {
+    if ((lhsType.getDimSize(i) == 1) != (rhsType.getDimSize(i) == 1))
+      return true;
+  }
+  return false;
+}
+
+// Computes the batched matmul of `lhs` and `rhs`, of ranks at least 2, as a
+// linalg.generic whose indexing maps broadcast the batch dims of the
+// operands, instead of materializing broadcast copies of them. Each batch dim
+// is indexed by the loop of that dim, or by 0 in an operand whose size is
+// statically 1 there, and is omitted from an operand of lower rank. The
+// operands are extended to `elementType`, the type of the accumulator. Returns
+// nullptr if the element type is not a float.
+static Value createBroadcastingBatchMatmul(OpBuilder &b, Location loc,
+                                           Value lhs, Value rhs,
+                                           Type elementType) {
+  if (!elementType.isa<mlir::FloatType>())
+    return nullptr;
+  auto lhsType = lhs.getType().cast<RankedTensorType>();
+  auto rhsType = rhs.getType().cast<RankedTensorType>();
+  int64_t lhsRank = lhsType.getRank();
+  int64_t rhsRank = rhsType.getRank();
+  int64_t batchRank = std::max(lhsRank, rhsRank) - 2;
+  SmallVector<AffineExpr> lhsExprs, rhsExprs, outExprs;
+  SmallVector<Value> resultShape;
+  for (int64_t i = 0; i < batchRank; i++) {
+    AffineExpr dim = b.getAffineDimExpr(i);
+    outExprs.push_back(dim);
+    // The dims of the operands aligned with batch dim `i`, which are negative
+    // for an operand that lacks it.
+    int64_t lhsDim = i - (batchRank - (lhsRank - 2));
+    int64_t rhsDim = i - (batchRank - (rhsRank - 2));
+    if (lhsDim < 0) {
+      rhsExprs.push_back(dim);
+      resultShape.push_back(getDimOp(b, loc, rhs, rhsDim));
+    } else if (rhsDim < 0) {
+      lhsExprs.push_back(dim);
+      resultShape.push_back(getDimOp(b, loc, lhs, lhsDim));
+    } else if (lhsType.getDimSize(lhsDim) == 1) {
+      lhsExprs.push_back(b.getAffineConstantExpr(0));
+      rhsExprs.push_back(dim);
+      resultShape.push_back(getDimOp(b, loc, rhs, rhsDim));
+    } else if (rhsType.getDimSize(rhsDim) == 1) {
+      lhsExprs.push_back(dim);
+      rhsExprs.push_back(b.getAffineConstantExpr(0));
+      resultShape.push_back(getDimOp(b, loc, lhs, lhsDim));
+    } else {
+      Value lhsSize = getDimOp(b, loc, lhs, lhsDim);
+      checkDimEqualHelper(b, loc, lhsSize, getDimOp(b, loc, rhs, rhsDim));
+      lhsExprs.push_back(dim);
+      rhsExprs.push_back(dim);
+      resultShape.push_back(lhsSize);
+    }
+  }
+  Value lhsRows = getDimOp(b, loc, lhs, lhsRank - 2);
+  Value rhsCols = getDimOp(b, loc, rhs, rhsRank - 1);
+  checkDimEqualHelper(b, loc, getDimOp(b, loc, lhs, lhsRank - 1),
+                      getDimOp(b, loc, rhs, rhsRank - 2));
+  resultShape.append({lhsRows, rhsCols});
+
+  AffineExpr m = b.getAffineDimExpr(batchRank);
+  AffineExpr k = b.getAffineDimExpr(batchRank + 1);
+  AffineExpr n = b.getAffineDimExpr(batchRank + 2);
+  lhsExprs.append({m, k});
+  rhsExprs.append({k, n});
+  outExprs.append({m, n});
+  SmallVector<utils::IteratorType> iteratorTypes(batchRank,
+                                                 utils::IteratorType::parallel);
+  iteratorTypes.append({utils::IteratorType::parallel,
+                        utils::IteratorType::reduction,
+                        utils::IteratorType::parallel});
+  Value zeroTensor = createZeroInitTensor(b, loc, resultShape, elementType);
+  return b
+      .create<linalg::GenericOp>(
+          loc, zeroTensor.getType(), ValueRange{lhs, rhs}, zeroTensor,
+          inferIndexingMaps({lhsExprs, rhsExprs, outExprs}), iteratorTypes,
+          [&](OpBuilder &b, Location loc, ValueRange args) {
+            Value l = convertScalarToDtype(b, loc, args[0], elementType);
+            Value r = convertScalarToDtype(b, loc, args[1], elementType);
+            Value mul = b.create<arith::MulFOp>(loc, l, r);
+            Value add = b.create<arith::AddFOp>(loc, mul, args[2]);
+            b.create<linalg::YieldOp>(loc, add);
+          })
+      .getResult(0);
+}
+
 namespace {
-class ConvertAtenMatmulOp : public OpConversionPattern<AtenMatmulOp> {
+class ConvertAtenMatmulOp : public ConvertContractionOp<AtenMatmulOp> {
 public:
-  using OpConversionPattern::OpConversionPattern;
+  using ConvertContractionOp::ConvertContractionOp;
   LogicalResult
   matchAndRewrite(AtenMatmulOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
@@ -175,6 +415,12 @@ public:
     Type newResultType = getTypeConverter()->convertType(op.getType());
     auto resultType = newResultType.cast<RankedTensorType>();
     Type elementType = resultType.getElementType();
+    Type accumulatorType = getAccumulatorElementType(elementType);
+    auto castToResultType = [&](Value accumulator) {
+      rewriter.replaceOpWithNewOp<tensor::CastOp>(
+          op, newResultType,
+          truncateAccumulator(rewriter, loc, accumulator, elementType));
+    };
 
     // The different cases of torch_matmul op is mentioned here:
     // https://pytorch.org/docs/stable/generated/torch.matmul.html
@@ -186,13 +432,14 @@ public:
 
       checkDimEqualHelper(rewriter, loc, lhsDim0, rhsDim0);
 
-      Value zeroTensor = createZeroInitTensor(rewriter, loc, {}, elementType);
+      Value zeroTensor =
+          createZeroInitTensor(rewriter, loc, {}, accumulatorType);
       Value dotProd =
           rewriter
               .create<linalg::DotOp>(loc, zeroTensor.getType(),
                                      ValueRange{lhs, rhs}, zeroTensor)
               .getResult(0);
-      rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType, dotProd);
+      castToResultType(dotProd);
       return success();
     }
 
@@ -203,14 +450,14 @@ public:
       Value rhsDim1 = getDimOp(rewriter, loc, rhs, 1);
       checkDimEqualHelper(rewriter, loc, lhsDim0, rhsDim0);
 
-      Value zeroTensor =
-          createZeroInitTensor(rewriter, loc, ValueRange{rhsDim1}, elementType);
+      Value zeroTensor = createZeroInitTensor(
+          rewriter, loc, ValueRange{rhsDim1}, accumulatorType);
       Value matmul =
           rewriter
               .create<linalg::VecmatOp>(loc, zeroTensor.getType(),
                                         ValueRange{lhs, rhs}, zeroTensor)
               .getResult(0);
-      rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType, matmul);
+      castToResultType(matmul);
       return success();
     }
 
@@ -221,14 +468,14 @@ public:
       Value rhsDim0 = getDimOp(rewriter, loc, rhs, 0);
       checkDimEqualHelper(rewriter, loc, lhsDim1, rhsDim0);
 
-      Value zeroTensor =
-          createZeroInitTensor(rewriter, loc, ValueRange{lhsDim0}, elementType);
+      Value zeroTensor = createZeroInitTensor(
+          rewriter, loc, ValueRange{lhsDim0}, accumulatorType);
       Value matmul =
           rewriter
               .create<linalg::MatvecOp>(loc, zeroTensor.getType(),
                                         ValueRange{lhs, rhs}, zeroTensor)
               .getResult(0);
-      rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType, matmul);
+      castToResultType(matmul);
       return success();
     }
 
@@ -245,6 +492,53 @@ public:
         return rewriter.notifyMatchFailure(op, "expected batch dimensions");
       }
 
+      // A rank 2 rhs is shared by all the batches of the lhs, so the batch
+      // dims of the lhs can be collapsed into its rows, giving a single
+      // matmul without copying the rhs once per batch.
+      if (rhsRank == 2 &&
+          llvm::count(lhsType.getShape().drop_back(), ShapedType::kDynamic) <=
+              1) {
+        Value rhsDim0 = getDimOp(rewriter, loc, rhs, 0);
+        Value rhsDim1 = getDimOp(rewriter, loc, rhs, 1);
+        checkDimEqualHelper(rewriter, loc,
+                            getDimOp(rewriter, loc, lhs, lhsRank - 1),
+                            rhsDim0);
+        SmallVector<ReassociationIndices> reassociation(2);
+        for (unsigned i = 0; i < lhsRank - 1; i++)
+          reassociation[0].push_back(i);
+        reassociation[1].push_back(lhsRank - 1);
+        Value collapsedLhs = rewriter.create<tensor::CollapseShapeOp>(
+            loc, lhs, reassociation);
+        Value zeroTensor = createZeroInitTensor(
+            rewriter, loc,
+            ValueRange{getDimOp(rewriter, loc, collapsedLhs, 0), rhsDim1},
+            accumulatorType);
+        Value matmul = createMatmulOfTransposes(rewriter, loc, collapsedLhs,
+                                                rhs, zeroTensor);
+        if (!matmul)
+          matmul = rewriter
+                       .create<linalg::MatmulOp>(
+                           loc, zeroTensor.getType(),
+                           ValueRange{collapsedLhs, rhs}, zeroTensor)
+                       .getResult(0);
+        SmallVector<int64_t> expandedShape(lhsType.getShape().drop_back());
+        expandedShape.push_back(rhsType.getDimSize(1));
+        Value expanded = rewriter.create<tensor::ExpandShapeOp>(
+            loc, RankedTensorType::get(expandedShape, accumulatorType),
+            matmul, reassociation);
+        castToResultType(expanded);
+        return success();
+      }
+
+      bool needsBroadcast = batchMatmulNeedsBroadcast(lhsType, rhsType);
+      if (needsBroadcast) {
+        if (Value result = createBroadcastingBatchMatmul(
+                rewriter, loc, lhs, rhs, accumulatorType)) {
+          castToResultType(result);
+          return success();
+        }
+      }
+
       // The `broadcastedBatchShape` contains batch dimensions of the resultant
       // matrix.
       SmallVector<Value> broadcastedBatchShape(batchRank);
@@ -283,15 +577,19 @@ public:
             castIndexToInt64(rewriter, loc, rhsBroadcastToShape[i]);
       }
 
-      // Broadcast the batch dimensions of both the matrices.
-      Value broadcastedLhs, broadcastedRhs;
-      if (failed(torch_to_linalg::broadcastToGivenShape(
-              op, rewriter, lhs, lhsBroadcastToShape, broadcastedLhs))) {
-        return rewriter.notifyMatchFailure(
-            op, "unable to perform broadcast operation");
-      }
-      if (failed(torch_to_linalg::broadcastToGivenShape(
-              op, rewriter, rhs, rhsBroadcastToShape, broadcastedRhs))) {
+      // Broadcast the batch dimensions of both the matrices, unless they
+      // already match.
+      Value broadcastedLhs = lhs, broadcastedRhs = rhs;
+      if (!needsBroadcast) {
+        for (unsigned i = 0; i < batchRank; i++)
+          checkDimEqualHelper(rewriter, loc, getDimOp(rewriter, loc, lhs, i),
+                              getDimOp(rewriter, loc, rhs, i));
+      } else if (failed(torch_to_linalg::broadcastToGivenShape(
+                     op, rewriter, lhs, lhsBroadcastToShape,
+                     broadcastedLhs)) ||
+                 failed(torch_to_linalg::broadcastToGivenShape(
+                     op, rewriter, rhs, rhsBroadcastToShape,
+                     broadcastedRhs))) {
         return rewriter.notifyMatchFailure(
             op, "unable to perform broadcast operation");
       }
@@ -300,14 +598,17 @@ public:
         Value zeroTensor = createZeroInitTensor(
             rewriter, loc,
             ValueRange{broadcastedBatchShape[0], lhsDim0, rhsDim1},
-            elementType);
-        Value matmul =
-            rewriter
-                .create<linalg::BatchMatmulOp>(
-                    loc, zeroTensor.getType(),
-                    ValueRange{broadcastedLhs, broadcastedRhs}, zeroTensor)
-                .getResult(0);
-        rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType, matmul);
+            accumulatorType);
+        Value matmul = createMatmulOfTransposes(
+            rewriter, loc, broadcastedLhs, broadcastedRhs, zeroTensor);
+        if (!matmul)
+          matmul =
+              rewriter
+                  .create<linalg::BatchMatmulOp>(
+                      loc, zeroTensor.getType(),
+                      ValueRange{broadcastedLhs, broadcastedRhs}, zeroTensor)
+                  .getResult(0);
+        castToResultType(matmul);
         return success();
       }
 
@@ -332,10 +633,19 @@ public:
             j++;
           reassociation[j].push_back(i);
         }
+        // The transposes of the last two dims are collapsed untransposed, and
+        // done by the indexing maps of the batch matmul instead.
+        Value lhsSource, rhsSource;
+        if (accumulatorType.isa<mlir::FloatType>()) {
+          lhsSource = torch_to_linalg::getTransposeSource(broadcastedLhs);
+          rhsSource = torch_to_linalg::getTransposeSource(broadcastedRhs);
+        }
         Value collapsedLhs = rewriter.create<tensor::CollapseShapeOp>(
-            op->getLoc(), broadcastedLhs, reassociation);
+            op->getLoc(), lhsSource ? lhsSource : broadcastedLhs,
+            reassociation);
         Value collapsedRhs = rewriter.create<tensor::CollapseShapeOp>(
-            op->getLoc(), broadcastedRhs, reassociation);
+            op->getLoc(), rhsSource ? rhsSource : broadcastedRhs,
+            reassociation);
 
         // Compute the result shape after collapsing the batch dimensions.
         SmallVector<Value> collapsedResultShape;
@@ -350,22 +660,28 @@ public:
             getAsOpFoldResult(collapsedResultShape);
 
         Value initTensor = rewriter.create<tensor::EmptyOp>(
-            loc, updatedCollapseResultShape, elementType);
+            loc, updatedCollapseResultShape, accumulatorType);
         Value c0 = rewriter.create<arith::ConstantOp>(
-            loc, rewriter.getZeroAttr(elementType));
+            loc, rewriter.getZeroAttr(accumulatorType));
         Value zeroTensor =
             rewriter.create<linalg::FillOp>(loc, c0, initTensor).getResult(0);
 
-        Value batchMatMul =
-            rewriter
-                .create<linalg::BatchMatmulOp>(
-                    loc, zeroTensor.getType(),
-                    ValueRange{collapsedLhs, collapsedRhs}, zeroTensor)
-                .getResult(0);
+        Value batchMatMul;
+        if (lhsSource || rhsSource)
+          batchMatMul = createTransposedMatmul(
+              rewriter, loc, collapsedLhs, /*transposeLhs=*/bool(lhsSource),
+              collapsedRhs, /*transposeRhs=*/bool(rhsSource), zeroTensor);
+        else
+          batchMatMul =
+              rewriter
+                  .create<linalg::BatchMatmulOp>(
+                      loc, zeroTensor.getType(),
+                      ValueRange{collapsedLhs, collapsedRhs}, zeroTensor)
+                  .getResult(0);
         Value expandResult = rewriter.create<tensor::ExpandShapeOp>(
-            loc, resultType, batchMatMul, reassociation);
-        rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType,
-                                                    expandResult);
+            loc, resultType.clone(accumulatorType), batchMatMul,
+            reassociation);
+        castToResultType(expandResult);
         return success();
       }
 
@@ -389,7 +705,7 @@ public:
       SmallVector<Value> resultShape(broadcastedBatchShape);
       resultShape.insert(resultShape.end(), {lhsDim0, rhsDim1});
       Value zeroTensor =
-          createZeroInitTensor(rewriter, loc, resultShape, elementType);
+          createZeroInitTensor(rewriter, loc, resultShape, accumulatorType);
       auto indexingMaps =
           AffineMap::inferFromExprList({lhsExpr, rhsExpr, outExpr});
       iteratorTypes.insert(iteratorTypes.end(),
@@ -405,14 +721,18 @@ public:
                   /*indexingMaps=*/indexingMaps,
                   /*iteratorTypes=*/iteratorTypes,
                   [&](OpBuilder &b, Location loc, ValueRange args) {
-                    Value l = args[0], r = args[1], res = args[2];
+                    Value res = args[2];
+                    Value l = convertScalarToDtype(b, loc, args[0],
+                                                   res.getType());
+                    Value r = convertScalarToDtype(b, loc, args[1],
+                                                   res.getType());
                     Value mul = b.create<arith::MulFOp>(loc, l, r);
                     Value add = b.create<arith::AddFOp>(loc, mul, res);
                     b.create<linalg::YieldOp>(loc, add);
                   })
               .getResult(0);
 
-      rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType, finalRes);
+      castToResultType(finalRes);
       return success();
     }
     return failure();
@@ -421,9 +741,9 @@ public:
 } // namespace
 
 namespace {
-class ConvertAtenBmmOp : public OpConversionPattern<AtenBmmOp> {
+class ConvertAtenBmmOp : public ConvertContractionOp<AtenBmmOp> {
 public:
-  using OpConversionPattern::OpConversionPattern;
+  using ConvertContractionOp::ConvertContractionOp;
   LogicalResult
   matchAndRewrite(AtenBmmOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
@@ -461,23 +781,879 @@ public:
     Type newResultType = getTypeConverter()->convertType(op.getType());
     Type elementType = newResultType.cast<TensorType>().getElementType();
     Value initTensor0 = createZeroInitTensor(
-        rewriter, loc, ValueRange{lhsDim0, lhsDim1, rhsDim2}, elementType);
+        rewriter, loc, ValueRange{lhsDim0, lhsDim1, rhsDim2},
+        getAccumulatorElementType(elementType));
+
+    Value bmm = createMatmulOfTransposes(rewriter, loc, lhs, rhs, initTensor0);
+    if (!bmm)
+      bmm = rewriter
+                .create<linalg::BatchMatmulOp>(
+                    loc, initTensor0.getType(),
+                    ValueRange{lookThroughFloatExtension(lhs),
+                               lookThroughFloatExtension(rhs)},
+                    initTensor0)
+                .getResult(0);
+    bmm = truncateAccumulator(rewriter, loc, bmm, elementType);
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType, bmm);
+    return success();
+  }
+};
+} // namespace
+
+// Returns `initTensor` filled with the convolution bias `bias`, broadcast
+// along every dimension but `channelDim` and extended to the element type of
+// `initTensor`, or with zeros if there is no bias.
+static Value createConvOutputInit(OpBuilder &b, Location loc, Value bias,
+                                  Value initTensor, int64_t channelDim) {
+  auto initType = initTensor.getType().cast<RankedTensorType>();
+  if (bias.getType().isa<Torch::NoneType>()) {
+    Value c0float = b.create<arith::ConstantOp>(
+        loc, FloatAttr::get(initType.getElementType(), 0.0));
+    return b.create<linalg::FillOp>(loc, c0float, initTensor).getResult(0);
+  }
+  int64_t resultRank = initType.getRank();
+  SmallVector<AffineMap> indexingMaps = {
+      AffineMap::get(/*dimCount=*/resultRank, /*symbolCount=*/0,
+                     b.getAffineDimExpr(channelDim), b.getContext()),
+      b.getMultiDimIdentityMap(resultRank)};
+  SmallVector<utils::IteratorType> iteratorTypes(resultRank,
+                                                 utils::IteratorType::parallel);
+  return b
+      .create<linalg::GenericOp>(
+          loc, initType, bias, initTensor, indexingMaps, iteratorTypes,
+          [](OpBuilder &b, Location loc, ValueRange args) {
+            b.create<linalg::YieldOp>(
+                loc, convertScalarToDtype(b, loc, args[0],
+                                          args[1].getType()));
+          })
+      .getResult(0);
+}
+
+// Creates a zero-filled tensor of the static shape `shape`.
+static Value createStaticZeroTensor(OpBuilder &b, Location loc,
+                                    ArrayRef<int64_t> shape, Type elementType) {
+  Value empty = b.create<tensor::EmptyOp>(loc, shape, elementType);
+  Value c0float =
+      b.create<arith::ConstantOp>(loc, FloatAttr::get(elementType, 0.0));
+  return b.create<linalg::FillOp>(loc, c0float, empty).getResult(0);
+}
+
+// Computes a 2D NCHW convolution as a single matmul.
+//
+// The windows of the input are unfolded into a [C * KH * KW, N * OH * OW]
+// matrix (the "im2col" matrix), which is multiplied by the weight reshaped to
+// [F, C * KH * KW]. All the shapes are static. `outShape` is [N, F, OH, OW].
+// The matmul accumulates in `accumulatorType`.
+static Value createIm2colConv(OpBuilder &b, Location loc, Value paddedInput,
+                              Value weight, Value bias,
+                              ArrayRef<int64_t> outShape,
+                              ArrayRef<int64_t> strides,
+                              ArrayRef<int64_t> dilations,
+                              Type accumulatorType) {
+  auto weightType = weight.getType().cast<RankedTensorType>();
+  Type elementType = weightType.getElementType();
+  ArrayRef<int64_t> weightShape = weightType.getShape();
+  int64_t n = outShape[0], f = outShape[1], oh = outShape[2],
+          ow = outShape[3];
+  int64_t c = weightShape[1], kh = weightShape[2], kw = weightShape[3];
+
+  // cols[c, kh, kw, n, oh, ow] =
+  //     input[n, c, oh * stride + kh * dilation, ow * stride + kw * dilation]
+  SmallVector<AffineExpr> d;
+  for (int64_t i = 0; i < 6; i++)
+    d.push_back(b.getAffineDimExpr(i));
+  SmallVector<AffineMap> indexingMaps = inferIndexingMaps(
+      {{d[3], d[0], d[4] * strides[0] + d[1] * dilations[0],
+        d[5] * strides[1] + d[2] * dilations[1]},
+       {d[0], d[1], d[2], d[3], d[4], d[5]}});
+  Value colsInit =
+      b.create<tensor::EmptyOp>(loc, ArrayRef<int64_t>{c, kh, kw, n, oh, ow},
+                                elementType);
+  SmallVector<utils::IteratorType> iteratorTypes(6,
+                                                 utils::IteratorType::parallel);
+  Value cols = b.create<linalg::GenericOp>(
+                    loc, colsInit.getType(), paddedInput, colsInit,
+                    indexingMaps, iteratorTypes,
+                    [](OpBuilder &b, Location loc, ValueRange args) {
+                      b.create<linalg::YieldOp>(loc, args[0]);
+                    })
+                   .getResult(0);
+  int64_t k = c * kh * kw, p = n * oh * ow;
+  cols = b.create<tensor::CollapseShapeOp>(
+      loc, RankedTensorType::get({k, p}, elementType), cols,
+      SmallVector<ReassociationIndices>{{0, 1, 2}, {3, 4, 5}});
+  Value weightMatrix = b.create<tensor::CollapseShapeOp>(
+      loc, RankedTensorType::get({f, k}, elementType), weight,
+      SmallVector<ReassociationIndices>{{0}, {1, 2, 3}});
+
+  Value matmulInit = createConvOutputInit(
+      b, loc, bias, b.create<tensor::EmptyOp>(loc, ArrayRef<int64_t>{f, p},
+                                              accumulatorType),
+      /*channelDim=*/0);
+  Value matmul = b.create<linalg::MatmulOp>(loc, matmulInit.getType(),
+                                            ValueRange{weightMatrix, cols},
+                                            matmulInit)
+                     .getResult(0);
+  Value result = b.create<tensor::ExpandShapeOp>(
+      loc, RankedTensorType::get({f, n, oh, ow}, accumulatorType), matmul,
+      SmallVector<ReassociationIndices>{{0}, {1, 2, 3}});
+  return permuteTensor(b, loc, result, {1, 0, 2, 3});
+}
 
-    Value bmm =
+// The outputs of one phase along a spatial dim of a transposed convolution,
+// see `createSubPixelTransposedConv`.
+struct TransposedConvPhase {
+  // The first kernel tap contributing to the phase.
+  int64_t firstTap;
+  // The number of kernel taps contributing to the phase.
+  int64_t numTaps;
+  // The input contributing to the first output of the phase through its last
+  // tap. It can be out of bounds, i.e. in the padding.
+  int64_t firstInput;
+  // The number of outputs of the phase.
+  int64_t size;
+};
+
+static TransposedConvPhase getTransposedConvPhase(int64_t phase,
+                                                  int64_t stride,
+                                                  int64_t padding,
+                                                  int64_t kernelSize,
+                                                  int64_t outSize) {
+  TransposedConvPhase result;
+  result.firstTap = (phase + padding) % stride;
+  result.numTaps = kernelSize > result.firstTap
+                       ? llvm::divideCeil(kernelSize - result.firstTap, stride)
+                       : 0;
+  result.firstInput = (phase + padding) / stride - result.numTaps + 1;
+  result.size = outSize > phase ? llvm::divideCeil(outSize - phase, stride) : 0;
+  return result;
+}
+
+// Computes a 2D NCHW transposed convolution with dilation 1 without the
+// zero-inserted input of its definition as a convolution, most of whose
+// products would be by zero.
+//
+// Along a spatial dim with stride s and padding p, the outputs o = r + s * j
+// of phase r in [0, s) only get contributions from the kernel taps
+// k = k0 + s * m with k0 = (r + p) mod s, through the inputs
+// i = (r + p) / s + j - m. Each of the s x s phases is thus a stride 1
+// convolution of a window of the input with the flipped taps of that phase,
+// and its results are interleaved into the output. All the shapes are static.
+// `weight` is [C, F, KH, KW] and `outShape` is [N, F, OH, OW]. The
+// convolutions accumulate in `accumulatorType`.
+static Value createSubPixelTransposedConv(Operation *op, OpBuilder &b,
+                                          Location loc, Value input,
+                                          Value weight, Value bias,
+                                          ArrayRef<int64_t> outShape,
+                                          ArrayRef<int64_t> strides,
+                                          ArrayRef<int64_t> paddings,
+                                          Type accumulatorType) {
+  auto inputType = input.getType().cast<RankedTensorType>();
+  auto weightType = weight.getType().cast<RankedTensorType>();
+  Type elementType = inputType.getElementType();
+  int64_t n = outShape[0], f = outShape[1], c = weightType.getDimSize(0);
+
+  // The phases along each spatial dim, and the padding of the input that
+  // covers the windows of all of them.
+  SmallVector<SmallVector<TransposedConvPhase>> phases(2);
+  SmallVector<int64_t> lowPadding(4, 0), highPadding(4, 0);
+  for (int64_t i = 0; i < 2; i++) {
+    int64_t inSize = inputType.getDimSize(i + 2);
+    for (int64_t r = 0; r < strides[i]; r++) {
+      TransposedConvPhase phase =
+          getTransposedConvPhase(r, strides[i], paddings[i],
+                                 weightType.getDimSize(i + 2), outShape[i + 2]);
+      phases[i].push_back(phase);
+      if (phase.numTaps == 0 || phase.size == 0)
+        continue;
+      int64_t lastInput = phase.firstInput + phase.size + phase.numTaps - 2;
+      lowPadding[i + 2] = std::max(lowPadding[i + 2], -phase.firstInput);
+      highPadding[i + 2] =
+          std::max(highPadding[i + 2], lastInput - (inSize - 1));
+    }
+  }
+  Value paddedInput = input;
+  if (llvm::any_of(lowPadding, [](int64_t p) { return p != 0; }) ||
+      llvm::any_of(highPadding, [](int64_t p) { return p != 0; })) {
+    Value zero =
+        b.create<arith::ConstantOp>(loc, FloatAttr::get(elementType, 0.0));
+    paddedInput = torch_to_linalg::getPaddedTensor(op, b, input, lowPadding,
+                                                   highPadding, zero);
+  }
+
+  SmallVector<AffineExpr> d;
+  for (int64_t i = 0; i < 4; i++)
+    d.push_back(b.getAffineDimExpr(i));
+  SmallVector<utils::IteratorType> iteratorTypes(4,
+                                                 utils::IteratorType::parallel);
+  auto unitStrides = b.getI64VectorAttr({1, 1});
+  SmallVector<OpFoldResult> zeroOffset(2, b.getIndexAttr(0));
+  SmallVector<OpFoldResult> oneStride(4, b.getIndexAttr(1));
+  Value result = b.create<tensor::EmptyOp>(loc, outShape, accumulatorType);
+  for (int64_t rh = 0; rh < strides[0]; rh++) {
+    for (int64_t rw = 0; rw < strides[1]; rw++) {
+      const TransposedConvPhase &phaseH = phases[0][rh];
+      const TransposedConvPhase &phaseW = phases[1][rw];
+      if (phaseH.size == 0 || phaseW.size == 0)
+        continue;
+      SmallVector<int64_t> phaseShape{n, f, phaseH.size, phaseW.size};
+      Value phaseResult = createConvOutputInit(
+          b, loc, bias,
+          b.create<tensor::EmptyOp>(loc, phaseShape, accumulatorType),
+          /*channelDim=*/1);
+      if (phaseH.numTaps > 0 && phaseW.numTaps > 0) {
+        SmallVector<OpFoldResult> windowOffsets(zeroOffset);
+        windowOffsets.push_back(
+            b.getIndexAttr(phaseH.firstInput + lowPadding[2]));
+        windowOffsets.push_back(
+            b.getIndexAttr(phaseW.firstInput + lowPadding[3]));
+        SmallVector<OpFoldResult> windowSizes{
+            b.getIndexAttr(n), b.getIndexAttr(c),
+            b.getIndexAttr(phaseH.size + phaseH.numTaps - 1),
+            b.getIndexAttr(phaseW.size + phaseW.numTaps - 1)};
+        Value window = b.create<tensor::ExtractSliceOp>(
+            loc, paddedInput, windowOffsets, windowSizes, oneStride);
+
+        // kernel[f, c, mh, mw] =
+        //     weight[c, f, k0h + sh * (MH - 1 - mh), k0w + sw * (MW - 1 - mw)]
+        AffineExpr tapH =
+            phaseH.firstTap + strides[0] * (phaseH.numTaps - 1) -
+            d[2] * strides[0];
+        AffineExpr tapW =
+            phaseW.firstTap + strides[1] * (phaseW.numTaps - 1) -
+            d[3] * strides[1];
+        Value kernelInit = b.create<tensor::EmptyOp>(
+            loc, ArrayRef<int64_t>{f, c, phaseH.numTaps, phaseW.numTaps},
+            elementType);
+        Value kernel =
+            b.create<linalg::GenericOp>(
+                 loc, kernelInit.getType(), weight, kernelInit,
+                 inferIndexingMaps(
+                     {{d[1], d[0], tapH, tapW}, {d[0], d[1], d[2], d[3]}}),
+                 iteratorTypes,
+                 [](OpBuilder &b, Location loc, ValueRange args) {
+                   b.create<linalg::YieldOp>(loc, args[0]);
+                 })
+                .getResult(0);
+        phaseResult = b.create<linalg::Conv2DNchwFchwOp>(
+                           loc, phaseResult.getType(),
+                           ValueRange{window, kernel}, phaseResult,
+                           unitStrides, unitStrides)
+                          .getResult(0);
+      }
+
+      SmallVector<OpFoldResult> outOffsets(zeroOffset);
+      outOffsets.push_back(b.getIndexAttr(rh));
+      outOffsets.push_back(b.getIndexAttr(rw));
+      SmallVector<OpFoldResult> outSizes;
+      for (int64_t size : phaseShape)
+        outSizes.push_back(b.getIndexAttr(size));
+      SmallVector<OpFoldResult> outStrides{
+          b.getIndexAttr(1), b.getIndexAttr(1), b.getIndexAttr(strides[0]),
+          b.getIndexAttr(strides[1])};
+      result = b.create<tensor::InsertSliceOp>(loc, phaseResult, result,
+                                               outOffsets, outSizes,
+                                               outStrides);
+    }
+  }
+  return result;
+}
+
+// Creates a constant `rows` x `cols` matrix.
+static Value createMatrixConstant(OpBuilder &b, Location loc, Type elementType,
+                                  int64_t rows, int64_t cols,
+                                  ArrayRef<double> values) {
+  SmallVector<Attribute> attrs;
+  for (double value : values)
+    attrs.push_back(FloatAttr::get(elementType, value));
+  auto type = RankedTensorType::get({rows, cols}, elementType);
+  return b.create<arith::ConstantOp>(loc, DenseElementsAttr::get(type, attrs));
+}
+
+// Winograd F(2x2, 3x3) needs 2.25x fewer multiplications in its matmuls than
+// a direct convolution, but transforming the input costs as much per tile as
+// a matmul with 16 output channels, and transforming the output as much as
+// one with 4 input channels. Narrower convolutions are faster without it.
+static constexpr int64_t kWinogradMinChannels = 16;
+
+// Computes a 2D NCHW convolution with a 3x3 kernel, stride 1 and dilation 1
+// with the Winograd F(2x2, 3x3) algorithm, see "Fast Algorithms for
+// Convolutional Neural Networks" (Lavin and Gray, 2015).
+//
+// The output is split into 2x2 tiles, each of which is computed from a 4x4
+// tile of the input as
+//
+//   Y = A^T [(G g G^T) * (B^T d B)] A
+//
+// where `*` is the elementwise product. Over all the channels, this product
+// is a batch of 16 [F, C] x [C, N * tiles] matmuls. All the shapes are
+// static. `outShape` is [N, F, OH, OW].
+static Value createWinogradConv(Operation *op, OpBuilder &b, Location loc,
+                                Value paddedInput, Value weight, Value bias,
+                                ArrayRef<int64_t> outShape) {
+  auto weightType = weight.getType().cast<RankedTensorType>();
+  Type elementType = weightType.getElementType();
+  int64_t n = outShape[0], f = outShape[1], oh = outShape[2],
+          ow = outShape[3];
+  int64_t c = weightType.getDimSize(1);
+  int64_t th = llvm::divideCeil(oh, 2), tw = llvm::divideCeil(ow, 2);
+
+  // Pad the input so that it is covered by whole tiles.
+  SmallVector<int64_t> lowPadding(4, 0);
+  SmallVector<int64_t> highPadding{0, 0, 2 * th - oh, 2 * tw - ow};
+  if (highPadding[2] != 0 || highPadding[3] != 0) {
+    Value c0float =
+        b.create<arith::ConstantOp>(loc, FloatAttr::get(elementType, 0.0));
+    paddedInput = torch_to_linalg::getPaddedTensor(
+        op, b, paddedInput, lowPadding, highPadding, c0float);
+  }
+
+  Value bt = createMatrixConstant(b, loc, elementType, 4, 4,
+                                  {1, 0, -1, 0, 0, 1, 1, 0,
+                                   0, -1, 1, 0, 0, 1, 0, -1});
+  Value g = createMatrixConstant(b, loc, elementType, 4, 3,
+                                 {1, 0, 0, 0.5, 0.5, 0.5,
+                                  0.5, -0.5, 0.5, 0, 0, 1});
+  Value at = createMatrixConstant(b, loc, elementType, 2, 4,
+                                  {1, 1, 1, 0, 0, 1, -1, -1});
+
+  SmallVector<AffineExpr> d;
+  for (int64_t i = 0; i < 8; i++)
+    d.push_back(b.getAffineDimExpr(i));
+  // Multiplies `args[1]` by `args[0]` and `args[2]`, and accumulates the
+  // product into `args[3]`.
+  auto multiplyAccumulate = [](OpBuilder &b, Location loc, ValueRange args) {
+    Value product = b.create<arith::MulFOp>(loc, args[0], args[1]);
+    product = b.create<arith::MulFOp>(loc, product, args[2]);
+    b.create<linalg::YieldOp>(
+        loc, ValueRange{b.create<arith::AddFOp>(loc, args[3], product)});
+  };
+  auto par = utils::IteratorType::parallel;
+  auto red = utils::IteratorType::reduction;
+
+  // U[xi, nu, f, c] = sum(a, b) G[xi, a] * g[f, c, a, b] * G[nu, b]
+  Value u =
+      b.create<linalg::GenericOp>(
+           loc, RankedTensorType::get({4, 4, f, c}, elementType),
+           ValueRange{g, weight, g},
+           createStaticZeroTensor(b, loc, {4, 4, f, c}, elementType),
+           inferIndexingMaps({{d[0], d[4]},
+                              {d[2], d[3], d[4], d[5]},
+                              {d[1], d[5]},
+                              {d[0], d[1], d[2], d[3]}}),
+           SmallVector<utils::IteratorType>{par, par, par, par, red, red},
+           multiplyAccumulate)
+          .getResult(0);
+  u = b.create<tensor::CollapseShapeOp>(
+      loc, RankedTensorType::get({16, f, c}, elementType), u,
+      SmallVector<ReassociationIndices>{{0, 1}, {2}, {3}});
+
+  // V[xi, nu, c, n, th, tw] =
+  //     sum(i, j) B^T[xi, i] * input[n, c, 2 * th + i, 2 * tw + j] * B^T[nu, j]
+  Value v =
+      b.create<linalg::GenericOp>(
+           loc, RankedTensorType::get({4, 4, c, n, th, tw}, elementType),
+           ValueRange{bt, paddedInput, bt},
+           createStaticZeroTensor(b, loc, {4, 4, c, n, th, tw}, elementType),
+           inferIndexingMaps(
+               {{d[0], d[6]},
+                {d[3], d[2], d[4] * 2 + d[6], d[5] * 2 + d[7]},
+                {d[1], d[7]},
+                {d[0], d[1], d[2], d[3], d[4], d[5]}}),
+           SmallVector<utils::IteratorType>{par, par, par, par, par, par, red,
+                                            red},
+           multiplyAccumulate)
+          .getResult(0);
+  int64_t tiles = n * th * tw;
+  v = b.create<tensor::CollapseShapeOp>(
+      loc, RankedTensorType::get({16, c, tiles}, elementType), v,
+      SmallVector<ReassociationIndices>{{0, 1}, {2}, {3, 4, 5}});
+
+  Value m = b.create<linalg::BatchMatmulOp>(
+                 loc, RankedTensorType::get({16, f, tiles}, elementType),
+                 ValueRange{u, v},
+                 createStaticZeroTensor(b, loc, {16, f, tiles}, elementType))
+                .getResult(0);
+  m = b.create<tensor::ExpandShapeOp>(
+      loc, RankedTensorType::get({4, 4, f, n, th, tw}, elementType), m,
+      SmallVector<ReassociationIndices>{{0, 1}, {2}, {3, 4, 5}});
+
+  // Y[n, f, th, a, tw, b] =
+  //     sum(xi, nu) A^T[a, xi] * M[xi, nu, f, n, th, tw] * A^T[b, nu]
+  auto yType = RankedTensorType::get({n, f, th, 2, tw, 2}, elementType);
+  Value yInit = createConvOutputInit(
+      b, loc, bias, b.create<tensor::EmptyOp>(loc, yType.getShape(),
+                                              elementType),
+      /*channelDim=*/1);
+  Value y =
+      b.create<linalg::GenericOp>(
+           loc, yType, ValueRange{at, m, at}, yInit,
+           inferIndexingMaps(
+               {{d[3], d[6]},
+                {d[6], d[7], d[1], d[0], d[2], d[4]},
+                {d[5], d[7]},
+                {d[0], d[1], d[2], d[3], d[4], d[5]}}),
+           SmallVector<utils::IteratorType>{par, par, par, par, par, par, red,
+                                            red},
+           multiplyAccumulate)
+          .getResult(0);
+  y = b.create<tensor::CollapseShapeOp>(
+      loc, RankedTensorType::get({n, f, 2 * th, 2 * tw}, elementType), y,
+      SmallVector<ReassociationIndices>{{0}, {1}, {2, 3}, {4, 5}});
+  if (2 * th == oh && 2 * tw == ow)
+    return y;
+  // Drop the part of the last tiles that falls outside of the output.
+  SmallVector<OpFoldResult> offsets(4, b.getIndexAttr(0));
+  SmallVector<OpFoldResult> strides(4, b.getIndexAttr(1));
+  SmallVector<OpFoldResult> sizes;
+  for (int64_t size : outShape)
+    sizes.push_back(b.getIndexAttr(size));
+  return b.create<tensor::ExtractSliceOp>(loc, y, offsets, sizes, strides);
+}
+
+// Creates the named op of the convolution with `numSpatialDims` spatial dims
+// among `Conv1DOpTy`, `Conv2DOpTy` and `Conv3DOpTy`, which must all have the
+// same operands and layout.
+template <typename Conv1DOpTy, typename Conv2DOpTy, typename Conv3DOpTy>
+static Value createNamedConvOfRank(OpBuilder &b, Location loc,
+                                   size_t numSpatialDims, ValueRange inputs,
+                                   Value output, Attribute strides,
+                                   Attribute dilations) {
+  if (numSpatialDims == 1)
+    return b
+        .create<Conv1DOpTy>(loc, output.getType(), inputs, output, strides,
+                            dilations)
+        .getResult(0);
+  if (numSpatialDims == 2)
+    return b
+        .create<Conv2DOpTy>(loc, output.getType(), inputs, output, strides,
+                            dilations)
+        .getResult(0);
+  return b
+      .create<Conv3DOpTy>(loc, output.getType(), inputs, output, strides,
+                          dilations)
+      .getResult(0);
+}
+
+// Computes a grouped convolution as a `linalg.generic`, for the ranks that
+// have no `linalg.conv_*_ngc*_fgc*` named op. `input` is [N, G, C, spatial
+// dims...], `weight` is [G, F, C, kernel dims...] and `output` is [N, G, F,
+// output dims...], accumulating in the element type of `output`.
+static Value createGroupedConvGeneric(OpBuilder &b, Location loc, Value input,
+                                      Value weight, Value output,
+                                      ArrayRef<int64_t> strides,
+                                      ArrayRef<int64_t> dilations) {
+  int64_t numSpatialDims = strides.size();
+  // The loops are N, G, F, the output dims, C and the kernel dims.
+  int64_t numLoops = 4 + 2 * numSpatialDims;
+  AffineExpr n = b.getAffineDimExpr(0), g = b.getAffineDimExpr(1),
+             f = b.getAffineDimExpr(2),
+             c = b.getAffineDimExpr(3 + numSpatialDims);
+  SmallVector<AffineExpr> inputExprs{n, g, c}, weightExprs{g, f, c},
+      outputExprs{n, g, f};
+  for (int64_t i = 0; i < numSpatialDims; i++) {
+    AffineExpr outputDim = b.getAffineDimExpr(3 + i);
+    AffineExpr kernelDim = b.getAffineDimExpr(4 + numSpatialDims + i);
+    inputExprs.push_back(outputDim * strides[i] + kernelDim * dilations[i]);
+    weightExprs.push_back(kernelDim);
+    outputExprs.push_back(outputDim);
+  }
+  SmallVector<AffineMap> indexingMaps{
+      AffineMap::get(numLoops, /*symbolCount=*/0, inputExprs, b.getContext()),
+      AffineMap::get(numLoops, /*symbolCount=*/0, weightExprs, b.getContext()),
+      AffineMap::get(numLoops, /*symbolCount=*/0, outputExprs,
+                     b.getContext())};
+  SmallVector<utils::IteratorType> iteratorTypes(
+      3 + numSpatialDims, utils::IteratorType::parallel);
+  iteratorTypes.append(1 + numSpatialDims, utils::IteratorType::reduction);
+  return b
+      .create<linalg::GenericOp>(
+          loc, output.getType(), ValueRange{input, weight}, output,
+          indexingMaps, iteratorTypes,
+          [](OpBuilder &b, Location loc, ValueRange args) {
+            Type accumulatorType = args[2].getType();
+            Value x = convertScalarToDtype(b, loc, args[0], accumulatorType);
+            Value w = convertScalarToDtype(b, loc, args[1], accumulatorType);
+            Value product = b.create<arith::MulFOp>(loc, x, w);
+            b.create<linalg::YieldOp>(
+                loc,
+                b.create<arith::AddFOp>(loc, args[2], product).getResult());
+          })
+      .getResult(0);
+}
+
+namespace {
+// Lowers `aten.linear` to a single contraction of the input with the
+// transposed weight, accumulating into the broadcast bias, instead of the
+// transpose, matmul and bias add of its decomposition. The leading dims of the
+// input are kept as parallel loops, so no reshapes are needed. Only the bias
+// is folded into the contraction; an activation that follows is lowered to its
+// own elementwise generic.
+//
+// This op is only seen here if the backend keeps it legal, see
+// `BACKEND_LEGAL_OPS` in `torch_mlir/__init__.py`.
+class ConvertAtenLinearOp : public ConvertContractionOp<AtenLinearOp> {
+public:
+  using ConvertContractionOp::ConvertContractionOp;
+  LogicalResult
+  matchAndRewrite(AtenLinearOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Location loc = op->getLoc();
+    Value input = adaptor.getInput();
+    Value weight = adaptor.getWeight();
+    Value bias = adaptor.getBias();
+    auto inputType = input.getType().cast<RankedTensorType>();
+    auto weightType = weight.getType().cast<RankedTensorType>();
+    auto resultType = getTypeConverter()
+                          ->convertType(op.getType())
+                          .cast<RankedTensorType>();
+    Type elementType = resultType.getElementType();
+    if (inputType.getRank() < 1 || weightType.getRank() != 2)
+      return rewriter.notifyMatchFailure(
+          op, "expected an input of rank at least 1 and a weight of rank 2");
+    if (!elementType.isa<mlir::FloatType>() ||
+        inputType.getElementType() != elementType ||
+        weightType.getElementType() != elementType)
+      return rewriter.notifyMatchFailure(
+          op, "expected floating point operands of the result type");
+    if (!bias.getType().isa<Torch::NoneType>()) {
+      auto biasType = bias.getType().cast<RankedTensorType>();
+      if (biasType.getRank() != 1 || biasType.getElementType() != elementType)
+        return rewriter.notifyMatchFailure(
+            op, "expected a rank 1 bias of the result type");
+    }
+
+    int64_t inputRank = inputType.getRank();
+    int64_t contractingDim = inputRank - 1;
+    checkDimEqualHelper(rewriter, loc,
+                        getDimOp(rewriter, loc, input, contractingDim),
+                        getDimOp(rewriter, loc, weight, 1));
+    SmallVector<Value> outputSizes;
+    for (int64_t i = 0; i < contractingDim; i++)
+      outputSizes.push_back(getDimOp(rewriter, loc, input, i));
+    outputSizes.push_back(getDimOp(rewriter, loc, weight, 0));
+    if (!bias.getType().isa<Torch::NoneType>())
+      checkDimEqualHelper(rewriter, loc, getDimOp(rewriter, loc, bias, 0),
+                          outputSizes.back());
+    Type accumulatorType = getAccumulatorElementType(elementType);
+    Value init = rewriter.create<tensor::EmptyOp>(
+        loc, getAsOpFoldResult(outputSizes), accumulatorType);
+    init = createConvOutputInit(rewriter, loc, bias, init,
+                                /*channelDim=*/contractingDim);
+
+    // The loops are the output dims followed by the contracting dim.
+    SmallVector<AffineExpr> inputExprs, outputExprs;
+    for (int64_t i = 0; i < contractingDim; i++) {
+      inputExprs.push_back(rewriter.getAffineDimExpr(i));
+      outputExprs.push_back(rewriter.getAffineDimExpr(i));
+    }
+    AffineExpr n = rewriter.getAffineDimExpr(contractingDim);
+    AffineExpr k = rewriter.getAffineDimExpr(contractingDim + 1);
+    inputExprs.push_back(k);
+    outputExprs.push_back(n);
+    SmallVector<AffineMap, 4> indexingMaps =
+        inferIndexingMaps({inputExprs, {n, k}, outputExprs});
+    SmallVector<utils::IteratorType> iteratorTypes(
+        inputRank, utils::IteratorType::parallel);
+    iteratorTypes.push_back(utils::IteratorType::reduction);
+    Value result =
         rewriter
-            .create<linalg::BatchMatmulOp>(loc, initTensor0.getType(),
-                                           ValueRange{lhs, rhs}, initTensor0)
+            .create<linalg::GenericOp>(
+                loc, init.getType(), ValueRange{input, weight}, init,
+                indexingMaps, iteratorTypes,
+                [&](OpBuilder &b, Location loc, ValueRange args) {
+                  Value l = convertScalarToDtype(b, loc, args[0],
+                                                 accumulatorType);
+                  Value r = convertScalarToDtype(b, loc, args[1],
+                                                 accumulatorType);
+                  Value product = b.create<arith::MulFOp>(loc, l, r);
+                  Value sum = b.create<arith::AddFOp>(loc, args[2], product);
+                  b.create<linalg::YieldOp>(loc, sum);
+                })
             .getResult(0);
-    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType, bmm);
+    result = truncateAccumulator(rewriter, loc, result, elementType);
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, result);
     return success();
   }
 };
 } // namespace
 
 namespace {
-class ConvertAtenConvolutionOp : public OpConversionPattern<AtenConvolutionOp> {
+// Lowers `torch.group_quantized.linear` to a single contraction that
+// dequantizes each weight as it reads it, so that only the packed weight is
+// read from memory:
+//   out[..., n] += in[..., k] * (q[n, k] * scales[n, k / group_size])
+// where the 4-bit `q[n, k]` is sign-extended from its nibble of the packed
+// weight.
+class ConvertGroupQuantizedLinearOp
+    : public ConvertContractionOp<GroupQuantizedLinearOp> {
 public:
-  using OpConversionPattern::OpConversionPattern;
+  using ConvertContractionOp::ConvertContractionOp;
+  LogicalResult
+  matchAndRewrite(GroupQuantizedLinearOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Location loc = op->getLoc();
+    Value input = adaptor.getInput();
+    Value weight = adaptor.getPackedWeight();
+    Value scales = adaptor.getScales();
+    Value bias = adaptor.getBias();
+    int64_t bits, groupSize;
+    if (!matchPattern(op.getBits(), m_TorchConstantInt(&bits)) ||
+        (bits != 4 && bits != 8))
+      return rewriter.notifyMatchFailure(op, "expected 4 or 8 constant bits");
+    if (!matchPattern(op.getGroupSize(), m_TorchConstantInt(&groupSize)) ||
+        groupSize <= 0 || (bits == 4 && groupSize % 2 != 0))
+      return rewriter.notifyMatchFailure(
+          op, "expected a positive constant group size, even for 4 bits");
+    auto inputType = input.getType().cast<RankedTensorType>();
+    auto weightType = weight.getType().cast<RankedTensorType>();
+    auto scalesType = scales.getType().cast<RankedTensorType>();
+    auto resultType = getTypeConverter()
+                          ->convertType(op.getType())
+                          .cast<RankedTensorType>();
+    Type elementType = resultType.getElementType();
+    if (inputType.getRank() < 1 || weightType.getRank() != 2 ||
+        scalesType.getRank() != 2)
+      return rewriter.notifyMatchFailure(
+          op, "expected an input of rank at least 1, and a weight and scales "
+              "of rank 2");
+    if (!elementType.isa<mlir::FloatType>() ||
+        inputType.getElementType() != elementType ||
+        scalesType.getElementType() != elementType ||
+        !weightType.getElementType().isInteger(8))
+      return rewriter.notifyMatchFailure(
+          op, "expected an i8 weight, and floating point input and scales of "
+              "the result type");
+    if (!bias.getType().isa<Torch::NoneType>()) {
+      auto biasType = bias.getType().cast<RankedTensorType>();
+      if (biasType.getRank() != 1 || biasType.getElementType() != elementType)
+        return rewriter.notifyMatchFailure(
+            op, "expected a rank 1 bias of the result type");
+    }
+
+    int64_t inputRank = inputType.getRank();
+    int64_t contractingDim = inputRank - 1;
+    Value inputSize = getDimOp(rewriter, loc, input, contractingDim);
+    auto mulDim = [&](Value dim, int64_t factor) -> Value {
+      if (factor == 1)
+        return dim;
+      return rewriter.create<arith::MulIOp>(
+          loc, dim, rewriter.create<arith::ConstantIndexOp>(loc, factor));
+    };
+    checkDimEqualHelper(
+        rewriter, loc, inputSize,
+        mulDim(getDimOp(rewriter, loc, weight, 1), 8 / bits));
+    checkDimEqualHelper(
+        rewriter, loc, inputSize,
+        mulDim(getDimOp(rewriter, loc, scales, 1), groupSize));
+    SmallVector<Value> outputSizes;
+    for (int64_t i = 0; i < contractingDim; i++)
+      outputSizes.push_back(getDimOp(rewriter, loc, input, i));
+    outputSizes.push_back(getDimOp(rewriter, loc, weight, 0));
+    checkDimEqualHelper(rewriter, loc, getDimOp(rewriter, loc, scales, 0),
+                        outputSizes.back());
+    if (!bias.getType().isa<Torch::NoneType>())
+      checkDimEqualHelper(rewriter, loc, getDimOp(rewriter, loc, bias, 0),
+                          outputSizes.back());
+    Type accumulatorType = getAccumulatorElementType(elementType);
+    Value init = rewriter.create<tensor::EmptyOp>(
+        loc, getAsOpFoldResult(outputSizes), accumulatorType);
+    init = createConvOutputInit(rewriter, loc, bias, init,
+                                /*channelDim=*/contractingDim);
+
+    // The loops are the output dims followed by the contracting dim.
+    SmallVector<AffineExpr> inputExprs, outputExprs;
+    for (int64_t i = 0; i < contractingDim; i++) {
+      inputExprs.push_back(rewriter.getAffineDimExpr(i));
+      outputExprs.push_back(rewriter.getAffineDimExpr(i));
+    }
+    AffineExpr n = rewriter.getAffineDimExpr(contractingDim);
+    AffineExpr k = rewriter.getAffineDimExpr(contractingDim + 1);
+    inputExprs.push_back(k);
+    outputExprs.push_back(n);
+    SmallVector<AffineMap, 4> indexingMaps = inferIndexingMaps(
+        {inputExprs, {n, k.floorDiv(8 / bits)}, {n, k.floorDiv(groupSize)},
+         outputExprs});
+    SmallVector<utils::IteratorType> iteratorTypes(
+        inputRank, utils::IteratorType::parallel);
+    iteratorTypes.push_back(utils::IteratorType::reduction);
+    Value result =
+        rewriter
+            .create<linalg::GenericOp>(
+                loc, init.getType(), ValueRange{input, weight, scales}, init,
+                indexingMaps, iteratorTypes,
+                [&](OpBuilder &b, Location loc, ValueRange args) {
+                  Value q = args[1];
+                  if (bits == 4) {
+                    // Move the nibble of `k` to the high nibble, and shift it
+                    // back to sign-extend it.
+                    Type i8 = q.getType();
+                    Value index = b.create<linalg::IndexOp>(loc,
+                                                            contractingDim + 1);
+                    Value parity = b.create<arith::AndIOp>(
+                        loc, b.create<arith::IndexCastOp>(loc, i8, index),
+                        b.create<arith::ConstantOp>(
+                            loc, b.getIntegerAttr(i8, 1)));
+                    Value four = b.create<arith::ConstantOp>(
+                        loc, b.getIntegerAttr(i8, 4));
+                    Value shift = b.create<arith::SubIOp>(
+                        loc, four,
+                        b.create<arith::ShLIOp>(
+                            loc, parity,
+                            b.create<arith::ConstantOp>(
+                                loc, b.getIntegerAttr(i8, 2))));
+                    q = b.create<arith::ShRSIOp>(
+                        loc, b.create<arith::ShLIOp>(loc, q, shift), four);
+                  }
+                  Value w = b.create<arith::SIToFPOp>(loc, accumulatorType, q);
+                  Value scale = convertScalarToDtype(b, loc, args[2],
+                                                     accumulatorType);
+                  Value x = convertScalarToDtype(b, loc, args[0],
+                                                 accumulatorType);
+                  Value product = b.create<arith::MulFOp>(
+                      loc, x, b.create<arith::MulFOp>(loc, w, scale));
+                  Value sum = b.create<arith::AddFOp>(loc, args[3], product);
+                  b.create<linalg::YieldOp>(loc, sum);
+                })
+            .getResult(0);
+    result = truncateAccumulator(rewriter, loc, result, elementType);
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, result);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Lowers `torch.semi_structured_sparse.linear` to a contraction over the
+// stored weights only, gathering the input element that each of them
+// multiplies:
+//   out[..., n] += in[..., 4 * (j / 2) + indices[n, j]] * values[n, j]
+class ConvertSemiStructuredSparseLinearOp
+    : public ConvertContractionOp<SemiStructuredSparseLinearOp> {
+public:
+  using ConvertContractionOp::ConvertContractionOp;
+  LogicalResult
+  matchAndRewrite(SemiStructuredSparseLinearOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Location loc = op->getLoc();
+    Value input = adaptor.getInput();
+    Value values = adaptor.getValues();
+    Value indices = adaptor.getIndices();
+    Value bias = adaptor.getBias();
+    auto inputType = input.getType().cast<RankedTensorType>();
+    auto valuesType = values.getType().cast<RankedTensorType>();
+    auto indicesType = indices.getType().cast<RankedTensorType>();
+    auto resultType = getTypeConverter()
+                          ->convertType(op.getType())
+                          .cast<RankedTensorType>();
+    Type elementType = resultType.getElementType();
+    if (inputType.getRank() < 1 || valuesType.getRank() != 2 ||
+        indicesType.getRank() != 2)
+      return rewriter.notifyMatchFailure(
+          op, "expected an input of rank at least 1, and values and indices "
+              "of rank 2");
+    if (!elementType.isa<mlir::FloatType>() ||
+        inputType.getElementType() != elementType ||
+        valuesType.getElementType() != elementType ||
+        !indicesType.getElementType().isInteger(8))
+      return rewriter.notifyMatchFailure(
+          op, "expected i8 indices, and floating point input and values of "
+              "the result type");
+    if (!bias.getType().isa<Torch::NoneType>()) {
+      auto biasType = bias.getType().cast<RankedTensorType>();
+      if (biasType.getRank() != 1 || biasType.getElementType() != elementType)
+        return rewriter.notifyMatchFailure(
+            op, "expected a rank 1 bias of the result type");
+    }
+
+    int64_t inputRank = inputType.getRank();
+    int64_t contractingDim = inputRank - 1;
+    Value c2 = rewriter.create<arith::ConstantIndexOp>(loc, 2);
+    checkDimEqualHelper(
+        rewriter, loc, getDimOp(rewriter, loc, input, contractingDim),
+        rewriter.create<arith::MulIOp>(loc, getDimOp(rewriter, loc, values, 1),
+                                       c2));
+    for (int64_t i = 0; i < 2; i++)
+      checkDimEqualHelper(rewriter, loc, getDimOp(rewriter, loc, values, i),
+                          getDimOp(rewriter, loc, indices, i));
+    SmallVector<Value> outputSizes;
+    for (int64_t i = 0; i < contractingDim; i++)
+      outputSizes.push_back(getDimOp(rewriter, loc, input, i));
+    outputSizes.push_back(getDimOp(rewriter, loc, values, 0));
+    if (!bias.getType().isa<Torch::NoneType>())
+      checkDimEqualHelper(rewriter, loc, getDimOp(rewriter, loc, bias, 0),
+                          outputSizes.back());
+    Type accumulatorType = getAccumulatorElementType(elementType);
+    Value init = rewriter.create<tensor::EmptyOp>(
+        loc, getAsOpFoldResult(outputSizes), accumulatorType);
+    init = createConvOutputInit(rewriter, loc, bias, init,
+                                /*channelDim=*/contractingDim);
+
+    // The loops are the output dims followed by the dim of the stored weights
+    // of a row. The input is read with `tensor.extract`, since which of its
+    // elements is read depends on the indices.
+    SmallVector<AffineExpr> outputExprs;
+    for (int64_t i = 0; i < contractingDim; i++)
+      outputExprs.push_back(rewriter.getAffineDimExpr(i));
+    AffineExpr n = rewriter.getAffineDimExpr(contractingDim);
+    AffineExpr j = rewriter.getAffineDimExpr(contractingDim + 1);
+    outputExprs.push_back(n);
+    SmallVector<AffineMap, 3> indexingMaps =
+        inferIndexingMaps({{n, j}, {n, j}, outputExprs});
+    SmallVector<utils::IteratorType> iteratorTypes(
+        inputRank, utils::IteratorType::parallel);
+    iteratorTypes.push_back(utils::IteratorType::reduction);
+    Value result =
+        rewriter
+            .create<linalg::GenericOp>(
+                loc, init.getType(), ValueRange{values, indices}, init,
+                indexingMaps, iteratorTypes,
+                [&](OpBuilder &b, Location loc, ValueRange args) {
+                  SmallVector<Value> inputIndices;
+                  for (int64_t i = 0; i < contractingDim; i++)
+                    inputIndices.push_back(b.create<linalg::IndexOp>(loc, i));
+                  // The start of the group of `j` is `4 * (j / 2) = 2 * j`
+                  // rounded down to a multiple of 4.
+                  Value groupStart = b.create<arith::AndIOp>(
+                      loc,
+                      b.create<arith::ShLIOp>(
+                          loc,
+                          b.create<linalg::IndexOp>(loc, contractingDim + 1),
+                          b.create<arith::ConstantIndexOp>(loc, 1)),
+                      b.create<arith::ConstantIndexOp>(loc, ~int64_t(3)));
+                  Value offset = b.create<arith::IndexCastOp>(
+                      loc, b.getIndexType(), args[1]);
+                  inputIndices.push_back(
+                      b.create<arith::AddIOp>(loc, groupStart, offset));
+                  Value x = b.create<tensor::ExtractOp>(loc, input,
+                                                        inputIndices);
+                  x = convertScalarToDtype(b, loc, x, accumulatorType);
+                  Value w = convertScalarToDtype(b, loc, args[0],
+                                                 accumulatorType);
+                  Value product = b.create<arith::MulFOp>(loc, x, w);
+                  Value sum = b.create<arith::AddFOp>(loc, args[2], product);
+                  b.create<linalg::YieldOp>(loc, sum);
+                })
+            .getResult(0);
+    result = truncateAccumulator(rewriter, loc, result, elementType);
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, result);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+class ConvertAtenConvolutionOp
+    : public ConvertContractionOp<AtenConvolutionOp> {
+public:
+  using ConvertContractionOp::ConvertContractionOp;
+
   LogicalResult
   matchAndRewrite(AtenConvolutionOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
@@ -497,9 +1673,9 @@ public:
       return op.emitError("unimplemented: non-floating point type");
     size_t inRank = input.getType().cast<RankedTensorType>().getRank();
     size_t numSpacialDims = inRank - 2;
-    if (numSpacialDims != 2)
+    if (numSpacialDims < 1 || numSpacialDims > 3)
       return rewriter.notifyMatchFailure(
-          op, "unimplemented: only 2D convolution currently supported");
+          op, "unimplemented: only 1D, 2D and 3D convolutions supported");
 
     Type intType = IntegerType::get(context, 64);
     auto castIndexToInt = [&](Value v) {
@@ -564,6 +1740,49 @@ public:
     SmallVector<Value> strideIntValues =
         getAsConstantIntValues(rewriter, loc, strideInts);
 
+    // Statically shaped transposed convolutions are computed one output
+    // phase at a time rather than as a convolution of the zero-inserted
+    // input.
+    Type accumulatorType = getAccumulatorElementType(elementType);
+    SmallVector<int64_t> transposedPaddingInts, outputPaddingInts;
+    auto inputTensorType = input.getType().cast<RankedTensorType>();
+    auto weightTensorType = weight.getType().cast<RankedTensorType>();
+    if (transposed && numSpacialDims == 2 && groupSize == 1 &&
+        llvm::all_of(dilationInts, [](int64_t d) { return d == 1; }) &&
+        inputTensorType.hasStaticShape() &&
+        weightTensorType.hasStaticShape() &&
+        matchPattern(op.getPadding(),
+                     m_TorchListOfConstantInts(transposedPaddingInts)) &&
+        transposedPaddingInts.size() == numSpacialDims &&
+        matchPattern(op.getOutputPadding(),
+                     m_TorchListOfConstantInts(outputPaddingInts)) &&
+        outputPaddingInts.size() == numSpacialDims) {
+      SmallVector<int64_t> outShape{inputTensorType.getDimSize(0),
+                                    weightTensorType.getDimSize(1)};
+      for (size_t i = 0; i < numSpacialDims; i++) {
+        outShape.push_back(
+            (inputTensorType.getDimSize(i + 2) - 1) * strideInts[i] -
+            2 * transposedPaddingInts[i] +
+            weightTensorType.getDimSize(i + 2) + outputPaddingInts[i]);
+      }
+      Value bias = adaptor.getBias();
+      bool isValidBias = true;
+      if (auto biasType = bias.getType().dyn_cast<RankedTensorType>()) {
+        isValidBias = biasType.getRank() == 1 &&
+                      biasType.getElementType() == elementType;
+      }
+      if (isValidBias &&
+          llvm::all_of(outShape, [](int64_t size) { return size > 0; })) {
+        Value conv = createSubPixelTransposedConv(
+            op, rewriter, loc, input, weight, bias, outShape, strideInts,
+            transposedPaddingInts, accumulatorType);
+        conv = truncateAccumulator(rewriter, loc, conv, elementType);
+        Type newResultType = getTypeConverter()->convertType(op.getType());
+        rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType, conv);
+        return success();
+      }
+    }
+
     // Pad the input tensor according to padding.
     SmallVector<Value> outDims{inBatch, weightBatch};
     Value paddedInput;
@@ -661,9 +1880,26 @@ public:
       strideInts.append(numSpacialDims, 1);
 
     } else {
-      // Pad input
-      paddedInput = torch_to_linalg::getDynamicZeroPaddedTensor(
-          op, rewriter, input, paddingIntValues, /*unpaddedDims=*/2);
+      // Pad the input. With constant paddings the tensor.pad has static
+      // paddings and keeps the static sizes of the input, so that it can be
+      // fused into the tiles of the convolution, and it is omitted without
+      // padding.
+      SmallVector<int64_t> constPaddingInts;
+      if (matchPattern(op.getPadding(),
+                       m_TorchListOfConstantInts(constPaddingInts)) &&
+          constPaddingInts.size() == numSpacialDims) {
+        if (llvm::all_of(constPaddingInts, [](int64_t p) { return p == 0; })) {
+          paddedInput = input;
+        } else {
+          SmallVector<int64_t> paddingIncludingNC = {0, 0};
+          paddingIncludingNC.append(constPaddingInts);
+          paddedInput = torch_to_linalg::getZeroPaddedTensor(
+              op, rewriter, input, paddingIncludingNC);
+        }
+      } else {
+        paddedInput = torch_to_linalg::getDynamicZeroPaddedTensor(
+            op, rewriter, input, paddingIntValues, /*unpaddedDims=*/2);
+      }
 
       // Calculate output dims
       for (size_t i = 0; i < numSpacialDims; i++)
@@ -673,39 +1909,18 @@ public:
     }
 
     Value initTensor = rewriter.create<tensor::EmptyOp>(
-        loc, getAsOpFoldResult(outDims), elementType);
+        loc, getAsOpFoldResult(outDims), accumulatorType);
 
     Value bias = adaptor.getBias();
-    Value outputTensor;
-    if (bias.getType().isa<Torch::NoneType>()) {
-      Value c0float = rewriter.create<arith::ConstantOp>(
-          loc, FloatAttr::get(elementType, 0.0));
-      outputTensor = rewriter.create<linalg::FillOp>(loc, c0float, initTensor)
-                         .getResult(0);
-    } else {
+    if (!bias.getType().isa<Torch::NoneType>()) {
       auto biasType = bias.getType().cast<RankedTensorType>();
       if (biasType.getRank() != 1)
         return rewriter.notifyMatchFailure(op, "expect bias to be rank 1");
       if (elementType != biasType.getElementType())
         return rewriter.notifyMatchFailure(op, "unimplemented: type promotion");
-
-      auto resultRank = initTensor.getType().cast<RankedTensorType>().getRank();
-      SmallVector<AffineMap> indexingMaps = {
-          // bias is used to initialize the channels - dimension 1 of output
-          AffineMap::get(/*dimCount=*/resultRank, /*symbolCount=*/0,
-                         rewriter.getAffineDimExpr(1), context),
-          rewriter.getMultiDimIdentityMap(resultRank)};
-      SmallVector<utils::IteratorType> iteratorTypes(
-          resultRank, utils::IteratorType::parallel);
-      outputTensor = rewriter
-                         .create<linalg::GenericOp>(
-                             loc, initTensor.getType(), bias, initTensor,
-                             indexingMaps, iteratorTypes,
-                             [](OpBuilder &b, Location loc, ValueRange args) {
-                               b.create<linalg::YieldOp>(loc, args[0]);
-                             })
-                         .getResult(0);
     }
+    Value outputTensor =
+        createConvOutputInit(rewriter, loc, bias, initTensor, /*channelDim=*/1);
 
     auto stridesAttr = rewriter.getI64VectorAttr(strideInts);
     auto dilationAttr = rewriter.getI64VectorAttr(dilationInts);
@@ -726,41 +1941,182 @@ public:
     SmallVector<Value> weightSliceSizes{weightStride, weightChannels};
     weightSliceSizes.append(weightDims);
 
+    // The NWC, NHWC and NDHWC named ops take the input and the output with
+    // the channels last, and their weights with the spatial dims first.
+    SmallVector<int64_t> channelsLastPerm{0}, channelsFirstPerm{0};
+    channelsFirstPerm.push_back(inRank - 1);
+    SmallVector<int64_t> spatialDims;
+    for (size_t i = 2; i < inRank; i++) {
+      channelsLastPerm.push_back(i);
+      channelsFirstPerm.push_back(i - 1);
+      spatialDims.push_back(i);
+    }
+    channelsLastPerm.push_back(1);
+    auto toNhwc = [&](Value tensor) {
+      return permuteTensor(rewriter, loc, tensor, channelsLastPerm);
+    };
+    auto toNchw = [&](Value tensor) {
+      return permuteTensor(rewriter, loc, tensor, channelsFirstPerm);
+    };
+
     Value conv;
     if (groupSize == 1) {
+      // Statically shaped 2D convolutions can be lowered to matmuls instead.
+      auto inputType = input.getType().cast<RankedTensorType>();
+      auto weightType = weight.getType().cast<RankedTensorType>();
+      SmallVector<int64_t> paddingInts, paddedShape, staticOutShape;
+      bool isStatic = numSpacialDims == 2 && !transposed &&
+                      inputType.hasStaticShape() &&
+                      weightType.hasStaticShape() &&
+                      matchPattern(op.getPadding(),
+                                   m_TorchListOfConstantInts(paddingInts)) &&
+                      paddingInts.size() == numSpacialDims;
+      if (isStatic) {
+        paddedShape = {inputType.getDimSize(0), inputType.getDimSize(1)};
+        staticOutShape = {inputType.getDimSize(0), weightType.getDimSize(0)};
+        for (size_t i = 0; i < numSpacialDims; i++) {
+          paddedShape.push_back(inputType.getDimSize(i + 2) +
+                                2 * paddingInts[i]);
+          int64_t window =
+              dilationInts[i] * (weightType.getDimSize(i + 2) - 1) + 1;
+          staticOutShape.push_back((paddedShape.back() - window) /
+                                       strideInts[i] +
+                                   1);
+          isStatic &= staticOutShape.back() > 0;
+        }
+      }
+      auto isOne = [](int64_t i) { return i == 1; };
+      // The Winograd transforms are computed in the element type, so they
+      // can't accumulate in a wider type.
+      bool useWinograd =
+          options.winograd && isStatic && accumulatorType == elementType &&
+          weightType.getDimSize(2) == 3 &&
+          weightType.getDimSize(3) == 3 && llvm::all_of(strideInts, isOne) &&
+          llvm::all_of(dilationInts, isOne) &&
+          weightType.getDimSize(0) >= kWinogradMinChannels &&
+          weightType.getDimSize(1) >= kWinogradMinChannels;
+
       // TODO: add 1D and 3D case
-      conv =
-          rewriter
-              .create<linalg::Conv2DNchwFchwOp>(
-                  loc, outputTensor.getType(), ValueRange{paddedInput, weight},
-                  outputTensor, stridesAttr, dilationAttr)
-              .getResult(0);
+      if (useWinograd || (options.im2col && isStatic)) {
+        Value staticInput = paddedInput;
+        if (staticInput.getType() != inputType.clone(paddedShape))
+          staticInput = rewriter.create<tensor::CastOp>(
+              loc, inputType.clone(paddedShape), paddedInput);
+        if (useWinograd)
+          conv = createWinogradConv(op, rewriter, loc, staticInput, weight,
+                                    bias, staticOutShape);
+        else
+          conv = createIm2colConv(rewriter, loc, staticInput, weight, bias,
+                                  staticOutShape, strideInts, dilationInts,
+                                  accumulatorType);
+      } else if (options.nhwc) {
+        SmallVector<int64_t> hwcfPerm(spatialDims);
+        hwcfPerm.append({1, 0});
+        conv = createNamedConvOfRank<linalg::Conv1DNwcWcfOp,
+                                     linalg::Conv2DNhwcHwcfOp,
+                                     linalg::Conv3DNdhwcDhwcfOp>(
+            rewriter, loc, numSpacialDims,
+            ValueRange{toNhwc(paddedInput),
+                       permuteTensor(rewriter, loc, weight, hwcfPerm)},
+            toNhwc(outputTensor), stridesAttr, dilationAttr);
+        conv = toNchw(conv);
+      } else {
+        conv = createNamedConvOfRank<linalg::Conv1DNcwFcwOp,
+                                     linalg::Conv2DNchwFchwOp,
+                                     linalg::Conv3DNcdhwFcdhwOp>(
+            rewriter, loc, numSpacialDims, ValueRange{paddedInput, weight},
+            outputTensor, stridesAttr, dilationAttr);
+      }
     } else {
-      // Special depthwise case
+      // Special depthwise case, where every input channel is its own group
+      // and produces `multiplier` output channels.
       auto inShape = makeShapeTorchCompatible(
           input.getType().cast<RankedTensorType>().getShape());
       auto weightShape = makeShapeTorchCompatible(
           weight.getType().cast<RankedTensorType>().getShape());
       if (weightShape[0] != kUnknownSize && inShape[1] == groupSize &&
           weightShape[0] % inShape[1] == 0 && weightShape[1] == 1) {
+        int64_t multiplier = weightShape[0] / inShape[1];
         // Collapse weight shape
-        SmallVector<ReassociationIndices, 4> collapsedDims = {{0, 1}, {2}, {3}};
-        SmallVector<int64_t> collapsedShape{
-            (weightShape[0] == kUnknownSize ? kUnknownSize
-                                            : weightShape[0] * weightShape[1]),
-            weightShape[2], weightShape[3]};
+        SmallVector<ReassociationIndices, 4> collapsedDims = {{0, 1}};
+        SmallVector<int64_t> collapsedShape{weightShape[0] * weightShape[1]};
+        for (int64_t dim : spatialDims) {
+          collapsedDims.push_back({dim});
+          collapsedShape.push_back(weightShape[dim]);
+        }
         Type collapsedType = RankedTensorType::get(
             makeShapeLLVMCompatible(collapsedShape), elementType);
         Value collapsedWeight = rewriter.create<tensor::CollapseShapeOp>(
             loc, collapsedType, weight, collapsedDims);
 
-        conv = rewriter
-                   .create<linalg::DepthwiseConv2DNchwChwOp>(
-                       loc, outputTensor.getType(),
-                       ValueRange{paddedInput, collapsedWeight}, outputTensor,
-                       stridesAttr, dilationAttr)
-                   .getResult(0);
+        if (multiplier == 1 && !options.nhwc) {
+          conv = createNamedConvOfRank<linalg::DepthwiseConv1DNcwCwOp,
+                                       linalg::DepthwiseConv2DNchwChwOp,
+                                       linalg::DepthwiseConv3DNcdhwCdhwOp>(
+              rewriter, loc, numSpacialDims,
+              ValueRange{paddedInput, collapsedWeight}, outputTensor,
+              stridesAttr, dilationAttr);
+        } else if (multiplier == 1) {
+          SmallVector<int64_t> hwcPerm;
+          for (size_t i = 1; i <= numSpacialDims; i++)
+            hwcPerm.push_back(i);
+          hwcPerm.push_back(0);
+          conv = createNamedConvOfRank<linalg::DepthwiseConv1DNwcWcOp,
+                                       linalg::DepthwiseConv2DNhwcHwcOp,
+                                       linalg::DepthwiseConv3DNdhwcDhwcOp>(
+              rewriter, loc, numSpacialDims,
+              ValueRange{toNhwc(paddedInput),
+                         permuteTensor(rewriter, loc, collapsedWeight,
+                                       hwcPerm)},
+              toNhwc(outputTensor), stridesAttr, dilationAttr);
+          conv = toNchw(conv);
+        } else {
+          // There is no NCHW depthwise op with a multiplier, so this case
+          // always goes through NHWC, with the output channels split into
+          // [channels, multiplier] and the weight laid out as HWCM.
+          SmallVector<int64_t> expandedWeightShape{inShape[1], multiplier};
+          for (int64_t dim : spatialDims)
+            expandedWeightShape.push_back(weightShape[dim]);
+          Value expandedWeight = rewriter.create<tensor::ExpandShapeOp>(
+              loc,
+              RankedTensorType::get(
+                  makeShapeLLVMCompatible(expandedWeightShape), elementType),
+              collapsedWeight, collapsedDims);
+          SmallVector<int64_t> hwcmPerm(spatialDims);
+          hwcmPerm.append({0, 1});
+          Value hwcmWeight =
+              permuteTensor(rewriter, loc, expandedWeight, hwcmPerm);
+
+          auto outputType = outputTensor.getType().cast<RankedTensorType>();
+          SmallVector<int64_t> nhwcOutputShape{outputType.getDimSize(0)};
+          for (int64_t dim : spatialDims)
+            nhwcOutputShape.push_back(outputType.getDimSize(dim));
+          nhwcOutputShape.push_back(weightShape[0]);
+          Value nhwcOutput = rewriter.create<tensor::CastOp>(
+              loc, outputType.clone(nhwcOutputShape), toNhwc(outputTensor));
+          SmallVector<ReassociationIndices> channelDims;
+          for (int64_t i = 0; i < (int64_t)inRank - 1; i++)
+            channelDims.push_back({i});
+          channelDims.push_back({(int64_t)inRank - 1, (int64_t)inRank});
+          SmallVector<int64_t> expandedOutputShape(nhwcOutputShape);
+          expandedOutputShape.back() = inShape[1];
+          expandedOutputShape.push_back(multiplier);
+          Value expandedOutput = rewriter.create<tensor::ExpandShapeOp>(
+              loc, outputType.clone(expandedOutputShape), nhwcOutput,
+              channelDims);
+
+          conv = createNamedConvOfRank<linalg::DepthwiseConv1DNwcWcmOp,
+                                       linalg::DepthwiseConv2DNhwcHwcmOp,
+                                       linalg::DepthwiseConv3DNdhwcDhwcmOp>(
+              rewriter, loc, numSpacialDims,
+              ValueRange{toNhwc(paddedInput), hwcmWeight}, expandedOutput,
+              stridesAttr, dilationAttr);
+          conv = rewriter.create<tensor::CollapseShapeOp>(
+              loc, nhwcOutput.getType(), conv, channelDims);
+          conv = toNchw(conv);
+        }
 
+        conv = truncateAccumulator(rewriter, loc, conv, elementType);
         Type newResultType = getTypeConverter()->convertType(op.getType());
         rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType, conv);
         return success();
@@ -821,13 +2177,18 @@ public:
       Value weightExpanded = expandWeight(weight);
       Value outputTensorExpanded = expandGroups(outputTensor, 1);
 
-      // TODO: add 1D and 3D case
-      conv = rewriter
-                 .create<linalg::Conv2DNgchwFgchwOp>(
-                     loc, outputTensorExpanded.getType(),
-                     ValueRange{paddedInputExpanded, weightExpanded},
-                     outputTensorExpanded, stridesAttr, dilationAttr)
-                 .getResult(0);
+      if (numSpacialDims == 2) {
+        conv = rewriter
+                   .create<linalg::Conv2DNgchwFgchwOp>(
+                       loc, outputTensorExpanded.getType(),
+                       ValueRange{paddedInputExpanded, weightExpanded},
+                       outputTensorExpanded, stridesAttr, dilationAttr)
+                   .getResult(0);
+      } else {
+        conv = createGroupedConvGeneric(rewriter, loc, paddedInputExpanded,
+                                        weightExpanded, outputTensorExpanded,
+                                        strideInts, dilationInts);
+      }
 
       SmallVector<ReassociationIndices> indices{{0}, {1, 2}};
       for (auto dim = 3; dim <= (int64_t)inRank; dim++)
@@ -836,6 +2197,7 @@ public:
           loc, outputTensor.getType(), conv, indices);
     }
 
+    conv = truncateAccumulator(rewriter, loc, conv, elementType);
     Type newResultType = getTypeConverter()->convertType(op.getType());
     rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType, conv);
     return success();
@@ -843,18 +2205,386 @@ public:
 };
 } // namespace
 
+namespace {
+// An operand of a quantized contraction: the integer representation of an
+// 8-bit affine quantized tensor, as signed integers, with its zero point as an
+// i32 and either its scale or, if it is quantized per channel, the tensor of
+// its scales.
+struct QuantizedOperand {
+  Value intRepr;
+  Value scale;
+  Value channelScales;
+  Value zeroPoint;
+};
+} // namespace
+
+// Returns true if `value` is a literal tensor of zeros.
+static bool isZeroLiteral(Value value) {
+  auto literal = value.getDefiningOp<ValueTensorLiteralOp>();
+  if (!literal)
+    return false;
+  auto elements = literal.getValue().dyn_cast<DenseIntElementsAttr>();
+  return elements && llvm::all_of(elements.getValues<APInt>(),
+                                  [](const APInt &v) { return v.isZero(); });
+}
+
+// Matches `value` as the `aten.dequantize.self` of a per-tensor affine
+// quantized tensor with known quantization parameters or, if `channelAxis` is
+// given, of a tensor quantized per channel along it. The linalg quantized ops
+// only take scalar zero points, so the zero points of a per-channel quantized
+// tensor must be literal zeros, as with symmetric quantization.
+//
+// The linalg quantized ops sign extend their operands, so the integer
+// representation of a quint8 tensor is shifted to the signed range by
+// flipping its sign bit, and its zero point by subtracting 128, which leaves
+// `int_repr - zero_point` unchanged.
+static FailureOr<QuantizedOperand>
+matchDequantizedOperand(ConversionPatternRewriter &rewriter, Location loc,
+                        TypeConverter *converter, Value value,
+                        std::optional<int64_t> channelAxis = std::nullopt) {
+  auto dequantize = value.getDefiningOp<AtenDequantizeSelfOp>();
+  if (!dequantize)
+    return failure();
+  Value quantized = dequantize.getSelf();
+  Type dtype = quantized.getType().cast<ValueTensorType>().getDtype();
+  if (!dtype.isa<QInt8Type, QUInt8Type>())
+    return failure();
+  QuantizedOperand operand;
+  Value zeroPoint;
+  if (succeeded(torch_to_linalg::getPerTensorQuantizationParams(
+          rewriter, loc, converter, quantized, operand.scale, zeroPoint))) {
+    operand.zeroPoint = rewriter.create<arith::TruncIOp>(
+        loc, rewriter.getI32Type(), zeroPoint);
+  } else {
+    int64_t axis;
+    auto create = quantized.getDefiningOp<PerChannelAffineCreateOp>();
+    if (!channelAxis || !create || !isZeroLiteral(create.getZeroPoints()) ||
+        failed(torch_to_linalg::getPerChannelQuantizationParams(
+            rewriter, loc, converter, quantized, operand.channelScales,
+            zeroPoint, axis)) ||
+        axis != *channelAxis)
+      return failure();
+    operand.zeroPoint = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getI32IntegerAttr(0));
+  }
+  operand.intRepr = rewriter.getRemappedValue(quantized);
+  if (!operand.intRepr)
+    return failure();
+  if (dtype.isa<QUInt8Type>()) {
+    Value c128 = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getI32IntegerAttr(128));
+    operand.zeroPoint =
+        rewriter.create<arith::SubIOp>(loc, operand.zeroPoint, c128);
+    Type i8Type = rewriter.getI8Type();
+    Value signBit = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getIntegerAttr(i8Type, -128));
+    operand.intRepr = torch_to_linalg::createElementwiseLinalgGeneric(
+        rewriter, loc, operand.intRepr, i8Type,
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          b.create<linalg::YieldOp>(
+              loc, b.create<arith::XOrIOp>(loc, args[0], signBit).getResult());
+        });
+  }
+  return operand;
+}
+
+// Returns the scale of the quantized contraction of `lhs` and `rhs`, as
+// `elementType`, which excludes the per-channel scales of `rhs`, if any.
+static Value getQuantizedContractionScale(OpBuilder &b, Location loc,
+                                          const QuantizedOperand &lhs,
+                                          const QuantizedOperand &rhs,
+                                          Type elementType) {
+  Value scale = lhs.scale;
+  if (rhs.scale)
+    scale = b.create<arith::MulFOp>(loc, scale, rhs.scale);
+  return convertScalarToDtype(b, loc, scale, elementType);
+}
+
+// Returns a zero-filled i32 accumulator of the sizes `sizes`.
+static Value createQuantizedAccumulator(OpBuilder &b, Location loc,
+                                        ArrayRef<Value> sizes) {
+  Type accType = b.getI32Type();
+  Value empty =
+      b.create<tensor::EmptyOp>(loc, getAsOpFoldResult(sizes), accType);
+  Value zero = b.create<arith::ConstantOp>(loc, b.getI32IntegerAttr(0));
+  return b.create<linalg::FillOp>(loc, zero, empty).getResult(0);
+}
+
+// Dequantizes the i32 accumulator `acc` of a quantized contraction as
+// `acc * scale * channelScales + bias`, into a tensor of `elementType` whose
+// dimension `i` is dimension `permutation[i]` of `acc`. The per-channel scales
+// and the bias, if any, are broadcast along every dimension of the result but
+// `channelDim`.
+static Value createQuantizedContractionEpilogue(
+    OpBuilder &b, Location loc, Value acc, ArrayRef<int64_t> permutation,
+    Value scale, Value channelScales, Value bias, int64_t channelDim,
+    Type elementType) {
+  int64_t rank = permutation.size();
+  SmallVector<AffineExpr> accExprs(rank);
+  SmallVector<Value> sizes;
+  for (int64_t i = 0; i < rank; i++) {
+    accExprs[permutation[i]] = b.getAffineDimExpr(i);
+    sizes.push_back(getDimOp(b, loc, acc, permutation[i]));
+  }
+  Value empty =
+      b.create<tensor::EmptyOp>(loc, getAsOpFoldResult(sizes), elementType);
+  SmallVector<Value> inputs{acc};
+  SmallVector<AffineMap> indexingMaps{
+      AffineMap::get(rank, /*symbolCount=*/0, accExprs, b.getContext())};
+  AffineMap channelMap = AffineMap::get(
+      rank, /*symbolCount=*/0, b.getAffineDimExpr(channelDim), b.getContext());
+  bool hasBias = !bias.getType().isa<Torch::NoneType>();
+  if (hasBias) {
+    inputs.push_back(bias);
+    indexingMaps.push_back(channelMap);
+  }
+  if (channelScales) {
+    inputs.push_back(channelScales);
+    indexingMaps.push_back(channelMap);
+  }
+  indexingMaps.push_back(b.getMultiDimIdentityMap(rank));
+  SmallVector<utils::IteratorType> iteratorTypes(rank,
+                                                 utils::IteratorType::parallel);
+  return b
+      .create<linalg::GenericOp>(
+          loc, empty.getType(), inputs, empty, indexingMaps, iteratorTypes,
+          [&](OpBuilder &b, Location loc, ValueRange args) {
+            Value result = b.create<arith::MulFOp>(
+                loc, b.create<arith::SIToFPOp>(loc, elementType, args[0]),
+                scale);
+            if (channelScales)
+              result = b.create<arith::MulFOp>(
+                  loc, result,
+                  convertScalarToDtype(b, loc, args[hasBias ? 2 : 1],
+                                       elementType));
+            if (hasBias)
+              result = b.create<arith::AddFOp>(loc, result, args[1]);
+            b.create<linalg::YieldOp>(loc, result);
+          })
+      .getResult(0);
+}
+
+// Checks that `bias` is None or a rank 1 tensor of `elementType`.
+static bool isValidQuantizedContractionBias(Value bias, Type elementType) {
+  if (bias.getType().isa<Torch::NoneType>())
+    return true;
+  auto biasType = bias.getType().cast<RankedTensorType>();
+  return biasType.getRank() == 1 && biasType.getElementType() == elementType;
+}
+
+namespace {
+// Lowers `aten.linear` of dequantized 8-bit operands, as found in the
+// dequantize -> linear -> quantize patterns of quantized models, to a
+// `linalg.quantized_matmul` of their integer representations, accumulating in
+// i32. The accumulator is then dequantized and the bias added in a single
+// elementwise epilogue. The weight can also be quantized per output channel.
+// The leading dims of the input are collapsed into the rows of the matmul.
+class ConvertQuantizedAtenLinearOp : public OpConversionPattern<AtenLinearOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenLinearOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Location loc = op->getLoc();
+    auto resultType = getTypeConverter()
+                          ->convertType(op.getType())
+                          .cast<RankedTensorType>();
+    Type elementType = resultType.getElementType();
+    Value bias = adaptor.getBias();
+    if (!elementType.isa<mlir::FloatType>() ||
+        !isValidQuantizedContractionBias(bias, elementType))
+      return rewriter.notifyMatchFailure(
+          op, "expected a floating point result and bias");
+    FailureOr<QuantizedOperand> input = matchDequantizedOperand(
+        rewriter, loc, getTypeConverter(), op.getInput());
+    FailureOr<QuantizedOperand> weight = matchDequantizedOperand(
+        rewriter, loc, getTypeConverter(), op.getWeight(), /*channelAxis=*/0);
+    if (failed(input) || failed(weight))
+      return rewriter.notifyMatchFailure(
+          op, "expected dequantized per-tensor quantized operands");
+
+    auto inputType = input->intRepr.getType().cast<RankedTensorType>();
+    auto weightType = weight->intRepr.getType().cast<RankedTensorType>();
+    int64_t inputRank = inputType.getRank();
+    if (inputRank < 2 || weightType.getRank() != 2)
+      return rewriter.notifyMatchFailure(
+          op, "expected an input of rank at least 2 and a weight of rank 2");
+    // Each reassociation group of tensor.expand_shape can have at most one
+    // dynamic dim.
+    if (llvm::count(inputType.getShape().drop_back(), ShapedType::kDynamic) >
+        1)
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: more than one dynamic leading input dim");
+
+    SmallVector<ReassociationIndices> reassociation(2);
+    for (int64_t i = 0; i < inputRank - 1; i++)
+      reassociation[0].push_back(i);
+    reassociation[1].push_back(inputRank - 1);
+    Value matmulInput = input->intRepr;
+    if (inputRank > 2)
+      matmulInput = rewriter.create<tensor::CollapseShapeOp>(loc, matmulInput,
+                                                             reassociation);
+    checkDimEqualHelper(rewriter, loc, getDimOp(rewriter, loc, matmulInput, 1),
+                        getDimOp(rewriter, loc, weight->intRepr, 1));
+    Value acc = createQuantizedAccumulator(
+        rewriter, loc,
+        {getDimOp(rewriter, loc, matmulInput, 0),
+         getDimOp(rewriter, loc, weight->intRepr, 0)});
+    acc = rewriter
+              .create<linalg::QuantizedMatmulOp>(
+                  loc, acc.getType(),
+                  ValueRange{matmulInput,
+                             permuteTensor(rewriter, loc, weight->intRepr,
+                                           {1, 0}),
+                             input->zeroPoint, weight->zeroPoint},
+                  acc)
+              .getResult(0);
+
+    Value scale = getQuantizedContractionScale(rewriter, loc, *input, *weight,
+                                               elementType);
+    Value result = createQuantizedContractionEpilogue(
+        rewriter, loc, acc, {0, 1}, scale, weight->channelScales, bias,
+        /*channelDim=*/1, elementType);
+    if (inputRank > 2) {
+      SmallVector<int64_t> expandedShape(inputType.getShape().drop_back());
+      expandedShape.push_back(weightType.getDimSize(0));
+      result = rewriter.create<tensor::ExpandShapeOp>(
+          loc, RankedTensorType::get(expandedShape, elementType), result,
+          reassociation);
+    }
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, result);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Lowers a 2D `aten.convolution` of dequantized 8-bit operands to a
+// `linalg.conv_2d_nhwc_hwcf_q` of their integer representations, accumulating
+// in i32, like `ConvertQuantizedAtenLinearOp`. The input is padded with its
+// zero point, which dequantizes to zero, and the epilogue reads the NHWC
+// accumulator to write the NCHW result.
+class ConvertQuantizedAtenConvolutionOp
+    : public OpConversionPattern<AtenConvolutionOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenConvolutionOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Location loc = op->getLoc();
+    auto resultType = getTypeConverter()
+                          ->convertType(op.getType())
+                          .cast<RankedTensorType>();
+    Type elementType = resultType.getElementType();
+    Value bias = adaptor.getBias();
+    if (!elementType.isa<mlir::FloatType>() ||
+        !isValidQuantizedContractionBias(bias, elementType))
+      return rewriter.notifyMatchFailure(
+          op, "expected a floating point result and bias");
+
+    bool transposed;
+    int64_t groups;
+    SmallVector<int64_t> strideInts, paddingInts, dilationInts;
+    if (!matchPattern(op.getTransposed(), m_TorchConstantBool(&transposed)) ||
+        transposed ||
+        !matchPattern(op.getGroups(), m_TorchConstantInt(&groups)) ||
+        groups != 1)
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: only non-transposed ungrouped convolutions");
+    if (!matchPattern(op.getStride(), m_TorchListOfConstantInts(strideInts)) ||
+        !matchPattern(op.getPadding(),
+                      m_TorchListOfConstantInts(paddingInts)) ||
+        !matchPattern(op.getDilation(),
+                      m_TorchListOfConstantInts(dilationInts)) ||
+        strideInts.size() != 2 || paddingInts.size() != 2 ||
+        dilationInts.size() != 2)
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: only 2D convolutions with constant int "
+              "strides, padding and dilations");
+    FailureOr<QuantizedOperand> input = matchDequantizedOperand(
+        rewriter, loc, getTypeConverter(), op.getInput());
+    FailureOr<QuantizedOperand> weight = matchDequantizedOperand(
+        rewriter, loc, getTypeConverter(), op.getWeight(), /*channelAxis=*/0);
+    if (failed(input) || failed(weight))
+      return rewriter.notifyMatchFailure(
+          op, "expected dequantized per-tensor quantized operands");
+    if (input->intRepr.getType().cast<RankedTensorType>().getRank() != 4)
+      return rewriter.notifyMatchFailure(op, "expected a rank 4 input");
+
+    checkDimEqualHelper(rewriter, loc,
+                        getDimOp(rewriter, loc, input->intRepr, 1),
+                        getDimOp(rewriter, loc, weight->intRepr, 1));
+    SmallVector<int64_t> padding{0, 0, paddingInts[0], paddingInts[1]};
+    Value padValue = rewriter.create<arith::TruncIOp>(
+        loc, rewriter.getI8Type(), input->zeroPoint);
+    Value paddedInput = torch_to_linalg::getPaddedTensor(
+        op, rewriter, input->intRepr, padding, padding, padValue);
+
+    SmallVector<Value> accSizes{getDimOp(rewriter, loc, paddedInput, 0)};
+    for (int64_t i = 0; i < 2; i++) {
+      Value kernelSize = castIndexToInt64(
+          rewriter, loc, getDimOp(rewriter, loc, weight->intRepr, i + 2));
+      // The input is already padded.
+      accSizes.push_back(torch_to_linalg::getOutputDimForConvOps(
+          rewriter, loc, getDimOp(rewriter, loc, paddedInput, i + 2),
+          getConstant(rewriter, loc, 0, rewriter.getI64Type()),
+          getConstant(rewriter, loc, dilationInts[i], rewriter.getI64Type()),
+          kernelSize,
+          getConstant(rewriter, loc, strideInts[i], rewriter.getI64Type())));
+    }
+    accSizes.push_back(getDimOp(rewriter, loc, weight->intRepr, 0));
+    Value acc = createQuantizedAccumulator(rewriter, loc, accSizes);
+    acc = rewriter
+              .create<linalg::Conv2DNhwcHwcfQOp>(
+                  loc, acc.getType(),
+                  ValueRange{
+                      permuteTensor(rewriter, loc, paddedInput, {0, 2, 3, 1}),
+                      permuteTensor(rewriter, loc, weight->intRepr,
+                                    {2, 3, 1, 0}),
+                      input->zeroPoint, weight->zeroPoint},
+                  acc, rewriter.getI64VectorAttr(strideInts),
+                  rewriter.getI64VectorAttr(dilationInts))
+              .getResult(0);
+
+    Value scale = getQuantizedContractionScale(rewriter, loc, *input, *weight,
+                                               elementType);
+    Value result = createQuantizedContractionEpilogue(
+        rewriter, loc, acc, {0, 3, 1, 2}, scale, weight->channelScales, bias,
+        /*channelDim=*/1, elementType);
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, result);
+    return success();
+  }
+};
+} // namespace
+
 void mlir::torch::torch_to_linalg::populateLinearPatternsAndLegality(
     TypeConverter &typeConverter, RewritePatternSet &patterns,
-    ConversionTarget &target) {
+    ConversionTarget &target,
+    const torch_to_linalg::LinearLoweringOptions &options) {
   MLIRContext *context = patterns.getContext();
   target.addIllegalOp<AtenMmOp>();
-  patterns.add<ConvertAtenMmOp>(typeConverter, context);
+  patterns.add<ConvertAtenMmOp>(typeConverter, context, options);
   target.addIllegalOp<AtenFlipOp>();
   patterns.add<ConvertAtenFlipOp>(typeConverter, context);
   target.addIllegalOp<AtenMatmulOp>();
-  patterns.add<ConvertAtenMatmulOp>(typeConverter, context);
+  patterns.add<ConvertAtenMatmulOp>(typeConverter, context, options);
   target.addIllegalOp<AtenBmmOp>();
-  patterns.add<ConvertAtenBmmOp>(typeConverter, context);
+  patterns.add<ConvertAtenBmmOp>(typeConverter, context, options);
+  target.addIllegalOp<AtenLinearOp>();
+  patterns.add<ConvertAtenLinearOp>(typeConverter, context, options);
+  patterns.add<ConvertQuantizedAtenLinearOp>(typeConverter, context,
+                                             /*benefit=*/2);
+  target.addIllegalOp<GroupQuantizedLinearOp>();
+  patterns.add<ConvertGroupQuantizedLinearOp>(typeConverter, context, options);
+  target.addIllegalOp<SemiStructuredSparseLinearOp>();
+  patterns.add<ConvertSemiStructuredSparseLinearOp>(typeConverter, context,
+                                                    options);
   target.addIllegalOp<AtenConvolutionOp>();
-  patterns.add<ConvertAtenConvolutionOp>(typeConverter, context);
+  patterns.add<ConvertAtenConvolutionOp>(typeConverter, context, options);
+  patterns.add<ConvertQuantizedAtenConvolutionOp>(typeConverter, context,
+                                                  /*benefit=*/2);
 }
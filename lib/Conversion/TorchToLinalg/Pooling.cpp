@@ -72,32 +72,40 @@ checkAndGetPoolingParameters(OpTy op, ConversionPatternRewriter &rewriter,
   return success();
 }
 
-// Creates a pooling operation based on the type specified by `OpTy` and
-// arguments passed.
-template <typename OpTy>
-static LogicalResult createPoolingOp(
+// Creates the operands of a 2D pooling op: the padded input, the window
+// tensor of the size of the kernel and the output tensor, initialized with
+// `initValueAttr`. The input is only padded if the padding or `ceilMode`
+// requires it.
+static LogicalResult createPoolingOperands(
     Operation *op, ConversionPatternRewriter &rewriter, Value self,
     bool supportNonFPInput, bool ceilMode,
     SmallVectorImpl<Value> &kernelSizeIntValues,
     SmallVectorImpl<int64_t> &strideInts, SmallVectorImpl<int64_t> &paddingInts,
     SmallVectorImpl<int64_t> &dilationInts, Attribute initValueAttr,
-    SmallVectorImpl<Value> &outTensorShape, Value &paddedInput, Value &result) {
+    SmallVectorImpl<Value> &outTensorShape, Value &paddedInput,
+    Value &windowTensor, Value &outTensorInitialized) {
   Location loc = op->getLoc();
   Type elementType = self.getType().cast<RankedTensorType>().getElementType();
   if (!elementType.isa<mlir::FloatType>() && !supportNonFPInput)
     return op->emitError("unimplemented: non-floating point type");
 
+  // In ceil mode, the last window may start at most `stride - 1` elements
+  // past the last window of the floor mode, so the input is padded by that
+  // much more at the high end.
   SmallVector<int64_t, 4> lowPaddingIncludingNC = {0, 0};
   lowPaddingIncludingNC.append(paddingInts);
   SmallVector<int64_t, 4> highPaddingIncludingNC = lowPaddingIncludingNC;
   if (ceilMode) {
-    highPaddingIncludingNC[2] += strideInts[0];
-    highPaddingIncludingNC[3] += strideInts[1];
+    highPaddingIncludingNC[2] += strideInts[0] - 1;
+    highPaddingIncludingNC[3] += strideInts[1] - 1;
   }
   Value initValue = rewriter.create<arith::ConstantOp>(loc, cast<TypedAttr>(initValueAttr));
-  paddedInput = torch_to_linalg::getPaddedTensor(
-      op, rewriter, self, lowPaddingIncludingNC, highPaddingIncludingNC,
-      initValue);
+  if (llvm::all_of(highPaddingIncludingNC, [](int64_t p) { return p == 0; }))
+    paddedInput = self;
+  else
+    paddedInput = torch_to_linalg::getPaddedTensor(
+        op, rewriter, self, lowPaddingIncludingNC, highPaddingIncludingNC,
+        initValue);
 
   Value N = getDimOp(rewriter, loc, self, 0);
   Value C = getDimOp(rewriter, loc, self, 1);
@@ -120,17 +128,36 @@ static LogicalResult createPoolingOp(
 
   // Create output tensor initialized with smallest floating point value.
   outTensorShape.insert(outTensorShape.begin(), {N, C, hOut, wOut});
-  Value outTensorInitialized =
+  outTensorInitialized =
       createInitTensor(rewriter, loc, outTensorShape, elementType, initValue);
 
-  auto stridesAttr = rewriter.getI64VectorAttr(strideInts);
-  auto dilationAttr = rewriter.getI64VectorAttr(dilationInts);
   auto shape = castIntVectorToIndexVector(rewriter, loc, kernelSizeIntValues);
-  Value windowTensor = rewriter.create<tensor::EmptyOp>(
+  windowTensor = rewriter.create<tensor::EmptyOp>(
       loc, getAsOpFoldResult(shape), elementType);
+  return success();
+}
 
+// Creates a pooling operation based on the type specified by `OpTy` and
+// arguments passed.
+template <typename OpTy>
+static LogicalResult createPoolingOp(
+    Operation *op, ConversionPatternRewriter &rewriter, Value self,
+    bool supportNonFPInput, bool ceilMode,
+    SmallVectorImpl<Value> &kernelSizeIntValues,
+    SmallVectorImpl<int64_t> &strideInts, SmallVectorImpl<int64_t> &paddingInts,
+    SmallVectorImpl<int64_t> &dilationInts, Attribute initValueAttr,
+    SmallVectorImpl<Value> &outTensorShape, Value &paddedInput, Value &result) {
+  Value windowTensor, outTensorInitialized;
+  if (failed(createPoolingOperands(
+          op, rewriter, self, supportNonFPInput, ceilMode, kernelSizeIntValues,
+          strideInts, paddingInts, dilationInts, initValueAttr, outTensorShape,
+          paddedInput, windowTensor, outTensorInitialized)))
+    return failure();
+
+  auto stridesAttr = rewriter.getI64VectorAttr(strideInts);
+  auto dilationAttr = rewriter.getI64VectorAttr(dilationInts);
   result = rewriter
-               .create<OpTy>(loc, outTensorInitialized.getType(),
+               .create<OpTy>(op->getLoc(), outTensorInitialized.getType(),
                              ValueRange{paddedInput, windowTensor},
                              outTensorInitialized, stridesAttr, dilationAttr)
                .getResult(0);
@@ -404,6 +431,67 @@ public:
           op, "unimplemented: count_include_pad is expected to be true");
     }
 
+    Value kHtimeskW = rewriter.create<arith::MulIOp>(
+        loc, kernelSizeIntValues[0], kernelSizeIntValues[1]);
+    Value divisor = op.getDivisorOverride().getType().isa<Torch::NoneType>()
+                        ? kHtimeskW
+                        : adaptor.getDivisorOverride();
+    divisor = convertScalarToDtype(rewriter, loc, divisor, resultElementType);
+
+    // For floating point results, the division is folded into the pooling:
+    // each element of the window is scaled by the inverse of the divisor as it
+    // is accumulated, so that the input is read once and no second pass over
+    // the result is needed.
+    if (resultElementType.isa<mlir::FloatType>() &&
+        inputElementType == resultElementType) {
+      Value paddedInput, windowTensor, outTensorInitialized;
+      SmallVector<Value, 4> outTensorShape;
+      if (failed(createPoolingOperands(
+              op, rewriter, self, /*supportNonFPInput=*/false, ceilMode,
+              kernelSizeIntValues, strideInts, paddingInts, dilationInts,
+              rewriter.getZeroAttr(inputElementType), outTensorShape,
+              paddedInput, windowTensor, outTensorInitialized)))
+        return rewriter.notifyMatchFailure(op, "unable to compute avgpool2d");
+      Value one = rewriter.create<arith::ConstantOp>(
+          loc, rewriter.getFloatAttr(resultElementType, 1.0));
+      Value scale = rewriter.create<arith::DivFOp>(loc, one, divisor);
+
+      // The six dimensions are N, C, Hout, Wout, kH and kW.
+      AffineExpr hIn = rewriter.getAffineDimExpr(2) * strideInts[0] +
+                       rewriter.getAffineDimExpr(4) * dilationInts[0];
+      AffineExpr wIn = rewriter.getAffineDimExpr(3) * strideInts[1] +
+                       rewriter.getAffineDimExpr(5) * dilationInts[1];
+      SmallVector<AffineExpr> inputExprs = {rewriter.getAffineDimExpr(0),
+                                            rewriter.getAffineDimExpr(1), hIn,
+                                            wIn};
+      SmallVector<AffineExpr> kernelExprs = {rewriter.getAffineDimExpr(4),
+                                             rewriter.getAffineDimExpr(5)};
+      SmallVector<AffineExpr> outputExprs;
+      for (unsigned i = 0; i < 4; i++)
+        outputExprs.push_back(rewriter.getAffineDimExpr(i));
+      SmallVector<AffineMap> indexingMaps =
+          AffineMap::inferFromExprList({inputExprs, kernelExprs, outputExprs});
+      SmallVector<utils::IteratorType> iteratorTypes(
+          4, utils::IteratorType::parallel);
+      iteratorTypes.append(2, utils::IteratorType::reduction);
+      Value avgPool2d =
+          rewriter
+              .create<linalg::GenericOp>(
+                  loc, outTensorInitialized.getType(),
+                  ValueRange{paddedInput, windowTensor}, outTensorInitialized,
+                  indexingMaps, iteratorTypes,
+                  [&](OpBuilder &b, Location loc, ValueRange args) {
+                    Value scaled = b.create<arith::MulFOp>(loc, args[0], scale);
+                    b.create<linalg::YieldOp>(
+                        loc,
+                        b.create<arith::AddFOp>(loc, args[2], scaled)
+                            .getResult());
+                  })
+              .getResult(0);
+      rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, avgPool2d);
+      return success();
+    }
+
     // `sumPool2d` contains the result of sumpool2d operation over the input.
     Value sumPool2d, paddedInput;
     SmallVector<Value, 4> outTensorShape;
@@ -414,13 +502,6 @@ public:
             sumPool2d)))
       return rewriter.notifyMatchFailure(op, "unable to compute sumpool2d");
 
-    Value kHtimeskW = rewriter.create<arith::MulIOp>(
-        loc, kernelSizeIntValues[0], kernelSizeIntValues[1]);
-    Value divisor = op.getDivisorOverride().getType().isa<Torch::NoneType>()
-                        ? kHtimeskW
-                        : adaptor.getDivisorOverride();
-    divisor = convertScalarToDtype(rewriter, loc, divisor, resultElementType);
-
     Value outputTensor = rewriter.create<tensor::EmptyOp>(
         loc, getAsOpFoldResult(outTensorShape), resultElementType);
     SmallVector<AffineMap> indexingMapsAvg(2,
@@ -450,6 +531,212 @@ public:
 };
 } // namespace
 
+namespace {
+// Lowers `aten.adaptive_avg_pool2d` and `aten.adaptive_max_pool2d` to a single
+// `linalg.generic` for any output size. Element `i` of a pooled dim with
+// input size `in` and output size `out` pools the input elements
+//
+//   [start(i), end(i)) = [floor(i * in / out), ceil((i + 1) * in / out))
+//
+// whose number is `in / out` if `out` divides `in`, and at most
+// `ceil(in / out) + 1` otherwise. The generic iterates over the output and a
+// window of that maximum size, computes the bounds of the pooled elements
+// from the output indices, and ignores the elements of the window past
+// `end(i)`. Unlike the decomposition into `aten.avg_pool2d`, this doesn't
+// require all the windows to be of the same size.
+template <typename OpTy>
+class ConvertAtenAdaptivePool2dOp : public OpConversionPattern<OpTy> {
+public:
+  using OpConversionPattern<OpTy>::OpConversionPattern;
+  using OpAdaptor = typename OpTy::Adaptor;
+  static constexpr bool isMaxPool =
+      std::is_same_v<OpTy, AtenAdaptiveMaxPool2dOp>;
+
+  LogicalResult
+  matchAndRewrite(OpTy op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Location loc = op->getLoc();
+    TypeConverter *typeConverter = this->getTypeConverter();
+    Value self = adaptor.getSelf();
+    RankedTensorType selfType = self.getType().cast<RankedTensorType>();
+    Type elementType = selfType.getElementType();
+    if (!elementType.isa<mlir::FloatType>())
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: non-floating point type");
+    int64_t rank = selfType.getRank();
+    if (rank != 3 && rank != 4)
+      return rewriter.notifyMatchFailure(op, "expected a 3D or 4D input");
+
+    SmallVector<Value> outputSizeTorchInt;
+    if (!getListConstructElements(op.getOutputSize(), outputSizeTorchInt) ||
+        outputSizeTorchInt.size() != 2)
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: output_size must be a list of two ints");
+
+    // The input sizes, output sizes and maximum window sizes of the pooled
+    // dims. They fold to constants when they are static, so that the window
+    // is static too.
+    SmallVector<Value> inSizes, outSizes, windowSizes;
+    Value zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+    Value one = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+    for (unsigned i = 0; i < 2; i++) {
+      Value inSize = getDimOp(rewriter, loc, self, rank - 2 + i);
+      int64_t outSizeInt;
+      Value outSize =
+          matchPattern(outputSizeTorchInt[i], m_TorchConstantInt(&outSizeInt))
+              ? rewriter.create<arith::ConstantIndexOp>(loc, outSizeInt)
+              : castIntToIndex(
+                    rewriter, loc,
+                    typeConverter->materializeTargetConversion(
+                        rewriter, loc,
+                        typeConverter->convertType(
+                            outputSizeTorchInt[i].getType()),
+                        outputSizeTorchInt[i]));
+      Value windowSize =
+          rewriter.createOrFold<arith::CeilDivUIOp>(loc, inSize, outSize);
+      Value remainder =
+          rewriter.createOrFold<arith::RemUIOp>(loc, inSize, outSize);
+      Value isDivisible = rewriter.createOrFold<arith::CmpIOp>(
+          loc, arith::CmpIPredicate::eq, remainder, zero);
+      windowSize = rewriter.createOrFold<arith::AddIOp>(
+          loc, windowSize,
+          rewriter.createOrFold<arith::SelectOp>(loc, isDivisible, zero, one));
+      inSizes.push_back(inSize);
+      outSizes.push_back(outSize);
+      windowSizes.push_back(windowSize);
+    }
+
+    SmallVector<Value> outTensorShape;
+    for (int64_t dim = 0; dim < rank - 2; dim++)
+      outTensorShape.push_back(getDimOp(rewriter, loc, self, dim));
+    outTensorShape.append(outSizes);
+    Value windowTensor = rewriter.create<tensor::EmptyOp>(
+        loc, getAsOpFoldResult(windowSizes), elementType);
+
+    SmallVector<Value> outTensorsInitialized;
+    Value cstMinusOne;
+    if constexpr (isMaxPool) {
+      Value smallestFPValue = rewriter.create<arith::ConstantOp>(
+          loc, rewriter.getFloatAttr(
+                   elementType,
+                   APFloat::getInf(
+                       elementType.cast<mlir::FloatType>().getFloatSemantics(),
+                       /*Negative=*/true)));
+      outTensorsInitialized.push_back(createInitTensor(
+          rewriter, loc, outTensorShape, elementType, smallestFPValue));
+      cstMinusOne = rewriter.create<arith::ConstantOp>(
+          loc, rewriter.getI64IntegerAttr(-1));
+      outTensorsInitialized.push_back(createInitTensor(
+          rewriter, loc, outTensorShape, rewriter.getI64Type(), cstMinusOne));
+    } else {
+      outTensorsInitialized.push_back(
+          createZeroInitTensor(rewriter, loc, outTensorShape, elementType));
+    }
+
+    // The dimensions are those of the output, followed by kH and kW.
+    SmallVector<AffineExpr> outputExprs;
+    for (int64_t dim = 0; dim < rank; dim++)
+      outputExprs.push_back(rewriter.getAffineDimExpr(dim));
+    SmallVector<AffineExpr> kernelExprs = {rewriter.getAffineDimExpr(rank),
+                                           rewriter.getAffineDimExpr(rank + 1)};
+    SmallVector<ArrayRef<AffineExpr>> exprs = {kernelExprs};
+    exprs.append(outTensorsInitialized.size(), outputExprs);
+    SmallVector<AffineMap> indexingMaps = AffineMap::inferFromExprList(exprs);
+    SmallVector<utils::IteratorType> iteratorTypes(
+        rank, utils::IteratorType::parallel);
+    iteratorTypes.append(2, utils::IteratorType::reduction);
+
+    auto pool = rewriter.create<linalg::GenericOp>(
+        loc, ValueRange(outTensorsInitialized).getTypes(),
+        /*inputs=*/windowTensor, /*outputs=*/outTensorsInitialized,
+        indexingMaps, iteratorTypes,
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          SmallVector<Value> indices;
+          for (int64_t dim = 0; dim < rank - 2; dim++)
+            indices.push_back(b.create<linalg::IndexOp>(loc, dim));
+          // The index of the pooled element in each pooled dim, and the
+          // number of elements pooled along it.
+          Value inWindow, count;
+          for (unsigned i = 0; i < 2; i++) {
+            Value outIndex = b.create<linalg::IndexOp>(loc, rank - 2 + i);
+            Value kernelIndex = b.create<linalg::IndexOp>(loc, rank + i);
+            Value start = b.create<arith::DivUIOp>(
+                loc, b.create<arith::MulIOp>(loc, outIndex, inSizes[i]),
+                outSizes[i]);
+            Value end = b.create<arith::CeilDivUIOp>(
+                loc,
+                b.create<arith::MulIOp>(
+                    loc, b.create<arith::AddIOp>(loc, outIndex, one),
+                    inSizes[i]),
+                outSizes[i]);
+            Value index = b.create<arith::AddIOp>(loc, start, kernelIndex);
+            Value isInWindow = b.create<arith::CmpIOp>(
+                loc, arith::CmpIPredicate::ult, index, end);
+            // Read the start of the window in place of the elements past its
+            // end, which may be past the end of the input.
+            indices.push_back(
+                b.create<arith::SelectOp>(loc, isInWindow, index, start));
+            Value size = b.create<arith::SubIOp>(loc, end, start);
+            if (i == 0) {
+              inWindow = isInWindow;
+              count = size;
+            } else {
+              inWindow = b.create<arith::AndIOp>(loc, inWindow, isInWindow);
+              count = b.create<arith::MulIOp>(loc, count, size);
+            }
+          }
+          Value input = b.create<tensor::ExtractOp>(loc, self, indices);
+
+          if constexpr (isMaxPool) {
+            Value maxVal = args[1], maxIndex = args[2];
+            // Like PyTorch, take the first element of the window and then
+            // any greater element or NaN.
+            Value isGreater = b.create<arith::CmpFOp>(
+                loc, arith::CmpFPredicate::OGT, input, maxVal);
+            Value isNaN = b.create<arith::CmpFOp>(
+                loc, arith::CmpFPredicate::UNO, input, input);
+            Value isFirst = b.create<arith::CmpIOp>(
+                loc, arith::CmpIPredicate::eq, maxIndex, cstMinusOne);
+            Value pred = b.create<arith::OrIOp>(
+                loc, b.create<arith::OrIOp>(loc, isGreater, isNaN), isFirst);
+            pred = b.create<arith::AndIOp>(loc, pred, inWindow);
+            Value flatIndex = b.create<arith::AddIOp>(
+                loc,
+                b.create<arith::MulIOp>(loc, indices[rank - 2], inSizes[1]),
+                indices[rank - 1]);
+            b.create<linalg::YieldOp>(
+                loc, ValueRange{b.create<arith::SelectOp>(loc, pred, input,
+                                                          maxVal),
+                                b.create<arith::SelectOp>(
+                                    loc, pred,
+                                    castIndexToInt64(b, loc, flatIndex),
+                                    maxIndex)});
+          } else {
+            // As in `ConvertAtenAvgPool2dOp`, the division is folded into
+            // the accumulation.
+            Value countFP = b.create<arith::SIToFPOp>(
+                loc, elementType, castIndexToInt64(b, loc, count));
+            Value sum = b.create<arith::AddFOp>(
+                loc, args[1], b.create<arith::DivFOp>(loc, input, countFP));
+            b.create<linalg::YieldOp>(
+                loc, b.create<arith::SelectOp>(loc, inWindow, sum, args[1])
+                         .getResult());
+          }
+        });
+
+    SmallVector<Value> results;
+    for (auto [result, type] :
+         llvm::zip_equal(pool.getResults(), op->getResultTypes()))
+      results.push_back(rewriter.create<tensor::CastOp>(
+          loc, typeConverter->convertType(type), result));
+    rewriter.replaceOp(op, results);
+    return success();
+  }
+};
+} // namespace
+
 void mlir::torch::torch_to_linalg::populatePoolingPatternsAndLegality(
     TypeConverter &typeConverter, RewritePatternSet &patterns,
     ConversionTarget &target) {
@@ -460,4 +747,8 @@ void mlir::torch::torch_to_linalg::populatePoolingPatternsAndLegality(
   patterns.add<ConvertAtenMaxPool2dWithIndicesOp>(typeConverter, context);
   target.addIllegalOp<AtenAvgPool2dOp>();
   patterns.add<ConvertAtenAvgPool2dOp>(typeConverter, context);
+  target.addIllegalOp<AtenAdaptiveAvgPool2dOp, AtenAdaptiveMaxPool2dOp>();
+  patterns.add<ConvertAtenAdaptivePool2dOp<AtenAdaptiveAvgPool2dOp>,
+               ConvertAtenAdaptivePool2dOp<AtenAdaptiveMaxPool2dOp>>(
+      typeConverter, context);
 }
@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/DialectConversion.h"
 
 namespace mlir {
@@ -39,9 +40,26 @@ namespace torch_to_linalg {
 void populateTensorScalarInteropPatternsAndLegality(
     TypeConverter &typeConverter, RewritePatternSet &patterns,
     ConversionTarget &target);
+// How matmuls and convolutions are lowered. See the options of the
+// `convert-torch-to-linalg` pass.
+struct LinearLoweringOptions {
+  // Use the channels last (NWC, NHWC or NDHWC) named ops, with transposes of
+  // the input and the result.
+  bool nhwc = false;
+  // Use a matmul of the unfolded input windows for statically shaped
+  // convolutions.
+  bool im2col = false;
+  // Use Winograd F(2x2, 3x3) for the statically shaped 3x3 stride-1
+  // convolutions that are large enough to benefit from it.
+  bool winograd = false;
+  // Accumulate the matmuls and convolutions of bf16 and f16 tensors in f32,
+  // and truncate their results.
+  bool accumulateInF32 = false;
+};
 void populateLinearPatternsAndLegality(TypeConverter &typeConverter,
                                        RewritePatternSet &patterns,
-                                       ConversionTarget &target);
+                                       ConversionTarget &target,
+                                       const LinearLoweringOptions &options);
 void populatePoolingPatternsAndLegality(TypeConverter &typeConverter,
                                         RewritePatternSet &patterns,
                                         ConversionTarget &target);
@@ -51,12 +69,27 @@ void populateRandomPatternsAndLegality(TypeConverter &typeConverter,
 void populateUncategorizedPatternsAndLegality(TypeConverter &typeConverter,
                                               RewritePatternSet &patterns,
                                               ConversionTarget &target);
-void populateReductionPatternsAndLegality(TypeConverter &typeConverter,
-                                          RewritePatternSet &patterns,
-                                          ConversionTarget &target);
-void populateDataMovementPatternsAndLegality(TypeConverter &typeConverter,
-                                             RewritePatternSet &patterns,
-                                             ConversionTarget &target);
+// How reductions are lowered. See the options of the
+// `convert-torch-to-linalg` pass.
+struct ReductionLoweringOptions {
+  // Split the statically shaped full sums and maxes into this many parallel
+  // partial reductions followed by a reduction of the partial results. 0
+  // disables the split.
+  int64_t splitFactor = 0;
+};
+void populateReductionPatternsAndLegality(
+    TypeConverter &typeConverter, RewritePatternSet &patterns,
+    ConversionTarget &target, const ReductionLoweringOptions &options);
+// The statistics of the `convert-torch-to-linalg` pass that the data movement
+// patterns update. Null statistics are not updated.
+struct DataMovementStatistics {
+  // The views converted to a `tensor.reshape`, which can copy the input.
+  Pass::Statistic *numCopiedViews = nullptr;
+};
+
+void populateDataMovementPatternsAndLegality(
+    TypeConverter &typeConverter, RewritePatternSet &patterns,
+    ConversionTarget &target, const DataMovementStatistics &statistics);
 void populateIndirectDataMovementPatternsAndLegality(
     TypeConverter &typeConverter, RewritePatternSet &patterns,
     ConversionTarget &target);
@@ -113,6 +113,19 @@ static Value randomUniformUInt(OpBuilder &b, Location loc, Value ctr,
   return bitwiseXOr(t, shiftRight32(add(mul(x, x), y)));
 }
 
+// Derives the key of the Squares64 generator from the seed of the global RNG
+// with a step of the 2^64 LCG from
+// https://en.wikipedia.org/wiki/Linear_congruential_generator, so that small
+// seeds such as the default of 0 still give keys with well mixed bits.
+static Value squaresKeyFromSeed(OpBuilder &b, Location loc, Value seed) {
+  Value multiplier = b.create<arith::ConstantOp>(
+      loc, b.getI64IntegerAttr(6364136223846793005));
+  Value incrementStep = b.create<arith::ConstantOp>(
+      loc, b.getI64IntegerAttr(1442695040888963407));
+  Value mul = b.create<arith::MulIOp>(loc, seed, multiplier);
+  return b.create<arith::AddIOp>(loc, mul, incrementStep);
+}
+
 namespace {
 class ConvertAtenUniformOp : public OpConversionPattern<AtenUniformOp> {
 public:
@@ -137,8 +150,23 @@ public:
       return rewriter.notifyMatchFailure(
           op, "The generator has to be None because only global default "
               "generator is supported");
-    // Get key, min and max used by `linalg.generic` compute payload.
-    Value key = rewriter.create<TorchConversion::GetNextSeedOp>(loc);
+    SmallVector<Value> sizes = getTensorSizes(rewriter, loc, self);
+    SmallVector<Value> sizesIntValues =
+        castIndexVectorToInt64Vector(rewriter, loc, sizes);
+
+    // Reserve one counter per element in the stream of the global RNG. The
+    // value of each element only depends on the seed and its counter, which
+    // keeps the `linalg.generic` below parallel in all of its dimensions.
+    Value numel =
+        rewriter.create<arith::ConstantOp>(loc, rewriter.getI64IntegerAttr(1));
+    for (Value size : sizesIntValues)
+      numel = rewriter.create<arith::MulIOp>(loc, numel, size);
+    auto rngState =
+        rewriter.create<TorchConversion::GetNextRngOffsetOp>(loc, numel);
+    Value key = squaresKeyFromSeed(rewriter, loc, rngState.getSeed());
+    Value offset = rngState.getOffset();
+
+    // Get min and max used by `linalg.generic` compute payload.
     Value min = convertScalarToDtype(rewriter, loc, from, elemTy);
     Value max = convertScalarToDtype(rewriter, loc, to, elemTy);
 
@@ -148,9 +176,6 @@ public:
         1, rewriter.getMultiDimIdentityMap(resultRank));
     SmallVector<utils::IteratorType> iteratorTypes(
         resultRank, utils::IteratorType::parallel);
-    SmallVector<Value> sizes = getTensorSizes(rewriter, loc, self);
-    SmallVector<Value> sizesIntValues =
-        castIndexVectorToInt64Vector(rewriter, loc, sizes);
     Value initTensor =
         rewriter.create<tensor::EmptyOp>(loc, getAsOpFoldResult(sizes), elemTy);
     Value uniformRes =
@@ -167,7 +192,9 @@ public:
 
                   Value linearIndex =
                       toLinearIndex(b, loc, indicesIntValues, sizesIntValues);
-                  Value randomVal = randomUniformUInt(b, loc, linearIndex, key);
+                  Value counter =
+                      b.create<arith::AddIOp>(loc, offset, linearIndex);
+                  Value randomVal = randomUniformUInt(b, loc, counter, key);
 
                   // scale = (max - min) * const(F64,  5.4210108E-20)
                   // which is derived from rand(min,max) =
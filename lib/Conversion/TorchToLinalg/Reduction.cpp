@@ -108,11 +108,12 @@ public:
       } else if (keepDim)
         resultShape.push_back(c1);
     }
-    // First fill the output buffer for the index.
-    Value filledTensorIdx =
-        createZeroInitTensor(rewriter, loc, resultShape, idxElementType);
-
-    // Second fill the output buffer for the running max.
+    // The max and its index are computed by two reductions, each with a
+    // single result and a plain max or min combiner, rather than by a single
+    // reduction of (value, index) pairs, whose payload can't be vectorized.
+    // The first reduction computes the max. The second one computes the first
+    // index at which the input is equal to the max, or is NaN, which is then
+    // the max.
     Value initTensorMax = rewriter.create<tensor::EmptyOp>(
         loc, getAsOpFoldResult(resultShape), inElementType);
 
@@ -137,6 +138,17 @@ public:
         rewriter.create<linalg::FillOp>(loc, fillValueMax, initTensorMax)
             .result();
 
+    Value initTensorIdx = rewriter.create<tensor::EmptyOp>(
+        loc, getAsOpFoldResult(resultShape), idxElementType);
+    Value fillValueIdx = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getIntegerAttr(
+                 idxElementType,
+                 APSInt::getSignedMaxValue(
+                     idxElementType.cast<mlir::IntegerType>().getWidth())));
+    Value filledTensorIdx =
+        rewriter.create<linalg::FillOp>(loc, fillValueIdx, initTensorIdx)
+            .result();
+
     // Create the affine expressions that will be used to
     // iterate over the input and output tensors.
     // Here we also set the type of iterator: parallel or reduction.
@@ -158,45 +170,63 @@ public:
         resultExprs.push_back(rewriter.getAffineDimExpr(size.index()));
       }
     }
-    auto maps = AffineMap::inferFromExprList({exprs, resultExprs, resultExprs});
-    auto linalgOp = rewriter.create<linalg::GenericOp>(
-        loc,
-        ArrayRef<Type>({filledTensorMax.getType(), filledTensorIdx.getType()}),
-        input, ValueRange({filledTensorMax, filledTensorIdx}), maps,
-        iteratorTypes,
-        [&](OpBuilder &nestedBuilder, Location nestedLoc,
-            ValueRange blockArgs) {
-          Value newValue = blockArgs[0];
-          Value oldValue = blockArgs[1];
-          Value oldIndex = blockArgs[2];
-
-          Value newIndex = rewriter.create<arith::IndexCastOp>(
-              nestedLoc, oldIndex.getType(),
-              rewriter.create<linalg::IndexOp>(loc, dim));
-
-          Value resultMax, predicate;
-          if (inElementType.isa<mlir::FloatType>()) {
-            resultMax =
-                rewriter.create<arith::MaxFOp>(nestedLoc, newValue, oldValue);
-            predicate = rewriter.create<arith::CmpFOp>(
-                nestedLoc, arith::CmpFPredicate::OGT, newValue, oldValue);
-          } else {
-            resultMax =
-                rewriter.create<arith::MaxSIOp>(nestedLoc, newValue, oldValue);
-            predicate = rewriter.create<arith::CmpIOp>(
-                nestedLoc, arith::CmpIPredicate::sgt, newValue, oldValue);
-          }
-          auto resultIndex = rewriter.create<arith::SelectOp>(
-              nestedLoc, predicate, newIndex, oldIndex);
-          nestedBuilder.create<linalg::YieldOp>(
-              nestedLoc, ValueRange({resultMax, resultIndex}));
-        });
+    auto maxMaps = AffineMap::inferFromExprList({exprs, resultExprs});
+    Value maxValues =
+        rewriter
+            .create<linalg::GenericOp>(
+                loc, filledTensorMax.getType(), input, filledTensorMax,
+                maxMaps, iteratorTypes,
+                [&](OpBuilder &b, Location loc, ValueRange blockArgs) {
+                  Value resultMax;
+                  if (inElementType.isa<mlir::FloatType>())
+                    resultMax = b.create<arith::MaxFOp>(loc, blockArgs[0],
+                                                        blockArgs[1]);
+                  else
+                    resultMax = b.create<arith::MaxSIOp>(loc, blockArgs[0],
+                                                         blockArgs[1]);
+                  b.create<linalg::YieldOp>(loc, resultMax);
+                })
+            .getResult(0);
+
+    auto idxMaps =
+        AffineMap::inferFromExprList({exprs, resultExprs, resultExprs});
+    Value maxIndices =
+        rewriter
+            .create<linalg::GenericOp>(
+                loc, filledTensorIdx.getType(), ValueRange{input, maxValues},
+                filledTensorIdx, idxMaps, iteratorTypes,
+                [&](OpBuilder &b, Location loc, ValueRange blockArgs) {
+                  Value value = blockArgs[0];
+                  Value maxValue = blockArgs[1];
+                  Value oldIndex = blockArgs[2];
+                  Value isMax;
+                  if (inElementType.isa<mlir::FloatType>()) {
+                    isMax = b.create<arith::OrIOp>(
+                        loc,
+                        b.create<arith::CmpFOp>(loc, arith::CmpFPredicate::OEQ,
+                                                value, maxValue),
+                        b.create<arith::CmpFOp>(loc, arith::CmpFPredicate::UNO,
+                                                value, value));
+                  } else {
+                    isMax = b.create<arith::CmpIOp>(
+                        loc, arith::CmpIPredicate::eq, value, maxValue);
+                  }
+                  Value index = b.create<arith::IndexCastOp>(
+                      loc, oldIndex.getType(),
+                      b.create<linalg::IndexOp>(loc, dim));
+                  Value candidate = b.create<arith::SelectOp>(
+                      loc, isMax, index, fillValueIdx);
+                  b.create<linalg::YieldOp>(
+                      loc, b.create<arith::MinSIOp>(loc, candidate, oldIndex)
+                               .getResult());
+                })
+            .getResult(0);
 
     // This cast is required to fix the shape in the case of keepDim=True
-    Value maxValuesCast = rewriter.create<tensor::CastOp>(
-        loc, valResultType, linalgOp.getResult(0));
-    Value maxIdxCast = rewriter.create<tensor::CastOp>(loc, idxResultType,
-                                                       linalgOp.getResult(1));
+    Value maxValuesCast =
+        rewriter.create<tensor::CastOp>(loc, valResultType, maxValues);
+    Value maxIdxCast =
+        rewriter.create<tensor::CastOp>(loc, idxResultType, maxIndices);
     rewriter.replaceOp(maxDimOp, {maxValuesCast, maxIdxCast});
     return success();
   }
@@ -436,11 +466,66 @@ private:
     };
 
     Value initElem = createInitElementForReduceOp(rewriter, loc, op, elemType);
+    if (Value splitReduceOp =
+            createSplitReductionOp(loc, op, opInfo, initElem,
+                                   reductionBodyBuilder, rewriter))
+      return err ? Value{} : splitReduceOp;
     Value reduceOp = torch_to_linalg::createReductionLinalgGeneric(
         rewriter, loc, opInfo, initElem, reductionBodyBuilder);
     return err ? Value{} : reduceOp;
   }
 
+  /// Generate the reduction of all the elements of a statically shaped input
+  /// as `options.splitFactor` partial reductions of contiguous chunks of the
+  /// input, which are parallel, followed by the reduction of the partial
+  /// results. Returns a null value if the reduction isn't split. Only the sums
+  /// and maxes are split, since their payload also combines partial results.
+  Value createSplitReductionOp(
+      Location loc, Operation *op,
+      const torch_to_linalg::ReductionOpInfo &opInfo, Value initElem,
+      function_ref<void(OpBuilder &, Location, ValueRange)> bodyBuild,
+      ConversionPatternRewriter &rewriter) const {
+    int64_t splitFactor = options.splitFactor;
+    if (splitFactor < 2 || !isa<AtenSumOp, AtenSumDimIntListOp, AtenMaxOp>(op))
+      return Value{};
+    auto inputType = opInfo.tensorOperand.getType().cast<RankedTensorType>();
+    int64_t rank = inputType.getRank();
+    if (!inputType.hasStaticShape() ||
+        static_cast<int64_t>(opInfo.dimSet.size()) != rank)
+      return Value{};
+    int64_t numElements = inputType.getNumElements();
+    if (numElements <= splitFactor || numElements % splitFactor != 0)
+      return Value{};
+
+    // View the input as [splitFactor, numElements / splitFactor].
+    Type inputElemType = inputType.getElementType();
+    ReassociationIndices allDims =
+        llvm::to_vector(llvm::seq<int64_t>(0, rank));
+    Value flatInput = rewriter.create<tensor::CollapseShapeOp>(
+        loc, RankedTensorType::get({numElements}, inputElemType),
+        opInfo.tensorOperand, ArrayRef<ReassociationIndices>{allDims});
+    Value chunks = rewriter.create<tensor::ExpandShapeOp>(
+        loc,
+        RankedTensorType::get({splitFactor, numElements / splitFactor},
+                              inputElemType),
+        flatInput, ArrayRef<ReassociationIndices>{{0, 1}});
+
+    torch_to_linalg::ReductionOpInfo partialInfo{/*keepDim=*/false, chunks,
+                                                 {1}};
+    Value partials = torch_to_linalg::createReductionLinalgGeneric(
+        rewriter, loc, partialInfo, initElem, bodyBuild);
+    torch_to_linalg::ReductionOpInfo finalInfo{/*keepDim=*/false, partials,
+                                               {0}};
+    Value result = torch_to_linalg::createReductionLinalgGeneric(
+        rewriter, loc, finalInfo, initElem, bodyBuild);
+    if (!opInfo.keepDim)
+      return result;
+    SmallVector<int64_t> unitShape(rank, 1);
+    return rewriter.create<tensor::ExpandShapeOp>(
+        loc, RankedTensorType::get(unitShape, initElem.getType()), result,
+        ArrayRef<ReassociationIndices>{});
+  }
+
   /// Depending on the operation, check validity of the result's element type.
   LogicalResult
   validateReductionElementType(Operation *op, Type elemType,
@@ -454,9 +539,11 @@ private:
   }
 
 public:
-  ConvertReductionOp(TypeConverter &typeConverter, MLIRContext *context)
-      : ConversionPattern(typeConverter, MatchAnyOpTypeTag(), /*benefit=*/1,
-                          context) {}
+  ConvertReductionOp(StringRef rootName, TypeConverter &typeConverter,
+                     MLIRContext *context,
+                     const torch_to_linalg::ReductionLoweringOptions &options)
+      : ConversionPattern(typeConverter, rootName, /*benefit=*/1, context),
+        options(options) {}
   LogicalResult
   matchAndRewrite(Operation *op, ArrayRef<Value> operands,
                   ConversionPatternRewriter &rewriter) const override {
@@ -508,12 +595,768 @@ public:
     rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, reduceOp);
     return success();
   }
+
+private:
+  torch_to_linalg::ReductionLoweringOptions options;
+};
+} // namespace
+
+// Returns exp(a - max), where `max` is a running maximum that `a` contributed
+// to. This is 1 when `a == max`, even when both are -inf.
+static Value createShiftedExp(OpBuilder &b, Location loc, Value a, Value max) {
+  Value isMax = b.create<arith::CmpFOp>(loc, arith::CmpFPredicate::OEQ, a, max);
+  Value one = b.create<arith::ConstantOp>(loc, b.getFloatAttr(a.getType(), 1));
+  Value exp =
+      b.create<math::ExpOp>(loc, b.create<arith::SubFOp>(loc, a, max));
+  return b.create<arith::SelectOp>(loc, isMax, one, exp);
+}
+
+// Returns the running maximum `m` and the sum `s` of exp(x - m) of `input`
+// along `dim`, computed in `accType` after converting the elements to
+// `elementType`, in a single reduction that rescales the sum whenever the
+// maximum grows:
+//   m' = max(m, x)
+//   s' = s * exp(m - m') + exp(x - m')
+static std::pair<Value, Value>
+createSoftmaxStatistics(OpBuilder &b, Location loc, Value input, int64_t dim,
+                        Type elementType, Type accType) {
+  int64_t rank = input.getType().cast<RankedTensorType>().getRank();
+  SmallVector<Value> reducedSizes;
+  SmallVector<AffineExpr> reducedExprs;
+  for (int64_t i = 0; i < rank; i++) {
+    if (i == dim)
+      continue;
+    reducedSizes.push_back(getDimOp(b, loc, input, i));
+    reducedExprs.push_back(b.getAffineDimExpr(i));
+  }
+  auto accSemantics = accType.cast<mlir::FloatType>().getFloatSemantics();
+  Value negInf = b.create<arith::ConstantOp>(
+      loc, b.getFloatAttr(accType,
+                          APFloat::getInf(accSemantics, /*Negative=*/true)));
+  Value zero = b.create<arith::ConstantOp>(loc, b.getFloatAttr(accType, 0));
+  Value maxInit = createInitTensor(b, loc, reducedSizes, accType, negInf);
+  Value sumInit = createInitTensor(b, loc, reducedSizes, accType, zero);
+
+  AffineMap identityMap = b.getMultiDimIdentityMap(rank);
+  AffineMap reducedMap =
+      AffineMap::get(rank, /*symbolCount=*/0, reducedExprs, b.getContext());
+  SmallVector<utils::IteratorType> iteratorTypes(
+      rank, utils::IteratorType::parallel);
+  iteratorTypes[dim] = utils::IteratorType::reduction;
+  auto statistics = b.create<linalg::GenericOp>(
+      loc, TypeRange{maxInit.getType(), sumInit.getType()}, input,
+      ValueRange{maxInit, sumInit},
+      ArrayRef<AffineMap>{identityMap, reducedMap, reducedMap}, iteratorTypes,
+      [&](OpBuilder &b, Location loc, ValueRange args) {
+        Value x = convertScalarToDtype(
+            b, loc, convertScalarToDtype(b, loc, args[0], elementType),
+            accType);
+        Value max = args[1], sum = args[2];
+        Value newMax = b.create<arith::MaxFOp>(loc, max, x);
+        Value scaledSum = b.create<arith::MulFOp>(
+            loc, sum, createShiftedExp(b, loc, max, newMax));
+        Value newSum = b.create<arith::AddFOp>(
+            loc, scaledSum, createShiftedExp(b, loc, x, newMax));
+        b.create<linalg::YieldOp>(loc, ValueRange{newMax, newSum});
+      });
+  return {statistics.getResult(0), statistics.getResult(1)};
+}
+
+namespace {
+// Lowers softmax and log-softmax along `dim` to two passes over the input,
+// instead of the five ops of their decompositions.
+//
+// The first pass is a reduction along `dim` that keeps a running maximum `m`
+// and a running sum `s` of exp(x - m), see `createSoftmaxStatistics`.
+// The second pass computes exp(x - m) / s, or (x - m) - log(s) for
+// log-softmax. Both passes compute in at least f32.
+//
+// These ops are only seen here if the backend keeps them legal, see
+// `BACKEND_LEGAL_OPS` in `torch_mlir/__init__.py`.
+template <typename OpTy, bool isLogSoftmax>
+class ConvertSoftmaxOp : public OpConversionPattern<OpTy> {
+public:
+  using OpConversionPattern<OpTy>::OpConversionPattern;
+  using OpAdaptor = typename OpTy::Adaptor;
+  LogicalResult
+  matchAndRewrite(OpTy op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Location loc = op.getLoc();
+    Value input = adaptor.getSelf();
+    auto inputType = input.getType().template cast<RankedTensorType>();
+    auto resultType = this->getTypeConverter()
+                          ->convertType(op.getType())
+                          .template cast<RankedTensorType>();
+    Type resultElementType = resultType.getElementType();
+    if (!inputType.getElementType().template isa<mlir::FloatType>() ||
+        !resultElementType.isa<mlir::FloatType>())
+      return rewriter.notifyMatchFailure(op, "only support floating type");
+
+    int64_t rank = inputType.getRank();
+    int64_t dim;
+    if (!matchPattern(op.getDim(), m_TorchConstantInt(&dim)))
+      return rewriter.notifyMatchFailure(op, "dim must be constant");
+    dim = toPositiveDim(dim, rank);
+    if (rank == 0 || !isValidDim(dim, rank))
+      return rewriter.notifyMatchFailure(op, "dim is not a valid dim");
+
+    // The input is converted to the result type first, like PyTorch does for
+    // `dtype` and `half_to_float`, but the exponentials are summed in at
+    // least f32.
+    Type accType = resultElementType;
+    if (accType.getIntOrFloatBitWidth() < 32)
+      accType = rewriter.getF32Type();
+
+    auto [max, sum] = createSoftmaxStatistics(rewriter, loc, input, dim,
+                                              resultElementType, accType);
+    SmallVector<AffineExpr> reducedExprs;
+    for (int64_t i = 0; i < rank; i++) {
+      if (i != dim)
+        reducedExprs.push_back(rewriter.getAffineDimExpr(i));
+    }
+    AffineMap identityMap = rewriter.getMultiDimIdentityMap(rank);
+    AffineMap reducedMap = AffineMap::get(rank, /*symbolCount=*/0, reducedExprs,
+                                          op.getContext());
+
+    Value outInit = rewriter.create<tensor::EmptyOp>(
+        loc, getAsOpFoldResult(getTensorSizes(rewriter, loc, input)),
+        resultElementType);
+    SmallVector<utils::IteratorType> parallelIteratorTypes(
+        rank, utils::IteratorType::parallel);
+    Value result =
+        rewriter
+            .create<linalg::GenericOp>(
+                loc, outInit.getType(),
+                ValueRange{input, max, sum},
+                outInit,
+                ArrayRef<AffineMap>{identityMap, reducedMap, reducedMap,
+                                    identityMap},
+                parallelIteratorTypes,
+                [&](OpBuilder &b, Location loc, ValueRange args) {
+                  Value x = convertScalarToDtype(
+                      b, loc,
+                      convertScalarToDtype(b, loc, args[0], resultElementType),
+                      accType);
+                  Value shifted = b.create<arith::SubFOp>(loc, x, args[1]);
+                  Value result;
+                  if (isLogSoftmax) {
+                    result = b.create<arith::SubFOp>(
+                        loc, shifted, b.create<math::LogOp>(loc, args[2]));
+                  } else {
+                    result = b.create<arith::DivFOp>(
+                        loc, b.create<math::ExpOp>(loc, shifted), args[2]);
+                  }
+                  b.create<linalg::YieldOp>(
+                      loc, convertScalarToDtype(b, loc, result,
+                                                resultElementType));
+                })
+            .getResult(0);
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, result);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Lowers `aten.cross_entropy_loss` of 2-d logits and 1-d targets straight
+// from the logits, instead of materializing their log-softmax for
+// `aten.nll_loss_forward` like its decomposition does.
+//
+// The softmax statistics `m` and `s` of the logits are computed along the
+// classes (see `createSoftmaxStatistics`), and a pass over the targets
+// computes the loss of each row:
+//   loss[i] = m[i] + log(s[i]) - x[i, target[i]]
+// or 0 if `target[i]` is `ignore_index`. The losses are then summed, or
+// averaged over the rows that aren't ignored. Only the per-row statistics
+// are materialized, in at least f32.
+//
+// This op is only seen here if the backend keeps it legal, see
+// `BACKEND_LEGAL_OPS` in `torch_mlir/__init__.py`.
+class ConvertAtenCrossEntropyLossOp
+    : public OpConversionPattern<AtenCrossEntropyLossOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenCrossEntropyLossOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Location loc = op.getLoc();
+    MLIRContext *context = op.getContext();
+    Value input = adaptor.getSelf();
+    Value target = adaptor.getTarget();
+    auto inputType = input.getType().cast<RankedTensorType>();
+    auto targetType = target.getType().cast<RankedTensorType>();
+    auto resultType = getTypeConverter()
+                          ->convertType(op.getType())
+                          .cast<RankedTensorType>();
+    Type resultElementType = resultType.getElementType();
+    if (inputType.getRank() != 2 || targetType.getRank() != 1)
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: only support 2-d input and 1-d target");
+    if (!inputType.getElementType().isa<mlir::FloatType>() ||
+        !resultElementType.isa<mlir::FloatType>() ||
+        !targetType.getElementType().isa<mlir::IntegerType>())
+      return rewriter.notifyMatchFailure(
+          op, "expected float input and integer target");
+    if (!op.getWeight().getType().isa<Torch::NoneType>())
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: the weight operand is not incorporated");
+    double labelSmoothing;
+    if (!matchPattern(op.getLabelSmoothing(),
+                      m_TorchConstantFloat(&labelSmoothing)) ||
+        labelSmoothing != 0.0)
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: only support a label_smoothing of 0.0");
+    int64_t reduction;
+    if (!matchPattern(op.getReduction(), m_TorchConstantInt(&reduction)))
+      return rewriter.notifyMatchFailure(op, "reduction must be constant");
+
+    Type accType = resultElementType;
+    if (accType.getIntOrFloatBitWidth() < 32)
+      accType = rewriter.getF32Type();
+    auto [max, sum] = createSoftmaxStatistics(rewriter, loc, input, /*dim=*/1,
+                                              resultElementType, accType);
+
+    Value ignoreIndex = castIntToIndex(rewriter, loc, adaptor.getIgnoreIndex());
+    Value zeroIndex = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+    Value zero =
+        rewriter.create<arith::ConstantOp>(loc, rewriter.getZeroAttr(accType));
+    auto isIgnored = [&](OpBuilder &b, Location loc, Value targetElem) {
+      return b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::eq,
+                                     castIntToIndex(b, loc, targetElem),
+                                     ignoreIndex);
+    };
+    Type lossType = reduction == torch_upstream::Reduction::None
+                        ? resultElementType
+                        : accType;
+    Value losses = torch_to_linalg::createElementwiseLinalgGeneric(
+        rewriter, loc, {target, max, sum}, lossType,
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value ignored = isIgnored(b, loc, args[0]);
+          // Ignored targets can be out of bounds.
+          Value classIndex = b.create<arith::SelectOp>(
+              loc, ignored, zeroIndex, castIntToIndex(b, loc, args[0]));
+          Value row = b.create<linalg::IndexOp>(loc, 0);
+          Value logit = b.create<tensor::ExtractOp>(
+              loc, input, ValueRange{row, classIndex});
+          logit = convertScalarToDtype(
+              b, loc, convertScalarToDtype(b, loc, logit, resultElementType),
+              accType);
+          Value logSumExp = b.create<arith::AddFOp>(
+              loc, args[1], b.create<math::LogOp>(loc, args[2]));
+          Value loss = b.create<arith::SelectOp>(
+              loc, ignored, zero,
+              b.create<arith::SubFOp>(loc, logSumExp, logit));
+          b.create<linalg::YieldOp>(
+              loc, convertScalarToDtype(b, loc, loss, lossType));
+        });
+    if (reduction == torch_upstream::Reduction::None) {
+      rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, losses);
+      return success();
+    }
+
+    // Sum the losses and count the rows that aren't ignored.
+    Value one = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getFloatAttr(accType, 1));
+    Value lossSumInit = createInitTensor(rewriter, loc, {}, accType, zero);
+    Value countInit = createInitTensor(rewriter, loc, {}, accType, zero);
+    AffineMap rowMap = rewriter.getMultiDimIdentityMap(1);
+    AffineMap scalarMap = AffineMap::get(1, /*symbolCount=*/0, {}, context);
+    auto totals = rewriter.create<linalg::GenericOp>(
+        loc, TypeRange{lossSumInit.getType(), countInit.getType()},
+        ValueRange{losses, target}, ValueRange{lossSumInit, countInit},
+        ArrayRef<AffineMap>{rowMap, rowMap, scalarMap, scalarMap},
+        ArrayRef<utils::IteratorType>{utils::IteratorType::reduction},
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value lossSum = b.create<arith::AddFOp>(loc, args[2], args[0]);
+          Value count = b.create<arith::AddFOp>(
+              loc, args[3],
+              b.create<arith::SelectOp>(loc, isIgnored(b, loc, args[1]), zero,
+                                        one));
+          b.create<linalg::YieldOp>(loc, ValueRange{lossSum, count});
+        });
+    Value result = torch_to_linalg::createElementwiseLinalgGeneric(
+        rewriter, loc, totals.getResults(), resultElementType,
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value loss = args[0];
+          if (reduction == torch_upstream::Reduction::Mean)
+            loss = b.create<arith::DivFOp>(loc, loss, args[1]);
+          b.create<linalg::YieldOp>(
+              loc, convertScalarToDtype(b, loc, loss, resultElementType));
+        });
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, result);
+    return success();
+  }
+};
+} // namespace
+
+// Builds the body of a Welford reduction of elements `args[0]` into their
+// running mean, M2 and count `args[1..3]`, of type `accType`.
+static void buildWelfordStep(OpBuilder &b, Location loc, ValueRange args,
+                             Type accType) {
+  Value x = convertScalarToDtype(b, loc, args[0], accType);
+  Value mean = args[1], m2 = args[2], count = args[3];
+  Value one = b.create<arith::ConstantOp>(loc, b.getFloatAttr(accType, 1));
+  Value newCount = b.create<arith::AddFOp>(loc, count, one);
+  Value delta = b.create<arith::SubFOp>(loc, x, mean);
+  Value newMean = b.create<arith::AddFOp>(
+      loc, mean, b.create<arith::DivFOp>(loc, delta, newCount));
+  Value newM2 = b.create<arith::AddFOp>(
+      loc, m2,
+      b.create<arith::MulFOp>(loc, delta,
+                              b.create<arith::SubFOp>(loc, x, newMean)));
+  b.create<linalg::YieldOp>(loc, ValueRange{newMean, newM2, newCount});
+}
+
+// Computes rstd = rsqrt(M2 / numElements + eps) once per normalized slice,
+// from the `mean` and `m2` results of a Welford reduction. The results are
+// rstd, and the mean and rstd in `statsElementType`.
+static linalg::GenericOp createNormalizationStats(OpBuilder &b, Location loc,
+                                                  Value mean, Value m2,
+                                                  Value numElements, Value eps,
+                                                  Type statsElementType) {
+  auto meanType = mean.getType().cast<RankedTensorType>();
+  Type accType = meanType.getElementType();
+  Value invNumElements = b.create<arith::DivFOp>(
+      loc, b.create<arith::ConstantOp>(loc, b.getFloatAttr(accType, 1)),
+      convertScalarToDtype(
+          b, loc,
+          b.create<arith::IndexCastOp>(loc, b.getI64Type(), numElements),
+          accType));
+  eps = convertScalarToDtype(b, loc, eps, accType);
+  int64_t statsRank = meanType.getRank();
+  AffineMap statsIdentityMap = b.getMultiDimIdentityMap(statsRank);
+  Value rstdInit = b.create<tensor::EmptyOp>(
+      loc, getAsOpFoldResult(getTensorSizes(b, loc, mean)), accType);
+  Value statsInit = b.create<tensor::EmptyOp>(
+      loc, getAsOpFoldResult(getTensorSizes(b, loc, mean)), statsElementType);
+  return b.create<linalg::GenericOp>(
+      loc, TypeRange{rstdInit.getType(), statsInit.getType(),
+                     statsInit.getType()},
+      ValueRange{mean, m2}, ValueRange{rstdInit, statsInit, statsInit},
+      SmallVector<AffineMap>(5, statsIdentityMap),
+      SmallVector<utils::IteratorType>(statsRank,
+                                       utils::IteratorType::parallel),
+      [&](OpBuilder &b, Location loc, ValueRange args) {
+        Value var = b.create<arith::MulFOp>(loc, args[1], invNumElements);
+        Value rstd = b.create<math::RsqrtOp>(
+            loc, b.create<arith::AddFOp>(loc, var, eps));
+        Value mean = convertScalarToDtype(b, loc, args[0], statsElementType);
+        b.create<linalg::YieldOp>(
+            loc, ValueRange{rstd, mean,
+                            convertScalarToDtype(b, loc, rstd,
+                                                 statsElementType)});
+      });
+}
+
+namespace {
+// Lowers `aten.native_layer_norm` to two passes over the input, instead of the
+// separate mean, variance and normalization passes of its decomposition.
+//
+// The first pass is a reduction over the normalized dims that computes the
+// mean and the sum of squared deviations `M2` with Welford's algorithm:
+//   n' = n + 1
+//   mean' = mean + (x - mean) / n'
+//   M2' = M2 + (x - mean) * (x - mean')
+// The second pass computes (x - mean) * rsqrt(M2 / N + eps) * weight + bias.
+// Both passes compute in at least f32.
+//
+// This op is only seen here if the backend keeps it legal, see
+// `BACKEND_LEGAL_OPS` in `torch_mlir/__init__.py`.
+class ConvertAtenNativeLayerNormOp
+    : public OpConversionPattern<AtenNativeLayerNormOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenNativeLayerNormOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Location loc = op.getLoc();
+    MLIRContext *context = op.getContext();
+    Value input = adaptor.getInput();
+    Value weight = adaptor.getWeight();
+    Value bias = adaptor.getBias();
+    auto inputType = input.getType().cast<RankedTensorType>();
+    SmallVector<RankedTensorType> resultTypes;
+    for (Type type : op->getResultTypes())
+      resultTypes.push_back(
+          getTypeConverter()->convertType(type).cast<RankedTensorType>());
+    Type resultElementType = resultTypes[0].getElementType();
+    Type statsElementType = resultTypes[1].getElementType();
+    if (!inputType.getElementType().isa<mlir::FloatType>() ||
+        !resultElementType.isa<mlir::FloatType>() ||
+        !statsElementType.isa<mlir::FloatType>())
+      return rewriter.notifyMatchFailure(op, "only support floating type");
+
+    SmallVector<Value> normalizedShape;
+    if (!getListConstructElements(op.getNormalizedShape(), normalizedShape))
+      return rewriter.notifyMatchFailure(
+          op, "normalized_shape must be a list construct");
+    int64_t rank = inputType.getRank();
+    int64_t axis = rank - normalizedShape.size();
+    if (axis < 0 || axis == rank)
+      return rewriter.notifyMatchFailure(
+          op, "normalized_shape must be a non-empty suffix of the input shape");
+    bool hasWeight = !weight.getType().isa<Torch::NoneType>();
+    bool hasBias = !bias.getType().isa<Torch::NoneType>();
+    if ((hasWeight &&
+         weight.getType().cast<RankedTensorType>().getRank() != rank - axis) ||
+        (hasBias &&
+         bias.getType().cast<RankedTensorType>().getRank() != rank - axis))
+      return rewriter.notifyMatchFailure(
+          op, "weight and bias must have the rank of normalized_shape");
+
+    Type accType = resultElementType;
+    if (accType.getIntOrFloatBitWidth() < 32)
+      accType = rewriter.getF32Type();
+
+    SmallVector<Value> statsSizes;
+    SmallVector<AffineExpr> statsExprs, normalizedExprs;
+    Value numElements =
+        rewriter.create<arith::ConstantOp>(loc, rewriter.getIndexAttr(1));
+    for (int64_t i = 0; i < rank; i++) {
+      if (i < axis) {
+        statsSizes.push_back(getDimOp(rewriter, loc, input, i));
+        statsExprs.push_back(rewriter.getAffineDimExpr(i));
+      } else {
+        numElements = rewriter.create<arith::MulIOp>(
+            loc, numElements, getDimOp(rewriter, loc, input, i));
+        normalizedExprs.push_back(rewriter.getAffineDimExpr(i));
+      }
+    }
+    Value zero = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getFloatAttr(accType, 0));
+    Value meanInit = createInitTensor(rewriter, loc, statsSizes, accType, zero);
+
+    AffineMap identityMap = rewriter.getMultiDimIdentityMap(rank);
+    AffineMap statsMap =
+        AffineMap::get(rank, /*symbolCount=*/0, statsExprs, context);
+    SmallVector<utils::IteratorType> iteratorTypes(
+        rank, utils::IteratorType::parallel);
+    for (int64_t i = axis; i < rank; i++)
+      iteratorTypes[i] = utils::IteratorType::reduction;
+    auto welford = rewriter.create<linalg::GenericOp>(
+        loc, TypeRange{meanInit.getType(), meanInit.getType(),
+                       meanInit.getType()},
+        input, ValueRange{meanInit, meanInit, meanInit},
+        ArrayRef<AffineMap>{identityMap, statsMap, statsMap, statsMap},
+        iteratorTypes, [&](OpBuilder &b, Location loc, ValueRange args) {
+          buildWelfordStep(b, loc, args, accType);
+        });
+    Value mean = welford.getResult(0);
+
+    // This also produces the mean and rstd results in their own element type.
+    linalg::GenericOp finalizeStats = createNormalizationStats(
+        rewriter, loc, mean, welford.getResult(1), numElements,
+        adaptor.getEps(), statsElementType);
+    Value rstd = finalizeStats.getResult(0);
+
+    SmallVector<Value> normalizeInputs = {input, mean, rstd};
+    AffineMap normalizedMap =
+        AffineMap::get(rank, /*symbolCount=*/0, normalizedExprs, context);
+    SmallVector<AffineMap> indexingMaps = {identityMap, statsMap, statsMap};
+    if (hasWeight) {
+      normalizeInputs.push_back(weight);
+      indexingMaps.push_back(normalizedMap);
+    }
+    if (hasBias) {
+      normalizeInputs.push_back(bias);
+      indexingMaps.push_back(normalizedMap);
+    }
+    indexingMaps.push_back(identityMap);
+    Value outInit = rewriter.create<tensor::EmptyOp>(
+        loc, getAsOpFoldResult(getTensorSizes(rewriter, loc, input)),
+        resultElementType);
+    Value result =
+        rewriter
+            .create<linalg::GenericOp>(
+                loc, outInit.getType(), normalizeInputs, outInit,
+                indexingMaps,
+                SmallVector<utils::IteratorType>(rank,
+                                                 utils::IteratorType::parallel),
+                [&](OpBuilder &b, Location loc, ValueRange args) {
+                  Value x = convertScalarToDtype(b, loc, args[0], accType);
+                  Value result = b.create<arith::MulFOp>(
+                      loc, b.create<arith::SubFOp>(loc, x, args[1]), args[2]);
+                  unsigned nextArg = 3;
+                  if (hasWeight)
+                    result = b.create<arith::MulFOp>(
+                        loc, result,
+                        convertScalarToDtype(b, loc, args[nextArg++], accType));
+                  if (hasBias)
+                    result = b.create<arith::AddFOp>(
+                        loc, result,
+                        convertScalarToDtype(b, loc, args[nextArg++], accType));
+                  b.create<linalg::YieldOp>(
+                      loc, convertScalarToDtype(b, loc, result,
+                                                resultElementType));
+                })
+            .getResult(0);
+
+    // The mean and rstd results keep the normalized dims as size-1 dims.
+    SmallVector<ReassociationIndices> reassociation;
+    for (int64_t i = 0; i < axis; i++)
+      reassociation.push_back({i});
+    for (int64_t i = axis; i < rank && axis > 0; i++)
+      reassociation.back().push_back(i);
+    SmallVector<int64_t> expandedShape(inputType.getShape().take_front(axis));
+    expandedShape.append(rank - axis, 1);
+    auto expandedType = RankedTensorType::get(expandedShape, statsElementType);
+    auto expandStats = [&](Value stats, RankedTensorType resultType) -> Value {
+      Value expanded = rewriter.create<tensor::ExpandShapeOp>(
+          loc, expandedType, stats, reassociation);
+      return rewriter.create<tensor::CastOp>(loc, resultType, expanded);
+    };
+    rewriter.replaceOp(
+        op, {rewriter.create<tensor::CastOp>(loc, resultTypes[0], result),
+             expandStats(finalizeStats.getResult(1), resultTypes[1]),
+             expandStats(finalizeStats.getResult(2), resultTypes[2])});
+    return success();
+  }
+};
+} // namespace
+
+// Returns the [N, S..., C] source of `input` if it is the NHWC to NCHW
+// permutation of it, as produced by the lowering of `aten.permute`, and a
+// null value otherwise.
+static Value getChannelsLastSource(Value input) {
+  if (auto cast = input.getDefiningOp<tensor::CastOp>())
+    input = cast.getSource();
+  auto generic = input.getDefiningOp<linalg::GenericOp>();
+  if (!generic || generic.getNumDpsInputs() != 1 ||
+      generic.getNumDpsInits() != 1 ||
+      generic.getNumLoops() != generic.getNumParallelLoops())
+    return Value();
+  Block *body = generic.getBody();
+  auto yield = dyn_cast<linalg::YieldOp>(body->getTerminator());
+  if (!yield || yield.getNumOperands() != 1 ||
+      yield.getOperand(0) != body->getArgument(0))
+    return Value();
+  SmallVector<AffineMap> maps = generic.getIndexingMapsArray();
+  if (!maps[0].isPermutation() || !maps[1].isPermutation())
+    return Value();
+  // The map from the indices of the result to those of the source.
+  int64_t rank = maps[0].getNumDims();
+  SmallVector<unsigned> channelsLast = {0};
+  for (int64_t i = 2; i < rank; i++)
+    channelsLast.push_back(i);
+  channelsLast.push_back(1);
+  if (maps[0].compose(inversePermutation(maps[1])) !=
+      AffineMap::getPermutationMap(channelsLast, generic.getContext()))
+    return Value();
+  return generic.getDpsInputOperand(0)->get();
+}
+
+namespace {
+// Lowers `aten.native_group_norm` to the same two passes over the input as
+// `aten.native_layer_norm`: a Welford reduction computing the mean and M2 of
+// each group of `C / group` channels, then the normalization. Instance norm
+// is the case where each channel is a group.
+//
+// The input is viewed as [N, group, C / group, S...], the iteration space of
+// both passes. If it is the NCHW permutation of an NHWC tensor, both passes
+// read that tensor instead, viewed as [N, S..., group, C / group], so that
+// channels last models don't transpose their activations around each norm.
+//
+// This op is only seen here if the backend keeps it legal, see
+// `BACKEND_LEGAL_OPS` in `torch_mlir/__init__.py`.
+class ConvertAtenNativeGroupNormOp
+    : public OpConversionPattern<AtenNativeGroupNormOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenNativeGroupNormOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Location loc = op.getLoc();
+    MLIRContext *context = op.getContext();
+    Value input = adaptor.getInput();
+    Value weight = adaptor.getWeight();
+    Value bias = adaptor.getBias();
+    auto inputType = input.getType().cast<RankedTensorType>();
+    SmallVector<RankedTensorType> resultTypes;
+    for (Type type : op->getResultTypes())
+      resultTypes.push_back(
+          getTypeConverter()->convertType(type).cast<RankedTensorType>());
+    Type resultElementType = resultTypes[0].getElementType();
+    Type statsElementType = resultTypes[1].getElementType();
+    if (!inputType.getElementType().isa<mlir::FloatType>() ||
+        !resultElementType.isa<mlir::FloatType>() ||
+        !statsElementType.isa<mlir::FloatType>())
+      return rewriter.notifyMatchFailure(op, "only support floating type");
+
+    int64_t numGroups;
+    if (!matchPattern(op.getGroup(), m_TorchConstantInt(&numGroups)) ||
+        numGroups <= 0)
+      return rewriter.notifyMatchFailure(
+          op, "group must be a positive constant int");
+    int64_t rank = inputType.getRank();
+    if (rank < 2)
+      return rewriter.notifyMatchFailure(op, "input must have a channel dim");
+    int64_t numChannels = inputType.getDimSize(1);
+    if (numChannels != ShapedType::kDynamic && numChannels % numGroups != 0)
+      return rewriter.notifyMatchFailure(
+          op, "the number of channels must be divisible by group");
+    bool hasWeight = !weight.getType().isa<Torch::NoneType>();
+    bool hasBias = !bias.getType().isa<Torch::NoneType>();
+    auto isVector = [](Value tensor) {
+      return tensor.getType().cast<RankedTensorType>().getRank() == 1;
+    };
+    if ((hasWeight && !isVector(weight)) || (hasBias && !isVector(bias)))
+      return rewriter.notifyMatchFailure(op, "weight and bias must be 1-D");
+
+    Type accType = resultElementType;
+    if (accType.getIntOrFloatBitWidth() < 32)
+      accType = rewriter.getF32Type();
+
+    // Splits the channel dim `dim` of `tensor` into [group, C / group].
+    int64_t channelsPerGroup = numChannels == ShapedType::kDynamic
+                                   ? ShapedType::kDynamic
+                                   : numChannels / numGroups;
+    auto splitChannels = [&](Value tensor, int64_t dim) -> Value {
+      auto type = tensor.getType().cast<RankedTensorType>();
+      SmallVector<int64_t> shape(type.getShape());
+      shape[dim] = channelsPerGroup;
+      shape.insert(shape.begin() + dim, numGroups);
+      SmallVector<ReassociationIndices> reassociation;
+      for (int64_t i = 0, e = type.getRank(); i < e; i++) {
+        if (i == dim)
+          reassociation.push_back({i, i + 1});
+        else
+          reassociation.push_back({i < dim ? i : i + 1});
+      }
+      return rewriter.create<tensor::ExpandShapeOp>(
+          loc, RankedTensorType::get(shape, type.getElementType()), tensor,
+          reassociation);
+    };
+
+    // The iteration space is (n, group, channel in group, spatial dims...).
+    int64_t iterationRank = rank + 1;
+    SmallVector<AffineExpr> dims(iterationRank);
+    for (int64_t i = 0; i < iterationRank; i++)
+      dims[i] = rewriter.getAffineDimExpr(i);
+    AffineMap identityMap = rewriter.getMultiDimIdentityMap(iterationRank);
+    Value expandedInput;
+    AffineMap inputMap;
+    // The sizes of the input, in NCHW order.
+    SmallVector<Value> inputSizes;
+    if (Value source = getChannelsLastSource(input)) {
+      expandedInput = splitChannels(source, rank - 1);
+      SmallVector<AffineExpr> exprs = {dims[0]};
+      exprs.append(dims.begin() + 3, dims.end());
+      exprs.append({dims[1], dims[2]});
+      inputMap = AffineMap::get(iterationRank, /*symbolCount=*/0, exprs,
+                                context);
+      inputSizes = {getDimOp(rewriter, loc, source, 0),
+                    getDimOp(rewriter, loc, source, rank - 1)};
+      for (int64_t i = 1; i < rank - 1; i++)
+        inputSizes.push_back(getDimOp(rewriter, loc, source, i));
+    } else {
+      expandedInput = splitChannels(input, 1);
+      inputMap = identityMap;
+      inputSizes = getTensorSizes(rewriter, loc, input);
+    }
+
+    Value numGroupsValue = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getIndexAttr(numGroups));
+    Value channelsPerGroupValue =
+        rewriter.create<arith::DivUIOp>(loc, inputSizes[1], numGroupsValue);
+    SmallVector<Value> iterationSizes = {inputSizes[0], numGroupsValue,
+                                         channelsPerGroupValue};
+    iterationSizes.append(inputSizes.begin() + 2, inputSizes.end());
+    Value numElements = channelsPerGroupValue;
+    for (int64_t i = 2; i < rank; i++)
+      numElements =
+          rewriter.create<arith::MulIOp>(loc, numElements, inputSizes[i]);
+
+    Value zero = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getFloatAttr(accType, 0));
+    Value meanInit = createInitTensor(
+        rewriter, loc, {inputSizes[0], numGroupsValue}, accType, zero);
+    AffineMap statsMap = AffineMap::get(iterationRank, /*symbolCount=*/0,
+                                        {dims[0], dims[1]}, context);
+    SmallVector<utils::IteratorType> iteratorTypes(
+        iterationRank, utils::IteratorType::reduction);
+    iteratorTypes[0] = iteratorTypes[1] = utils::IteratorType::parallel;
+    auto welford = rewriter.create<linalg::GenericOp>(
+        loc, TypeRange{meanInit.getType(), meanInit.getType(),
+                       meanInit.getType()},
+        expandedInput, ValueRange{meanInit, meanInit, meanInit},
+        ArrayRef<AffineMap>{inputMap, statsMap, statsMap, statsMap},
+        iteratorTypes, [&](OpBuilder &b, Location loc, ValueRange args) {
+          buildWelfordStep(b, loc, args, accType);
+        });
+    Value mean = welford.getResult(0);
+    linalg::GenericOp finalizeStats = createNormalizationStats(
+        rewriter, loc, mean, welford.getResult(1), numElements,
+        adaptor.getEps(), statsElementType);
+    Value rstd = finalizeStats.getResult(0);
+
+    SmallVector<Value> normalizeInputs = {expandedInput, mean, rstd};
+    SmallVector<AffineMap> indexingMaps = {inputMap, statsMap, statsMap};
+    AffineMap channelMap = AffineMap::get(iterationRank, /*symbolCount=*/0,
+                                          {dims[1], dims[2]}, context);
+    if (hasWeight) {
+      normalizeInputs.push_back(splitChannels(weight, 0));
+      indexingMaps.push_back(channelMap);
+    }
+    if (hasBias) {
+      normalizeInputs.push_back(splitChannels(bias, 0));
+      indexingMaps.push_back(channelMap);
+    }
+    indexingMaps.push_back(identityMap);
+    Value outInit = rewriter.create<tensor::EmptyOp>(
+        loc, getAsOpFoldResult(iterationSizes), resultElementType);
+    Value result =
+        rewriter
+            .create<linalg::GenericOp>(
+                loc, outInit.getType(), normalizeInputs, outInit,
+                indexingMaps,
+                SmallVector<utils::IteratorType>(iterationRank,
+                                                 utils::IteratorType::parallel),
+                [&](OpBuilder &b, Location loc, ValueRange args) {
+                  Value x = convertScalarToDtype(b, loc, args[0], accType);
+                  Value result = b.create<arith::MulFOp>(
+                      loc, b.create<arith::SubFOp>(loc, x, args[1]), args[2]);
+                  unsigned nextArg = 3;
+                  if (hasWeight)
+                    result = b.create<arith::MulFOp>(
+                        loc, result,
+                        convertScalarToDtype(b, loc, args[nextArg++], accType));
+                  if (hasBias)
+                    result = b.create<arith::AddFOp>(
+                        loc, result,
+                        convertScalarToDtype(b, loc, args[nextArg++], accType));
+                  b.create<linalg::YieldOp>(
+                      loc, convertScalarToDtype(b, loc, result,
+                                                resultElementType));
+                })
+            .getResult(0);
+
+    SmallVector<ReassociationIndices> reassociation = {{0}, {1, 2}};
+    for (int64_t i = 3; i < iterationRank; i++)
+      reassociation.push_back({i});
+    result = rewriter.create<tensor::CollapseShapeOp>(loc, result,
+                                                      reassociation);
+    rewriter.replaceOp(
+        op, {rewriter.create<tensor::CastOp>(loc, resultTypes[0], result),
+             rewriter.create<tensor::CastOp>(loc, resultTypes[1],
+                                             finalizeStats.getResult(1)),
+             rewriter.create<tensor::CastOp>(loc, resultTypes[2],
+                                             finalizeStats.getResult(2))});
+    return success();
+  }
 };
 } // namespace
 
 void mlir::torch::torch_to_linalg::populateReductionPatternsAndLegality(
     TypeConverter &typeConverter, RewritePatternSet &patterns,
-    ConversionTarget &target) {
+    ConversionTarget &target, const ReductionLoweringOptions &options) {
   MLIRContext *context = patterns.getContext();
   target.addIllegalOp<AtenMaxDimOp>();
   patterns.add<ConvertAtenMaxDimOp>(typeConverter, context);
@@ -522,5 +1365,21 @@ void mlir::torch::torch_to_linalg::populateReductionPatternsAndLegality(
   target.addIllegalOp<AtenMaxOp>();
   target.addIllegalOp<AtenLinalgVectorNormOp>();
   target.addIllegalOp<AtenFrobeniusNormDimOp>();
-  patterns.add<ConvertReductionOp>(typeConverter, context);
+  torch_to_linalg::addPatternForEachOp<
+      ConvertReductionOp, AtenSumOp, AtenSumDimIntListOp, AtenMaxOp,
+      AtenLinalgVectorNormOp, AtenFrobeniusNormDimOp>(patterns, typeConverter,
+                                                      context, options);
+  target.addIllegalOp<AtenSoftmaxIntOp, Aten_SoftmaxOp, AtenLogSoftmaxIntOp,
+                      Aten_LogSoftmaxOp>();
+  patterns.add<ConvertSoftmaxOp<AtenSoftmaxIntOp, /*isLogSoftmax=*/false>,
+               ConvertSoftmaxOp<Aten_SoftmaxOp, /*isLogSoftmax=*/false>,
+               ConvertSoftmaxOp<AtenLogSoftmaxIntOp, /*isLogSoftmax=*/true>,
+               ConvertSoftmaxOp<Aten_LogSoftmaxOp, /*isLogSoftmax=*/true>>(
+      typeConverter, context);
+  target.addIllegalOp<AtenCrossEntropyLossOp>();
+  patterns.add<ConvertAtenCrossEntropyLossOp>(typeConverter, context);
+  target.addIllegalOp<AtenNativeLayerNormOp>();
+  patterns.add<ConvertAtenNativeLayerNormOp>(typeConverter, context);
+  target.addIllegalOp<AtenNativeGroupNormOp>();
+  patterns.add<ConvertAtenNativeGroupNormOp>(typeConverter, context);
 }
@@ -11,6 +11,7 @@
 
 #include "../PassDetail.h"
 #include "PopulatePatterns.h"
+#include "Utils.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
@@ -112,18 +113,14 @@ public:
 namespace {
 class ConvertAtenScalarToTensorLike : public ConversionPattern {
 public:
-  ConvertAtenScalarToTensorLike(TypeConverter &typeConverter,
+  ConvertAtenScalarToTensorLike(StringRef rootName,
+                                TypeConverter &typeConverter,
                                 MLIRContext *context)
-      : ConversionPattern(typeConverter, MatchAnyOpTypeTag(), /*benefit=*/1,
-                          context) {}
+      : ConversionPattern(typeConverter, rootName, /*benefit=*/1, context) {}
 
   LogicalResult
   matchAndRewrite(Operation *op, ArrayRef<Value> operands,
                   ConversionPatternRewriter &rewriter) const override {
-    if (!isa<AtenTensorIntOp, AtenTensorFloatOp>(op))
-      return rewriter.notifyMatchFailure(
-          op, "not a supported Scalar to Tensor like op");
-
     if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
       return failure();
     Location loc = op->getLoc();
@@ -219,7 +216,9 @@ void mlir::torch::torch_to_linalg::
   patterns.add<ConvertAtenTensorToScalarLikeOp<AtenBoolTensorOp>>(typeConverter,
                                                                   context);
   target.addIllegalOp<AtenTensorIntOp, AtenTensorFloatOp>();
-  patterns.add<ConvertAtenScalarToTensorLike>(typeConverter, context);
+  torch_to_linalg::addPatternForEachOp<ConvertAtenScalarToTensorLike,
+                                       AtenTensorIntOp, AtenTensorFloatOp>(
+      patterns, typeConverter, context);
   target.addIllegalOp<PrimNumToTensorScalarOp>();
   patterns.add<ConvertPrimNumToTensorScalarOp>(typeConverter, context);
   patterns.add<ConvertAtenScalarImplicitOp>(typeConverter, context);
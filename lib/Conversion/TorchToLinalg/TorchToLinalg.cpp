@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "torch-mlir/Conversion/TorchToLinalg/TorchToLinalg.h"
+#include "torch-mlir/Conversion/Utils/Utils.h"
 
 #include "../PassDetail.h"
 #include "PopulatePatterns.h"
@@ -17,6 +18,8 @@
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/SparseTensor/IR/SparseTensor.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
@@ -39,6 +42,9 @@ namespace {
 class ConvertTorchToLinalg
     : public ConvertTorchToLinalgBase<ConvertTorchToLinalg> {
 public:
+  ConvertTorchToLinalg() = default;
+  ConvertTorchToLinalg(bool convNhwc) { this->convNhwc = convNhwc; }
+
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<linalg::LinalgDialect>();
     registry.insert<math::MathDialect>();
@@ -47,6 +53,8 @@ public:
     registry.insert<arith::ArithDialect>();
     registry.insert<cf::ControlFlowDialect>();
     registry.insert<complex::ComplexDialect>();
+    registry.insert<scf::SCFDialect>();
+    registry.insert<sparse_tensor::SparseTensorDialect>();
     TorchConversion::getBackendTypeConversionDependentDialects(registry);
   }
 
@@ -56,8 +64,10 @@ public:
     target.addLegalDialect<linalg::LinalgDialect, func::FuncDialect,
                            cf::ControlFlowDialect, math::MathDialect,
                            tensor::TensorDialect, arith::ArithDialect,
-                           complex::ComplexDialect>();
-    target.addLegalOp<TorchConversion::GetNextSeedOp>();
+                           complex::ComplexDialect, scf::SCFDialect,
+                           sparse_tensor::SparseTensorDialect>();
+    target.addLegalOp<TorchConversion::GetNextSeedOp,
+                      TorchConversion::GetNextRngOffsetOp>();
 
     TypeConverter typeConverter;
     typeConverter.addConversion([](Type type) { return type; });
@@ -67,25 +77,38 @@ public:
 
     torch_to_linalg::populateTensorScalarInteropPatternsAndLegality(
         typeConverter, patterns, target);
+    torch_to_linalg::LinearLoweringOptions linearOptions;
+    linearOptions.nhwc = convNhwc;
+    linearOptions.im2col = convIm2col;
+    linearOptions.winograd = convWinograd;
+    linearOptions.accumulateInF32 = accumulateInF32;
     torch_to_linalg::populateLinearPatternsAndLegality(typeConverter, patterns,
-                                                       target);
+                                                       target, linearOptions);
     torch_to_linalg::populatePoolingPatternsAndLegality(typeConverter, patterns,
                                                         target);
     torch_to_linalg::populateRandomPatternsAndLegality(typeConverter, patterns,
                                                        target);
     torch_to_linalg::populateUncategorizedPatternsAndLegality(typeConverter,
                                                               patterns, target);
-    torch_to_linalg::populateReductionPatternsAndLegality(typeConverter,
-                                                          patterns, target);
-    torch_to_linalg::populateDataMovementPatternsAndLegality(typeConverter,
-                                                             patterns, target);
+    torch_to_linalg::ReductionLoweringOptions reductionOptions;
+    reductionOptions.splitFactor = reductionSplitFactor;
+    torch_to_linalg::populateReductionPatternsAndLegality(
+        typeConverter, patterns, target, reductionOptions);
+    torch_to_linalg::DataMovementStatistics dataMovementStatistics;
+    dataMovementStatistics.numCopiedViews = &numCopiedViews;
+    torch_to_linalg::populateDataMovementPatternsAndLegality(
+        typeConverter, patterns, target, dataMovementStatistics);
     torch_to_linalg::populateIndirectDataMovementPatternsAndLegality(
         typeConverter, patterns, target);
     torch_to_linalg::populateTensorConstructorsPatternsAndLegality(
         typeConverter, patterns, target);
 
-    if (failed(applyPartialConversion(getOperation(), target,
-                                      std::move(patterns))))
+    if (failed(profile
+                   ? applyPartialConversionWithProfile(
+                         getOperation(), target, std::move(patterns),
+                         getArgument(), llvm::errs())
+                   : applyPartialConversion(getOperation(), target,
+                                            std::move(patterns))))
       return signalPassFailure();
   }
 };
@@ -95,3 +118,8 @@ std::unique_ptr<OperationPass<func::FuncOp>>
 mlir::torch::createConvertTorchToLinalgPass() {
   return std::make_unique<ConvertTorchToLinalg>();
 }
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::createConvertTorchToLinalgPass(bool convNhwc) {
+  return std::make_unique<ConvertTorchToLinalg>(convNhwc);
+}
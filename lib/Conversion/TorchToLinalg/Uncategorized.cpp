@@ -17,6 +17,7 @@
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/SparseTensor/IR/SparseTensor.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/Matchers.h"
 #include "torch-mlir/Conversion/Utils/Utils.h"
@@ -359,6 +360,36 @@ static Value createLinalgPayloadCalculationForElementwiseOp(
     }
     return b.create<math::RoundEvenOp>(loc, payloadArgs[0]);
   }
+  if (auto quantize = dyn_cast<AtenQuantizePerTensorOp>(op)) {
+    AtenQuantizePerTensorOp::Adaptor adaptor(operands);
+    Type inputType = payloadArgs[0].getType();
+    Type dtype = quantize.getType().cast<ValueTensorType>().getDtype();
+    if (!inputType.isa<mlir::FloatType>() ||
+        !dtype.isa<QInt8Type, QUInt8Type>()) {
+      quantize.emitError("unimplemented: only quantization of floating point "
+                         "tensors to qint8 or quint8 is supported");
+      return nullptr;
+    }
+    bool isUnsigned = dtype.isa<QUInt8Type>();
+    Type resultElementType = converter->convertType(quantize.getType())
+                                 .cast<RankedTensorType>()
+                                 .getElementType();
+    Value scale = convertScalarToDtype(b, loc, adaptor.getScale(), inputType);
+    Value zeroPoint =
+        convertScalarToDtype(b, loc, adaptor.getZeroPoint(), inputType);
+    Value scaled = b.create<arith::DivFOp>(loc, payloadArgs[0], scale);
+    Value quantized = b.create<arith::AddFOp>(
+        loc, b.create<math::RoundEvenOp>(loc, scaled), zeroPoint);
+    Value min = b.create<arith::ConstantOp>(
+        loc, FloatAttr::get(inputType, isUnsigned ? 0 : -128));
+    Value max = b.create<arith::ConstantOp>(
+        loc, FloatAttr::get(inputType, isUnsigned ? 255 : 127));
+    quantized = b.create<arith::MaxFOp>(loc, quantized, min);
+    quantized = b.create<arith::MinFOp>(loc, quantized, max);
+    if (isUnsigned)
+      return b.create<arith::FPToUIOp>(loc, resultElementType, quantized);
+    return b.create<arith::FPToSIOp>(loc, resultElementType, quantized);
+  }
   if (auto prelu = dyn_cast<AtenPreluOp>(op)) {
     if (!prelu.getType()
              .cast<ValueTensorType>()
@@ -1121,37 +1152,18 @@ namespace {
 // be needed for "pre-fusing" elementwise ops that way, as it can potentially be
 // a pessimization. A mild extension of this pattern should work for such a
 // general op.
+//
+// An instance of this pattern is added for each supported op, see
+// `populateUncategorizedPatternsAndLegality`.
 class ConvertElementwiseOp : public ConversionPattern {
 public:
-  ConvertElementwiseOp(TypeConverter &typeConverter, MLIRContext *context)
-      : ConversionPattern(typeConverter, MatchAnyOpTypeTag(), /*benefit=*/1,
-                          context) {}
+  ConvertElementwiseOp(StringRef rootName, TypeConverter &typeConverter,
+                       MLIRContext *context)
+      : ConversionPattern(typeConverter, rootName, /*benefit=*/1, context) {}
 
   LogicalResult
   matchAndRewrite(Operation *op, ArrayRef<Value> operands,
                   ConversionPatternRewriter &rewriter) const override {
-    if (!isa<AtenTanhOp, AtenReluOp, AtenPreluOp, AtenGeluOp,
-             AtenGeluBackwardOp, AtenAddTensorOp, AtenMulTensorOp,
-             AtenDivTensorOp, AtenDivTensorModeOp, AtenSubTensorOp, AtenAtan2Op,
-             AtenLerpTensorOp, AtenSigmoidOp, AtenExpOp, AtenExpm1Op,
-             AtenMinimumOp, AtenMaximumOp, AtenToDtypeOp, AtenClampOp,
-             AtenRsubScalarOp, AtenMulScalarOp, AtenLogOp, AtenErfOp,
-             AtenSqrtOp, AtenFloorOp, AtenPowTensorScalarOp,
-             AtenPowTensorTensorOp, AtenLog2Op, AtenLog1pOp, AtenRsqrtOp,
-             AtenDivScalarOp, AtenRemainderScalarOp, AtenAbsOp,
-             AtenReciprocalOp, AtenBitwiseAndTensorOp, AtenBitwiseOrTensorOp,
-             AtenBitwiseXorTensorOp, AtenGtScalarOp, AtenGeScalarOp,
-             AtenEqScalarOp, AtenLtScalarOp, AtenLeScalarOp, AtenWhereSelfOp,
-             AtenCeilOp, AtenGtTensorOp, AtenGeTensorOp, AtenEqTensorOp,
-             AtenLtTensorOp, AtenLeTensorOp, AtenSubScalarOp, AtenAddScalarOp,
-             AtenThresholdOp, AtenThresholdBackwardOp, AtenHardtanhBackwardOp,
-             AtenCloneOp, AtenSinOp, AtenCosOp, AtenNeScalarOp, AtenNegOp,
-             AtenMaskedFillTensorOp, AtenLogicalOrOp, AtenLogicalAndOp,
-             AtenLogicalXorOp, AtenLogicalNotOp, AtenTriuOp, AtenBitwiseNotOp,
-             AtenRoundOp, AtenFillScalarOp, AtenFillTensorOp, AtenAtanOp,
-             AtenRealOp, AtenImagOp>(op))
-      return rewriter.notifyMatchFailure(op, "not a supported elementwise op");
-
     if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
       return failure();
 
@@ -1601,6 +1613,13 @@ public:
     RankedTensorType resultType = getTypeConverter()
                                       ->convertType(op->getResult(0).getType())
                                       .cast<RankedTensorType>();
+    // Casts that change the sparse layout of the tensor convert its storage.
+    auto operandType = adaptor.getOperand().getType().cast<RankedTensorType>();
+    if (operandType.getEncoding() != resultType.getEncoding()) {
+      rewriter.replaceOpWithNewOp<sparse_tensor::ConvertOp>(
+          op, resultType, adaptor.getOperand());
+      return success();
+    }
     rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType,
                                                 adaptor.getOperand());
     return success();
@@ -1608,6 +1627,121 @@ public:
 };
 } // namespace
 
+namespace {
+// A quantized tensor is represented by its integer representation, see
+// `ValueTensorType::toBuiltinTensor`, so creating one is a no-op.
+template <typename OpTy>
+class ConvertAffineQuantizedCreateOp : public OpConversionPattern<OpTy> {
+public:
+  using OpConversionPattern<OpTy>::OpConversionPattern;
+  using OpAdaptor = typename OpTy::Adaptor;
+  LogicalResult
+  matchAndRewrite(OpTy op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Type resultType = this->getTypeConverter()->convertType(op.getType());
+    auto intReprType =
+        adaptor.getIntRepr().getType().template cast<RankedTensorType>();
+    if (intReprType.getElementType() !=
+        resultType.cast<RankedTensorType>().getElementType())
+      return rewriter.notifyMatchFailure(
+          op, "expected an 8-bit integer representation");
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType,
+                                                adaptor.getIntRepr());
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Dequantizes an affine quantized tensor as `(int_repr - zero_point) * scale`,
+// with the scale and zero point of the op that produced it. Those of a
+// per-channel quantized tensor are broadcast along every dimension but its
+// axis.
+class ConvertAtenDequantizeSelfOp
+    : public OpConversionPattern<AtenDequantizeSelfOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenDequantizeSelfOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Type dtype = op.getSelf().getType().cast<ValueTensorType>().getDtype();
+    if (!dtype.isa<QInt8Type, QUInt8Type>())
+      return rewriter.notifyMatchFailure(op,
+                                         "expected a qint8 or quint8 tensor");
+    Location loc = op.getLoc();
+    auto resultType = getTypeConverter()
+                          ->convertType(op.getType())
+                          .cast<RankedTensorType>();
+    Type elementType = resultType.getElementType();
+    Type accType = rewriter.getI32Type();
+    bool isUnsigned = dtype.isa<QUInt8Type>();
+    auto dequantize = [&](OpBuilder &b, Location loc, Value quantized,
+                          Value zeroPoint, Value scale) {
+      quantized = isUnsigned
+                      ? b.create<arith::ExtUIOp>(loc, accType, quantized)
+                      : b.create<arith::ExtSIOp>(loc, accType, quantized);
+      Value shifted = b.create<arith::SubIOp>(
+          loc, quantized, convertScalarToDtype(b, loc, zeroPoint, accType));
+      Value unscaled = b.create<arith::SIToFPOp>(loc, elementType, shifted);
+      return b.create<arith::MulFOp>(
+          loc, unscaled, convertScalarToDtype(b, loc, scale, elementType));
+    };
+
+    Value scale, zeroPoint, dequantized;
+    int64_t axis;
+    if (succeeded(torch_to_linalg::getPerTensorQuantizationParams(
+            rewriter, loc, getTypeConverter(), op.getSelf(), scale,
+            zeroPoint))) {
+      scale = convertScalarToDtype(rewriter, loc, scale, elementType);
+      zeroPoint = rewriter.create<arith::TruncIOp>(loc, accType, zeroPoint);
+      dequantized = torch_to_linalg::createElementwiseLinalgGeneric(
+          rewriter, loc, adaptor.getSelf(), elementType,
+          [&](OpBuilder &b, Location loc, ValueRange payloadArgs) {
+            b.create<linalg::YieldOp>(
+                loc, dequantize(b, loc, payloadArgs[0], zeroPoint, scale));
+          });
+    } else if (succeeded(torch_to_linalg::getPerChannelQuantizationParams(
+                   rewriter, loc, getTypeConverter(), op.getSelf(), scale,
+                   zeroPoint, axis))) {
+      Value self = adaptor.getSelf();
+      int64_t rank = resultType.getRank();
+      SmallVector<Value> sizes = getTensorSizes(rewriter, loc, self);
+      Value empty = rewriter.create<tensor::EmptyOp>(
+          loc, getAsOpFoldResult(sizes), elementType);
+      AffineMap identity = rewriter.getMultiDimIdentityMap(rank);
+      AffineMap channelMap =
+          AffineMap::get(rank, /*symbolCount=*/0,
+                         rewriter.getAffineDimExpr(axis), op.getContext());
+      SmallVector<utils::IteratorType> iteratorTypes(
+          rank, utils::IteratorType::parallel);
+      dequantized =
+          rewriter
+              .create<linalg::GenericOp>(
+                  loc, empty.getType(), ValueRange{self, scale, zeroPoint},
+                  empty,
+                  SmallVector<AffineMap>{identity, channelMap, channelMap,
+                                         identity},
+                  iteratorTypes,
+                  [&](OpBuilder &b, Location loc, ValueRange payloadArgs) {
+                    b.create<linalg::YieldOp>(
+                        loc, dequantize(b, loc, payloadArgs[0],
+                                        payloadArgs[2], payloadArgs[1]));
+                  })
+              .getResult(0);
+    } else {
+      return rewriter.notifyMatchFailure(
+          op, "unknown quantization parameters of the dequantized tensor");
+    }
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, dequantized);
+    return success();
+  }
+};
+} // namespace
+
 void mlir::torch::torch_to_linalg::populateUncategorizedPatternsAndLegality(
     TypeConverter &typeConverter, RewritePatternSet &patterns,
     ConversionTarget &target) {
@@ -1628,8 +1762,27 @@ void mlir::torch::torch_to_linalg::populateUncategorizedPatternsAndLegality(
       AtenMaskedFillTensorOp, AtenLogicalOrOp, AtenLogicalAndOp, AtenAtanOp,
       AtenLogicalXorOp, AtenLogicalNotOp, AtenTriuOp, AtenRemainderScalarOp,
       AtenBitwiseNotOp, AtenRoundOp, AtenFillScalarOp, AtenFillTensorOp,
-      AtenRealOp, AtenImagOp>();
-  patterns.add<ConvertElementwiseOp>(typeConverter, context);
+      AtenRealOp, AtenImagOp, AtenQuantizePerTensorOp>();
+  torch_to_linalg::addPatternForEachOp<
+      ConvertElementwiseOp,
+      AtenTanhOp, AtenReluOp, AtenPreluOp, AtenGeluOp, AtenGeluBackwardOp,
+      AtenAddTensorOp, AtenMulTensorOp, AtenDivTensorOp, AtenDivTensorModeOp,
+      AtenSubTensorOp, AtenAtan2Op, AtenLerpTensorOp, AtenSigmoidOp, AtenExpOp,
+      AtenExpm1Op, AtenMinimumOp, AtenMaximumOp, AtenToDtypeOp, AtenClampOp,
+      AtenRsubScalarOp, AtenMulScalarOp, AtenLogOp, AtenErfOp, AtenSqrtOp,
+      AtenFloorOp, AtenPowTensorScalarOp, AtenPowTensorTensorOp, AtenLog2Op,
+      AtenLog1pOp, AtenRsqrtOp, AtenDivScalarOp, AtenRemainderScalarOp,
+      AtenAbsOp, AtenReciprocalOp, AtenBitwiseAndTensorOp,
+      AtenBitwiseOrTensorOp, AtenBitwiseXorTensorOp, AtenGtScalarOp,
+      AtenGeScalarOp, AtenEqScalarOp, AtenLtScalarOp, AtenLeScalarOp,
+      AtenWhereSelfOp, AtenCeilOp, AtenGtTensorOp, AtenGeTensorOp,
+      AtenEqTensorOp, AtenLtTensorOp, AtenLeTensorOp, AtenSubScalarOp,
+      AtenAddScalarOp, AtenThresholdOp, AtenThresholdBackwardOp,
+      AtenHardtanhBackwardOp, AtenCloneOp, AtenSinOp, AtenCosOp, AtenNeScalarOp,
+      AtenNegOp, AtenMaskedFillTensorOp, AtenLogicalOrOp, AtenLogicalAndOp,
+      AtenLogicalXorOp, AtenLogicalNotOp, AtenTriuOp, AtenBitwiseNotOp,
+      AtenRoundOp, AtenFillScalarOp, AtenFillTensorOp, AtenAtanOp, AtenRealOp,
+      AtenImagOp, AtenQuantizePerTensorOp>(patterns, typeConverter, context);
   target.addIllegalOp<AtenNllLossForwardOp>();
   patterns.add<ConvertAtenDetachOp>(typeConverter, context);
   target.addIllegalOp<AtenDetachOp>();
@@ -1640,4 +1793,10 @@ void mlir::torch::torch_to_linalg::populateUncategorizedPatternsAndLegality(
   patterns.add<ConvertAtenNllLossBackwardOp>(typeConverter, context);
   patterns.add<ConvertTensorStaticInfoCastOp>(typeConverter, context);
   target.addIllegalOp<TensorStaticInfoCastOp>();
+  patterns.add<ConvertAffineQuantizedCreateOp<PerTensorAffineCreateOp>,
+               ConvertAffineQuantizedCreateOp<PerChannelAffineCreateOp>>(
+      typeConverter, context);
+  target.addIllegalOp<PerTensorAffineCreateOp, PerChannelAffineCreateOp>();
+  patterns.add<ConvertAtenDequantizeSelfOp>(typeConverter, context);
+  target.addIllegalOp<AtenDequantizeSelfOp>();
 }
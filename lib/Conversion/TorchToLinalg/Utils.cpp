@@ -16,6 +16,7 @@
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/Dialect/Tensor/Utils/Utils.h"
+#include "mlir/IR/IRMapping.h"
 #include "mlir/IR/Matchers.h"
 #include "torch-mlir/Conversion/Utils/Utils.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
@@ -212,6 +213,83 @@ Value torch_to_linalg::createReductionLinalgGeneric(
       .getResult(0);
 }
 
+// Returns the scalar that all the elements of `tensor` are set to if it is
+// produced by a `linalg.fill`, possibly cast to a more static shape.
+static Value getFilledScalar(Value tensor) {
+  if (auto cast = tensor.getDefiningOp<tensor::CastOp>())
+    tensor = cast.getSource();
+  auto fill = tensor.getDefiningOp<linalg::FillOp>();
+  if (!fill)
+    return Value();
+  Value scalar = fill.getInputs()[0];
+  if (scalar.getType() !=
+      tensor.getType().cast<RankedTensorType>().getElementType())
+    return Value();
+  return scalar;
+}
+
+linalg::GenericOp torch_to_linalg::getBroadcastOrCastProducer(Value tensor) {
+  if (auto cast = tensor.getDefiningOp<tensor::CastOp>())
+    tensor = cast.getSource();
+  auto generic = tensor.getDefiningOp<linalg::GenericOp>();
+  if (!generic || generic.getNumDpsInputs() != 1 ||
+      generic.getNumDpsInits() != 1 ||
+      generic.getNumParallelLoops() != generic.getNumLoops())
+    return nullptr;
+  AffineMap initMap = generic.getIndexingMapsArray()[1];
+  AffineMap inputMap = generic.getIndexingMapsArray()[0];
+  if (!initMap.isIdentity() || !inputMap.isMinorIdentityWithBroadcasting())
+    return nullptr;
+  Block *body = generic.getBody();
+  if (!body->getArgument(1).use_empty())
+    return nullptr;
+  for (Operation &op : body->without_terminator()) {
+    if (!isa<arith::ConstantOp, CastOpInterface>(op))
+      return nullptr;
+  }
+  return generic;
+}
+
+Value torch_to_linalg::getTransposeSource(Value tensor) {
+  if (auto cast = tensor.getDefiningOp<tensor::CastOp>())
+    tensor = cast.getSource();
+  auto generic = tensor.getDefiningOp<linalg::GenericOp>();
+  if (!generic || generic.getNumDpsInputs() != 1 ||
+      generic.getNumDpsInits() != 1 || generic.getNumLoops() < 2 ||
+      generic.getNumParallelLoops() != generic.getNumLoops())
+    return nullptr;
+  unsigned rank = generic.getNumLoops();
+  SmallVector<unsigned> permutation =
+      llvm::to_vector(llvm::seq<unsigned>(0, rank));
+  std::swap(permutation[rank - 2], permutation[rank - 1]);
+  AffineMap swapMap =
+      AffineMap::getPermutationMap(permutation, generic.getContext());
+  // The swap is its own inverse, so it can be applied to either map.
+  AffineMap inputMap = generic.getIndexingMapsArray()[0];
+  AffineMap initMap = generic.getIndexingMapsArray()[1];
+  if (!(inputMap.isIdentity() && initMap == swapMap) &&
+      !(inputMap == swapMap && initMap.isIdentity()))
+    return nullptr;
+  Block *body = generic.getBody();
+  if (body->getOperations().size() != 1 ||
+      body->getTerminator()->getOperand(0) != body->getArgument(0))
+    return nullptr;
+  return generic.getDpsInputOperand(0)->get();
+}
+
+// Clones the payload of `producer`, a generic op returned by
+// `getBroadcastOrCastProducer`, at `b` for the element `input` of its input,
+// and returns the element it yields.
+static Value clonePayload(OpBuilder &b, linalg::GenericOp producer,
+                          Value input) {
+  Block *body = producer.getBody();
+  IRMapping mapping;
+  mapping.map(body->getArgument(0), input);
+  for (Operation &op : body->without_terminator())
+    b.clone(op, mapping);
+  return mapping.lookupOrDefault(body->getTerminator()->getOperand(0));
+}
+
 Value torch_to_linalg::createElementwiseLinalgGeneric(
     OpBuilder &b, Location loc, ValueRange tensorOperands,
     Type resultElementType,
@@ -250,6 +328,8 @@ Value torch_to_linalg::createElementwiseLinalgGeneric(
   // all sizes along that result dimension are statically 1.
   auto c1 = b.create<arith::ConstantIndexOp>(loc, /*value=*/1);
   SmallVector<Value> resultShape(resultRank, c1);
+  // The operand and dimension that each entry of `resultShape` is the size of.
+  SmallVector<std::pair<Value, int64_t>> resultShapeSources(resultRank);
   SmallVector<AffineMap> indexingMaps;
   for (Value tensorOperand : tensorOperands) {
     SmallVector<AffineExpr> exprs;
@@ -286,9 +366,17 @@ Value torch_to_linalg::createElementwiseLinalgGeneric(
       // dimension size.
       if (resultShape[resultDim] == c1) {
         resultShape[resultDim] = currentDimSize;
+        resultShapeSources[resultDim] = {tensorOperand, size.index()};
         continue;
       }
 
+      // If the sizes are known to be equal, for example because both operands
+      // were computed from the same tensor, there is nothing to check.
+      auto [runningTensor, runningDim] = resultShapeSources[resultDim];
+      if (areDimSizesEqual(runningTensor, runningDim, tensorOperand,
+                           size.index()))
+        continue;
+
       // We prohibit the size-1 dynamic broadcasting scenario, so just check
       // for exact equality with the running result size.
       // This is the check which protects against the undefined behavior of
@@ -304,19 +392,61 @@ Value torch_to_linalg::createElementwiseLinalgGeneric(
         /*dimCount=*/resultRank, /*symbolCount=*/0, exprs, b.getContext()));
   }
 
+  // The operands filled with a scalar, such as the results of `aten.zeros`,
+  // take part in the broadcast above but are not read by the generic op: the
+  // payload uses their scalar instead, so that the fill is only materialized
+  // if something else needs its buffer. The outs init tensor alone bounds the
+  // loops. Likewise, the generic op reads the operands broadcasted or
+  // converted from another tensor, such as the results of `aten.expand` or
+  // `aten.to.dtype`, from that tensor, and converts its elements itself.
+  SmallVector<Value> filledScalars;
+  SmallVector<linalg::GenericOp> producers;
+  SmallVector<Value> inputs;
+  SmallVector<AffineMap> genericIndexingMaps;
+  for (auto [tensorOperand, indexingMap] :
+       llvm::zip(tensorOperands, indexingMaps)) {
+    filledScalars.push_back(getFilledScalar(tensorOperand));
+    producers.push_back(nullptr);
+    if (filledScalars.back())
+      continue;
+    if (auto producer = getBroadcastOrCastProducer(tensorOperand)) {
+      producers.back() = producer;
+      inputs.push_back(producer.getDpsInputOperand(0)->get());
+      genericIndexingMaps.push_back(
+          producer.getIndexingMapsArray()[0].compose(indexingMap));
+      continue;
+    }
+    inputs.push_back(tensorOperand);
+    genericIndexingMaps.push_back(indexingMap);
+  }
+  auto bodyBuildWithFoldedOperands = [&](OpBuilder &b, Location loc,
+                                         ValueRange args) {
+    SmallVector<Value> payloadArgs;
+    unsigned argIndex = 0;
+    for (auto [filledScalar, producer] : llvm::zip(filledScalars, producers)) {
+      if (filledScalar) {
+        payloadArgs.push_back(filledScalar);
+        continue;
+      }
+      Value arg = args[argIndex++];
+      payloadArgs.push_back(producer ? clonePayload(b, producer, arg) : arg);
+    }
+    payloadArgs.append(args.begin() + argIndex, args.end());
+    bodyBuild(b, loc, payloadArgs);
+  };
+
   SmallVector<utils::IteratorType> iteratorTypes(resultRank,
                                                  utils::IteratorType::parallel);
   // Add the indexing map for the outs init tensor.
-  indexingMaps.push_back(b.getMultiDimIdentityMap(resultRank));
+  genericIndexingMaps.push_back(b.getMultiDimIdentityMap(resultRank));
 
   Value initTensor = b.create<tensor::EmptyOp>(
       loc, getAsOpFoldResult(resultShape), resultElementType);
   return b
-      .create<linalg::GenericOp>(loc,
-                                 /*resultTensorTypes=*/initTensor.getType(),
-                                 /*inputs=*/tensorOperands,
-                                 /*outputs=*/initTensor, indexingMaps,
-                                 iteratorTypes, bodyBuild)
+      .create<linalg::GenericOp>(
+          loc, /*resultTensorTypes=*/initTensor.getType(), inputs,
+          /*outputs=*/initTensor, genericIndexingMaps, iteratorTypes,
+          bodyBuildWithFoldedOperands)
       .getResult(0);
 }
 
@@ -412,3 +542,47 @@ Value torch_to_linalg::removeSizeInformation(OpBuilder &b, Location loc,
   return b.create<tensor::CastOp>(
       loc, tensorType.clone(makeShapeLLVMCompatible(unknownSizes)), tensor);
 }
+
+LogicalResult torch_to_linalg::getPerTensorQuantizationParams(
+    OpBuilder &b, Location loc, TypeConverter *converter, Value quantized,
+    Value &scale, Value &zeroPoint) {
+  Value torchScale, torchZeroPoint;
+  if (auto create = quantized.getDefiningOp<PerTensorAffineCreateOp>()) {
+    torchScale = create.getScale();
+    torchZeroPoint = create.getOffset();
+  } else if (auto quantize =
+                 quantized.getDefiningOp<AtenQuantizePerTensorOp>()) {
+    torchScale = quantize.getScale();
+    torchZeroPoint = quantize.getZeroPoint();
+  } else {
+    return failure();
+  }
+  scale = converter->materializeTargetConversion(b, loc, b.getF64Type(),
+                                                 torchScale);
+  zeroPoint = converter->materializeTargetConversion(
+      b, loc, b.getIntegerType(64), torchZeroPoint);
+  return success(scale && zeroPoint);
+}
+
+LogicalResult torch_to_linalg::getPerChannelQuantizationParams(
+    OpBuilder &b, Location loc, TypeConverter *converter, Value quantized,
+    Value &scales, Value &zeroPoints, int64_t &axis) {
+  auto create = quantized.getDefiningOp<PerChannelAffineCreateOp>();
+  auto type = quantized.getType().cast<BaseTensorType>();
+  if (!create || !type.hasSizes() ||
+      !matchPattern(create.getAxis(), m_TorchConstantInt(&axis)))
+    return failure();
+  int64_t rank = type.getSizes().size();
+  axis = toPositiveDim(axis, rank);
+  if (!isValidDim(axis, rank))
+    return failure();
+  auto materialize = [&](Value v) -> Value {
+    Type type = converter->convertType(v.getType());
+    if (!type || !type.isa<RankedTensorType>())
+      return nullptr;
+    return converter->materializeTargetConversion(b, loc, type, v);
+  };
+  scales = materialize(create.getScales());
+  zeroPoints = materialize(create.getZeroPoints());
+  return success(scales && zeroPoints);
+}
@@ -7,12 +7,22 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Transforms/DialectConversion.h"
 
 namespace mlir {
 namespace torch {
 namespace torch_to_linalg {
 
+// Adds an instance of the pattern `PatternTy` for each of `OpTys`, rooted on
+// that op, so that the conversion driver only tries it on these ops instead of
+// on every op, as it does for `MatchAnyOpTypeTag` patterns. `PatternTy` is
+// constructed with the name of its root op followed by `args`.
+template <typename PatternTy, typename... OpTys, typename... Args>
+void addPatternForEachOp(RewritePatternSet &patterns, Args &&...args) {
+  (patterns.add<PatternTy>(OpTys::getOperationName(), args...), ...);
+}
+
 struct ReductionOpInfo {
   bool keepDim;
   Value tensorOperand;
@@ -66,12 +76,30 @@ Value createReductionLinalgGeneric(
     function_ref<void(OpBuilder &, Location, ValueRange)> bodyBuild);
 
 // Create a pointwise operation that uses values in `tensorOperands`, such that
-// the element type of the resulting tensor is `resultElementType`.
+// the element type of the resulting tensor is `resultElementType`. No runtime
+// check is emitted for the dynamic sizes that `areDimSizesEqual` proves equal.
+// The operands produced by a `linalg.fill` are not inputs of the generic op:
+// `bodyBuild` is passed their scalar instead of a block argument. Those
+// produced by a `getBroadcastOrCastProducer` op are read from its input, and
+// converted in the payload.
 Value createElementwiseLinalgGeneric(
     OpBuilder &b, Location loc, ValueRange tensorOperands,
     Type resultElementType,
     function_ref<void(OpBuilder &, Location, ValueRange)> bodyBuild);
 
+// Returns the `linalg.generic` producing `tensor`, possibly cast to a more
+// static shape, if it reads a single tensor through a broadcasting indexing
+// map and only converts its elements, like the lowerings of
+// `aten.broadcast_to` and `aten.to.dtype`. Its consumers can read that tensor
+// instead.
+linalg::GenericOp getBroadcastOrCastProducer(Value tensor);
+
+// Returns the tensor that `tensor` is a copy of with its last two dims
+// swapped, possibly cast to a more static shape, if it is produced by a
+// `linalg.generic` doing only that, like the lowerings of `aten.transpose.int`
+// and `aten.permute`. Returns null otherwise.
+Value getTransposeSource(Value tensor);
+
 // Broadcasts input tensor based on the broadcastToShape.
 LogicalResult broadcastToGivenShape(Operation *op, PatternRewriter &rewriter,
                                     Value input,
@@ -81,6 +109,25 @@ LogicalResult broadcastToGivenShape(Operation *op, PatternRewriter &rewriter,
 // Cast a tensor to a rank-equivalent tensor of unknown size, i.e. <1x2xf32> ->
 // <?x?xf32>
 Value removeSizeInformation(OpBuilder &b, Location loc, Value tensor);
+
+// Gets the scale, as an f64, and the zero point, as an i64, of the per-tensor
+// affine quantized tensor `quantized`, from the
+// `torch.per_tensor_affine.create` or `aten.quantize_per_tensor` op that
+// produces it.
+LogicalResult getPerTensorQuantizationParams(OpBuilder &b, Location loc,
+                                             TypeConverter *converter,
+                                             Value quantized, Value &scale,
+                                             Value &zeroPoint);
+
+// Gets the scales, as a tensor of floats, the zero points, as a tensor of
+// integers, and the non-negative axis of the per-channel affine quantized
+// tensor `quantized`, from the `torch.per_channel_affine.create` op that
+// produces it.
+LogicalResult getPerChannelQuantizationParams(OpBuilder &b, Location loc,
+                                              TypeConverter *converter,
+                                              Value quantized, Value &scales,
+                                              Value &zeroPoints,
+                                              int64_t &axis);
 } // namespace torch_to_linalg
 } // namespace torch
 } // namespace mlir
@@ -12,12 +12,14 @@
 #include "../PassDetail.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchTypes.h"
 #include "torch-mlir/Dialect/TorchConversion/IR/TorchConversionDialect.h"
+#include "torch-mlir/Dialect/TorchConversion/IR/TorchConversionOps.h"
 #include "torch-mlir/Dialect/TorchConversion/Transforms/BackendTypeConversion.h"
 
 using namespace mlir;
@@ -64,6 +66,73 @@ public:
 };
 } // namespace
 
+// Returns the most static type known for the tensor `value`, looking through
+// the casts that only change the static information of its type.
+static RankedTensorType getMostStaticTensorType(Value value) {
+  while (Operation *producer = value.getDefiningOp()) {
+    if (!isa<tensor::CastOp, TensorStaticInfoCastOp,
+             TorchConversion::FromBuiltinTensorOp,
+             TorchConversion::ToBuiltinTensorOp>(producer))
+      break;
+    value = producer->getOperand(0);
+  }
+  if (auto tensorType = value.getType().dyn_cast<ValueTensorType>())
+    return tensorType.toBuiltinTensor().dyn_cast_or_null<RankedTensorType>();
+  return value.getType().dyn_cast<RankedTensorType>();
+}
+
+// Returns the type of the builtin tensor carried by a loop in place of the
+// converted loop type `type`, given the initial value of the iter arg and the
+// value yielded by the body. A dim that the torch type doesn't know is static
+// when it is the same in both: each iteration starts from one of them, and
+// the type of the yielded value holds for any input of the loop type, so it
+// also holds for an input of the more static type.
+static Type getCarriedType(Type type, Value init, Value yielded) {
+  auto tensorType = type.dyn_cast<RankedTensorType>();
+  if (!tensorType)
+    return type;
+  RankedTensorType initType = getMostStaticTensorType(init);
+  RankedTensorType yieldedType = getMostStaticTensorType(yielded);
+  if (!initType || !yieldedType ||
+      initType.getElementType() != tensorType.getElementType() ||
+      yieldedType.getElementType() != tensorType.getElementType() ||
+      initType.getRank() != tensorType.getRank() ||
+      yieldedType.getRank() != tensorType.getRank())
+    return type;
+  SmallVector<int64_t> shape;
+  for (auto [size, initSize, yieldedSize] : llvm::zip(
+           tensorType.getShape(), initType.getShape(), yieldedType.getShape()))
+    shape.push_back(ShapedType::isDynamic(size) && initSize == yieldedSize
+                        ? initSize
+                        : size);
+  return tensorType.clone(shape);
+}
+
+static SmallVector<Type> getCarriedTypes(PrimLoopOp op, ValueRange iterArgsInit,
+                                         TypeRange resultTypes) {
+  auto condition =
+      cast<PrimLoopConditionOp>(op.getRegion().front().getTerminator());
+  SmallVector<Type> carriedTypes;
+  for (auto [type, init, yielded] :
+       llvm::zip(resultTypes, iterArgsInit, condition.getIterArgs()))
+    carriedTypes.push_back(getCarriedType(type, init, yielded));
+  return carriedTypes;
+}
+
+static Value castToType(OpBuilder &b, Location loc, Value value, Type type) {
+  if (value.getType() == type)
+    return value;
+  return b.create<tensor::CastOp>(loc, type, value);
+}
+
+static SmallVector<Value> castToTypes(OpBuilder &b, Location loc,
+                                      ValueRange values, TypeRange types) {
+  SmallVector<Value> castValues;
+  for (auto [value, type] : llvm::zip(values, types))
+    castValues.push_back(castToType(b, loc, value, type));
+  return castValues;
+}
+
 namespace {
 
 // Converts the Torch::PrimLoopOp which is ``While-like`` into scf::WhileOp.
@@ -87,12 +156,17 @@ public:
     // Create scf.while operation using the operands of torch::primloop. The
     // first argument of the primloop correspond to `maxTripCount`  which
     // can be omitted in the `scf.while` operation.
+    // The carried tensors may be more static than the results of the loop.
     Value condition = adaptor.getInitialCondition();
     ValueRange iterArgsInit = adaptor.getIterArgsInit();
+    SmallVector<Type> carriedTypes =
+        getCarriedTypes(op, iterArgsInit, newResultTypes);
     SmallVector<Value> scfWhileOpOperands{condition};
-    scfWhileOpOperands.append(iterArgsInit.begin(), iterArgsInit.end());
+    llvm::append_range(scfWhileOpOperands,
+                       castToTypes(rewriter, op.getLoc(), iterArgsInit,
+                                   carriedTypes));
     auto scfWhileOp = rewriter.create<scf::WhileOp>(
-        op->getLoc(), newResultTypes, scfWhileOpOperands);
+        op->getLoc(), carriedTypes, scfWhileOpOperands);
 
     // Populate the before region of the scf.while operation. The `before`
     // region will have only one block and the arguments of the block must match
@@ -152,6 +226,11 @@ public:
           targetType = Torch::IntType::get(op->getContext());
         torchArg = typeConverter->materializeSourceConversion(
             rewriter, scfWhileOp.getLoc(), targetType, {to});
+      } else if (targetType.isa<mlir::TensorType>()) {
+        to = castToType(rewriter, scfWhileOp.getLoc(), to,
+                        newResultTypes[barg.index()]);
+        torchArg = typeConverter->materializeSourceConversion(
+            rewriter, scfWhileOp.getLoc(), barg.value().getType(), {to});
       }
       if (!torchArg)
         return rewriter.notifyMatchFailure(op,
@@ -174,12 +253,13 @@ public:
           return rewriter.notifyMatchFailure(op,
                                              "unsupported type of the operand");
         loopConditionIterArgs.push_back(shouldContinue);
-        for (auto torchArg : primLoopConditionOp.getIterArgs()) {
+        for (auto [torchArg, carriedType] :
+             llvm::zip(primLoopConditionOp.getIterArgs(), carriedTypes)) {
           Type torchType = torchArg.getType();
 
-          // If the argument is a torch tensor, directly add it in the list of
-          // iter args.
-          if (torchType.isa<Torch::BaseTensorType>()) {
+          // If the argument is a non-value tensor, directly add it in the list
+          // of iter args.
+          if (torchType.isa<Torch::NonValueTensorType>()) {
             loopConditionIterArgs.push_back(torchArg);
             continue;
           }
@@ -189,6 +269,8 @@ public:
           if (!arg)
             return rewriter.notifyMatchFailure(
                 op, "unsupported type of the operand");
+          if (arg.getType().isa<mlir::TensorType>())
+            arg = castToType(rewriter, scfWhileOp->getLoc(), arg, carriedType);
           loopConditionIterArgs.push_back(arg);
         }
         rewriter.create<scf::YieldOp>(scfWhileOp.getLoc(),
@@ -198,7 +280,10 @@ public:
         operation.moveBefore(afterBlock, afterBlock->end());
       }
     }
-    rewriter.replaceOp(op, scfWhileOp->getResults());
+    rewriter.setInsertionPointAfter(scfWhileOp);
+    rewriter.replaceOp(op, castToTypes(rewriter, op.getLoc(),
+                                       scfWhileOp->getResults(),
+                                       newResultTypes));
     return success();
   }
 };
@@ -231,9 +316,12 @@ public:
     Value stepIndex = rewriter.create<arith::ConstantIndexOp>(loc, 1);
     Value upperBoundIndex = rewriter.create<arith::IndexCastOp>(
         loc, rewriter.getIndexType(), adaptor.getMaxTripCount());
-    auto scfForOp =
-        rewriter.create<scf::ForOp>(loc, lowerBoundIndex, upperBoundIndex,
-                                    stepIndex, adaptor.getIterArgsInit());
+    // The carried tensors may be more static than the results of the loop.
+    SmallVector<Type> carriedTypes =
+        getCarriedTypes(op, adaptor.getIterArgsInit(), newResultTypes);
+    auto scfForOp = rewriter.create<scf::ForOp>(
+        loc, lowerBoundIndex, upperBoundIndex, stepIndex,
+        castToTypes(rewriter, loc, adaptor.getIterArgsInit(), carriedTypes));
 
     SmallVector<Type> regionArgTypes;
     SmallVector<Location> regionArgLocs;
@@ -274,6 +362,12 @@ public:
           targetType = Torch::IntType::get(op->getContext());
         torchArg = typeConverter->materializeSourceConversion(
             rewriter, scfForOp.getLoc(), targetType, {to});
+      } else if (targetType.isa<mlir::TensorType>()) {
+        // The first argument is the induction variable.
+        to = castToType(rewriter, scfForOp.getLoc(), to,
+                        newResultTypes[barg.index() - 1]);
+        torchArg = typeConverter->materializeSourceConversion(
+            rewriter, scfForOp.getLoc(), barg.value().getType(), {to});
       }
       if (!torchArg)
         return rewriter.notifyMatchFailure(op,
@@ -288,12 +382,13 @@ public:
       if (auto primLoopConditionOp = dyn_cast<PrimLoopConditionOp>(operation)) {
         // Fix up the terminator.
         SmallVector<Value> loopConditionIterArgs;
-        for (auto torchArg : primLoopConditionOp.getIterArgs()) {
+        for (auto [torchArg, carriedType] :
+             llvm::zip(primLoopConditionOp.getIterArgs(), carriedTypes)) {
           Type torchType = torchArg.getType();
 
-          // If the argument is a torch tensor, directly add it in the list of
-          // iter args.
-          if (torchType.isa<Torch::BaseTensorType>()) {
+          // If the argument is a non-value tensor, directly add it in the list
+          // of iter args.
+          if (torchType.isa<Torch::NonValueTensorType>()) {
             loopConditionIterArgs.push_back(torchArg);
             continue;
           }
@@ -303,6 +398,8 @@ public:
           if (!arg)
             return rewriter.notifyMatchFailure(
                 op, "unsupported type of the operand");
+          if (arg.getType().isa<mlir::TensorType>())
+            arg = castToType(rewriter, scfForOp.getLoc(), arg, carriedType);
           loopConditionIterArgs.push_back(arg);
         }
         rewriter.create<scf::YieldOp>(scfForOp.getLoc(), loopConditionIterArgs);
@@ -311,7 +408,9 @@ public:
       }
     }
 
-    rewriter.replaceOp(op, scfForOp->getResults());
+    rewriter.setInsertionPointAfter(scfForOp);
+    rewriter.replaceOp(op, castToTypes(rewriter, loc, scfForOp->getResults(),
+                                       newResultTypes));
     return success();
   }
 };
@@ -321,7 +420,8 @@ namespace {
 class ConvertTorchToSCF : public ConvertTorchToSCFBase<ConvertTorchToSCF> {
 public:
   void getDependentDialects(DialectRegistry &registry) const override {
-    registry.insert<scf::SCFDialect, arith::ArithDialect>();
+    registry.insert<scf::SCFDialect, arith::ArithDialect,
+                    tensor::TensorDialect>();
     TorchConversion::getBackendTypeConversionDependentDialects(registry);
   }
 
@@ -329,7 +429,7 @@ public:
     MLIRContext *context = &getContext();
     ConversionTarget target(*context);
     target.addLegalDialect<Torch::TorchDialect, scf::SCFDialect,
-                           arith::ArithDialect>();
+                           arith::ArithDialect, tensor::TensorDialect>();
 
     TypeConverter typeConverter;
     typeConverter.addConversion([](Type type) { return type; });
@@ -0,0 +1,196 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "torch-mlir/Conversion/TorchToStablehlo/TorchToStablehlo.h"
+
+#include "../PassDetail.h"
+#include "PopulatePatterns.h"
+
+#include "stablehlo/dialect/ChloOps.h"
+#include "stablehlo/dialect/StablehloOps.h"
+#include "torch-mlir/Conversion/Utils/Utils.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+#include "torch-mlir/Dialect/TorchConversion/IR/TorchConversionOps.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+using namespace mlir::torch::torch_to_stablehlo;
+
+// The `c10d_functional` collectives run over the ranks of the groups of
+// `group_size` consecutive elements of `ranks`. These are lowered to the
+// replica groups of the StableHLO collectives, i.e. ranks are replica ids.
+static FailureOr<DenseIntElementsAttr>
+getReplicaGroups(Operation *op, Value ranks, Value groupSize,
+                 ConversionPatternRewriter &rewriter) {
+  SmallVector<int64_t> rankValues;
+  if (!matchPattern(ranks, m_TorchListOfConstantInts(rankValues)))
+    return rewriter.notifyMatchFailure(op, "only constant ranks are supported");
+  int64_t groupSizeValue;
+  if (!matchPattern(groupSize, m_TorchConstantInt(&groupSizeValue)))
+    return rewriter.notifyMatchFailure(
+        op, "only a constant group size is supported");
+  if (groupSizeValue <= 0 || rankValues.size() % groupSizeValue != 0)
+    return rewriter.notifyMatchFailure(
+        op, "the number of ranks must be a multiple of the group size");
+  auto type = RankedTensorType::get(
+      {static_cast<int64_t>(rankValues.size()) / groupSizeValue,
+       groupSizeValue},
+      rewriter.getI64Type());
+  return DenseIntElementsAttr::get(type, rankValues);
+}
+
+static bool isSupportedReduction(StringRef reduceOp) {
+  return llvm::any_of(
+      ArrayRef<StringRef>{"sum", "avg", "product", "min", "max"},
+      [&](StringRef kind) { return reduceOp.equals_insensitive(kind); });
+}
+
+// Creates the body of the reduction `reduceOp` of a collective in `region`.
+// An average is reduced as a sum, which is then divided by the group size.
+static void createReductionBody(Location loc, Region &region,
+                                StringRef reduceOp, Type elementType,
+                                ConversionPatternRewriter &rewriter) {
+  auto scalarType = RankedTensorType::get({}, elementType);
+  Block &block = region.emplaceBlock();
+  Value lhs = block.addArgument(scalarType, loc);
+  Value rhs = block.addArgument(scalarType, loc);
+
+  OpBuilder::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPointToStart(&block);
+  Value result;
+  if (reduceOp.equals_insensitive("product"))
+    result = rewriter.create<stablehlo::MulOp>(loc, lhs, rhs);
+  else if (reduceOp.equals_insensitive("min"))
+    result = rewriter.create<stablehlo::MinOp>(loc, lhs, rhs);
+  else if (reduceOp.equals_insensitive("max"))
+    result = rewriter.create<stablehlo::MaxOp>(loc, lhs, rhs);
+  else
+    result = rewriter.create<stablehlo::AddOp>(loc, lhs, rhs);
+  rewriter.create<stablehlo::ReturnOp>(loc, result);
+}
+
+// Lowers an all-reduce or reduce-scatter `op` to the `CollectiveOpT` that
+// `createCollective` creates from the result type and the replica groups.
+template <typename CollectiveOpT, typename OpT>
+static LogicalResult lowerReduction(
+    OpT op, Value ranks, Value groupSize, ConversionPatternRewriter &rewriter,
+    const TypeConverter *typeConverter,
+    function_ref<CollectiveOpT(RankedTensorType, DenseIntElementsAttr)>
+        createCollective) {
+  std::string reduceOp;
+  if (!matchPattern(op.getReduceOp(), m_TorchConstantStr(reduceOp)) ||
+      !isSupportedReduction(reduceOp))
+    return rewriter.notifyMatchFailure(
+        op, "only constant sum, avg, product, min and max reductions are "
+            "supported");
+  FailureOr<DenseIntElementsAttr> replicaGroups =
+      getReplicaGroups(op, ranks, groupSize, rewriter);
+  if (failed(replicaGroups))
+    return failure();
+  auto resultType =
+      typeConverter->convertType(op.getType()).cast<RankedTensorType>();
+  Type elementType = resultType.getElementType();
+
+  CollectiveOpT collective = createCollective(resultType, *replicaGroups);
+  createReductionBody(op.getLoc(), collective.getComputation(), reduceOp,
+                      elementType, rewriter);
+  Value result = collective.getResult();
+  if (StringRef(reduceOp).equals_insensitive("avg")) {
+    int64_t groupSizeValue;
+    matchPattern(groupSize, m_TorchConstantInt(&groupSizeValue));
+    Attribute divisor =
+        elementType.isa<mlir::FloatType>()
+            ? Attribute(rewriter.getFloatAttr(elementType, groupSizeValue))
+            : Attribute(rewriter.getIntegerAttr(elementType, groupSizeValue));
+    Value divisorTensor = rewriter.create<stablehlo::ConstantOp>(
+        op.getLoc(),
+        DenseElementsAttr::get(RankedTensorType::get({}, elementType),
+                               divisor));
+    DenseIntElementsAttr bcastDimensions;
+    result = rewriter.create<chlo::BroadcastDivOp>(
+        op.getLoc(), resultType, result, divisorTensor, bcastDimensions);
+  }
+  rewriter.replaceOp(op, result);
+  return success();
+}
+
+template <>
+LogicalResult ConvertAtenOp<C10dFunctionalAllReduceOp>::matchAndRewrite(
+    C10dFunctionalAllReduceOp op, OpAdaptor adaptor,
+    ConversionPatternRewriter &rewriter) const {
+  return lowerReduction<stablehlo::AllReduceOp>(
+      op, op.getRanks(), op.getGroupSize(), rewriter, getTypeConverter(),
+      [&](RankedTensorType resultType, DenseIntElementsAttr replicaGroups) {
+        return rewriter.create<stablehlo::AllReduceOp>(
+            op.getLoc(), resultType, adaptor.getSelf(), replicaGroups,
+            /*channel_handle=*/stablehlo::ChannelHandleAttr(),
+            /*use_global_device_ids=*/false);
+      });
+}
+
+template <>
+LogicalResult
+ConvertAtenOp<C10dFunctionalReduceScatterTensorOp>::matchAndRewrite(
+    C10dFunctionalReduceScatterTensorOp op, OpAdaptor adaptor,
+    ConversionPatternRewriter &rewriter) const {
+  return lowerReduction<stablehlo::ReduceScatterOp>(
+      op, op.getRanks(), op.getGroupSize(), rewriter, getTypeConverter(),
+      [&](RankedTensorType resultType, DenseIntElementsAttr replicaGroups) {
+        return rewriter.create<stablehlo::ReduceScatterOp>(
+            op.getLoc(), resultType, adaptor.getInput(),
+            /*scatter_dimension=*/0, replicaGroups,
+            /*channel_handle=*/stablehlo::ChannelHandleAttr(),
+            /*use_global_device_ids=*/false);
+      });
+}
+
+template <>
+LogicalResult
+ConvertAtenOp<C10dFunctionalAllGatherIntoTensorOp>::matchAndRewrite(
+    C10dFunctionalAllGatherIntoTensorOp op, OpAdaptor adaptor,
+    ConversionPatternRewriter &rewriter) const {
+  FailureOr<DenseIntElementsAttr> replicaGroups =
+      getReplicaGroups(op, op.getRanks(), op.getGroupSize(), rewriter);
+  if (failed(replicaGroups))
+    return failure();
+  auto resultType =
+      getTypeConverter()->convertType(op.getType()).cast<RankedTensorType>();
+  rewriter.replaceOpWithNewOp<stablehlo::AllGatherOp>(
+      op, resultType, adaptor.getShard(), /*all_gather_dim=*/0, *replicaGroups,
+      /*channel_handle=*/stablehlo::ChannelHandleAttr(),
+      /*use_global_device_ids=*/false);
+  return success();
+}
+
+// The StableHLO collectives are synchronous, so waiting on their results is a
+// no-op.
+template <>
+LogicalResult ConvertAtenOp<C10dFunctionalWaitTensorOp>::matchAndRewrite(
+    C10dFunctionalWaitTensorOp op, OpAdaptor adaptor,
+    ConversionPatternRewriter &rewriter) const {
+  rewriter.replaceOp(op, adaptor.getSelf());
+  return success();
+}
+
+void mlir::torch::torch_to_stablehlo::populateCollectiveOpPatternsAndLegality(
+    TypeConverter &typeConverter, RewritePatternSet &patterns,
+    ConversionTarget &target, const TorchToStablehloOptions &options) {
+  MLIRContext *context = patterns.getContext();
+#define INSERT_COLLECTIVE_PATTERN(OpT)                                         \
+  target.addIllegalOp<OpT>();                                                  \
+  patterns.add<ConvertAtenOp<OpT>>(typeConverter, context, options)
+  INSERT_COLLECTIVE_PATTERN(C10dFunctionalAllReduceOp);
+  INSERT_COLLECTIVE_PATTERN(C10dFunctionalAllGatherIntoTensorOp);
+  INSERT_COLLECTIVE_PATTERN(C10dFunctionalReduceScatterTensorOp);
+  INSERT_COLLECTIVE_PATTERN(C10dFunctionalWaitTensorOp);
+#undef INSERT_COLLECTIVE_PATTERN
+}
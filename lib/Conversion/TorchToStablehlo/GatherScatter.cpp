@@ -29,9 +29,41 @@ using namespace mlir::torch::Torch;
 using namespace mlir::torch::torch_to_stablehlo;
 
 namespace {
+// Returns whether the torch tensor `indices` is known to be in ascending order
+// along `dim`, which lets the gathers using it set `indices_are_sorted`.
+bool areIndicesSortedAlong(Value indices, int64_t dim) {
+  auto indicesTy = indices.getType().dyn_cast<BaseTensorType>();
+  if (!indicesTy || !indicesTy.hasSizes())
+    return false;
+  int64_t rank = indicesTy.getSizes().size();
+  Operation *producer = indices.getDefiningOp();
+  if (!producer)
+    return false;
+  if (isa<AtenArangeOp, AtenArangeStartOp>(producer))
+    return dim == 0;
+  if (auto arange = dyn_cast<AtenArangeStartStepOp>(producer)) {
+    int64_t step;
+    return dim == 0 &&
+           matchPattern(arange.getStep(), m_TorchConstantInt(&step)) &&
+           step > 0;
+  }
+  if (auto sort = dyn_cast<AtenSortOp>(producer)) {
+    int64_t sortDim;
+    bool descending;
+    return indices == sort.getValues() &&
+           matchPattern(sort.getDim(), m_TorchConstantInt(&sortDim)) &&
+           toPositiveDim(sortDim, rank) == dim &&
+           matchPattern(sort.getDescending(),
+                        m_TorchConstantBool(&descending)) &&
+           !descending;
+  }
+  return false;
+}
+
 Value gatherTensorAlongSingleAxis(PatternRewriter &rewriter, Operation *op,
                                   Value input, Value indices, int64_t axis,
-                                  size_t dimSizeIndexBits) {
+                                  size_t dimSizeIndexBits,
+                                  bool indicesAreSorted = false) {
   auto loc = op->getLoc();
   Type intType = rewriter.getIntegerType(dimSizeIndexBits);
   Value one = rewriter.create<arith::ConstantOp>(
@@ -92,10 +124,10 @@ Value gatherTensorAlongSingleAxis(PatternRewriter &rewriter, Operation *op,
   // create output tensor type
   auto outputTy =
       RankedTensorType::get(outputShape, inputRankTy.getElementType());
-  return rewriter
-      .create<stablehlo::DynamicGatherOp>(loc, outputTy, input, indices,
-                                          sliceSizesTensor, dimsAttr)
-      .getResult();
+  auto gather = rewriter.create<stablehlo::DynamicGatherOp>(
+      loc, outputTy, input, indices, sliceSizesTensor, dimsAttr);
+  gather.setIndicesAreSortedAttr(rewriter.getBoolAttr(indicesAreSorted));
+  return gather.getResult();
 }
 
 template <typename OpTy, typename OpAdaptor>
@@ -209,8 +241,12 @@ LogicalResult ConvertAtenOp<AtenEmbeddingOp>::matchAndRewrite(
     return rewriter.notifyMatchFailure(
         op, "sparse gradients is currently not supported");
 
+  bool indicesAreSorted =
+      adaptor.getIndices().getType().cast<RankedTensorType>().getRank() == 1 &&
+      areIndicesSortedAlong(op.getIndices(), 0);
   Value output = gatherTensorAlongSingleAxis(
-      rewriter, op, weight, adaptor.getIndices(), 0, options.dimSizeIndexBits);
+      rewriter, op, weight, adaptor.getIndices(), 0, options.dimSizeIndexBits,
+      indicesAreSorted);
   rewriter.replaceOpWithNewOp<stablehlo::ConvertOp>(
       op, getTypeConverter()->convertType(op.getType()), output);
 
@@ -234,8 +270,12 @@ LogicalResult ConvertAtenOp<AtenIndexSelectOp>::matchAndRewrite(
   if (!isValidDim(dim, inputRank))
     return rewriter.notifyMatchFailure(op, "dim is statically invalid");
 
-  Value output = gatherTensorAlongSingleAxis(
-      rewriter, op, self, adaptor.getIndex(), dim, options.dimSizeIndexBits);
+  bool indicesAreSorted =
+      adaptor.getIndex().getType().cast<RankedTensorType>().getRank() == 1 &&
+      areIndicesSortedAlong(op.getIndex(), 0);
+  Value output =
+      gatherTensorAlongSingleAxis(rewriter, op, self, adaptor.getIndex(), dim,
+                                  options.dimSizeIndexBits, indicesAreSorted);
 
   rewriter.replaceOpWithNewOp<stablehlo::ConvertOp>(
       op, getTypeConverter()->convertType(op.getType()), output);
@@ -326,9 +366,14 @@ LogicalResult ConvertAtenOp<AtenGatherOp>::matchAndRewrite(
       /*startIndexMap=*/startIndexMap,
       /*indexVecDim=*/indexVecDim);
 
-  rewriter.replaceOpWithNewOp<stablehlo::GatherOp>(
+  // The index tuples are built in row-major order from iotas along all the
+  // other dims, so they are sorted when `index` is sorted along the last one.
+  auto gather = rewriter.replaceOpWithNewOp<stablehlo::GatherOp>(
       op, input, gatherIndicies, dimsAttr,
       rewriter.getI64TensorAttr(sliceSizes));
+  if (dim == inputType.getRank() - 1 &&
+      areIndicesSortedAlong(op.getIndex(), dim))
+    gather.setIndicesAreSortedAttr(rewriter.getBoolAttr(true));
   return success();
 }
 
@@ -523,9 +568,12 @@ LogicalResult ConvertAtenOp<AtenIndexTensorOp>::matchAndRewrite(
     }
   }
 
-  rewriter.replaceOpWithNewOp<stablehlo::GatherOp>(
+  auto gather = rewriter.replaceOpWithNewOp<stablehlo::GatherOp>(
       op, resultType, input, finalIndexTensor, dimsAttr,
       rewriter.getI64TensorAttr(sliceSizes));
+  if (numIndicesDim == 1 && indicesRank == 1 &&
+      areIndicesSortedAlong(indicesTorchType[0], 0))
+    gather.setIndicesAreSortedAttr(rewriter.getBoolAttr(true));
   return success();
 }
 
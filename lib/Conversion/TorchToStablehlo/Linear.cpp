@@ -29,12 +29,31 @@ using namespace mlir::torch::Torch;
 using namespace mlir::torch::torch_to_stablehlo;
 
 namespace {
+// Returns the element type in which a matmul with operands of `elementType`
+// accumulates: f32 for FP8 operands, which are too coarse to accumulate in,
+// and `elementType` otherwise.
+Type getAccumulatorElementType(Type elementType) {
+  if (elementType.isFloat8E5M2() || elementType.isFloat8E4M3FN())
+    return Float32Type::get(elementType.getContext());
+  return elementType;
+}
+
+// Converts `accumulator`, the result of a matmul, to `elementType` if it was
+// accumulated in a wider type.
+Value truncateAccumulator(PatternRewriter &rewriter, Operation *op,
+                          Value accumulator, Type elementType) {
+  if (accumulator.getType().cast<RankedTensorType>().getElementType() ==
+      elementType)
+    return accumulator;
+  return rewriter.create<stablehlo::ConvertOp>(op->getLoc(), accumulator,
+                                               elementType);
+}
+
 Value getBroadcastTensor(PatternRewriter &rewriter, Operation *op, Value tensor,
                          ArrayRef<int64_t> shape, ArrayRef<Value> dimSizes,
                          ArrayRef<int64_t> broadcastDims) {
   auto tensorTy = tensor.getType().dyn_cast<RankedTensorType>();
   auto loc = op->getLoc();
-  Value stablehloShape = rewriter.create<tensor::FromElementsOp>(loc, dimSizes);
 
   RankedTensorType outTy =
       RankedTensorType::get(shape, tensorTy.getElementType());
@@ -43,6 +62,11 @@ Value getBroadcastTensor(PatternRewriter &rewriter, Operation *op, Value tensor,
       RankedTensorType::get({static_cast<int64_t>(broadcastDims.size())},
                             rewriter.getIntegerType(64));
   auto broadcastAttr = DenseIntElementsAttr::get(attrTy, broadcastDims);
+  if (outTy.hasStaticShape())
+    return rewriter.create<stablehlo::BroadcastInDimOp>(loc, outTy, tensor,
+                                                        broadcastAttr);
+
+  Value stablehloShape = rewriter.create<tensor::FromElementsOp>(loc, dimSizes);
 
   auto broadcast = rewriter.create<stablehlo::DynamicBroadcastInDimOp>(
       loc, outTy, tensor, stablehloShape, broadcastAttr);
@@ -72,20 +96,16 @@ Value getPermutedTensor(PatternRewriter &rewriter, Operation *op, Value input,
   return result.getResult();
 }
 
-RankedTensorType castContractingDim(PatternRewriter &rewriter, Operation *op,
-                                    Value &lhs, Value &rhs,
-                                    int64_t lhsResultDim, int64_t rhsResultDim,
-                                    int64_t lhsContractingDim,
-                                    int64_t rhsContractingDim) {
+// Refines a dynamic contracting dimension of `lhs` or `rhs` to the static size
+// of the contracting dimension of the other one.
+void castContractingDimSize(PatternRewriter &rewriter, Operation *op,
+                            Value &lhs, Value &rhs, int64_t lhsContractingDim,
+                            int64_t rhsContractingDim) {
   auto lhsTy = lhs.getType().dyn_cast<RankedTensorType>();
   auto rhsTy = rhs.getType().dyn_cast<RankedTensorType>();
 
-  auto oldLhsShape = lhsTy.getShape();
-  auto oldRhsShape = rhsTy.getShape();
-  SmallVector<int64_t> lhsShape;
-  SmallVector<int64_t> rhsShape;
-  lhsShape.append(oldLhsShape.begin(), oldLhsShape.end());
-  rhsShape.append(oldRhsShape.begin(), oldRhsShape.end());
+  SmallVector<int64_t> lhsShape(lhsTy.getShape());
+  SmallVector<int64_t> rhsShape(rhsTy.getShape());
   auto lhsContractingDimSize = lhsShape[lhsContractingDim];
   auto rhsContractingDimSize = rhsShape[rhsContractingDim];
   if (lhsContractingDimSize != rhsContractingDimSize) {
@@ -101,6 +121,18 @@ RankedTensorType castContractingDim(PatternRewriter &rewriter, Operation *op,
       rhs = rewriter.create<tensor::CastOp>(op->getLoc(), newRankTy, rhs);
     }
   }
+}
+
+RankedTensorType castContractingDim(PatternRewriter &rewriter, Operation *op,
+                                    Value &lhs, Value &rhs,
+                                    int64_t lhsResultDim, int64_t rhsResultDim,
+                                    int64_t lhsContractingDim,
+                                    int64_t rhsContractingDim) {
+  castContractingDimSize(rewriter, op, lhs, rhs, lhsContractingDim,
+                         rhsContractingDim);
+  auto lhsTy = lhs.getType().cast<RankedTensorType>();
+  auto lhsShape = lhsTy.getShape();
+  auto rhsShape = rhs.getType().cast<RankedTensorType>().getShape();
   SmallVector<int64_t> outShape;
   // set batch dims, will skip invalid dimensions
   for (int64_t k = 0; k < static_cast<int64_t>(lhsShape.size()); ++k) {
@@ -180,6 +212,55 @@ void getBmmBroadcast(PatternRewriter &rewriter, Operation *op, Value &inpLhs,
   inpRhs = rhs;
 }
 
+// Multiplies `lhs` and `rhs`, one of which is a vector or a matrix and the
+// other a batch of matrices, with a dot_general without batching dimensions,
+// so that the vector or matrix operand is not broadcast over the batch:
+//
+//   [B, H, N, d] x [d, M] -> [B, H, N, M]
+//   [N, d] x [B, d, M] -> [N, B, M] -> transpose -> [B, N, M]
+Value getUnbatchedDotGeneral(PatternRewriter &rewriter, Operation *op,
+                             Value lhs, Value rhs) {
+  auto lhsRank = lhs.getType().cast<RankedTensorType>().getRank();
+  auto rhsRank = rhs.getType().cast<RankedTensorType>().getRank();
+  int64_t lhsContractingDim = lhsRank - 1;
+  int64_t rhsContractingDim = rhsRank == 1 ? 0 : rhsRank - 2;
+  castContractingDimSize(rewriter, op, lhs, rhs, lhsContractingDim,
+                         rhsContractingDim);
+
+  auto lhsTy = lhs.getType().cast<RankedTensorType>();
+  auto rhsTy = rhs.getType().cast<RankedTensorType>();
+  SmallVector<int64_t> outShape;
+  for (int64_t k = 0; k < lhsRank; ++k)
+    if (k != lhsContractingDim)
+      outShape.push_back(lhsTy.getDimSize(k));
+  for (int64_t k = 0; k < rhsRank; ++k)
+    if (k != rhsContractingDim)
+      outShape.push_back(rhsTy.getDimSize(k));
+
+  stablehlo::DotDimensionNumbersAttr dotDimensionNumbers =
+      stablehlo::DotDimensionNumbersAttr::get(
+          rewriter.getContext(),
+          /*lhsBatchingDimensions=*/{},
+          /*rhsBatchingDimensions=*/{},
+          /*lhsContractingDimensions=*/{lhsContractingDim},
+          /*rhsContractingDimensions=*/{rhsContractingDim});
+  Value output = rewriter.create<stablehlo::DotGeneralOp>(
+      op->getLoc(),
+      RankedTensorType::get(outShape,
+                            getAccumulatorElementType(lhsTy.getElementType())),
+      lhs, rhs, dotDimensionNumbers, nullptr);
+  if (lhsRank == 1 || rhsRank <= 2)
+    return output;
+
+  // The rows of the lhs come first in the result, move them after the batch
+  // dimensions of the rhs.
+  SmallVector<int64_t> permutation =
+      llvm::to_vector(llvm::seq<int64_t>(1, rhsRank - 1));
+  permutation.push_back(0);
+  permutation.push_back(rhsRank - 1);
+  return getPermutedTensor(rewriter, op, output, permutation);
+}
+
 // Perform the basic n-dim matmul operation encompassing the handling of
 // broadcasting and dynamic shape propagation.
 // All PyTorch ops that leverage matrix multiplication will derive this and
@@ -219,42 +300,43 @@ public:
     }
 
     if (lhsRank <= 2 && rhsRank <= 2) {
-      auto tensorType =
-          ConvertAtenOp<AtenOpT>::getTypeConverter()->convertType(op.getType());
-      output = rewriter.create<stablehlo::DotOp>(op->getLoc(), tensorType, lhs,
-                                                 rhs, nullptr);
+      auto tensorType = ConvertAtenOp<AtenOpT>::getTypeConverter()
+                            ->convertType(op.getType())
+                            .template cast<RankedTensorType>();
+      output = rewriter.create<stablehlo::DotOp>(
+          op->getLoc(), tensorType.clone(getAccumulatorElementType(lhsElemTy)),
+          lhs, rhs, nullptr);
+      return success();
+    }
+
+    if (lhsRank <= 2 || rhsRank <= 2) {
+      output = getUnbatchedDotGeneral(rewriter, op, lhs, rhs);
       return success();
     }
 
     const auto &options = ConvertAtenOp<AtenOpT>::getOptions();
-    int64_t nBatchDims;
-    if (rhsRank <= 2) {
-      auto leadingRank = lhsRank - 2;
-      getBmmBroadcast(rewriter, op, lhs, rhs, leadingRank,
-                      options.dimSizeIndexBits);
-      nBatchDims = leadingRank;
-    } else if (lhsRank <= 2) {
-      auto leadingRank = rhsRank - 2;
-      getBmmBroadcast(rewriter, op, lhs, rhs, leadingRank,
-                      options.dimSizeIndexBits);
-      nBatchDims = leadingRank;
-    } else {
-      assert(rhsRank > 2 && lhsRank > 2);
-      auto leadingRank = std::max(lhsRank - rhsRank, rhsRank - lhsRank);
-      nBatchDims = std::max(lhsRank - 2, rhsRank - 2);
+    assert(rhsRank > 2 && lhsRank > 2);
+    auto leadingRank = std::max(lhsRank - rhsRank, rhsRank - lhsRank);
+    int64_t nBatchDims = std::max(lhsRank - 2, rhsRank - 2);
+    // The batch dimensions of aten.bmm are equal, and so are those of operands
+    // of the same rank with the same static batch dimensions, so that there is
+    // nothing to broadcast.
+    bool sameBatchDims = std::is_same<AtenOpT, AtenBmmOp>();
+    if (!sameBatchDims && lhsRank == rhsRank) {
+      auto lhsBatchShape = lhsTy.getShape().take_front(nBatchDims);
+      auto rhsBatchShape = rhsTy.getShape().take_front(nBatchDims);
+      sameBatchDims = lhsBatchShape == rhsBatchShape &&
+                      !llvm::is_contained(lhsBatchShape, ShapedType::kDynamic);
+    }
+    if (!sameBatchDims)
       getBmmBroadcast(rewriter, op, lhs, rhs, leadingRank,
                       options.dimSizeIndexBits);
-    }
     auto batchDims = llvm::to_vector<4>(llvm::seq<int64_t>(0, nBatchDims));
 
     auto lhsResultDim = nBatchDims;
     auto rhsResultDim = nBatchDims + 1;
     auto lhsContractingDim = nBatchDims + 1;
     auto rhsContractingDim = nBatchDims;
-    if (lhsRank == 1) {
-      lhsResultDim = nBatchDims + 1;
-      lhsContractingDim = nBatchDims;
-    }
 
     stablehlo::DotDimensionNumbersAttr dotDimensionNumbers =
         stablehlo::DotDimensionNumbersAttr::get(
@@ -266,6 +348,7 @@ public:
     auto outTy =
         castContractingDim(rewriter, op, lhs, rhs, lhsResultDim, rhsResultDim,
                            lhsContractingDim, rhsContractingDim);
+    outTy = outTy.clone(getAccumulatorElementType(lhsElemTy));
     output = rewriter
                  .create<stablehlo::DotGeneralOp>(op->getLoc(), outTy, lhs, rhs,
                                                   dotDimensionNumbers, nullptr)
@@ -286,6 +369,9 @@ public:
 
     if (failed(performMatmul(op, adaptor, rewriter, lhs, rhs, output)))
       return op.emitError("failed to perform matmul operation");
+    output = truncateAccumulator(
+        rewriter, op, output,
+        lhs.getType().cast<RankedTensorType>().getElementType());
 
     rewriter.replaceOpWithNewOp<tensor::CastOp>(
         op,
@@ -407,39 +493,68 @@ public:
       return op.emitError("only ranked tensor types are supported in StableHLO "
                           "matmul for bias tensor");
 
-    // weight.T
-    rhs = getPermutedTensor(rewriter, op, rhs, {1, 0});
-
-    auto lhsTy = lhs.getType().cast<RankedTensorType>();
-    auto rhsTy = rhs.getType().cast<RankedTensorType>();
-    auto leadingRank = std::max(lhsTy.getRank() - rhsTy.getRank(),
-                                rhsTy.getRank() - lhsTy.getRank());
+    Value matmulOutput;
+    RankedTensorType outTy;
+    if (rhs.getType().cast<RankedTensorType>().getRank() == 2) {
+      // A 2D weight is contracted along its input features, which makes both
+      // weight.T and its broadcast over the batch dimensions unnecessary.
+      auto lhsContractingDim =
+          lhs.getType().cast<RankedTensorType>().getRank() - 1;
+      castContractingDimSize(rewriter, op, lhs, rhs, lhsContractingDim, 1);
+      SmallVector<int64_t> outShape(
+          lhs.getType().cast<RankedTensorType>().getShape().drop_back());
+      outShape.push_back(rhs.getType().cast<RankedTensorType>().getDimSize(0));
+      Type lhsElemTy = lhs.getType().cast<RankedTensorType>().getElementType();
+      outTy = RankedTensorType::get(outShape,
+                                    getAccumulatorElementType(lhsElemTy));
+      stablehlo::DotDimensionNumbersAttr dotDimensionNumbers =
+          stablehlo::DotDimensionNumbersAttr::get(
+              rewriter.getContext(),
+              /*lhsBatchingDimensions=*/{},
+              /*rhsBatchingDimensions=*/{},
+              /*lhsContractingDimensions=*/{lhsContractingDim},
+              /*rhsContractingDimensions=*/{1});
+      matmulOutput = rewriter.create<stablehlo::DotGeneralOp>(
+          op->getLoc(), outTy, lhs, rhs, dotDimensionNumbers, nullptr);
+    } else {
+      // weight.T
+      rhs = getPermutedTensor(rewriter, op, rhs, {1, 0});
 
-    const auto &options = ConvertAtenOp<AtenOpT>::getOptions();
-    getBmmBroadcast(rewriter, op, lhs, rhs, leadingRank,
-                    options.dimSizeIndexBits);
-    auto resultRank = std::max(lhsTy.getRank(), rhsTy.getRank());
-    auto nBatchDims = resultRank - 2;
-    auto batchDims = llvm::to_vector<4>(llvm::seq<int64_t>(0, nBatchDims));
+      auto lhsTy = lhs.getType().cast<RankedTensorType>();
+      auto rhsTy = rhs.getType().cast<RankedTensorType>();
+      auto leadingRank = std::max(lhsTy.getRank() - rhsTy.getRank(),
+                                  rhsTy.getRank() - lhsTy.getRank());
 
-    auto lhsResultDim = nBatchDims;
-    auto rhsResultDim = nBatchDims + 1;
-    auto lhsContractingDim = nBatchDims + 1;
-    auto rhsContractingDim = nBatchDims;
-
-    auto outTy =
-        castContractingDim(rewriter, op, lhs, rhs, lhsResultDim, rhsResultDim,
-                           lhsContractingDim, rhsContractingDim);
-    stablehlo::DotDimensionNumbersAttr dotDimensionNumbers =
-        stablehlo::DotDimensionNumbersAttr::get(
-            rewriter.getContext(),
-            /*lhsBatchingDimensions=*/batchDims,
-            /*rhsBatchingDimensions=*/batchDims,
-            /*lhsContractingDimensions=*/{lhsContractingDim},
-            /*rhsContractingDimensions=*/{rhsContractingDim});
-    Value matmulOutput = rewriter.create<stablehlo::DotGeneralOp>(
-        op->getLoc(), outTy, lhs, rhs, dotDimensionNumbers, nullptr);
+      const auto &options = ConvertAtenOp<AtenOpT>::getOptions();
+      getBmmBroadcast(rewriter, op, lhs, rhs, leadingRank,
+                      options.dimSizeIndexBits);
+      auto resultRank = std::max(lhsTy.getRank(), rhsTy.getRank());
+      auto nBatchDims = resultRank - 2;
+      auto batchDims = llvm::to_vector<4>(llvm::seq<int64_t>(0, nBatchDims));
+
+      auto lhsResultDim = nBatchDims;
+      auto rhsResultDim = nBatchDims + 1;
+      auto lhsContractingDim = nBatchDims + 1;
+      auto rhsContractingDim = nBatchDims;
+
+      outTy =
+          castContractingDim(rewriter, op, lhs, rhs, lhsResultDim, rhsResultDim,
+                             lhsContractingDim, rhsContractingDim);
+      outTy = outTy.clone(getAccumulatorElementType(outTy.getElementType()));
+      stablehlo::DotDimensionNumbersAttr dotDimensionNumbers =
+          stablehlo::DotDimensionNumbersAttr::get(
+              rewriter.getContext(),
+              /*lhsBatchingDimensions=*/batchDims,
+              /*rhsBatchingDimensions=*/batchDims,
+              /*lhsContractingDimensions=*/{lhsContractingDim},
+              /*rhsContractingDimensions=*/{rhsContractingDim});
+      matmulOutput = rewriter.create<stablehlo::DotGeneralOp>(
+          op->getLoc(), outTy, lhs, rhs, dotDimensionNumbers, nullptr);
+    }
 
+    Type elementType = lhs.getType().cast<RankedTensorType>().getElementType();
+    matmulOutput = truncateAccumulator(rewriter, op, matmulOutput, elementType);
+    outTy = outTy.clone(elementType);
     Value matmulPlusBias = matmulOutput;
     if (!biasTy.template isa<Torch::NoneType>()) {
       // Bias addition broadcasts to the matmul output shape.
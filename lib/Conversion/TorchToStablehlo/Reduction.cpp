@@ -829,6 +829,225 @@ LogicalResult ConvertAtenReductionOp<AtenLinalgVectorNormOp>::matchAndRewrite(
 }
 } // namespace
 
+// Returns a rank-0 stablehlo.constant of float type `elemTy` holding `value`.
+static Value createScalarFloatConstant(PatternRewriter &rewriter, Location loc,
+                                       Type elemTy, double value) {
+  auto constType = RankedTensorType::get({}, elemTy);
+  return rewriter.create<stablehlo::ConstantOp>(
+      loc, DenseElementsAttr::get(constType,
+                                  rewriter.getFloatAttr(elemTy, value)));
+}
+
+// Matches the `correction` operand of the variance ops: none, which is the
+// unbiased estimator, or a constant int or float.
+static LogicalResult matchVarianceCorrection(Value correction,
+                                             double &correctionValue) {
+  correctionValue = 1.0;
+  if (correction.getType().isa<Torch::NoneType>())
+    return success();
+  int64_t correctionInt;
+  if (matchPattern(correction, m_TorchConstantInt(&correctionInt))) {
+    correctionValue = correctionInt;
+    return success();
+  }
+  return success(
+      matchPattern(correction, m_TorchConstantFloat(&correctionValue)));
+}
+
+// Matches the `dim` operand of the variance ops: none or an empty list reduce
+// all the dimensions.
+static LogicalResult matchVarianceDims(Value dimList, int64_t rank,
+                                       SmallVector<int64_t> &dims) {
+  SmallVector<int64_t> inputDims;
+  if (!dimList.getType().isa<Torch::NoneType>() &&
+      !matchPattern(dimList, m_TorchListOfConstantInts(inputDims)))
+    return failure();
+  if (inputDims.empty())
+    inputDims = llvm::to_vector<4>(llvm::seq<int64_t>(0, rank));
+  for (int64_t d : inputDims) {
+    d = toPositiveDim(d, rank);
+    if (!isValidDim(d, rank))
+      return failure();
+    dims.push_back(d);
+  }
+  llvm::sort(dims);
+  dims.erase(std::unique(dims.begin(), dims.end()), dims.end());
+  return success();
+}
+
+// Computes the variance and the mean of `input` along `dims` in a single pass
+// over the input: a variadic stablehlo.reduce combines the (count, mean, M2)
+// triples of Welford's algorithm, with the pairwise update of Chan et al.
+//
+//   n = n_a + n_b
+//   delta = mean_b - mean_a
+//   mean = mean_a + delta * n_b / n
+//   M2 = M2_a + M2_b + delta * delta * n_a * n_b / n
+//
+// which, unlike the sum of squares, does not lose precision to cancellation.
+// The variance is M2 / (n - correction). Inputs narrower than f32 are
+// accumulated in f32.
+static FailureOr<std::pair<Value, Value>>
+createVarianceAndMean(ConversionPatternRewriter &rewriter, Operation *op,
+                      Value input, ArrayRef<int64_t> dims,
+                      double correction, bool keepDim,
+                      RankedTensorType outTy, size_t dimSizeIndexBits) {
+  auto inputTy = input.getType().cast<RankedTensorType>();
+  auto inputElemTy = inputTy.getElementType().dyn_cast<mlir::FloatType>();
+  if (!inputElemTy)
+    return rewriter.notifyMatchFailure(op, "only float inputs are supported");
+  Location loc = op->getLoc();
+  Type accTy = inputElemTy;
+  if (inputElemTy.getWidth() < 32)
+    accTy = rewriter.getF32Type();
+  auto accInputTy = RankedTensorType::get(inputTy.getShape(), accTy);
+  if (accTy != inputElemTy)
+    input = rewriter.create<stablehlo::ConvertOp>(loc, input, accTy);
+
+  auto inputShapeInfo =
+      hlo::getDimSizesOfTensor(rewriter, op, input, dimSizeIndexBits);
+  if (failed(inputShapeInfo))
+    return rewriter.notifyMatchFailure(
+        op, "failed to get dimension sizes of the input");
+  auto inputShapeVec = *inputShapeInfo;
+  Value inputShape =
+      rewriter.create<tensor::FromElementsOp>(loc, inputShapeVec);
+  auto semantics = accTy.cast<mlir::FloatType>().getFloatSemantics();
+  Value ones = hlo::getConstantOfShape(rewriter, loc, APFloat(semantics, 1),
+                                       inputShape, accInputTy);
+  Value zeros = hlo::getConstantOfShape(rewriter, loc, APFloat(semantics, 0),
+                                        inputShape, accInputTy);
+  Value zero = createScalarFloatConstant(rewriter, loc, accTy, 0.0);
+
+  auto reduceOp = rewriter.create<stablehlo::ReduceOp>(
+      loc, ValueRange{ones, input, zeros}, ValueRange{zero, zero, zero},
+      rewriter.getI64TensorAttr(dims));
+  Block &block = reduceOp.getBody().emplaceBlock();
+  auto scalarTy = RankedTensorType::get({}, accTy);
+  for (int i = 0; i < 6; ++i)
+    block.addArgument(scalarTy, loc);
+  {
+    OpBuilder::InsertionGuard guard(rewriter);
+    rewriter.setInsertionPointToStart(&block);
+    Value countA = block.getArgument(0), meanA = block.getArgument(1),
+          m2A = block.getArgument(2), countB = block.getArgument(3),
+          meanB = block.getArgument(4), m2B = block.getArgument(5);
+    Value count = rewriter.create<stablehlo::AddOp>(loc, countA, countB);
+    Value delta = rewriter.create<stablehlo::SubtractOp>(loc, meanB, meanA);
+    // Both sides are empty when combining the initial values.
+    Value blockZero = createScalarFloatConstant(rewriter, loc, accTy, 0.0);
+    Value blockOne = createScalarFloatConstant(rewriter, loc, accTy, 1.0);
+    Value isEmpty = rewriter.create<stablehlo::CompareOp>(
+        loc, count, blockZero, stablehlo::ComparisonDirection::EQ);
+    Value safeCount =
+        rewriter.create<stablehlo::SelectOp>(loc, isEmpty, blockOne, count);
+    Value ratio = rewriter.create<stablehlo::DivOp>(loc, countB, safeCount);
+    Value mean = rewriter.create<stablehlo::AddOp>(
+        loc, meanA, rewriter.create<stablehlo::MulOp>(loc, delta, ratio));
+    Value deltaSquare = rewriter.create<stablehlo::MulOp>(loc, delta, delta);
+    Value m2 = rewriter.create<stablehlo::AddOp>(
+        loc, rewriter.create<stablehlo::AddOp>(loc, m2A, m2B),
+        rewriter.create<stablehlo::MulOp>(
+            loc, deltaSquare,
+            rewriter.create<stablehlo::MulOp>(loc, countA, ratio)));
+    rewriter.create<stablehlo::ReturnOp>(loc, ValueRange{count, mean, m2});
+  }
+
+  Value count = reduceOp.getResult(0);
+  Value mean = reduceOp.getResult(1);
+  Value m2 = reduceOp.getResult(2);
+  Value correctionValue =
+      createScalarFloatConstant(rewriter, loc, accTy, correction);
+  Value denominator = rewriter.create<chlo::BroadcastSubOp>(
+      loc, count, correctionValue, /*broadcast_dimensions=*/nullptr);
+  Value variance = rewriter.create<stablehlo::DivOp>(loc, m2, denominator);
+
+  SmallVector<Value> results{variance, mean};
+  for (Value &result : results) {
+    if (accTy != outTy.getElementType())
+      result = rewriter.create<stablehlo::ConvertOp>(loc, result,
+                                                     outTy.getElementType());
+    if (!keepDim)
+      continue;
+    auto one = rewriter.create<mlir::arith::ConstantOp>(
+        loc, rewriter.getIntegerAttr(rewriter.getIntegerType(dimSizeIndexBits),
+                                     1));
+    SmallVector<Value> outShapeVec(inputShapeVec);
+    for (int64_t d : dims)
+      outShapeVec[d] = one;
+    auto outShapeTensor =
+        rewriter.create<mlir::tensor::FromElementsOp>(loc, outShapeVec);
+    result = rewriter.create<stablehlo::DynamicReshapeOp>(loc, outTy, result,
+                                                          outShapeTensor);
+  }
+  return std::make_pair(results[0], results[1]);
+}
+
+// AtenVarCorrectionOp, AtenVarDimOp, AtenVarMeanCorrectionOp,
+// AtenVarMeanDimOp and AtenVarMeanOp
+// The variance, and the mean for the var_mean ops, of the input computed in a
+// single reduction. See createVarianceAndMean.
+namespace {
+template <typename AtenOpT>
+class ConvertAtenVarianceOp : public ConvertAtenOp<AtenOpT> {
+public:
+  using ConvertAtenOp<AtenOpT>::ConvertAtenOp;
+  using OpAdaptor = typename AtenOpT::Adaptor;
+  LogicalResult
+  matchAndRewrite(AtenOpT op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Value input = adaptor.getSelf();
+    auto inputTy = input.getType().template dyn_cast<RankedTensorType>();
+    if (!inputTy)
+      return rewriter.notifyMatchFailure(
+          op, "only Tensor types supported in StableHLO");
+
+    SmallVector<int64_t> dims;
+    double correction;
+    bool keepDim = false;
+    if constexpr (std::is_same<AtenOpT, AtenVarMeanOp>()) {
+      dims = llvm::to_vector<4>(llvm::seq<int64_t>(0, inputTy.getRank()));
+    } else {
+      if (failed(matchVarianceDims(op.getDim(), inputTy.getRank(), dims)))
+        return rewriter.notifyMatchFailure(op, "non-const dim unsupported");
+      if (!matchPattern(op.getKeepdim(), m_TorchConstantBool(&keepDim)))
+        return rewriter.notifyMatchFailure(op, "non-bool keepdim unsupported");
+    }
+    if constexpr (std::is_same<AtenOpT, AtenVarDimOp>() ||
+                  std::is_same<AtenOpT, AtenVarMeanDimOp>() ||
+                  std::is_same<AtenOpT, AtenVarMeanOp>()) {
+      bool unbiased;
+      if (!matchPattern(op.getUnbiased(), m_TorchConstantBool(&unbiased)))
+        return rewriter.notifyMatchFailure(op,
+                                           "non-bool unbiased unsupported");
+      correction = unbiased ? 1.0 : 0.0;
+    } else {
+      if (failed(matchVarianceCorrection(op.getCorrection(), correction)))
+        return rewriter.notifyMatchFailure(op,
+                                           "non-const correction unsupported");
+    }
+
+    auto outTy = this->getTypeConverter()
+                     ->convertType(op->getResult(0).getType())
+                     .template cast<RankedTensorType>();
+    auto results = createVarianceAndMean(
+        rewriter, op, input, dims, correction, keepDim, outTy,
+        this->getOptions().dimSizeIndexBits);
+    if (failed(results))
+      return failure();
+    Value values[] = {results->first, results->second};
+    SmallVector<Value> newResults;
+    for (OpResult result : op->getResults()) {
+      newResults.push_back(rewriter.create<tensor::CastOp>(
+          op.getLoc(), this->getTypeConverter()->convertType(result.getType()),
+          values[result.getResultNumber()]));
+    }
+    rewriter.replaceOp(op, newResults);
+    return success();
+  }
+};
+} // namespace
+
 void mlir::torch::torch_to_stablehlo::populateReductionOpPatternsAndLegality(
     TypeConverter &typeConverter, RewritePatternSet &patterns,
     ConversionTarget &target, const TorchToStablehloOptions &options) {
@@ -844,4 +1063,14 @@ void mlir::torch::torch_to_stablehlo::populateReductionOpPatternsAndLegality(
   INSERT_ATEN_REDUCTION_OP_PATTERN(AtenFrobeniusNormDimOp);
   INSERT_ATEN_REDUCTION_OP_PATTERN(AtenLinalgVectorNormOp);
 #undef INSERT_ATEN_REDUCTION_OP_PATTERN
+
+#define INSERT_ATEN_VARIANCE_OP_PATTERN(AtenOp)                                \
+  target.addIllegalOp<AtenOp>();                                               \
+  patterns.add<ConvertAtenVarianceOp<AtenOp>>(typeConverter, context, options)
+  INSERT_ATEN_VARIANCE_OP_PATTERN(AtenVarCorrectionOp);
+  INSERT_ATEN_VARIANCE_OP_PATTERN(AtenVarDimOp);
+  INSERT_ATEN_VARIANCE_OP_PATTERN(AtenVarMeanCorrectionOp);
+  INSERT_ATEN_VARIANCE_OP_PATTERN(AtenVarMeanDimOp);
+  INSERT_ATEN_VARIANCE_OP_PATTERN(AtenVarMeanOp);
+#undef INSERT_ATEN_VARIANCE_OP_PATTERN
 }
@@ -275,11 +275,19 @@ FailureOr<SmallVector<Value, 4>> getDimSizesOfTensor(PatternRewriter &rewriter,
   SmallVector<Value, 4> dimSizes;
   dimSizes.reserve(dims.size());
 
+  // The static dimension sizes are materialized as constants, so that only the
+  // dynamic dimensions keep the shape computations, and the ops consuming the
+  // sizes are static when the shape is.
   auto loc = op->getLoc();
+  Type intType = rewriter.getIntegerType(dimSizeIndexBits);
   for (auto d : dims) {
+    if (!valueTy.isDynamicDim(d)) {
+      dimSizes.emplace_back(rewriter.create<arith::ConstantOp>(
+          loc, rewriter.getIntegerAttr(intType, valueTy.getDimSize(d))));
+      continue;
+    }
     dimSizes.emplace_back(rewriter.create<arith::IndexCastOp>(
-        loc, rewriter.getIntegerType(dimSizeIndexBits),
-        rewriter.create<tensor::DimOp>(loc, value, d)));
+        loc, intType, rewriter.create<tensor::DimOp>(loc, value, d)));
   }
   return dimSizes;
 }
@@ -349,6 +357,9 @@ FailureOr<Value> unsqueezeTensor(PatternRewriter &rewriter, Operation *op,
   }
 
   auto outTy = RankedTensorType::get(newShape, rankTy.getElementType());
+  if (outTy.hasStaticShape())
+    return rewriter.create<stablehlo::ReshapeOp>(loc, outTy, tensor)
+        .getResult();
   auto shape = rewriter.create<tensor::FromElementsOp>(loc, newDimSizes);
   return rewriter.create<stablehlo::DynamicReshapeOp>(loc, outTy, tensor, shape)
       .getResult();
@@ -359,6 +370,11 @@ Value getConstantOfShape(PatternRewriter &rewriter, Location loc,
                          TensorType outType) {
   auto constAttr = rewriter.getFloatAttr(outType.getElementType(), constant);
   auto constTensor = rewriter.create<stablehlo::ConstantOp>(loc, constAttr);
+  if (outType.hasStaticShape())
+    return rewriter
+        .create<stablehlo::BroadcastInDimOp>(loc, outType, constTensor,
+                                             rewriter.getI64TensorAttr({}))
+        .getResult();
   return rewriter
       .create<stablehlo::DynamicBroadcastInDimOp>(
           loc, outType, constTensor, shape, rewriter.getI64TensorAttr({}))
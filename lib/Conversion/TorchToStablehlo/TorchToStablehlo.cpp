@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "torch-mlir/Conversion/TorchToStablehlo/TorchToStablehlo.h"
+#include "torch-mlir/Conversion/Utils/Utils.h"
 
 #include "../PassDetail.h"
 #include "PopulatePatterns.h"
@@ -29,6 +30,59 @@ using namespace mlir;
 using namespace mlir::torch;
 using namespace mlir::torch::Torch;
 
+// Turns the `torch.sharding` attributes of the arguments and results of `func`
+// into the `mhlo.sharding` attributes from which XLA's SPMD partitioner
+// propagates the sharding of the program.
+static void convertShardingAttrs(func::FuncOp func) {
+  for (unsigned i = 0, e = func.getNumArguments(); i < e; i++) {
+    if (Attribute sharding = func.removeArgAttr(i, "torch.sharding"))
+      func.setArgAttr(i, "mhlo.sharding", sharding);
+  }
+  for (unsigned i = 0, e = func.getNumResults(); i < e; i++) {
+    if (Attribute sharding = func.removeResultAttr(i, "torch.sharding"))
+      func.setResultAttr(i, "mhlo.sharding", sharding);
+  }
+}
+
+// Folds the stablehlo.transpose and stablehlo.reshape ops of the constants
+// with at most `maxNumElements` elements, such as the weights of convolutions
+// and matmuls, into new constants.
+static void foldLayoutOfConstants(func::FuncOp func, int64_t maxNumElements) {
+  SmallVector<Operation *> layoutOps;
+  func.walk([&](Operation *op) {
+    if (isa<stablehlo::TransposeOp, stablehlo::ReshapeOp>(op))
+      layoutOps.push_back(op);
+  });
+  OpBuilder builder(func.getContext());
+  for (Operation *op : layoutOps) {
+    auto constant = op->getOperand(0).getDefiningOp<stablehlo::ConstantOp>();
+    auto resultType = op->getResult(0).getType().dyn_cast<RankedTensorType>();
+    if (!constant || !resultType || !resultType.hasStaticShape())
+      continue;
+    DenseElementsAttr folded;
+    if (auto transpose = dyn_cast<stablehlo::TransposeOp>(op)) {
+      auto perms =
+          llvm::to_vector(transpose.getPermutation().getValues<int64_t>());
+      folded = transposeDenseElements(constant.getValue(), perms,
+                                      maxNumElements);
+    } else {
+      auto elements = constant.getValue().dyn_cast<DenseElementsAttr>();
+      if (elements && elements.getNumElements() <= maxNumElements)
+        folded = elements.reshape(resultType);
+    }
+    if (!folded || folded.getType() != resultType)
+      continue;
+
+    builder.setInsertionPoint(op);
+    Value replacement =
+        builder.create<stablehlo::ConstantOp>(op->getLoc(), folded);
+    op->getResult(0).replaceAllUsesWith(replacement);
+    op->erase();
+    if (constant->use_empty())
+      constant->erase();
+  }
+}
+
 namespace {
 
 class ConvertTorchToStablehlo
@@ -73,11 +127,19 @@ public:
         typeConverter, patterns, target, options);
     torch_to_stablehlo::populatePoolingOpPatternsAndLegality(
         typeConverter, patterns, target, options);
+    torch_to_stablehlo::populateCollectiveOpPatternsAndLegality(
+        typeConverter, patterns, target, options);
 
-    if (failed(applyPartialConversion(getOperation(), target,
-                                      std::move(patterns)))) {
+    if (failed(profile
+                   ? applyPartialConversionWithProfile(
+                         getOperation(), target, std::move(patterns),
+                         getArgument(), llvm::errs())
+                   : applyPartialConversion(getOperation(), target,
+                                            std::move(patterns)))) {
       return signalPassFailure();
     }
+    convertShardingAttrs(getOperation());
+    foldLayoutOfConstants(getOperation(), maxFoldedConstantElements);
   }
 };
 
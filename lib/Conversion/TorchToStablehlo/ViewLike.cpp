@@ -320,9 +320,9 @@ LogicalResult ConvertAtenOp<AtenSqueezeOp>::matchAndRewrite(
     if (dSize != 1)
       dims.push_back(r);
   }
-  if (dims.size() == 0) {
-    rewriter.replaceOpWithNewOp<stablehlo::ReshapeOp>(
-        op, getTypeConverter()->convertType(op.getType()), self);
+  auto outTy = getTypeConverter()->convertType(op.getType());
+  if (dims.size() == 0 || outTy.cast<RankedTensorType>().hasStaticShape()) {
+    rewriter.replaceOpWithNewOp<stablehlo::ReshapeOp>(op, outTy, self);
     return success();
   }
 
@@ -334,8 +334,8 @@ LogicalResult ConvertAtenOp<AtenSqueezeOp>::matchAndRewrite(
   auto newDimSizes = *newDimSizesInfo;
   auto stablehloShape =
       rewriter.create<tensor::FromElementsOp>(op.getLoc(), newDimSizes);
-  rewriter.replaceOpWithNewOp<stablehlo::DynamicReshapeOp>(
-      op, getTypeConverter()->convertType(op.getType()), self, stablehloShape);
+  rewriter.replaceOpWithNewOp<stablehlo::DynamicReshapeOp>(op, outTy, self,
+                                                           stablehloShape);
   return success();
 }
 
@@ -373,9 +373,9 @@ LogicalResult ConvertAtenOp<AtenSqueezeDimOp>::matchAndRewrite(
   SmallVector<int64_t, 4> dims(rank);
   std::iota(dims.begin(), dims.end(), 0);
   dims.erase(dims.begin() + dim);
-  if (dims.size() == 0) {
-    rewriter.replaceOpWithNewOp<stablehlo::ReshapeOp>(
-        op, getTypeConverter()->convertType(op.getType()), self);
+  auto outTy = getTypeConverter()->convertType(op.getType());
+  if (dims.size() == 0 || outTy.cast<RankedTensorType>().hasStaticShape()) {
+    rewriter.replaceOpWithNewOp<stablehlo::ReshapeOp>(op, outTy, self);
     return success();
   }
   auto newDimSizesInfo = hlo::getDimSizesOfTensor(rewriter, op, self, dims,
@@ -386,8 +386,8 @@ LogicalResult ConvertAtenOp<AtenSqueezeDimOp>::matchAndRewrite(
   auto newDimSizes = *newDimSizesInfo;
   auto stablehloShape =
       rewriter.create<tensor::FromElementsOp>(op.getLoc(), newDimSizes);
-  rewriter.replaceOpWithNewOp<stablehlo::DynamicReshapeOp>(
-      op, getTypeConverter()->convertType(op.getType()), self, stablehloShape);
+  rewriter.replaceOpWithNewOp<stablehlo::DynamicReshapeOp>(op, outTy, self,
+                                                           stablehloShape);
   return success();
 }
 
@@ -14,12 +14,14 @@
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinTypeInterfaces.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/Matchers.h"
+#include "mlir/IR/TypeUtilities.h"
 #include "mlir/IR/ValueRange.h"
 #include "torch-mlir-dialects/Dialect/TMTensor/IR/TMTensorDialect.h"
 #include "torch-mlir-dialects/Dialect/TMTensor/IR/TMTensorOps.h"
@@ -299,6 +301,105 @@ createTMTensorSortOp(PatternRewriter &rewriter, Location sortOpLoc,
   return SmallVector<Value>(sortOp.getResults());
 }
 
+// The number of chunks of the input that `aten.bincount` counts into private
+// histograms in parallel, when it has at most `kMaxPrivatizedBincountSize`
+// bins and at least `kMinInputsPerPrivatizedBin` times as many inputs.
+// Each chunk is compared with every bin, which pays off for small histograms
+// only, and the histograms are then summed.
+static constexpr int64_t kNumPrivateBincountHistograms = 16;
+static constexpr int64_t kMaxPrivatizedBincountSize = 64;
+static constexpr int64_t kMinInputsPerPrivatizedBin = 16;
+
+// Counts the values of the 1-d `input` into `bincountSize` bins with
+// privatized histograms:
+//
+// chunks = pad(input, -1).reshape(numHistograms, -1)
+// for h in range(numHistograms):       # parallel
+//    for j in range(chunks.size[1]):
+//       for bin in range(bincountSize):  # parallel
+//          histograms[h, bin] += (chunks[h, j] == bin)
+// bincount = histograms.sum(0)
+//
+// Unlike a tm_tensor.scatter into a single histogram, no two iterations of
+// the parallel loops update the same count.
+static Value createPrivatizedBincount(OpBuilder &b, Location loc, Value input,
+                                      Value bincountSize, Type resultElemType) {
+  auto inputType = input.getType().cast<RankedTensorType>();
+  Type inputElemType = inputType.getElementType();
+  int64_t numHistograms = kNumPrivateBincountHistograms;
+  int64_t inputSize = inputType.getShape()[0];
+
+  // Pad the input to a multiple of the number of histograms, with a value
+  // that falls in no bin.
+  if (ShapedType::isDynamic(inputSize) || inputSize % numHistograms != 0) {
+    Value cstNumHistograms =
+        b.create<arith::ConstantIndexOp>(loc, numHistograms);
+    Value dynamicInputSize = getDimOp(b, loc, input, 0);
+    Value chunkSize =
+        b.create<arith::CeilDivUIOp>(loc, dynamicInputSize, cstNumHistograms);
+    Value padding = b.create<arith::SubIOp>(
+        loc, b.create<arith::MulIOp>(loc, chunkSize, cstNumHistograms),
+        dynamicInputSize);
+    Value padValue =
+        b.create<arith::ConstantOp>(loc, b.getIntegerAttr(inputElemType, -1));
+    input = b.create<tensor::PadOp>(
+        loc, RankedTensorType::get({ShapedType::kDynamic}, inputElemType),
+        input, /*low=*/ArrayRef<OpFoldResult>{b.getIndexAttr(0)},
+        /*high=*/ArrayRef<OpFoldResult>{padding}, padValue);
+    inputSize = ShapedType::kDynamic;
+  }
+  int64_t chunkSize = ShapedType::isDynamic(inputSize)
+                          ? ShapedType::kDynamic
+                          : inputSize / numHistograms;
+  Value chunks = b.create<tensor::ExpandShapeOp>(
+      loc, RankedTensorType::get({numHistograms, chunkSize}, inputElemType),
+      input, ArrayRef<ReassociationIndices>{{0, 1}});
+
+  Value cstNumHistograms = b.create<arith::ConstantIndexOp>(loc, numHistograms);
+  Value histograms = createZeroInitTensor(
+      b, loc, {cstNumHistograms, bincountSize}, resultElemType);
+  MLIRContext *context = b.getContext();
+  AffineExpr h, j, bin;
+  bindDims(context, h, j, bin);
+  SmallVector<AffineMap> countMaps =
+      AffineMap::inferFromExprList({{h, j}, {h, bin}});
+  SmallVector<utils::IteratorType> countIteratorTypes{
+      utils::IteratorType::parallel, utils::IteratorType::reduction,
+      utils::IteratorType::parallel};
+  histograms =
+      b.create<linalg::GenericOp>(
+           loc, histograms.getType(), chunks, histograms, countMaps,
+           countIteratorTypes,
+           [&](OpBuilder &b, Location loc, ValueRange args) {
+             Value binIndex = b.create<arith::IndexCastOp>(
+                 loc, inputElemType, b.create<linalg::IndexOp>(loc, 2));
+             Value inBin = b.create<arith::CmpIOp>(
+                 loc, arith::CmpIPredicate::eq, args[0], binIndex);
+             Value count = b.create<arith::AddIOp>(
+                 loc, args[1],
+                 b.create<arith::ExtUIOp>(loc, resultElemType, inBin));
+             b.create<linalg::YieldOp>(loc, count);
+           })
+          .getResult(0);
+
+  Value bincount = createZeroInitTensor(b, loc, {bincountSize}, resultElemType);
+  AffineExpr sumBin, sumH;
+  bindDims(context, sumBin, sumH);
+  SmallVector<AffineMap> sumMaps =
+      AffineMap::inferFromExprList({{sumH, sumBin}, {sumBin}});
+  SmallVector<utils::IteratorType> sumIteratorTypes{
+      utils::IteratorType::parallel, utils::IteratorType::reduction};
+  return b
+      .create<linalg::GenericOp>(
+          loc, bincount.getType(), histograms, bincount, sumMaps,
+          sumIteratorTypes,
+          [&](OpBuilder &b, Location loc, ValueRange args) {
+            b.create<linalg::YieldOp>(
+                loc, b.create<arith::AddIOp>(loc, args[0], args[1]));
+          })
+      .getResult(0);
+}
+
 namespace {
 // aten::bincount op counts the frequency of each value in a 1-d input tensor of
 // non-negative ints.
@@ -387,9 +488,6 @@ public:
 
     SmallVector<Value, 1> inputSizeDynamic =
         getTensorSizesUntilDim(rewriter, loc, input, 0);
-    Value updatesTensor = rewriter.create<tensor::EmptyOp>(
-        loc, getAsOpFoldResult(inputSizeDynamic), resultElemType);
-
     Value constantZero = rewriter.create<arith::ConstantOp>(
         loc, rewriter.getZeroAttr(resultElemType));
     Value constantOne = rewriter.create<arith::ConstantIntOp>(
@@ -401,17 +499,312 @@ public:
     Value bincountSize =
         rewriter.create<arith::MaxSIOp>(loc, maxInputPlusOne, minlength);
     bincountSize = castIntToIndex(rewriter, loc, bincountSize);
-    Value bincountTensor = createInitTensor(rewriter, loc, {bincountSize},
-                                            resultElemType, constantZero);
 
-    Value scatterOp = createTMTensorScatterOp(
-        rewriter, loc, updatesTensor, indices, bincountTensor,
-        /*uniqueIndices=*/false,
-        [&](OpBuilder &b, Location loc, Value _, Value bincountElem) {
-          Value add = b.create<arith::AddIOp>(loc, bincountElem, constantOne);
-          b.create<TMTensor::YieldOp>(loc, add);
+    // The counts of a tm_tensor.scatter are updated one input at a time, so
+    // small histograms of large inputs are counted in parallel into private
+    // histograms instead.
+    Value isSmallHistogram = rewriter.create<arith::CmpIOp>(
+        loc, arith::CmpIPredicate::ule, bincountSize,
+        rewriter.create<arith::ConstantIndexOp>(loc,
+                                                kMaxPrivatizedBincountSize));
+    Value minInputSize = rewriter.create<arith::MulIOp>(
+        loc, bincountSize,
+        rewriter.create<arith::ConstantIndexOp>(loc,
+                                                kMinInputsPerPrivatizedBin));
+    Value isLargeInput = rewriter.create<arith::CmpIOp>(
+        loc, arith::CmpIPredicate::uge, inputSizeDynamic[0], minInputSize);
+    Value privatize =
+        rewriter.create<arith::AndIOp>(loc, isSmallHistogram, isLargeInput);
+    auto bincountType =
+        RankedTensorType::get({ShapedType::kDynamic}, resultElemType);
+    Value bincount =
+        rewriter
+            .create<scf::IfOp>(
+                loc, bincountType, privatize,
+                [&](OpBuilder &b, Location loc) {
+                  b.create<scf::YieldOp>(
+                      loc, createPrivatizedBincount(b, loc, input, bincountSize,
+                                                    resultElemType));
+                },
+                [&](OpBuilder &b, Location loc) {
+                  Value updatesTensor = b.create<tensor::EmptyOp>(
+                      loc, getAsOpFoldResult(inputSizeDynamic), resultElemType);
+                  Value bincountTensor = createInitTensor(
+                      b, loc, {bincountSize}, resultElemType, constantZero);
+                  Value scatterOp = createTMTensorScatterOp(
+                      b, loc, updatesTensor, indices, bincountTensor,
+                      /*uniqueIndices=*/false,
+                      [&](OpBuilder &b, Location loc, Value _,
+                          Value bincountElem) {
+                        Value add = b.create<arith::AddIOp>(loc, bincountElem,
+                                                            constantOne);
+                        b.create<TMTensor::YieldOp>(loc, add);
+                      });
+                  b.create<scf::YieldOp>(loc, scatterOp);
+                })
+            .getResult(0);
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, bincount);
+    return success();
+  }
+};
+} // namespace
+
+// Collapses `tensor`, of rank at least 1, to a 1-d tensor in row-major order.
+static Value flattenTensor(OpBuilder &b, Location loc, Value tensor) {
+  auto type = tensor.getType().cast<RankedTensorType>();
+  if (type.getRank() == 1)
+    return tensor;
+  int64_t size =
+      type.hasStaticShape() ? type.getNumElements() : ShapedType::kDynamic;
+  ReassociationIndices dims;
+  for (int64_t dim = 0; dim < type.getRank(); dim++)
+    dims.push_back(dim);
+  return b.create<tensor::CollapseShapeOp>(
+      loc, RankedTensorType::get({size}, type.getElementType()), tensor,
+      ArrayRef<ReassociationIndices>{dims});
+}
+
+// Returns the scatter indices that stably partition the 1-d `isSelected`,
+// moving its selected elements to the front in order, and the number of
+// selected elements:
+//
+// positions = cumsum(isSelected)
+// count = sum(isSelected)
+// indices[i] = isSelected[i] ? positions[i] - 1 : count + i - positions[i]
+//
+// The indices are a permutation, so that the results of data-dependent ops,
+// which select elements, are scattered in parallel into buffers sized by their
+// upper bound, the number of elements, and sliced to their first `count`
+// elements.
+static std::pair<Value, Value>
+createCompactionIndices(OpBuilder &b, Location loc, Value isSelected) {
+  MLIRContext *context = b.getContext();
+  auto selectedType = isSelected.getType().cast<RankedTensorType>();
+  Type i64 = b.getI64Type();
+  Type i32 = b.getI32Type();
+  SmallVector<OpFoldResult> sizes{
+      getAsOpFoldResult(getDimOp(b, loc, isSelected, 0))};
+  SmallVector<utils::IteratorType> parallel{utils::IteratorType::parallel};
+  AffineMap identity = AffineMap::getMultiDimIdentityMap(1, context);
+
+  Value flags = b.create<tensor::EmptyOp>(loc, sizes, i64);
+  flags =
+      b.create<linalg::GenericOp>(
+           loc, flags.getType(), isSelected, flags,
+           SmallVector<AffineMap>(2, identity), parallel,
+           [&](OpBuilder &b, Location loc, ValueRange args) {
+             b.create<linalg::YieldOp>(
+                 loc, b.create<arith::ExtUIOp>(loc, i64, args[0]).getResult());
+           })
+          .getResult(0);
+
+  Value countTensor = createZeroInitTensor(b, loc, {}, i64);
+  countTensor =
+      b.create<linalg::GenericOp>(
+           loc, countTensor.getType(), flags, countTensor,
+           SmallVector<AffineMap>{identity, AffineMap::get(1, 0, context)},
+           SmallVector<utils::IteratorType>{utils::IteratorType::reduction},
+           [&](OpBuilder &b, Location loc, ValueRange args) {
+             b.create<linalg::YieldOp>(
+                 loc, b.create<arith::AddIOp>(loc, args[0], args[1]));
+           })
+          .getResult(0);
+  Value count = b.create<tensor::ExtractOp>(loc, countTensor);
+
+  Value positions = createTMTensorScanOp(
+      b, loc, flags, b.create<tensor::EmptyOp>(loc, sizes, i64),
+      createZeroInitTensor(b, loc, {}, i64), /*dim=*/0, /*inclusive=*/true,
+      [](OpBuilder &b, Location loc, Value input, Value acc) {
+        b.create<TMTensor::YieldOp>(
+            loc, b.create<arith::AddIOp>(loc, input, acc).getResult());
+      });
+
+  Value indices = b.create<tensor::EmptyOp>(loc, sizes, i32);
+  indices =
+      b.create<linalg::GenericOp>(
+           loc, indices.getType(), ValueRange{isSelected, positions}, indices,
+           SmallVector<AffineMap>(3, identity), parallel,
+           [&](OpBuilder &b, Location loc, ValueRange args) {
+             Value i = b.create<arith::IndexCastOp>(
+                 loc, i64, b.create<linalg::IndexOp>(loc, 0));
+             Value one = b.create<arith::ConstantIntOp>(loc, 1, 64);
+             Value selectedIndex =
+                 b.create<arith::SubIOp>(loc, args[1], one);
+             Value unselectedIndex = b.create<arith::AddIOp>(
+                 loc, count, b.create<arith::SubIOp>(loc, i, args[1]));
+             Value index = b.create<arith::SelectOp>(
+                 loc, args[0], selectedIndex, unselectedIndex);
+             b.create<linalg::YieldOp>(
+                 loc, b.create<arith::TruncIOp>(loc, i32, index).getResult());
+           })
+          .getResult(0);
+  indices = b.create<tensor::ExpandShapeOp>(
+      loc, RankedTensorType::get({selectedType.getShape()[0], 1}, i32),
+      indices, ArrayRef<ReassociationIndices>{{0, 1}});
+  return {indices, castIntToIndex(b, loc, count)};
+}
+
+namespace {
+// aten::nonzero returns the coordinates of the nonzero elements of its input,
+// in row-major order, as the rows of a [count, rank] tensor. The coordinates of
+// all the elements are scattered into a buffer of as many rows, the upper bound
+// of the count, by the compaction indices, which the result is a slice of.
+class ConvertAtenNonzeroOp : public OpConversionPattern<AtenNonzeroOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenNonzeroOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Location loc = op.getLoc();
+    MLIRContext *context = op->getContext();
+    Value self = adaptor.getSelf();
+    auto selfType = self.getType().cast<RankedTensorType>();
+    int64_t rank = selfType.getRank();
+    if (rank == 0)
+      return rewriter.notifyMatchFailure(op, "unimplemented: 0-d input");
+    auto resultType = getTypeConverter()
+                          ->convertType(op.getType())
+                          .cast<RankedTensorType>();
+    Type elementType = selfType.getElementType();
+    Type i64 = rewriter.getI64Type();
+
+    Value flatSelf = flattenTensor(rewriter, loc, self);
+    SmallVector<OpFoldResult> flatSizes{
+        getAsOpFoldResult(getDimOp(rewriter, loc, flatSelf, 0))};
+    AffineMap identity = AffineMap::getMultiDimIdentityMap(1, context);
+    Value isNonzero = rewriter.create<tensor::EmptyOp>(
+        loc, flatSizes, rewriter.getI1Type());
+    isNonzero =
+        rewriter
+            .create<linalg::GenericOp>(
+                loc, isNonzero.getType(), flatSelf, isNonzero,
+                SmallVector<AffineMap>(2, identity),
+                SmallVector<utils::IteratorType>{
+                    utils::IteratorType::parallel},
+                [&](OpBuilder &b, Location loc, ValueRange args) {
+                  Value zero = b.create<arith::ConstantOp>(
+                      loc, b.getZeroAttr(elementType));
+                  Value nonzero;
+                  if (elementType.isa<mlir::FloatType>())
+                    nonzero = b.create<arith::CmpFOp>(
+                        loc, arith::CmpFPredicate::UNE, args[0], zero);
+                  else
+                    nonzero = b.create<arith::CmpIOp>(
+                        loc, arith::CmpIPredicate::ne, args[0], zero);
+                  b.create<linalg::YieldOp>(loc, nonzero);
+                })
+            .getResult(0);
+    auto [indices, count] = createCompactionIndices(rewriter, loc, isNonzero);
+
+    // coordinates[i, d] = (i / strides[d]) % sizes[d]
+    SmallVector<Value> sizes = getTensorSizes(rewriter, loc, self);
+    SmallVector<Value> strides(rank);
+    Value stride = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+    for (int64_t d = rank - 1; d >= 0; d--) {
+      strides[d] = stride;
+      stride = rewriter.create<arith::MulIOp>(loc, stride, sizes[d]);
+    }
+    Value stridesTensor = rewriter.create<tensor::FromElementsOp>(
+        loc, castIndexVectorToInt64Vector(rewriter, loc, strides));
+    Value sizesTensor = rewriter.create<tensor::FromElementsOp>(
+        loc, castIndexVectorToInt64Vector(rewriter, loc, sizes));
+    SmallVector<OpFoldResult> bufferSizes{flatSizes[0],
+                                          rewriter.getIndexAttr(rank)};
+    Value coordinates = rewriter.create<tensor::EmptyOp>(loc, bufferSizes, i64);
+    AffineExpr i, d;
+    bindDims(context, i, d);
+    coordinates =
+        rewriter
+            .create<linalg::GenericOp>(
+                loc, coordinates.getType(),
+                ValueRange{stridesTensor, sizesTensor}, coordinates,
+                AffineMap::inferFromExprList({{d}, {d}, {i, d}}),
+                SmallVector<utils::IteratorType>(
+                    2, utils::IteratorType::parallel),
+                [&](OpBuilder &b, Location loc, ValueRange args) {
+                  Value index = b.create<arith::IndexCastOp>(
+                      loc, i64, b.create<linalg::IndexOp>(loc, 0));
+                  Value coordinate = b.create<arith::RemUIOp>(
+                      loc, b.create<arith::DivUIOp>(loc, index, args[0]),
+                      args[1]);
+                  b.create<linalg::YieldOp>(loc, coordinate);
+                })
+            .getResult(0);
+
+    Value buffer = rewriter.create<tensor::EmptyOp>(loc, bufferSizes, i64);
+    Value scatter = createTMTensorScatterOp(
+        rewriter, loc, coordinates, indices, buffer, /*uniqueIndices=*/true,
+        [](OpBuilder &b, Location loc, Value update, Value _) {
+          b.create<TMTensor::YieldOp>(loc, update);
         });
-    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, scatterOp);
+    Value nonzero = rewriter.create<tensor::ExtractSliceOp>(
+        loc, scatter,
+        ArrayRef<OpFoldResult>{rewriter.getIndexAttr(0),
+                               rewriter.getIndexAttr(0)},
+        ArrayRef<OpFoldResult>{count, rewriter.getIndexAttr(rank)},
+        ArrayRef<OpFoldResult>{rewriter.getIndexAttr(1),
+                               rewriter.getIndexAttr(1)});
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, nonzero);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// aten::masked_select returns the elements of `self` selected by `mask`, in
+// row-major order, as a 1-d tensor. Like aten::nonzero, all the elements are
+// scattered into a buffer of the size of `self` by the compaction indices.
+class ConvertAtenMaskedSelectOp
+    : public OpConversionPattern<AtenMaskedSelectOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenMaskedSelectOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Location loc = op.getLoc();
+    Value self = adaptor.getSelf();
+    Value mask = adaptor.getMask();
+    auto selfType = self.getType().cast<RankedTensorType>();
+    auto maskType = mask.getType().cast<RankedTensorType>();
+    if (!maskType.getElementType().isInteger(1))
+      return rewriter.notifyMatchFailure(op, "expected a boolean mask");
+    if (selfType.getRank() == 0)
+      return rewriter.notifyMatchFailure(op, "unimplemented: 0-d input");
+    // TODO: Broadcast the mask and `self` to their common shape.
+    if (maskType.getRank() != selfType.getRank() ||
+        failed(verifyCompatibleShape(maskType.getShape(), selfType.getShape())))
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: the mask is broadcast to the shape of self");
+    auto resultType = getTypeConverter()
+                          ->convertType(op.getType())
+                          .cast<RankedTensorType>();
+
+    Value flatSelf = flattenTensor(rewriter, loc, self);
+    auto flatType = flatSelf.getType().cast<RankedTensorType>();
+    Value flatMask = rewriter.create<tensor::CastOp>(
+        loc, RankedTensorType::get(flatType.getShape(), rewriter.getI1Type()),
+        flattenTensor(rewriter, loc, mask));
+    auto [indices, count] = createCompactionIndices(rewriter, loc, flatMask);
+
+    Value buffer = rewriter.create<tensor::EmptyOp>(
+        loc,
+        SmallVector<OpFoldResult>{
+            getAsOpFoldResult(getDimOp(rewriter, loc, flatSelf, 0))},
+        flatType.getElementType());
+    Value scatter = createTMTensorScatterOp(
+        rewriter, loc, flatSelf, indices, buffer, /*uniqueIndices=*/true,
+        [](OpBuilder &b, Location loc, Value update, Value _) {
+          b.create<TMTensor::YieldOp>(loc, update);
+        });
+    Value selected = rewriter.create<tensor::ExtractSliceOp>(
+        loc, scatter, ArrayRef<OpFoldResult>{rewriter.getIndexAttr(0)},
+        ArrayRef<OpFoldResult>{count},
+        ArrayRef<OpFoldResult>{rewriter.getIndexAttr(1)});
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, selected);
     return success();
   }
 };
@@ -913,8 +1306,147 @@ public:
 };
 } // namespace
 
+// Computes the gradient of each input element from the windows that cover
+// it, when the pooling parameters are constants:
+//
+// for each input position (..., h, w):
+//   grad_input[..., h, w] = 0
+//   for kh in range(kernel_size[0]):
+//     for kw in range(kernel_size[1]):
+//       oh = (h + padding[0] - kh * dilation[0]) / stride[0]
+//       ow = (w + padding[1] - kw * dilation[1]) / stride[1]
+//       if the divisions are exact, (oh, ow) is an output position and
+//          indices[..., oh, ow] == h * Win + w:
+//         grad_input[..., h, w] += grad_output[..., oh, ow]
+//
+// The taps are unrolled into a single elementwise linalg.generic, which
+// writes each element of the gradient once and needs no index tensor,
+// unlike the scatter below. Returns nullptr if the parameters aren't
+// constants.
+static Value createMaxPool2dBackwardGather(
+    AtenMaxPool2dWithIndicesBackwardOp op,
+    AtenMaxPool2dWithIndicesBackwardOp::Adaptor adaptor, OpBuilder &b) {
+  SmallVector<int64_t> kernelSize, stride, padding, dilation;
+  if (!matchPattern(op.getKernelSize(),
+                    m_TorchListOfConstantInts(kernelSize)) ||
+      !matchPattern(op.getStride(), m_TorchListOfConstantInts(stride)) ||
+      !matchPattern(op.getPadding(), m_TorchListOfConstantInts(padding)) ||
+      !matchPattern(op.getDilation(), m_TorchListOfConstantInts(dilation)))
+    return nullptr;
+  // An empty stride defaults to the kernel size, and single values apply to
+  // both spatial dims.
+  if (stride.empty())
+    stride = kernelSize;
+  for (SmallVector<int64_t> *param :
+       {&kernelSize, &stride, &padding, &dilation}) {
+    if (param->size() == 1)
+      param->push_back(param->front());
+    if (param->size() != 2)
+      return nullptr;
+  }
+  if (llvm::any_of(stride, [](int64_t s) { return s <= 0; }))
+    return nullptr;
+
+  Location loc = op.getLoc();
+  Value gradOutput = adaptor.getGradOutput();
+  Value input = adaptor.getSelf();
+  Value indices = adaptor.getIndices();
+  auto inputType = input.getType().cast<RankedTensorType>();
+  Type elementType = inputType.getElementType();
+  if (!elementType.isa<mlir::FloatType>() ||
+      gradOutput.getType().cast<RankedTensorType>().getElementType() !=
+          elementType)
+    return nullptr;
+  Type indicesElemType =
+      indices.getType().cast<RankedTensorType>().getElementType();
+  int64_t rank = inputType.getRank();
+
+  SmallVector<Value> inputShape = getTensorSizes(b, loc, input);
+  Value wIn = inputShape[rank - 1];
+  Value outputSizes[2] = {getDimOp(b, loc, gradOutput, rank - 2),
+                          getDimOp(b, loc, gradOutput, rank - 1)};
+  Value outInit = b.create<tensor::EmptyOp>(
+      loc, getAsOpFoldResult(inputShape), elementType);
+  SmallVector<utils::IteratorType> iteratorTypes(
+      rank, utils::IteratorType::parallel);
+  return b
+      .create<linalg::GenericOp>(
+          loc, outInit.getType(), ValueRange{}, outInit,
+          ArrayRef<AffineMap>{b.getMultiDimIdentityMap(rank)}, iteratorTypes,
+          [&](OpBuilder &b, Location loc, ValueRange args) {
+            SmallVector<Value> position;
+            for (int64_t i = 0; i < rank; i++)
+              position.push_back(b.create<linalg::IndexOp>(loc, i));
+            Value zeroIndex = b.create<arith::ConstantIndexOp>(loc, 0);
+            // The output positions along each spatial dim that each tap of
+            // the kernel maps to this position, clamped to 0 when there are
+            // none, and whether there are.
+            SmallVector<std::pair<Value, Value>> taps[2];
+            for (int64_t dim = 0; dim < 2; dim++) {
+              Value inputPos = position[rank - 2 + dim];
+              Value cstStride =
+                  b.create<arith::ConstantIndexOp>(loc, stride[dim]);
+              for (int64_t k = 0; k < kernelSize[dim]; k++) {
+                Value offset = b.create<arith::AddIOp>(
+                    loc, inputPos,
+                    b.create<arith::ConstantIndexOp>(
+                        loc, padding[dim] - k * dilation[dim]));
+                Value outputPos =
+                    b.create<arith::DivSIOp>(loc, offset, cstStride);
+                Value isAligned = b.create<arith::CmpIOp>(
+                    loc, arith::CmpIPredicate::eq,
+                    b.create<arith::RemSIOp>(loc, offset, cstStride),
+                    zeroIndex);
+                Value isInBounds = b.create<arith::AndIOp>(
+                    loc,
+                    b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::sge,
+                                            offset, zeroIndex),
+                    b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::slt,
+                                            outputPos, outputSizes[dim]));
+                Value isValid =
+                    b.create<arith::AndIOp>(loc, isAligned, isInBounds);
+                taps[dim].emplace_back(
+                    b.create<arith::SelectOp>(loc, isValid, outputPos,
+                                              zeroIndex),
+                    isValid);
+              }
+            }
+
+            Value flatIndex = b.create<arith::IndexCastOp>(
+                loc, indicesElemType,
+                b.create<arith::AddIOp>(
+                    loc,
+                    b.create<arith::MulIOp>(loc, position[rank - 2], wIn),
+                    position[rank - 1]));
+            Value zero =
+                b.create<arith::ConstantOp>(loc, b.getZeroAttr(elementType));
+            Value gradInput = zero;
+            SmallVector<Value> outputPosition(position);
+            for (auto [oh, isValidH] : taps[0]) {
+              for (auto [ow, isValidW] : taps[1]) {
+                outputPosition[rank - 2] = oh;
+                outputPosition[rank - 1] = ow;
+                Value index =
+                    b.create<tensor::ExtractOp>(loc, indices, outputPosition);
+                Value grad = b.create<tensor::ExtractOp>(loc, gradOutput,
+                                                         outputPosition);
+                Value isMax = b.create<arith::AndIOp>(
+                    loc, b.create<arith::AndIOp>(loc, isValidH, isValidW),
+                    b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::eq,
+                                            index, flatIndex));
+                gradInput = b.create<arith::AddFOp>(
+                    loc, gradInput,
+                    b.create<arith::SelectOp>(loc, isMax, grad, zero));
+              }
+            }
+            b.create<linalg::YieldOp>(loc, gradInput);
+          })
+      .getResult(0);
+}
+
 namespace {
-// The original implementation of the op is as follows:
+// When the pooling parameters aren't constants, the gradients are scattered
+// instead. The original implementation of the op is as follows:
 //
 // Indices and GradOutput Layout: [N, C, H, W] or [C, H, W]
 // Input Layout: [N, C, Hin, Win] or [C, Hin, Win]
@@ -944,6 +1476,13 @@ public:
     if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
       return failure();
 
+    if (Value gradInput =
+            createMaxPool2dBackwardGather(op, adaptor, rewriter)) {
+      rewriter.replaceOpWithNewOp<tensor::CastOp>(
+          op, getTypeConverter()->convertType(op.getType()), gradInput);
+      return success();
+    }
+
     Location loc = op.getLoc();
     MLIRContext *context = op->getContext();
     Value gradOutput = adaptor.getGradOutput();
@@ -1513,23 +2052,23 @@ public:
         adaptor.getQuery().getType().cast<ShapedType>().getElementType();
 
     // Verify inputs (only support defaults)
-    if (!mask.getType().isa<Torch::NoneType>())
-      return rewriter.notifyMatchFailure(op.getLoc(),
-                                         "attention masking not supported");
     double dropout;
     if (!matchPattern(dropoutP, m_TorchConstantFloat(&dropout)) ||
         dropout > 0.0)
       return rewriter.notifyMatchFailure(op.getLoc(), "dropout not supported");
     bool causal;
-    if (!matchPattern(isCausal, m_TorchConstantBool(&causal)) || causal)
+    if (!matchPattern(isCausal, m_TorchConstantBool(&causal)))
       return rewriter.notifyMatchFailure(
-          op.getLoc(), "causal attention masking not supported");
+          op.getLoc(), "only constant is_causal supported");
+    // Without a scale, tm_tensor.attention uses the same default,
+    // 1/sqrt(head dimension).
+    FloatAttr scaleAttr;
     if (!scale.getType().isa<Torch::NoneType>()) {
       double scaleFloat;
-      if (!matchPattern(scale, m_TorchConstantFloat(&scaleFloat)) ||
-          scaleFloat != 1.0)
+      if (!matchPattern(scale, m_TorchConstantFloat(&scaleFloat)))
         return rewriter.notifyMatchFailure(op.getLoc(),
-                                           "only default scale supported");
+                                           "only constant scale supported");
+      scaleAttr = rewriter.getF64FloatAttr(scaleFloat);
     }
 
     SmallVector<int64_t> outSizes(
@@ -1545,12 +2084,42 @@ public:
     Value output = createZeroInitTensor(rewriter, op.getLoc(), outSizesDynamic,
                                         elementType);
 
+    SmallVector<Value> inputs{adaptor.getQuery(), adaptor.getKey(),
+                              adaptor.getValue()};
+    // The mask is passed as is, boolean or additive, and broadcast by
+    // tm_tensor.attention, without materializing it to the shape of the
+    // scores.
+    if (!mask.getType().isa<Torch::NoneType>()) {
+      Value builtinMask = adaptor.getAttnMask();
+      auto maskType = builtinMask.getType().cast<RankedTensorType>();
+      int64_t queryRank =
+          adaptor.getQuery().getType().cast<ShapedType>().getRank();
+      if (maskType.getRank() > queryRank)
+        return rewriter.notifyMatchFailure(
+            op.getLoc(), "expected a mask of at most the rank of the query");
+      Type maskElementType = maskType.getElementType();
+      if (!maskElementType.isInteger(1) && maskElementType != elementType)
+        return rewriter.notifyMatchFailure(
+            op.getLoc(),
+            "expected a boolean mask or a mask of the dtype of the query");
+      // Masks of rank 0 and 1 get leading dims of size 1 for the queries.
+      if (maskType.getRank() < 2) {
+        SmallVector<int64_t> shape(2 - maskType.getRank(), 1);
+        llvm::append_range(shape, maskType.getShape());
+        SmallVector<ReassociationIndices> reassociation;
+        if (maskType.getRank() == 1)
+          reassociation.push_back({0, 1});
+        builtinMask = rewriter.create<tensor::ExpandShapeOp>(
+            op.getLoc(), RankedTensorType::get(shape, maskElementType),
+            builtinMask, reassociation);
+      }
+      inputs.push_back(builtinMask);
+    }
+
     // Overwrite with tm_tensor::attention
     auto attention = rewriter.create<AttentionOp>(
-        op.getLoc(), outType,
-        SmallVector<Value>{adaptor.getQuery(), adaptor.getKey(),
-                           adaptor.getValue()},
-        SmallVector<Value>{output});
+        op.getLoc(), outType, inputs, SmallVector<Value>{output}, scaleAttr,
+        rewriter.getBoolAttr(causal));
 
     rewriter.replaceOp(op, attention.getResult());
 
@@ -1572,6 +2141,7 @@ public:
     registry.insert<func::FuncDialect>();
     registry.insert<tensor::TensorDialect>();
     registry.insert<arith::ArithDialect>();
+    registry.insert<scf::SCFDialect>();
     registry.insert<TMTensorDialect>();
     TorchConversion::getBackendTypeConversionDependentDialects(registry);
   }
@@ -1581,8 +2151,8 @@ public:
     ConversionTarget target(*context);
     target.addLegalDialect<linalg::LinalgDialect, func::FuncDialect,
                            tensor::TensorDialect, arith::ArithDialect,
-                           math::MathDialect, Torch::TorchDialect,
-                           TMTensorDialect>();
+                           math::MathDialect, scf::SCFDialect,
+                           Torch::TorchDialect, TMTensorDialect>();
 
     TypeConverter typeConverter;
     typeConverter.addConversion([](Type type) { return type; });
@@ -1591,6 +2161,10 @@ public:
     RewritePatternSet patterns(context);
     target.addIllegalOp<AtenBincountOp>();
     patterns.add<ConvertAtenBincountOp>(typeConverter, context);
+    target.addIllegalOp<AtenNonzeroOp>();
+    patterns.add<ConvertAtenNonzeroOp>(typeConverter, context);
+    target.addIllegalOp<AtenMaskedSelectOp>();
+    patterns.add<ConvertAtenMaskedSelectOp>(typeConverter, context);
     target.addIllegalOp<Aten_IndexPutImplOp>();
     patterns.add<ConvertAten_IndexPutImplOp>(typeConverter, context);
     target.addIllegalOp<AtenMaxPool2dWithIndicesBackwardOp>();
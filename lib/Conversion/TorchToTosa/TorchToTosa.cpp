@@ -1214,6 +1214,61 @@ public:
       return false;
     };
 
+    // Unit dims can be moved anywhere without moving any data, so a transpose
+    // that only changes the position of unit dims is a pure reshape. The
+    // transposedShape holds the shape of each dim in transposedDims.
+    auto isPureReshape = [&](SmallVector<int32_t> transposedDims,
+                             ArrayRef<int64_t> transposedShape) -> bool {
+      SmallVector<int32_t> nonUnitDims;
+      for (auto [dim, shape] : llvm::zip(transposedDims, transposedShape)) {
+        if (shape != 1)
+          nonUnitDims.push_back(dim);
+      }
+      return !isTransposeRequired(nonUnitDims);
+    };
+
+    // Creates the transpose of an operand of the tosa.matmul. When the operand
+    // is itself a transpose, e.g. the output transpose of a previous matmul,
+    // the two are composed into one, and cancel out when the composition is
+    // the identity. The result only feeds a reshape, so its type doesn't have
+    // to match resultType exactly in that case.
+    auto createOperandTranspose = [&](Value input, SmallVector<int32_t> perms,
+                                      Type resultType) -> Value {
+      Value source = input;
+      if (auto cast = source.getDefiningOp<tensor::CastOp>())
+        source = cast.getSource();
+      DenseIntElementsAttr sourcePermsAttr;
+      auto sourceTranspose = source.getDefiningOp<tosa::TransposeOp>();
+      if (sourceTranspose &&
+          matchPattern(sourceTranspose.getPerms(),
+                       m_Constant(&sourcePermsAttr)) &&
+          sourcePermsAttr.getNumElements() ==
+              static_cast<int64_t>(perms.size())) {
+        SmallVector<int32_t> sourcePerms;
+        for (APInt perm : sourcePermsAttr.getValues<APInt>())
+          sourcePerms.push_back(perm.getSExtValue());
+        // transpose(transpose(x, p1), p2) == transpose(x, p1[p2[i]]).
+        SmallVector<int32_t> composedPerms;
+        bool isIdentity = true;
+        for (auto [i, perm] : llvm::enumerate(perms)) {
+          composedPerms.push_back(sourcePerms[perm]);
+          isIdentity &= composedPerms.back() == static_cast<int32_t>(i);
+        }
+        if (isIdentity)
+          return sourceTranspose.getInput1();
+        input = sourceTranspose.getInput1();
+        perms = composedPerms;
+      }
+      std::optional<Value> permsConst = tosa::getConstTensor<int32_t>(
+          rewriter, op,
+          /*vec=*/perms,
+          /*shape=*/{static_cast<int32_t>(perms.size())});
+      return rewriter
+          .create<tosa::TransposeOp>(op->getLoc(), resultType, input,
+                                     permsConst.value())
+          .getResult();
+    };
+
     SmallVector<TensorShape_t> commonElems, lhsSqueezedElems, rhsSqueezedElems;
 
     if (!performBatchDimBroadcast) {
@@ -1308,7 +1363,9 @@ public:
       transposedLhsDims.push_back(maxInputRank - 1);
       transposedLhsShape.push_back(lhsBroadcastedShape[maxInputRank - 1]);
 
-      bool lhsNeedsTranspose = isTransposeRequired(transposedLhsDims);
+      bool lhsNeedsTranspose =
+          isTransposeRequired(transposedLhsDims) &&
+          !isPureReshape(transposedLhsDims, transposedLhsShape);
 
       auto lhsReshapeInput = rankBroadcastedLhs;
 
@@ -1316,20 +1373,10 @@ public:
         auto transposedLhsType = RankedTensorType::get(
             makeShapeLLVMCompatible(transposedLhsShape), rhsElemTy);
 
-        std::optional<Value> transposedLhsDimsConst =
-            tosa::getConstTensor<int32_t>(
-                rewriter, op,
-                /*vec=*/transposedLhsDims,
-                /*shape=*/{static_cast<int32_t>(transposedLhsDims.size())});
-
-        lhsReshapeInput =
-            rewriter
-                .create<tosa::TransposeOp>(
-                    op->getLoc(),
-                    OpConversionPattern<AtenOpT>::getTypeConverter()
-                        ->convertType(transposedLhsType),
-                    rankBroadcastedLhs, transposedLhsDimsConst.value())
-                .getResult();
+        lhsReshapeInput = createOperandTranspose(
+            rankBroadcastedLhs, transposedLhsDims,
+            OpConversionPattern<AtenOpT>::getTypeConverter()->convertType(
+                transposedLhsType));
       }
 
       // LHS = {common, lhs_squeezed, matmul_dim}
@@ -1391,25 +1438,17 @@ public:
       auto newRhsType = RankedTensorType::get(
           makeShapeLLVMCompatible(newRhsShape), rhsElemTy);
 
-      bool rhsNeedsTranspose = isTransposeRequired(transposedRhsDims);
+      bool rhsNeedsTranspose =
+          isTransposeRequired(transposedRhsDims) &&
+          !isPureReshape(transposedRhsDims, transposedRhsShape);
 
       auto transposedRhsValue = rankBroadcastedRhs;
 
       if (rhsNeedsTranspose) {
-        std::optional<Value> transposedRhsDimsConst =
-            tosa::getConstTensor<int32_t>(
-                rewriter, op,
-                /*vec=*/transposedRhsDims,
-                /*shape=*/{static_cast<int32_t>(transposedRhsDims.size())});
-
-        transposedRhsValue =
-            rewriter
-                .create<tosa::TransposeOp>(
-                    op->getLoc(),
-                    OpConversionPattern<AtenOpT>::getTypeConverter()
-                        ->convertType(transposedRhsType),
-                    rankBroadcastedRhs, transposedRhsDimsConst.value())
-                .getResult();
+        transposedRhsValue = createOperandTranspose(
+            rankBroadcastedRhs, transposedRhsDims,
+            OpConversionPattern<AtenOpT>::getTypeConverter()->convertType(
+                transposedRhsType));
       }
 
       // reshape
@@ -1541,6 +1580,14 @@ public:
 
       bool opNeedsTranspose = isTransposeRequired(transposedOpDims);
 
+      // When the transpose only moves unit dims, reshape straight to the
+      // transposed output shape instead.
+      if (opNeedsTranspose &&
+          isPureReshape(transposedOpDims, reshapedOpShape)) {
+        opNeedsTranspose = false;
+        reshapedOpShape = transposedOpShape;
+      }
+
       // Perform reshape
       auto reshapedOpType = RankedTensorType::get(
           makeShapeLLVMCompatible(reshapedOpShape), outputElemTy);
@@ -1551,12 +1598,17 @@ public:
           mmOpResult, rewriter.getDenseI64ArrayAttr(reshapedOpShape));
 
       if (opNeedsTranspose) {
+        // transposedOpDims holds the output dim of each dim of the reshaped
+        // output, so the transpose is by its inverse permutation.
+        SmallVector<int32_t> outputPerms(transposedOpDims.size());
+        for (auto [i, dim] : llvm::enumerate(transposedOpDims))
+          outputPerms[dim] = i;
 
         std::optional<Value> transposedOpShapeConst =
             tosa::getConstTensor<int32_t>(
                 rewriter, op,
-                /*vec=*/transposedOpDims,
-                /*shape=*/{static_cast<int32_t>(transposedOpDims.size())});
+                /*vec=*/outputPerms,
+                /*shape=*/{static_cast<int32_t>(outputPerms.size())});
 
         auto transposedOpType = RankedTensorType::get(
             makeShapeLLVMCompatible(transposedOpShape), outputElemTy);
@@ -1782,6 +1834,297 @@ public:
   }
 };
 
+// A qint8 tensor consumed by an `aten.dequantize.self`: its integer
+// representation and its constant per-tensor quantization parameters.
+struct DequantizedQInt8Operand {
+  AtenDequantizeSelfOp dequantize;
+  Value intRepr;
+  double scale;
+  int64_t zeroPoint;
+};
+
+// Gets the scale and zero point of the per-tensor affine quantized tensor
+// `quantized` from the `torch.per_tensor_affine.create` or
+// `aten.quantize_per_tensor` op that produces it, if they are constants.
+static LogicalResult
+getConstantPerTensorQuantizationParams(Value quantized, double &scale,
+                                       int64_t &zeroPoint) {
+  Value torchScale, torchZeroPoint;
+  if (auto create = quantized.getDefiningOp<PerTensorAffineCreateOp>()) {
+    torchScale = create.getScale();
+    torchZeroPoint = create.getOffset();
+  } else if (auto quantize =
+                 quantized.getDefiningOp<AtenQuantizePerTensorOp>()) {
+    torchScale = quantize.getScale();
+    torchZeroPoint = quantize.getZeroPoint();
+  } else {
+    return failure();
+  }
+  return success(matchPattern(torchScale, m_TorchConstantFloat(&scale)) &&
+                 matchPattern(torchZeroPoint, m_TorchConstantInt(&zeroPoint)));
+}
+
+// Matches `value` as the `aten.dequantize.self` of a qint8 tensor with constant
+// per-tensor quantization parameters.
+static FailureOr<DequantizedQInt8Operand>
+matchDequantizedQInt8Operand(ConversionPatternRewriter &rewriter, Value value) {
+  auto dequantize = value.getDefiningOp<AtenDequantizeSelfOp>();
+  if (!dequantize)
+    return failure();
+  Value quantized = dequantize.getSelf();
+  auto type = quantized.getType().dyn_cast<ValueTensorType>();
+  if (!type || !type.hasDtype() || !type.getDtype().isa<QInt8Type>())
+    return failure();
+  DequantizedQInt8Operand operand;
+  operand.dequantize = dequantize;
+  if (failed(getConstantPerTensorQuantizationParams(quantized, operand.scale,
+                                                    operand.zeroPoint)))
+    return failure();
+  operand.intRepr = rewriter.getRemappedValue(quantized);
+  if (!operand.intRepr ||
+      !operand.intRepr.getType().cast<RankedTensorType>().hasStaticShape())
+    return failure();
+  return operand;
+}
+
+// Returns the single user of `op` if it is an `aten.quantize_per_tensor` to
+// qint8 with constant quantization parameters, which are returned in `scale`
+// and `zeroPoint`.
+static AtenQuantizePerTensorOp matchQInt8Quantize(Operation *op, double &scale,
+                                                  int64_t &zeroPoint) {
+  if (!op->hasOneUse())
+    return nullptr;
+  auto quantize = dyn_cast<AtenQuantizePerTensorOp>(*op->getUsers().begin());
+  int64_t dtype;
+  if (!quantize ||
+      !matchPattern(quantize.getDtype(), m_TorchConstantInt(&dtype)) ||
+      dtype != static_cast<int64_t>(torch_upstream::ScalarType::QInt8) ||
+      !matchPattern(quantize.getScale(), m_TorchConstantFloat(&scale)) ||
+      !matchPattern(quantize.getZeroPoint(), m_TorchConstantInt(&zeroPoint)))
+    return nullptr;
+  return quantize;
+}
+
+// Replaces `quantize`, the quantization of the result of the quantized
+// contraction `op`, with the integer representation `result`, and erases `op`
+// and the dequantizations of its operands that have no other users, so that
+// none of the floating point values are computed.
+static void replaceQuantizedContraction(
+    ConversionPatternRewriter &rewriter, TypeConverter *typeConverter,
+    Operation *op, AtenQuantizePerTensorOp quantize, Value result,
+    ArrayRef<AtenDequantizeSelfOp> dequantizes) {
+  Type resultType = typeConverter->convertType(quantize.getType());
+  rewriter.replaceOp(quantize, rewriter
+                                   .create<tensor::CastOp>(
+                                       op->getLoc(), resultType, result)
+                                   .getResult());
+  rewriter.eraseOp(op);
+  SmallPtrSet<Operation *, 2> erased;
+  for (AtenDequantizeSelfOp dequantize : dequantizes) {
+    if (llvm::all_of(dequantize->getUsers(),
+                     [&](Operation *user) { return user == op; }) &&
+        erased.insert(dequantize).second)
+      rewriter.eraseOp(dequantize);
+  }
+}
+
+// Lowers an `aten.mm` or `aten.bmm` of dequantized qint8 operands whose result
+// is quantized to qint8 again, as in the dequantize -> matmul -> quantize
+// patterns of quantized models, to an integer-only tosa.matmul of their
+// integer representations, which accumulates in i32, and a tosa.rescale of the
+// accumulator to the quantized result.
+template <typename AtenOpT>
+class ConvertQuantizedAtenMmOp : public OpConversionPattern<AtenOpT> {
+public:
+  using OpConversionPattern<AtenOpT>::OpConversionPattern;
+  using OpAdaptor = typename AtenOpT::Adaptor;
+  LogicalResult
+  matchAndRewrite(AtenOpT op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    double outputScale;
+    int64_t outputZeroPoint;
+    AtenQuantizePerTensorOp quantize =
+        matchQInt8Quantize(op, outputScale, outputZeroPoint);
+    if (!quantize)
+      return rewriter.notifyMatchFailure(op,
+                                         "result is not quantized to qint8");
+    FailureOr<DequantizedQInt8Operand> lhs =
+        matchDequantizedQInt8Operand(rewriter, op.getSelf());
+    FailureOr<DequantizedQInt8Operand> rhs =
+        matchDequantizedQInt8Operand(rewriter, op.getMat2());
+    if (failed(lhs) || failed(rhs))
+      return rewriter.notifyMatchFailure(
+          op, "expected statically shaped dequantized qint8 operands");
+
+    // tosa.matmul is batched, so 2D operands get a unit batch dim.
+    Location loc = op->getLoc();
+    auto reshapeUpTo3D = [&](Value tensor) -> Value {
+      auto type = tensor.getType().template cast<RankedTensorType>();
+      if (type.getRank() == 3)
+        return tensor;
+      SmallVector<int64_t> shape{1};
+      shape.append(type.getShape().begin(), type.getShape().end());
+      return rewriter.create<tosa::ReshapeOp>(
+          loc, RankedTensorType::get(shape, type.getElementType()), tensor,
+          rewriter.getDenseI64ArrayAttr(shape));
+    };
+    Value matmulLhs = reshapeUpTo3D(lhs->intRepr);
+    Value matmulRhs = reshapeUpTo3D(rhs->intRepr);
+    auto lhsShape =
+        matmulLhs.getType().template cast<RankedTensorType>().getShape();
+    auto rhsShape =
+        matmulRhs.getType().template cast<RankedTensorType>().getShape();
+    if (lhsShape.size() != 3 || rhsShape.size() != 3)
+      return rewriter.notifyMatchFailure(op, "expected 2D or 3D operands");
+
+    auto accType = RankedTensorType::get(
+        {lhsShape[0], lhsShape[1], rhsShape[2]}, rewriter.getI32Type());
+    Value acc = rewriter
+                    .create<tosa::MatMulOp>(
+                        loc, accType, matmulLhs, matmulRhs,
+                        tosa::MatMulOpQuantizationAttr::get(
+                            op.getContext(), lhs->zeroPoint, rhs->zeroPoint))
+                    .getResult();
+    Value result = tosa::buildRescale(
+        rewriter, op, accType.clone(rewriter.getI8Type()), acc,
+        lhs->scale * rhs->scale / outputScale, /*input_zp=*/0, outputZeroPoint,
+        /*double_round=*/true, /*scale32=*/true);
+    if (lhs->intRepr.getType().template cast<RankedTensorType>().getRank() ==
+        2) {
+      SmallVector<int64_t> shape{lhsShape[1], rhsShape[2]};
+      result = rewriter.create<tosa::ReshapeOp>(
+          loc, RankedTensorType::get(shape, rewriter.getI8Type()), result,
+          rewriter.getDenseI64ArrayAttr(shape));
+    }
+    replaceQuantizedContraction(rewriter, this->getTypeConverter(), op,
+                                quantize, result,
+                                {lhs->dequantize, rhs->dequantize});
+    return success();
+  }
+};
+
+// Lowers a 2D `aten.convolution` of dequantized qint8 operands whose result is
+// quantized to qint8 again to an integer-only tosa.conv2d, like
+// `ConvertQuantizedAtenMmOp`. The bias, if any, must be a literal, and is
+// quantized to i32 with the scale of the accumulator.
+class ConvertQuantizedAtenConvolutionOp
+    : public OpConversionPattern<AtenConvolutionOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenConvolutionOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    double outputScale;
+    int64_t outputZeroPoint;
+    AtenQuantizePerTensorOp quantize =
+        matchQInt8Quantize(op, outputScale, outputZeroPoint);
+    if (!quantize)
+      return rewriter.notifyMatchFailure(op,
+                                         "result is not quantized to qint8");
+    FailureOr<DequantizedQInt8Operand> input =
+        matchDequantizedQInt8Operand(rewriter, op.getInput());
+    FailureOr<DequantizedQInt8Operand> weight =
+        matchDequantizedQInt8Operand(rewriter, op.getWeight());
+    if (failed(input) || failed(weight))
+      return rewriter.notifyMatchFailure(
+          op, "expected statically shaped dequantized qint8 operands");
+
+    bool transposed;
+    int64_t groups;
+    if (!matchPattern(op.getTransposed(), m_TorchConstantBool(&transposed)) ||
+        transposed ||
+        !matchPattern(op.getGroups(), m_TorchConstantInt(&groups)) ||
+        groups != 1)
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: only non-transposed convolutions of one group");
+    auto inputShape =
+        input->intRepr.getType().cast<RankedTensorType>().getShape();
+    auto weightShape =
+        weight->intRepr.getType().cast<RankedTensorType>().getShape();
+    if (inputShape.size() != 4 || weightShape.size() != 4)
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: only 2D convolutions supported");
+
+    SmallVector<int64_t, 2> stride, padding2d, dilation;
+    if (!matchPattern(op.getStride(), m_TorchListOfConstantInts(stride)) ||
+        !matchPattern(op.getPadding(), m_TorchListOfConstantInts(padding2d)) ||
+        !matchPattern(op.getDilation(), m_TorchListOfConstantInts(dilation)) ||
+        stride.size() != 2 || padding2d.size() != 2 || dilation.size() != 2)
+      return rewriter.notifyMatchFailure(
+          op, "non-const stride, padding or dilation list unsupported");
+    SmallVector<int64_t> padding(
+        {padding2d[0], padding2d[0], padding2d[1], padding2d[1]});
+
+    // The accumulator holds the products of the integer representations, so
+    // the bias is quantized with the product of the input and weight scales.
+    double accScale = input->scale * weight->scale;
+    SmallVector<int32_t> biasVec(weightShape[0], 0);
+    if (!op.getBias().getType().isa<Torch::NoneType>()) {
+      auto literal = op.getBias().getDefiningOp<ValueTensorLiteralOp>();
+      auto elements = literal
+                          ? literal.getValue().dyn_cast<DenseFPElementsAttr>()
+                          : nullptr;
+      if (!elements || elements.getNumElements() != weightShape[0])
+        return rewriter.notifyMatchFailure(op, "expected a literal bias");
+      for (auto [i, value] : llvm::enumerate(elements.getValues<APFloat>())) {
+        APFloat biasValue = value;
+        bool losesInfo;
+        biasValue.convert(APFloat::IEEEdouble(), APFloat::rmNearestTiesToEven,
+                          &losesInfo);
+        biasVec[i] = std::lround(biasValue.convertToDouble() / accScale);
+      }
+    }
+    Value bias = tosa::getConstTensor<int32_t>(rewriter, op, biasVec,
+                                               {weightShape[0]})
+                     .value();
+
+    // TOSA works in NHWC and takes OHWI weights.
+    Location loc = op->getLoc();
+    auto transpose = [&](Value tensor, ArrayRef<int32_t> perms) -> Value {
+      auto type = tensor.getType().cast<RankedTensorType>();
+      SmallVector<int64_t> shape;
+      for (int32_t dim : perms)
+        shape.push_back(type.getDimSize(dim));
+      Value permsConst =
+          tosa::getConstTensor<int32_t>(rewriter, op, perms, {4}).value();
+      return rewriter.create<tosa::TransposeOp>(
+          loc, RankedTensorType::get(shape, type.getElementType()), tensor,
+          permsConst);
+    };
+    Value nhwcInput = transpose(input->intRepr, {0, 2, 3, 1});
+    Value ohwiWeight = transpose(weight->intRepr, {0, 2, 3, 1});
+    int64_t outputH = (inputShape[2] + padding[0] + padding[1] -
+                       dilation[0] * (weightShape[2] - 1) - 1) /
+                          stride[0] +
+                      1;
+    int64_t outputW = (inputShape[3] + padding[2] + padding[3] -
+                       dilation[1] * (weightShape[3] - 1) - 1) /
+                          stride[1] +
+                      1;
+    auto accType = RankedTensorType::get(
+        {inputShape[0], outputH, outputW, weightShape[0]},
+        rewriter.getI32Type());
+    Value acc = rewriter
+                    .create<tosa::Conv2DOp>(
+                        loc, accType, nhwcInput, ohwiWeight, bias,
+                        rewriter.getDenseI64ArrayAttr(padding),
+                        rewriter.getDenseI64ArrayAttr(stride),
+                        rewriter.getDenseI64ArrayAttr(dilation),
+                        tosa::ConvOpQuantizationAttr::get(
+                            op.getContext(), input->zeroPoint,
+                            weight->zeroPoint))
+                    .getResult();
+    Value result = tosa::buildRescale(
+        rewriter, op, accType.clone(rewriter.getI8Type()), acc,
+        accScale / outputScale, /*input_zp=*/0, outputZeroPoint,
+        /*double_round=*/true, /*scale32=*/true);
+    replaceQuantizedContraction(rewriter, getTypeConverter(), op, quantize,
+                                transpose(result, {0, 3, 1, 2}),
+                                {input->dequantize, weight->dequantize});
+    return success();
+  }
+};
+
 template <>
 LogicalResult ConvertAtenOp<AtenRsubScalarOp>::matchAndRewrite(
     AtenRsubScalarOp op, OpAdaptor adaptor,
@@ -2355,6 +2698,17 @@ LogicalResult ConvertAtenOp<ValueTensorLiteralOp>::matchAndRewrite(
   return success();
 }
 
+// Quantized tensors are represented by their integer representation, which
+// the quantized lowerings read with the constant quantization parameters of
+// this op.
+template <>
+LogicalResult ConvertAtenOp<PerTensorAffineCreateOp>::matchAndRewrite(
+    PerTensorAffineCreateOp op, OpAdaptor adaptor,
+    ConversionPatternRewriter &rewriter) const {
+  rewriter.replaceOp(op, adaptor.getIntRepr());
+  return success();
+}
+
 template <>
 LogicalResult ConvertAtenOp<AtenFlattenUsingIntsOp>::matchAndRewrite(
     AtenFlattenUsingIntsOp op, OpAdaptor adaptor,
@@ -4528,6 +4882,53 @@ LogicalResult ConvertAtenOp<AtenCatOp>::matchAndRewrite(
 // TorchToTosa Pass
 // -----------------------------------------------------------------------------
 
+// Folds the tosa.transpose and tosa.reshape ops of the constants with at most
+// `maxNumElements` elements, such as the weights of convolutions and matmuls,
+// into new constants.
+static void foldLayoutOfConstants(func::FuncOp func, int64_t maxNumElements) {
+  SmallVector<Operation *> layoutOps;
+  func.walk([&](Operation *op) {
+    if (isa<tosa::TransposeOp, tosa::ReshapeOp>(op))
+      layoutOps.push_back(op);
+  });
+  OpBuilder builder(func.getContext());
+  for (Operation *op : layoutOps) {
+    auto constant = op->getOperand(0).getDefiningOp<tosa::ConstOp>();
+    auto resultType = op->getResult(0).getType().dyn_cast<RankedTensorType>();
+    if (!constant || !resultType || !resultType.hasStaticShape())
+      continue;
+    DenseElementsAttr folded;
+    Operation *permsConst = nullptr;
+    if (auto transpose = dyn_cast<tosa::TransposeOp>(op)) {
+      DenseIntElementsAttr permsAttr;
+      if (!matchPattern(transpose.getPerms(), m_Constant(&permsAttr)))
+        continue;
+      SmallVector<int64_t> perms;
+      for (APInt perm : permsAttr.getValues<APInt>())
+        perms.push_back(perm.getSExtValue());
+      folded = transposeDenseElements(constant.getValue(), perms,
+                                      maxNumElements);
+      permsConst = transpose.getPerms().getDefiningOp();
+    } else {
+      auto elements = constant.getValue().dyn_cast<DenseElementsAttr>();
+      if (elements && elements.getNumElements() <= maxNumElements)
+        folded = elements.reshape(resultType);
+    }
+    if (!folded || folded.getType() != resultType)
+      continue;
+
+    builder.setInsertionPoint(op);
+    Value replacement =
+        builder.create<tosa::ConstOp>(op->getLoc(), resultType, folded);
+    op->getResult(0).replaceAllUsesWith(replacement);
+    op->erase();
+    if (constant->use_empty())
+      constant->erase();
+    if (permsConst && permsConst->use_empty())
+      permsConst->erase();
+  }
+}
+
 namespace {
 class ConvertTorchToTosa : public ConvertTorchToTosaBase<ConvertTorchToTosa> {
 public:
@@ -4665,6 +5066,11 @@ public:
     INSERT_MM_ATENOP_PATTERN(AtenBmmOp);
 #undef INSERT_MM_ATEMOP_PATTERN
 
+    patterns.add<ConvertQuantizedAtenMmOp<AtenMmOp>,
+                 ConvertQuantizedAtenMmOp<AtenBmmOp>,
+                 ConvertQuantizedAtenConvolutionOp>(typeConverter, context,
+                                                    /*benefit=*/2);
+
 #define INSERT_LINEAR_ATENOP_PATTERN(AtenOp)                                   \
   target.addIllegalOp<AtenOp>();                                               \
   patterns.add<ConvertAtenLinearOp<AtenOp>>(typeConverter, context);
@@ -4719,6 +5125,7 @@ public:
     INSERT_ATENOP_PATTERN(AtenRsubScalarOp);
     INSERT_ATENOP_PATTERN(AtenConvolutionOp);
     INSERT_ATENOP_PATTERN(ValueTensorLiteralOp);
+    INSERT_ATENOP_PATTERN(PerTensorAffineCreateOp);
     INSERT_ATENOP_PATTERN(AtenReshapeOp);
     INSERT_ATENOP_PATTERN(AtenBatchNormOp);
     INSERT_ATENOP_PATTERN(AtenNativeLayerNormOp);
@@ -4758,9 +5165,14 @@ public:
     INSERT_CLONE_ATENOP_PATTERN(AtenCloneOp);
 #undef INSERT_CLONE_ATENOP_PATTERN
 
-    if (failed(applyPartialConversion(getOperation(), target,
-                                      std::move(patterns))))
+    if (failed(profile
+                   ? applyPartialConversionWithProfile(
+                         getOperation(), target, std::move(patterns),
+                         getArgument(), llvm::errs())
+                   : applyPartialConversion(getOperation(), target,
+                                            std::move(patterns))))
       return signalPassFailure();
+    foldLayoutOfConstants(getOperation(), maxFoldedConstantElements);
   }
 };
 } // namespace
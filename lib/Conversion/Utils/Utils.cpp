@@ -16,6 +16,12 @@
 #include "mlir/Transforms/DialectConversion.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+#include "torch-mlir/Dialect/TorchConversion/IR/TorchConversionOps.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Format.h"
+
+#include <chrono>
+#include <cstring>
 
 namespace mlir {
 namespace torch {
@@ -119,6 +125,58 @@ void checkDimEqualHelper(OpBuilder &b, Location loc, Value lhsDim,
                          b.getStringAttr("mismatching contracting dimension"));
 }
 
+// Returns the tensor and dimension that the size of dimension `dim` of
+// `tensor` is known to be equal to, looking through the ops that preserve the
+// shape of their operand, the results of linalg ops, which have the shape of
+// their inits, and the `tensor.empty` ops whose sizes are the sizes of other
+// tensors. If the size is a dynamic size of a `tensor.empty` that isn't the size
+// of another tensor, that size value is returned with a dimension of -1.
+static std::pair<Value, int64_t> getDimSizeSource(Value tensor, int64_t dim) {
+  while (true) {
+    Operation *op = tensor.getDefiningOp();
+    if (!op)
+      return {tensor, dim};
+    if (isa<tensor::CastOp, UnrealizedConversionCastOp,
+            TorchConversion::ToBuiltinTensorOp,
+            TorchConversion::FromBuiltinTensorOp>(op) &&
+        op->getNumOperands() == 1) {
+      tensor = op->getOperand(0);
+      continue;
+    }
+    if (auto linalgOp = dyn_cast<linalg::LinalgOp>(op)) {
+      if (!linalgOp.hasTensorSemantics())
+        return {tensor, dim};
+      tensor = linalgOp
+                   .getDpsInitOperand(tensor.cast<OpResult>().getResultNumber())
+                   ->get();
+      continue;
+    }
+    if (auto empty = dyn_cast<tensor::EmptyOp>(op)) {
+      if (!empty.getType().isDynamicDim(dim))
+        return {tensor, dim};
+      Value size = empty.getDynamicSize(dim);
+      auto dimOp = size.getDefiningOp<tensor::DimOp>();
+      std::optional<int64_t> index =
+          dimOp ? dimOp.getConstantIndex() : std::nullopt;
+      if (!index)
+        return {size, -1};
+      tensor = dimOp.getSource();
+      dim = *index;
+      continue;
+    }
+    return {tensor, dim};
+  }
+}
+
+bool areDimSizesEqual(Value lhs, int64_t lhsDim, Value rhs, int64_t rhsDim) {
+  auto lhsType = lhs.getType().dyn_cast<RankedTensorType>();
+  auto rhsType = rhs.getType().dyn_cast<RankedTensorType>();
+  if (lhsType && rhsType && !lhsType.isDynamicDim(lhsDim) &&
+      !rhsType.isDynamicDim(rhsDim))
+    return lhsType.getDimSize(lhsDim) == rhsType.getDimSize(rhsDim);
+  return getDimSizeSource(lhs, lhsDim) == getDimSizeSource(rhs, rhsDim);
+}
+
 // Creates a tensor with required `sizes` and `elemTy` and fills it with
 // initElem.
 Value createInitTensor(OpBuilder &b, Location loc, ValueRange sizes,
@@ -424,6 +482,175 @@ void computeBroadcastShape(ConversionPatternRewriter &rewriter, Location loc,
   }
 }
 
+namespace {
+struct ConversionProfile {
+  int64_t count = 0;
+  double seconds = 0;
+  int64_t numEmittedOps = 0;
+  llvm::StringMap<int64_t> emittedOps;
+};
+} // namespace
+
+LogicalResult
+applyPartialConversionWithProfile(Operation *root, ConversionTarget &target,
+                                  const FrozenRewritePatternSet &patterns,
+                                  StringRef name, raw_ostream &os) {
+  // The conversion of an op also converts the ops nested in it, so only the
+  // outermost illegal ops are converted on their own. The patterns only
+  // replace the op they match, so the other ops in the list stay alive.
+  SmallVector<Operation *> illegalOps;
+  root->walk<WalkOrder::PreOrder>([&](Operation *op) {
+    if (op == root || !target.isIllegal(op))
+      return WalkResult::advance();
+    illegalOps.push_back(op);
+    return WalkResult::skip();
+  });
+
+  llvm::StringMap<ConversionProfile> profiles;
+  for (Operation *op : illegalOps) {
+    ConversionProfile &profile = profiles[op->getName().getStringRef()];
+    // The emitted ops, including the materializations of the operands and
+    // results, end up between the neighbours of the converted op.
+    Block *block = op->getBlock();
+    Operation *prev = op->getPrevNode();
+    Operation *next = op->getNextNode();
+    auto start = std::chrono::steady_clock::now();
+    if (failed(applyPartialConversion(ArrayRef<Operation *>(op), target,
+                                      patterns)))
+      return failure();
+    profile.seconds += std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+    ++profile.count;
+    auto begin = prev ? std::next(prev->getIterator()) : block->begin();
+    auto end = next ? next->getIterator() : block->end();
+    for (Operation &emitted : llvm::make_range(begin, end)) {
+      emitted.walk([&](Operation *nested) {
+        ++profile.numEmittedOps;
+        ++profile.emittedOps[nested->getName().getStringRef()];
+      });
+    }
+  }
+
+  // The table is printed at once, so that the tables of the functions
+  // converted in parallel don't interleave.
+  std::string table;
+  llvm::raw_string_ostream tableOs(table);
+  tableOs << "===" << std::string(73, '-') << "===\n";
+  tableOs << "  " << name;
+  if (auto symbol = dyn_cast<SymbolOpInterface>(root))
+    tableOs << " @" << symbol.getName();
+  tableOs << " conversion profile\n";
+  tableOs << "===" << std::string(73, '-') << "===\n";
+  tableOs << llvm::format("%10s %8s %10s  %s\n", "Time (ms)", "Count",
+                          "Emitted", "Op");
+  SmallVector<std::pair<StringRef, const ConversionProfile *>> byTime;
+  for (const auto &entry : profiles)
+    byTime.emplace_back(entry.getKey(), &entry.getValue());
+  llvm::sort(byTime, [](const auto &lhs, const auto &rhs) {
+    return lhs.second->seconds > rhs.second->seconds;
+  });
+  for (auto [opName, profile] : byTime) {
+    tableOs << llvm::format("%10.3f %8lld %10lld  ", profile->seconds * 1000,
+                            static_cast<long long>(profile->count),
+                            static_cast<long long>(profile->numEmittedOps))
+            << opName << "\n";
+    SmallVector<std::pair<StringRef, int64_t>> byCount;
+    for (const auto &entry : profile->emittedOps)
+      byCount.emplace_back(entry.getKey(), entry.getValue());
+    llvm::sort(byCount, [](const auto &lhs, const auto &rhs) {
+      return lhs.second > rhs.second ||
+             (lhs.second == rhs.second && lhs.first < rhs.first);
+    });
+    for (auto [emittedName, count] : byCount) {
+      tableOs << llvm::format("%30lld    ", static_cast<long long>(count))
+              << emittedName << "\n";
+    }
+  }
+  os << tableOs.str();
+  return success();
+}
+
+DenseElementsAttr transposeDenseElements(ElementsAttr elements,
+                                         ArrayRef<int64_t> perms,
+                                         int64_t maxNumElements) {
+  auto dense = elements.dyn_cast<DenseElementsAttr>();
+  if (!dense || !dense.getType().hasStaticShape() ||
+      dense.getNumElements() > maxNumElements)
+    return nullptr;
+  ArrayRef<int64_t> shape = dense.getType().getShape();
+  int64_t rank = shape.size();
+  if (static_cast<int64_t>(perms.size()) != rank)
+    return nullptr;
+  SmallVector<int64_t> resultShape;
+  for (int64_t perm : perms)
+    resultShape.push_back(shape[perm]);
+  auto resultType = dense.getType().clone(resultShape);
+  if (dense.isSplat())
+    return dense.reshape(resultType);
+  // Booleans are stored one bit per element, everything else in whole bytes.
+  ArrayRef<char> rawData = dense.getRawData();
+  int64_t numElements = dense.getNumElements();
+  if (dense.getElementType().isInteger(1) ||
+      rawData.size() % numElements != 0)
+    return nullptr;
+  size_t elementBytes = rawData.size() / numElements;
+
+  // The stride in `dense` of each dimension of the result.
+  SmallVector<int64_t> inputStrides(rank, 1);
+  for (int64_t i = rank - 2; i >= 0; i--)
+    inputStrides[i] = inputStrides[i + 1] * shape[i + 1];
+  SmallVector<int64_t> strides;
+  for (int64_t perm : perms)
+    strides.push_back(inputStrides[perm]);
+
+  std::vector<char> data(rawData.size());
+  SmallVector<int64_t> index(rank, 0);
+  int64_t offset = 0;
+  for (int64_t i = 0; i < numElements; i++) {
+    std::memcpy(&data[i * elementBytes], &rawData[offset * elementBytes],
+                elementBytes);
+    for (int64_t dim = rank - 1; dim >= 0; dim--) {
+      offset += strides[dim];
+      if (++index[dim] < resultShape[dim])
+        break;
+      offset -= strides[dim] * resultShape[dim];
+      index[dim] = 0;
+    }
+  }
+  return DenseElementsAttr::getFromRawBuffer(resultType, data);
+}
+
+Value permuteTensor(OpBuilder &b, Location loc, Value tensor,
+                    ArrayRef<int64_t> permutation) {
+  auto inType = tensor.getType().cast<RankedTensorType>();
+  int64_t rank = inType.getRank();
+  SmallVector<int64_t> outShape;
+  SmallVector<Value> dynamicDims;
+  SmallVector<AffineExpr> outExprs;
+  for (int64_t dim : permutation) {
+    outShape.push_back(inType.getDimSize(dim));
+    if (inType.isDynamicDim(dim))
+      dynamicDims.push_back(b.create<tensor::DimOp>(loc, tensor, dim));
+    outExprs.push_back(b.getAffineDimExpr(dim));
+  }
+  Value outTensor = b.create<tensor::EmptyOp>(
+      loc, outShape, inType.getElementType(), dynamicDims);
+  SmallVector<AffineMap> indexingMaps{
+      b.getMultiDimIdentityMap(rank),
+      AffineMap::get(rank, /*symbolCount=*/0, outExprs, b.getContext())};
+  SmallVector<utils::IteratorType> iteratorTypes(rank,
+                                                 utils::IteratorType::parallel);
+  return b
+      .create<linalg::GenericOp>(
+          loc, outTensor.getType(), tensor, outTensor, indexingMaps,
+          iteratorTypes,
+          [](OpBuilder &b, Location loc, ValueRange args) {
+            b.create<linalg::YieldOp>(loc, args[0]);
+          })
+      .getResult(0);
+}
+
 } // namespace Torch
 } // namespace torch
 } // namespace mlir
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
+#include "mlir/Bytecode/BytecodeImplementation.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/DialectImplementation.h"
@@ -42,6 +43,175 @@ struct TorchInlinerInterface : public DialectInlinerInterface {
 };
 } // end anonymous namespace
 
+namespace {
+/// The codes identifying the Torch types in bytecode. They are part of the
+/// bytecode format: new types get new codes, and codes are never reused.
+/// Types without a code are stored in their textual form.
+enum class TorchTypeCode : uint64_t {
+  ValueTensor = 1,
+  NonValueTensor = 2,
+  Int = 3,
+  Float = 4,
+  Bool = 5,
+  None = 6,
+  String = 7,
+  Device = 8,
+  Number = 9,
+  List = 10,
+  Optional = 11,
+  Tuple = 12,
+};
+} // end anonymous namespace
+
+/// Writes the sizes and dtype of a tensor type, each preceded by whether it
+/// is known.
+static void writeTensorType(BaseTensorType type,
+                            DialectBytecodeWriter &writer) {
+  writer.writeVarInt(type.hasSizes());
+  if (type.hasSizes()) {
+    writer.writeList(type.getSizes(),
+                     [&](int64_t size) { writer.writeSignedVarInt(size); });
+  }
+  writer.writeVarInt(type.hasDtype());
+  if (type.hasDtype())
+    writer.writeType(type.getDtype());
+  Attribute sparsity = type.getOptionalSparsity();
+  writer.writeVarInt(static_cast<bool>(sparsity));
+  if (sparsity)
+    writer.writeAttribute(sparsity);
+}
+
+template <typename TensorTypeT>
+static Type readTensorType(MLIRContext *context,
+                           DialectBytecodeReader &reader) {
+  uint64_t hasSizes;
+  if (failed(reader.readVarInt(hasSizes)))
+    return {};
+  SmallVector<int64_t> sizes;
+  std::optional<ArrayRef<int64_t>> optionalSizes;
+  if (hasSizes) {
+    if (failed(reader.readList(sizes, [&](int64_t &size) {
+          return reader.readSignedVarInt(size);
+        })))
+      return {};
+    optionalSizes = sizes;
+  }
+  uint64_t hasDtype;
+  if (failed(reader.readVarInt(hasDtype)))
+    return {};
+  Type dtype;
+  if (hasDtype && failed(reader.readType(dtype)))
+    return {};
+  uint64_t hasSparsity;
+  if (failed(reader.readVarInt(hasSparsity)))
+    return {};
+  Attribute sparsity;
+  if (hasSparsity && failed(reader.readAttribute(sparsity)))
+    return {};
+  return TensorTypeT::get(context, optionalSizes, dtype, sparsity);
+}
+
+namespace {
+/// Stores the most common Torch types compactly in bytecode, rather than as
+/// text that has to be parsed again when the module is read.
+struct TorchBytecodeInterface : public BytecodeDialectInterface {
+  using BytecodeDialectInterface::BytecodeDialectInterface;
+
+  Type readType(DialectBytecodeReader &reader) const override {
+    MLIRContext *context = getContext();
+    uint64_t code;
+    if (failed(reader.readVarInt(code)))
+      return {};
+    switch (static_cast<TorchTypeCode>(code)) {
+    case TorchTypeCode::ValueTensor:
+      return readTensorType<ValueTensorType>(context, reader);
+    case TorchTypeCode::NonValueTensor:
+      return readTensorType<NonValueTensorType>(context, reader);
+    case TorchTypeCode::Int:
+      return Torch::IntType::get(context);
+    case TorchTypeCode::Float:
+      return Torch::FloatType::get(context);
+    case TorchTypeCode::Bool:
+      return Torch::BoolType::get(context);
+    case TorchTypeCode::None:
+      return Torch::NoneType::get(context);
+    case TorchTypeCode::String:
+      return Torch::StringType::get(context);
+    case TorchTypeCode::Device:
+      return Torch::DeviceType::get(context);
+    case TorchTypeCode::Number:
+      return Torch::NumberType::get(context);
+    case TorchTypeCode::List:
+    case TorchTypeCode::Optional: {
+      Type containedType;
+      if (failed(reader.readType(containedType)))
+        return {};
+      if (static_cast<TorchTypeCode>(code) == TorchTypeCode::List)
+        return Torch::ListType::get(containedType);
+      return Torch::OptionalType::get(containedType);
+    }
+    case TorchTypeCode::Tuple: {
+      SmallVector<Type> containedTypes;
+      if (failed(reader.readList(containedTypes, [&](Type &type) {
+            return reader.readType(type);
+          })))
+        return {};
+      return Torch::TupleType::get(context, containedTypes);
+    }
+    }
+    reader.emitError() << "unknown Torch type code " << code;
+    return {};
+  }
+
+  LogicalResult writeType(Type type,
+                          DialectBytecodeWriter &writer) const override {
+    auto writeCode = [&](TorchTypeCode code) {
+      writer.writeVarInt(static_cast<uint64_t>(code));
+      return success();
+    };
+    return llvm::TypeSwitch<Type, LogicalResult>(type)
+        .Case<ValueTensorType, NonValueTensorType>([&](auto tensorType) {
+          (void)writeCode(type.isa<ValueTensorType>()
+                              ? TorchTypeCode::ValueTensor
+                              : TorchTypeCode::NonValueTensor);
+          writeTensorType(tensorType, writer);
+          return success();
+        })
+        .Case([&](Torch::IntType) { return writeCode(TorchTypeCode::Int); })
+        .Case(
+            [&](Torch::FloatType) { return writeCode(TorchTypeCode::Float); })
+        .Case([&](Torch::BoolType) { return writeCode(TorchTypeCode::Bool); })
+        .Case([&](Torch::NoneType) { return writeCode(TorchTypeCode::None); })
+        .Case([&](Torch::StringType) {
+          return writeCode(TorchTypeCode::String);
+        })
+        .Case([&](Torch::DeviceType) {
+          return writeCode(TorchTypeCode::Device);
+        })
+        .Case([&](Torch::NumberType) {
+          return writeCode(TorchTypeCode::Number);
+        })
+        .Case([&](Torch::ListType listType) {
+          (void)writeCode(TorchTypeCode::List);
+          writer.writeType(listType.getContainedType());
+          return success();
+        })
+        .Case([&](Torch::OptionalType optionalType) {
+          (void)writeCode(TorchTypeCode::Optional);
+          writer.writeType(optionalType.getContainedType());
+          return success();
+        })
+        .Case([&](Torch::TupleType tupleType) {
+          (void)writeCode(TorchTypeCode::Tuple);
+          writer.writeList(tupleType.getContainedTypes(),
+                           [&](Type type) { writer.writeType(type); });
+          return success();
+        })
+        .Default([](Type) { return failure(); });
+  }
+};
+} // end anonymous namespace
+
 //===----------------------------------------------------------------------===//
 // Tablegen Type Definitions
 //===----------------------------------------------------------------------===//
@@ -105,7 +275,26 @@ void TorchDialect::initialize() {
 #define GET_TYPEDEF_LIST
 #include "torch-mlir/Dialect/Torch/IR/TorchTypes.cpp.inc"
       >();
-  addInterfaces<TorchInlinerInterface>();
+  addInterfaces<TorchInlinerInterface, TorchBytecodeInterface>();
+}
+
+//===----------------------------------------------------------------------===//
+// AbstractInterpLibraryCache
+//===----------------------------------------------------------------------===//
+
+SymbolTable *AbstractInterpLibraryCache::getOrParse(
+    StringRef key, llvm::function_ref<OwningOpRef<ModuleOp>()> parse) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = entries.find(key);
+  if (it != entries.end())
+    return it->second.symbolTable.get();
+  OwningOpRef<ModuleOp> module = parse();
+  if (!module)
+    return nullptr;
+  Entry &entry = entries[key];
+  entry.symbolTable = std::make_unique<SymbolTable>(*module);
+  entry.module = std::move(module);
+  return entry.symbolTable.get();
 }
 
 //===----------------------------------------------------------------------===//
@@ -132,6 +321,16 @@ LogicalResult TorchDialect::verifyRegionArgAttribute(Operation *op,
                                 "argument of !torch.tensor/!torch.vtensor type";
     return success();
   }
+  if (namedAttr.getName().getValue() == "torch.donated") {
+    if (!namedAttr.getValue().isa<UnitAttr>())
+      return op->emitError() << "'torch.donated' must be UnitAttr";
+    return success();
+  }
+  if (namedAttr.getName().getValue() == "torch.sharding") {
+    if (!namedAttr.getValue().isa<StringAttr>())
+      return op->emitError() << "'torch.sharding' must be StringAttr";
+    return success();
+  }
 
   return op->emitError() << "unknown region arg attribute '"
                          << namedAttr.getName().getValue() << "'";
@@ -679,6 +679,25 @@ OpFoldResult AtenSqueezeDimOp::fold(FoldAdaptor adaptor) {
   return nullptr;
 }
 
+//===----------------------------------------------------------------------===//
+// AtenDropoutOp
+//===----------------------------------------------------------------------===//
+
+OpFoldResult AtenDropoutOp::fold(FoldAdaptor adaptor) {
+  // Dropout is the identity in inference mode and when nothing is dropped.
+  // With non-value semantics the result is a new tensor, so it can't be
+  // replaced by the input.
+  if (!getInput().getType().isa<ValueTensorType>() ||
+      getInput().getType() != getType())
+    return nullptr;
+  bool train;
+  double p;
+  if ((matchPattern(getTrain(), m_TorchConstantBool(&train)) && !train) ||
+      (matchPattern(getP(), m_TorchConstantFloat(&p)) && p == 0.0))
+    return getInput();
+  return nullptr;
+}
+
 //===----------------------------------------------------------------------===//
 // AtenRoundOp
 //===----------------------------------------------------------------------===//
@@ -863,6 +882,18 @@ OpFoldResult PrimsViewOfOp::fold(FoldAdaptor adaptor) {
   return getOperand();
 }
 
+//===----------------------------------------------------------------------===//
+// C10dFunctionalWaitTensorOp
+//===----------------------------------------------------------------------===//
+
+OpFoldResult C10dFunctionalWaitTensorOp::fold(FoldAdaptor adaptor) {
+  // The collectives are imported as synchronous ops, whose results are ready
+  // when they are used.
+  if (getSelf().getType() != getType())
+    return nullptr;
+  return getSelf();
+}
+
 //===----------------------------------------------------------------------===//
 // AtenDimOp
 //===----------------------------------------------------------------------===//
@@ -1565,6 +1596,25 @@ OpFoldResult ValueTensorLiteralOp::fold(FoldAdaptor adaptor) {
   return getValueAttr();
 }
 
+//===----------------------------------------------------------------------===//
+// NonValueTensorExternalOp and ValueTensorExternalOp
+//===----------------------------------------------------------------------===//
+
+static LogicalResult verifyExternalTensorType(Operation *op,
+                                              BaseTensorType type) {
+  if (!type.areAllSizesKnown() || !type.hasDtype())
+    return op->emitOpError("result type must have known sizes and dtype");
+  return success();
+}
+
+LogicalResult NonValueTensorExternalOp::verify() {
+  return verifyExternalTensorType(*this, getType().cast<BaseTensorType>());
+}
+
+LogicalResult ValueTensorExternalOp::verify() {
+  return verifyExternalTensorType(*this, getType().cast<BaseTensorType>());
+}
+
 //----------------------------------------------------------------------------//
 // TensorStaticInfoCast
 //----------------------------------------------------------------------------//
@@ -2745,3 +2795,32 @@ LogicalResult InitializeGlobalSlotsOp::verify() {
     return emitOpError("expected number of operands to match number of slots");
   return success();
 }
+
+//===----------------------------------------------------------------------===//
+// GlobalSlotSetOp
+//===----------------------------------------------------------------------===//
+
+void GlobalSlotSetOp::getCanonicalizationPatterns(RewritePatternSet &patterns,
+                                                  MLIRContext *context) {
+  // Writing back the value read from the slot does nothing, unless the slot
+  // may have been written in between.
+  patterns.add(+[](GlobalSlotSetOp op, PatternRewriter &rewriter) {
+    auto get = op.getValue().getDefiningOp<GlobalSlotGetOp>();
+    if (!get || get.getSlot() != op.getSlot() ||
+        get->getBlock() != op->getBlock())
+      return failure();
+    for (Operation *between = get->getNextNode(); between != op;
+         between = between->getNextNode()) {
+      WalkResult mayWriteSlot = between->walk([&](Operation *nested) {
+        auto set = dyn_cast<GlobalSlotSetOp>(nested);
+        if (isa<func::CallOp>(nested) || (set && set.getSlot() == op.getSlot()))
+          return WalkResult::interrupt();
+        return WalkResult::advance();
+      });
+      if (mayWriteSlot.wasInterrupted())
+        return failure();
+    }
+    rewriter.eraseOp(op);
+    return success();
+  });
+}
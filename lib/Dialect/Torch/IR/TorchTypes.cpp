@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "torch-mlir/Dialect/Torch/IR/TorchTypes.h"
+#include "mlir/Dialect/SparseTensor/IR/SparseTensor.h"
 #include "mlir/IR/DialectImplementation.h"
 #include "torch-mlir/Dialect/Torch/Utils/Utils.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
@@ -108,6 +109,12 @@ bool Torch::isValidSubtype(Type subtype, Type type) {
       return false;
     }
 
+    // `type` must not have a sparse layout that `subtype` doesn't have.
+    if (typeTensorType.getOptionalSparsity() &&
+        typeTensorType.getOptionalSparsity() !=
+            subtypeTensorType.getOptionalSparsity())
+      return false;
+
     return true;
   }
   return false;
@@ -189,6 +196,8 @@ static bool isValidTorchDtype(Type dtype) {
   // Builtin floating point types.
   if (dtype.isa<Float16Type, BFloat16Type, Float32Type, Float64Type>())
     return true;
+  if (dtype.isa<Float8E5M2Type, Float8E4M3FNType>())
+    return true;
   // Builtin integer types.
   if (IntegerType type = dtype.dyn_cast<IntegerType>()) {
     if (type.isSignless() && type.getWidth() == 1)
@@ -218,13 +227,28 @@ Type BaseTensorType::getWithSizesAndDtypeFrom(BaseTensorType other) const {
 
 Type BaseTensorType::getWithSizesAndDtype(
     std::optional<ArrayRef<int64_t>> optionalSizes, Type optionalDtype) const {
+  Attribute optionalSparsity = getOptionalSparsity();
+  if (optionalSparsity &&
+      (!optionalSizes || optionalSizes->size() != getSizes().size()))
+    optionalSparsity = Attribute();
   if (isa<NonValueTensorType>())
-    return NonValueTensorType::get(getContext(), optionalSizes, optionalDtype);
+    return NonValueTensorType::get(getContext(), optionalSizes, optionalDtype,
+                                   optionalSparsity);
   if (isa<ValueTensorType>())
-    return ValueTensorType::get(getContext(), optionalSizes, optionalDtype);
+    return ValueTensorType::get(getContext(), optionalSizes, optionalDtype,
+                                optionalSparsity);
   llvm_unreachable("not a BaseTensorType!");
 }
 
+Type BaseTensorType::getWithStaticInfo(const TensorStaticInfo &info) const {
+  if (TensorStaticInfo(*this) == info)
+    return *this;
+  std::optional<ArrayRef<int64_t>> optionalSizes;
+  if (info.optionalSizes)
+    optionalSizes = ArrayRef(*info.optionalSizes);
+  return getWithSizesAndDtype(optionalSizes, info.optionalDtype);
+}
+
 ValueTensorType BaseTensorType::getWithValueSemantics() const {
   if (auto tensor = dyn_cast<NonValueTensorType>())
     return tensor.getWithValueSemantics();
@@ -236,7 +260,7 @@ ValueTensorType BaseTensorType::getWithValueSemantics() const {
 static LogicalResult
 verifyTensorType(function_ref<InFlightDiagnostic()> emitError,
                  std::optional<ArrayRef<int64_t>> optionalSizes,
-                 Type optionalDtype) {
+                 Type optionalDtype, Attribute optionalSparsity) {
   if (optionalDtype && !isValidTorchDtype(optionalDtype)) {
     emitError() << "invalid dtype " << optionalDtype
                 << " for !torch.tensor type";
@@ -250,6 +274,22 @@ verifyTensorType(function_ref<InFlightDiagnostic()> emitError,
       }
     }
   }
+  if (optionalSparsity) {
+    auto encoding =
+        optionalSparsity.dyn_cast<sparse_tensor::SparseTensorEncodingAttr>();
+    if (!encoding) {
+      emitError() << "invalid sparsity " << optionalSparsity
+                  << " for !torch.tensor type, expected a "
+                     "#sparse_tensor.encoding";
+      return failure();
+    }
+    if (!optionalSizes.has_value() ||
+        encoding.getDimRank() != optionalSizes->size()) {
+      emitError() << "sparsity " << optionalSparsity
+                  << " does not match the sizes of the !torch.tensor type";
+      return failure();
+    }
+  }
   return success();
 }
 
@@ -259,7 +299,8 @@ Type parseTensorType(MLIRContext *context, AsmParser &parser,
   if (parser.parseOptionalLess())
     return getTensorType(context,
                          /*optionalSizes=*/std::nullopt,
-                         /*optionalDtype=*/Type());
+                         /*optionalDtype=*/Type(),
+                         /*optionalSparsity=*/Attribute());
   bool hasSizes;
   SmallVector<int64_t> sizes;
   if (succeeded(parser.parseOptionalStar())) {
@@ -304,6 +345,11 @@ Type parseTensorType(MLIRContext *context, AsmParser &parser,
     if (parser.parseType(optionalDtype))
       return Type();
   }
+  Attribute optionalSparsity;
+  if (succeeded(parser.parseOptionalComma())) {
+    if (parser.parseAttribute(optionalSparsity))
+      return Type();
+  }
   if (parser.parseGreater())
     return Type();
   std::optional<ArrayRef<int64_t>> optionalSizes;
@@ -311,15 +357,16 @@ Type parseTensorType(MLIRContext *context, AsmParser &parser,
     optionalSizes.emplace(sizes);
 
   if (failed(verifyTensorType([&]() { return parser.emitError(startLoc); },
-                              optionalSizes, optionalDtype)))
+                              optionalSizes, optionalDtype, optionalSparsity)))
     return Type();
 
-  return getTensorType(context, optionalSizes, optionalDtype);
+  return getTensorType(context, optionalSizes, optionalDtype,
+                       optionalSparsity);
 }
 
 static void printTensorType(AsmPrinter &printer,
                             std::optional<ArrayRef<int64_t>> optionalSizes,
-                            Type optionalDtype) {
+                            Type optionalDtype, Attribute optionalSparsity) {
   if (!optionalSizes && !optionalDtype)
     return;
   printer << "<";
@@ -342,6 +389,10 @@ static void printTensorType(AsmPrinter &printer,
     printer.printType(optionalDtype);
   else
     printer << "unk";
+  if (optionalSparsity) {
+    printer << ",";
+    printer.printAttribute(optionalSparsity);
+  }
   printer << ">";
 }
 
@@ -351,7 +402,7 @@ static void printTensorType(AsmPrinter &printer,
 
 ValueTensorType NonValueTensorType::getWithValueSemantics() const {
   return ValueTensorType::get(getContext(), getOptionalSizes(),
-                              getOptionalDtype());
+                              getOptionalDtype(), getOptionalSparsity());
 }
 
 NonValueTensorType
@@ -364,8 +415,9 @@ NonValueTensorType::getWithLeastStaticInformation(MLIRContext *context) {
 LogicalResult
 NonValueTensorType::verify(function_ref<InFlightDiagnostic()> emitError,
                            std::optional<ArrayRef<int64_t>> optionalSizes,
-                           Type optionalDtype) {
-  return verifyTensorType(emitError, optionalSizes, optionalDtype);
+                           Type optionalDtype, Attribute optionalSparsity) {
+  return verifyTensorType(emitError, optionalSizes, optionalDtype,
+                          optionalSparsity);
 }
 
 Type NonValueTensorType::parse(AsmParser &parser) {
@@ -373,13 +425,15 @@ Type NonValueTensorType::parse(AsmParser &parser) {
   return parseTensorType(
       context, parser,
       [](MLIRContext *context, std::optional<ArrayRef<int64_t>> optionalSizes,
-         Type optionalType) {
-        return NonValueTensorType::get(context, optionalSizes, optionalType);
+         Type optionalType, Attribute optionalSparsity) {
+        return NonValueTensorType::get(context, optionalSizes, optionalType,
+                                       optionalSparsity);
       });
 }
 
 void NonValueTensorType::print(AsmPrinter &printer) const {
-  printTensorType(printer, getOptionalSizes(), getOptionalDtype());
+  printTensorType(printer, getOptionalSizes(), getOptionalDtype(),
+                  getOptionalSparsity());
 }
 
 //===----------------------------------------------------------------------===//
@@ -388,7 +442,7 @@ void NonValueTensorType::print(AsmPrinter &printer) const {
 
 NonValueTensorType ValueTensorType::getWithoutValueSemantics() const {
   return NonValueTensorType::get(getContext(), getOptionalSizes(),
-                                 getOptionalDtype());
+                                 getOptionalDtype(), getOptionalSparsity());
 }
 
 ValueTensorType
@@ -404,6 +458,10 @@ static Type convertDtypeToBuiltinElementType(MLIRContext *context, Type dtype) {
   } else if (auto integerType = dtype.dyn_cast<IntegerType>()) {
     return IntegerType::get(context, integerType.getWidth(),
                             IntegerType::Signless);
+  } else if (dtype.isa<Torch::QInt8Type, Torch::QUInt8Type>()) {
+    // Quantized tensors are represented by their integer representation. Their
+    // scale and zero point are carried by the ops that produce them.
+    return IntegerType::get(context, 8, IntegerType::Signless);
   } else if (auto complexType = dtype.dyn_cast<mlir::ComplexType>()) {
     // torch-complex types add the precision of the real and imag values to
     // get the final precision i.e., if the real and imag value is of `float`
@@ -433,14 +491,16 @@ TensorType ValueTensorType::toBuiltinTensor() const {
   Type elementType = convertDtypeToBuiltinElementType(getContext(), getDtype());
   if (!elementType)
     return nullptr;
-  return RankedTensorType::get(makeShapeLLVMCompatible(getSizes()), elementType);
+  return RankedTensorType::get(makeShapeLLVMCompatible(getSizes()), elementType,
+                               getOptionalSparsity());
 }
 
 LogicalResult
 ValueTensorType::verify(function_ref<InFlightDiagnostic()> emitError,
                         std::optional<ArrayRef<int64_t>> optionalSizes,
-                        Type optionalDtype) {
-  return verifyTensorType(emitError, optionalSizes, optionalDtype);
+                        Type optionalDtype, Attribute optionalSparsity) {
+  return verifyTensorType(emitError, optionalSizes, optionalDtype,
+                          optionalSparsity);
 }
 
 Type ValueTensorType::parse(AsmParser &parser) {
@@ -448,54 +508,54 @@ Type ValueTensorType::parse(AsmParser &parser) {
   return parseTensorType(
       context, parser,
       [](MLIRContext *context, std::optional<ArrayRef<int64_t>> optionalSizes,
-         Type optionalType) {
-        return ValueTensorType::get(context, optionalSizes, optionalType);
+         Type optionalType, Attribute optionalSparsity) {
+        return ValueTensorType::get(context, optionalSizes, optionalType,
+                                    optionalSparsity);
       });
 }
 
 void ValueTensorType::print(AsmPrinter &printer) const {
-  printTensorType(printer, getOptionalSizes(), getOptionalDtype());
+  printTensorType(printer, getOptionalSizes(), getOptionalDtype(),
+                  getOptionalSparsity());
 }
 
-Type Torch::meetTensorTypes(BaseTensorType lhs, BaseTensorType rhs) {
-  assert(((lhs.isa<ValueTensorType>() && rhs.isa<ValueTensorType>()) ||
-          (lhs.isa<NonValueTensorType>() && rhs.isa<NonValueTensorType>())) &&
-         "expected lhs and rhs to have same sense of value semantics");
-
+std::optional<TensorStaticInfo>
+Torch::meetTensorStaticInfo(const TensorStaticInfo &lhs,
+                            const TensorStaticInfo &rhs) {
   // First, calculate the dtype.
 
   // If the dtypes are contradictory, return null.
-  if (lhs.hasDtype() && rhs.hasDtype() && lhs.getDtype() != rhs.getDtype())
-    return nullptr;
-  Type dtype;
+  if (lhs.optionalDtype && rhs.optionalDtype &&
+      lhs.optionalDtype != rhs.optionalDtype)
+    return std::nullopt;
   // If we have a dtype, use it. If not, then the dtype Type remains in its
   // default null state, which the constructor of ValueTensorType treats as
   // "unknown".
-  if (lhs.hasDtype() || rhs.hasDtype()) {
-    dtype = lhs.hasDtype() ? lhs.getDtype() : rhs.getDtype();
-  }
+  TensorStaticInfo meet;
+  meet.optionalDtype =
+      lhs.optionalDtype ? lhs.optionalDtype : rhs.optionalDtype;
 
-  // Then, calculate the sizes and return the new Type.
+  // Then, calculate the sizes.
 
   // If neither has sizes, we have nothing left to do.
-  if (!lhs.hasSizes() && !rhs.hasSizes()) {
-    return ValueTensorType::get(lhs.getContext(),
-                                /*optionalSizes=*/std::nullopt, dtype);
-  }
+  if (!lhs.optionalSizes && !rhs.optionalSizes)
+    return meet;
 
   // If the number of sizes is different, the two types are contradictory.
-  if (lhs.hasSizes() && rhs.hasSizes() &&
-      lhs.getSizes().size() != rhs.getSizes().size()) {
-    return nullptr;
+  if (lhs.optionalSizes && rhs.optionalSizes &&
+      lhs.optionalSizes->size() != rhs.optionalSizes->size()) {
+    return std::nullopt;
   }
 
   // Either lhs or rhs has sizes. If either one doesn't have sizes, we can
   // replace it with the other one's sizes, since the meet logic below is
   // idempotent.
-  ArrayRef<int64_t> lhsSizes = lhs.hasSizes() ? lhs.getSizes() : rhs.getSizes();
-  ArrayRef<int64_t> rhsSizes = rhs.hasSizes() ? rhs.getSizes() : lhs.getSizes();
+  ArrayRef<int64_t> lhsSizes =
+      lhs.optionalSizes ? *lhs.optionalSizes : *rhs.optionalSizes;
+  ArrayRef<int64_t> rhsSizes =
+      rhs.optionalSizes ? *rhs.optionalSizes : *lhs.optionalSizes;
   // Meet the sizes.
-  SmallVector<int64_t> newSizes;
+  SmallVector<int64_t> &newSizes = meet.optionalSizes.emplace();
   for (int i = 0, e = lhsSizes.size(); i < e; i++) {
     if (lhsSizes[i] == rhsSizes[i]) {
       newSizes.push_back(lhsSizes[i]);
@@ -505,11 +565,45 @@ Type Torch::meetTensorTypes(BaseTensorType lhs, BaseTensorType rhs) {
       newSizes.push_back(lhsSizes[i]);
     } else {
       // The two sizes are contradictory.
-      return nullptr;
+      return std::nullopt;
     }
   }
+  return meet;
+}
+
+TensorStaticInfo Torch::joinTensorStaticInfo(const TensorStaticInfo &lhs,
+                                             const TensorStaticInfo &rhs) {
+  TensorStaticInfo join;
+  // The dtype is only known if both agree on it.
+  if (lhs.optionalDtype == rhs.optionalDtype)
+    join.optionalDtype = lhs.optionalDtype;
+
+  // The rank is only known if both agree on it, and then each size is.
+  if (!lhs.optionalSizes || !rhs.optionalSizes ||
+      lhs.optionalSizes->size() != rhs.optionalSizes->size())
+    return join;
+  SmallVector<int64_t> &newSizes = join.optionalSizes.emplace();
+  for (auto [lhsSize, rhsSize] : llvm::zip(*lhs.optionalSizes,
+                                           *rhs.optionalSizes))
+    newSizes.push_back(lhsSize == rhsSize ? lhsSize : kUnknownSize);
+  return join;
+}
+
+Type Torch::meetTensorTypes(BaseTensorType lhs, BaseTensorType rhs) {
+  assert(((lhs.isa<ValueTensorType>() && rhs.isa<ValueTensorType>()) ||
+          (lhs.isa<NonValueTensorType>() && rhs.isa<NonValueTensorType>())) &&
+         "expected lhs and rhs to have same sense of value semantics");
+  std::optional<TensorStaticInfo> meet = meetTensorStaticInfo(lhs, rhs);
+  if (!meet)
+    return nullptr;
+  return lhs.getWithStaticInfo(*meet);
+}
 
-  return lhs.getWithSizesAndDtype(ArrayRef(newSizes), dtype);
+Type Torch::joinTensorTypes(BaseTensorType lhs, BaseTensorType rhs) {
+  assert(((lhs.isa<ValueTensorType>() && rhs.isa<ValueTensorType>()) ||
+          (lhs.isa<NonValueTensorType>() && rhs.isa<NonValueTensorType>())) &&
+         "expected lhs and rhs to have same sense of value semantics");
+  return lhs.getWithStaticInfo(joinTensorStaticInfo(lhs, rhs));
 }
 
 ////===----------------------------------------------------------------------===//
@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ActivationLiveness.h"
+
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "llvm/ADT/DenseSet.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+int64_t Torch::getActivationBytes(Value value) {
+  auto type = value.getType().dyn_cast<BaseTensorType>();
+  if (!type || !type.areAllSizesKnown() || !type.hasDtype() ||
+      !type.getDtype().isIntOrFloat())
+    return 0;
+  int64_t numElements = 1;
+  for (int64_t size : type.getSizes())
+    numElements *= size;
+  return numElements *
+         llvm::divideCeil(type.getDtype().getIntOrFloatBitWidth(), 8);
+}
+
+bool Torch::isReorderable(Operation *op) {
+  if (op->hasTrait<mlir::OpTrait::IsTerminator>())
+    return false;
+  if (op->hasTrait<Torch::OpTrait::HasValueSemantics>() &&
+      op->getNumRegions() == 0)
+    return true;
+  return isMemoryEffectFree(op);
+}
+
+BlockLiveness::BlockLiveness(Block &block) {
+  for (Operation &op : block) {
+    SmallVector<Value> &used = usedValues[&op];
+    op.walk([&](Operation *nested) {
+      for (Value operand : nested->getOperands()) {
+        if (operand.getParentBlock() == &block &&
+            !operand.isa<BlockArgument>() &&
+            !llvm::is_contained(used, operand))
+          used.push_back(operand);
+      }
+    });
+    if (isa<ValueTensorLiteralOp, NonValueTensorLiteralOp>(op))
+      continue;
+    for (Value result : op.getResults()) {
+      int64_t bytes = getActivationBytes(result);
+      if (bytes == 0)
+        continue;
+      bytesOf[result] = bytes;
+      bool usedOutside = false;
+      DenseSet<Operation *> users;
+      for (Operation *user : result.getUsers()) {
+        if (Operation *ancestor = block.findAncestorOpInBlock(*user))
+          users.insert(ancestor);
+        else
+          usedOutside = true;
+      }
+      // Values used outside of the block are never freed.
+      numUsersOf[result] = users.size() + (usedOutside ? 1 : 0);
+    }
+  }
+}
+
+int64_t BlockLiveness::computePeakBytes(ArrayRef<Operation *> order,
+                                        Operation **peakOp) {
+  DenseMap<Value, unsigned> remainingUsers;
+  int64_t liveBytes = 0, peakBytes = 0;
+  for (Operation *op : order) {
+    for (Value result : op->getResults())
+      liveBytes += getBytes(result);
+    if (liveBytes > peakBytes) {
+      peakBytes = liveBytes;
+      if (peakOp)
+        *peakOp = op;
+    }
+    for (Value used : getUsedValues(op)) {
+      if (getBytes(used) == 0)
+        continue;
+      auto it = remainingUsers.try_emplace(used, getNumUsers(used)).first;
+      if (--it->second == 0)
+        liveBytes -= getBytes(used);
+    }
+    for (Value result : op->getResults()) {
+      if (getNumUsers(result) == 0)
+        liveBytes -= getBytes(result);
+    }
+  }
+  return peakBytes;
+}
@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TORCHMLIR_DIALECT_TORCH_TRANSFORMS_ACTIVATION_LIVENESS_H
+#define TORCHMLIR_DIALECT_TORCH_TRANSFORMS_ACTIVATION_LIVENESS_H
+
+#include "mlir/IR/Block.h"
+#include "llvm/ADT/DenseMap.h"
+
+namespace mlir {
+namespace torch {
+namespace Torch {
+
+// Returns the number of bytes of the activation `value`, or 0 if it isn't a
+// tensor with static sizes and a dtype.
+int64_t getActivationBytes(Value value);
+
+// Returns true if `op` can be moved past, or duplicated among, the ops it
+// doesn't depend on: it has value semantics and no regions, or no memory
+// effects.
+bool isReorderable(Operation *op);
+
+// The liveness of the activations defined in a block, for a given order of its
+// ops. A value is live from the op defining it until the last op using it, or
+// until the end of the block if it is used outside of it. Literals are the
+// parameters of the model, so they aren't activations.
+class BlockLiveness {
+public:
+  explicit BlockLiveness(Block &block);
+
+  // The values defined in the block that `op` or the ops nested in it use.
+  ArrayRef<Value> getUsedValues(Operation *op) { return usedValues[op]; }
+
+  int64_t getBytes(Value value) { return bytesOf.lookup(value); }
+
+  // Returns the number of ops in the block that use the activation `value`,
+  // plus one if it is used outside of the block.
+  unsigned getNumUsers(Value value) { return numUsersOf.lookup(value); }
+
+  // Returns the peak of the bytes of the live activations when the ops of the
+  // block run in `order`, and sets `peakOp` to the first op running at the
+  // peak. The operands and results of an op are live at the same time while it
+  // runs.
+  int64_t computePeakBytes(ArrayRef<Operation *> order,
+                           Operation **peakOp = nullptr);
+
+private:
+  DenseMap<Operation *, SmallVector<Value>> usedValues;
+  DenseMap<Value, int64_t> bytesOf;
+  DenseMap<Value, unsigned> numUsersOf;
+};
+
+} // namespace Torch
+} // namespace torch
+} // namespace mlir
+
+#endif // TORCHMLIR_DIALECT_TORCH_TRANSFORMS_ACTIVATION_LIVENESS_H
@@ -69,6 +69,17 @@ public:
     rewriter.applySignatureConversion(&func.getBody(), conversion,
                                       typeConverter);
 
+    // Keep the other attributes of the remaining arguments, such as
+    // `torch.donated`.
+    SmallVector<DictionaryAttr> newArgAttrs;
+    for (auto type : llvm::enumerate(func.getArgumentTypes())) {
+      if (type.value().isa<Torch::NoneType>())
+        continue;
+      NamedAttrList attrs(func.getArgAttrDict(type.index()));
+      attrs.erase(typeBoundIdent);
+      newArgAttrs.push_back(attrs.getDictionary(context));
+    }
+
     SmallVector<Type> newResultTypes;
     for (auto type : func.getFunctionType().getResults()) {
       if (auto none = type.dyn_cast<Torch::NoneType>()) {
@@ -84,8 +95,7 @@ public:
       func.setType(FunctionType::get(
           getContext(), conversion.getConvertedTypes(), newResultTypes));
       // Clear out the type bounds, now that the type incorporates them.
-      for (int i = 0, e = func.getNumArguments(); i != e; i++)
-        func.removeArgAttr(i, typeBoundIdent);
+      func.setAllArgAttrs(newArgAttrs);
     });
     return success();
   }
@@ -0,0 +1,216 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "llvm/ADT/StringSet.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+// The ops computed in the lower precision when no allowlist is given: the
+// matmuls, convolutions and attention, which dominate the memory traffic and
+// are the least sensitive to the precision of their inputs.
+static const char *const kDefaultMixedPrecisionOps[] = {
+    "aten.mm",
+    "aten.bmm",
+    "aten.matmul",
+    "aten.addmm",
+    "aten.baddbmm",
+    "aten.linear",
+    "aten.convolution",
+    "aten._convolution",
+    "aten.conv2d",
+    "aten.conv_transpose2d.input",
+    "aten.scaled_dot_product_attention",
+};
+
+// Returns true if `op` only converts the dtype of its input, so that it can be
+// looked through.
+static bool isPlainDtypeConversion(AtenToDtypeOp op) {
+  bool nonBlocking, copy;
+  return matchPattern(op.getNonBlocking(), m_TorchConstantBool(&nonBlocking)) &&
+         !nonBlocking &&
+         matchPattern(op.getCopy(), m_TorchConstantBool(&copy)) && !copy &&
+         op.getMemoryFormat().getType().isa<Torch::NoneType>();
+}
+
+// Returns the dtype of `value` if it is a value tensor with sizes and a known
+// dtype, and nullptr otherwise.
+static Type getValueTensorDtype(Value value) {
+  auto type = value.getType().dyn_cast<ValueTensorType>();
+  if (!type || !type.hasSizes() || !type.hasDtype())
+    return nullptr;
+  return type.getDtype();
+}
+
+namespace {
+// Computes an allowlisted op in `lowDtype`: its f32 tensor operands are
+// converted to `lowDtype`, and its results, which are then of `lowDtype`, are
+// converted back to f32 for its users. Everything else, in particular the
+// reductions and normalizations, keeps computing in f32.
+class ComputeInLowerPrecision : public RewritePattern {
+public:
+  ComputeInLowerPrecision(MLIRContext *context, Type lowDtype,
+                          const llvm::StringSet<> &ops)
+      : RewritePattern(MatchAnyOpTypeTag(), /*benefit=*/1, context),
+        lowDtype(lowDtype), ops(ops) {}
+  LogicalResult matchAndRewrite(Operation *op,
+                                PatternRewriter &rewriter) const override {
+    if (!ops.contains(op->getName().getStringRef().ltrim(kTorchOpPrefix)))
+      return rewriter.notifyMatchFailure(op, "not an allowlisted op");
+
+    bool hasF32Operand = false;
+    for (Value operand : op->getOperands()) {
+      if (!operand.getType().isa<BaseTensorType>())
+        continue;
+      Type dtype = getValueTensorDtype(operand);
+      if (!dtype)
+        return rewriter.notifyMatchFailure(
+            op, "expected value tensor operands with sizes and dtypes");
+      if (dtype.isF32())
+        hasF32Operand = true;
+      else if (dtype.isa<mlir::FloatType>() && dtype != lowDtype)
+        return rewriter.notifyMatchFailure(op, "unsupported operand dtype");
+    }
+    if (!hasF32Operand)
+      return rewriter.notifyMatchFailure(op, "no f32 operand");
+    for (Value result : op->getResults()) {
+      if (!result.getType().isa<BaseTensorType>())
+        continue;
+      Type dtype = getValueTensorDtype(result);
+      if (!dtype || !dtype.isF32())
+        return rewriter.notifyMatchFailure(
+            op, "expected f32 value tensor results with sizes");
+    }
+
+    Location loc = op->getLoc();
+    rewriter.setInsertionPoint(op);
+    for (OpOperand &operand : op->getOpOperands()) {
+      Type dtype = getValueTensorDtype(operand.get());
+      if (!dtype || !dtype.isF32())
+        continue;
+      Value converted =
+          convertTensorToDtype(rewriter, loc, operand.get(), lowDtype);
+      rewriter.updateRootInPlace(op, [&]() { operand.set(converted); });
+    }
+    rewriter.setInsertionPointAfter(op);
+    Type f32 = rewriter.getF32Type();
+    for (OpResult result : op->getResults()) {
+      auto type = result.getType().dyn_cast<ValueTensorType>();
+      if (!type)
+        continue;
+      rewriter.updateRootInPlace(op, [&]() {
+        result.setType(type.getWithSizesAndDtype(type.getSizes(), lowDtype));
+      });
+      Value converted = convertTensorToDtype(rewriter, loc, result, f32);
+      for (OpOperand &use : llvm::make_early_inc_range(result.getUses())) {
+        if (use.getOwner() != converted.getDefiningOp())
+          rewriter.updateRootInPlace(use.getOwner(),
+                                     [&]() { use.set(converted); });
+      }
+    }
+    return success();
+  }
+
+private:
+  Type lowDtype;
+  const llvm::StringSet<> &ops;
+};
+} // namespace
+
+namespace {
+// Folds the conversion of a tensor to a wider floating point dtype and back,
+// such as the conversion of the f32 result of an op computed in bf16 back to
+// bf16 for the next op computed in bf16. Widening is exact, so the round trip
+// is the identity.
+class FoldDtypeRoundTrip : public OpRewritePattern<AtenToDtypeOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(AtenToDtypeOp op,
+                                PatternRewriter &rewriter) const override {
+    auto widen = op.getSelf().getDefiningOp<AtenToDtypeOp>();
+    if (!widen || !isPlainDtypeConversion(op) ||
+        !isPlainDtypeConversion(widen))
+      return rewriter.notifyMatchFailure(op, "not a round trip");
+    Value input = widen.getSelf();
+    Type dtype = getValueTensorDtype(input);
+    Type wideDtype = getValueTensorDtype(widen);
+    if (!dtype || !wideDtype || input.getType() != op.getType())
+      return rewriter.notifyMatchFailure(
+          op, "expected a round trip between value tensors of known dtypes");
+    if (!dtype.isa<mlir::FloatType>() ||
+        !(wideDtype.isF32() || wideDtype.isF64()) ||
+        wideDtype.getIntOrFloatBitWidth() <= dtype.getIntOrFloatBitWidth())
+      return rewriter.notifyMatchFailure(
+          op, "expected a round trip through a wider float dtype");
+    rewriter.replaceOp(op, input);
+    if (widen->use_empty())
+      rewriter.eraseOp(widen);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+class AutoMixedPrecisionPass
+    : public AutoMixedPrecisionBase<AutoMixedPrecisionPass> {
+public:
+  AutoMixedPrecisionPass() = default;
+  AutoMixedPrecisionPass(StringRef dtype, ArrayRef<std::string> ops) {
+    this->dtype = dtype.str();
+    this->ops = ops;
+  }
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    StringRef dtypeName(dtype.getValue());
+    Type lowDtype;
+    if (dtypeName == "bf16")
+      lowDtype = BFloat16Type::get(context);
+    else if (dtypeName == "f16")
+      lowDtype = Float16Type::get(context);
+    else {
+      emitError(getOperation().getLoc())
+          << "unsupported mixed precision dtype '" << dtypeName
+          << "', expected 'bf16' or 'f16'";
+      return signalPassFailure();
+    }
+
+    // The strings in the `ops` ArrayRef don't exist during the call to the
+    // constructor, so the set is created here.
+    opsSet.clear();
+    if (ops.empty())
+      opsSet.insert(std::begin(kDefaultMixedPrecisionOps),
+                    std::end(kDefaultMixedPrecisionOps));
+    else
+      opsSet.insert(ops.begin(), ops.end());
+
+    RewritePatternSet patterns(context);
+    patterns.add<ComputeInLowerPrecision>(context, lowDtype, opsSet);
+    patterns.add<FoldDtypeRoundTrip>(context);
+    if (failed(applyPatternsAndFoldGreedily(getOperation(),
+                                            std::move(patterns))))
+      return signalPassFailure();
+  }
+
+private:
+  llvm::StringSet<> opsSet;
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::Torch::createAutoMixedPrecisionPass(StringRef dtype,
+                                                 ArrayRef<std::string> ops) {
+  return std::make_unique<AutoMixedPrecisionPass>(dtype, ops);
+}
@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Rewrite/FrozenRewritePatternSet.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+struct mlir::torch::Torch::SharedCanonicalizationPatterns {
+  MLIRContext *context = nullptr;
+  FrozenRewritePatternSet patterns;
+};
+
+std::shared_ptr<SharedCanonicalizationPatterns>
+mlir::torch::Torch::createSharedCanonicalizationPatterns() {
+  return std::make_shared<SharedCanonicalizationPatterns>();
+}
+
+// Returns the canonicalization patterns of the Torch and func dialects and of
+// their ops, which are the only ops of the Torch backend IR. The canonicalizer
+// also collects the patterns of every other loaded dialect.
+static FrozenRewritePatternSet
+getTorchCanonicalizationPatterns(MLIRContext *context) {
+  RewritePatternSet patterns(context);
+  for (Dialect *dialect : {context->getLoadedDialect<TorchDialect>(),
+                           context->getLoadedDialect<func::FuncDialect>()}) {
+    if (dialect)
+      dialect->getCanonicalizationPatterns(patterns);
+  }
+  for (RegisteredOperationName op : context->getRegisteredOperations()) {
+    if (isa<TorchDialect, func::FuncDialect>(op.getDialect()))
+      op.getCanonicalizationPatterns(patterns, context);
+  }
+  return FrozenRewritePatternSet(std::move(patterns));
+}
+
+namespace {
+class CanonicalizePass : public CanonicalizeBase<CanonicalizePass> {
+public:
+  CanonicalizePass() = default;
+  CanonicalizePass(std::shared_ptr<SharedCanonicalizationPatterns> shared)
+      : shared(std::move(shared)) {}
+
+  LogicalResult initialize(MLIRContext *context) override {
+    // Passes are initialized one at a time, before any of them runs, so the
+    // shared patterns are built by the first pass using them.
+    if (!shared)
+      shared = createSharedCanonicalizationPatterns();
+    if (shared->context != context) {
+      shared->patterns = getTorchCanonicalizationPatterns(context);
+      shared->context = context;
+    }
+    patterns = shared->patterns;
+    return success();
+  }
+
+  void runOnOperation() override {
+    // As for the canonicalizer.
+    GreedyRewriteConfig config;
+    config.useTopDownTraversal = true;
+    (void)applyPatternsAndFoldGreedily(getOperation(), patterns, config);
+  }
+
+private:
+  std::shared_ptr<SharedCanonicalizationPatterns> shared;
+  FrozenRewritePatternSet patterns;
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::Torch::createCanonicalizePass(
+    std::shared_ptr<SharedCanonicalizationPatterns> patterns) {
+  return std::make_unique<CanonicalizePass>(std::move(patterns));
+}
@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+namespace {
+// The compressed weight of a linear op, see
+// `torch.semi_structured_sparse.linear`.
+struct CompressedWeight {
+  Value values;
+  Value indices;
+};
+} // namespace
+
+// Compresses the [N, K] weight `attr`, with `K` a multiple of 4, and creates
+// the literals of its values and indices after `literal`. Returns std::nullopt
+// if a group of 4 weights has more than 2 nonzeros.
+static std::optional<CompressedWeight>
+compressWeight(OpBuilder &b, ValueTensorLiteralOp literal,
+               DenseFPElementsAttr attr) {
+  int64_t rows = attr.getType().getDimSize(0);
+  int64_t cols = attr.getType().getDimSize(1);
+  SmallVector<APFloat> weight(attr.getValues<APFloat>());
+
+  SmallVector<APFloat> values;
+  SmallVector<int8_t> indices;
+  values.reserve(rows * cols / 2);
+  indices.reserve(rows * cols / 2);
+  for (int64_t group = 0, e = rows * cols / 4; group < e; group++) {
+    ArrayRef<APFloat> groupWeights = ArrayRef(weight).slice(group * 4, 4);
+    SmallVector<int8_t, 2> groupIndices;
+    for (int8_t i = 0; i < 4; i++) {
+      if (!groupWeights[i].isZero())
+        groupIndices.push_back(i);
+    }
+    if (groupIndices.size() > 2)
+      return std::nullopt;
+    // Store zeros at the first free positions of the groups with fewer than
+    // 2 nonzeros, keeping the indices of each group sorted.
+    for (int8_t i = 0; groupIndices.size() < 2; i++) {
+      if (!llvm::is_contained(groupIndices, i))
+        groupIndices.insert(llvm::lower_bound(groupIndices, i), i);
+    }
+    for (int8_t i : groupIndices) {
+      values.push_back(groupWeights[i]);
+      indices.push_back(i);
+    }
+  }
+
+  MLIRContext *context = b.getContext();
+  Location loc = literal.getLoc();
+  b.setInsertionPointAfter(literal);
+  auto valuesType =
+      RankedTensorType::get({rows, cols / 2}, attr.getElementType());
+  auto indicesType = RankedTensorType::get(
+      {rows, cols / 2}, IntegerType::get(context, 8, IntegerType::Signed));
+  CompressedWeight result;
+  result.values = b.create<ValueTensorLiteralOp>(
+      loc, DenseElementsAttr::get(valuesType, values));
+  result.indices = b.create<ValueTensorLiteralOp>(
+      loc, DenseElementsAttr::get(indicesType, ArrayRef<int8_t>(indices)));
+  return result;
+}
+
+namespace {
+class CompressSparseLinearWeightsPass
+    : public CompressSparseLinearWeightsBase<CompressSparseLinearWeightsPass> {
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+
+    // Weights shared by several linear ops are compressed once. Dense weights
+    // are remembered too, so that they are only checked once.
+    DenseMap<Operation *, std::optional<CompressedWeight>> compressedWeights;
+    SmallVector<ValueTensorLiteralOp> literals;
+    OpBuilder b(func.getContext());
+    func.walk([&](AtenLinearOp op) {
+      auto literal = op.getWeight().getDefiningOp<ValueTensorLiteralOp>();
+      auto attr = literal ? literal.getValue().dyn_cast<DenseFPElementsAttr>()
+                          : nullptr;
+      auto resultType = op.getType().dyn_cast<ValueTensorType>();
+      if (!attr || !resultType || !resultType.hasDtype() ||
+          resultType.getDtype() != attr.getElementType() ||
+          attr.getType().getRank() != 2 ||
+          attr.getType().getDimSize(1) % 4 != 0)
+        return;
+
+      auto it = compressedWeights.find(literal);
+      if (it == compressedWeights.end()) {
+        it = compressedWeights
+                 .try_emplace(literal, compressWeight(b, literal, attr))
+                 .first;
+        if (it->second) {
+          literals.push_back(literal);
+          ++numCompressedWeights;
+        }
+      }
+      if (!it->second)
+        return;
+      b.setInsertionPoint(op);
+      Value result = b.create<SemiStructuredSparseLinearOp>(
+          op.getLoc(), resultType, op.getInput(), it->second->values,
+          it->second->indices, op.getBias());
+      op.replaceAllUsesWith(result);
+      op.erase();
+    });
+    for (ValueTensorLiteralOp literal : literals) {
+      if (literal->use_empty())
+        literal.erase();
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::Torch::createCompressSparseLinearWeightsPass() {
+  return std::make_unique<CompressSparseLinearWeightsPass>();
+}
@@ -15,12 +15,18 @@
 #include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchTypes.h"
+#include "torch-mlir/Dialect/Torch/Transforms/DecompositionCostModel.h"
 #include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
 #include "torch-mlir/Dialect/Torch/Utils/Utils.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
+#include "llvm/ADT/bit.h"
+#include <array>
 #include <cstdint>
+#include <functional>
+#include <limits>
 
 using namespace mlir;
 using namespace mlir::torch;
@@ -467,6 +473,102 @@ public:
 };
 } // namespace
 
+// Decompose aten.scaled_dot_product_attention into
+//   softmax(matmul(query, key^T) * scale + attn_mask, -1) @ value
+// for the cases without dropout or a causal mask, and with an additive
+// (floating-point) mask if any.
+namespace {
+class DecomposeAtenScaledDotProductAttentionOp
+    : public OpRewritePattern<AtenScaledDotProductAttentionOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(AtenScaledDotProductAttentionOp op,
+                                PatternRewriter &rewriter) const override {
+    Location loc = op.getLoc();
+    Value query = op.getQuery();
+    Value key = op.getKey();
+    auto queryType = query.getType().cast<BaseTensorType>();
+    auto keyType = key.getType().cast<BaseTensorType>();
+    if (!queryType.hasSizes() || !keyType.hasSizes() ||
+        !queryType.hasDtype() ||
+        !queryType.getDtype().isa<mlir::FloatType>())
+      return rewriter.notifyMatchFailure(
+          op, "expected query and key of known sizes and float dtype");
+    ArrayRef<int64_t> querySizes = queryType.getSizes();
+    ArrayRef<int64_t> keySizes = keyType.getSizes();
+    int64_t rank = querySizes.size();
+    if (rank < 2 || keySizes.size() != querySizes.size())
+      return rewriter.notifyMatchFailure(
+          op, "expected query and key of the same rank");
+
+    double dropout;
+    if (!matchPattern(op.getDropoutP(), m_TorchConstantFloat(&dropout)) ||
+        dropout != 0.0)
+      return rewriter.notifyMatchFailure(op, "dropout is not supported");
+    bool isCausal;
+    if (!matchPattern(op.getIsCausal(), m_TorchConstantBool(&isCausal)) ||
+        isCausal)
+      return rewriter.notifyMatchFailure(op, "causal masks are not supported");
+    Value mask = op.getAttnMask();
+    if (!mask.getType().isa<Torch::NoneType>()) {
+      auto maskType = mask.getType().cast<BaseTensorType>();
+      if (!maskType.hasDtype() || !maskType.getDtype().isa<mlir::FloatType>())
+        return rewriter.notifyMatchFailure(
+            op, "only additive float masks are supported");
+    }
+    double scale;
+    if (op.getScale().getType().isa<Torch::NoneType>()) {
+      if (querySizes.back() == kUnknownSize)
+        return rewriter.notifyMatchFailure(
+            op, "the default scale needs a static head dim");
+      scale = 1.0 / std::sqrt(static_cast<double>(querySizes.back()));
+    } else if (!matchPattern(op.getScale(), m_TorchConstantFloat(&scale))) {
+      return rewriter.notifyMatchFailure(op, "scale must be a constant");
+    }
+
+    SmallVector<int64_t> keyTransposedSizes(keySizes);
+    std::swap(keyTransposedSizes[rank - 2], keyTransposedSizes[rank - 1]);
+    SmallVector<int64_t> scoresSizes(querySizes);
+    for (int64_t i = 0; i < rank - 2; ++i) {
+      if (querySizes[i] != keySizes[i])
+        scoresSizes[i] = kUnknownSize;
+    }
+    scoresSizes[rank - 1] = keySizes[rank - 2];
+    Type dtype = queryType.getDtype();
+    Type keyTransposedType = keyType.getWithSizesAndDtype(
+        keyTransposedSizes, keyType.getOptionalDtype());
+    Type scoresType = queryType.getWithSizesAndDtype(scoresSizes, dtype);
+
+    Value minusOne =
+        rewriter.create<ConstantIntOp>(loc, rewriter.getI64IntegerAttr(-1));
+    Value minusTwo =
+        rewriter.create<ConstantIntOp>(loc, rewriter.getI64IntegerAttr(-2));
+    Value keyTransposed = rewriter.create<AtenTransposeIntOp>(
+        loc, keyTransposedType, key, minusTwo, minusOne);
+    Value scores = rewriter.create<AtenMatmulOp>(loc, scoresType, query,
+                                                 keyTransposed);
+    Value scaleValue =
+        rewriter.create<ConstantFloatOp>(loc, rewriter.getF64FloatAttr(scale));
+    scores = rewriter.create<AtenMulScalarOp>(loc, scoresType, scores,
+                                              scaleValue);
+    if (!mask.getType().isa<Torch::NoneType>()) {
+      Value one =
+          rewriter.create<ConstantIntOp>(loc, rewriter.getI64IntegerAttr(1));
+      scores = rewriter.create<AtenAddTensorOp>(
+          loc, queryType.getWithSizesAndDtype(std::nullopt, dtype), scores,
+          mask, /*alpha=*/one);
+      scores = rewriter.create<TensorStaticInfoCastOp>(loc, scoresType, scores);
+    }
+    Value none = rewriter.create<ConstantNoneOp>(loc);
+    Value probs = rewriter.create<AtenSoftmaxIntOp>(loc, scoresType, scores,
+                                                    minusOne, /*dtype=*/none);
+    rewriter.replaceOpWithNewOp<AtenMatmulOp>(op, op.getType(), probs,
+                                              op.getValue());
+    return success();
+  }
+};
+} // namespace
+
 // Aten_SoftmaxBackwardDataOp(gradOutput, output, dim) =>
 //    newGrad = gradOutput * output
 //    result = newGrad - output * sum(newGrad, dim))
@@ -880,6 +982,426 @@ public:
 };
 } // namespace
 
+// Decompose aten.einsum into: aten.permute, aten.view, aten.sum.dim_IntList,
+// aten.mm and aten.bmm.
+namespace {
+// The labels of the dims of the operands and of the result of an einsum.
+struct EinsumEquation {
+  SmallVector<std::string> inputLabels;
+  std::string outputLabels;
+};
+} // namespace
+
+// Returns whether `term` is made of letters and at most one ellipsis.
+static bool isValidEinsumTerm(StringRef term) {
+  if (llvm::any_of(term, [](char c) { return c != '.' && !llvm::isAlpha(c); }))
+    return false;
+  size_t numDots = term.count('.');
+  return numDots == 0 || (numDots == 3 && term.contains("..."));
+}
+
+// Parses the einsum `equation` of operands of ranks `ranks`. The dims of an
+// ellipsis are labeled '0', '1', ..., aligned to the right across operands.
+// They come first in an implicit output, followed by the labels that appear
+// once, in alphabetical order. Labels repeated within an operand, which take
+// diagonals, are not supported.
+static FailureOr<EinsumEquation> parseEinsumEquation(StringRef equation,
+                                                     ArrayRef<int64_t> ranks) {
+  std::string compact;
+  for (char c : equation) {
+    if (c != ' ')
+      compact.push_back(c);
+  }
+  StringRef inputs = compact, output;
+  bool hasExplicitOutput = inputs.contains("->");
+  if (hasExplicitOutput)
+    std::tie(inputs, output) = inputs.split("->");
+  SmallVector<StringRef> terms;
+  inputs.split(terms, ',');
+  if (terms.size() != ranks.size() || !isValidEinsumTerm(output))
+    return failure();
+
+  // The number of dims of the ellipsis of each operand.
+  SmallVector<int64_t> numEllipsisDims;
+  int64_t maxEllipsisDims = 0;
+  for (auto [term, rank] : llvm::zip(terms, ranks)) {
+    if (!isValidEinsumTerm(term))
+      return failure();
+    bool hasEllipsis = term.contains("...");
+    int64_t numLabels = term.size() - (hasEllipsis ? 3 : 0);
+    if (numLabels > rank || (!hasEllipsis && numLabels != rank))
+      return failure();
+    numEllipsisDims.push_back(rank - numLabels);
+    maxEllipsisDims = std::max(maxEllipsisDims, rank - numLabels);
+  }
+  if (maxEllipsisDims > 10)
+    return failure();
+  auto expandEllipsis = [&](StringRef term, int64_t numDims) {
+    size_t ellipsis = term.find("...");
+    if (ellipsis == StringRef::npos)
+      return term.str();
+    std::string labels = term.take_front(ellipsis).str();
+    for (int64_t i = maxEllipsisDims - numDims; i < maxEllipsisDims; i++)
+      labels.push_back('0' + i);
+    return labels + term.drop_front(ellipsis + 3).str();
+  };
+
+  EinsumEquation parsed;
+  std::array<int64_t, 128> counts = {};
+  for (auto [term, numDims] : llvm::zip(terms, numEllipsisDims)) {
+    std::string labels = expandEllipsis(term, numDims);
+    for (char label : labels) {
+      if (llvm::count(labels, label) != 1)
+        return failure();
+      counts[label]++;
+    }
+    parsed.inputLabels.push_back(labels);
+  }
+  if (hasExplicitOutput) {
+    parsed.outputLabels = expandEllipsis(output, maxEllipsisDims);
+  } else {
+    for (int64_t i = 0; i < maxEllipsisDims; i++)
+      parsed.outputLabels.push_back('0' + i);
+    for (char label = 'A'; label <= 'z'; label++) {
+      if (llvm::isAlpha(label) && counts[label] == 1)
+        parsed.outputLabels.push_back(label);
+    }
+  }
+  for (char label : parsed.outputLabels) {
+    if (counts[label] == 0 || llvm::count(parsed.outputLabels, label) != 1)
+      return failure();
+  }
+  return parsed;
+}
+
+// The size assumed for the dims of unknown size when choosing the order of the
+// contractions of an einsum.
+static constexpr double kEinsumUnknownDimSize = 64;
+
+// Returns the order in which to contract the operands of an einsum with
+// `equation`, as the best split into two subsets, by bitmask, of each subset
+// of at least two operands. The order minimizes the total number of
+// multiply-adds, and then the total size of the intermediate results.
+// `labelSizes` are the sizes of the labels, or kUnknownSize.
+static SmallVector<std::pair<uint64_t, uint64_t>>
+getEinsumContractionOrder(const EinsumEquation &equation,
+                          const llvm::DenseMap<char, int64_t> &labelSizes) {
+  int64_t numInputs = equation.inputLabels.size();
+  uint64_t all = (uint64_t(1) << numInputs) - 1;
+  // The operands with each label.
+  SmallVector<std::pair<char, uint64_t>> labelInputs;
+  for (auto [i, labels] : llvm::enumerate(equation.inputLabels)) {
+    for (char label : labels) {
+      auto it = llvm::find_if(labelInputs,
+                              [&](auto entry) { return entry.first == label; });
+      if (it == labelInputs.end())
+        labelInputs.push_back({label, uint64_t(1) << i});
+      else
+        it->second |= uint64_t(1) << i;
+    }
+  }
+  auto getSize = [&](char label) {
+    int64_t size = labelSizes.lookup(label);
+    return size == kUnknownSize ? kEinsumUnknownDimSize : double(size);
+  };
+  // Whether `label`, which is in `inputs`, is a dim of the result of
+  // contracting `subset`: it is in `subset`, and in the output or in other
+  // operands.
+  auto isInResult = [&](char label, uint64_t inputs, uint64_t subset) {
+    return (inputs & subset) &&
+           ((inputs & ~subset & all) ||
+            llvm::is_contained(equation.outputLabels, label));
+  };
+  auto getResultSize = [&](uint64_t subset) {
+    double size = 1;
+    for (auto [label, inputs] : labelInputs) {
+      if (isInResult(label, inputs, subset))
+        size *= getSize(label);
+    }
+    return size;
+  };
+  // The number of multiply-adds of contracting the results of `lhs` and `rhs`.
+  auto getContractionFlops = [&](uint64_t lhs, uint64_t rhs) {
+    double flops = 1;
+    for (auto [label, inputs] : labelInputs) {
+      if (isInResult(label, inputs, lhs) || isInResult(label, inputs, rhs))
+        flops *= getSize(label);
+    }
+    return flops;
+  };
+
+  // Subsets are contracted left to right past this many operands, rather than
+  // searching all 3^n splits.
+  constexpr int64_t kMaxSearchedInputs = 10;
+  SmallVector<std::pair<uint64_t, uint64_t>> splits(all + 1);
+  // The (multiply-adds, intermediate sizes) of each subset.
+  SmallVector<std::pair<double, double>> costs(all + 1);
+  for (uint64_t subset = 1; subset <= all; subset++) {
+    if (llvm::popcount(subset) < 2)
+      continue;
+    uint64_t lowest = subset & (~subset + 1);
+    if (numInputs > kMaxSearchedInputs) {
+      // The highest operand is contracted last.
+      uint64_t highest = uint64_t(1) << (llvm::Log2_64(subset));
+      splits[subset] = {subset ^ highest, highest};
+      continue;
+    }
+    std::optional<std::pair<double, double>> best;
+    // Splits whose lhs contains the lowest operand, so each is seen once.
+    for (uint64_t lhs = (subset - 1) & subset; lhs; lhs = (lhs - 1) & subset) {
+      if (!(lhs & lowest))
+        continue;
+      uint64_t rhs = subset ^ lhs;
+      double resultSize = subset == all ? 0 : getResultSize(subset);
+      std::pair<double, double> cost = {
+          costs[lhs].first + costs[rhs].first +
+              getContractionFlops(lhs, rhs),
+          costs[lhs].second + costs[rhs].second + resultSize};
+      if (!best || cost < *best) {
+        best = cost;
+        splits[subset] = {lhs, rhs};
+      }
+    }
+    costs[subset] = *best;
+  }
+  return splits;
+}
+
+namespace {
+// An operand of an einsum, or the result of contracting some of them, and the
+// labels of its dims.
+struct EinsumTerm {
+  Value tensor;
+  std::string labels;
+};
+
+// Decomposes `aten.einsum` into a tree of `aten.mm` and `aten.bmm` ops, each
+// contracting a pair of operands or of intermediate results, in the order
+// chosen by `getEinsumContractionOrder`. The two sides of each contraction
+// are permuted and viewed as [batch, free, contracted] and
+// [batch, contracted, free] tensors, and the dims of a side that are not
+// needed anymore are summed first. The `path` operand, which only
+// suggests an order, is ignored.
+class DecomposeAtenEinsumOp : public OpRewritePattern<AtenEinsumOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(AtenEinsumOp op,
+                                PatternRewriter &rewriter) const override {
+    Location loc = op.getLoc();
+    MLIRContext *context = op.getContext();
+    std::string equationStr;
+    if (!matchPattern(op.getEquation(), m_TorchConstantStr(equationStr)))
+      return rewriter.notifyMatchFailure(op, "equation must be a constant");
+    SmallVector<Value> inputs;
+    if (!getListConstructElements(op.getTensors(), inputs) || inputs.empty())
+      return rewriter.notifyMatchFailure(
+          op, "tensors must be a non-empty list construct");
+    // The subsets of operands are enumerated when choosing the order.
+    if (inputs.size() > 16)
+      return rewriter.notifyMatchFailure(op, "too many operands");
+    SmallVector<int64_t> ranks;
+    Type dtype;
+    for (Value input : inputs) {
+      auto type = input.getType().cast<BaseTensorType>();
+      if (!type.hasSizes() || !type.hasDtype() ||
+          !type.getDtype().isa<mlir::FloatType>())
+        return rewriter.notifyMatchFailure(
+            op, "operands must have known ranks and a floating point dtype");
+      if (dtype && type.getDtype() != dtype)
+        return rewriter.notifyMatchFailure(
+            op, "operands must have the same dtype");
+      dtype = type.getDtype();
+      ranks.push_back(type.getSizes().size());
+    }
+    FailureOr<EinsumEquation> equation =
+        parseEinsumEquation(equationStr, ranks);
+    if (failed(equation))
+      return rewriter.notifyMatchFailure(op, "unsupported equation");
+
+    // The size of each label, and an operand dim with that label.
+    llvm::DenseMap<char, int64_t> labelSizes;
+    llvm::DenseMap<char, std::pair<Value, int64_t>> labelDims;
+    for (auto [input, labels] : llvm::zip(inputs, equation->inputLabels)) {
+      ArrayRef<int64_t> sizes =
+          input.getType().cast<BaseTensorType>().getSizes();
+      for (auto [dim, label] : llvm::enumerate(labels)) {
+        auto [it, inserted] = labelSizes.try_emplace(label, sizes[dim]);
+        if (inserted) {
+          labelDims[label] = {input, dim};
+        } else if (it->second == kUnknownSize) {
+          it->second = sizes[dim];
+        } else if (sizes[dim] != kUnknownSize && sizes[dim] != it->second) {
+          return rewriter.notifyMatchFailure(
+              op, "dims with the same label must have the same size");
+        }
+      }
+    }
+
+    auto resultType = op.getType().cast<BaseTensorType>();
+    auto getGroupedType = [&](ArrayRef<std::string> groups) {
+      SmallVector<int64_t> sizes;
+      for (StringRef group : groups) {
+        int64_t size = 1;
+        for (char label : group) {
+          int64_t labelSize = labelSizes[label];
+          size = size == kUnknownSize || labelSize == kUnknownSize
+                     ? kUnknownSize
+                     : size * labelSize;
+        }
+        sizes.push_back(size);
+      }
+      return resultType.getWithSizesAndDtype(sizes, dtype);
+    };
+    auto getConstantInt = [&](int64_t value) -> Value {
+      return rewriter.create<ConstantIntOp>(loc,
+                                            rewriter.getI64IntegerAttr(value));
+    };
+    auto getIntList = [&](ValueRange values) -> Value {
+      return rewriter.create<PrimListConstructOp>(
+          loc, Torch::ListType::get(Torch::IntType::get(context)), values);
+    };
+    auto getLabelSize = [&](char label) -> Value {
+      if (labelSizes[label] != kUnknownSize)
+        return getConstantInt(labelSizes[label]);
+      auto [tensor, dim] = labelDims[label];
+      return rewriter.create<AtenSizeIntOp>(loc, tensor, getConstantInt(dim));
+    };
+    auto getSingleLabelGroups = [](StringRef labels) {
+      SmallVector<std::string> groups;
+      for (char label : labels)
+        groups.push_back(std::string(1, label));
+      return groups;
+    };
+
+    // Sums the dims of `term` whose labels are not in `keep`.
+    auto reduce = [&](const EinsumTerm &term, StringRef keep) -> EinsumTerm {
+      SmallVector<Value> dims;
+      std::string labels;
+      for (auto [dim, label] : llvm::enumerate(term.labels)) {
+        if (keep.contains(label))
+          labels.push_back(label);
+        else
+          dims.push_back(getConstantInt(dim));
+      }
+      if (dims.empty())
+        return term;
+      Value keepDim = rewriter.create<ConstantBoolOp>(loc, false);
+      Value none = rewriter.create<ConstantNoneOp>(loc);
+      Value sum = rewriter.create<AtenSumDimIntListOp>(
+          loc, getGroupedType(getSingleLabelGroups(labels)), term.tensor,
+          getIntList(dims), keepDim, none);
+      return {sum, labels};
+    };
+    // Permutes the dims of `term` to the order of `labels`.
+    auto permute = [&](const EinsumTerm &term,
+                       StringRef labels) -> EinsumTerm {
+      if (term.labels == labels)
+        return term;
+      SmallVector<Value> dims;
+      for (char label : labels)
+        dims.push_back(getConstantInt(term.labels.find(label)));
+      Value permuted = rewriter.create<AtenPermuteOp>(
+          loc, getGroupedType(getSingleLabelGroups(labels)), term.tensor,
+          getIntList(dims));
+      return {permuted, labels.str()};
+    };
+    // Views `tensor` as a tensor with a dim for each of the `groups` of its
+    // consecutive labels, of the product of their sizes. An empty group is a
+    // dim of size 1, and a tensor with such dims may have more dims than
+    // labels.
+    auto view = [&](Value tensor, ArrayRef<std::string> groups) -> Value {
+      int64_t rank = tensor.getType().cast<BaseTensorType>().getSizes().size();
+      if (rank == static_cast<int64_t>(groups.size()) &&
+          llvm::all_of(groups, [](const std::string &group) {
+            return group.size() == 1;
+          }))
+        return tensor;
+      SmallVector<Value> sizes;
+      for (StringRef group : groups) {
+        Value size;
+        for (char label : group) {
+          Value labelSize = getLabelSize(label);
+          size = size ? rewriter.create<AtenMulIntOp>(loc, size, labelSize)
+                      : labelSize;
+        }
+        sizes.push_back(size ? size : getConstantInt(1));
+      }
+      return rewriter.create<AtenViewOp>(loc, getGroupedType(groups), tensor,
+                                         getIntList(sizes));
+    };
+    // Contracts `lhs` and `rhs`, keeping the dims with labels in `keep`.
+    auto contract = [&](EinsumTerm lhs, EinsumTerm rhs,
+                        StringRef keep) -> EinsumTerm {
+      lhs = reduce(lhs, keep.str() + rhs.labels);
+      rhs = reduce(rhs, keep.str() + lhs.labels);
+      std::string batch, lhsFree, contracted, rhsFree;
+      for (char label : lhs.labels) {
+        if (!StringRef(rhs.labels).contains(label))
+          lhsFree.push_back(label);
+        else if (keep.contains(label))
+          batch.push_back(label);
+        else
+          contracted.push_back(label);
+      }
+      for (char label : rhs.labels) {
+        if (!StringRef(lhs.labels).contains(label))
+          rhsFree.push_back(label);
+      }
+      lhs = permute(lhs, batch + lhsFree + contracted);
+      rhs = permute(rhs, batch + contracted + rhsFree);
+      SmallVector<std::string> lhsGroups = {lhsFree, contracted};
+      SmallVector<std::string> rhsGroups = {contracted, rhsFree};
+      SmallVector<std::string> resultGroups = {lhsFree, rhsFree};
+      if (!batch.empty()) {
+        lhsGroups.insert(lhsGroups.begin(), batch);
+        rhsGroups.insert(rhsGroups.begin(), batch);
+        resultGroups.insert(resultGroups.begin(), batch);
+      }
+      Value lhsMatrix = view(lhs.tensor, lhsGroups);
+      Value rhsMatrix = view(rhs.tensor, rhsGroups);
+      Value result;
+      if (batch.empty())
+        result = rewriter.create<AtenMmOp>(loc, getGroupedType(resultGroups),
+                                           lhsMatrix, rhsMatrix);
+      else
+        result = rewriter.create<AtenBmmOp>(loc, getGroupedType(resultGroups),
+                                            lhsMatrix, rhsMatrix);
+      std::string labels = batch + lhsFree + rhsFree;
+      result = view(result, getSingleLabelGroups(labels));
+      return {result, labels};
+    };
+
+    SmallVector<std::pair<uint64_t, uint64_t>> splits =
+        getEinsumContractionOrder(*equation, labelSizes);
+    std::function<EinsumTerm(uint64_t)> contractSubset =
+        [&](uint64_t subset) -> EinsumTerm {
+      if (llvm::popcount(subset) == 1) {
+        int64_t index = llvm::countr_zero(subset);
+        return {inputs[index], equation->inputLabels[index]};
+      }
+      // The labels still needed after contracting `subset`.
+      std::string keep = equation->outputLabels;
+      for (auto [index, labels] : llvm::enumerate(equation->inputLabels)) {
+        if (!(subset & (uint64_t(1) << index)))
+          keep += labels;
+      }
+      auto [lhs, rhs] = splits[subset];
+      return contract(contractSubset(lhs), contractSubset(rhs), keep);
+    };
+    EinsumTerm result =
+        contractSubset((uint64_t(1) << inputs.size()) - 1);
+    result = reduce(result, equation->outputLabels);
+    result = permute(result, equation->outputLabels);
+    if (result.tensor.getType() == op.getType())
+      rewriter.replaceOp(op, result.tensor);
+    else
+      rewriter.replaceOpWithNewOp<TensorStaticInfoCastOp>(op, op.getType(),
+                                                          result.tensor);
+    return success();
+  }
+};
+} // namespace
+
 // ReLU6(x) = min(max(0, x), 6) = min(Relu(x), 6)
 static Value getRelu6Results(PatternRewriter &rewriter, Location loc,
                              Value input) {
@@ -1506,6 +2028,118 @@ public:
 };
 } // namespace
 
+// Decompose a pointwise aten.conv2d, with a 1x1 kernel, unit strides, no
+// padding and a single group, into a matmul over the flattened spatial dims:
+//   result = (weight[O, C] @ input[N, C, H * W] + bias[O, 1])[N, O, H, W]
+// This is an alternative to `DecomposeAtenConv2dOp`, for backends whose
+// matmuls are faster than their convolutions.
+namespace {
+class DecomposeAtenConv2dOpAsMatmul : public OpRewritePattern<AtenConv2dOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(AtenConv2dOp op,
+                                PatternRewriter &rewriter) const override {
+    Location loc = op.getLoc();
+    MLIRContext *context = op.getContext();
+    Value input = op.getInput();
+    Value weight = op.getWeight();
+    auto inputType = input.getType().cast<BaseTensorType>();
+    auto weightType = weight.getType().cast<BaseTensorType>();
+    auto resultType = op.getType().cast<BaseTensorType>();
+    if (!inputType.hasSizes() || inputType.getSizes().size() != 4 ||
+        !weightType.hasSizes() || !resultType.hasDtype())
+      return rewriter.notifyMatchFailure(op, "expected a batched 2d input");
+    ArrayRef<int64_t> inputSizes = inputType.getSizes();
+    ArrayRef<int64_t> weightSizes = weightType.getSizes();
+    if (weightSizes.size() != 4 || weightSizes[2] != 1 || weightSizes[3] != 1)
+      return rewriter.notifyMatchFailure(op, "expected a 1x1 kernel");
+    auto isConstantIntList = [](Value list, int64_t expected) {
+      SmallVector<int64_t> values;
+      return matchPattern(list, m_TorchListOfConstantInts(values)) &&
+             llvm::all_of(values,
+                          [&](int64_t value) { return value == expected; });
+    };
+    int64_t groups;
+    if (!isConstantIntList(op.getStride(), 1) ||
+        !isConstantIntList(op.getPadding(), 0) ||
+        !matchPattern(op.getGroups(), m_TorchConstantInt(&groups)) ||
+        groups != 1)
+      return rewriter.notifyMatchFailure(
+          op, "expected unit strides, no padding and a single group");
+
+    auto getDimSize = [&](Value tensor, int64_t dim) -> Value {
+      return rewriter.create<AtenSizeIntOp>(
+          loc, tensor,
+          rewriter.create<ConstantIntOp>(loc, rewriter.getI64IntegerAttr(dim)));
+    };
+    auto multiply = [](int64_t lhs, int64_t rhs) {
+      return lhs == kUnknownSize || rhs == kUnknownSize ? kUnknownSize
+                                                        : lhs * rhs;
+    };
+    auto getListType = [&]() {
+      return Torch::ListType::get(Torch::IntType::get(context));
+    };
+    Type dtype = resultType.getDtype();
+
+    // input[N, C, H, W] -> input[N, C, H * W]
+    Value batch = getDimSize(input, 0);
+    Value channels = getDimSize(input, 1);
+    Value height = getDimSize(input, 2);
+    Value width = getDimSize(input, 3);
+    Value spatial = rewriter.create<AtenMulIntOp>(loc, height, width);
+    Value flatInput = rewriter.create<AtenViewOp>(
+        loc,
+        inputType.getWithSizesAndDtype(
+            ArrayRef<int64_t>{inputSizes[0], inputSizes[1],
+                              multiply(inputSizes[2], inputSizes[3])},
+            inputType.getOptionalDtype()),
+        input,
+        rewriter.create<PrimListConstructOp>(
+            loc, getListType(), ValueRange{batch, channels, spatial}));
+    // weight[O, C, 1, 1] -> weight[O, C]
+    Value outChannels = getDimSize(weight, 0);
+    Value flatWeight = rewriter.create<AtenViewOp>(
+        loc,
+        weightType.getWithSizesAndDtype(
+            ArrayRef<int64_t>{weightSizes[0], weightSizes[1]},
+            weightType.getOptionalDtype()),
+        weight,
+        rewriter.create<PrimListConstructOp>(
+            loc, getListType(),
+            ValueRange{outChannels, getDimSize(weight, 1)}));
+    SmallVector<int64_t> flatResultSizes{
+        inputSizes[0], weightSizes[0], multiply(inputSizes[2], inputSizes[3])};
+    Type flatResultType =
+        resultType.getWithSizesAndDtype(flatResultSizes, dtype);
+    Value result = rewriter.create<AtenMatmulOp>(loc, flatResultType,
+                                                 flatWeight, flatInput);
+
+    // bias[O] -> bias[O, 1]
+    Value bias = op.getBias();
+    if (!bias.getType().isa<Torch::NoneType>()) {
+      auto biasType = bias.getType().cast<BaseTensorType>();
+      Value one =
+          rewriter.create<ConstantIntOp>(loc, rewriter.getI64IntegerAttr(1));
+      Value columnBias = rewriter.create<AtenUnsqueezeOp>(
+          loc,
+          biasType.getWithSizesAndDtype(ArrayRef<int64_t>{weightSizes[0], 1},
+                                        biasType.getOptionalDtype()),
+          bias, /*dim=*/one);
+      result = rewriter.create<AtenAddTensorOp>(loc, flatResultType, result,
+                                                columnBias, /*alpha=*/one);
+    }
+
+    // result[N, O, H * W] -> result[N, O, H, W]
+    rewriter.replaceOpWithNewOp<AtenViewOp>(
+        op, op.getType(), result,
+        rewriter.create<PrimListConstructOp>(
+            loc, getListType(),
+            ValueRange{batch, outChannels, height, width}));
+    return success();
+  }
+};
+} // namespace
+
 // Decompose aten.conv_transpose2d to aten.convolution
 namespace {
 class DecomposeAtenConvTranspose2dOp
@@ -2072,9 +2706,13 @@ public:
 } // namespace
 
 // pDash = 1.0 - p
-// boolMask = aten.rand_like(input) < pDash
-// dropout(input, p, train=True) = (boolMask * input) / pDash
+// keep = aten.rand_like(input) < pDash
+// dropout(input, p, train=True) = aten.where(keep, input / pDash, 0.0)
 // dropout(input, p, train=False) = input
+//
+// In training mode, all the ops are elementwise and the random values are
+// generated from their index, so the mask is never materialized once they are
+// fused together.
 namespace {
 class DecomposeAtenDropoutOp : public OpRewritePattern<AtenDropoutOp> {
 public:
@@ -2096,16 +2734,26 @@ public:
     if (!inputType.hasDtype() || !inputType.getDtype().isa<mlir::FloatType>())
       return rewriter.notifyMatchFailure(
           op, "only support floating type input for training mode");
+    if (!inputType.hasSizes())
+      return rewriter.notifyMatchFailure(
+          op, "only support input with sizes for training mode");
     Value noneVal = rewriter.create<ConstantNoneOp>(loc);
+    Value floatZero =
+        rewriter.create<ConstantFloatOp>(loc, rewriter.getF64FloatAttr(0.0));
     Value floatOne =
         rewriter.create<ConstantFloatOp>(loc, rewriter.getF64FloatAttr(1.0));
     Value oneMinusP = rewriter.create<AtenSubFloatOp>(loc, floatOne, prob);
-    Value boolMask = rewriter.create<ValsemVariantAtenBernoulliFloatOp>(
-        loc, inputType, input, oneMinusP, /*generator=*/noneVal);
-    Value maskedInput =
-        rewriter.create<AtenMulTensorOp>(loc, inputType, boolMask, input);
-    rewriter.replaceOpWithNewOp<AtenDivScalarOp>(op, op.getType(), maskedInput,
-                                                 oneMinusP);
+    Value randomVal = rewriter.create<AtenRandLikeOp>(
+        loc, inputType, input, /*dtype=*/noneVal, /*layout=*/noneVal,
+        /*device=*/noneVal, /*pinMemory=*/noneVal, /*memoryFormat=*/noneVal);
+    auto boolType = inputType.getWithSizesAndDtype(inputType.getSizes(),
+                                                   rewriter.getI1Type());
+    Value keep =
+        rewriter.create<AtenLtScalarOp>(loc, boolType, randomVal, oneMinusP);
+    Value scaledInput =
+        rewriter.create<AtenDivScalarOp>(loc, inputType, input, oneMinusP);
+    rewriter.replaceOpWithNewOp<AtenWhereScalarOtherOp>(
+        op, op.getType(), keep, scaledInput, floatZero);
     return success();
   }
 };
@@ -3343,6 +3991,38 @@ class DecomposeAtenAdaptiveAvgPool2dOp
 };
 } // namespace
 
+namespace {
+// Decompose a global `aten.adaptive_avg_pool2d`, whose output size is 1x1,
+// into the mean over the spatial dims. This is an alternative to
+// `DecomposeAtenAdaptiveAvgPool2dOp`, for backends whose reductions are
+// faster than their pooling ops.
+class DecomposeAtenAdaptiveAvgPool2dOpAsMean
+    : public OpRewritePattern<AtenAdaptiveAvgPool2dOp> {
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(AtenAdaptiveAvgPool2dOp op,
+                                PatternRewriter &rewriter) const override {
+    SmallVector<int64_t> outputSize;
+    if (!matchPattern(op.getOutputSize(),
+                      m_TorchListOfConstantInts(outputSize)) ||
+        outputSize.size() != 2 || outputSize[0] != 1 || outputSize[1] != 1)
+      return rewriter.notifyMatchFailure(op, "expected a 1x1 output size");
+
+    Location loc = op.getLoc();
+    Value dims = rewriter.create<PrimListConstructOp>(
+        loc, Torch::ListType::get(Torch::IntType::get(op.getContext())),
+        ValueRange{rewriter.create<ConstantIntOp>(
+                       loc, rewriter.getI64IntegerAttr(-2)),
+                   rewriter.create<ConstantIntOp>(
+                       loc, rewriter.getI64IntegerAttr(-1))});
+    Value keepDim = rewriter.create<ConstantBoolOp>(loc, true);
+    Value none = rewriter.create<ConstantNoneOp>(loc);
+    rewriter.replaceOpWithNewOp<AtenMeanDimOp>(op, op.getType(), op.getSelf(),
+                                               dims, keepDim, /*dtype=*/none);
+    return success();
+  }
+};
+} // namespace
+
 namespace {
 // Decompose `aten.clampMin` op into `aten.clamp` op.
 class DecomposeAtenClampMinOp : public OpRewritePattern<AtenClampMinOp> {
@@ -4399,6 +5079,83 @@ public:
 };
 } // namespace
 
+namespace {
+// A rewriter for trying a decomposition out on a copy of an op, away from the
+// IR of the pass.
+class TrialRewriter : public PatternRewriter {
+public:
+  explicit TrialRewriter(MLIRContext *context) : PatternRewriter(context) {}
+};
+} // namespace
+
+// Returns the sum of the costs of the ops that `pattern` decomposes `op`
+// into, which is infinite if the cost of one of them can't be estimated, or
+// std::nullopt if `pattern` doesn't apply to `op`. The pattern is applied to a
+// copy of `op` in a block of its own, so it must only create ops at the
+// insertion point it is given and not modify other ops.
+static std::optional<double>
+getDecompositionCost(const RewritePattern &pattern, Operation *op,
+                     const DecompositionCostModel &costModel) {
+  Block scratch;
+  OpBuilder builder = OpBuilder::atBlockEnd(&scratch);
+  Operation *copy = builder.clone(*op);
+  TrialRewriter rewriter(op->getContext());
+  rewriter.setInsertionPoint(copy);
+  std::optional<double> cost;
+  if (succeeded(pattern.matchAndRewrite(copy, rewriter))) {
+    cost = 0;
+    for (Operation &decomposed : scratch) {
+      std::optional<double> opCost = costModel.getCost(&decomposed);
+      *cost += opCost ? *opCost : std::numeric_limits<double>::infinity();
+    }
+  }
+  // Erase the ops after their users, which also drops their uses of the
+  // values of the IR.
+  while (!scratch.empty()) {
+    scratch.back().dropAllUses();
+    scratch.back().erase();
+  }
+  return cost;
+}
+
+namespace {
+// Decomposes an op with the cheapest of several alternative decompositions
+// for it according to a cost model, which is estimated for each op from its
+// sizes. Ties go to the earlier alternative.
+template <typename OpTy>
+class DecomposeWithCheapestAlternative : public OpRewritePattern<OpTy> {
+public:
+  DecomposeWithCheapestAlternative(
+      MLIRContext *context,
+      std::shared_ptr<const DecompositionCostModel> costModel,
+      SmallVector<std::unique_ptr<RewritePattern>> alternatives)
+      : OpRewritePattern<OpTy>(context), costModel(std::move(costModel)),
+        alternatives(std::move(alternatives)) {}
+
+  LogicalResult matchAndRewrite(OpTy op,
+                                PatternRewriter &rewriter) const override {
+    SmallVector<std::pair<double, const RewritePattern *>> candidates;
+    for (const std::unique_ptr<RewritePattern> &alternative : alternatives) {
+      if (std::optional<double> cost =
+              getDecompositionCost(*alternative, op, *costModel))
+        candidates.emplace_back(*cost, alternative.get());
+    }
+    llvm::stable_sort(candidates, [](const auto &lhs, const auto &rhs) {
+      return lhs.first < rhs.first;
+    });
+    for (const auto &[cost, alternative] : candidates) {
+      if (succeeded(alternative->matchAndRewrite(op, rewriter)))
+        return success();
+    }
+    return rewriter.notifyMatchFailure(op, "no decomposition applies");
+  }
+
+private:
+  std::shared_ptr<const DecompositionCostModel> costModel;
+  SmallVector<std::unique_ptr<RewritePattern>> alternatives;
+};
+} // namespace
+
 namespace {
 class DecomposeComplexOpsPass
     : public DecomposeComplexOpsBase<DecomposeComplexOpsPass> {
@@ -4417,13 +5174,62 @@ private:
     // on `Operation *` are not allowed, since there is no way of telling if
     // that pattern will match on an op in the `legalOpsSet` or not.
     assert(opName && "All decomposition patterns must target a single op");
-    if (!legalOpsSet.contains(opName->getStringRef().ltrim(kTorchOpPrefix)))
+    if (isTargetOpIllegalAndPresent(opName->getStringRef()))
       patterns.add<DecomposePattern>(context);
   }
 
+  // Adds the `Alternatives` decompositions of `OpTy`, of which the cheapest
+  // according to `model` is applied to each op.
+  template <typename OpTy, typename... Alternatives>
+  void addAlternativesIfTargetOpIsIllegal(
+      RewritePatternSet &patterns,
+      const std::shared_ptr<const DecompositionCostModel> &model) {
+    MLIRContext *context = &getContext();
+    if (!isTargetOpIllegalAndPresent(OpTy::getOperationName()))
+      return;
+    SmallVector<std::unique_ptr<RewritePattern>> alternatives;
+    (alternatives.push_back(std::make_unique<Alternatives>(context)), ...);
+    patterns.add<DecomposeWithCheapestAlternative<OpTy>>(
+        context, model, std::move(alternatives));
+  }
+
+  // Returns true if ops named `opName` are to be decomposed, in which case
+  // they are also recorded in `targetOps`. Only the ops present in the
+  // function are, so that patterns are only created, and the rewriter only
+  // visits ops, for the few ops that usually remain to be decomposed.
+  bool isTargetOpIllegalAndPresent(StringRef opName) {
+    if (legalOpsSet.contains(opName.ltrim(kTorchOpPrefix)))
+      return false;
+    if (!presentOps.contains(opName))
+      return false;
+    targetOps.insert(opName);
+    return true;
+  }
+
+  void populateDecompositionPatterns(
+      RewritePatternSet &patterns,
+      const std::shared_ptr<const DecompositionCostModel> &model);
+
+  // The names of the ops in the function.
+  DenseSet<StringRef> presentOps;
+  // The names of the ops whose decompositions are in the pattern set.
+  DenseSet<StringRef> targetOps;
+
+  // The cost model given to the constructor, which takes precedence over the
+  // options.
+  std::shared_ptr<const DecompositionCostModel> costModel;
+
 public:
   DecomposeComplexOpsPass() = default;
-  DecomposeComplexOpsPass(ArrayRef<std::string> legalOps) {
+  DecomposeComplexOpsPass(ArrayRef<std::string> legalOps,
+                          ArrayRef<std::string> opEfficiencies) {
+    this->legalOps = legalOps;
+    this->opEfficiencies = opEfficiencies;
+  }
+  DecomposeComplexOpsPass(
+      ArrayRef<std::string> legalOps,
+      std::shared_ptr<const DecompositionCostModel> costModel)
+      : costModel(std::move(costModel)) {
     this->legalOps = legalOps;
   }
   void runOnOperation() override {
@@ -4435,149 +5241,205 @@ public:
     legalOpsSet.clear();
     legalOpsSet.insert(legalOps.begin(), legalOps.end());
 
-    addPatternIfTargetOpIsIllegal<DecomposeAtenSoftmaxIntOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAten_SoftmaxOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAten_LogSoftmaxOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenLogSoftmaxIntOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenEmptyLikeOp>(patterns);
-    addPatternIfTargetOpIsIllegal<
-        DecomposeConstantTensorAllocLikeOp<AtenOnesLikeOp, 1>>(patterns);
-    addPatternIfTargetOpIsIllegal<
-        DecomposeConstantTensorAllocLikeOp<AtenZerosLikeOp, 0>>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenStackOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenRollOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenRepeatOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenExpandOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenFlattenUsingIntsOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenWhereScalarOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenWhereScalarOtherOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenWhereScalarSelfOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenMaskedFillScalarOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenSizeOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenReshapeOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAten_SoftmaxBackwardDataOp>(
-        patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenTanhBackwardOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenAddmmOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenMeanOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenMeanDimOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenSelectIntOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenMatmulOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenMvOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenTOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAten_LogSoftmaxBackwardDataOp>(
-        patterns);
-    addPatternIfTargetOpIsIllegal<
-        DecomposeAtenAddCLikeOp<AtenAddcmulOp, AtenMulTensorOp>>(patterns);
-    addPatternIfTargetOpIsIllegal<
-        DecomposeAtenAddCLikeOp<AtenAddcdivOp, AtenDivTensorOp>>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenLayerNormOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenNativeLayerNormOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenNativeBatchNormOp>(patterns);
-    addPatternIfTargetOpIsIllegal<
-        DecomposeAten_ConvolutionLikeOp<Aten_ConvolutionOp>>(patterns);
-    addPatternIfTargetOpIsIllegal<
-        DecomposeAten_ConvolutionLikeOp<Aten_ConvolutionDeprecatedOp>>(
-        patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenConvolutionBackwardOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenConv2dOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenConvTranspose2dOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenArangeOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenArangeStartOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenArgMaxOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenSquareOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenVarOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenStdOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAten_UnsafeViewOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAten_ReshapeAliasOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenBernoulliOp>(patterns);
-    addPatternIfTargetOpIsIllegal<
-        DecomposeAtenBernoulliLikeOp<ValsemVariantAtenBernoulliFloatOp>>(
-        patterns);
-    addPatternIfTargetOpIsIllegal<
-        DecomposeAtenBernoulliLikeOp<AtenBernoulliPOp>>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenBernoulliTensorOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenZeroOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenRandLikeOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenHardsigmoidOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenRelu6Op>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenHardswishOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenSoftplusOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenSiluOp>(patterns);
-    addPatternIfTargetOpIsIllegal<
-        DecomposeConstantTensorNewLikeOp<AtenNewZerosOp, AtenZerosOp>>(
-        patterns);
-    addPatternIfTargetOpIsIllegal<
-        DecomposeConstantTensorNewLikeOp<AtenNewOnesOp, AtenOnesOp>>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenHardtanhOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenFullOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenLinearOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenMishOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenFullLikeOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenIndexPutOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenExpandAsOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAten_ToCopyOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenCopyOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenDropoutOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenNewEmptyOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenIndexPutHackedTwinOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenPadOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenToDtypeLayoutOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenToDeviceOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenAdaptiveAvgPool2dOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenClampMinOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenClampMaxOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenBaddbmmOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenFloorDivideOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenNumpyTOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenSelectScatterOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenVarDimOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenAmaxOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenVarCorrectionOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenStdDimOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenStdCorrectionOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenNarrowOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAten_EmbeddingBagOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenLiftFreshCopyOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenIndexTensorHackedTwinOp>(
-        patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenMseLossOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenNormScalarOptDimOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenRandintOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenRandintLowOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenVarMeanCorrectionOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposePrimsConvertElementTypeOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposePrimsVarOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposePrimsSqrtOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenRandnOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenRandnGeneratorOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenRandnLikeOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenVarMeanOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenLeakyReluOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenLeakyReluBackwardOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenNewEmptyStridedOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenBucketizeTensorOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposePrimsSqueezeOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenMovedimIntOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenOneHotOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenCrossEntropyLossOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenVarMeanDimOp>(patterns);
-    addPatternIfTargetOpIsIllegal<DecomposeAtenTopkOp>(patterns);
-
-    GreedyRewriteConfig config;
-    config.useTopDownTraversal = true;
-    config.maxIterations = GreedyRewriteConfig::kNoLimit;
-
-    if (failed(applyPatternsAndFoldGreedily(getOperation(), std::move(patterns),
-                                            config))) {
-      return signalPassFailure();
+    std::shared_ptr<const DecompositionCostModel> model = costModel;
+    if (!model) {
+      FailureOr<std::unique_ptr<RooflineCostModel>> roofline =
+          RooflineCostModel::parse(flopsPerByte, opEfficiencies);
+      if (failed(roofline)) {
+        getOperation().emitError()
+            << "expected a positive flops-per-byte and op-efficiencies of "
+               "the form 'aten.foo=0.5'";
+        return signalPassFailure();
+      }
+      model = std::move(*roofline);
+    }
+
+    // Decompositions can create ops that need decompositions themselves. The
+    // ones that were already present are rewritten as they are created, and
+    // the others on the next round.
+    DenseSet<StringRef> decomposedOps;
+    while (true) {
+      presentOps.clear();
+      targetOps.clear();
+      getOperation().walk([&](Operation *op) {
+        presentOps.insert(op->getName().getStringRef());
+      });
+      RewritePatternSet patterns(context);
+      populateDecompositionPatterns(patterns, model);
+      if (llvm::all_of(targetOps, [&](StringRef opName) {
+            return decomposedOps.contains(opName);
+          }))
+        break;
+      decomposedOps.insert(targetOps.begin(), targetOps.end());
+
+      // Constants are visited too, so that the ones the decompositions use
+      // are deduplicated and hoisted together with the ones they create.
+      SmallVector<Operation *> ops;
+      getOperation().walk<WalkOrder::PreOrder>([&](Operation *op) {
+        if (targetOps.contains(op->getName().getStringRef()) ||
+            op->hasTrait<OpTrait::ConstantLike>())
+          ops.push_back(op);
+      });
+      GreedyRewriteConfig config;
+      config.strictMode = GreedyRewriteStrictness::ExistingAndNewOps;
+      if (failed(applyOpPatternsAndFold(ops, std::move(patterns), config)))
+        return signalPassFailure();
     }
   }
 };
 } // namespace
 
+void DecomposeComplexOpsPass::populateDecompositionPatterns(
+    RewritePatternSet &patterns,
+    const std::shared_ptr<const DecompositionCostModel> &model) {
+  addPatternIfTargetOpIsIllegal<DecomposeAtenSoftmaxIntOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAten_SoftmaxOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenScaledDotProductAttentionOp>(
+      patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAten_LogSoftmaxOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenLogSoftmaxIntOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenEmptyLikeOp>(patterns);
+  addPatternIfTargetOpIsIllegal<
+      DecomposeConstantTensorAllocLikeOp<AtenOnesLikeOp, 1>>(patterns);
+  addPatternIfTargetOpIsIllegal<
+      DecomposeConstantTensorAllocLikeOp<AtenZerosLikeOp, 0>>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenStackOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenRollOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenRepeatOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenExpandOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenFlattenUsingIntsOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenWhereScalarOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenWhereScalarOtherOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenWhereScalarSelfOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenMaskedFillScalarOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenSizeOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenReshapeOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAten_SoftmaxBackwardDataOp>(
+      patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenTanhBackwardOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenAddmmOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenMeanOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenMeanDimOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenSelectIntOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenMatmulOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenMvOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenEinsumOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenTOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAten_LogSoftmaxBackwardDataOp>(
+      patterns);
+  addPatternIfTargetOpIsIllegal<
+      DecomposeAtenAddCLikeOp<AtenAddcmulOp, AtenMulTensorOp>>(patterns);
+  addPatternIfTargetOpIsIllegal<
+      DecomposeAtenAddCLikeOp<AtenAddcdivOp, AtenDivTensorOp>>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenLayerNormOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenNativeLayerNormOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenNativeBatchNormOp>(patterns);
+  addPatternIfTargetOpIsIllegal<
+      DecomposeAten_ConvolutionLikeOp<Aten_ConvolutionOp>>(patterns);
+  addPatternIfTargetOpIsIllegal<
+      DecomposeAten_ConvolutionLikeOp<Aten_ConvolutionDeprecatedOp>>(
+      patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenConvolutionBackwardOp>(patterns);
+  addAlternativesIfTargetOpIsIllegal<AtenConv2dOp, DecomposeAtenConv2dOp,
+                                     DecomposeAtenConv2dOpAsMatmul>(patterns,
+                                                                    model);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenConvTranspose2dOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenArangeOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenArangeStartOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenArgMaxOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenSquareOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenVarOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenStdOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAten_UnsafeViewOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAten_ReshapeAliasOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenBernoulliOp>(patterns);
+  addPatternIfTargetOpIsIllegal<
+      DecomposeAtenBernoulliLikeOp<ValsemVariantAtenBernoulliFloatOp>>(
+      patterns);
+  addPatternIfTargetOpIsIllegal<
+      DecomposeAtenBernoulliLikeOp<AtenBernoulliPOp>>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenBernoulliTensorOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenZeroOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenRandLikeOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenHardsigmoidOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenRelu6Op>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenHardswishOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenSoftplusOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenSiluOp>(patterns);
+  addPatternIfTargetOpIsIllegal<
+      DecomposeConstantTensorNewLikeOp<AtenNewZerosOp, AtenZerosOp>>(
+      patterns);
+  addPatternIfTargetOpIsIllegal<
+      DecomposeConstantTensorNewLikeOp<AtenNewOnesOp, AtenOnesOp>>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenHardtanhOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenFullOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenLinearOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenMishOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenFullLikeOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenIndexPutOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenExpandAsOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAten_ToCopyOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenCopyOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenDropoutOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenNewEmptyOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenIndexPutHackedTwinOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenPadOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenToDtypeLayoutOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenToDeviceOp>(patterns);
+  addAlternativesIfTargetOpIsIllegal<AtenAdaptiveAvgPool2dOp,
+                                     DecomposeAtenAdaptiveAvgPool2dOp,
+                                     DecomposeAtenAdaptiveAvgPool2dOpAsMean>(
+      patterns, model);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenClampMinOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenClampMaxOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenBaddbmmOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenFloorDivideOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenNumpyTOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenSelectScatterOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenVarDimOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenAmaxOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenVarCorrectionOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenStdDimOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenStdCorrectionOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenNarrowOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAten_EmbeddingBagOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenLiftFreshCopyOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenIndexTensorHackedTwinOp>(
+      patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenMseLossOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenNormScalarOptDimOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenRandintOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenRandintLowOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenVarMeanCorrectionOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposePrimsConvertElementTypeOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposePrimsVarOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposePrimsSqrtOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenRandnOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenRandnGeneratorOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenRandnLikeOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenVarMeanOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenLeakyReluOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenLeakyReluBackwardOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenNewEmptyStridedOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenBucketizeTensorOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposePrimsSqueezeOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenMovedimIntOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenOneHotOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenCrossEntropyLossOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenVarMeanDimOp>(patterns);
+  addPatternIfTargetOpIsIllegal<DecomposeAtenTopkOp>(patterns);
+}
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::Torch::createDecomposeComplexOpsPass(
+    ArrayRef<std::string> legalOps, ArrayRef<std::string> opEfficiencies) {
+  return std::make_unique<DecomposeComplexOpsPass>(legalOps, opEfficiencies);
+}
+
 std::unique_ptr<OperationPass<func::FuncOp>>
 mlir::torch::Torch::createDecomposeComplexOpsPass(
-    ArrayRef<std::string> legalOps) {
-  return std::make_unique<DecomposeComplexOpsPass>(legalOps);
+    ArrayRef<std::string> legalOps,
+    std::shared_ptr<const DecompositionCostModel> costModel) {
+  return std::make_unique<DecomposeComplexOpsPass>(legalOps,
+                                                   std::move(costModel));
 }
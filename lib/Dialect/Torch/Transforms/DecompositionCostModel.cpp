@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "torch-mlir/Dialect/Torch/Transforms/DecompositionCostModel.h"
+
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+// Returns the number of elements of `type`, or std::nullopt if its sizes
+// aren't static.
+static std::optional<double> getNumElements(BaseTensorType type) {
+  if (!type.areAllSizesKnown())
+    return std::nullopt;
+  double numElements = 1;
+  for (int64_t size : type.getSizes())
+    numElements *= size;
+  return numElements;
+}
+
+// Returns the number of bytes of `type`, or std::nullopt if its sizes or
+// dtype aren't known.
+static std::optional<double> getNumBytes(BaseTensorType type) {
+  std::optional<double> numElements = getNumElements(type);
+  if (!numElements || !type.hasDtype() || !type.getDtype().isIntOrFloat())
+    return std::nullopt;
+  return *numElements *
+         llvm::divideCeil(type.getDtype().getIntOrFloatBitWidth(), 8);
+}
+
+// Returns the number of multiply-adds per element of the result of a matmul
+// or convolution, or std::nullopt if `op` is neither or its sizes aren't
+// static.
+static std::optional<double> getMultiplyAddsPerElement(Operation *op) {
+  auto getSizes = [&](unsigned operand) -> ArrayRef<int64_t> {
+    auto type = op->getOperand(operand).getType().cast<BaseTensorType>();
+    if (!type.areAllSizesKnown() || type.getSizes().empty())
+      return {};
+    return type.getSizes();
+  };
+  // The contraction dim is the innermost dim of the lhs.
+  if (isa<AtenMmOp, AtenBmmOp, AtenMatmulOp, AtenLinearOp>(op)) {
+    ArrayRef<int64_t> lhsSizes = getSizes(0);
+    if (lhsSizes.empty())
+      return std::nullopt;
+    return lhsSizes.back();
+  }
+  if (isa<AtenAddmmOp, AtenBaddbmmOp>(op)) {
+    ArrayRef<int64_t> lhsSizes = getSizes(1);
+    if (lhsSizes.empty())
+      return std::nullopt;
+    return lhsSizes.back();
+  }
+  // Each element of the result of a convolution, or of the input of a
+  // transposed convolution, is multiplied with a slice of the weight along
+  // dim 0.
+  if (isa<AtenConvolutionOp, Aten_ConvolutionOp, AtenConv2dOp>(op)) {
+    auto weightType = op->getOperand(1).getType().cast<BaseTensorType>();
+    std::optional<double> weightElements = getNumElements(weightType);
+    if (!weightElements || weightType.getSizes().empty() ||
+        weightType.getSizes()[0] == 0)
+      return std::nullopt;
+    return *weightElements / weightType.getSizes()[0];
+  }
+  return std::nullopt;
+}
+
+std::optional<OpCost> Torch::estimateOpCost(Operation *op) {
+  // Views and casts of the static information of a tensor only change its
+  // metadata, unlike conversions of its dtype or device. Ops without tensor
+  // results, such as `aten.size.int`, at most read the metadata of a tensor.
+  if (isViewLikeOp(op) && !isa<AtenToDtypeOp, AtenToDtypeLayoutOp,
+                               AtenToDeviceOp, AtenContiguousOp>(op))
+    return OpCost();
+  if (llvm::none_of(op->getResultTypes(),
+                    [](Type type) { return type.isa<BaseTensorType>(); }))
+    return OpCost();
+
+  OpCost cost;
+  double maxElements = 0;
+  SmallVector<Type> types(op->getOperandTypes());
+  llvm::append_range(types, op->getResultTypes());
+  for (Type type : types) {
+    auto tensorType = type.dyn_cast<BaseTensorType>();
+    if (!tensorType)
+      continue;
+    std::optional<double> numBytes = getNumBytes(tensorType);
+    if (!numBytes)
+      return std::nullopt;
+    cost.bytes += *numBytes;
+    maxElements = std::max(maxElements, *getNumElements(tensorType));
+  }
+  if (cost.bytes == 0)
+    return cost;
+
+  if (isa<AtenMmOp, AtenBmmOp, AtenMatmulOp, AtenLinearOp, AtenAddmmOp,
+          AtenBaddbmmOp, AtenConvolutionOp, Aten_ConvolutionOp, AtenConv2dOp>(
+          op)) {
+    std::optional<double> multiplyAdds = getMultiplyAddsPerElement(op);
+    if (!multiplyAdds)
+      return std::nullopt;
+    bool transposed = false;
+    if (auto convolution = dyn_cast<AtenConvolutionOp>(op)) {
+      if (!matchPattern(convolution.getTransposed(),
+                        m_TorchConstantBool(&transposed)))
+        return std::nullopt;
+    }
+    Value iterated = transposed ? op->getOperand(0) : op->getResult(0);
+    cost.flops = 2 * *multiplyAdds *
+                 *getNumElements(iterated.getType().cast<BaseTensorType>());
+    return cost;
+  }
+  // Elementwise ops, reductions and pooling do about one operation per
+  // element of their largest tensor.
+  cost.flops = maxElements;
+  return cost;
+}
+
+RooflineCostModel::RooflineCostModel(double flopsPerByte,
+                                     llvm::StringMap<double> opEfficiencies)
+    : flopsPerByte(flopsPerByte), opEfficiencies(std::move(opEfficiencies)) {}
+
+FailureOr<std::unique_ptr<RooflineCostModel>>
+RooflineCostModel::parse(double flopsPerByte,
+                         ArrayRef<std::string> opEfficiencies) {
+  if (!(flopsPerByte > 0))
+    return failure();
+  llvm::StringMap<double> efficiencies;
+  for (StringRef entry : opEfficiencies) {
+    auto [opName, efficiencyString] = entry.split('=');
+    double efficiency;
+    if (opName.empty() || efficiencyString.getAsDouble(efficiency) ||
+        !(efficiency > 0))
+      return failure();
+    efficiencies[opName] = efficiency;
+  }
+  return std::make_unique<RooflineCostModel>(flopsPerByte,
+                                             std::move(efficiencies));
+}
+
+std::optional<double> RooflineCostModel::getCost(Operation *op) const {
+  std::optional<OpCost> cost = estimateOpCost(op);
+  if (!cost)
+    return std::nullopt;
+  double efficiency = opEfficiencies.lookup(
+      op->getName().getStringRef().ltrim(kTorchOpPrefix));
+  if (efficiency == 0)
+    efficiency = 1;
+  return std::max(cost->bytes, cost->flops / (flopsPerByte * efficiency));
+}
@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/SymbolTable.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+// Returns the attributes of `func` other than its name.
+static DictionaryAttr getAttrsWithoutName(func::FuncOp func) {
+  NamedAttrList attrs(func->getAttrDictionary());
+  attrs.erase(SymbolTable::getSymbolAttrName());
+  return attrs.getDictionary(func.getContext());
+}
+
+// Returns a hash of the signature, the attributes other than the name, and
+// the names and result types of the ops of `func`, which is the same for
+// equivalent functions.
+static llvm::hash_code hashFunction(func::FuncOp func) {
+  llvm::hash_code hash =
+      llvm::hash_combine(func.getFunctionType(), getAttrsWithoutName(func));
+  func.walk([&](Operation *op) {
+    hash = llvm::hash_combine(hash, op->getName(), op->getAttrDictionary(),
+                              TypeRange(op->getResultTypes()));
+  });
+  return hash;
+}
+
+// Returns true if `lhs` and `rhs` compute the same thing: they only differ by
+// their names and the locations of their ops.
+static bool areEquivalentFunctions(func::FuncOp lhs, func::FuncOp rhs) {
+  if (lhs.getFunctionType() != rhs.getFunctionType())
+    return false;
+  if (getAttrsWithoutName(lhs) != getAttrsWithoutName(rhs))
+    return false;
+  Region &lhsBody = lhs.getBody(), &rhsBody = rhs.getBody();
+  if (!lhsBody.hasOneBlock() || !rhsBody.hasOneBlock())
+    return false;
+  Block &lhsBlock = lhsBody.front(), &rhsBlock = rhsBody.front();
+  if (lhsBlock.getOperations().size() != rhsBlock.getOperations().size())
+    return false;
+
+  // The values of `lhs` that correspond to the values of `rhs`.
+  DenseMap<Value, Value> equivalentValues;
+  for (auto [lhsArg, rhsArg] :
+       llvm::zip(lhsBlock.getArguments(), rhsBlock.getArguments()))
+    equivalentValues[rhsArg] = lhsArg;
+  auto checkEquivalent = [&](Value lhsValue, Value rhsValue) {
+    return success(equivalentValues.lookup(rhsValue) == lhsValue);
+  };
+  auto markEquivalent = [&](Value lhsValue, Value rhsValue) {
+    equivalentValues[rhsValue] = lhsValue;
+  };
+  for (auto [lhsOp, rhsOp] : llvm::zip(lhsBlock, rhsBlock)) {
+    if (!OperationEquivalence::isEquivalentTo(
+            &lhsOp, &rhsOp, checkEquivalent, markEquivalent,
+            OperationEquivalence::IgnoreLocations))
+      return false;
+  }
+  return true;
+}
+
+namespace {
+class DeduplicateFunctionsPass
+    : public DeduplicateFunctionsBase<DeduplicateFunctionsPass> {
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    // Merging two functions can make their callers equivalent, so repeat
+    // until no functions are merged.
+    while (deduplicateOnce(module)) {
+    }
+  }
+
+  // Replaces the uses of each private function equivalent to an earlier one
+  // with the earlier one. Returns true if any function was replaced.
+  bool deduplicateOnce(ModuleOp module) {
+    DenseMap<llvm::hash_code, SmallVector<func::FuncOp>> functionsByHash;
+    SmallVector<std::pair<func::FuncOp, func::FuncOp>> duplicates;
+    for (auto func : module.getOps<func::FuncOp>()) {
+      if (!func.isPrivate() || func.isExternal())
+        continue;
+      SmallVector<func::FuncOp> &candidates =
+          functionsByHash[hashFunction(func)];
+      auto original = llvm::find_if(candidates, [&](func::FuncOp candidate) {
+        return areEquivalentFunctions(candidate, func);
+      });
+      if (original != candidates.end()) {
+        duplicates.emplace_back(func, *original);
+        continue;
+      }
+      candidates.push_back(func);
+    }
+    for (auto [duplicate, original] : duplicates) {
+      if (failed(SymbolTable::replaceAllSymbolUses(
+              duplicate, original.getSymNameAttr(), module))) {
+        duplicate.emitError("failed to replace the uses of the function");
+        signalPassFailure();
+        return false;
+      }
+      duplicate.erase();
+      ++numDeduplicatedFunctions;
+    }
+    return !duplicates.empty();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>>
+mlir::torch::Torch::createDeduplicateFunctionsPass() {
+  return std::make_unique<DeduplicateFunctionsPass>();
+}
@@ -9,6 +9,7 @@
 
 #include "PassDetail.h"
 
+#include "ReifyAbstractInterpCalculationsUtils.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
@@ -44,6 +45,10 @@ class DropAbstractInterpCalculationsPass
   void runOnOperation() override {
     MLIRContext *context = &getContext();
 
+    // Give the ops that reused a memoized calculation the results of that
+    // calculation before the calculations disappear.
+    applyMemoizedCalculationResults(getOperation());
+
     RewritePatternSet patterns(context);
     patterns.insert<DropCalculateOp<DtypeCalculateOp>>(context);
     patterns.insert<DropCalculateOp<ShapeCalculateOp>>(context);
@@ -0,0 +1,170 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+#include "llvm/ADT/SetVector.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+// Returns the tensor that `alias` is a cast of, through any number of
+// `torch.tensor_static_info_cast` ops. Casts only encode compile time
+// information, so both are the same tensor at runtime.
+static Value stripCasts(Value alias) {
+  while (auto cast = alias.getDefiningOp<TensorStaticInfoCastOp>())
+    alias = cast.getOperand();
+  return alias;
+}
+
+// Returns the ops of the block of `root` that access the tensor it creates or
+// a view of it, directly or from one of their regions, in block order.
+//
+// The tensor is only known to have no aliases beyond these views if each use
+// of them is by a view-like op, a `torch.copy.to_vtensor`, a
+// `torch.overwrite.tensor.contents` or the return of the function. Any other
+// use could keep an alias around for later ops to access, in which case
+// failure is returned.
+static FailureOr<SmallVector<Operation *>>
+getAccesses(CopyToNonValueTensorOp root) {
+  Block *block = root->getBlock();
+  llvm::SetVector<Operation *> accesses;
+  SmallVector<Value> workList{root.getResult()};
+  while (!workList.empty()) {
+    Value alias = workList.pop_back_val();
+    for (Operation *user : alias.getUsers()) {
+      Operation *access = block->findAncestorOpInBlock(*user);
+      if (!access)
+        return failure();
+      if (access != user) {
+        if (!isa<CopyToValueTensorOp, OverwriteTensorContentsOp>(user))
+          return failure();
+        accesses.insert(access);
+        continue;
+      }
+      if (isViewLikeOp(user)) {
+        if (user->getNumResults() != 1)
+          return failure();
+        // Views taking two aliases, such as `aten.expand_as`, are reached
+        // once per alias, but their own views only need to be walked once.
+        Value view = user->getResult(0);
+        if (accesses.insert(user) && view.getType().isa<NonValueTensorType>())
+          workList.push_back(view);
+        continue;
+      }
+      if (!isa<CopyToValueTensorOp, OverwriteTensorContentsOp,
+               func::ReturnOp>(user))
+        return failure();
+      accesses.insert(user);
+    }
+  }
+  SmallVector<Operation *> sorted = accesses.takeVector();
+  llvm::sort(sorted, [](Operation *lhs, Operation *rhs) {
+    return lhs->isBeforeInBlock(rhs);
+  });
+  return sorted;
+}
+
+// Interprets the accesses to the tensor created by `root` in order, tracking
+// which value tensor, if any, is known to hold the current contents of each
+// alias. Copies of an alias with known contents are replaced by them, and
+// overwrites whose contents are never read are erased. Returns the number of
+// copies eliminated.
+static int64_t eliminateCopies(CopyToNonValueTensorOp root,
+                               ArrayRef<Operation *> accesses) {
+  int64_t numEliminated = 0;
+  // Keyed by the aliases with their casts stripped.
+  DenseMap<Value, Value> knownContents;
+  knownContents[root.getResult()] = root.getOperand();
+  SmallVector<OverwriteTensorContentsOp> unreadOverwrites;
+  OpBuilder builder(root.getContext());
+  for (Operation *access : accesses) {
+    if (auto copy = dyn_cast<CopyToValueTensorOp>(access)) {
+      Value &contents = knownContents[stripCasts(copy.getOperand())];
+      if (!contents) {
+        contents = copy.getResult();
+        unreadOverwrites.clear();
+        continue;
+      }
+      builder.setInsertionPoint(copy);
+      Value replacement = copyTensorToType(
+          builder, copy.getLoc(), copy.getType().cast<BaseTensorType>(),
+          contents);
+      copy.replaceAllUsesWith(replacement);
+      copy.erase();
+      numEliminated++;
+    } else if (auto overwrite = dyn_cast<OverwriteTensorContentsOp>(access)) {
+      // Overwriting an alias again without reading any alias in between makes
+      // the earlier overwrite dead.
+      Value overwritten = stripCasts(overwrite.getOverwritten());
+      llvm::erase_if(unreadOverwrites, [&](OverwriteTensorContentsOp earlier) {
+        if (stripCasts(earlier.getOverwritten()) != overwritten)
+          return false;
+        earlier.erase();
+        numEliminated++;
+        return true;
+      });
+      // The views of a tensor overlap, so any of them might have changed.
+      knownContents.clear();
+      knownContents[overwritten] = overwrite.getValue();
+      unreadOverwrites.push_back(overwrite);
+    } else if (isViewLikeOp(access) &&
+               access->getResult(0).getType().isa<NonValueTensorType>()) {
+      // Creating a view neither reads nor writes the contents.
+    } else {
+      // A view-like op with value semantics or a return reads the aliases,
+      // and the ops with regions accessing them may write them too.
+      if (access->getNumRegions() != 0)
+        knownContents.clear();
+      unreadOverwrites.clear();
+    }
+  }
+  // Nothing outside of `accesses` can read the tensor.
+  for (OverwriteTensorContentsOp overwrite : unreadOverwrites) {
+    overwrite.erase();
+    numEliminated++;
+  }
+  if (root->use_empty()) {
+    root.erase();
+    numEliminated++;
+  }
+  return numEliminated;
+}
+
+namespace {
+class EliminateTensorCopiesPass
+    : public EliminateTensorCopiesBase<EliminateTensorCopiesPass> {
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+    SmallVector<CopyToNonValueTensorOp> roots;
+    func.walk([&](CopyToNonValueTensorOp root) { roots.push_back(root); });
+    for (CopyToNonValueTensorOp root : roots) {
+      FailureOr<SmallVector<Operation *>> accesses = getAccesses(root);
+      if (succeeded(accesses))
+        numEliminatedCopies += eliminateCopies(root, *accesses);
+    }
+    func.walk([&](Operation *op) {
+      if (isa<CopyToNonValueTensorOp, CopyToValueTensorOp,
+              OverwriteTensorContentsOp>(op))
+        ++numRemainingCopies;
+    });
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::Torch::createEliminateTensorCopiesPass() {
+  return std::make_unique<EliminateTensorCopiesPass>();
+}
@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Dominance.h"
+#include "mlir/Interfaces/InferTypeOpInterface.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "llvm/ADT/SetVector.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+static bool allowsTypeRefinement(OpOperand &use) {
+  return use.getOwner()
+      ->hasTrait<mlir::torch::Torch::OpTrait::AllowsTypeRefinement>();
+}
+
+// Returns true if the result types of `op` can be refined to any type with
+// more static information, because nothing derives them from its operands or
+// attributes.
+static bool isResultTypeRefinable(Operation *op) {
+  return op->hasTrait<mlir::torch::Torch::OpTrait::HasValueSemantics>() &&
+         op->hasTrait<mlir::torch::Torch::OpTrait::AllowsTypeRefinement>() &&
+         op->getNumRegions() == 0 && !isa<InferTypeOpInterface>(op);
+}
+
+namespace {
+class EliminateTensorStaticInfoCastsPass
+    : public EliminateTensorStaticInfoCastsBase<
+          EliminateTensorStaticInfoCastsPass> {
+  void runOnOperation() override {
+    postDominance = &getAnalysis<PostDominanceInfo>();
+    SetVector<TensorStaticInfoCastOp> worklist;
+    getOperation().walk(
+        [&](TensorStaticInfoCastOp cast) { worklist.insert(cast); });
+    while (!worklist.empty()) {
+      TensorStaticInfoCastOp cast = worklist.pop_back_val();
+      simplifyCast(cast, worklist);
+    }
+  }
+
+  void simplifyCast(TensorStaticInfoCastOp cast,
+                    SetVector<TensorStaticInfoCastOp> &worklist) {
+    Value operand = cast.getOperand();
+    auto operandType = operand.getType().cast<BaseTensorType>();
+    auto resultType = cast.getType().cast<BaseTensorType>();
+    if (operandType == resultType) {
+      for (Operation *user : cast->getUsers()) {
+        if (auto userCast = dyn_cast<TensorStaticInfoCastOp>(user))
+          worklist.insert(userCast);
+      }
+      cast.getResult().replaceAllUsesWith(operand);
+      worklist.remove(cast);
+      cast.erase();
+      return;
+    }
+    // Casts between contradictory types stay, they fail at runtime.
+    Type meet = meetTensorTypes(operandType, resultType);
+    if (!meet)
+      return;
+
+    // The cast adds static information to the result of an op, so the op
+    // computes a value of the refined type to begin with. This only holds if
+    // the cast runs whenever the op does: a cast in a branch only refines the
+    // value on that branch.
+    Operation *producer = operand.getDefiningOp();
+    if (meet != operandType && producer && isResultTypeRefinable(producer) &&
+        postDominance->postDominates(cast, producer)) {
+      refineValueType(operand, meet, worklist);
+      operandType = meet.cast<BaseTensorType>();
+    }
+    if (operandType != meet)
+      return;
+
+    // The operand is now at least as refined as the result, so the uses that
+    // allow it use the operand directly.
+    for (OpOperand &use : llvm::make_early_inc_range(cast->getUses())) {
+      if (!allowsTypeRefinement(use))
+        continue;
+      use.set(operand);
+      if (auto userCast = dyn_cast<TensorStaticInfoCastOp>(use.getOwner()))
+        worklist.insert(userCast);
+    }
+    // Refining the operand may have queued the cast again.
+    if (cast.use_empty()) {
+      worklist.remove(cast);
+      cast.erase();
+    }
+  }
+
+  PostDominanceInfo *postDominance = nullptr;
+
+  // Sets the type of `value` to `newType`, and casts it back to its original
+  // type for the uses that require it.
+  void refineValueType(Value value, Type newType,
+                       SetVector<TensorStaticInfoCastOp> &worklist) {
+    Type originalType = value.getType();
+    SmallVector<OpOperand *> usesRequiringOriginalType;
+    for (OpOperand &use : value.getUses()) {
+      if (auto userCast = dyn_cast<TensorStaticInfoCastOp>(use.getOwner()))
+        worklist.insert(userCast);
+      else if (!allowsTypeRefinement(use))
+        usesRequiringOriginalType.push_back(&use);
+    }
+    value.setType(newType);
+    if (usesRequiringOriginalType.empty())
+      return;
+    OpBuilder b(value.getContext());
+    b.setInsertionPointAfterValue(value);
+    Value originalTypedValue =
+        b.create<TensorStaticInfoCastOp>(value.getLoc(), originalType, value);
+    for (OpOperand *use : usesRequiringOriginalType)
+      use->set(originalTypedValue);
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::Torch::createEliminateTensorStaticInfoCastsPass() {
+  return std::make_unique<EliminateTensorStaticInfoCastsPass>();
+}
@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/DecompositionCostModel.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+// Returns the number of bytes of the tensors among `values`, or std::nullopt
+// if one of them doesn't have static sizes or a dtype.
+static std::optional<double> getTensorBytes(ValueRange values) {
+  double bytes = 0;
+  for (Value value : values) {
+    auto type = value.getType().dyn_cast<BaseTensorType>();
+    if (!type)
+      continue;
+    if (!type.areAllSizesKnown() || !type.hasDtype() ||
+        !type.getDtype().isIntOrFloat())
+      return std::nullopt;
+    double numElements = 1;
+    for (int64_t size : type.getSizes())
+      numElements *= size;
+    bytes += numElements *
+             llvm::divideCeil(type.getDtype().getIntOrFloatBitWidth(), 8);
+  }
+  return bytes;
+}
+
+namespace {
+// The costs of a function.
+struct FunctionCost {
+  double flops = 0;
+  double bytes = 0;
+  double parameterBytes = 0;
+  double activationBytes = 0;
+  int64_t numUnestimatedOps = 0;
+};
+} // namespace
+
+static DictionaryAttr getCostAttr(Builder &b, const FunctionCost &cost) {
+  return b.getDictionaryAttr({
+      b.getNamedAttr("flops", b.getF64FloatAttr(cost.flops)),
+      b.getNamedAttr("bytes", b.getI64IntegerAttr(cost.bytes)),
+      b.getNamedAttr("parameter_bytes",
+                     b.getI64IntegerAttr(cost.parameterBytes)),
+      b.getNamedAttr("activation_bytes",
+                     b.getI64IntegerAttr(cost.activationBytes)),
+      b.getNamedAttr("num_unestimated_ops",
+                     b.getI64IntegerAttr(cost.numUnestimatedOps)),
+  });
+}
+
+namespace {
+class EstimateCostsPass : public EstimateCostsBase<EstimateCostsPass> {
+public:
+  EstimateCostsPass() = default;
+  EstimateCostsPass(bool perOp) { this->perOp = perOp; }
+
+  void runOnOperation() override {
+    Builder b(&getContext());
+    for (auto func : getOperation().getOps<func::FuncOp>()) {
+      if (func.isExternal())
+        continue;
+      FunctionCost funcCost;
+      // The arguments of the function are activations too.
+      for (Value arg : func.getArguments()) {
+        if (std::optional<double> argBytes = getTensorBytes(arg))
+          funcCost.activationBytes += *argBytes;
+      }
+
+      func.walk([&](Operation *op) {
+        if (op->getNumResults() == 0)
+          return;
+        std::optional<double> resultBytes = getTensorBytes(op->getResults());
+        // Literals are the parameters of the model, which are loaded rather
+        // than computed.
+        if (isa<ValueTensorLiteralOp, NonValueTensorLiteralOp>(op)) {
+          if (resultBytes)
+            funcCost.parameterBytes += *resultBytes;
+          else
+            ++funcCost.numUnestimatedOps;
+          return;
+        }
+        std::optional<OpCost> cost = estimateOpCost(op);
+        if (!cost || !resultBytes) {
+          ++funcCost.numUnestimatedOps;
+          return;
+        }
+        funcCost.flops += cost->flops;
+        funcCost.bytes += cost->bytes;
+        // Ops that do no work, such as views, don't write a new tensor.
+        if (cost->bytes != 0)
+          funcCost.activationBytes += *resultBytes;
+        if (perOp && llvm::any_of(op->getResultTypes(), [](Type type) {
+              return type.isa<BaseTensorType>();
+            })) {
+          op->setAttr("torch.cost",
+                      b.getDictionaryAttr({
+                          b.getNamedAttr("flops",
+                                         b.getF64FloatAttr(cost->flops)),
+                          b.getNamedAttr("bytes",
+                                         b.getI64IntegerAttr(cost->bytes)),
+                      }));
+        }
+      });
+      func->setAttr("torch.cost", getCostAttr(b, funcCost));
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>>
+mlir::torch::Torch::createEstimateCostsPass(bool perOp) {
+  return std::make_unique<EstimateCostsPass>(perOp);
+}
@@ -0,0 +1,259 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectResourceBlobManager.h"
+#include "mlir/IR/SymbolTable.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+// Returns the safetensors dtype of elements of type `type`, or an empty string
+// if it has none.
+static StringRef getSafetensorsDtype(Type type) {
+  if (type.isF64())
+    return "F64";
+  if (type.isF32())
+    return "F32";
+  if (type.isF16())
+    return "F16";
+  if (type.isBF16())
+    return "BF16";
+  if (type.isFloat8E5M2())
+    return "F8_E5M2";
+  if (type.isFloat8E4M3FN())
+    return "F8_E4M3";
+  auto intType = type.dyn_cast<IntegerType>();
+  if (!intType)
+    return "";
+  if (intType.getWidth() == 1)
+    return "BOOL";
+  if (intType.isUnsigned())
+    return intType.getWidth() == 8 ? "U8" : "";
+  switch (intType.getWidth()) {
+  case 8:
+    return "I8";
+  case 16:
+    return "I16";
+  case 32:
+    return "I32";
+  case 64:
+    return "I64";
+  default:
+    return "";
+  }
+}
+
+// Returns whether the contents of `elements` can be written to a safetensors
+// file by `writeContents`.
+static bool canWriteContents(ElementsAttr elements) {
+  if (getSafetensorsDtype(elements.getElementType()).empty())
+    return false;
+  if (auto resource = elements.dyn_cast<DenseResourceElementsAttr>())
+    return resource.getRawHandle().getBlob() != nullptr;
+  return elements.isa<DenseElementsAttr>();
+}
+
+// Returns the number of bytes that `writeContents` writes for `elements`.
+static int64_t getContentsSize(ElementsAttr elements) {
+  Type elementType = elements.getElementType();
+  int64_t elementBytes =
+      std::max<int64_t>(1, elementType.getIntOrFloatBitWidth() / 8);
+  return elements.getNumElements() * elementBytes;
+}
+
+// Writes the row-major contents of `elements` to `os`, with a byte per
+// boolean, as safetensors stores them.
+static void writeContents(raw_ostream &os, ElementsAttr elements) {
+  if (auto resource = elements.dyn_cast<DenseResourceElementsAttr>()) {
+    ArrayRef<char> data = resource.getRawHandle().getBlob()->getData();
+    os.write(data.data(), data.size());
+    return;
+  }
+  auto dense = elements.cast<DenseElementsAttr>();
+  // Dense booleans are stored as bits.
+  if (dense.getElementType().isInteger(1)) {
+    for (bool value : dense.getValues<bool>())
+      os << static_cast<char>(value);
+    return;
+  }
+  ArrayRef<char> raw = dense.getRawData();
+  int64_t numCopies = dense.isSplat() ? dense.getNumElements() : 1;
+  for (int64_t i = 0; i < numCopies; i++)
+    os.write(raw.data(), raw.size());
+}
+
+// Returns whether `tensor`, read from a global slot, is only read, through
+// any views of it, so that its contents can be provided by external storage.
+static bool isOnlyRead(Value tensor) {
+  for (Operation *user : tensor.getUsers()) {
+    if (isa<TensorStaticInfoCastOp>(user) || isViewLikeOp(user)) {
+      if (user->getNumResults() != 1 || !isOnlyRead(user->getResult(0)))
+        return false;
+      continue;
+    }
+    if (!isa<CopyToValueTensorOp, func::ReturnOp>(user) &&
+        !user->hasTrait<OpTrait::HasValueSemantics>())
+      return false;
+  }
+  return true;
+}
+
+// Returns whether `slot` is only ever read, with its initial value.
+static bool isReadOnlySlot(GlobalSlotOp slot, ModuleOp module) {
+  std::optional<SymbolTable::UseRange> uses =
+      SymbolTable::getSymbolUses(slot, module);
+  if (!uses)
+    return false;
+  for (const SymbolTable::SymbolUse &use : *uses) {
+    Operation *user = use.getUser();
+    if (isa<InitializeGlobalSlotsOp>(user))
+      continue;
+    auto get = dyn_cast<GlobalSlotGetOp>(user);
+    if (!get)
+      return false;
+    // Value tensors can't be mutated.
+    if (!get.getType().isa<ValueTensorType>() && !isOnlyRead(get.getResult()))
+      return false;
+  }
+  return true;
+}
+
+// Writes `weights`, keyed by name, to the safetensors file `path`, in order.
+static LogicalResult
+writeSafetensors(ModuleOp module, StringRef path,
+                 ArrayRef<std::pair<StringRef, ElementsAttr>> weights) {
+  llvm::json::Object header;
+  int64_t offset = 0;
+  for (auto [name, elements] : weights) {
+    int64_t size = getContentsSize(elements);
+    auto type = elements.getType().cast<ShapedType>();
+    header[name] = llvm::json::Object{
+        {"dtype", getSafetensorsDtype(elements.getElementType())},
+        {"shape", llvm::json::Array(type.getShape())},
+        {"data_offsets", llvm::json::Array{offset, offset + size}}};
+    offset += size;
+  }
+  std::string headerString;
+  llvm::raw_string_ostream(headerString)
+      << llvm::json::Value(std::move(header));
+  // The header is padded with spaces to keep the contents 8-byte aligned.
+  headerString.append((8 - headerString.size() % 8) % 8, ' ');
+
+  std::error_code error;
+  llvm::raw_fd_ostream os(path, error);
+  if (error)
+    return emitError(module.getLoc())
+           << "could not open the weights file '" << path
+           << "': " << error.message();
+  llvm::support::endian::write<uint64_t>(os, headerString.size(),
+                                         llvm::support::little);
+  os << headerString;
+  for (auto [name, elements] : weights)
+    writeContents(os, elements);
+  return success();
+}
+
+namespace {
+class ExternalizeWeightsPass
+    : public ExternalizeWeightsBase<ExternalizeWeightsPass> {
+public:
+  ExternalizeWeightsPass() = default;
+  ExternalizeWeightsPass(StringRef weightsFile) {
+    this->weightsFile = weightsFile.str();
+  }
+
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    InitializeGlobalSlotsOp initialize;
+    for (auto initializer : module.getOps<GlobalSlotModuleInitializerOp>()) {
+      initialize =
+          cast<InitializeGlobalSlotsOp>(initializer.getBody()->getTerminator());
+    }
+    if (!initialize)
+      return;
+
+    DenseMap<StringAttr, unsigned> initialValueIndices;
+    for (auto [index, symName] :
+         llvm::enumerate(initialize.getSlotSymNames())) {
+      initialValueIndices[symName.cast<FlatSymbolRefAttr>().getAttr()] =
+          index;
+    }
+
+    // The weights are named by their slot, which is their key in the
+    // `state_dict()` of the root module.
+    SmallVector<std::pair<StringRef, ElementsAttr>> weights;
+    llvm::SetVector<Operation *> literals;
+    OpBuilder b(initialize);
+    for (auto slot : module.getOps<GlobalSlotOp>()) {
+      if (slot.getVisibility() == SymbolTable::Visibility::Public)
+        continue;
+      auto indexIt = initialValueIndices.find(slot.getSymNameAttr());
+      if (indexIt == initialValueIndices.end())
+        continue;
+      unsigned index = indexIt->second;
+      Operation *literal = initialize.getInitialValues()[index].getDefiningOp();
+      if (!isa_and_nonnull<NonValueTensorLiteralOp, ValueTensorLiteralOp>(
+              literal))
+        continue;
+      auto elements = literal->getAttrOfType<ElementsAttr>("value");
+      if (!elements || !canWriteContents(elements) ||
+          !isReadOnlySlot(slot, module))
+        continue;
+
+      auto type = elements.getType().cast<RankedTensorType>();
+      Value external;
+      if (isa<NonValueTensorLiteralOp>(literal)) {
+        external = b.create<NonValueTensorExternalOp>(
+            literal->getLoc(),
+            NonValueTensorType::get(b.getContext(), type.getShape(),
+                                    type.getElementType()),
+            slot.getSymNameAttr());
+      } else {
+        external = b.create<ValueTensorExternalOp>(
+            literal->getLoc(),
+            ValueTensorType::get(b.getContext(), type.getShape(),
+                                 type.getElementType()),
+            slot.getSymNameAttr());
+      }
+      initialize->setOperand(index, external);
+      weights.emplace_back(slot.getSymName(), elements);
+      literals.insert(literal);
+      ++numExternalizedWeights;
+    }
+
+    // The contents are written before the literals holding them are erased.
+    if (!weightsFile.empty() &&
+        failed(writeSafetensors(module, weightsFile, weights)))
+      return signalPassFailure();
+    for (Operation *literal : literals) {
+      if (literal->use_empty())
+        literal->erase();
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>>
+mlir::torch::Torch::createExternalizeWeightsPass(StringRef weightsFile) {
+  return std::make_unique<ExternalizeWeightsPass>(weightsFile);
+}
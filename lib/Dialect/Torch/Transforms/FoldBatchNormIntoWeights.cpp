@@ -0,0 +1,335 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+
+#include <cmath>
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+// Returns the value of `value` if it is a floating point tensor literal that
+// can be replaced by another literal. A non-value tensor literal can be
+// mutated through any of its uses, so it is only accepted if it has one use.
+static DenseFPElementsAttr getFloatLiteral(Value value) {
+  Attribute attr;
+  if (auto literal = value.getDefiningOp<ValueTensorLiteralOp>())
+    attr = literal.getValue();
+  else if (auto literal = value.getDefiningOp<NonValueTensorLiteralOp>())
+    if (value.hasOneUse())
+      attr = literal.getValue();
+  return attr.dyn_cast_or_null<DenseFPElementsAttr>();
+}
+
+static SmallVector<double> getValues(DenseFPElementsAttr attr) {
+  SmallVector<double> values;
+  values.reserve(attr.getNumElements());
+  for (APFloat value : attr.getValues<APFloat>()) {
+    bool losesInfo;
+    value.convert(APFloat::IEEEdouble(), APFloat::rmNearestTiesToEven,
+                  &losesInfo);
+    values.push_back(value.convertToDouble());
+  }
+  return values;
+}
+
+// Returns the values of the per-channel operand `value`, which is either None
+// or a rank-1 literal with `numChannels` elements.
+static FailureOr<SmallVector<double>>
+getChannelValues(Value value, int64_t numChannels, double noneValue) {
+  if (value.getType().isa<Torch::NoneType>())
+    return SmallVector<double>(numChannels, noneValue);
+  DenseFPElementsAttr attr = getFloatLiteral(value);
+  if (!attr || attr.getType().getRank() != 1 ||
+      attr.getNumElements() != numChannels)
+    return failure();
+  return getValues(attr);
+}
+
+namespace {
+// The literal weight and bias of a convolution or linear op. Dim 0 of the
+// weight is the output channel dim, and the bias has one element per output
+// channel.
+struct LiteralWeights {
+  ShapedType weightType;
+  ShapedType biasType;
+  bool hasValueSemantics;
+  int64_t numChannels;
+  SmallVector<double> weight;
+  SmallVector<double> bias;
+
+  // Scales the weight and bias of output channel `c` by `scale[c]`.
+  void scale(ArrayRef<double> scale) {
+    int64_t innerSize = weight.size() / numChannels;
+    for (size_t i = 0, e = weight.size(); i < e; i++)
+      weight[i] *= scale[i / innerSize];
+    for (int64_t c = 0; c < numChannels; c++)
+      bias[c] *= scale[c];
+  }
+};
+} // namespace
+
+template <typename OpTy>
+static FailureOr<LiteralWeights> getLiteralWeights(OpTy op) {
+  if constexpr (std::is_same_v<OpTy, AtenConvolutionOp>) {
+    bool transposed;
+    if (!matchPattern(op.getTransposed(), m_TorchConstantBool(&transposed)) ||
+        transposed)
+      return failure();
+  }
+  DenseFPElementsAttr weightAttr = getFloatLiteral(op.getWeight());
+  if (!weightAttr || weightAttr.getType().getRank() < 2 ||
+      weightAttr.getType().getDimSize(0) == 0)
+    return failure();
+  // The folded bias is rounded to the element type of the weight.
+  if (!op.getBias().getType().template isa<Torch::NoneType>()) {
+    DenseFPElementsAttr biasAttr = getFloatLiteral(op.getBias());
+    if (!biasAttr ||
+        biasAttr.getType().getElementType() != weightAttr.getElementType())
+      return failure();
+  }
+  LiteralWeights weights;
+  weights.weightType = weightAttr.getType();
+  weights.hasValueSemantics =
+      op.getWeight().getType().template isa<ValueTensorType>();
+  weights.numChannels = weights.weightType.getDimSize(0);
+  weights.weight = getValues(weightAttr);
+  weights.biasType = RankedTensorType::get({weights.numChannels},
+                                           weights.weightType.getElementType());
+  FailureOr<SmallVector<double>> bias =
+      getChannelValues(op.getBias(), weights.numChannels, /*noneValue=*/0);
+  if (failed(bias))
+    return failure();
+  weights.bias = std::move(*bias);
+  return weights;
+}
+
+static Value createLiteral(PatternRewriter &rewriter, Location loc,
+                           ShapedType type, ArrayRef<double> values,
+                           bool hasValueSemantics) {
+  const llvm::fltSemantics &semantics =
+      type.getElementType().cast<mlir::FloatType>().getFloatSemantics();
+  SmallVector<APFloat> elements;
+  elements.reserve(values.size());
+  for (double value : values) {
+    APFloat element(value);
+    bool losesInfo;
+    element.convert(semantics, APFloat::rmNearestTiesToEven, &losesInfo);
+    elements.push_back(element);
+  }
+  auto attr = DenseElementsAttr::get(type, elements);
+  if (hasValueSemantics)
+    return rewriter.create<ValueTensorLiteralOp>(loc, attr);
+  return rewriter.create<NonValueTensorLiteralOp>(loc, attr);
+}
+
+// Replaces the weight and bias of `op` by literals holding `weights`, and
+// replaces `user` by `op`.
+template <typename OpTy>
+static void replaceWithFoldedOp(PatternRewriter &rewriter, OpTy op,
+                                Operation *user,
+                                const LiteralWeights &weights) {
+  rewriter.setInsertionPoint(op);
+  Value weight =
+      createLiteral(rewriter, op.getLoc(), weights.weightType, weights.weight,
+                    weights.hasValueSemantics);
+  Value bias = createLiteral(rewriter, op.getLoc(), weights.biasType,
+                             weights.bias, weights.hasValueSemantics);
+  rewriter.updateRootInPlace(op, [&]() {
+    op.getWeightMutable().assign(weight);
+    op.getBiasMutable().assign(bias);
+  });
+  rewriter.replaceOp(user, op.getResult());
+}
+
+// Returns the producer of `value` if it is an `OpTy` whose result is only used
+// by `user`, which has the same result type.
+template <typename OpTy>
+static OpTy getFoldableProducer(Value value, Operation *user) {
+  auto producer = value.getDefiningOp<OpTy>();
+  if (!producer || !producer->hasOneUse() ||
+      producer.getType() != user->getResult(0).getType())
+    return nullptr;
+  return producer;
+}
+
+// Returns the dim of the result of `OpTy` along which per-channel operands
+// are broadcast.
+template <typename OpTy> static int64_t getChannelDim(int64_t rank) {
+  if constexpr (std::is_same_v<OpTy, AtenLinearOp>)
+    return rank - 1;
+  return 1;
+}
+
+namespace {
+// Folds an inference-mode `aten.batch_norm` with literal parameters into the
+// literal weight and bias of the convolution or linear op producing its input:
+//   scale = bn_weight / sqrt(running_var + eps)
+//   weight' = weight * scale (broadcast along dim 0)
+//   bias' = (bias - running_mean) * scale + bn_bias
+// For a linear op, the batch_norm must normalize the output features, i.e.
+// its input must have rank 2.
+template <typename OpTy>
+class FoldBatchNormIntoLiteralWeights
+    : public OpRewritePattern<AtenBatchNormOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(AtenBatchNormOp op,
+                                PatternRewriter &rewriter) const override {
+    auto producer = getFoldableProducer<OpTy>(op.getInput(), op);
+    if (!producer)
+      return rewriter.notifyMatchFailure(
+          op, "input is not a convolution or linear op only used here");
+    if constexpr (std::is_same_v<OpTy, AtenLinearOp>) {
+      std::optional<unsigned> rank = getTensorRank(op.getInput());
+      if (!rank || *rank != 2)
+        return rewriter.notifyMatchFailure(
+            op, "a linear op must produce a rank 2 input");
+    }
+    bool training;
+    if (!matchPattern(op.getTraining(), m_TorchConstantBool(&training)) ||
+        training)
+      return rewriter.notifyMatchFailure(op, "expected inference mode");
+    double eps;
+    if (!matchPattern(op.getEps(), m_TorchConstantFloat(&eps)))
+      return rewriter.notifyMatchFailure(op, "eps must be a constant float");
+    if (op.getRunningMean().getType().isa<Torch::NoneType>() ||
+        op.getRunningVar().getType().isa<Torch::NoneType>())
+      return rewriter.notifyMatchFailure(
+          op, "running stats must not be None in inference mode");
+
+    FailureOr<LiteralWeights> weights = getLiteralWeights(producer);
+    if (failed(weights))
+      return rewriter.notifyMatchFailure(
+          op, "expected literal weight and bias");
+    int64_t numChannels = weights->numChannels;
+    FailureOr<SmallVector<double>> gamma =
+        getChannelValues(op.getWeight(), numChannels, /*noneValue=*/1);
+    FailureOr<SmallVector<double>> beta =
+        getChannelValues(op.getBias(), numChannels, /*noneValue=*/0);
+    FailureOr<SmallVector<double>> mean =
+        getChannelValues(op.getRunningMean(), numChannels, /*noneValue=*/0);
+    FailureOr<SmallVector<double>> var =
+        getChannelValues(op.getRunningVar(), numChannels, /*noneValue=*/1);
+    if (failed(gamma) || failed(beta) || failed(mean) || failed(var))
+      return rewriter.notifyMatchFailure(
+          op, "expected literal per-channel parameters");
+
+    SmallVector<double> scale(numChannels);
+    for (int64_t c = 0; c < numChannels; c++) {
+      scale[c] = (*gamma)[c] / std::sqrt((*var)[c] + eps);
+      weights->bias[c] -= (*mean)[c];
+    }
+    weights->scale(scale);
+    for (int64_t c = 0; c < numChannels; c++)
+      weights->bias[c] += (*beta)[c];
+    replaceWithFoldedOp(rewriter, producer, op, *weights);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Folds the multiplication or addition of the result of a convolution or linear
+// op with literal weights by a literal that is constant across everything but
+// the output channels, e.g. a [C, 1, 1] tensor for a 2D convolution.
+template <typename OpTy, typename ArithOpTy>
+class FoldChannelAffineIntoLiteralWeights : public OpRewritePattern<ArithOpTy> {
+public:
+  using OpRewritePattern<ArithOpTy>::OpRewritePattern;
+  LogicalResult matchAndRewrite(ArithOpTy op,
+                                PatternRewriter &rewriter) const override {
+    auto producer = getFoldableProducer<OpTy>(op.getSelf(), op);
+    if (!producer)
+      return rewriter.notifyMatchFailure(
+          op, "lhs is not a convolution or linear op only used here");
+    double alpha = 1;
+    if constexpr (std::is_same_v<ArithOpTy, AtenAddTensorOp>) {
+      int64_t alphaInt;
+      if (matchPattern(op.getAlpha(), m_TorchConstantInt(&alphaInt)))
+        alpha = alphaInt;
+      else if (!matchPattern(op.getAlpha(), m_TorchConstantFloat(&alpha)))
+        return rewriter.notifyMatchFailure(op, "alpha must be a constant");
+    }
+    std::optional<unsigned> maybeRank = getTensorRank(producer.getResult());
+    DenseFPElementsAttr attr = getFloatLiteral(op.getOther());
+    if (!maybeRank || !attr)
+      return rewriter.notifyMatchFailure(
+          op, "expected a ranked lhs and a literal rhs");
+    FailureOr<LiteralWeights> weights = getLiteralWeights(producer);
+    if (failed(weights))
+      return rewriter.notifyMatchFailure(
+          op, "expected literal weight and bias");
+
+    // Align the rhs to the right of the result, and check that only its
+    // channel dim, if any, is not 1.
+    int64_t rank = *maybeRank;
+    ArrayRef<int64_t> shape = attr.getType().getShape();
+    if (static_cast<int64_t>(shape.size()) > rank)
+      return rewriter.notifyMatchFailure(op, "rhs must not broadcast the lhs");
+    int64_t channelDim =
+        getChannelDim<OpTy>(rank) - (rank - static_cast<int64_t>(shape.size()));
+    for (int64_t i = 0, e = shape.size(); i < e; i++) {
+      if (shape[i] != 1 &&
+          (i != channelDim || shape[i] != weights->numChannels))
+        return rewriter.notifyMatchFailure(
+            op, "rhs must only vary along the output channels");
+    }
+    SmallVector<double> values = getValues(attr);
+    SmallVector<double> channelValues(weights->numChannels, values.front());
+    if (values.size() != 1)
+      channelValues = values;
+
+    if constexpr (std::is_same_v<ArithOpTy, AtenMulTensorOp>) {
+      weights->scale(channelValues);
+    } else {
+      for (int64_t c = 0; c < weights->numChannels; c++)
+        weights->bias[c] += alpha * channelValues[c];
+    }
+    replaceWithFoldedOp(rewriter, producer, op, *weights);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+class FoldBatchNormIntoWeightsPass
+    : public FoldBatchNormIntoWeightsBase<FoldBatchNormIntoWeightsPass> {
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.add<FoldBatchNormIntoLiteralWeights<AtenConvolutionOp>,
+                 FoldBatchNormIntoLiteralWeights<AtenConv2dOp>,
+                 FoldBatchNormIntoLiteralWeights<AtenLinearOp>>(context);
+    patterns.add<
+        FoldChannelAffineIntoLiteralWeights<AtenConvolutionOp, AtenMulTensorOp>,
+        FoldChannelAffineIntoLiteralWeights<AtenConv2dOp, AtenMulTensorOp>,
+        FoldChannelAffineIntoLiteralWeights<AtenLinearOp, AtenMulTensorOp>,
+        FoldChannelAffineIntoLiteralWeights<AtenConvolutionOp, AtenAddTensorOp>,
+        FoldChannelAffineIntoLiteralWeights<AtenConv2dOp, AtenAddTensorOp>,
+        FoldChannelAffineIntoLiteralWeights<AtenLinearOp, AtenAddTensorOp>>(
+        context);
+    if (failed(applyPatternsAndFoldGreedily(getOperation(),
+                                            std::move(patterns))))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::Torch::createFoldBatchNormIntoWeightsPass() {
+  return std::make_unique<FoldBatchNormIntoWeightsPass>();
+}
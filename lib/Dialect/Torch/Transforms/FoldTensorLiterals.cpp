@@ -0,0 +1,499 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+#include "llvm/ADT/SmallBitVector.h"
+
+#include <cmath>
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+// Returns the value of `value` if it is a value tensor literal that is a splat
+// or has at most `maxElements` elements.
+static DenseElementsAttr getLiteral(Value value, int64_t maxElements) {
+  auto literal = value.getDefiningOp<ValueTensorLiteralOp>();
+  if (!literal)
+    return nullptr;
+  auto attr = literal.getValue().dyn_cast<DenseElementsAttr>();
+  if (!attr || (!attr.isSplat() && attr.getNumElements() > maxElements))
+    return nullptr;
+  return attr;
+}
+
+// Returns true if the result of `op` can be replaced by a literal of `type`.
+// The dims of unknown size in the result type match any size.
+static bool canReplaceWithLiteral(Operation *op, ShapedType type) {
+  auto resultType = op->getResult(0).getType().dyn_cast<ValueTensorType>();
+  if (!resultType)
+    return false;
+  if (resultType.hasDtype() && resultType.getDtype() != type.getElementType())
+    return false;
+  if (!resultType.hasSizes())
+    return true;
+  ArrayRef<int64_t> sizes = resultType.getSizes();
+  if (sizes.size() != type.getShape().size())
+    return false;
+  return llvm::all_of(llvm::zip(sizes, type.getShape()), [](auto pair) {
+    auto [size, literalSize] = pair;
+    return size == kUnknownSize || size == literalSize;
+  });
+}
+
+// Replaces `op` by a literal of `attr`, cast to the result type of `op`.
+static void replaceWithLiteral(PatternRewriter &rewriter, Operation *op,
+                               DenseElementsAttr attr) {
+  Value literal = rewriter.create<ValueTensorLiteralOp>(op->getLoc(), attr);
+  rewriter.replaceOp(op, adjustStaticInformation(
+                             rewriter, op->getLoc(), literal,
+                             op->getResult(0).getType(),
+                             /*userAllowsRefinement=*/false));
+}
+
+static double roundTo(double value, const llvm::fltSemantics &semantics) {
+  APFloat element(value);
+  bool losesInfo;
+  element.convert(semantics, APFloat::rmNearestTiesToEven, &losesInfo);
+  element.convert(APFloat::IEEEdouble(), APFloat::rmNearestTiesToEven,
+                  &losesInfo);
+  return element.convertToDouble();
+}
+
+static double toDouble(APFloat value) {
+  bool losesInfo;
+  value.convert(APFloat::IEEEdouble(), APFloat::rmNearestTiesToEven,
+                &losesInfo);
+  return value.convertToDouble();
+}
+
+// Returns the elements of `attr`, or its single element if it is a splat.
+static SmallVector<double> getValues(DenseFPElementsAttr attr) {
+  if (attr.isSplat())
+    return {toDouble(attr.getSplatValue<APFloat>())};
+  SmallVector<double> values;
+  values.reserve(attr.getNumElements());
+  for (APFloat value : attr.getValues<APFloat>())
+    values.push_back(toDouble(value));
+  return values;
+}
+
+// Returns the constant int or float `value` as a double.
+static FailureOr<double> getConstantNumber(Value value) {
+  int64_t intValue;
+  if (matchPattern(value, m_TorchConstantInt(&intValue)))
+    return static_cast<double>(intValue);
+  double floatValue;
+  if (matchPattern(value, m_TorchConstantFloat(&floatValue)))
+    return floatValue;
+  return failure();
+}
+
+// Computes `fn` elementwise over `operands`, broadcast together, in double
+// precision and rounds the results to their common element type. Returns
+// nullptr if they don't have the same element type or can't be broadcast.
+static DenseElementsAttr
+foldElementwise(ArrayRef<DenseFPElementsAttr> operands,
+                function_ref<double(ArrayRef<double>)> fn) {
+  auto elementType =
+      operands.front().getElementType().cast<mlir::FloatType>();
+  SmallVector<int64_t> shape;
+  for (DenseFPElementsAttr operand : operands) {
+    if (operand.getElementType() != elementType)
+      return nullptr;
+    ArrayRef<int64_t> operandShape = operand.getType().getShape();
+    if (operandShape.size() > shape.size())
+      shape.insert(shape.begin(), operandShape.size() - shape.size(), 1);
+    for (auto [resultSize, size] :
+         llvm::zip(llvm::reverse(shape), llvm::reverse(operandShape))) {
+      if (size != resultSize && size != 1 && resultSize != 1)
+        return nullptr;
+      resultSize = std::max(resultSize, size);
+    }
+  }
+  auto type = RankedTensorType::get(shape, elementType);
+  const llvm::fltSemantics &semantics = elementType.getFloatSemantics();
+  auto toAttribute = [&](double value) -> Attribute {
+    return FloatAttr::get(elementType, roundTo(value, semantics));
+  };
+
+  SmallVector<SmallVector<double>> values;
+  for (DenseFPElementsAttr operand : operands)
+    values.push_back(getValues(operand));
+  if (llvm::all_of(operands, [](auto operand) { return operand.isSplat(); })) {
+    SmallVector<double> args;
+    for (ArrayRef<double> operandValues : values)
+      args.push_back(operandValues.front());
+    return DenseElementsAttr::get(type, toAttribute(fn(args)));
+  }
+
+  // The strides of each operand in the result, which are 0 along the dims it
+  // is broadcast along.
+  int64_t rank = shape.size();
+  SmallVector<SmallVector<int64_t>> strides;
+  for (DenseFPElementsAttr operand : operands) {
+    ArrayRef<int64_t> operandShape = operand.getType().getShape();
+    SmallVector<int64_t> operandStrides(rank, 0);
+    int64_t stride = 1;
+    for (int64_t i = operandShape.size() - 1; i >= 0; --i) {
+      if (operandShape[i] != 1 && !operand.isSplat())
+        operandStrides[rank - operandShape.size() + i] = stride;
+      stride *= operandShape[i];
+    }
+    strides.push_back(std::move(operandStrides));
+  }
+  SmallVector<Attribute> results;
+  results.reserve(type.getNumElements());
+  SmallVector<int64_t> index(rank, 0);
+  SmallVector<double> args(operands.size());
+  for (int64_t i = 0, e = type.getNumElements(); i < e; ++i) {
+    for (size_t j = 0; j < operands.size(); ++j) {
+      int64_t offset = 0;
+      for (int64_t d = 0; d < rank; ++d)
+        offset += index[d] * strides[j][d];
+      args[j] = values[j][offset];
+    }
+    results.push_back(toAttribute(fn(args)));
+    for (int64_t d = rank - 1; d >= 0 && ++index[d] == shape[d]; --d)
+      index[d] = 0;
+  }
+  return DenseElementsAttr::get(type, results);
+}
+
+// Returns the tensor operands of the elementwise `op` and the function it
+// computes on their elements, which have the float semantics `semantics`.
+// Scalar operands are rounded to the element type first, as PyTorch does.
+template <typename OpTy>
+static LogicalResult
+getElementwiseFn(OpTy op, const llvm::fltSemantics &semantics,
+                 SmallVectorImpl<Value> &tensors,
+                 std::function<double(ArrayRef<double>)> &fn) {
+  tensors.push_back(op.getSelf());
+  if constexpr (std::is_same_v<OpTy, AtenNegOp>) {
+    fn = [](ArrayRef<double> x) { return -x[0]; };
+  } else if constexpr (std::is_same_v<OpTy, AtenReciprocalOp>) {
+    fn = [](ArrayRef<double> x) { return 1 / x[0]; };
+  } else if constexpr (std::is_same_v<OpTy, AtenSqrtOp>) {
+    fn = [](ArrayRef<double> x) { return std::sqrt(x[0]); };
+  } else if constexpr (std::is_same_v<OpTy, AtenRsqrtOp>) {
+    fn = [](ArrayRef<double> x) { return 1 / std::sqrt(x[0]); };
+  } else if constexpr (std::is_same_v<OpTy, AtenMulTensorOp>) {
+    tensors.push_back(op.getOther());
+    fn = [](ArrayRef<double> x) { return x[0] * x[1]; };
+  } else if constexpr (std::is_same_v<OpTy, AtenDivTensorOp>) {
+    tensors.push_back(op.getOther());
+    fn = [](ArrayRef<double> x) { return x[0] / x[1]; };
+  } else if constexpr (std::is_same_v<OpTy, AtenAddTensorOp> ||
+                       std::is_same_v<OpTy, AtenSubTensorOp>) {
+    FailureOr<double> alpha = getConstantNumber(op.getAlpha());
+    if (failed(alpha))
+      return failure();
+    double sign = std::is_same_v<OpTy, AtenAddTensorOp> ? 1 : -1;
+    double scale = sign * roundTo(*alpha, semantics);
+    tensors.push_back(op.getOther());
+    fn = [scale](ArrayRef<double> x) { return x[0] + scale * x[1]; };
+  } else {
+    FailureOr<double> other = getConstantNumber(op.getOther());
+    if (failed(other))
+      return failure();
+    double value = roundTo(*other, semantics);
+    if constexpr (std::is_same_v<OpTy, AtenMulScalarOp>) {
+      fn = [value](ArrayRef<double> x) { return x[0] * value; };
+    } else if constexpr (std::is_same_v<OpTy, AtenDivScalarOp>) {
+      fn = [value](ArrayRef<double> x) { return x[0] / value; };
+    } else {
+      FailureOr<double> alpha = getConstantNumber(op.getAlpha());
+      if (failed(alpha))
+        return failure();
+      double sign = std::is_same_v<OpTy, AtenAddScalarOp> ? 1 : -1;
+      double offset = sign * roundTo(*alpha, semantics) * value;
+      fn = [offset](ArrayRef<double> x) { return x[0] + offset; };
+    }
+  }
+  return success();
+}
+
+namespace {
+// Folds an elementwise arithmetic op whose tensor operands are float literals
+// of the same dtype into a literal.
+template <typename OpTy>
+class FoldElementwiseOfLiterals : public OpRewritePattern<OpTy> {
+public:
+  FoldElementwiseOfLiterals(MLIRContext *context, int64_t maxElements)
+      : OpRewritePattern<OpTy>(context), maxElements(maxElements) {}
+  LogicalResult matchAndRewrite(OpTy op,
+                                PatternRewriter &rewriter) const override {
+    auto self = getLiteral(op.getSelf(), maxElements)
+                    .template dyn_cast_or_null<DenseFPElementsAttr>();
+    if (!self)
+      return rewriter.notifyMatchFailure(op, "self is not a float literal");
+    SmallVector<Value> tensors;
+    std::function<double(ArrayRef<double>)> fn;
+    auto elementType = self.getElementType().cast<mlir::FloatType>();
+    if (failed(getElementwiseFn(op, elementType.getFloatSemantics(), tensors,
+                                fn)))
+      return rewriter.notifyMatchFailure(op, "non-constant scalar operand");
+    SmallVector<DenseFPElementsAttr> literals;
+    for (Value tensor : tensors) {
+      auto literal = getLiteral(tensor, maxElements)
+                         .template dyn_cast_or_null<DenseFPElementsAttr>();
+      if (!literal)
+        return rewriter.notifyMatchFailure(op, "operand is not a literal");
+      literals.push_back(literal);
+    }
+    DenseElementsAttr result = foldElementwise(literals, fn);
+    if (!result || (!result.isSplat() && result.getNumElements() > maxElements))
+      return rewriter.notifyMatchFailure(
+          op, "operands have different dtypes, don't broadcast, or the "
+              "result is too large");
+    if (!canReplaceWithLiteral(op, result.getType()))
+      return rewriter.notifyMatchFailure(op, "incompatible result type");
+    replaceWithLiteral(rewriter, op, result);
+    return success();
+  }
+
+private:
+  int64_t maxElements;
+};
+} // namespace
+
+// Returns the permutation of the dims of `self` that `op` computes, where
+// dim `i` of the result is dim `permutation[i]` of `self`.
+template <typename OpTy>
+static LogicalResult getPermutation(OpTy op, int64_t rank,
+                                    SmallVectorImpl<int64_t> &permutation) {
+  for (int64_t i = 0; i < rank; ++i)
+    permutation.push_back(i);
+  if constexpr (std::is_same_v<OpTy, AtenTOp>) {
+    if (rank == 2)
+      std::swap(permutation[0], permutation[1]);
+    return success(rank <= 2);
+  } else if constexpr (std::is_same_v<OpTy, AtenTransposeIntOp>) {
+    int64_t dim0, dim1;
+    if (!matchPattern(op.getDim0(), m_TorchConstantInt(&dim0)) ||
+        !matchPattern(op.getDim1(), m_TorchConstantInt(&dim1)))
+      return failure();
+    dim0 = toPositiveDim(dim0, rank);
+    dim1 = toPositiveDim(dim1, rank);
+    if (!isValidDim(dim0, rank) || !isValidDim(dim1, rank))
+      return failure();
+    std::swap(permutation[dim0], permutation[dim1]);
+    return success();
+  } else {
+    SmallVector<int64_t> dims;
+    if (!matchPattern(op.getDims(), m_TorchListOfConstantInts(dims)) ||
+        static_cast<int64_t>(dims.size()) != rank)
+      return failure();
+    llvm::SmallBitVector seen(rank);
+    for (int64_t i = 0; i < rank; ++i) {
+      int64_t dim = toPositiveDim(dims[i], rank);
+      if (!isValidDim(dim, rank) || seen.test(dim))
+        return failure();
+      seen.set(dim);
+      permutation[i] = dim;
+    }
+    return success();
+  }
+}
+
+namespace {
+// Folds a transpose or permutation of a literal into a literal.
+template <typename OpTy>
+class FoldPermutationOfLiteral : public OpRewritePattern<OpTy> {
+public:
+  FoldPermutationOfLiteral(MLIRContext *context, int64_t maxElements)
+      : OpRewritePattern<OpTy>(context), maxElements(maxElements) {}
+  LogicalResult matchAndRewrite(OpTy op,
+                                PatternRewriter &rewriter) const override {
+    DenseElementsAttr self = getLiteral(op.getSelf(), maxElements);
+    if (!self)
+      return rewriter.notifyMatchFailure(op, "self is not a literal");
+    ArrayRef<int64_t> shape = self.getType().getShape();
+    int64_t rank = shape.size();
+    SmallVector<int64_t> permutation;
+    if (failed(getPermutation(op, rank, permutation)))
+      return rewriter.notifyMatchFailure(op, "unsupported permutation");
+    SmallVector<int64_t> resultShape;
+    for (int64_t dim : permutation)
+      resultShape.push_back(shape[dim]);
+    auto type = RankedTensorType::get(resultShape, self.getElementType());
+    if (!canReplaceWithLiteral(op, type))
+      return rewriter.notifyMatchFailure(op, "incompatible result type");
+    if (self.isSplat()) {
+      replaceWithLiteral(rewriter, op, self.resizeSplat(type));
+      return success();
+    }
+
+    // The stride in `self` of each dim of the result.
+    SmallVector<int64_t> strides(rank);
+    int64_t stride = 1;
+    for (int64_t i = rank - 1; i >= 0; --i) {
+      strides[i] = stride;
+      stride *= shape[i];
+    }
+    SmallVector<int64_t> resultStrides;
+    for (int64_t dim : permutation)
+      resultStrides.push_back(strides[dim]);
+    auto values = llvm::to_vector(self.getValues<Attribute>());
+    SmallVector<Attribute> results;
+    results.reserve(values.size());
+    SmallVector<int64_t> index(rank, 0);
+    for (size_t i = 0, e = values.size(); i < e; ++i) {
+      int64_t offset = 0;
+      for (int64_t d = 0; d < rank; ++d)
+        offset += index[d] * resultStrides[d];
+      results.push_back(values[offset]);
+      for (int64_t d = rank - 1; d >= 0 && ++index[d] == resultShape[d]; --d)
+        index[d] = 0;
+    }
+    replaceWithLiteral(rewriter, op, DenseElementsAttr::get(type, results));
+    return success();
+  }
+
+private:
+  int64_t maxElements;
+};
+} // namespace
+
+namespace {
+// Folds a view or reshape of a literal to constant sizes into a literal.
+template <typename OpTy>
+class FoldReshapeOfLiteral : public OpRewritePattern<OpTy> {
+public:
+  FoldReshapeOfLiteral(MLIRContext *context, int64_t maxElements)
+      : OpRewritePattern<OpTy>(context), maxElements(maxElements) {}
+  LogicalResult matchAndRewrite(OpTy op,
+                                PatternRewriter &rewriter) const override {
+    DenseElementsAttr self = getLiteral(op.getSelf(), maxElements);
+    SmallVector<int64_t> sizes;
+    Value sizesList;
+    if constexpr (std::is_same_v<OpTy, AtenReshapeOp>)
+      sizesList = op.getShape();
+    else
+      sizesList = op.getSize();
+    if (!self || !matchPattern(sizesList, m_TorchListOfConstantInts(sizes)))
+      return rewriter.notifyMatchFailure(
+          op, "expected a literal reshaped to constant sizes");
+    // Infer the size of at most one `-1` dim.
+    int64_t numElements = self.getNumElements();
+    int64_t knownElements = 1;
+    int64_t inferredDim = -1;
+    for (auto [i, size] : llvm::enumerate(sizes)) {
+      if (size == -1 && inferredDim == -1) {
+        inferredDim = i;
+        continue;
+      }
+      if (size < 0)
+        return rewriter.notifyMatchFailure(op, "invalid sizes");
+      knownElements *= size;
+    }
+    if (inferredDim != -1 && knownElements != 0)
+      sizes[inferredDim] = numElements / knownElements;
+    if (inferredDim != -1 ? knownElements * sizes[inferredDim] != numElements
+                          : knownElements != numElements)
+      return rewriter.notifyMatchFailure(op, "sizes don't match the literal");
+    auto type = RankedTensorType::get(sizes, self.getElementType());
+    if (!canReplaceWithLiteral(op, type))
+      return rewriter.notifyMatchFailure(op, "incompatible result type");
+    replaceWithLiteral(rewriter, op, self.reshape(type));
+    return success();
+  }
+
+private:
+  int64_t maxElements;
+};
+} // namespace
+
+namespace {
+// Folds the conversion of a float literal to another float dtype into a
+// literal.
+class FoldDtypeConversionOfLiteral : public OpRewritePattern<AtenToDtypeOp> {
+public:
+  FoldDtypeConversionOfLiteral(MLIRContext *context, int64_t maxElements)
+      : OpRewritePattern<AtenToDtypeOp>(context), maxElements(maxElements) {}
+  LogicalResult matchAndRewrite(AtenToDtypeOp op,
+                                PatternRewriter &rewriter) const override {
+    auto self = getLiteral(op.getSelf(), maxElements)
+                    .dyn_cast_or_null<DenseFPElementsAttr>();
+    int64_t dtypeInt;
+    if (!self || !matchPattern(op.getDtype(), m_TorchConstantInt(&dtypeInt)) ||
+        !op.getMemoryFormat().getType().isa<Torch::NoneType>())
+      return rewriter.notifyMatchFailure(
+          op, "expected a float literal converted to a constant dtype");
+    FailureOr<Type> dtype = getTypeForScalarType(
+        op.getContext(), static_cast<torch_upstream::ScalarType>(dtypeInt));
+    if (failed(dtype) || !dtype->isa<mlir::FloatType>())
+      return rewriter.notifyMatchFailure(op, "expected a float dtype");
+    const llvm::fltSemantics &semantics =
+        dtype->cast<mlir::FloatType>().getFloatSemantics();
+    auto type = RankedTensorType::get(self.getType().getShape(), *dtype);
+    if (!canReplaceWithLiteral(op, type))
+      return rewriter.notifyMatchFailure(op, "incompatible result type");
+    DenseElementsAttr result = self.mapValues(*dtype, [&](const APFloat &x) {
+      APFloat value = x;
+      bool losesInfo;
+      value.convert(semantics, APFloat::rmNearestTiesToEven, &losesInfo);
+      return value.bitcastToAPInt();
+    });
+    replaceWithLiteral(rewriter, op, result);
+    return success();
+  }
+
+private:
+  int64_t maxElements;
+};
+} // namespace
+
+namespace {
+class FoldTensorLiteralsPass
+    : public FoldTensorLiteralsBase<FoldTensorLiteralsPass> {
+public:
+  FoldTensorLiteralsPass() = default;
+  FoldTensorLiteralsPass(int64_t maxElements) {
+    this->maxElements = maxElements;
+  }
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.add<FoldElementwiseOfLiterals<AtenNegOp>,
+                 FoldElementwiseOfLiterals<AtenReciprocalOp>,
+                 FoldElementwiseOfLiterals<AtenSqrtOp>,
+                 FoldElementwiseOfLiterals<AtenRsqrtOp>,
+                 FoldElementwiseOfLiterals<AtenAddTensorOp>,
+                 FoldElementwiseOfLiterals<AtenSubTensorOp>,
+                 FoldElementwiseOfLiterals<AtenMulTensorOp>,
+                 FoldElementwiseOfLiterals<AtenDivTensorOp>,
+                 FoldElementwiseOfLiterals<AtenAddScalarOp>,
+                 FoldElementwiseOfLiterals<AtenSubScalarOp>,
+                 FoldElementwiseOfLiterals<AtenMulScalarOp>,
+                 FoldElementwiseOfLiterals<AtenDivScalarOp>>(context,
+                                                              maxElements);
+    patterns.add<FoldPermutationOfLiteral<AtenTOp>,
+                 FoldPermutationOfLiteral<AtenTransposeIntOp>,
+                 FoldPermutationOfLiteral<AtenPermuteOp>,
+                 FoldReshapeOfLiteral<AtenViewOp>,
+                 FoldReshapeOfLiteral<AtenReshapeOp>,
+                 FoldDtypeConversionOfLiteral>(context, maxElements);
+    if (failed(applyPatternsAndFoldGreedily(getOperation(),
+                                            std::move(patterns))))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::Torch::createFoldTensorLiteralsPass(int64_t maxElements) {
+  return std::make_unique<FoldTensorLiteralsPass>(maxElements);
+}
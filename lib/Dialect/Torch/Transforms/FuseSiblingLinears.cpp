@@ -0,0 +1,270 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SetVector.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+namespace {
+// An `aten.linear`, `aten.matmul` or `aten.mm` with a literal weight, which
+// can be fused with the ops of the same kind on the same input.
+struct SiblingOp {
+  Operation *op;
+  ValueTensorType resultType;
+  // [N, K] for a linear op, [K, N] for a matmul.
+  DenseElementsAttr weight;
+  // The [N] bias of a linear op, or null if it has none.
+  DenseElementsAttr bias;
+  // The number of output features, N.
+  int64_t numFeatures;
+};
+} // namespace
+
+static bool isLinear(Operation *op) { return isa<AtenLinearOp>(op); }
+
+// Returns whether the elements of `attr` take whole bytes, so that it can be
+// concatenated byte-wise.
+static bool hasByteSizedElements(DenseElementsAttr attr) {
+  Type elementType = attr.getElementType();
+  return elementType.isIntOrFloat() &&
+         elementType.getIntOrFloatBitWidth() % 8 == 0;
+}
+
+static std::optional<SiblingOp> matchSiblingOp(Operation *op) {
+  Value weight = op->getOperand(1);
+  auto literal = weight.getDefiningOp<ValueTensorLiteralOp>();
+  auto weightAttr =
+      literal ? literal.getValue().dyn_cast<DenseElementsAttr>() : nullptr;
+  auto resultType = op->getResult(0).getType().dyn_cast<ValueTensorType>();
+  if (!weightAttr || !hasByteSizedElements(weightAttr) ||
+      weightAttr.getType().getRank() != 2 || !resultType ||
+      !resultType.hasSizes() || !resultType.hasDtype() ||
+      resultType.getSizes().empty())
+    return std::nullopt;
+
+  SiblingOp sibling;
+  sibling.op = op;
+  sibling.resultType = resultType;
+  sibling.weight = weightAttr;
+  sibling.numFeatures = weightAttr.getType().getDimSize(isLinear(op) ? 0 : 1);
+  if (resultType.getSizes().back() != sibling.numFeatures)
+    return std::nullopt;
+  if (auto linear = dyn_cast<AtenLinearOp>(op)) {
+    if (!linear.getBias().getType().isa<Torch::NoneType>()) {
+      auto biasLiteral = linear.getBias().getDefiningOp<ValueTensorLiteralOp>();
+      sibling.bias = biasLiteral
+                         ? biasLiteral.getValue().dyn_cast<DenseElementsAttr>()
+                         : nullptr;
+      if (!sibling.bias || sibling.bias.getType().getRank() != 1 ||
+          sibling.bias.getElementType() != weightAttr.getElementType())
+        return std::nullopt;
+    }
+  }
+  return sibling;
+}
+
+// Returns whether `a` and `b` can be computed by a single op, whose weight is
+// the concatenation of theirs along N and whose result is the concatenation
+// of theirs along the last dim.
+static bool areFusable(const SiblingOp &a, const SiblingOp &b) {
+  int64_t reductionDim = isLinear(a.op) ? 1 : 0;
+  if (a.weight.getElementType() != b.weight.getElementType() ||
+      a.weight.getType().getDimSize(reductionDim) !=
+          b.weight.getType().getDimSize(reductionDim) ||
+      a.resultType.getDtype() != b.resultType.getDtype())
+    return false;
+  return a.resultType.getSizes().drop_back() ==
+         b.resultType.getSizes().drop_back();
+}
+
+// Returns the row-major bytes of `attr`, with splats expanded.
+static SmallVector<char> getExpandedRawData(DenseElementsAttr attr) {
+  ArrayRef<char> raw = attr.getRawData();
+  if (!attr.isSplat())
+    return SmallVector<char>(raw.begin(), raw.end());
+  SmallVector<char> data;
+  data.reserve(raw.size() * attr.getNumElements());
+  for (int64_t i = 0, e = attr.getNumElements(); i < e; i++)
+    data.append(raw.begin(), raw.end());
+  return data;
+}
+
+// Concatenates the weights of `siblings` along N. The rows of the [N, K]
+// weights of linear ops are contiguous, but the [K, N] weights of matmuls
+// are interleaved row by row.
+static DenseElementsAttr concatenateWeights(ArrayRef<SiblingOp> siblings,
+                                            int64_t numFeatures) {
+  DenseElementsAttr first = siblings.front().weight;
+  Type elementType = first.getElementType();
+  int64_t elementBytes = elementType.getIntOrFloatBitWidth() / 8;
+  bool linear = isLinear(siblings.front().op);
+  int64_t numReductions = first.getType().getDimSize(linear ? 1 : 0);
+
+  SmallVector<SmallVector<char>> weights;
+  for (const SiblingOp &sibling : siblings)
+    weights.push_back(getExpandedRawData(sibling.weight));
+  SmallVector<char> data;
+  data.reserve(numFeatures * numReductions * elementBytes);
+  if (linear) {
+    for (ArrayRef<char> weight : weights)
+      data.append(weight.begin(), weight.end());
+  } else {
+    for (int64_t k = 0; k < numReductions; k++) {
+      for (auto [sibling, weight] : llvm::zip(siblings, weights)) {
+        int64_t rowBytes = sibling.numFeatures * elementBytes;
+        ArrayRef<char> row = ArrayRef(weight).slice(k * rowBytes, rowBytes);
+        data.append(row.begin(), row.end());
+      }
+    }
+  }
+  SmallVector<int64_t> shape{numFeatures, numReductions};
+  if (!linear)
+    std::swap(shape[0], shape[1]);
+  return DenseElementsAttr::getFromRawBuffer(
+      RankedTensorType::get(shape, elementType), data);
+}
+
+// Concatenates the biases of the linear ops `siblings`, with zeros for the
+// ops without one, or returns null if none has a bias.
+static DenseElementsAttr concatenateBiases(ArrayRef<SiblingOp> siblings,
+                                           int64_t numFeatures) {
+  if (llvm::none_of(siblings,
+                    [](const SiblingOp &sibling) { return sibling.bias; }))
+    return nullptr;
+  Type elementType = siblings.front().weight.getElementType();
+  int64_t elementBytes = elementType.getIntOrFloatBitWidth() / 8;
+  SmallVector<char> data;
+  data.reserve(numFeatures * elementBytes);
+  for (const SiblingOp &sibling : siblings) {
+    if (!sibling.bias) {
+      // Zero is all zero bits for the integer and floating point types.
+      data.append(sibling.numFeatures * elementBytes, 0);
+      continue;
+    }
+    SmallVector<char> bias = getExpandedRawData(sibling.bias);
+    data.append(bias.begin(), bias.end());
+  }
+  return DenseElementsAttr::getFromRawBuffer(
+      RankedTensorType::get({numFeatures}, elementType), data);
+}
+
+// Replaces `siblings`, in program order, by a single op of the same kind on
+// their concatenated weights, placed before the first of them, whose result is
+// sliced along the last dim into the results of each.
+static void fuseSiblings(OpBuilder &b, ArrayRef<SiblingOp> siblings) {
+  Operation *first = siblings.front().op;
+  int64_t numFeatures = 0;
+  for (const SiblingOp &sibling : siblings)
+    numFeatures += sibling.numFeatures;
+
+  Location loc = first->getLoc();
+  b.setInsertionPoint(first);
+  Value input = first->getOperand(0);
+  Value weight = b.create<ValueTensorLiteralOp>(
+      loc, concatenateWeights(siblings, numFeatures));
+  ValueTensorType firstType = siblings.front().resultType;
+  SmallVector<int64_t> sizes(firstType.getSizes());
+  sizes.back() = numFeatures;
+  auto resultType =
+      ValueTensorType::get(b.getContext(), sizes, firstType.getDtype());
+  Value fused;
+  if (isa<AtenLinearOp>(first)) {
+    Value bias;
+    if (DenseElementsAttr biasAttr = concatenateBiases(siblings, numFeatures))
+      bias = b.create<ValueTensorLiteralOp>(loc, biasAttr);
+    else
+      bias = b.create<ConstantNoneOp>(loc);
+    fused = b.create<AtenLinearOp>(loc, resultType, input, weight, bias);
+  } else if (isa<AtenMatmulOp>(first)) {
+    fused = b.create<AtenMatmulOp>(loc, resultType, input, weight);
+  } else {
+    fused = b.create<AtenMmOp>(loc, resultType, input, weight);
+  }
+
+  Value dim = b.create<ConstantIntOp>(
+      loc, b.getI64IntegerAttr(firstType.getSizes().size() - 1));
+  Value step = b.create<ConstantIntOp>(loc, b.getI64IntegerAttr(1));
+  int64_t offset = 0;
+  for (const SiblingOp &sibling : siblings) {
+    Value start = b.create<ConstantIntOp>(loc, b.getI64IntegerAttr(offset));
+    offset += sibling.numFeatures;
+    Value end = b.create<ConstantIntOp>(loc, b.getI64IntegerAttr(offset));
+    Value slice = b.create<AtenSliceTensorOp>(
+        sibling.op->getLoc(), sibling.resultType, fused, dim, start, end, step);
+    sibling.op->getResult(0).replaceAllUsesWith(slice);
+  }
+}
+
+namespace {
+class FuseSiblingLinearsPass
+    : public FuseSiblingLinearsBase<FuseSiblingLinearsPass> {
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+
+    // The ops are grouped by input, kind and block, in program order.
+    using GroupKey = std::tuple<Value, OperationName, Block *>;
+    llvm::MapVector<GroupKey, SmallVector<SiblingOp>> groups;
+    func.walk([&](Operation *op) {
+      if (!isa<AtenLinearOp, AtenMatmulOp, AtenMmOp>(op))
+        return;
+      if (std::optional<SiblingOp> sibling = matchSiblingOp(op)) {
+        GroupKey key{op->getOperand(0), op->getName(), op->getBlock()};
+        groups[key].push_back(*sibling);
+      }
+    });
+
+    OpBuilder b(func.getContext());
+    llvm::SetVector<Operation *> weights;
+    for (auto &[key, candidates] : groups) {
+      // Fuse the ops compatible with the first of the remaining ones, until
+      // fewer than two are left.
+      while (candidates.size() >= 2) {
+        SmallVector<SiblingOp> fusable, rest;
+        for (const SiblingOp &candidate : candidates) {
+          if (areFusable(candidates.front(), candidate))
+            fusable.push_back(candidate);
+          else
+            rest.push_back(candidate);
+        }
+        if (fusable.size() >= 2) {
+          fuseSiblings(b, fusable);
+          for (const SiblingOp &sibling : fusable) {
+            for (Value operand : sibling.op->getOperands().drop_front()) {
+              if (Operation *producer = operand.getDefiningOp())
+                weights.insert(producer);
+            }
+            sibling.op->erase();
+          }
+          numFusedOps += fusable.size();
+        }
+        candidates = std::move(rest);
+      }
+    }
+    // The original weights and biases are usually only used by the fused ops.
+    for (Operation *weight : weights) {
+      if (isa<ValueTensorLiteralOp>(weight) && weight->use_empty())
+        weight->erase();
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::Torch::createFuseSiblingLinearsPass() {
+  return std::make_unique<FuseSiblingLinearsPass>();
+}
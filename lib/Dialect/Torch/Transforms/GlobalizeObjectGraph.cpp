@@ -100,28 +100,25 @@ public:
 
 private:
   LogicalResult collectUsedSlots() {
-    // Collect all the slots in each module.
-    // moduleClassNameToSlots tracks, for each class, for each attribute, the
-    // set of slot instances that belong to that attribute. E.g. if there are
-    // two instances of a class "Foo" with an attribute "a", then there will be
-    // two SlotOps in the inner vector of moduleClassNameToSlots["Foo"]["a"].
-    // This is not precise -- in the code below it effectively results in the
-    // conservative assumption that all instances of a class might reach all
-    // GetAttr ops on that type.
-    llvm::StringMap<llvm::StringMap<std::vector<SlotOp>>>
-        moduleClassNameToSlots;
+    // Collect the names of the slots of each class.
+    // The slots are tracked per class and not per instance: all the instances
+    // of a class share the GetAttr ops of its methods, so this conservatively
+    // assumes that all instances of a class might reach all GetAttr ops on
+    // that type. With many instances of a class, such as the layers of a
+    // transformer, this also keeps the cost of each GetAttr op independent of
+    // the number of instances.
+    llvm::StringMap<llvm::StringSet<>> classNameToSlotNames;
     symbolTable.getOp()->walk([&](NnModuleOp moduleOp) {
-      llvm::StringMap<SlotOp> nameToSlot;
-      auto &slotNameToSlots = moduleClassNameToSlots[moduleOp.getClassName()];
+      auto &slotNames = classNameToSlotNames[moduleOp.getClassName()];
       for (auto slotOp : moduleOp.getOps<SlotOp>())
-        slotNameToSlots[slotOp.getName()].push_back(slotOp);
+        slotNames.insert(slotOp.getName());
     });
 
     // Find all the module slots that are accessed through `PrimGetAttrOp` or
     // `PrimSetAttrOp`.
-    symbolTable.getOp()->walk([&](Operation *op) {
+    auto walkResult = symbolTable.getOp()->walk([&](Operation *op) {
       if (!isa<PrimGetAttrOp, PrimSetAttrOp>(op))
-        return;
+        return WalkResult::advance();
 
       Value module;
       StringRef slotName;
@@ -133,24 +130,37 @@ private:
         module = setAttrOp.getReceiver();
         slotName = setAttrOp.getName();
       }
+      bool isWrite = isa<PrimSetAttrOp>(op);
 
       auto moduleType = module.getType().cast<NnModuleType>();
-      auto slots = moduleClassNameToSlots.find(moduleType.getClassName());
+      auto slots = classNameToSlotNames.find(moduleType.getClassName());
       // TODO: Improve verifier so that this can never happen
-      if (slots == moduleClassNameToSlots.end())
+      if (slots == classNameToSlotNames.end()) {
         op->emitError() << "Reference to non-existing module type "
                         << moduleType.getClassName();
+        return WalkResult::interrupt();
+      }
 
-      auto &slotNameToSlots = slots->getValue();
-      auto slotIt = slotNameToSlots.find(slotName);
       // TODO: Improve verifier so that this can never happen
-      if (slotIt == slotNameToSlots.end())
+      if (!slots->getValue().contains(slotName)) {
         op->emitError() << "Reference to non-existing module slot " << slotName
                         << "in " << moduleType.getClassName();
-      for (SlotOp slotOp : slotIt->getValue())
-        usedSlots.insert(slotOp);
+        return WalkResult::interrupt();
+      }
+      usedSlots[moduleType.getClassName()].insert(slotName);
+      if (isWrite)
+        writtenSlots[moduleType.getClassName()].insert(slotName);
+      return WalkResult::advance();
     });
-    return success();
+    return success(!walkResult.wasInterrupted());
+  }
+
+  // Returns true if `slot` of `nnModule` is in `slots`, one of usedSlots or
+  // writtenSlots.
+  static bool isSlotIn(const llvm::StringMap<llvm::StringSet<>> &slots,
+                       NnModuleOp nnModule, SlotOp slot) {
+    auto it = slots.find(nnModule.getClassName());
+    return it != slots.end() && it->getValue().contains(slot.getName());
   }
 
   LogicalResult recursivelyTraverse(NnModuleOp nnModule) {
@@ -173,9 +183,25 @@ private:
         if (failed(
                 recursivelyTraverse(slot.getValue().getDefiningOp<NnModuleOp>())))
           return failure();
-      } else if (usedSlots.find(slot) != usedSlots.end()) {
+      } else if (isSlotIn(usedSlots, nnModule, slot)) {
         // Only create the GlobalSlotOp if the slot is used at all.
         std::string linkageName = llvm::join(nameStack, ".");
+        // A tensor held by several private slots that are never written, such
+        // as a weight tied between two submodules, gets a single GlobalSlotOp
+        // so that the sharing is preserved.
+        bool isShareable = attr.getIsPrivate() &&
+                           attr.getType().isa<BaseTensorType>() &&
+                           !isSlotIn(writtenSlots, nnModule, slot);
+        if (isShareable) {
+          auto it = sharedTensorGlobalSlots.find(slot.getValue());
+          if (it != sharedTensorGlobalSlots.end() &&
+              it->second.getTypeBound() == attr.getType()) {
+            slotToGlobalSlot[slot] = it->second;
+            slotLinkageInfo[slot] = LinkageInfo{linkageName, true};
+            nameStack.pop_back();
+            continue;
+          }
+        }
         auto globalSlot = globalSlotBuilder.create<GlobalSlotOp>(
             slot.getLoc(), linkageName,
             /*sym_visibility=*/nullptr, attr.getType());
@@ -185,6 +211,8 @@ private:
         slotToGlobalSlot[slot] = globalSlot;
         slotLinkageInfo[slot] = LinkageInfo{linkageName, attr.getIsPrivate()};
         globalSlotInitialValues[globalSlot.getSymNameAttr()] = slot.getValue();
+        if (isShareable)
+          sharedTensorGlobalSlots.insert({slot.getValue(), globalSlot});
       }
       nameStack.pop_back();
     }
@@ -224,8 +252,14 @@ private:
   // This is a MapVector to keep the order deterministic.
   llvm::MapVector<StringAttr, Value> globalSlotInitialValues;
   // Used to keep track of all the used torch slots so that the restrictions can
-  // be applied to those slots only.
-  DenseSet<SlotOp> usedSlots;
+  // be applied to those slots only. These are the names of the slots used in
+  // each class, see collectUsedSlots.
+  llvm::StringMap<llvm::StringSet<>> usedSlots;
+  // The used slots that are written through `PrimSetAttrOp`.
+  llvm::StringMap<llvm::StringSet<>> writtenSlots;
+  // The GlobalSlotOp shared by the private, never written slots holding each
+  // tensor.
+  DenseMap<Value, GlobalSlotOp> sharedTensorGlobalSlots;
 };
 } // namespace
 
@@ -322,6 +356,27 @@ template <> struct llvm::DenseMapInfo<Monomorphization> {
   }
 };
 
+namespace {
+// Index of the slots of each instance by name, built the first time the
+// instance is looked up, so that resolving a `PrimGetAttrOp` or
+// `PrimSetAttrOp` doesn't scan all the slots of the instance.
+class SlotIndex {
+public:
+  SlotOp lookup(NnModuleOp instance, StringRef name) {
+    auto it = slotsByName.find(instance);
+    if (it == slotsByName.end()) {
+      it = slotsByName.try_emplace(instance).first;
+      for (auto slot : instance.getOps<SlotOp>())
+        it->second.try_emplace(slot.getName(), slot);
+    }
+    return it->second.lookup(name);
+  }
+
+private:
+  DenseMap<NnModuleOp, llvm::StringMap<SlotOp>> slotsByName;
+};
+} // namespace
+
 // Populate `mapping` such that values of NnModuleType in the function are
 // mapped to appropriate global objects of NnModuleType.
 //
@@ -329,7 +384,8 @@ template <> struct llvm::DenseMapInfo<Monomorphization> {
 // currently only analyzes a subset of ops.
 static LogicalResult analyzeInstances(func::FuncOp func,
                                       ArrayRef<ArgInstance> argInstances,
-                                      IRMapping &mapping) {
+                                      IRMapping &mapping,
+                                      SlotIndex &slotIndex) {
   for (auto &argInstance : argInstances)
     mapping.map(func.getArgument(argInstance.argIndex), argInstance.instance);
   auto walkResult = func.walk([&](PrimGetAttrOp op) {
@@ -337,12 +393,9 @@ static LogicalResult analyzeInstances(func::FuncOp func,
       return WalkResult::advance();
     auto instance = mapping.lookupOrNull(op.getReceiver());
     assert(instance && "verifyFuncConformsToSubset should ensure this");
-    for (auto slot : instance.getDefiningOp<NnModuleOp>().getOps<SlotOp>()) {
-      if (slot.getName() == op.getName()) {
-        mapping.map(op, slot.getValue());
-        break;
-      }
-    }
+    if (SlotOp slot = slotIndex.lookup(instance.getDefiningOp<NnModuleOp>(),
+                                       op.getName()))
+      mapping.map(op, slot.getValue());
     return WalkResult::advance();
   });
   return success(!walkResult.wasInterrupted());
@@ -368,8 +421,8 @@ createMonomorphizationForCall(func::CallOp op, IRMapping &mapping,
 namespace {
 class MonomorphizationTracker {
 public:
-  MonomorphizationTracker(ModuleOp module)
-      : module(module), symbolTable(module) {}
+  MonomorphizationTracker(ModuleOp module, SlotIndex &slotIndex)
+      : module(module), symbolTable(module), slotIndex(slotIndex) {}
   LogicalResult
   initialize(DenseMap<ClassTypeOp, std::vector<NnModuleOp>> &instances) {
     for (auto func : module.getOps<func::FuncOp>()) {
@@ -411,7 +464,7 @@ private:
   LogicalResult generateNewMonomorphizations(const Monomorphization &m) {
     auto func = m.func;
     IRMapping mapping;
-    if (failed(analyzeInstances(func, m.argInstances, mapping)))
+    if (failed(analyzeInstances(func, m.argInstances, mapping, slotIndex)))
       return failure();
     auto walkResult = func.walk([&](func::CallOp op) {
       FailureOr<Monomorphization> maybeMonomorphization =
@@ -427,6 +480,7 @@ private:
 
   ModuleOp module;
   SymbolTable symbolTable;
+  SlotIndex &slotIndex;
   SmallVector<Monomorphization> dirtyMonomorphizations;
   llvm::SetVector<Monomorphization> monomorphizations;
 };
@@ -497,16 +551,12 @@ verifyPublicMonomorphizations(ModuleOp module, SymbolTable &symbolTable,
 static LogicalResult rewriteMonomorphizedFuncClone(
     func::FuncOp func, IRMapping mapping, SymbolTable &symbolTable,
     DenseMap<Monomorphization, func::FuncOp> &newFuncs,
-    ObjectGraphInfo &objectGraphInfo) {
+    ObjectGraphInfo &objectGraphInfo, SlotIndex &slotIndex) {
 
   SmallVector<Operation *> toErase;
   auto handlePrimSetAttr = [&](PrimSetAttrOp op) {
     auto instance = mapping.lookup(op.getReceiver()).getDefiningOp<NnModuleOp>();
-    SlotOp affectedSlot;
-    for (auto slot : instance.getOps<SlotOp>()) {
-      if (slot.getName() == op.getName())
-        affectedSlot = slot;
-    }
+    SlotOp affectedSlot = slotIndex.lookup(instance, op.getName());
     OpBuilder(op).create<GlobalSlotSetOp>(
         op.getLoc(), objectGraphInfo.getGlobalSlotFor(affectedSlot).getSymName(),
         op.getValue());
@@ -516,11 +566,7 @@ static LogicalResult rewriteMonomorphizedFuncClone(
   auto handlePrimGetAttr = [&](PrimGetAttrOp op) {
     if (!op.getType().isa<NnModuleType>()) {
       auto instance = mapping.lookup(op.getReceiver()).getDefiningOp<NnModuleOp>();
-      SlotOp affectedSlot;
-      for (auto slot : instance.getOps<SlotOp>()) {
-        if (slot.getName() == op.getName())
-          affectedSlot = slot;
-      }
+      SlotOp affectedSlot = slotIndex.lookup(instance, op.getName());
       auto newOp = OpBuilder(op).create<GlobalSlotGetOp>(
           op.getLoc(), op.getType(),
           objectGraphInfo.getGlobalSlotFor(affectedSlot).getSymName());
@@ -623,7 +669,8 @@ static LogicalResult globalizeObjectGraph(ModuleOp module) {
   // calculating these monomorphizations is a fixed-point iteration that
   // discovers all needed monomorphizations. In practice this yields a
   // controllable number.
-  MonomorphizationTracker tracker(module);
+  SlotIndex slotIndex;
+  MonomorphizationTracker tracker(module, slotIndex);
   if (failed(tracker.initialize(instances)))
     return failure();
 
@@ -663,10 +710,12 @@ static LogicalResult globalizeObjectGraph(ModuleOp module) {
 
   for (auto &kv : newFuncs) {
     IRMapping mapping;
-    if (failed(analyzeInstances(kv.second, kv.first.argInstances, mapping)))
+    if (failed(analyzeInstances(kv.second, kv.first.argInstances, mapping,
+                                slotIndex)))
       return failure();
     if (failed(rewriteMonomorphizedFuncClone(kv.second, mapping, symbolTable,
-                                             newFuncs, objectGraphInfo)))
+                                             newFuncs, objectGraphInfo,
+                                             slotIndex)))
       return failure();
   }
 
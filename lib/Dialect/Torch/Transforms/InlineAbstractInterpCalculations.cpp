@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Threading.h"
+#include "mlir/Transforms/InliningUtils.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "llvm/ADT/Sequence.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringSet.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+// Collects the calls nested in the calculation regions within `root`.
+static SmallVector<func::CallOp> collectCalculationCalls(Operation *root) {
+  SmallVector<func::CallOp> calls;
+  auto collect = [&](Region &calculation) {
+    calculation.walk([&](func::CallOp call) { calls.push_back(call); });
+  };
+  root->walk([&](Operation *op) {
+    if (auto shapeCalculate = dyn_cast<ShapeCalculateOp>(op))
+      collect(shapeCalculate.getCalculation());
+    else if (auto dtypeCalculate = dyn_cast<DtypeCalculateOp>(op))
+      collect(dtypeCalculate.getCalculation());
+  });
+  return calls;
+}
+
+// Inlines the calls in the calculation regions within `root`, adding the
+// callees to `inlinedCallees`. Inlining a library function can expose calls to
+// its own callees in the calculation region, so we iterate until no calls are
+// left. The library functions are imported from TorchScript, which does not
+// allow recursion, so this terminates.
+//
+// The library functions are only read, so this can safely be run concurrently
+// on different functions.
+static LogicalResult
+inlineCalculationCalls(Operation *root, SymbolTable &symbolTable,
+                       llvm::SetVector<Operation *> &inlinedCallees) {
+  InlinerInterface inliner(root->getContext());
+  SmallVector<func::CallOp> calls = collectCalculationCalls(root);
+  while (!calls.empty()) {
+    for (func::CallOp call : calls) {
+      auto callee = symbolTable.lookup<func::FuncOp>(call.getCallee());
+      if (!callee || callee.isExternal())
+        return call.emitError("unable to inline call to library function ")
+               << call.getCalleeAttr();
+      if (failed(inlineCall(inliner, call, callee, &callee.getBody())))
+        return call.emitError("failed to inline call to library function ")
+               << call.getCalleeAttr();
+      call.erase();
+      inlinedCallees.insert(callee);
+    }
+    calls = collectCalculationCalls(root);
+  }
+  return success();
+}
+
+namespace {
+class InlineAbstractInterpCalculationsPass
+    : public InlineAbstractInterpCalculationsBase<
+          InlineAbstractInterpCalculationsPass> {
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    SymbolTable symbolTable(module);
+
+    // Process each top-level op in parallel when threading is enabled. The
+    // library functions never contain calculations themselves, so they are
+    // only ever read.
+    SmallVector<Operation *> roots = llvm::to_vector(llvm::map_range(
+        module.getBody()->getOperations(), [](Operation &op) { return &op; }));
+    SmallVector<llvm::SetVector<Operation *>> inlinedCalleesPerRoot(
+        roots.size());
+    if (failed(failableParallelForEach(
+            &getContext(), llvm::seq<size_t>(0, roots.size()), [&](size_t i) {
+              return inlineCalculationCalls(roots[i], symbolTable,
+                                            inlinedCalleesPerRoot[i]);
+            })))
+      return signalPassFailure();
+    llvm::SetVector<Operation *> inlinedCallees;
+    for (auto &calleesOfRoot : inlinedCalleesPerRoot)
+      inlinedCallees.insert(calleesOfRoot.begin(), calleesOfRoot.end());
+
+    // Erase the private library functions that are no longer referenced from
+    // outside of the library itself. Everything else in the module is left
+    // alone, unlike with the general-purpose inliner.
+    llvm::StringSet<> referencedFromProgram;
+    for (Operation &op : *module.getBody()) {
+      if (inlinedCallees.contains(&op))
+        continue;
+      std::optional<SymbolTable::UseRange> uses =
+          SymbolTable::getSymbolUses(&op);
+      if (!uses)
+        return;
+      for (const SymbolTable::SymbolUse &use : *uses)
+        referencedFromProgram.insert(use.getSymbolRef().getRootReference());
+    }
+    for (Operation *op : inlinedCallees) {
+      auto func = cast<func::FuncOp>(op);
+      if (func.isPrivate() &&
+          !referencedFromProgram.contains(func.getSymName()))
+        symbolTable.erase(func);
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>>
+mlir::torch::Torch::createInlineAbstractInterpCalculationsPass() {
+  return std::make_unique<InlineAbstractInterpCalculationsPass>();
+}
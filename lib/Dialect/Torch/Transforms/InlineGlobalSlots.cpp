@@ -139,11 +139,13 @@ public:
 private:
   /// The local transfer function determining the safety of `value`.
   bool isValueSafeTransferFunction(Value value);
-  /// The InitializeGlobalSlotsOp of the current module we are analyzing.
+  /// The initial value of each global slot, from the InitializeGlobalSlotsOp
+  /// of the current module we are analyzing.
   ///
   /// This is used to propagate the analysis from globals into to the module
-  /// initializer.
-  InitializeGlobalSlotsOp initializeGlobalSlotsOp;
+  /// initializer. It is indexed once when the analysis is initialized, so
+  /// that visiting a global slot doesn't search the initializer.
+  DenseMap</*FlatSymbolRefAttr*/ Attribute, Value> initialValues;
 };
 
 InlineGlobalSlotsAnalysis::InlineGlobalSlotsAnalysis(DataFlowSolver &solver)
@@ -166,9 +168,11 @@ LogicalResult InlineGlobalSlotsAnalysis::initialize(Operation *top) {
           getProgramPoint<FlatSymbolRefProgramPoint>(globalSlotSet.getSlotAttr()));
       propagateIfChanged(state, state->setSafe(false));
     }
-    // Save the InitializeGlobalSlotsOp for later referencee
+    // Index the InitializeGlobalSlotsOp for later reference.
     if (auto initialize = dyn_cast<Torch::InitializeGlobalSlotsOp>(op)) {
-      initializeGlobalSlotsOp = initialize;
+      for (auto it : llvm::zip(initialize.getSlotSymNames(),
+                               initialize->getOperands()))
+        initialValues[std::get<0>(it)] = std::get<1>(it);
     }
     for (Value result : op->getResults()) {
       if (failed(visit(result)))
@@ -207,12 +211,7 @@ LogicalResult InlineGlobalSlotsAnalysis::visit(ProgramPoint point) {
   if (auto *genericProgramPoint = point.dyn_cast<GenericProgramPoint *>()) {
     if (auto *flatSymbolRefPoint =
             dyn_cast<FlatSymbolRefProgramPoint>(genericProgramPoint)) {
-      if (initializeGlobalSlotsOp) {
-        auto it =
-            llvm::find(initializeGlobalSlotsOp.getSlotSymNames(),
-                       static_cast<Attribute>(flatSymbolRefPoint->getValue()));
-        Value value = initializeGlobalSlotsOp->getOperand(
-            std::distance(initializeGlobalSlotsOp.getSlotSymNames().begin(), it));
+      if (Value value = initialValues.lookup(flatSymbolRefPoint->getValue())) {
         auto *flatSymbolRefState =
             getOrCreateFor<InlineGlobalSlotsAnalysisState>(value,
                                                            flatSymbolRefPoint);
@@ -270,9 +269,10 @@ SmallVector<Operation *> getBackwardSliceIncludingRoot(Value initialValue) {
   return slice;
 }
 
-static bool isInitialValueTransitivelySafeToInline(Value initialValue,
-                                                   DataFlowSolver &solver) {
-  SmallVector<Operation *> slice = getBackwardSliceIncludingRoot(initialValue);
+// Returns true if all the values computed by `slice`, the backward slice of an
+// initial value, are safe.
+static bool isSliceSafeToInline(ArrayRef<Operation *> slice,
+                                DataFlowSolver &solver) {
   for (Operation *op : slice) {
     for (auto result : op->getResults()) {
       auto *state = solver.lookupState<InlineGlobalSlotsAnalysisState>(result);
@@ -290,6 +290,21 @@ class InlineGlobalSlotsPass
   void runOnOperation() override {
 
     ModuleOp module = getOperation();
+    Torch::InitializeGlobalSlotsOp initialize;
+    // TODO: Have a torch.module with an optional initializer region to make
+    // this tighter.
+    for (auto moduleInitializer :
+         module.getOps<Torch::GlobalSlotModuleInitializerOp>()) {
+      initialize = cast<Torch::InitializeGlobalSlotsOp>(
+          moduleInitializer.getBody()->getTerminator());
+    }
+    // Once the slots have been inlined by a previous iteration of the
+    // simplification pipeline, there is nothing left to analyze, so don't
+    // run the solver over the whole module again.
+    if (!initialize || initialize->getNumOperands() == 0) {
+      return;
+    }
+
     DataFlowSolver solver;
     solver.load<InlineGlobalSlotsAnalysis>();
     if (failed(solver.initializeAndRun(module)))
@@ -317,19 +332,12 @@ class InlineGlobalSlotsPass
       });
     });
 
-    Torch::InitializeGlobalSlotsOp initialize;
-    // TODO: Have a torch.module with an optional initializer region to make
-    // this tighter.
-    for (auto moduleInitializer :
-         module.getOps<Torch::GlobalSlotModuleInitializerOp>()) {
-      initialize = cast<Torch::InitializeGlobalSlotsOp>(
-          moduleInitializer.getBody()->getTerminator());
-    }
-    if (!initialize) {
-      return;
-    }
-
+    // The slots to inline, with the slice computing their initial value,
+    // which is computed once for all the uses of the slot.
     DenseSet</*FlatSymbolRefAttr*/ Attribute> safeToInline;
+    DenseMap</*FlatSymbolRefAttr*/ Attribute,
+             std::pair<Value, SmallVector<Operation *>>>
+        initialValueSlices;
     for (int i = 0, e = initialize->getNumOperands(); i != e; i++) {
       auto slotSymName = initialize.getSlotSymNames()[i].cast<FlatSymbolRefAttr>();
       Value operand = initialize.getOperand(i);
@@ -354,25 +362,21 @@ class InlineGlobalSlotsPass
       // too much boilerplate to write that with the dataflow framework and we
       // generally don't expect long transitive chains of values here -- most
       // initial values are just single tensor literals.
-      if (isInitialValueTransitivelySafeToInline(operand, solver)) {
+      SmallVector<Operation *> slice = getBackwardSliceIncludingRoot(operand);
+      if (isSliceSafeToInline(slice, solver)) {
         safeToInline.insert(slotSymName);
+        initialValueSlices[slotSymName] = {operand, std::move(slice)};
       }
     }
 
     SymbolTable symbolTable(module);
     DenseSet<Operation *> toErase;
     module.walk([&](Torch::GlobalSlotGetOp op) {
-      if (!safeToInline.count(op.getSlotAttr()))
+      auto it = initialValueSlices.find(op.getSlotAttr());
+      if (it == initialValueSlices.end())
         return;
-      // TODO: Make this more ergonomic.
-      auto it = llvm::find(initialize.getSlotSymNames(), op.getSlotAttr());
-      Value initialValue = initialize.getOperand(
-          std::distance(initialize.getSlotSymNames().begin(), it));
-      // It seems inefficient to get a backward slice again here, but we are
-      // going to be cloning the whole slice anyway, so it doesn't seem like a
-      // big deal.
-      SmallVector<Operation *> slice =
-          getBackwardSliceIncludingRoot(initialValue);
+      Value initialValue = it->second.first;
+      ArrayRef<Operation *> slice = it->second.second;
       IRMapping mapping;
       OpBuilder builder(op);
       for (Operation *opInSlice : slice)
@@ -17,8 +17,13 @@
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
 #include "torch-mlir/Dialect/Torch/Utils/Utils.h"
-#include "llvm/Support/Debug.h"
+#include "llvm/ADT/EquivalenceClasses.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/ADT/StringSet.h"
+#include "llvm/Support/Debug.h"
+
+#include <chrono>
 
 #define DEBUG_TYPE "torch-lower-to-backend-contract"
 
@@ -173,23 +178,51 @@ static LogicalResult checkOpIsBackendLegal(Operation *op,
   }
 }
 
-static bool satisfiesBackendContract(ModuleOp module,
+// Returns true if every global slot initialized by `initializer` is state
+// that backends can keep across calls: a value tensor with known sizes and
+// dtype, initialized by a literal.
+static bool
+holdsOnlyTensorState(Torch::GlobalSlotModuleInitializerOp initializer) {
+  auto initialize = cast<Torch::InitializeGlobalSlotsOp>(
+      initializer.getBody()->getTerminator());
+  for (auto [symName, initialValue] :
+       llvm::zip(initialize.getSlotSymNames(), initialize.getInitialValues())) {
+    auto slot = SymbolTable::lookupNearestSymbolFrom<Torch::GlobalSlotOp>(
+        initializer, symName.cast<FlatSymbolRefAttr>());
+    if (!slot)
+      return false;
+    auto type = slot.getTypeBound().dyn_cast<ValueTensorType>();
+    if (!type || !type.hasSizes() || !type.hasDtype() ||
+        !initialValue.getDefiningOp<Torch::ValueTensorLiteralOp>())
+      return false;
+  }
+  return true;
+}
+
+// Checks whether `root` (typically a module, but the check also makes sense on
+// a single function) satisfies the backend contract.
+static bool satisfiesBackendContract(Operation *root,
                                      const ConversionTarget &target,
                                      bool actuallyEmitDiagnostics = false) {
-  // We do not permit `torch.global_slot`'s in the backend contract, since
-  // support for them is not widespread, and this does not align with PyTorch's
-  // more tracing-based direction.
+  // We do not permit general `torch.global_slot`'s in the backend contract,
+  // since support for them is not widespread, and this does not align with
+  // PyTorch's more tracing-based direction. The only slots we permit are
+  // value tensors initialized by literals, which hold state across calls,
+  // such as the caches of a decoder (see PromoteMutableGlobalSlots).
   //
   // We just check for the GlobalSlotModuleInitializerOp since its verifier
   // ensures that the set of global slots matches those initialized by the
   // module initializer.
-  auto walkResult0 = module.walk([&](Torch::GlobalSlotModuleInitializerOp op) {
+  auto walkResult0 = root->walk([&](Torch::GlobalSlotModuleInitializerOp op) {
+    if (holdsOnlyTensorState(op))
+      return WalkResult::advance();
     if (actuallyEmitDiagnostics) {
       // Report the error on the terminator to avoid dumping the whole
       // initializer itself, which can have pages of ops in it.
       op.getBody()
           ->getTerminator()
-          ->emitError("unsupported by backend contract: module initializers")
+          ->emitError("unsupported by backend contract: module initializers "
+                      "of global slots other than tensor literals")
           .attachNote()
           .append("this is likely due to InlineGlobalSlots being unable to "
                   "inline a global slot");
@@ -200,7 +233,7 @@ static bool satisfiesBackendContract(ModuleOp module,
     return false;
 
   // Check for unimplemented operators first to give more direct diagnostics.
-  walkResult0 = module.walk([&](Torch::OperatorOp op) {
+  walkResult0 = root->walk([&](Torch::OperatorOp op) {
     if (llvm::all_of(op.getResults(), [&op](auto res) {
           return succeeded(
               checkType(op.getOperation(), res.getType(), /*actuallyEmitDiagnostics=*/false));
@@ -223,7 +256,7 @@ static bool satisfiesBackendContract(ModuleOp module,
   // A pre-order walk gives a more intuitive "first error".
   // TODO: Should we report more than the first error?
   // How do we avoid making it too spammy?
-  auto walkResult1 = module.walk<WalkOrder::PreOrder>([&](Block *block) {
+  auto walkResult1 = root->walk<WalkOrder::PreOrder>([&](Block *block) {
     for (BlockArgument arg : block->getArguments())
       if (failed(checkType(block->getParentOp(), arg.getType(),
                            actuallyEmitDiagnostics))) {
@@ -245,6 +278,48 @@ static bool satisfiesBackendContract(ModuleOp module,
   return true;
 }
 
+// Counts the ops in `root` that do not yet satisfy the backend contract, either
+// because they are backend illegal or because one of their results has a type
+// that is not allowed by the backend contract, keyed by op name.
+static llvm::MapVector<OperationName, int>
+countBackendIllegalOps(Operation *root, const ConversionTarget &target) {
+  llvm::MapVector<OperationName, int> counts;
+  root->walk([&](Operation *op) {
+    if (op == root)
+      return;
+    bool illegal =
+        failed(checkOpIsBackendLegal(op, target,
+                                     /*actuallyEmitDiagnostics=*/false)) ||
+        llvm::any_of(op->getResultTypes(), [&](Type type) {
+          return failed(
+              checkType(op, type, /*actuallyEmitDiagnostics=*/false));
+        });
+    if (illegal)
+      ++counts[op->getName()];
+  });
+  return counts;
+}
+
+// Counts the distinct tensor types of the values in `root`, which stay in the
+// context after the module is gone.
+static int64_t countTensorTypes(Operation *root) {
+  DenseSet<Type> tensorTypes;
+  auto addTypes = [&](TypeRange types) {
+    for (Type type : types) {
+      if (type.isa<BaseTensorType>())
+        tensorTypes.insert(type);
+    }
+  };
+  root->walk([&](Operation *op) {
+    addTypes(op->getResultTypes());
+    for (Region &region : op->getRegions()) {
+      for (Block &block : region)
+        addTypes(block.getArgumentTypes());
+    }
+  });
+  return tensorTypes.size();
+}
+
 // Explicitly set ops and dialects allowed and not allowed in backend contract.
 static ConversionTarget
 getBackendContractTarget(MLIRContext *context, bool decompose,
@@ -256,6 +331,74 @@ getBackendContractTarget(MLIRContext *context, bool decompose,
   return target;
 }
 
+// Moves the functions of `module` that already satisfy the backend contract
+// into `parked`, so that subsequent runs of the simplification pipeline only
+// pay for the functions that still need work.
+//
+// Functions are parked a whole "symbol component" at a time: a function is only
+// parked together with every function it references or is referenced by,
+// which keeps the symbol references on both sides of the split intact. We also
+// never park anything while the module still has global slots, since
+// InlineGlobalSlots needs to see every use of a slot to reason about it.
+//
+// Returns the number of functions parked.
+static int parkFunctionsSatisfyingBackendContract(ModuleOp module,
+                                                  ModuleOp parked,
+                                                  const ConversionTarget &target) {
+  if (!module.getOps<Torch::GlobalSlotOp>().empty() ||
+      !module.getOps<Torch::GlobalSlotModuleInitializerOp>().empty())
+    return 0;
+
+  SymbolTable symbolTable(module);
+  llvm::EquivalenceClasses<Operation *> components;
+  for (auto func : module.getOps<func::FuncOp>()) {
+    components.insert(func);
+    std::optional<SymbolTable::UseRange> uses =
+        SymbolTable::getSymbolUses(func);
+    // Conservatively bail out if we can't tell what `func` references.
+    if (!uses)
+      return 0;
+    for (const SymbolTable::SymbolUse &use : *uses) {
+      Operation *callee =
+          symbolTable.lookup(use.getSymbolRef().getRootReference());
+      if (callee)
+        components.unionSets(func, callee);
+    }
+  }
+
+  // A component can only be parked if all of its members are functions that
+  // satisfy the backend contract.
+  llvm::DenseSet<Operation *> unsatisfiedLeaders;
+  for (auto it = components.begin(), e = components.end(); it != e; ++it) {
+    if (!it->isLeader())
+      continue;
+    for (auto member = components.member_begin(it);
+         member != components.member_end(); ++member) {
+      if (!isa<func::FuncOp>(*member) ||
+          !satisfiesBackendContract(*member, target)) {
+        unsatisfiedLeaders.insert(it->getData());
+        break;
+      }
+    }
+  }
+
+  int numParked = 0;
+  for (auto func : llvm::make_early_inc_range(module.getOps<func::FuncOp>())) {
+    if (unsatisfiedLeaders.contains(components.getLeaderValue(func)))
+      continue;
+    func->moveBefore(parked.getBody(), parked.getBody()->end());
+    ++numParked;
+  }
+  return numParked;
+}
+
+// Moves the functions parked by `parkFunctionsSatisfyingBackendContract` back
+// into `module`.
+static void unparkFunctions(ModuleOp module, ModuleOp parked) {
+  Block *body = module.getBody();
+  body->getOperations().splice(body->end(), parked.getBody()->getOperations());
+}
+
 namespace {
 class LowerToBackendContractPass
     : public LowerToBackendContractBase<LowerToBackendContractPass> {
@@ -263,11 +406,20 @@ public:
   LowerToBackendContractPass() = default;
   LowerToBackendContractPass(int maxIterations, bool decompose,
                              ArrayRef<std::string> backendLegalOps,
-                             StringRef extraLibrary) {
+                             StringRef extraLibrary, bool incremental,
+                             bool reportIterations, StringRef mixedPrecision,
+                             ArrayRef<std::string> mixedPrecisionOps,
+                             ArrayRef<std::string>
+                                 decompositionOpEfficiencies) {
     this->maxIterations = maxIterations;
     this->decompose = decompose;
     this->backendLegalOps = backendLegalOps;
     this->extraLibrary = extraLibrary.str();
+    this->incremental = incremental;
+    this->reportIterations = reportIterations;
+    this->mixedPrecision = mixedPrecision.str();
+    this->mixedPrecisionOps = mixedPrecisionOps;
+    this->decompositionOpEfficiencies = decompositionOpEfficiencies;
   }
   void runOnOperation() override {
     ModuleOp module = getOperation();
@@ -283,8 +435,24 @@ public:
     options.decompose = decompose;
     options.backendLegalOps = backendLegalOps;
     options.extraLibrary = extraLibrary;
+    options.mixedPrecision = mixedPrecision;
+    options.mixedPrecisionOps = mixedPrecisionOps;
+    options.decompositionOpEfficiencies = decompositionOpEfficiencies;
     createTorchSimplificationPipeline(pm, options);
 
+    // In incremental mode, functions which already satisfy the backend
+    // contract are set aside here between iterations.
+    OwningOpRef<ModuleOp> parked = ModuleOp::create(module.getLoc());
+    auto restoreParkedFunctions =
+        llvm::make_scope_exit([&]() { unparkFunctions(module, *parked); });
+
+    // For each kind of op that was backend illegal at some point, the first
+    // iteration after which no illegal instance of it remained (or 0 if there
+    // still is one).
+    llvm::MapVector<OperationName, int> iterationOpBecameLegal;
+    for (auto &opAndCount : countBackendIllegalOps(module, target))
+      iterationOpBecameLegal[opAndCount.first] = 0;
+
     int i = 0;
     do {
       if (i++ == maxIterations) {
@@ -294,22 +462,96 @@ public:
                        << maxIterations
                        << " iterations of the simplification pipeline\n";
         });
+        if (reportIterations)
+          emitLegalizationSummary(module, iterationOpBecameLegal);
         // Show the diagnostics.
         (void)satisfiesBackendContract(module, target,
                                        /*actuallyEmitDiagnostics=*/true);
         return signalPassFailure();
       }
 
+      if (incremental && i > 1) {
+        int numParked =
+            parkFunctionsSatisfyingBackendContract(module, *parked, target);
+        numFunctionsParked += numParked;
+        LLVM_DEBUG({
+          llvm::dbgs() << "LowerToBackendContractPass: "
+                       << "parked " << numParked
+                       << " functions already satisfying the backend "
+                          "contract before iteration "
+                       << i << "\n";
+        });
+      }
+
+      auto start = std::chrono::steady_clock::now();
       if (failed(runPipeline(pm, module)))
         return signalPassFailure();
+      int64_t elapsedUs =
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count();
+      ++numIterations;
+
+      llvm::MapVector<OperationName, int> illegalOps =
+          countBackendIllegalOps(module, target);
+      int numIllegal = 0;
+      for (auto &opAndCount : illegalOps) {
+        numIllegal += opAndCount.second;
+        // Ops can be (re)introduced by the pipeline, e.g. by decompositions.
+        iterationOpBecameLegal[opAndCount.first] = 0;
+      }
+      for (auto &opAndIteration : iterationOpBecameLegal) {
+        if (opAndIteration.second == 0 &&
+            !illegalOps.count(opAndIteration.first))
+          opAndIteration.second = i;
+      }
+      numIllegalOps = numIllegal;
+
+      if (reportIterations) {
+        InFlightDiagnostic remark = module.emitRemark();
+        remark << "iteration " << i << " of the simplification pipeline took "
+               << elapsedUs << " us; " << numIllegal
+               << " ops do not yet satisfy the backend contract";
+        if (numIllegal)
+          remark << ":";
+        llvm::interleave(
+            illegalOps,
+            [&](auto &opAndCount) {
+              remark << " " << opAndCount.first << " x" << opAndCount.second;
+            },
+            [&]() { remark << ","; });
+      }
     } while (!satisfiesBackendContract(module, target));
+    numTensorTypes = countTensorTypes(module);
     LLVM_DEBUG({
       llvm::dbgs() << "LowerToBackendContractPass: "
                    << "succeeded after " << i
                    << " iterations of the simplification pipeline\n";
     });
+    if (reportIterations)
+      emitLegalizationSummary(module, iterationOpBecameLegal);
   }
+
 private:
+  // Reports, for each kind of op that was backend illegal at some point, the
+  // iteration in which it became legal.
+  static void emitLegalizationSummary(
+      ModuleOp module,
+      const llvm::MapVector<OperationName, int> &iterationOpBecameLegal) {
+    for (auto &opAndIteration : iterationOpBecameLegal) {
+      if (opAndIteration.second == 0) {
+        module.emitRemark() << "'" << opAndIteration.first
+                            << "' ops still do not satisfy the backend "
+                               "contract";
+      } else {
+        module.emitRemark() << "'" << opAndIteration.first
+                            << "' ops satisfy the backend contract after "
+                               "iteration "
+                            << opAndIteration.second;
+      }
+    }
+  }
+
   llvm::StringSet<> backendLegalOpsSet;
 };
 
@@ -335,9 +577,13 @@ public:
 std::unique_ptr<OperationPass<ModuleOp>>
 mlir::torch::Torch::createLowerToBackendContractPass(
     int maxIterations, bool decompose, ArrayRef<std::string> backendLegalOps,
-    StringRef extraLibrary) {
+    StringRef extraLibrary, bool incremental, bool reportIterations,
+    StringRef mixedPrecision, ArrayRef<std::string> mixedPrecisionOps,
+    ArrayRef<std::string> decompositionOpEfficiencies) {
   return std::make_unique<LowerToBackendContractPass>(
-      maxIterations, decompose, backendLegalOps, extraLibrary);
+      maxIterations, decompose, backendLegalOps, extraLibrary, incremental,
+      reportIterations, mixedPrecision, mixedPrecisionOps,
+      decompositionOpEfficiencies);
 }
 
 std::unique_ptr<OperationPass<ModuleOp>>
@@ -390,6 +636,7 @@ static void markDecomposedOpsAsIllegal(MLIRContext *context,
   target.addIllegalOp<AtenNormScalarOptDimOp>();
   target.addIllegalOp<AtenSelectIntOp>();
   target.addIllegalOp<AtenMvOp>();
+  target.addIllegalOp<AtenEinsumOp>();
   target.addIllegalOp<AtenTOp>();
   target.addIllegalOp<Aten_LogSoftmaxBackwardDataOp>();
   target.addDynamicallyLegalOp<AtenMatmulOp>([](AtenMatmulOp op) {
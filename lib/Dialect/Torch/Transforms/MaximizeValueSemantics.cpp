@@ -59,6 +59,8 @@ public:
   // Used to represent all of the interpreted ops that have at least
   // one non-value tensor as input or output.
   struct InterpretedOps {
+    // All of the users of non-value tensors in the slice, in block order.
+    SmallVector<Operation *> users;
     SmallVector<Operation *> copyLikeOps;
     SmallVector<Operation *> viewLikeOps;
     SmallVector<OverwriteTensorContentsOp> overwriteTensorContentsOps;
@@ -88,6 +90,7 @@ public:
     DenseSet<Value> availableAliases{
         assertNonValueTensor(copyToNonValueTensor.getResult())};
     for (Operation *user : nonValueTensorUsers) {
+      result.users.push_back(user);
       for (Value operand : nonValueTensorsUsedByOp.lookup(user)) {
         if (!availableAliases.contains(operand)) {
           return rewriter.notifyMatchFailure(
@@ -151,23 +154,30 @@ public:
     // operand to a value tensor, this rewriting MUST happen first to avoid
     // wrongly replacing operands that were previously not a view of the
     // overwritten tensor.
-    for (OverwriteTensorContentsOp overwrite :
-         llvm::reverse(ops.overwriteTensorContentsOps)) {
-      Value overwritten = assertNonValueTensor(overwrite.getOverwritten());
-      // Cast-like aliases represent the exact same tensor at runtime as the
-      // overwritten alias, since casts only encode compile time information.
-      // Therefore, here we replace the overwritten value and any cast-like
-      // aliases of it with the overwrite value.
-      DenseSet<Value> overwrittenAliases = getCastLikeAliasesOf(overwritten);
-      overwrittenAliases.insert(overwritten);
-
-      for (Value alias : overwrittenAliases) {
-        alias.replaceUsesWithIf(
-            overwrite.getValue(), [&](const OpOperand &operand) {
-              return !operand.getOwner()->isBeforeInBlock(overwrite);
-            });
+    //
+    // All of the uses of the aliases in the slice are uses by `ops.users`, so
+    // rather than replacing the later uses of the overwritten aliases once per
+    // overwrite, which is quadratic for a tensor that is overwritten many
+    // times, the users are walked forward once, mapping each overwritten alias
+    // to the value it was last overwritten with.
+    DenseMap<Value, Value> overwrittenContents;
+    for (Operation *user : ops.users) {
+      if (auto overwrite = dyn_cast<OverwriteTensorContentsOp>(user)) {
+        Value overwritten = assertNonValueTensor(overwrite.getOverwritten());
+        // Cast-like aliases represent the exact same tensor at runtime as the
+        // overwritten alias, since casts only encode compile time information.
+        // Therefore, here we replace the overwritten value and any cast-like
+        // aliases of it with the overwrite value.
+        overwrittenContents[overwritten] = overwrite.getValue();
+        for (Value alias : getCastLikeAliasesOf(overwritten))
+          overwrittenContents[alias] = overwrite.getValue();
+        rewriter.eraseOp(overwrite);
+        continue;
+      }
+      for (OpOperand &operand : user->getOpOperands()) {
+        if (Value contents = overwrittenContents.lookup(operand.get()))
+          operand.set(contents);
       }
-      rewriter.eraseOp(overwrite);
     }
 
     for (Operation *copyLikeOp : ops.copyLikeOps)
@@ -305,12 +315,15 @@ public:
     SmallVector<CopyToValueTensorOp> copyToValueTensorOps;
     SmallVector<mlir::func::ReturnOp> returnOps;
     auto workList = llvm::to_vector<6>(copy.getResult().getUsers());
-    // We currently only support view-like ops with one tensor input and one
-    // tensor output, meaning that the tensor use-def chains form a tree.
-    // This will not be the case for an op like `torch.aten.view_as`, so
-    // we will need to add a set to prune duplicate visitation.
+    // An op like `torch.aten.view_as` can use more than one tensor of the
+    // subgraph, so the tensor use-def chains do not necessarily form a tree.
+    // Each op is only visited once, otherwise the subgraph below such an op
+    // would be walked, and its ops rewritten, once per path to it.
+    DenseSet<Operation *> visited;
     while (!workList.empty()) {
       Operation *op = workList.pop_back_val();
+      if (!visited.insert(op).second)
+        continue;
       if (auto copyToValueTensor = dyn_cast<CopyToValueTensorOp>(op)) {
         copyToValueTensorOps.push_back(copyToValueTensor);
       } else if (auto returnOp = dyn_cast<mlir::func::ReturnOp>(op)) {
@@ -0,0 +1,191 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "torch-mlir/Dialect/Torch/Transforms/MemoryUsageInstrumentation.h"
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/DialectResourceBlobManager.h"
+#include "mlir/Pass/PassInstrumentation.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
+
+#include <cstdlib>
+#include <mutex>
+#include <optional>
+
+#ifdef LLVM_ON_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+// Returns the resident set size of the process in bytes, or 0 if it is not
+// known on this platform.
+static int64_t getResidentSetSize() {
+#ifdef __linux__
+  // The second field of statm is the number of resident pages.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> statm =
+      llvm::MemoryBuffer::getFileAsStream("/proc/self/statm");
+  if (!statm)
+    return 0;
+  int64_t residentPages;
+  if ((*statm)->getBuffer().split(' ').second.split(' ').first.getAsInteger(
+          10, residentPages))
+    return 0;
+  return residentPages * llvm::sys::Process::getPageSizeEstimate();
+#else
+  return 0;
+#endif
+}
+
+// Returns the peak resident set size of the process in bytes, or 0 if it is
+// not known on this platform.
+static int64_t getPeakResidentSetSize() {
+#ifdef LLVM_ON_UNIX
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  return usage.ru_maxrss;
+#else
+  // Linux and the BSDs count kilobytes.
+  return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+  return 0;
+#endif
+}
+
+// Returns the bytes of the elements held by `attr`, or 0 if it is not an
+// elements attribute.
+static int64_t getElementBytes(Attribute attr) {
+  if (auto dense = attr.dyn_cast<DenseElementsAttr>())
+    return dense.getRawData().size();
+  if (auto resource = attr.dyn_cast<DenseResourceElementsAttr>()) {
+    if (AsmResourceBlob *blob = resource.getRawHandle().getBlob())
+      return blob->getData().size();
+  }
+  return 0;
+}
+
+static double toMiB(int64_t bytes) { return bytes / double(1 << 20); }
+
+// Formats the change `bytes` in MiB, with its sign.
+static std::string formatChange(int64_t bytes) {
+  return llvm::formatv("{0}{1:f1}", bytes < 0 ? "-" : "+",
+                       toMiB(std::abs(bytes)))
+      .str();
+}
+
+namespace {
+// The memory usage of the process and the attributes of the IR when a pass
+// started.
+struct Snapshot {
+  int64_t residentSetSize;
+  int64_t peakResidentSetSize;
+  llvm::DenseSet<Attribute> attributes;
+};
+
+class MemoryUsageInstrumentation : public PassInstrumentation {
+public:
+  MemoryUsageInstrumentation(const MemoryUsageInstrumentationOptions &options)
+      : options(options) {}
+
+  void runBeforePass(Pass *pass, Operation *op) override {
+    if (!isReported(pass))
+      return;
+    Snapshot snapshot{getResidentSetSize(), getPeakResidentSetSize(),
+                      collectAttributes(op)};
+    std::lock_guard<std::mutex> lock(mutex);
+    snapshots[{pass, op}] = std::move(snapshot);
+  }
+
+  void runAfterPass(Pass *pass, Operation *op) override {
+    if (!isReported(pass))
+      return;
+    int64_t residentSetSize = getResidentSetSize();
+    int64_t peakResidentSetSize = getPeakResidentSetSize();
+    std::optional<Snapshot> before = takeSnapshot(pass, op);
+    if (!before)
+      return;
+
+    int64_t numNewAttributes = 0;
+    int64_t newElementBytes = 0;
+    for (Attribute attr : collectAttributes(op)) {
+      if (before->attributes.contains(attr))
+        continue;
+      ++numNewAttributes;
+      newElementBytes += getElementBytes(attr);
+    }
+
+    InFlightDiagnostic remark = op->emitRemark();
+    remark << llvm::formatv(
+                  "memory usage after '{0}': rss {1:f1} MiB ({2} MiB), peak "
+                  "rss {3:f1} MiB ({4} MiB), {5} new attributes with {6:f1} "
+                  "MiB of elements",
+                  pass->getArgument(), toMiB(residentSetSize),
+                  formatChange(residentSetSize - before->residentSetSize),
+                  toMiB(peakResidentSetSize),
+                  formatChange(peakResidentSetSize -
+                               before->peakResidentSetSize),
+                  numNewAttributes, toMiB(newElementBytes))
+                  .str();
+    if (numNewAttributes >= options.largeAttributeCount ||
+        newElementBytes >= options.largeAttributeBytes)
+      remark << "; the pass created many attributes";
+  }
+
+  void runAfterPassFailed(Pass *pass, Operation *op) override {
+    (void)takeSnapshot(pass, op);
+  }
+
+private:
+  // The adaptors running nested pass managers have no argument, and their
+  // passes are reported on their own.
+  static bool isReported(Pass *pass) { return !pass->getArgument().empty(); }
+
+  // Returns the attributes of `op` and the operations nested in it, including
+  // the attributes nested in them.
+  static llvm::DenseSet<Attribute> collectAttributes(Operation *op) {
+    llvm::DenseSet<Attribute> attributes;
+    op->walk([&](Operation *nested) {
+      nested->getAttrDictionary().walk(
+          [&](Attribute attr) { attributes.insert(attr); });
+    });
+    return attributes;
+  }
+
+  std::optional<Snapshot> takeSnapshot(Pass *pass, Operation *op) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = snapshots.find({pass, op});
+    if (it == snapshots.end())
+      return std::nullopt;
+    Snapshot snapshot = std::move(it->second);
+    snapshots.erase(it);
+    return snapshot;
+  }
+
+  MemoryUsageInstrumentationOptions options;
+  // The passes running on different operations run in parallel.
+  std::mutex mutex;
+  llvm::DenseMap<std::pair<Pass *, Operation *>, Snapshot> snapshots;
+};
+} // namespace
+
+void mlir::torch::Torch::addMemoryUsageInstrumentation(
+    PassManager &pm, const MemoryUsageInstrumentationOptions &options) {
+  pm.addInstrumentation(std::make_unique<MemoryUsageInstrumentation>(options));
+}
@@ -0,0 +1,369 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+//
+// Native shape and dtype functions for the most common ops, used instead of
+// the abstract interpretation library when the operands are static enough.
+// They only handle the cases in which the result is easy to get right; for
+// everything else, including invalid programs, they give up and the library
+// functions are used, which also produce the errors.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ReifyAbstractInterpCalculationsUtils.h"
+#include "mlir/IR/Matchers.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchTypes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+// Returns the sizes of `value` if it is a tensor with static sizes.
+static std::optional<ArrayRef<int64_t>> getStaticSizes(Value value) {
+  auto type = value.getType().dyn_cast<BaseTensorType>();
+  if (!type || !type.areAllSizesKnown())
+    return std::nullopt;
+  return type.getSizes();
+}
+
+// Returns the dtype of `value` if it is a tensor with a float dtype.
+static Type getFloatDtype(Value value) {
+  auto type = value.getType().dyn_cast<BaseTensorType>();
+  if (!type || !type.hasDtype() || !type.getDtype().isa<mlir::FloatType>())
+    return nullptr;
+  return type.getDtype();
+}
+
+// Matches a list of constant ints that is never mutated.
+static bool matchConstantIntList(Value list, SmallVectorImpl<int64_t> &values) {
+  return matchPattern(list, m_TorchListOfConstantInts(values)) &&
+         !isListPotentiallyMutated(list);
+}
+
+static std::optional<SmallVector<int64_t>>
+broadcastSizes(ArrayRef<int64_t> lhs, ArrayRef<int64_t> rhs) {
+  size_t rank = std::max(lhs.size(), rhs.size());
+  SmallVector<int64_t> result(rank);
+  for (size_t i = 0; i < rank; i++) {
+    int64_t lhsSize = i < lhs.size() ? lhs[lhs.size() - 1 - i] : 1;
+    int64_t rhsSize = i < rhs.size() ? rhs[rhs.size() - 1 - i] : 1;
+    if (lhsSize != rhsSize && lhsSize != 1 && rhsSize != 1)
+      return std::nullopt;
+    result[rank - 1 - i] = lhsSize == 1 ? rhsSize : lhsSize;
+  }
+  return result;
+}
+
+// The sizes of `aten.matmul`, with vector operands treated as matrices with
+// one row (lhs) or column (rhs) that is dropped from the result.
+static std::optional<SmallVector<int64_t>> matmulSizes(ArrayRef<int64_t> lhs,
+                                                       ArrayRef<int64_t> rhs) {
+  if (lhs.empty() || rhs.empty())
+    return std::nullopt;
+  SmallVector<int64_t> lhsMatrix(lhs), rhsMatrix(rhs);
+  bool lhsIsVector = lhs.size() == 1, rhsIsVector = rhs.size() == 1;
+  if (lhsIsVector)
+    lhsMatrix.insert(lhsMatrix.begin(), 1);
+  if (rhsIsVector)
+    rhsMatrix.push_back(1);
+  if (lhsMatrix.back() != rhsMatrix[rhsMatrix.size() - 2])
+    return std::nullopt;
+  std::optional<SmallVector<int64_t>> result =
+      broadcastSizes(ArrayRef(lhsMatrix).drop_back(2),
+                     ArrayRef(rhsMatrix).drop_back(2));
+  if (!result)
+    return std::nullopt;
+  if (!lhsIsVector)
+    result->push_back(lhsMatrix[lhsMatrix.size() - 2]);
+  if (!rhsIsVector)
+    result->push_back(rhsMatrix.back());
+  return result;
+}
+
+// The sizes of a non-transposed convolution.
+static std::optional<SmallVector<int64_t>>
+convolutionSizes(Value input, Value weight, Value strideList,
+                 Value paddingList, Value dilationList, Value groupsValue) {
+  std::optional<ArrayRef<int64_t>> inputSizes = getStaticSizes(input);
+  std::optional<ArrayRef<int64_t>> weightSizes = getStaticSizes(weight);
+  SmallVector<int64_t> stride, padding, dilation;
+  int64_t groups;
+  if (!inputSizes || !weightSizes || inputSizes->size() < 3 ||
+      inputSizes->size() != weightSizes->size() ||
+      !matchConstantIntList(strideList, stride) ||
+      !matchConstantIntList(paddingList, padding) ||
+      !matchConstantIntList(dilationList, dilation) ||
+      !matchPattern(groupsValue, m_TorchConstantInt(&groups)))
+    return std::nullopt;
+  size_t spatialRank = inputSizes->size() - 2;
+  if (stride.size() != spatialRank || padding.size() != spatialRank ||
+      dilation.size() != spatialRank || groups < 1 ||
+      (*inputSizes)[1] != (*weightSizes)[1] * groups ||
+      (*weightSizes)[0] % groups != 0)
+    return std::nullopt;
+
+  SmallVector<int64_t> result = {(*inputSizes)[0], (*weightSizes)[0]};
+  for (size_t i = 0; i < spatialRank; i++) {
+    int64_t numerator = (*inputSizes)[i + 2] + 2 * padding[i] -
+                        dilation[i] * ((*weightSizes)[i + 2] - 1) - 1;
+    if (numerator < 0 || stride[i] < 1)
+      return std::nullopt;
+    result.push_back(numerator / stride[i] + 1);
+  }
+  return result;
+}
+
+// The sizes of a 2d pooling, as computed by `pooling_output_shape` in
+// PyTorch. `dilationList` is null for pooling ops without dilation.
+static std::optional<SmallVector<int64_t>>
+pool2dSizes(Value input, Value kernelSizeList, Value strideList,
+            Value paddingList, Value dilationList, Value ceilModeValue) {
+  std::optional<ArrayRef<int64_t>> inputSizes = getStaticSizes(input);
+  SmallVector<int64_t> kernelSize, stride, padding, dilation = {1};
+  bool ceilMode;
+  if (!inputSizes || (inputSizes->size() != 3 && inputSizes->size() != 4) ||
+      !matchConstantIntList(kernelSizeList, kernelSize) ||
+      !matchConstantIntList(strideList, stride) ||
+      !matchConstantIntList(paddingList, padding) ||
+      !matchPattern(ceilModeValue, m_TorchConstantBool(&ceilMode)))
+    return std::nullopt;
+  if (dilationList) {
+    dilation.clear();
+    if (!matchConstantIntList(dilationList, dilation))
+      return std::nullopt;
+  }
+  // Each list holds one value per spatial dimension, or a single one for
+  // both. An empty stride means that the stride is the kernel size.
+  if (stride.empty())
+    stride = kernelSize;
+  for (SmallVector<int64_t> *list : {&kernelSize, &stride, &padding,
+                                     &dilation}) {
+    if (list->size() == 1)
+      list->push_back(list->front());
+    if (list->size() != 2)
+      return std::nullopt;
+  }
+
+  SmallVector<int64_t> result(inputSizes->drop_back(2));
+  for (size_t i = 0; i < 2; i++) {
+    int64_t inputSize = (*inputSizes)[inputSizes->size() - 2 + i];
+    if (kernelSize[i] < 1 || stride[i] < 1 || dilation[i] < 1 ||
+        padding[i] < 0 || padding[i] > kernelSize[i] / 2)
+      return std::nullopt;
+    int64_t numerator = inputSize + 2 * padding[i] -
+                        dilation[i] * (kernelSize[i] - 1) - 1 +
+                        (ceilMode ? stride[i] - 1 : 0);
+    if (numerator < 0)
+      return std::nullopt;
+    int64_t outputSize = numerator / stride[i] + 1;
+    // The last window must start inside the input or its left padding.
+    if (ceilMode && (outputSize - 1) * stride[i] >= inputSize + padding[i])
+      outputSize--;
+    result.push_back(outputSize);
+  }
+  return result;
+}
+
+// The sizes of a reduction over `dimList`, which reduces all the dimensions if
+// it is None or empty.
+static std::optional<SmallVector<int64_t>>
+reductionSizes(Value input, Value dimList, Value keepDimValue) {
+  std::optional<ArrayRef<int64_t>> inputSizes = getStaticSizes(input);
+  SmallVector<int64_t> dims;
+  bool keepDim;
+  if (!inputSizes ||
+      !matchPattern(keepDimValue, m_TorchConstantBool(&keepDim)) ||
+      (!dimList.getType().isa<Torch::NoneType>() &&
+       !matchConstantIntList(dimList, dims)))
+    return std::nullopt;
+  int64_t rank = inputSizes->size();
+  SmallVector<bool> isReduced(rank, dims.empty());
+  for (int64_t dim : dims) {
+    dim = toPositiveDim(dim, rank);
+    if (!isValidDim(dim, rank) || isReduced[dim])
+      return std::nullopt;
+    isReduced[dim] = true;
+  }
+  SmallVector<int64_t> result;
+  for (int64_t i = 0; i < rank; i++) {
+    if (!isReduced[i])
+      result.push_back((*inputSizes)[i]);
+    else if (keepDim)
+      result.push_back(1);
+  }
+  return result;
+}
+
+// The sizes of a view of `input` with the sizes in `sizeList`, one of which
+// may be -1 to be inferred from the others.
+static std::optional<SmallVector<int64_t>> viewSizes(Value input,
+                                                     Value sizeList) {
+  std::optional<ArrayRef<int64_t>> inputSizes = getStaticSizes(input);
+  SmallVector<int64_t> sizes;
+  if (!inputSizes || !matchConstantIntList(sizeList, sizes))
+    return std::nullopt;
+  int64_t numElements = 1;
+  for (int64_t size : *inputSizes)
+    numElements *= size;
+  int64_t knownNumElements = 1;
+  int64_t *inferredSize = nullptr;
+  for (int64_t &size : sizes) {
+    if (size == -1 && !inferredSize)
+      inferredSize = &size;
+    else if (size < 0)
+      return std::nullopt;
+    else
+      knownNumElements *= size;
+  }
+  if (inferredSize) {
+    if (knownNumElements == 0 || numElements % knownNumElements != 0)
+      return std::nullopt;
+    *inferredSize = numElements / knownNumElements;
+  } else if (knownNumElements != numElements) {
+    return std::nullopt;
+  }
+  return sizes;
+}
+
+static bool isNativeUnaryOp(Operation *op) {
+  return isa<AtenTanhOp, AtenReluOp, AtenSigmoidOp, AtenExpOp, AtenGeluOp,
+             AtenSqrtOp, AtenRsqrtOp, AtenNegOp, AtenLogOp, AtenSiluOp>(op);
+}
+
+static bool isNativeBinaryOp(Operation *op) {
+  return isa<AtenAddTensorOp, AtenSubTensorOp, AtenMulTensorOp,
+             AtenDivTensorOp>(op);
+}
+
+static std::optional<SmallVector<int64_t>> computeResultSizes(Operation *op) {
+  if (isNativeUnaryOp(op)) {
+    std::optional<ArrayRef<int64_t>> sizes =
+        getStaticSizes(op->getOperand(0));
+    if (!sizes)
+      return std::nullopt;
+    return SmallVector<int64_t>(*sizes);
+  }
+  if (isNativeBinaryOp(op)) {
+    std::optional<ArrayRef<int64_t>> lhs = getStaticSizes(op->getOperand(0));
+    std::optional<ArrayRef<int64_t>> rhs = getStaticSizes(op->getOperand(1));
+    if (!lhs || !rhs)
+      return std::nullopt;
+    return broadcastSizes(*lhs, *rhs);
+  }
+  if (isa<AtenMmOp, AtenBmmOp, AtenMatmulOp>(op)) {
+    std::optional<ArrayRef<int64_t>> lhs = getStaticSizes(op->getOperand(0));
+    std::optional<ArrayRef<int64_t>> rhs = getStaticSizes(op->getOperand(1));
+    if (!lhs || !rhs)
+      return std::nullopt;
+    // Unlike `aten.matmul`, these require matrices and don't broadcast.
+    if (isa<AtenMmOp>(op) && (lhs->size() != 2 || rhs->size() != 2))
+      return std::nullopt;
+    if (isa<AtenBmmOp>(op) &&
+        (lhs->size() != 3 || rhs->size() != 3 || (*lhs)[0] != (*rhs)[0]))
+      return std::nullopt;
+    return matmulSizes(*lhs, *rhs);
+  }
+  if (auto conv = dyn_cast<AtenConvolutionOp>(op)) {
+    bool transposed;
+    if (!matchPattern(conv.getTransposed(), m_TorchConstantBool(&transposed)) ||
+        transposed)
+      return std::nullopt;
+    return convolutionSizes(conv.getInput(), conv.getWeight(),
+                            conv.getStride(), conv.getPadding(),
+                            conv.getDilation(), conv.getGroups());
+  }
+  if (auto conv = dyn_cast<AtenConv2dOp>(op)) {
+    return convolutionSizes(conv.getInput(), conv.getWeight(),
+                            conv.getStride(), conv.getPadding(),
+                            conv.getDilation(), conv.getGroups());
+  }
+  if (auto pool = dyn_cast<AtenMaxPool2dOp>(op)) {
+    return pool2dSizes(pool.getSelf(), pool.getKernelSize(), pool.getStride(),
+                       pool.getPadding(), pool.getDilation(),
+                       pool.getCeilMode());
+  }
+  if (auto pool = dyn_cast<AtenAvgPool2dOp>(op)) {
+    return pool2dSizes(pool.getSelf(), pool.getKernelSize(), pool.getStride(),
+                       pool.getPadding(), /*dilationList=*/nullptr,
+                       pool.getCeilMode());
+  }
+  if (auto sum = dyn_cast<AtenSumDimIntListOp>(op))
+    return reductionSizes(sum.getSelf(), sum.getDim(), sum.getKeepdim());
+  if (auto mean = dyn_cast<AtenMeanDimOp>(op))
+    return reductionSizes(mean.getSelf(), mean.getDim(), mean.getKeepdim());
+  if (auto view = dyn_cast<AtenViewOp>(op))
+    return viewSizes(view.getSelf(), view.getSize());
+  if (auto reshape = dyn_cast<AtenReshapeOp>(op))
+    return viewSizes(reshape.getSelf(), reshape.getShape());
+  return std::nullopt;
+}
+
+// Only the ops computing in the float dtype of their tensor operands are
+// handled: the promotion rules of the other dtypes are left to the library.
+static Type computeResultDtype(Operation *op) {
+  if (isNativeUnaryOp(op) || isa<AtenMaxPool2dOp, AtenAvgPool2dOp>(op))
+    return getFloatDtype(op->getOperand(0));
+  if (isNativeBinaryOp(op) ||
+      isa<AtenMmOp, AtenBmmOp, AtenMatmulOp, AtenConvolutionOp, AtenConv2dOp>(
+          op)) {
+    Type lhsDtype = getFloatDtype(op->getOperand(0));
+    if (lhsDtype != getFloatDtype(op->getOperand(1)))
+      return nullptr;
+    return lhsDtype;
+  }
+  if (isa<AtenSumDimIntListOp, AtenMeanDimOp>(op)) {
+    // The `dtype` operand, which overrides the dtype of the result.
+    if (!op->getOperand(3).getType().isa<Torch::NoneType>())
+      return nullptr;
+    return getFloatDtype(op->getOperand(0));
+  }
+  if (isa<AtenViewOp, AtenReshapeOp>(op)) {
+    auto type = op->getOperand(0).getType().dyn_cast<BaseTensorType>();
+    return type ? type.getOptionalDtype() : nullptr;
+  }
+  return nullptr;
+}
+
+std::optional<Type>
+Torch::computeResultTypeNatively(Operation *op,
+                                 LibraryFunctionKind libFuncKind) {
+  if (op->getNumResults() != 1 ||
+      !op->hasTrait<mlir::torch::Torch::OpTrait::AllowsTypeRefinement>())
+    return std::nullopt;
+  auto resultType = op->getResult(0).getType().dyn_cast<BaseTensorType>();
+  if (!resultType)
+    return std::nullopt;
+
+  if (libFuncKind == LibraryFunctionKind::ShapeFunction) {
+    std::optional<SmallVector<int64_t>> sizes = computeResultSizes(op);
+    if (!sizes)
+      return std::nullopt;
+    // Leave a result type that disagrees to the library.
+    if (resultType.hasSizes()) {
+      ArrayRef<int64_t> knownSizes = resultType.getSizes();
+      if (knownSizes.size() != sizes->size())
+        return std::nullopt;
+      for (auto [knownSize, size] : llvm::zip(knownSizes, *sizes)) {
+        if (knownSize != kUnknownSize && knownSize != size)
+          return std::nullopt;
+      }
+    }
+    return resultType.getWithSizesAndDtype(ArrayRef<int64_t>(*sizes),
+                                           resultType.getOptionalDtype());
+  }
+  if (libFuncKind == LibraryFunctionKind::DtypeFunction) {
+    Type dtype = computeResultDtype(op);
+    if (!dtype || (resultType.hasDtype() && resultType.getDtype() != dtype))
+      return std::nullopt;
+    return resultType.getWithSizesAndDtype(resultType.getOptionalSizes(),
+                                           dtype);
+  }
+  return std::nullopt;
+}
@@ -0,0 +1,237 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/SymbolTable.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/DecompositionCostModel.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "llvm/ADT/SetVector.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+// Returns true if `op` is copied into each stage using it rather than assigned
+// to a stage, which is the case of constants, tensor literals and lists of
+// them.
+static bool isCopiedIntoStages(Operation *op) {
+  if (isa<ValueTensorLiteralOp>(op) || op->hasTrait<OpTrait::ConstantLike>())
+    return true;
+  if (!isa<PrimListConstructOp>(op))
+    return false;
+  return llvm::all_of(op->getOperands(), [](Value operand) {
+    Operation *def = operand.getDefiningOp();
+    return def && isCopiedIntoStages(def);
+  });
+}
+
+// Adds the values defined outside of `op` that `op` or the ops nested in it
+// use to `values`.
+static void getUsedValues(Operation *op, llvm::SetVector<Value> &values) {
+  op->walk([&](Operation *nested) {
+    for (Value operand : nested->getOperands()) {
+      if (!op->isAncestor(operand.getParentBlock()->getParentOp()))
+        values.insert(operand);
+    }
+  });
+}
+
+// Copies the op defining `value`, and the ops defining its operands, with
+// `b`, unless `mapping` already has a copy of it.
+static void copyIntoStage(Value value, IRMapping &mapping, OpBuilder &b) {
+  if (mapping.contains(value))
+    return;
+  Operation *def = value.getDefiningOp();
+  for (Value operand : def->getOperands())
+    copyIntoStage(operand, mapping, b);
+  b.clone(*def, mapping);
+}
+
+namespace {
+// A pipeline stage of the function being partitioned.
+struct Stage {
+  SmallVector<Operation *> ops;
+  // The values that the stage receives, in the order of its arguments.
+  llvm::SetVector<Value> inputs;
+  // The values that the stage sends, in the order of its results.
+  llvm::SetVector<Value> outputs;
+};
+
+class PartitionPipelineStagesPass
+    : public PartitionPipelineStagesBase<PartitionPipelineStagesPass> {
+public:
+  PartitionPipelineStagesPass() = default;
+  PartitionPipelineStagesPass(int64_t numStages, double flopsPerByte) {
+    this->numStages = numStages;
+    this->flopsPerByte = flopsPerByte;
+  }
+
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    if (numStages < 1) {
+      emitError(module.getLoc()) << "the number of pipeline stages must be "
+                                    "positive";
+      return signalPassFailure();
+    }
+    RooflineCostModel costModel(flopsPerByte);
+    SymbolTable symbolTable(module);
+    SmallVector<func::FuncOp> funcs;
+    for (auto func : module.getOps<func::FuncOp>()) {
+      if (func.isPublic() && !func.isExternal() &&
+          func.getBody().hasOneBlock())
+        funcs.push_back(func);
+    }
+    for (func::FuncOp func : funcs)
+      partition(func, costModel, symbolTable);
+  }
+
+private:
+  void partition(func::FuncOp func, const RooflineCostModel &costModel,
+                 SymbolTable &symbolTable);
+};
+} // namespace
+
+void PartitionPipelineStagesPass::partition(func::FuncOp func,
+                                            const RooflineCostModel &costModel,
+                                            SymbolTable &symbolTable) {
+  Block &body = func.getBody().front();
+  SmallVector<Operation *> ops;
+  SmallVector<double> costs;
+  double totalCost = 0;
+  for (Operation &op : body.without_terminator()) {
+    if (isCopiedIntoStages(&op))
+      continue;
+    double cost = 0;
+    op.walk([&](Operation *nested) {
+      cost += costModel.getCost(nested).value_or(0);
+    });
+    ops.push_back(&op);
+    costs.push_back(cost);
+    totalCost += cost;
+  }
+  if (numStages == 1 || totalCost == 0)
+    return;
+
+  // Each op goes to the stage in which the middle of its cost falls, when the
+  // total cost is split evenly. Stages without ops are skipped.
+  SmallVector<Stage> stages;
+  DenseMap<Operation *, int64_t> stageOfOp;
+  double costBefore = 0;
+  int64_t lastStage = -1;
+  for (auto [op, cost] : llvm::zip(ops, costs)) {
+    int64_t stage = std::min<int64_t>(
+        numStages - 1,
+        static_cast<int64_t>((costBefore + cost / 2) * numStages / totalCost));
+    costBefore += cost;
+    if (stage != lastStage) {
+      stages.emplace_back();
+      lastStage = stage;
+    }
+    stages.back().ops.push_back(op);
+    stageOfOp[op] = stages.size() - 1;
+  }
+  if (stages.size() < 2)
+    return;
+
+  for (int64_t index = 0, e = stages.size(); index < e; index++) {
+    Stage &stage = stages[index];
+    for (Operation *op : stage.ops) {
+      llvm::SetVector<Value> used;
+      getUsedValues(op, used);
+      for (Value value : used) {
+        Operation *def = value.getDefiningOp();
+        if (!def ||
+            (!isCopiedIntoStages(def) && stageOfOp.lookup(def) != index))
+          stage.inputs.insert(value);
+      }
+      for (Value result : op->getResults()) {
+        for (Operation *user : result.getUsers()) {
+          Operation *ancestor = body.findAncestorOpInBlock(*user);
+          if (ancestor == body.getTerminator() ||
+              stageOfOp.lookup(ancestor) > index) {
+            stage.outputs.insert(result);
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  // Create a function for each stage, called in turn by `func`.
+  MLIRContext *context = func.getContext();
+  Location loc = func.getLoc();
+  OpBuilder callBuilder(body.getTerminator());
+  IRMapping callMapping;
+  Operation *insertAfter = func;
+  for (int64_t index = 0, e = stages.size(); index < e; index++) {
+    Stage &stage = stages[index];
+    auto stageAttr = IntegerAttr::get(IntegerType::get(context, 64), index);
+    auto type = FunctionType::get(
+        context, ValueRange(stage.inputs.getArrayRef()).getTypes(),
+        ValueRange(stage.outputs.getArrayRef()).getTypes());
+    auto stageFunc = func::FuncOp::create(
+        loc, (func.getName() + "_stage" + Twine(index)).str(), type);
+    stageFunc.setPrivate();
+    stageFunc->setAttr("torch.pipeline_stage", stageAttr);
+    symbolTable.insert(stageFunc);
+    stageFunc->moveAfter(insertAfter);
+    insertAfter = stageFunc;
+
+    Block *entry = stageFunc.addEntryBlock();
+    IRMapping mapping;
+    mapping.map(stage.inputs.getArrayRef(), entry->getArguments());
+    OpBuilder b = OpBuilder::atBlockEnd(entry);
+    for (Operation *op : stage.ops) {
+      llvm::SetVector<Value> used;
+      getUsedValues(op, used);
+      for (Value value : used) {
+        Operation *def = value.getDefiningOp();
+        if (def && isCopiedIntoStages(def))
+          copyIntoStage(value, mapping, b);
+      }
+      b.clone(*op, mapping);
+    }
+    SmallVector<Value> results;
+    for (Value output : stage.outputs)
+      results.push_back(mapping.lookup(output));
+    b.create<func::ReturnOp>(loc, results);
+
+    SmallVector<Value> operands;
+    for (Value input : stage.inputs)
+      operands.push_back(callMapping.lookupOrDefault(input));
+    auto call = callBuilder.create<func::CallOp>(loc, stageFunc, operands);
+    call->setAttr("torch.pipeline_stage", stageAttr);
+    callMapping.map(stage.outputs.getArrayRef(), call.getResults());
+  }
+  numCreatedStages += stages.size();
+
+  Operation *terminator = body.getTerminator();
+  for (OpOperand &operand : terminator->getOpOperands())
+    operand.set(callMapping.lookupOrDefault(operand.get()));
+  for (Operation *op : llvm::reverse(ops))
+    op->erase();
+  for (Operation &op :
+       llvm::make_early_inc_range(llvm::reverse(body.without_terminator()))) {
+    if (isCopiedIntoStages(&op) && op.use_empty())
+      op.erase();
+  }
+}
+
+std::unique_ptr<OperationPass<ModuleOp>>
+mlir::torch::Torch::createPartitionPipelineStagesPass(int64_t numStages,
+                                                      double flopsPerByte) {
+  return std::make_unique<PartitionPipelineStagesPass>(numStages,
+                                                       flopsPerByte);
+}
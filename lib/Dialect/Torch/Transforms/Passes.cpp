@@ -51,6 +51,9 @@ void mlir::torch::Torch::createTorchScriptModuleToTorchBackendPipeline(
   // every single module even if it doesn't have any explicit slots.
   // TODO: Support global slots in backends.
   pm.addPass(createSymbolDCEPass());
+  // Methods that call the same submodules can leave equivalent copies of
+  // their functions, which the inliner then only needs to simplify once.
+  pm.addPass(createDeduplicateFunctionsPass());
   // Currently, our shape inference is not powerful enough to deal with
   // calls, so inline everything.
   // TODO: Improve shape inference.
@@ -63,11 +66,22 @@ void mlir::torch::Torch::createTorchFunctionToTorchBackendPipeline(
     OpPassManager &pm, const TorchLoweringPipelineOptions &options) {
   // Incorporate user annotations and remove signature Python-isms.
   pm.addPass(createAdjustCallingConventionsPass());
+  // Move the weights out of the program before InlineGlobalSlots bakes them
+  // into it, so that retrained weights don't need a new compilation.
+  if (!options.externalWeightsFile.empty())
+    pm.addPass(createExternalizeWeightsPass(options.externalWeightsFile));
   // Perform the bulk of lowering to the backend contract.
   // See the pass documentation for more information.
   pm.addPass(createLowerToBackendContractPass(
       options.maxIterations, options.decompose, options.backendLegalOps,
-      options.extraLibrary));
+      options.extraLibrary, options.incremental, options.reportIterations,
+      options.mixedPrecision, options.mixedPrecisionOps,
+      options.decompositionOpEfficiencies));
+  // Let the backends see the most refined types of the backend contract.
+  pm.addNestedPass<func::FuncOp>(createEliminateTensorStaticInfoCastsPass());
+  if (options.reorderForPeakMemory)
+    pm.addNestedPass<func::FuncOp>(
+        createReorderForPeakMemoryPass(/*report=*/false));
 }
 
 // A simplification pipeline to establish the invariants of the backend
@@ -96,61 +110,107 @@ void mlir::torch::Torch::createTorchFunctionToTorchBackendPipeline(
 // together at finer granularity.
 void mlir::torch::Torch::createTorchSimplificationPipeline(
     OpPassManager &pm, const TorchLoweringPipelineOptions &options) {
+  // The canonicalizations below only involve the Torch backend IR, so they
+  // share the patterns of its ops, which are built once for the pipeline.
+  std::shared_ptr<SharedCanonicalizationPatterns> canonicalizationPatterns =
+      createSharedCanonicalizationPatterns();
+  auto addCanonicalizer = [&]() {
+    pm.addNestedPass<func::FuncOp>(
+        createCanonicalizePass(canonicalizationPatterns));
+  };
   // General cleanup.
-  pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
+  addCanonicalizer();
   // Inline global slots to expose a bunch of simplification opportunities
   // from constant hyperparameters, weights, etc.
   pm.addPass(createInlineGlobalSlotsPass());
+  // Give value semantics to the slots that are mutated in place, such as
+  // caches, so that they survive as state once the program has value
+  // semantics.
+  pm.addPass(createPromoteMutableGlobalSlotsPass());
   // Erase the module initializer if we have proven that all the global slots
   // are gone.
   pm.addPass(createEraseModuleInitializerPass());
   // Clean up again to avoid needing to to back around the fixed-point
   // iteration.
-  pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
+  addCanonicalizer();
+  // Fold inference-mode batch norms into literal weights before
+  // RecomposeComplexOps folds them into runtime computations on the weights.
+  pm.addNestedPass<func::FuncOp>(createFoldBatchNormIntoWeightsPass());
   pm.addNestedPass<func::FuncOp>(createRecomposeComplexOpsPass());
   // Reduce variants of ops to a smaller set of primitives.
   pm.addNestedPass<func::FuncOp>(
       createReduceOpVariantsPass(options.extraLibrary));
-  pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
-  // Remove dead global slots.
-  pm.addPass(createSymbolDCEPass());
+  addCanonicalizer();
   // Convert the bulk of non-ABI-visible !torch.tensor's to !torch.vtensor's.
   pm.addNestedPass<func::FuncOp>(Torch::createMaximizeValueSemanticsPass());
+  // Clean up the copies that MaximizeValueSemantics left over.
+  pm.addNestedPass<func::FuncOp>(createEliminateTensorCopiesPass());
+  // Precompute the ops on the weights, which are now value tensor literals.
+  pm.addNestedPass<func::FuncOp>(createFoldTensorLiteralsPass());
+  // Remove dead global slots. This is done after MaximizeValueSemantics (which
+  // doesn't care about global slots) so that all of the function-level passes
+  // above run as a single parallel batch over the functions, rather than
+  // being split by a module-level synchronization point.
+  pm.addPass(createSymbolDCEPass());
   // Update the return op to return value tensors.
   pm.addPass(Torch::createRefinePublicReturnPass());
-  pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
+  addCanonicalizer();
   // Do shape and dtype refinement.
   // Shape refinement should be run before dtype refinement because Torch type
   // promotion rules actually depend on the shape of the operand.
   createTorchShapeRefinementPipeline(pm, options);
   createTorchDtypeRefinementPipeline(pm, options);
+  // Lower the precision of the matmuls, convolutions and attention once their
+  // dtypes are known, and refine the dtypes again.
+  if (!options.mixedPrecision.empty()) {
+    pm.addNestedPass<func::FuncOp>(createAutoMixedPrecisionPass(
+        options.mixedPrecision, options.mixedPrecisionOps));
+    createTorchDtypeRefinementPipeline(pm, options);
+  }
+  // Fuse the projections of an input into wider GEMMs once their shapes and
+  // dtypes are known, so that their weights are compressed or quantized
+  // together.
+  if (options.fuseSiblingLinears)
+    pm.addNestedPass<func::FuncOp>(createFuseSiblingLinearsPass());
+  // Compress or quantize the literal weights of the linear ops once their
+  // dtypes are known, before they are decomposed into matmuls. The weights
+  // that are compressed are not quantized.
+  if (options.compressSparseLinearWeights)
+    pm.addNestedPass<func::FuncOp>(createCompressSparseLinearWeightsPass());
+  if (options.weightQuantizationBits != 0) {
+    pm.addNestedPass<func::FuncOp>(
+        createQuantizeLinearWeightsPass(options.weightQuantizationBits,
+                                        options.weightQuantizationGroupSize));
+  }
   // Propagate to ABI return types the shape/dtype information discovered by
   // the previous pass. Doing this is ABI-compatible for our backends.
   pm.addPass(Torch::createRefinePublicReturnPass());
-  pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
+  addCanonicalizer();
   if (options.decompose) {
     pm.addNestedPass<func::FuncOp>(
-        Torch::createDecomposeComplexOpsPass(options.backendLegalOps));
-    pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
+        Torch::createDecomposeComplexOpsPass(
+            options.backendLegalOps, options.decompositionOpEfficiencies));
+    addCanonicalizer();
   }
 }
 
 static void createRefinementPipeline(
     mlir::OpPassManager &pm,
     llvm::function_ref<
-        std::unique_ptr<mlir::OperationPass<mlir::ModuleOp>>(llvm::StringRef)>
+        std::unique_ptr<mlir::OperationPass<mlir::ModuleOp>>(llvm::StringRef,
+                                                             bool)>
         reifyCalculationsPass,
     llvm::function_ref<
         std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>()>
         simplifyCalculationsPass,
     const mlir::torch::Torch::TorchLoweringPipelineOptions &options) {
-  // Reify the library functions for each op that is present in the library.
-  pm.addPass(reifyCalculationsPass(options.extraLibrary));
+  // Reify the library functions for each op that is present in the library,
+  // unless its result type can be computed natively.
+  pm.addPass(reifyCalculationsPass(options.extraLibrary,
+                                   options.nativeAbstractInterp));
 
   // Inline the library functions to enable analysis and transformation.
-  // TODO: Only inline library functions (this will currently inline
-  // everything).
-  pm.addPass(mlir::createInlinerPass());
+  pm.addPass(mlir::torch::Torch::createInlineAbstractInterpCalculationsPass());
 
   // Now, try to simplify calculations. This is unfortunately a "optimize
   // as hard as possible" kind of thing, so it's inherently somewhat brittle.
@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/SymbolTable.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+// Returns the functions reading `slot` if it can be promoted, that is, if it
+// is only read by torch.global_slot.get ops with a non-value tensor type in
+// functions without calls, which could also access the slot.
+static std::optional<SmallVector<func::FuncOp>>
+getPromotableUsers(GlobalSlotOp slot, ModuleOp module) {
+  std::optional<SymbolTable::UseRange> uses =
+      SymbolTable::getSymbolUses(slot, module);
+  if (!uses)
+    return std::nullopt;
+  SmallVector<func::FuncOp> funcs;
+  for (const SymbolTable::SymbolUse &use : *uses) {
+    Operation *user = use.getUser();
+    if (isa<InitializeGlobalSlotsOp>(user))
+      continue;
+    auto get = dyn_cast<GlobalSlotGetOp>(user);
+    if (!get || !get.getType().isa<NonValueTensorType>())
+      return std::nullopt;
+    auto func = get->getParentOfType<func::FuncOp>();
+    if (!func)
+      return std::nullopt;
+    if (!llvm::is_contained(funcs, func))
+      funcs.push_back(func);
+  }
+  for (func::FuncOp func : funcs) {
+    if (func.walk([](func::CallOp) { return WalkResult::interrupt(); })
+            .wasInterrupted())
+      return std::nullopt;
+  }
+  return funcs;
+}
+
+// Reads `slot` once at the entry of `func`, in a non-value tensor that stands
+// for all the reads of the function, and writes the final contents of that
+// tensor back before each return.
+static void promoteSlotInFunc(GlobalSlotOp slot, func::FuncOp func,
+                              ValueTensorType valueType) {
+  OpBuilder b(func.getBody());
+  Location loc = slot.getLoc();
+  Value value = b.create<GlobalSlotGetOp>(loc, valueType, slot.getSymName());
+  Value tensor = b.create<CopyToNonValueTensorOp>(loc, value);
+
+  SmallVector<GlobalSlotGetOp> gets;
+  func.walk([&](GlobalSlotGetOp get) {
+    if (get.getSlot() == slot.getSymName() && get.getResult() != value)
+      gets.push_back(get);
+  });
+  for (GlobalSlotGetOp get : gets) {
+    Value replacement = tensor;
+    if (get.getType() != tensor.getType()) {
+      b.setInsertionPoint(get);
+      replacement =
+          b.create<TensorStaticInfoCastOp>(get.getLoc(), get.getType(), tensor);
+    }
+    get.replaceAllUsesWith(replacement);
+    get.erase();
+  }
+
+  func.walk([&](func::ReturnOp ret) {
+    b.setInsertionPoint(ret);
+    Value newValue = b.create<CopyToValueTensorOp>(loc, tensor);
+    b.create<GlobalSlotSetOp>(loc, slot.getSymName(), newValue);
+  });
+}
+
+namespace {
+class PromoteMutableGlobalSlotsPass
+    : public PromoteMutableGlobalSlotsBase<PromoteMutableGlobalSlotsPass> {
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    InitializeGlobalSlotsOp initialize;
+    for (auto initializer : module.getOps<GlobalSlotModuleInitializerOp>()) {
+      initialize =
+          cast<InitializeGlobalSlotsOp>(initializer.getBody()->getTerminator());
+    }
+    if (!initialize)
+      return;
+
+    DenseMap<StringAttr, unsigned> initialValueIndices;
+    for (auto [index, symName] :
+         llvm::enumerate(initialize.getSlotSymNames())) {
+      initialValueIndices[symName.cast<FlatSymbolRefAttr>().getAttr()] =
+          index;
+    }
+
+    OpBuilder b(initialize);
+    for (auto slot : module.getOps<GlobalSlotOp>()) {
+      if (slot.getVisibility() == SymbolTable::Visibility::Public ||
+          !slot.getTypeBound().isa<NonValueTensorType>())
+        continue;
+      auto indexIt = initialValueIndices.find(slot.getSymNameAttr());
+      if (indexIt == initialValueIndices.end())
+        continue;
+      unsigned index = indexIt->second;
+      auto literal =
+          initialize.getInitialValues()[index]
+              .getDefiningOp<NonValueTensorLiteralOp>();
+      if (!literal)
+        continue;
+      std::optional<SmallVector<func::FuncOp>> funcs =
+          getPromotableUsers(slot, module);
+      if (!funcs)
+        continue;
+
+      // The slot now holds the successive values of the tensor.
+      auto initialValue =
+          b.create<ValueTensorLiteralOp>(literal.getLoc(), literal.getValue());
+      initialize->setOperand(index, initialValue);
+      if (literal->use_empty())
+        literal.erase();
+      auto valueType = initialValue.getType().cast<ValueTensorType>();
+      slot.setTypeBound(valueType);
+      for (func::FuncOp func : *funcs)
+        promoteSlotInFunc(slot, func, valueType);
+      ++numPromotedSlots;
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>>
+mlir::torch::Torch::createPromoteMutableGlobalSlotsPass() {
+  return std::make_unique<PromoteMutableGlobalSlotsPass>();
+}
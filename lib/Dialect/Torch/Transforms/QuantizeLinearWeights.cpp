@@ -0,0 +1,185 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+namespace {
+// The quantized weight of a linear op and its scales, see
+// `torch.group_quantized.linear`.
+struct QuantizedWeight {
+  Value packedWeight;
+  Value scales;
+};
+} // namespace
+
+static double roundToSemantics(double value,
+                               const llvm::fltSemantics &semantics) {
+  APFloat rounded(value);
+  bool losesInfo;
+  rounded.convert(semantics, APFloat::rmNearestTiesToEven, &losesInfo);
+  return rounded.convertToDouble();
+}
+
+// Quantizes the [N, K] weight `attr` group-wise, with `K` a multiple of
+// `groupSize`, and creates the literals of the packed weight and the scales
+// after `literal`.
+static QuantizedWeight quantizeWeight(OpBuilder &b,
+                                      ValueTensorLiteralOp literal,
+                                      DenseFPElementsAttr attr, int64_t bits,
+                                      int64_t groupSize) {
+  auto floatType = attr.getElementType().cast<mlir::FloatType>();
+  const llvm::fltSemantics &semantics = floatType.getFloatSemantics();
+  int64_t rows = attr.getType().getDimSize(0);
+  int64_t cols = attr.getType().getDimSize(1);
+  int64_t numGroups = cols / groupSize;
+  double qmax = (1 << (bits - 1)) - 1;
+
+  SmallVector<double> weight;
+  weight.reserve(attr.getNumElements());
+  for (APFloat value : attr.getValues<APFloat>()) {
+    bool losesInfo;
+    value.convert(APFloat::IEEEdouble(), APFloat::rmNearestTiesToEven,
+                  &losesInfo);
+    weight.push_back(value.convertToDouble());
+  }
+
+  SmallVector<APFloat> scales;
+  scales.reserve(rows * numGroups);
+  SmallVector<int8_t> quantized(rows * cols);
+  for (int64_t group = 0, e = rows * numGroups; group < e; group++) {
+    ArrayRef<double> values =
+        ArrayRef<double>(weight).slice(group * groupSize, groupSize);
+    double maxAbs = 0;
+    for (double value : values)
+      maxAbs = std::max(maxAbs, std::abs(value));
+    // The weights are quantized with the scale rounded to the dtype in which
+    // they are dequantized.
+    double scale = maxAbs == 0 ? 1 : roundToSemantics(maxAbs / qmax, semantics);
+    scales.push_back(APFloat(scale));
+    bool losesInfo;
+    scales.back().convert(semantics, APFloat::rmNearestTiesToEven, &losesInfo);
+    for (int64_t i = 0; i < groupSize; i++) {
+      double q = std::round(values[i] / scale);
+      quantized[group * groupSize + i] =
+          static_cast<int8_t>(std::clamp(q, -qmax, qmax));
+    }
+  }
+
+  // Pack two 4-bit weights per byte, the even column in the low nibble.
+  SmallVector<int64_t> packedShape = {rows, cols};
+  if (bits == 4) {
+    packedShape[1] = cols / 2;
+    SmallVector<int8_t> packed(rows * cols / 2);
+    for (size_t i = 0, e = packed.size(); i < e; i++) {
+      uint8_t low = quantized[2 * i] & 0xF;
+      uint8_t high = quantized[2 * i + 1] & 0xF;
+      packed[i] = static_cast<int8_t>(low | (high << 4));
+    }
+    quantized = std::move(packed);
+  }
+
+  MLIRContext *context = b.getContext();
+  Location loc = literal.getLoc();
+  b.setInsertionPointAfter(literal);
+  auto packedType = RankedTensorType::get(
+      packedShape, IntegerType::get(context, 8, IntegerType::Signed));
+  auto scalesType = RankedTensorType::get({rows, numGroups}, floatType);
+  QuantizedWeight result;
+  result.packedWeight = b.create<ValueTensorLiteralOp>(
+      loc, DenseElementsAttr::get(packedType, ArrayRef<int8_t>(quantized)));
+  result.scales = b.create<ValueTensorLiteralOp>(
+      loc, DenseElementsAttr::get(scalesType, scales));
+  return result;
+}
+
+namespace {
+class QuantizeLinearWeightsPass
+    : public QuantizeLinearWeightsBase<QuantizeLinearWeightsPass> {
+public:
+  QuantizeLinearWeightsPass() = default;
+  QuantizeLinearWeightsPass(int64_t bits, int64_t groupSize) {
+    this->bits = bits;
+    this->groupSize = groupSize;
+  }
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+    if (bits != 4 && bits != 8) {
+      emitError(func.getLoc())
+          << "unsupported weight quantization to "
+          << static_cast<int64_t>(bits) << " bits, expected 4 or 8";
+      return signalPassFailure();
+    }
+    if (groupSize <= 0 || (bits == 4 && groupSize % 2 != 0)) {
+      emitError(func.getLoc())
+          << "the weight quantization group size must be positive, and even "
+             "for 4 bits";
+      return signalPassFailure();
+    }
+
+    // Weights shared by several linear ops are quantized once.
+    DenseMap<Operation *, QuantizedWeight> quantizedWeights;
+    SmallVector<ValueTensorLiteralOp> literals;
+    OpBuilder b(func.getContext());
+    func.walk([&](AtenLinearOp op) {
+      auto literal = op.getWeight().getDefiningOp<ValueTensorLiteralOp>();
+      auto attr = literal ? literal.getValue().dyn_cast<DenseFPElementsAttr>()
+                          : nullptr;
+      auto resultType = op.getType().dyn_cast<ValueTensorType>();
+      if (!attr || !resultType || !resultType.hasDtype() ||
+          resultType.getDtype() != attr.getElementType() ||
+          attr.getType().getRank() != 2 ||
+          attr.getType().getDimSize(1) % groupSize != 0)
+        return;
+
+      auto it = quantizedWeights.find(literal);
+      if (it == quantizedWeights.end()) {
+        it = quantizedWeights
+                 .try_emplace(literal, quantizeWeight(b, literal, attr, bits,
+                                                      groupSize))
+                 .first;
+        literals.push_back(literal);
+        ++numQuantizedWeights;
+      }
+      b.setInsertionPoint(op);
+      Location loc = op.getLoc();
+      Value bitsValue =
+          b.create<ConstantIntOp>(loc, b.getI64IntegerAttr(bits));
+      Value groupSizeValue =
+          b.create<ConstantIntOp>(loc, b.getI64IntegerAttr(groupSize));
+      Value result = b.create<GroupQuantizedLinearOp>(
+          loc, resultType, op.getInput(), it->second.packedWeight,
+          it->second.scales, bitsValue, groupSizeValue, op.getBias());
+      op.replaceAllUsesWith(result);
+      op.erase();
+    });
+    for (ValueTensorLiteralOp literal : literals) {
+      if (literal->use_empty())
+        literal.erase();
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::Torch::createQuantizeLinearWeightsPass(int64_t bits,
+                                                    int64_t groupSize) {
+  return std::make_unique<QuantizeLinearWeightsPass>(bits, groupSize);
+}
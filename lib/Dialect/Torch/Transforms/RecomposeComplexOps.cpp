@@ -12,13 +12,80 @@
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/TorchUpstream.h"
 #include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+#include "llvm/ADT/SmallBitVector.h"
 
 using namespace mlir;
 using namespace mlir::torch;
 using namespace mlir::torch::Torch;
 
 namespace {
+// Recomposes the copy of `src` into a slice of `self` into
+//
+//   %scatter = aten.slice_scatter %self, %src, %dim, %start, %end, %step
+//   torch.overwrite.tensor.contents %scatter overwrites %self
+//
+// The slice_scatter lowers to a tensor.insert_slice into `self`, which
+// bufferizes into an in-place update of the slice when `self` isn't otherwise
+// used, rather than a copy of all of `self`. This is what makes updates of a
+// few rows of a large buffer, such as a KV cache, proportional to the size of
+// the update. The bounds of the slice don't need to be constants.
+//
+// Copies whose result is used are left to `RecomposeSliceCopy_`.
+class RecomposeSliceCopy_ToSliceScatter
+    : public OpRewritePattern<AtenCopy_Op> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(AtenCopy_Op op,
+                                PatternRewriter &rewriter) const override {
+    auto sliceOp = op.getSelf().getDefiningOp<AtenSliceTensorOp>();
+    if (!sliceOp)
+      return rewriter.notifyMatchFailure(op, "self is not a slice");
+    // The slice is only read before `self` is overwritten, which keeps the
+    // aliasing simple enough for MaximizeValueSemantics.
+    if (!op->use_empty())
+      return rewriter.notifyMatchFailure(op, "the result of copy_ is used");
+    bool nonBlocking;
+    if (!matchPattern(op.getNonBlocking(), m_TorchConstantBool(&nonBlocking)) ||
+        nonBlocking)
+      return rewriter.notifyMatchFailure(op,
+                                         "non_blocking must be constant false");
+    Value self = sliceOp.getSelf();
+    auto selfType = self.getType().dyn_cast<NonValueTensorType>();
+    auto sliceType = sliceOp.getType().dyn_cast<NonValueTensorType>();
+    if (!selfType || !sliceType)
+      return rewriter.notifyMatchFailure(
+          op, "expected a slice of a non-value tensor");
+
+    // `copy_` converts `src` to the dtype of `self` and broadcasts it to the
+    // shape of the slice, while `slice_scatter` expects it to already have
+    // them.
+    Location loc = op.getLoc();
+    Value src = op.getSrc();
+    if (src.getType() != sliceType) {
+      Value dtype = rewriter.create<PrimDtypeOp>(
+          loc, Torch::IntType::get(op->getContext()), self);
+      Value falseVal = rewriter.create<ConstantBoolOp>(loc, false);
+      Value noneVal = rewriter.create<ConstantNoneOp>(loc);
+      src = rewriter.create<AtenToDtypeOp>(
+          loc,
+          NonValueTensorType::getWithLeastStaticInformation(op->getContext()),
+          src, dtype, /*non_blocking=*/falseVal, /*copy=*/falseVal,
+          /*memory_format=*/noneVal);
+      src = rewriter.create<AtenExpandAsOp>(loc, sliceType, src, sliceOp);
+    }
+
+    Value scatter = rewriter.create<AtenSliceScatterOp>(
+        loc, selfType, self, src, sliceOp.getDim(), sliceOp.getStart(),
+        sliceOp.getEnd(), sliceOp.getStep());
+    Value scatterValue = rewriter.create<CopyToValueTensorOp>(loc, scatter);
+    rewriter.create<OverwriteTensorContentsOp>(loc, scatterValue, self);
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 class RecomposeSliceCopy_ : public OpRewritePattern<AtenCopy_Op> {
 public:
   using OpRewritePattern::OpRewritePattern;
@@ -279,6 +346,604 @@ public:
     return success();
   }
 };
+
+// Folds an inference-mode `aten.batch_norm` into the convolution that produces
+// its input, by scaling the weight and bias of the convolution per output
+// channel:
+//   scale = bn_weight * rsqrt(running_var + eps)
+//   conv_weight' = conv_weight * scale (broadcast along dim 0)
+//   conv_bias' = (conv_bias - running_mean) * scale + bn_bias
+// The new weight and bias only depend on parameters, so this removes a full
+// pass over the activations.
+template <typename ConvOpTy>
+class RecomposeConvolutionBatchNorm : public OpRewritePattern<AtenBatchNormOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(AtenBatchNormOp op,
+                                PatternRewriter &rewriter) const override {
+    auto conv = op.getInput().getDefiningOp<ConvOpTy>();
+    if (!conv)
+      return rewriter.notifyMatchFailure(op, "input is not a convolution");
+    if (!conv->hasOneUse() || conv.getType() != op.getType())
+      return rewriter.notifyMatchFailure(
+          op, "convolution result must only be used by the batch_norm");
+    if constexpr (std::is_same_v<ConvOpTy, AtenConvolutionOp>) {
+      bool transposed;
+      if (!matchPattern(conv.getTransposed(),
+                        m_TorchConstantBool(&transposed)) ||
+          transposed)
+        return rewriter.notifyMatchFailure(
+            op, "transposed convolutions are not supported");
+    }
+    bool training;
+    if (!matchPattern(op.getTraining(), m_TorchConstantBool(&training)) ||
+        training)
+      return rewriter.notifyMatchFailure(op, "expected inference mode");
+    Value runningMean = op.getRunningMean();
+    Value runningVar = op.getRunningVar();
+    if (runningMean.getType().isa<Torch::NoneType>() ||
+        runningVar.getType().isa<Torch::NoneType>())
+      return rewriter.notifyMatchFailure(
+          op, "running stats must not be None in inference mode");
+
+    // All the new ops must dominate the convolution.
+    rewriter.setInsertionPoint(conv);
+    Location loc = op.getLoc();
+    Value convWeight = conv.getWeight();
+    Value convBias = conv.getBias();
+    Type statsType = runningVar.getType();
+    auto weightType = convWeight.getType().template cast<BaseTensorType>();
+    Type transposedWeightType = weightType.getWithSizesAndDtype(
+        std::nullopt, weightType.getOptionalDtype());
+    Value one =
+        rewriter.create<ConstantIntOp>(loc, rewriter.getI64IntegerAttr(1));
+
+    Value varEps = rewriter.create<AtenAddScalarOp>(loc, statsType, runningVar,
+                                                    op.getEps(), /*alpha=*/one);
+    Value scale = rewriter.create<AtenRsqrtOp>(loc, statsType, varEps);
+    if (!op.getWeight().getType().isa<Torch::NoneType>())
+      scale = rewriter.create<AtenMulTensorOp>(loc, statsType, scale,
+                                               op.getWeight());
+
+    // Broadcast the scale along the output channels without knowing the rank
+    // of the weight, by moving them to the innermost dim and back.
+    Value zero =
+        rewriter.create<ConstantIntOp>(loc, rewriter.getI64IntegerAttr(0));
+    Value minusOne =
+        rewriter.create<ConstantIntOp>(loc, rewriter.getI64IntegerAttr(-1));
+    Value newWeight = rewriter.create<AtenTransposeIntOp>(
+        loc, transposedWeightType, convWeight, zero, minusOne);
+    newWeight = rewriter.create<AtenMulTensorOp>(loc, transposedWeightType,
+                                                 newWeight, scale);
+    newWeight = rewriter.create<AtenTransposeIntOp>(loc, weightType, newWeight,
+                                                    zero, minusOne);
+
+    Value newBias;
+    if (convBias.getType().isa<Torch::NoneType>()) {
+      Value negMean =
+          rewriter.create<AtenNegOp>(loc, runningMean.getType(), runningMean);
+      newBias =
+          rewriter.create<AtenMulTensorOp>(loc, statsType, negMean, scale);
+    } else {
+      Value centeredBias = rewriter.create<AtenSubTensorOp>(
+          loc, statsType, convBias, runningMean, /*alpha=*/one);
+      newBias =
+          rewriter.create<AtenMulTensorOp>(loc, statsType, centeredBias, scale);
+    }
+    if (!op.getBias().getType().isa<Torch::NoneType>())
+      newBias = rewriter.create<AtenAddTensorOp>(loc, statsType, newBias,
+                                                 op.getBias(), /*alpha=*/one);
+
+    rewriter.updateRootInPlace(conv, [&]() {
+      conv.getWeightMutable().assign(newWeight);
+      conv.getBiasMutable().assign(newBias);
+    });
+    rewriter.replaceOp(op, conv.getResult());
+    return success();
+  }
+};
+} // namespace
+
+// Returns true if `value` is a constant int or float within a relative
+// tolerance of `expected`, which the constants of decompositions, such as
+// 1/sqrt(2), are printed with.
+static bool isConstantNear(Value value, double expected) {
+  double floatValue;
+  if (matchPattern(value, m_TorchConstantFloat(&floatValue)))
+    return std::abs(floatValue - expected) <= 1e-6 * std::abs(expected);
+  int64_t intValue;
+  return matchPattern(value, m_TorchConstantInt(&intValue)) &&
+         intValue == expected;
+}
+
+// Returns the op of type `OpTy` defining `value` if `value` has no other use.
+template <typename OpTy> static OpTy getSingleUseDefiningOp(Value value) {
+  auto op = value.getDefiningOp<OpTy>();
+  if (!op || !value.hasOneUse())
+    return nullptr;
+  return op;
+}
+
+// Returns `x` if `value` is `1 + erf(x / sqrt(2))`, with the division written
+// as either a division or a multiplication.
+static Value matchOnePlusErfOfScaledInput(Value value) {
+  auto addOne = getSingleUseDefiningOp<AtenAddScalarOp>(value);
+  if (!addOne || !isConstantNear(addOne.getOther(), 1.0) ||
+      !isConstantNear(addOne.getAlpha(), 1.0))
+    return nullptr;
+  auto erf = getSingleUseDefiningOp<AtenErfOp>(addOne.getSelf());
+  if (!erf)
+    return nullptr;
+  Value scaled = erf.getSelf();
+  if (auto mul = getSingleUseDefiningOp<AtenMulScalarOp>(scaled)) {
+    if (isConstantNear(mul.getOther(), std::sqrt(0.5)))
+      return mul.getSelf();
+  } else if (auto div = getSingleUseDefiningOp<AtenDivScalarOp>(scaled)) {
+    if (isConstantNear(div.getOther(), std::sqrt(2.0)))
+      return div.getSelf();
+  }
+  return nullptr;
+}
+
+namespace {
+// Recomposes the exact (erf) form of `aten.gelu`, as decomposed by AOT
+// autograd, either
+//   x * (0.5 * (1 + erf(x / sqrt(2))))
+// or
+//   (x * 0.5) * (1 + erf(x / sqrt(2)))
+// with the operands of the outer multiplication in either order.
+class RecomposeGelu : public OpRewritePattern<AtenMulTensorOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(AtenMulTensorOp op,
+                                PatternRewriter &rewriter) const override {
+    auto matchOperands = [](Value lhs, Value rhs) -> Value {
+      // x * (0.5 * (1 + erf(x / sqrt(2))))
+      if (auto half = getSingleUseDefiningOp<AtenMulScalarOp>(rhs)) {
+        if (isConstantNear(half.getOther(), 0.5) &&
+            matchOnePlusErfOfScaledInput(half.getSelf()) == lhs)
+          return lhs;
+      }
+      // (x * 0.5) * (1 + erf(x / sqrt(2)))
+      if (auto half = getSingleUseDefiningOp<AtenMulScalarOp>(lhs)) {
+        if (isConstantNear(half.getOther(), 0.5) &&
+            matchOnePlusErfOfScaledInput(rhs) == half.getSelf())
+          return half.getSelf();
+      }
+      return nullptr;
+    };
+    Value input = matchOperands(op.getSelf(), op.getOther());
+    if (!input)
+      input = matchOperands(op.getOther(), op.getSelf());
+    if (!input)
+      return rewriter.notifyMatchFailure(op, "not a decomposed gelu");
+    if (input.getType() != op.getType())
+      return rewriter.notifyMatchFailure(
+          op, "the multiplication broadcasts or promotes its input");
+
+    Value approximate = rewriter.create<ConstantStrOp>(op.getLoc(), "none");
+    rewriter.replaceOpWithNewOp<AtenGeluOp>(op, op.getType(), input,
+                                            approximate);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Recomposes `aten.native_layer_norm` from the ops AOT autograd decomposes it
+// into:
+//
+//   %var, %mean = aten.var_mean.correction %x, [dims], 0, true
+//   %rstd = aten.rsqrt (aten.add.Scalar %var, %eps)
+//   %out = aten.mul.Tensor (aten.sub.Tensor %x, %mean), %rstd
+//   %out = aten.mul.Tensor %out, %weight (optional)
+//   %out = aten.add.Tensor %out, %bias (optional)
+//
+// where `dims` are the innermost dims of `x`, which must be static. `%mean`
+// and `%rstd` may have other uses, such as by the backward pass, which then
+// use the results of the native_layer_norm instead.
+class RecomposeLayerNorm : public OpRewritePattern<AtenVarMeanCorrectionOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(AtenVarMeanCorrectionOp op,
+                                PatternRewriter &rewriter) const override {
+    Value input = op.getSelf();
+    auto inputType = input.getType().cast<BaseTensorType>();
+    if (!inputType.hasSizes())
+      return rewriter.notifyMatchFailure(op, "input must have known sizes");
+    ArrayRef<int64_t> inputSizes = inputType.getSizes();
+    int64_t rank = inputSizes.size();
+
+    int64_t correction;
+    bool keepDim;
+    if (!matchPattern(op.getCorrection(), m_TorchConstantInt(&correction)) ||
+        correction != 0 ||
+        !matchPattern(op.getKeepdim(), m_TorchConstantBool(&keepDim)) ||
+        !keepDim)
+      return rewriter.notifyMatchFailure(
+          op, "expected a biased variance keeping the dims");
+    SmallVector<Value> dimValues;
+    if (!getListConstructElements(op.getDim(), dimValues) ||
+        dimValues.empty())
+      return rewriter.notifyMatchFailure(op, "expected a list of dims");
+    llvm::SmallBitVector isReduced(rank);
+    for (Value dimValue : dimValues) {
+      int64_t dim;
+      if (!matchPattern(dimValue, m_TorchConstantInt(&dim)))
+        return rewriter.notifyMatchFailure(op, "dims must be constants");
+      dim = toPositiveDim(dim, rank);
+      if (!isValidDim(dim, rank))
+        return rewriter.notifyMatchFailure(op, "invalid dim");
+      isReduced.set(dim);
+    }
+    int64_t numReduced = isReduced.count();
+    if (isReduced.find_first() != rank - numReduced)
+      return rewriter.notifyMatchFailure(op, "must reduce the innermost dims");
+    ArrayRef<int64_t> normalizedShape = inputSizes.take_back(numReduced);
+    if (llvm::is_contained(normalizedShape, kUnknownSize))
+      return rewriter.notifyMatchFailure(op, "normalized dims must be static");
+
+    Value var = op.getResult(0);
+    Value mean = op.getResult(1);
+    auto addEps = var.hasOneUse()
+                      ? dyn_cast<AtenAddScalarOp>(*var.getUsers().begin())
+                      : nullptr;
+    if (!addEps || addEps.getSelf() != var ||
+        !addEps.getResult().hasOneUse() ||
+        !isConstantNear(addEps.getAlpha(), 1.0))
+      return rewriter.notifyMatchFailure(op, "variance must only add eps");
+    double eps;
+    if (!matchPattern(addEps.getOther(), m_TorchConstantFloat(&eps)))
+      return rewriter.notifyMatchFailure(op, "eps must be a constant float");
+    auto rsqrt = dyn_cast<AtenRsqrtOp>(*addEps->getUsers().begin());
+    if (!rsqrt)
+      return rewriter.notifyMatchFailure(op, "expected rsqrt(var + eps)");
+    Value rstd = rsqrt.getResult();
+
+    AtenSubTensorOp centered;
+    for (Operation *user : mean.getUsers()) {
+      auto sub = dyn_cast<AtenSubTensorOp>(user);
+      if (sub && sub.getSelf() == input && sub.getOther() == mean &&
+          isConstantNear(sub.getAlpha(), 1.0) &&
+          sub.getResult().hasOneUse()) {
+        centered = sub;
+        break;
+      }
+    }
+    if (!centered)
+      return rewriter.notifyMatchFailure(op, "expected x - mean");
+    auto normalized =
+        dyn_cast<AtenMulTensorOp>(*centered->getUsers().begin());
+    if (!normalized ||
+        !llvm::is_contained(normalized->getOperands(), rstd))
+      return rewriter.notifyMatchFailure(op, "expected (x - mean) * rstd");
+
+    // Returns the other operand of `user` if it is an affine parameter of the
+    // normalized shape.
+    auto getParameter = [&](Operation *user, Value operand) -> Value {
+      Value parameter = user->getOperand(0) == operand ? user->getOperand(1)
+                                                       : user->getOperand(0);
+      auto parameterType = parameter.getType().dyn_cast<BaseTensorType>();
+      if (!parameterType || !parameterType.hasSizes() ||
+          parameterType.getSizes() != normalizedShape)
+        return nullptr;
+      return parameter;
+    };
+    SmallVector<Operation *> chain = {centered, normalized};
+    Value result = normalized.getResult();
+    Value weight, bias;
+    if (result.hasOneUse()) {
+      if (auto mul = dyn_cast<AtenMulTensorOp>(*result.getUsers().begin())) {
+        if ((weight = getParameter(mul, result))) {
+          chain.push_back(mul);
+          result = mul.getResult();
+        }
+      }
+    }
+    if (result.hasOneUse()) {
+      if (auto add = dyn_cast<AtenAddTensorOp>(*result.getUsers().begin())) {
+        if (add.getSelf() == result && isConstantNear(add.getAlpha(), 1.0) &&
+            (bias = getParameter(add, result))) {
+          chain.push_back(add);
+          result = add.getResult();
+        }
+      }
+    }
+    Operation *root = chain.back();
+    for (Value stat : {mean, rstd}) {
+      for (Operation *user : stat.getUsers()) {
+        if (llvm::is_contained(chain, user))
+          continue;
+        if (user->getBlock() != root->getBlock() ||
+            !root->isBeforeInBlock(user))
+          return rewriter.notifyMatchFailure(
+              op, "the statistics are used before the normalization");
+      }
+    }
+
+    rewriter.setInsertionPoint(root);
+    Location loc = op.getLoc();
+    SmallVector<Value> normalizedShapeValues;
+    for (int64_t size : normalizedShape)
+      normalizedShapeValues.push_back(rewriter.create<ConstantIntOp>(
+          loc, rewriter.getI64IntegerAttr(size)));
+    Value normalizedShapeList = rewriter.create<PrimListConstructOp>(
+        loc, Torch::ListType::get(Torch::IntType::get(op.getContext())),
+        normalizedShapeValues);
+    Value none = rewriter.create<ConstantNoneOp>(loc);
+    auto layerNorm = rewriter.create<AtenNativeLayerNormOp>(
+        loc, TypeRange{result.getType(), mean.getType(), rstd.getType()},
+        input, normalizedShapeList, weight ? weight : none,
+        bias ? bias : none, addEps.getOther());
+
+    rewriter.replaceOp(root, layerNorm.getResult(0));
+    for (Operation *chainOp :
+         llvm::reverse(ArrayRef<Operation *>(chain).drop_back()))
+      rewriter.eraseOp(chainOp);
+    rewriter.replaceOp(rsqrt, layerNorm.getResult(2));
+    rewriter.eraseOp(addEps);
+    for (OpOperand &use : llvm::make_early_inc_range(mean.getUses()))
+      rewriter.updateRootInPlace(use.getOwner(),
+                                 [&]() { use.set(layerNorm.getResult(1)); });
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Recomposes `aten.scaled_dot_product_attention` from
+//
+//   softmax(matmul(q, transpose(k, -2, -1)) * scale, -1) @ v
+//
+// where the scaling is a multiplication or division by a constant, or is
+// missing, and the matmuls are either `aten.matmul` or `aten.bmm`. The
+// attention is recomposed without a mask or dropout.
+template <typename MatmulOpTy>
+class RecomposeScaledDotProductAttention
+    : public OpRewritePattern<MatmulOpTy> {
+public:
+  using OpRewritePattern<MatmulOpTy>::OpRewritePattern;
+  LogicalResult matchAndRewrite(MatmulOpTy op,
+                                PatternRewriter &rewriter) const override {
+    Value probs = op->getOperand(0);
+    Value value = op->getOperand(1);
+    std::optional<unsigned> maybeRank = getTensorRank(value);
+    if (!maybeRank || *maybeRank < 2)
+      return rewriter.notifyMatchFailure(op, "value must be ranked");
+    int64_t rank = *maybeRank;
+
+    Value scores;
+    Value softmaxDim;
+    if (auto softmax = getSingleUseDefiningOp<AtenSoftmaxIntOp>(probs)) {
+      if (!softmax.getDtype().getType().isa<Torch::NoneType>())
+        return rewriter.notifyMatchFailure(op, "softmax casts its input");
+      scores = softmax.getSelf();
+      softmaxDim = softmax.getDim();
+    } else if (auto softmax = getSingleUseDefiningOp<Aten_SoftmaxOp>(probs)) {
+      bool halfToFloat;
+      if (!matchPattern(softmax.getHalfToFloat(),
+                        m_TorchConstantBool(&halfToFloat)) ||
+          halfToFloat)
+        return rewriter.notifyMatchFailure(op, "softmax casts its input");
+      scores = softmax.getSelf();
+      softmaxDim = softmax.getDim();
+    } else {
+      return rewriter.notifyMatchFailure(op, "not a matmul of a softmax");
+    }
+    int64_t dim;
+    if (!matchPattern(softmaxDim, m_TorchConstantInt(&dim)) ||
+        toPositiveDim(dim, rank) != rank - 1)
+      return rewriter.notifyMatchFailure(
+          op, "softmax must be over the innermost dim");
+
+    double scale = 1.0;
+    if (auto mul = getSingleUseDefiningOp<AtenMulScalarOp>(scores)) {
+      if (!matchPattern(mul.getOther(), m_TorchConstantFloat(&scale)))
+        return rewriter.notifyMatchFailure(op, "scale must be a constant");
+      scores = mul.getSelf();
+    } else if (auto div = getSingleUseDefiningOp<AtenDivScalarOp>(scores)) {
+      double divisor;
+      if (!matchPattern(div.getOther(), m_TorchConstantFloat(&divisor)) ||
+          divisor == 0.0)
+        return rewriter.notifyMatchFailure(op, "scale must be a constant");
+      scale = 1.0 / divisor;
+      scores = div.getSelf();
+    }
+
+    auto qk = getSingleUseDefiningOp<MatmulOpTy>(scores);
+    if (!qk)
+      return rewriter.notifyMatchFailure(op, "expected matmul(q, k^T)");
+    auto keyTransposed =
+        getSingleUseDefiningOp<AtenTransposeIntOp>(qk->getOperand(1));
+    if (!keyTransposed)
+      return rewriter.notifyMatchFailure(op, "expected k to be transposed");
+    int64_t dim0, dim1;
+    if (!matchPattern(keyTransposed.getDim0(), m_TorchConstantInt(&dim0)) ||
+        !matchPattern(keyTransposed.getDim1(), m_TorchConstantInt(&dim1)))
+      return rewriter.notifyMatchFailure(op, "transpose dims must be constant");
+    dim0 = toPositiveDim(dim0, rank);
+    dim1 = toPositiveDim(dim1, rank);
+    if (std::min(dim0, dim1) != rank - 2 || std::max(dim0, dim1) != rank - 1)
+      return rewriter.notifyMatchFailure(
+          op, "k must be transposed in its innermost dims");
+    Value query = qk->getOperand(0);
+    Value key = keyTransposed.getSelf();
+    if (getTensorRank(query) != maybeRank ||
+        getTensorRank(key) != maybeRank)
+      return rewriter.notifyMatchFailure(
+          op, "q, k and v must have the same rank");
+
+    Location loc = op.getLoc();
+    Value none = rewriter.create<ConstantNoneOp>(loc);
+    Value dropout =
+        rewriter.create<ConstantFloatOp>(loc, rewriter.getF64FloatAttr(0.0));
+    Value isCausal = rewriter.create<ConstantBoolOp>(loc, false);
+    Value scaleValue =
+        rewriter.create<ConstantFloatOp>(loc, rewriter.getF64FloatAttr(scale));
+    rewriter.replaceOpWithNewOp<AtenScaledDotProductAttentionOp>(
+        op, op.getType(), query, key, value, /*attn_mask=*/none, dropout,
+        isCausal, scaleValue);
+    return success();
+  }
+};
+} // namespace
+
+static bool castsInput(AtenLogSoftmaxIntOp op) {
+  return !op.getDtype().getType().isa<Torch::NoneType>();
+}
+
+static bool castsInput(Aten_LogSoftmaxOp op) {
+  bool halfToFloat;
+  return !matchPattern(op.getHalfToFloat(),
+                       m_TorchConstantBool(&halfToFloat)) ||
+         halfToFloat;
+}
+
+namespace {
+// Recomposes the cross entropy losses of the logits `x` whose log-softmax is
+// only used by negative log likelihood losses and their gradients:
+//
+//   %logp = aten._log_softmax %x, 1, false
+//   %loss, %total_weight = aten.nll_loss_forward %logp, %target, None, ...
+//   %grad_logp = aten.nll_loss_backward %grad, %logp, %target, None, ...
+//   %grad_x = aten._log_softmax_backward_data %grad_logp, %logp, 1, ...
+//
+// The losses become `aten.cross_entropy_loss %x, %target, ...`, and their
+// total weights count the targets that aren't `ignore_index`. The rows of
+// `%grad_logp` sum to minus its values at the targets, so the gradient of the
+// logits becomes
+//
+//   %grad_logp + softmax(%x, 1) * unsqueeze(%g * (%target != ignore_index), 1)
+//
+// where `%g` is `%grad`, divided by the total weight for a mean reduction.
+// nll_loss_backward only takes its shape from its `self` operand, which
+// becomes `%x`. Nothing reads the log-probabilities anymore, so neither the
+// loss nor its gradient materializes them, and they are as large as the
+// logits.
+template <typename LogSoftmaxOpTy>
+class RecomposeCrossEntropyLoss : public OpRewritePattern<LogSoftmaxOpTy> {
+public:
+  using OpRewritePattern<LogSoftmaxOpTy>::OpRewritePattern;
+  LogicalResult matchAndRewrite(LogSoftmaxOpTy op,
+                                PatternRewriter &rewriter) const override {
+    if (castsInput(op))
+      return rewriter.notifyMatchFailure(op, "log_softmax casts its input");
+    // The losses take 1-d or 2-d inputs, so a log-softmax along dim 1 is over
+    // the classes of 2-d logits.
+    Value logits = op.getSelf();
+    bool isRank2 = getTensorRank(logits) == 2;
+    auto isClassDim = [&](Value dimValue) {
+      int64_t dim;
+      return matchPattern(dimValue, m_TorchConstantInt(&dim)) &&
+             (dim == 1 || (dim == -1 && isRank2));
+    };
+    if (!isClassDim(op.getDim()))
+      return rewriter.notifyMatchFailure(
+          op, "log_softmax must be along the classes of 2-d logits");
+
+    Value logProbs = op.getResult();
+    SmallVector<AtenNllLossForwardOp> losses;
+    SmallVector<AtenNllLossBackwardOp> lossGrads;
+    SmallVector<Aten_LogSoftmaxBackwardDataOp> logitGrads;
+    for (Operation *user : logProbs.getUsers()) {
+      if (auto loss = dyn_cast<AtenNllLossForwardOp>(user)) {
+        if (loss.getSelf() != logProbs ||
+            !loss.getWeight().getType().isa<Torch::NoneType>())
+          return rewriter.notifyMatchFailure(
+              op, "expected an unweighted nll_loss_forward of the log-softmax");
+        losses.push_back(loss);
+      } else if (auto lossGrad = dyn_cast<AtenNllLossBackwardOp>(user)) {
+        if (lossGrad.getSelf() != logProbs ||
+            lossGrad.getGradOutput() == logProbs ||
+            !lossGrad.getWeight().getType().isa<Torch::NoneType>())
+          return rewriter.notifyMatchFailure(
+              op,
+              "expected an unweighted nll_loss_backward of the log-softmax");
+        lossGrads.push_back(lossGrad);
+      } else if (auto logitGrad =
+                     dyn_cast<Aten_LogSoftmaxBackwardDataOp>(user)) {
+        auto lossGrad =
+            logitGrad.getGradOutput().getDefiningOp<AtenNllLossBackwardOp>();
+        int64_t reduction;
+        if (logitGrad.getOutput() != logProbs || !lossGrad ||
+            lossGrad.getSelf() != logProbs ||
+            !isClassDim(logitGrad.getDim()) ||
+            !matchPattern(lossGrad.getReduction(),
+                          m_TorchConstantInt(&reduction)))
+          return rewriter.notifyMatchFailure(
+              op, "expected the log-softmax gradient of a nll_loss_backward");
+        logitGrads.push_back(logitGrad);
+      } else {
+        return rewriter.notifyMatchFailure(
+            op, "the log-softmax is used by other ops than the losses");
+      }
+    }
+    if (losses.empty())
+      return rewriter.notifyMatchFailure(op, "the log-softmax has no loss");
+
+    Location loc = op.getLoc();
+    MLIRContext *context = op.getContext();
+    Value none = rewriter.create<ConstantNoneOp>(loc);
+    Value cstOne =
+        rewriter.create<ConstantIntOp>(loc, rewriter.getI64IntegerAttr(1));
+    Value noLabelSmoothing =
+        rewriter.create<ConstantFloatOp>(loc, rewriter.getF64FloatAttr(0.0));
+    Value dtype =
+        rewriter.create<PrimDtypeOp>(loc, Torch::IntType::get(context), logits);
+    auto getUnrefinedType = [](Value value) {
+      return value.getType().cast<BaseTensorType>().getWithSizesAndDtype(
+          std::nullopt, Type());
+    };
+    auto createNotIgnored = [&](Value target, Value ignoreIndex) {
+      return rewriter.create<AtenNeScalarOp>(loc, getUnrefinedType(target),
+                                             target, ignoreIndex);
+    };
+
+    for (AtenNllLossForwardOp loss : losses) {
+      rewriter.setInsertionPoint(loss);
+      Value crossEntropy = rewriter.create<AtenCrossEntropyLossOp>(
+          loc, loss.getResult(0).getType(), logits, loss.getTarget(),
+          /*weight=*/none, loss.getReduction(), loss.getIgnoreIndex(),
+          noLabelSmoothing);
+      Value totalWeight = rewriter.create<AtenSumOp>(
+          loc, loss.getResult(1).getType(),
+          createNotIgnored(loss.getTarget(), loss.getIgnoreIndex()), dtype);
+      rewriter.replaceOp(loss, {crossEntropy, totalWeight});
+    }
+
+    for (Aten_LogSoftmaxBackwardDataOp logitGrad : logitGrads) {
+      rewriter.setInsertionPoint(logitGrad);
+      auto lossGrad =
+          logitGrad.getGradOutput().getDefiningOp<AtenNllLossBackwardOp>();
+      int64_t reduction;
+      matchPattern(lossGrad.getReduction(), m_TorchConstantInt(&reduction));
+      Value rowGrad = lossGrad.getGradOutput();
+      if (reduction == torch_upstream::Reduction::Mean)
+        rowGrad = rewriter.create<AtenDivTensorOp>(
+            loc, getUnrefinedType(rowGrad), rowGrad, lossGrad.getTotalWeight());
+      rowGrad = rewriter.create<AtenMulTensorOp>(
+          loc, getUnrefinedType(rowGrad), rowGrad,
+          createNotIgnored(lossGrad.getTarget(), lossGrad.getIgnoreIndex()));
+      rowGrad = rewriter.create<AtenUnsqueezeOp>(
+          loc, getUnrefinedType(rowGrad), rowGrad, cstOne);
+      Value probs = rewriter.create<AtenSoftmaxIntOp>(
+          loc, getUnrefinedType(logits), logits, op.getDim(), none);
+      Value scaledProbs = rewriter.create<AtenMulTensorOp>(
+          loc, getUnrefinedType(probs), probs, rowGrad);
+      rewriter.replaceOpWithNewOp<AtenAddTensorOp>(
+          logitGrad, logitGrad.getType(), logitGrad.getGradOutput(),
+          scaledProbs, /*alpha=*/cstOne);
+    }
+
+    for (AtenNllLossBackwardOp lossGrad : lossGrads) {
+      rewriter.updateRootInPlace(
+          lossGrad, [&]() { lossGrad.getSelfMutable().assign(logits); });
+    }
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
 } // namespace
 
 namespace {
@@ -290,12 +955,21 @@ public:
     RewritePatternSet patterns(context);
 
     // pattern.add calls go here
+    patterns.add<RecomposeSliceCopy_ToSliceScatter>(context, /*benefit=*/2);
     patterns.add<RecomposeSliceCopy_>(context);
     patterns.add<RecomposeSelectFill_>(context);
     patterns.add<RecomposeSplitTensorGetItemOp>(context);
     patterns.add<RecomposeUnbindListUnpack>(context);
     patterns.add<RecomposeUnbindGetItem>(context);
     patterns.add<RecomposeChunkListUnpack>(context);
+    patterns.add<RecomposeConvolutionBatchNorm<AtenConvolutionOp>>(context);
+    patterns.add<RecomposeConvolutionBatchNorm<AtenConv2dOp>>(context);
+    patterns.add<RecomposeGelu>(context);
+    patterns.add<RecomposeLayerNorm>(context);
+    patterns.add<RecomposeScaledDotProductAttention<AtenMatmulOp>>(context);
+    patterns.add<RecomposeScaledDotProductAttention<AtenBmmOp>>(context);
+    patterns.add<RecomposeCrossEntropyLoss<AtenLogSoftmaxIntOp>>(context);
+    patterns.add<RecomposeCrossEntropyLoss<Aten_LogSoftmaxOp>>(context);
 
     GreedyRewriteConfig config;
     config.useTopDownTraversal = true;
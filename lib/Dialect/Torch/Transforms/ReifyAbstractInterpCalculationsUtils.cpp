@@ -8,8 +8,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "ReifyAbstractInterpCalculationsUtils.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Parser/Parser.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Sequence.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -66,7 +72,7 @@ createCalculateYieldCalculationOp(OpBuilder &b, Location loc,
 }
 
 LogicalResult Torch::wrapWithCalculateOpIfLibraryFunctionAvailable(
-    Operation *op, ModuleOp library, LibraryFunctionKind libFuncKind,
+    Operation *op, SymbolTable &library, LibraryFunctionKind libFuncKind,
     SmallVector<std::string> &libFuncNamesUsed,
     function_ref<FailureOr<SmallVector<Value>>(OpBuilder &, Location,
                                                ValueRange, func::FuncOp)>
@@ -84,7 +90,7 @@ LogicalResult Torch::wrapWithCalculateOpIfLibraryFunctionAvailable(
     name = cast<OperatorOp>(op)->getAttr("name").cast<StringAttr>().getValue();
   std::string libFuncName =
       (getLibraryFunctionPrefix(libFuncKind) + Twine(name)).str();
-  auto libFunc = library.lookupSymbol<func::FuncOp>(libFuncName);
+  auto libFunc = library.lookup<func::FuncOp>(libFuncName);
   if (!libFunc)
     return success();
   libFuncNamesUsed.push_back(libFuncName);
@@ -132,7 +138,226 @@ LogicalResult Torch::wrapWithCalculateOpIfLibraryFunctionAvailable(
   return success();
 }
 
-void Torch::importLibraryFunctions(ModuleOp module, ModuleOp library,
+// Prints a description of the statically known value of `value` to `os`.
+// Returns false if the value is not statically known.
+static bool printStaticValue(Value value, llvm::raw_ostream &os) {
+  Operation *def = value.getDefiningOp();
+  if (!def)
+    return false;
+  if (def->hasTrait<mlir::OpTrait::ConstantLike>()) {
+    os << def->getName() << def->getAttrDictionary() << ":" << value.getType();
+    return true;
+  }
+  if (auto listConstruct = dyn_cast<PrimListConstructOp>(def)) {
+    if (isListPotentiallyMutated(listConstruct.getResult()))
+      return false;
+    os << "[";
+    for (Value element : listConstruct.getElements()) {
+      if (!printStaticValue(element, os))
+        return false;
+      os << ",";
+    }
+    os << "]";
+    return true;
+  }
+  return false;
+}
+
+// Returns a key that uniquely identifies the result of the `libFuncKind`
+// calculation for `op`, or std::nullopt if that result might depend on more
+// than the op's types and constant operands.
+static std::optional<std::string>
+getMemoizationKey(Operation *op, LibraryFunctionKind libFuncKind) {
+  // We need to be able to refine the result types of the op in place when
+  // reusing a memoized result.
+  if (op->getNumRegions() != 0 || op->getNumResults() == 0 ||
+      !op->hasTrait<mlir::torch::Torch::OpTrait::AllowsTypeRefinement>())
+    return std::nullopt;
+
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  os << op->getName() << op->getAttrDictionary() << "(";
+  for (Value operand : op->getOperands()) {
+    if (auto tensorType = operand.getType().dyn_cast<BaseTensorType>()) {
+      if (!tensorType.hasSizes() || !tensorType.hasDtype())
+        return std::nullopt;
+      // Shape functions see the sizes of the tensor, which are only part of
+      // the key if they are static.
+      if (libFuncKind == LibraryFunctionKind::ShapeFunction &&
+          !tensorType.areAllSizesKnown())
+        return std::nullopt;
+      os << tensorType;
+    } else if (!printStaticValue(operand, os)) {
+      return std::nullopt;
+    }
+    os << ",";
+  }
+  os << ")->(";
+  llvm::interleaveComma(op->getResultTypes(), os);
+  os << ")";
+  return os.str();
+}
+
+// Refines the types of the results of `op` to `newTypes`. Users that don't
+// allow type refinement get a value with the original type, as in
+// `updateCalculateOpResultTypes`.
+static void refineResultTypes(Operation *op, ArrayRef<Type> newTypes) {
+  OpBuilder b(op->getContext());
+  b.setInsertionPointAfter(op);
+  for (auto resultAndType : llvm::zip(op->getResults(), newTypes)) {
+    Value result = std::get<0>(resultAndType);
+    Type originalType = result.getType();
+    Type newType = std::get<1>(resultAndType);
+    if (newType == originalType)
+      continue;
+    Value originalTypedValue;
+    for (OpOperand &use : llvm::make_early_inc_range(result.getUses())) {
+      if (use.getOwner()
+              ->hasTrait<mlir::torch::Torch::OpTrait::AllowsTypeRefinement>())
+        continue;
+      if (!originalTypedValue) {
+        if (originalType.isa<BaseTensorType>())
+          originalTypedValue = b.create<TensorStaticInfoCastOp>(
+              op->getLoc(), originalType, result);
+        else
+          originalTypedValue =
+              b.create<DerefineOp>(op->getLoc(), originalType, result);
+      }
+      use.set(originalTypedValue);
+    }
+    result.setType(newType);
+  }
+}
+
+// Reifies the calculations for the ops nested in `root`. If `memoize` is true,
+// calculations are memoized as described in `reifyLibraryCalculations`, and
+// if `nativeFastPath` is true, the result types that can be computed natively
+// are refined in place. As the ops are visited in order, this refinement
+// carries over to the ops using them.
+//
+// This only touches IR nested in `root` and only reads `library`, so it can
+// safely be run concurrently on different functions.
+static LogicalResult reifyLibraryCalculationsIn(
+    Operation *root, SymbolTable &library, LibraryFunctionKind libFuncKind,
+    function_ref<FailureOr<SmallVector<Value>>(OpBuilder &, Location,
+                                               ValueRange, func::FuncOp)>
+        libFuncArgsBuilder,
+    bool memoize, bool nativeFastPath,
+    SmallVector<std::string> &functionsNeeded) {
+  MLIRContext *context = root->getContext();
+  // The memoized calculations, keyed by op signature. The values are the ids
+  // stored in `kMemoizedCalculationAttrName` attributes.
+  llvm::StringMap<int64_t> memoizedCalculations;
+  int64_t nextMemoId = 0;
+  WalkResult walkResult = root->walk([&](Operation *op) -> WalkResult {
+    if (nativeFastPath) {
+      if (std::optional<Type> resultType =
+              computeResultTypeNatively(op, libFuncKind)) {
+        refineResultTypes(op, *resultType);
+        return WalkResult::advance();
+      }
+    }
+
+    std::optional<std::string> key;
+    if (memoize)
+      key = getMemoizationKey(op, libFuncKind);
+    if (key) {
+      auto it = memoizedCalculations.find(*key);
+      if (it != memoizedCalculations.end()) {
+        op->setAttr(kMemoizedCalculationAttrName,
+                    IntegerAttr::get(IntegerType::get(context, 64),
+                                     it->second));
+        return WalkResult::advance();
+      }
+    }
+
+    Operation *parentBefore = op->getParentOp();
+    if (failed(wrapWithCalculateOpIfLibraryFunctionAvailable(
+            op, library, libFuncKind, functionsNeeded, libFuncArgsBuilder)))
+      return WalkResult::interrupt();
+    // If the op was wrapped, make its calculation available to later ops
+    // with the same signature.
+    Operation *calculate = op->getParentOp();
+    if (key && calculate != parentBefore) {
+      int64_t memoId = nextMemoId++;
+      calculate->setAttr(
+          kMemoizedCalculationAttrName,
+          IntegerAttr::get(IntegerType::get(context, 64), memoId));
+      memoizedCalculations[*key] = memoId;
+    }
+    return WalkResult::advance();
+  });
+  return failure(walkResult.wasInterrupted());
+}
+
+LogicalResult Torch::reifyLibraryCalculations(
+    ModuleOp module, SymbolTable &library, LibraryFunctionKind libFuncKind,
+    function_ref<FailureOr<SmallVector<Value>>(OpBuilder &, Location,
+                                               ValueRange, func::FuncOp)>
+        libFuncArgsBuilder,
+    bool nativeFastPath) {
+  // Functions are processed in parallel (when threading is enabled), each
+  // with its own memoization table and list of library functions needed.
+  // Everything else at module level, such as module initializers, is
+  // processed serially and without memoization.
+  SmallVector<func::FuncOp> funcs;
+  SmallVector<Operation *> otherOps;
+  for (Operation &op : *module.getBody()) {
+    if (auto func = dyn_cast<func::FuncOp>(op))
+      funcs.push_back(func);
+    else
+      otherOps.push_back(&op);
+  }
+
+  SmallVector<SmallVector<std::string>> functionsNeededPerFunc(funcs.size());
+  if (failed(failableParallelForEach(
+          module.getContext(), llvm::seq<size_t>(0, funcs.size()),
+          [&](size_t i) {
+            return reifyLibraryCalculationsIn(
+                funcs[i], library, libFuncKind, libFuncArgsBuilder,
+                /*memoize=*/true, nativeFastPath, functionsNeededPerFunc[i]);
+          })))
+    return failure();
+
+  SmallVector<std::string> functionsNeeded;
+  for (Operation *op : otherOps)
+    if (failed(reifyLibraryCalculationsIn(op, library, libFuncKind,
+                                          libFuncArgsBuilder,
+                                          /*memoize=*/false, nativeFastPath,
+                                          functionsNeeded)))
+      return failure();
+  for (SmallVector<std::string> &funcsNeeded : functionsNeededPerFunc)
+    llvm::append_range(functionsNeeded, funcsNeeded);
+  importLibraryFunctions(module, library, std::move(functionsNeeded));
+  return success();
+}
+
+void Torch::applyMemoizedCalculationResults(func::FuncOp func) {
+  llvm::DenseMap<int64_t, SmallVector<Type>> memoizedResultTypes;
+  func.walk([&](Operation *op) {
+    if (!isa<ShapeCalculateOp, DtypeCalculateOp>(op))
+      return;
+    auto memoId = op->getAttrOfType<IntegerAttr>(kMemoizedCalculationAttrName);
+    if (!memoId)
+      return;
+    memoizedResultTypes[memoId.getInt()] =
+        llvm::to_vector(op->getResultTypes());
+    op->removeAttr(kMemoizedCalculationAttrName);
+  });
+
+  func.walk([&](Operation *op) {
+    auto memoId = op->getAttrOfType<IntegerAttr>(kMemoizedCalculationAttrName);
+    if (!memoId)
+      return;
+    op->removeAttr(kMemoizedCalculationAttrName);
+    auto it = memoizedResultTypes.find(memoId.getInt());
+    if (it == memoizedResultTypes.end())
+      return;
+    refineResultTypes(op, it->second);
+  });
+}
+
+void Torch::importLibraryFunctions(ModuleOp module, SymbolTable &library,
                                    SmallVector<std::string> functionsNeeded) {
   // Import just the functions we need. This includes transitive callees,
   // so we use a worklist algorithm.
@@ -141,15 +366,16 @@ void Torch::importLibraryFunctions(ModuleOp module, ModuleOp library,
     std::string symName = functionsNeeded.pop_back_val();
     if (importedFunctions.contains(symName))
       continue;
-    auto func = library.lookupSymbol<func::FuncOp>(symName);
+    auto func = library.lookup<func::FuncOp>(symName);
     assert(func && "broken library");
-    // Move the function from the library to the module this pass
-    // is running on. (this mutates the library, but we re-parse it each time
-    // so this is safe to do).
-    func->moveBefore(&module.getBody()->front());
+    // Clone the function from the library into the module this pass is
+    // running on. The library is shared across pass runs, so it must not be
+    // mutated.
+    auto clonedFunc = cast<func::FuncOp>(func->clone());
+    module.getBody()->push_front(clonedFunc);
     // Set the visibility to private so that the functions go away
     // nicely after we are done with them.
-    func.setVisibility(SymbolTable::Visibility::Private);
+    clonedFunc.setVisibility(SymbolTable::Visibility::Private);
     // Continue the DFS.
     importedFunctions.insert(symName);
     func.walk([&](func::CallOp op) {
@@ -346,3 +572,22 @@ mlir::torch::Torch::loadExtraLibrary(const std::string &filename,
 
   return success();
 }
+
+SymbolTable *
+mlir::torch::Torch::getCachedAbstractInterpLibrary(MLIRContext *context,
+                                                   StringRef extraLibrary) {
+  auto *dialect = context->getLoadedDialect<TorchDialect>();
+  assert(dialect && "expected the torch dialect to be loaded");
+  return dialect->getAbstractInterpLibraryCache().getOrParse(
+      extraLibrary, [&]() -> OwningOpRef<ModuleOp> {
+        // The builtin library may be embedded as bytecode, which the parser
+        // detects and reads directly.
+        OwningOpRef<ModuleOp> library =
+            parseSourceString<ModuleOp>(getAbstractInterpLibrary(), context);
+        if (!library || extraLibrary.empty())
+          return library;
+        if (failed(loadExtraLibrary(extraLibrary.str(), library)))
+          return nullptr;
+        return library;
+      });
+}
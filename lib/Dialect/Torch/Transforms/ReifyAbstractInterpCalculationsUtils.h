@@ -15,6 +15,7 @@
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Operation.h"
 #include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/SymbolTable.h"
 #include "mlir/Support/LogicalResult.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 
@@ -41,19 +42,72 @@ enum class LibraryFunctionKind {
 // Note: This function does *not* import the abstract interpretation function
 // from the library into the IR.
 LogicalResult wrapWithCalculateOpIfLibraryFunctionAvailable(
-    Operation *op, ModuleOp library, LibraryFunctionKind funcKind,
+    Operation *op, SymbolTable &library, LibraryFunctionKind funcKind,
     SmallVector<std::string> &libFuncNamesUsed,
     function_ref<FailureOr<SmallVector<Value>>(OpBuilder &, Location,
                                                ValueRange, func::FuncOp)>
         libFuncArgsBuilder);
 
+// Computes the refined result type of `op` for `funcKind` (which must be
+// `ShapeFunction` or `DtypeFunction`) natively, without the library, for the
+// most common ops, such as elementwise ops, matmuls, convolutions, poolings,
+// reductions and views. Returns std::nullopt if `op` is not one of them, if
+// its operands are not static enough, or if its result type could not be
+// refined in place. Defined in NativeAbstractInterp.cpp.
+std::optional<Type> computeResultTypeNatively(Operation *op,
+                                              LibraryFunctionKind funcKind);
+
+// The name of the attribute used to link ops whose calculation was memoized to
+// the `CalculateOp` that computes their results. See
+// `reifyLibraryCalculations`.
+static const char kMemoizedCalculationAttrName[] = "torch.memoized_calculation";
+
+// Wraps each op in `module` that has a library function of kind `funcKind` in
+// a `CalculateOp` (see `wrapWithCalculateOpIfLibraryFunctionAvailable`), and
+// imports the library functions needed into `module`.
+//
+// The result of a calculation is memoized within each function when it only
+// depends on static information, i.e. the op's types and constant operands:
+// only the first op with a given signature is wrapped, and later ops with the
+// same signature are left unwrapped and linked to it through the
+// `kMemoizedCalculationAttrName` attribute. This makes the cost of refinement
+// scale with the number of distinct op signatures rather than with the number
+// of ops. `applyMemoizedCalculationResults` then propagates the simplified
+// results to the linked ops.
+//
+// If `nativeFastPath` is true, the ops whose result type
+// `computeResultTypeNatively` can compute have it refined directly instead of
+// being wrapped.
+LogicalResult reifyLibraryCalculations(
+    ModuleOp module, SymbolTable &library, LibraryFunctionKind funcKind,
+    function_ref<FailureOr<SmallVector<Value>>(OpBuilder &, Location,
+                                               ValueRange, func::FuncOp)>
+        libFuncArgsBuilder,
+    bool nativeFastPath = false);
+
+// Refines the result types of the ops in `func` linked to a memoized
+// calculation to the result types of that calculation, and removes the
+// `kMemoizedCalculationAttrName` attributes.
+void applyMemoizedCalculationResults(func::FuncOp func);
+
 // Imports the functions in `functionsNeeded` from the library into the module.
 // This function assumes that all functions needed exist in the library.
 //
-// Note: This function modifies the library.
-void importLibraryFunctions(ModuleOp module, ModuleOp library,
+// The functions are cloned, so the library is left untouched and can be reused
+// by later pass runs.
+void importLibraryFunctions(ModuleOp module, SymbolTable &library,
                             SmallVector<std::string> functionsNeeded);
 
+// Returns the abstract interpretation library for `context`, with the module at
+// `extraLibrary` spliced in if it is non-empty.
+//
+// The library is parsed at most once per context and `extraLibrary`, and is
+// then shared by all later queries. Callers must treat it as read-only.
+// Returns nullptr (after printing an error) if the extra library fails to
+// load.
+SymbolTable *getCachedAbstractInterpLibrary(MLIRContext *context,
+                                            StringRef extraLibrary);
+
 // Recursively adjust `operand` to match `desiredType`.
 //
 // This function by default handles a few types such as `UnionType`,
@@ -10,7 +10,6 @@
 #include "PassDetail.h"
 
 #include "ReifyAbstractInterpCalculationsUtils.h"
-#include "mlir/Parser/Parser.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
@@ -64,38 +63,33 @@ namespace {
 struct ReifyDtypeCalculationsPass
     : public ReifyDtypeCalculationsBase<ReifyDtypeCalculationsPass> {
   ReifyDtypeCalculationsPass() = default;
-  ReifyDtypeCalculationsPass(StringRef extraLibrary) {
+  ReifyDtypeCalculationsPass(StringRef extraLibrary, bool nativeFastPath) {
     this->extraLibrary = extraLibrary.str();
+    this->nativeFastPath = nativeFastPath;
   }
   void runOnOperation() override {
     MLIRContext *context = &getContext();
     ModuleOp module = getOperation();
-    OwningOpRef<ModuleOp> library =
-        parseSourceString<ModuleOp>(getAbstractInterpLibrary(), context);
-    if (!extraLibrary.empty())
-      if (failed(mlir::torch::Torch::loadExtraLibrary(extraLibrary, library))) {
-        emitError(module->getLoc(),
-                  "Failed to load extra-library file at " + extraLibrary);
-        return signalPassFailure();
-      }
-
-    // Walk all the operations, and if we have a dtype function, wrap the op
-    // in a `torch.dtype.calculate` op.
-    SmallVector<std::string> functionsNeeded;
-    WalkResult walkResult = module.walk([&](Operation *op) -> WalkResult {
-      return wrapWithCalculateOpIfLibraryFunctionAvailable(
-          op, *library, LibraryFunctionKind::DtypeFunction, functionsNeeded,
-          dtypeFunctionArgsBuilder);
-    });
+    SymbolTable *library =
+        getCachedAbstractInterpLibrary(context, extraLibrary);
+    if (!library) {
+      emitError(module->getLoc(),
+                "Failed to load extra-library file at " + extraLibrary);
+      return signalPassFailure();
+    }
 
-    if (walkResult.wasInterrupted())
+    if (failed(reifyLibraryCalculations(module, *library,
+                                        LibraryFunctionKind::DtypeFunction,
+                                        dtypeFunctionArgsBuilder,
+                                        nativeFastPath)))
       return signalPassFailure();
-    importLibraryFunctions(module, *library, std::move(functionsNeeded));
   }
 };
 } // namespace
 
 std::unique_ptr<OperationPass<ModuleOp>>
-Torch::createReifyDtypeCalculationsPass(StringRef extraLibrary) {
-  return std::make_unique<ReifyDtypeCalculationsPass>(extraLibrary);
+Torch::createReifyDtypeCalculationsPass(StringRef extraLibrary,
+                                        bool nativeFastPath) {
+  return std::make_unique<ReifyDtypeCalculationsPass>(extraLibrary,
+                                                      nativeFastPath);
 }
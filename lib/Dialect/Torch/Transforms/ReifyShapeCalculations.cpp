@@ -10,7 +10,6 @@
 #include "PassDetail.h"
 
 #include "ReifyAbstractInterpCalculationsUtils.h"
-#include "mlir/Parser/Parser.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
@@ -59,42 +58,37 @@ namespace {
 struct ReifyShapeCalculationsPass
     : public ReifyShapeCalculationsBase<ReifyShapeCalculationsPass> {
   ReifyShapeCalculationsPass() = default;
-  ReifyShapeCalculationsPass(StringRef extraLibrary) {
+  ReifyShapeCalculationsPass(StringRef extraLibrary, bool nativeFastPath) {
     this->extraLibrary = extraLibrary.str();
+    this->nativeFastPath = nativeFastPath;
   }
   void runOnOperation() override {
     MLIRContext *context = &getContext();
     ModuleOp module = getOperation();
 
-    // TODO: Find a way to not have to parse this every time.
-    // The library is O(#ops we know about), and this pass should be
-    // O(#ops in the program) ideally.
-    OwningOpRef<ModuleOp> library =
-        parseSourceString<ModuleOp>(getAbstractInterpLibrary(), context);
-    if (!extraLibrary.empty())
-      if (failed(mlir::torch::Torch::loadExtraLibrary(extraLibrary, library))) {
-        emitError(module->getLoc(),
-                  "Failed to load extra-library file at " + extraLibrary);
-        return signalPassFailure();
-      }
-
-    // Walk all the operations, and if we have a shape function, wrap the op
-    // in a `torch.shape.calculate` op.
-    SmallVector<std::string> functionsNeeded;
-    WalkResult walkResult = module.walk([&](Operation *op) -> WalkResult {
-      return wrapWithCalculateOpIfLibraryFunctionAvailable(
-          op, *library, LibraryFunctionKind::ShapeFunction, functionsNeeded,
-          shapeFunctionArgsBuilder);
-    });
+    // The library is parsed once per context and shared by all runs of this
+    // pass, so that this pass is O(#ops in the program) rather than
+    // O(#ops we know about).
+    SymbolTable *library =
+        getCachedAbstractInterpLibrary(context, extraLibrary);
+    if (!library) {
+      emitError(module->getLoc(),
+                "Failed to load extra-library file at " + extraLibrary);
+      return signalPassFailure();
+    }
 
-    if (walkResult.wasInterrupted())
+    if (failed(reifyLibraryCalculations(module, *library,
+                                        LibraryFunctionKind::ShapeFunction,
+                                        shapeFunctionArgsBuilder,
+                                        nativeFastPath)))
       return signalPassFailure();
-    importLibraryFunctions(module, *library, std::move(functionsNeeded));
   }
 };
 } // namespace
 
 std::unique_ptr<OperationPass<ModuleOp>>
-mlir::torch::Torch::createReifyShapeCalculationsPass(StringRef extraLibrary) {
-  return std::make_unique<ReifyShapeCalculationsPass>(extraLibrary);
+mlir::torch::Torch::createReifyShapeCalculationsPass(StringRef extraLibrary,
+                                                     bool nativeFastPath) {
+  return std::make_unique<ReifyShapeCalculationsPass>(extraLibrary,
+                                                      nativeFastPath);
 }
@@ -0,0 +1,171 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "ActivationLiveness.h"
+#include "mlir/IR/Builders.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/DecompositionCostModel.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+// Returns true if `op` is cheap enough to be recomputed, that is, it does at
+// most `maxFlopsPerByte` FLOPs per byte of its results, which is the case of
+// elementwise ops and views.
+static bool isCheapToRecompute(Operation *op, BlockLiveness &liveness,
+                               double maxFlopsPerByte) {
+  if (!isReorderable(op))
+    return false;
+  std::optional<OpCost> cost = estimateOpCost(op);
+  if (!cost)
+    return false;
+  int64_t resultBytes = 0;
+  for (Value result : op->getResults())
+    resultBytes += liveness.getBytes(result);
+  return resultBytes != 0 && cost->flops <= maxFlopsPerByte * resultBytes;
+}
+
+namespace {
+// A recomputation of the results of `original` by `clone`, for the uses after
+// the peak.
+struct Rematerialization {
+  Operation *original;
+  Operation *clone;
+
+  void revert() {
+    clone->replaceAllUsesWith(original->getResults());
+    clone->erase();
+  }
+};
+} // namespace
+
+// Recomputes the results of `op` right before their first use after `peakOp`,
+// for all the uses from there on. Returns std::nullopt if none of the uses
+// after `peakOp` is in the block of `op`, since there is then nowhere in the
+// block to recompute them.
+static std::optional<Rematerialization>
+rematerializeAfter(Operation *op, Operation *peakOp) {
+  Block *block = op->getBlock();
+  Operation *firstLateUser = nullptr;
+  for (Operation *user : op->getUsers()) {
+    Operation *ancestor = block->findAncestorOpInBlock(*user);
+    if (ancestor && peakOp->isBeforeInBlock(ancestor) &&
+        (!firstLateUser || ancestor->isBeforeInBlock(firstLateUser)))
+      firstLateUser = ancestor;
+  }
+  if (!firstLateUser)
+    return std::nullopt;
+  OpBuilder b(firstLateUser);
+  Operation *clone = b.clone(*op);
+  for (auto [result, newResult] :
+       llvm::zip(op->getResults(), clone->getResults())) {
+    result.replaceUsesWithIf(newResult, [&](OpOperand &use) {
+      Operation *ancestor = block->findAncestorOpInBlock(*use.getOwner());
+      return ancestor && !ancestor->isBeforeInBlock(firstLateUser);
+    });
+  }
+  return Rematerialization{op, clone};
+}
+
+namespace {
+class RematerializePass : public RematerializeBase<RematerializePass> {
+public:
+  RematerializePass() = default;
+  RematerializePass(int64_t memoryBudget, double maxFlopsPerByte) {
+    this->memoryBudget = memoryBudget;
+    this->maxFlopsPerByte = maxFlopsPerByte;
+  }
+
+  void runOnOperation() override {
+    for (Block &block : getOperation().getBody())
+      rematerializeBlock(block);
+  }
+
+private:
+  // Recomputes cheap activations that are live across the peak, one at a
+  // time and largest first, until the peak is within the budget or no
+  // recomputation lowers it.
+  void rematerializeBlock(Block &block) {
+    int64_t maxIterations = block.getOperations().size();
+    for (int64_t iteration = 0; iteration < maxIterations; ++iteration) {
+      BlockLiveness liveness(block);
+      SmallVector<Operation *> order = llvm::to_vector(
+          llvm::map_range(block, [](Operation &op) { return &op; }));
+      Operation *peakOp = nullptr;
+      int64_t peakBytes = liveness.computePeakBytes(order, &peakOp);
+      if (!peakOp || peakBytes <= memoryBudget)
+        return;
+
+      // Returns true if `value` is still used after the peak.
+      auto isLiveAfterPeak = [&](Value value) {
+        return llvm::any_of(value.getUsers(), [&](Operation *user) {
+          Operation *ancestor = block.findAncestorOpInBlock(*user);
+          return !ancestor || peakOp->isBeforeInBlock(ancestor);
+        });
+      };
+      // The ops live across the peak, whose recomputation only needs
+      // activations that are live after the peak anyway.
+      SmallVector<std::pair<int64_t, Operation *>> candidates;
+      for (Operation *op : order) {
+        if (op == peakOp)
+          break;
+        if (!isCheapToRecompute(op, liveness, maxFlopsPerByte))
+          continue;
+        int64_t bytes = 0;
+        for (Value result : op->getResults()) {
+          if (isLiveAfterPeak(result) &&
+              !llvm::is_contained(liveness.getUsedValues(peakOp), result))
+            bytes += liveness.getBytes(result);
+        }
+        bool operandsLive = llvm::all_of(
+            liveness.getUsedValues(op), [&](Value used) {
+              return liveness.getBytes(used) == 0 || isLiveAfterPeak(used);
+            });
+        if (bytes != 0 && operandsLive)
+          candidates.emplace_back(bytes, op);
+      }
+      llvm::stable_sort(candidates, [](const auto &a, const auto &b) {
+        return a.first > b.first;
+      });
+
+      bool rematerialized = false;
+      for (Operation *op : llvm::make_second_range(candidates)) {
+        std::optional<Rematerialization> rematerialization =
+            rematerializeAfter(op, peakOp);
+        if (!rematerialization)
+          continue;
+        SmallVector<Operation *> newOrder = llvm::to_vector(
+            llvm::map_range(block, [](Operation &op) { return &op; }));
+        BlockLiveness newLiveness(block);
+        if (newLiveness.computePeakBytes(newOrder) < peakBytes) {
+          // The original op is dead if all of its uses were after the peak.
+          if (op->use_empty())
+            op->erase();
+          ++numRematerializedOps;
+          rematerialized = true;
+          break;
+        }
+        rematerialization->revert();
+      }
+      if (!rematerialized)
+        return;
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::Torch::createRematerializePass(int64_t memoryBudget,
+                                            double maxFlopsPerByte) {
+  return std::make_unique<RematerializePass>(memoryBudget, maxFlopsPerByte);
+}
@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "ActivationLiveness.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+
+#include <set>
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+// Returns an order of the ops of `block` in which the ops that can't be
+// reordered stay in place, and in which the ops between them are scheduled
+// greedily: among the ops whose operands are ready, the one that increases the
+// live bytes the least runs first, in their original order on ties.
+static SmallVector<Operation *> scheduleForPeakMemory(Block &block,
+                                                      BlockLiveness &liveness) {
+  SmallVector<Operation *> order;
+  DenseMap<Value, unsigned> remainingUsers;
+  auto getRemainingUsers = [&](Value value) -> unsigned & {
+    return remainingUsers.try_emplace(value, liveness.getNumUsers(value))
+        .first->second;
+  };
+  auto schedule = [&](Operation *op) {
+    order.push_back(op);
+    for (Value used : liveness.getUsedValues(op)) {
+      if (liveness.getBytes(used) != 0)
+        --getRemainingUsers(used);
+    }
+  };
+
+  auto it = block.begin();
+  while (it != block.end()) {
+    if (!isReorderable(&*it)) {
+      schedule(&*it++);
+      continue;
+    }
+    // The ops up to the next op that can't be reordered.
+    SmallVector<Operation *> segment;
+    DenseMap<Operation *, unsigned> indexOf;
+    while (it != block.end() && isReorderable(&*it)) {
+      indexOf[&*it] = segment.size();
+      segment.push_back(&*it++);
+    }
+    // The number of ops of the segment that each op waits for.
+    SmallVector<unsigned> numPending(segment.size(), 0);
+    SmallVector<SmallVector<unsigned>> dependents(segment.size());
+    for (auto [index, op] : llvm::enumerate(segment)) {
+      for (Value used : liveness.getUsedValues(op)) {
+        auto producer = indexOf.find(used.getDefiningOp());
+        if (producer == indexOf.end())
+          continue;
+        ++numPending[index];
+        dependents[producer->second].push_back(index);
+      }
+    }
+    std::set<unsigned> ready;
+    for (unsigned index = 0; index < segment.size(); ++index) {
+      if (numPending[index] == 0)
+        ready.insert(index);
+    }
+    while (!ready.empty()) {
+      std::optional<unsigned> best;
+      int64_t bestDelta = 0;
+      for (unsigned index : ready) {
+        Operation *op = segment[index];
+        int64_t delta = 0;
+        for (Value result : op->getResults())
+          delta += liveness.getBytes(result);
+        for (Value used : liveness.getUsedValues(op)) {
+          if (liveness.getBytes(used) != 0 && getRemainingUsers(used) == 1)
+            delta -= liveness.getBytes(used);
+        }
+        if (!best || delta < bestDelta) {
+          best = index;
+          bestDelta = delta;
+        }
+      }
+      ready.erase(*best);
+      schedule(segment[*best]);
+      for (unsigned dependent : dependents[*best]) {
+        if (--numPending[dependent] == 0)
+          ready.insert(dependent);
+      }
+    }
+  }
+  return order;
+}
+
+namespace {
+class ReorderForPeakMemoryPass
+    : public ReorderForPeakMemoryBase<ReorderForPeakMemoryPass> {
+public:
+  ReorderForPeakMemoryPass() = default;
+  ReorderForPeakMemoryPass(bool report) { this->report = report; }
+
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+    int64_t peakBytesBefore = 0, peakBytesAfter = 0;
+    for (Block &block : func.getBody()) {
+      BlockLiveness liveness(block);
+      SmallVector<Operation *> originalOrder =
+          llvm::to_vector(llvm::map_range(block, [](Operation &op) {
+            return &op;
+          }));
+      int64_t originalPeak = liveness.computePeakBytes(originalOrder);
+      SmallVector<Operation *> newOrder =
+          scheduleForPeakMemory(block, liveness);
+      int64_t newPeak = liveness.computePeakBytes(newOrder);
+      peakBytesBefore = std::max(peakBytesBefore, originalPeak);
+      // The greedy schedule isn't always better than the original order.
+      if (newPeak >= originalPeak) {
+        peakBytesAfter = std::max(peakBytesAfter, originalPeak);
+        continue;
+      }
+      peakBytesAfter = std::max(peakBytesAfter, newPeak);
+      Operation *terminator = block.getTerminator();
+      for (Operation *op : newOrder) {
+        if (op != terminator)
+          op->moveBefore(terminator);
+      }
+    }
+    if (report) {
+      func.emitRemark() << "peak activation memory of " << peakBytesBefore
+                        << " bytes before reordering and " << peakBytesAfter
+                        << " bytes after";
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::Torch::createReorderForPeakMemoryPass(bool report) {
+  return std::make_unique<ReorderForPeakMemoryPass>(report);
+}
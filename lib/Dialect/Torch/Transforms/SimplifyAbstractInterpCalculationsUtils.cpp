@@ -250,6 +250,141 @@ public:
 };
 } // namespace
 
+// Returns the most refined static information known for the value tensor
+// `value`, looking through the casts that erase static information.
+static TensorStaticInfo getMostRefinedStaticInfo(Value value) {
+  TensorStaticInfo info(value.getType().cast<ValueTensorType>());
+  while (auto cast = value.getDefiningOp<TensorStaticInfoCastOp>()) {
+    value = cast.getOperand();
+    auto operandType = value.getType().dyn_cast<ValueTensorType>();
+    if (!operandType)
+      break;
+    std::optional<TensorStaticInfo> meet =
+        meetTensorStaticInfo(info, operandType);
+    if (!meet)
+      break;
+    info = std::move(*meet);
+  }
+  return info;
+}
+
+// Returns the refinement of `type` to the join of the most refined types of
+// `lhs` and `rhs`, or null if that doesn't refine `type`. Only the refined
+// type is created in the context, not the types in between.
+static Type getRefinedJoinType(ValueTensorType type, Value lhs, Value rhs) {
+  TensorStaticInfo joined = joinTensorStaticInfo(getMostRefinedStaticInfo(lhs),
+                                                 getMostRefinedStaticInfo(rhs));
+  std::optional<TensorStaticInfo> refined = meetTensorStaticInfo(type, joined);
+  if (!refined || *refined == TensorStaticInfo(type))
+    return nullptr;
+  return type.getWithStaticInfo(*refined);
+}
+
+// Sets the type of `value` to the refined `newType`, and routes the uses that
+// require the exact previous type through a TensorStaticInfoCastOp.
+static void refineValueType(Value value, Type newType,
+                            PatternRewriter &rewriter) {
+  Type originalType = value.getType();
+  SmallVector<OpOperand *> uses;
+  for (OpOperand &use : value.getUses()) {
+    if (!use.getOwner()
+             ->hasTrait<mlir::torch::Torch::OpTrait::AllowsTypeRefinement>())
+      uses.push_back(&use);
+  }
+  value.setType(newType);
+  if (uses.empty())
+    return;
+  rewriter.setInsertionPointAfterValue(value);
+  Value originalTypedValue = rewriter.create<TensorStaticInfoCastOp>(
+      value.getLoc(), originalType, value);
+  for (OpOperand *use : uses)
+    use->set(originalTypedValue);
+}
+
+// Sets the operand `use` to a TensorStaticInfoCastOp of its value to
+// `newType`, right before its owner.
+static void castOperand(OpOperand &use, Type newType,
+                        PatternRewriter &rewriter) {
+  rewriter.setInsertionPoint(use.getOwner());
+  use.set(rewriter.create<TensorStaticInfoCastOp>(use.getOwner()->getLoc(),
+                                                  newType, use.get()));
+}
+
+namespace {
+// Refines the types of the value tensors carried by a `torch.prim.Loop` to the
+// join of the types of their initial and yielded values.
+//
+// The yielded values are computed from block arguments of the current type, so
+// their type holds for any iteration that starts from the more refined type as
+// well. Each refinement lets the abstract interpretation of the body refine
+// the yielded values further, and applying this pattern again iterates to the
+// fixed point.
+class RefinePrimLoopCarriedTypes : public OpRewritePattern<PrimLoopOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(PrimLoopOp op,
+                                PatternRewriter &rewriter) const override {
+    Block &body = op.getRegion().front();
+    auto condition = cast<PrimLoopConditionOp>(body.getTerminator());
+    unsigned initOperandsBegin = op.getIterArgsInit().getBeginOperandIndex();
+    unsigned yieldOperandsBegin =
+        condition.getIterArgs().getBeginOperandIndex();
+    bool changed = false;
+    for (auto [i, result] : llvm::enumerate(op.getResults())) {
+      auto type = result.getType().dyn_cast<ValueTensorType>();
+      if (!type)
+        continue;
+      Type newType = getRefinedJoinType(type, op.getIterArgsInit()[i],
+                                        condition.getIterArgs()[i]);
+      if (!newType)
+        continue;
+      rewriter.updateRootInPlace(op, [&]() {
+        castOperand(op->getOpOperand(initOperandsBegin + i), newType,
+                    rewriter);
+        castOperand(condition->getOpOperand(yieldOperandsBegin + i), newType,
+                    rewriter);
+        // The first block argument is the induction variable.
+        refineValueType(body.getArgument(i + 1), newType, rewriter);
+        refineValueType(result, newType, rewriter);
+      });
+      changed = true;
+    }
+    return success(changed);
+  }
+};
+} // namespace
+
+namespace {
+// Refines the types of the value tensors returned by a `torch.prim.If` to the
+// join of the types of the values yielded by both branches.
+class RefinePrimIfResultTypes : public OpRewritePattern<PrimIfOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(PrimIfOp op,
+                                PatternRewriter &rewriter) const override {
+    Operation *thenYield = op.getThenRegion().front().getTerminator();
+    Operation *elseYield = op.getElseRegion().front().getTerminator();
+    bool changed = false;
+    for (auto [i, result] : llvm::enumerate(op.getResults())) {
+      auto type = result.getType().dyn_cast<ValueTensorType>();
+      if (!type)
+        continue;
+      Type newType = getRefinedJoinType(type, thenYield->getOperand(i),
+                                        elseYield->getOperand(i));
+      if (!newType)
+        continue;
+      rewriter.updateRootInPlace(op, [&]() {
+        castOperand(thenYield->getOpOperand(i), newType, rewriter);
+        castOperand(elseYield->getOpOperand(i), newType, rewriter);
+        refineValueType(result, newType, rewriter);
+      });
+      changed = true;
+    }
+    return success(changed);
+  }
+};
+} // namespace
+
 LogicalResult Torch::updateCalculateOpResultTypes(Operation *calculateOp,
                                                   int resultNum,
                                                   Type newResultType,
@@ -345,6 +480,12 @@ void mlir::torch::Torch::populateFullyUnrollPrimLoopOpPattern(
   patterns.insert<FullyUnrollPrimLoopOp>(context);
 }
 
+void mlir::torch::Torch::populateRefineControlFlowTypesPatterns(
+    RewritePatternSet &patterns, MLIRContext *context) {
+  patterns.insert<RefinePrimLoopCarriedTypes, RefinePrimIfResultTypes>(
+      context);
+}
+
 void mlir::torch::Torch::populateAbstractlyInterpretListOpsWithinABlockPattern(
     RewritePatternSet &patterns, MLIRContext *context) {
   patterns.insert<AbstractlyInterpretListOpsWithinABlock>(context);
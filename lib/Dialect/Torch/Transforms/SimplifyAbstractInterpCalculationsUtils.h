@@ -27,6 +27,11 @@ void populateFoldPrimUncheckedCastOpPattern(RewritePatternSet &patterns,
                                             MLIRContext *context);
 void populateFullyUnrollPrimLoopOpPattern(RewritePatternSet &patterns,
                                           MLIRContext *context);
+// Refines the types of the tensors carried by `torch.prim.Loop` ops and
+// returned by `torch.prim.If` ops from the types of the values flowing into
+// them.
+void populateRefineControlFlowTypesPatterns(RewritePatternSet &patterns,
+                                            MLIRContext *context);
 void populateAbstractlyInterpretListOpsWithinABlockPattern(
     RewritePatternSet &patterns, MLIRContext *context);
 
@@ -194,6 +194,7 @@ class SimplifyDtypeCalculationsPass
     populateFullyUnrollPrimLoopOpPattern(patterns, context);
     populateAbstractlyInterpretListOpsWithinABlockPattern(patterns, context);
     populateFoldPrimUncheckedCastOpPattern(patterns, context);
+    populateRefineControlFlowTypesPatterns(patterns, context);
     patterns.insert<RefineDtypeCalculateOp>(context);
     patterns.insert<DecomposePromoteDtypesOp>(context);
     patterns.insert<RefineNumToTensorScalarOpType>(context);
@@ -96,15 +96,19 @@ static LogicalResult refineShapeCalculateResult(ShapeCalculateOp op,
       sizes.push_back(kUnknownSize);
   }
 
+  // Only create the refined type, and not the type implied by the shape
+  // alone, which mostly differs from it.
   auto originalResultType = result.getType().cast<BaseTensorType>();
-  auto impliedTypesFromShape =
-      originalResultType.cast<BaseTensorType>()
-          .getWithSizesAndDtype(ArrayRef(sizes),
-                                originalResultType.getOptionalDtype())
-          .cast<BaseTensorType>();
-
-  return updateCalculateOpResultTypes(op, resultNum, impliedTypesFromShape,
-                                      rewriter);
+  std::optional<TensorStaticInfo> refinedInfo = meetTensorStaticInfo(
+      originalResultType,
+      TensorStaticInfo(ArrayRef(sizes), originalResultType.getOptionalDtype()));
+  if (!refinedInfo || *refinedInfo == TensorStaticInfo(originalResultType))
+    return rewriter.notifyMatchFailure(
+        op, "New type information does not refine old type");
+  auto refinedType = originalResultType.getWithStaticInfo(*refinedInfo)
+                         .cast<BaseTensorType>();
+
+  return updateCalculateOpResultTypes(op, resultNum, refinedType, rewriter);
 }
 
 namespace {
@@ -134,6 +138,7 @@ class SimplifyShapeCalculationsPass
     populateFullyUnrollPrimLoopOpPattern(patterns, context);
     populateAbstractlyInterpretListOpsWithinABlockPattern(patterns, context);
     populateFoldPrimUncheckedCastOpPattern(patterns, context);
+    populateRefineControlFlowTypesPatterns(patterns, context);
     patterns.insert<DecomposeAtenSizeOp>(context);
     patterns.insert<RefineShapeCalculateOp>(context);
 
@@ -24,6 +24,10 @@ static inline bool isQIntType(ScalarType t) {
          t == ScalarType::QUInt2x4;
 }
 
+static inline bool isFloat8Type(ScalarType t) {
+  return t == ScalarType::Float8_e5m2 || t == ScalarType::Float8_e4m3fn;
+}
+
 //===----------------------------------------------------------------------===//
 // Type promotion related code are copied from
 // aten/src/ATen/native/TypeProperties.*.
@@ -58,6 +62,11 @@ static inline ScalarType promoteTypes(ScalarType a, ScalarType b) {
                     "figure out what the correct rules should be");
   }
 
+  // Like PyTorch, only promote the Float8 types to themselves, since there is
+  // no agreed upon promotion between them and the other types.
+  if (isFloat8Type(a) || isFloat8Type(b))
+    return a == b ? a : ud;
+
   // this matrix has to be consistent with AT_FORALL_SCALAR_TYPES_WITH_COMPLEX
   // so that's why we have to add undefined as we are not sure what is the
   // corrent values for the type promotions in complex type cases.
@@ -86,7 +95,8 @@ static inline ScalarType promoteTypes(ScalarType a, ScalarType b) {
 
 static inline bool isFloatingType(ScalarType t) {
   return (t == ScalarType::Double || t == ScalarType::Float ||
-          t == ScalarType::Half || t == ScalarType::BFloat16);
+          t == ScalarType::Half || t == ScalarType::BFloat16 ||
+          isFloat8Type(t));
 }
 
 static inline bool isComplexType(ScalarType t) {
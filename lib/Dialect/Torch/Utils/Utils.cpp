@@ -57,10 +57,18 @@ torch_upstream::ScalarType Torch::getScalarTypeForType(Type type) {
     return torch_upstream::ScalarType::BFloat16;
   if (type.isF16())
     return torch_upstream::ScalarType::Half;
+  if (type.isFloat8E5M2())
+    return torch_upstream::ScalarType::Float8_e5m2;
+  if (type.isFloat8E4M3FN())
+    return torch_upstream::ScalarType::Float8_e4m3fn;
   if (type.isUnsignedInteger(8))
     return torch_upstream::ScalarType::Byte;
   if (type.isSignedInteger(8))
     return torch_upstream::ScalarType::Char;
+  if (type.isa<QInt8Type>())
+    return torch_upstream::ScalarType::QInt8;
+  if (type.isa<QUInt8Type>())
+    return torch_upstream::ScalarType::QUInt8;
   if (type.isa<ComplexType>()) {
     mlir::Type complexElemType = type.cast<ComplexType>().getElementType();
     if (complexElemType.isF32())
@@ -102,9 +110,17 @@ Torch::getTypeForScalarType(MLIRContext *context,
     return mlir::FloatType::getBF16(context);
   case torch_upstream::ScalarType::Half:
     return mlir::FloatType::getF16(context);
+  case torch_upstream::ScalarType::Float8_e5m2:
+    return mlir::FloatType::getFloat8E5M2(context);
+  case torch_upstream::ScalarType::Float8_e4m3fn:
+    return mlir::FloatType::getFloat8E4M3FN(context);
   case torch_upstream::ScalarType::Byte:
   case torch_upstream::ScalarType::Char:
     return mlir::IntegerType::get(context, 8, signedness);
+  case torch_upstream::ScalarType::QInt8:
+    return QInt8Type::get(context);
+  case torch_upstream::ScalarType::QUInt8:
+    return QUInt8Type::get(context);
   case torch_upstream::ScalarType::ComplexHalf:
     return mlir::ComplexType::get(Float32Type::get(context));
   case torch_upstream::ScalarType::ComplexFloat:
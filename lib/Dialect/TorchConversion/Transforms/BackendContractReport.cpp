@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "BackendContractReport.h"
+
+#include "mlir/Interfaces/ControlFlowInterfaces.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <map>
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::TorchConversion;
+
+// Returns the tensor types that `op` reads and writes.
+static SmallVector<RankedTensorType> getTensorTypes(Operation *op) {
+  SmallVector<RankedTensorType> types;
+  for (Type type : op->getOperandTypes())
+    if (auto tensorType = type.dyn_cast<RankedTensorType>())
+      types.push_back(tensorType);
+  for (Type type : op->getResultTypes())
+    if (auto tensorType = type.dyn_cast<RankedTensorType>())
+      types.push_back(tensorType);
+  return types;
+}
+
+std::optional<double>
+mlir::torch::TorchConversion::estimateElementwiseFlops(Operation *op) {
+  double maxElements = 0;
+  for (RankedTensorType type : getTensorTypes(op)) {
+    if (!type.hasStaticShape())
+      return std::nullopt;
+    maxElements = std::max<double>(maxElements, type.getNumElements());
+  }
+  return maxElements;
+}
+
+// Returns the number of bytes that `op` reads and writes, or std::nullopt if
+// its tensors don't have static shapes.
+static std::optional<double> estimateBytes(Operation *op) {
+  double bytes = 0;
+  for (RankedTensorType type : getTensorTypes(op)) {
+    if (!type.hasStaticShape() || !type.getElementType().isIntOrFloat())
+      return std::nullopt;
+    bytes += static_cast<double>(type.getNumElements()) *
+             llvm::divideCeil(type.getElementTypeBitWidth(), 8);
+  }
+  return bytes;
+}
+
+static std::string getLocationString(Location loc) {
+  std::string string;
+  llvm::raw_string_ostream os(string);
+  loc.print(os);
+  return os.str();
+}
+
+LogicalResult mlir::torch::TorchConversion::writeBackendContractReport(
+    ModuleOp module, StringRef path, const BackendContractReportHooks &hooks) {
+  struct Cost {
+    Operation *op;
+    double flops;
+    double bytes;
+  };
+  // Sorted by name, so that the report is deterministic.
+  std::map<std::string, int64_t> opCounts;
+  llvm::json::Array slowFallbacks;
+  SmallVector<Cost> costs;
+  double totalFlops = 0, totalBytes = 0;
+  module.walk<WalkOrder::PreOrder>([&](Operation *op) {
+    if (op == module)
+      return WalkResult::advance();
+    ++opCounts[op->getName().getStringRef().str()];
+    if (hooks.isSlowFallback(op)) {
+      slowFallbacks.push_back(llvm::json::Object{
+          {"op", op->getName().getStringRef()},
+          {"location", getLocationString(op->getLoc())}});
+    }
+    if (std::optional<double> flops = hooks.estimateFlops(op)) {
+      if (std::optional<double> bytes = estimateBytes(op)) {
+        costs.push_back({op, *flops, *bytes});
+        totalFlops += *flops;
+        totalBytes += *bytes;
+      }
+    }
+    bool hasTensorResults =
+        llvm::any_of(op->getResultTypes(),
+                     [](Type type) { return type.isa<TensorType>(); });
+    if (hasTensorResults && op->getNumRegions() != 0 &&
+        !isa<RegionBranchOpInterface>(op))
+      return WalkResult::skip();
+    return WalkResult::advance();
+  });
+
+  llvm::stable_sort(costs, [](const Cost &a, const Cost &b) {
+    return std::make_pair(a.flops, a.bytes) > std::make_pair(b.flops, b.bytes);
+  });
+  llvm::json::Object counts;
+  for (const auto &[name, count] : opCounts)
+    counts[name] = count;
+  llvm::json::Array hotOps;
+  for (const Cost &cost : costs) {
+    hotOps.push_back(llvm::json::Object{
+        {"op", cost.op->getName().getStringRef()},
+        {"location", getLocationString(cost.op->getLoc())},
+        {"flops", cost.flops},
+        {"bytes", cost.bytes}});
+  }
+  llvm::json::Object report{{"op_counts", std::move(counts)},
+                            {"slow_fallbacks", std::move(slowFallbacks)},
+                            {"hot_ops", std::move(hotOps)},
+                            {"total_flops", totalFlops},
+                            {"total_bytes", totalBytes}};
+
+  std::error_code error;
+  llvm::raw_fd_ostream os(path, error);
+  if (error)
+    return emitError(module.getLoc())
+           << "could not open the report file '" << path
+           << "': " << error.message();
+  os << llvm::formatv("{0:2}", llvm::json::Value(std::move(report))) << "\n";
+  return success();
+}
@@ -0,0 +1,52 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TORCHMLIR_DIALECT_TORCHCONVERSION_TRANSFORMS_BACKENDCONTRACTREPORT_H
+#define TORCHMLIR_DIALECT_TORCHCONVERSION_TRANSFORMS_BACKENDCONTRACTREPORT_H
+
+#include "mlir/IR/BuiltinOps.h"
+
+#include <optional>
+
+namespace mlir {
+namespace torch {
+namespace TorchConversion {
+
+/// Returns the number of elements of the largest tensor that `op` reads or
+/// writes, which is about the number of operations done by elementwise ops,
+/// reductions and pooling, or std::nullopt if it doesn't have static sizes.
+std::optional<double> estimateElementwiseFlops(Operation *op);
+
+/// The hooks through which a backend contract verification pass describes
+/// the ops of its backend to `writeBackendContractReport`.
+struct BackendContractReportHooks {
+  /// Returns true if `op` is a generic form that the lowering falls back to
+  /// when it has no better one, such as a gather.
+  function_ref<bool(Operation *)> isSlowFallback;
+  /// Returns the estimated number of arithmetic operations done by `op`, or
+  /// std::nullopt if `op` does no work worth reporting, such as views, or
+  /// its work can't be estimated.
+  function_ref<std::optional<double>(Operation *)> estimateFlops;
+};
+
+/// Writes a JSON report on the ops of `module` to `path`, or to stdout if
+/// `path` is "-": the count of each op, the ops that are slow fallbacks, and
+/// the estimated FLOPs and bytes read and written by each op that does work,
+/// from the most to the least expensive. The bodies of ops with tensor
+/// results, such as the payloads of linalg ops, are counted as part of their
+/// op rather than on their own.
+LogicalResult
+writeBackendContractReport(ModuleOp module, StringRef path,
+                           const BackendContractReportHooks &hooks);
+
+} // namespace TorchConversion
+} // namespace torch
+} // namespace mlir
+
+#endif // TORCHMLIR_DIALECT_TORCHCONVERSION_TRANSFORMS_BACKENDCONTRACTREPORT_H
@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::TorchConversion;
+
+namespace {
+// Folds an elementwise linalg.generic computing `c + f(others...)`, where `c`
+// is the result of a contraction, into the accumulator of the contraction:
+//
+//   %c = linalg.matmul ins(%a, %b) outs(%init)
+//   %r = linalg.generic ins(%c, %bias) outs(%empty) {yield %c + %bias}
+//
+// becomes
+//
+//   %acc = linalg.generic ins(%init, %bias) outs(%empty) {yield %init + %bias}
+//   %r = linalg.matmul ins(%a, %b) outs(%acc)
+//
+// so that the bias or residual is added while the accumulator is initialized,
+// rather than in another pass over the result. The elementwise ops that
+// compute the accumulator can then be fused together. This reassociates the
+// floating point additions.
+class FoldAddIntoContractionAccumulator
+    : public OpRewritePattern<linalg::GenericOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(linalg::GenericOp op,
+                                PatternRewriter &rewriter) const override {
+    if (!op.hasTensorSemantics() || op.getNumDpsInits() != 1 ||
+        op.getNumParallelLoops() != op.getNumLoops() ||
+        !op.getMatchingIndexingMap(op.getDpsInitOperand(0)).isIdentity() ||
+        op.payloadUsesValueFromOperand(op.getDpsInitOperand(0)))
+      return rewriter.notifyMatchFailure(op, "not an elementwise generic");
+    auto yield = cast<linalg::YieldOp>(op.getBody()->getTerminator());
+    if (yield.getNumOperands() != 1)
+      return rewriter.notifyMatchFailure(op, "expected a single result");
+    Operation *add = yield.getOperand(0).getDefiningOp();
+    if (!add || !isa<arith::AddFOp, arith::AddIOp>(add) ||
+        add->getBlock() != op.getBody())
+      return rewriter.notifyMatchFailure(op, "payload does not end in an add");
+
+    for (OpOperand *input : op.getDpsInputOperands()) {
+      auto contraction = input->get().getDefiningOp<linalg::LinalgOp>();
+      if (!contraction || !linalg::isaContractionOpInterface(contraction) ||
+          contraction->getNumResults() != 1 || !contraction->hasOneUse() ||
+          contraction->getResult(0).getType() != op.getResultTypes()[0] ||
+          !op.getMatchingIndexingMap(input).isIdentity())
+        continue;
+      // The contraction must only be used as an operand of the final add, so
+      // that the rest of the payload computes the value added to it.
+      BlockArgument arg = op.getMatchingBlockArgument(input);
+      if (!arg.hasOneUse() || *arg.getUsers().begin() != add)
+        continue;
+
+      OpOperand *accumulator = contraction.getDpsInitOperand(0);
+      Operation *newAccumulator = rewriter.clone(*op);
+      newAccumulator->setOperand(input->getOperandNumber(),
+                                 accumulator->get());
+      Operation *newContraction = rewriter.clone(*contraction);
+      newContraction->setOperand(accumulator->getOperandNumber(),
+                                 newAccumulator->getResult(0));
+      rewriter.replaceOp(op, newContraction->getResults());
+      rewriter.eraseOp(contraction);
+      return success();
+    }
+    return rewriter.notifyMatchFailure(
+        op, "no contraction operand that can accumulate the result");
+  }
+};
+} // namespace
+
+namespace {
+class FoldLinalgContractionEpiloguesPass
+    : public FoldLinalgContractionEpiloguesBase<
+          FoldLinalgContractionEpiloguesPass> {
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.add<FoldAddIntoContractionAccumulator>(context);
+    if (failed(applyPatternsAndFoldGreedily(getOperation(),
+                                            std::move(patterns))))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::TorchConversion::createFoldLinalgContractionEpiloguesPass() {
+  return std::make_unique<FoldLinalgContractionEpiloguesPass>();
+}
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::TorchConversion;
+
+// Returns true if `init` is a tensor.empty, or a linalg.fill of one, that has
+// no other use than as the init of the op it is passed to, so that the op can
+// write to another tensor instead.
+static bool isFreshInit(Value init) {
+  if (!init.hasOneUse())
+    return false;
+  if (auto fill = init.getDefiningOp<linalg::FillOp>()) {
+    Value fillInit = fill.getDpsInitOperand(0)->get();
+    return fillInit.hasOneUse() && fillInit.getDefiningOp<tensor::EmptyOp>();
+  }
+  return init.getDefiningOp<tensor::EmptyOp>() != nullptr;
+}
+
+namespace {
+// Makes a linalg op whose result is inserted into a larger tensor write to the
+// slice of that tensor directly:
+//
+//   %init = tensor.empty()
+//   %r = linalg.generic ins(%x) outs(%init)
+//   %cat = tensor.insert_slice %r into %dest[%offsets] [%sizes] [%strides]
+//
+// becomes
+//
+//   %slice = tensor.extract_slice %dest[%offsets] [%sizes] [%strides]
+//   %r = linalg.generic ins(%x) outs(%slice)
+//   %cat = tensor.insert_slice %r into %dest[%offsets] [%sizes] [%strides]
+//
+// An init that is a linalg.fill of a tensor.empty, such as the accumulator of
+// a matmul, is filled on the slice instead. This is the destination passing
+// form that one-shot bufferization writes in place, so that the parts of an
+// `aten.cat` are computed into the result rather than into temporaries that
+// are then copied.
+class WriteProducerIntoInsertSliceDest
+    : public OpRewritePattern<tensor::InsertSliceOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(tensor::InsertSliceOp op,
+                                PatternRewriter &rewriter) const override {
+    auto producer = op.getSource().getDefiningOp<linalg::LinalgOp>();
+    if (!producer || !producer.hasTensorSemantics() ||
+        producer->getNumResults() != 1 || !op.getSource().hasOneUse())
+      return rewriter.notifyMatchFailure(
+          op, "source is not a linalg op only used by the insert");
+    OpOperand *init = producer.getDpsInitOperand(0);
+    if (!isFreshInit(init->get()))
+      return rewriter.notifyMatchFailure(
+          op, "the producer already writes to an existing tensor");
+
+    // The new ops are created right before the insert, where both the
+    // destination and the operands of the producer are available.
+    Location loc = op.getLoc();
+    Value slice = rewriter.create<tensor::ExtractSliceOp>(
+        loc, op.getSourceType(), op.getDest(), op.getMixedOffsets(),
+        op.getMixedSizes(), op.getMixedStrides());
+    if (auto fill = init->get().getDefiningOp<linalg::FillOp>()) {
+      slice = rewriter
+                  .create<linalg::FillOp>(
+                      loc, ValueRange{fill.getDpsInputOperand(0)->get()},
+                      ValueRange{slice})
+                  .getResult(0);
+    }
+    Operation *newProducer = rewriter.clone(*producer);
+    newProducer->setOperand(init->getOperandNumber(), slice);
+    rewriter.updateRootInPlace(op, [&]() {
+      op.getSourceMutable().assign(newProducer->getResult(0));
+    });
+    rewriter.eraseOp(producer);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+class FoldLinalgProducersIntoInsertSlicesPass
+    : public FoldLinalgProducersIntoInsertSlicesBase<
+          FoldLinalgProducersIntoInsertSlicesPass> {
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.add<WriteProducerIntoInsertSliceDest>(context);
+    if (failed(applyPatternsAndFoldGreedily(getOperation(),
+                                            std::move(patterns))))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::TorchConversion::createFoldLinalgProducersIntoInsertSlicesPass() {
+  return std::make_unique<FoldLinalgProducersIntoInsertSlicesPass>();
+}
@@ -0,0 +1,217 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MLProgram/IR/MLProgram.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Transforms/RegionUtils.h"
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::TorchConversion;
+
+// Returns a zero splat of `type` to give a cache global an initial value, or
+// nullptr if the element type isn't an int or float.
+static Attribute getZeroAttr(RankedTensorType type) {
+  Type elementType = type.getElementType();
+  if (auto floatType = elementType.dyn_cast<mlir::FloatType>())
+    return DenseElementsAttr::get(type, FloatAttr::get(floatType, 0));
+  if (auto intType = elementType.dyn_cast<IntegerType>())
+    return DenseElementsAttr::get(type, IntegerAttr::get(intType, 0));
+  return nullptr;
+}
+
+// Returns true if `op` computes its results from the contents of a tensor,
+// as opposed to filling them from scalars or splats, which is cheap to redo.
+static bool readsTensorData(Operation *op) {
+  if (op->getNumRegions() == 0)
+    return false;
+  return llvm::any_of(op->getOperands(), [](Value operand) {
+    if (!operand.getType().isa<RankedTensorType>() ||
+        operand.getDefiningOp<tensor::EmptyOp>())
+      return false;
+    DenseElementsAttr splat;
+    return !matchPattern(operand, m_Constant(&splat)) || !splat.isSplat();
+  });
+}
+
+namespace {
+// The ops at the top level of a function that only depend on constants, and
+// the subset of their results worth caching.
+struct ConstantComputations {
+  // In the order of the function.
+  SmallVector<Operation *> ops;
+  DenseSet<Operation *> opSet;
+  // The tensors computed from the contents of constants, which are used by
+  // the rest of the function.
+  SmallVector<Value> roots;
+};
+} // namespace
+
+static ConstantComputations findConstantComputations(func::FuncOp func) {
+  ConstantComputations result;
+  // The constant ops whose result is the result of a computation, as opposed
+  // to a constant or a view of one.
+  DenseSet<Operation *> computes;
+  auto isConstant = [&](Value value) {
+    Operation *producer = value.getDefiningOp();
+    return producer && result.opSet.contains(producer);
+  };
+  for (Operation &op : func.getBody().front()) {
+    if (op.getNumResults() == 0 || !isMemoryEffectFree(&op) ||
+        !llvm::all_of(op.getOperands(), isConstant))
+      continue;
+    SetVector<Value> capturedValues;
+    getUsedValuesDefinedAbove(op.getRegions(), capturedValues);
+    if (!llvm::all_of(capturedValues, isConstant))
+      continue;
+    result.ops.push_back(&op);
+    result.opSet.insert(&op);
+    if (readsTensorData(&op) ||
+        llvm::any_of(op.getOperands(), [&](Value operand) {
+          return computes.contains(operand.getDefiningOp());
+        }))
+      computes.insert(&op);
+  }
+  for (Operation *op : result.ops) {
+    if (!computes.contains(op))
+      continue;
+    for (Value value : op->getResults()) {
+      auto type = value.getType().dyn_cast<RankedTensorType>();
+      if (!type || !type.hasStaticShape() || !getZeroAttr(type))
+        continue;
+      if (llvm::any_of(value.getUsers(), [&](Operation *user) {
+            return !result.opSet.contains(user);
+          }))
+        result.roots.push_back(value);
+    }
+  }
+  return result;
+}
+
+namespace {
+class HoistConstantComputationsPass
+    : public HoistConstantComputationsBase<HoistConstantComputationsPass> {
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    SymbolTable symbolTable(module);
+    MLIRContext *context = &getContext();
+    Location loc = module.getLoc();
+    OpBuilder moduleBuilder(context);
+    auto createGlobal = [&](StringRef name, RankedTensorType type,
+                            Attribute value) {
+      moduleBuilder.setInsertionPointToStart(module.getBody());
+      auto global = moduleBuilder.create<ml_program::GlobalOp>(
+          loc, name, type, /*is_mutable=*/true, value,
+          /*sym_visibility=*/moduleBuilder.getStringAttr("private"));
+      symbolTable.insert(global);
+      return global;
+    };
+
+    func::FuncOp initFunc;
+    ml_program::GlobalOp initializedGlobal;
+    for (auto func : llvm::to_vector(module.getOps<func::FuncOp>())) {
+      if (func.isDeclaration())
+        continue;
+      ConstantComputations computations = findConstantComputations(func);
+      if (computations.roots.empty())
+        continue;
+
+      // The function computing the cached values, and the flag recording
+      // whether it has run.
+      auto i1TensorType = RankedTensorType::get({}, moduleBuilder.getI1Type());
+      if (!initFunc) {
+        initializedGlobal = createGlobal(
+            "__hoisted_initialized", i1TensorType,
+            DenseElementsAttr::get(i1TensorType, false));
+        moduleBuilder.setInsertionPointToEnd(module.getBody());
+        initFunc = moduleBuilder.create<func::FuncOp>(
+            loc, "__initialize_hoisted", FunctionType::get(context, {}, {}));
+        initFunc.setPrivate();
+        symbolTable.insert(initFunc);
+        OpBuilder::atBlockEnd(initFunc.addEntryBlock())
+            .create<func::ReturnOp>(loc);
+      }
+
+      // Compute the roots in the initializer and cache them in globals.
+      OpBuilder initBuilder =
+          OpBuilder::atBlockTerminator(&initFunc.getBody().front());
+      IRMapping mapping;
+      SmallVector<Operation *> clones;
+      for (Operation *op : computations.ops)
+        clones.push_back(initBuilder.clone(*op, mapping));
+      SmallVector<ml_program::GlobalOp> globals;
+      for (Value root : computations.roots) {
+        auto type = root.getType().cast<RankedTensorType>();
+        ml_program::GlobalOp global =
+            createGlobal("__hoisted", type, getZeroAttr(type));
+        initBuilder.create<ml_program::GlobalStoreOp>(
+            root.getLoc(), FlatSymbolRefAttr::get(global.getSymNameAttr()),
+            mapping.lookup(root));
+        globals.push_back(global);
+      }
+      // Only keep what the cached results depend on.
+      for (Operation *clone : llvm::reverse(clones)) {
+        if (isOpTriviallyDead(clone))
+          clone->erase();
+      }
+
+      // Run the initializer on the first call, then load the cached values.
+      Block &entry = func.getBody().front();
+      OpBuilder builder = OpBuilder::atBlockBegin(&entry);
+      auto initializedSymbol =
+          FlatSymbolRefAttr::get(initializedGlobal.getSymNameAttr());
+      Value initialized = builder.create<tensor::ExtractOp>(
+          loc, builder.create<ml_program::GlobalLoadOp>(loc, i1TensorType,
+                                                         initializedSymbol),
+          ValueRange());
+      Value isFirstCall = builder.create<arith::XOrIOp>(
+          loc, initialized,
+          builder.create<arith::ConstantIntOp>(loc, 1, /*width=*/1));
+      auto ifOp = builder.create<scf::IfOp>(loc, isFirstCall,
+                                            /*withElseRegion=*/false);
+      {
+        OpBuilder::InsertionGuard guard(builder);
+        builder.setInsertionPointToStart(ifOp.thenBlock());
+        builder.create<func::CallOp>(loc, initFunc);
+        builder.create<ml_program::GlobalStoreOp>(
+            loc, initializedSymbol,
+            builder.create<arith::ConstantOp>(
+                loc, DenseElementsAttr::get(i1TensorType, true)));
+      }
+      for (auto [root, global] : llvm::zip(computations.roots, globals)) {
+        Value cached = builder.create<ml_program::GlobalLoadOp>(
+            root.getLoc(), root.getType(),
+            FlatSymbolRefAttr::get(global.getSymNameAttr()));
+        root.replaceAllUsesWith(cached);
+      }
+      for (Operation *op : llvm::reverse(computations.ops)) {
+        if (op->use_empty())
+          op->erase();
+      }
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>>
+mlir::torch::TorchConversion::createHoistConstantComputationsPass() {
+  return std::make_unique<HoistConstantComputationsPass>();
+}
@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MLProgram/IR/MLProgram.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/SymbolTable.h"
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::TorchConversion;
+
+// Returns the value of `op` if it is a constant that is worth storing once as
+// a global: a statically shaped tensor of at least `minElements` elements
+// that isn't a splat.
+static ElementsAttr getHoistableValue(arith::ConstantOp op,
+                                      int64_t minElements) {
+  auto type = op.getType().dyn_cast<RankedTensorType>();
+  auto value = op.getValue().dyn_cast<ElementsAttr>();
+  if (!type || !type.hasStaticShape() || !value ||
+      type.getNumElements() < minElements)
+    return nullptr;
+  if (auto dense = value.dyn_cast<DenseElementsAttr>()) {
+    if (dense.isSplat())
+      return nullptr;
+  }
+  return value;
+}
+
+namespace {
+class HoistTensorConstantsToGlobalsPass
+    : public HoistTensorConstantsToGlobalsBase<
+          HoistTensorConstantsToGlobalsPass> {
+public:
+  HoistTensorConstantsToGlobalsPass() = default;
+  HoistTensorConstantsToGlobalsPass(int64_t minElements) {
+    this->minElements = minElements;
+  }
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    SymbolTable symbolTable(module);
+    OpBuilder moduleBuilder(module.getBodyRegion());
+    // The attributes are uniqued together with their type, so equal
+    // constants map to the same global.
+    DenseMap<Attribute, ml_program::GlobalOp> globals;
+    module.walk([&](func::FuncOp func) {
+      func.walk([&](arith::ConstantOp op) {
+        ElementsAttr value = getHoistableValue(op, minElements);
+        if (!value)
+          return;
+        ml_program::GlobalOp &global = globals[value];
+        if (!global) {
+          moduleBuilder.setInsertionPointToStart(module.getBody());
+          global = moduleBuilder.create<ml_program::GlobalOp>(
+              op.getLoc(), /*sym_name=*/"__constant", /*type=*/op.getType(),
+              /*is_mutable=*/false, /*value=*/value,
+              /*sym_visibility=*/moduleBuilder.getStringAttr("private"));
+          // Renames the global if the name is already taken.
+          symbolTable.insert(global);
+        }
+        OpBuilder builder(op);
+        Value load = builder.create<ml_program::GlobalLoadConstOp>(
+            op.getLoc(), op.getType(),
+            FlatSymbolRefAttr::get(global.getSymNameAttr()));
+        op.replaceAllUsesWith(load);
+        op.erase();
+      });
+    });
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>>
+mlir::torch::TorchConversion::createHoistTensorConstantsToGlobalsPass(
+    int64_t minElements) {
+  return std::make_unique<HoistTensorConstantsToGlobalsPass>(minElements);
+}
@@ -0,0 +1,307 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/Analysis/DataFlow/DeadCodeAnalysis.h"
+#include "mlir/Analysis/DataFlow/IntegerRangeAnalysis.h"
+#include "mlir/Analysis/DataFlowFramework.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::TorchConversion;
+
+// Moves the scalar ops of the body of `generic` that don't depend on the
+// elements or the iteration indices before it, so that they run once rather
+// than for every element. Only pure ops are moved, since the body doesn't run
+// at all when the iteration domain is empty, and an op like a division by a
+// value that may be zero can't be executed speculatively.
+static void hoistInvariantScalarOps(linalg::GenericOp generic) {
+  Region &body = generic.getRegion();
+  for (Operation &op : llvm::make_early_inc_range(body.getOps())) {
+    if (op.hasTrait<OpTrait::IsTerminator>() || isa<linalg::IndexOp>(op) ||
+        op.getNumRegions() != 0 || !isPure(&op))
+      continue;
+    if (llvm::any_of(op.getOperands(), [&](Value operand) {
+          return body.isAncestor(operand.getParentRegion());
+        }))
+      continue;
+    op.moveBefore(generic);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Integers.
+//===----------------------------------------------------------------------===//
+
+// Returns the number of bits of the smallest signed integer type that holds
+// all the values that `value` can take according to `solver`, or
+// std::nullopt if they aren't known.
+static std::optional<unsigned> getSignedBitWidth(DataFlowSolver &solver,
+                                                 Value value) {
+  auto *lattice =
+      solver.lookupState<dataflow::IntegerValueRangeLattice>(value);
+  if (!lattice || lattice->getValue().isUninitialized())
+    return std::nullopt;
+  const ConstantIntRanges &range = lattice->getValue().getValue();
+  return std::max(range.smin().getMinSignedBits(),
+                  range.smax().getMinSignedBits());
+}
+
+// Returns true if all the values that `value` can take, according to
+// `solver`, are `bitWidth`-bit signed integers.
+static bool fitsInSignedBits(DataFlowSolver &solver, Value value,
+                             unsigned bitWidth) {
+  std::optional<unsigned> signedBitWidth = getSignedBitWidth(solver, value);
+  return signedBitWidth && *signedBitWidth <= bitWidth;
+}
+
+// Computes the integer ops on i64 whose operands and result provably fit in
+// i32 in i32 instead:
+//
+//   %a = arith.extsi %x : i32 to i64
+//   %0 = arith.remsi %a, %c7 : i64
+//
+// becomes
+//
+//   %c7_i32 = arith.constant 7 : i32
+//   %0_i32 = arith.remsi %x, %c7_i32 : i32
+//   %0 = arith.extsi %0_i32 : i32 to i64
+//
+// Since the result fits in i32, the i32 op can't overflow and computes the
+// same value. Only the ops whose operands are already narrow, either because
+// they are constants, extensions of narrow integers or results of narrowed
+// ops, are narrowed, so that narrowing doesn't add more casts than it saves.
+// The extension of the result folds away when it is itself only used by
+// narrowed ops.
+static void narrowIntegerArithmetic(func::FuncOp func, DataFlowSolver &solver) {
+  constexpr unsigned kNarrowWidth = 32;
+  auto isNarrowSource = [](Value value) {
+    if (matchPattern(value, m_Constant()))
+      return true;
+    auto extension = value.getDefiningOp<arith::ExtSIOp>();
+    return extension &&
+           extension.getIn().getType().getIntOrFloatBitWidth() <= kNarrowWidth;
+  };
+
+  SmallVector<Operation *> candidates;
+  func.walk([&](Operation *op) {
+    if (!isa<arith::AddIOp, arith::SubIOp, arith::MulIOp, arith::DivSIOp,
+             arith::RemSIOp, arith::CeilDivSIOp, arith::FloorDivSIOp,
+             arith::MaxSIOp, arith::MinSIOp, arith::AndIOp, arith::OrIOp,
+             arith::XOrIOp, arith::CmpIOp>(op))
+      return;
+    auto type = op->getOperand(0).getType().dyn_cast<IntegerType>();
+    if (!type || type.getWidth() <= kNarrowWidth)
+      return;
+    auto fits = [&](Value value) {
+      return fitsInSignedBits(solver, value, kNarrowWidth);
+    };
+    if (!llvm::all_of(op->getOperands(), fits) ||
+        (!isa<arith::CmpIOp>(op) && !fits(op->getResult(0))))
+      return;
+    candidates.push_back(op);
+  });
+
+  // The narrowed results of the ops narrowed so far.
+  DenseMap<Value, Value> narrowedValues;
+  IRRewriter rewriter(func.getContext());
+  Type narrowType = rewriter.getIntegerType(kNarrowWidth);
+  for (Operation *op : candidates) {
+    if (!llvm::all_of(op->getOperands(), [&](Value operand) {
+          return narrowedValues.count(operand) || isNarrowSource(operand);
+        }))
+      continue;
+    rewriter.setInsertionPoint(op);
+    Location loc = op->getLoc();
+    SmallVector<Value> operands;
+    for (Value operand : op->getOperands()) {
+      Value narrowed = narrowedValues.lookup(operand);
+      operands.push_back(narrowed ? narrowed
+                                  : rewriter.createOrFold<arith::TruncIOp>(
+                                        loc, narrowType, operand));
+    }
+    // Comparisons still produce an i1. Sign extension preserves both the
+    // signed and the unsigned order, so truncating the operands doesn't
+    // change the result of any predicate.
+    Type resultType =
+        isa<arith::CmpIOp>(op) ? op->getResult(0).getType() : narrowType;
+    OperationState state(loc, op->getName(), operands, resultType,
+                         op->getAttrs());
+    Value narrowResult = rewriter.create(state)->getResult(0);
+    if (isa<arith::CmpIOp>(op)) {
+      rewriter.replaceOp(op, narrowResult);
+      continue;
+    }
+    Value wideResult = rewriter.create<arith::ExtSIOp>(
+        loc, op->getResult(0).getType(), narrowResult);
+    narrowedValues[wideResult] = narrowResult;
+    rewriter.replaceOp(op, wideResult);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Floats.
+//===----------------------------------------------------------------------===//
+
+// The number of bits of the signed integers converted by each
+// `arith.sitofp`, computed before anything is rewritten.
+using ConversionBitWidths = DenseMap<Operation *, unsigned>;
+
+// Returns true if `value` is exactly representable as a float of type
+// `narrowType` without computing anything that wasn't computed before.
+static bool isExactlyNarrowable(const ConversionBitWidths &conversionBitWidths,
+                                Value value, mlir::FloatType narrowType) {
+  if (auto extension = value.getDefiningOp<arith::ExtFOp>())
+    return extension.getIn().getType() == narrowType;
+  FloatAttr constant;
+  if (matchPattern(value, m_Constant(&constant))) {
+    APFloat narrowed = constant.getValue();
+    bool losesInfo;
+    narrowed.convert(narrowType.getFloatSemantics(),
+                     APFloat::rmNearestTiesToEven, &losesInfo);
+    return !losesInfo;
+  }
+  // The integers whose magnitude is at most 2^p convert exactly to a float
+  // type of precision p.
+  if (auto conversion = value.getDefiningOp<arith::SIToFPOp>()) {
+    auto it = conversionBitWidths.find(conversion);
+    return it != conversionBitWidths.end() &&
+           it->second <=
+               APFloat::semanticsPrecision(narrowType.getFloatSemantics()) + 1;
+  }
+  return false;
+}
+
+// Returns `value`, which `isExactlyNarrowable`, as a float of type
+// `narrowType`.
+static Value createNarrowed(OpBuilder &builder, Value value,
+                            mlir::FloatType narrowType) {
+  Location loc = value.getLoc();
+  if (auto extension = value.getDefiningOp<arith::ExtFOp>())
+    return extension.getIn();
+  if (auto conversion = value.getDefiningOp<arith::SIToFPOp>())
+    return builder.create<arith::SIToFPOp>(loc, narrowType,
+                                           conversion.getIn());
+  FloatAttr constant;
+  matchPattern(value, m_Constant(&constant));
+  APFloat narrowed = constant.getValue();
+  bool losesInfo;
+  narrowed.convert(narrowType.getFloatSemantics(),
+                   APFloat::rmNearestTiesToEven, &losesInfo);
+  return builder.create<arith::ConstantOp>(
+      loc, builder.getFloatAttr(narrowType, narrowed));
+}
+
+// Computes the float ops in the type their result is truncated to when their
+// operands are exactly representable in that type:
+//
+//   %a_f64 = arith.extf %a : f32 to f64
+//   %b_f64 = arith.extf %b : f32 to f64
+//   %0 = arith.mulf %a_f64, %b_f64 : f64
+//   %1 = arith.truncf %0 : f64 to f32
+//
+// becomes
+//
+//   %1 = arith.mulf %a, %b : f32
+//
+// The result of an add, sub, mul or div of two floats, rounded to a float
+// type with at least 2p + 2 bits of precision and then to their type of
+// precision p, is the same as when it is rounded to their type directly
+// (Figueroa, "When is double rounding innocuous?"), which holds from f64
+// to f32 and from f32 to f16 and bf16. The other ops narrowed here are
+// exact. Each narrowed op must have exact operands, since a chain of wide
+// ops rounds only its final result, so only an op whose operands come from
+// extensions, conversions or constants is narrowed, and a wide op feeding
+// another one is left as is. The wide op stays for its other users and is
+// erased when the truncation was its only one.
+static void
+narrowFloatArithmetic(func::FuncOp func,
+                      const ConversionBitWidths &conversionBitWidths) {
+  SmallVector<arith::TruncFOp> truncations;
+  func.walk([&](arith::TruncFOp op) { truncations.push_back(op); });
+  IRRewriter rewriter(func.getContext());
+  for (arith::TruncFOp op : truncations) {
+    auto narrowType = op.getType().dyn_cast<mlir::FloatType>();
+    auto wideType = op.getIn().getType().dyn_cast<mlir::FloatType>();
+    if (!narrowType || !wideType)
+      continue;
+    Operation *producer = op.getIn().getDefiningOp();
+    if (!producer || !isa<arith::AddFOp, arith::SubFOp, arith::MulFOp,
+                          arith::DivFOp, arith::NegFOp, arith::MaxFOp,
+                          arith::MinFOp>(producer))
+      continue;
+    unsigned narrowPrecision =
+        APFloat::semanticsPrecision(narrowType.getFloatSemantics());
+    unsigned widePrecision =
+        APFloat::semanticsPrecision(wideType.getFloatSemantics());
+    if (widePrecision < 2 * narrowPrecision + 2)
+      continue;
+    if (!llvm::all_of(producer->getOperands(), [&](Value operand) {
+          return isExactlyNarrowable(conversionBitWidths, operand,
+                                     narrowType);
+        }))
+      continue;
+
+    rewriter.setInsertionPoint(producer);
+    SmallVector<Value> operands;
+    for (Value operand : producer->getOperands())
+      operands.push_back(createNarrowed(rewriter, operand, narrowType));
+    OperationState state(producer->getLoc(), producer->getName(), operands,
+                         narrowType, producer->getAttrs());
+    rewriter.replaceOp(op, rewriter.create(state)->getResults());
+  }
+}
+
+namespace {
+class NarrowScalarArithmeticPass
+    : public NarrowScalarArithmeticBase<NarrowScalarArithmeticPass> {
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+    func.walk(hoistInvariantScalarOps);
+
+    // The ranges are looked up before anything is rewritten, since the
+    // solver doesn't know about the values created by the rewrites.
+    DataFlowSolver solver;
+    solver.load<dataflow::DeadCodeAnalysis>();
+    solver.load<dataflow::IntegerRangeAnalysis>();
+    if (failed(solver.initializeAndRun(func)))
+      return signalPassFailure();
+    ConversionBitWidths conversionBitWidths;
+    func.walk([&](arith::SIToFPOp op) {
+      if (std::optional<unsigned> bitWidth =
+              getSignedBitWidth(solver, op.getIn()))
+        conversionBitWidths[op] = *bitWidth;
+    });
+    narrowIntegerArithmetic(func, solver);
+    narrowFloatArithmetic(func, conversionBitWidths);
+
+    // Fold away the casts between the narrowed ops.
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    arith::TruncIOp::getCanonicalizationPatterns(patterns, context);
+    arith::ExtSIOp::getCanonicalizationPatterns(patterns, context);
+    if (failed(applyPatternsAndFoldGreedily(func, std::move(patterns))))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::TorchConversion::createNarrowScalarArithmeticPass() {
+  return std::make_unique<NarrowScalarArithmeticPass>();
+}
@@ -41,7 +41,8 @@ namespace reg {
 
 void mlir::torch::registerTorchConversionPasses() {
   reg::registerPasses();
-  mlir::PassPipelineRegistration<>(
+  mlir::PassPipelineRegistration<
+      TorchConversion::LinalgOnTensorsBackendPipelineOptions>(
       "torch-backend-to-linalg-on-tensors-backend-pipeline",
       "Pipeline lowering torch backend contract to linalg-on-tensors backend "
       "contract.",
@@ -63,13 +64,15 @@ void mlir::torch::registerTorchConversionPasses() {
 }
 
 void TorchConversion::createTorchBackendToLinalgOnTensorsBackendPipeline(
-    OpPassManager &pm) {
+    OpPassManager &pm,
+    const TorchConversion::LinalgOnTensorsBackendPipelineOptions &options) {
   // Lower to linalg + guards which is the input to codegen backends.
   // We do this first as it tends to involve pattern-matching against constants,
   // (e.g. dimensions which must be constant in a ranked programming model)
   // and those constants get somewhat obscured by TorchToArith.
   pm.addNestedPass<func::FuncOp>(createConvertTorchToTMTensorPass());
-  pm.addNestedPass<func::FuncOp>(createConvertTorchToLinalgPass());
+  pm.addNestedPass<func::FuncOp>(
+      createConvertTorchToLinalgPass(/*convNhwc=*/options.channelsLast));
   pm.addNestedPass<func::FuncOp>(createConvertTorchToSCFPass());
   pm.addNestedPass<func::FuncOp>(createConvertTorchToArithPass());
   pm.addPass(createConvertTorchConversionToMLProgramPass());
@@ -83,6 +86,43 @@ void TorchConversion::createTorchBackendToLinalgOnTensorsBackendPipeline(
       memref::createResolveShapedTypeResultDimsPass());
   // The resolution of `dim` ops tends to create identical ops. CSE them.
   pm.addNestedPass<func::FuncOp>(createCSEPass());
+  // Erase the asserts on the sizes that are now known to be equal, which
+  // keeps them from getting in the way of fusion and vectorization.
+  pm.addNestedPass<func::FuncOp>(
+      TorchConversion::createSimplifyRuntimeAssertsPass(options.trustShapes));
+  // Keep the size computations in `index` rather than casting them back and
+  // forth to the `i64` that `!torch.int` is lowered to.
+  pm.addNestedPass<func::FuncOp>(
+      TorchConversion::createSimplifyIndexCastsPass());
+  if (options.narrowScalars) {
+    // Compute the scalars in i32 and f32 where that is exact, which is much
+    // faster than i64 and f64 on many GPUs and accelerators.
+    pm.addNestedPass<func::FuncOp>(
+        TorchConversion::createNarrowScalarArithmeticPass());
+  }
+
+  if (options.channelsLast) {
+    // The NHWC convolutions come with transposes around them. Cancel the
+    // ones between consecutive convolutions.
+    pm.addNestedPass<func::FuncOp>(
+        TorchConversion::createPropagateLinalgTransposesPass());
+    pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
+    pm.addNestedPass<func::FuncOp>(createCSEPass());
+  }
+
+  if (options.fuseElementwise) {
+    // TorchToLinalg emits a linalg.generic with its own tensor.empty init per
+    // elementwise op. Fuse the chains of them, so that backends that don't
+    // run fusion themselves don't materialize every intermediate tensor.
+    // This runs after the transposes have been propagated, since fusing them
+    // into their users would keep them from cancelling out. Bias and residual
+    // adds are first folded into the accumulators of the matmuls they follow,
+    // so that they get fused with the initialization of the accumulator.
+    pm.addNestedPass<func::FuncOp>(
+        TorchConversion::createFoldLinalgContractionEpiloguesPass());
+    pm.addNestedPass<func::FuncOp>(createLinalgElementwiseOpFusionPass());
+    pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
+  }
 
   // Finish the type conversion from `torch` types to the types of the
   // linalg-on-tensors backend contract.
@@ -91,6 +131,17 @@ void TorchConversion::createTorchBackendToLinalgOnTensorsBackendPipeline(
   pm.addNestedPass<func::FuncOp>(
       TorchConversion::createFinalizingBackendTypeConversionPass());
 
+  if (options.hoistWeightComputations) {
+    // Compute the preprocessing of the weights, such as transposes and
+    // quantization, once instead of on every call.
+    pm.addPass(TorchConversion::createHoistConstantComputationsPass());
+  }
+  if (options.hoistConstants) {
+    // Store the weights once for all the functions of the module, now that
+    // they have been canonicalized and CSE'd within each function.
+    pm.addPass(TorchConversion::createHoistTensorConstantsToGlobalsPass());
+  }
+
   // Verify that we have lowered to the form that linalg on tensors backends
   // expect. This fails compilation (signalPassFailure) if the IR is not in the
   // correct form.
@@ -102,6 +153,10 @@ void TorchConversion::createTorchBackendToTosaBackendPipeline(
   pm.addNestedPass<func::FuncOp>(createConvertTorchToTosaPass());
   // Perform rank broadcasting so TosaToLinalg pass works
   pm.addNestedPass<func::FuncOp>(createTosaMakeBroadcastablePass());
+  // The convolutions and pooling ops come with NCHW<->NHWC transposes around
+  // them. Cancel the ones between consecutive layers.
+  pm.addNestedPass<func::FuncOp>(
+      TorchConversion::createPropagateTosaTransposesPass());
 
   // Clean up any non-canonical code introduced above..
   pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
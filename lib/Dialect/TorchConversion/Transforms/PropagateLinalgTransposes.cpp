@@ -0,0 +1,402 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/IndexingUtils.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Conversion/Utils/Utils.h"
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::TorchConversion;
+
+// Throughout this file, a transpose with permutation `p` is an op whose
+// result dimension `i` is dimension `p[i]` of its input.
+
+// Returns true if all the loops of `op` are parallel, it has a single result
+// that is written with the identity map, and the payload doesn't read the
+// initial value of the result.
+static bool isElementwiseGeneric(linalg::GenericOp op) {
+  if (!op.hasTensorSemantics() || op.getNumDpsInits() != 1 ||
+      op.getNumParallelLoops() != op.getNumLoops())
+    return false;
+  OpOperand *init = op.getDpsInitOperand(0);
+  return op.getMatchingIndexingMap(init).isIdentity() &&
+         !op.payloadUsesValueFromOperand(init);
+}
+
+// Returns the permutation of `op` if it is a transpose, i.e. a
+// linalg.generic that only copies its single input to a permutation of it.
+static std::optional<SmallVector<int64_t>>
+getTransposePermutation(Operation *op) {
+  auto generic = dyn_cast_or_null<linalg::GenericOp>(op);
+  if (!generic || !generic.hasTensorSemantics() ||
+      generic.getNumDpsInputs() != 1 || generic.getNumDpsInits() != 1 ||
+      generic.getNumParallelLoops() != generic.getNumLoops() ||
+      !llvm::hasSingleElement(*generic.getBody()))
+    return std::nullopt;
+  auto yield = cast<linalg::YieldOp>(generic.getBody()->getTerminator());
+  if (yield.getOperand(0) != generic.getBody()->getArgument(0))
+    return std::nullopt;
+  AffineMap inputMap =
+      generic.getMatchingIndexingMap(generic.getDpsInputOperand(0));
+  AffineMap outputMap =
+      generic.getMatchingIndexingMap(generic.getDpsInitOperand(0));
+  if (!inputMap.isPermutation() || !outputMap.isPermutation())
+    return std::nullopt;
+  // Dimension `i` of the result and dimension `inputDims[loop]` of the input
+  // are both iterated over by the loop `outputMap.getDimPosition(i)`.
+  SmallVector<int64_t> inputDims(inputMap.getNumResults());
+  for (unsigned i = 0; i < inputMap.getNumResults(); i++)
+    inputDims[inputMap.getDimPosition(i)] = i;
+  SmallVector<int64_t> permutation;
+  for (unsigned i = 0; i < outputMap.getNumResults(); i++)
+    permutation.push_back(inputDims[outputMap.getDimPosition(i)]);
+  return permutation;
+}
+
+// Replaces `op` with `value`, casting it to the type of the result of `op` if
+// the static information in the types differs.
+static void replaceWithCast(PatternRewriter &rewriter, Operation *op,
+                            Value value) {
+  Type resultType = op->getResult(0).getType();
+  if (value.getType() != resultType)
+    value = rewriter.create<tensor::CastOp>(op->getLoc(), resultType, value);
+  rewriter.replaceOp(op, value);
+}
+
+// Returns the indexing maps of the inputs of `op`, an elementwise
+// linalg.generic, in a permuted iteration space where loop `i` of `op` is
+// loop `newLoops[i]`.
+static SmallVector<AffineMap>
+remapInputIndexingMaps(linalg::GenericOp op, ArrayRef<int64_t> newLoops) {
+  SmallVector<AffineExpr> exprs;
+  for (int64_t loop : newLoops)
+    exprs.push_back(getAffineDimExpr(loop, op.getContext()));
+  AffineMap substitution = AffineMap::get(newLoops.size(), /*symbolCount=*/0,
+                                          exprs, op.getContext());
+  SmallVector<AffineMap> maps;
+  for (OpOperand *input : op.getDpsInputOperands())
+    maps.push_back(op.getMatchingIndexingMap(input).compose(substitution));
+  return maps;
+}
+
+// Creates the elementwise linalg.generic `op` in a permuted iteration space,
+// where loop `i` of `op` is loop `newLoops[i]` of the new op, with
+// `inputs` and `inputMaps` and writing into `init`.
+static Value createPermutedGeneric(PatternRewriter &rewriter,
+                                   linalg::GenericOp op, ValueRange inputs,
+                                   ArrayRef<AffineMap> inputMaps, Value init,
+                                   ArrayRef<int64_t> newLoops) {
+  SmallVector<AffineMap> indexingMaps(inputMaps);
+  indexingMaps.push_back(rewriter.getMultiDimIdentityMap(newLoops.size()));
+  auto newOp = rewriter.create<linalg::GenericOp>(
+      op.getLoc(), init.getType(), inputs, init, indexingMaps,
+      op.getIteratorTypesArray());
+  rewriter.inlineRegionBefore(op.getRegion(), newOp.getRegion(),
+                              newOp.getRegion().begin());
+  newOp.getBody()->walk([&](linalg::IndexOp index) {
+    rewriter.updateRootInPlace(
+        index, [&]() { index.setDim(newLoops[index.getDim()]); });
+  });
+  return newOp.getResult(0);
+}
+
+namespace {
+// Folds a transpose of a transpose into a single transpose, or removes both if
+// they cancel out.
+class FoldTransposeOfTranspose : public OpRewritePattern<linalg::GenericOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(linalg::GenericOp op,
+                                PatternRewriter &rewriter) const override {
+    std::optional<SmallVector<int64_t>> outer = getTransposePermutation(op);
+    if (!outer)
+      return rewriter.notifyMatchFailure(op, "not a transpose");
+    Value input = op.getDpsInputOperand(0)->get();
+    Operation *producer = input.getDefiningOp();
+    std::optional<SmallVector<int64_t>> inner =
+        getTransposePermutation(producer);
+    if (!inner)
+      return rewriter.notifyMatchFailure(op, "input is not a transpose");
+
+    Value source = producer->getOperand(0);
+    SmallVector<int64_t> permutation;
+    for (int64_t dim : *outer)
+      permutation.push_back((*inner)[dim]);
+    if (isIdentityPermutation(permutation)) {
+      replaceWithCast(rewriter, op, source);
+      return success();
+    }
+    Value transpose =
+        Torch::permuteTensor(rewriter, op.getLoc(), source, permutation);
+    replaceWithCast(rewriter, op, transpose);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Rewrites an elementwise op with a transposed input to work on the layout of
+// the input before the transpose, and transposes its result instead:
+//
+//   elementwise(transpose(x), y) -> transpose(elementwise'(x, y'))
+//
+// where `y'` is `y` accessed with the permuted indexing map. All the other
+// transposed inputs are read through their indexing maps too.
+class SinkTransposeThroughElementwise
+    : public OpRewritePattern<linalg::GenericOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(linalg::GenericOp op,
+                                PatternRewriter &rewriter) const override {
+    if (!isElementwiseGeneric(op) || getTransposePermutation(op))
+      return rewriter.notifyMatchFailure(op, "not an elementwise op");
+
+    // Pick the layout of the first input that is transposed in full.
+    std::optional<SmallVector<int64_t>> permutation;
+    Value source;
+    for (OpOperand *input : op.getDpsInputOperands()) {
+      if (!op.getMatchingIndexingMap(input).isIdentity())
+        continue;
+      Operation *producer = input->get().getDefiningOp();
+      if ((permutation = getTransposePermutation(producer))) {
+        source = producer->getOperand(0);
+        break;
+      }
+    }
+    if (!permutation)
+      return rewriter.notifyMatchFailure(op, "no transposed input");
+
+    // Loop `i` of `op` iterates over dimension `permutation[i]` of `source`,
+    // which is loop `permutation[i]` of the new op.
+    SmallVector<AffineMap> inputMaps =
+        remapInputIndexingMaps(op, *permutation);
+    SmallVector<Value> inputs;
+    for (auto [input, map] : llvm::zip(op.getDpsInputOperands(), inputMaps)) {
+      Operation *producer = input->get().getDefiningOp();
+      std::optional<SmallVector<int64_t>> inputPermutation =
+          getTransposePermutation(producer);
+      if (!inputPermutation) {
+        inputs.push_back(input->get());
+        continue;
+      }
+      // Read the transposed tensor directly: its dimension `j` is dimension
+      // `inputPermutation[j]` of the source of the transpose.
+      SmallVector<AffineExpr> exprs(map.getNumResults());
+      for (unsigned j = 0; j < map.getNumResults(); j++)
+        exprs[(*inputPermutation)[j]] = map.getResult(j);
+      map = AffineMap::get(map.getNumDims(), /*symbolCount=*/0, exprs,
+                           op.getContext());
+      inputs.push_back(producer->getOperand(0));
+    }
+
+    Location loc = op.getLoc();
+    auto sourceType = source.getType().cast<RankedTensorType>();
+    SmallVector<Value> dynamicDims;
+    for (int64_t i = 0; i < sourceType.getRank(); i++) {
+      if (sourceType.isDynamicDim(i))
+        dynamicDims.push_back(rewriter.create<tensor::DimOp>(loc, source, i));
+    }
+    Value init = rewriter.create<tensor::EmptyOp>(
+        loc, sourceType.getShape(),
+        op.getResultTypes()[0].cast<RankedTensorType>().getElementType(),
+        dynamicDims);
+    Value result = createPermutedGeneric(rewriter, op, inputs, inputMaps,
+                                         init, *permutation);
+    replaceWithCast(rewriter, op,
+                    Torch::permuteTensor(rewriter, loc, result, *permutation));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Pads before a transpose instead of after it, if the padding value is a
+// constant.
+class SinkTransposeThroughPad : public OpRewritePattern<tensor::PadOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(tensor::PadOp op,
+                                PatternRewriter &rewriter) const override {
+    Operation *producer = op.getSource().getDefiningOp();
+    std::optional<SmallVector<int64_t>> permutation =
+        getTransposePermutation(producer);
+    if (!permutation)
+      return rewriter.notifyMatchFailure(op, "source is not a transpose");
+    Value padValue = op.getConstantPaddingValue();
+    if (!padValue)
+      return rewriter.notifyMatchFailure(op, "non-constant padding value");
+
+    SmallVector<OpFoldResult> low = op.getMixedLowPad();
+    SmallVector<OpFoldResult> high = op.getMixedHighPad();
+    SmallVector<OpFoldResult> newLow(low.size()), newHigh(high.size());
+    SmallVector<int64_t> newShape(low.size());
+    for (auto [i, dim] : llvm::enumerate(*permutation)) {
+      newLow[dim] = low[i];
+      newHigh[dim] = high[i];
+      newShape[dim] = op.getResultType().getDimSize(i);
+    }
+    Value source = producer->getOperand(0);
+    Value padded = rewriter.create<tensor::PadOp>(
+        op.getLoc(), op.getResultType().clone(newShape), source, newLow,
+        newHigh, padValue, op.getNofold());
+    replaceWithCast(rewriter, op,
+                    Torch::permuteTensor(rewriter, op.getLoc(), padded,
+                                         *permutation));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Casts before a transpose instead of after it.
+class SinkTransposeThroughCast : public OpRewritePattern<tensor::CastOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(tensor::CastOp op,
+                                PatternRewriter &rewriter) const override {
+    Operation *producer = op.getSource().getDefiningOp();
+    std::optional<SmallVector<int64_t>> permutation =
+        getTransposePermutation(producer);
+    auto resultType = op.getType().dyn_cast<RankedTensorType>();
+    if (!permutation || !resultType)
+      return rewriter.notifyMatchFailure(op, "source is not a transpose");
+
+    SmallVector<int64_t> newShape(resultType.getRank());
+    for (auto [i, dim] : llvm::enumerate(*permutation))
+      newShape[dim] = resultType.getDimSize(i);
+    Value cast = rewriter.create<tensor::CastOp>(
+        op.getLoc(), resultType.clone(newShape), producer->getOperand(0));
+    replaceWithCast(rewriter, op,
+                    Torch::permuteTensor(rewriter, op.getLoc(), cast,
+                                         *permutation));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Folds a transpose into producers that can create their result in any
+// layout at no cost: tensor.empty, linalg.fill and broadcasts, i.e.
+// elementwise ops without an input that has all the dimensions of the result.
+class FoldTransposeIntoProducer : public OpRewritePattern<linalg::GenericOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(linalg::GenericOp op,
+                                PatternRewriter &rewriter) const override {
+    std::optional<SmallVector<int64_t>> permutation =
+        getTransposePermutation(op);
+    if (!permutation)
+      return rewriter.notifyMatchFailure(op, "not a transpose");
+    Value input = op.getDpsInputOperand(0)->get();
+    // The transpose writes every element of its init, so whatever the init
+    // holds is a valid tensor.empty of the transposed shape.
+    Value init = op.getDpsInitOperand(0)->get();
+    Operation *producer = input.getDefiningOp();
+    if (isa_and_nonnull<tensor::EmptyOp>(producer)) {
+      rewriter.replaceOp(op, init);
+      return success();
+    }
+    if (auto fill = dyn_cast_or_null<linalg::FillOp>(producer)) {
+      rewriter.replaceOpWithNewOp<linalg::FillOp>(op, fill.getInputs(), init);
+      return success();
+    }
+
+    auto generic = dyn_cast_or_null<linalg::GenericOp>(producer);
+    if (!generic || !generic->hasOneUse() || !isElementwiseGeneric(generic) ||
+        getTransposePermutation(generic))
+      return rewriter.notifyMatchFailure(op, "unsupported producer");
+    for (OpOperand *operand : generic.getDpsInputOperands()) {
+      if (generic.getMatchingIndexingMap(operand).getNumResults() ==
+          generic.getNumLoops())
+        return rewriter.notifyMatchFailure(op, "producer is not a broadcast");
+    }
+    // Loop `permutation[i]` of the producer iterates over dimension `i` of
+    // the transposed result.
+    SmallVector<int64_t> newLoops = invertPermutationVector(*permutation);
+    SmallVector<AffineMap> inputMaps =
+        remapInputIndexingMaps(generic, newLoops);
+    rewriter.replaceOp(op, createPermutedGeneric(rewriter, generic,
+                                                 generic.getInputs(), inputMaps,
+                                                 init, newLoops));
+    rewriter.eraseOp(generic);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Rewrites an NCHW pooling op whose input is an NHWC tensor transposed to
+// NCHW to the corresponding NHWC pooling op, transposing the result instead.
+template <typename NchwOpTy, typename NhwcOpTy>
+class ConvertNchwPoolingToNhwc : public OpRewritePattern<NchwOpTy> {
+public:
+  using OpRewritePattern<NchwOpTy>::OpRewritePattern;
+  LogicalResult matchAndRewrite(NchwOpTy op,
+                                PatternRewriter &rewriter) const override {
+    if (!op.hasTensorSemantics())
+      return rewriter.notifyMatchFailure(op, "expected tensor semantics");
+    Value input = op.getDpsInputOperand(0)->get();
+    Operation *producer = input.getDefiningOp();
+    std::optional<SmallVector<int64_t>> permutation =
+        getTransposePermutation(producer);
+    if (!permutation ||
+        ArrayRef<int64_t>(*permutation) != ArrayRef<int64_t>{0, 3, 1, 2})
+      return rewriter.notifyMatchFailure(op, "input is not NHWC");
+
+    Location loc = op.getLoc();
+    Value init =
+        Torch::permuteTensor(rewriter, loc, op.getDpsInitOperand(0)->get(),
+                             {0, 2, 3, 1});
+    Value pooling =
+        rewriter
+            .create<NhwcOpTy>(loc, init.getType(),
+                              ValueRange{producer->getOperand(0),
+                                         op.getDpsInputOperand(1)->get()},
+                              init, op.getStrides(), op.getDilations())
+            .getResult(0);
+    replaceWithCast(rewriter, op,
+                    Torch::permuteTensor(rewriter, loc, pooling, *permutation));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+class PropagateLinalgTransposesPass
+    : public PropagateLinalgTransposesBase<PropagateLinalgTransposesPass> {
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.add<FoldTransposeOfTranspose, SinkTransposeThroughElementwise,
+                 SinkTransposeThroughPad, SinkTransposeThroughCast,
+                 FoldTransposeIntoProducer>(context);
+    patterns.add<
+        ConvertNchwPoolingToNhwc<linalg::PoolingNchwMaxOp,
+                                 linalg::PoolingNhwcMaxOp>,
+        ConvertNchwPoolingToNhwc<linalg::PoolingNchwSumOp,
+                                 linalg::PoolingNhwcSumOp>>(context);
+    if (failed(applyPatternsAndFoldGreedily(getOperation(),
+                                            std::move(patterns))))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::TorchConversion::createPropagateLinalgTransposesPass() {
+  return std::make_unique<PropagateLinalgTransposesPass>();
+}
@@ -0,0 +1,239 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Tosa/IR/TosaOps.h"
+#include "mlir/Dialect/Utils/IndexingUtils.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Conversion/TorchToTosa/TosaLegalizeUtils.h"
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::TorchConversion;
+
+// Throughout this file, a transpose with permutation `p` is a tosa.transpose
+// whose result dimension `i` is dimension `p[i]` of its input.
+
+// Returns the permutation of `op` if it is a tosa.transpose with constant
+// perms.
+static std::optional<SmallVector<int64_t>>
+getTransposePermutation(Operation *op) {
+  auto transpose = dyn_cast_or_null<tosa::TransposeOp>(op);
+  DenseIntElementsAttr perms;
+  if (!transpose || !matchPattern(transpose.getPerms(), m_Constant(&perms)))
+    return std::nullopt;
+  SmallVector<int64_t> permutation;
+  for (APInt perm : perms.getValues<APInt>())
+    permutation.push_back(perm.getSExtValue());
+  return permutation;
+}
+
+// Creates a transpose of `tensor` with permutation `permutation`.
+static Value createTranspose(PatternRewriter &rewriter, Operation *op,
+                             Value tensor, ArrayRef<int64_t> permutation) {
+  auto inType = tensor.getType().cast<RankedTensorType>();
+  SmallVector<int64_t> outShape;
+  for (int64_t dim : permutation)
+    outShape.push_back(inType.getDimSize(dim));
+  SmallVector<int32_t> perms(permutation.begin(), permutation.end());
+  Value permsConst =
+      *tosa::getConstTensor<int32_t>(rewriter, op, perms,
+                                     {static_cast<int64_t>(perms.size())});
+  return rewriter
+      .create<tosa::TransposeOp>(
+          op->getLoc(),
+          RankedTensorType::get(outShape, inType.getElementType()), tensor,
+          permsConst)
+      .getResult();
+}
+
+// Returns true if transposing `tensor` with `permutation` only moves its unit
+// dims, so that the transpose can be done by a tosa.reshape. Only static
+// shapes are handled, which covers the per-channel operands of the
+// elementwise ops, e.g. the `1xCx1x1` scales and shifts of a batch norm.
+static bool isPermutedByReshape(Value tensor, ArrayRef<int64_t> permutation) {
+  auto type = tensor.getType().dyn_cast<RankedTensorType>();
+  if (!type || !type.hasStaticShape() ||
+      type.getRank() != static_cast<int64_t>(permutation.size()))
+    return false;
+  int64_t lastDim = -1;
+  for (int64_t dim : permutation) {
+    if (type.getDimSize(dim) == 1)
+      continue;
+    if (dim < lastDim)
+      return false;
+    lastDim = dim;
+  }
+  return true;
+}
+
+// Creates the transpose of `tensor` with `permutation` as a tosa.reshape. See
+// isPermutedByReshape.
+static Value createPermutedReshape(PatternRewriter &rewriter, Location loc,
+                                   Value tensor,
+                                   ArrayRef<int64_t> permutation) {
+  auto type = tensor.getType().cast<RankedTensorType>();
+  SmallVector<int64_t> newShape;
+  for (int64_t dim : permutation)
+    newShape.push_back(type.getDimSize(dim));
+  return rewriter.create<tosa::ReshapeOp>(
+      loc, RankedTensorType::get(newShape, type.getElementType()), tensor,
+      rewriter.getDenseI64ArrayAttr(newShape));
+}
+
+// Replaces `op` with `value`, casting it to the type of the result of `op` if
+// the static information in the types differs.
+static void replaceWithCast(PatternRewriter &rewriter, Operation *op,
+                            Value value) {
+  Type resultType = op->getResult(0).getType();
+  if (value.getType() != resultType)
+    value = rewriter.create<tensor::CastOp>(op->getLoc(), resultType, value);
+  rewriter.replaceOp(op, value);
+}
+
+// Returns true if `op` computes each element of its result from the elements
+// of its operands at the same position.
+static bool isElementwise(Operation *op) {
+  return isa<tosa::AbsOp, tosa::AddOp, tosa::CastOp, tosa::CeilOp,
+             tosa::ClampOp, tosa::EqualOp, tosa::ExpOp, tosa::FloorOp,
+             tosa::GreaterEqualOp, tosa::GreaterOp, tosa::LogOp,
+             tosa::LogicalAndOp, tosa::LogicalNotOp, tosa::LogicalOrOp,
+             tosa::MaximumOp, tosa::MinimumOp, tosa::MulOp, tosa::NegateOp,
+             tosa::PowOp, tosa::ReciprocalOp, tosa::RsqrtOp, tosa::SelectOp,
+             tosa::SigmoidOp, tosa::SubOp, tosa::TanhOp>(op);
+}
+
+namespace {
+// Folds a transpose of a transpose into a single transpose, or removes both if
+// they cancel out.
+class FoldTransposeOfTranspose : public OpRewritePattern<tosa::TransposeOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(tosa::TransposeOp op,
+                                PatternRewriter &rewriter) const override {
+    std::optional<SmallVector<int64_t>> outer = getTransposePermutation(op);
+    if (!outer)
+      return rewriter.notifyMatchFailure(op, "non-constant perms");
+    Operation *producer = op.getInput1().getDefiningOp();
+    std::optional<SmallVector<int64_t>> inner =
+        getTransposePermutation(producer);
+    if (!inner)
+      return rewriter.notifyMatchFailure(op, "input is not a transpose");
+
+    Value source = producer->getOperand(0);
+    SmallVector<int64_t> permutation;
+    for (int64_t dim : *outer)
+      permutation.push_back((*inner)[dim]);
+    if (isIdentityPermutation(permutation)) {
+      replaceWithCast(rewriter, op, source);
+      return success();
+    }
+    replaceWithCast(rewriter, op,
+                    createTranspose(rewriter, op, source, permutation));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Rewrites an elementwise op with a transposed operand to work on the layout of
+// the operand before the transpose, and transposes its result instead:
+//
+//   elementwise(transpose(x), transpose(y), z)
+//     -> transpose(elementwise(x, y, z'))
+//
+// The other operands must either be transposed with the same permutation, or
+// be permuted by only moving their unit dims, in which case `z'` is a reshape
+// of `z`.
+class SinkTransposeThroughElementwise : public RewritePattern {
+public:
+  SinkTransposeThroughElementwise(MLIRContext *context)
+      : RewritePattern(MatchAnyOpTypeTag(), /*benefit=*/1, context) {}
+  LogicalResult matchAndRewrite(Operation *op,
+                                PatternRewriter &rewriter) const override {
+    if (!isElementwise(op) || op->getNumResults() != 1)
+      return rewriter.notifyMatchFailure(op, "not an elementwise op");
+    auto resultType = op->getResult(0).getType().dyn_cast<RankedTensorType>();
+    if (!resultType)
+      return rewriter.notifyMatchFailure(op, "unranked result");
+
+    std::optional<SmallVector<int64_t>> permutation;
+    for (Value operand : op->getOperands()) {
+      if ((permutation = getTransposePermutation(operand.getDefiningOp())))
+        break;
+    }
+    if (!permutation)
+      return rewriter.notifyMatchFailure(op, "no transposed operand");
+    // The operands of the new op are the operands of `op` transposed with the
+    // inverse permutation.
+    // The transposes of the operands must have no other uses, otherwise they
+    // stay alongside the new transpose of the result.
+    SmallVector<int64_t> inverse = invertPermutationVector(*permutation);
+    for (Value operand : op->getOperands()) {
+      if (getTransposePermutation(operand.getDefiningOp()) == permutation) {
+        if (!operand.hasOneUse())
+          return rewriter.notifyMatchFailure(
+              op, "a transposed operand has other uses");
+        continue;
+      }
+      if (!isPermutedByReshape(operand, inverse))
+        return rewriter.notifyMatchFailure(
+            op, "an operand would need a separate transpose");
+    }
+
+    Location loc = op->getLoc();
+    SmallVector<Value> newOperands;
+    for (Value operand : op->getOperands()) {
+      Operation *producer = operand.getDefiningOp();
+      if (getTransposePermutation(producer) == permutation)
+        newOperands.push_back(producer->getOperand(0));
+      else
+        newOperands.push_back(
+            createPermutedReshape(rewriter, loc, operand, inverse));
+    }
+    SmallVector<int64_t> newShape;
+    for (int64_t dim : inverse)
+      newShape.push_back(resultType.getDimSize(dim));
+    Operation *newOp = rewriter.clone(*op);
+    newOp->setOperands(newOperands);
+    newOp->getResult(0).setType(
+        RankedTensorType::get(newShape, resultType.getElementType()));
+    replaceWithCast(
+        rewriter, op,
+        createTranspose(rewriter, op, newOp->getResult(0), *permutation));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+class PropagateTosaTransposesPass
+    : public PropagateTosaTransposesBase<PropagateTosaTransposesPass> {
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.add<FoldTransposeOfTranspose, SinkTransposeThroughElementwise>(
+        context);
+    if (failed(applyPatternsAndFoldGreedily(getOperation(),
+                                            std::move(patterns))))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::TorchConversion::createPropagateTosaTransposesPass() {
+  return std::make_unique<PropagateTosaTransposesPass>();
+}
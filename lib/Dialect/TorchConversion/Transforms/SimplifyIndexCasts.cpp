@@ -0,0 +1,168 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::TorchConversion;
+
+// The width of `index` on the targets of the backends, which store sizes and
+// offsets in 64-bit integers.
+static constexpr unsigned kIndexBitwidth = 64;
+
+// Returns true if `type` is a signless integer at least as wide as an index,
+// so that casting between it and an index only truncates or extends it.
+static bool isAtLeastIndexWide(Type type) {
+  return type.isSignlessInteger() &&
+         type.getIntOrFloatBitWidth() >= kIndexBitwidth;
+}
+
+// Returns true if `value` is the index_cast of an index.
+static bool isCastOfIndex(Value value) {
+  auto cast = value.getDefiningOp<arith::IndexCastOp>();
+  return cast && cast.getIn().getType().isIndex();
+}
+
+// Returns true if `value` is a constant that fits in an index of any width.
+static bool isSmallConstant(Value value) {
+  APInt constant;
+  return matchPattern(value, m_ConstantInt(&constant)) &&
+         constant.isSignedIntN(32);
+}
+
+// Returns `value`, which is either a cast of an index or a small constant, as
+// an index.
+static Value getAsIndex(PatternRewriter &rewriter, Location loc, Value value) {
+  if (isCastOfIndex(value))
+    return value.getDefiningOp<arith::IndexCastOp>().getIn();
+  APInt constant;
+  matchPattern(value, m_ConstantInt(&constant));
+  return rewriter.create<arith::ConstantIndexOp>(loc,
+                                                 constant.getSExtValue());
+}
+
+namespace {
+// Computes an integer add, sub or mul in `index` when its result is only cast
+// to an index:
+//
+//   %0 = arith.addi %a, %b : i64
+//   %1 = arith.index_cast %0 : i64 to index
+//
+// becomes
+//
+//   %a_index = arith.index_cast %a : i64 to index
+//   %b_index = arith.index_cast %b : i64 to index
+//   %1 = arith.addi %a_index, %b_index : index
+//
+// The low bits of these ops don't depend on the high bits of their operands,
+// so this holds as long as the integers are at least as wide as `index`. With
+// narrower integers, the op would wrap at their width in the original code but
+// not in `index`, so those are left alone. The casts of the operands fold
+// away when the operands are themselves computed from indices, which keeps
+// the whole size and offset computations in `index`.
+class ComputeIntegerArithmeticInIndex
+    : public OpRewritePattern<arith::IndexCastOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(arith::IndexCastOp op,
+                                PatternRewriter &rewriter) const override {
+    if (!op.getType().isIndex())
+      return rewriter.notifyMatchFailure(op, "not a cast to an index");
+    Operation *producer = op.getIn().getDefiningOp();
+    if (!producer ||
+        !isa<arith::AddIOp, arith::SubIOp, arith::MulIOp>(producer))
+      return rewriter.notifyMatchFailure(
+          op, "not a cast of an integer add, sub or mul");
+    if (!isAtLeastIndexWide(op.getIn().getType()))
+      return rewriter.notifyMatchFailure(op,
+                                         "the integers are narrower than index");
+    // Keep the integer op if it has other uses, rather than computing it
+    // twice.
+    if (!llvm::all_of(producer->getUsers(), [](Operation *user) {
+          auto cast = dyn_cast<arith::IndexCastOp>(user);
+          return cast && cast.getType().isIndex();
+        }))
+      return rewriter.notifyMatchFailure(op, "the op has other uses");
+
+    Location loc = producer->getLoc();
+    SmallVector<Value> operands;
+    for (Value operand : producer->getOperands()) {
+      operands.push_back(rewriter.create<arith::IndexCastOp>(
+          loc, rewriter.getIndexType(), operand));
+    }
+    OperationState state(loc, producer->getName(), operands,
+                         rewriter.getIndexType(), producer->getAttrs());
+    Operation *indexOp = rewriter.create(state);
+    for (Operation *user : llvm::to_vector(producer->getUsers()))
+      rewriter.replaceOp(user, indexOp->getResults());
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Compares indices directly rather than after casting them to integers. The
+// casts sign-extend, which preserves both the signed and the unsigned order,
+// as long as the integers are at least as wide as `index`; casts to narrower
+// integers truncate, so those comparisons are left alone.
+class CompareIndicesInIndex : public OpRewritePattern<arith::CmpIOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(arith::CmpIOp op,
+                                PatternRewriter &rewriter) const override {
+    if (op.getLhs().getType().isIndex() ||
+        !op.getLhs().getType().isSignlessInteger())
+      return rewriter.notifyMatchFailure(op, "not a comparison of integers");
+    if (!isAtLeastIndexWide(op.getLhs().getType()))
+      return rewriter.notifyMatchFailure(op,
+                                         "the integers are narrower than index");
+    if (!isCastOfIndex(op.getLhs()) && !isCastOfIndex(op.getRhs()))
+      return rewriter.notifyMatchFailure(op, "no operand is an index cast");
+    auto isIndexLike = [](Value value) {
+      return isCastOfIndex(value) || isSmallConstant(value);
+    };
+    if (!isIndexLike(op.getLhs()) || !isIndexLike(op.getRhs()))
+      return rewriter.notifyMatchFailure(
+          op, "an operand is not an index or a small constant");
+    Value lhs = getAsIndex(rewriter, op.getLoc(), op.getLhs());
+    Value rhs = getAsIndex(rewriter, op.getLoc(), op.getRhs());
+    rewriter.replaceOpWithNewOp<arith::CmpIOp>(op, op.getPredicate(), lhs, rhs);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+class SimplifyIndexCastsPass
+    : public SimplifyIndexCastsBase<SimplifyIndexCastsPass> {
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.add<ComputeIntegerArithmeticInIndex, CompareIndicesInIndex>(
+        context);
+    arith::IndexCastOp::getCanonicalizationPatterns(patterns, context);
+    if (failed(applyPatternsAndFoldGreedily(getOperation(),
+                                            std::move(patterns))))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::TorchConversion::createSimplifyIndexCastsPass() {
+  return std::make_unique<SimplifyIndexCastsPass>();
+}
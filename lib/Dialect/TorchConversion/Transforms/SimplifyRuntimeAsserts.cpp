@@ -0,0 +1,151 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Conversion/Utils/Utils.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::TorchConversion;
+
+static Value lookThroughIndexCasts(Value value) {
+  while (auto cast = value.getDefiningOp<arith::IndexCastOp>())
+    value = cast.getIn();
+  return value;
+}
+
+// Returns true if the integers `lhs` and `rhs` are known to be equal, because
+// they are the same value, or the sizes of dimensions that `areDimSizesEqual` proves equal.
+static bool areKnownEqual(Value lhs, Value rhs) {
+  lhs = lookThroughIndexCasts(lhs);
+  rhs = lookThroughIndexCasts(rhs);
+  if (lhs == rhs)
+    return true;
+  auto lhsDim = lhs.getDefiningOp<tensor::DimOp>();
+  auto rhsDim = rhs.getDefiningOp<tensor::DimOp>();
+  if (!lhsDim || !rhsDim)
+    return false;
+  std::optional<int64_t> lhsIndex = lhsDim.getConstantIndex();
+  std::optional<int64_t> rhsIndex = rhsDim.getConstantIndex();
+  return lhsIndex && rhsIndex &&
+         Torch::areDimSizesEqual(lhsDim.getSource(), *lhsIndex,
+                                 rhsDim.getSource(), *rhsIndex);
+}
+
+// Returns true if the integer `value` is known to be non-negative, because it
+// is the size of a dimension or a non-negative constant.
+static bool isKnownNonNegative(Value value) {
+  value = lookThroughIndexCasts(value);
+  if (value.getDefiningOp<tensor::DimOp>())
+    return true;
+  APInt constant;
+  return matchPattern(value, m_ConstantInt(&constant)) &&
+         !constant.isNegative();
+}
+
+// Returns true if the condition `cond` of an assert is known to hold.
+static bool isKnownTrue(Value cond) {
+  if (matchPattern(cond, m_One()))
+    return true;
+  if (auto andOp = cond.getDefiningOp<arith::AndIOp>())
+    return isKnownTrue(andOp.getLhs()) && isKnownTrue(andOp.getRhs());
+  if (auto orOp = cond.getDefiningOp<arith::OrIOp>())
+    return isKnownTrue(orOp.getLhs()) || isKnownTrue(orOp.getRhs());
+  auto cmp = cond.getDefiningOp<arith::CmpIOp>();
+  if (!cmp)
+    return false;
+  Value lhs = cmp.getLhs();
+  Value rhs = cmp.getRhs();
+  switch (cmp.getPredicate()) {
+  case arith::CmpIPredicate::eq:
+  case arith::CmpIPredicate::ule:
+  case arith::CmpIPredicate::uge:
+    return areKnownEqual(lhs, rhs);
+  case arith::CmpIPredicate::sge:
+    return areKnownEqual(lhs, rhs) ||
+           (isKnownNonNegative(lhs) && matchPattern(rhs, m_Zero()));
+  case arith::CmpIPredicate::sle:
+    return areKnownEqual(lhs, rhs) ||
+           (matchPattern(lhs, m_Zero()) && isKnownNonNegative(rhs));
+  default:
+    return false;
+  }
+}
+
+namespace {
+// Erases the asserts whose condition is known to hold, or all of them if the
+// shapes are trusted.
+class EraseProvenAssert : public OpRewritePattern<cf::AssertOp> {
+public:
+  EraseProvenAssert(MLIRContext *context, bool trustShapes)
+      : OpRewritePattern(context), trustShapes(trustShapes) {}
+  LogicalResult matchAndRewrite(cf::AssertOp op,
+                                PatternRewriter &rewriter) const override {
+    if (!trustShapes && !isKnownTrue(op.getArg()))
+      return rewriter.notifyMatchFailure(op, "condition not known to hold");
+    rewriter.eraseOp(op);
+    return success();
+  }
+
+private:
+  bool trustShapes;
+};
+} // namespace
+
+namespace {
+// Erases the `torch.runtime.assert` ops that are still around when the shapes
+// are trusted, e.g. when the pass runs before TorchToArith.
+class EraseTorchRuntimeAssert
+    : public OpRewritePattern<Torch::RuntimeAssertOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(Torch::RuntimeAssertOp op,
+                                PatternRewriter &rewriter) const override {
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+class SimplifyRuntimeAssertsPass
+    : public SimplifyRuntimeAssertsBase<SimplifyRuntimeAssertsPass> {
+public:
+  SimplifyRuntimeAssertsPass() = default;
+  SimplifyRuntimeAssertsPass(bool trustShapes) {
+    this->trustShapes = trustShapes;
+  }
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.add<EraseProvenAssert>(context, trustShapes);
+    if (trustShapes)
+      patterns.add<EraseTorchRuntimeAssert>(context);
+    if (failed(applyPatternsAndFoldGreedily(getOperation(),
+                                            std::move(patterns))))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::TorchConversion::createSimplifyRuntimeAssertsPass(
+    bool trustShapes) {
+  return std::make_unique<SimplifyRuntimeAssertsPass>(trustShapes);
+}
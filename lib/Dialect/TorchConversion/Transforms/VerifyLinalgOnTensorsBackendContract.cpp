@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "BackendContractReport.h"
 #include "PassDetail.h"
 
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
@@ -33,6 +34,62 @@ using namespace mlir::torch;
 using namespace mlir::torch::TorchConversion;
 using namespace TMTensor;
 
+// Returns true if `op` is a `linalg.generic` that reads its input with
+// `tensor.extract`, which is how gathers and other data-dependent accesses are
+// lowered, rather than through its indexing maps.
+static bool isGatherLikeGeneric(Operation *op) {
+  auto generic = dyn_cast<linalg::GenericOp>(op);
+  if (!generic)
+    return false;
+  return generic
+      ->walk([](tensor::ExtractOp) { return WalkResult::interrupt(); })
+      .wasInterrupted();
+}
+
+static std::optional<double> estimateLinalgOnTensorsFlops(Operation *op) {
+  // The static loop ranges of a linalg op are the sizes of its iteration
+  // space, and each iteration computes its payload once.
+  if (auto linalgOp = dyn_cast<linalg::LinalgOp>(op)) {
+    double iterations = 1;
+    for (int64_t range : linalgOp.getStaticLoopRanges()) {
+      if (ShapedType::isDynamic(range))
+        return std::nullopt;
+      iterations *= range;
+    }
+    int64_t payloadOps = 0;
+    linalgOp->walk([&](Operation *payloadOp) {
+      if (isa<arith::ArithDialect, math::MathDialect>(
+              payloadOp->getDialect()) &&
+          !isa<arith::ConstantOp, arith::IndexCastOp>(payloadOp))
+        ++payloadOps;
+    });
+    return iterations * payloadOps;
+  }
+  // An attention computes the product of the query and the key and the
+  // product of the softmax of that and the value.
+  if (auto attention = dyn_cast<AttentionOp>(op)) {
+    ShapedType queryType = attention.getQueryType();
+    ShapedType keyType = attention.getKeyType();
+    ShapedType outputType = attention.getOutputType();
+    if (!queryType.hasStaticShape() || !keyType.hasStaticShape() ||
+        !outputType.hasStaticShape())
+      return std::nullopt;
+    double keyLength = keyType.getDimSize(keyType.getRank() - 2);
+    return 2 * keyLength *
+           (queryType.getNumElements() + outputType.getNumElements());
+  }
+  // The work of a variable-length attention depends on the sequence lengths
+  // at runtime.
+  if (isa<VarlenAttentionOp>(op))
+    return std::nullopt;
+  if (isa<TMTensorDialect>(op->getDialect()))
+    return estimateElementwiseFlops(op);
+  // The tensor ops that copy data do no arithmetic, but move bytes.
+  if (isa<tensor::PadOp, tensor::InsertSliceOp, tensor::GatherOp,
+          tensor::ScatterOp>(op))
+    return 0;
+  return std::nullopt;
+}
 
 namespace {
 class VerifyLinalgOnTensorsBackendContractPass
@@ -69,7 +126,8 @@ class VerifyLinalgOnTensorsBackendContractPass
     target.addDynamicallyLegalOp<ModuleOp, func::FuncOp, func::ReturnOp>(
         opHasLegalTypes);
 
-    target.addDynamicallyLegalOp<GetNextSeedOp>(opHasLegalTypes);
+    target.addDynamicallyLegalOp<GetNextSeedOp, GetNextRngOffsetOp>(
+        opHasLegalTypes);
 
     // Basic scalar operations.
     target.addDynamicallyLegalDialect<func::FuncDialect>(isLegalScalarOp);
@@ -91,6 +149,14 @@ class VerifyLinalgOnTensorsBackendContractPass
     target.addDynamicallyLegalOp<arith::ConstantOp>(opHasLegalTypes);
     target.addDynamicallyLegalOp<complex::CreateOp>(opHasLegalTypes);
 
+    // The report is written before verifying, since it is also useful to find
+    // out what didn't lower.
+    if (!reportFile.empty() &&
+        failed(writeBackendContractReport(
+            module, reportFile,
+            {isGatherLikeGeneric, estimateLinalgOnTensorsFlops})))
+      return signalPassFailure();
+
     RewritePatternSet patterns(context);
     if (failed(applyFullConversion(module, target, std::move(patterns)))) {
       // We avoid `module.emitError()` so that mlir-print-op-on-diagnostics
@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 #ifdef TORCH_MLIR_ENABLE_STABLEHLO
+#include "BackendContractReport.h"
 #include "PassDetail.h"
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
@@ -24,6 +25,72 @@ using namespace mlir;
 using namespace mlir::torch;
 using namespace mlir::torch::TorchConversion;
 
+static bool isSlowStablehloFallback(Operation *op) {
+  return isa<stablehlo::GatherOp, stablehlo::ScatterOp,
+             stablehlo::CustomCallOp>(op);
+}
+
+// Returns the shape of `value`, or std::nullopt if it isn't static.
+static std::optional<ArrayRef<int64_t>> getStaticShape(Value value) {
+  auto type = value.getType().dyn_cast<RankedTensorType>();
+  if (!type || !type.hasStaticShape())
+    return std::nullopt;
+  return type.getShape();
+}
+
+static std::optional<double> estimateStablehloFlops(Operation *op) {
+  if (!isa<stablehlo::StablehloDialect, chlo::ChloDialect>(op->getDialect()) ||
+      isa<stablehlo::ConstantOp>(op))
+    return std::nullopt;
+  // The ops that only move data.
+  if (isa<stablehlo::ReshapeOp, stablehlo::TransposeOp, stablehlo::SliceOp,
+          stablehlo::DynamicSliceOp, stablehlo::ConcatenateOp,
+          stablehlo::BroadcastInDimOp, stablehlo::PadOp, stablehlo::GatherOp,
+          stablehlo::ScatterOp>(op))
+    return 0;
+
+  // Each element of the result of a contraction takes a multiply-add per
+  // element of the contracted dims.
+  std::optional<double> multiplyAddsPerElement;
+  if (auto dotGeneral = dyn_cast<stablehlo::DotGeneralOp>(op)) {
+    if (std::optional<ArrayRef<int64_t>> lhsShape =
+            getStaticShape(dotGeneral.getLhs())) {
+      multiplyAddsPerElement = 1;
+      for (int64_t dim :
+           dotGeneral.getDotDimensionNumbers().getLhsContractingDimensions())
+        *multiplyAddsPerElement *= (*lhsShape)[dim];
+    }
+  } else if (auto dot = dyn_cast<stablehlo::DotOp>(op)) {
+    std::optional<ArrayRef<int64_t>> lhsShape = getStaticShape(dot.getLhs());
+    if (lhsShape && !lhsShape->empty())
+      multiplyAddsPerElement = lhsShape->back();
+  } else if (auto convolution = dyn_cast<stablehlo::ConvolutionOp>(op)) {
+    // Each element of the result is multiplied with a slice of the kernel
+    // along its output feature dim.
+    std::optional<ArrayRef<int64_t>> kernelShape =
+        getStaticShape(convolution.getRhs());
+    int64_t outputFeatureDim = convolution.getDimensionNumbers()
+                                   .getKernelOutputFeatureDimension();
+    if (kernelShape && (*kernelShape)[outputFeatureDim] != 0) {
+      double kernelElements = 1;
+      for (int64_t size : *kernelShape)
+        kernelElements *= size;
+      multiplyAddsPerElement =
+          kernelElements / (*kernelShape)[outputFeatureDim];
+    }
+  } else {
+    return estimateElementwiseFlops(op);
+  }
+  std::optional<ArrayRef<int64_t>> resultShape =
+      getStaticShape(op->getResult(0));
+  if (!multiplyAddsPerElement || !resultShape)
+    return std::nullopt;
+  double resultElements = 1;
+  for (int64_t size : *resultShape)
+    resultElements *= size;
+  return 2 * *multiplyAddsPerElement * resultElements;
+}
+
 namespace {
 class VerifyStablehloBackendContractPass
     : public VerifyStablehloBackendContractBase<
@@ -53,6 +120,12 @@ class VerifyStablehloBackendContractPass
     target.addLegalDialect<stablehlo::StablehloDialect>();
     target.addLegalDialect<tensor::TensorDialect>();
     target.addLegalDialect<arith::ArithDialect>();
+
+    if (!reportFile.empty() &&
+        failed(writeBackendContractReport(
+            getOperation(), reportFile,
+            {isSlowStablehloFallback, estimateStablehloFlops})))
+      return signalPassFailure();
   }
 };
 } // namespace
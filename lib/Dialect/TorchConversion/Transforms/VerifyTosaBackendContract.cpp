@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "BackendContractReport.h"
 #include "PassDetail.h"
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
@@ -22,6 +23,60 @@ using namespace mlir;
 using namespace mlir::torch;
 using namespace mlir::torch::TorchConversion;
 
+static bool isSlowTosaFallback(Operation *op) {
+  return isa<tosa::GatherOp, tosa::ScatterOp, tosa::CustomOp>(op);
+}
+
+// Returns the shape of `value`, or std::nullopt if it isn't static.
+static std::optional<ArrayRef<int64_t>> getStaticShape(Value value) {
+  auto type = value.getType().dyn_cast<RankedTensorType>();
+  if (!type || !type.hasStaticShape())
+    return std::nullopt;
+  return type.getShape();
+}
+
+static std::optional<double> estimateTosaFlops(Operation *op) {
+  if (!isa<tosa::TosaDialect>(op->getDialect()) || isa<tosa::ConstOp>(op))
+    return std::nullopt;
+  // The ops that only move data.
+  if (isa<tosa::ReshapeOp, tosa::TransposeOp, tosa::SliceOp, tosa::ConcatOp,
+          tosa::PadOp, tosa::TileOp, tosa::ReverseOp, tosa::GatherOp,
+          tosa::ScatterOp, tosa::IdentityOp>(op))
+    return 0;
+
+  // Each element of the result of a contraction takes a multiply-add per
+  // element of the contracted dims.
+  std::optional<double> multiplyAddsPerElement;
+  if (isa<tosa::MatMulOp, tosa::FullyConnectedOp>(op)) {
+    // The contracted dim is the innermost dim of the lhs, which is
+    // [N, H, C] for a matmul and [N, C] for a fully connected op.
+    if (std::optional<ArrayRef<int64_t>> lhsShape =
+            getStaticShape(op->getOperand(0)))
+      multiplyAddsPerElement = lhsShape->back();
+  } else if (isa<tosa::Conv2DOp>(op)) {
+    // The weight is [O, KH, KW, I].
+    if (std::optional<ArrayRef<int64_t>> weightShape =
+            getStaticShape(op->getOperand(1)))
+      multiplyAddsPerElement = (*weightShape)[1] * (*weightShape)[2] *
+                               (*weightShape)[3];
+  } else if (isa<tosa::DepthwiseConv2DOp>(op)) {
+    // The weight is [KH, KW, C, M].
+    if (std::optional<ArrayRef<int64_t>> weightShape =
+            getStaticShape(op->getOperand(1)))
+      multiplyAddsPerElement = (*weightShape)[0] * (*weightShape)[1];
+  } else {
+    return estimateElementwiseFlops(op);
+  }
+  std::optional<ArrayRef<int64_t>> resultShape =
+      getStaticShape(op->getResult(0));
+  if (!multiplyAddsPerElement || !resultShape)
+    return std::nullopt;
+  double resultElements = 1;
+  for (int64_t size : *resultShape)
+    resultElements *= size;
+  return 2 * *multiplyAddsPerElement * resultElements;
+}
+
 namespace {
 class VerifyTosaBackendContractPass
     : public VerifyTosaBackendContractBase<VerifyTosaBackendContractPass> {
@@ -48,6 +103,13 @@ class VerifyTosaBackendContractPass
     target.addDynamicallyLegalOp<arith::ExtSIOp>(opHasLegalTypes);
     target.addDynamicallyLegalOp<arith::ConstantOp>(opHasLegalTypes);
 
+    // The report is written before verifying, since it is also useful to find
+    // out what didn't lower.
+    if (!reportFile.empty() &&
+        failed(writeBackendContractReport(
+            module, reportFile, {isSlowTosaFallback, estimateTosaFlops})))
+      return signalPassFailure();
+
     RewritePatternSet patterns(context);
     if (failed(applyFullConversion(module, target, std::move(patterns)))) {
       // We avoid `module.emitError()` so that mlir-print-op-on-diagnostics
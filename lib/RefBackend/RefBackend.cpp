@@ -18,17 +18,27 @@
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Bufferization/IR/Bufferization.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/GPU/IR/GPUDialect.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Linalg/Transforms/Transforms.h"
 #include "mlir/Dialect/Math/IR/Math.h"
 #include "mlir/Dialect/Math/Transforms/Approximation.h"
 #include "mlir/Dialect/Math/Transforms/Passes.h"
 #include "mlir/Dialect/MLProgram/IR/MLProgram.h"
+#include "mlir/Dialect/SCF/Transforms/TileUsingInterface.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/DialectResourceBlobManager.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Interfaces/TilingInterface.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir-dialects/Dialect/TMTensor/IR/TMTensorOps.h"
 #include "torch-mlir/Dialect/TorchConversion/IR/TorchConversionOps.h"
 #include "torch-mlir/Dialect/TorchConversion/Transforms/BackendTypeConversion.h"
 #include "torch-mlir/RefBackend/Passes.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include <numeric>
 #include <set>
 
@@ -194,6 +204,176 @@ static LogicalResult mungeFunction(
   return success();
 }
 
+// Name of the module attribute that records the result types of the functions
+// that were given the destination-passing calling convention. The invoker
+// needs them to preallocate the output buffers.
+static constexpr StringRef kDestinationPassingResultsAttrName =
+    "refback.destination_passing_results";
+
+static bool isStaticallyShapedAbiMemRef(Type type) {
+  auto memRefType = type.dyn_cast<MemRefType>();
+  return memRefType && memRefType.hasStaticShape() &&
+         memRefType.getLayout().isIdentity() && isArgMemRefTypeValid(type);
+}
+
+// Returns true if the whole signature of `func` can be expressed with the
+// destination-passing calling convention.
+static bool canUseDestinationPassing(func::FuncOp func) {
+  if (!func.getBody().hasOneBlock())
+    return false;
+  FunctionType type = func.getFunctionType();
+  return llvm::all_of(type.getInputs(), isStaticallyShapedAbiMemRef) &&
+         llvm::all_of(type.getResults(), isStaticallyShapedAbiMemRef);
+}
+
+// Rewrite `func` to the destination-passing calling convention:
+// - the ranked memref arguments are kept as they are
+// - one memref argument of the same type is appended for each result, into
+//   which the caller has already allocated the storage for that result
+// - the function returns nothing.
+//
+// Results that are freshly allocated in the function are computed directly
+// into the caller's buffer instead of being copied there.
+static void mungeFunctionForDestinationPassing(func::FuncOp func) {
+  addEmitCInterfaceAttr(func);
+  auto returnOp = cast<func::ReturnOp>(func.getBody().front().getTerminator());
+  SmallVector<Type> resultTypes(func.getResultTypes());
+  SmallVector<Type> newArgTypes(func.getArgumentTypes());
+  llvm::append_range(newArgTypes, resultTypes);
+
+  OpBuilder b(returnOp);
+  for (auto en : llvm::enumerate(returnOp.getOperands())) {
+    Value result = en.value();
+    Value out = func.getBody().addArgument(resultTypes[en.index()],
+                                           returnOp.getLoc());
+    auto alloc = result.getDefiningOp<memref::AllocOp>();
+    if (alloc && alloc.getType() == out.getType()) {
+      alloc.replaceAllUsesWith(out);
+      alloc.erase();
+      continue;
+    }
+    b.create<memref::CopyOp>(returnOp.getLoc(), result, out);
+  }
+  b.create<func::ReturnOp>(returnOp.getLoc());
+  returnOp.erase();
+  SmallVector<DictionaryAttr> argAttrs;
+  func.getAllArgAttrs(argAttrs);
+  argAttrs.resize(newArgTypes.size(), DictionaryAttr::get(func.getContext()));
+  func.setType(FunctionType::get(func.getContext(), newArgTypes, {}));
+  func.setAllArgAttrs(argAttrs);
+}
+
+// Name of the module attribute that records, for each result of the
+// functions that were given the destination-passing calling convention, the
+// arguments whose storage can be donated to that result.
+static constexpr StringRef kDonatableInputsAttrName =
+    "refback.donatable_inputs";
+
+// Returns true if `op` reads and writes the same element of `input` and
+// `output` in each iteration, so that it still computes the same thing when
+// both are the same buffer.
+static bool isElementwiseInPlace(Operation *op, Value input, Value output) {
+  if (isa<memref::CopyOp>(op))
+    return true;
+  auto linalgOp = cast<linalg::LinalgOp>(op);
+  if (linalgOp.getNumParallelLoops() != linalgOp.getNumLoops())
+    return false;
+  return llvm::all_of(op->getOpOperands(), [&](OpOperand &operand) {
+    if (operand.get() != input && operand.get() != output)
+      return true;
+    return linalgOp.getMatchingIndexingMap(&operand).isIdentity();
+  });
+}
+
+// Returns true if the argument `input` of the destination-passing function
+// `func` can share its storage with the out argument `output`. The ops using
+// either of them have to be linalg ops or copies at the top level of the
+// function, so that their effects are known, and none of them may read
+// `input` after `output` is first written.
+static bool canDonateInput(func::FuncOp func, BlockArgument input,
+                           BlockArgument output) {
+  if (input.getType() != output.getType())
+    return false;
+  Block &body = func.getBody().front();
+  auto isKnownUser = [&](Operation *user) {
+    return user->getBlock() == &body &&
+           isa<linalg::LinalgOp, memref::CopyOp>(user);
+  };
+  if (!llvm::all_of(input.getUsers(), isKnownUser) ||
+      !llvm::all_of(output.getUsers(), isKnownUser))
+    return false;
+
+  bool outputWritten = false;
+  for (Operation &op : body) {
+    bool readsInput = false, writesInput = false, writesOutput = false;
+    if (auto copy = dyn_cast<memref::CopyOp>(op)) {
+      readsInput = copy.getSource() == input;
+      writesInput = copy.getTarget() == input;
+      writesOutput = copy.getTarget() == output;
+    } else if (auto linalgOp = dyn_cast<linalg::LinalgOp>(op)) {
+      for (OpOperand &operand : op.getOpOperands()) {
+        bool isInit = linalgOp.isDpsInit(&operand);
+        readsInput |= operand.get() == input;
+        writesInput |= isInit && operand.get() == input;
+        writesOutput |= isInit && operand.get() == output;
+      }
+    }
+    if (writesInput)
+      return false;
+    if (readsInput && outputWritten)
+      return false;
+    if (readsInput && writesOutput &&
+        !isElementwiseInPlace(&op, input, output))
+      return false;
+    outputWritten |= writesOutput;
+  }
+  return true;
+}
+
+// Returns, for each out argument of the destination-passing function `func`,
+// the indices of the arguments that can be donated to it.
+static ArrayAttr getDonatableInputs(func::FuncOp func, unsigned numInputs) {
+  Builder b(func.getContext());
+  SmallVector<Attribute> donatableInputs;
+  for (unsigned out = numInputs, e = func.getNumArguments(); out < e; ++out) {
+    SmallVector<Attribute> inputs;
+    for (unsigned in = 0; in < numInputs; ++in) {
+      if (canDonateInput(func, func.getArgument(in), func.getArgument(out)))
+        inputs.push_back(b.getI64IntegerAttr(in));
+    }
+    donatableInputs.push_back(b.getArrayAttr(inputs));
+  }
+  return b.getArrayAttr(donatableInputs);
+}
+
+// Name of the module attribute that records, for each result of the
+// functions that were given the destination-passing calling convention, the
+// argument whose storage the invoker reuses for that result, or -1.
+static constexpr StringRef kDonatedInputsAttrName = "refback.donated_inputs";
+
+// Returns, for each out argument of the destination-passing function `func`,
+// the index of an argument annotated as `torch.donated` that can be donated to
+// it, or -1. Each argument is donated to at most one result.
+static ArrayAttr getDonatedInputs(func::FuncOp func, unsigned numInputs) {
+  Builder b(func.getContext());
+  SmallVector<Attribute> donatedInputs;
+  llvm::SmallDenseSet<unsigned> used;
+  for (unsigned out = numInputs, e = func.getNumArguments(); out < e; ++out) {
+    int64_t donated = -1;
+    for (unsigned in = 0; in < numInputs; ++in) {
+      if (used.contains(in) || !func.getArgAttr(in, "torch.donated"))
+        continue;
+      if (canDonateInput(func, func.getArgument(in), func.getArgument(out))) {
+        donated = in;
+        used.insert(in);
+        break;
+      }
+    }
+    donatedInputs.push_back(b.getI64IntegerAttr(donated));
+  }
+  return b.getArrayAttr(donatedInputs);
+}
+
 namespace {
 class MungeCallingConventions
     : public MungeCallingConventionsBase<MungeCallingConventions> {
@@ -201,10 +381,46 @@ class MungeCallingConventions
     auto module = getOperation();
     OpBuilder b(module.getBodyRegion());
     std::map<std::string, std::vector<Type>> invokedConsumeFuncReturnFuncs;
+    SmallVector<NamedAttribute> destinationPassingResults;
+    SmallVector<NamedAttribute> donatableInputs;
+    SmallVector<NamedAttribute> donatedInputs;
     for (auto func : module.getOps<func::FuncOp>()) {
+      // Functions whose callers preallocate the outputs use the
+      // destination-passing calling convention whenever they can.
+      bool preallocatedOutputs =
+          func->hasAttr("torch.preallocated_outputs") && !func.isPrivate();
+      if (preallocatedOutputs && !canUseDestinationPassing(func)) {
+        func.emitWarning() << "cannot use destination passing for a function "
+                              "with preallocated outputs; its results will be "
+                              "allocated by the function";
+      }
+      if ((destinationPassing || preallocatedOutputs) && !func.isPrivate() &&
+          canUseDestinationPassing(func)) {
+        SmallVector<Attribute> resultTypes = llvm::to_vector(
+            llvm::map_range(func.getResultTypes(), [](Type type) -> Attribute {
+              return TypeAttr::get(type);
+            }));
+        destinationPassingResults.push_back(
+            b.getNamedAttr(func.getSymName(), b.getArrayAttr(resultTypes)));
+        unsigned numInputs = func.getNumArguments();
+        mungeFunctionForDestinationPassing(func);
+        donatableInputs.push_back(b.getNamedAttr(
+            func.getSymName(), getDonatableInputs(func, numInputs)));
+        donatedInputs.push_back(b.getNamedAttr(
+            func.getSymName(), getDonatedInputs(func, numInputs)));
+        continue;
+      }
       if (failed(mungeFunction(func, invokedConsumeFuncReturnFuncs)))
         return signalPassFailure();
     }
+    if (!destinationPassingResults.empty()) {
+      module->setAttr(kDestinationPassingResultsAttrName,
+                      b.getDictionaryAttr(destinationPassingResults));
+      module->setAttr(kDonatableInputsAttrName,
+                      b.getDictionaryAttr(donatableInputs));
+      module->setAttr(kDonatedInputsAttrName,
+                      b.getDictionaryAttr(donatedInputs));
+    }
 
     // Create FuncOp for consumeFuncReturnFuncs that are used.
     for (auto &p : invokedConsumeFuncReturnFuncs) {
@@ -264,6 +480,23 @@ bufferizeMLProgramGlobaLoadOp(ml_program::GlobalLoadOp globalLoadOp,
   return success();
 }
 
+static LogicalResult
+bufferizeMLProgramGlobalLoadConstOp(ml_program::GlobalLoadConstOp loadConstOp,
+                                    OpBuilder &b) {
+  RankedTensorType tensorType = loadConstOp.getType().cast<RankedTensorType>();
+  MemRefType memrefType =
+      MemRefType::get(tensorType.getShape(), tensorType.getElementType());
+
+  b.setInsertionPoint(loadConstOp);
+  Value globalVal = b.create<memref::GetGlobalOp>(
+      loadConstOp.getLoc(), memrefType,
+      loadConstOp.getGlobalAttr().getLeafReference());
+  globalVal = b.create<bufferization::ToTensorOp>(loadConstOp->getLoc(),
+                                                  tensorType, globalVal);
+  loadConstOp->getResult(0).replaceAllUsesWith(globalVal);
+  return success();
+}
+
 static LogicalResult
 bufferizeMLProgramGlobaStoreOp(ml_program::GlobalStoreOp globalStoreOp,
                                OpBuilder &b,
@@ -330,6 +563,14 @@ class MLProgramBufferize : public MLProgramBufferizeBase<MLProgramBufferize> {
       toErase.push_back(op);
     });
 
+    module.walk([&](ml_program::GlobalLoadConstOp op) {
+      if (failed(bufferizeMLProgramGlobalLoadConstOp(op, b))) {
+        op.emitError("bufferization for this op failed");
+        return;
+      }
+      toErase.push_back(op);
+    });
+
     module.walk([&](ml_program::GlobalStoreOp op) {
       if (failed(bufferizeMLProgramGlobaStoreOp(op, b, toErase))) {
         op.emitError("bufferization for this op failed");
@@ -459,3 +700,695 @@ std::unique_ptr<OperationPass<func::FuncOp>>
 mlir::torch::RefBackend::createGeneralizeTensorPadPass() {
   return std::make_unique<GeneralizeTensorPad>();
 }
+
+//===----------------------------------------------------------------------===//
+// TileAndVectorize
+//===----------------------------------------------------------------------===//
+
+// Marks the innermost tiles produced by TileAndVectorize that should be
+// vectorized.
+static constexpr StringRef kVectorizeMarker = "refback.vectorize";
+
+// Tiles `op` with `tileSize` along each of its loops, and returns the tiled op,
+// or `op` itself if it was not tiled.
+static linalg::LinalgOp tileLinalgOp(RewriterBase &rewriter,
+                                     linalg::LinalgOp op, int64_t tileSize) {
+  if (tileSize == 0 || op.getNumLoops() == 0)
+    return op;
+  SmallVector<int64_t> tileSizes(op.getNumLoops(), tileSize);
+  scf::SCFTilingOptions options;
+  options.setTileSizes(tileSizes);
+  rewriter.setInsertionPoint(op);
+  FailureOr<scf::SCFTilingResult> tilingResult = scf::tileUsingSCFForOp(
+      rewriter, cast<TilingInterface>(op.getOperation()), options);
+  if (failed(tilingResult) || tilingResult->tiledOps.size() != 1)
+    return op;
+  // With buffer semantics there are no results to replace.
+  rewriter.eraseOp(op);
+  return cast<linalg::LinalgOp>(tilingResult->tiledOps.front());
+}
+
+// Canonicalizes the loop nests produced by tiling. Among other things, this
+// folds the sizes of full tiles into the types of their subviews (and then,
+// through memref.cast folding, into the linalg ops using them), which is what
+// lets the vectorizer see static shapes.
+static LogicalResult canonicalizeTiledCode(func::FuncOp func) {
+  MLIRContext *context = func.getContext();
+  RewritePatternSet patterns(context);
+  memref::SubViewOp::getCanonicalizationPatterns(patterns, context);
+  memref::CastOp::getCanonicalizationPatterns(patterns, context);
+  scf::ForOp::getCanonicalizationPatterns(patterns, context);
+  affine::AffineMinOp::getCanonicalizationPatterns(patterns, context);
+  affine::AffineApplyOp::getCanonicalizationPatterns(patterns, context);
+  vector::TransferReadOp::getCanonicalizationPatterns(patterns, context);
+  vector::TransferWriteOp::getCanonicalizationPatterns(patterns, context);
+  return applyPatternsAndFoldGreedily(func, std::move(patterns));
+}
+
+// Returns the key of `op` in a tuning database: the op name followed by the
+// types of its operands, e.g. `linalg.matmul:4x8xf32,8x?xf32,4x?xf32`. The
+// RefBackend autotuner computes the same keys from the Python bindings.
+static std::string getTuningKey(linalg::LinalgOp op) {
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  os << op->getName() << ":";
+  llvm::interleave(
+      op->getOperandTypes(), os,
+      [&](Type type) {
+        auto shapedType = type.dyn_cast<ShapedType>();
+        if (!shapedType || !shapedType.hasRank()) {
+          os << type;
+          return;
+        }
+        for (int64_t size : shapedType.getShape()) {
+          if (ShapedType::isDynamic(size))
+            os << "?";
+          else
+            os << size;
+          os << "x";
+        }
+        os << shapedType.getElementType();
+      },
+      ",");
+  return os.str();
+}
+
+namespace {
+struct TileSizes {
+  int64_t cacheTileSize;
+  int64_t vectorTileSize;
+};
+} // namespace
+
+// Reads the tile sizes of each tuning key from the tuning database at `path`
+// into `tunedTileSizes`.
+static LogicalResult
+loadTuningDatabase(MLIRContext *context, StringRef path,
+                   llvm::StringMap<TileSizes> &tunedTileSizes) {
+  Location loc = UnknownLoc::get(context);
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      llvm::MemoryBuffer::getFile(path);
+  if (!buffer) {
+    return emitError(loc) << "could not open tuning database '" << path
+                          << "': " << buffer.getError().message();
+  }
+  llvm::Expected<llvm::json::Value> json =
+      llvm::json::parse((*buffer)->getBuffer());
+  if (!json) {
+    return emitError(loc) << "could not parse tuning database '" << path
+                          << "': " << llvm::toString(json.takeError());
+  }
+  llvm::json::Object *entries = json->getAsObject();
+  if (!entries)
+    return emitError(loc) << "tuning database must be a JSON object";
+  for (auto &entry : *entries) {
+    llvm::json::Object *sizes = entry.second.getAsObject();
+    std::optional<int64_t> cacheTileSize =
+        sizes ? sizes->getInteger("cache_tile_size") : std::nullopt;
+    std::optional<int64_t> vectorTileSize =
+        sizes ? sizes->getInteger("vector_tile_size") : std::nullopt;
+    if (!cacheTileSize || !vectorTileSize || *cacheTileSize < 0 ||
+        *vectorTileSize < 0) {
+      return emitError(loc) << "invalid tile sizes in tuning database for '"
+                            << entry.first.str() << "'";
+    }
+    tunedTileSizes[entry.first.str()] = {*cacheTileSize, *vectorTileSize};
+  }
+  return success();
+}
+
+namespace {
+class TileAndVectorize : public TileAndVectorizeBase<TileAndVectorize> {
+public:
+  LogicalResult initialize(MLIRContext *context) override {
+    if (tuningDatabase.empty())
+      return success();
+    return loadTuningDatabase(context, tuningDatabase, tunedTileSizes);
+  }
+
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+    MLIRContext *context = &getContext();
+    SmallVector<linalg::LinalgOp> linalgOps;
+    func.walk([&](linalg::LinalgOp op) {
+      if (op.hasBufferSemantics())
+        linalgOps.push_back(op);
+    });
+
+    IRRewriter rewriter(context);
+    for (linalg::LinalgOp op : linalgOps) {
+      TileSizes sizes = {cacheTileSize, vectorTileSize};
+      if (!tunedTileSizes.empty()) {
+        auto it = tunedTileSizes.find(getTuningKey(op));
+        if (it != tunedTileSizes.end())
+          sizes = it->second;
+      }
+      linalg::LinalgOp tiledOp =
+          tileLinalgOp(rewriter, op, sizes.cacheTileSize);
+      tiledOp = tileLinalgOp(rewriter, tiledOp, sizes.vectorTileSize);
+      // Only vectorize ops that were actually tiled down to vector tiles;
+      // vectorizing a large untiled op would create huge vectors.
+      if (tiledOp != op)
+        tiledOp->setAttr(kVectorizeMarker, UnitAttr::get(context));
+    }
+    if (failed(canonicalizeTiledCode(func)))
+      return signalPassFailure();
+
+    SmallVector<linalg::LinalgOp> toVectorize;
+    func.walk([&](linalg::LinalgOp op) {
+      if (op->removeAttr(kVectorizeMarker) && !op.hasDynamicShape())
+        toVectorize.push_back(op);
+    });
+    for (linalg::LinalgOp op : toVectorize) {
+      rewriter.setInsertionPoint(op);
+      // Vectorization failing just means the op is lowered to loops later.
+      (void)linalg::vectorize(rewriter, op);
+    }
+    if (failed(canonicalizeTiledCode(func)))
+      return signalPassFailure();
+  }
+
+private:
+  llvm::StringMap<TileSizes> tunedTileSizes;
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::RefBackend::createTileAndVectorizePass() {
+  return std::make_unique<TileAndVectorize>();
+}
+
+//===----------------------------------------------------------------------===//
+// PackConstantWeights
+//===----------------------------------------------------------------------===//
+
+namespace {
+// A matmul of a [M, K] tensor by a constant weight, either a `linalg.matmul`
+// or a `linalg.generic` with the same loops.
+struct ConstantWeightMatmul {
+  linalg::LinalgOp op;
+  ElementsAttr weight;
+  // Whether the weight is stored as [N, K] rather than [K, N], as for the
+  // `x @ w.t()` of linear layers.
+  bool transposed;
+  int64_t k;
+  int64_t n;
+};
+} // namespace
+
+// Returns the row-major contents of `elements`, or std::nullopt if they are
+// not available, e.g. for splats, which don't need packing anyway.
+static std::optional<ArrayRef<char>> getRawContents(ElementsAttr elements) {
+  if (auto dense = elements.dyn_cast<DenseElementsAttr>()) {
+    if (dense.isSplat())
+      return std::nullopt;
+    return dense.getRawData();
+  }
+  if (auto resource = elements.dyn_cast<DenseResourceElementsAttr>()) {
+    if (AsmResourceBlob *blob = resource.getRawHandle().getBlob())
+      return blob->getData();
+  }
+  return std::nullopt;
+}
+
+static std::optional<ConstantWeightMatmul>
+matchConstantWeightMatmul(linalg::LinalgOp op) {
+  if (!isa<linalg::MatmulOp, linalg::GenericOp>(op) ||
+      !op.hasTensorSemantics() || op.getNumDpsInputs() != 2 ||
+      op.getNumDpsInits() != 1 || op->getNumResults() != 1)
+    return std::nullopt;
+  SmallVector<utils::IteratorType> matmulIteratorTypes = {
+      utils::IteratorType::parallel, utils::IteratorType::parallel,
+      utils::IteratorType::reduction};
+  if (op.getIteratorTypesArray() != matmulIteratorTypes)
+    return std::nullopt;
+  // The body is reused as is, so it must not depend on the loop indices.
+  if (!op.getBlock()->getOps<linalg::IndexOp>().empty())
+    return std::nullopt;
+
+  AffineExpr m, n, k;
+  bindDims(op.getContext(), m, n, k);
+  ConstantWeightMatmul matmul;
+  matmul.op = op;
+  SmallVector<AffineMap> maps = op.getIndexingMapsArray();
+  if (maps == AffineMap::inferFromExprList({{m, k}, {k, n}, {m, n}}))
+    matmul.transposed = false;
+  else if (maps == AffineMap::inferFromExprList({{m, k}, {n, k}, {m, n}}))
+    matmul.transposed = true;
+  else
+    return std::nullopt;
+
+  Attribute weight;
+  if (!matchPattern(op.getDpsInputOperand(1)->get(), m_Constant(&weight)))
+    return std::nullopt;
+  matmul.weight = weight.dyn_cast<ElementsAttr>();
+  if (!matmul.weight || !getRawContents(matmul.weight))
+    return std::nullopt;
+  Type elementType = matmul.weight.getElementType();
+  if (!elementType.isIntOrFloat() ||
+      elementType.getIntOrFloatBitWidth() % 8 != 0)
+    return std::nullopt;
+  ArrayRef<int64_t> shape = matmul.weight.getShapedType().getShape();
+  matmul.k = shape[matmul.transposed ? 1 : 0];
+  matmul.n = shape[matmul.transposed ? 0 : 1];
+  return matmul;
+}
+
+// Returns the weight of `matmul` in the blocked [N / nTile, K / kTile, kTile,
+// nTile] layout, in which the weight elements used by consecutive iterations
+// of the packed matmul are contiguous.
+static DenseElementsAttr packWeight(const ConstantWeightMatmul &matmul,
+                                    int64_t kTile, int64_t nTile) {
+  ArrayRef<char> raw = *getRawContents(matmul.weight);
+  Type elementType = matmul.weight.getElementType();
+  int64_t elementBytes = elementType.getIntOrFloatBitWidth() / 8;
+  int64_t k = matmul.k, n = matmul.n;
+  SmallVector<char> data;
+  data.reserve(raw.size());
+  for (int64_t n0 = 0; n0 < n; n0 += nTile) {
+    for (int64_t k0 = 0; k0 < k; k0 += kTile) {
+      for (int64_t k1 = k0; k1 < k0 + kTile; k1++) {
+        for (int64_t n1 = n0; n1 < n0 + nTile; n1++) {
+          int64_t index = matmul.transposed ? n1 * k + k1 : k1 * n + n1;
+          ArrayRef<char> element =
+              raw.slice(index * elementBytes, elementBytes);
+          data.append(element.begin(), element.end());
+        }
+      }
+    }
+  }
+  auto packedType =
+      RankedTensorType::get({n / nTile, k / kTile, kTile, nTile}, elementType);
+  return DenseElementsAttr::getFromRawBuffer(packedType, data);
+}
+
+// Returns `value` cast to the type of the same shape with the static sizes of
+// `staticSizes` (kDynamic in that list keeps the size of `value`).
+static Value castToStaticSizes(OpBuilder &b, Location loc, Value value,
+                               ArrayRef<int64_t> staticSizes) {
+  auto type = value.getType().cast<RankedTensorType>();
+  SmallVector<int64_t> shape(type.getShape());
+  for (auto [size, staticSize] : llvm::zip(shape, staticSizes)) {
+    if (!ShapedType::isDynamic(staticSize))
+      size = staticSize;
+  }
+  auto castType = RankedTensorType::get(shape, type.getElementType());
+  if (castType == type)
+    return value;
+  return b.create<tensor::CastOp>(loc, castType, value);
+}
+
+// Replaces `matmul` by a matmul of the same body reading its weight packed by
+// `packWeight`. The loops are (m, n / nTile, k / kTile, k % kTile, n % nTile),
+// which visits the K dim in the original order, so the results are the same.
+static void packMatmul(RewriterBase &rewriter,
+                       const ConstantWeightMatmul &matmul, int64_t kTile,
+                       int64_t nTile) {
+  linalg::LinalgOp op = matmul.op;
+  Location loc = op.getLoc();
+  MLIRContext *context = op.getContext();
+  rewriter.setInsertionPoint(op);
+  Value packed = rewriter.create<arith::ConstantOp>(
+      loc, packWeight(matmul, kTile, nTile));
+
+  // The lhs is viewed as [M, K / kTile, kTile] and the init as
+  // [M, N / nTile, nTile].
+  auto splitLastDim = [&](Value tensor, int64_t size, int64_t tile) -> Value {
+    tensor = castToStaticSizes(rewriter, loc, tensor,
+                               {ShapedType::kDynamic, size});
+    auto type = tensor.getType().cast<RankedTensorType>();
+    auto expandedType = RankedTensorType::get(
+        {type.getDimSize(0), size / tile, tile}, type.getElementType());
+    return rewriter.create<tensor::ExpandShapeOp>(
+        loc, expandedType, tensor,
+        SmallVector<ReassociationIndices>{{0}, {1, 2}});
+  };
+  Value lhs = splitLastDim(op.getDpsInputOperand(0)->get(), matmul.k, kTile);
+  Value init = splitLastDim(op.getDpsInitOperand(0)->get(), matmul.n, nTile);
+
+  AffineExpr m, n0, k0, k1, n1;
+  bindDims(context, m, n0, k0, k1, n1);
+  SmallVector<AffineMap> indexingMaps = AffineMap::inferFromExprList(
+      {{m, k0, k1}, {n0, k0, k1, n1}, {m, n0, n1}});
+  SmallVector<utils::IteratorType> iteratorTypes = {
+      utils::IteratorType::parallel, utils::IteratorType::parallel,
+      utils::IteratorType::reduction, utils::IteratorType::reduction,
+      utils::IteratorType::parallel};
+  auto packedMatmul = rewriter.create<linalg::GenericOp>(
+      loc, init.getType(), ValueRange{lhs, packed}, init, indexingMaps,
+      iteratorTypes);
+  // The block arguments of the body are the same elements as before.
+  rewriter.cloneRegionBefore(op->getRegion(0), packedMatmul.getRegion(),
+                             packedMatmul.getRegion().end());
+
+  Value result = rewriter.create<tensor::CollapseShapeOp>(
+      loc, packedMatmul.getResult(0),
+      SmallVector<ReassociationIndices>{{0}, {1, 2}});
+  Type resultType = op->getResult(0).getType();
+  if (result.getType() != resultType)
+    result = rewriter.create<tensor::CastOp>(loc, resultType, result);
+  rewriter.replaceOp(op, result);
+}
+
+// Returns `tile` if it is positive and divides `size`, and `size` otherwise,
+// which leaves that dim unblocked.
+static int64_t getDividingTileSize(int64_t size, int64_t tile) {
+  return tile > 0 && size % tile == 0 ? tile : size;
+}
+
+namespace {
+class PackConstantWeights
+    : public PackConstantWeightsBase<PackConstantWeights> {
+public:
+  LogicalResult initialize(MLIRContext *context) override {
+    if (tuningDatabase.empty())
+      return success();
+    return loadTuningDatabase(context, tuningDatabase, tunedTileSizes);
+  }
+
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+    SmallVector<ConstantWeightMatmul> matmuls;
+    func.walk([&](linalg::LinalgOp op) {
+      if (std::optional<ConstantWeightMatmul> matmul =
+              matchConstantWeightMatmul(op))
+        matmuls.push_back(*matmul);
+    });
+
+    IRRewriter rewriter(&getContext());
+    for (const ConstantWeightMatmul &matmul : matmuls) {
+      TileSizes sizes = {kTileSize, nTileSize};
+      if (!tunedTileSizes.empty()) {
+        auto it = tunedTileSizes.find(getTuningKey(matmul.op));
+        if (it != tunedTileSizes.end())
+          sizes = it->second;
+      }
+      int64_t kTile = getDividingTileSize(matmul.k, sizes.cacheTileSize);
+      int64_t nTile = getDividingTileSize(matmul.n, sizes.vectorTileSize);
+      // Without blocking, only a transposed weight changes layout.
+      if (kTile == matmul.k && nTile == matmul.n && !matmul.transposed)
+        continue;
+      Operation *weight =
+          matmul.op.getDpsInputOperand(1)->get().getDefiningOp();
+      packMatmul(rewriter, matmul, kTile, nTile);
+      if (weight->use_empty())
+        rewriter.eraseOp(weight);
+      ++numPackedWeights;
+    }
+  }
+
+private:
+  llvm::StringMap<TileSizes> tunedTileSizes;
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::RefBackend::createPackConstantWeightsPass() {
+  return std::make_unique<PackConstantWeights>();
+}
+
+//===----------------------------------------------------------------------===//
+// PlanStaticBuffers
+//===----------------------------------------------------------------------===//
+
+namespace {
+// A statically shaped buffer that is allocated and deallocated in the entry
+// block of a function, and the range of ops in that block during which it is
+// live.
+struct PlannedBuffer {
+  memref::AllocOp alloc;
+  memref::DeallocOp dealloc;
+  int64_t begin;
+  int64_t end;
+  int64_t size;
+  int64_t offset = 0;
+};
+} // namespace
+
+static std::optional<int64_t> getStaticBufferSize(MemRefType type) {
+  if (!type.hasStaticShape() || !type.getLayout().isIdentity() ||
+      type.getMemorySpace())
+    return std::nullopt;
+  Type elemTy = type.getElementType();
+  int64_t bitWidth;
+  if (elemTy.isIntOrFloat())
+    bitWidth = elemTy.getIntOrFloatBitWidth();
+  else if (auto complexTy = elemTy.dyn_cast<ComplexType>();
+           complexTy && complexTy.getElementType().isIntOrFloat())
+    bitWidth = 2 * complexTy.getElementType().getIntOrFloatBitWidth();
+  else
+    return std::nullopt;
+  return type.getNumElements() * llvm::divideCeil(bitWidth, 8);
+}
+
+// Assigns an offset to each buffer so that buffers that are live at the same
+// time don't overlap, and returns the total size needed. Buffers are placed
+// largest first, each one at the lowest offset that fits, which is simple and
+// close to optimal on the mostly linear liveness of bufferized programs.
+static int64_t assignBufferOffsets(MutableArrayRef<PlannedBuffer> buffers,
+                                   int64_t alignment) {
+  SmallVector<PlannedBuffer *> order;
+  for (PlannedBuffer &buffer : buffers)
+    order.push_back(&buffer);
+  llvm::stable_sort(order, [](PlannedBuffer *a, PlannedBuffer *b) {
+    return a->size > b->size;
+  });
+
+  int64_t arenaSize = 0;
+  SmallVector<PlannedBuffer *> placed;
+  for (PlannedBuffer *buffer : order) {
+    // The placed buffers that are live at the same time, by offset.
+    SmallVector<PlannedBuffer *> conflicts;
+    for (PlannedBuffer *other : placed) {
+      if (other->begin <= buffer->end && buffer->begin <= other->end)
+        conflicts.push_back(other);
+    }
+    llvm::sort(conflicts, [](PlannedBuffer *a, PlannedBuffer *b) {
+      return a->offset < b->offset;
+    });
+    int64_t offset = 0;
+    for (PlannedBuffer *other : conflicts) {
+      if (offset + buffer->size <= other->offset)
+        break;
+      offset = std::max(
+          offset, llvm::alignTo(other->offset + other->size, alignment));
+    }
+    buffer->offset = offset;
+    arenaSize = std::max(arenaSize, offset + buffer->size);
+    placed.push_back(buffer);
+  }
+  return arenaSize;
+}
+
+namespace {
+class PlanStaticBuffers : public PlanStaticBuffersBase<PlanStaticBuffers> {
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+    if (func.isExternal() || !func.getBody().hasOneBlock())
+      return;
+    Block &block = func.getBody().front();
+
+    DenseMap<Operation *, int64_t> positions;
+    for (auto en : llvm::enumerate(block.getOperations()))
+      positions[&en.value()] = en.index();
+
+    // Buffers whose lifetime is delimited by a dealloc in the same block.
+    // Anything else (dynamically shaped buffers, buffers that escape through
+    // the return, allocations in nested regions) keeps using malloc.
+    SmallVector<PlannedBuffer> buffers;
+    for (auto alloc : block.getOps<memref::AllocOp>()) {
+      std::optional<int64_t> size = getStaticBufferSize(alloc.getType());
+      if (!size || !alloc.getSymbolOperands().empty())
+        continue;
+      if (alloc.getAlignment() &&
+          static_cast<int64_t>(*alloc.getAlignment()) > alignment)
+        continue;
+      memref::DeallocOp dealloc;
+      for (Operation *user : alloc->getUsers()) {
+        auto userDealloc = dyn_cast<memref::DeallocOp>(user);
+        if (!userDealloc || userDealloc->getBlock() != &block)
+          continue;
+        dealloc = userDealloc;
+        break;
+      }
+      if (!dealloc)
+        continue;
+      buffers.push_back({alloc, dealloc, positions[alloc],
+                         positions[dealloc], *size});
+    }
+    if (buffers.empty())
+      return;
+
+    int64_t arenaSize = assignBufferOffsets(buffers, alignment);
+    numPlannedBuffers += buffers.size();
+    for (const PlannedBuffer &buffer : buffers)
+      numBufferBytes += buffer.size;
+    numArenaBytes += arenaSize;
+
+    OpBuilder b(&block, block.begin());
+    Location loc = func.getLoc();
+    auto arenaType = MemRefType::get({arenaSize}, b.getI8Type());
+    Value arena = b.create<memref::AllocOp>(loc, arenaType,
+                                            b.getI64IntegerAttr(alignment));
+    for (PlannedBuffer &buffer : buffers) {
+      b.setInsertionPoint(buffer.alloc);
+      Value offset = b.create<arith::ConstantIndexOp>(buffer.alloc.getLoc(),
+                                                      buffer.offset);
+      Value view = b.create<memref::ViewOp>(buffer.alloc.getLoc(),
+                                            buffer.alloc.getType(), arena,
+                                            offset, ValueRange());
+      buffer.dealloc.erase();
+      buffer.alloc.replaceAllUsesWith(view);
+      buffer.alloc.erase();
+    }
+    b.setInsertionPoint(block.getTerminator());
+    b.create<memref::DeallocOp>(loc, arena);
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+mlir::torch::RefBackend::createPlanStaticBuffersPass() {
+  return std::make_unique<PlanStaticBuffers>();
+}
+
+//===----------------------------------------------------------------------===//
+// InsertOpTimers
+//===----------------------------------------------------------------------===//
+
+static constexpr StringRef kOpTimerNamesAttrName = "refback.op_timer_names";
+static constexpr StringRef kOpTimerStartFuncName = "refbackend_op_timer_start";
+static constexpr StringRef kOpTimerStopFuncName = "refbackend_op_timer_stop";
+
+static bool isTimedOp(Operation *op) {
+  return isa<linalg::LinalgOp, TMTensor::TMTensorOp>(op);
+}
+
+// Returns the name under which the time spent in `op` is reported: the name of
+// the op followed by its location, which is the location of the Torch op it
+// was converted from.
+static std::string getOpTimerName(Operation *op) {
+  std::string name;
+  llvm::raw_string_ostream os(name);
+  os << op->getName() << " ";
+  op->getLoc().print(os);
+  return os.str();
+}
+
+namespace {
+class InsertOpTimers : public InsertOpTimersBase<InsertOpTimers> {
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    // Ops nested in a timed op are accounted for by the time of that op.
+    SmallVector<Operation *> timedOps;
+    module.walk<WalkOrder::PreOrder>([&](Operation *op) {
+      if (!isTimedOp(op))
+        return WalkResult::advance();
+      timedOps.push_back(op);
+      return WalkResult::skip();
+    });
+    if (timedOps.empty())
+      return;
+
+    OpBuilder b(module.getBodyRegion());
+    SmallVector<Attribute> names;
+    for (auto [id, op] : llvm::enumerate(timedOps)) {
+      Location loc = op->getLoc();
+      b.setInsertionPoint(op);
+      Value idValue = b.create<arith::ConstantIntOp>(loc, id, /*width=*/64);
+      b.create<func::CallOp>(loc, kOpTimerStartFuncName, TypeRange(),
+                             idValue);
+      b.setInsertionPointAfter(op);
+      b.create<func::CallOp>(loc, kOpTimerStopFuncName, TypeRange(), idValue);
+      names.push_back(b.getStringAttr(getOpTimerName(op)));
+    }
+    module->setAttr(kOpTimerNamesAttrName, b.getArrayAttr(names));
+
+    b.setInsertionPointToEnd(module.getBody());
+    for (StringRef name : {kOpTimerStartFuncName, kOpTimerStopFuncName}) {
+      auto timerFunc = b.create<func::FuncOp>(
+          module.getLoc(), name,
+          FunctionType::get(module.getContext(), b.getI64Type(), {}));
+      timerFunc.setPrivate();
+      addEmitCInterfaceAttr(timerFunc);
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>>
+mlir::torch::RefBackend::createInsertOpTimersPass() {
+  return std::make_unique<InsertOpTimers>();
+}
+
+//===----------------------------------------------------------------------===//
+// RegisterHostBuffersForGpu
+//===----------------------------------------------------------------------===//
+
+// Registers `buffer` with the GPU runtime and returns the unranked memref that
+// was registered, which is what it must be unregistered with.
+static Value registerHostBuffer(OpBuilder &b, Location loc, Value buffer) {
+  Value unranked = buffer;
+  if (auto type = buffer.getType().dyn_cast<MemRefType>()) {
+    auto unrankedType =
+        UnrankedMemRefType::get(type.getElementType(), type.getMemorySpace());
+    unranked = b.create<memref::CastOp>(loc, unrankedType, buffer);
+  }
+  b.create<gpu::HostRegisterOp>(loc, unranked);
+  return unranked;
+}
+
+namespace {
+class RegisterHostBuffersForGpu
+    : public RegisterHostBuffersForGpuBase<RegisterHostBuffersForGpu> {
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    for (auto global : module.getOps<memref::GlobalOp>())
+      global->removeAttr(global.getConstantAttrName());
+
+    for (auto func : module.getOps<func::FuncOp>()) {
+      if (func.isExternal())
+        continue;
+      Block &entryBlock = func.getBody().front();
+      OpBuilder b(&entryBlock, entryBlock.begin());
+
+      // The buffers that are registered for the whole call.
+      SmallVector<Value> registered;
+      for (BlockArgument arg : func.getArguments()) {
+        if (registerArguments && arg.getType().isa<BaseMemRefType>())
+          registered.push_back(registerHostBuffer(b, func.getLoc(), arg));
+      }
+      // Registering the same memory twice is an error.
+      llvm::StringSet<> registeredGlobals;
+      for (auto getGlobal : entryBlock.getOps<memref::GetGlobalOp>()) {
+        if (!registeredGlobals.insert(getGlobal.getName()).second)
+          continue;
+        b.setInsertionPointAfter(getGlobal);
+        registered.push_back(
+            registerHostBuffer(b, getGlobal.getLoc(), getGlobal));
+      }
+      func.walk([&](func::ReturnOp ret) {
+        b.setInsertionPoint(ret);
+        for (Value buffer : registered)
+          b.create<gpu::HostUnregisterOp>(ret.getLoc(), buffer);
+      });
+
+      func.walk([&](memref::AllocOp alloc) {
+        b.setInsertionPointAfter(alloc);
+        Value buffer = registerHostBuffer(b, alloc.getLoc(), alloc);
+        for (Operation *user : alloc->getUsers()) {
+          if (!isa<memref::DeallocOp>(user))
+            continue;
+          b.setInsertionPoint(user);
+          b.create<gpu::HostUnregisterOp>(user->getLoc(), buffer);
+        }
+      });
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>>
+mlir::torch::RefBackend::createRegisterHostBuffersForGpuPass() {
+  return std::make_unique<RegisterHostBuffersForGpu>();
+}
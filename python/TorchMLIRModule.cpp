@@ -9,10 +9,46 @@
 
 #include "mlir/Bindings/Python/PybindAdaptors.h"
 #include "torch-mlir-c/Dialects.h"
+#include "torch-mlir-c/Instrumentation.h"
+#include "torch-mlir-c/Pipeline.h"
 #include "torch-mlir-c/Registration.h"
+#include "torch-mlir-c/Threading.h"
+#include "torch-mlir-c/TorchTypes.h"
+
+#include <pybind11/stl.h>
 
 namespace py = pybind11;
 
+namespace {
+// Owns a `TorchMlirPipeline`.
+class PyPipeline {
+public:
+  PyPipeline(MlirContext context, const std::string &pipeline) {
+    std::string error;
+    this->pipeline = torchMlirPipelineCreate(
+        context, mlirStringRefCreate(pipeline.data(), pipeline.size()),
+        [](MlirStringRef message, void *userData) {
+          static_cast<std::string *>(userData)->append(message.data,
+                                                       message.length);
+        },
+        &error);
+    if (torchMlirPipelineIsNull(this->pipeline))
+      throw std::invalid_argument("Failed to parse the pipeline '" + pipeline +
+                                  "': " + error);
+  }
+  PyPipeline(const PyPipeline &) = delete;
+  ~PyPipeline() { torchMlirPipelineDestroy(pipeline); }
+
+  bool run(MlirModule module) {
+    return mlirLogicalResultIsSuccess(
+        torchMlirPipelineRunOnOp(pipeline, mlirModuleGetOperation(module)));
+  }
+
+private:
+  TorchMlirPipeline pipeline;
+};
+} // namespace
+
 PYBIND11_MODULE(_torchMlir, m) {
   torchMlirRegisterAllPasses();
 
@@ -28,4 +64,61 @@ PYBIND11_MODULE(_torchMlir, m) {
         }
       },
       py::arg("context"), py::arg("load") = true);
+
+  m.def(
+      "clone_module",
+      [](MlirModule module) {
+        return mlirModuleFromOperation(
+            mlirOperationClone(mlirModuleGetOperation(module)));
+      },
+      py::arg("module"),
+      "Returns a deep copy of `module`, in the same context.");
+
+  m.def(
+      "value_tensor_type",
+      [](MlirContext context, std::vector<int64_t> sizes, MlirType dtype) {
+        return torchMlirTorchValueTensorTypeGet(context, sizes.size(),
+                                                sizes.data(), dtype);
+      },
+      py::arg("context"), py::arg("sizes"), py::arg("dtype"),
+      "Returns the `!torch.vtensor` type of the given sizes and dtype, "
+      "without going through the textual form of the type.");
+
+  m.def(
+      "set_thread_pool_size",
+      [](MlirContext context, unsigned numThreads) {
+        torchMlirContextSetThreadPoolSize(context, numThreads);
+      },
+      py::arg("context"), py::arg("num_threads"),
+      "Runs the multithreaded work of `context` on a thread pool of at most "
+      "`num_threads` threads, shared with the other contexts using that many "
+      "threads. 0 uses one thread per core.");
+
+  m.def("get_thread_pool_size", &torchMlirContextGetThreadPoolSize,
+        py::arg("context"),
+        "Returns the number of threads `context` runs its multithreaded work "
+        "on, or 0 if multithreading is disabled.");
+
+  m.def("is_multithreading_enabled", &torchMlirContextIsMultithreadingEnabled,
+        py::arg("context"));
+
+  m.def("add_memory_usage_instrumentation",
+        &torchMlirPassManagerAddMemoryUsageInstrumentation,
+        py::arg("pass_manager"), py::arg("large_attribute_count") = 10000,
+        py::arg("large_attribute_bytes") = 64 << 20,
+        "Makes `pass_manager` emit a remark after each pass with the memory "
+        "usage of the process and the attributes added to the IR, flagging "
+        "the passes that add at least `large_attribute_count` attributes or "
+        "`large_attribute_bytes` bytes of elements attributes.");
+
+  py::class_<PyPipeline>(m, "Pipeline",
+                         "A pass pipeline parsed once for `context`, which "
+                         "can run on many modules from several threads.")
+      .def(py::init<MlirContext, const std::string &>(), py::arg("context"),
+           py::arg("pipeline"))
+      // The GIL is kept, since the diagnostic handlers attached from Python
+      // call back into Python.
+      .def("run", &PyPipeline::run, py::arg("module"),
+           "Runs the pipeline on `module` in place, and returns true on "
+           "success.");
 }
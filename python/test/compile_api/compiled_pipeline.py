@@ -0,0 +1,44 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+from concurrent.futures import ThreadPoolExecutor
+
+import torch
+
+import torch_mlir
+from torch_mlir.compiler_utils import (CompiledPipeline,
+                                       run_pipeline_with_repro_report)
+
+class TanhModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+    def forward(self, x):
+        return torch.ops.aten.tanh(x)
+
+module = torch_mlir.compile(TanhModule(), torch.ones(2, 3), output_type="torch")
+pipeline = CompiledPipeline(
+    "builtin.module(torch-backend-to-linalg-on-tensors-backend-pipeline)",
+    module.context)
+
+# The pipeline is reused for every module, from several threads.
+modules = [torch_mlir.ir.Module.parse(str(module), module.context)
+           for _ in range(4)]
+with ThreadPoolExecutor(max_workers=2) as executor:
+    list(executor.map(
+        lambda m: run_pipeline_with_repro_report(
+            m, pipeline,
+            "Lowering Torch Backend IR -> Linalg-on-Tensors Backend IR"),
+        modules))
+for m in modules:
+    print(m)
+# CHECK-COUNT-4: linalg.generic
+
+try:
+    CompiledPipeline("builtin.module(not-a-pass)", module.context)
+except ValueError as e:
+    print(e)
+# CHECK: Failed to parse the pipeline 'builtin.module(not-a-pass)'
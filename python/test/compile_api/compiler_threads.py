@@ -0,0 +1,39 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import torch
+
+import torch_mlir
+from torch_mlir._mlir_libs._torchMlir import (get_thread_pool_size,
+                                              is_multithreading_enabled)
+from torch_mlir.compiler_utils import (run_pipeline_with_repro_report,
+                                       set_compiler_threads)
+
+class TanhModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+    def forward(self, x):
+        return torch.ops.aten.tanh(x)
+
+module = torch_mlir.compile(TanhModule(), torch.ones(2, 3), output_type="torch")
+
+set_compiler_threads(module.context, 2)
+print(get_thread_pool_size(module.context))
+# CHECK: 2
+
+# Multithreading is only disabled for the duration of the run.
+run_pipeline_with_repro_report(
+    module, "builtin.module(torch-backend-to-linalg-on-tensors-backend-pipeline)",
+    "Lowering Torch Backend IR -> Linalg-on-Tensors Backend IR",
+    multithreading=False)
+print(is_multithreading_enabled(module.context))
+# CHECK: True
+print(get_thread_pool_size(module.context))
+# CHECK: 2
+print(module)
+# CHECK-LABEL: @forward
+# CHECK: linalg.generic
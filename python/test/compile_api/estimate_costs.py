@@ -0,0 +1,32 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import torch
+
+import torch_mlir
+
+class TanhModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+    def forward(self, x):
+        return torch.ops.aten.tanh(x)
+
+module = torch_mlir.compile(TanhModule(), torch.ones(2, 3),
+                            output_type="torch")
+costs = torch_mlir.estimate_costs(module)
+for name, value in sorted(costs["forward"].items()):
+    print(name, value)
+# CHECK: activation_bytes 48
+# CHECK: bytes 48
+# CHECK: flops 6.0
+# CHECK: num_unestimated_ops 0
+# CHECK: parameter_bytes 0
+
+# The module is left untouched.
+print(module)
+# CHECK-LABEL: @forward
+# CHECK-NOT: torch.cost
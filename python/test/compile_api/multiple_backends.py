@@ -0,0 +1,47 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import torch
+
+import torch_mlir
+
+class TanhModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+    def forward(self, x):
+        return torch.ops.aten.tanh(x)
+
+tanh_example_input = torch.ones(2, 3)
+
+contract = torch_mlir.compile_to_backend_contract(
+    TanhModule(), tanh_example_input,
+    output_types=["linalg-on-tensors", "tosa"])
+print(contract.lower("linalg-on-tensors"))
+# CHECK-LABEL: @forward
+# CHECK: linalg.generic
+print(contract.lower("tosa"))
+# CHECK-LABEL: @forward
+# CHECK: tosa.tanh
+# The lowerings work on copies of the Torch backend IR.
+print(contract.module)
+# CHECK-LABEL: @forward
+# CHECK: torch.aten.tanh %{{.*}} : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+
+try:
+    contract.lower("stablehlo")
+except Exception as e:
+    print(e)
+# CHECK: The module was not compiled for the `stablehlo` output type, only for linalg-on-tensors, tosa
+
+modules = torch_mlir.compile_for_backends(
+    TanhModule(), tanh_example_input, output_types=["torch", "tosa"])
+print(modules[torch_mlir.OutputType.TORCH])
+# CHECK-LABEL: @forward
+# CHECK: torch.aten.tanh
+print(modules[torch_mlir.OutputType.TOSA])
+# CHECK-LABEL: @forward
+# CHECK: tosa.tanh
@@ -0,0 +1,60 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+from typing import List
+
+import torch
+import torch._dynamo as dynamo
+from torch_mlir.dynamo import make_simple_dynamo_backend
+
+num_compiles = 0
+
+
+@make_simple_dynamo_backend(max_cached_graphs=8)
+def counting_backend(gm: torch.fx.GraphModule,
+                     example_inputs: List[torch.Tensor]):
+    global num_compiles
+    num_compiles += 1
+    return gm
+
+
+def f(x, y):
+    return torch.tanh(x) + y
+
+
+def g(a, b):
+    return torch.tanh(a) + b
+
+
+def h(x, y):
+    return torch.sigmoid(x) + y
+
+
+x = torch.randn(3, 4)
+# `g` only differs from `f` by the names of its values, so it reuses the
+# callable compiled for `f`.
+# CHECK: 1 compile(s)
+dynamo.optimize(counting_backend)(f)(x, x)
+dynamo.optimize(counting_backend)(g)(x, x)
+print(f"{num_compiles} compile(s)")
+
+# CHECK: 2 compile(s)
+dynamo.optimize(counting_backend)(h)(x, x)
+print(f"{num_compiles} compile(s)")
+
+# Other sizes are compiled separately, but only once.
+# CHECK: 3 compile(s)
+dynamo.reset()
+dynamo.optimize(counting_backend)(f)(torch.randn(5, 4), torch.randn(5, 4))
+dynamo.reset()
+dynamo.optimize(counting_backend)(f)(torch.randn(5, 4), torch.randn(5, 4))
+print(f"{num_compiles} compile(s)")
+
+# The results are still computed by the compiled graph.
+# CHECK: True
+print(torch.allclose(dynamo.optimize(counting_backend)(g)(x, x),
+                     torch.tanh(x) + x))
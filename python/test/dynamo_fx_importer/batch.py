@@ -0,0 +1,45 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+from typing import List
+
+import torch
+import torch.fx
+import torch._dynamo as dynamo
+from torch._dynamo.backends.common import aot_autograd
+from torch._functorch.aot_autograd import make_boxed_compiler
+
+from torch_mlir.dynamo import compile_fx_graphs
+
+graphs = {}
+
+
+@make_boxed_compiler
+def collecting_backend(gm: torch.fx.GraphModule,
+                       example_inputs: List[torch.Tensor]):
+    graphs[f"graph{len(graphs)}"] = gm
+    return gm
+
+
+@dynamo.optimize(aot_autograd(fw_compiler=collecting_backend))
+def with_graph_break(x):
+    x = torch.tanh(x)
+    dynamo.graph_break()
+    return torch.sigmoid(x)
+
+
+with_graph_break(torch.randn(3, 4))
+
+# Both graphs end up as functions of one module.
+# CHECK:      module attributes {torch.debug_module_name = "graphs"} {
+# CHECK-LABEL:  func.func @graph0(
+# CHECK:          linalg.generic
+# CHECK:            math.tanh
+# CHECK-LABEL:  func.func @graph1(
+# CHECK:          linalg.generic
+# CHECK:            arith.negf
+print(compile_fx_graphs(graphs, output_type="linalg-on-tensors"))
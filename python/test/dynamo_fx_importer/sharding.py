@@ -0,0 +1,29 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import torch
+from torch.distributed._tensor import Replicate, Shard
+
+from torch_mlir._dynamo_fx_importer import hlo_sharding_from_placements
+
+mesh_1d = torch.arange(4)
+mesh_2d = torch.arange(4).reshape(2, 2)
+
+# CHECK: {devices=[4,1]0,1,2,3}
+print(hlo_sharding_from_placements(mesh_1d, [Shard(0)], 2))
+# CHECK: {devices=[1,4]0,1,2,3}
+print(hlo_sharding_from_placements(mesh_1d, [Shard(-1)], 2))
+# CHECK: {replicated}
+print(hlo_sharding_from_placements(mesh_2d, [Replicate(), Replicate()], 2))
+# CHECK: {devices=[2,2]0,1,2,3}
+print(hlo_sharding_from_placements(mesh_2d, [Shard(0), Shard(1)], 2))
+# CHECK: {devices=[2,2]0,2,1,3}
+print(hlo_sharding_from_placements(mesh_2d, [Shard(1), Shard(0)], 2))
+# CHECK: {devices=[4,1]0,1,2,3}
+print(hlo_sharding_from_placements(mesh_2d, [Shard(0), Shard(0)], 2))
+# CHECK: {devices=[1,2,2]0,2,1,3 last_tile_dim_replicate}
+print(hlo_sharding_from_placements(mesh_2d, [Replicate(), Shard(1)], 2))
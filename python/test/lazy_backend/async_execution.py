@@ -0,0 +1,32 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+
+import torch
+import torch._lazy
+
+import torch_mlir._mlir_libs._REFERENCE_LAZY_BACKEND as lazy_backend
+
+from run_test import run_test
+
+lazy_backend._initialize()
+lazy_backend.set_async_execution(True)
+
+device = "lazy"
+
+
+# CHECK: PASS - test_async_results
+@run_test
+def test_async_results():
+    x = torch.ones(2, 3).to(device)
+    y = x + x
+    torch._lazy.mark_step()
+    # The second step consumes the (possibly still pending) result of the
+    # first one.
+    z = y * y
+    torch._lazy.mark_step()
+    assert torch.equal(z.cpu(), torch.full((2, 3), 4.0))
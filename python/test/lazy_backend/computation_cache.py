@@ -0,0 +1,60 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+
+import torch
+import torch._lazy
+import torch._lazy.debug
+import torch._lazy.metrics
+
+import torch_mlir._mlir_libs._REFERENCE_LAZY_BACKEND as lazy_backend
+
+from run_test import run_test
+
+lazy_backend._initialize()
+
+device = "lazy"
+
+
+def get_counter(name):
+    if name not in torch._lazy.metrics.counter_names():
+        return 0
+    return torch._lazy.metrics.counter_value(name)
+
+
+def trace(x):
+    return torch.tanh(x.to(device) * 2 + 1)
+
+
+# CHECK: PASS - test_retrace_hits_cache
+@run_test
+def test_retrace_hits_cache():
+    hits = get_counter("TorchMlirComputationCacheHit")
+    misses = get_counter("TorchMlirComputationCacheMiss")
+    # Lowering the traced tensors to the backend builds their computation
+    # without going through the compilation cache of the lazy graph executor.
+    y = trace(torch.rand(2, 3))
+    first = torch._lazy.debug.dump_ir([y], "backend")
+    assert get_counter("TorchMlirComputationCacheHit") == hits
+    assert get_counter("TorchMlirComputationCacheMiss") == misses + 1
+
+    # Re-tracing the same graph on an input of the same shape hits the cache.
+    x = torch.rand(2, 3)
+    y = trace(x)
+    second = torch._lazy.debug.dump_ir([y], "backend")
+    assert get_counter("TorchMlirComputationCacheHit") == hits + 1
+    assert get_counter("TorchMlirComputationCacheMiss") == misses + 1
+    assert first == second
+
+    # A graph on an input of another shape is a different computation.
+    y_other = trace(torch.rand(3, 2))
+    torch._lazy.debug.dump_ir([y_other], "backend")
+    assert get_counter("TorchMlirComputationCacheHit") == hits + 1
+    assert get_counter("TorchMlirComputationCacheMiss") == misses + 2
+
+    torch._lazy.mark_step()
+    assert torch.allclose(y.cpu(), torch.tanh(x * 2 + 1))
@@ -14,6 +14,8 @@ import torch_mlir._mlir_libs._REFERENCE_LAZY_BACKEND as lazy_backend
 from run_test import run_test
 
 lazy_backend._initialize()
+# The input tensors of each computation are only printed when tracing.
+lazy_backend.set_trace_level(1)
 
 device = "lazy"
 
@@ -0,0 +1,40 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: env TORCH_MLIR_LTC_EAGER_OPS=aten::tanh %PYTHON %s | FileCheck %s
+
+
+import torch
+import torch._lazy
+import torch._lazy.metrics
+
+import torch_mlir._mlir_libs._REFERENCE_LAZY_BACKEND as lazy_backend
+
+from run_test import run_test
+
+lazy_backend._initialize()
+
+device = "lazy"
+
+
+def get_counter(name):
+    if name not in torch._lazy.metrics.counter_names():
+        return 0
+    return torch._lazy.metrics.counter_value(name)
+
+
+# CHECK: PASS - test_eager_segment
+@run_test
+def test_eager_segment():
+    x = torch.rand(2, 3)
+    partitioned = get_counter("TorchMlirPartitionedComputations")
+    eager_segments = get_counter("TorchMlirEagerSegments")
+    # `aten::tanh` is executed eagerly, between the lowered segments computing
+    # its input and its user.
+    y = torch.tanh(x.to(device) + 1) * 2
+    torch._lazy.mark_step()
+    assert torch.allclose(y.cpu(), torch.tanh(x + 1) * 2)
+    assert get_counter("TorchMlirPartitionedComputations") == partitioned + 1
+    assert get_counter("TorchMlirEagerSegments") == eager_segments + 1
@@ -0,0 +1,73 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import io
+import json
+
+import torch
+
+from torch_mlir_e2e_test.benchmarking import report_benchmarks, run_benchmarks
+from torch_mlir_e2e_test.framework import TestUtils
+from torch_mlir_e2e_test.registry import register_test_case, GLOBAL_TEST_REGISTRY
+from torch_mlir_e2e_test.configs import TorchScriptTestConfig
+
+
+class MmModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+
+    def forward(self, lhs, rhs):
+        return torch.mm(lhs, rhs)
+
+
+@register_test_case(module_factory=lambda: MmModule())
+def MmModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(4, 4), tu.rand(4, 4))
+
+
+class CompilationFailureModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+
+    def forward(self, t):
+        # Static type error that will fail TorchScript compilation.
+        if t.item() > 0:
+            return torch.tensor([])
+        else:
+            return 3
+
+
+@register_test_case(module_factory=lambda: CompilationFailureModule())
+def CompilationFailureModule_basic(module, tu: TestUtils):
+    module.forward(torch.ones([]))
+
+
+def main():
+    results = run_benchmarks(GLOBAL_TEST_REGISTRY, TorchScriptTestConfig(),
+                             warmup=1, repetitions=3)
+    output = io.StringIO()
+    report_benchmarks(results, "torchscript", 1, 3, output)
+    report = json.loads(output.getvalue())
+    # CHECK: config: torchscript
+    print("config:", report["config"])
+    for benchmark in report["benchmarks"]:
+        # CHECK: CompilationFailureModule_basic has error: True
+        # CHECK-SAME: speedup: None
+        # CHECK: MmModule_basic has error: False
+        # CHECK-SAME: timed: True
+        # CHECK-SAME: speedup: True
+        if benchmark["error"] is not None:
+            print(f"{benchmark['name']} has error: True",
+                  "speedup:", benchmark["speedup_over_eager"])
+        else:
+            print(f"{benchmark['name']} has error: False",
+                  "timed:", benchmark["run_time"]["median"] > 0,
+                  "speedup:", benchmark["speedup_over_eager"] > 0)
+
+
+if __name__ == '__main__':
+    main()
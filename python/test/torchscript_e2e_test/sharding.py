@@ -0,0 +1,68 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import torch
+
+from torch_mlir_e2e_test.framework import run_tests, shard_tests, TestUtils
+from torch_mlir_e2e_test.reporting import report_results
+from torch_mlir_e2e_test.registry import register_test_case, GLOBAL_TEST_REGISTRY
+from torch_mlir_e2e_test.configs import TorchScriptTestConfig
+
+
+class MmModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+
+    def forward(self, lhs, rhs):
+        return torch.mm(lhs, rhs)
+
+
+@register_test_case(module_factory=lambda: MmModule())
+def MmModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(4, 4), tu.rand(4, 4))
+
+
+@register_test_case(module_factory=lambda: MmModule())
+def MmModule_basic2(module, tu: TestUtils):
+    module.forward(tu.rand(4, 4), tu.rand(4, 4))
+
+
+@register_test_case(module_factory=lambda: MmModule())
+def MmModule_basic3(module, tu: TestUtils):
+    module.forward(tu.rand(4, 4), tu.rand(4, 4))
+
+
+@register_test_case(module_factory=lambda: MmModule())
+def MmModule_basic4(module, tu: TestUtils):
+    module.forward(tu.rand(4, 4), tu.rand(4, 4))
+
+
+def _names(tests):
+    return sorted(test.unique_name for test in tests)
+
+
+def main():
+    shards = [shard_tests(GLOBAL_TEST_REGISTRY, 3, i) for i in range(3)]
+    # CHECK: each test is in one shard: True
+    print("each test is in one shard:",
+          sorted(sum((_names(shard) for shard in shards), [])) ==
+          _names(GLOBAL_TEST_REGISTRY))
+    # CHECK: shards are deterministic: True
+    print("shards are deterministic:",
+          _names(shards[1]) ==
+          _names(shard_tests(list(reversed(GLOBAL_TEST_REGISTRY)), 3, 1)))
+
+    results = []
+    for shard in shards:
+        results += run_tests(shard, TorchScriptTestConfig(), num_processes=2)
+    # CHECK: Summary:
+    # CHECK: Passed: 4
+    report_results(results, set())
+
+
+if __name__ == '__main__':
+    main()
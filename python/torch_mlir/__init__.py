@@ -14,7 +14,12 @@ from torch._functorch.compile_utils import strip_overloads
 import torch
 import torch.fx
 
-from .compiler_utils import run_pipeline_with_repro_report
+from ._mlir_libs._torchMlir import clone_module
+from .compiler_utils import CompiledPipeline, run_pipeline_with_repro_report
+from .compile_cache import CompileCache
+from .external_tensors import save_external_tensors
+from .dialects import torch as torch_dialect
+from .ir import Context, FloatAttr, IntegerAttr, Module, StringAttr
 from torch_mlir.dialects.torch.importer.jit_ir import ClassAnnotator, ImportOptions, ModuleBuilder
 from torch_mlir.dialects.torch.importer.jit_ir.build_tools.library_generator import generate_library
 
@@ -243,8 +248,40 @@ class ExampleArgs:
 # compiler where each backend can "own" its set of legal ops.
 BACKEND_LEGAL_OPS = {
     OutputType.TOSA: ['aten.flatten.using_ints', 'aten.native_layer_norm', 'aten.linear'],
-    OutputType.LINALG_ON_TENSORS: ['aten.flatten.using_ints', ],
-    OutputType.STABLEHLO: [],
+    OutputType.LINALG_ON_TENSORS: [
+        'aten.flatten.using_ints',
+        # Lowered to two passes over the input instead of five ops.
+        'aten.softmax.int', 'aten._softmax',
+        'aten.log_softmax.int', 'aten._log_softmax',
+        # Lowered to a single-pass Welford reduction plus a normalization pass.
+        'aten.native_layer_norm',
+        # Lowered like `aten.native_layer_norm`, with the statistics of each
+        # group of channels, reading NHWC inputs in place.
+        'aten.native_group_norm',
+        # Lowered to a single contraction that accumulates into the bias.
+        'aten.linear',
+        # Lowered to tm_tensor.attention rather than two matmuls and a
+        # softmax.
+        'aten.scaled_dot_product_attention',
+        # Lowered to copies of the input blocks that move as a whole, rather
+        # than two slices and a concatenation per rolled dim.
+        'aten.roll',
+        # Lowered for any output size, with windows of varying sizes, rather
+        # than only the sizes that `aten.avg_pool2d` can express.
+        'aten.adaptive_avg_pool2d',
+        # Lowered to a binary search over the boundaries for each element,
+        # rather than comparing each element with every boundary.
+        'aten.bucketize.Tensor',
+        # Lowered straight from the logits, rather than from their
+        # log-softmax.
+        'aten.cross_entropy_loss',
+    ],
+    OutputType.STABLEHLO: [
+        # Lowered to a single variadic reduction computing the count, mean and
+        # M2 of Welford's algorithm.
+        'aten.var.correction', 'aten.var.dim',
+        'aten.var_mean.correction', 'aten.var_mean.dim', 'aten.var_mean',
+    ],
 }
 
 
@@ -263,7 +300,8 @@ def _canon_extra_library(extra_library):
     return extra_library_file_name
 
 
-def _lower_mlir_module(verbose, output_type, module):
+def _lower_mlir_module(verbose, output_type, module,
+                       report_memory_usage=False):
     if verbose:
         print("\n====================")
         print("Torch Backend IR")
@@ -275,7 +313,8 @@ def _lower_mlir_module(verbose, output_type, module):
     if output_type == OutputType.TOSA:
         run_pipeline_with_repro_report(
             module, "builtin.module(torch-backend-to-tosa-backend-pipeline)",
-            "Lowering Torch Backend IR -> TOSA Backend IR")
+            "Lowering Torch Backend IR -> TOSA Backend IR",
+            report_memory_usage=report_memory_usage)
         if verbose:
             print("\n====================")
             print("TOSA Backend IR")
@@ -286,7 +325,8 @@ def _lower_mlir_module(verbose, output_type, module):
         run_pipeline_with_repro_report(
             module,
             "builtin.module(torch-backend-to-linalg-on-tensors-backend-pipeline)",
-            "Lowering Torch Backend IR -> Linalg-on-Tensors Backend IR")
+            "Lowering Torch Backend IR -> Linalg-on-Tensors Backend IR",
+            report_memory_usage=report_memory_usage)
         if verbose:
             print("\n====================")
             print("LINALG Backend IR")
@@ -297,7 +337,8 @@ def _lower_mlir_module(verbose, output_type, module):
         run_pipeline_with_repro_report(
             module,
             "builtin.module(torch-backend-to-stablehlo-backend-pipeline)",
-            "Lowering Torch Backend IR -> StableHLO Backend IR")
+            "Lowering Torch Backend IR -> StableHLO Backend IR",
+            report_memory_usage=report_memory_usage)
         if verbose:
             print("\n====================")
             print("StableHLO Backend IR")
@@ -306,67 +347,10 @@ def _lower_mlir_module(verbose, output_type, module):
     raise Exception(f"Unknown OutputType: {output_type}")
 
 
-def compile(model: torch.nn.Module,
-            example_args: _example_args,
-            output_type: Union[str, "OutputType"] = OutputType.TORCH,
-            use_tracing: bool = False,
-            ignore_traced_shapes=False,
-            backend_legal_ops: Optional[Sequence[str]] = None,
-            extra_library: Iterable[Callable] = [],
-            verbose: bool = False):
-    """Convert a PyTorch model to MLIR.
-
-    Args:
-        model: The PyTorch model to convert.
-        example_args: A list of example arguments to use when inferring the
-            shapes of the arguments to `forward` method of the model.
-            A single tensor is treated as a list of a single tensor.
-            A TensorPlaceholder object is also allowed in the place of any
-            Tensor. For models with multiple methods, an `ExampleArgs` object
-            can be passed.
-        output_type: The kind of output to produce. See `OutputType` for more
-            details.
-        use_tracing: If True, use `torch.jit.trace` to convert the model to
-            JIT IR rather than `torch.jit.script`.
-        ignore_traced_shapes: If True, ignore the shapes that were observed
-            during tracing. This should only be used if one knows that the
-            original traced program would result in the same trace (modulo
-            shapes) for all shape combinations implied by any
-            `TensorPlaceholder`'s used as `example_args`. Also,
-            strictly-speaking, this option covers dtypes too, but we just say
-            "shapes" to be succinct.
-        backend_legal_ops: A list of ops that should be considered legal for
-            the backend. An op that is considered legal will not be decomposed.
-            This option is only valid with the `"torch"` output type.
-        extra_library: List of abstract interpretation functions to splice
-            into the abstract interpretation library. See
-            `docs/adding_abstract_interpretation_functions.md` for more info
-            on the format the functions should have.
-        verbose: If true, print extra information about the conversion.
-
-    Returns:
-        An MLIR module that contains the converted model in the specified
-        output type.
-    """
-    extra_library_file_name = _canon_extra_library(extra_library)
-    output_type = OutputType.get(output_type)
-    example_args = ExampleArgs.get(example_args)
-    if ignore_traced_shapes and not use_tracing:
-        raise Exception("`ignore_traced_shapes` requires `use_tracing`")
-
-    # We only allow `backend_legal_ops` to be specified for the `"torch"`
-    # output type because the other output types actually invoke their
-    # respective backends (Linalg, TOSA, or STABLEHLO), and those backends have
-    # very specific requirements about the ops which are legal.
-    # See `BACKEND_LEGAL_OPS` for more details.
-    if backend_legal_ops is not None:
-        if output_type != OutputType.TORCH:
-            raise Exception("`backend_legal_ops` is only valid with the "
-                            "`torch` output type")
-        backend_legal_ops = list(sorted(set(backend_legal_ops)))
-    else:
-        backend_legal_ops = BACKEND_LEGAL_OPS.get(output_type, [])
-
+def _import_model(model, example_args: "ExampleArgs", use_tracing: bool,
+                  ignore_traced_shapes: bool,
+                  external_tensors_file: Optional[str]):
+    """Imports `model` as TorchScript object graph IR, see `compile`."""
     # For FX-based models, automatically strip overloads.
     if isinstance(model, torch.fx.GraphModule):
         strip_overloads(model)
@@ -415,6 +399,7 @@ def compile(model: torch.nn.Module,
     mb = ModuleBuilder()
     import_options = ImportOptions()
     import_options.ignoreExistingTensorShapesAndDtypes = ignore_traced_shapes
+    import_options.externalizeTensors = external_tensors_file is not None
     try:
         original_stderr = sys.stderr
         sys.stderr = StringIO()
@@ -430,15 +415,424 @@ PyTorch TorchScript module -> torch-mlir Object Graph IR import failed with:
 """) from None
     finally:
         sys.stderr = original_stderr
-    if output_type == OutputType.RAW:
-        return mb.module
+    # The module only has the structure and methods of the model at this
+    # point, and the tensors are streamed to their file from the model.
+    if external_tensors_file is not None:
+        save_external_tensors(mb.module, scripted, external_tensors_file)
+    return mb.module
 
+
+def _lower_to_backend_contract(module, backend_legal_ops: Sequence[str],
+                               extra_library_file_name: str, verbose: bool,
+                               report_memory_usage: bool = False):
+    """Lowers an imported module, in place, to the Torch backend IR."""
     option_string = "{backend-legal-ops=" + ",".join(backend_legal_ops) + \
-        " extra-library=" + extra_library_file_name + "}"
+        " extra-library=" + extra_library_file_name
+    # In verbose mode, report the progress of each iteration of the
+    # simplification pipeline run by `torch-lower-to-backend-contract`.
+    if verbose:
+        option_string += " report-iterations=true"
+    option_string += "}"
     run_pipeline_with_repro_report(
-        mb.module,
+        module,
         f"builtin.module(torchscript-module-to-torch-backend-pipeline{option_string})",
         "Lowering TorchScript IR -> Torch Backend IR",
+        print_remarks=verbose,
+        report_memory_usage=report_memory_usage,
     )
 
-    return _lower_mlir_module(verbose, output_type, mb.module)
+
+def compile(model: torch.nn.Module,
+            example_args: _example_args,
+            output_type: Union[str, "OutputType"] = OutputType.TORCH,
+            use_tracing: bool = False,
+            ignore_traced_shapes=False,
+            backend_legal_ops: Optional[Sequence[str]] = None,
+            extra_library: Iterable[Callable] = [],
+            verbose: bool = False,
+            cache_dir: Optional[str] = None,
+            external_tensors_file: Optional[str] = None,
+            report_memory_usage: bool = False):
+    """Convert a PyTorch model to MLIR.
+
+    Args:
+        model: The PyTorch model to convert.
+        example_args: A list of example arguments to use when inferring the
+            shapes of the arguments to `forward` method of the model.
+            A single tensor is treated as a list of a single tensor.
+            A TensorPlaceholder object is also allowed in the place of any
+            Tensor. For models with multiple methods, an `ExampleArgs` object
+            can be passed.
+        output_type: The kind of output to produce. See `OutputType` for more
+            details.
+        use_tracing: If True, use `torch.jit.trace` to convert the model to
+            JIT IR rather than `torch.jit.script`.
+        ignore_traced_shapes: If True, ignore the shapes that were observed
+            during tracing. This should only be used if one knows that the
+            original traced program would result in the same trace (modulo
+            shapes) for all shape combinations implied by any
+            `TensorPlaceholder`'s used as `example_args`. Also,
+            strictly-speaking, this option covers dtypes too, but we just say
+            "shapes" to be succinct.
+        backend_legal_ops: A list of ops that should be considered legal for
+            the backend. An op that is considered legal will not be decomposed.
+            This option is only valid with the `"torch"` output type.
+        extra_library: List of abstract interpretation functions to splice
+            into the abstract interpretation library. See
+            `docs/adding_abstract_interpretation_functions.md` for more info
+            on the format the functions should have.
+        verbose: If true, print extra information about the conversion,
+            including the progress made by each iteration of the lowering to
+            the backend contract.
+        cache_dir: A directory in which to cache the lowered modules, keyed
+            on the imported module and the options above. If not given, the
+            `TORCH_MLIR_COMPILE_CACHE_DIR` environment variable is used, and
+            if that is not set either, nothing is cached. The cache is not
+            consulted for the `"raw"` output type.
+        external_tensors_file: If given, the tensors held by the model (its
+            parameters and buffers) are not imported into the module, but
+            referenced by their name in the model's `state_dict()`. Their
+            contents are then written to this file in the safetensors format,
+            a chunk at a time, so that very large models can be compiled
+            without holding a copy of their weights in the module. Every
+            tensor held by the model must be in its state dict.
+        report_memory_usage: If true, print the memory usage of the process
+            and the attributes added to the IR after each pass of the
+            lowering pipelines, flagging the passes that create many
+            attributes. This helps finding the passes that drive the peak
+            memory usage of the compilation of large models.
+
+    Returns:
+        An MLIR module that contains the converted model in the specified
+        output type.
+    """
+    extra_library_file_name = _canon_extra_library(extra_library)
+    output_type = OutputType.get(output_type)
+    example_args = ExampleArgs.get(example_args)
+    if ignore_traced_shapes and not use_tracing:
+        raise Exception("`ignore_traced_shapes` requires `use_tracing`")
+
+    # We only allow `backend_legal_ops` to be specified for the `"torch"`
+    # output type because the other output types actually invoke their
+    # respective backends (Linalg, TOSA, or STABLEHLO), and those backends have
+    # very specific requirements about the ops which are legal.
+    # See `BACKEND_LEGAL_OPS` for more details.
+    if backend_legal_ops is not None:
+        if output_type != OutputType.TORCH:
+            raise Exception("`backend_legal_ops` is only valid with the "
+                            "`torch` output type")
+        backend_legal_ops = list(sorted(set(backend_legal_ops)))
+    else:
+        backend_legal_ops = BACKEND_LEGAL_OPS.get(output_type, [])
+
+    module = _import_model(model, example_args, use_tracing,
+                           ignore_traced_shapes, external_tensors_file)
+    if output_type == OutputType.RAW:
+        return module
+
+    cache = CompileCache.from_env_or(cache_dir)
+    if cache is not None:
+        cache_key = cache.get_key(module, output_type.value,
+                                  backend_legal_ops, extra_library_file_name)
+        cached_module = cache.load(cache_key, module.context)
+        if cached_module is not None:
+            if verbose:
+                print("\n====================")
+                print(f"Loaded {output_type.value} IR from the compilation cache")
+                print(cached_module)
+            return cached_module
+        # The Torch backend IR only depends on the backend legal ops, not on
+        # the backend it is lowered to next, so it is cached on its own and
+        # shared by the output types with the same legal ops. This keeps
+        # compiling a model for several backends from running the frontend
+        # pipeline for each of them.
+        contract_cache_key = cache.get_key(module, OutputType.TORCH.value,
+                                           backend_legal_ops,
+                                           extra_library_file_name)
+
+    contract_module = None
+    if cache is not None and contract_cache_key != cache_key:
+        contract_module = cache.load(contract_cache_key, module.context)
+    if contract_module is None:
+        _lower_to_backend_contract(module, backend_legal_ops,
+                                   extra_library_file_name, verbose,
+                                   report_memory_usage)
+        contract_module = module
+        # The lowering to the backend modifies the module in place, so the
+        # Torch backend IR is stored first.
+        if cache is not None and contract_cache_key != cache_key:
+            cache.store(contract_cache_key, contract_module)
+
+    module = _lower_mlir_module(verbose, output_type, contract_module,
+                                report_memory_usage)
+    if cache is not None:
+        cache.store(cache_key, module)
+    return module
+
+
+def estimate_costs(module) -> Dict[str, Dict[str, float]]:
+    """Estimates the compute and memory traffic of each function of `module`,
+    which is in the Torch backend IR, without running it.
+
+    Returns, for each function name, its `flops`, the `bytes` read and written
+    by its ops, its `parameter_bytes` and `activation_bytes`, and the
+    `num_unestimated_ops` whose tensors don't have static sizes. See the
+    `torch-estimate-costs` pass. `module` itself is left untouched.
+    """
+    module = clone_module(module)
+    run_pipeline_with_repro_report(module,
+                                   "builtin.module(torch-estimate-costs)",
+                                   "Estimating the costs of the module")
+    costs = {}
+    for op in module.body.operations:
+        if "torch.cost" not in op.attributes:
+            continue
+        cost_attr = op.attributes["torch.cost"]
+        cost = {}
+        for i in range(len(cost_attr)):
+            named_attr = cost_attr[i]
+            if FloatAttr.isinstance(named_attr.attr):
+                cost[named_attr.name] = FloatAttr(named_attr.attr).value
+            else:
+                cost[named_attr.name] = IntegerAttr(named_attr.attr).value
+        costs[StringAttr(op.attributes["sym_name"]).value] = cost
+    return costs
+
+
+def save_bytecode(module, file):
+    """Writes `module`, such as one returned by `compile`, to `file` as MLIR
+    bytecode.
+
+    `file` is a path or a binary file object. Bytecode is much faster to load
+    than the textual form of the module, so it is the preferred way to hand a
+    module over to another process. See `load_module` to read it back.
+    """
+    if isinstance(file, str):
+        with open(file, "wb") as f:
+            module.operation.write_bytecode(f)
+    else:
+        module.operation.write_bytecode(file)
+
+
+def load_module(file, context: Optional[Context] = None) -> Module:
+    """Reads a module written by `save_bytecode`, or in the textual form, from
+    `file`, which is a path or a binary file object.
+
+    The module is loaded into `context`, or into a new context with the Torch
+    dialect registered if not given.
+    """
+    if isinstance(file, str):
+        with open(file, "rb") as f:
+            data = f.read()
+    else:
+        data = file.read()
+    if context is None:
+        context = Context()
+        torch_dialect.register_dialect(context)
+    return Module.parse(data, context=context)
+
+
+class BackendContractModule:
+    """The Torch backend IR of a model, which can be lowered to several
+    backends while the frontend pipeline runs only once.
+
+    See `compile_to_backend_contract`.
+    """
+
+    def __init__(self, module, backend_legal_ops: List[str],
+                 output_types: List[OutputType]):
+        # The Torch backend IR, which `lower` leaves untouched.
+        self.module = module
+        self.backend_legal_ops = backend_legal_ops
+        self.output_types = output_types
+
+    def lower(self, output_type: Union[str, "OutputType"],
+              verbose: bool = False):
+        """Returns a copy of the Torch backend IR lowered to `output_type`.
+
+        Args:
+            output_type: One of the output types the module was compiled for,
+                or `"torch"`, which returns a copy of the Torch backend IR.
+            verbose: If true, print the IR before and after the lowering.
+        """
+        output_type = OutputType.get(output_type)
+        if output_type != OutputType.TORCH and \
+                output_type not in self.output_types:
+            raise Exception(
+                f"The module was not compiled for the `{output_type.value}` "
+                f"output type, only for "
+                f"{', '.join(t.value for t in self.output_types)}")
+        # The lowering modifies the module in place, so it works on a copy.
+        # The copy is made in C++, which is much cheaper than printing and
+        # parsing the module, and keeps it in the same context.
+        return _lower_mlir_module(verbose, output_type,
+                                  clone_module(self.module))
+
+    def estimate_costs(self) -> Dict[str, Dict[str, float]]:
+        """Returns the estimated costs of each function of the Torch backend
+        IR, see `estimate_costs`."""
+        return estimate_costs(self.module)
+
+
+def compile_to_backend_contract(
+        model: torch.nn.Module,
+        example_args: _example_args,
+        output_types: Sequence[Union[str, "OutputType"]],
+        use_tracing: bool = False,
+        ignore_traced_shapes=False,
+        extra_library: Iterable[Callable] = [],
+        verbose: bool = False,
+        external_tensors_file: Optional[str] = None) -> BackendContractModule:
+    """Converts a PyTorch model to the Torch backend IR shared by several
+    output types.
+
+    This runs the import and the frontend pipeline, which are usually the most
+    expensive part of `compile`, once for all of `output_types`. The result
+    can then be lowered to each of them with `BackendContractModule.lower`:
+    ```python
+    contract = torch_mlir.compile_to_backend_contract(
+        model, example_args, output_types=["linalg-on-tensors", "tosa"])
+    linalg_module = contract.lower("linalg-on-tensors")
+    tosa_module = contract.lower("tosa")
+    ```
+
+    Only the ops that are legal for all of `output_types` (see
+    `BACKEND_LEGAL_OPS`) are kept undecomposed, so a backend can get slightly
+    different IR than with `compile`.
+
+    The other arguments are as for `compile`.
+    """
+    output_types = [OutputType.get(t) for t in output_types]
+    if not output_types:
+        raise Exception("`output_types` must not be empty")
+    if OutputType.RAW in output_types:
+        raise Exception("The `raw` output type has no backend contract")
+    if ignore_traced_shapes and not use_tracing:
+        raise Exception("`ignore_traced_shapes` requires `use_tracing`")
+    backend_legal_ops = set(BACKEND_LEGAL_OPS.get(output_types[0], []))
+    for output_type in output_types[1:]:
+        backend_legal_ops &= set(BACKEND_LEGAL_OPS.get(output_type, []))
+    backend_legal_ops = list(sorted(backend_legal_ops))
+
+    extra_library_file_name = _canon_extra_library(extra_library)
+    module = _import_model(model, ExampleArgs.get(example_args), use_tracing,
+                           ignore_traced_shapes, external_tensors_file)
+    _lower_to_backend_contract(module, backend_legal_ops,
+                               extra_library_file_name, verbose)
+    return BackendContractModule(module, backend_legal_ops, output_types)
+
+
+def compile_for_backends(
+        model: torch.nn.Module,
+        example_args: _example_args,
+        output_types: Sequence[Union[str, "OutputType"]],
+        **kwargs) -> Dict[OutputType, object]:
+    """Converts a PyTorch model to MLIR for each of `output_types`, running
+    the frontend pipeline only once.
+
+    Takes the same arguments as `compile_to_backend_contract`, and returns the
+    module of each output type. The backend lowerings run one after the
+    other, each parallelized over the functions of the module by the MLIR
+    pass manager.
+    """
+    contract = compile_to_backend_contract(model, example_args, output_types,
+                                           **kwargs)
+    return {
+        output_type: contract.lower(output_type,
+                                    verbose=kwargs.get("verbose", False))
+        for output_type in contract.output_types
+    }
+
+
+class ShapeSpecializedFunction:
+    """A function compiled for dynamic shapes, plus lazily compiled static-shape
+    specializations for the argument shapes it is called with most often.
+
+    Fully static shapes give the fastest code, but need a compile per shape,
+    while dynamic shapes need a single compile. This class compiles one
+    dynamic-shape variant up front, and dispatches each call on the shapes of
+    its arguments: once a combination of shapes has been seen
+    `specialize_after` times, a variant specialized to exactly those shapes is
+    compiled and used for it from then on. This suits serving with a variable
+    batch size, where a few batch sizes (say 1, 8 and 32) are hot.
+    ```python
+    def compile_fn(example_args):
+        module = torch_mlir.compile(model, example_args,
+                                    output_type="linalg-on-tensors")
+        return backend.load(backend.compile(module)).forward
+
+    forward = ShapeSpecializedFunction(
+        compile_fn, [TensorPlaceholder([-1, 128], torch.float32)])
+    forward(x)
+    ```
+    """
+
+    def __init__(self,
+                 compile_fn: Callable[[List[TensorPlaceholder]], Callable],
+                 example_args: _example_args_for_one_method,
+                 specialize_after: int = 2,
+                 max_specializations: int = 8):
+        """
+        Args:
+            compile_fn: Compiles the function for a list of `TensorPlaceholder`
+                arguments, and returns a callable that runs it.
+            example_args: The arguments of the dynamic-shape variant, as for
+                `torch_mlir.compile`. Tensors are taken to be fully static.
+                Static sizes are kept in the specializations, and calls
+                whose arguments don't match them go to the dynamic variant.
+            specialize_after: The number of calls with the same argument
+                shapes after which a variant specialized to those shapes is
+                compiled. With 1, the first call with new shapes compiles one.
+            max_specializations: The maximum number of specialized variants.
+                Once reached, calls with shapes that don't have one go to the
+                dynamic variant.
+        """
+        if specialize_after < 1:
+            raise ValueError("`specialize_after` must be at least 1")
+        self._compile_fn = compile_fn
+        self._placeholders = [
+            arg if isinstance(arg, TensorPlaceholder) else
+            TensorPlaceholder.like(arg)
+            for arg in ExampleArgs._canonicalize_args(example_args)
+        ]
+        self._specialize_after = specialize_after
+        self._max_specializations = max_specializations
+        self._dynamic = compile_fn(self._placeholders)
+        self._specialized = {}
+        self._call_counts = {}
+
+    @property
+    def specialized_shapes(self) -> List[Tuple[Tuple[int, ...], ...]]:
+        """The argument shapes that have a specialized variant."""
+        return list(self._specialized.keys())
+
+    def _is_specializable(self, shapes) -> bool:
+        if len(shapes) != len(self._placeholders):
+            return False
+        for shape, placeholder in zip(shapes, self._placeholders):
+            if len(shape) != len(placeholder.shape):
+                return False
+            for size, placeholder_size in zip(shape, placeholder.shape):
+                if placeholder_size != -1 and size != placeholder_size:
+                    return False
+        return True
+
+    def __call__(self, *args):
+        shapes = tuple(tuple(arg.shape) for arg in args)
+        specialized = self._specialized.get(shapes)
+        if specialized is not None:
+            return specialized(*args)
+        if len(self._specialized) < self._max_specializations and \
+                self._is_specializable(shapes):
+            count = self._call_counts.get(shapes, 0) + 1
+            if count < self._specialize_after:
+                self._call_counts[shapes] = count
+            else:
+                self._call_counts.pop(shapes, None)
+                specialized = self._compile_fn([
+                    TensorPlaceholder(list(shape), placeholder.dtype)
+                    for shape, placeholder in zip(shapes, self._placeholders)
+                ])
+                self._specialized[shapes] = specialized
+                return specialized(*args)
+        return self._dynamic(*args)
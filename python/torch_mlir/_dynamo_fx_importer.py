@@ -21,8 +21,9 @@ import pdb
 # FX -> MLIR use cases should be done carefully, and likely will involve
 # introducing new concepts or abstractions into the import process.
 
-from typing import Dict, Tuple
+from typing import Dict, Optional, Sequence, Tuple
 
+import math
 import operator
 import re
 
@@ -31,6 +32,13 @@ import torch
 import torch_mlir.ir as ir
 import torch_mlir.dialects.func as func_dialect
 import torch_mlir.dialects.torch as torch_dialect
+from torch_mlir._mlir_libs._torchMlir import value_tensor_type
+
+try:
+    from torch.distributed._tensor import DTensor, Replicate, Shard
+except ImportError:
+    # PyTorch was built without distributed support.
+    DTensor = None
 
 
 def _is_valid_meta_val(val):
@@ -38,13 +46,81 @@ def _is_valid_meta_val(val):
     # as meta['val']. However, this can potentially change also hold a SymInt
     # in the future. See:
     # https://github.com/pytorch/pytorch/issues/90839#issuecomment-1352856661
+    # DTensor's of FakeTensor's are imported with their global shape, and
+    # their placements as a `torch.sharding` attribute.
     if isinstance(val, torch._subclasses.FakeTensor):
         return True
+    if DTensor is not None and isinstance(val, DTensor):
+        return isinstance(val._local_tensor, torch._subclasses.FakeTensor)
     if isinstance(val, (tuple, list)):
-        return all(isinstance(x, torch._subclasses.FakeTensor) for x in val)
+        return all(_is_valid_meta_val(x) for x in val)
     return False
 
 
+def hlo_sharding_from_placements(mesh: torch.Tensor,
+                                 placements: Sequence[object],
+                                 ndim: int) -> str:
+    """Returns the textual HLO sharding of a DTensor.
+
+    Args:
+        mesh: The device ids of the DTensor's `DeviceMesh`, with one dimension
+            per mesh dimension.
+        placements: The `Shard` or `Replicate` placement of the DTensor along
+            each mesh dimension.
+        ndim: The rank of the DTensor.
+    Returns:
+        The sharding, such as "{devices=[2,1]0,1}" for a matrix split along
+        its rows across a mesh of two devices. The tiles assigned to the
+        devices of a mesh dimension along which the DTensor is replicated are
+        the same, which is modeled by a last tile dimension of replicas.
+    """
+    sharded_mesh_dims = [[] for _ in range(ndim)]
+    replicated_mesh_dims = []
+    for mesh_dim, placement in enumerate(placements):
+        if isinstance(placement, Shard):
+            sharded_mesh_dims[placement.dim % ndim].append(mesh_dim)
+        elif isinstance(placement, Replicate):
+            replicated_mesh_dims.append(mesh_dim)
+        else:
+            raise Exception(f"Unsupported: DTensor placement {placement}")
+    if not any(sharded_mesh_dims):
+        return "{replicated}"
+    # A tensor dimension sharded along several mesh dimensions is split along
+    # the first of them first, as DTensor does.
+    tile_shape = [
+        math.prod(mesh.shape[d] for d in dims) for dims in sharded_mesh_dims
+    ]
+    permutation = [d for dims in sharded_mesh_dims for d in dims]
+    suffix = ""
+    if replicated_mesh_dims:
+        tile_shape.append(
+            math.prod(mesh.shape[d] for d in replicated_mesh_dims))
+        permutation += replicated_mesh_dims
+        suffix = " last_tile_dim_replicate"
+    devices = mesh.permute(permutation).flatten().tolist()
+    return (f"{{devices=[{','.join(str(size) for size in tile_shape)}]"
+            f"{','.join(str(device) for device in devices)}{suffix}}}")
+
+
+def _sharding_attrs_for_nodes(nodes: Sequence[torch.fx.Node]
+                              ) -> Optional[ir.ArrayAttr]:
+    """Returns the `torch.sharding` attributes of the function arguments or
+    results imported from `nodes`, or None if none of them is a DTensor."""
+    attrs = []
+    for node in nodes:
+        val = node.meta["val"]
+        if DTensor is None or not isinstance(val, DTensor):
+            attrs.append(ir.DictAttr.get({}))
+            continue
+        sharding = hlo_sharding_from_placements(val.device_mesh.mesh,
+                                                val.placements, val.ndim)
+        attrs.append(
+            ir.DictAttr.get({"torch.sharding": ir.StringAttr.get(sharding)}))
+    if all(len(attr) == 0 for attr in attrs):
+        return None
+    return ir.ArrayAttr.get(attrs)
+
+
 def _verify_fx_graph_conforms_to_subset(g: torch.fx.Graph):
     # TODO: Report errors with source locations if possible.
     def _check_meta_val(node):
@@ -130,6 +206,11 @@ def _convert_dtype_to_mlir_type(dtype: torch.dtype) -> str:
         return "f32"
     if dtype == torch.float64:
         return "f64"
+    # The Float8 dtypes only exist in recent versions of PyTorch.
+    if dtype == getattr(torch, "float8_e5m2", None):
+        return "f8E5M2"
+    if dtype == getattr(torch, "float8_e4m3fn", None):
+        return "f8E4M3FN"
     if dtype == torch.uint8:
         return "ui8"
     if dtype == torch.int8:
@@ -161,21 +242,77 @@ def _import_fake_tensor_as_mlir_type(
     return ir.Type.parse(f"!torch.vtensor<[{shape}],{dtype}>")
 
 
-def _mlir_types_for_node(node: torch.fx.Node) -> ir.Type:
+class _TypeCache:
+    """Caches the MLIR types and op names used by the importer.
+
+    Most nodes of a graph have the same few types, so each of them is only
+    constructed once per context, and tensor types are constructed natively
+    rather than by printing and parsing them.
+    """
+
+    def __init__(self, context: ir.Context):
+        self._context = context
+        self._tensor_types: Dict[Tuple[Tuple[int, ...], torch.dtype],
+                                 ir.Type] = {}
+        self._element_types: Dict[torch.dtype, ir.Type] = {}
+        self._torch_types: Dict[str, ir.Type] = {}
+        self._registered_operations: Dict[str, bool] = {}
+
+    def fake_tensor_type(self,
+                         fake_tensor: torch._subclasses.FakeTensor) -> ir.Type:
+        shape = tuple(fake_tensor.shape)
+        if not all(isinstance(d, int) for d in shape):
+            return _import_fake_tensor_as_mlir_type(fake_tensor)
+        key = (shape, fake_tensor.dtype)
+        mlir_type = self._tensor_types.get(key)
+        if mlir_type is None:
+            mlir_type = value_tensor_type(
+                self._context, list(shape),
+                self._element_type(fake_tensor.dtype))
+            self._tensor_types[key] = mlir_type
+        return mlir_type
+
+    def torch_type(self, t: torch.Type) -> ir.Type:
+        key = str(t)
+        mlir_type = self._torch_types.get(key)
+        if mlir_type is None:
+            mlir_type = _torch_type_to_mlir_type(t)
+            self._torch_types[key] = mlir_type
+        return mlir_type
+
+    def is_registered_operation(self, name: str) -> bool:
+        registered = self._registered_operations.get(name)
+        if registered is None:
+            registered = self._context.is_registered_operation(name)
+            self._registered_operations[name] = registered
+        return registered
+
+    def _element_type(self, dtype: torch.dtype) -> ir.Type:
+        mlir_type = self._element_types.get(dtype)
+        if mlir_type is None:
+            mlir_type = ir.Type.parse(_convert_dtype_to_mlir_type(dtype),
+                                      self._context)
+            self._element_types[dtype] = mlir_type
+        return mlir_type
+
+
+def _mlir_types_for_node(node: torch.fx.Node,
+                         type_cache: _TypeCache) -> ir.Type:
     if isinstance(node.meta["val"], (tuple, list)):
-        return [_import_fake_tensor_as_mlir_type(v) for v in node.meta["val"]]
-    return [_import_fake_tensor_as_mlir_type(node.meta["val"])]
+        return [type_cache.fake_tensor_type(v) for v in node.meta["val"]]
+    return [type_cache.fake_tensor_type(node.meta["val"])]
 
 
-def _extract_function_type_from_graph(g: torch.fx.Graph) -> ir.FunctionType:
+def _extract_function_type_from_graph(
+        g: torch.fx.Graph, type_cache: _TypeCache) -> ir.FunctionType:
     input_types = []
     for node in g.nodes:
         if node.op == "placeholder":
-            input_types.append(_mlir_types_for_node(node)[0])
+            input_types.append(_mlir_types_for_node(node, type_cache)[0])
         if node.op == "output":
             # TODO(DNS): Test this or add verifier that it can't happen.
             result_types = torch.fx.map_arg(
-                node.args[0], lambda n: _mlir_types_for_node(n)[0])
+                node.args[0], lambda n: _mlir_types_for_node(n, type_cache)[0])
     # Note: We import directly to the backend contract -- multiple results
     # are modeled with func.func native multiple results rather than as a
     # singleton value / tuple.
@@ -220,6 +357,10 @@ DTYPE_TO_INT = {
     15,
 }
 
+if hasattr(torch, "float8_e5m2"):
+    DTYPE_TO_INT[torch.float8_e5m2] = 23
+    DTYPE_TO_INT[torch.float8_e4m3fn] = 24
+
 MEMORY_FORMAT_TO_INT = {
     # https://github.com/pytorch/pytorch/c10/core/MemoryFormat.h#L28
     torch.contiguous_format:
@@ -262,9 +403,14 @@ def _mlir_location_for_node(node: torch.fx.Node) -> ir.Location:
 
 class _FXGraphImporter:
 
-    def __init__(self, g: torch.fx.Graph, func_name: str):
+    def __init__(self, g: torch.fx.Graph, func_name: str,
+                 module: Optional[ir.Module] = None,
+                 type_cache: Optional[_TypeCache] = None):
         self._g = g
         self._func_name = func_name
+        if type_cache is None:
+            type_cache = _TypeCache(ir.Context.current)
+        self._types = type_cache
         # For each node, we track a mapping to MLIR Value's.
         # Technically all Node's have a single output (which can be a tuple of
         # values in case of multiple returns), but we treat them as having
@@ -272,10 +418,12 @@ class _FXGraphImporter:
         # node.meta['val'] is set up, since it contains a list with multiple
         # FakeTensor's in case of a tuple return with multiple elements.
         self._env: Dict[Tuple[torch.fx.Node, int], ir.Value] = {}
-        self._module = ir.Module.create(ir.Location.unknown())
-        self._module.operation.attributes[
-            "torch.debug_module_name"] = ir.StringAttr.get(func_name)
-        function_type = _extract_function_type_from_graph(g)
+        if module is None:
+            module = ir.Module.create(ir.Location.unknown())
+            module.operation.attributes[
+                "torch.debug_module_name"] = ir.StringAttr.get(func_name)
+        self._module = module
+        function_type = _extract_function_type_from_graph(g, self._types)
         func = func_dialect.FuncOp(
             func_name,
             function_type,
@@ -284,6 +432,17 @@ class _FXGraphImporter:
         )
         self._body_block = ir.Block.create_at_start(func.body,
                                                     function_type.inputs)
+        placeholders = [node for node in g.nodes if node.op == "placeholder"]
+        arg_attrs = _sharding_attrs_for_nodes(placeholders)
+        if arg_attrs is not None:
+            func.attributes["arg_attrs"] = arg_attrs
+        outputs = [
+            arg for node in g.nodes if node.op == "output"
+            for arg in node.args[0]
+        ]
+        result_attrs = _sharding_attrs_for_nodes(outputs)
+        if result_attrs is not None:
+            func.attributes["res_attrs"] = result_attrs
 
     def import_graph(self) -> ir.Module:
         with ir.InsertionPoint(self._body_block):
@@ -324,11 +483,11 @@ class _FXGraphImporter:
             mlir_op_name += f".{schema.overload_name}"
 
         # DNS: Unregistered ops
-        assert ir.Context.current.is_registered_operation(
+        assert self._types.is_registered_operation(
             mlir_op_name), f"Unregistered operation: {mlir_op_name}"
 
         # Construct the Operation.
-        result_types = _mlir_types_for_node(node)
+        result_types = _mlir_types_for_node(node, self._types)
         operands = []
         # `schema.arguments` is a bit confusing in this context, since
         # `Argument` is the term that FX uses analogous to mlir "Value". It is
@@ -410,7 +569,7 @@ class _FXGraphImporter:
                 els = [self._env[e, 0] for e in arg]
 
             else:
-                element_type = _torch_type_to_mlir_type(element_type)
+                element_type = self._types.torch_type(element_type)
                 els = [
                     self._import_argument(e, element_type) for e in arg
                 ]
@@ -418,7 +577,7 @@ class _FXGraphImporter:
             # import pydevd_pycharm
             # pydevd_pycharm.settrace('localhost', port=8888, stdoutToServer=True, stderrToServer=True)
             return torch_dialect.PrimListConstructOp(
-                _torch_type_to_mlir_type(expected_type),
+                self._types.torch_type(expected_type),
                 els,
             ).result
         raise Exception(f"Unsupported literal: {arg}")
@@ -440,3 +599,41 @@ def import_fx_graph_as_func(g: torch.fx.Graph, func_name: str) -> ir.Module:
     with ir.Context() as context:
         torch_dialect.register_dialect(context)
         return _FXGraphImporter(g, func_name).import_graph()
+
+
+def import_fx_graphs_as_funcs(graphs: Sequence[Tuple[torch.fx.Graph, str]],
+                              module_name: str,
+                              context: Optional[ir.Context] = None
+                              ) -> ir.Module:
+    """Imports the given FX graphs as the functions of one MLIR module.
+
+    Compiling one module with many functions amortizes the setup of the
+    context and of the pass manager over all of them, and lets the pass
+    manager process the functions in parallel.
+
+    Args:
+        graphs: The FX graphs to import, with the distinct sym_name of the
+            `func.func` to import each of them into.
+        module_name: The debug name of the module.
+        context: The context to create the module in. Defaults to a new
+            context.
+    Returns:
+        A new MLIR module containing the imported functions.
+    """
+    func_names = [func_name for _, func_name in graphs]
+    if len(set(func_names)) != len(func_names):
+        raise Exception(f"Function names must be distinct: {func_names}")
+    for g, _ in graphs:
+        _verify_fx_graph_conforms_to_subset(g)
+    if context is None:
+        context = ir.Context()
+        torch_dialect.register_dialect(context)
+    with context:
+        module = ir.Module.create(ir.Location.unknown())
+        module.operation.attributes[
+            "torch.debug_module_name"] = ir.StringAttr.get(module_name)
+        # The graphs share their types.
+        type_cache = _TypeCache(context)
+        for g, func_name in graphs:
+            _FXGraphImporter(g, func_name, module, type_cache).import_graph()
+        return module
@@ -0,0 +1,131 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+"""A persistent, content-addressed cache of `torch_mlir.compile` results.
+
+Entries are keyed on the Torch dialect module produced by the importer, the
+options that affect the lowering, the requested output type, and the identity
+of the torch-mlir native library doing the lowering. Each entry is the lowered
+module, stored as MLIR bytecode.
+"""
+
+import hashlib
+import os
+import tempfile
+from io import BytesIO
+from typing import Optional, Sequence
+
+from torch_mlir.ir import Module
+from torch_mlir._mlir_libs import _mlir
+
+# Bump this whenever the way entries are keyed or stored changes.
+_CACHE_FORMAT_VERSION = "1"
+
+# The environment variable used to enable the cache when `torch_mlir.compile`
+# is not given an explicit cache directory.
+CACHE_DIR_ENV_VAR = "TORCH_MLIR_COMPILE_CACHE_DIR"
+
+
+def _native_library_identity() -> str:
+    # A different build of torch-mlir can lower the same module differently,
+    # so entries produced by one build must not be reused by another.
+    path = _mlir.__file__
+    stat = os.stat(path)
+    return f"{path}:{stat.st_size}:{stat.st_mtime_ns}"
+
+
+def _hash_parts(parts) -> str:
+    h = hashlib.sha256()
+    for part in parts:
+        if isinstance(part, str):
+            part = part.encode()
+        h.update(len(part).to_bytes(8, "little"))
+        h.update(part)
+    return h.hexdigest()
+
+
+class CompileCache:
+    """A directory of lowered modules, keyed by `CompileCache.get_key`."""
+
+    def __init__(self, directory: str):
+        self.directory = directory
+
+    @staticmethod
+    def from_env_or(directory: Optional[str]) -> Optional["CompileCache"]:
+        """Returns the cache in `directory`, or the one named by
+        `TORCH_MLIR_COMPILE_CACHE_DIR`, or None if neither is set."""
+        directory = directory or os.environ.get(CACHE_DIR_ENV_VAR)
+        if not directory:
+            return None
+        return CompileCache(directory)
+
+    def get_key(self, imported_module, output_type: str,
+                backend_legal_ops: Sequence[str],
+                extra_library_file_name: str) -> str:
+        """Computes the key for lowering `imported_module` (in the Torch
+        dialect, straight out of the importer) to `output_type`."""
+        # The extra library always lives at the same path, so hash what is in
+        # it rather than its name.
+        extra_library = b""
+        if extra_library_file_name:
+            with open(extra_library_file_name, "rb") as f:
+                extra_library = f.read()
+        return _hash_parts([
+            _CACHE_FORMAT_VERSION,
+            _native_library_identity(),
+            output_type,
+            # Sorted, since the order of the legal ops doesn't matter.
+            ",".join(sorted(backend_legal_ops)),
+            extra_library,
+            # Locations end up in the lowered module, so they are part of the
+            # key.
+            imported_module.operation.get_asm(enable_debug_info=True),
+        ])
+
+    def get_pipeline_key(self, module, pipeline: str) -> str:
+        """Computes the key for running the pass pipeline `pipeline` on
+        `module`."""
+        return _hash_parts([
+            _CACHE_FORMAT_VERSION,
+            _native_library_identity(),
+            pipeline,
+            module.operation.get_asm(enable_debug_info=True),
+        ])
+
+    def _path(self, key: str) -> str:
+        return os.path.join(self.directory, key + ".mlirbc")
+
+    def load(self, key: str, context) -> Optional[Module]:
+        """Returns the module stored for `key`, or None on a cache miss."""
+        path = self._path(key)
+        try:
+            with open(path, "rb") as f:
+                data = f.read()
+        except FileNotFoundError:
+            return None
+        try:
+            return Module.parse(data, context=context)
+        except Exception:
+            # A truncated or otherwise unreadable entry is just a miss; it
+            # will be overwritten by the next store.
+            return None
+
+    def store(self, key: str, module):
+        """Stores `module` for `key`.
+
+        The entry is written to a temporary file first and then renamed into
+        place, so that concurrent readers never observe a partial entry.
+        """
+        os.makedirs(self.directory, exist_ok=True)
+        buffer = BytesIO()
+        module.operation.write_bytecode(buffer)
+        fd, temp_path = tempfile.mkstemp(dir=self.directory, suffix=".tmp")
+        try:
+            with os.fdopen(fd, "wb") as f:
+                f.write(buffer.getvalue())
+            os.replace(temp_path, self._path(key))
+        except BaseException:
+            os.remove(temp_path)
+            raise
@@ -7,9 +7,15 @@ from io import StringIO
 import os
 import sys
 import tempfile
+from typing import Optional, Union
 
+from torch_mlir._mlir_libs._torchMlir import (Pipeline,
+                                              add_memory_usage_instrumentation,
+                                              clone_module,
+                                              is_multithreading_enabled,
+                                              set_thread_pool_size)
 from torch_mlir.passmanager import PassManager
-from torch_mlir.ir import StringAttr
+from torch_mlir.ir import DiagnosticSeverity, StringAttr
 
 
 def get_module_name_for_debug_dump(module):
@@ -31,20 +37,116 @@ class TorchMlirCompilerError(Exception):
         return self.value
 
 
+def _print_remark(diagnostic):
+    if diagnostic.severity != DiagnosticSeverity.REMARK:
+        return False
+    print(f"{diagnostic.location}: remark: {diagnostic.message}")
+    return True
+
+
+def set_compiler_threads(context, num_threads: int):
+    """Limits the number of threads that pipelines use in `context`.
+
+    The passes then run on a thread pool of `num_threads` threads that is
+    shared by all the contexts limited to that many threads, rather than on
+    one thread per core for each context. This keeps in-process compilation
+    from competing with the threads of a serving process, for example
+    PyTorch's intra-op threads. A `num_threads` of 0 uses one thread per
+    core.
+    """
+    set_thread_pool_size(context, num_threads)
+
+
+class CompiledPipeline:
+    """A pass pipeline that is parsed once for `context` and then run on any
+    number of modules of that context, such as by a long-running compile
+    server.
+
+    Unlike `PassManager.parse` on each run, the passes are only built, and
+    their pattern sets frozen, on the first run. The pipeline can be run from
+    several threads at once, each run using its own copy of the passes, which
+    requires multithreading to be enabled on `context`.
+
+    Pass it to `run_pipeline_with_repro_report` instead of the pipeline
+    string.
+    """
+
+    def __init__(self, pipeline: str, context):
+        self.pipeline = pipeline
+        self.context = context
+        self._pipeline = Pipeline(context, pipeline)
+
+    def run(self, module):
+        """Runs the pipeline on `module` in place."""
+        if module.context is not self.context:
+            raise ValueError(
+                "The module is not in the context of the pipeline")
+        if not self._pipeline.run(module):
+            raise Exception("Failure while executing pass pipeline")
+
+
 def run_pipeline_with_repro_report(module,
-                                   pipeline: str,
-                                   description: str):
-    """Runs `pipeline` on `module`, with a nice repro report if it fails."""
+                                   pipeline: Union[str, CompiledPipeline],
+                                   description: str,
+                                   print_remarks: bool = False,
+                                   multithreading: Optional[bool] = None,
+                                   report_memory_usage: bool = False):
+    """Runs `pipeline` on `module`, with a nice repro report if it fails.
+
+    If `print_remarks` is true, remarks emitted by the passes in the pipeline
+    are printed to stdout as they are emitted.
+
+    If `report_memory_usage` is true, the resident set size of the process
+    and the attributes added to the IR are printed after each pass, and the
+    passes creating many attributes, such as by folding literals or cloning
+    weights, are flagged. A `CompiledPipeline` is then parsed again into an
+    instrumented pass manager. Disable `multithreading` for the memory usage
+    of each pass to be its own.
+
+    If `multithreading` is given, multithreading is enabled or disabled on the
+    context of `module` for this run only. See `set_compiler_threads` for
+    limiting the number of threads instead.
+
+    `pipeline` is either the textual pipeline, which is parsed on each call,
+    or a `CompiledPipeline`, which is reused.
+    """
+    compiled_pipeline = None
+    if isinstance(pipeline, CompiledPipeline):
+        compiled_pipeline = pipeline
+        pipeline = compiled_pipeline.pipeline
+        # The passes of a compiled pipeline can't be instrumented.
+        if report_memory_usage:
+            compiled_pipeline = None
     module_name = get_module_name_for_debug_dump(module)
+    remark_handler = None
+    if print_remarks or report_memory_usage:
+        remark_handler = module.context.attach_diagnostic_handler(
+            _print_remark)
     try:
         original_stderr = sys.stderr
         sys.stderr = StringIO()
-        asm_for_error_report = module.operation.get_asm(
-            large_elements_limit=10, enable_debug_info=True)
+        # Keep a copy of the module for the repro, which is only printed if the
+        # pipeline fails. Cloning is much cheaper than printing, as the
+        # attributes, such as the weights, are shared with the clone.
+        module_for_error_report = clone_module(module)
         # Lower module in place to make it ready for compiler backends.
         with module.context:
-            pm = PassManager.parse(pipeline)
-            pm.run(module.operation)
+            if compiled_pipeline is not None:
+                run = lambda: compiled_pipeline.run(module)
+            else:
+                pm = PassManager.parse(pipeline)
+                if report_memory_usage:
+                    add_memory_usage_instrumentation(pm)
+                run = lambda: pm.run(module.operation)
+            if multithreading is None:
+                run()
+            else:
+                was_multithreaded = is_multithreading_enabled(module.context)
+                module.context.enable_multithreading(multithreading)
+                try:
+                    run()
+                finally:
+                    module.context.enable_multithreading(was_multithreaded)
     except Exception as e:
         # TODO: More robust.
         # - don't arbitrarily clutter up /tmp. When a test suite has many
@@ -56,7 +158,8 @@ def run_pipeline_with_repro_report(module,
         #   avoid being racy.
         filename = os.path.join(tempfile.gettempdir(), module_name + ".mlir")
         with open(filename, 'w') as f:
-            f.write(asm_for_error_report)
+            module_for_error_report.operation.print(
+                file=f, large_elements_limit=10, enable_debug_info=True)
         debug_options="-mlir-print-ir-after-all -mlir-disable-threading"
         # Put something descriptive here even if description is empty.
         description = description or f"{module_name} compile"
@@ -75,3 +178,5 @@ def run_pipeline_with_repro_report(module,
         raise TorchMlirCompilerError(trimmed_message) from None
     finally:
         sys.stderr = original_stderr
+        if remark_handler is not None:
+            remark_handler.detach()
@@ -13,7 +13,9 @@
 #include <torch/csrc/lazy/backend/backend_data.h>
 #include <torch/csrc/lazy/backend/backend_device.h>
 #include <torch/csrc/lazy/backend/lowering_context.h>
+#include <torch/csrc/lazy/core/metrics.h>
 #include <torch/csrc/lazy/core/shape.h>
+#include <torch/csrc/lazy/core/thread_pool.h>
 
 #include "backend_impl.h"
 #include "ir_builder.h"
@@ -21,10 +23,30 @@
 #include "ops/device_data.h"
 #include "utils/debug.h"
 #include "utils/exception.h"
+#include "utils/sys_utils.h"
 
 namespace torch {
 namespace lazy {
 
+namespace {
+// A buffer of a staging buffer pool, which is returned to the pool when this
+// goes out of scope.
+class StagingBuffer {
+public:
+  StagingBuffer(
+      StagingBufferPool& pool, at::IntArrayRef sizes,
+      at::ScalarType scalar_type)
+      : pool_(pool), tensor_(pool.Acquire(sizes, scalar_type)) {}
+  ~StagingBuffer() { pool_.Release(tensor_); }
+
+  at::Tensor& tensor() { return tensor_; }
+
+private:
+  StagingBufferPool& pool_;
+  at::Tensor tensor_;
+};
+} // namespace
+
 TorchMlirBackendData::TorchMlirBackendData(BackendDevice device, Shape shape)
     : BackendData(device, shape),
       info_(std::make_shared<TorchMlirBackendData::Info>()) {
@@ -59,15 +81,59 @@ void TorchMlirBackendData::Assign(const BackendData& data) {
       torch_mlir_data,
       "Invalid Backend Data Pointer. Expected TorchMlirBackendData.");
 
-  info_ = torch_mlir_data->info_;
+  // If `data` is still pending, this becomes pending on the same value rather
+  // than waiting for it here.
+  std::shared_ptr<BackendData::Info> info;
+  std::shared_future<BackendDataPtr> pending_data;
+  {
+    std::lock_guard<std::mutex> lock(torch_mlir_data->mutex_);
+    info = torch_mlir_data->info_;
+    pending_data = torch_mlir_data->pending_data_;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  info_ = std::move(info);
+  pending_data_ = std::move(pending_data);
 }
 
-bool TorchMlirBackendData::HasValue() const { return bool(info_); }
+bool TorchMlirBackendData::HasValue() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return info_ || pending_data_.valid();
+}
 
 BackendData::Info* TorchMlirBackendData::mlir_info() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_data_.valid()) {
+    // Rethrows any exception raised while computing the value.
+    BackendDataPtr data;
+    {
+      TORCH_LAZY_TIMED("TorchMlirPendingDataWait");
+      data = pending_data_.get();
+    }
+    const auto* torch_mlir_data =
+        dynamic_cast<const TorchMlirBackendData*>(data.get());
+    TORCH_CHECK(
+        torch_mlir_data,
+        "Invalid Backend Data Pointer. Expected TorchMlirBackendData.");
+    // The computed data may itself be pending.
+    torch_mlir_data->mlir_info();
+    std::lock_guard<std::mutex> data_lock(torch_mlir_data->mutex_);
+    info_ = torch_mlir_data->info_;
+    pending_data_ = {};
+  }
   return info_.get();
 }
 
+void TorchMlirBackendData::SetPendingData(
+    std::shared_future<BackendDataPtr> pending_data) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  info_.reset();
+  pending_data_ = std::move(pending_data);
+}
+
+TorchMlirBackendImpl::TorchMlirBackendImpl()
+    : async_execution_enabled_(
+          sys_util::GetEnvBool("TORCH_MLIR_LTC_ASYNC", false)) {}
+
 /**
  * Initialization/Teardown
  * */
@@ -90,7 +156,41 @@ BackendDataPtr TorchMlirBackendImpl::MakeComputationDataFromTensor(
     const at::Tensor& tensor, const Shape& shape,
     const BackendDevice& device) const {
   PRINT_FUNCTION();
-  return std::make_shared<TorchMlirBackendData>(tensor, device, shape);
+  if (!UsesDeviceMemory()) {
+    return std::make_shared<TorchMlirBackendData>(tensor, device, shape);
+  }
+
+  auto info = std::make_shared<TorchMlirBackendData::Info>();
+  info->requires_grad = tensor.requires_grad();
+  {
+    StagingBuffer staged(
+        GetStagingBufferPool(), tensor.sizes(), tensor.scalar_type());
+    staged.tensor().copy_(tensor);
+    info->device_handle = CopyToDevice(staged.tensor(), device);
+  }
+  TORCH_CHECK(info->device_handle, "Failed to copy a tensor to the device");
+  return std::make_shared<TorchMlirBackendData>(device, shape, info);
+}
+
+BackendDataPtr TorchMlirBackendImpl::MakeComputationDataFromTensorAsync(
+    const at::Tensor& tensor, const Shape& shape,
+    const BackendDevice& device) const {
+  PRINT_FUNCTION();
+  if (!UsesDeviceMemory()) {
+    return MakeComputationDataFromTensor(tensor, shape, device);
+  }
+
+  auto promise = std::make_shared<std::promise<BackendDataPtr>>();
+  auto placeholder = std::make_shared<TorchMlirBackendData>(device, shape);
+  placeholder->SetPendingData(promise->get_future().share());
+  ScheduleIoClosure([this, promise, tensor, shape, device]() {
+    try {
+      promise->set_value(MakeComputationDataFromTensor(tensor, shape, device));
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+    }
+  });
+  return placeholder;
 }
 
 BackendDataPtr TorchMlirBackendImpl::MakeComputationDataFromScalar(
@@ -132,7 +232,33 @@ at::Tensor TorchMlirBackendImpl::MakeTensorFromComputationData(
       info,
       "Invalid Backend Data Pointer. Expected TorchMlirBackendData::Info.");
 
-  return info->tensor;
+  if (!info->device_handle) {
+    return info->tensor;
+  }
+  const Shape& shape = torch_mlir_data->shape();
+  StagingBuffer staged(
+      GetStagingBufferPool(), shape.sizes(), shape.scalar_type());
+  CopyFromDevice(*info, staged.tensor());
+  // The staging buffer is reused, so hand out a copy.
+  return staged.tensor().clone();
+}
+
+std::shared_future<at::Tensor>
+TorchMlirBackendImpl::MakeTensorFromComputationDataAsync(
+    const BackendDataPtr data,
+    c10::optional<at::ScalarType> logical_scalar_type) const {
+  PRINT_FUNCTION();
+  auto promise = std::make_shared<std::promise<at::Tensor>>();
+  std::shared_future<at::Tensor> tensor = promise->get_future().share();
+  ScheduleIoClosure([this, promise, data, logical_scalar_type]() {
+    try {
+      promise->set_value(
+          MakeTensorFromComputationData(data, logical_scalar_type));
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+    }
+  });
+  return tensor;
 }
 
 /**
@@ -199,5 +325,89 @@ void TorchMlirBackendImpl::SetDefaultDeviceOrdinal(int64_t ordinal) {
   default_device_ordinal = ordinal;
 }
 
+/**
+ * Device Memory
+ * */
+
+StagingBufferPool& TorchMlirBackendImpl::GetStagingBufferPool() const {
+  static StagingBufferPool* pool = new StagingBufferPool(
+      static_cast<size_t>(
+          sys_util::GetEnv<int>("TORCH_MLIR_LTC_STAGING_POOL_MB", 256))
+      << 20);
+  return *pool;
+}
+
+/**
+ * Asynchronous Execution
+ * */
+
+bool TorchMlirBackendImpl::IsAsyncExecutionEnabled() const {
+  return async_execution_enabled_;
+}
+
+void TorchMlirBackendImpl::SetAsyncExecutionEnabled(bool enabled) {
+  async_execution_enabled_ = enabled;
+}
+
+std::vector<BackendDataPtr> TorchMlirBackendImpl::ScheduleExecution(
+    const TorchMlirComputation& computation, const BackendDevice& device,
+    std::function<std::vector<BackendDataPtr>()> execute) const {
+  PRINT_FUNCTION();
+  // Executions are timed where they run, which is on the thread pool when
+  // they are asynchronous.
+  auto timed_execute = [execute = std::move(execute)]() {
+    TORCH_LAZY_TIMED("TorchMlirExecute");
+    return execute();
+  };
+  if (!async_execution_enabled_) {
+    return timed_execute();
+  }
+
+  // The placeholders need the shape of each result up front.
+  std::vector<Shape> result_shapes;
+  for (const torch::jit::Value* output : computation.graph()->outputs()) {
+    auto tensor_type = output->type()->cast<c10::TensorType>();
+    if (!tensor_type || !tensor_type->scalarType() ||
+        !tensor_type->sizes().concrete_sizes()) {
+      return timed_execute();
+    }
+    result_shapes.emplace_back(
+        *tensor_type->scalarType(), *tensor_type->sizes().concrete_sizes());
+  }
+
+  auto promises = std::make_shared<std::vector<std::promise<BackendDataPtr>>>(
+      result_shapes.size());
+  std::vector<BackendDataPtr> placeholders;
+  for (size_t i = 0; i < result_shapes.size(); ++i) {
+    auto placeholder =
+        std::make_shared<TorchMlirBackendData>(device, result_shapes[i]);
+    placeholder->SetPendingData((*promises)[i].get_future().share());
+    placeholders.push_back(placeholder);
+  }
+
+  // Computations that consume the results of this one wait on the
+  // placeholders when they read their arguments, and the thread pool runs
+  // closures in order, so computations can't wait on later ones.
+  ScheduleIoClosure([promises, execute = std::move(timed_execute)]() {
+    try {
+      std::vector<BackendDataPtr> results = execute();
+      TORCH_CHECK(
+          results.size() == promises->size(), "Expected ", promises->size(),
+          " results, but got ", results.size());
+      for (size_t i = 0; i < results.size(); ++i)
+        (*promises)[i].set_value(results[i]);
+    } catch (...) {
+      for (auto& promise : *promises) {
+        try {
+          promise.set_exception(std::current_exception());
+        } catch (const std::future_error&) {
+          // This promise was already fulfilled.
+        }
+      }
+    }
+  });
+  return placeholders;
+}
+
 } // namespace lazy
 } // namespace torch
@@ -15,7 +15,10 @@
 
 #pragma once
 
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <sstream>
 
 #include <torch/csrc/lazy/backend/backend_data.h>
@@ -23,6 +26,8 @@
 #include <torch/csrc/lazy/backend/backend_interface.h>
 #include <torch/csrc/lazy/core/shape.h>
 
+#include "utils/staging_buffer_pool.h"
+
 namespace torch {
 namespace lazy {
 
@@ -33,6 +38,11 @@ public:
     c10::optional<at::Scalar> scalar;
     bool requires_grad;
     std::string name;
+    // Opaque handle of the value in device memory, for backends that keep
+    // data resident on a device. It is owned by the backend, which sets it in
+    // `CopyToDevice`; `tensor` may then be undefined. Data of the base
+    // backend lives on the host and has no handle.
+    std::shared_ptr<void> device_handle;
 
     Info() {
       static int i = 0;
@@ -43,7 +53,8 @@ public:
     }
     Info(const Info& other)
         : tensor{other.tensor}, scalar{other.scalar},
-          requires_grad{other.requires_grad}, name{other.name} {}
+          requires_grad{other.requires_grad}, name{other.name},
+          device_handle{other.device_handle} {}
     Info(const at::Tensor& tensor)
         : tensor{tensor}, requires_grad{tensor.requires_grad()} {}
     Info(const at::Scalar& scalar) : scalar{scalar}, requires_grad(false) {}
@@ -61,14 +72,25 @@ public:
 
   virtual bool HasValue() const override;
 
+  // Returns the value of this data, first waiting for it if it is still being
+  // computed asynchronously.
   BackendData::Info* mlir_info() const;
 
+  // Turns this data into a placeholder for the value of `pending_data`, which
+  // is being computed asynchronously.
+  void SetPendingData(std::shared_future<BackendDataPtr> pending_data);
+
 protected:
-  std::shared_ptr<BackendData::Info> info_;
+  mutable std::mutex mutex_;
+  mutable std::shared_ptr<BackendData::Info> info_;
+  mutable std::shared_future<BackendDataPtr> pending_data_;
 };
 
+class TorchMlirComputation;
+
 class TORCH_API TorchMlirBackendImpl : public BackendImplInterface {
 public:
+  TorchMlirBackendImpl();
   virtual ~TorchMlirBackendImpl() = default;
 
   /**
@@ -109,6 +131,21 @@ public:
       const BackendDataPtr data,
       c10::optional<at::ScalarType> logical_scalar_type) const override;
 
+  // Like `MakeComputationDataFromTensor`, but copies `tensor` to the device
+  // on the LTC thread pool, returning data that blocks when it is first read
+  // until the copy is done. This lets uploads overlap with tracing and with
+  // the execution of earlier computations. `tensor` must not be modified
+  // until the copy is done.
+  BackendDataPtr MakeComputationDataFromTensorAsync(
+      const at::Tensor& tensor, const Shape& shape,
+      const BackendDevice& device) const;
+
+  // Like `MakeTensorFromComputationData`, but copies `data` back to the host
+  // on the LTC thread pool.
+  std::shared_future<at::Tensor> MakeTensorFromComputationDataAsync(
+      const BackendDataPtr data,
+      c10::optional<at::ScalarType> logical_scalar_type) const;
+
   /**
    * Lowering, Compilation, Execution
    * */
@@ -180,8 +217,58 @@ public:
   //     const ComputationPtr computation
   // ) const = 0;
 
+  /**
+   * Asynchronous Execution
+   * */
+
+  // Whether computations are executed asynchronously. Defaults to the value
+  // of the TORCH_MLIR_LTC_ASYNC environment variable.
+  bool IsAsyncExecutionEnabled() const;
+
+  void SetAsyncExecutionEnabled(bool enabled);
+
 protected:
+  /**
+   * Device Memory
+   * */
+
+  // Whether the backend keeps data in device memory, through `CopyToDevice`
+  // and `CopyFromDevice`. The base backend keeps all data on the host and
+  // passes tensors through as they are.
+  virtual bool UsesDeviceMemory() const { return false; }
+
+  // Copies `staged`, a contiguous host tensor in a (pinned, when possible)
+  // staging buffer, to `device` and returns the handle of the copy. The
+  // buffer is reused once this returns, so the copy must be done reading
+  // from it by then.
+  virtual std::shared_ptr<void> CopyToDevice(
+      const at::Tensor& staged, const BackendDevice& device) const {
+    TORCH_CHECK(false, "The backend doesn't keep data in device memory");
+  }
+
+  // Copies the device value of `info`, which has a `device_handle`, into
+  // `staged`, a contiguous host tensor of the shape of the data.
+  virtual void CopyFromDevice(
+      const TorchMlirBackendData::Info& info, at::Tensor& staged) const {
+    TORCH_CHECK(false, "The backend doesn't keep data in device memory");
+  }
+
+  // The staging buffers of the transfers between the host and the device.
+  // Defaults to caching up to TORCH_MLIR_LTC_STAGING_POOL_MB (256 by default)
+  // megabytes of buffers.
+  StagingBufferPool& GetStagingBufferPool() const;
+
+  // Helper for `ExecuteComputation` implementations. With async execution
+  // enabled, runs `execute` on the LTC thread pool and immediately returns
+  // placeholders for its results, which block when they are first read (e.g.
+  // by `MakeTensorFromComputationData`). Otherwise, or if the shapes of the
+  // results of `computation` aren't all known, runs `execute` right away.
+  std::vector<BackendDataPtr> ScheduleExecution(
+      const TorchMlirComputation& computation, const BackendDevice& device,
+      std::function<std::vector<BackendDataPtr>()> execute) const;
+
   int64_t default_device_ordinal = 0;
+  bool async_execution_enabled_;
 };
 
 } // namespace lazy
@@ -36,6 +36,18 @@ int64_t SizeNode::getStaticValue() const {
 
 std::string SizeNode::ToString() const { return "SizeNode"; }
 
+// Reads the size at runtime, rather than burning `getStaticValue()` into the
+// computation, so that it holds for any size of a dynamic dimension.
+TorchMlirOpVector SizeNode::Lower(
+    TorchMlirFunction function, TorchMlirLoweringContext* loctx) const {
+  std::vector<torch::jit::NamedValue> arguments;
+  arguments.emplace_back(loctx->GetOutputOp(operand(0)));
+  arguments.emplace_back(static_cast<int64_t>(dim_));
+  return LowerTorchMlirBuiltin(
+      function, c10::Symbol::fromQualString("aten::size"),
+      /*result_shapes=*/{}, arguments);
+}
+
 SizeAdd::SizeAdd(Value a, Value b)
     : DimensionNode(OpKind{c10::Symbol::fromQualString("aten::add")}, {a, b}){};
 
@@ -70,5 +82,17 @@ int64_t SizeDiv::getStaticValue() const {
 
 std::string SizeDiv::ToString() const { return "SizeDiv"; }
 
+// `aten::div` of two ints is a float, like `/` in Python, so the quotient of
+// the sizes, which are never negative, is lowered to `aten::floordiv`.
+TorchMlirOpVector SizeDiv::Lower(
+    TorchMlirFunction function, TorchMlirLoweringContext* loctx) const {
+  std::vector<torch::jit::NamedValue> arguments;
+  arguments.emplace_back(loctx->GetOutputOp(operand(0)));
+  arguments.emplace_back(loctx->GetOutputOp(operand(1)));
+  return LowerTorchMlirBuiltin(
+      function, c10::Symbol::fromQualString("aten::floordiv"),
+      /*result_shapes=*/{}, arguments);
+}
+
 } // namespace lazy
 } // namespace torch
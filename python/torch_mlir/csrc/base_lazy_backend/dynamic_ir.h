@@ -71,6 +71,9 @@ public:
   SizeNode(Value input, size_t dim);
   int64_t getStaticValue() const override;
   std::string ToString() const override;
+  TorchMlirOpVector Lower(
+      TorchMlirFunction function,
+      TorchMlirLoweringContext* loctx) const override;
   size_t dim_ = 0;
 };
 
@@ -93,6 +96,9 @@ public:
   SizeDiv(Value a, Value b);
   int64_t getStaticValue() const override;
   std::string ToString() const override;
+  TorchMlirOpVector Lower(
+      TorchMlirFunction function,
+      TorchMlirLoweringContext* loctx) const override;
 };
 
 } // namespace lazy
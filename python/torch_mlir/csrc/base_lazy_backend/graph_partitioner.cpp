@@ -0,0 +1,153 @@
+//===- graph_partitioner.cpp ----------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "graph_partitioner.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace torch {
+namespace lazy {
+
+namespace {
+
+// Returns true if `node` is cheap enough to compute that it is copied into
+// every segment using it, rather than passed between segments.
+bool IsRematerializable(const torch::jit::Node* node) {
+  if (node->kind() == c10::prim::Constant) {
+    return true;
+  }
+  if (node->kind() == c10::prim::ListConstruct) {
+    return std::all_of(
+        node->inputs().begin(), node->inputs().end(),
+        [](const torch::jit::Value* input) {
+          return IsRematerializable(input->node());
+        });
+  }
+  return false;
+}
+
+} // namespace
+
+std::shared_ptr<torch::jit::Graph> ExtractSubgraph(
+    const std::vector<torch::jit::Node*>& nodes,
+    const std::vector<torch::jit::Value*>& outputs,
+    std::vector<torch::jit::Value*>* inputs) {
+  auto subgraph = std::make_shared<torch::jit::Graph>();
+  std::unordered_map<torch::jit::Value*, torch::jit::Value*> env;
+  auto map_outputs = [&](torch::jit::Node* node, torch::jit::Node* clone) {
+    for (size_t i = 0; i < node->outputs().size(); ++i) {
+      env[node->output(i)] = clone->output(i);
+    }
+  };
+  std::function<torch::jit::Value*(torch::jit::Value*)> map_value =
+      [&](torch::jit::Value* value) -> torch::jit::Value* {
+    auto it = env.find(value);
+    if (it != env.end()) {
+      return it->second;
+    }
+    torch::jit::Node* producer = value->node();
+    if (IsRematerializable(producer)) {
+      torch::jit::Node* clone = subgraph->createClone(producer, map_value);
+      subgraph->insertNode(clone);
+      map_outputs(producer, clone);
+      return env.at(value);
+    }
+    torch::jit::Value* input = subgraph->addInput()->copyMetadata(value);
+    inputs->push_back(value);
+    env[value] = input;
+    return input;
+  };
+
+  for (torch::jit::Node* node : nodes) {
+    torch::jit::Node* clone = subgraph->createClone(node, map_value);
+    subgraph->insertNode(clone);
+    map_outputs(node, clone);
+  }
+  for (torch::jit::Value* output : outputs) {
+    subgraph->registerOutput(env.at(output));
+  }
+  return subgraph;
+}
+
+GraphPartition PartitionGraph(
+    const std::shared_ptr<torch::jit::Graph>& graph,
+    const std::function<bool(torch::jit::Node*)>& is_supported) {
+  std::unordered_set<const torch::jit::Value*> graph_outputs(
+      graph->outputs().begin(), graph->outputs().end());
+
+  // Group the nodes into runs that all are, or all aren't, supported.
+  std::vector<std::pair<bool, std::vector<torch::jit::Node*>>> runs;
+  for (torch::jit::Node* node : graph->nodes()) {
+    bool is_output = std::any_of(
+        node->outputs().begin(), node->outputs().end(),
+        [&](const torch::jit::Value* output) {
+          return graph_outputs.count(output);
+        });
+    // Rematerializable nodes are copied into the segments that use them, but
+    // still need a segment to be returned from.
+    if (IsRematerializable(node) && !is_output) {
+      continue;
+    }
+    bool supported = is_supported(node);
+    if (runs.empty() || runs.back().first != supported) {
+      runs.emplace_back(supported, std::vector<torch::jit::Node*>());
+    }
+    runs.back().second.push_back(node);
+  }
+
+  GraphPartition partition;
+  std::unordered_map<torch::jit::Value*, size_t> value_ids;
+  for (torch::jit::Value* input : graph->inputs()) {
+    value_ids.emplace(input, value_ids.size());
+  }
+  for (const auto& run : runs) {
+    const std::vector<torch::jit::Node*>& nodes = run.second;
+    std::unordered_set<const torch::jit::Node*> node_set(
+        nodes.begin(), nodes.end());
+    // The values used outside of the segment, including by the return of
+    // the graph.
+    std::vector<torch::jit::Value*> outputs;
+    for (torch::jit::Node* node : nodes) {
+      for (torch::jit::Value* output : node->outputs()) {
+        if (std::any_of(
+                output->uses().begin(), output->uses().end(),
+                [&](const torch::jit::Use& use) {
+                  return !node_set.count(use.user);
+                })) {
+          outputs.push_back(output);
+        }
+      }
+    }
+
+    GraphSegment segment;
+    segment.supported = run.first;
+    std::vector<torch::jit::Value*> inputs;
+    segment.graph = ExtractSubgraph(nodes, outputs, &inputs);
+    for (torch::jit::Value* input : inputs) {
+      segment.inputs.push_back(value_ids.at(input));
+    }
+    for (torch::jit::Value* output : outputs) {
+      size_t id = value_ids.size();
+      value_ids.emplace(output, id);
+      segment.outputs.push_back(id);
+    }
+    partition.segments.push_back(std::move(segment));
+  }
+
+  for (torch::jit::Value* output : graph->outputs()) {
+    partition.results.push_back(value_ids.at(output));
+  }
+  partition.num_values = value_ids.size();
+  return partition;
+}
+
+} // namespace lazy
+} // namespace torch
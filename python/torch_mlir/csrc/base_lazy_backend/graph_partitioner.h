@@ -0,0 +1,66 @@
+//===- graph_partitioner.h ------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+//
+// Splits the graph of a lazy computation into parts that the backend supports
+// and parts that fall back to eager execution, so that a few unsupported ops
+// don't keep the rest of the graph from being compiled.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace lazy {
+
+// A part of a partitioned graph.
+struct GraphSegment {
+  // The nodes of the part, whose inputs and outputs are values of the
+  // partitioned graph numbered as described in `GraphPartition`.
+  std::shared_ptr<torch::jit::Graph> graph;
+  std::vector<size_t> inputs;
+  std::vector<size_t> outputs;
+  // Whether all the nodes of the segment are supported.
+  bool supported;
+};
+
+struct GraphPartition {
+  // In the order in which they must run.
+  std::vector<GraphSegment> segments;
+  // The values flowing between segments are numbered from 0, starting with
+  // the inputs of the graph, followed by the outputs of each segment in
+  // order. These are the values returned by the graph.
+  std::vector<size_t> results;
+  size_t num_values = 0;
+};
+
+// Splits `graph` into runs of consecutive nodes that all are, or all aren't,
+// supported according to `is_supported`. Constants, and lists of constants,
+// are copied into each segment that uses them instead of being passed
+// between segments.
+TORCH_API GraphPartition PartitionGraph(
+    const std::shared_ptr<torch::jit::Graph>& graph,
+    const std::function<bool(torch::jit::Node*)>& is_supported);
+
+// Copies `nodes`, which must be in topological order, into a new graph
+// returning `outputs`. The values that `nodes` use from other nodes become the
+// inputs of the new graph, and are appended to `inputs`, except for constants
+// and lists of constants, which are copied too.
+TORCH_API std::shared_ptr<torch::jit::Graph> ExtractSubgraph(
+    const std::vector<torch::jit::Node*>& nodes,
+    const std::vector<torch::jit::Value*>& outputs,
+    std::vector<torch::jit::Value*>* inputs);
+
+} // namespace lazy
+} // namespace torch
@@ -10,11 +10,18 @@
 // https://github.com/pytorch/pytorch/blob/master/torch/csrc/lazy/ts_backend/ts_lowering_context.cpp
 //===----------------------------------------------------------------------===//
 
+#include <cstdlib>
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <unordered_set>
 
 #include <torch/csrc/jit/api/compilation_unit.h>
+#include <torch/csrc/jit/ir/constants.h>
 #include <torch/csrc/jit/passes/refine_tuple_types.h>
+#include <torch/csrc/lazy/core/cache.h>
 #include <torch/csrc/lazy/core/lazy_graph_executor.h>
+#include <torch/csrc/lazy/core/metrics.h>
 #include "torch-mlir-c/Registration.h"
 #include "torch-mlir-c/Transforms.h"
 #include "mlir-c/IR.h"
@@ -22,6 +29,7 @@
 
 #include "../../dialects/torch/importer/jit_ir/csrc/function_importer.h"
 #include "backend_impl.h"
+#include "graph_partitioner.h"
 #include "mlir_lowering_context.h"
 #include "mlir_node.h"
 #include "utils/debug.h"
@@ -37,14 +45,190 @@ namespace lazy {
 // TorchMlir Lowering Context
 ///////////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+using ComputationCache = Cache<hash_t, Computation, HashReducer>;
+
+// Returns the process-wide cache of built computations, or nullptr if it is
+// disabled by setting TORCH_MLIR_LTC_COMPUTATION_CACHE_SIZE to 0.
+ComputationCache* GetComputationCache() {
+  static const size_t cache_size =
+      sys_util::GetEnv<size_t>("TORCH_MLIR_LTC_COMPUTATION_CACHE_SIZE", 1024);
+  static ComputationCache* cache =
+      cache_size > 0 ? new ComputationCache(cache_size) : nullptr;
+  return cache;
+}
+
+// Returns the context that all computations are built in. Creating a context
+// and loading all the dialects into it takes longer than importing most
+// traces, so it is only done once per process. A context only grows by the
+// types and attributes uniqued in it, so sharing it doesn't keep the IR of
+// computations alive. Multithreading stays enabled, since that is what makes
+// uniquing in it safe when computations are built on several threads.
+MlirContext GetSharedMlirContext() {
+  static MlirContext context = []() {
+    MlirContext context = mlirContextCreate();
+    // https://reviews.llvm.org/D88162
+    torchMlirRegisterAllDialects(context);
+    return context;
+  }();
+  return context;
+}
+
+std::unique_ptr<torch::jit::Function>
+CreateJitFunction(const std::shared_ptr<torch::jit::Graph>& graph);
+
+// Imports `graph` as the only function of a new module.
+MlirModule ImportGraph(
+    MlirContext context, const std::shared_ptr<torch::jit::Graph>& graph) {
+  TORCH_LAZY_TIMED("TorchMlirImport");
+  MlirOperation func_op = torch_mlir::importJitFunctionAsFuncOp(
+      /*context=*/context,
+      /*function=*/CreateJitFunction(graph).get(),
+      /*getArgAttribute=*/[](int) -> MlirAttribute { return {nullptr}; },
+      /*importOptions=*/{/*assumeTensorsHaveValueSemantics=*/true});
+
+  // Convert MlirOperation to MlirModule.
+  MlirLocation loc = mlirLocationUnknownGet(context);
+  MlirModule module_op = mlirModuleCreateEmpty(loc);
+  MlirBlock block = mlirModuleGetBody(module_op);
+  mlirBlockAppendOwnedOperation(block, func_op);
+  return module_op;
+}
+
+// The pass manager that verifies the backend contract on the current thread.
+// A pass manager can't run on several threads at once, so there is one per
+// thread, which is reused by all the computations built on that thread.
+class VerificationPassManager {
+public:
+  explicit VerificationPassManager(MlirContext context)
+      : pass_manager_(mlirPassManagerCreate(context)) {
+    mlirPassManagerAddOwnedPass(
+        pass_manager_, mlirCreateVerifyBackendContractNoDecompositions());
+  }
+  ~VerificationPassManager() { mlirPassManagerDestroy(pass_manager_); }
+
+  MlirLogicalResult Run(MlirModule module_op) {
+    return mlirPassManagerRunOnOp(
+        pass_manager_, mlirModuleGetOperation(module_op));
+  }
+
+private:
+  MlirPassManager pass_manager_;
+};
+
+// Returns true if `module_op` satisfies the backend contract without any
+// further decomposition.
+bool VerifyBackendContract(MlirContext context, MlirModule module_op) {
+  // All computations are built in the shared context.
+  TORCH_CHECK(
+      mlirContextEqual(context, GetSharedMlirContext()),
+      "Expected a module of the shared MLIR context");
+  TORCH_LAZY_TIMED("TorchMlirVerify");
+  thread_local VerificationPassManager pass_manager(context);
+  return mlirLogicalResultIsSuccess(pass_manager.Run(module_op));
+}
+
+// Returns the kinds of nodes, such as "aten::tanh", listed in the
+// comma-separated TORCH_MLIR_LTC_EAGER_OPS, which are executed eagerly even if
+// they can be lowered. This helps debug and test the partitioning of graphs.
+const std::unordered_set<std::string>& GetEagerNodeKinds() {
+  static const std::unordered_set<std::string> kinds = []() {
+    std::unordered_set<std::string> kinds;
+    const char* env = std::getenv("TORCH_MLIR_LTC_EAGER_OPS");
+    std::stringstream list(env ? env : "");
+    std::string kind;
+    while (std::getline(list, kind, ',')) {
+      if (!kind.empty())
+        kinds.insert(kind);
+    }
+    return kinds;
+  }();
+  return kinds;
+}
+
+// Returns true if `graph` has nodes of the kinds in GetEagerNodeKinds().
+bool HasEagerNodes(const std::shared_ptr<torch::jit::Graph>& graph) {
+  const std::unordered_set<std::string>& kinds = GetEagerNodeKinds();
+  if (kinds.empty())
+    return false;
+  for (torch::jit::Node* node : graph->nodes()) {
+    if (kinds.count(node->kind().toQualString()))
+      return true;
+  }
+  return false;
+}
+
+// Returns true if `node` on its own lowers to MLIR that satisfies the backend
+// contract. The result is cached by the kind of the node, the types of its
+// inputs and outputs, and the values of its constant inputs, which the
+// lowering can depend on (e.g. the dims of a reduction). Tensor constants are
+// only keyed by their type.
+bool IsNodeSupported(MlirContext context, torch::jit::Node* node) {
+  if (GetEagerNodeKinds().count(node->kind().toQualString()))
+    return false;
+  std::stringstream key;
+  key << node->kind().toQualString();
+  for (torch::jit::Value* input : node->inputs()) {
+    key << " " << *input->type();
+    c10::optional<c10::IValue> constant = torch::jit::toIValue(input);
+    if (constant && !constant->isTensor())
+      key << "=" << *constant;
+  }
+  key << " ->";
+  for (const torch::jit::Value* output : node->outputs()) {
+    key << " " << *output->type();
+  }
+
+  static std::mutex mutex;
+  static std::unordered_map<std::string, bool> supported_nodes;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = supported_nodes.find(key.str());
+    if (it != supported_nodes.end()) {
+      return it->second;
+    }
+  }
+
+  bool supported = false;
+  try {
+    std::vector<torch::jit::Value*> inputs;
+    auto graph =
+        ExtractSubgraph({node}, node->outputs().vec(), &inputs);
+    MlirModule module_op = ImportGraph(context, graph);
+    supported = VerifyBackendContract(context, module_op);
+    mlirModuleDestroy(module_op);
+  } catch (const std::exception& e) {
+    TRACE_LTC(
+        kTraceComputations,
+        "Failed to import " << key.str() << ": " << e.what());
+  }
+  TRACE_LTC(
+      kTraceComputations,
+      (supported ? "Supported node: " : "Unsupported node: ") << key.str());
+  std::lock_guard<std::mutex> lock(mutex);
+  supported_nodes.emplace(key.str(), supported);
+  return supported;
+}
+
+// Whether graphs that don't satisfy the backend contract are split into the
+// parts that do and parts executed eagerly, rather than failing to build.
+// Can be disabled by setting TORCH_MLIR_LTC_PARTITION_GRAPHS to 0.
+bool IsGraphPartitioningEnabled() {
+  static const bool enabled =
+      sys_util::GetEnvBool("TORCH_MLIR_LTC_PARTITION_GRAPHS", true);
+  return enabled;
+}
+
+} // namespace
+
 TorchMlirLoweringContext::TorchMlirLoweringContext(
     const std::string& name, BackendDevice device)
     : LoweringContext(name, std::forward<BackendDevice>(device)),
       graph_(std::make_shared<torch::jit::Graph>()),
       function_(
           std::make_shared<torch::jit::GraphFunction>(name, graph_, nullptr)),
-      mlir_context_(mlirContextCreate()) {
-  RegisterMlirDialects();
+      mlir_context_(GetSharedMlirContext()) {
 }
 
 TorchMlirLoweringContext::TorchMlirLoweringContext(
@@ -57,8 +241,7 @@ TorchMlirLoweringContext::TorchMlirLoweringContext(
       graph_(std::make_shared<torch::jit::Graph>()),
       function_(
           std::make_shared<torch::jit::GraphFunction>(name, graph_, nullptr)),
-      mlir_context_(mlirContextCreate()) {
-  RegisterMlirDialects();
+      mlir_context_(GetSharedMlirContext()) {
 
   for (auto node : post_order) {
     Lower(node);
@@ -113,6 +296,7 @@ bool TorchMlirLoweringContext::CheckResultShape(
 size_t TorchMlirLoweringContext::AddResult(const Output& output) {
   PRINT_FUNCTION();
 
+  result_hashes_.push_back(output.hash());
   return AddResult(GetOutputOp(output));
 }
 
@@ -129,6 +313,21 @@ void TorchMlirLoweringContext::AddParameter(
 // embedded builder (returned by the builder() API).
 ComputationPtr TorchMlirLoweringContext::Build() {
   PRINT_FUNCTION();
+  // Cache hits are timed too, since hashing the computation isn't free.
+  TORCH_LAZY_TIMED("TorchMlirBuild");
+
+  // Skip importing and verifying the graph, and whatever later lowering the
+  // backend caches per computation, if an identical one was built before.
+  ComputationCache* cache = GetComputationCache();
+  hash_t computation_hash;
+  if (cache) {
+    computation_hash = ComputationHash();
+    if (ComputationPtr computation = cache->Get(computation_hash)) {
+      TORCH_LAZY_COUNTER("TorchMlirComputationCacheHit", 1);
+      return computation;
+    }
+    TORCH_LAZY_COUNTER("TorchMlirComputationCacheMiss", 1);
+  }
 
   // Since we mutated the types of some nodes to insert shape information, we
   // must perform this pass to ensure tuples have up to date output types.
@@ -145,36 +344,87 @@ ComputationPtr TorchMlirLoweringContext::Build() {
   torch::jit::ConvertScalarImplicit(graph_);
 
   // Generate MLIR.
-  MlirOperation func_op = torch_mlir::importJitFunctionAsFuncOp(
-      /*context=*/mlir_context_,
-      /*function=*/generate_jit_fn().get(),
-      /*getArgAttribute=*/[](int) -> MlirAttribute { return {nullptr}; },
-      /*importOptions=*/{/*assumeTensorsHaveValueSemantics=*/true});
-
-
-  // Convert MlirOperation to MlirModule.
-  MlirLocation loc = mlirLocationUnknownGet(mlir_context_);
-  MlirModule module_op = mlirModuleCreateEmpty(loc);
-  MlirBlock block = mlirModuleGetBody(module_op);
-  mlirBlockAppendOwnedOperation(block, func_op);
+  MlirModule module_op = ImportGraph(mlir_context_, graph_);
 
   // Apply passes to verify generated MLIR.
-  auto pass_manager = mlirPassManagerCreate(mlir_context_);
-  mlirPassManagerAddOwnedPass(
-    pass_manager,
-    mlirCreateVerifyBackendContractNoDecompositions()
-  );
-
-  MlirLogicalResult result = mlirPassManagerRunOnOp(
-    pass_manager,
-    mlirModuleGetOperation(module_op)
-  );
-
-  if (mlirLogicalResultIsFailure(result)) {
+  ComputationPtr computation;
+  if (!HasEagerNodes(graph_) &&
+      VerifyBackendContract(mlir_context_, module_op)) {
+    computation = CreateComputation(module_op);
+  } else if (IsGraphPartitioningEnabled()) {
+    computation = BuildPartitioned(module_op);
+  } else {
     throw std::runtime_error("MLIR verification has failed.");
   }
+  if (cache) {
+    cache->Add(computation_hash, computation);
+  }
+  return computation;
+}
 
-  return CreateComputation(module_op);
+ComputationPtr
+TorchMlirLoweringContext::BuildPartitioned(MlirModule module_op) {
+  PRINT_FUNCTION();
+  TORCH_LAZY_COUNTER("TorchMlirPartitionedComputations", 1);
+  GraphPartition partition =
+      PartitionGraph(graph_, [this](torch::jit::Node* node) {
+        return IsNodeSupported(mlir_context_, node);
+      });
+
+  std::vector<TorchMlirComputation::Segment> segments;
+  for (GraphSegment& graph_segment : partition.segments) {
+    TorchMlirComputation::Segment segment;
+    segment.graph = graph_segment.graph;
+    segment.inputs = std::move(graph_segment.inputs);
+    segment.outputs = std::move(graph_segment.outputs);
+    // Ops that are supported on their own may still not be together.
+    if (graph_segment.supported) {
+      MlirModule segment_module = ImportGraph(mlir_context_, segment.graph);
+      if (VerifyBackendContract(mlir_context_, segment_module)) {
+        segment.computation = std::make_shared<TorchMlirComputation>(
+            segment_module, mlir_context_, segment.graph,
+            std::unordered_map<int, std::string>(), InputOutputAliases());
+      } else {
+        mlirModuleDestroy(segment_module);
+      }
+    }
+    if (!segment.computation) {
+      TORCH_LAZY_COUNTER("TorchMlirEagerSegments", 1);
+    }
+    segments.push_back(std::move(segment));
+  }
+
+  // The computation keeps the MLIR of the whole graph for debugging.
+  auto computation =
+      std::dynamic_pointer_cast<TorchMlirComputation>(CreateComputation(module_op));
+  TORCH_CHECK(computation, "Expected a TorchMlirComputation");
+  computation->SetSegments(
+      std::move(segments), std::move(partition.results), partition.num_values);
+  return computation;
+}
+
+hash_t TorchMlirLoweringContext::ComputationHash() const {
+  hash_t hash = Hash(std::string("TorchMlirComputation"));
+  for (const hash_t& result_hash : result_hashes_) {
+    hash = HashCombine(hash, result_hash);
+  }
+  // The type of each parameter gives its dtype and sizes, or whether it is a
+  // scalar.
+  const auto& inputs = graph_->inputs();
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    hash = HashCombine(hash, Hash(inputs[i]->type()->str()));
+    auto name = parameter_names_.find(static_cast<int>(i));
+    if (name != parameter_names_.end()) {
+      hash = HashCombine(hash, Hash(name->second));
+    }
+  }
+  for (const auto& alias : input_output_aliases_) {
+    hash = HashCombine(hash, Hash(alias.output_index));
+    hash = HashCombine(hash, Hash(alias.param_number));
+    hash = HashCombine(hash, Hash(alias.param_index));
+    hash = HashCombine(hash, Hash(alias.must_alias));
+  }
+  return hash;
 }
 
 ComputationPtr TorchMlirLoweringContext::CreateComputation(MlirModule module_op) {
@@ -245,13 +495,9 @@ torch::jit::Value* TorchMlirLoweringContext::GetParameter(BackendDataPtr data) {
             false, "Unhandled scalar type: ", c10::toString(scalar.type()));
       }
     } else {
-      // Save parameter shape information.
-      param->setType(torch::jit::TensorType::create(
-          /*scalar_type=*/data->shape().scalar_type(),
-          /*device=*/c10::nullopt,
-          /*sizes=*/c10::VaryingShape<int64_t>(data->shape().sizes()),
-          /*strides=*/c10::VaryingShape<int64_t>(),
-          /*requires_grad=*/c10::nullopt));
+      // Save parameter shape information. With dynamic shapes, this leaves
+      // the sizes out of `ComputationHash` too.
+      param->setType(GetTensorTypeForShape(data->shape()));
 
       if (info->name != "" && !startswith(info->name, "input")) {
         parameter_names_[parameters_.size()] = info->name;
@@ -295,12 +541,14 @@ std::vector<c10::Argument> sync_argument_types(
   return updated_args;
 }
 
+namespace {
+
 std::unique_ptr<torch::jit::Function>
-TorchMlirLoweringContext::generate_jit_fn() const {
+CreateJitFunction(const std::shared_ptr<torch::jit::Graph>& graph) {
   // IMPORTANT: We pass in a COPY of the graph into create_function, since it
   //            may get mutated in the process.
   auto fn = std::make_unique<torch::jit::GraphFunction>(
-      c10::QualifiedName("graph"), graph_->copy(), nullptr);
+      c10::QualifiedName("graph"), graph->copy(), nullptr);
 
   c10::FunctionSchema schema = fn->getSchema();
 
@@ -308,18 +556,20 @@ TorchMlirLoweringContext::generate_jit_fn() const {
   // output shapes are stripped (via call to unshapedType(...)); however,
   // since we want to have shape information in our MLIR, we'll add it back.
   std::vector<c10::Argument> arguments =
-      sync_argument_types(schema.arguments(), graph_->inputs());
+      sync_argument_types(schema.arguments(), graph->inputs());
   std::vector<c10::Argument> returns =
-      sync_argument_types(schema.returns(), graph_->outputs());
+      sync_argument_types(schema.returns(), graph->outputs());
 
   fn->setSchema(schema.cloneWithArguments(arguments).cloneWithReturns(returns));
 
   return fn;
 }
 
-void TorchMlirLoweringContext::RegisterMlirDialects() {
-  // https://reviews.llvm.org/D88162
-  torchMlirRegisterAllDialects(mlir_context_);
+} // namespace
+
+std::unique_ptr<torch::jit::Function>
+TorchMlirLoweringContext::generate_jit_fn() const {
+  return CreateJitFunction(graph_);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -372,6 +622,11 @@ std::shared_ptr<torch::jit::Graph> TorchMlirComputation::graph() const {
   return graph_;
 }
 
+const TorchMlirComputation::InputOutputAliases&
+TorchMlirComputation::input_output_aliases() const {
+  return input_output_aliases_;
+}
+
 MlirOperation TorchMlirComputation::func_op() const {
   MlirBlock block = mlirModuleGetBody(module_op_);
   return mlirBlockGetFirstOperation(block);
@@ -385,6 +640,27 @@ MlirContext TorchMlirComputation::mlir_context() const {
   return mlir_context_;
 }
 
+const std::vector<TorchMlirComputation::Segment>&
+TorchMlirComputation::segments() const {
+  return segments_;
+}
+
+const std::vector<size_t>& TorchMlirComputation::segment_results() const {
+  return segment_results_;
+}
+
+size_t TorchMlirComputation::num_segment_values() const {
+  return num_segment_values_;
+}
+
+void TorchMlirComputation::SetSegments(
+    std::vector<Segment> segments, std::vector<size_t> results,
+    size_t num_values) {
+  segments_ = std::move(segments);
+  segment_results_ = std::move(results);
+  num_segment_values_ = num_values;
+}
+
 const std::string TorchMlirComputation::debug_string() const {
   std::stringstream ss;
 
@@ -409,6 +685,17 @@ const std::string TorchMlirComputation::debug_string() const {
   }
   ss << "\n";
 
+  // Segments
+  if (!segments_.empty()) {
+    ss << "Segments:\n";
+    for (const Segment& segment : segments_) {
+      ss << (segment.computation ? "MLIR" : "Eager") << " segment: "
+         << segment.inputs << " -> " << segment.outputs << "\n"
+         << segment.graph->toString();
+    }
+    ss << "\n";
+  }
+
   // Mark Step
   ss << "In Mark Step: " << (in_mark_step ? "true" : "false") << "\n";
 
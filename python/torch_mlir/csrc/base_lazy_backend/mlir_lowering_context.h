@@ -70,7 +70,10 @@ public:
       const torch::lazy::Shape& shape, const std::string& name) override;
 
   // Build the computation capturing all the operations created with the
-  // embedded builder (returned by the builder() API).
+  // embedded builder (returned by the builder() API). Identical graphs (see
+  // `ComputationHash`) share the computation built for the first of them.
+  // Graphs that don't satisfy the backend contract are partitioned (see
+  // `BuildPartitioned`).
   torch::lazy::ComputationPtr Build() override;
 
   virtual torch::lazy::ComputationPtr CreateComputation(MlirModule module_op);
@@ -100,20 +103,31 @@ protected:
 
   size_t AddResult(torch::jit::Value* op);
 
+  // Builds the computation of a graph that doesn't satisfy the backend
+  // contract as a whole, and whose MLIR is `module_op`, by splitting the graph
+  // into runs of consecutive nodes that do, which are lowered to MLIR on
+  // their own, and the runs in between, which are executed eagerly.
+  torch::lazy::ComputationPtr BuildPartitioned(MlirModule module_op);
+
+  // Returns the key under which the computation built by this context is
+  // cached: the hash of the lazy graph behind each result, together with the
+  // type and name of each parameter and the input/output aliases.
+  hash_t ComputationHash() const;
+
   // Creates a jit::Function from the current jit::Graph. Input and output
   // type information is patched to include shape.
   std::unique_ptr<torch::jit::Function> generate_jit_fn() const;
 
-  void RegisterMlirDialects();
-
   // Holds the input/output alias information populated by the SetUpAlias() API.
   InputOutputAliases input_output_aliases_;
   std::shared_ptr<torch::jit::Graph> graph_;
   std::shared_ptr<torch::jit::GraphFunction> function_;
+  // Shared by all the lowering contexts, and never destroyed.
   MlirContext mlir_context_;
   std::unordered_map<BackendData::Handle, Parameter> parameters_map_;
   std::unordered_map<int, std::string> parameter_names_;
   std::vector<torch::jit::Value*> root_tuple_;
+  std::vector<hash_t> result_hashes_;
   OutputMap<torch::jit::Value*> emitted_outputs_;
 };
 
@@ -122,6 +136,19 @@ public:
   using InputOutputAliases = TorchMlirLoweringContext::InputOutputAliases;
   using InputOutputAlias = TorchMlirLoweringContext::InputOutputAlias;
 
+  // A part of the graph of a partitioned computation.
+  struct Segment {
+    // Takes and returns the values with the given indices. See
+    // `segment_results`.
+    std::shared_ptr<torch::jit::Graph> graph;
+    std::vector<size_t> inputs;
+    std::vector<size_t> outputs;
+    // The computation of the segment if it is lowered to MLIR, or nullptr if
+    // it falls back to eager execution (by the TorchScript interpreter, on
+    // the eager fallback device).
+    std::shared_ptr<TorchMlirComputation> computation;
+  };
+
   TorchMlirComputation(
       MlirModule module_op, MlirContext mlir_context,
       const std::shared_ptr<torch::jit::Graph>& graph,
@@ -140,12 +167,34 @@ public:
 
   std::shared_ptr<torch::jit::Graph> graph() const;
 
+  // The outputs that update a parameter in place, as set up by the lazy
+  // graph executor at a step barrier. The storage of those parameters is no
+  // longer needed after the computation, so backends may reuse it for the
+  // outputs.
+  const InputOutputAliases& input_output_aliases() const;
+
   MlirOperation func_op() const;
 
   MlirModule module_op() const;
 
   MlirContext mlir_context() const;
 
+  // The parts of the graph to run in order, for computations whose graph
+  // doesn't satisfy the backend contract as a whole, in which case the MLIR
+  // of the computation can't be lowered further. Empty otherwise.
+  const std::vector<Segment>& segments() const;
+
+  // The values passed between segments are numbered from 0, starting with the
+  // parameters of the computation, followed by the outputs of each segment in
+  // order. These are the values of the results of the computation.
+  const std::vector<size_t>& segment_results() const;
+
+  size_t num_segment_values() const;
+
+  void SetSegments(
+      std::vector<Segment> segments, std::vector<size_t> results,
+      size_t num_values);
+
   virtual const std::string debug_string() const;
 
   virtual const std::string to_string() const override;
@@ -161,6 +210,9 @@ protected:
   MlirContext mlir_context_;
   std::shared_ptr<torch::jit::Graph> graph_;
   InputOutputAliases input_output_aliases_;
+  std::vector<Segment> segments_;
+  std::vector<size_t> segment_results_;
+  size_t num_segment_values_ = 0;
 };
 
 } // namespace lazy
@@ -21,6 +21,7 @@
 #include <torch/csrc/jit/frontend/sugared_value.h>
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/lazy/backend/backend_interface.h>
+#include <torch/csrc/lazy/core/config.h>
 #include <torch/csrc/lazy/core/helpers.h>
 #include <torch/csrc/lazy/core/internal_ops/ltc_ops.h>
 #include <torch/csrc/lazy/core/ir_builder.h>
@@ -31,6 +32,19 @@
 namespace torch {
 namespace lazy {
 
+c10::TypePtr GetTensorTypeForShape(const Shape& shape) {
+  c10::VaryingShape<int64_t> sizes =
+      FLAGS_ltc_enable_dynamic_shapes
+          ? c10::VaryingShape<int64_t>(shape.dim())
+          : c10::VaryingShape<int64_t>(shape.sizes());
+  return torch::jit::TensorType::create(
+      /*scalar_type=*/shape.scalar_type(),
+      /*device=*/c10::nullopt,
+      /*sizes=*/sizes,
+      /*strides=*/c10::VaryingShape<int64_t>(),
+      /*requires_grad=*/c10::nullopt);
+}
+
 TorchMlirOpVector LowerTorchMlirBuiltin(
     TorchMlirFunction function, c10::Symbol sym,
     const std::vector<c10::TypePtr> tensor_types,
@@ -98,14 +112,9 @@ TorchMlirOpVector LowerTorchMlirBuiltin(
     const std::vector<torch::jit::NamedValue>& kwarguments) {
   std::vector<c10::TypePtr> tensor_types;
 
-  // Generate types with fixed tensor shape information.
+  // Generate types with the tensor shape information.
   for (const Shape& shape : result_shapes) {
-    tensor_types.push_back(torch::jit::TensorType::create(
-        /*scalar_type=*/shape.scalar_type(),
-        /*device=*/c10::nullopt,
-        /*sizes=*/c10::VaryingShape<int64_t>(shape.sizes()),
-        /*strides=*/c10::VaryingShape<int64_t>(),
-        /*requires_grad=*/c10::nullopt));
+    tensor_types.push_back(GetTensorTypeForShape(shape));
   }
 
   return LowerTorchMlirBuiltin(
@@ -21,6 +21,12 @@ namespace lazy {
 typedef std::vector<torch::jit::Value*> TorchMlirOpVector;
 typedef std::shared_ptr<torch::jit::GraphFunction> TorchMlirFunction;
 
+// Returns the JIT type of a tensor of `shape`. With dynamic shapes enabled
+// (`--ltc_enable_dynamic_shapes`), only the dtype and rank are kept, so that
+// the computation built for a trace also serves the traces that only differ
+// from it in their sizes. The backend then infers the sizes it can.
+TORCH_API c10::TypePtr GetTensorTypeForShape(const Shape& shape);
+
 TORCH_API TorchMlirOpVector LowerTorchMlirBuiltin(
     TorchMlirFunction function, c10::Symbol sym,
     const c10::ArrayRef<Shape> result_shapes,
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <ATen/ATen.h>
+#include <ATen/ExpandUtils.h>
 #include <c10/util/Optional.h>
 #include <cmath>
 
@@ -19,6 +20,85 @@ namespace lazy {
 
 // TODO(henrytu): Upstream these shape inference functions to PyTorch in the future.
 
+// The shapes of the structured ops listed under `native_shape_inference` in
+// `autogen_ltc_backend.yaml`, which would otherwise be computed by running
+// their meta kernel for every traced call.
+
+namespace {
+
+// Returns the shape of a binary elementwise op, where `self` and `other` are
+// broadcast together and promoted to a common dtype. Wrapped numbers (Python
+// scalars) take part in the promotion as scalars, as in eager mode.
+Shape BroadcastShape(
+    const at::Tensor& self, const at::Tensor& other, bool integer_to_float) {
+  at::ScalarType dtype = at::result_type(self, other);
+  if (integer_to_float && at::isIntegralType(dtype, /*includeBool=*/true)) {
+    dtype = at::get_default_dtype_as_scalartype();
+  }
+  return Shape(dtype, at::infer_size(self.sizes(), other.sizes()));
+}
+
+// Returns the shape of a unary floating-point op, which computes integer
+// inputs in the default dtype.
+Shape FloatingUnaryShape(const at::Tensor& self) {
+  at::ScalarType dtype = self.scalar_type();
+  if (at::isIntegralType(dtype, /*includeBool=*/true)) {
+    dtype = at::get_default_dtype_as_scalartype();
+  }
+  return Shape(dtype, self.sizes().vec());
+}
+
+} // namespace
+
+std::vector<torch::lazy::Shape> compute_shape_add(
+    const at::Tensor& self, const at::Tensor& other, const at::Scalar& alpha) {
+  return {BroadcastShape(self, other, /*integer_to_float=*/false)};
+}
+
+std::vector<torch::lazy::Shape> compute_shape_sub(
+    const at::Tensor& self, const at::Tensor& other, const at::Scalar& alpha) {
+  return {BroadcastShape(self, other, /*integer_to_float=*/false)};
+}
+
+std::vector<torch::lazy::Shape>
+compute_shape_mul(const at::Tensor& self, const at::Tensor& other) {
+  return {BroadcastShape(self, other, /*integer_to_float=*/false)};
+}
+
+// True division, which is computed in floating point.
+std::vector<torch::lazy::Shape>
+compute_shape_div(const at::Tensor& self, const at::Tensor& other) {
+  return {BroadcastShape(self, other, /*integer_to_float=*/true)};
+}
+
+std::vector<torch::lazy::Shape> compute_shape_neg(const at::Tensor& self) {
+  return {Shape(self.scalar_type(), self.sizes().vec())};
+}
+
+std::vector<torch::lazy::Shape> compute_shape_exp(const at::Tensor& self) {
+  return {FloatingUnaryShape(self)};
+}
+
+std::vector<torch::lazy::Shape> compute_shape_log(const at::Tensor& self) {
+  return {FloatingUnaryShape(self)};
+}
+
+std::vector<torch::lazy::Shape> compute_shape_rsqrt(const at::Tensor& self) {
+  return {FloatingUnaryShape(self)};
+}
+
+std::vector<torch::lazy::Shape> compute_shape_sigmoid(const at::Tensor& self) {
+  return {FloatingUnaryShape(self)};
+}
+
+std::vector<torch::lazy::Shape> compute_shape_sqrt(const at::Tensor& self) {
+  return {FloatingUnaryShape(self)};
+}
+
+std::vector<torch::lazy::Shape> compute_shape_tanh(const at::Tensor& self) {
+  return {FloatingUnaryShape(self)};
+}
+
 std::vector<torch::lazy::Shape>
 compute_shape_div(const at::Tensor& self, const at::Scalar& other) {
   return {Shape(self.scalar_type(), self.sizes().vec())};
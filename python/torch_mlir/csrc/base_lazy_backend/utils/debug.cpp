@@ -0,0 +1,27 @@
+//===- debug.cpp ----------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "debug.h"
+
+namespace debug_util {
+
+static int GetInitialTraceLevel() {
+  if (sys_util::GetEnvBool("VERBOSE_PRINT_FUNCTION", false)) {
+    return kTraceFunctions;
+  }
+  return sys_util::GetEnv("TORCH_MLIR_LTC_TRACE_LEVEL", 0);
+}
+
+std::atomic<int> trace_level(GetInitialTraceLevel());
+
+void SetTraceLevel(int level) {
+  trace_level.store(level, std::memory_order_relaxed);
+}
+
+} // namespace debug_util
@@ -6,22 +6,71 @@
 // Also available under a BSD-style license. See LICENSE.
 //
 //===----------------------------------------------------------------------===//
+//
+// Tracing for the lazy backends.
+//
+// Traces are printed to stdout when the trace level, which is initialized from
+// the TORCH_MLIR_LTC_TRACE_LEVEL environment variable (or to
+// `kTraceFunctions` if VERBOSE_PRINT_FUNCTION is set), is at least the level
+// of the trace. When tracing is off, a trace only costs a load and a branch;
+// building with TORCH_MLIR_LTC_ENABLE_TRACING=0 removes traces entirely.
+//
+//===----------------------------------------------------------------------===//
 
 #pragma once
 
+#include <atomic>
 #include <iostream>
 
+#include <c10/macros/Macros.h>
+
 #include "sys_utils.h"
 
+#ifndef TORCH_MLIR_LTC_ENABLE_TRACING
+#define TORCH_MLIR_LTC_ENABLE_TRACING 1
+#endif
+
+namespace debug_util {
+
+enum TraceLevel : int {
+  kTraceOff = 0,
+  // What each computation that is compiled and executed looks like.
+  kTraceComputations = 1,
+  // Additionally, every call into the backend.
+  kTraceFunctions = 2,
+};
+
+// Shared by all the lazy backend libraries, so that setting it from one of
+// them affects all of them.
+TORCH_API extern std::atomic<int> trace_level;
+
+inline bool IsTraceEnabled(TraceLevel level) {
+  return C10_UNLIKELY(trace_level.load(std::memory_order_relaxed) >= level);
+}
+
+TORCH_API void SetTraceLevel(int level);
+
+} // namespace debug_util
+
+#if TORCH_MLIR_LTC_ENABLE_TRACING
+#define TRACE_LTC(level, msg)                                                  \
+  do {                                                                         \
+    if (debug_util::IsTraceEnabled(debug_util::level)) {                       \
+      std::cout << msg << std::endl;                                           \
+    }                                                                          \
+  } while (0)
+#else
+#define TRACE_LTC(level, msg)                                                  \
+  do {                                                                         \
+  } while (0)
+#endif
+
 #define PRINT_DEBUG(msg)                                                       \
-  std::cout << msg << "    (" << __FILE__ << ":" << __LINE__ << ")"            \
-            << std::endl;
+  TRACE_LTC(                                                                   \
+      kTraceComputations,                                                      \
+      msg << "    (" << __FILE__ << ":" << __LINE__ << ")")
 
 #define PRINT_FUNCTION()                                                       \
-  if (verbose_print_function) {                                                \
-    std::cout << __PRETTY_FUNCTION__ << "    (" << __FILE__ << ":" << __LINE__ \
-              << ")" << std::endl;                                             \
-  }
-
-static const bool verbose_print_function =
-    sys_util::GetEnvBool("VERBOSE_PRINT_FUNCTION", false);
+  TRACE_LTC(                                                                   \
+      kTraceFunctions, __PRETTY_FUNCTION__ << "    (" << __FILE__ << ":"       \
+                                           << __LINE__ << ")")
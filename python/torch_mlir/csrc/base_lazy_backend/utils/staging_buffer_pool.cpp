@@ -0,0 +1,70 @@
+//===- staging_buffer_pool.cpp --------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "staging_buffer_pool.h"
+
+#include <ATen/Context.h>
+#include <ATen/Functions.h>
+#include <c10/util/Exception.h>
+
+namespace torch {
+namespace lazy {
+
+StagingBufferPool::StagingBufferPool(size_t max_cached_bytes)
+    : max_cached_bytes_(max_cached_bytes) {}
+
+at::Tensor StagingBufferPool::Acquire(
+    at::IntArrayRef sizes, at::ScalarType scalar_type) {
+  int64_t numel = c10::multiply_integers(sizes);
+  size_t nbytes = numel * c10::elementSize(scalar_type);
+  at::Tensor bytes;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = free_buffers_.find(nbytes);
+    if (it != free_buffers_.end()) {
+      bytes = std::move(it->second);
+      free_buffers_.erase(it);
+      cached_bytes_ -= nbytes;
+    }
+  }
+  if (!bytes.defined()) {
+    bytes = at::empty(
+        {static_cast<int64_t>(nbytes)},
+        at::TensorOptions(at::kByte).pinned_memory(at::hasCUDA()));
+  }
+  if (numel == 0) {
+    return at::empty(sizes, bytes.options().dtype(scalar_type));
+  }
+  return bytes.view(scalar_type).view(sizes);
+}
+
+void StagingBufferPool::Release(const at::Tensor& buffer) {
+  TORCH_CHECK(
+      buffer.is_contiguous() && buffer.device().is_cpu(),
+      "Expected a staging buffer acquired from this pool");
+  size_t nbytes = buffer.nbytes();
+  if (nbytes == 0) {
+    return;
+  }
+  at::Tensor bytes = buffer.view({-1}).view(at::kByte);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (cached_bytes_ + nbytes > max_cached_bytes_) {
+    return;
+  }
+  free_buffers_.emplace(nbytes, std::move(bytes));
+  cached_bytes_ += nbytes;
+}
+
+size_t StagingBufferPool::CachedBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cached_bytes_;
+}
+
+} // namespace lazy
+} // namespace torch
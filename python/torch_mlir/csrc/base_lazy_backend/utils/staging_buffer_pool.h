@@ -0,0 +1,51 @@
+//===- staging_buffer_pool.h ----------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+//
+// A pool of host buffers through which tensors are copied to and from device
+// memory. The buffers are pinned when a CUDA runtime is available, so that
+// backends can DMA from them, and are reused across transfers of the same
+// size rather than being allocated (and pinned) for every transfer.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+
+#include <ATen/Tensor.h>
+
+namespace torch {
+namespace lazy {
+
+class TORCH_API StagingBufferPool {
+public:
+  // Keeps at most `max_cached_bytes` of released buffers for reuse.
+  explicit StagingBufferPool(size_t max_cached_bytes);
+
+  // Returns a contiguous host tensor of the given sizes and type, reusing a
+  // released buffer of the same size if there is one.
+  at::Tensor Acquire(at::IntArrayRef sizes, at::ScalarType scalar_type);
+
+  // Returns a buffer from `Acquire` to the pool. The caller must be done
+  // with it, including any asynchronous copy reading from or writing to it.
+  void Release(const at::Tensor& buffer);
+
+  size_t CachedBytes() const;
+
+private:
+  mutable std::mutex mutex_;
+  // Byte tensors, by size.
+  std::unordered_multimap<size_t, at::Tensor> free_buffers_;
+  size_t cached_bytes_ = 0;
+  size_t max_cached_bytes_;
+};
+
+} // namespace lazy
+} // namespace torch
@@ -12,7 +12,9 @@
 #include <torch/csrc/lazy/backend/backend_device.h>
 #include <torch/csrc/lazy/backend/lowering_context.h>
 #include <torch/csrc/lazy/core/lazy_graph_executor.h>
+#include <torch/csrc/lazy/core/metrics.h>
 #include <torch/csrc/lazy/core/shape.h>
+#include <torch/csrc/lazy/core/thread_pool.h>
 
 #include <torch_mlir/csrc/base_lazy_backend/backend_impl.h>
 #include <torch_mlir/csrc/base_lazy_backend/generated/LazyNativeFunctions.h>
@@ -20,8 +22,14 @@
 #include <torch_mlir/csrc/base_lazy_backend/utils/debug.h>
 #include <torch_mlir/csrc/base_lazy_backend/utils/exception.h>
 #include <torch_mlir/csrc/base_lazy_backend/utils/string_utils.h>
+#include <torch_mlir/csrc/base_lazy_backend/utils/sys_utils.h>
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
 
 #include "backend_impl.h"
+#include "refbackend_executable.h"
 
 using namespace torch::lazy;
 
@@ -49,7 +57,7 @@ public:
    * Configuration
    * */
   void SetRngSeed(size_t seed) const override {
-    std::cout << "RNG Seed Set to: " << seed << std::endl;
+    TRACE_LTC(kTraceComputations, "RNG Seed Set to: " << seed);
   }
 
   /**
@@ -74,10 +82,25 @@ public:
       );
       // Store computation instance for external access after compilation.
       GetLatestComputation() = instance;
+      // Compile in the background, so that only executing the computation
+      // has to wait for it. Only the segments of partitioned computations
+      // are compiled.
+      if (IsAsyncExecutionEnabled()) {
+        auto mlir_computation =
+            static_cast<TorchMlirComputation*>(instance.get());
+        if (mlir_computation->segments().empty()) {
+          GetRefBackendExecutableFuture(instance, /*async=*/true);
+        }
+        for (const auto& segment : mlir_computation->segments()) {
+          if (segment.computation)
+            GetRefBackendExecutableFuture(segment.computation, /*async=*/true);
+        }
+      }
     }
 
-    std::cout << "Received " << instances.size()
-              << " computation instances at Compile!" << std::endl;
+    TRACE_LTC(
+        kTraceComputations, "Received " << instances.size()
+                                        << " computation instances at Compile!");
 
     return instances;
   }
@@ -88,6 +111,23 @@ public:
       const BackendDevice& device) const override {
     PRINT_FUNCTION();
 
+    auto mlir_computation =
+        static_cast<TorchMlirComputation*>(computation.get());
+    std::vector<BackendDataPtr> argument_vector(
+        arguments.begin(), arguments.end());
+    return ScheduleExecution(
+        *mlir_computation, device,
+        [this, computation, argument_vector, device]() {
+          return ExecuteComputationNow(computation, argument_vector, device);
+        });
+  }
+
+  std::vector<BackendDataPtr> ExecuteComputationNow(
+      torch::lazy::ComputationPtr computation,
+      c10::ArrayRef<BackendDataPtr> arguments,
+      const BackendDevice& device) const {
+    PRINT_FUNCTION();
+
     // `arguments` maps 1:1 with the parameters in the generated MLIR. In this
     // function, we will generate a list of BackendData that corresponds to the
     // return values in the MLIR.
@@ -95,16 +135,10 @@ public:
     auto mlir_computation =
         static_cast<TorchMlirComputation*>(computation.get());
 
+    const bool trace =
+        debug_util::IsTraceEnabled(debug_util::kTraceComputations);
     int num_inputs = 0;
 
-    // Vendor backend specific execution can be inserted here.
-    //
-    // We don't have a way to execute a computation based on the generated MLIR,
-    // so we'll fallback to the implementation used by the TS LTC backend.
-    //
-    // JIT Execution adopted from:
-    // https://github.com/pytorch/pytorch/blob/master/torch/csrc/lazy/ts_backend/ts_backend_impl.cpp
-    torch::jit::GraphExecutor graph_executor(mlir_computation->graph(), "");
     std::vector<torch::jit::IValue> stack;
     for (const auto& argument : arguments) {
       const auto mlir_data =
@@ -118,20 +152,40 @@ public:
         stack.emplace_back(tensor);
       }
 
-      // count number of inputs
-      auto name = info->name;
-      if (startswith(name, "input_")) {
-        // Printing tensor name for testing purposes
-        std::cout << "Input tensor: " << name << std::endl;
+      // Count the named inputs, for testing purposes.
+      if (trace && startswith(info->name, "input_")) {
+        TRACE_LTC(kTraceComputations, "Input tensor: " << info->name);
         ++num_inputs;
       }
     }
-    // Printing number of input tensors for testing purposes
-    std::cout << num_inputs << " input tensors found" << std::endl;
-    graph_executor.run(stack);
+    TRACE_LTC(kTraceComputations, num_inputs << " input tensors found");
+
+    std::vector<at::Tensor> outputs;
+    if (!mlir_computation->segments().empty()) {
+      outputs = ExecuteSegments(*mlir_computation, std::move(stack));
+    } else if (auto executable = GetRefBackendExecutable(computation)) {
+      std::vector<at::Tensor> inputs;
+      for (const auto& value : stack) {
+        TORCH_CHECK(value.isTensor(), "Expected only tensor arguments");
+        inputs.push_back(value.toTensor());
+      }
+      outputs = executable->Run(
+          inputs,
+          GetDonatedInputs(*mlir_computation, executable->NumResults()));
+    } else {
+      // The computation can't be run natively, so fall back to the
+      // implementation used by the TS LTC backend.
+      //
+      // JIT Execution adopted from:
+      // https://github.com/pytorch/pytorch/blob/master/torch/csrc/lazy/ts_backend/ts_backend_impl.cpp
+      torch::jit::GraphExecutor graph_executor(mlir_computation->graph(), "");
+      graph_executor.run(stack);
+      for (torch::jit::IValue component : stack)
+        outputs.push_back(component.toTensor());
+    }
+
     std::vector<torch::lazy::BackendDataPtr> results;
-    for (torch::jit::IValue component : stack) {
-      at::Tensor result = component.toTensor();
+    for (const at::Tensor& result : outputs) {
       at::IntArrayRef result_sizes = result.sizes();
       torch::lazy::Shape shape(
           result.scalar_type(),
@@ -140,9 +194,11 @@ public:
           std::make_shared<TorchMlirBackendData>(result, device, shape));
     }
 
-    std::cout << "Received " << arguments.size() << " arguments, and returned "
-              << results.size() << " results during ExecuteCompile!"
-              << std::endl;
+    TRACE_LTC(
+        kTraceComputations, "Received " << arguments.size()
+                                        << " arguments, and returned "
+                                        << results.size()
+                                        << " results during ExecuteCompile!");
 
     return results;
   }
@@ -174,7 +230,143 @@ public:
   }
 
 private:
+  // Runs the segments of a partitioned computation on `arguments`. The
+  // segments lowered to MLIR run natively when they can, and the others with
+  // the TorchScript interpreter, on the same CPU tensors, which are passed
+  // from one segment to the next without copies.
+  std::vector<at::Tensor> ExecuteSegments(
+      const TorchMlirComputation& computation,
+      std::vector<torch::jit::IValue> arguments) const {
+    std::vector<torch::jit::IValue> values = std::move(arguments);
+    values.resize(computation.num_segment_values());
+    for (const auto& segment : computation.segments()) {
+      std::vector<torch::jit::IValue> stack;
+      for (size_t input : segment.inputs)
+        stack.push_back(values[input]);
+
+      std::shared_ptr<RefBackendExecutable> executable;
+      if (segment.computation &&
+          std::all_of(stack.begin(), stack.end(), [](const auto& value) {
+            return value.isTensor();
+          }))
+        executable = GetRefBackendExecutable(segment.computation);
+      if (executable) {
+        std::vector<at::Tensor> inputs;
+        for (const auto& value : stack)
+          inputs.push_back(value.toTensor());
+        std::vector<at::Tensor> results = executable->Run(inputs);
+        stack.assign(results.begin(), results.end());
+      } else {
+        torch::jit::GraphExecutor graph_executor(segment.graph, "");
+        graph_executor.run(stack);
+      }
+
+      TORCH_CHECK(
+          stack.size() == segment.outputs.size(), "Expected ",
+          segment.outputs.size(), " segment outputs, but got ", stack.size());
+      for (size_t i = 0; i < stack.size(); ++i)
+        values[segment.outputs[i]] = std::move(stack[i]);
+    }
+
+    std::vector<at::Tensor> outputs;
+    for (size_t result : computation.segment_results())
+      outputs.push_back(values[result].toTensor());
+    return outputs;
+  }
+
+  // Maps each output of `computation` to the parameter it was aliased with by
+  // the lazy graph executor, or -1. The aliased parameters belong to tensors
+  // that are overwritten by those outputs, so their storage can be donated.
+  static std::vector<int64_t> GetDonatedInputs(
+      const TorchMlirComputation& computation, size_t num_outputs) {
+    std::vector<int64_t> donated_inputs(num_outputs, -1);
+    for (const auto& alias : computation.input_output_aliases()) {
+      if (alias.output_index.size() != 1 || !alias.param_index.empty())
+        continue;
+      int64_t output = alias.output_index.front();
+      if (output >= 0 && output < static_cast<int64_t>(num_outputs))
+        donated_inputs[output] = alias.param_number;
+    }
+    return donated_inputs;
+  }
+
+  // Returns the RefBackend executable for `computation`, compiling it on first
+  // use, or nullptr if it can't be executed that way. The lazy graph executor
+  // already reuses computations for identical graphs, so caching executables
+  // per computation amounts to caching them per graph hash.
+  std::shared_ptr<RefBackendExecutable>
+  GetRefBackendExecutable(const ComputationPtr& computation) const {
+    static bool use_jit = sys_util::GetEnvBool(
+        "TORCH_MLIR_REFERENCE_LAZY_BACKEND_USE_JIT", false);
+    if (use_jit)
+      return nullptr;
+    auto executable =
+        GetRefBackendExecutableFuture(computation, /*async=*/false);
+    // Only an asynchronous compile that is still running is waited on here.
+    TORCH_LAZY_TIMED("TorchMlirCompileWait");
+    return executable.get();
+  }
+
+  // Returns the cached executable for `computation`, first starting to compile
+  // it if there isn't one yet. With `async`, the compilation runs on the LTC
+  // thread pool instead of the calling thread.
+  std::shared_future<std::shared_ptr<RefBackendExecutable>>
+  GetRefBackendExecutableFuture(
+      const ComputationPtr& computation, bool async) const {
+    std::unique_lock<std::mutex> lock(executables_mutex_);
+    auto it = executables_.find(computation.get());
+    if (it == executables_.end() || it->second.computation.expired()) {
+      // Drop the executables of computations that no longer exist. One of
+      // them may be at the same address as `computation`.
+      for (auto entry = executables_.begin(); entry != executables_.end();) {
+        if (entry->second.computation.expired())
+          entry = executables_.erase(entry);
+        else
+          ++entry;
+      }
+      auto promise =
+          std::make_shared<std::promise<std::shared_ptr<RefBackendExecutable>>>();
+      CachedExecutable entry{computation, promise->get_future().share()};
+      it = executables_.emplace(computation.get(), std::move(entry)).first;
+      auto compile = [computation, promise]() {
+        try {
+          auto mlir_computation =
+              static_cast<TorchMlirComputation*>(computation.get());
+          auto executable = RefBackendExecutable::Compile(*mlir_computation);
+          if (!executable) {
+            TORCH_LAZY_COUNTER("TorchMlirJitFallbacks", 1);
+            TRACE_LTC(
+                kTraceComputations,
+                "Falling back to the TorchScript executor for this "
+                "computation");
+          }
+          promise->set_value(std::move(executable));
+        } catch (...) {
+          promise->set_exception(std::current_exception());
+        }
+      };
+      auto executable = it->second.executable;
+      // Other computations can be looked up while this one compiles.
+      lock.unlock();
+      if (async)
+        ScheduleClosure(std::move(compile));
+      else
+        compile();
+      return executable;
+    }
+    return it->second.executable;
+  }
+
+  struct CachedExecutable {
+    std::weak_ptr<Computation> computation;
+    // Holds null if the computation can't be executed with the RefBackend.
+    std::shared_future<std::shared_ptr<RefBackendExecutable>> executable;
+  };
+
   ReferenceLazyBackendDeviceType default_device_type_;
+  mutable std::mutex executables_mutex_;
+  mutable std::unordered_map<const Computation*, CachedExecutable>
+      executables_;
 };
 
 BackendImplInterface* GetReferenceLazyBackendImpl() {
@@ -0,0 +1,303 @@
+//===- refbackend_executable.cpp ------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include <ATen/ATen.h>
+#include <c10/util/Optional.h>
+#include <torch/csrc/lazy/core/metrics.h>
+#include <mlir-c/BuiltinAttributes.h>
+#include <mlir-c/BuiltinTypes.h>
+#include <mlir-c/IR.h>
+#include <mlir-c/Pass.h>
+#include <mlir-c/RegisterEverything.h>
+
+#include <torch_mlir/csrc/base_lazy_backend/utils/debug.h>
+
+#include "torch-mlir-c/Pipeline.h"
+#include "torch-mlir-c/Registration.h"
+
+#include "refbackend_executable.h"
+
+namespace torch {
+namespace lazy {
+
+namespace {
+
+// The name of the function generated by `TorchMlirLoweringContext`.
+constexpr const char* kFunctionName = "graph";
+
+// The pipeline set by `SetLoweringPipeline`.
+std::string& GetLoweringPipelineText() {
+  static std::string pipeline;
+  return pipeline;
+}
+
+void appendToString(MlirStringRef str, void* userData) {
+  static_cast<std::string*>(userData)->append(str.data, str.length);
+}
+
+// Returns the lowering pipeline for `context`, which all computations are
+// built in. The dialects and LLVM translations the lowering needs are
+// registered in the context the first time, along with the passes, and the
+// pipeline is parsed once, so its passes are reused by all the compiles.
+TorchMlirPipeline GetLoweringPipeline(MlirContext context) {
+  static TorchMlirPipeline pipeline = [](MlirContext context) {
+    const std::string& text = GetLoweringPipelineText();
+    if (text.empty())
+      return TorchMlirPipeline{nullptr};
+    mlirRegisterAllPasses();
+    torchMlirRegisterAllPasses();
+    MlirDialectRegistry registry = mlirDialectRegistryCreate();
+    mlirRegisterAllDialects(registry);
+    mlirContextAppendDialectRegistry(context, registry);
+    mlirDialectRegistryDestroy(registry);
+    mlirRegisterAllLLVMTranslations(context);
+    std::string error;
+    TorchMlirPipeline pipeline = torchMlirPipelineCreate(
+        context, mlirStringRefCreate(text.data(), text.size()),
+        appendToString, &error);
+    if (torchMlirPipelineIsNull(pipeline))
+      TORCH_WARN("Failed to parse the RefBackend lowering pipeline: ", error);
+    return pipeline;
+  }(context);
+  return pipeline;
+}
+
+c10::optional<c10::ScalarType> getScalarType(MlirType type) {
+  if (mlirTypeIsAF16(type))
+    return c10::ScalarType::Half;
+  if (mlirTypeIsABF16(type))
+    return c10::ScalarType::BFloat16;
+  if (mlirTypeIsAF32(type))
+    return c10::ScalarType::Float;
+  if (mlirTypeIsAF64(type))
+    return c10::ScalarType::Double;
+  if (mlirTypeIsAInteger(type) && !mlirIntegerTypeIsUnsigned(type)) {
+    switch (mlirIntegerTypeGetWidth(type)) {
+    case 1:
+      return c10::ScalarType::Bool;
+    case 8:
+      return c10::ScalarType::Char;
+    case 32:
+      return c10::ScalarType::Int;
+    case 64:
+      return c10::ScalarType::Long;
+    }
+  }
+  if (mlirTypeIsAComplex(type)) {
+    MlirType elementType = mlirComplexTypeGetElementType(type);
+    if (mlirTypeIsAF32(elementType))
+      return c10::ScalarType::ComplexFloat;
+    if (mlirTypeIsAF64(elementType))
+      return c10::ScalarType::ComplexDouble;
+  }
+  return c10::nullopt;
+}
+
+// Builds a ranked memref descriptor (allocated pointer, aligned pointer,
+// offset, sizes, strides) pointing at the storage of `tensor`.
+std::vector<int64_t> getMemRefDescriptor(const at::Tensor& tensor) {
+  std::vector<int64_t> descriptor;
+  auto data = reinterpret_cast<intptr_t>(tensor.data_ptr());
+  descriptor.push_back(data);
+  descriptor.push_back(data);
+  descriptor.push_back(0);
+  for (int64_t size : tensor.sizes())
+    descriptor.push_back(size);
+  for (int64_t stride : tensor.strides())
+    descriptor.push_back(stride);
+  return descriptor;
+}
+
+} // namespace
+
+void RefBackendExecutable::SetLoweringPipeline(std::string pipeline) {
+  GetLoweringPipelineText() = std::move(pipeline);
+}
+
+std::shared_ptr<RefBackendExecutable>
+RefBackendExecutable::Compile(const TorchMlirComputation& computation) {
+  TORCH_LAZY_TIMED("TorchMlirCompile");
+  TorchMlirPipeline pipeline = GetLoweringPipeline(computation.mlir_context());
+  if (torchMlirPipelineIsNull(pipeline)) {
+    TRACE_LTC(
+        kTraceComputations, "The RefBackend lowering pipeline is unavailable");
+    return nullptr;
+  }
+
+  // Lower a copy, so that the computation is still printed in the Torch
+  // dialect by `to_string`.
+  MlirModule module = mlirModuleFromOperation(
+      mlirOperationClone(mlirModuleGetOperation(computation.module_op())));
+  MlirOperation moduleOp = mlirModuleGetOperation(module);
+
+  if (mlirLogicalResultIsFailure(torchMlirPipelineRunOnOp(pipeline, moduleOp))) {
+    TRACE_LTC(
+        kTraceComputations,
+        "Failed to lower the computation with the RefBackend");
+    mlirModuleDestroy(module);
+    return nullptr;
+  }
+
+  // The result types of the function are only recorded there if it was given
+  // the ranked, destination-passing calling convention, which is the only one
+  // supported here.
+  MlirAttribute destinationPassingResults = mlirOperationGetAttributeByName(
+      moduleOp,
+      mlirStringRefCreateFromCString("refback.destination_passing_results"));
+  MlirAttribute resultTypesAttr = {nullptr};
+  if (!mlirAttributeIsNull(destinationPassingResults)) {
+    resultTypesAttr = mlirDictionaryAttrGetElementByName(
+        destinationPassingResults,
+        mlirStringRefCreateFromCString(kFunctionName));
+  }
+  if (mlirAttributeIsNull(resultTypesAttr)) {
+    TRACE_LTC(
+        kTraceComputations,
+        "The computation doesn't have a statically shaped, tensor-only "
+        "signature");
+    mlirModuleDestroy(module);
+    return nullptr;
+  }
+  // Not all results have donatable inputs, but all of them are listed.
+  MlirAttribute donatableInputsAttr = mlirOperationGetAttributeByName(
+      moduleOp, mlirStringRefCreateFromCString("refback.donatable_inputs"));
+  if (!mlirAttributeIsNull(donatableInputsAttr)) {
+    donatableInputsAttr = mlirDictionaryAttrGetElementByName(
+        donatableInputsAttr, mlirStringRefCreateFromCString(kFunctionName));
+  }
+  std::vector<ResultType> resultTypes;
+  const auto& graphOutputs = computation.graph()->outputs();
+  for (intptr_t i = 0, e = mlirArrayAttrGetNumElements(resultTypesAttr); i < e;
+       ++i) {
+    MlirType type =
+        mlirTypeAttrGetValue(mlirArrayAttrGetElement(resultTypesAttr, i));
+    // Signedness is lost in the lowering (e.g. both int8 and uint8 become
+    // i8), so prefer the dtype recorded in the JIT graph.
+    c10::optional<c10::ScalarType> dtype;
+    if (i < static_cast<intptr_t>(graphOutputs.size())) {
+      if (auto tensorType =
+              graphOutputs[i]->type()->cast<c10::TensorType>())
+        dtype = tensorType->scalarType();
+    }
+    if (!dtype)
+      dtype = getScalarType(mlirShapedTypeGetElementType(type));
+    if (!dtype) {
+      TRACE_LTC(kTraceComputations, "Unsupported result element type");
+      mlirModuleDestroy(module);
+      return nullptr;
+    }
+    std::vector<int64_t> sizes;
+    for (intptr_t dim = 0, rank = mlirShapedTypeGetRank(type); dim < rank;
+         ++dim)
+      sizes.push_back(mlirShapedTypeGetDimSize(type, dim));
+    std::vector<int64_t> donatableInputs;
+    if (!mlirAttributeIsNull(donatableInputsAttr)) {
+      MlirAttribute inputs = mlirArrayAttrGetElement(donatableInputsAttr, i);
+      for (intptr_t j = 0, n = mlirArrayAttrGetNumElements(inputs); j < n; ++j)
+        donatableInputs.push_back(
+            mlirIntegerAttrGetValueInt(mlirArrayAttrGetElement(inputs, j)));
+    }
+    resultTypes.push_back(
+        {std::move(sizes), *dtype, std::move(donatableInputs)});
+  }
+
+  MlirExecutionEngine engine = mlirExecutionEngineCreate(
+      module, /*optLevel=*/2, /*numPaths=*/0, /*sharedLibPaths=*/nullptr,
+      /*enableObjectDump=*/false);
+  mlirModuleDestroy(module);
+  if (mlirExecutionEngineIsNull(engine)) {
+    TRACE_LTC(kTraceComputations, "Failed to JIT-compile the computation");
+    return nullptr;
+  }
+  return std::shared_ptr<RefBackendExecutable>(
+      new RefBackendExecutable(engine, std::move(resultTypes)));
+}
+
+RefBackendExecutable::~RefBackendExecutable() {
+  mlirExecutionEngineDestroy(engine_);
+}
+
+bool RefBackendExecutable::CanDonate(
+    const std::vector<at::Tensor>& inputs, int64_t input_index,
+    size_t result_index) const {
+  const ResultType& resultType = result_types_[result_index];
+  if (std::find(
+          resultType.donatable_inputs.begin(),
+          resultType.donatable_inputs.end(),
+          input_index) == resultType.donatable_inputs.end())
+    return false;
+  const at::Tensor& input = inputs[input_index];
+  // The result has to be written to the input itself, not to a contiguous
+  // copy of it, and nothing else may see the storage change.
+  if (!input.is_contiguous() || input.scalar_type() != resultType.dtype ||
+      !input.sizes().equals(resultType.sizes) ||
+      input.storage_offset() != 0 || input.storage().use_count() != 1)
+    return false;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (static_cast<int64_t>(i) != input_index &&
+        inputs[i].is_alias_of(input))
+      return false;
+  }
+  return true;
+}
+
+std::vector<at::Tensor> RefBackendExecutable::Run(
+    const std::vector<at::Tensor>& inputs,
+    const std::vector<int64_t>& donated_inputs) const {
+  // The generated code assumes the default, contiguous layout, so only
+  // non-contiguous inputs are copied.
+  std::vector<at::Tensor> buffers;
+  for (const auto& input : inputs) {
+    TORCH_CHECK(input.is_cpu(), "RefBackend inputs must be CPU tensors");
+    buffers.push_back(input.contiguous());
+  }
+  std::vector<at::Tensor> results;
+  std::vector<bool> donated(inputs.size(), false);
+  for (size_t i = 0; i < result_types_.size(); ++i) {
+    const ResultType& resultType = result_types_[i];
+    int64_t input = i < donated_inputs.size() ? donated_inputs[i] : -1;
+    if (input >= 0 && input < static_cast<int64_t>(inputs.size()) &&
+        !donated[input] && CanDonate(inputs, input, i)) {
+      donated[input] = true;
+      results.push_back(inputs[input]);
+    } else {
+      results.push_back(at::empty(
+          resultType.sizes, at::TensorOptions().dtype(resultType.dtype)));
+    }
+    buffers.push_back(results.back());
+  }
+
+  // With `llvm.emit_c_interface`, each argument is a pointer to a memref
+  // descriptor, and the packed interface takes a pointer to each argument.
+  std::vector<std::vector<int64_t>> descriptors;
+  for (const auto& buffer : buffers)
+    descriptors.push_back(getMemRefDescriptor(buffer));
+  std::vector<void*> descriptorPtrs;
+  for (auto& descriptor : descriptors)
+    descriptorPtrs.push_back(descriptor.data());
+  std::vector<void*> packedArgs;
+  for (void*& descriptorPtr : descriptorPtrs)
+    packedArgs.push_back(&descriptorPtr);
+
+  std::string name = std::string("_mlir_ciface_") + kFunctionName;
+  MlirLogicalResult result = mlirExecutionEngineInvokePacked(
+      engine_, mlirStringRefCreate(name.data(), name.size()),
+      packedArgs.data());
+  TORCH_CHECK(
+      mlirLogicalResultIsSuccess(result),
+      "Failed to invoke the RefBackend executable");
+  return results;
+}
+
+} // namespace lazy
+} // namespace torch
@@ -0,0 +1,84 @@
+//===- refbackend_executable.h --------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+//
+// Compiles the MLIR of a lazy computation with the RefBackend and runs it
+// natively.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ATen/Tensor.h>
+#include <c10/core/ScalarType.h>
+#include <mlir-c/ExecutionEngine.h>
+
+#include <torch_mlir/csrc/base_lazy_backend/mlir_lowering_context.h>
+
+namespace torch {
+namespace lazy {
+
+class RefBackendExecutable {
+public:
+  // Sets the textual pass pipeline lowering computations from the backend
+  // contract to LLVM, `LAZY_BACKEND_LOWERING_PIPELINE` of `refbackend.py`.
+  // This must be called before the first `Compile`; until it is, computations
+  // can't be compiled.
+  static void SetLoweringPipeline(std::string pipeline);
+
+  // Lowers `computation` through the linalg-on-tensors backend pipeline and
+  // the RefBackend pipeline and JIT-compiles the result. Returns nullptr
+  // (after tracing why) if the computation can't be executed this way, e.g.
+  // because it isn't statically shaped or takes scalar arguments.
+  static std::shared_ptr<RefBackendExecutable>
+  Compile(const TorchMlirComputation& computation);
+
+  ~RefBackendExecutable();
+
+  size_t NumResults() const { return result_types_.size(); }
+
+  // Runs the computation on `inputs`, which must be CPU tensors matching the
+  // parameters of the computation. The inputs are passed by their own
+  // storage, and the results are written directly into the returned tensors.
+  //
+  // `donated_inputs` optionally maps each result to the index of an input
+  // whose storage the caller no longer needs, or -1. Where the generated code
+  // allows it, that result is computed in place into the input, which is
+  // then returned as the result.
+  std::vector<at::Tensor> Run(
+      const std::vector<at::Tensor>& inputs,
+      const std::vector<int64_t>& donated_inputs = {}) const;
+
+private:
+  struct ResultType {
+    std::vector<int64_t> sizes;
+    c10::ScalarType dtype;
+    // The inputs whose storage can also be used for this result.
+    std::vector<int64_t> donatable_inputs;
+  };
+
+  RefBackendExecutable(
+      MlirExecutionEngine engine, std::vector<ResultType> result_types)
+      : engine_(engine), result_types_(std::move(result_types)) {}
+
+  // Returns true if the storage of `inputs[input_index]` can be reused for
+  // the result `result_index`.
+  bool CanDonate(
+      const std::vector<at::Tensor>& inputs, int64_t input_index,
+      size_t result_index) const;
+
+  MlirExecutionEngine engine_;
+  std::vector<ResultType> result_types_;
+};
+
+} // namespace lazy
+} // namespace torch
@@ -9,8 +9,11 @@
 
 #include "torch/csrc/jit/python/pybind.h"
 #include "torch/csrc/lazy/backend/backend_interface.h"
+#include "torch/csrc/lazy/core/metrics.h"
 
+#include <torch_mlir/csrc/base_lazy_backend/backend_impl.h>
 #include <torch_mlir/csrc/base_lazy_backend/mlir_lowering_context.h>
+#include <torch_mlir/csrc/base_lazy_backend/utils/debug.h>
 #include <torch_mlir/csrc/base_lazy_backend/utils/string_utils.h>
 #include <torch_mlir/csrc/base_lazy_backend/utils/sys_utils.h>
 #include <torch_mlir/csrc/base_lazy_backend/utils/tensor_utils.h>
@@ -20,6 +23,7 @@
 #include <string>
 
 #include "backend_impl.h"
+#include "refbackend_executable.h"
 
 namespace py = pybind11;
 
@@ -84,7 +88,47 @@ PYBIND11_MODULE(_REFERENCE_LAZY_BACKEND, m) {
             }
             return false;
         });
+  m.def("set_trace_level", [](int level) {
+    // 0 disables tracing, 1 traces each computation that is compiled and
+    // executed, and 2 additionally traces every call into the backend.
+    debug_util::SetTraceLevel(level);
+  });
+  m.def("set_async_execution", [](bool enabled) {
+    // Computations are then compiled and executed on the LTC thread pool, and
+    // reading a result blocks until that computation has finished.
+    static_cast<torch::lazy::TorchMlirBackendImpl*>(
+        torch::lazy::GetReferenceLazyBackendImpl())
+        ->SetAsyncExecutionEnabled(enabled);
+  });
+  m.def("get_metric_totals", []() {
+    // `torch._lazy.metrics` only exposes the metrics in its text report, so
+    // this maps the name of each one to its number of samples and the sum of
+    // their values, which are nanoseconds for the timers.
+    py::dict totals;
+    for (const std::string& name : torch::lazy::GetMetricNames()) {
+      torch::lazy::MetricData* data = torch::lazy::GetMetric(name);
+      if (data) {
+        totals[py::str(name)] =
+            py::make_tuple(data->TotalSamples(), data->Accumulator());
+      }
+    }
+    return totals;
+  });
   m.def("_initialize", []() {
+    // The lowering pipeline is defined along with the one of the RefBackend,
+    // so that the two stay in sync. Without it, computations are executed
+    // with the TorchScript executor.
+    try {
+      torch::lazy::RefBackendExecutable::SetLoweringPipeline(
+          py::module::import(
+              "torch_mlir_e2e_test.linalg_on_tensors_backends.refbackend")
+              .attr("LAZY_BACKEND_LOWERING_PIPELINE")
+              .cast<std::string>());
+    } catch (const py::error_already_set& e) {
+      TRACE_LTC(
+          kTraceComputations,
+          "Failed to get the RefBackend lowering pipeline: " << e.what());
+    }
     NoGilSection gil;
     Initialize();
   });
@@ -12,7 +12,7 @@ from torch import device
 import torch.jit._shape_functions as upstream_shape_functions
 
 from .testing_framework import Invocation, ErrorInvocation, TensorOfShape, LongTensorOfShape, NonZeroDTensorWithDtype, ZeroDTensorWithDtype, check_shape_function, check_dtype_function
-from .library_generator import generate_library, not_present_in_registry, promote_dtypes, get_dtype_of_scalar, is_integer_dtype, is_float_dtype, is_complex_dtype, get_priority_of_dtype, all_integer_dtypes, all_float_dtypes, all_complex_dtypes
+from .library_generator import generate_library, library_asm_to_bytecode, not_present_in_registry, promote_dtypes, get_dtype_of_scalar, is_integer_dtype, is_float_dtype, is_complex_dtype, get_priority_of_dtype, all_integer_dtypes, all_float_dtypes, all_complex_dtypes
 
 # ==============================================================================
 # Shape Functions
@@ -56,6 +56,12 @@ def aten〇atan〡shape(self: List[int]) -> List[int]:
 def aten〇tanh〡shape(self: List[int]) -> List[int]:
     return upstream_shape_functions.unary(self)
 
+def aten〇quantize_per_tensor〡shape(self: List[int], scale: float, zero_point: int, dtype: int) -> List[int]:
+    return upstream_shape_functions.unary(self)
+
+def aten〇dequantize〇self〡shape(self: List[int]) -> List[int]:
+    return upstream_shape_functions.unary(self)
+
 def aten〇erf〡shape(self: List[int]) -> List[int]:
     return upstream_shape_functions.unary(self)
 
@@ -516,6 +522,10 @@ def aten〇avg_pool2d〡shape(self: List[int], kernel_size: List[int], stride: L
 def aten〇adaptive_avg_pool2d〡shape(self: List[int], output_size: List[int]) -> List[int]:
     return upstream_shape_functions.adaptive_avg_pool2d(self, output_size)
 
+def aten〇adaptive_max_pool2d〡shape(self: List[int], output_size: List[int]) -> Tuple[List[int], List[int]]:
+    out = indices = upstream_shape_functions.adaptive_avg_pool2d(self, output_size)
+    return out, indices
+
 def aten〇flatten〇using_ints〡shape(self: List[int], start_dim: int = 0, end_dim: int = -1) -> List[int]:
     return upstream_shape_functions.flatten(self, start_dim, end_dim)
 
@@ -740,6 +750,41 @@ def prims〇view_of〡dtype(a_rank_dtype: Tuple[int, int]) -> int:
     _, a_dtype = a_rank_dtype
     return a_dtype
 
+# The collectives can't run without a process group, so their abstract
+# interpretation functions aren't checked against PyTorch.
+def c10d_functional〇all_reduce〡shape(self: List[int], reduceOp: str, tag: str, ranks: List[int], group_size: int) -> List[int]:
+    return upstream_shape_functions.unary(self)
+
+def c10d_functional〇all_reduce〡dtype(self_rank_dtype: Tuple[int, int], reduceOp: str, tag: str, ranks: List[int], group_size: int) -> int:
+    _, self_dtype = self_rank_dtype
+    return self_dtype
+
+def c10d_functional〇all_gather_into_tensor〡shape(shard: List[int], tag: str, ranks: List[int], group_size: int) -> List[int]:
+    out = upstream_shape_functions._copy(shard)
+    out[0] = shard[0] * group_size
+    return out
+
+def c10d_functional〇all_gather_into_tensor〡dtype(shard_rank_dtype: Tuple[int, int], tag: str, ranks: List[int], group_size: int) -> int:
+    _, shard_dtype = shard_rank_dtype
+    return shard_dtype
+
+def c10d_functional〇reduce_scatter_tensor〡shape(input: List[int], reduceOp: str, tag: str, ranks: List[int], group_size: int) -> List[int]:
+    assert input[0] % group_size == 0
+    out = upstream_shape_functions._copy(input)
+    out[0] = input[0] // group_size
+    return out
+
+def c10d_functional〇reduce_scatter_tensor〡dtype(input_rank_dtype: Tuple[int, int], reduceOp: str, tag: str, ranks: List[int], group_size: int) -> int:
+    _, input_dtype = input_rank_dtype
+    return input_dtype
+
+def c10d_functional〇wait_tensor〡shape(self: List[int]) -> List[int]:
+    return self
+
+def c10d_functional〇wait_tensor〡dtype(self_rank_dtype: Tuple[int, int]) -> int:
+    _, self_dtype = self_rank_dtype
+    return self_dtype
+
 def prim〇NumToTensor〇Scalar〡shape(a: float) -> List[int]:
     return []
 
@@ -931,6 +976,13 @@ def aten〇cross_entropy_loss〡shape(self: List[int], target: List[int], weight
 def aten〇native_layer_norm〡shape(input: List[int], normalized_shape: List[int], weight: Optional[List[int]], bias: Optional[List[int]], eps: float) -> Tuple[List[int], List[int], List[int]]:
     return upstream_shape_functions.native_layer_norm(input, normalized_shape)
 
+@check_shape_function([
+    Invocation(TensorOfShape(2, 6, 2, 2), None, None, 2, 6, 4, 3, 1e-6), # Basic case.
+    Invocation(TensorOfShape(2, 6, 4), None, None, 2, 6, 4, 6, 1e-6), # Instance norm.
+])
+def aten〇native_group_norm〡shape(input: List[int], weight: Optional[List[int]], bias: Optional[List[int]], N: int, C: int, HxW: int, group: int, eps: float) -> Tuple[List[int], List[int], List[int]]:
+    return upstream_shape_functions.unary(input), [N, group], [N, group]
+
 # Use CPU because META device results in the wrong behavior
 # https://github.com/pytorch/pytorch/issues/100985
 # TODO: This should be fixed by switching to FakeTensor instead of Meta tensor
@@ -1080,6 +1132,14 @@ def hacky_get_unknown_dimension_size():
 def aten〇bincount〡shape(self: List[int], weights: Optional[List[int]] = None, minlength: int = 0) -> List[int]:
     return [hacky_get_unknown_dimension_size()]
 
+# The number of selected elements is only bounded by the number of elements of
+# `self`, which the lowerings size their results by.
+def aten〇nonzero〡shape(self: List[int]) -> List[int]:
+    return [hacky_get_unknown_dimension_size(), len(self)]
+
+def aten〇masked_select〡shape(self: List[int], mask: List[int]) -> List[int]:
+    return [hacky_get_unknown_dimension_size()]
+
 def aten〇linalg_vector_norm〡shape(self: List[int], ord: float = 2, dim: Optional[List[int]] = None, keepdim: bool = False, dtype: Optional[int] = None) -> List[int]:
     return upstream_shape_functions.sum_mean_dim(self, dim, keepdim, dtype)
 
@@ -1216,6 +1276,12 @@ def _get_dtype_of_floating_point_op(input_dtype: int) -> int:
         return input_dtype
     return torch.float32
 
+def aten〇quantize_per_tensor〡dtype(self_rank_dtype: Tuple[int, int], scale: float, zero_point: int, dtype: int) -> int:
+    return dtype
+
+def aten〇dequantize〇self〡dtype(self_rank_dtype: Tuple[int, int]) -> int:
+    return torch.float32
+
 @check_dtype_function(_check_tensors_with_the_same_dtype(num_of_tensors=1))
 def aten〇tanh〡dtype(self_rank_dtype: Tuple[int, int]) -> int:
     self_rank, self_dtype = self_rank_dtype
@@ -1321,6 +1387,11 @@ def aten〇adaptive_avg_pool2d〡dtype(self_rank_dtype: Tuple[int, int], output_
     self_rank, self_dtype = self_rank_dtype
     return self_dtype
 
+@check_dtype_function(_check_tensors_with_the_same_dtype(tensor_shapes=[(2, 3, 5, 7)], output_size=[2, 2]))
+def aten〇adaptive_max_pool2d〡dtype(self_rank_dtype: Tuple[int, int], output_size: List[int]) -> Tuple[int, int]:
+    self_rank, self_dtype = self_rank_dtype
+    return self_dtype, torch.int64
+
 @check_dtype_function(_check_tensors_with_the_same_dtype(tensor_shapes=[(2, 3, 5, 7)], kernel_size=[2, 2]))
 def aten〇avg_pool2d〡dtype(self_rank_dtype: Tuple[int, int], kernel_size: List[int], stride: List[int] = (), padding: List[int] = (0, 0), ceil_mode: bool = False, count_include_pad: bool = True, divisor_override: Optional[int] = None) -> int:
     self_rank, self_dtype = self_rank_dtype
@@ -1597,6 +1668,11 @@ def aten〇masked_select〡dtype(self_rank_dtype: Tuple[int, int], mask_rank_dty
     self_rank, self_dtype = self_rank_dtype
     return self_dtype
 
+# Could not run 'aten::nonzero' with arguments from the 'Meta' backend.
+@check_dtype_function(_check_tensors_with_the_same_dtype(num_of_tensors=1, tensor_device="cpu"))
+def aten〇nonzero〡dtype(self_rank_dtype: Tuple[int, int]) -> int:
+    return torch.int64
+
 @check_dtype_function(_check_tensors_with_the_same_dtype(tensor_shapes=[(2, 3, 5, 7)], kernel_size=[2, 2]))
 def aten〇max_pool2d〡dtype(self_rank_dtype: Tuple[int, int], kernel_size: List[int], stride: List[int] = (), padding: List[int] = (0, 0), dilation: List[int] = (1, 1), ceil_mode: bool = False) -> int:
     self_rank, self_dtype = self_rank_dtype
@@ -2641,6 +2717,18 @@ def aten〇native_layer_norm〡dtype(input_rank_dtype: Tuple[int, int], normaliz
         result_dtype = torch.float64
     return input_dtype, input_dtype, result_dtype
 
+@check_dtype_function(
+    [Invocation(TensorOfShape(2, 6, 2, 2, dtype=torch.float32), None, None, 2, 6, 4, 3, eps=0.0),
+     Invocation(TensorOfShape(2, 6, 2, 2, dtype=torch.float64), TensorOfShape(6, dtype=torch.float64),
+                TensorOfShape(6, dtype=torch.float64), 2, 6, 4, 3, eps=0.0),
+     # Input must be float
+     ErrorInvocation(TensorOfShape(2, 6, 2, 2, dtype=torch.int32), None, None, 2, 6, 4, 3, eps=0.0),
+     ])
+def aten〇native_group_norm〡dtype(input_rank_dtype: Tuple[int, int], weight_rank_dtype: Optional[Tuple[int, int]], bias_rank_dtype: Optional[Tuple[int, int]], N: int, C: int, HxW: int, group: int, eps: float) -> Tuple[int, int, int]:
+    input_rank, input_dtype = input_rank_dtype
+    assert not is_integer_dtype(input_dtype)
+    return input_dtype, input_dtype, input_dtype
+
 @check_dtype_function(
     [Invocation(TensorOfShape(3, 3, dtype=torch.float32), TensorOfShape(3, dtype=torch.float32),
                 TensorOfShape(3, dtype=torch.float32), TensorOfShape(3, dtype=torch.float32),
@@ -3234,9 +3322,7 @@ def _maybe_import_op_extensions(args: argparse.Namespace):
             # importing these modules, so we don't need the return value.
             importlib.import_module(name)
 
-def main(args):
-    _maybe_import_op_extensions(args)
-    asm = generate_library(globals())
+def _to_cpp_string_literal(asm: str) -> str:
     # We're about to put quotes around the string, so escape the `"` characters.
     asm = asm.replace("\"", "\\\"")
 
@@ -3246,7 +3332,40 @@ def main(args):
     # [https://docs.microsoft.com/en-us/cpp/error-messages/compiler-errors-1/compiler-error-c2026?view=msvc-170]
     # for details.
     multiple_lines = asm.replace("\n", "\\n\"\n\"")
-    asm = f"\"{multiple_lines}\""
+    return f"\"{multiple_lines}\""
+
+def _to_cpp_byte_array(data: bytes) -> str:
+    # Emit the bytes as a comma-separated initializer list, 16 bytes per line.
+    # Unlike a string literal, this doesn't run into any length limits.
+    lines = []
+    for i in range(0, len(data), 16):
+        chunk = data[i:i + 16]
+        lines.append(", ".join(f"0x{b:02x}" for b in chunk) + ",")
+    return "\n".join(lines)
+
+def main(args):
+    _maybe_import_op_extensions(args)
+    asm = generate_library(globals())
+
+    if args.emit_bytecode:
+        # The bytecode reader requires the buffer to be suitably aligned.
+        body = f"""  alignas(8) static const unsigned char library[] = {{
+  // clang-format off
+{_to_cpp_byte_array(library_asm_to_bytecode(asm))}
+  // clang-format on
+  }};
+  return StringRef(reinterpret_cast<const char *>(library), sizeof(library));"""
+    else:
+        body = f"""#ifndef _MSC_VER
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Woverlength-strings"
+#endif
+  // clang-format off
+  return {_to_cpp_string_literal(asm)};
+  // clang-format on
+#ifndef _MSC_VER
+#pragma clang diagnostic pop
+#endif"""
 
     # Write out the library .cpp file.
     abstract_interp_lib_cpp_file = os.path.join(
@@ -3273,16 +3392,7 @@ f"""//===-------------------------------------------------------------*- C++-*-=
 using namespace mlir;
 
 StringRef mlir::torch::Torch::getAbstractInterpLibrary() {{
-#ifndef _MSC_VER
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Woverlength-strings"
-#endif
-  // clang-format off
-  return {asm};
-  // clang-format on
-#ifndef _MSC_VER
-#pragma clang diagnostic pop
-#endif
+{body}
 }}""")
 
 def _create_argparse() -> argparse.ArgumentParser:
@@ -3296,6 +3406,10 @@ def _create_argparse() -> argparse.ArgumentParser:
         type=str,
         default="",
         help="An optional, comma-separated list of Python modules which register additional PyTorch operators upon being imported. These modules can be used to build a torch-mlir which supports PyTorch extensions.")
+    parser.add_argument(
+        "--emit_bytecode",
+        action="store_true",
+        help="Embed the library as MLIR bytecode rather than as textual MLIR. Bytecode is smaller and faster to load, but is not human-readable.")
     return parser
 
 if __name__ == "__main__":
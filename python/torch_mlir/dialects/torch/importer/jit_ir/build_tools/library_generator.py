@@ -4,11 +4,14 @@
 # Also available under a BSD-style license. See LICENSE.
 
 import inspect
+import io
 import re
 from typing import List, Optional, Union, Any, Dict
 
 import torch
 
+from torch_mlir import ir
+from torch_mlir.dialects import torch as torch_dialect
 from torch_mlir.dialects.torch.importer.jit_ir import ModuleBuilder
 from torch_mlir.passmanager import PassManager
 
@@ -241,3 +244,16 @@ def generate_library(functions: Dict[str, Any]) -> str:
     # Put the `〇` back to a regular `.`.
     asm = asm.replace("\\E3\\80\\87", ".")
     return asm
+
+def library_asm_to_bytecode(asm: str) -> bytes:
+    """Convert the textual library produced by `generate_library` to bytecode.
+
+    MLIR bytecode is much cheaper to load than the textual form, since it skips
+    lexing and most of the parsing work, and it is also more compact.
+    """
+    with ir.Context() as context:
+        torch_dialect.register_dialect(context)
+        module = ir.Module.parse(asm)
+        buffer = io.BytesIO()
+        module.operation.write_bytecode(buffer)
+        return buffer.getvalue()
@@ -7,9 +7,12 @@
 
 from typing import Dict, List, Tuple, Union, Callable
 
+import importlib
 import io
 import itertools
 
+import torch
+
 from .utils import TextEmitter
 
 # Note that this utility exists only in the c-extension.
@@ -387,6 +390,10 @@ class Registry:
 
     @staticmethod
     def load() -> "Registry":
+        # The `c10d_functional::` ops are registered when the functional
+        # collectives are first imported.
+        if torch.distributed.is_available():
+            importlib.import_module("torch.distributed._functional_collectives")
         return Registry([JitOperator(op_info) for op_info in get_registered_ops()])
 
     def __getitem__(self, key: str):
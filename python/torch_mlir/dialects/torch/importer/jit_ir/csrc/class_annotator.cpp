@@ -191,6 +191,30 @@ void ClassAnnotator::annotateArgs(c10::ClassType &rootClassType,
   return;
 }
 
+void ClassAnnotator::annotatePreallocatedOutputs(
+    c10::ClassType &rootClassType, std::vector<std::string> path) {
+  if (path.size() == 0) {
+    throw std::invalid_argument("Empty annotated path. Can only annotate "
+                                "the outputs of a method of a class.");
+  }
+  c10::ClassType *classType = getClassAtPath(
+      &rootClassType,
+      c10::ArrayRef<std::string>(path).slice(0, path.size() - 1).vec());
+
+  // Throw error if no method on the class of the specified name.
+  (void)classType->getMethod(path.back());
+
+  ClassAnnotation &classAnnotation = getOrCreateClassAnnotation(classType);
+  std::vector<MethodAnnotation> &methodAnnotations =
+      classAnnotation.getMethodAnnotations();
+  const std::vector<torch::jit::Function *> &methods = classType->methods();
+  for (int i = 0, e = methods.size(); i != e; i++) {
+    if (methods[i]->name() == path.back()) {
+      methodAnnotations[i].hasPreallocatedOutputs = true;
+    }
+  }
+}
+
 c10::ClassType *ClassAnnotator::getClassAtPath(c10::ClassType *rootClassType,
                                                std::vector<std::string> path) {
   c10::ClassType *classType = rootClassType;
@@ -255,6 +279,8 @@ std::string ArgAnnotation::toString(int argIndex) {
   }
   ss << "  hasValueSemantics = " << (hasValueSemantics ? "true" : "false")
      << "\n";
+  ss << "  isDonated = " << (isDonated ? "true" : "false") << "\n";
+  ss << "  sharding = " << (sharding ? *sharding : "<none>") << "\n";
   ss << "}\n";
   return ss.str();
 }
@@ -263,6 +289,8 @@ std::string MethodAnnotation::toString(const std::string &name) {
   std::stringstream ss;
   ss << "MethodAnnotation('" << name << "') {\n";
   ss << "  isExported = " << (isExported ? "true" : "false") << "\n";
+  ss << "  hasPreallocatedOutputs = "
+     << (hasPreallocatedOutputs ? "true" : "false") << "\n";
   ss << "  argAnnotations =";
   if (argAnnotations) {
     ss << "\n";
@@ -61,11 +61,24 @@ struct ArgAnnotation {
   //
   // A value of `false` preserves the default Torch semantics and is a
   // safe default.
-  //
-  // TODO: Also add a "last use" / "dead" flag, which enables more powerful
-  // optimizations like reusing the input buffer for scratch space.
   bool hasValueSemantics = false;
 
+  // If true, means that the caller doesn't use the argument after the call,
+  // so that its buffer can be reused, such as for the results (the argument
+  // must be a tensor with value semantics).
+  //
+  // This is imported as a `torch.donated` argument attribute.
+  bool isDonated = false;
+
+  // The sharding of the argument across the devices it is partitioned over,
+  // in the textual HLO sharding syntax, such as "{devices=[2,1]0,1}" for a
+  // tensor split along its first dimension across two devices.
+  //
+  // This is imported as a `torch.sharding` argument attribute, which the
+  // StableHLO lowering turns into the `mhlo.sharding` attribute that XLA's
+  // SPMD partitioner reads.
+  c10::optional<std::string> sharding;
+
   std::string toString(int argIndex);
 };
 
@@ -76,6 +89,12 @@ struct MethodAnnotation {
   // can be externally called.
   bool isExported = true;
 
+  // Whether the callers of this method provide the buffers its results are
+  // written into, rather than the method allocating them.
+  //
+  // This is imported as a `torch.preallocated_outputs` function attribute.
+  bool hasPreallocatedOutputs = false;
+
   // Optional is not strictly needed here, but it prevents an unreasonably
   // large printout of the default ArgAnnotation for every method.
   c10::optional<std::vector<ArgAnnotation>> argAnnotations;
@@ -156,13 +175,20 @@ public:
   // `argAnnotations` should be a list of 3-tuples, with the first element
   // being a list/tuple of integer sizes, and the second being a torch datatype
   // object, such as `torch.float32`, `torch.int8`, etc., and the last being
-  // a "has value semantics" boolean.
+  // a "has value semantics" boolean. A fourth "is donated" boolean may follow,
+  // and then a "sharding" string or None.
   // These will be put into an `ArgAnnotation` struct -- see there for
   // precise definitions of the promised semantics of each entry.
   void annotateArgs(c10::ClassType &rootClassType,
                     std::vector<std::string> path,
                     std::vector<ArgAnnotation> argAnnotations);
 
+  // Annotate that the callers of the method at path `path` from
+  // `rootClassType` provide the buffers for its results. See
+  // `MethodAnnotation::hasPreallocatedOutputs`.
+  void annotatePreallocatedOutputs(c10::ClassType &rootClassType,
+                                   std::vector<std::string> path);
+
   // The annotations collected so far.
   const ClassAnnotationMap &getAnnotationMap();
 
@@ -43,6 +43,12 @@ static std::vector<ArgAnnotation> getArgAnnotations(py::list pyArgAnnotations) {
       argAnnotations[i].dtype = convertToC10ScalarType(dtype);
     }
     argAnnotations[i].hasValueSemantics = py::cast<bool>(hasValueSemantics);
+    if (tuple.size() > 3) {
+      argAnnotations[i].isDonated = py::cast<bool>(tuple[3]);
+    }
+    if (tuple.size() > 4 && !tuple[4].is_none()) {
+      argAnnotations[i].sharding = py::cast<std::string>(tuple[4]);
+    }
   };
 
   return argAnnotations;
@@ -59,5 +65,7 @@ void torch_mlir::initClassAnnotatorBindings(py::module &m) {
              cls_annotator.annotateArgs(rootClassType, path,
                                         getArgAnnotations(argAnnotations));
            })
+      .def("annotatePreallocatedOutputs",
+           &ClassAnnotator::annotatePreallocatedOutputs)
       .def("__repr__", &ClassAnnotator::toString);
 }
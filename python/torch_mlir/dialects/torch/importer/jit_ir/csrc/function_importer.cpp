@@ -26,6 +26,7 @@ MlirOperation torch_mlir::importJitFunctionAsFuncOp(
     const ImportOptions &importOptions) {
   // Useful for debugging:
   // graph->dump();
+  TensorTypeCacheScope typeCacheScope;
   MlirLocation loc = mlirLocationUnknownGet(context);
   MlirType functionType =
       getFunctionTypeFromSchema(context, function->getSchema(), importOptions);
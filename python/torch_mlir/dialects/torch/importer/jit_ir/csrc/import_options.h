@@ -33,6 +33,28 @@ struct ImportOptions {
   // In that case, the appropriate shape information is provided via the type
   // bound annotations on the function arguments instead.
   bool ignoreExistingTensorShapesAndDtypes = false;
+
+  // If this is set to true, then tensors held by the imported module (such
+  // as parameters and buffers) are imported as `dense_resource` attributes
+  // that reference the tensor's storage directly, rather than being copied
+  // into a uniqued `DenseElementsAttr` in the context. Tensors that cannot be
+  // referenced in place (e.g. non-contiguous or non-CPU ones) are still
+  // copied.
+  bool importTensorsAsDenseResources = false;
+
+  // If this is set to true, then tensors held by the imported module are
+  // imported as `torch.tensor.external` ops (or `torch.vtensor.external`, see
+  // `assumeTensorsHaveValueSemantics`) that only carry the tensor's name, sizes
+  // and dtype. The name is the tensor's key in the root module's
+  // `state_dict()`, so that a runtime can load the contents from e.g. a
+  // safetensors file saved from it. This takes precedence over
+  // `importTensorsAsDenseResources`.
+  bool externalizeTensors = false;
+
+  // If this is set to true, then the functions of the compilation unit of an
+  // imported module are imported in parallel, on PyTorch's intra-op thread
+  // pool. This requires the MLIR context to have multithreading enabled.
+  bool importFunctionsInParallel = true;
 };
 } // namespace torch_mlir
 
@@ -20,5 +20,11 @@ void torch_mlir::initImportOptionsBindings(py::module &m) {
       .def_readwrite("assumeTensorsHaveValueSemantics",
                      &ImportOptions::assumeTensorsHaveValueSemantics)
       .def_readwrite("ignoreExistingTensorShapesAndDtypes",
-                     &ImportOptions::ignoreExistingTensorShapesAndDtypes);
+                     &ImportOptions::ignoreExistingTensorShapesAndDtypes)
+      .def_readwrite("importTensorsAsDenseResources",
+                     &ImportOptions::importTensorsAsDenseResources)
+      .def_readwrite("externalizeTensors",
+                     &ImportOptions::externalizeTensors)
+      .def_readwrite("importFunctionsInParallel",
+                     &ImportOptions::importFunctionsInParallel);
 }
@@ -12,6 +12,10 @@
 #include "function_importer.h"
 #include "torch_to_mlir_utils.h"
 
+#include <atomic>
+#include <functional>
+#include <map>
+#include <tuple>
 #include <unordered_map>
 
 #include "mlir_utils.h"
@@ -21,6 +25,7 @@
 #include "mlir-c/Diagnostics.h"
 #include "torch-mlir-c/TorchTypes.h"
 
+#include "ATen/Parallel.h"
 #include "ATen/native/quantized/PackedParams.h"
 
 using namespace torch_mlir;
@@ -90,13 +95,16 @@ namespace {
 /// - at::StorageImpl which is a low-level buffer
 ///   - the address of the at::StorageImpl is the identity of the "storage".
 ///
-/// Multiple different tensors can share the same underlying storage. We
-/// currently import tensors by identity and emit errors in the case of tensors
-/// with different identity but sharing the same storage. This is done because
-/// correctly modeling the many ways that tensors can overlap and alias when
-/// they share storage is difficult. Example hard cases are weird
-/// strides/offsets that overlap, and even cases where the data types mismatch
-/// (PyTorch allows this!).
+/// Multiple different tensors can share the same underlying storage. Tensors
+/// with different identity that are the same view of the same storage (same
+/// offset, sizes, strides and dtype), such as the tied weights of a language
+/// model that were loaded into separate parameters, are unified and import as
+/// a single literal. We emit errors for the remaining tensors with different
+/// identity but sharing the same storage. This is done because correctly
+/// modeling the many ways that tensors can overlap and alias when they share
+/// storage is difficult. Example hard cases are weird strides/offsets that
+/// overlap, and even cases where the data types mismatch (PyTorch allows
+/// this!).
 class IValueImporter {
 public:
   IValueImporter(MlirBlock importBlock, MlirContext context,
@@ -105,10 +113,16 @@ public:
         importOptions(importOptions) {}
 
   MlirValue importIValue(c10::IValue ivalue);
+  /// Prepares the payloads of the tensors reachable from `ivalue` that will be
+  /// imported as DenseElementsAttr's, in parallel. Only the creation of the
+  /// attributes and ops, which use the MLIR context, is then left to
+  /// `importIValue`.
+  void prepareTensors(c10::IValue ivalue);
 
 private:
   MlirValue rawImportIValue(c10::IValue ivalue);
   MlirValue importTensor(c10::IValue ivalue);
+  std::string getUniqueExternalTensorName();
   MlirValue importModule(torch::jit::Module jitModule);
   void importMethod(torch::jit::Function *function, MlirBlock classTypeBody,
                     const MethodAnnotation &methodAnnotation);
@@ -131,8 +145,21 @@ private:
   // `__torch__`).
   torch::jit::CompilationUnit *compilationUnit = nullptr;
 
+  // The payloads computed by `prepareTensors`, keyed by tensor identity.
+  std::unordered_map<c10::TensorImpl *, at::Tensor> preparedTensors;
+
   // Used to detect potentially aliasing tensors.
   std::unordered_set<c10::StorageImpl *> seenStorageImpls;
+  // Map from the view of the storage that a tensor is (storage, offset, sizes,
+  // strides and dtype) to the value it was imported as, used to unify tensors
+  // that are the same view of the same storage.
+  using TensorView =
+      std::tuple<c10::StorageImpl *, int64_t, std::vector<int64_t>,
+                 std::vector<int64_t>, c10::ScalarType>;
+  std::map<TensorView, MlirValue> tensorViewMap;
+  // The names already given to tensors imported with
+  // `ImportOptions::externalizeTensors`.
+  std::unordered_set<std::string> externalTensorNames;
   // The set of ClassType's that have already been imported.
   //
   // ClassType's are referenced via their `classType->name()->qualifiedName()`
@@ -229,10 +256,25 @@ MlirValue IValueImporter::importIValue(c10::IValue ivalue) {
   if (it != valueMap.end()) {
     return it->second;
   }
-  // Reject potentially aliased tensors.
-  if (ivalue.isTensor()) {
-    c10::StorageImpl *storageImpl =
-        ivalue.toTensor().storage().unsafeGetStorageImpl();
+  // Unify tensors that are the same view of the same storage, and reject
+  // other potentially aliased tensors. Sparse tensors have no storage of their
+  // own, so they are only unified by identity.
+  c10::optional<TensorView> tensorView;
+  if (ivalue.isTensor() && ivalue.toTensor().layout() == c10::Layout::Strided) {
+    at::Tensor tensor = ivalue.toTensor();
+    c10::StorageImpl *storageImpl = tensor.storage().unsafeGetStorageImpl();
+    // Quantized tensors also carry their quantization parameters, so they are
+    // only unified by identity.
+    if (!tensor.is_quantized()) {
+      tensorView = TensorView(storageImpl, tensor.storage_offset(),
+                              tensor.sizes().vec(), tensor.strides().vec(),
+                              tensor.scalar_type());
+      auto viewIt = tensorViewMap.find(*tensorView);
+      if (viewIt != tensorViewMap.end()) {
+        valueMap[ivalue] = viewIt->second;
+        return viewIt->second;
+      }
+    }
     if (!seenStorageImpls.insert(storageImpl).second) {
       std::stringstream msg;
       msg << "Unhandled tensor that shares storage with another tensor.";
@@ -246,9 +288,38 @@ MlirValue IValueImporter::importIValue(c10::IValue ivalue) {
   }
   MlirValue value = rawImportIValue(ivalue);
   valueMap[ivalue] = value;
+  if (tensorView)
+    tensorViewMap[*tensorView] = value;
   return value;
 }
 
+void IValueImporter::prepareTensors(c10::IValue ivalue) {
+  // Externalized tensors have no payload, and dense resources reference the
+  // storage in place.
+  if (importOptions.externalizeTensors ||
+      importOptions.importTensorsAsDenseResources)
+    return;
+  std::vector<at::Tensor> tensors;
+  std::unordered_set<c10::TensorImpl *> seenTensorImpls;
+  ivalue.visit([&](const c10::IValue &v) {
+    if (v.isTensor() &&
+        seenTensorImpls.insert(v.toTensor().unsafeGetTensorImpl()).second)
+      tensors.push_back(v.toTensor());
+    return false;
+  });
+  if (tensors.size() < 2)
+    return;
+
+  std::vector<at::Tensor> prepared(tensors.size());
+  at::parallel_for(0, tensors.size(), /*grain_size=*/1,
+                   [&](int64_t begin, int64_t end) {
+                     for (int64_t i = begin; i < end; ++i)
+                       prepared[i] = prepareTensorForElementsAttr(tensors[i]);
+                   });
+  for (size_t i = 0; i < tensors.size(); ++i)
+    preparedTensors[tensors[i].unsafeGetTensorImpl()] = std::move(prepared[i]);
+}
+
 MlirValue IValueImporter::rawImportIValue(c10::IValue ivalue) {
   // TODO: Can we do better?
   MlirLocation loc = mlirLocationUnknownGet(context);
@@ -370,35 +441,93 @@ MlirValue IValueImporter::rawImportIValue(c10::IValue ivalue) {
   throw std::invalid_argument(msg.str());
 }
 
+std::string IValueImporter::getUniqueExternalTensorName() {
+  // The attribute path matches the key of the tensor in the `state_dict()` of
+  // the root module, which is what e.g. safetensors files are keyed by.
+  std::string name =
+      attributeNameStack.empty()
+          ? "torch_tensor"
+          : c10::QualifiedName(attributeNameStack).qualifiedName();
+  // Tensors that are not held directly by a module attribute (e.g. the
+  // elements of a list) can share a path, so disambiguate those.
+  std::string uniqueName = name;
+  for (int i = 1; !externalTensorNames.insert(uniqueName).second; ++i)
+    uniqueName = name + "_" + std::to_string(i);
+  return uniqueName;
+}
+
 MlirValue IValueImporter::importTensor(c10::IValue ivalue) {
   assert(ivalue.isTensor() && "expected a tensor!");
 
   // TODO: Can we do better?
   MlirLocation loc = mlirLocationUnknownGet(context);
 
-  // Import the bulk tensor representation.
-  at::Tensor tensor = ivalue.toTensor().contiguous();
-  MlirAttribute denseElements = convertTensorToMlirElementsAttr(tensor, loc);
-
+  // Import the bulk tensor representation. Sparse tensors are imported from
+  // their dense values, and cast to their sparse type below.
+  at::Tensor tensor = ivalue.toTensor();
+  MlirAttribute sparsity = getMlirSparsityForTensor(tensor, loc);
+  if (!mlirAttributeIsNull(sparsity))
+    tensor = tensor.to_dense();
   MlirOperation tensorOp;
-
-  if (importOptions.assumeTensorsHaveValueSemantics) {
-    tensorOp = createMlirOperationAtEnd(
-        importBlock, "torch.vtensor.literal", loc,
-        torchMlirTorchValueTensorTypeGetFromAttribute(denseElements),
-        toMlirNamedAttribute("value", denseElements));
+  if (importOptions.externalizeTensors) {
+    // Only the name, sizes and dtype of the tensor are imported. The contents
+    // are provided by the runtime, which finds them by name.
+    std::vector<int64_t> shape(tensor.sizes().begin(), tensor.sizes().end());
+    MlirType dtype = getMlirTypeForTorchScalarType(
+        loc, c10::toUnderlying(tensor.scalar_type()));
+    MlirAttribute name = mlirStringAttrGet(
+        context, toMlirStringRef(getUniqueExternalTensorName()));
+    if (importOptions.assumeTensorsHaveValueSemantics) {
+      tensorOp = createMlirOperationAtEnd(
+          importBlock, "torch.vtensor.external", loc,
+          torchMlirTorchValueTensorTypeGet(context, shape.size(), shape.data(),
+                                           dtype),
+          toMlirNamedAttribute("name", name));
+    } else {
+      tensorOp = createMlirOperationAtEnd(
+          importBlock, "torch.tensor.external", loc,
+          torchMlirTorchNonValueTensorTypeGet(context, shape.size(),
+                                              shape.data(), dtype),
+          toMlirNamedAttribute("name", name));
+    }
   } else {
-    tensorOp = createMlirOperationAtEnd(
-        importBlock, "torch.tensor.literal", loc,
-        torchMlirTorchNonValueTensorTypeGetFromAttribute(denseElements),
-        toMlirNamedAttribute("value", denseElements));
+    tensor = tensor.contiguous();
+    MlirAttribute denseElements = {nullptr};
+    if (importOptions.importTensorsAsDenseResources) {
+      std::string resourceName =
+          attributeNameStack.empty()
+              ? "torch_tensor"
+              : c10::QualifiedName(attributeNameStack).qualifiedName();
+      denseElements =
+          convertTensorToMlirDenseResourceAttr(tensor, resourceName, loc);
+    }
+    if (mlirAttributeIsNull(denseElements)) {
+      c10::optional<at::Tensor> prepared;
+      auto it = preparedTensors.find(ivalue.toTensor().unsafeGetTensorImpl());
+      if (it != preparedTensors.end()) {
+        prepared = std::move(it->second);
+        preparedTensors.erase(it);
+      }
+      denseElements = convertTensorToMlirElementsAttr(tensor, loc, prepared);
+    }
+
+    if (importOptions.assumeTensorsHaveValueSemantics) {
+      tensorOp = createMlirOperationAtEnd(
+          importBlock, "torch.vtensor.literal", loc,
+          torchMlirTorchValueTensorTypeGetFromAttribute(denseElements),
+          toMlirNamedAttribute("value", denseElements));
+    } else {
+      tensorOp = createMlirOperationAtEnd(
+          importBlock, "torch.tensor.literal", loc,
+          torchMlirTorchNonValueTensorTypeGetFromAttribute(denseElements),
+          toMlirNamedAttribute("value", denseElements));
+    }
   }
 
   MlirValue tensorReprValue = mlirOperationGetResult(tensorOp, 0);
 
   // Construct the complete tensor value. This is trivial for most tensors, but
-  // for quantized tensors (and probably sparse too, TBD) there is more for us
-  // to do.
+  // for quantized and sparse tensors there is more for us to do.
   MlirValue tensorValue;
   if (tensor.is_quantized()) {
     // Note that Torch models quantization in a type-erased way. So we don't
@@ -423,12 +552,40 @@ MlirValue IValueImporter::importTensor(c10::IValue ivalue) {
           importBlock, "torch.per_tensor_affine.create", loc,
           quantizedTensorType, tensorReprValue, qScale, zeroPoint);
       tensorValue = mlirOperationGetResult(quantizedTensor, 0);
+    } else if (tensor.qscheme() == c10::kPerChannelAffine) {
+      MlirValue qScales =
+          importIValue(c10::IValue(tensor.q_per_channel_scales()));
+      MlirValue zeroPoints =
+          importIValue(c10::IValue(tensor.q_per_channel_zero_points()));
+      MlirValue axis = importIValue(c10::IValue(tensor.q_per_channel_axis()));
+      MlirOperation quantizedTensor = createMlirOperationAtEnd(
+          importBlock, "torch.per_channel_affine.create", loc,
+          quantizedTensorType, tensorReprValue, qScales, zeroPoints, axis);
+      tensorValue = mlirOperationGetResult(quantizedTensor, 0);
     } else {
       std::stringstream msg;
       msg << "Unsupported quantization scheme '"
           << c10::toString(tensor.qscheme()) << "' for tensor: " << ivalue;
       throw std::invalid_argument(msg.str());
     }
+  } else if (!mlirAttributeIsNull(sparsity)) {
+    // The sparse layout is static information of the tensor type, which the
+    // backends lower to a conversion from the dense values.
+    std::vector<int64_t> shape(tensor.sizes().begin(), tensor.sizes().end());
+    MlirType dtype = getMlirTypeForTorchScalarType(
+        loc, c10::toUnderlying(tensor.scalar_type()));
+    MlirType sparseTensorType;
+    if (importOptions.assumeTensorsHaveValueSemantics) {
+      sparseTensorType = torchMlirTorchValueTensorTypeGetWithSparsity(
+          context, shape.size(), shape.data(), dtype, sparsity);
+    } else {
+      sparseTensorType = torchMlirTorchNonValueTensorTypeGetWithSparsity(
+          context, shape.size(), shape.data(), dtype, sparsity);
+    }
+    MlirOperation sparseTensor = createMlirOperationAtEnd(
+        importBlock, "torch.tensor_static_info_cast", loc, sparseTensorType,
+        tensorReprValue);
+    tensorValue = mlirOperationGetResult(sparseTensor, 0);
   } else {
     tensorValue = tensorReprValue;
   }
@@ -505,6 +662,111 @@ void IValueImporter::importClassType(c10::ClassType *classType) {
   createMlirOperationAtEnd(classTypeBody, "torch.class_type_terminator", loc);
 }
 
+// Returns the attributes of argument `argIndex` of a function with the
+// annotation `annotation`, or a null attribute if it has none.
+static MlirAttribute getArgAttribute(MlirContext context,
+                                     MethodAnnotation *annotation,
+                                     int argIndex) {
+  if (!annotation || !annotation->argAnnotations.has_value()) {
+    return {nullptr};
+  }
+  ArgAnnotation &argAnnotation = annotation->argAnnotations.value()[argIndex];
+  c10::optional<std::vector<int64_t>> &maybeShape = argAnnotation.shape;
+  c10::optional<c10::ScalarType> &maybeDtype = argAnnotation.dtype;
+  bool hasValueSemantics = argAnnotation.hasValueSemantics;
+
+  std::vector<MlirNamedAttribute> argAttrs;
+  if (argAnnotation.isDonated) {
+    argAttrs.push_back(
+        toMlirNamedAttribute("torch.donated", mlirUnitAttrGet(context)));
+  }
+  if (argAnnotation.sharding) {
+    argAttrs.push_back(toMlirNamedAttribute(
+        "torch.sharding",
+        mlirStringAttrGet(context, toMlirStringRef(*argAnnotation.sharding))));
+  }
+
+  // TODO: Handle unranked tensors and tensors with unknown dtype (but
+  // possibly known ranks/sizes).
+  if (maybeShape && maybeDtype) {
+    std::vector<int64_t> shape = *maybeShape;
+    MlirType dtype = getMlirTypeForTorchScalarType(
+        mlirLocationUnknownGet(context), *maybeDtype);
+    MlirType typeBound;
+    // `std::vector`'s `.data()` method can return nullptr when the size is 0.
+    // This triggers the "nothing known about sizes" case in the C API
+    // constructor, when we want the "we know we have 0 sizes" case. So use a
+    // dummy data pointer.
+    int64_t dummy;
+    int64_t *shapeData = shape.size() == 0 ? &dummy : shape.data();
+    if (hasValueSemantics) {
+      typeBound = torchMlirTorchValueTensorTypeGet(context, shape.size(),
+                                                   shapeData, dtype);
+    } else {
+      typeBound = torchMlirTorchNonValueTensorTypeGet(context, shape.size(),
+                                                      shapeData, dtype);
+    }
+    argAttrs.push_back(
+        toMlirNamedAttribute("torch.type_bound", mlirTypeAttrGet(typeBound)));
+  }
+
+  if (argAttrs.empty()) {
+    return {nullptr};
+  }
+  return mlirDictionaryAttrGet(context, argAttrs.size(), argAttrs.data());
+}
+
+// Imports each of `functions` into `funcs` with `importFunction` on the
+// intra-op thread pool of PyTorch. Contexts without multithreading are not
+// safe to use from several threads, so false is returned right away for them.
+//
+// The diagnostic handlers of the context, such as the one printing to Python's
+// `sys.stderr`, can't be called from the worker threads, so the diagnostics
+// emitted meanwhile are dropped. If there are any, or if an import fails,
+// whatever was imported is discarded and false is returned, so that the
+// functions can be imported again on this thread to report them.
+static bool
+importInParallel(MlirContext context,
+                 c10::ArrayRef<torch::jit::Function *> functions,
+                 std::vector<MlirOperation> &funcs,
+                 const std::function<void(size_t)> &importFunction) {
+  if (!mlirContextIsMultithreadingEnabled(context))
+    return false;
+  // The schemas of the functions are created lazily and cached, which is not
+  // thread-safe.
+  for (torch::jit::Function *function : functions)
+    function->getSchema();
+
+  std::atomic<bool> failed(false);
+  MlirDiagnosticHandlerID handlerID = mlirContextAttachDiagnosticHandler(
+      context,
+      [](MlirDiagnostic, void *userData) {
+        static_cast<std::atomic<bool> *>(userData)->store(true);
+        return mlirLogicalResultSuccess();
+      },
+      static_cast<void *>(&failed), [](void *) { return; });
+  at::parallel_for(0, functions.size(), /*grain_size=*/1,
+                   [&](int64_t begin, int64_t end) {
+                     for (int64_t i = begin; i < end && !failed; ++i) {
+                       try {
+                         importFunction(i);
+                       } catch (...) {
+                         failed = true;
+                       }
+                     }
+                   });
+  mlirContextDetachDiagnosticHandler(context, handlerID);
+
+  if (!failed)
+    return true;
+  for (MlirOperation &func : funcs) {
+    if (!mlirOperationIsNull(func))
+      mlirOperationDestroy(func);
+    func = {nullptr};
+  }
+  return false;
+}
+
 void IValueImporter::importCompilationUnit(torch::jit::CompilationUnit *cu) {
   if (compilationUnit == nullptr) {
     compilationUnit = cu;
@@ -524,57 +786,37 @@ void IValueImporter::importCompilationUnit(torch::jit::CompilationUnit *cu) {
     return;
   }
 
-  for (torch::jit::Function *function : cu->get_functions()) {
+  std::vector<torch::jit::Function *> functions = cu->get_functions();
+  std::vector<MethodAnnotation *> annotations;
+  for (torch::jit::Function *function : functions) {
     // Useful for debugging errors in free functions that end up being
     // unused. These can be missing when round-tripping through the on-disk
     // format, even though they still cause import issues when importing
     // through the larger Python session where they originate.
     // std::cerr << "NAME: " << function->qualname().qualifiedName() << "\n";
     // std::cerr << *torch::jit::toGraphFunction(function).graph();
-    MethodAnnotation *annotation =
-        annotator.getMethodAnnotationForFunction(function);
-    MlirOperation func = importJitFunctionAsFuncOp(
-        context, function,
-        [&](int argIndex) -> MlirAttribute {
-          if (!annotation || !annotation->argAnnotations.has_value()) {
-            return {nullptr};
-          }
-          c10::optional<std::vector<int64_t>> &maybeShape =
-              annotation->argAnnotations.value()[argIndex].shape;
-          c10::optional<c10::ScalarType> &maybeDtype =
-              annotation->argAnnotations.value()[argIndex].dtype;
-          bool hasValueSemantics =
-              annotation->argAnnotations.value()[argIndex].hasValueSemantics;
-
-          // TODO: Handle unranked tensors and tensors with unknown dtype (but
-          // possibly known ranks/sizes).
-          if (!maybeShape || !maybeDtype) {
-            return {nullptr};
-          }
-
-          std::vector<int64_t> shape = *maybeShape;
-          MlirType dtype = getMlirTypeForTorchScalarType(
-              mlirLocationUnknownGet(context), *maybeDtype);
-          MlirType typeBound;
-          // `std::vector`'s `.data()` method can return nullptr when the
-          // size is 0. This triggers the "nothing known about sizes" case in
-          // the C API constructor, when we want the "we know we have 0 sizes"
-          // case. So use a dummy data pointer.
-          int64_t dummy;
-          int64_t *shapeData = shape.size() == 0 ? &dummy : shape.data();
-          if (hasValueSemantics) {
-            typeBound = torchMlirTorchValueTensorTypeGet(context, shape.size(),
-                                                         shapeData, dtype);
-          } else {
-            typeBound = torchMlirTorchNonValueTensorTypeGet(
-                context, shape.size(), shapeData, dtype);
-          }
-
-          MlirNamedAttribute typeBoundAttr = toMlirNamedAttribute(
-              "torch.type_bound", mlirTypeAttrGet(typeBound));
-          return mlirDictionaryAttrGet(context, 1, &typeBoundAttr);
+    annotations.push_back(annotator.getMethodAnnotationForFunction(function));
+  }
+  std::vector<MlirOperation> funcs(functions.size(), {nullptr});
+  auto importFunction = [&](size_t i) {
+    funcs[i] = importJitFunctionAsFuncOp(
+        context, functions[i],
+        [&](int argIndex) {
+          return getArgAttribute(context, annotations[i], argIndex);
         },
         importOptions);
+  };
+  if (!importOptions.importFunctionsInParallel || functions.size() < 2 ||
+      !importInParallel(context, functions, funcs, importFunction)) {
+    for (size_t i = 0; i < functions.size(); ++i)
+      importFunction(i);
+  }
+
+  // The functions are inserted in the order of the compilation unit, however
+  // they were imported.
+  for (size_t i = 0; i < functions.size(); ++i) {
+    MlirOperation func = funcs[i];
+    MethodAnnotation *annotation = annotations[i];
     // For IValue importing, the logical linkage structure of the module
     // is determined by the object graph.
     //
@@ -587,6 +829,11 @@ void IValueImporter::importCompilationUnit(torch::jit::CompilationUnit *cu) {
     mlirOperationSetAttributeByName(
         func, toMlirStringRef("sym_visibility"),
         mlirStringAttrGet(context, toMlirStringRef("private")));
+    if (annotation && annotation->hasPreallocatedOutputs) {
+      mlirOperationSetAttributeByName(
+          func, toMlirStringRef("torch.preallocated_outputs"),
+          mlirUnitAttrGet(context));
+    }
     mlirBlockInsertOwnedOperationBefore(
         importBlock, mlirBlockGetTerminator(importBlock), func);
   }
@@ -599,6 +846,8 @@ MlirValue torch_mlir::importIValue(c10::IValue ivalue, MlirBlock block,
   // When debugging module importing, it can be useful to dump as so:
   // if (ivalue.isModule())
   //   ivalue.toModule().dump(true, false, false);
+  TensorTypeCacheScope typeCacheScope;
   IValueImporter importer(block, context, annotator, importOptions);
+  importer.prepareTensors(ivalue);
   return importer.importIValue(ivalue);
 }
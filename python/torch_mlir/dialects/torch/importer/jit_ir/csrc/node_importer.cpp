@@ -49,9 +49,16 @@ private:
   void mapResults(Node *node, MlirOperation operation);
   MlirValue lookupMappedValue(Value *jitValue);
   std::vector<MlirValue> lookupMappedValues(c10::ArrayRef<Value *> values);
+  const SchemaOperation &getOperationFor(const c10::FunctionSchema &schema);
+  const std::string &getPrimOpName(c10::Symbol kind);
 
   MlirContext context;
   std::unordered_map<Value *, MlirValue> valueMap;
+  // The op names are only built once per operator and import, since a graph
+  // mostly uses the same few operators.
+  std::unordered_map<const c10::FunctionSchema *, SchemaOperation>
+      schemaOperations;
+  std::unordered_map<c10::Symbol, std::string> primOpNames;
 };
 } // namespace
 
@@ -108,10 +115,11 @@ void NodeImporter::importNode(Node *node, MlirBlock appendToBlock,
   // Trivial ops with schema.
   auto maybeSchema = node->maybeSchema();
   if (maybeSchema) {
-    MlirOperation operation = createOperationFromSchema(
-        appendToBlock, loc, node->schema(),
+    const SchemaOperation &schemaOperation = getOperationFor(*maybeSchema);
+    MlirOperation operation = createMlirOperationAtEnd(
+        appendToBlock, schemaOperation.name, loc,
         getMlirTypesFromValues(loc, node->outputs(), importOptions),
-        lookupMappedValues(node->inputs()));
+        lookupMappedValues(node->inputs()), schemaOperation.nameAttr);
     mapResults(node, operation);
     return;
   }
@@ -123,8 +131,7 @@ void NodeImporter::importNode(Node *node, MlirBlock appendToBlock,
   case c10::prim::ListUnpack:
   case c10::prim::ListConstruct:
   case c10::prim::CreateObject: {
-    createAndMapTrivialNode(
-        node, "torch.prim." + std::string(kind.toUnqualString()), nullptr);
+    createAndMapTrivialNode(node, getPrimOpName(kind), nullptr);
     return;
   }
   case c10::prim::TupleConstruct: {
@@ -139,8 +146,7 @@ void NodeImporter::importNode(Node *node, MlirBlock appendToBlock,
           }
           return type;
         });
-    createAndMapTrivialNode(node,
-                            "torch.prim." + std::string(kind.toUnqualString()),
+    createAndMapTrivialNode(node, getPrimOpName(kind),
                             [&](std::vector<MlirValue> &inputs) {
                               assert(containedTypes.size() == inputs.size());
                               return adjustStaticInformationForValues(
@@ -150,8 +156,7 @@ void NodeImporter::importNode(Node *node, MlirBlock appendToBlock,
     return;
   }
   case c10::prim::DictConstruct: {
-    createAndMapTrivialNode(node,
-                            "torch.prim." + std::string(kind.toUnqualString()),
+    createAndMapTrivialNode(node, getPrimOpName(kind),
                             rearrangeDictConstructInputs);
     return;
   }
@@ -159,9 +164,8 @@ void NodeImporter::importNode(Node *node, MlirBlock appendToBlock,
   case c10::prim::Store:
   case c10::prim::GetAttr:
   case c10::prim::SetAttr: {
-    createAndMapNodeWithAttribute(
-        node, "torch.prim." + std::string(kind.toUnqualString()), "name",
-        importAttribute(loc, node, c10::attr::name));
+    createAndMapNodeWithAttribute(node, getPrimOpName(kind), "name",
+                                  importAttribute(loc, node, c10::attr::name));
     return;
   }
   }
@@ -426,12 +430,30 @@ NodeImporter::lookupMappedValues(c10::ArrayRef<Value *> values) {
   }
   return ret;
 }
+const SchemaOperation &
+NodeImporter::getOperationFor(const c10::FunctionSchema &schema) {
+  auto it = schemaOperations.find(&schema);
+  if (it == schemaOperations.end())
+    it = schemaOperations
+             .emplace(&schema, getOperationForSchema(context, schema))
+             .first;
+  return it->second;
+}
+const std::string &NodeImporter::getPrimOpName(c10::Symbol kind) {
+  auto it = primOpNames.find(kind);
+  if (it == primOpNames.end())
+    it = primOpNames
+             .emplace(kind, "torch.prim." + std::string(kind.toUnqualString()))
+             .first;
+  return it->second;
+}
 
 MlirBlock
 torch_mlir::importBlock(MlirContext context, Block *jitBlock,
                         CreateTerminatorFn createTerminator,
                         c10::optional<c10::ArrayRef<MlirType>> blockArgTypes,
                         const ImportOptions &importOptions) {
+  TensorTypeCacheScope typeCacheScope;
   NodeImporter importer(context);
   return importer.importBlock(jitBlock, createTerminator, blockArgTypes, importOptions);
 }
@@ -12,6 +12,7 @@
 #include "ivalue_importer.h"
 
 #include <ATen/TensorUtils.h>
+#include <c10/util/hash.h>
 #include <unordered_map>
 
 #include "mlir_utils.h"
@@ -24,6 +25,11 @@
 
 using namespace torch_mlir;
 
+// PyTorch has Float8 dtypes since version 2.1.
+#if __has_include(<c10/util/Float8_e5m2.h>)
+#define TORCH_MLIR_HAS_FLOAT8_DTYPES
+#endif
+
 static MlirType getMlirTypeForTorchScalarTypeRaw(MlirContext context,
                                                  c10::ScalarType scalarType) {
   using c10::ScalarType;
@@ -50,6 +56,12 @@ static MlirType getMlirTypeForTorchScalarTypeRaw(MlirContext context,
     return mlirBF16TypeGet(context);
   case ScalarType::Half:
     return mlirF16TypeGet(context);
+#ifdef TORCH_MLIR_HAS_FLOAT8_DTYPES
+  case ScalarType::Float8_e5m2:
+    return mlirFloat8E5M2TypeGet(context);
+  case ScalarType::Float8_e4m3fn:
+    return mlirFloat8E4M3FNTypeGet(context);
+#endif
   case ScalarType::QInt8:
     return torchMlirTorchQInt8TypeGet(context);
   case ScalarType::QUInt8:
@@ -123,6 +135,53 @@ static MlirType mapCustomClassType(MlirContext context, MlirLocation loc,
   throw mlir_diagnostic_emitted();
 }
 
+namespace {
+// Identifies a tensor type as built by `getMlirTypeFromTorchType`.
+struct TensorTypeKey {
+  void *context;
+  bool valueSemantics;
+  // -1 if the dtype is unknown.
+  int scalarType;
+  // Empty and with `ranked` unset if the tensor is unranked.
+  bool ranked;
+  std::vector<int64_t> dims;
+
+  bool operator==(const TensorTypeKey &other) const {
+    return context == other.context && valueSemantics == other.valueSemantics &&
+           scalarType == other.scalarType && ranked == other.ranked &&
+           dims == other.dims;
+  }
+};
+
+struct TensorTypeKeyHash {
+  size_t operator()(const TensorTypeKey &key) const {
+    size_t hash = c10::get_hash(key.context, key.valueSemantics,
+                                key.scalarType, key.ranked);
+    for (int64_t dim : key.dims)
+      hash = c10::hash_combine(hash, std::hash<int64_t>()(dim));
+    return hash;
+  }
+};
+} // namespace
+
+struct torch_mlir::TensorTypeCache {
+  std::unordered_map<TensorTypeKey, MlirType, TensorTypeKeyHash> types;
+};
+
+static thread_local TensorTypeCache *activeTensorTypeCache = nullptr;
+
+TensorTypeCacheScope::TensorTypeCacheScope() {
+  if (!activeTensorTypeCache) {
+    cache = std::make_unique<TensorTypeCache>();
+    activeTensorTypeCache = cache.get();
+  }
+}
+
+TensorTypeCacheScope::~TensorTypeCacheScope() {
+  if (cache)
+    activeTensorTypeCache = nullptr;
+}
+
 MlirType
 torch_mlir::getMlirTypeFromTorchType(MlirLocation loc,
                                      const c10::TypePtr &torchType,
@@ -144,6 +203,30 @@ torch_mlir::getMlirTypeFromTorchType(MlirLocation loc,
                                /*optionalDtype=*/{nullptr});
     }
 
+    // Sizes, with -1 for the dynamic dims.
+    auto &sizes = tensorType->symbolic_sizes();
+    std::vector<int64_t> dims;
+    if (sizes.rank()) {
+      dims.resize(*sizes.rank());
+      for (size_t i = 0; i < dims.size(); ++i) {
+        auto shapeSymbol = sizes[i];
+        dims[i] = shapeSymbol.is_static() ? shapeSymbol.static_size() : -1;
+      }
+    }
+
+    TensorTypeCache *cache = activeTensorTypeCache;
+    TensorTypeKey key;
+    if (cache) {
+      key = {context.ptr, importOptions.assumeTensorsHaveValueSemantics,
+             tensorType->scalarType()
+                 ? static_cast<int>(*tensorType->scalarType())
+                 : -1,
+             sizes.rank().has_value(), dims};
+      auto it = cache->types.find(key);
+      if (it != cache->types.end())
+        return it->second;
+    }
+
     // Element type.
     MlirType elementType = {nullptr};
     if (tensorType->scalarType()) {
@@ -152,35 +235,31 @@ torch_mlir::getMlirTypeFromTorchType(MlirLocation loc,
       if (mlirTypeIsNull(elementType))
         return {nullptr};
     }
-    // Sizes.
-    auto &sizes = tensorType->symbolic_sizes();
+
+    MlirType type;
     if (!sizes.rank()) {
       // Unranked.
-      return getMlirTensorType(context,
+      type = getMlirTensorType(context,
                                /*numSizes=*/-1,
                                /*optionalSizes=*/nullptr,
                                /*optionalDtype=*/
                                elementType);
+    } else {
+      // Ranked with possibly dynamic dims.
+      // `std::vector`'s `.data()` method can return nullptr when the
+      // size is 0. This triggers the "nothing known about sizes" case in
+      // the C API constructor, when we want the "we know we have 0 sizes"
+      // case. So use a dummy data pointer.
+      int64_t dummy;
+      int64_t *dimsData = dims.size() == 0 ? &dummy : dims.data();
+      type = getMlirTensorType(context, dims.size(),
+                               /*optionalSizes=*/dimsData,
+                               /*optionalDtype=*/
+                               elementType);
     }
-    // Ranked with possibly dynamic dims.
-    auto &symbolicShape = tensorType->symbolic_sizes();
-    std::vector<int64_t> dims;
-    dims.resize(*sizes.rank());
-    for (size_t i = 0; i < dims.size(); ++i) {
-      auto shapeSymbol = symbolicShape[i];
-      dims[i] = shapeSymbol.is_static() ? shapeSymbol.static_size() : -1;
-    }
-
-    // `std::vector`'s `.data()` method can return nullptr when the
-    // size is 0. This triggers the "nothing known about sizes" case in
-    // the C API constructor, when we want the "we know we have 0 sizes"
-    // case. So use a dummy data pointer.
-    int64_t dummy;
-    int64_t *dimsData = dims.size() == 0 ? &dummy : dims.data();
-    return getMlirTensorType(context, dims.size(),
-                             /*optionalSizes=*/dimsData,
-                             /*optionalDtype=*/
-                             elementType);
+    if (cache)
+      cache->types.emplace(std::move(key), type);
+    return type;
   }
   case TypeKind::IntType: {
     return torchMlirTorchIntTypeGet(context);
@@ -289,8 +368,25 @@ torch_mlir::getFunctionTypeFromSchema(MlirContext context,
                              outputTypes.size(), outputTypes.data());
 }
 
-MlirAttribute torch_mlir::convertTensorToMlirElementsAttr(at::Tensor tensor,
-                                                          MlirLocation loc) {
+at::Tensor torch_mlir::prepareTensorForElementsAttr(at::Tensor tensor) {
+  // Sparse tensors are imported from their dense values, see
+  // `getMlirSparsityForTensor`.
+  if (tensor.layout() != c10::Layout::Strided)
+    tensor = tensor.to_dense();
+  // Get a C-contiguous form as we can bulk-load that into a DenseElementsAttr.
+  at::Tensor prepared = tensor.cpu().contiguous();
+  // The bool DenseElementsAttr builder reads an `int` per element.
+  // TODO: The signature of `mlirDenseElementsAttrBoolGet` should be changed
+  // upstream to take in a `const bool *` rather than a `const int *` to avoid
+  // the unnecessary copying into an array four times as large.
+  if (prepared.scalar_type() == at::ScalarType::Bool)
+    prepared = prepared.to(at::ScalarType::Int);
+  return prepared;
+}
+
+MlirAttribute
+torch_mlir::convertTensorToMlirElementsAttr(at::Tensor tensor, MlirLocation loc,
+                                            c10::optional<at::Tensor> prepared) {
   using at::ScalarType;
 
   auto throwUnsupportedTensorError = [&]() {
@@ -299,10 +395,6 @@ MlirAttribute torch_mlir::convertTensorToMlirElementsAttr(at::Tensor tensor,
     throw std::invalid_argument(msg.str());
   };
 
-  // Get a C-contiguous form as we can bulk-load that into a DenseElementsAttr.
-  if (!tensor.is_contiguous())
-    tensor = tensor.contiguous();
-
   // The flat number of bytes throws an exception for tensors that are not
   // dense and accessible as such.
   at::checkLayout(at::CheckedFrom("accessing contiguous"), tensor,
@@ -326,7 +418,8 @@ MlirAttribute torch_mlir::convertTensorToMlirElementsAttr(at::Tensor tensor,
   // Import DenseElementsAttr data.
   // TODO: More import formats in C-API.
   auto numElements = tensor.numel();
-  auto tensor_cpu = tensor.cpu().contiguous();
+  at::Tensor tensor_cpu =
+      prepared ? *prepared : prepareTensorForElementsAttr(tensor);
   auto tensorData = tensor_cpu.data_ptr();
   switch (tensor.scalar_type()) {
   case ScalarType::Int:
@@ -345,15 +438,10 @@ MlirAttribute torch_mlir::convertTensorToMlirElementsAttr(at::Tensor tensor,
     return mlirDenseElementsAttrDoubleGet(
         shapedType, numElements, static_cast<const double *>(tensorData));
     break;
-  case ScalarType::Bool: {
-    // TODO: The signature of `mlirDenseElementsAttrBoolGet` should be changed
-    // upstream to take in a `const bool *` rather than a `const int *` to avoid
-    // the unnecessary copying into an array four times as large.
-    const int8_t *elements = static_cast<const int8_t *>(tensorData);
-    std::vector<int> tensorDataVector(elements, elements + numElements);
+  case ScalarType::Bool:
     return mlirDenseElementsAttrBoolGet(shapedType, numElements,
-                                        tensorDataVector.data());
-  } break;
+                                        static_cast<const int *>(tensorData));
+    break;
   case ScalarType::QInt8:
     return mlirDenseElementsAttrInt8Get(
         shapedType, numElements, static_cast<const int8_t *>(tensorData));
@@ -372,6 +460,14 @@ MlirAttribute torch_mlir::convertTensorToMlirElementsAttr(at::Tensor tensor,
   case ScalarType::Char:
     return mlirDenseElementsAttrInt8Get(
         shapedType, numElements, static_cast<const int8_t *>(tensorData));
+#ifdef TORCH_MLIR_HAS_FLOAT8_DTYPES
+  // There are no builders taking Float8 elements, but their bytes are laid
+  // out as the attribute stores them.
+  case ScalarType::Float8_e5m2:
+  case ScalarType::Float8_e4m3fn:
+    return mlirDenseElementsAttrRawBufferGet(shapedType, numElements,
+                                             tensorData);
+#endif
 
   default:
     throwUnsupportedTensorError();
@@ -379,6 +475,93 @@ MlirAttribute torch_mlir::convertTensorToMlirElementsAttr(at::Tensor tensor,
   return {nullptr}; // Unreachable.
 }
 
+MlirAttribute
+torch_mlir::convertTensorToMlirDenseResourceAttr(at::Tensor tensor,
+                                                 const std::string &name,
+                                                 MlirLocation loc) {
+  // We can only reference the storage in place if it already has the layout
+  // that a builtin tensor attribute expects. Bool tensors are excluded since
+  // their in-memory format (one byte per element) is not the one that MLIR
+  // uses for `i1` element data.
+  if (!tensor.is_contiguous() || !tensor.device().is_cpu() ||
+      tensor.layout() != c10::Layout::Strided || tensor.numel() == 0 ||
+      tensor.scalar_type() == at::ScalarType::Bool)
+    return {nullptr};
+
+  MlirType elementType = getMlirTypeForTorchScalarType(
+      loc, c10::toUnderlying(tensor.scalar_type()));
+  std::vector<int64_t> shape(tensor.sizes().begin(), tensor.sizes().end());
+  MlirType shapedType = mlirRankedTensorTypeGetChecked(
+      loc, shape.size(), shape.data(), elementType, {nullptr});
+  if (mlirTypeIsNull(shapedType))
+    return {nullptr};
+
+  // The blob holds a reference to the tensor, which keeps its storage alive
+  // for as long as the context needs the data.
+  auto *owner = new at::Tensor(tensor);
+  return mlirUnmanagedDenseResourceElementsAttrGet(
+      shapedType, toMlirStringRef(name), owner->data_ptr(), owner->nbytes(),
+      owner->element_size(), /*dataIsMutable=*/false,
+      [](void *userData, const void *data, size_t size, size_t align) {
+        delete static_cast<at::Tensor *>(userData);
+      },
+      owner);
+}
+
+MlirAttribute torch_mlir::getMlirSparsityForTensor(const at::Tensor &tensor,
+                                                   MlirLocation loc) {
+  auto throwUnsupportedLayoutError = [&]() {
+    std::stringstream msg;
+    msg << "Unsupported sparse tensor layout '" << tensor.layout()
+        << "' with sizes " << tensor.sizes();
+    throw std::invalid_argument(msg.str());
+  };
+
+  std::vector<std::string> levels;
+  std::string dimOrdering;
+  switch (tensor.layout()) {
+  case c10::Layout::Strided:
+    return {nullptr};
+  case c10::Layout::Sparse:
+    // A COO tensor stores the coordinates of its nonzeros, which is a
+    // non-unique compressed level followed by singleton levels. Hybrid
+    // tensors, with dense trailing dimensions, are not supported.
+    if (tensor.dense_dim() != 0)
+      throwUnsupportedLayoutError();
+    levels.push_back(tensor.dim() == 1 ? "compressed" : "compressed-nu");
+    for (int64_t i = 1; i < tensor.dim(); ++i)
+      levels.push_back(i + 1 == tensor.dim() ? "singleton" : "singleton-nu");
+    break;
+  case c10::Layout::SparseCsr:
+  case c10::Layout::SparseCsc:
+    // Batched and hybrid compressed tensors aren't supported.
+    if (tensor.dim() != 2)
+      throwUnsupportedLayoutError();
+    levels = {"dense", "compressed"};
+    if (tensor.layout() == c10::Layout::SparseCsc)
+      dimOrdering = ", dimOrdering = affine_map<(i, j) -> (j, i)>";
+    break;
+  default:
+    throwUnsupportedLayoutError();
+  }
+
+  std::stringstream encoding;
+  encoding << "#sparse_tensor.encoding<{ dimLevelType = [ ";
+  for (size_t i = 0; i < levels.size(); ++i)
+    encoding << (i ? ", \"" : "\"") << levels[i] << "\"";
+  encoding << " ]" << dimOrdering << " }>";
+  MlirContext context = mlirLocationGetContext(loc);
+  MlirAttribute sparsity =
+      mlirAttributeParseGet(context, toMlirStringRef(encoding.str()));
+  if (mlirAttributeIsNull(sparsity)) {
+    std::stringstream msg;
+    msg << "could not create the sparse tensor encoding " << encoding.str();
+    mlirEmitError(loc, msg.str().c_str());
+    throw mlir_diagnostic_emitted();
+  }
+  return sparsity;
+}
+
 MlirAttribute torch_mlir::importAttribute(MlirLocation loc,
                                           torch::jit::Node *node,
                                           c10::Symbol symbol) {
@@ -464,13 +647,9 @@ std::vector<MlirValue> torch_mlir::adjustStaticInformationForValues(
   return ret;
 }
 
-MlirOperation
-torch_mlir::createOperationFromSchema(MlirBlock appendToBlock, MlirLocation loc,
-                                      const c10::FunctionSchema &schema,
-                                      c10::ArrayRef<MlirType> resultTypes,
-                                      c10::ArrayRef<MlirValue> operands) {
-  MlirContext context = mlirLocationGetContext(loc);
-
+SchemaOperation
+torch_mlir::getOperationForSchema(MlirContext context,
+                                  const c10::FunctionSchema &schema) {
   // Munge the name into the appropriate MLIR operation name.
   // See torch_ods_gen.py:JitOperator for the logic used to construct the MLIR
   // op name from the schema. This logic must be kept in sync with that logic.
@@ -484,10 +663,8 @@ torch_mlir::createOperationFromSchema(MlirBlock appendToBlock, MlirLocation loc,
   }
   std::string opName = "torch." + opNameSuffix;
   // If we have a registered op, use it!
-  if (mlirContextIsRegisteredOperation(context, toMlirStringRef(opName))) {
-    return createMlirOperationAtEnd(appendToBlock, opName, loc, resultTypes,
-                                    operands);
-  }
+  if (mlirContextIsRegisteredOperation(context, toMlirStringRef(opName)))
+    return {opName, c10::nullopt};
   // Oops, no registered op -- create an opaque wrapper so that import can
   // still succeed. This helps a common use case of filling out registered ops
   // support, where it is easier to iterate on an MLIR file with
@@ -497,8 +674,19 @@ torch_mlir::createOperationFromSchema(MlirBlock appendToBlock, MlirLocation loc,
   // - Makes the dialect overall less strict
   // - Makes it hard to see exactly which ops from a model are registered or
   //   not.
-  return createMlirOperationAtEnd(
-      appendToBlock, "torch.operator", loc, resultTypes, operands,
-      toMlirNamedAttribute(
-          "name", mlirStringAttrGet(context, toMlirStringRef(opNameSuffix))));
+  return {"torch.operator",
+          toMlirNamedAttribute(
+              "name",
+              mlirStringAttrGet(context, toMlirStringRef(opNameSuffix)))};
+}
+
+MlirOperation
+torch_mlir::createOperationFromSchema(MlirBlock appendToBlock, MlirLocation loc,
+                                      const c10::FunctionSchema &schema,
+                                      c10::ArrayRef<MlirType> resultTypes,
+                                      c10::ArrayRef<MlirValue> operands) {
+  SchemaOperation operation =
+      getOperationForSchema(mlirLocationGetContext(loc), schema);
+  return createMlirOperationAtEnd(appendToBlock, operation.name, loc,
+                                  resultTypes, operands, operation.nameAttr);
 }
@@ -13,6 +13,7 @@
 #include "import_options.h"
 
 #include <memory>
+#include <string>
 
 #include "mlir-c/IR.h"
 
@@ -41,6 +42,23 @@ public:
 MlirType getMlirTypeForTorchScalarType(MlirLocation loc,
                                        c10::ScalarType scalarType);
 
+struct TensorTypeCache;
+
+/// Caches the tensor types built by `getMlirTypeFromTorchType` on this thread
+/// for as long as it is alive. The values of a graph mostly have the same few
+/// types, which are then only built once per import. Scopes nested in another
+/// one share its cache. Each import entry point opens a scope, so types are
+/// never reused across imports, whose contexts may differ.
+class TensorTypeCacheScope {
+public:
+  TensorTypeCacheScope();
+  ~TensorTypeCacheScope();
+
+private:
+  // Null if this scope is nested in another one.
+  std::unique_ptr<TensorTypeCache> cache;
+};
+
 /// Maps a torch type to a corresponding MlirType. Returns a null type
 /// on failure and emits a diagnostic.
 MlirType getMlirTypeFromTorchType(MlirLocation loc,
@@ -55,9 +73,32 @@ MlirType getFunctionTypeFromSchema(MlirContext context,
                                    const c10::FunctionSchema &schema,
                                    const ImportOptions &importOptions = {});
 
+/// Returns a contiguous CPU tensor holding the values of `tensor` in the
+/// layout that `convertTensorToMlirElementsAttr` reads them in. This does not
+/// use the MLIR context, so it can be run for several tensors in parallel.
+at::Tensor prepareTensorForElementsAttr(at::Tensor tensor);
+
 /// Creates an appropriate MlirAttribute that holds the same values as `tensor`.
-MlirAttribute convertTensorToMlirElementsAttr(at::Tensor tensor,
-                                              MlirLocation loc);
+/// `prepared` is the result of `prepareTensorForElementsAttr(tensor)`, which
+/// is computed here if it isn't given.
+MlirAttribute
+convertTensorToMlirElementsAttr(at::Tensor tensor, MlirLocation loc,
+                                c10::optional<at::Tensor> prepared = {});
+
+/// Creates a `dense_resource` attribute named `name` that references the
+/// storage of `tensor` instead of copying it. Returns a null attribute if the
+/// storage cannot be referenced in place (e.g. it is not contiguous or not on
+/// the CPU), in which case `convertTensorToMlirElementsAttr` should be used.
+MlirAttribute convertTensorToMlirDenseResourceAttr(at::Tensor tensor,
+                                                   const std::string &name,
+                                                   MlirLocation loc);
+
+/// Creates the `#sparse_tensor.encoding` attribute describing the layout of
+/// a `torch.sparse_coo`, `torch.sparse_csr` or `torch.sparse_csc` tensor.
+/// Returns a null attribute for strided tensors, and throws for the other
+/// layouts.
+MlirAttribute getMlirSparsityForTensor(const at::Tensor &tensor,
+                                       MlirLocation loc);
 
 MlirAttribute importAttribute(MlirLocation loc, torch::jit::Node *node,
                               c10::Symbol symbol);
@@ -74,11 +115,25 @@ std::vector<MlirValue> adjustStaticInformationForValues(
     MlirBlock appendToBlock, MlirLocation loc, c10::ArrayRef<MlirValue> values,
     c10::ArrayRef<MlirType> desiredTypes, bool userAllowsRefinement);
 
-/// Create the appropriate MLIR operation for the Torch operator with schema
-/// "schema".
+/// The MLIR operation that a Torch operator is imported as.
+struct SchemaOperation {
+  /// The name of the registered op, or "torch.operator" if there is none.
+  std::string name;
+  /// The "name" attribute of a "torch.operator" op.
+  c10::optional<MlirNamedAttribute> nameAttr;
+};
+
+/// Returns the MLIR operation that the Torch operator with schema "schema" is
+/// imported as.
 ///
 /// The primary difficulty here is doing the appropriate name munging and
-/// checking if the have a registered op.
+/// checking if the have a registered op. Importers of many nodes should cache
+/// the result rather than query it for each node.
+SchemaOperation getOperationForSchema(MlirContext context,
+                                      const c10::FunctionSchema &schema);
+
+/// Create the appropriate MLIR operation for the Torch operator with schema
+/// "schema", see getOperationForSchema.
 MlirOperation createOperationFromSchema(MlirBlock appendToBlock,
                                         MlirLocation loc,
                                         const c10::FunctionSchema &schema,
@@ -42,6 +42,9 @@ def _recursively_extract_annotations(
             class_annotator.annotateArgs(
                 scripted._c._type(), [method_name],
                 method._torch_mlir_arg_annotations)
+        if hasattr(method, '_torch_mlir_preallocated_outputs'):
+            class_annotator.annotatePreallocatedOutputs(
+                scripted._c._type(), [method_name])
     # Recurse.
     for name, child in module.named_children():
         scripted_child = getattr(scripted, name)
@@ -3,7 +3,8 @@
 # SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 # Also available under a BSD-style license. See LICENSE.
 
-from typing import List
+from collections import OrderedDict
+from typing import Dict, List, Optional, Sequence, Union
 
 import torch
 from torch._functorch.compile_utils import strip_overloads
@@ -11,6 +12,10 @@ from torch._decomp import get_decompositions
 from torch._dynamo.backends.common import aot_autograd
 import functorch
 
+from torch_mlir import BACKEND_LEGAL_OPS, OutputType, _lower_mlir_module
+from torch_mlir._dynamo_fx_importer import import_fx_graphs_as_funcs
+from torch_mlir.compiler_utils import run_pipeline_with_repro_report
+
 import warnings
 # https://github.com/pytorch/pytorch/issues/89064
 warnings.filterwarnings("ignore", module="torch.jit._check")
@@ -49,7 +54,6 @@ def _get_decomposition_table():
         # (the upstream decomposition we use here does), even though we have
         # support for aten.native_batch_norm_backward.
         aten._native_batch_norm_legit_functional,
-        aten.native_group_norm,
         aten.split.Tensor,
         aten.split_with_sizes,
         aten.norm.ScalarOpt_dim,
@@ -112,25 +116,135 @@ def _adjust_calling_convention(gm: torch.fx.GraphModule) -> bool:
     return did_unwrap_single_element, did_convert_list_to_tuple
 
 
-def make_simple_dynamo_backend(user_backend):
+def _describe_tensors(value) -> Optional[str]:
+    """Returns the dtypes and sizes of a (FakeTensor) value of a graph, or
+    None if they aren't static."""
+    if isinstance(value, torch.Tensor):
+        if not all(isinstance(d, int) for d in value.shape):
+            return None
+        return f"{value.dtype}{list(value.shape)}"
+    if isinstance(value, (tuple, list)):
+        elements = [_describe_tensors(v) for v in value]
+        if any(e is None for e in elements):
+            return None
+        return f"({', '.join(elements)})"
+    return None
+
+
+def _describe_target(target) -> Optional[str]:
+    if isinstance(target, str):
+        return target
+    if isinstance(target, torch._ops.OpOverload):
+        return str(target)
+    qualname = getattr(target, "__qualname__", None)
+    if qualname is None:
+        return None
+    return f"{getattr(target, '__module__', None)}.{qualname}"
+
+
+def _graph_cache_key(gm: torch.fx.GraphModule,
+                     example_inputs: List[torch.Tensor]) -> Optional[str]:
+    """Returns a key that is equal for graphs that only differ by the names of
+    their nodes, or None if the graph can't be keyed reliably.
+
+    The nodes are numbered in order, and each of them is described by its
+    target, its arguments in terms of these numbers, and the dtypes and sizes
+    of its values, so graphs with the same key compile to the same code.
+    Graphs reading attributes, calling modules or holding tensor literals
+    depend on more than their nodes and aren't keyed.
+    """
+    numbering: Dict[torch.fx.Node, str] = {}
+
+    def describe_argument(arg) -> Optional[str]:
+        if isinstance(arg, torch.fx.Node):
+            return numbering[arg]
+        if isinstance(arg, (tuple, list)):
+            elements = [describe_argument(a) for a in arg]
+            if any(e is None for e in elements):
+                return None
+            return f"{type(arg).__name__}({', '.join(elements)})"
+        if arg is None or isinstance(
+                arg, (bool, int, float, str, torch.dtype, torch.device,
+                      torch.memory_format, torch.layout)):
+            return repr(arg)
+        return None
+
+    parts = [_describe_tensors(list(example_inputs))]
+    for node in gm.graph.nodes:
+        if node.op not in ("placeholder", "call_function", "output"):
+            return None
+        numbering[node] = f"%{len(numbering)}"
+        target = _describe_target(node.target)
+        arguments = [describe_argument(arg) for arg in node.args]
+        kwargs = [(name, describe_argument(arg))
+                  for name, arg in sorted(node.kwargs.items())]
+        if target is None or None in arguments or \
+                any(arg is None for _, arg in kwargs):
+            return None
+        arguments += [f"{name}={arg}" for name, arg in kwargs]
+        parts.append(f"{node.op} {target}({', '.join(arguments)})")
+        if node.op != "output":
+            parts.append(_describe_tensors(node.meta.get("val")))
+    if None in parts:
+        return None
+    return "\n".join(parts)
+
+
+def make_simple_dynamo_backend(user_backend=None, *,
+                               max_cached_graphs: int = 0):
     """Wrapper for functions intended to be used as TorchDynamo backends.
 
     This function simplifies a few of the steps that are required to make
     TorchDynamo work with Torch-MLIR.
 
+    Can be used as `@make_simple_dynamo_backend` or, to pass options, as
+    `@make_simple_dynamo_backend(max_cached_graphs=...)`.
+
     Args:
         user_backend: A function with the signature used by ordinary
             TorchDynamo backends. But the torch.fx.GraphModule passed to it
             will be normalized for consumption by `torch_mlir.compile`.
+        max_cached_graphs: If positive, the callables that `user_backend`
+            returns are kept for up to this many of the most recently
+            compiled graphs, and reused for graphs that only differ from one
+            of them by the names of their nodes. Dynamo compiles such graphs
+            again e.g. for other functions or instances of a model with the
+            same code, after a reset, or when sizes alternate and exceed its
+            own cache. The imported graphs are statically shaped, so graphs
+            with other sizes are compiled separately. `user_backend` must
+            then only depend on the graph and on the dtypes and sizes of the
+            example inputs.
     Returns:
         A function with the signature used by TorchDynamo backends.
     """
+    if user_backend is None:
+        return lambda user_backend: make_simple_dynamo_backend(
+            user_backend, max_cached_graphs=max_cached_graphs)
+
+    # Maps the keys of the recently compiled graphs to their callables, from
+    # the least to the most recently used.
+    compiled_graphs = OrderedDict()
+
+    def compile_graph(gm: torch.fx.GraphModule,
+                      example_inputs: List[torch.Tensor]):
+        key = _graph_cache_key(gm, example_inputs) \
+            if max_cached_graphs > 0 else None
+        if key is not None and key in compiled_graphs:
+            compiled_graphs.move_to_end(key)
+            return compiled_graphs[key]
+        strip_overloads(gm)
+        user_callable = user_backend(gm, example_inputs)
+        if key is not None:
+            compiled_graphs[key] = user_callable
+            if len(compiled_graphs) > max_cached_graphs:
+                compiled_graphs.popitem(last=False)
+        return user_callable
+
     def wrapper_backend(gm: torch.fx.GraphModule,
                         example_inputs: List[torch.Tensor]):
         did_unwrap_single_element, did_convert_list_to_tuple = \
             _adjust_calling_convention(gm)
-        strip_overloads(gm)
-        user_callable = user_backend(gm, example_inputs)
+        user_callable = compile_graph(gm, example_inputs)
 
         # TODO: Have a consistent story about the boxed calling convention.
         # (for more details on this remove this decorator and look at the warning)
@@ -146,3 +260,53 @@ def make_simple_dynamo_backend(user_backend):
         return dynamo_callable
     return aot_autograd(fw_compiler=wrapper_backend,
                         decompositions=_get_decomposition_table)
+
+
+def compile_fx_graphs(graphs: Dict[str, torch.fx.GraphModule],
+                      output_type: Union[str, OutputType] = OutputType.TORCH,
+                      module_name: str = "graphs",
+                      backend_legal_ops: Optional[Sequence[str]] = None,
+                      verbose: bool = False):
+    """Compiles several FX graphs, such as the graph breaks of a model, as
+    the functions of one MLIR module.
+
+    Compiling the graphs one at a time pays for creating a context, loading
+    the dialects, parsing the abstract interpretation library and building
+    the pass managers for each of them. Here they are paid once, and the
+    passes that work on one function at a time process the graphs in
+    parallel. The module can be loaded once and each graph called by its
+    name, e.g. `getattr(invoker, name)` with the RefBackend.
+
+    Args:
+        graphs: The graphs to compile, keyed by the name of the function to
+            compile each of them into. They must be in the form that
+            `make_simple_dynamo_backend` passes to its `user_backend`.
+        output_type: The kind of output to produce, as for
+            `torch_mlir.compile`.
+        module_name: The debug name of the module.
+        backend_legal_ops: As for `torch_mlir.compile`.
+        verbose: If true, print the IR after each step.
+    Returns:
+        An MLIR module with one function per graph.
+    """
+    output_type = OutputType.get(output_type)
+    if backend_legal_ops is not None:
+        if output_type != OutputType.TORCH:
+            raise Exception("`backend_legal_ops` is only valid with the "
+                            "`torch` output type")
+        backend_legal_ops = list(sorted(set(backend_legal_ops)))
+    else:
+        backend_legal_ops = BACKEND_LEGAL_OPS.get(output_type, [])
+
+    for gm in graphs.values():
+        strip_overloads(gm)
+    module = import_fx_graphs_as_funcs(
+        [(gm.graph, name) for name, gm in graphs.items()], module_name)
+    # The graphs don't depend on each other, so the ones that satisfy the
+    # backend contract early are set aside while the others are simplified.
+    run_pipeline_with_repro_report(
+        module,
+        "builtin.module(torch-lower-to-backend-contract{incremental=true "
+        "backend-legal-ops=" + ",".join(backend_legal_ops) + "})",
+        "Lowering TorchFX IR -> Torch Backend IR")
+    return _lower_mlir_module(verbose, output_type, module)
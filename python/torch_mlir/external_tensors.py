@@ -0,0 +1,136 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+"""Streaming of the tensors of an imported module into external storage.
+
+When a module is imported with `ImportOptions.externalizeTensors`, its
+tensors are imported as `torch.tensor.external` ops that only carry a name,
+and the module stays small no matter how large the model is. This writes the
+contents of those tensors to a safetensors file, indexed by the same names, a
+chunk at a time. No copy of a whole tensor is ever made, even for tensors that
+are not contiguous or not on the CPU, so the memory used on top of the model
+is bounded by the chunk size. With a model whose storage is memory mapped
+(e.g. with `torch.load(..., mmap=True)`), the model itself never has to be
+resident either.
+"""
+
+import json
+import struct
+from typing import BinaryIO, Dict, Iterator, List
+
+import torch
+
+_EXTERNAL_TENSOR_OPS = ("torch.tensor.external", "torch.vtensor.external")
+
+_SAFETENSORS_DTYPES = {
+    torch.float64: "F64",
+    torch.float32: "F32",
+    torch.float16: "F16",
+    torch.bfloat16: "BF16",
+    torch.int64: "I64",
+    torch.int32: "I32",
+    torch.int16: "I16",
+    torch.int8: "I8",
+    torch.uint8: "U8",
+    torch.bool: "BOOL",
+}
+if hasattr(torch, "float8_e5m2"):
+    _SAFETENSORS_DTYPES[torch.float8_e5m2] = "F8_E5M2"
+    _SAFETENSORS_DTYPES[torch.float8_e4m3fn] = "F8_E4M3"
+
+# The default size of the chunks that tensors are written in.
+DEFAULT_CHUNK_BYTES = 64 * 1024 * 1024
+
+
+def get_external_tensor_names(module) -> List[str]:
+    """Returns the names of the external tensors of the MLIR module `module`,
+    in the order in which they appear."""
+    names = []
+
+    def walk(operation):
+        if operation.name in _EXTERNAL_TENSOR_OPS:
+            names.append(operation.attributes["name"].value)
+        for region in operation.regions:
+            for block in region.blocks:
+                for op in block.operations:
+                    walk(op.operation)
+
+    walk(module.operation)
+    return names
+
+
+def _iter_chunks(tensor: torch.Tensor,
+                 chunk_bytes: int) -> Iterator[torch.Tensor]:
+    """Yields views of `tensor` that cover it in row-major order, each of
+    them at most `chunk_bytes` large unless it is a single element."""
+    if tensor.dim() == 0 or \
+            tensor.numel() * tensor.element_size() <= chunk_bytes:
+        yield tensor
+        return
+    row_bytes = tensor[0].numel() * tensor.element_size()
+    rows_per_chunk = max(1, chunk_bytes // row_bytes)
+    for start in range(0, tensor.shape[0], rows_per_chunk):
+        if rows_per_chunk == 1:
+            yield from _iter_chunks(tensor[start], chunk_bytes)
+        else:
+            yield tensor[start:start + rows_per_chunk]
+
+
+def _write_tensor(f: BinaryIO, tensor: torch.Tensor, chunk_bytes: int):
+    for chunk in _iter_chunks(tensor, chunk_bytes):
+        data = chunk.contiguous().cpu().reshape(-1).view(torch.uint8)
+        f.write(data.numpy().data)
+
+
+def save_external_tensors(module, model: torch.nn.Module, path: str,
+                          chunk_bytes: int = DEFAULT_CHUNK_BYTES):
+    """Writes the contents of the external tensors of the imported `module`
+    to the safetensors file `path`.
+
+    Args:
+        module: The MLIR module imported from `model` with
+            `ImportOptions.externalizeTensors`.
+        model: The model that `module` was imported from. The names of the
+            external tensors are keys of its `state_dict()`.
+        path: The file to write.
+        chunk_bytes: The size of the chunks that tensors are copied and
+            written in.
+    """
+    state_dict: Dict[str, torch.Tensor] = model.state_dict(keep_vars=True)
+    names = get_external_tensor_names(module)
+    missing = [name for name in names if name not in state_dict]
+    if missing:
+        raise ValueError(
+            "external tensors that are not in the state dict of the model: " +
+            ", ".join(missing))
+
+    tensors = {}
+    header = {}
+    offset = 0
+    for name in names:
+        tensor = state_dict[name].detach()
+        # Quantized tensors are externalized as their integer representation.
+        if tensor.is_quantized:
+            tensor = tensor.int_repr()
+        if tensor.dtype not in _SAFETENSORS_DTYPES:
+            raise ValueError(
+                f"unsupported dtype {tensor.dtype} of external tensor {name}")
+        num_bytes = tensor.numel() * tensor.element_size()
+        tensors[name] = tensor
+        header[name] = {
+            "dtype": _SAFETENSORS_DTYPES[tensor.dtype],
+            "shape": list(tensor.shape),
+            "data_offsets": [offset, offset + num_bytes],
+        }
+        offset += num_bytes
+
+    # The header is padded with spaces to keep the data 8-byte aligned.
+    header_bytes = json.dumps(header, separators=(",", ":")).encode()
+    header_bytes += b" " * (-len(header_bytes) % 8)
+    with open(path, "wb") as f:
+        f.write(struct.pack("<Q", len(header_bytes)))
+        f.write(header_bytes)
+        for tensor in tensors.values():
+            _write_tensor(f, tensor, chunk_bytes)
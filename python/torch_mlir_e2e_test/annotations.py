@@ -24,6 +24,7 @@ import torch
 # `torch_mlir/torchscript_annotations.py`.
 TORCH_MLIR_EXPORT_ATTR_NAME = '_torch_mlir_export'
 TORCH_MLIR_ARG_ANNOTATIONS_ATTR_NAME = '_torch_mlir_arg_annotations'
+TORCH_MLIR_PREALLOCATED_OUTPUTS_ATTR_NAME = '_torch_mlir_preallocated_outputs'
 
 
 def export(fn):
@@ -60,6 +61,18 @@ def annotate_args(annotations: List[Optional[ArgAnnotation]]):
       indicated by using `-1` as the size. This provides the compiler a
       guarantee that the argument will always dynamically have the described
       shape and dtype.
+    - A 3-tuple whose last element tells whether the argument has value
+      semantics, such as `([2, 3, 4], torch.float32, True)`.
+    - A 4-tuple whose last element tells whether the argument is donated,
+      such as `([2, 3, 4], torch.float32, True, True)`. The caller promises
+      not to use a donated argument after the call, so that the compiler can
+      reuse its storage, such as for the results.
+    - A 5-tuple whose last element is the sharding of the argument in the
+      textual HLO sharding syntax, or None, such as
+      `([4, 8], torch.float32, True, False, "{devices=[2,1]0,1}")` for an
+      argument split along its first dimension across two devices. It is
+      emitted as the `mhlo.sharding` of the argument when lowering to
+      StableHLO, for XLA's SPMD partitioner.
     """
 
     # TODO: Check the number of arguments matches the number of arg annotations.
@@ -68,3 +81,15 @@ def annotate_args(annotations: List[Optional[ArgAnnotation]]):
         return fn
 
     return decorator
+
+
+def preallocated_outputs(fn):
+    """Decorator that tells the torch-mlir compiler that the callers of a
+    method provide the buffers its results are written into.
+
+    Backends that support it then compile the method with a
+    destination-passing calling convention. Combined with donated arguments
+    (see `annotate_args`), this lets a result be written over an argument.
+    """
+    setattr(fn, TORCH_MLIR_PREALLOCATED_OUTPUTS_ATTR_NAME, True)
+    return fn
@@ -0,0 +1,152 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+"""
+Timing of the e2e tests, to track the performance of the code that each
+`TestConfig` produces.
+
+Each test is compiled once, and its golden trace is then run a few times to
+warm up, and a number of times more to be timed. The same trace is timed with
+the original program in PyTorch eager mode, so that the results of different
+configs and machines can be compared as speedups over eager mode.
+"""
+
+import json
+import statistics
+import sys
+import time
+import traceback
+from typing import Any, Dict, List, NamedTuple, Optional, TextIO
+
+import torch
+
+from .framework import Test, TestConfig, generate_golden_trace
+from .configs.native_torch import NativeTorchTestConfig
+
+
+class TimingStats(NamedTuple):
+    """Statistics of the times, in seconds, of repeated runs."""
+    min: float
+    median: float
+    mean: float
+
+    @staticmethod
+    def from_times(times: List[float]) -> "TimingStats":
+        return TimingStats(min=min(times),
+                           median=statistics.median(times),
+                           mean=statistics.mean(times))
+
+
+class BenchmarkResult(NamedTuple):
+    # Name of the test.
+    unique_name: str
+    # The time it took `TestConfig.compile` to compile the program, in
+    # seconds.
+    compile_time: Optional[float]
+    # The times of running the golden trace with the compiled program.
+    run_time: Optional[TimingStats]
+    # The times of running the golden trace with the original program in
+    # PyTorch eager mode.
+    eager_run_time: Optional[TimingStats]
+    # If compiling or running the program failed, the error.
+    error: Optional[str]
+
+    @property
+    def speedup_over_eager(self) -> Optional[float]:
+        """How many times faster the compiled program runs than eager mode,
+        comparing the medians."""
+        if self.run_time is None or self.eager_run_time is None or \
+                self.run_time.median == 0:
+            return None
+        return self.eager_run_time.median / self.run_time.median
+
+
+def _time_runs(config: TestConfig, artifact: Any, trace, warmup: int,
+               repetitions: int) -> TimingStats:
+    for _ in range(warmup):
+        config.run(artifact, trace)
+    times = []
+    for _ in range(repetitions):
+        start = time.perf_counter()
+        config.run(artifact, trace)
+        times.append(time.perf_counter() - start)
+    return TimingStats.from_times(times)
+
+
+def benchmark_test(test: Test, config: TestConfig, warmup: int = 3,
+                   repetitions: int = 10) -> BenchmarkResult:
+    """Times compiling `test` with `config`, and running its golden trace
+    with the result and in eager mode."""
+    compile_time = None
+    run_time = None
+    try:
+        golden_trace = generate_golden_trace(test)
+        start = time.perf_counter()
+        artifact = config.compile(test.program_factory())
+        compile_time = time.perf_counter() - start
+        run_time = _time_runs(config, artifact, golden_trace, warmup,
+                              repetitions)
+        eager = NativeTorchTestConfig()
+        eager_run_time = _time_runs(eager,
+                                    eager.compile(test.program_factory()),
+                                    golden_trace, warmup, repetitions)
+    except Exception as e:
+        return BenchmarkResult(unique_name=test.unique_name,
+                               compile_time=compile_time,
+                               run_time=run_time,
+                               eager_run_time=None,
+                               error="".join(
+                                   traceback.format_exception(
+                                       type(e), e, e.__traceback__)))
+    return BenchmarkResult(unique_name=test.unique_name,
+                           compile_time=compile_time,
+                           run_time=run_time,
+                           eager_run_time=eager_run_time,
+                           error=None)
+
+
+def run_benchmarks(tests: List[Test], config: TestConfig, warmup: int = 3,
+                   repetitions: int = 10,
+                   verbose: bool = False) -> List[BenchmarkResult]:
+    """Benchmarks the given `Test`'s with the provided `TestConfig`.
+
+    Unlike `run_tests`, this runs the tests one after the other in this
+    process, so that they don't compete for the cores while being timed.
+    """
+    # Gradients are never needed, and only add overhead to eager mode.
+    results = []
+    with torch.no_grad():
+        for test in sorted(tests, key=lambda t: t.unique_name):
+            if verbose:
+                print(f"Benchmarking {test.unique_name}...", file=sys.stderr)
+            results.append(benchmark_test(test, config, warmup, repetitions))
+    return results
+
+
+def _stats_to_json(stats: Optional[TimingStats]) -> Optional[Dict[str, float]]:
+    return stats._asdict() if stats is not None else None
+
+
+def report_benchmarks(results: List[BenchmarkResult], config_name: str,
+                      warmup: int, repetitions: int, file: TextIO):
+    """Writes `results` to `file` as JSON.
+
+    All times are in seconds. Tests that failed to compile or run have an
+    `error` and no speedup.
+    """
+    report = {
+        "config": config_name,
+        "warmup": warmup,
+        "repetitions": repetitions,
+        "benchmarks": [{
+            "name": result.unique_name,
+            "compile_time": result.compile_time,
+            "run_time": _stats_to_json(result.run_time),
+            "eager_run_time": _stats_to_json(result.eager_run_time),
+            "speedup_over_eager": result.speedup_over_eager,
+            "error": result.error,
+        } for result in results],
+    }
+    json.dump(report, file, indent=2)
+    file.write("\n")
@@ -11,10 +11,6 @@ import torch_mlir
 from torch_mlir_e2e_test.tosa_backends.abc import TosaBackend
 from torch_mlir_e2e_test.framework import TestConfig, Trace, TraceItem
 from torch_mlir_e2e_test.utils import convert_annotations_to_placeholders
-from .utils import (
-    recursively_convert_to_numpy,
-    recursively_convert_from_numpy,
-)
 
 
 class TosaBackendTestConfig(TestConfig):
@@ -40,9 +36,9 @@ class TosaBackendTestConfig(TestConfig):
         backend_module = self.backend.load(artifact)
         result: Trace = []
         for item in trace:
-            numpy_inputs = recursively_convert_to_numpy(item.inputs)
-            outputs = getattr(backend_module, item.symbol)(*numpy_inputs)
-            output = recursively_convert_from_numpy(outputs)
+            # The RefBackend takes and returns torch tensors without copying
+            # them.
+            output = getattr(backend_module, item.symbol)(*item.inputs)
             result.append(
                 TraceItem(symbol=item.symbol,
                           inputs=item.inputs,
@@ -26,6 +26,7 @@ from itertools import repeat
 
 import sys
 import traceback
+import zlib
 
 import torch
 import multiprocess as mp
@@ -315,17 +316,44 @@ def compile_and_run_test(test: Test, config: TestConfig, verbose=False) -> Any:
                       golden_trace=clone_trace(golden_trace))
 
 
-def run_tests(tests: List[Test], config: TestConfig, sequential=False, verbose=False) -> List[TestResult]:
-    """Invoke the given `Test`'s with the provided `TestConfig`."""
-    num_processes = min(int(mp.cpu_count() * 1.1), len(tests))
-    # TODO: We've noticed that on certain 2 core machine parallelizing the tests
-    # makes the llvm backend legacy pass manager 20x slower than using a
-    # single process. Need to investigate the root cause eventually. This is a
-    # hack to work around this issue.
-    # Also our multiprocessing implementation is not the most efficient, so
-    # the benefit at core count 2 is probably not worth it anyway.
-    if mp.cpu_count() == 2:
-        num_processes = 1
+def shard_tests(tests: List[Test], num_shards: int,
+                shard_index: int) -> List[Test]:
+    """Returns the tests in the shard `shard_index` of `num_shards` shards.
+
+    Each test is assigned to a shard by a hash of its name, so that a test
+    stays in the same shard on every machine and when other tests are added or
+    removed.
+    """
+    if not 0 <= shard_index < num_shards:
+        raise ValueError(
+            f"shard index {shard_index} is not in [0, {num_shards})")
+    return [
+        test for test in tests
+        if zlib.crc32(test.unique_name.encode()) % num_shards == shard_index
+    ]
+
+
+def run_tests(tests: List[Test], config: TestConfig, sequential=False,
+              verbose=False,
+              num_processes: Optional[int] = None) -> List[TestResult]:
+    """Invoke the given `Test`'s with the provided `TestConfig`.
+
+    The tests are run in a pool of `num_processes` processes, which defaults
+    to one per core.
+    """
+    if not tests:
+        return []
+    if num_processes is None:
+        num_processes = int(mp.cpu_count() * 1.1)
+        # TODO: We've noticed that on certain 2 core machine parallelizing the
+        # tests makes the llvm backend legacy pass manager 20x slower than
+        # using a single process. Need to investigate the root cause
+        # eventually. This is a hack to work around this issue.
+        # Also our multiprocessing implementation is not the most efficient,
+        # so the benefit at core count 2 is probably not worth it anyway.
+        if mp.cpu_count() == 2:
+            num_processes = 1
+    num_processes = min(num_processes, len(tests))
 
     # Sort the tests to make output nicer.
     tests = list(sorted(tests, key=lambda t: t.unique_name))
@@ -343,7 +371,9 @@ def run_tests(tests: List[Test], config: TestConfig, sequential=False, verbose=F
 
     pool = mp.Pool(num_processes)
     arg_list = zip(tests, repeat(config))
-    handles = pool.starmap_async(compile_and_run_test, arg_list)
+    # The tests take very different times to run, so they are handed out one
+    # at a time rather than in chunks.
+    handles = pool.starmap_async(compile_and_run_test, arg_list, chunksize=1)
     results = handles.get()
 
     tests_with_results = {result.unique_name for result in results}
@@ -0,0 +1,256 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+"""An autotuner for the tile sizes of the optimizing RefBackend.
+
+By default, `refback-tile-and-vectorize` tiles every linalg op with the same
+tile sizes. The autotuner instead benchmarks candidate tile sizes for each
+kind of linalg op (its name and the shapes and dtypes of its operands, see
+`get_tuning_keys`) on the machine it runs on, and records the fastest ones in
+a tuning database. That is a JSON file, which lowering with
+`RefBackendLinalgOnTensorsBackend(optimize=True, tuning_db=...)`, or with
+`TORCH_MLIR_TUNING_DB` set, then takes the tile sizes from.
+
+The autotuner can be used from Python through `autotune`, or on the
+linalg-on-tensors output of `torch_mlir.compile` from the command line:
+
+    python -m torch_mlir_e2e_test.linalg_on_tensors_backends.autotuner \\
+        module.mlir --tuning-db tuning.json
+"""
+
+import argparse
+import itertools
+import json
+import os
+import tempfile
+import time
+from typing import Dict, Iterator, List, Optional, Sequence
+
+import numpy as np
+
+from torch_mlir.ir import *
+from torch_mlir.compiler_utils import run_pipeline_with_repro_report
+
+from .refbackend import RefBackendLinalgOnTensorsBackend, _get_lowering_passes
+
+__all__ = [
+    "TuningDatabase",
+    "get_tuning_keys",
+    "autotune",
+]
+
+DEFAULT_CACHE_TILE_SIZES = (0, 16, 32, 64, 128)
+DEFAULT_VECTOR_TILE_SIZES = (0, 4, 8, 16)
+
+# Ops of the linalg dialect that are not linalg ops themselves, but parts of
+# their bodies.
+_NON_TUNABLE_LINALG_OPS = {"linalg.index", "linalg.yield"}
+
+
+class TuningDatabase:
+    """The tile sizes to use for each tuning key, stored in a JSON file."""
+
+    def __init__(self, path: str):
+        self.path = path
+        self.entries: Dict[str, Dict[str, float]] = {}
+        if os.path.exists(path):
+            with open(path) as f:
+                self.entries = json.load(f)
+
+    def __contains__(self, key: str) -> bool:
+        return key in self.entries
+
+    def set(self, key: str, cache_tile_size: int, vector_tile_size: int,
+            time_us: float):
+        self.entries[key] = {
+            "cache_tile_size": cache_tile_size,
+            "vector_tile_size": vector_tile_size,
+            # Only informative, the lowering ignores it.
+            "time_us": time_us,
+        }
+
+    def save(self, path: Optional[str] = None):
+        """Writes the database to `path`, or to the file it was loaded from.
+
+        The file is replaced atomically, so that a compilation reading it
+        concurrently never sees a partially written database.
+        """
+        path = path or self.path
+        directory = os.path.dirname(os.path.abspath(path))
+        fd, tmp_path = tempfile.mkstemp(dir=directory, suffix=".tmp")
+        with os.fdopen(fd, "w") as f:
+            json.dump(self.entries, f, indent=2, sort_keys=True)
+        os.replace(tmp_path, path)
+
+
+def _walk(op) -> Iterator[Operation]:
+    for region in op.regions:
+        for block in region.blocks:
+            for nested in block.operations:
+                yield nested.operation
+                yield from _walk(nested.operation)
+
+
+def _format_type(type: Type) -> str:
+    # Needs to match `getTuningKey` in RefBackend.cpp.
+    if not ShapedType.isinstance(type) or not ShapedType(type).has_rank:
+        return str(type)
+    shaped_type = ShapedType(type)
+    sizes = ["?" if shaped_type.is_dynamic_dim(i) else str(size)
+             for i, size in enumerate(shaped_type.shape)]
+    return "".join(size + "x" for size in sizes) + str(
+        shaped_type.element_type)
+
+
+def get_tuning_keys(module: Module) -> List[str]:
+    """Returns the tuning keys of the linalg ops of a linalg-on-tensors
+    `module`, in the order in which they first appear, as
+    `refback-tile-and-vectorize` computes them after bufferization.
+
+    `module` itself is left alone.
+    """
+    passes = _get_lowering_passes(optimize=True)
+    passes = passes[:passes.index("func.func(refback-tile-and-vectorize)")]
+    with module.context:
+        bufferized = Module.parse(str(module))
+    run_pipeline_with_repro_report(
+        bufferized, "builtin.module(" + ",".join(passes) + ")",
+        "Bufferizing Linalg-on-Tensors IR for autotuning")
+    keys = []
+    for op in _walk(bufferized.operation):
+        if not op.name.startswith("linalg.") or \
+                op.name in _NON_TUNABLE_LINALG_OPS:
+            continue
+        key = op.name + ":" + ",".join(
+            _format_type(operand.type) for operand in op.operands)
+        if key not in keys:
+            keys.append(key)
+    return keys
+
+
+def _benchmark(module_asm: str, context: Context, function_name: str,
+               inputs: Sequence[np.ndarray], tuning_db_path: str,
+               repeats: int) -> float:
+    """Returns the best time, in microseconds, of calling `function_name`
+    with `inputs` after lowering `module_asm` with the given tuning
+    database."""
+    with context:
+        module = Module.parse(module_asm)
+    backend = RefBackendLinalgOnTensorsBackend(optimize=True,
+                                               tuning_db=tuning_db_path)
+    invoker = backend.load(backend.compile(module))
+    function = getattr(invoker, function_name)
+    # The first call may still be paying for lazily initialized state.
+    function(*inputs)
+    best = float("inf")
+    for _ in range(repeats):
+        start = time.perf_counter()
+        function(*inputs)
+        best = min(best, time.perf_counter() - start)
+    return best * 1e6
+
+
+def autotune(module: Module, inputs: Sequence[np.ndarray], tuning_db: str,
+             function_name: str = "forward",
+             cache_tile_sizes: Sequence[int] = DEFAULT_CACHE_TILE_SIZES,
+             vector_tile_sizes: Sequence[int] = DEFAULT_VECTOR_TILE_SIZES,
+             repeats: int = 5, retune: bool = False) -> TuningDatabase:
+    """Tunes the tile sizes of the linalg ops of a linalg-on-tensors `module`
+    and records them in the tuning database at `tuning_db`.
+
+    The tuning keys are tuned one at a time, in order: each candidate pair of
+    tile sizes for a key is benchmarked by timing `function_name` on
+    `inputs`, with the sizes already tuned for the previous keys, and the
+    fastest is recorded. Keys that the database already has an entry for are
+    skipped, unless `retune` is set, and the database is saved after each
+    key, so that an interrupted run can be resumed.
+
+    Returns the updated database.
+    """
+    db = TuningDatabase(tuning_db)
+    module_asm = str(module)
+    candidates = list(itertools.product(cache_tile_sizes, vector_tile_sizes))
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        candidate_db = TuningDatabase(os.path.join(tmp_dir, "candidate.json"))
+        for key in get_tuning_keys(module):
+            if key in db and not retune:
+                continue
+            best = None
+            for cache_tile_size, vector_tile_size in candidates:
+                candidate_db.entries = dict(db.entries)
+                candidate_db.set(key, cache_tile_size, vector_tile_size, 0)
+                candidate_db.save()
+                time_us = _benchmark(module_asm, module.context,
+                                     function_name, inputs,
+                                     candidate_db.path, repeats)
+                if best is None or time_us < best[2]:
+                    best = (cache_tile_size, vector_tile_size, time_us)
+            db.set(key, *best)
+            db.save()
+    return db
+
+
+_ELEMENT_TYPE_TO_NP_DTYPE = {
+    "f16": np.float16,
+    "f32": np.float32,
+    "f64": np.float64,
+    "i1": np.bool_,
+    "i8": np.int8,
+    "i32": np.int32,
+    "i64": np.int64,
+}
+
+
+def _random_inputs(module: Module, function_name: str) -> List[np.ndarray]:
+    for op in module.body.operations:
+        op = op.operation
+        if op.name == "func.func" and \
+                StringAttr(op.attributes["sym_name"]).value == function_name:
+            break
+    else:
+        raise ValueError(f"no function named '{function_name}'")
+    function_type = FunctionType(TypeAttr(op.attributes["function_type"]).value)
+    inputs = []
+    for type in function_type.inputs:
+        tensor_type = RankedTensorType(type)
+        dtype = _ELEMENT_TYPE_TO_NP_DTYPE.get(str(tensor_type.element_type))
+        if not tensor_type.has_static_shape or dtype is None:
+            raise ValueError(
+                f"cannot create a random input of type {type}, use "
+                "`autotune` with example inputs instead")
+        inputs.append(np.random.rand(*tensor_type.shape).astype(dtype))
+    return inputs
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Tune the RefBackend tile sizes of the linalg ops of a "
+        "linalg-on-tensors module, with random inputs.")
+    parser.add_argument("input", help="The linalg-on-tensors module.")
+    parser.add_argument("--tuning-db", required=True,
+                        help="The tuning database to update.")
+    parser.add_argument("--function", default="forward",
+                        help="The function to benchmark.")
+    parser.add_argument("--repeats", type=int, default=5,
+                        help="The number of timed calls per candidate.")
+    parser.add_argument("--retune", action="store_true",
+                        help="Tune the ops that already have an entry too.")
+    args = parser.parse_args()
+
+    with Context():
+        with open(args.input) as f:
+            module = Module.parse(f.read())
+        inputs = _random_inputs(module, args.function)
+        db = autotune(module, inputs, args.tuning_db,
+                      function_name=args.function, repeats=args.repeats,
+                      retune=args.retune)
+    for key, entry in sorted(db.entries.items()):
+        print(f"{key}: cache_tile_size={entry['cache_tile_size']} "
+              f"vector_tile_size={entry['vector_tile_size']} "
+              f"({entry['time_us']:.1f} us)")
+
+
+if __name__ == "__main__":
+    main()
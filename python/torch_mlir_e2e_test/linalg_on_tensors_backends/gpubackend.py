@@ -0,0 +1,279 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+import concurrent.futures
+import ctypes
+from typing import Optional, Sequence
+
+import numpy as np
+import torch
+
+from torch_mlir.ir import Module
+from torch_mlir.compiler_utils import run_pipeline_with_repro_report
+from torch_mlir.compile_cache import CompileCache
+
+from .abc import LinalgOnTensorsBackend
+from .refbackend import (
+    RefBackendInvoker,
+    _as_numpy_view,
+    _get_cached_invoker,
+    get_runtime_library,
+)
+
+__all__ = [
+    "GpuLinalgOnTensorsBackend",
+    "GpuRefBackendInvoker",
+]
+
+# The runtime wrappers that the host code calls into, the passes that lower
+# the kernels for each GPU target, and the attribute of the `gpu.module`s that
+# holds the serialized kernels.
+_GPU_TARGETS = {
+    "cuda": ("mlir_cuda_runtime", "convert-gpu-to-nvvm", "gpu-to-cubin",
+             "nvvm.cubin"),
+    "rocm": ("mlir_rocm_runtime", "convert-gpu-to-rocdl", "gpu-to-hsaco",
+             "rocdl.hsaco"),
+}
+
+
+def _get_lowering_pipeline(target: str, chip: Optional[str],
+                           tile_sizes: Sequence[int]) -> str:
+    """Returns the GPU lowering pipeline.
+
+    The bufferized linalg ops are lowered to parallel loops, whose parallel
+    dimensions are tiled by `tile_sizes` (and by 1 along the remaining
+    ones). The tile loops are mapped to GPU blocks and the loops within a tile
+    to GPU threads, up to 3 dimensions each, and each of them is outlined
+    into its own kernel. Reductions stay sequential loops within each thread.
+    TMTensor ops and scalar code run on the host.
+
+    Kernels run directly on the host buffers, which are registered with the
+    GPU runtime (see `refback-register-host-buffers-for-gpu`), so no data is
+    copied to or from the device explicitly. The arguments are registered by
+    `GpuRefBackendInvoker` instead, once for all calls.
+    """
+    _, to_gpu_dialect, serialize, binary_annotation = _GPU_TARGETS[target]
+    chip_option = f"{{chip={chip}}}" if chip is not None else ""
+    tile_sizes_option = ",".join(str(size) for size in tile_sizes)
+    return "builtin.module(" + ",".join([
+        "func.func(refback-generalize-tensor-pad)",
+        "func.func(linalg-fuse-elementwise-ops)",
+        "convert-shape-to-std",
+        # Bufferize.
+        "func.func(scf-bufferize)",
+        "func.func(tm-tensor-bufferize)",
+        "func.func(empty-tensor-to-alloc-tensor)",
+        "func.func(linalg-bufferize)",
+        "func-bufferize",
+        "arith-bufferize",
+        "refback-mlprogram-bufferize",
+        "func.func(tensor-bufferize)",
+        "func.func(finalizing-bufferize)",
+        "func.func(buffer-deallocation)",
+        "refback-munge-calling-conventions",
+        "func.func(tm-tensor-to-loops)",
+        "func.func(refback-munge-memref-copy)",
+        # Expand the ops that the GPU targets can't lower either, before the
+        # kernels are outlined out of the functions.
+        "func.func(refback-expand-ops-for-llvm)",
+        "func.func(arith-expand)",
+        # Map to GPU kernels.
+        "func.func(convert-linalg-to-parallel-loops)",
+        "func.func(scf-parallel-loop-tiling{"
+        f"parallel-loop-tile-sizes={tile_sizes_option} no-min-max-bounds=true}})",
+        "func.func(gpu-map-parallel-loops)",
+        "func.func(convert-parallel-loops-to-gpu)",
+        "gpu-kernel-outlining",
+        "refback-register-host-buffers-for-gpu{register-arguments=false}",
+        "lower-affine",
+        "convert-scf-to-cf",
+        f"gpu.module(strip-debuginfo,{to_gpu_dialect},{serialize}{chip_option})",
+        # Lower the host code to LLVM.
+        "func.func(convert-math-to-llvm)",
+        "convert-math-to-libm",
+        "convert-linalg-to-llvm",
+        "expand-strided-metadata",
+        "finalize-memref-to-llvm",
+        "func.func(convert-arith-to-llvm)",
+        "convert-func-to-llvm",
+        "convert-cf-to-llvm",
+        "convert-complex-to-llvm",
+        f"gpu-to-llvm{{gpu-binary-annotation={binary_annotation}}}",
+        "reconcile-unrealized-casts",
+    ]) + ")"
+
+
+class _StagingBuffers:
+    """The two buffers that the successive calls of a function pass in turn
+    as one of its arguments, registered with the GPU runtime for as long as
+    that argument keeps the same shape and dtype."""
+
+    def __init__(self, runtime, shape, dtype):
+        self.runtime = runtime
+        self.shape = shape
+        self.dtype = dtype
+        self.buffers = [np.empty(shape, dtype=dtype) for _ in range(2)]
+        for buffer in self.buffers:
+            if buffer.nbytes:
+                runtime.mgpuMemHostRegister(buffer.ctypes.data, buffer.nbytes)
+        # The last submitted call using each buffer.
+        self.calls = [None, None]
+        self.next = 0
+
+    def acquire(self) -> int:
+        """Returns the index of the buffer for the next call, once the
+        previous call using it is done."""
+        index = self.next
+        self.next = 1 - index
+        if self.calls[index] is not None:
+            concurrent.futures.wait([self.calls[index]])
+            self.calls[index] = None
+        return index
+
+    def release(self):
+        concurrent.futures.wait(
+            [call for call in self.calls if call is not None])
+        for buffer in self.buffers:
+            if buffer.nbytes:
+                self.runtime.mgpuMemHostUnregister(buffer.ctypes.data)
+        self.buffers = []
+
+
+class GpuRefBackendInvoker(RefBackendInvoker):
+    """Invokes the functions of modules compiled by
+    `GpuLinalgOnTensorsBackend`.
+
+    Registering memory with the GPU runtime is expensive, so the arguments are
+    copied into staging buffers that stay registered across calls. There are
+    two per argument, used by every other call, so that with `submit` the
+    arguments of one call are copied while the previous call runs.
+    """
+
+    # The result buffers may still be registered with the GPU runtime.
+    frees_result_buffers = False
+
+    def __init__(self, module, shared_libs):
+        super().__init__(module, shared_libs)
+        self._runtime = ctypes.CDLL(shared_libs[0])
+        self._runtime.mgpuMemHostRegister.argtypes = [
+            ctypes.c_void_p, ctypes.c_uint64
+        ]
+        self._runtime.mgpuMemHostUnregister.argtypes = [ctypes.c_void_p]
+        # The staging buffers of each argument, keyed by the function name and
+        # the index of the argument.
+        self._staging = {}
+        # The staging buffers used by the call being prepared.
+        self._acquired = []
+
+    def __del__(self):
+        self._wait_for_submitted_calls()
+        for staging in self._staging.values():
+            staging.release()
+
+    def _prepare_arg(self, function_name: str, index: int, arg):
+        arg = _as_numpy_view(arg)
+        staging = self._staging.get((function_name, index))
+        if (staging is None or staging.shape != arg.shape
+                or staging.dtype != arg.dtype):
+            if staging is not None:
+                staging.release()
+            staging = _StagingBuffers(self._runtime, arg.shape, arg.dtype)
+            self._staging[(function_name, index)] = staging
+        buffer_index = staging.acquire()
+        self._acquired.append((staging, buffer_index))
+        buffer = staging.buffers[buffer_index]
+        np.copyto(buffer, arg)
+        return buffer
+
+    def _prepare_call(self, function_name, args):
+        self._acquired = []
+        run = super()._prepare_call(function_name, args)
+        buffers = [staging.buffers[index] for staging, index in self._acquired]
+
+        # Results that alias an argument would be overwritten by the calls
+        # that reuse its staging buffer.
+        def copy_if_aliased(result):
+            view = _as_numpy_view(result)
+            if isinstance(view, np.ndarray) and any(
+                    np.may_share_memory(view, buffer) for buffer in buffers):
+                if isinstance(result, torch.Tensor):
+                    return result.clone()
+                return np.copy(result)
+            return result
+
+        def run_and_copy_aliased_results():
+            result = run()
+            if isinstance(result, tuple):
+                return tuple(copy_if_aliased(r) for r in result)
+            return copy_if_aliased(result)
+
+        return run_and_copy_aliased_results
+
+    def submit(self, function_name: str, *args) -> concurrent.futures.Future:
+        future = super().submit(function_name, *args)
+        for staging, index in self._acquired:
+            staging.calls[index] = future
+        return future
+
+
+class GpuLinalgOnTensorsBackend(LinalgOnTensorsBackend):
+    """A reference backend that runs the linalg ops on a GPU.
+
+    This is meant for measuring how well torch-mlir's lowerings map to GPU
+    kernels, not for production use: kernels access host memory over the
+    bus, and math functions that the GPU targets lower to calls to device
+    libraries (e.g. `math.exp`) are not supported, since the kernels are not
+    linked against those libraries.
+    """
+
+    def __init__(self, target: str = "cuda", chip: Optional[str] = None,
+                 tile_sizes: Sequence[int] = (32, 8),
+                 cache_dir: Optional[str] = None):
+        """
+        Args:
+          target: The GPU runtime to run the kernels with, "cuda" or "rocm".
+            torch-mlir must have been built with the corresponding MLIR
+            runner enabled.
+          chip: The GPU architecture to compile the kernels for, e.g.
+            "sm_80" or "gfx90a". Defaults to that of the serialization pass.
+          tile_sizes: The number of threads of the blocks along the leading
+            parallel dimensions of each linalg op.
+          cache_dir: See `RefBackendLinalgOnTensorsBackend`.
+        """
+        super().__init__()
+        if target not in _GPU_TARGETS:
+            raise ValueError(f"Unsupported GPU target '{target}', expected "
+                             f"one of {sorted(_GPU_TARGETS)}")
+        self.lowering_pipeline = _get_lowering_pipeline(target, chip,
+                                                        tile_sizes)
+        runtime_library = _GPU_TARGETS[target][0]
+        self.shared_libs = [
+            get_runtime_library(runtime_library,
+                                f"to run modules on {target} GPUs")
+        ]
+        self.cache = CompileCache.from_env_or(cache_dir)
+
+    def compile(self, imported_module: Module):
+        """Compiles an imported module in linalg-on-tensors form, see
+        `RefBackendLinalgOnTensorsBackend.compile`."""
+        if self.cache is not None:
+            cache_key = self.cache.get_pipeline_key(imported_module,
+                                                    self.lowering_pipeline)
+            cached_module = self.cache.load(cache_key,
+                                            imported_module.context)
+            if cached_module is not None:
+                return cached_module
+
+        run_pipeline_with_repro_report(
+            imported_module, self.lowering_pipeline,
+            "Lowering Linalg-on-Tensors IR to LLVM and GPU kernels")
+        if self.cache is not None:
+            self.cache.store(cache_key, imported_module)
+        return imported_module
+
+    def load(self, module) -> GpuRefBackendInvoker:
+        """Loads a compiled artifact into the runtime."""
+        return _get_cached_invoker(module, self.shared_libs,
+                                   GpuRefBackendInvoker)
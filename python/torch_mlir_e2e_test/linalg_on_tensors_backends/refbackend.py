@@ -3,15 +3,29 @@
 # SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 # Also available under a BSD-style license. See LICENSE.
 
+import collections
+import concurrent.futures
 import ctypes
+import functools
+import glob
+import hashlib
+import os
+import threading
+import time
+from typing import Callable, List, Optional
 import numpy as np
+import torch
+import torch.utils.dlpack
 
+import torch_mlir._mlir_libs
 from torch_mlir.ir import *
 from torch_mlir.passmanager import *
 from torch_mlir.execution_engine import *
 from torch_mlir.runtime import *
 import torch_mlir.dialects.torch
 from torch_mlir.compiler_utils import run_pipeline_with_repro_report
+from torch_mlir.compile_cache import CompileCache
+from torch_mlir import ShapeSpecializedFunction, TensorPlaceholder
 
 from .abc import LinalgOnTensorsBackend
 
@@ -39,6 +53,17 @@ memref_type_to_np_dtype = {
     "mrc32": np.complex64,
     "mrc64": np.complex128
 }
+memref_type_to_torch_dtype = {
+    "mrf16": torch.float16,
+    "mrf32": torch.float32,
+    "mrf64": torch.float64,
+    "mri1": torch.bool,
+    "mri8": torch.int8,
+    "mri32": torch.int32,
+    "mri64": torch.int64,
+    "mrc32": torch.complex64,
+    "mrc64": torch.complex128
+}
 elemental_type_to_ctype = {
     "i1": ctypes.c_bool,
     "i8": ctypes.c_byte,
@@ -47,7 +72,30 @@ elemental_type_to_ctype = {
     "f64": ctypes.c_double
 }
 
+element_type_to_np_dtype = {
+    "f16": np.float16,
+    "f32": np.float32,
+    "f64": np.float64,
+    "i1": np.bool_,
+    "i8": np.int8,
+    "si8": np.int8,
+    "i32": np.int32,
+    "i64": np.int64,
+    "complex<f32>": np.complex64,
+    "complex<f64>": np.complex128
+}
+
 CONSUME_RETURN_FUNC_PREFIX = "refbackend_consume_func_return_"
+DESTINATION_PASSING_RESULTS_ATTR = "refback.destination_passing_results"
+DONATED_INPUTS_ATTR = "refback.donated_inputs"
+OP_TIMER_NAMES_ATTR = "refback.op_timer_names"
+OP_TIMER_START_FUNC = "refbackend_op_timer_start"
+OP_TIMER_STOP_FUNC = "refbackend_op_timer_stop"
+
+# The time spent in the ops with a given name, as reported by
+# `RefBackendInvoker.get_op_profile`.
+OpProfileEntry = collections.namedtuple("OpProfileEntry",
+                                        ["name", "count", "total_time_s"])
 
 
 def get_return_funcs(module):
@@ -78,108 +126,706 @@ def get_ctype_func(func_name):
     return ctypes.CFUNCTYPE(*ctypes_arg), ret_types
 
 
-class RefBackendInvoker:
+def get_destination_passing_results(module):
+    """Returns the shape and dtype of each result of each function that uses
+    the destination-passing calling convention, keyed by function name."""
+    results = {}
+    with module.context:
+        attributes = module.operation.attributes
+        if DESTINATION_PASSING_RESULTS_ATTR not in attributes:
+            return results
+        results_attr = DictAttr(attributes[DESTINATION_PASSING_RESULTS_ATTR])
+        for i in range(len(results_attr)):
+            named_attr = results_attr[i]
+            result_types = []
+            for type_attr in ArrayAttr(named_attr.attr):
+                memref_type = MemRefType(TypeAttr(type_attr).value)
+                result_types.append(
+                    (tuple(memref_type.shape),
+                     element_type_to_np_dtype[str(memref_type.element_type)]))
+            results[named_attr.name] = result_types
+    return results
+
+
+def get_donated_inputs(module):
+    """Returns, for each result of each function that uses the
+    destination-passing calling convention, the index of the donated argument
+    whose storage is reused for that result, or -1, keyed by function name."""
+    donated_inputs = {}
+    with module.context:
+        attributes = module.operation.attributes
+        if DONATED_INPUTS_ATTR not in attributes:
+            return donated_inputs
+        donated_attr = DictAttr(attributes[DONATED_INPUTS_ATTR])
+        for i in range(len(donated_attr)):
+            named_attr = donated_attr[i]
+            donated_inputs[named_attr.name] = [
+                IntegerAttr(index).value
+                for index in ArrayAttr(named_attr.attr)
+            ]
+    return donated_inputs
+
+
+def get_op_timer_names(module):
+    """Returns the name of each op timed by `refback-insert-op-timers`,
+    indexed by the id of the op."""
+    with module.context:
+        attributes = module.operation.attributes
+        if OP_TIMER_NAMES_ATTR not in attributes:
+            return []
+        return [StringAttr(name).value
+                for name in ArrayAttr(attributes[OP_TIMER_NAMES_ATTR])]
+
+
+def _as_numpy_view(arg):
+    # `torch.Tensor.numpy` shares storage with the tensor, so this doesn't
+    # copy.
+    if isinstance(arg, torch.Tensor):
+        return arg.detach().numpy()
+    return arg
+
+
+SUPPORTED_TORCH_DTYPES = [
+    torch.float16, torch.float32, torch.float64, torch.uint8, torch.int8,
+    torch.int32, torch.int64, torch.bool, torch.complex64, torch.complex128
+]
+
 
-    def __init__(self, module):
-        self.ee = ExecutionEngine(module)
+@functools.lru_cache(maxsize=None)
+def _get_memref_descriptor_type(rank: int):
+    # The element type of the descriptor only types its pointers, and the
+    # compiled code doesn't see it.
+    if rank == 0:
+        return make_zero_d_memref_descriptor(ctypes.c_byte)
+    return make_nd_memref_descriptor(rank, ctypes.c_byte)
+
+
+def _get_tensor_memref_descriptor(tensor: torch.Tensor, ranked: bool):
+    """Returns a memref descriptor pointing at the storage of `tensor`."""
+    assert tensor.dtype in SUPPORTED_TORCH_DTYPES, \
+        f"Only tensors with dtypes in {SUPPORTED_TORCH_DTYPES} are supported, but got {tensor.dtype}"
+    assert tensor.device.type == "cpu", \
+        f"Only CPU tensors are supported, but got a tensor on {tensor.device}"
+    descriptor = _get_memref_descriptor_type(tensor.dim())()
+    pointer = ctypes.cast(tensor.data_ptr(), ctypes.POINTER(ctypes.c_byte))
+    descriptor.allocated = pointer
+    descriptor.aligned = pointer
+    descriptor.offset = ctypes.c_longlong(0)
+    if tensor.dim() > 0:
+        descriptor.shape[:] = tensor.shape
+        descriptor.strides[:] = tensor.stride()
+    if ranked:
+        return descriptor
+    unranked = UnrankedMemRefDescriptor()
+    unranked.rank = tensor.dim()
+    unranked.descriptor = ctypes.cast(ctypes.pointer(descriptor),
+                                      ctypes.c_void_p)
+    return unranked
+
+
+def _get_ffi_arg(arg, ranked: bool):
+    """Returns the argument passed to the compiled code for the torch tensor
+    or numpy array `arg`, which points at its storage."""
+    if isinstance(arg, torch.Tensor):
+        descriptor = _get_tensor_memref_descriptor(arg, ranked)
+    else:
+        assert_arg_type_is_supported(arg.dtype)
+        if ranked:
+            descriptor = get_ranked_memref_descriptor(arg)
+        else:
+            descriptor = get_unranked_memref_descriptor(arg)
+    return ctypes.pointer(ctypes.pointer(descriptor))
+
+
+def _get_data_pointer(arg) -> int:
+    if isinstance(arg, torch.Tensor):
+        return arg.data_ptr()
+    return arg.ctypes.data
+
+
+# The DLPack structs, see
+# https://github.com/dmlc/dlpack/blob/main/include/dlpack/dlpack.h.
+class _DLDevice(ctypes.Structure):
+    _fields_ = [("device_type", ctypes.c_int), ("device_id", ctypes.c_int)]
+
+
+class _DLDataType(ctypes.Structure):
+    _fields_ = [("code", ctypes.c_uint8), ("bits", ctypes.c_uint8),
+                ("lanes", ctypes.c_uint16)]
+
+
+class _DLTensor(ctypes.Structure):
+    _fields_ = [("data", ctypes.c_void_p), ("device", _DLDevice),
+                ("ndim", ctypes.c_int), ("dtype", _DLDataType),
+                ("shape", ctypes.POINTER(ctypes.c_int64)),
+                ("strides", ctypes.POINTER(ctypes.c_int64)),
+                ("byte_offset", ctypes.c_uint64)]
+
+
+class _DLManagedTensor(ctypes.Structure):
+    pass
+
+
+_DLManagedTensorDeleter = ctypes.CFUNCTYPE(None,
+                                           ctypes.POINTER(_DLManagedTensor))
+_DLManagedTensor._fields_ = [("dl_tensor", _DLTensor),
+                             ("manager_ctx", ctypes.c_void_p),
+                             ("deleter", _DLManagedTensorDeleter)]
+
+_DL_CPU = 1
+_DLPACK_CAPSULE_NAME = b"dltensor"
+
+_PyCapsule_New = ctypes.pythonapi.PyCapsule_New
+_PyCapsule_New.restype = ctypes.py_object
+_PyCapsule_New.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_void_p]
+_PyCapsule_GetPointer = ctypes.pythonapi.PyCapsule_GetPointer
+_PyCapsule_GetPointer.restype = ctypes.c_void_p
+_PyCapsule_GetPointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+
+
+@functools.lru_cache(maxsize=None)
+def _get_dl_data_type(dtype: torch.dtype):
+    """Returns the (code, bits) of the DLPack data type of `dtype`, as torch
+    exports it."""
+    capsule = torch.utils.dlpack.to_dlpack(torch.empty(0, dtype=dtype))
+    managed = ctypes.cast(_PyCapsule_GetPointer(capsule, _DLPACK_CAPSULE_NAME),
+                          ctypes.POINTER(_DLManagedTensor)).contents
+    return managed.dl_tensor.dtype.code, managed.dl_tensor.dtype.bits
+
+
+# Memrefs that aren't heap allocated, like the constant globals, are given
+# this allocated pointer by the lowering to LLVM.
+_UNOWNED_ALLOCATED_POINTER = 0xdeadbeef
+
+try:
+    _free = ctypes.CDLL(None).free
+    _free.argtypes = [ctypes.c_void_p]
+except (OSError, AttributeError, TypeError):
+    _free = None
+
+
+class _EngineAllocation:
+    """A buffer allocated by the compiled code and returned to us, which is
+    freed once the last tensor viewing it is."""
+
+    def __init__(self, allocated: int):
+        self.allocated = allocated
+
+    def __del__(self):
+        if _free is not None:
+            _free(self.allocated)
+
+
+# The DLPack tensors handed over to torch, keyed on their address, with the
+# objects keeping their storage alive.
+_exported_dl_tensors = {}
+
+
+@_DLManagedTensorDeleter
+def _delete_dl_tensor(managed):
+    # This module may already be torn down when torch frees the last tensors
+    # at exit.
+    if _exported_dl_tensors is not None:
+        _exported_dl_tensors.pop(ctypes.cast(managed, ctypes.c_void_p).value)
+
+
+def _memref_to_tensor(unranked_memref, dtype: torch.dtype, owners: dict,
+                      free_allocations: bool):
+    """Returns a torch tensor viewing the storage of `unranked_memref`,
+    without copying it.
+
+    `owners` maps the allocated pointers of the memrefs passed to or returned
+    by the call to the objects keeping them alive. The tensor keeps the owner
+    of its memref alive. With `free_allocations`, the buffers allocated by the
+    compiled code get one that frees them, otherwise they are never freed.
+    """
+    rank = unranked_memref[0].rank
+    descriptor = ctypes.cast(
+        unranked_memref[0].descriptor,
+        ctypes.POINTER(_get_memref_descriptor_type(rank))).contents
+    allocated = ctypes.cast(descriptor.allocated, ctypes.c_void_p).value or 0
+    if allocated not in owners and free_allocations:
+        owners[allocated] = _EngineAllocation(allocated)
+    owner = owners.get(allocated)
+
+    shape = (ctypes.c_int64 * rank)(*(descriptor.shape if rank else []))
+    strides = (ctypes.c_int64 * rank)(*(descriptor.strides if rank else []))
+    itemsize = torch.empty(0, dtype=dtype).element_size()
+    managed = _DLManagedTensor()
+    aligned = ctypes.cast(descriptor.aligned, ctypes.c_void_p).value or 0
+    managed.dl_tensor.data = aligned + descriptor.offset * itemsize
+    managed.dl_tensor.device = _DLDevice(_DL_CPU, 0)
+    managed.dl_tensor.ndim = rank
+    code, bits = _get_dl_data_type(dtype)
+    managed.dl_tensor.dtype = _DLDataType(code, bits, 1)
+    managed.dl_tensor.shape = shape
+    managed.dl_tensor.strides = strides
+    managed.dl_tensor.byte_offset = 0
+    managed.deleter = _delete_dl_tensor
+    address = ctypes.addressof(managed)
+    _exported_dl_tensors[address] = (managed, shape, strides, owner)
+    capsule = _PyCapsule_New(address, _DLPACK_CAPSULE_NAME, None)
+    return torch.utils.dlpack.from_dlpack(capsule)
+
+
+def get_runtime_library(name: str, purpose: str) -> str:
+    """Returns the path to the MLIR runtime library `name` shipped with
+    torch-mlir, which is needed for `purpose`."""
+    libs_dir = os.path.dirname(torch_mlir._mlir_libs.__file__)
+    candidates = glob.glob(os.path.join(libs_dir, f"*{name}*"))
+    if not candidates:
+        raise RuntimeError(
+            f"Could not find the {name} library in {libs_dir}, "
+            f"which is needed {purpose}")
+    return candidates[0]
+
+
+class _CallState(threading.local):
+    """The state of the call running on the current thread, which the result
+    callbacks of the compiled code, called on that same thread, fill in."""
+
+    def __init__(self):
+        # The owners of the memrefs of the call, see `_memref_to_tensor`.
+        self.owners = {}
         self.result = None
+        # The start times of the ops running on this thread, keyed by op id.
+        self.op_start_times = {}
+
+
+class RefBackendInvoker:
+    """Invokes the functions of a module compiled by the RefBackend.
+
+    The calls are reentrant: each thread has its own slot for the results of
+    the call it runs, so several threads can call the same loaded module at
+    once, as long as the module doesn't have mutable state.
+    """
+
+    # Whether the buffers that the compiled code allocates for the results
+    # can be freed with `free` once the result tensors are.
+    frees_result_buffers = True
+
+    def __init__(self, module, shared_libs: List[str] = []):
+        self.ee = ExecutionEngine(module, shared_libs=shared_libs)
+        self._call_state = _CallState()
+        # Guards the creation of the executor of `submit` and the last call
+        # submitted to it.
+        self._submit_lock = threading.Lock()
+        self._executor = None
+        self._last_submitted = None
+        self.destination_passing_results = get_destination_passing_results(
+            module)
+        self.donated_inputs = get_donated_inputs(module)
 
         return_funcs = get_return_funcs(module)
 
         for ret_func in return_funcs:
             ctype_wrapper, ret_types = get_ctype_func(ret_func)
 
-            def consume_return_funcs(*args):
-                self.result = tuple([
+            def consume_return_funcs(*args, ret_types=ret_types):
+                state = self._call_state
+                result = tuple([
                     arg if type in elemental_type_to_ctype
-                    else unranked_memref_to_numpy(
-                        arg, memref_type_to_np_dtype[type])
+                    else _memref_to_tensor(arg,
+                                           memref_type_to_torch_dtype[type],
+                                           state.owners,
+                                           self.frees_result_buffers)
                     for arg, type in zip(args, ret_types)
                 ])
-                if len(self.result) == 1:
-                    self.result = self.result[0]
+                state.result = result[0] if len(result) == 1 else result
 
             self.ee.register_runtime(ret_func,
                                      ctype_wrapper(consume_return_funcs))
 
+        self.op_timer_names = get_op_timer_names(module)
+        if self.op_timer_names:
+            self._register_op_timers()
+
+    def _register_op_timers(self):
+        num_ops = len(self.op_timer_names)
+        self.op_times = [0] * num_ops
+        self.op_counts = [0] * num_ops
+        op_timer_lock = threading.Lock()
+
+        def start_op_timer(op_id):
+            self._call_state.op_start_times[op_id] = time.perf_counter_ns()
+
+        def stop_op_timer(op_id):
+            elapsed = (time.perf_counter_ns() -
+                       self._call_state.op_start_times.pop(op_id))
+            with op_timer_lock:
+                self.op_times[op_id] += elapsed
+                self.op_counts[op_id] += 1
+
+        ctype_wrapper = ctypes.CFUNCTYPE(None, ctypes.c_int64)
+        self.ee.register_runtime(OP_TIMER_START_FUNC,
+                                 ctype_wrapper(start_op_timer))
+        self.ee.register_runtime(OP_TIMER_STOP_FUNC,
+                                 ctype_wrapper(stop_op_timer))
+
+    def get_op_profile(self) -> List[OpProfileEntry]:
+        """Returns the time spent in each op since the module was loaded or
+        the profile was last reset, most expensive first.
+
+        Ops with the same name, i.e. the same kind of op converted from the
+        same Torch op, are reported together. The module must have been
+        compiled with `profile=True`.
+        """
+        assert self.op_timer_names, \
+            "The module was not compiled with op timers"
+        profile = collections.OrderedDict()
+        for name, count, time_ns in zip(self.op_timer_names, self.op_counts,
+                                        self.op_times):
+            total_count, total_time_ns = profile.get(name, (0, 0))
+            profile[name] = (total_count + count, total_time_ns + time_ns)
+        entries = [
+            OpProfileEntry(name, count, time_ns * 1e-9)
+            for name, (count, time_ns) in profile.items()
+        ]
+        return sorted(entries, key=lambda entry: -entry.total_time_s)
+
+    def reset_op_profile(self):
+        """Clears the times returned by `get_op_profile`."""
+        num_ops = len(self.op_timer_names)
+        self.op_times = [0] * num_ops
+        self.op_counts = [0] * num_ops
+
+    def _prepare_arg(self, function_name: str, index: int, arg):
+        """Returns the torch tensor or numpy array passed as argument `index`
+        of `function_name` for `arg`."""
+        if isinstance(arg, torch.Tensor):
+            return arg.detach()
+        return arg
+
+    def _get_ffi_args(self, function_name, args, ranked: bool):
+        """Returns the arguments passed to `function_name` for `args`, and
+        the objects owning their storage, keyed on its address."""
+        ffi_args = []
+        owners = {}
+        for index, arg in enumerate(args):
+            arg = self._prepare_arg(function_name, index, arg)
+            ffi_args.append(_get_ffi_arg(arg, ranked))
+            owners[_get_data_pointer(arg)] = arg
+        return ffi_args, owners
+
+    def _prepare_destination_passing_call(self, function_name, result_types,
+                                          args):
+        # Results are written straight into buffers we allocate here, and
+        # arguments are passed by their own storage. Returning tensors if we
+        # were given tensors keeps this zero-copy in both directions.
+        return_tensors = any(isinstance(arg, torch.Tensor) for arg in args)
+        donated_inputs = self.donated_inputs.get(function_name,
+                                                 [-1] * len(result_types))
+        results = []
+        for (shape, dtype), donated in zip(result_types, donated_inputs):
+            # The caller gave away the storage of donated arguments, so the
+            # result is written over it instead of into a new buffer.
+            if donated >= 0:
+                donated_arg = _as_numpy_view(args[donated])
+                if (donated_arg.shape == shape and donated_arg.dtype == dtype
+                        and donated_arg.flags["C_CONTIGUOUS"]):
+                    results.append(args[donated])
+                    continue
+            if return_tensors:
+                results.append(
+                    torch.from_numpy(np.empty(shape, dtype=dtype)))
+            else:
+                results.append(np.empty(shape, dtype=dtype))
+        ffi_args, _ = self._get_ffi_args(function_name, args, ranked=True)
+        for result in results:
+            ffi_args.append(_get_ffi_arg(result, ranked=True))
+
+        def run():
+            self.ee.invoke(function_name, *ffi_args)
+            if len(results) == 1:
+                return results[0]
+            return tuple(results)
+
+        return run
+
+    def _prepare_call(self, function_name, args):
+        """Converts `args` to the arguments of `function_name`, and returns a
+        function that calls it with them and returns its results."""
+        result_types = self.destination_passing_results.get(function_name)
+        if result_types is not None:
+            return self._prepare_destination_passing_call(
+                function_name, result_types, args)
+
+        # The results are torch tensors owning the buffers that the compiled
+        # code allocated for them, or viewing the storage of the arguments or
+        # of the module that they alias. Callers passing numpy arrays get
+        # numpy views of them.
+        ffi_args, owners = self._get_ffi_args(function_name, args,
+                                              ranked=False)
+        owners[_UNOWNED_ALLOCATED_POINTER] = self
+        return_tensors = any(isinstance(arg, torch.Tensor) for arg in args)
+
+        def run():
+            state = self._call_state
+            state.owners = owners
+            state.result = None
+            try:
+                self.ee.invoke(function_name, *ffi_args)
+                result = state.result
+            finally:
+                state.owners = {}
+                state.result = None
+            assert result is not None, "Invocation didn't produce a result"
+            if return_tensors:
+                return result
+            if isinstance(result, tuple):
+                return tuple(_as_numpy_view(r) for r in result)
+            return _as_numpy_view(result)
+
+        return run
+
+    def submit(self, function_name: str, *args) -> concurrent.futures.Future:
+        """Calls `function_name` asynchronously and returns a future of its
+        results.
+
+        The arguments are converted before this returns, and the calls run
+        one at a time, in the order they were submitted, on a thread that
+        doesn't hold the GIL while the compiled code runs. Preparing the
+        arguments of the next call, or anything else the caller does until
+        it needs the results, thus overlaps with the previous calls.
+        """
+        run = self._prepare_call(function_name, args)
+        with self._submit_lock:
+            if self._executor is None:
+                self._executor = concurrent.futures.ThreadPoolExecutor(
+                    max_workers=1)
+            # The prepared call only points at the storage of the arguments,
+            # so they are passed along to be kept alive until it is done.
+            self._last_submitted = self._executor.submit(
+                lambda args: run(), args)
+            return self._last_submitted
+
+    def _wait_for_submitted_calls(self):
+        # Synchronous calls run after the calls submitted before them, in case
+        # the module has state that they update.
+        with self._submit_lock:
+            last_submitted = self._last_submitted
+        if last_submitted is None:
+            return
+        concurrent.futures.wait([last_submitted])
+        with self._submit_lock:
+            if self._last_submitted is last_submitted:
+                self._last_submitted = None
+
     def __getattr__(self, function_name: str):
+        if function_name.startswith("_"):
+            raise AttributeError(function_name)
 
         def invoke(*args):
-            ffi_args = []
-            for arg in args:
-                assert_arg_type_is_supported(arg.dtype)
-                ffi_args.append(
-                    ctypes.pointer(
-                        ctypes.pointer(get_unranked_memref_descriptor(arg))))
-
-            self.ee.invoke(function_name, *ffi_args)
-            result = self.result
-            assert result is not None, "Invocation didn't produce a result"
-            self.result = None
-            return result
+            self._wait_for_submitted_calls()
+            return self._prepare_call(function_name, args)()
 
         return invoke
 
 
-LOWERING_PIPELINE = "builtin.module(" + ",".join([
-    "func.func(refback-generalize-tensor-pad)",
-    # Apply some optimizations. It would be great if MLIR had more useful
-    # optimizations that worked out of the box here.
-    # Note: When measured, this doesn't seem to actually help that much
-    # for the linalg-on-tensors backend.
-    # This is likely because if things are naturally fusable we usually already
-    # emit things in that form from the high level (e.g. single linalg-generic).
-    # Other backends are likely to benefit more.
-    "func.func(linalg-fuse-elementwise-ops)",
-    "convert-shape-to-std",
-    # Bufferize.
-    "func.func(scf-bufferize)",
-    "func.func(tm-tensor-bufferize)",
-    "func.func(empty-tensor-to-alloc-tensor)",
-    "func.func(linalg-bufferize)",
-    "func-bufferize",
-    "arith-bufferize",
-    "refback-mlprogram-bufferize",
-    "func.func(tensor-bufferize)",
-    "func.func(finalizing-bufferize)",
-    "func.func(buffer-deallocation)",
-    # Munge to make it ExecutionEngine compatible.
-    # Specifically, we rewrite calling convention boundaries to be in terms
-    # of unranked memref, and we rewrite the return to actually be a
-    # callback that consumes the return (the final munged function always
-    # returns void at the C level -- we get the return value by providing the
-    # callback).
-    "refback-munge-calling-conventions",
-    # Insert global variable and instruction sequence for getting the next
-    # global seed used in stateful rng.
-    # Lower to LLVM
-    "func.func(tm-tensor-to-loops)",
-    "func.func(refback-munge-memref-copy)",
-    "func.func(convert-linalg-to-loops)",
-    "func.func(lower-affine)",
-    "convert-scf-to-cf",
-    "func.func(refback-expand-ops-for-llvm)",
-    "func.func(arith-expand)",
-    "func.func(convert-math-to-llvm)",
-    # Handle some complex mlir::math ops (e.g. atan2)
-    "convert-math-to-libm",
-    "convert-linalg-to-llvm",
-    "expand-strided-metadata",
-    "finalize-memref-to-llvm",
-    "lower-affine",
-    "func.func(convert-arith-to-llvm)",
-    "convert-func-to-llvm",
-    "convert-cf-to-llvm",
-    "convert-complex-to-llvm",
-    "reconcile-unrealized-casts",
-]) + ")"
+# The most recently loaded modules, keyed on their contents, with the most
+# recently used last. The results of invokers don't depend on previous calls,
+# so loading the same module again can reuse one instead of JIT-compiling it
+# again.
+_MAX_CACHED_INVOKERS = 64
+_invoker_cache = collections.OrderedDict()
+
+
+def _get_cached_invoker(module, shared_libs: List[str],
+                        invoker_class=RefBackendInvoker) -> RefBackendInvoker:
+    h = hashlib.sha256()
+    for shared_lib in shared_libs:
+        h.update(shared_lib.encode() + b"\0")
+    h.update(module.operation.get_asm(binary=True))
+    key = h.hexdigest()
+    invoker = _invoker_cache.get(key)
+    if invoker is not None:
+        _invoker_cache.move_to_end(key)
+        return invoker
+    invoker = invoker_class(module, shared_libs)
+    _invoker_cache[key] = invoker
+    if len(_invoker_cache) > _MAX_CACHED_INVOKERS:
+        _invoker_cache.popitem(last=False)
+    return invoker
+
+
+# The environment variable naming the tuning database to use when the
+# RefBackend is not given an explicit one, see `autotuner.py`.
+TUNING_DB_ENV_VAR = "TORCH_MLIR_TUNING_DB"
+
+
+def _get_lowering_passes(optimize: bool, num_threads: int = 1,
+                         destination_passing: bool = False,
+                         profile: bool = False,
+                         tuning_db: Optional[str] = None) -> List[str]:
+    """Returns the passes of the RefBackend lowering pipeline.
+
+    With `optimize`, the constant weights of matmuls are packed into blocked
+    layouts at compile time (see `refback-pack-constant-weights`), temporary
+    buffers are packed into one arena per function
+    (see `refback-plan-static-buffers`), and linalg ops are tiled and
+    vectorized (see `refback-tile-and-vectorize`) and lowered through the
+    `vector` dialect.
+    Otherwise they are lowered straight to scalar loops, which is slower but
+    simpler, and is what we use for correctness testing.
+
+    With `num_threads` > 1, the parallel loops of the linalg ops that are
+    lowered to loops are split into that many tasks, which run on the MLIR
+    async runtime's thread pool.
+
+    With `destination_passing`, statically shaped functions take their
+    arguments as ranked memrefs and write their results into buffers
+    allocated by the caller, instead of going through unranked memrefs and a
+    result callback (see `refback-munge-calling-conventions`).
+
+    With `profile`, each linalg and TMTensor op is timed when it runs (see
+    `refback-insert-op-timers`).
+
+    With `optimize` and a `tuning_db`, the tile sizes of the ops that have an
+    entry in that tuning database, and those of the packed weights of the
+    matmuls that have one, are taken from it.
+    """
+    optimized_only = lambda passes: passes if optimize else []
+    parallel = num_threads > 1
+    tile_and_vectorize = "refback-tile-and-vectorize"
+    pack_constant_weights = "refback-pack-constant-weights"
+    if tuning_db:
+        tile_and_vectorize += f"{{tuning-db={tuning_db}}}"
+        pack_constant_weights += f"{{tuning-db={tuning_db}}}"
+    return [
+        "func.func(refback-generalize-tensor-pad)",
+        # Apply some optimizations. It would be great if MLIR had more useful
+        # optimizations that worked out of the box here.
+        # Note: When measured, this doesn't seem to actually help that much
+        # for the linalg-on-tensors backend.
+        # This is likely because if things are naturally fusable we usually already
+        # emit things in that form from the high level (e.g. single linalg-generic).
+        # Other backends are likely to benefit more.
+        "func.func(linalg-fuse-elementwise-ops)",
+        *optimized_only([f"func.func({pack_constant_weights})"]),
+        "convert-shape-to-std",
+        # Bufferize.
+        "func.func(scf-bufferize)",
+        "func.func(tm-tensor-bufferize)",
+        "func.func(empty-tensor-to-alloc-tensor)",
+        "func.func(linalg-bufferize)",
+        "func-bufferize",
+        "arith-bufferize",
+        "refback-mlprogram-bufferize",
+        "func.func(tensor-bufferize)",
+        "func.func(finalizing-bufferize)",
+        "func.func(buffer-deallocation)",
+        *optimized_only(["func.func(refback-plan-static-buffers)"]),
+        # Munge to make it ExecutionEngine compatible.
+        # Specifically, we rewrite calling convention boundaries to be in terms
+        # of unranked memref, and we rewrite the return to actually be a
+        # callback that consumes the return (the final munged function always
+        # returns void at the C level -- we get the return value by providing the
+        # callback).
+        "refback-munge-calling-conventions{destination-passing=true}"
+        if destination_passing else "refback-munge-calling-conventions",
+        *(["refback-insert-op-timers"] if profile else []),
+        # Insert global variable and instruction sequence for getting the next
+        # global seed used in stateful rng.
+        # Lower to LLVM
+        "func.func(tm-tensor-to-loops)",
+        "func.func(refback-munge-memref-copy)",
+        *optimized_only([
+            f"func.func({tile_and_vectorize})",
+            "func.func(convert-vector-to-scf)",
+        ]),
+        *([
+            "func.func(convert-linalg-to-parallel-loops)",
+            f"async-parallel-for{{num-workers={num_threads}}}",
+            "async-to-async-runtime",
+            "async-runtime-ref-counting",
+            "async-runtime-ref-counting-opt",
+            "convert-async-to-llvm",
+        ] if parallel else []),
+        "func.func(convert-linalg-to-loops)",
+        "func.func(lower-affine)",
+        "convert-scf-to-cf",
+        "func.func(refback-expand-ops-for-llvm)",
+        "func.func(arith-expand)",
+        "func.func(convert-math-to-llvm)",
+        # Handle some complex mlir::math ops (e.g. atan2)
+        "convert-math-to-libm",
+        "convert-linalg-to-llvm",
+        *optimized_only(["convert-vector-to-llvm"]),
+        "expand-strided-metadata",
+        "finalize-memref-to-llvm",
+        "lower-affine",
+        "func.func(convert-arith-to-llvm)",
+        "convert-func-to-llvm",
+        "convert-cf-to-llvm",
+        "convert-complex-to-llvm",
+        "reconcile-unrealized-casts",
+    ]
+
+
+def _get_lowering_pipeline(*args, **kwargs) -> str:
+    """Returns the RefBackend lowering pipeline, see `_get_lowering_passes`."""
+    return ("builtin.module(" + ",".join(_get_lowering_passes(*args, **kwargs))
+            + ")")
+
+
+LOWERING_PIPELINE = _get_lowering_pipeline(optimize=False)
+
+# The pipeline with which the reference lazy backend lowers its computations,
+# which satisfy the backend contract, and then JIT-compiles them with the
+# destination-passing calling convention. The backend reads it from here when
+# it is initialized.
+LAZY_BACKEND_LOWERING_PIPELINE = (
+    "builtin.module(" + ",".join([
+        "torch-backend-to-linalg-on-tensors-backend-pipeline",
+        *_get_lowering_passes(optimize=False, destination_passing=True),
+    ]) + ")")
 
 
 class RefBackendLinalgOnTensorsBackend(LinalgOnTensorsBackend):
     """Main entry-point for the reference backend."""
 
-    def __init__(self):
+    def __init__(self, optimize: bool = False, num_threads: int = 1,
+                 destination_passing: bool = False,
+                 profile: bool = False,
+                 cache_dir: Optional[str] = None,
+                 tuning_db: Optional[str] = None):
+        """
+        Args:
+          optimize: If true, tile and vectorize linalg ops for much faster
+            execution, at the cost of a less straightforward lowering.
+          num_threads: The number of tasks to split the parallel loops of
+            each linalg op into. With more than one, the loaded modules run
+            those tasks on the MLIR async runtime's thread pool.
+          destination_passing: If true, statically shaped functions are
+            called with ranked memref descriptors that point directly at the
+            storage of their arguments and of preallocated results.
+          profile: If true, time each linalg and TMTensor op of the loaded
+            modules, see `RefBackendInvoker.get_op_profile`. The timers call
+            back into Python, so this is only meaningful for ops that take
+            much longer than a Python call.
+          cache_dir: A directory in which to cache lowered modules across
+            processes, so that compiling the same module again skips the
+            lowering pipeline. Defaults to `TORCH_MLIR_COMPILE_CACHE_DIR`, if
+            set.
+          tuning_db: With `optimize`, the path of a tuning database written
+            by the autotuner (see `autotuner.py`) from which to take the tile
+            sizes of the ops it has entries for. Defaults to
+            `TORCH_MLIR_TUNING_DB`, if set.
+        """
         super().__init__()
+        self.tuning_db = (tuning_db or os.environ.get(TUNING_DB_ENV_VAR)
+                          if optimize else None)
+        self.lowering_pipeline = _get_lowering_pipeline(optimize, num_threads,
+                                                        destination_passing,
+                                                        profile,
+                                                        self.tuning_db)
+        self.profile = profile
+        self.shared_libs = []
+        if num_threads > 1:
+            self.shared_libs.append(
+                get_runtime_library("mlir_async_runtime",
+                                    "to run multithreaded RefBackend modules"))
+        self.cache = CompileCache.from_env_or(cache_dir)
 
     def compile(self, imported_module: Module):
         """Compiles an imported module, with a flat list of functions.
@@ -194,12 +840,62 @@ class RefBackendLinalgOnTensorsBackend(LinalgOnTensorsBackend):
           An opaque, backend specific compiled artifact object that can be
           passed to `load`.
         """
+        if self.cache is not None:
+            # The tuning database is read by the pipeline, so what is in it
+            # is part of the key, not just its path.
+            pipeline = self.lowering_pipeline
+            if self.tuning_db:
+                with open(self.tuning_db) as f:
+                    pipeline += f.read()
+            cache_key = self.cache.get_pipeline_key(imported_module, pipeline)
+            cached_module = self.cache.load(cache_key,
+                                            imported_module.context)
+            if cached_module is not None:
+                return cached_module
 
         run_pipeline_with_repro_report(
-            imported_module, LOWERING_PIPELINE,
+            imported_module, self.lowering_pipeline,
             "Lowering Linalg-on-Tensors IR to LLVM with RefBackend")
+        if self.cache is not None:
+            self.cache.store(cache_key, imported_module)
         return imported_module
 
     def load(self, module) -> RefBackendInvoker:
-        """Loads a compiled artifact into the runtime."""
-        return RefBackendInvoker(module)
+        """Loads a compiled artifact into the runtime.
+
+        Loading a module with the same contents as one of the recently loaded
+        ones returns the invoker that was created for it, without
+        JIT-compiling it again, except when profiling, since the invoker then
+        records the profile of the module.
+        """
+        if self.profile:
+            return RefBackendInvoker(module, self.shared_libs)
+        return _get_cached_invoker(module, self.shared_libs)
+
+    def load_shape_specialized(
+            self, import_fn: Callable[[List[TensorPlaceholder]], Module],
+            example_args, function_name: str = "forward",
+            specialize_after: int = 2,
+            max_specializations: int = 8) -> ShapeSpecializedFunction:
+        """Compiles and loads a function for dynamic shapes, and lazily for
+        the static shapes it is called with most often.
+
+        Args:
+          import_fn: Imports the module for a list of `TensorPlaceholder`
+            arguments, for example with `torch_mlir.compile` and
+            `output_type="linalg-on-tensors"`.
+          example_args: The arguments of the dynamic-shape variant.
+          function_name: The function of the module to call.
+          specialize_after: See `ShapeSpecializedFunction`.
+          max_specializations: See `ShapeSpecializedFunction`.
+        Returns:
+          A `ShapeSpecializedFunction` that takes the same numpy arrays as the
+          loaded function.
+        """
+        def compile_fn(placeholders):
+            invoker = self.load(self.compile(import_fn(placeholders)))
+            return getattr(invoker, function_name)
+
+        return ShapeSpecializedFunction(compile_fn, example_args,
+                                        specialize_after=specialize_after,
+                                        max_specializations=max_specializations)
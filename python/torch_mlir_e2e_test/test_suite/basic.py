@@ -1151,6 +1151,33 @@ def SoftmaxIntArgTypeF64Module_basic(module, tu: TestUtils):
 # ==============================================================================
 
 
+class _SoftmaxMaskedModule(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1], torch.float32, True),
+    ])
+    def forward(self, tensor):
+        return torch.ops.aten._softmax(tensor, dim=1, half_to_float=False)
+
+
+@register_test_case(module_factory=lambda: _SoftmaxMaskedModule())
+def _SoftmaxMaskedModule_basic(module, tu: TestUtils):
+    # Masked out entries, leading and large values must not turn the running
+    # maximum and sum into NaNs.
+    inf = float("inf")
+    module.forward(torch.tensor([[-inf, -inf, 1.0, 2.0, -inf],
+                                 [1e9, -inf, 0.0, -1e9, 3.0],
+                                 [0.5, 0.25, -inf, 0.5, 1e-9]]))
+
+
+# ==============================================================================
+
+
 class _LogSoftmaxModule(torch.nn.Module):
 
     def __init__(self):
@@ -2606,6 +2633,73 @@ def BincountMinlengthModule_basic(module, tu: TestUtils):
 # ==============================================================================
 
 
+class NonzeroModule(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1], torch.int64, True),
+    ])
+    def forward(self, x):
+        return torch.ops.aten.nonzero(x)
+
+
+@register_test_case(module_factory=lambda: NonzeroModule())
+def NonzeroModule_basic(module, tu: TestUtils):
+    module.forward(tu.randint(7, 5, high=3))
+
+
+# ==============================================================================
+
+
+class NonzeroFloatStaticSizeModule(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([2, 3, 4], torch.float32, True),
+    ])
+    def forward(self, x):
+        return torch.ops.aten.nonzero(torch.ops.aten.relu(x))
+
+
+@register_test_case(module_factory=lambda: NonzeroFloatStaticSizeModule())
+def NonzeroFloatStaticSizeModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(2, 3, 4, low=-1.0))
+
+
+# ==============================================================================
+
+
+class MaskedSelectModule(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1], torch.float32, True),
+        ([-1, -1], torch.bool, True),
+    ])
+    def forward(self, x, mask):
+        return torch.ops.aten.masked_select(x, mask)
+
+
+@register_test_case(module_factory=lambda: MaskedSelectModule())
+def MaskedSelectModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(6, 5), tu.randint(6, 5, high=2).to(torch.bool))
+
+
+# ==============================================================================
+
+
 class ExpandAsFloatModule(torch.nn.Module):
 
     def __init__(self):
@@ -3268,6 +3362,74 @@ def AtenEmbeddingBagSumExample_basic(module, tu: TestUtils):
     offsets = torch.LongTensor([0, 3, 5, 7, 9, 10, 15])
     module.forward(weight, indices, offsets)
 
+class AtenEmbeddingBagMeanExample(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1], torch.float32, True),
+        ([-1], torch.int64, True),
+        ([-1], torch.int64, True),
+    ])
+    def forward(self, weight, indices, offsets):
+        return torch.ops.aten.embedding_bag(weight, indices, offsets, scale_grad_by_freq=False, mode=1, sparse=False, per_sample_weights=None, include_last_offset=False, padding_idx=2)[0]
+
+@register_test_case(module_factory=lambda: AtenEmbeddingBagMeanExample())
+def AtenEmbeddingBagMeanExample_basic(module, tu: TestUtils):
+    weight  = tu.rand(100, 10)
+    indices = torch.LongTensor([0, 1, 2, 2, 0, 2, 1, 3, 20, 50, 99, 2, 4, 5, 6, 7, 34, 54])
+    offsets = torch.LongTensor([0, 3, 5, 7, 9, 10, 15])
+    module.forward(weight, indices, offsets)
+
+class AtenEmbeddingBagMaxExample(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1], torch.float32, True),
+        ([-1], torch.int64, True),
+        ([-1], torch.int64, True),
+    ])
+    def forward(self, weight, indices, offsets):
+        result = torch.ops.aten.embedding_bag(weight, indices, offsets, scale_grad_by_freq=False, mode=2, sparse=False, per_sample_weights=None, include_last_offset=True, padding_idx=None)
+        return result[0], result[3]
+
+@register_test_case(module_factory=lambda: AtenEmbeddingBagMaxExample())
+def AtenEmbeddingBagMaxExample_basic(module, tu: TestUtils):
+    weight  = tu.rand(100, 10)
+    indices = torch.LongTensor([0, 1, 2, 2, 0, 2, 1, 3, 20, 50, 99, 2, 4, 5, 6, 7, 34, 54])
+    offsets = torch.LongTensor([0, 3, 5, 7, 9, 10, 15, 18])
+    module.forward(weight, indices, offsets)
+
+class AtenEmbeddingBagPerSampleWeightsExample(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1], torch.float32, True),
+        ([-1], torch.int64, True),
+        ([-1], torch.int64, True),
+        ([-1], torch.float32, True),
+    ])
+    def forward(self, weight, indices, offsets, per_sample_weights):
+        return torch.ops.aten.embedding_bag(weight, indices, offsets, scale_grad_by_freq=False, mode=0, sparse=False, per_sample_weights=per_sample_weights, include_last_offset=False, padding_idx=None)[0]
+
+@register_test_case(module_factory=lambda: AtenEmbeddingBagPerSampleWeightsExample())
+def AtenEmbeddingBagPerSampleWeightsExample_basic(module, tu: TestUtils):
+    weight  = tu.rand(100, 10)
+    indices = torch.LongTensor([0, 1, 2, 2, 0, 2, 1, 3, 20, 50, 99, 2, 4, 5, 6, 7, 34, 54])
+    offsets = torch.LongTensor([0, 3, 5, 7, 9, 10, 15])
+    module.forward(weight, indices, offsets, tu.rand(18))
+
 class Aten_EmbeddingBagExample(torch.nn.Module):
 
     def __init__(self):
@@ -3326,6 +3488,24 @@ class CumsumStaticModule(torch.nn.Module):
 def CumsumStaticModule_basic(module, tu: TestUtils):
     module.forward(tu.rand(2, 7, 4))
 
+class CumsumLongModule(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1], torch.int64, True),
+    ])
+    def forward(self, val):
+        return torch.ops.aten.cumsum(val, 1)
+
+@register_test_case(module_factory=lambda: CumsumLongModule())
+def CumsumLongModule_basic(module, tu: TestUtils):
+    # Long enough to be scanned in several blocks.
+    module.forward(tu.randint(3, 1500, high=10))
+
 class CumsumStaticNegativeDimModule(torch.nn.Module):
 
     def __init__(self):
@@ -3512,6 +3692,25 @@ class SortTensorDescending(torch.nn.Module):
 def SortTensorDescending_basic(module, tu: TestUtils):
     module.forward(tu.rand(3, 4, 5))
 
+
+class SortTensorLong(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([3, 2500], torch.float32, True)
+    ])
+    def forward(self, input):
+        return torch.sort(input, descending=True)
+
+
+@register_test_case(module_factory=lambda: SortTensorLong())
+def SortTensorLong_basic(module, tu: TestUtils):
+    module.forward(tu.rand(3, 2500))
+
 class SortTensorSpecificDimension(torch.nn.Module):
 
     def __init__(self):
@@ -3741,6 +3940,142 @@ def ScaledDotProductAttentionDifferentModule_basic(module, tu: TestUtils):
     value = torch.randn(3, 2, 16, 4, dtype=torch.float32)
     module.forward(query, key, value)
 
+class ScaledDotProductAttentionCausalModule(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1, -1, -1], torch.float32, True),
+        ([-1, -1, -1, -1], torch.float32, True),
+        ([-1, -1, -1, -1], torch.float32, True)
+    ])
+    def forward(self, query, key, value):
+        return torch.ops.aten.scaled_dot_product_attention(
+            query, key, value, is_causal=True)
+
+@register_test_case(module_factory=lambda: ScaledDotProductAttentionCausalModule())
+def ScaledDotProductAttentionCausalModule_basic(module, tu: TestUtils):
+    # Long enough to span several query and key tiles.
+    query = torch.randn(2, 2, 100, 8, dtype=torch.float32)
+    key = torch.randn(2, 2, 100, 8, dtype=torch.float32)
+    value = torch.randn(2, 2, 100, 8, dtype=torch.float32)
+    module.forward(query, key, value)
+
+class ScaledDotProductAttentionScaleModule(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1, -1, -1], torch.float32, True),
+        ([-1, -1, -1, -1], torch.float32, True),
+        ([-1, -1, -1, -1], torch.float32, True)
+    ])
+    def forward(self, query, key, value):
+        return torch.ops.aten.scaled_dot_product_attention(
+            query, key, value, scale=0.3)
+
+@register_test_case(module_factory=lambda: ScaledDotProductAttentionScaleModule())
+def ScaledDotProductAttentionScaleModule_basic(module, tu: TestUtils):
+    query = torch.randn(1, 3, 40, 6, dtype=torch.float32)
+    key = torch.randn(1, 3, 130, 6, dtype=torch.float32)
+    value = torch.randn(1, 3, 130, 5, dtype=torch.float32)
+    module.forward(query, key, value)
+
+class ScaledDotProductAttentionMaskModule(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1, -1, -1], torch.float32, True),
+        ([-1, -1, -1, -1], torch.float32, True),
+        ([-1, -1, -1, -1], torch.float32, True),
+        ([-1, -1], torch.float32, True)
+    ])
+    def forward(self, query, key, value, mask):
+        return torch.ops.aten.scaled_dot_product_attention(
+            query, key, value, attn_mask=mask)
+
+@register_test_case(module_factory=lambda: ScaledDotProductAttentionMaskModule())
+def ScaledDotProductAttentionMaskModule_basic(module, tu: TestUtils):
+    # The additive mask is broadcast over the batch and heads.
+    query = torch.randn(2, 3, 40, 8, dtype=torch.float32)
+    key = torch.randn(2, 3, 70, 8, dtype=torch.float32)
+    value = torch.randn(2, 3, 70, 8, dtype=torch.float32)
+    mask = torch.randn(40, 70, dtype=torch.float32)
+    module.forward(query, key, value, mask)
+
+class ScaledDotProductAttentionBoolMaskModule(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1, -1, -1], torch.float32, True),
+        ([-1, -1, -1, -1], torch.float32, True),
+        ([-1, -1, -1, -1], torch.float32, True),
+        ([-1, 1, -1, -1], torch.bool, True)
+    ])
+    def forward(self, query, key, value, mask):
+        return torch.ops.aten.scaled_dot_product_attention(
+            query, key, value, attn_mask=mask)
+
+@register_test_case(module_factory=lambda: ScaledDotProductAttentionBoolMaskModule())
+def ScaledDotProductAttentionBoolMaskModule_basic(module, tu: TestUtils):
+    # A padding mask per batch, broadcast over the heads. Whole tiles of keys
+    # are masked out for the first batch, but every query attends to the
+    # first key.
+    query = torch.randn(2, 2, 40, 8, dtype=torch.float32)
+    key = torch.randn(2, 2, 150, 8, dtype=torch.float32)
+    value = torch.randn(2, 2, 150, 8, dtype=torch.float32)
+    mask = torch.ones(2, 1, 40, 150, dtype=torch.bool)
+    mask[0, :, :, 1:100] = False
+    mask[1, :, :, 120:] = False
+    module.forward(query, key, value, mask)
+
+
+class KVCacheDecodeModule(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+        # The caches are [seq, batch, heads, dim], so that writing the key and
+        # value of a position is a single slice.
+        self.register_buffer("k_cache", torch.zeros(8, 1, 2, 4))
+        self.register_buffer("v_cache", torch.zeros(8, 1, 2, 4))
+
+    @export
+    @annotate_args([
+        None,
+        ([1, 2, 1, 4], torch.float32, True),
+        ([1, 1, 2, 4], torch.float32, True),
+        ([1, 1, 2, 4], torch.float32, True),
+        ([], torch.int64, True),
+    ])
+    def forward(self, query, key, value, position):
+        p = int(position)
+        self.k_cache[p:p + 1] = key
+        self.v_cache[p:p + 1] = value
+        keys = self.k_cache[:p + 1].permute(1, 2, 0, 3)
+        values = self.v_cache[:p + 1].permute(1, 2, 0, 3)
+        return torch.ops.aten.scaled_dot_product_attention(query, keys, values)
+
+@register_test_case(module_factory=lambda: KVCacheDecodeModule())
+def KVCacheDecodeModule_basic(module, tu: TestUtils):
+    # Each step attends to the keys and values cached by the previous ones.
+    for position in range(3):
+        module.forward(tu.rand(1, 2, 1, 4), tu.rand(1, 1, 2, 4),
+                       tu.rand(1, 1, 2, 4), torch.tensor(position))
+
 # ==============================================================================
 
 
@@ -500,6 +500,58 @@ class ConvolutionModule2DGroups(torch.nn.Module):
 def ConvolutionModule2DGroups_basic(module, tu: TestUtils):
     module.forward(tu.rand(1, 32, 4, 4), tu.rand(32, 8, 3, 3))
 
+class ConvolutionModule2DDepthwise(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([2, 8, 10, 10], torch.float32, True),
+        ([8, 1, 3, 3], torch.float32, True),
+    ])
+    def forward(self, inputVec, weight):
+        return torch.ops.aten.convolution(inputVec,
+                                          weight,
+                                          bias=None,
+                                          stride=[2, 2],
+                                          padding=[1, 1],
+                                          dilation=[1, 1],
+                                          transposed=False,
+                                          output_padding=[0, 0],
+                                          groups=8)
+
+@register_test_case(module_factory=lambda: ConvolutionModule2DDepthwise())
+def ConvolutionModule2DDepthwise_basic(module, tu: TestUtils):
+    module.forward(tu.rand(2, 8, 10, 10), tu.rand(8, 1, 3, 3))
+
+class ConvolutionModule2DDepthwiseMultiplier(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([2, 4, 10, 10], torch.float32, True),
+        ([12, 1, 3, 3], torch.float32, True),
+        ([12], torch.float32, True),
+    ])
+    def forward(self, inputVec, weight, bias):
+        return torch.ops.aten.convolution(inputVec,
+                                          weight,
+                                          bias=bias,
+                                          stride=[1, 1],
+                                          padding=[1, 1],
+                                          dilation=[2, 2],
+                                          transposed=False,
+                                          output_padding=[0, 0],
+                                          groups=4)
+
+@register_test_case(
+    module_factory=lambda: ConvolutionModule2DDepthwiseMultiplier())
+def ConvolutionModule2DDepthwiseMultiplier_basic(module, tu: TestUtils):
+    module.forward(tu.rand(2, 4, 10, 10), tu.rand(12, 1, 3, 3), tu.rand(12))
+
 # ==============================================================================
 
 class ConvolutionModule2DTranspose(torch.nn.Module):
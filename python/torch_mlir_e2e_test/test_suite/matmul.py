@@ -211,6 +211,26 @@ def MatmulBroadcastBatchDim_basic(module, tu: TestUtils):
     
 # ==============================================================================
 
+class MatmulBroadcastRank2Rhs(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([4, 5, -1, 7], torch.float32, True),
+        ([7, 6], torch.float32, True),
+    ])
+    def forward(self, lhs, rhs):
+        return torch.matmul(lhs, rhs)
+
+
+@register_test_case(module_factory=lambda: MatmulBroadcastRank2Rhs())
+def MatmulBroadcastRank2Rhs_basic(module, tu: TestUtils):
+    module.forward(tu.rand(4, 5, 6, 7), tu.rand(7, 6))
+
+# ==============================================================================
+
 class Mv(torch.nn.Module):
 
     @export
@@ -225,4 +245,115 @@ class Mv(torch.nn.Module):
 
 @register_test_case(module_factory=lambda: Mv())
 def Mv_basic(module, tu: TestUtils):
-    module.forward(tu.rand(2, 2), tu.rand(2))
\ No newline at end of file
+    module.forward(tu.rand(2, 2), tu.rand(2))
+
+# ==============================================================================
+
+class EinsumBatchedModule(torch.nn.Module):
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1, -1], torch.float32, True),
+        ([-1, -1, -1], torch.float32, True),
+    ])
+    def forward(self, lhs, rhs):
+        return torch.einsum("bij,bkj->bik", lhs, rhs)
+
+
+@register_test_case(module_factory=lambda: EinsumBatchedModule())
+def EinsumBatchedModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(2, 3, 4), tu.rand(2, 5, 4))
+
+# ==============================================================================
+
+class EinsumMultiOperandModule(torch.nn.Module):
+
+    @export
+    @annotate_args([
+        None,
+        ([8, 3], torch.float32, True),
+        ([3, 5], torch.float32, True),
+        ([5, 2], torch.float32, True),
+    ])
+    def forward(self, a, b, c):
+        return torch.einsum("ij,jk,kl->li", a, b, c)
+
+
+@register_test_case(module_factory=lambda: EinsumMultiOperandModule())
+def EinsumMultiOperandModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(8, 3), tu.rand(3, 5), tu.rand(5, 2))
+
+# ==============================================================================
+
+class EinsumImplicitOutputModule(torch.nn.Module):
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, 4, 3], torch.float32, True),
+        ([3, 5], torch.float32, True),
+    ])
+    def forward(self, lhs, rhs):
+        # The `i` dim of `lhs` is summed before the contraction.
+        return torch.einsum("...ij,jk", lhs, rhs), \
+            torch.einsum("bij,jk->bk", lhs, rhs)
+
+
+@register_test_case(module_factory=lambda: EinsumImplicitOutputModule())
+def EinsumImplicitOutputModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(2, 4, 3), tu.rand(3, 5))
+
+# ==============================================================================
+
+class EinsumMatvecModule(torch.nn.Module):
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1], torch.float32, True),
+        ([-1], torch.float32, True),
+    ])
+    def forward(self, m, v):
+        return torch.einsum("ij,j->i", m, v)
+
+
+@register_test_case(module_factory=lambda: EinsumMatvecModule())
+def EinsumMatvecModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(3, 4), tu.rand(4))
+
+# ==============================================================================
+
+class EinsumBatchedDotModule(torch.nn.Module):
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1], torch.float32, True),
+        ([-1, -1], torch.float32, True),
+    ])
+    def forward(self, lhs, rhs):
+        return torch.einsum("bi,bi->b", lhs, rhs)
+
+
+@register_test_case(module_factory=lambda: EinsumBatchedDotModule())
+def EinsumBatchedDotModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(3, 4), tu.rand(3, 4))
+
+# ==============================================================================
+
+class EinsumFullContractionModule(torch.nn.Module):
+
+    @export
+    @annotate_args([
+        None,
+        ([-1], torch.float32, True),
+        ([-1], torch.float32, True),
+    ])
+    def forward(self, lhs, rhs):
+        return torch.einsum("i,i->", lhs, rhs)
+
+
+@register_test_case(module_factory=lambda: EinsumFullContractionModule())
+def EinsumFullContractionModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(5), tu.rand(5))
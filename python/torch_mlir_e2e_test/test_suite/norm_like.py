@@ -115,6 +115,64 @@ def BatchNorm3DModule_basic(module, tu: TestUtils):
 
 # ==============================================================================
 
+class Conv2dBatchNormModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+        torch.manual_seed(0)
+        self.conv = torch.nn.Conv2d(3, 4, 3, bias=False)
+        self.bn2d = torch.nn.BatchNorm2d(4)
+        self.bn2d.eval()
+        self.bn2d.running_mean = torch.tensor([0.5, 0.4, 0.3, 0.2])
+        self.bn2d.running_var = torch.tensor([3.0, 2.0, 4.0, 2.0])
+        self.bn2d.weight = torch.nn.Parameter(
+            torch.tensor([3.0, 2.0, 4.0, 2.0]))
+        self.bn2d.bias = torch.nn.Parameter(
+            torch.tensor([0.5, 0.4, 0.3, 0.2]))
+
+    @export
+    @annotate_args([
+        None,
+        ([2, 3, 8, 8], torch.float32, True),
+    ])
+    def forward(self, x):
+        return self.bn2d(self.conv(x))
+
+
+@register_test_case(module_factory=lambda: Conv2dBatchNormModule())
+def Conv2dBatchNormModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(2, 3, 8, 8))
+
+# ==============================================================================
+
+class LinearBatchNorm1DModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+        torch.manual_seed(0)
+        self.linear = torch.nn.Linear(3, 4)
+        self.bn1d = torch.nn.BatchNorm1d(4)
+        self.bn1d.eval()
+        self.bn1d.running_mean = torch.tensor([0.5, 0.4, 0.3, 0.2])
+        self.bn1d.running_var = torch.tensor([3.0, 2.0, 4.0, 2.0])
+        self.bn1d.weight = torch.nn.Parameter(
+            torch.tensor([3.0, 2.0, 4.0, 2.0]))
+        self.bn1d.bias = torch.nn.Parameter(
+            torch.tensor([0.5, 0.4, 0.3, 0.2]))
+
+    @export
+    @annotate_args([
+        None,
+        ([5, 3], torch.float32, True),
+    ])
+    def forward(self, x):
+        return self.bn1d(self.linear(x))
+
+
+@register_test_case(module_factory=lambda: LinearBatchNorm1DModule())
+def LinearBatchNorm1DModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(5, 3))
+
+# ==============================================================================
+
 class BatchNorm1DStaticShapeModule(torch.nn.Module):
     def __init__(self):
         super().__init__()
@@ -264,6 +322,48 @@ class NativeGroupNormModule(torch.nn.Module):
 def NativeGroupNormModule_basic(module, tu: TestUtils):
     module.forward(tu.rand(2, 6, 2, 2), tu.rand(6), tu.rand(6))
 
+
+class NativeGroupNormChannelsLastModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([2, 3, 3, 8], torch.float32, True),
+        ([8], torch.float32, True),
+        ([8], torch.float32, True),
+    ])
+    def forward(self, x, weight, bias):
+        return torch.ops.aten.native_group_norm(
+            x.permute(0, 3, 1, 2), weight, bias,
+            2, 8, 9, 4, 0.000001);
+
+
+@register_test_case(module_factory=lambda: NativeGroupNormChannelsLastModule())
+def NativeGroupNormChannelsLastModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(2, 3, 3, 8), tu.rand(8), tu.rand(8))
+
+
+class NativeGroupNormInstanceNormModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([2, 4, 5], torch.float32, True),
+    ])
+    def forward(self, x):
+        return torch.ops.aten.native_group_norm(
+            x, None, None,
+            2, 4, 5, 4, 0.00001);
+
+
+@register_test_case(module_factory=lambda: NativeGroupNormInstanceNormModule())
+def NativeGroupNormInstanceNormModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(2, 4, 5))
+
 class NativeGroupNormBackwardModule(torch.nn.Module):
     def __init__(self):
         super().__init__()
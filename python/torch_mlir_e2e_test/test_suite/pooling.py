@@ -98,6 +98,72 @@ def AdaptiveAvgPool2dUnitOutputSizeDynamicModule_basic(module, tu: TestUtils):
     module.forward(tu.rand(1, 512, 7, 7))
 
 
+class AdaptiveAvgPool2dNonDivisibleOutputSizeModule(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+        self.aap2d = torch.nn.AdaptiveAvgPool2d((3, 4))
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1, -1, -1], torch.float32, True),
+    ])
+    def forward(self, x):
+        return self.aap2d(x)
+
+
+@register_test_case(
+    module_factory=lambda: AdaptiveAvgPool2dNonDivisibleOutputSizeModule())
+def AdaptiveAvgPool2dNonDivisibleOutputSizeModule_basic(
+        module, tu: TestUtils):
+    module.forward(tu.rand(2, 3, 10, 9))
+
+
+# ==============================================================================
+
+
+class AdaptiveMaxPool2dModule(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+        self.amp2d = torch.nn.AdaptiveMaxPool2d((3, 4))
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1, -1, -1], torch.float32, True),
+    ])
+    def forward(self, x):
+        return self.amp2d(x)
+
+
+@register_test_case(module_factory=lambda: AdaptiveMaxPool2dModule())
+def AdaptiveMaxPool2dModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(2, 3, 10, 9, low=-1))
+
+
+class AdaptiveMaxPool2dWithIndicesStaticModule(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+        self.amp2d = torch.nn.AdaptiveMaxPool2d((5, 3), return_indices=True)
+
+    @export
+    @annotate_args([
+        None,
+        ([1, 2, 7, 11], torch.float32, True),
+    ])
+    def forward(self, x):
+        return self.amp2d(x)
+
+
+@register_test_case(
+    module_factory=lambda: AdaptiveMaxPool2dWithIndicesStaticModule())
+def AdaptiveMaxPool2dWithIndicesStaticModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(1, 2, 7, 11, low=-1))
+
+
 # ==============================================================================
 
 
@@ -457,6 +523,14 @@ def MaxPool2dWithIndicesCeilModeTrueModule_basic(module, tu: TestUtils):
 # ==============================================================================
 
 
+def _get_max_pool2d_indices(input):
+    """Returns the indices of the maxima that the pools of the backward tests
+    below select, which are the only indices their backward can be given."""
+    _, indices = torch.ops.aten.max_pool2d_with_indices(
+        input, [2, 2], [1, 1], [1, 1], [1, 1], False)
+    return indices
+
+
 class MaxPool2dWithIndicesBackwardStatic4DModule(torch.nn.Module):
 
     def __init__(self):
@@ -483,8 +557,9 @@ class MaxPool2dWithIndicesBackwardStatic4DModule(torch.nn.Module):
 @register_test_case(
     module_factory=lambda: MaxPool2dWithIndicesBackwardStatic4DModule())
 def MaxPool2dWithIndicesBackwardStatic4DModule_basic(module, tu: TestUtils):
-    module.forward(tu.rand(2, 4, 7, 6), tu.rand(2, 4, 6, 5),
-                   tu.randint(2, 4, 7, 6, high=16))
+    input = tu.rand(2, 4, 6, 5)
+    module.forward(tu.rand(2, 4, 7, 6), input,
+                   _get_max_pool2d_indices(input))
 
 
 class MaxPool2dWithIndicesBackwardStatic3DModule(torch.nn.Module):
@@ -513,8 +588,9 @@ class MaxPool2dWithIndicesBackwardStatic3DModule(torch.nn.Module):
 @register_test_case(
     module_factory=lambda: MaxPool2dWithIndicesBackwardStatic3DModule())
 def MaxPool2dWithIndicesBackwardStatic3DModule_basic(module, tu: TestUtils):
-    module.forward(tu.rand(4, 7, 6), tu.rand(4, 6, 5),
-                   tu.randint(4, 7, 6, high=16))
+    input = tu.rand(4, 6, 5)
+    module.forward(tu.rand(4, 7, 6), input,
+                   _get_max_pool2d_indices(input))
 
 
 class MaxPool2dWithIndicesBackwardDynamic4DModule(torch.nn.Module):
@@ -543,8 +619,9 @@ class MaxPool2dWithIndicesBackwardDynamic4DModule(torch.nn.Module):
 @register_test_case(
     module_factory=lambda: MaxPool2dWithIndicesBackwardDynamic4DModule())
 def MaxPool2dWithIndicesBackwardDynamic4DModule_basic(module, tu: TestUtils):
-    module.forward(tu.rand(2, 4, 7, 6), tu.rand(2, 4, 6, 5),
-                   tu.randint(2, 4, 7, 6, high=16))
+    input = tu.rand(2, 4, 6, 5)
+    module.forward(tu.rand(2, 4, 7, 6), input,
+                   _get_max_pool2d_indices(input))
 
 
 class MaxPool2dWithIndicesBackwardDynamic3DModule(torch.nn.Module):
@@ -573,8 +650,9 @@ class MaxPool2dWithIndicesBackwardDynamic3DModule(torch.nn.Module):
 @register_test_case(
     module_factory=lambda: MaxPool2dWithIndicesBackwardDynamic3DModule())
 def MaxPool2dWithIndicesBackwardDynamic3DModule_basic(module, tu: TestUtils):
-    module.forward(tu.rand(2, 7, 6), tu.rand(2, 6, 5),
-                   tu.randint(2, 7, 6, high=16))
+    input = tu.rand(2, 6, 5)
+    module.forward(tu.rand(2, 7, 6), input,
+                   _get_max_pool2d_indices(input))
 
 
 # ==============================================================================
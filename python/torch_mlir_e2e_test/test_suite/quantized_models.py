@@ -57,3 +57,57 @@ def get_quantized_mlp():
 @register_test_case(module_factory=get_quantized_mlp)
 def QuantizedMLP_basic(module, tu: TestUtils):
     module.forward(get_mlp_input())
+
+# ==============================================================================
+
+
+class QuantizedLinearModule(nn.Module):
+    def __init__(self):
+        super().__init__()
+        torch.random.manual_seed(0)
+        self.weight = torch.quantize_per_tensor(
+            torch.rand(8, 16) - 0.5, 0.01, 0, torch.qint8)
+        self.bias = torch.rand(8)
+
+    @export
+    @annotate_args([
+        None,
+        ([3, 16], torch.float32, True),
+    ])
+    def forward(self, x):
+        x = torch.quantize_per_tensor(x, 0.01, 128, torch.quint8)
+        return torch.nn.functional.linear(x.dequantize(),
+                                          self.weight.dequantize(), self.bias)
+
+
+@register_test_case(module_factory=lambda: QuantizedLinearModule())
+def QuantizedLinearModule_basic(module, tu: TestUtils):
+    module.forward(get_mlp_input().expand(3, 16))
+
+# ==============================================================================
+
+
+class QuantizedLinearPerChannelModule(nn.Module):
+    def __init__(self):
+        super().__init__()
+        torch.random.manual_seed(0)
+        self.weight = torch.quantize_per_channel(
+            torch.rand(8, 16) - 0.5,
+            torch.linspace(0.005, 0.02, 8, dtype=torch.double),
+            torch.zeros(8, dtype=torch.long), 0, torch.qint8)
+        self.bias = torch.rand(8)
+
+    @export
+    @annotate_args([
+        None,
+        ([3, 16], torch.float32, True),
+    ])
+    def forward(self, x):
+        x = torch.quantize_per_tensor(x, 0.01, 128, torch.quint8)
+        return torch.nn.functional.linear(x.dequantize(),
+                                          self.weight.dequantize(), self.bias)
+
+
+@register_test_case(module_factory=lambda: QuantizedLinearPerChannelModule())
+def QuantizedLinearPerChannelModule_basic(module, tu: TestUtils):
+    module.forward(get_mlp_input().expand(3, 16))
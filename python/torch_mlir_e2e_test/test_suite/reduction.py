@@ -882,3 +882,42 @@ class CrossEntropyLossNoReductionModule(torch.nn.Module):
 @register_test_case(module_factory=lambda: CrossEntropyLossNoReductionModule())
 def CrossEntropyLossNoReductionModule_basic(module, tu: TestUtils):
     module.forward(tu.rand(8, 2), tu.randint(8, high=2))
+
+
+class CrossEntropyLossIgnoreIndexModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([-1 , -1], torch.float32, True),
+        ([-1, ], torch.int64, True),
+    ])
+
+    def forward(self, input, target):
+        return torch.ops.aten.cross_entropy_loss(input, target, ignore_index=1)
+
+@register_test_case(module_factory=lambda: CrossEntropyLossIgnoreIndexModule())
+def CrossEntropyLossIgnoreIndexModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(16, 4), tu.randint(16, high=4))
+
+
+class LogSoftmaxNllLossModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([-1 , -1], torch.float32, True),
+        ([-1, ], torch.int64, True),
+    ])
+
+    def forward(self, input, target):
+        log_probs = torch.nn.functional.log_softmax(input, dim=1)
+        return torch.nn.functional.nll_loss(log_probs, target, ignore_index=1)
+
+@register_test_case(module_factory=lambda: LogSoftmaxNllLossModule())
+def LogSoftmaxNllLossModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(16, 4), tu.randint(16, high=4))
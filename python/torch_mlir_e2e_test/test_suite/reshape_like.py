@@ -183,6 +183,44 @@ def ViewCollapseDynamicWithAtenSizeIntModule_basic(module, tu: TestUtils):
 
 # ==============================================================================
 
+class ViewCollapseDynamicWithMulOfSizesModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1, -1, 4], torch.float32, True),
+    ])
+
+    def forward(self, a):
+        return a.view(a.size(0) * a.size(1), a.size(2), 4)
+
+@register_test_case(module_factory=lambda: ViewCollapseDynamicWithMulOfSizesModule())
+def ViewCollapseDynamicWithMulOfSizesModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(2, 3, 5, 4))
+
+# ==============================================================================
+
+class ViewDynamicReorderedSizesModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([-1, -1], torch.float32, True),
+    ])
+
+    def forward(self, a):
+        return a.view(a.size(1), a.size(0))
+
+@register_test_case(module_factory=lambda: ViewDynamicReorderedSizesModule())
+def ViewDynamicReorderedSizesModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(2, 3))
+
+# ==============================================================================
+
 class ViewExpandCollapseWithOnesModule(torch.nn.Module):
     def __init__(self):
         super().__init__()
@@ -170,6 +170,32 @@ def IndexPutImpl2DFloatAccumulateModule_basic(module, tu: TestUtils):
     module.forward(tu.rand(10, 8), tu.randint(5, high=4), tu.rand(5, 8))
 
 
+class IndexPutImpl2DFloatAccumulateRepeatedModule(torch.nn.Module):
+
+    def __init__(self):
+        super().__init__()
+
+    @export
+    @annotate_args([
+        None,
+        ([8, 64], torch.float32, True),
+        ([1000], torch.int64, True),
+        ([1000, 64], torch.float32, True),
+    ])
+    def forward(self, input, index, value):
+        return torch.ops.aten._index_put_impl_(input.clone(), (index, ),
+                                               value,
+                                               accumulate=True,
+                                               unsafe=False)
+
+
+@register_test_case(
+    module_factory=lambda: IndexPutImpl2DFloatAccumulateRepeatedModule())
+def IndexPutImpl2DFloatAccumulateRepeatedModule_basic(module, tu: TestUtils):
+    module.forward(tu.rand(8, 64), tu.randint(1000, high=8),
+                   tu.rand(1000, 64))
+
+
 class IndexPutImpl3DFloatAccumulateModule(torch.nn.Module):
 
     def __init__(self):
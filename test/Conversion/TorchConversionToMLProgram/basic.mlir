@@ -17,3 +17,25 @@ module {
     return %seed : i64
   }
 }
+
+// -----
+
+// CHECK-LABEL:   ml_program.global private mutable @global_rng_offset(dense<0> : tensor<i64>) : tensor<i64>
+// CHECK-LABEL:   ml_program.global private mutable @global_seed(dense<0> : tensor<i64>) : tensor<i64>
+// CHECK-LABEL:   func.func @f(
+// CHECK-SAME:                 %[[INCREMENT:.*]]: i64) -> (i64, i64) {
+// CHECK:           %[[GLOBAL_SEED:.*]] = ml_program.global_load @global_seed : tensor<i64>
+// CHECK:           %[[SEED:.*]] = tensor.extract %[[GLOBAL_SEED]][] : tensor<i64>
+// CHECK:           %[[GLOBAL_OFFSET:.*]] = ml_program.global_load @global_rng_offset : tensor<i64>
+// CHECK:           %[[OFFSET:.*]] = tensor.extract %[[GLOBAL_OFFSET]][] : tensor<i64>
+// CHECK:           %[[NEXT_OFFSET:.*]] = arith.addi %[[OFFSET]], %[[INCREMENT]] : i64
+// CHECK:           %[[INSERTED:.*]] = tensor.insert %[[NEXT_OFFSET]] into %[[GLOBAL_OFFSET]][] : tensor<i64>
+// CHECK:           ml_program.global_store @global_rng_offset = %[[INSERTED]] : tensor<i64>
+// CHECK-NOT:       ml_program.global_store @global_seed
+// CHECK:           return %[[SEED]], %[[OFFSET]] : i64, i64
+module {
+  func.func @f(%arg0: i64) -> (i64, i64) {
+    %seed, %offset = torch_c.get_next_rng_offset %arg0 : (i64) -> (i64, i64)
+    return %seed, %offset : i64, i64
+  }
+}
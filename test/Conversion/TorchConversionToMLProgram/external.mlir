@@ -0,0 +1,31 @@
+// RUN: torch-mlir-opt %s -convert-torch-conversion-to-mlprogram -split-input-file -verify-diagnostics | FileCheck %s
+
+// CHECK:         ml_program.global private @"l1.weight"(#ml_program.extern : tensor<4x3xf32>) : tensor<4x3xf32>
+// CHECK-LABEL:   func.func @f() -> !torch.vtensor<[4,3],f32> {
+// CHECK:           %[[LOAD:.*]] = ml_program.global_load_const @"l1.weight" : tensor<4x3xf32>
+// CHECK:           %[[TENSOR:.*]] = torch_c.from_builtin_tensor %[[LOAD]] : tensor<4x3xf32> -> !torch.vtensor<[4,3],f32>
+// CHECK:           return %[[TENSOR]] : !torch.vtensor<[4,3],f32>
+// CHECK-LABEL:   func.func @g() -> !torch.vtensor<[4,3],f32> {
+// CHECK:           ml_program.global_load_const @"l1.weight" : tensor<4x3xf32>
+// CHECK-NOT:     ml_program.global private @"l1.weight"
+module {
+  func.func @f() -> !torch.vtensor<[4,3],f32> {
+    %0 = torch.vtensor.external "l1.weight" : !torch.vtensor<[4,3],f32>
+    return %0 : !torch.vtensor<[4,3],f32>
+  }
+  func.func @g() -> !torch.vtensor<[4,3],f32> {
+    %0 = torch.vtensor.external "l1.weight" : !torch.vtensor<[4,3],f32>
+    return %0 : !torch.vtensor<[4,3],f32>
+  }
+}
+
+// -----
+
+module {
+  func.func @f() -> (!torch.vtensor<[4,3],f32>, !torch.vtensor<[3],f32>) {
+    %0 = torch.vtensor.external "weight" : !torch.vtensor<[4,3],f32>
+    // expected-error@+1 {{conflicting definition of external tensor 'weight'}}
+    %1 = torch.vtensor.external "weight" : !torch.vtensor<[3],f32>
+    return %0, %1 : !torch.vtensor<[4,3],f32>, !torch.vtensor<[3],f32>
+  }
+}
@@ -0,0 +1,39 @@
+// RUN: torch-mlir-opt %s -convert-torch-conversion-to-mlprogram -split-input-file -verify-diagnostics | FileCheck %s
+
+// CHECK-NOT:     torch.global_slot
+// CHECK:         ml_program.global private mutable @cache(dense<0.000000e+00> : tensor<4xf32>) : tensor<4xf32>
+// CHECK:         ml_program.global private mutable @position(dense<0> : tensor<i64>) : tensor<i64>
+// CHECK-LABEL:   func.func @forward(
+// CHECK-SAME:                       %[[ARG:.*]]: !torch.vtensor<[4],f32>) -> !torch.vtensor<[4],f32> {
+// CHECK:           %[[LOAD:.*]] = ml_program.global_load @cache : tensor<4xf32>
+// CHECK:           %[[CACHE:.*]] = torch_c.from_builtin_tensor %[[LOAD]] : tensor<4xf32> -> !torch.vtensor<[4],f32>
+// CHECK:           %[[BUILTIN_ARG:.*]] = torch_c.to_builtin_tensor %[[ARG]] : !torch.vtensor<[4],f32> -> tensor<4xf32>
+// CHECK:           ml_program.global_store @cache = %[[BUILTIN_ARG]] : tensor<4xf32>
+// CHECK:           return %[[CACHE]] : !torch.vtensor<[4],f32>
+torch.global_slot.module_initializer {
+  %0 = torch.vtensor.literal(dense<0.0> : tensor<4xf32>) : !torch.vtensor<[4],f32>
+  %1 = torch.vtensor.literal(dense<0> : tensor<si64>) : !torch.vtensor<[],si64>
+  torch.initialize.global_slots [
+    @cache(%0 : !torch.vtensor<[4],f32>)
+    @position(%1 : !torch.vtensor<[],si64>)
+  ]
+}
+torch.global_slot "private" @cache : !torch.vtensor<[4],f32>
+torch.global_slot "private" @position : !torch.vtensor<[],si64>
+
+func.func @forward(%arg0: !torch.vtensor<[4],f32>) -> !torch.vtensor<[4],f32> {
+  %0 = torch.global_slot.get @cache : !torch.vtensor<[4],f32>
+  torch.global_slot.set @cache = %arg0 : !torch.vtensor<[4],f32>
+  return %0 : !torch.vtensor<[4],f32>
+}
+
+// -----
+
+torch.global_slot.module_initializer {
+  %0 = torch.constant.int 1
+  // expected-error @+1 {{unsupported global slot @count}}
+  torch.initialize.global_slots [
+    @count(%0 : !torch.int)
+  ]
+}
+torch.global_slot "private" @count : !torch.int
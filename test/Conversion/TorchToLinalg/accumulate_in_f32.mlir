@@ -0,0 +1,89 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="accumulate-in-f32=true" -split-input-file | FileCheck %s
+
+// CHECK-LABEL:   func.func @torch.aten.mm$bf16(
+// CHECK:           %[[LHS:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[4,8],bf16> -> tensor<4x8xbf16>
+// CHECK:           %[[RHS:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[8,2],bf16> -> tensor<8x2xbf16>
+// CHECK:           %[[EMPTY:.*]] = tensor.empty(%{{.*}}, %{{.*}}) : tensor<?x?xf32>
+// CHECK:           %[[ZERO:.*]] = arith.constant 0.000000e+00 : f32
+// CHECK:           %[[FILL:.*]] = linalg.fill ins(%[[ZERO]] : f32) outs(%[[EMPTY]] : tensor<?x?xf32>) -> tensor<?x?xf32>
+// CHECK:           %[[MATMUL:.*]] = linalg.matmul ins(%[[LHS]], %[[RHS]] : tensor<4x8xbf16>, tensor<8x2xbf16>) outs(%[[FILL]] : tensor<?x?xf32>) -> tensor<?x?xf32>
+// CHECK:           %[[TRUNC_INIT:.*]] = tensor.empty(%{{.*}}, %{{.*}}) : tensor<?x?xbf16>
+// CHECK:           %[[TRUNC:.*]] = linalg.generic {{.*}} ins(%[[MATMUL]] : tensor<?x?xf32>) outs(%[[TRUNC_INIT]] : tensor<?x?xbf16>)
+// CHECK:             arith.truncf %{{.*}} : f32 to bf16
+// CHECK:           tensor.cast %[[TRUNC]] : tensor<?x?xbf16> to tensor<4x2xbf16>
+func.func @torch.aten.mm$bf16(%arg0: !torch.vtensor<[4,8],bf16>, %arg1: !torch.vtensor<[8,2],bf16>) -> !torch.vtensor<[4,2],bf16> {
+  %0 = torch.aten.mm %arg0, %arg1 : !torch.vtensor<[4,8],bf16>, !torch.vtensor<[8,2],bf16> -> !torch.vtensor<[4,2],bf16>
+  return %0 : !torch.vtensor<[4,2],bf16>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.mm$f32(
+// CHECK:           linalg.matmul ins(%{{.*}}, %{{.*}} : tensor<4x8xf32>, tensor<8x2xf32>) outs(%{{.*}} : tensor<?x?xf32>)
+// CHECK-NOT:       arith.truncf
+func.func @torch.aten.mm$f32(%arg0: !torch.vtensor<[4,8],f32>, %arg1: !torch.vtensor<[8,2],f32>) -> !torch.vtensor<[4,2],f32> {
+  %0 = torch.aten.mm %arg0, %arg1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,2],f32> -> !torch.vtensor<[4,2],f32>
+  return %0 : !torch.vtensor<[4,2],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.bmm$f16(
+// CHECK:           %[[BMM:.*]] = linalg.batch_matmul ins(%{{.*}}, %{{.*}} : tensor<?x?x?xf16>, tensor<?x?x?xf16>) outs(%{{.*}} : tensor<?x?x?xf32>) -> tensor<?x?x?xf32>
+// CHECK:           linalg.generic {{.*}} ins(%[[BMM]] : tensor<?x?x?xf32>) outs(%{{.*}} : tensor<?x?x?xf16>)
+// CHECK:             arith.truncf %{{.*}} : f32 to f16
+func.func @torch.aten.bmm$f16(%arg0: !torch.vtensor<[?,?,?],f16>, %arg1: !torch.vtensor<[?,?,?],f16>) -> !torch.vtensor<[?,?,?],f16> {
+  %0 = torch.aten.bmm %arg0, %arg1 : !torch.vtensor<[?,?,?],f16>, !torch.vtensor<[?,?,?],f16> -> !torch.vtensor<[?,?,?],f16>
+  return %0 : !torch.vtensor<[?,?,?],f16>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.linear$bf16(
+// CHECK:           %[[BIAS:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[4],bf16> -> tensor<4xbf16>
+// CHECK:           %[[INIT:.*]] = linalg.generic {{.*}} ins(%[[BIAS]] : tensor<4xbf16>) outs(%{{.*}} : tensor<2x5x4xf32>)
+// CHECK:             arith.extf %{{.*}} : bf16 to f32
+// CHECK:           %[[LINEAR:.*]] = linalg.generic {{.*}} outs(%[[INIT]] : tensor<2x5x4xf32>)
+// CHECK:           ^bb0(%[[A:.*]]: bf16, %[[B:.*]]: bf16, %[[ACC:.*]]: f32):
+// CHECK:             %[[A_EXT:.*]] = arith.extf %[[A]] : bf16 to f32
+// CHECK:             %[[B_EXT:.*]] = arith.extf %[[B]] : bf16 to f32
+// CHECK:             %[[MUL:.*]] = arith.mulf %[[A_EXT]], %[[B_EXT]] : f32
+// CHECK:             arith.addf %[[ACC]], %[[MUL]] : f32
+// CHECK:           linalg.generic {{.*}} ins(%[[LINEAR]] : tensor<2x5x4xf32>) outs(%{{.*}} : tensor<2x5x4xbf16>)
+// CHECK:             arith.truncf %{{.*}} : f32 to bf16
+func.func @torch.aten.linear$bf16(%arg0: !torch.vtensor<[2,5,3],bf16>, %arg1: !torch.vtensor<[4,3],bf16>, %arg2: !torch.vtensor<[4],bf16>) -> !torch.vtensor<[2,5,4],bf16> {
+  %0 = torch.aten.linear %arg0, %arg1, %arg2 : !torch.vtensor<[2,5,3],bf16>, !torch.vtensor<[4,3],bf16>, !torch.vtensor<[4],bf16> -> !torch.vtensor<[2,5,4],bf16>
+  return %0 : !torch.vtensor<[2,5,4],bf16>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.convolution$bf16(
+// CHECK:           %[[CONV:.*]] = linalg.conv_2d_nchw_fchw {{.*}} ins(%{{.*}}, %{{.*}} : tensor<1x3x16x16xbf16>, tensor<16x3x3x3xbf16>) outs(%{{.*}} : tensor<1x16x?x?xf32>) -> tensor<1x16x?x?xf32>
+// CHECK:           linalg.generic {{.*}} ins(%[[CONV]] : tensor<1x16x?x?xf32>) outs(%{{.*}} : tensor<1x16x?x?xbf16>)
+// CHECK:             arith.truncf %{{.*}} : f32 to bf16
+func.func @torch.aten.convolution$bf16(%arg0: !torch.vtensor<[1,3,16,16],bf16>, %arg1: !torch.vtensor<[16,3,3,3],bf16>) -> !torch.vtensor<[1,16,14,14],bf16> {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct  : () -> !torch.list<int>
+  %3 = torch.aten.convolution %arg0, %arg1, %none, %0, %1, %0, %false, %2, %int1 : !torch.vtensor<[1,3,16,16],bf16>, !torch.vtensor<[16,3,3,3],bf16>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,16,14,14],bf16>
+  return %3 : !torch.vtensor<[1,16,14,14],bf16>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.mm$extended_operand(
+// CHECK:           %[[LHS:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[4,8],bf16> -> tensor<4x8xbf16>
+// CHECK:           linalg.matmul ins(%[[LHS]], %{{.*}} : tensor<4x8xbf16>, tensor<8x2xf32>) outs(%{{.*}} : tensor<?x?xf32>)
+func.func @torch.aten.mm$extended_operand(%arg0: !torch.vtensor<[4,8],bf16>, %arg1: !torch.vtensor<[8,2],f32>) -> !torch.vtensor<[4,2],f32> {
+  %int6 = torch.constant.int 6
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %0 = torch.aten.to.dtype %arg0, %int6, %false, %false, %none : !torch.vtensor<[4,8],bf16>, !torch.int, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[4,8],f32>
+  %1 = torch.aten.mm %0, %arg1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,2],f32> -> !torch.vtensor<[4,2],f32>
+  return %1 : !torch.vtensor<[4,2],f32>
+}
@@ -29,6 +29,48 @@ func.func @torch.aten.mm$basic(%arg0: !torch.vtensor<[?,?],f32>, %arg1: !torch.v
 
 // -----
 
+// The transpose of the rhs is done by the indexing map of the matmul.
+// CHECK-DAG:   #[[$LHS_MAP:.*]] = affine_map<(d0, d1, d2) -> (d0, d2)>
+// CHECK-DAG:   #[[$RHS_MAP:.*]] = affine_map<(d0, d1, d2) -> (d1, d2)>
+// CHECK-DAG:   #[[$OUT_MAP:.*]] = affine_map<(d0, d1, d2) -> (d0, d1)>
+// CHECK-LABEL:   func.func @torch.aten.mm$transposed_rhs(
+// CHECK-SAME:                        %[[LHS_VTENSOR:.*]]: !torch.vtensor<[4,8],f32>,
+// CHECK-SAME:                        %[[RHS_VTENSOR:.*]]: !torch.vtensor<[2,8],f32>) -> !torch.vtensor<[4,2],f32> {
+// CHECK:           %[[LHS:.*]] = torch_c.to_builtin_tensor %[[LHS_VTENSOR]]
+// CHECK:           %[[RHS:.*]] = torch_c.to_builtin_tensor %[[RHS_VTENSOR]]
+// CHECK:           %[[ZEROFILL:.*]] = linalg.fill
+// CHECK-NOT:       linalg.matmul
+// CHECK:           linalg.generic {indexing_maps = [#[[$LHS_MAP]], #[[$RHS_MAP]], #[[$OUT_MAP]]], iterator_types = ["parallel", "parallel", "reduction"]}
+// CHECK-SAME:          ins(%[[LHS]], %[[RHS]] : tensor<4x8xf32>, tensor<2x8xf32>) outs(%[[ZEROFILL]] : tensor<4x2xf32>)
+// CHECK:             arith.mulf
+// CHECK:             arith.addf
+func.func @torch.aten.mm$transposed_rhs(%arg0: !torch.vtensor<[4,8],f32>, %arg1: !torch.vtensor<[2,8],f32>) -> !torch.vtensor<[4,2],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.transpose.int %arg1, %int0, %int1 : !torch.vtensor<[2,8],f32>, !torch.int, !torch.int -> !torch.vtensor<[8,2],f32>
+  %1 = torch.aten.mm %arg0, %0 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,2],f32> -> !torch.vtensor<[4,2],f32>
+  return %1 : !torch.vtensor<[4,2],f32>
+}
+
+// -----
+
+// CHECK-DAG:   #[[$LHS_MAP:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d3)>
+// CHECK-DAG:   #[[$RHS_MAP:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d2, d3)>
+// CHECK-DAG:   #[[$OUT_MAP:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2)>
+// CHECK-LABEL:   func.func @torch.aten.bmm$transposed_rhs(
+// CHECK-NOT:       linalg.batch_matmul
+// CHECK:           linalg.generic {indexing_maps = [#[[$LHS_MAP]], #[[$RHS_MAP]], #[[$OUT_MAP]]], iterator_types = ["parallel", "parallel", "parallel", "reduction"]}
+// CHECK-SAME:          ins(%{{.*}}, %{{.*}} : tensor<2x4x8xf32>, tensor<2x6x8xf32>) outs(%{{.*}} : tensor<2x4x6xf32>)
+func.func @torch.aten.bmm$transposed_rhs(%arg0: !torch.vtensor<[2,4,8],f32>, %arg1: !torch.vtensor<[2,6,8],f32>) -> !torch.vtensor<[2,4,6],f32> {
+  %int-2 = torch.constant.int -2
+  %int-1 = torch.constant.int -1
+  %0 = torch.aten.transpose.int %arg1, %int-2, %int-1 : !torch.vtensor<[2,6,8],f32>, !torch.int, !torch.int -> !torch.vtensor<[2,8,6],f32>
+  %1 = torch.aten.bmm %arg0, %0 : !torch.vtensor<[2,4,8],f32>, !torch.vtensor<[2,8,6],f32> -> !torch.vtensor<[2,4,6],f32>
+  return %1 : !torch.vtensor<[2,4,6],f32>
+}
+
+// -----
+
 // If the operands are missing dtype, we cannot lower it.
 func.func @torch.aten.mm$no_convert$missing_dtype(%arg0: !torch.vtensor, %arg1: !torch.vtensor) -> !torch.vtensor {
   // expected-error@+1 {{failed to legalize}}
@@ -300,3 +342,294 @@ func.func @torch.aten.index.Tensor(%arg0: !torch.vtensor<[?,?,?],f32>, %arg1: !t
   %2 = torch.aten.index.Tensor %arg0, %1 : !torch.vtensor<[?,?,?],f32>, !torch.list<optional<vtensor>> -> !torch.vtensor<[?,?,?],f32>
   return %2 : !torch.vtensor<[?,?,?],f32>
 }
+
+// -----
+
+// A single index tensor selects contiguous slices, which are copied whole.
+// CHECK-LABEL:   func.func @torch.aten.index.Tensor$slices(
+// CHECK-SAME:                        %[[INPUT_VTENSOR:.*]]: !torch.vtensor<[4,?,8],f32>,
+// CHECK-SAME:                        %[[INDEX_VTENSOR:.*]]: !torch.vtensor<[?],si64>)
+// CHECK-DAG:       %[[INPUT:.*]] = torch_c.to_builtin_tensor %[[INPUT_VTENSOR]]
+// CHECK-DAG:       %[[INDEX:.*]] = torch_c.to_builtin_tensor %[[INDEX_VTENSOR]]
+// CHECK:           %[[INIT:.*]] = tensor.empty(%{{.*}}) : tensor<4x?x8xf32>
+// CHECK:           %[[OUT:.*]] = scf.for %[[I:.*]] = %{{.*}} to %{{.*}} step %{{.*}} iter_args(%[[ACC0:.*]] = %[[INIT]]) -> (tensor<4x?x8xf32>) {
+// CHECK:             scf.for %[[J:.*]] = %{{.*}} to %{{.*}} step %{{.*}} iter_args(%[[ACC1:.*]] = %[[ACC0]]) -> (tensor<4x?x8xf32>) {
+// CHECK:               %[[ELEM:.*]] = tensor.extract %[[INDEX]][%[[J]]] : tensor<?xi64>
+// CHECK:               %[[SELECTED:.*]] = arith.index_cast %[[ELEM]] : i64 to index
+// CHECK:               %[[SLICE:.*]] = tensor.extract_slice %[[INPUT]][%[[I]], %[[SELECTED]], 0] [1, 1, 8] [1, 1, 1] : tensor<4x?x8xf32> to tensor<8xf32>
+// CHECK:               tensor.insert_slice %[[SLICE]] into %[[ACC1]][%[[I]], %[[J]], 0] [1, 1, 8] [1, 1, 1] : tensor<8xf32> into tensor<4x?x8xf32>
+// CHECK-NOT:       linalg.generic
+// CHECK:           tensor.cast %[[OUT]] : tensor<4x?x8xf32> to tensor<4x?x8xf32>
+func.func @torch.aten.index.Tensor$slices(%arg0: !torch.vtensor<[4,?,8],f32>, %arg1: !torch.vtensor<[?],si64>) -> !torch.vtensor<[4,?,8],f32> {
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %none, %arg1 : (!torch.none, !torch.vtensor<[?],si64>) -> !torch.list<optional<vtensor>>
+  %1 = torch.aten.index.Tensor %arg0, %0 : !torch.vtensor<[4,?,8],f32>, !torch.list<optional<vtensor>> -> !torch.vtensor<[4,?,8],f32>
+  return %1 : !torch.vtensor<[4,?,8],f32>
+}
+
+// -----
+
+// Each bag is gathered and reduced by a loop over its own indices inside a
+// single linalg.generic over [bags x embedding_size].
+// CHECK-LABEL:   func.func @torch.aten.embedding_bag.padding_idx$mean(
+// CHECK-SAME:                        %[[WEIGHT_VTENSOR:.*]]: !torch.vtensor<[?,?],f32>,
+// CHECK-SAME:                        %[[INDICES_VTENSOR:.*]]: !torch.vtensor<[?],si64>,
+// CHECK-SAME:                        %[[OFFSETS_VTENSOR:.*]]: !torch.vtensor<[?],si64>)
+// CHECK-DAG:       %[[WEIGHT:.*]] = torch_c.to_builtin_tensor %[[WEIGHT_VTENSOR]]
+// CHECK-DAG:       %[[INDICES:.*]] = torch_c.to_builtin_tensor %[[INDICES_VTENSOR]]
+// CHECK-DAG:       %[[OFFSETS:.*]] = torch_c.to_builtin_tensor %[[OFFSETS_VTENSOR]]
+// CHECK:           %[[OUT:.*]] = linalg.generic {{.*}} iterator_types = ["parallel", "parallel"]} outs(%{{.*}} : tensor<?x?xf32>) {
+// CHECK:             %[[BAG:.*]] = linalg.index 0 : index
+// CHECK:             %[[COLUMN:.*]] = linalg.index 1 : index
+// CHECK:             %[[BEGIN:.*]] = tensor.extract %[[OFFSETS]][%[[BAG]]] : tensor<?xi64>
+// CHECK:             %[[RESULTS:.*]]:2 = scf.for %[[J:.*]] = %{{.*}} to %{{.*}} step %{{.*}} iter_args(%[[ACC:.*]] = %{{.*}}, %[[COUNT:.*]] = %{{.*}}) -> (f32, index) {
+// CHECK:               %[[INDEX:.*]] = tensor.extract %[[INDICES]][%[[J]]] : tensor<?xi64>
+// CHECK:               %[[ROW:.*]] = arith.index_cast %[[INDEX]] : i64 to index
+// CHECK:               %[[ELEM:.*]] = tensor.extract %[[WEIGHT]][%[[ROW]], %[[COLUMN]]] : tensor<?x?xf32>
+// CHECK:               %[[IS_VALID:.*]] = arith.cmpi ne, %[[INDEX]], %{{.*}} : i64
+// CHECK:               %[[SUM:.*]] = arith.addf %[[ACC]], %[[ELEM]] : f32
+// CHECK:               arith.select %[[IS_VALID]], %[[SUM]], %[[ACC]] : f32
+// CHECK:             arith.divf %[[RESULTS]]#0
+// CHECK:           } -> tensor<?x?xf32>
+// CHECK-NOT:       tensor<?x?x?xf32>
+func.func @torch.aten.embedding_bag.padding_idx$mean(%weight: !torch.vtensor<[?,?],f32>, %indices: !torch.vtensor<[?],si64>, %offsets: !torch.vtensor<[?],si64>) -> !torch.vtensor<[?,?],f32> {
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %0:4 = torch.aten.embedding_bag.padding_idx %weight, %indices, %offsets, %false, %int1, %false, %none, %false, %int2 : !torch.vtensor<[?,?],f32>, !torch.vtensor<[?],si64>, !torch.vtensor<[?],si64>, !torch.bool, !torch.int, !torch.bool, !torch.none, !torch.bool, !torch.int -> !torch.vtensor<[?,?],f32>, !torch.vtensor<[0],si64>, !torch.vtensor<[?],si64>, !torch.vtensor<[?],si64>
+  return %0#0 : !torch.vtensor<[?,?],f32>
+}
+
+// -----
+
+// Each embedding is copied as a slice by a loop nest over the indices.
+// CHECK-LABEL:   func.func @torch.aten.embedding(
+// CHECK-SAME:                        %[[WEIGHT_VTENSOR:.*]]: !torch.vtensor<[?,?],f32>,
+// CHECK-SAME:                        %[[INDICES_VTENSOR:.*]]: !torch.vtensor<[?,?],si64>)
+// CHECK-DAG:       %[[WEIGHT:.*]] = torch_c.to_builtin_tensor %[[WEIGHT_VTENSOR]]
+// CHECK-DAG:       %[[INDICES:.*]] = torch_c.to_builtin_tensor %[[INDICES_VTENSOR]]
+// CHECK:           %[[INIT:.*]] = tensor.empty(%{{.*}}, %{{.*}}, %{{.*}}) : tensor<?x?x?xf32>
+// CHECK:           %[[OUT:.*]] = scf.for %[[I:.*]] = %{{.*}} to %{{.*}} step %{{.*}} iter_args(%[[ACC0:.*]] = %[[INIT]]) -> (tensor<?x?x?xf32>) {
+// CHECK:             scf.for %[[J:.*]] = %{{.*}} to %{{.*}} step %{{.*}} iter_args(%[[ACC1:.*]] = %[[ACC0]]) -> (tensor<?x?x?xf32>) {
+// CHECK:               %[[INDEX:.*]] = tensor.extract %[[INDICES]][%[[I]], %[[J]]] : tensor<?x?xi64>
+// CHECK:               %[[ROW_INDEX:.*]] = arith.index_cast %[[INDEX]] : i64 to index
+// CHECK:               %[[ROW:.*]] = tensor.extract_slice %[[WEIGHT]][%[[ROW_INDEX]], 0] [1, %{{.*}}] [1, 1] : tensor<?x?xf32> to tensor<?xf32>
+// CHECK:               %[[INSERT:.*]] = tensor.insert_slice %[[ROW]] into %[[ACC1]][%[[I]], %[[J]], 0] [1, 1, %{{.*}}] [1, 1, 1] : tensor<?xf32> into tensor<?x?x?xf32>
+// CHECK:               scf.yield %[[INSERT]] : tensor<?x?x?xf32>
+// CHECK-NOT:       linalg.generic
+// CHECK:           tensor.cast %[[OUT]] : tensor<?x?x?xf32> to tensor<?x?x?xf32>
+func.func @torch.aten.embedding(%weight: !torch.vtensor<[?,?],f32>, %indices: !torch.vtensor<[?,?],si64>) -> !torch.vtensor<[?,?,?],f32> {
+  %false = torch.constant.bool false
+  %int-1 = torch.constant.int -1
+  %0 = torch.aten.embedding %weight, %indices, %int-1, %false, %false : !torch.vtensor<[?,?],f32>, !torch.vtensor<[?,?],si64>, !torch.int, !torch.bool, !torch.bool -> !torch.vtensor<[?,?,?],f32>
+  return %0 : !torch.vtensor<[?,?,?],f32>
+}
+
+// -----
+
+// CHECK-DAG:     #[[INPUT_MAP:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d3)>
+// CHECK-DAG:     #[[WEIGHT_MAP:.*]] = affine_map<(d0, d1, d2, d3) -> (d2, d3)>
+// CHECK-DAG:     #[[OUT_MAP:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2)>
+// CHECK-DAG:     #[[BIAS_MAP:.*]] = affine_map<(d0, d1, d2) -> (d2)>
+// CHECK-LABEL:   func.func @torch.aten.linear$bias(
+// CHECK:           %[[INPUT:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[2,5,3],f32> -> tensor<2x5x3xf32>
+// CHECK:           %[[WEIGHT:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[4,3],f32> -> tensor<4x3xf32>
+// CHECK:           %[[BIAS:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[4],f32> -> tensor<4xf32>
+// CHECK:           %[[EMPTY:.*]] = tensor.empty() : tensor<2x5x4xf32>
+// CHECK:           %[[INIT:.*]] = linalg.generic {indexing_maps = [#[[BIAS_MAP]], {{.*}}], iterator_types = ["parallel", "parallel", "parallel"]} ins(%[[BIAS]] : tensor<4xf32>) outs(%[[EMPTY]] : tensor<2x5x4xf32>)
+// CHECK:           %[[LINEAR:.*]] = linalg.generic {indexing_maps = [#[[INPUT_MAP]], #[[WEIGHT_MAP]], #[[OUT_MAP]]], iterator_types = ["parallel", "parallel", "parallel", "reduction"]}
+// CHECK-SAME:          ins(%[[INPUT]], %[[WEIGHT]] : tensor<2x5x3xf32>, tensor<4x3xf32>) outs(%[[INIT]] : tensor<2x5x4xf32>)
+// CHECK:           ^bb0(%[[A:.*]]: f32, %[[B:.*]]: f32, %[[ACC:.*]]: f32):
+// CHECK:             %[[MUL:.*]] = arith.mulf %[[A]], %[[B]] : f32
+// CHECK:             %[[ADD:.*]] = arith.addf %[[ACC]], %[[MUL]] : f32
+// CHECK:             linalg.yield %[[ADD]] : f32
+// CHECK-NOT:       linalg.generic
+func.func @torch.aten.linear$bias(%arg0: !torch.vtensor<[2,5,3],f32>, %arg1: !torch.vtensor<[4,3],f32>, %arg2: !torch.vtensor<[4],f32>) -> !torch.vtensor<[2,5,4],f32> {
+  %0 = torch.aten.linear %arg0, %arg1, %arg2 : !torch.vtensor<[2,5,3],f32>, !torch.vtensor<[4,3],f32>, !torch.vtensor<[4],f32> -> !torch.vtensor<[2,5,4],f32>
+  return %0 : !torch.vtensor<[2,5,4],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.linear$no_bias(
+// CHECK:           %[[ZERO:.*]] = arith.constant 0.000000e+00 : f32
+// CHECK:           %[[INIT:.*]] = linalg.fill ins(%[[ZERO]] : f32) outs(%{{.*}} : tensor<?x4xf32>) -> tensor<?x4xf32>
+// CHECK:           linalg.generic {{.*}} iterator_types = ["parallel", "parallel", "reduction"]
+// CHECK-SAME:          outs(%[[INIT]] : tensor<?x4xf32>)
+func.func @torch.aten.linear$no_bias(%arg0: !torch.vtensor<[?,3],f32>, %arg1: !torch.vtensor<[4,3],f32>) -> !torch.vtensor<[?,4],f32> {
+  %none = torch.constant.none
+  %0 = torch.aten.linear %arg0, %arg1, %none : !torch.vtensor<[?,3],f32>, !torch.vtensor<[4,3],f32>, !torch.none -> !torch.vtensor<[?,4],f32>
+  return %0 : !torch.vtensor<[?,4],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.matmul$broadcast_rank2_rhs(
+// CHECK:           %[[LHS:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[2,3,4,5],f32> -> tensor<2x3x4x5xf32>
+// CHECK:           %[[RHS:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[5,6],f32> -> tensor<5x6xf32>
+// CHECK:           %[[COLLAPSED:.*]] = tensor.collapse_shape %[[LHS]] {{\[\[}}0, 1, 2], [3]] : tensor<2x3x4x5xf32> into tensor<24x5xf32>
+// CHECK:           %[[MATMUL:.*]] = linalg.matmul ins(%[[COLLAPSED]], %[[RHS]] : tensor<24x5xf32>, tensor<5x6xf32>)
+// CHECK:           %[[EXPANDED:.*]] = tensor.expand_shape %[[MATMUL]] {{\[\[}}0, 1, 2], [3]] : tensor<24x6xf32> into tensor<2x3x4x6xf32>
+// CHECK-NOT:       linalg.generic
+func.func @torch.aten.matmul$broadcast_rank2_rhs(%arg0: !torch.vtensor<[2,3,4,5],f32>, %arg1: !torch.vtensor<[5,6],f32>) -> !torch.vtensor<[2,3,4,6],f32> {
+  %0 = torch.aten.matmul %arg0, %arg1 : !torch.vtensor<[2,3,4,5],f32>, !torch.vtensor<[5,6],f32> -> !torch.vtensor<[2,3,4,6],f32>
+  return %0 : !torch.vtensor<[2,3,4,6],f32>
+}
+
+// -----
+
+// CHECK-DAG:     #[[LHS_MAP:.*]] = affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d2, d3)>
+// CHECK-DAG:     #[[RHS_MAP:.*]] = affine_map<(d0, d1, d2, d3, d4) -> (d1, d3, d4)>
+// CHECK-DAG:     #[[OUT_MAP:.*]] = affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d2, d4)>
+// CHECK-LABEL:   func.func @torch.aten.matmul$broadcast_batch(
+// CHECK:           %[[LHS:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[2,3,4,5],f32> -> tensor<2x3x4x5xf32>
+// CHECK:           %[[RHS:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[3,5,6],f32> -> tensor<3x5x6xf32>
+// CHECK:           %[[INIT:.*]] = linalg.fill
+// CHECK:           linalg.generic {indexing_maps = [#[[LHS_MAP]], #[[RHS_MAP]], #[[OUT_MAP]]], iterator_types = ["parallel", "parallel", "parallel", "reduction", "parallel"]}
+// CHECK-SAME:          ins(%[[LHS]], %[[RHS]] : tensor<2x3x4x5xf32>, tensor<3x5x6xf32>) outs(%[[INIT]] : tensor<2x3x4x6xf32>)
+// CHECK-NOT:       linalg.generic
+func.func @torch.aten.matmul$broadcast_batch(%arg0: !torch.vtensor<[2,3,4,5],f32>, %arg1: !torch.vtensor<[3,5,6],f32>) -> !torch.vtensor<[2,3,4,6],f32> {
+  %0 = torch.aten.matmul %arg0, %arg1 : !torch.vtensor<[2,3,4,5],f32>, !torch.vtensor<[3,5,6],f32> -> !torch.vtensor<[2,3,4,6],f32>
+  return %0 : !torch.vtensor<[2,3,4,6],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.uniform(
+// CHECK:           %[[NUMEL0:.*]] = arith.muli %{{.*}}, %{{.*}} : i64
+// CHECK:           %[[NUMEL:.*]] = arith.muli %[[NUMEL0]], %{{.*}} : i64
+// CHECK:           %[[SEED:.*]], %[[OFFSET:.*]] = torch_c.get_next_rng_offset %[[NUMEL]] : (i64) -> (i64, i64)
+// CHECK:           %[[KEY:.*]] = arith.addi %{{.*}}, %{{.*}} : i64
+// CHECK:           linalg.generic {{.*}} iterator_types = ["parallel", "parallel"]
+// CHECK:             %[[INDEX:.*]] = arith.addi %{{.*}}, %{{.*}} : i64
+// CHECK:             %[[COUNTER:.*]] = arith.addi %[[OFFSET]], %[[INDEX]] : i64
+// CHECK:             arith.muli %[[COUNTER]], %[[KEY]] : i64
+func.func @torch.aten.uniform(%arg0: !torch.vtensor<[3,4],f64>) -> !torch.vtensor<[3,4],f64> {
+  %none = torch.constant.none
+  %float0 = torch.constant.float 0.000000e+00
+  %float1 = torch.constant.float 1.000000e+00
+  %0 = torch.aten.uniform %arg0, %float0, %float1, %none : !torch.vtensor<[3,4],f64>, !torch.float, !torch.float, !torch.none -> !torch.vtensor<[3,4],f64>
+  return %0 : !torch.vtensor<[3,4],f64>
+}
+
+// -----
+
+// The max and its index are computed by two single-result reductions.
+// CHECK-LABEL:   func.func @torch.aten.max.dim(
+// CHECK-SAME:                        %[[INPUT_VTENSOR:.*]]: !torch.vtensor<[?,?],f32>)
+// CHECK:           %[[INPUT:.*]] = torch_c.to_builtin_tensor %[[INPUT_VTENSOR]]
+// CHECK:           %[[MAX:.*]] = linalg.generic {{.*}} iterator_types = ["parallel", "reduction"]} ins(%[[INPUT]] : tensor<?x?xf32>) outs(%{{.*}} : tensor<?xf32>) {
+// CHECK:           ^bb0(%[[IN:.*]]: f32, %[[ACC:.*]]: f32):
+// CHECK:             %[[NEW_MAX:.*]] = arith.maxf %[[IN]], %[[ACC]] : f32
+// CHECK:             linalg.yield %[[NEW_MAX]] : f32
+// CHECK:           %[[IDX:.*]] = linalg.generic {{.*}} iterator_types = ["parallel", "reduction"]} ins(%[[INPUT]], %[[MAX]] : tensor<?x?xf32>, tensor<?xf32>) outs(%{{.*}} : tensor<?xi64>) {
+// CHECK:           ^bb0(%[[VALUE:.*]]: f32, %[[MAX_VALUE:.*]]: f32, %[[OLD_IDX:.*]]: i64):
+// CHECK:             %[[EQ:.*]] = arith.cmpf oeq, %[[VALUE]], %[[MAX_VALUE]] : f32
+// CHECK:             %[[NAN:.*]] = arith.cmpf uno, %[[VALUE]], %[[VALUE]] : f32
+// CHECK:             %[[IS_MAX:.*]] = arith.ori %[[EQ]], %[[NAN]] : i1
+// CHECK:             %[[SELECT:.*]] = arith.select %[[IS_MAX]], %{{.*}}, %{{.*}} : i64
+// CHECK:             %[[NEW_IDX:.*]] = arith.minsi %[[SELECT]], %[[OLD_IDX]] : i64
+// CHECK:             linalg.yield %[[NEW_IDX]] : i64
+func.func @torch.aten.max.dim(%arg0: !torch.vtensor<[?,?],f32>) -> (!torch.vtensor<[?],f32>, !torch.vtensor<[?],si64>) {
+  %int1 = torch.constant.int 1
+  %false = torch.constant.bool false
+  %values, %indices = torch.aten.max.dim %arg0, %int1, %false : !torch.vtensor<[?,?],f32>, !torch.int, !torch.bool -> !torch.vtensor<[?],f32>, !torch.vtensor<[?],si64>
+  return %values, %indices : !torch.vtensor<[?],f32>, !torch.vtensor<[?],si64>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.view_as_complex(
+// CHECK-SAME:                                          %[[ARG:.*]]: !torch.vtensor<[5,2],f32>) -> !torch.vtensor<[5],complex<f32>> {
+// CHECK:           %[[INPUT:.*]] = torch_c.to_builtin_tensor %[[ARG]] : !torch.vtensor<[5,2],f32> -> tensor<5x2xf32>
+// CHECK:           %[[REAL:.*]] = tensor.extract_slice %[[INPUT]][0, 0] [5, 1] [1, 1] : tensor<5x2xf32> to tensor<5xf32>
+// CHECK:           %[[IMAG:.*]] = tensor.extract_slice %[[INPUT]][0, 1] [5, 1] [1, 1] : tensor<5x2xf32> to tensor<5xf32>
+// CHECK:           %[[EMPTY:.*]] = tensor.empty() : tensor<5xcomplex<f32>>
+// CHECK:           linalg.generic {{.*}} ins(%[[REAL]], %[[IMAG]] : tensor<5xf32>, tensor<5xf32>) outs(%[[EMPTY]] : tensor<5xcomplex<f32>>) {
+// CHECK:           ^bb0(%[[RE:.*]]: f32, %[[IM:.*]]: f32, %{{.*}}: complex<f32>):
+// CHECK:             %[[COMPLEX:.*]] = complex.create %[[RE]], %[[IM]] : complex<f32>
+// CHECK:             linalg.yield %[[COMPLEX]] : complex<f32>
+func.func @torch.aten.view_as_complex(%arg0: !torch.vtensor<[5,2],f32>) -> !torch.vtensor<[5],complex<f32>> {
+  %0 = torch.aten.view_as_complex %arg0 : !torch.vtensor<[5,2],f32> -> !torch.vtensor<[5],complex<f32>>
+  return %0 : !torch.vtensor<[5],complex<f32>>
+}
+
+// -----
+
+// FP8 matmuls accumulate in f32.
+// CHECK-LABEL:   func.func @torch.aten.mm$f8E4M3FN(
+// CHECK:           %[[LHS:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[4,8],f8E4M3FN> -> tensor<4x8xf8E4M3FN>
+// CHECK:           %[[RHS:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[8,2],f8E4M3FN> -> tensor<8x2xf8E4M3FN>
+// CHECK:           %[[FILL:.*]] = linalg.fill ins(%{{.*}} : f32) outs(%{{.*}} : tensor<?x?xf32>) -> tensor<?x?xf32>
+// CHECK:           %[[MATMUL:.*]] = linalg.matmul ins(%[[LHS]], %[[RHS]] : tensor<4x8xf8E4M3FN>, tensor<8x2xf8E4M3FN>) outs(%[[FILL]] : tensor<?x?xf32>) -> tensor<?x?xf32>
+// CHECK:           linalg.generic {{.*}} ins(%[[MATMUL]] : tensor<?x?xf32>) outs(%{{.*}} : tensor<?x?xf8E4M3FN>)
+// CHECK:             arith.truncf %{{.*}} : f32 to f8E4M3FN
+func.func @torch.aten.mm$f8E4M3FN(%arg0: !torch.vtensor<[4,8],f8E4M3FN>, %arg1: !torch.vtensor<[8,2],f8E4M3FN>) -> !torch.vtensor<[4,2],f8E4M3FN> {
+  %0 = torch.aten.mm %arg0, %arg1 : !torch.vtensor<[4,8],f8E4M3FN>, !torch.vtensor<[8,2],f8E4M3FN> -> !torch.vtensor<[4,2],f8E4M3FN>
+  return %0 : !torch.vtensor<[4,2],f8E4M3FN>
+}
+
+// -----
+
+// A scaled FP8 matmul reads its FP8 operands directly and scales the f32
+// result.
+// CHECK-LABEL:   func.func @torch.aten.mm$scaled_f8E5M2(
+// CHECK:           %[[LHS:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[4,8],f8E5M2> -> tensor<4x8xf8E5M2>
+// CHECK:           %[[RHS:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[8,2],f8E5M2> -> tensor<8x2xf8E5M2>
+// CHECK:           %[[MATMUL:.*]] = linalg.matmul ins(%[[LHS]], %[[RHS]] : tensor<4x8xf8E5M2>, tensor<8x2xf8E5M2>) outs(%{{.*}} : tensor<?x?xf32>) -> tensor<?x?xf32>
+// CHECK-NOT:       arith.truncf
+// CHECK:           arith.mulf
+func.func @torch.aten.mm$scaled_f8E5M2(%arg0: !torch.vtensor<[4,8],f8E5M2>, %arg1: !torch.vtensor<[8,2],f8E5M2>, %arg2: !torch.vtensor<[],f32>) -> !torch.vtensor<[4,2],f32> {
+  %int6 = torch.constant.int 6
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %0 = torch.aten.to.dtype %arg0, %int6, %false, %false, %none : !torch.vtensor<[4,8],f8E5M2>, !torch.int, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[4,8],f32>
+  %1 = torch.aten.to.dtype %arg1, %int6, %false, %false, %none : !torch.vtensor<[8,2],f8E5M2>, !torch.int, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[8,2],f32>
+  %2 = torch.aten.mm %0, %1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,2],f32> -> !torch.vtensor<[4,2],f32>
+  %3 = torch.aten.mul.Tensor %2, %arg2 : !torch.vtensor<[4,2],f32>, !torch.vtensor<[],f32> -> !torch.vtensor<[4,2],f32>
+  return %3 : !torch.vtensor<[4,2],f32>
+}
+
+// -----
+
+#CSR = #sparse_tensor.encoding<{ dimLevelType = [ "dense", "compressed" ] }>
+
+// CHECK-LABEL:   func.func @torch.aten.mm$sparse(
+// CHECK-SAME:                                    %[[DENSE_VTENSOR:.*]]: !torch.vtensor<[8,16],f32>,
+// CHECK-SAME:                                    %[[RHS_VTENSOR:.*]]: !torch.vtensor<[16,4],f32>) -> !torch.vtensor<[8,4],f32> {
+// CHECK-DAG:       %[[DENSE:.*]] = torch_c.to_builtin_tensor %[[DENSE_VTENSOR]] : !torch.vtensor<[8,16],f32> -> tensor<8x16xf32>
+// CHECK-DAG:       %[[RHS:.*]] = torch_c.to_builtin_tensor %[[RHS_VTENSOR]] : !torch.vtensor<[16,4],f32> -> tensor<16x4xf32>
+// CHECK:           %[[LHS:.*]] = sparse_tensor.convert %[[DENSE]] : tensor<8x16xf32> to tensor<8x16xf32, #[[CSR:.*]]>
+// CHECK:           %[[ZEROFILL:.*]] = linalg.fill
+// CHECK:           linalg.matmul ins(%[[LHS]], %[[RHS]] : tensor<8x16xf32, #[[CSR]]>, tensor<16x4xf32>) outs(%[[ZEROFILL]] : tensor<8x4xf32>) -> tensor<8x4xf32>
+func.func @torch.aten.mm$sparse(%arg0: !torch.vtensor<[8,16],f32>, %arg1: !torch.vtensor<[16,4],f32>) -> !torch.vtensor<[8,4],f32> {
+  %0 = torch.tensor_static_info_cast %arg0 : !torch.vtensor<[8,16],f32> to !torch.vtensor<[8,16],f32,#CSR>
+  %1 = torch.aten.mm %0, %arg1 : !torch.vtensor<[8,16],f32,#CSR>, !torch.vtensor<[16,4],f32> -> !torch.vtensor<[8,4],f32>
+  return %1 : !torch.vtensor<[8,4],f32>
+}
+
+// -----
+
+// CHECK-DAG:   #[[WEIGHT_MAP:.*]] = affine_map<(d0, d1, d2) -> (d1, d2)>
+// CHECK-DAG:   #[[OUTPUT_MAP:.*]] = affine_map<(d0, d1, d2) -> (d0, d1)>
+// CHECK-LABEL: func.func @torch.semi_structured_sparse.linear(
+// CHECK:         %[[INPUT:.*]] = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[2,8],f32> -> tensor<2x8xf32>
+// CHECK:         %[[INIT:.*]] = linalg.fill
+// CHECK:         linalg.generic {indexing_maps = [#[[WEIGHT_MAP]], #[[WEIGHT_MAP]], #[[OUTPUT_MAP]]], iterator_types = ["parallel", "parallel", "reduction"]} ins(%{{.*}}, %{{.*}} : tensor<3x4xf32>, tensor<3x4xi8>) outs(%[[INIT]] : tensor<2x3xf32>)
+// CHECK:         ^bb0(%[[VALUE:.*]]: f32, %[[INDEX:.*]]: i8, %[[ACC:.*]]: f32):
+// CHECK:           %[[B:.*]] = linalg.index 0 : index
+// CHECK:           %[[J:.*]] = linalg.index 2 : index
+// CHECK:           %[[J2:.*]] = arith.shli %[[J]], %{{.*}} : index
+// CHECK:           %[[GROUP:.*]] = arith.andi %[[J2]], %{{.*}} : index
+// CHECK:           %[[OFFSET:.*]] = arith.index_cast %[[INDEX]] : i8 to index
+// CHECK:           %[[K:.*]] = arith.addi %[[GROUP]], %[[OFFSET]] : index
+// CHECK:           %[[X:.*]] = tensor.extract %[[INPUT]][%[[B]], %[[K]]] : tensor<2x8xf32>
+// CHECK:           %[[PRODUCT:.*]] = arith.mulf %[[X]], %[[VALUE]] : f32
+// CHECK:           %[[SUM:.*]] = arith.addf %[[ACC]], %[[PRODUCT]] : f32
+// CHECK:           linalg.yield %[[SUM]] : f32
+func.func @torch.semi_structured_sparse.linear(%arg0: !torch.vtensor<[2,8],f32>, %arg1: !torch.vtensor<[3,4],f32>, %arg2: !torch.vtensor<[3,4],si8>) -> !torch.vtensor<[2,3],f32> {
+  %none = torch.constant.none
+  %0 = torch.semi_structured_sparse.linear %arg0, %arg1, %arg2, %none : !torch.vtensor<[2,8],f32>, !torch.vtensor<[3,4],f32>, !torch.vtensor<[3,4],si8>, !torch.none -> !torch.vtensor<[2,3],f32>
+  return %0 : !torch.vtensor<[2,3],f32>
+}
@@ -0,0 +1,49 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg -split-input-file -verify-diagnostics | FileCheck %s
+
+// CHECK-LABEL:   func.func @torch.aten.bucketize.Tensor(
+// CHECK-SAME:                                           %[[ARG0:.*]]: !torch.vtensor<[?,4],f32>,
+// CHECK-SAME:                                           %[[ARG1:.*]]: !torch.vtensor<[?],f32>) -> !torch.vtensor<[?,4],si64> {
+// CHECK-DAG:       %[[INPUT:.*]] = torch_c.to_builtin_tensor %[[ARG0]] : !torch.vtensor<[?,4],f32> -> tensor<?x4xf32>
+// CHECK-DAG:       %[[BOUNDARIES:.*]] = torch_c.to_builtin_tensor %[[ARG1]] : !torch.vtensor<[?],f32> -> tensor<?xf32>
+// CHECK:           %[[EMPTY:.*]] = tensor.empty(%{{.*}}) : tensor<?x4xi64>
+// CHECK-DAG:       %[[C0:.*]] = arith.constant 0 : index
+// CHECK-DAG:       %[[C1:.*]] = arith.constant 1 : index
+// CHECK:           %[[NUM_BOUNDARIES:.*]] = tensor.dim %[[BOUNDARIES]], %{{.*}} : tensor<?xf32>
+// CHECK:           %[[GENERIC:.*]] = linalg.generic {{.*}} ins(%[[INPUT]] : tensor<?x4xf32>) outs(%[[EMPTY]] : tensor<?x4xi64>) {
+// CHECK:           ^bb0(%[[VALUE:.*]]: f32, %{{.*}}: i64):
+// CHECK:             %[[SEARCH:.*]]:2 = scf.while (%[[LO:.*]] = %[[C0]], %[[HI:.*]] = %[[NUM_BOUNDARIES]]) : (index, index) -> (index, index) {
+// CHECK:               %[[NOT_EMPTY:.*]] = arith.cmpi ult, %[[LO]], %[[HI]] : index
+// CHECK:               scf.condition(%[[NOT_EMPTY]]) %[[LO]], %[[HI]] : index, index
+// CHECK:             } do {
+// CHECK:             ^bb0(%[[LO:.*]]: index, %[[HI:.*]]: index):
+// CHECK:               %[[SUM:.*]] = arith.addi %[[LO]], %[[HI]] : index
+// CHECK:               %[[MID:.*]] = arith.shrui %[[SUM]], %[[C1]] : index
+// CHECK:               %[[BOUNDARY:.*]] = tensor.extract %[[BOUNDARIES]][%[[MID]]] : tensor<?xf32>
+// CHECK:               %[[BELOW:.*]] = arith.cmpf olt, %[[BOUNDARY]], %[[VALUE]] : f32
+// CHECK:               %[[MID_PLUS_ONE:.*]] = arith.addi %[[MID]], %[[C1]] : index
+// CHECK:               %[[NEW_LO:.*]] = arith.select %[[BELOW]], %[[MID_PLUS_ONE]], %[[LO]] : index
+// CHECK:               %[[NEW_HI:.*]] = arith.select %[[BELOW]], %[[HI]], %[[MID]] : index
+// CHECK:               scf.yield %[[NEW_LO]], %[[NEW_HI]] : index, index
+// CHECK:             }
+// CHECK:             %[[BUCKET:.*]] = arith.index_cast %[[SEARCH]]#0 : index to i64
+// CHECK:             linalg.yield %[[BUCKET]] : i64
+// CHECK:           } -> tensor<?x4xi64>
+func.func @torch.aten.bucketize.Tensor(%arg0: !torch.vtensor<[?,4],f32>, %arg1: !torch.vtensor<[?],f32>) -> !torch.vtensor<[?,4],si64> {
+  %false = torch.constant.bool false
+  %0 = torch.aten.bucketize.Tensor %arg0, %arg1, %false, %false : !torch.vtensor<[?,4],f32>, !torch.vtensor<[?],f32>, !torch.bool, !torch.bool -> !torch.vtensor<[?,4],si64>
+  return %0 : !torch.vtensor<[?,4],si64>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.bucketize.Tensor$right_int32(
+// CHECK:           scf.while
+// CHECK:             %[[BOUNDARY:.*]] = tensor.extract %{{.*}} : tensor<5xi64>
+// CHECK:             arith.cmpi sle, %[[BOUNDARY]], %{{.*}} : i64
+// CHECK:           arith.index_cast %{{.*}} : index to i32
+// CHECK:           linalg.yield %{{.*}} : i32
+func.func @torch.aten.bucketize.Tensor$right_int32(%arg0: !torch.vtensor<[3],si64>, %arg1: !torch.vtensor<[5],si64>) -> !torch.vtensor<[3],si32> {
+  %true = torch.constant.bool true
+  %0 = torch.aten.bucketize.Tensor %arg0, %arg1, %true, %true : !torch.vtensor<[3],si64>, !torch.vtensor<[5],si64>, !torch.bool, !torch.bool -> !torch.vtensor<[3],si32>
+  return %0 : !torch.vtensor<[3],si32>
+}
@@ -0,0 +1,230 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg -split-input-file | FileCheck %s
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="conv-nhwc=true" -split-input-file | FileCheck %s --check-prefix=NHWC
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="conv-im2col=true" -split-input-file | FileCheck %s --check-prefix=IM2COL
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="conv-winograd=true" -split-input-file | FileCheck %s --check-prefix=WINOGRAD
+
+// CHECK-LABEL: func.func @torch.aten.convolution$depthwise(
+// CHECK:         %[[WEIGHT:.*]] = tensor.collapse_shape %{{.*}} {{\[\[}}0, 1], [2], [3]] : tensor<8x1x3x3xf32> into tensor<8x3x3xf32>
+// CHECK:         linalg.depthwise_conv_2d_nchw_chw {{.*}} ins(%{{.*}}, %[[WEIGHT]] : tensor<1x8x16x16xf32>, tensor<8x3x3xf32>)
+// NHWC-LABEL:  func.func @torch.aten.convolution$depthwise(
+// NHWC:          linalg.depthwise_conv_2d_nhwc_hwc {{.*}} ins(%{{.*}}, %{{.*}} : tensor<1x16x16x8xf32>, tensor<3x3x8xf32>)
+func.func @torch.aten.convolution$depthwise(%arg0: !torch.vtensor<[1,8,16,16],f32>, %arg1: !torch.vtensor<[8,1,3,3],f32>) -> !torch.vtensor<[1,8,14,14],f32> {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int8 = torch.constant.int 8
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct  : () -> !torch.list<int>
+  %3 = torch.aten.convolution %arg0, %arg1, %none, %0, %1, %0, %false, %2, %int8 : !torch.vtensor<[1,8,16,16],f32>, !torch.vtensor<[8,1,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,8,14,14],f32>
+  return %3 : !torch.vtensor<[1,8,14,14],f32>
+}
+
+// -----
+
+// A depthwise convolution with a channel multiplier always uses the NHWC op.
+// CHECK-LABEL: func.func @torch.aten.convolution$depthwise_multiplier(
+// CHECK:         %[[WEIGHT:.*]] = tensor.expand_shape %{{.*}} {{\[\[}}0, 1], [2], [3]] : tensor<8x3x3xf32> into tensor<4x2x3x3xf32>
+// CHECK:         %[[OUT:.*]] = tensor.expand_shape %{{.*}} {{\[\[}}0], [1], [2], [3, 4]] : tensor<?x?x?x8xf32> into tensor<?x?x?x4x2xf32>
+// CHECK:         %[[CONV:.*]] = linalg.depthwise_conv_2d_nhwc_hwcm {{.*}} ins(%{{.*}}, %{{.*}} : tensor<1x16x16x4xf32>, tensor<3x3x4x2xf32>) outs(%[[OUT]] : tensor<?x?x?x4x2xf32>)
+// CHECK:         tensor.collapse_shape %[[CONV]] {{\[\[}}0], [1], [2], [3, 4]] : tensor<?x?x?x4x2xf32> into tensor<?x?x?x8xf32>
+func.func @torch.aten.convolution$depthwise_multiplier(%arg0: !torch.vtensor<[1,4,16,16],f32>, %arg1: !torch.vtensor<[8,1,3,3],f32>) -> !torch.vtensor<[1,8,14,14],f32> {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int4 = torch.constant.int 4
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct  : () -> !torch.list<int>
+  %3 = torch.aten.convolution %arg0, %arg1, %none, %0, %1, %0, %false, %2, %int4 : !torch.vtensor<[1,4,16,16],f32>, !torch.vtensor<[8,1,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,8,14,14],f32>
+  return %3 : !torch.vtensor<[1,8,14,14],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @torch.aten.convolution$nhwc(
+// CHECK:         linalg.conv_2d_nchw_fchw
+// NHWC-LABEL:  func.func @torch.aten.convolution$nhwc(
+// NHWC:          %[[CONV:.*]] = linalg.conv_2d_nhwc_hwcf {{.*}} ins(%{{.*}}, %{{.*}} : tensor<1x16x16x3xf32>, tensor<3x3x3x16xf32>)
+// NHWC:          linalg.generic {{.*}} ins(%[[CONV]] : tensor<?x?x?x?xf32>)
+func.func @torch.aten.convolution$nhwc(%arg0: !torch.vtensor<[1,3,16,16],f32>, %arg1: !torch.vtensor<[16,3,3,3],f32>) -> !torch.vtensor<[1,16,14,14],f32> {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct  : () -> !torch.list<int>
+  %3 = torch.aten.convolution %arg0, %arg1, %none, %0, %1, %0, %false, %2, %int1 : !torch.vtensor<[1,3,16,16],f32>, !torch.vtensor<[16,3,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,16,14,14],f32>
+  return %3 : !torch.vtensor<[1,16,14,14],f32>
+}
+
+// -----
+
+// IM2COL-LABEL: func.func @torch.aten.convolution$im2col(
+// IM2COL:         %[[INPUT:.*]] = tensor.pad %{{.*}} low[0, 0, 1, 1] high[0, 0, 1, 1]
+// IM2COL:         %[[COLS:.*]] = linalg.generic {{.*}} ins(%[[INPUT]] : tensor<2x16x12x12xf32>) outs(%{{.*}} : tensor<16x3x3x2x5x5xf32>)
+// IM2COL:         %[[COLS_MATRIX:.*]] = tensor.collapse_shape %[[COLS]] {{\[\[}}0, 1, 2], [3, 4, 5]] : tensor<16x3x3x2x5x5xf32> into tensor<144x50xf32>
+// IM2COL:         %[[WEIGHT:.*]] = tensor.collapse_shape %{{.*}} {{\[\[}}0], [1, 2, 3]] : tensor<32x16x3x3xf32> into tensor<32x144xf32>
+// IM2COL:         %[[BIAS:.*]] = linalg.generic {{.*}} ins(%{{.*}} : tensor<32xf32>) outs(%{{.*}} : tensor<32x50xf32>)
+// IM2COL:         %[[MATMUL:.*]] = linalg.matmul ins(%[[WEIGHT]], %[[COLS_MATRIX]] : tensor<32x144xf32>, tensor<144x50xf32>) outs(%[[BIAS]] : tensor<32x50xf32>)
+// IM2COL:         %[[RESULT:.*]] = tensor.expand_shape %[[MATMUL]] {{\[\[}}0], [1, 2, 3]] : tensor<32x50xf32> into tensor<32x2x5x5xf32>
+// IM2COL:         linalg.generic {{.*}} ins(%[[RESULT]] : tensor<32x2x5x5xf32>) outs(%{{.*}} : tensor<2x32x5x5xf32>)
+// WINOGRAD-LABEL: func.func @torch.aten.convolution$im2col(
+// WINOGRAD:         linalg.conv_2d_nchw_fchw
+func.func @torch.aten.convolution$im2col(%arg0: !torch.vtensor<[2,16,10,10],f32>, %arg1: !torch.vtensor<[32,16,3,3],f32>, %arg2: !torch.vtensor<[32],f32>) -> !torch.vtensor<[2,32,5,5],f32> {
+  %false = torch.constant.bool false
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %0 = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct  : () -> !torch.list<int>
+  %3 = torch.aten.convolution %arg0, %arg1, %arg2, %0, %1, %1, %false, %2, %int1 : !torch.vtensor<[2,16,10,10],f32>, !torch.vtensor<[32,16,3,3],f32>, !torch.vtensor<[32],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[2,32,5,5],f32>
+  return %3 : !torch.vtensor<[2,32,5,5],f32>
+}
+
+// -----
+
+// The 7x7 output is computed as 4x4 tiles of 2x2, from an input padded to
+// 10x10.
+// WINOGRAD-LABEL: func.func @torch.aten.convolution$winograd(
+// WINOGRAD:         %[[INPUT:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[1,16,9,9],f32> -> tensor<1x16x9x9xf32>
+// WINOGRAD:         %[[PADDED:.*]] = tensor.pad %[[INPUT]] low[0, 0, 0, 0] high[0, 0, 1, 1]
+// WINOGRAD:         %[[U:.*]] = linalg.generic {{.*}} ins(%{{.*}}, %{{.*}}, %{{.*}} : tensor<4x3xf32>, tensor<16x16x3x3xf32>, tensor<4x3xf32>) outs(%{{.*}} : tensor<4x4x16x16xf32>)
+// WINOGRAD:         %[[U_BATCH:.*]] = tensor.collapse_shape %[[U]] {{\[\[}}0, 1], [2], [3]] : tensor<4x4x16x16xf32> into tensor<16x16x16xf32>
+// WINOGRAD:         %[[V:.*]] = linalg.generic {{.*}} ins(%{{.*}}, %[[PADDED]], %{{.*}} : tensor<4x4xf32>, tensor<1x16x10x10xf32>, tensor<4x4xf32>) outs(%{{.*}} : tensor<4x4x16x1x4x4xf32>)
+// WINOGRAD:         %[[V_BATCH:.*]] = tensor.collapse_shape %[[V]] {{\[\[}}0, 1], [2], [3, 4, 5]] : tensor<4x4x16x1x4x4xf32> into tensor<16x16x16xf32>
+// WINOGRAD:         %[[M:.*]] = linalg.batch_matmul ins(%[[U_BATCH]], %[[V_BATCH]] : tensor<16x16x16xf32>, tensor<16x16x16xf32>)
+// WINOGRAD:         %[[M_TILES:.*]] = tensor.expand_shape %[[M]] {{\[\[}}0, 1], [2], [3, 4, 5]] : tensor<16x16x16xf32> into tensor<4x4x16x1x4x4xf32>
+// WINOGRAD:         %[[Y:.*]] = linalg.generic {{.*}} ins(%{{.*}}, %[[M_TILES]], %{{.*}} : tensor<2x4xf32>, tensor<4x4x16x1x4x4xf32>, tensor<2x4xf32>) outs(%{{.*}} : tensor<1x16x4x2x4x2xf32>)
+// WINOGRAD:         %[[Y_TILES:.*]] = tensor.collapse_shape %[[Y]] {{\[\[}}0], [1], [2, 3], [4, 5]] : tensor<1x16x4x2x4x2xf32> into tensor<1x16x8x8xf32>
+// WINOGRAD:         tensor.extract_slice %[[Y_TILES]][0, 0, 0, 0] [1, 16, 7, 7] [1, 1, 1, 1] : tensor<1x16x8x8xf32> to tensor<1x16x7x7xf32>
+func.func @torch.aten.convolution$winograd(%arg0: !torch.vtensor<[1,16,9,9],f32>, %arg1: !torch.vtensor<[16,16,3,3],f32>) -> !torch.vtensor<[1,16,7,7],f32> {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct  : () -> !torch.list<int>
+  %3 = torch.aten.convolution %arg0, %arg1, %none, %0, %1, %0, %false, %2, %int1 : !torch.vtensor<[1,16,9,9],f32>, !torch.vtensor<[16,16,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,16,7,7],f32>
+  return %3 : !torch.vtensor<[1,16,7,7],f32>
+}
+
+// -----
+
+// Constant paddings give a tensor.pad with static paddings and sizes.
+// CHECK-LABEL: func.func @torch.aten.convolution$same_padding(
+// CHECK:         %[[PADDED:.*]] = tensor.pad %{{.*}} low[0, 0, 1, 1] high[0, 0, 1, 1]
+// CHECK:         } : tensor<1x3x16x16xf32> to tensor<1x3x18x18xf32>
+// CHECK:         linalg.conv_2d_nchw_fchw {{.*}} ins(%[[PADDED]], %{{.*}} : tensor<1x3x18x18xf32>, tensor<16x3x3x3xf32>)
+func.func @torch.aten.convolution$same_padding(%arg0: !torch.vtensor<[1,3,16,16],f32>, %arg1: !torch.vtensor<[16,3,3,3],f32>) -> !torch.vtensor<[1,16,16,16],f32> {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int1 = torch.constant.int 1
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct  : () -> !torch.list<int>
+  %2 = torch.aten.convolution %arg0, %arg1, %none, %0, %0, %0, %false, %1, %int1 : !torch.vtensor<[1,3,16,16],f32>, !torch.vtensor<[16,3,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,16,16,16],f32>
+  return %2 : !torch.vtensor<[1,16,16,16],f32>
+}
+
+// -----
+
+// A statically shaped transposed convolution is computed as one stride 1
+// convolution per output phase, with the taps of the kernel for that phase.
+// CHECK-LABEL: func.func @torch.aten.convolution$transposed(
+// CHECK:         %[[PADDED:.*]] = tensor.pad %{{.*}} low[0, 0, 1, 1] high[0, 0, 1, 1]
+// CHECK:         %[[OUT:.*]] = tensor.empty() : tensor<1x2x16x16xf32>
+// CHECK:         %[[WINDOW00:.*]] = tensor.extract_slice %[[PADDED]][0, 0, 0, 0] [1, 4, 9, 9] [1, 1, 1, 1]
+// CHECK:         %[[KERNEL00:.*]] = linalg.generic {{.*}} ins(%{{.*}} : tensor<4x2x4x4xf32>) outs(%{{.*}} : tensor<2x4x2x2xf32>)
+// CHECK:         %[[CONV00:.*]] = linalg.conv_2d_nchw_fchw {{.*}} ins(%[[WINDOW00]], %[[KERNEL00]] : tensor<1x4x9x9xf32>, tensor<2x4x2x2xf32>) outs(%{{.*}} : tensor<1x2x8x8xf32>)
+// CHECK:         %[[OUT00:.*]] = tensor.insert_slice %[[CONV00]] into %[[OUT]][0, 0, 0, 0] [1, 2, 8, 8] [1, 1, 2, 2]
+// CHECK:         tensor.extract_slice %[[PADDED]][0, 0, 0, 1] [1, 4, 9, 9] [1, 1, 1, 1]
+// CHECK:         linalg.conv_2d_nchw_fchw
+// CHECK:         %[[OUT01:.*]] = tensor.insert_slice %{{.*}} into %[[OUT00]][0, 0, 0, 1] [1, 2, 8, 8] [1, 1, 2, 2]
+// CHECK:         tensor.extract_slice %[[PADDED]][0, 0, 1, 0] [1, 4, 9, 9] [1, 1, 1, 1]
+// CHECK:         linalg.conv_2d_nchw_fchw
+// CHECK:         %[[OUT10:.*]] = tensor.insert_slice %{{.*}} into %[[OUT01]][0, 0, 1, 0] [1, 2, 8, 8] [1, 1, 2, 2]
+// CHECK:         tensor.extract_slice %[[PADDED]][0, 0, 1, 1] [1, 4, 9, 9] [1, 1, 1, 1]
+// CHECK:         linalg.conv_2d_nchw_fchw
+// CHECK:         %[[OUT11:.*]] = tensor.insert_slice %{{.*}} into %[[OUT10]][0, 0, 1, 1] [1, 2, 8, 8] [1, 1, 2, 2]
+// CHECK-NOT:     linalg.conv_2d_nchw_fchw
+// CHECK:         tensor.cast %[[OUT11]] : tensor<1x2x16x16xf32> to tensor<1x2x16x16xf32>
+func.func @torch.aten.convolution$transposed(%arg0: !torch.vtensor<[1,4,8,8],f32>, %arg1: !torch.vtensor<[4,2,4,4],f32>) -> !torch.vtensor<[1,2,16,16],f32> {
+  %none = torch.constant.none
+  %true = torch.constant.bool true
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %0 = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %3 = torch.aten.convolution %arg0, %arg1, %none, %0, %1, %1, %true, %2, %int1 : !torch.vtensor<[1,4,8,8],f32>, !torch.vtensor<[4,2,4,4],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,2,16,16],f32>
+  return %3 : !torch.vtensor<[1,2,16,16],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @torch.aten.convolution$1d_dilated(
+// CHECK:         linalg.conv_1d_ncw_fcw {dilations = dense<2> : vector<1xi64>, strides = dense<1> : vector<1xi64>} ins(%{{.*}}, %{{.*}} : tensor<1x4x16xf32>, tensor<8x4x3xf32>)
+// NHWC-LABEL:  func.func @torch.aten.convolution$1d_dilated(
+// NHWC:          linalg.conv_1d_nwc_wcf {dilations = dense<2> : vector<1xi64>, strides = dense<1> : vector<1xi64>} ins(%{{.*}}, %{{.*}} : tensor<1x16x4xf32>, tensor<3x4x8xf32>)
+func.func @torch.aten.convolution$1d_dilated(%arg0: !torch.vtensor<[1,4,16],f32>, %arg1: !torch.vtensor<[8,4,3],f32>) -> !torch.vtensor<[1,8,12],f32> {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %0 = torch.prim.ListConstruct %int1 : (!torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0 : (!torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct %int2 : (!torch.int) -> !torch.list<int>
+  %3 = torch.prim.ListConstruct  : () -> !torch.list<int>
+  %4 = torch.aten.convolution %arg0, %arg1, %none, %0, %1, %2, %false, %3, %int1 : !torch.vtensor<[1,4,16],f32>, !torch.vtensor<[8,4,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,8,12],f32>
+  return %4 : !torch.vtensor<[1,8,12],f32>
+}
+
+// -----
+
+// Grouped 1D convolutions have no named op and are computed by a generic op
+// on the operands with their groups expanded.
+// CHECK-LABEL: func.func @torch.aten.convolution$1d_grouped(
+// CHECK:         %[[INPUT:.*]] = tensor.expand_shape %{{.*}} {{\[\[}}0], [1, 2], [3]] : tensor<1x4x16xf32> into tensor<1x2x2x16xf32>
+// CHECK:         %[[WEIGHT:.*]] = tensor.expand_shape %{{.*}} {{\[\[}}0, 1], [2], [3]] : tensor<8x2x3xf32> into tensor<2x4x2x3xf32>
+// CHECK:         linalg.generic {{.*}} iterator_types = ["parallel", "parallel", "parallel", "parallel", "reduction", "reduction"]} ins(%[[INPUT]], %[[WEIGHT]] : tensor<1x2x2x16xf32>, tensor<2x4x2x3xf32>)
+// CHECK:           arith.mulf
+// CHECK:           arith.addf
+func.func @torch.aten.convolution$1d_grouped(%arg0: !torch.vtensor<[1,4,16],f32>, %arg1: !torch.vtensor<[8,2,3],f32>) -> !torch.vtensor<[1,8,14],f32> {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %0 = torch.prim.ListConstruct %int1 : (!torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0 : (!torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct  : () -> !torch.list<int>
+  %3 = torch.aten.convolution %arg0, %arg1, %none, %0, %1, %0, %false, %2, %int2 : !torch.vtensor<[1,4,16],f32>, !torch.vtensor<[8,2,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,8,14],f32>
+  return %3 : !torch.vtensor<[1,8,14],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @torch.aten.convolution$3d_depthwise(
+// CHECK:         %[[WEIGHT:.*]] = tensor.collapse_shape %{{.*}} {{\[\[}}0, 1], [2], [3], [4]] : tensor<4x1x3x3x3xf32> into tensor<4x3x3x3xf32>
+// CHECK:         linalg.depthwise_conv_3d_ncdhw_cdhw {{.*}} ins(%{{.*}}, %[[WEIGHT]] : tensor<1x4x8x8x8xf32>, tensor<4x3x3x3xf32>)
+// NHWC-LABEL:  func.func @torch.aten.convolution$3d_depthwise(
+// NHWC:          linalg.depthwise_conv_3d_ndhwc_dhwc {{.*}} ins(%{{.*}}, %{{.*}} : tensor<1x8x8x8x4xf32>, tensor<3x3x3x4xf32>)
+func.func @torch.aten.convolution$3d_depthwise(%arg0: !torch.vtensor<[1,4,8,8,8],f32>, %arg1: !torch.vtensor<[4,1,3,3,3],f32>) -> !torch.vtensor<[1,4,6,6,6],f32> {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int4 = torch.constant.int 4
+  %0 = torch.prim.ListConstruct %int1, %int1, %int1 : (!torch.int, !torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0, %int0 : (!torch.int, !torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct  : () -> !torch.list<int>
+  %3 = torch.aten.convolution %arg0, %arg1, %none, %0, %1, %0, %false, %2, %int4 : !torch.vtensor<[1,4,8,8,8],f32>, !torch.vtensor<[4,1,3,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,4,6,6,6],f32>
+  return %3 : !torch.vtensor<[1,4,6,6,6],f32>
+}
@@ -94,3 +94,84 @@ func.func @insufficient_dims_for_triu(%arg0: !torch.vtensor<[?],f32>) -> !torch.
   %0 = torch.aten.triu %arg0, %int0 : !torch.vtensor<[?],f32>, !torch.int -> !torch.vtensor<[?],f32>
   return %0 : !torch.vtensor<[?],f32>
 }
+
+// -----
+
+// The result of the relu has the sizes of %arg0, so adding it to %arg0 needs no
+// runtime check, unlike adding it to %arg1.
+// CHECK-LABEL:   func.func @elementwise$equal_dynamic_sizes(
+// CHECK:           linalg.generic
+// CHECK:             arith.select
+// CHECK-NOT:       assert
+// CHECK:           linalg.generic
+// CHECK:             arith.addf
+// CHECK:           %[[LEGAL_SIZES:.*]] = arith.cmpi eq
+// CHECK:           assert %[[LEGAL_SIZES]], "mismatched size for broadcast"
+// CHECK:           linalg.generic
+// CHECK:             arith.addf
+func.func @elementwise$equal_dynamic_sizes(%arg0: !torch.vtensor<[?,?],f32>, %arg1: !torch.vtensor<[?,?],f32>) -> !torch.vtensor<[?,?],f32> {
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.relu %arg0 : !torch.vtensor<[?,?],f32> -> !torch.vtensor<[?,?],f32>
+  %1 = torch.aten.add.Tensor %0, %arg0, %int1 : !torch.vtensor<[?,?],f32>, !torch.vtensor<[?,?],f32>, !torch.int -> !torch.vtensor<[?,?],f32>
+  %2 = torch.aten.add.Tensor %1, %arg1, %int1 : !torch.vtensor<[?,?],f32>, !torch.vtensor<[?,?],f32>, !torch.int -> !torch.vtensor<[?,?],f32>
+  return %2 : !torch.vtensor<[?,?],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @elementwise$filled_operand(
+// CHECK-SAME:                                         %[[ARG:.*]]: !torch.vtensor<[2,3],f32>) -> !torch.vtensor<[2,3],f32> {
+// CHECK-DAG:       %[[BUILTIN_ARG:.*]] = torch_c.to_builtin_tensor %[[ARG]] : !torch.vtensor<[2,3],f32> -> tensor<2x3xf32>
+// CHECK-DAG:       %[[ONE:.*]] = arith.constant 1.000000e+00 : f32
+// CHECK:           linalg.fill ins(%[[ONE]] : f32)
+// CHECK:           linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]} ins(%[[BUILTIN_ARG]] : tensor<2x3xf32>) outs(%{{.*}} : tensor<2x3xf32>) {
+// CHECK:           ^bb0(%[[LHS:.*]]: f32, %{{.*}}: f32):
+// CHECK:             %[[MUL:.*]] = arith.mulf %[[LHS]], %[[ONE]] : f32
+// CHECK:             linalg.yield %[[MUL]] : f32
+func.func @elementwise$filled_operand(%arg0: !torch.vtensor<[2,3],f32>) -> !torch.vtensor<[2,3],f32> {
+  %int3 = torch.constant.int 3
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %int3 : (!torch.int) -> !torch.list<int>
+  %1 = torch.aten.ones %0, %none, %none, %none, %none : !torch.list<int>, !torch.none, !torch.none, !torch.none, !torch.none -> !torch.vtensor<[3],f32>
+  %2 = torch.aten.mul.Tensor %arg0, %1 : !torch.vtensor<[2,3],f32>, !torch.vtensor<[3],f32> -> !torch.vtensor<[2,3],f32>
+  return %2 : !torch.vtensor<[2,3],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @elementwise$broadcasted_operand(
+// CHECK-SAME:                                              %[[ARG0:.*]]: !torch.vtensor<[2,3,4,4],f32>,
+// CHECK-SAME:                                              %[[ARG1:.*]]: !torch.vtensor<[1,1,4,4],f32>) -> !torch.vtensor<[2,3,4,4],f32> {
+// CHECK-DAG:       %[[LHS:.*]] = torch_c.to_builtin_tensor %[[ARG0]] : !torch.vtensor<[2,3,4,4],f32> -> tensor<2x3x4x4xf32>
+// CHECK-DAG:       %[[MASK:.*]] = torch_c.to_builtin_tensor %[[ARG1]] : !torch.vtensor<[1,1,4,4],f32> -> tensor<1x1x4x4xf32>
+// CHECK:           linalg.generic {indexing_maps = [affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>, affine_map<(d0, d1, d2, d3) -> (0, 0, d2, d3)>, affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>], iterator_types = ["parallel", "parallel", "parallel", "parallel"]} ins(%[[LHS]], %[[MASK]] : tensor<2x3x4x4xf32>, tensor<1x1x4x4xf32>)
+func.func @elementwise$broadcasted_operand(%arg0: !torch.vtensor<[2,3,4,4],f32>, %arg1: !torch.vtensor<[1,1,4,4],f32>) -> !torch.vtensor<[2,3,4,4],f32> {
+  %int2 = torch.constant.int 2
+  %int3 = torch.constant.int 3
+  %int4 = torch.constant.int 4
+  %0 = torch.prim.ListConstruct %int2, %int3, %int4, %int4 : (!torch.int, !torch.int, !torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.aten.broadcast_to %arg1, %0 : !torch.vtensor<[1,1,4,4],f32>, !torch.list<int> -> !torch.vtensor<[2,3,4,4],f32>
+  %2 = torch.aten.mul.Tensor %arg0, %1 : !torch.vtensor<[2,3,4,4],f32>, !torch.vtensor<[2,3,4,4],f32> -> !torch.vtensor<[2,3,4,4],f32>
+  return %2 : !torch.vtensor<[2,3,4,4],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @elementwise$converted_operand(
+// CHECK-SAME:                                            %[[ARG0:.*]]: !torch.vtensor<[4],bf16>,
+// CHECK-SAME:                                            %[[ARG1:.*]]: !torch.vtensor<[4],f32>) -> !torch.vtensor<[4],f32> {
+// CHECK-DAG:       %[[LHS:.*]] = torch_c.to_builtin_tensor %[[ARG0]] : !torch.vtensor<[4],bf16> -> tensor<4xbf16>
+// CHECK-DAG:       %[[RHS:.*]] = torch_c.to_builtin_tensor %[[ARG1]] : !torch.vtensor<[4],f32> -> tensor<4xf32>
+// CHECK:           linalg.generic {{.*}} ins(%[[LHS]], %[[RHS]] : tensor<4xbf16>, tensor<4xf32>) outs(%{{.*}} : tensor<4xf32>) {
+// CHECK:           ^bb0(%[[A:.*]]: bf16, %[[B:.*]]: f32, %{{.*}}: f32):
+// CHECK:             %[[A_EXT:.*]] = arith.extf %[[A]] : bf16 to f32
+// CHECK:             %[[MUL:.*]] = arith.mulf %[[A_EXT]], %[[B]] : f32
+// CHECK:             linalg.yield %[[MUL]] : f32
+func.func @elementwise$converted_operand(%arg0: !torch.vtensor<[4],bf16>, %arg1: !torch.vtensor<[4],f32>) -> !torch.vtensor<[4],f32> {
+  %int6 = torch.constant.int 6
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %0 = torch.aten.to.dtype %arg0, %int6, %false, %false, %none : !torch.vtensor<[4],bf16>, !torch.int, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[4],f32>
+  %1 = torch.aten.mul.Tensor %0, %arg1 : !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32> -> !torch.vtensor<[4],f32>
+  return %1 : !torch.vtensor<[4],f32>
+}
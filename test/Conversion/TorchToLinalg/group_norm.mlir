@@ -0,0 +1,57 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg -split-input-file -verify-diagnostics | FileCheck %s
+
+// CHECK-DAG:   #[[MAP:.*]] = affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d2, d3, d4)>
+// CHECK-DAG:   #[[STATS:.*]] = affine_map<(d0, d1, d2, d3, d4) -> (d0, d1)>
+// CHECK-DAG:   #[[CHANNELS:.*]] = affine_map<(d0, d1, d2, d3, d4) -> (d1, d2)>
+// CHECK-LABEL: func.func @torch.aten.native_group_norm(
+// CHECK:         %[[INPUT:.*]] = tensor.expand_shape %{{.*}} {{\[\[}}0], [1, 2], [3], [4]] : tensor<2x6x4x4xf32> into tensor<2x3x2x4x4xf32>
+// CHECK:         %[[INIT:.*]] = linalg.fill
+// CHECK:         %[[WELFORD:.*]]:3 = linalg.generic {indexing_maps = [#[[MAP]], #[[STATS]], #[[STATS]], #[[STATS]]], iterator_types = ["parallel", "parallel", "reduction", "reduction", "reduction"]}
+// CHECK-SAME:        ins(%[[INPUT]] : tensor<2x3x2x4x4xf32>) outs(%[[INIT]], %[[INIT]], %[[INIT]] : tensor<2x3xf32>, tensor<2x3xf32>, tensor<2x3xf32>)
+// CHECK:         %[[FINAL:.*]]:3 = linalg.generic
+// CHECK-SAME:        ins(%[[WELFORD]]#0, %[[WELFORD]]#1 : tensor<2x3xf32>, tensor<2x3xf32>)
+// CHECK:           math.rsqrt
+// CHECK:         %[[WEIGHT:.*]] = tensor.expand_shape %{{.*}} {{\[\[}}0, 1]] : tensor<6xf32> into tensor<3x2xf32>
+// CHECK:         %[[BIAS:.*]] = tensor.expand_shape %{{.*}} {{\[\[}}0, 1]] : tensor<6xf32> into tensor<3x2xf32>
+// CHECK:         %[[OUT:.*]] = linalg.generic {indexing_maps = [#[[MAP]], #[[STATS]], #[[STATS]], #[[CHANNELS]], #[[CHANNELS]], #[[MAP]]], iterator_types = ["parallel", "parallel", "parallel", "parallel", "parallel"]}
+// CHECK-SAME:        ins(%[[INPUT]], %[[WELFORD]]#0, %[[FINAL]]#0, %[[WEIGHT]], %[[BIAS]] : tensor<2x3x2x4x4xf32>, tensor<2x3xf32>, tensor<2x3xf32>, tensor<3x2xf32>, tensor<3x2xf32>)
+// CHECK:         tensor.collapse_shape %[[OUT]] {{\[\[}}0], [1, 2], [3], [4]] : tensor<2x3x2x4x4xf32> into tensor<2x6x4x4xf32>
+func.func @torch.aten.native_group_norm(%arg0: !torch.vtensor<[2,6,4,4],f32>, %arg1: !torch.vtensor<[6],f32>, %arg2: !torch.vtensor<[6],f32>) -> (!torch.vtensor<[2,6,4,4],f32>, !torch.vtensor<[2,3],f32>, !torch.vtensor<[2,3],f32>) {
+  %int2 = torch.constant.int 2
+  %int6 = torch.constant.int 6
+  %int16 = torch.constant.int 16
+  %int3 = torch.constant.int 3
+  %float1.000000e-05 = torch.constant.float 1.000000e-05
+  %result0, %result1, %result2 = torch.aten.native_group_norm %arg0, %arg1, %arg2, %int2, %int6, %int16, %int3, %float1.000000e-05 : !torch.vtensor<[2,6,4,4],f32>, !torch.vtensor<[6],f32>, !torch.vtensor<[6],f32>, !torch.int, !torch.int, !torch.int, !torch.int, !torch.float -> !torch.vtensor<[2,6,4,4],f32>, !torch.vtensor<[2,3],f32>, !torch.vtensor<[2,3],f32>
+  return %result0, %result1, %result2 : !torch.vtensor<[2,6,4,4],f32>, !torch.vtensor<[2,3],f32>, !torch.vtensor<[2,3],f32>
+}
+
+// -----
+
+// The group norm of the NCHW permutation of an NHWC tensor reads the NHWC
+// tensor, here in an instance norm, with a group per channel.
+// CHECK-DAG:   #[[NHWC:.*]] = affine_map<(d0, d1, d2, d3, d4) -> (d0, d3, d4, d1, d2)>
+// CHECK-DAG:   #[[STATS:.*]] = affine_map<(d0, d1, d2, d3, d4) -> (d0, d1)>
+// CHECK-LABEL: func.func @torch.aten.native_group_norm$nhwc(
+// CHECK:         %[[SOURCE:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[2,4,4,6],f16> -> tensor<2x4x4x6xf16>
+// CHECK:         %[[INPUT:.*]] = tensor.expand_shape %[[SOURCE]] {{\[\[}}0], [1], [2], [3, 4]] : tensor<2x4x4x6xf16> into tensor<2x4x4x6x1xf16>
+// CHECK:         %[[WELFORD:.*]]:3 = linalg.generic {indexing_maps = [#[[NHWC]], #[[STATS]], #[[STATS]], #[[STATS]]]
+// CHECK-SAME:        ins(%[[INPUT]] : tensor<2x4x4x6x1xf16>)
+// CHECK:         linalg.generic {indexing_maps = [#[[NHWC]], #[[STATS]], #[[STATS]], #{{.*}}]
+// CHECK-SAME:        ins(%[[INPUT]], %[[WELFORD]]#0, %{{.*}} : tensor<2x4x4x6x1xf16>, tensor<2x6xf32>, tensor<2x6xf32>)
+// CHECK-SAME:        outs(%{{.*}} : tensor<2x6x1x4x4xf16>)
+// CHECK:           arith.truncf %{{.*}} : f32 to f16
+func.func @torch.aten.native_group_norm$nhwc(%arg0: !torch.vtensor<[2,4,4,6],f16>) -> (!torch.vtensor<[2,6,4,4],f16>, !torch.vtensor<[2,6],f16>, !torch.vtensor<[2,6],f16>) {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %int3 = torch.constant.int 3
+  %int6 = torch.constant.int 6
+  %int16 = torch.constant.int 16
+  %none = torch.constant.none
+  %float1.000000e-05 = torch.constant.float 1.000000e-05
+  %0 = torch.prim.ListConstruct %int0, %int3, %int1, %int2 : (!torch.int, !torch.int, !torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.aten.permute %arg0, %0 : !torch.vtensor<[2,4,4,6],f16>, !torch.list<int> -> !torch.vtensor<[2,6,4,4],f16>
+  %result0, %result1, %result2 = torch.aten.native_group_norm %1, %none, %none, %int2, %int6, %int16, %int6, %float1.000000e-05 : !torch.vtensor<[2,6,4,4],f16>, !torch.none, !torch.none, !torch.int, !torch.int, !torch.int, !torch.int, !torch.float -> !torch.vtensor<[2,6,4,4],f16>, !torch.vtensor<[2,6],f16>, !torch.vtensor<[2,6],f16>
+  return %result0, %result1, %result2 : !torch.vtensor<[2,6,4,4],f16>, !torch.vtensor<[2,6],f16>, !torch.vtensor<[2,6],f16>
+}
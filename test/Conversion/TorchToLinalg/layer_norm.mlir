@@ -0,0 +1,62 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg -split-input-file -verify-diagnostics | FileCheck %s
+
+// CHECK-DAG:   #[[MAP:.*]] = affine_map<(d0, d1, d2) -> (d0, d1, d2)>
+// CHECK-DAG:   #[[STATS:.*]] = affine_map<(d0, d1, d2) -> (d0)>
+// CHECK-DAG:   #[[NORMALIZED:.*]] = affine_map<(d0, d1, d2) -> (d1, d2)>
+// CHECK-LABEL: func.func @torch.aten.native_layer_norm(
+// CHECK:         %[[INPUT:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[2,3,4],f32> -> tensor<2x3x4xf32>
+// CHECK:         %[[INIT:.*]] = linalg.fill
+// CHECK:         %[[WELFORD:.*]]:3 = linalg.generic {indexing_maps = [#[[MAP]], #[[STATS]], #[[STATS]], #[[STATS]]], iterator_types = ["parallel", "reduction", "reduction"]}
+// CHECK-SAME:        ins(%[[INPUT]] : tensor<2x3x4xf32>) outs(%[[INIT]], %[[INIT]], %[[INIT]] : tensor<2xf32>, tensor<2xf32>, tensor<2xf32>)
+// CHECK:         ^bb0(%[[X:.*]]: f32, %[[MEAN:.*]]: f32, %[[M2:.*]]: f32, %[[COUNT:.*]]: f32):
+// CHECK:           %[[NEW_COUNT:.*]] = arith.addf %[[COUNT]], %{{.*}} : f32
+// CHECK:           %[[DELTA:.*]] = arith.subf %[[X]], %[[MEAN]] : f32
+// CHECK:           %[[STEP:.*]] = arith.divf %[[DELTA]], %[[NEW_COUNT]] : f32
+// CHECK:           %[[NEW_MEAN:.*]] = arith.addf %[[MEAN]], %[[STEP]] : f32
+// CHECK:           %[[DELTA2:.*]] = arith.subf %[[X]], %[[NEW_MEAN]] : f32
+// CHECK:           %[[PROD:.*]] = arith.mulf %[[DELTA]], %[[DELTA2]] : f32
+// CHECK:           %[[NEW_M2:.*]] = arith.addf %[[M2]], %[[PROD]] : f32
+// CHECK:           linalg.yield %[[NEW_MEAN]], %[[NEW_M2]], %[[NEW_COUNT]] : f32, f32, f32
+// CHECK:         %[[FINAL:.*]]:3 = linalg.generic
+// CHECK-SAME:        ins(%[[WELFORD]]#0, %[[WELFORD]]#1 : tensor<2xf32>, tensor<2xf32>)
+// CHECK:           math.rsqrt
+// CHECK:         %[[OUT:.*]] = linalg.generic {indexing_maps = [#[[MAP]], #[[STATS]], #[[STATS]], #[[NORMALIZED]], #[[NORMALIZED]], #[[MAP]]], iterator_types = ["parallel", "parallel", "parallel"]}
+// CHECK-SAME:        ins(%[[INPUT]], %[[WELFORD]]#0, %[[FINAL]]#0, %{{.*}}, %{{.*}} : tensor<2x3x4xf32>, tensor<2xf32>, tensor<2xf32>, tensor<3x4xf32>, tensor<3x4xf32>)
+// CHECK:         ^bb0(%[[X:.*]]: f32, %[[MEAN:.*]]: f32, %[[RSTD:.*]]: f32, %[[WEIGHT:.*]]: f32, %[[BIAS:.*]]: f32, %{{.*}}: f32):
+// CHECK:           %[[CENTERED:.*]] = arith.subf %[[X]], %[[MEAN]] : f32
+// CHECK:           %[[NORM:.*]] = arith.mulf %[[CENTERED]], %[[RSTD]] : f32
+// CHECK:           %[[SCALED:.*]] = arith.mulf %[[NORM]], %[[WEIGHT]] : f32
+// CHECK:           %[[RESULT:.*]] = arith.addf %[[SCALED]], %[[BIAS]] : f32
+// CHECK:           linalg.yield %[[RESULT]] : f32
+// CHECK:         tensor.expand_shape %[[FINAL]]#1 {{\[\[}}0, 1, 2]] : tensor<2xf32> into tensor<2x1x1xf32>
+// CHECK:         tensor.expand_shape %[[FINAL]]#2 {{\[\[}}0, 1, 2]] : tensor<2xf32> into tensor<2x1x1xf32>
+func.func @torch.aten.native_layer_norm(%arg0: !torch.vtensor<[2,3,4],f32>, %arg1: !torch.vtensor<[3,4],f32>, %arg2: !torch.vtensor<[3,4],f32>) -> (!torch.vtensor<[2,3,4],f32>, !torch.vtensor<[2,1,1],f32>, !torch.vtensor<[2,1,1],f32>) {
+  %int3 = torch.constant.int 3
+  %int4 = torch.constant.int 4
+  %float1.000000e-05 = torch.constant.float 1.000000e-05
+  %0 = torch.prim.ListConstruct %int3, %int4 : (!torch.int, !torch.int) -> !torch.list<int>
+  %result0, %result1, %result2 = torch.aten.native_layer_norm %arg0, %0, %arg1, %arg2, %float1.000000e-05 : !torch.vtensor<[2,3,4],f32>, !torch.list<int>, !torch.vtensor<[3,4],f32>, !torch.vtensor<[3,4],f32>, !torch.float -> !torch.vtensor<[2,3,4],f32>, !torch.vtensor<[2,1,1],f32>, !torch.vtensor<[2,1,1],f32>
+  return %result0, %result1, %result2 : !torch.vtensor<[2,3,4],f32>, !torch.vtensor<[2,1,1],f32>, !torch.vtensor<[2,1,1],f32>
+}
+
+// -----
+
+// The statistics of a half-precision layer norm are computed in f32, and the
+// weight and bias are optional.
+// CHECK-LABEL: func.func @torch.aten.native_layer_norm$f16_no_affine(
+// CHECK:         linalg.generic {{.*}} iterator_types = ["parallel", "reduction"]
+// CHECK-SAME:        outs(%{{.*}}, %{{.*}}, %{{.*}} : tensor<?xf32>, tensor<?xf32>, tensor<?xf32>)
+// CHECK:           arith.extf %{{.*}} : f16 to f32
+// CHECK:         linalg.generic
+// CHECK-SAME:        outs(%{{.*}}, %{{.*}}, %{{.*}} : tensor<?xf32>, tensor<?xf16>, tensor<?xf16>)
+// CHECK:         linalg.generic
+// CHECK-SAME:        ins(%{{.*}}, %{{.*}}, %{{.*}} : tensor<?x8xf16>, tensor<?xf32>, tensor<?xf32>)
+// CHECK:           arith.truncf %{{.*}} : f32 to f16
+func.func @torch.aten.native_layer_norm$f16_no_affine(%arg0: !torch.vtensor<[?,8],f16>) -> (!torch.vtensor<[?,8],f16>, !torch.vtensor<[?,1],f16>, !torch.vtensor<[?,1],f16>) {
+  %int8 = torch.constant.int 8
+  %none = torch.constant.none
+  %float1.000000e-05 = torch.constant.float 1.000000e-05
+  %0 = torch.prim.ListConstruct %int8 : (!torch.int) -> !torch.list<int>
+  %result0, %result1, %result2 = torch.aten.native_layer_norm %arg0, %0, %none, %none, %float1.000000e-05 : !torch.vtensor<[?,8],f16>, !torch.list<int>, !torch.none, !torch.none, !torch.float -> !torch.vtensor<[?,8],f16>, !torch.vtensor<[?,1],f16>, !torch.vtensor<[?,1],f16>
+  return %result0, %result1, %result2 : !torch.vtensor<[?,8],f16>, !torch.vtensor<[?,1],f16>, !torch.vtensor<[?,1],f16>
+}
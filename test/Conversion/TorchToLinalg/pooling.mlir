@@ -27,3 +27,95 @@ func.func @forward(%arg0: !torch.vtensor<[?,?,?,?],f32>) -> !torch.vtensor<[?,?,
   %4 = torch.aten.max_pool2d %arg0, %kernel_size, %stride, %padding, %dilation, %false : !torch.vtensor<[?,?,?,?],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool -> !torch.vtensor<[?,?,?,?],f32>
   return %4 : !torch.vtensor<[?,?,?,?],f32>
 }
+
+// -----
+
+// The input isn't padded without padding.
+// CHECK-LABEL: func @forward_max_pool2d_no_padding
+// CHECK-NOT:     tensor.pad
+// CHECK:         linalg.pooling_nchw_max
+func.func @forward_max_pool2d_no_padding(%arg0: !torch.vtensor<[?,?,?,?],f32>) -> !torch.vtensor<[?,?,?,?],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %false = torch.constant.bool false
+  %kernel_size = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %stride = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %padding = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %dilation = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.max_pool2d %arg0, %kernel_size, %stride, %padding, %dilation, %false : !torch.vtensor<[?,?,?,?],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool -> !torch.vtensor<[?,?,?,?],f32>
+  return %0 : !torch.vtensor<[?,?,?,?],f32>
+}
+
+// -----
+
+// The division by the divisor is folded into the accumulation, and in ceil
+// mode the input is padded by `stride - 1` at the high end.
+// CHECK-DAG:   #[[INPUT_MAP:.*]] = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1, d2 * 2 + d4, d3 * 2 + d5)>
+// CHECK-DAG:   #[[KERNEL_MAP:.*]] = affine_map<(d0, d1, d2, d3, d4, d5) -> (d4, d5)>
+// CHECK-DAG:   #[[OUTPUT_MAP:.*]] = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1, d2, d3)>
+// CHECK-LABEL: func @forward_avg_pool2d
+// CHECK:         %[[PADDED:.*]] = tensor.pad %{{.*}} low[0, 0, 1, 1] high[0, 0, 2, 2]
+// CHECK:         %[[SCALE:.*]] = arith.divf %{{.*}}, %{{.*}} : f32
+// CHECK:         %[[AVG:.*]] = linalg.generic {indexing_maps = [#[[INPUT_MAP]], #[[KERNEL_MAP]], #[[OUTPUT_MAP]]], iterator_types = ["parallel", "parallel", "parallel", "parallel", "reduction", "reduction"]} ins(%[[PADDED]], %{{.*}} : tensor<?x?x?x?xf32>, tensor<?x?xf32>)
+// CHECK:         ^bb0(%[[IN:.*]]: f32, %{{.*}}: f32, %[[ACC:.*]]: f32):
+// CHECK:           %[[SCALED:.*]] = arith.mulf %[[IN]], %[[SCALE]] : f32
+// CHECK:           %[[SUM:.*]] = arith.addf %[[ACC]], %[[SCALED]] : f32
+// CHECK:           linalg.yield %[[SUM]] : f32
+// CHECK-NOT:     linalg.generic
+func.func @forward_avg_pool2d(%arg0: !torch.vtensor<[?,?,?,?],f32>) -> !torch.vtensor<[?,?,?,?],f32> {
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %int3 = torch.constant.int 3
+  %true = torch.constant.bool true
+  %none = torch.constant.none
+  %kernel_size = torch.prim.ListConstruct %int3, %int3 : (!torch.int, !torch.int) -> !torch.list<int>
+  %stride = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %padding = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.avg_pool2d %arg0, %kernel_size, %stride, %padding, %true, %true, %none : !torch.vtensor<[?,?,?,?],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[?,?,?,?],f32>
+  return %0 : !torch.vtensor<[?,?,?,?],f32>
+}
+
+// -----
+
+// Windows of 3 or 4 rows and 2 or 3 columns are pooled, within a window of
+// at most 5x4 elements.
+// CHECK-LABEL: func @forward_adaptive_avg_pool2d_non_divisible
+// CHECK:         %[[WINDOW:.*]] = tensor.empty() : tensor<5x4xf32>
+// CHECK:         %[[INIT:.*]] = linalg.fill ins(%{{.*}} : f32) outs(%{{.*}} : tensor<2x3x3x4xf32>) -> tensor<2x3x3x4xf32>
+// CHECK:         linalg.generic
+// CHECK-SAME:      iterator_types = ["parallel", "parallel", "parallel", "parallel", "reduction", "reduction"]
+// CHECK-SAME:      ins(%[[WINDOW]] : tensor<5x4xf32>) outs(%[[INIT]] : tensor<2x3x3x4xf32>)
+// CHECK:           arith.ceildivui
+// CHECK:           tensor.extract
+// CHECK:           arith.divf
+// CHECK:           arith.select
+func.func @forward_adaptive_avg_pool2d_non_divisible(%arg0: !torch.vtensor<[2,3,10,9],f32>) -> !torch.vtensor<[2,3,3,4],f32> {
+  %int3 = torch.constant.int 3
+  %int4 = torch.constant.int 4
+  %0 = torch.prim.ListConstruct %int3, %int4 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.aten.adaptive_avg_pool2d %arg0, %0 : !torch.vtensor<[2,3,10,9],f32>, !torch.list<int> -> !torch.vtensor<[2,3,3,4],f32>
+  return %1 : !torch.vtensor<[2,3,3,4],f32>
+}
+
+// -----
+
+// When the output size divides the input size, the window is exact.
+// CHECK-LABEL: func @forward_adaptive_max_pool2d
+// CHECK:         %[[WINDOW:.*]] = tensor.empty() : tensor<2x3xf32>
+// CHECK:         %[[VALUES:.*]] = linalg.fill ins(%{{.*}} : f32) outs(%{{.*}} : tensor<3x4x3xf32>) -> tensor<3x4x3xf32>
+// CHECK:         %[[INDICES:.*]] = linalg.fill ins(%{{.*}} : i64) outs(%{{.*}} : tensor<3x4x3xi64>) -> tensor<3x4x3xi64>
+// CHECK:         %[[POOL:.*]]:2 = linalg.generic
+// CHECK-SAME:      ins(%[[WINDOW]] : tensor<2x3xf32>) outs(%[[VALUES]], %[[INDICES]] : tensor<3x4x3xf32>, tensor<3x4x3xi64>)
+// CHECK:           tensor.extract
+// CHECK:           arith.cmpf ogt
+// CHECK:           arith.cmpf uno
+// CHECK:         tensor.cast %[[POOL]]#0
+// CHECK:         tensor.cast %[[POOL]]#1
+func.func @forward_adaptive_max_pool2d(%arg0: !torch.vtensor<[3,8,9],f32>) -> (!torch.vtensor<[3,4,3],f32>, !torch.vtensor<[3,4,3],si64>) {
+  %int4 = torch.constant.int 4
+  %int3 = torch.constant.int 3
+  %0 = torch.prim.ListConstruct %int4, %int3 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1:2 = torch.aten.adaptive_max_pool2d %arg0, %0 : !torch.vtensor<[3,8,9],f32>, !torch.list<int> -> !torch.vtensor<[3,4,3],f32>, !torch.vtensor<[3,4,3],si64>
+  return %1#0, %1#1 : !torch.vtensor<[3,4,3],f32>, !torch.vtensor<[3,4,3],si64>
+}
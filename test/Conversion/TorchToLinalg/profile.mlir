@@ -0,0 +1,16 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="profile" -split-input-file -o /dev/null 2>&1 | FileCheck %s
+
+// Each kind of converted op gets a row with the number of ops it was
+// converted from and the number of ops emitted, followed by the kinds of the
+// emitted ops.
+// CHECK:       convert-torch-to-linalg @elementwise conversion profile
+// CHECK:       Time (ms)    Count    Emitted  Op
+// CHECK-DAG:   {{[0-9.]+}} {{ +}}2 {{ +}}{{[0-9]+}}  torch.aten.tanh
+// CHECK-DAG:   {{ +}}2    linalg.generic
+// CHECK-DAG:   {{[0-9.]+}} {{ +}}1 {{ +}}{{[0-9]+}}  torch.aten.neg
+func.func @elementwise(%arg0: !torch.vtensor<[?],f32>) -> !torch.vtensor<[?],f32> {
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[?],f32> -> !torch.vtensor<[?],f32>
+  %1 = torch.aten.tanh %0 : !torch.vtensor<[?],f32> -> !torch.vtensor<[?],f32>
+  %2 = torch.aten.neg %1 : !torch.vtensor<[?],f32> -> !torch.vtensor<[?],f32>
+  return %2 : !torch.vtensor<[?],f32>
+}
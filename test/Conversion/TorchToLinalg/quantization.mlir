@@ -0,0 +1,171 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg -split-input-file -verify-diagnostics | FileCheck %s
+
+// CHECK-LABEL: func.func @torch.aten.quantize_per_tensor(
+// CHECK:         linalg.generic
+// CHECK:         ^bb0(%[[X:.*]]: f32, %{{.*}}: i8):
+// CHECK:           %[[SCALED:.*]] = arith.divf %[[X]], %{{.*}} : f32
+// CHECK:           %[[ROUNDED:.*]] = math.roundeven %[[SCALED]] : f32
+// CHECK:           %[[SHIFTED:.*]] = arith.addf %[[ROUNDED]], %{{.*}} : f32
+// CHECK:           %[[LOWER:.*]] = arith.maxf %[[SHIFTED]], %{{.*}} : f32
+// CHECK:           %[[CLAMPED:.*]] = arith.minf %[[LOWER]], %{{.*}} : f32
+// CHECK:           %[[Q:.*]] = arith.fptosi %[[CLAMPED]] : f32 to i8
+// CHECK:           linalg.yield %[[Q]] : i8
+// CHECK:         torch_c.from_builtin_tensor %{{.*}} : tensor<4xi8> -> !torch.vtensor<[4],!torch.qint8>
+func.func @torch.aten.quantize_per_tensor(%arg0: !torch.vtensor<[4],f32>) -> !torch.vtensor<[4],!torch.qint8> {
+  %scale = torch.constant.float 1.000000e-01
+  %zp = torch.constant.int 3
+  %dtype = torch.constant.int 12
+  %0 = torch.aten.quantize_per_tensor %arg0, %scale, %zp, %dtype : !torch.vtensor<[4],f32>, !torch.float, !torch.int, !torch.int -> !torch.vtensor<[4],!torch.qint8>
+  return %0 : !torch.vtensor<[4],!torch.qint8>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @torch.aten.dequantize.self(
+// CHECK:         %[[INT_REPR:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[4],ui8> -> tensor<4xi8>
+// CHECK:         linalg.generic {{.*}} ins(%{{.*}} : tensor<4xi8>)
+// CHECK:         ^bb0(%[[Q:.*]]: i8, %{{.*}}: f32):
+// CHECK:           %[[EXT:.*]] = arith.extui %[[Q]] : i8 to i32
+// CHECK:           %[[SHIFTED:.*]] = arith.subi %[[EXT]], %{{.*}} : i32
+// CHECK:           %[[FLOAT:.*]] = arith.sitofp %[[SHIFTED]] : i32 to f32
+// CHECK:           %[[X:.*]] = arith.mulf %[[FLOAT]], %{{.*}} : f32
+// CHECK:           linalg.yield %[[X]] : f32
+func.func @torch.aten.dequantize.self(%arg0: !torch.vtensor<[4],ui8>) -> !torch.vtensor<[4],f32> {
+  %scale = torch.constant.float 1.000000e-01
+  %zp = torch.constant.int 128
+  %0 = torch.per_tensor_affine.create %arg0, %scale, %zp : !torch.vtensor<[4],ui8>, !torch.float, !torch.int -> !torch.vtensor<[4],!torch.quint8>
+  %1 = torch.aten.dequantize.self %0 : !torch.vtensor<[4],!torch.quint8> -> !torch.vtensor<[4],f32>
+  return %1 : !torch.vtensor<[4],f32>
+}
+
+// -----
+
+// CHECK-DAG:   #[[ACC_MAP:.*]] = affine_map<(d0, d1) -> (d0, d1)>
+// CHECK-DAG:   #[[BIAS_MAP:.*]] = affine_map<(d0, d1) -> (d1)>
+// CHECK-LABEL: func.func @torch.aten.linear$quantized(
+// CHECK:         torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[4,3],si8> -> tensor<4x3xi8>
+// CHECK:         %[[SIGNED:.*]] = linalg.generic {{.*}} ins(%{{.*}} : tensor<2x5x3xi8>) outs(%{{.*}} : tensor<2x5x3xi8>)
+// CHECK:           arith.xori %{{.*}}, %{{.*}} : i8
+// CHECK:         %[[COLLAPSED:.*]] = tensor.collapse_shape %[[SIGNED]] {{\[\[}}0, 1], [2]] : tensor<2x5x3xi8> into tensor<10x3xi8>
+// CHECK:         %[[ACC:.*]] = linalg.fill ins(%{{.*}} : i32) outs(%{{.*}} : tensor<10x4xi32>) -> tensor<10x4xi32>
+// CHECK:         %[[TRANSPOSED:.*]] = linalg.generic {{.*}} ins(%{{.*}} : tensor<4x3xi8>) outs(%{{.*}} : tensor<3x4xi8>)
+// CHECK:         %[[MATMUL:.*]] = linalg.quantized_matmul ins(%[[COLLAPSED]], %[[TRANSPOSED]], %{{.*}}, %{{.*}} : tensor<10x3xi8>, tensor<3x4xi8>, i32, i32) outs(%[[ACC]] : tensor<10x4xi32>) -> tensor<10x4xi32>
+// CHECK:         %[[RESULT:.*]] = linalg.generic {indexing_maps = [#[[ACC_MAP]], #[[BIAS_MAP]], #[[ACC_MAP]]], iterator_types = ["parallel", "parallel"]} ins(%[[MATMUL]], %{{.*}} : tensor<10x4xi32>, tensor<4xf32>)
+// CHECK:           arith.sitofp %{{.*}} : i32 to f32
+// CHECK:         tensor.expand_shape %[[RESULT]] {{\[\[}}0, 1], [2]] : tensor<10x4xf32> into tensor<2x5x4xf32>
+func.func @torch.aten.linear$quantized(%arg0: !torch.vtensor<[2,5,3],f32>, %arg1: !torch.vtensor<[4,3],si8>, %arg2: !torch.vtensor<[4],f32>) -> !torch.vtensor<[2,5,4],f32> {
+  %scale = torch.constant.float 1.000000e-01
+  %zp = torch.constant.int 0
+  %dtype = torch.constant.int 13
+  %0 = torch.aten.quantize_per_tensor %arg0, %scale, %zp, %dtype : !torch.vtensor<[2,5,3],f32>, !torch.float, !torch.int, !torch.int -> !torch.vtensor<[2,5,3],!torch.quint8>
+  %1 = torch.aten.dequantize.self %0 : !torch.vtensor<[2,5,3],!torch.quint8> -> !torch.vtensor<[2,5,3],f32>
+  %2 = torch.per_tensor_affine.create %arg1, %scale, %zp : !torch.vtensor<[4,3],si8>, !torch.float, !torch.int -> !torch.vtensor<[4,3],!torch.qint8>
+  %3 = torch.aten.dequantize.self %2 : !torch.vtensor<[4,3],!torch.qint8> -> !torch.vtensor<[4,3],f32>
+  %4 = torch.aten.linear %1, %3, %arg2 : !torch.vtensor<[2,5,3],f32>, !torch.vtensor<[4,3],f32>, !torch.vtensor<[4],f32> -> !torch.vtensor<[2,5,4],f32>
+  return %4 : !torch.vtensor<[2,5,4],f32>
+}
+
+// -----
+
+// CHECK-DAG:   #[[ACC_MAP:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d2, d3, d1)>
+// CHECK-DAG:   #[[OUT_MAP:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+// CHECK-LABEL: func.func @torch.aten.convolution$quantized(
+// CHECK:         torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[1,3,8,8],si8> -> tensor<1x3x8x8xi8>
+// CHECK:         %[[PAD:.*]] = arith.trunci %[[ZP:.*]] : i32 to i8
+// CHECK:         %[[PADDED:.*]] = tensor.pad %{{.*}} low[0, 0, 1, 1] high[0, 0, 1, 1]
+// CHECK:           tensor.yield %[[PAD]] : i8
+// CHECK:         %[[ACC:.*]] = linalg.fill ins(%{{.*}} : i32) outs(%{{.*}} : tensor<1x?x?x4xi32>) -> tensor<1x?x?x4xi32>
+// CHECK:         %[[CONV:.*]] = linalg.conv_2d_nhwc_hwcf_q {dilations = dense<1> : vector<2xi64>, strides = dense<1> : vector<2xi64>}
+// CHECK-SAME:        ins(%{{.*}}, %{{.*}}, %[[ZP]], %{{.*}} : tensor<1x10x10x3xi8>, tensor<3x3x3x4xi8>, i32, i32) outs(%[[ACC]] : tensor<1x?x?x4xi32>)
+// CHECK:         linalg.generic {indexing_maps = [#[[ACC_MAP]], #[[OUT_MAP]]], iterator_types = ["parallel", "parallel", "parallel", "parallel"]} ins(%[[CONV]] : tensor<1x?x?x4xi32>) outs(%{{.*}} : tensor<1x4x?x?xf32>)
+func.func @torch.aten.convolution$quantized(%arg0: !torch.vtensor<[1,3,8,8],si8>, %arg1: !torch.vtensor<[4,3,3,3],si8>) -> !torch.vtensor<[1,4,8,8],f32> {
+  %scale = torch.constant.float 1.000000e-01
+  %zp = torch.constant.int 2
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %0 = torch.per_tensor_affine.create %arg0, %scale, %zp : !torch.vtensor<[1,3,8,8],si8>, !torch.float, !torch.int -> !torch.vtensor<[1,3,8,8],!torch.qint8>
+  %1 = torch.aten.dequantize.self %0 : !torch.vtensor<[1,3,8,8],!torch.qint8> -> !torch.vtensor<[1,3,8,8],f32>
+  %2 = torch.per_tensor_affine.create %arg1, %scale, %int0 : !torch.vtensor<[4,3,3,3],si8>, !torch.float, !torch.int -> !torch.vtensor<[4,3,3,3],!torch.qint8>
+  %3 = torch.aten.dequantize.self %2 : !torch.vtensor<[4,3,3,3],!torch.qint8> -> !torch.vtensor<[4,3,3,3],f32>
+  %ones = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %zeros = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %4 = torch.aten.convolution %1, %3, %none, %ones, %ones, %ones, %false, %zeros, %int1 : !torch.vtensor<[1,3,8,8],f32>, !torch.vtensor<[4,3,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,4,8,8],f32>
+  return %4 : !torch.vtensor<[1,4,8,8],f32>
+}
+
+// -----
+
+// CHECK-DAG:   #[[MAP:.*]] = affine_map<(d0, d1) -> (d0, d1)>
+// CHECK-DAG:   #[[CHANNEL_MAP:.*]] = affine_map<(d0, d1) -> (d1)>
+// CHECK-LABEL: func.func @torch.aten.dequantize.self$per_channel(
+// CHECK:         linalg.generic {indexing_maps = [#[[MAP]], #[[CHANNEL_MAP]], #[[CHANNEL_MAP]], #[[MAP]]], iterator_types = ["parallel", "parallel"]} ins(%{{.*}}, %{{.*}}, %{{.*}} : tensor<4x3xi8>, tensor<3xf64>, tensor<3xi64>)
+// CHECK:         ^bb0(%[[Q:.*]]: i8, %[[SCALE:.*]]: f64, %[[ZP:.*]]: i64, %{{.*}}: f32):
+// CHECK:           %[[EXT:.*]] = arith.extsi %[[Q]] : i8 to i32
+// CHECK:           %[[ZP32:.*]] = arith.trunci %[[ZP]] : i64 to i32
+// CHECK:           %[[SHIFTED:.*]] = arith.subi %[[EXT]], %[[ZP32]] : i32
+// CHECK:           %[[FLOAT:.*]] = arith.sitofp %[[SHIFTED]] : i32 to f32
+// CHECK:           %[[SCALE32:.*]] = arith.truncf %[[SCALE]] : f64 to f32
+// CHECK:           arith.mulf %[[FLOAT]], %[[SCALE32]] : f32
+func.func @torch.aten.dequantize.self$per_channel(%arg0: !torch.vtensor<[4,3],si8>, %arg1: !torch.vtensor<[3],f64>, %arg2: !torch.vtensor<[3],si64>) -> !torch.vtensor<[4,3],f32> {
+  %int-1 = torch.constant.int -1
+  %0 = torch.per_channel_affine.create %arg0, %arg1, %arg2, %int-1 : !torch.vtensor<[4,3],si8>, !torch.vtensor<[3],f64>, !torch.vtensor<[3],si64>, !torch.int -> !torch.vtensor<[4,3],!torch.qint8>
+  %1 = torch.aten.dequantize.self %0 : !torch.vtensor<[4,3],!torch.qint8> -> !torch.vtensor<[4,3],f32>
+  return %1 : !torch.vtensor<[4,3],f32>
+}
+
+// -----
+
+// CHECK-DAG:   #[[ACC_MAP:.*]] = affine_map<(d0, d1) -> (d0, d1)>
+// CHECK-DAG:   #[[CHANNEL_MAP:.*]] = affine_map<(d0, d1) -> (d1)>
+// CHECK-LABEL: func.func @torch.aten.linear$quantized_per_channel(
+// CHECK:         %[[WEIGHT_ZP:.*]] = arith.constant 0 : i32
+// CHECK:         %[[MATMUL:.*]] = linalg.quantized_matmul ins(%{{.*}}, %{{.*}}, %{{.*}}, %[[WEIGHT_ZP]] : tensor<2x3xi8>, tensor<3x4xi8>, i32, i32)
+// CHECK:         linalg.generic {indexing_maps = [#[[ACC_MAP]], #[[CHANNEL_MAP]], #[[ACC_MAP]]], iterator_types = ["parallel", "parallel"]} ins(%[[MATMUL]], %{{.*}} : tensor<2x4xi32>, tensor<4xf64>)
+// CHECK:         ^bb0(%[[ACC:.*]]: i32, %[[SCALE:.*]]: f64, %{{.*}}: f32):
+// CHECK:           %[[FLOAT:.*]] = arith.sitofp %[[ACC]] : i32 to f32
+// CHECK:           %[[SCALED:.*]] = arith.mulf %[[FLOAT]], %{{.*}} : f32
+// CHECK:           %[[CHANNEL_SCALE:.*]] = arith.truncf %[[SCALE]] : f64 to f32
+// CHECK:           arith.mulf %[[SCALED]], %[[CHANNEL_SCALE]] : f32
+func.func @torch.aten.linear$quantized_per_channel(%arg0: !torch.vtensor<[2,3],si8>, %arg1: !torch.vtensor<[4,3],si8>, %arg2: !torch.vtensor<[4],f64>) -> !torch.vtensor<[2,4],f32> {
+  %scale = torch.constant.float 1.000000e-01
+  %int0 = torch.constant.int 0
+  %none = torch.constant.none
+  %zero_points = torch.vtensor.literal(dense<0> : tensor<4xsi64>) : !torch.vtensor<[4],si64>
+  %0 = torch.per_tensor_affine.create %arg0, %scale, %int0 : !torch.vtensor<[2,3],si8>, !torch.float, !torch.int -> !torch.vtensor<[2,3],!torch.qint8>
+  %1 = torch.aten.dequantize.self %0 : !torch.vtensor<[2,3],!torch.qint8> -> !torch.vtensor<[2,3],f32>
+  %2 = torch.per_channel_affine.create %arg1, %arg2, %zero_points, %int0 : !torch.vtensor<[4,3],si8>, !torch.vtensor<[4],f64>, !torch.vtensor<[4],si64>, !torch.int -> !torch.vtensor<[4,3],!torch.qint8>
+  %3 = torch.aten.dequantize.self %2 : !torch.vtensor<[4,3],!torch.qint8> -> !torch.vtensor<[4,3],f32>
+  %4 = torch.aten.linear %1, %3, %none : !torch.vtensor<[2,3],f32>, !torch.vtensor<[4,3],f32>, !torch.none -> !torch.vtensor<[2,4],f32>
+  return %4 : !torch.vtensor<[2,4],f32>
+}
+
+// -----
+
+// CHECK-DAG:   #[[INPUT_MAP:.*]] = affine_map<(d0, d1, d2) -> (d0, d2)>
+// CHECK-DAG:   #[[WEIGHT_MAP:.*]] = affine_map<(d0, d1, d2) -> (d1, d2 floordiv 2)>
+// CHECK-DAG:   #[[SCALES_MAP:.*]] = affine_map<(d0, d1, d2) -> (d1, d2 floordiv 32)>
+// CHECK-DAG:   #[[OUTPUT_MAP:.*]] = affine_map<(d0, d1, d2) -> (d0, d1)>
+// CHECK-LABEL: func.func @torch.group_quantized.linear$int4(
+// CHECK:         %[[INIT:.*]] = linalg.fill
+// CHECK:         linalg.generic {indexing_maps = [#[[INPUT_MAP]], #[[WEIGHT_MAP]], #[[SCALES_MAP]], #[[OUTPUT_MAP]]], iterator_types = ["parallel", "parallel", "reduction"]} ins(%{{.*}}, %{{.*}}, %{{.*}} : tensor<2x64xf32>, tensor<3x32xi8>, tensor<3x2xf32>) outs(%[[INIT]] : tensor<2x3xf32>)
+// CHECK:         ^bb0(%[[X:.*]]: f32, %[[PACKED:.*]]: i8, %[[SCALE:.*]]: f32, %[[ACC:.*]]: f32):
+// CHECK:           %[[K:.*]] = linalg.index 2 : index
+// CHECK:           %[[K8:.*]] = arith.index_cast %[[K]] : index to i8
+// CHECK:           %[[PARITY:.*]] = arith.andi %[[K8]], %{{.*}} : i8
+// CHECK:           %[[SHIFT:.*]] = arith.subi
+// CHECK:           %[[HIGH:.*]] = arith.shli %[[PACKED]], %[[SHIFT]] : i8
+// CHECK:           %[[Q:.*]] = arith.shrsi %[[HIGH]], %{{.*}} : i8
+// CHECK:           %[[W:.*]] = arith.sitofp %[[Q]] : i8 to f32
+// CHECK:           %[[DEQUANTIZED:.*]] = arith.mulf %[[W]], %[[SCALE]] : f32
+// CHECK:           %[[PRODUCT:.*]] = arith.mulf %[[X]], %[[DEQUANTIZED]] : f32
+// CHECK:           %[[SUM:.*]] = arith.addf %[[ACC]], %[[PRODUCT]] : f32
+// CHECK:           linalg.yield %[[SUM]] : f32
+func.func @torch.group_quantized.linear$int4(%arg0: !torch.vtensor<[2,64],f32>, %arg1: !torch.vtensor<[3,32],si8>, %arg2: !torch.vtensor<[3,2],f32>) -> !torch.vtensor<[2,3],f32> {
+  %int4 = torch.constant.int 4
+  %int32 = torch.constant.int 32
+  %none = torch.constant.none
+  %0 = torch.group_quantized.linear %arg0, %arg1, %arg2, %int4, %int32, %none : !torch.vtensor<[2,64],f32>, !torch.vtensor<[3,32],si8>, !torch.vtensor<[3,2],f32>, !torch.none -> !torch.vtensor<[2,3],f32>
+  return %0 : !torch.vtensor<[2,3],f32>
+}
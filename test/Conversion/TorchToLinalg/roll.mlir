@@ -0,0 +1,48 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg -split-input-file -verify-diagnostics | FileCheck %s
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.roll$basic(
+// CHECK-SAME:                                     %[[ARG:.*]]: !torch.vtensor<[3,4],f32>) -> !torch.vtensor<[3,4],f32> {
+// CHECK:           %[[INPUT:.*]] = torch_c.to_builtin_tensor %[[ARG]] : !torch.vtensor<[3,4],f32> -> tensor<3x4xf32>
+// CHECK:           %[[EMPTY:.*]] = tensor.empty() : tensor<3x4xf32>
+// CHECK:           %[[SLICE0:.*]] = tensor.extract_slice %[[INPUT]][0, 0] [2, 2] [1, 1] : tensor<3x4xf32> to tensor<2x2xf32>
+// CHECK:           %[[INSERT0:.*]] = tensor.insert_slice %[[SLICE0]] into %[[EMPTY]][1, 2] [2, 2] [1, 1] : tensor<2x2xf32> into tensor<3x4xf32>
+// CHECK:           %[[SLICE1:.*]] = tensor.extract_slice %[[INPUT]][0, 2] [2, 2] [1, 1] : tensor<3x4xf32> to tensor<2x2xf32>
+// CHECK:           %[[INSERT1:.*]] = tensor.insert_slice %[[SLICE1]] into %[[INSERT0]][1, 0] [2, 2] [1, 1] : tensor<2x2xf32> into tensor<3x4xf32>
+// CHECK:           %[[SLICE2:.*]] = tensor.extract_slice %[[INPUT]][2, 0] [1, 2] [1, 1] : tensor<3x4xf32> to tensor<1x2xf32>
+// CHECK:           %[[INSERT2:.*]] = tensor.insert_slice %[[SLICE2]] into %[[INSERT1]][0, 2] [1, 2] [1, 1] : tensor<1x2xf32> into tensor<3x4xf32>
+// CHECK:           %[[SLICE3:.*]] = tensor.extract_slice %[[INPUT]][2, 2] [1, 2] [1, 1] : tensor<3x4xf32> to tensor<1x2xf32>
+// CHECK:           %[[INSERT3:.*]] = tensor.insert_slice %[[SLICE3]] into %[[INSERT2]][0, 0] [1, 2] [1, 1] : tensor<1x2xf32> into tensor<3x4xf32>
+// CHECK:           %[[CAST:.*]] = tensor.cast %[[INSERT3]] : tensor<3x4xf32> to tensor<3x4xf32>
+// CHECK:           %[[RESULT:.*]] = torch_c.from_builtin_tensor %[[CAST]] : tensor<3x4xf32> -> !torch.vtensor<[3,4],f32>
+// CHECK:           return %[[RESULT]] : !torch.vtensor<[3,4],f32>
+func.func @torch.aten.roll$basic(%arg0: !torch.vtensor<[3,4],f32>) -> !torch.vtensor<[3,4],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int-2 = torch.constant.int -2
+  %int1_0 = torch.constant.int 1
+  %0 = torch.prim.ListConstruct %int1_0, %int-2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.aten.roll %arg0, %0, %1 : !torch.vtensor<[3,4],f32>, !torch.list<int>, !torch.list<int> -> !torch.vtensor<[3,4],f32>
+  return %2 : !torch.vtensor<[3,4],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.roll$dynamic_shift(
+// CHECK-SAME:                                             %[[ARG:.*]]: !torch.vtensor<[?,4],f32>, %[[SHIFT:.*]]: !torch.int) -> !torch.vtensor<[?,4],f32> {
+// CHECK:           %[[EMPTY:.*]] = tensor.empty(%{{.*}}) : tensor<?x4xf32>
+// CHECK:           %[[SLICE0:.*]] = tensor.extract_slice %{{.*}}[0, 0] [%[[REST:.*]], 4] [1, 1] : tensor<?x4xf32> to tensor<?x4xf32>
+// CHECK:           %[[INSERT0:.*]] = tensor.insert_slice %[[SLICE0]] into %[[EMPTY]][%[[OFFSET:.*]], 0] [%[[REST]], 4] [1, 1] : tensor<?x4xf32> into tensor<?x4xf32>
+// CHECK:           %[[SLICE1:.*]] = tensor.extract_slice %{{.*}}[%[[REST]], 0] [%[[OFFSET]], 4] [1, 1] : tensor<?x4xf32> to tensor<?x4xf32>
+// CHECK:           %[[INSERT1:.*]] = tensor.insert_slice %[[SLICE1]] into %[[INSERT0]][0, 0] [%[[OFFSET]], 4] [1, 1] : tensor<?x4xf32> into tensor<?x4xf32>
+// CHECK-NOT:       tensor.insert_slice
+// CHECK:           tensor.cast %[[INSERT1]] : tensor<?x4xf32> to tensor<?x4xf32>
+func.func @torch.aten.roll$dynamic_shift(%arg0: !torch.vtensor<[?,4],f32>, %arg1: !torch.int) -> !torch.vtensor<[?,4],f32> {
+  %int0 = torch.constant.int 0
+  %0 = torch.prim.ListConstruct %arg1 : (!torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0 : (!torch.int) -> !torch.list<int>
+  %2 = torch.aten.roll %arg0, %0, %1 : !torch.vtensor<[?,4],f32>, !torch.list<int>, !torch.list<int> -> !torch.vtensor<[?,4],f32>
+  return %2 : !torch.vtensor<[?,4],f32>
+}
@@ -0,0 +1,85 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg -split-input-file -verify-diagnostics | FileCheck %s
+
+// CHECK-DAG:   #[[MAP:.*]] = affine_map<(d0, d1) -> (d0, d1)>
+// CHECK-DAG:   #[[REDUCED:.*]] = affine_map<(d0, d1) -> (d0)>
+// CHECK-LABEL: func.func @torch.aten._softmax(
+// CHECK:         %[[INPUT:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[?,?],f32> -> tensor<?x?xf32>
+// CHECK:         %[[NEG_INF:.*]] = arith.constant 0xFF800000 : f32
+// CHECK:         %[[ZERO:.*]] = arith.constant 0.000000e+00 : f32
+// CHECK:         %[[MAX_INIT:.*]] = linalg.fill ins(%[[NEG_INF]] : f32)
+// CHECK:         %[[SUM_INIT:.*]] = linalg.fill ins(%[[ZERO]] : f32)
+// CHECK:         %[[STATS:.*]]:2 = linalg.generic {indexing_maps = [#[[MAP]], #[[REDUCED]], #[[REDUCED]]], iterator_types = ["parallel", "reduction"]}
+// CHECK-SAME:        ins(%[[INPUT]] : tensor<?x?xf32>) outs(%[[MAX_INIT]], %[[SUM_INIT]] : tensor<?xf32>, tensor<?xf32>)
+// CHECK:         ^bb0(%[[X:.*]]: f32, %[[MAX:.*]]: f32, %[[SUM:.*]]: f32):
+// CHECK:           %[[NEW_MAX:.*]] = arith.maxf %[[MAX]], %[[X]] : f32
+// CHECK:           math.exp
+// CHECK:           arith.mulf %[[SUM]]
+// CHECK:           math.exp
+// CHECK:           %[[NEW_SUM:.*]] = arith.addf
+// CHECK:           linalg.yield %[[NEW_MAX]], %[[NEW_SUM]] : f32, f32
+// CHECK:         linalg.generic {indexing_maps = [#[[MAP]], #[[REDUCED]], #[[REDUCED]], #[[MAP]]], iterator_types = ["parallel", "parallel"]}
+// CHECK-SAME:        ins(%[[INPUT]], %[[STATS]]#0, %[[STATS]]#1 : tensor<?x?xf32>, tensor<?xf32>, tensor<?xf32>)
+// CHECK:         ^bb0(%[[X:.*]]: f32, %[[MAX:.*]]: f32, %[[SUM:.*]]: f32, %{{.*}}: f32):
+// CHECK:           %[[SHIFTED:.*]] = arith.subf %[[X]], %[[MAX]] : f32
+// CHECK:           %[[EXP:.*]] = math.exp %[[SHIFTED]] : f32
+// CHECK:           %[[RESULT:.*]] = arith.divf %[[EXP]], %[[SUM]] : f32
+// CHECK:           linalg.yield %[[RESULT]] : f32
+func.func @torch.aten._softmax(%arg0: !torch.vtensor<[?,?],f32>) -> !torch.vtensor<[?,?],f32> {
+  %int1 = torch.constant.int 1
+  %false = torch.constant.bool false
+  %0 = torch.aten._softmax %arg0, %int1, %false : !torch.vtensor<[?,?],f32>, !torch.int, !torch.bool -> !torch.vtensor<[?,?],f32>
+  return %0 : !torch.vtensor<[?,?],f32>
+}
+
+// -----
+
+// The exponentials of a half-precision log-softmax are summed in f32.
+// CHECK-LABEL: func.func @torch.aten.log_softmax.int$f16(
+// CHECK:         linalg.generic {{.*}} iterator_types = ["reduction", "parallel"]
+// CHECK-SAME:        outs(%{{.*}}, %{{.*}} : tensor<4xf32>, tensor<4xf32>)
+// CHECK:           arith.extf %{{.*}} : f16 to f32
+// CHECK:         linalg.generic
+// CHECK:           %[[SHIFTED:.*]] = arith.subf
+// CHECK:           %[[LOG:.*]] = math.log
+// CHECK:           %[[RESULT:.*]] = arith.subf %[[SHIFTED]], %[[LOG]] : f32
+// CHECK:           %[[TRUNC:.*]] = arith.truncf %[[RESULT]] : f32 to f16
+// CHECK:           linalg.yield %[[TRUNC]] : f16
+func.func @torch.aten.log_softmax.int$f16(%arg0: !torch.vtensor<[3,4],f16>) -> !torch.vtensor<[3,4],f16> {
+  %int0 = torch.constant.int 0
+  %none = torch.constant.none
+  %0 = torch.aten.log_softmax.int %arg0, %int0, %none : !torch.vtensor<[3,4],f16>, !torch.int, !torch.none -> !torch.vtensor<[3,4],f16>
+  return %0 : !torch.vtensor<[3,4],f16>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @torch.aten.cross_entropy_loss(
+// CHECK-DAG:     %[[INPUT:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[?,?],f32> -> tensor<?x?xf32>
+// CHECK-DAG:     %[[TARGET:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[?],si64> -> tensor<?xi64>
+// CHECK:         %[[STATS:.*]]:2 = linalg.generic {{.*}} iterator_types = ["parallel", "reduction"]
+// CHECK-SAME:        ins(%[[INPUT]] : tensor<?x?xf32>) outs(%{{.*}}, %{{.*}} : tensor<?xf32>, tensor<?xf32>)
+// CHECK:         %[[LOSSES:.*]] = linalg.generic {{.*}} iterator_types = ["parallel"]
+// CHECK-SAME:        ins(%[[TARGET]], %[[STATS]]#0, %[[STATS]]#1 : tensor<?xi64>, tensor<?xf32>, tensor<?xf32>)
+// CHECK:         ^bb0(%[[CLASS:.*]]: i64, %[[MAX:.*]]: f32, %[[SUM:.*]]: f32, %{{.*}}: f32):
+// CHECK:           %[[IGNORED:.*]] = arith.cmpi eq
+// CHECK:           %[[CLASS_INDEX:.*]] = arith.select %[[IGNORED]]
+// CHECK:           %[[ROW:.*]] = linalg.index 0 : index
+// CHECK:           %[[LOGIT:.*]] = tensor.extract %[[INPUT]][%[[ROW]], %[[CLASS_INDEX]]] : tensor<?x?xf32>
+// CHECK:           %[[LOG_SUM:.*]] = math.log %[[SUM]] : f32
+// CHECK:           %[[LOG_SUM_EXP:.*]] = arith.addf %[[MAX]], %[[LOG_SUM]] : f32
+// CHECK:           %[[LOSS:.*]] = arith.subf %[[LOG_SUM_EXP]], %[[LOGIT]] : f32
+// CHECK:           %[[RESULT:.*]] = arith.select %[[IGNORED]], %{{.*}}, %[[LOSS]] : f32
+// CHECK:           linalg.yield %[[RESULT]] : f32
+// CHECK:         %[[TOTALS:.*]]:2 = linalg.generic {{.*}} iterator_types = ["reduction"]
+// CHECK-SAME:        ins(%[[LOSSES]], %[[TARGET]] : tensor<?xf32>, tensor<?xi64>) outs(%{{.*}}, %{{.*}} : tensor<f32>, tensor<f32>)
+// CHECK:         linalg.generic
+// CHECK-SAME:        ins(%[[TOTALS]]#0, %[[TOTALS]]#1 : tensor<f32>, tensor<f32>)
+// CHECK:           arith.divf
+func.func @torch.aten.cross_entropy_loss(%arg0: !torch.vtensor<[?,?],f32>, %arg1: !torch.vtensor<[?],si64>) -> !torch.vtensor<[],f32> {
+  %none = torch.constant.none
+  %int1 = torch.constant.int 1
+  %int-100 = torch.constant.int -100
+  %float0.000000e00 = torch.constant.float 0.000000e+00
+  %0 = torch.aten.cross_entropy_loss %arg0, %arg1, %none, %int1, %int-100, %float0.000000e00 : !torch.vtensor<[?,?],f32>, !torch.vtensor<[?],si64>, !torch.none, !torch.int, !torch.int, !torch.float -> !torch.vtensor<[],f32>
+  return %0 : !torch.vtensor<[],f32>
+}
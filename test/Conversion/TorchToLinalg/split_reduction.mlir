@@ -0,0 +1,49 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="reduction-split-factor=4" -split-input-file | FileCheck %s
+
+// CHECK-LABEL:   func.func @torch.aten.sum$split(
+// CHECK:           %[[INPUT:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[8,16],f32> -> tensor<8x16xf32>
+// CHECK:           %[[FLAT:.*]] = tensor.collapse_shape %[[INPUT]] {{\[\[}}0, 1]] : tensor<8x16xf32> into tensor<128xf32>
+// CHECK:           %[[CHUNKS:.*]] = tensor.expand_shape %[[FLAT]] {{\[\[}}0, 1]] : tensor<128xf32> into tensor<4x32xf32>
+// CHECK:           %[[PARTIALS:.*]] = linalg.generic {{.*}} iterator_types = ["parallel", "reduction"]} ins(%[[CHUNKS]] : tensor<4x32xf32>)
+// CHECK:             arith.addf
+// CHECK:           %[[SUM:.*]] = linalg.generic {{.*}} iterator_types = ["reduction"]} ins(%[[PARTIALS]] : tensor<?xf32>) outs(%{{.*}} : tensor<f32>)
+// CHECK:             arith.addf
+// CHECK:           tensor.cast %[[SUM]] : tensor<f32> to tensor<f32>
+func.func @torch.aten.sum$split(%arg0: !torch.vtensor<[8,16],f32>) -> !torch.vtensor<[],f32> {
+  %none = torch.constant.none
+  %0 = torch.aten.sum %arg0, %none : !torch.vtensor<[8,16],f32>, !torch.none -> !torch.vtensor<[],f32>
+  return %0 : !torch.vtensor<[],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.sum.dim_IntList$keepdim(
+// CHECK:           %[[PARTIALS:.*]] = linalg.generic {{.*}} iterator_types = ["parallel", "reduction"]} ins(%{{.*}} : tensor<4x32xf32>)
+// CHECK:           %[[SUM:.*]] = linalg.generic {{.*}} iterator_types = ["reduction"]} ins(%[[PARTIALS]] : tensor<?xf32>)
+// CHECK:           %[[EXPANDED:.*]] = tensor.expand_shape %[[SUM]] [] : tensor<f32> into tensor<1x1xf32>
+// CHECK:           tensor.cast %[[EXPANDED]] : tensor<1x1xf32> to tensor<1x1xf32>
+func.func @torch.aten.sum.dim_IntList$keepdim(%arg0: !torch.vtensor<[8,16],f32>) -> !torch.vtensor<[1,1],f32> {
+  %none = torch.constant.none
+  %true = torch.constant.bool true
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %0 = torch.prim.ListConstruct %int0, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.aten.sum.dim_IntList %arg0, %0, %true, %none : !torch.vtensor<[8,16],f32>, !torch.list<int>, !torch.bool, !torch.none -> !torch.vtensor<[1,1],f32>
+  return %1 : !torch.vtensor<[1,1],f32>
+}
+
+// -----
+
+// Reductions over some of the dims, or of dynamically shaped inputs, are not
+// split.
+// CHECK-LABEL:   func.func @torch.aten.sum.dim_IntList$partial(
+// CHECK-NOT:       tensor.expand_shape
+// CHECK:           linalg.generic {{.*}} iterator_types = ["parallel", "reduction"]} ins(%{{.*}} : tensor<8x16xf32>)
+func.func @torch.aten.sum.dim_IntList$partial(%arg0: !torch.vtensor<[8,16],f32>) -> !torch.vtensor<[8],f32> {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int1 = torch.constant.int 1
+  %0 = torch.prim.ListConstruct %int1 : (!torch.int) -> !torch.list<int>
+  %1 = torch.aten.sum.dim_IntList %arg0, %0, %false, %none : !torch.vtensor<[8,16],f32>, !torch.list<int>, !torch.bool, !torch.none -> !torch.vtensor<[8],f32>
+  return %1 : !torch.vtensor<[8],f32>
+}
@@ -0,0 +1,28 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg -split-input-file -verify-diagnostics | FileCheck %s
+
+// The source rows and columns are computed once per row and per column of the
+// result, and the per-element payload only gathers from the input.
+// CHECK-DAG:   #[[ID1:.*]] = affine_map<(d0) -> (d0)>
+// CHECK-DAG:   #[[ROW:.*]] = affine_map<(d0, d1, d2, d3) -> (d2)>
+// CHECK-DAG:   #[[COL:.*]] = affine_map<(d0, d1, d2, d3) -> (d3)>
+// CHECK-DAG:   #[[ID4:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+// CHECK-LABEL: func.func @torch.aten.upsample_nearest2d(
+// CHECK:         %[[INPUT:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[1,3,4,4],f32> -> tensor<1x3x4x4xf32>
+// CHECK:         %[[ROWS:.*]] = linalg.generic {indexing_maps = [#[[ID1]]], iterator_types = ["parallel"]} outs(%{{.*}} : tensor<?xindex>)
+// CHECK:           arith.floordivsi
+// CHECK:         %[[COLS:.*]] = linalg.generic {indexing_maps = [#[[ID1]]], iterator_types = ["parallel"]} outs(%{{.*}} : tensor<?xindex>)
+// CHECK:           arith.floordivsi
+// CHECK:         linalg.generic {indexing_maps = [#[[ROW]], #[[COL]], #[[ID4]]], iterator_types = ["parallel", "parallel", "parallel", "parallel"]} ins(%[[ROWS]], %[[COLS]] : tensor<?xindex>, tensor<?xindex>)
+// CHECK:         ^bb0(%[[ROW_IDX:.*]]: index, %[[COL_IDX:.*]]: index, %{{.*}}: f32):
+// CHECK-NOT:       arith.floordivsi
+// CHECK:           %[[N:.*]] = linalg.index 0 : index
+// CHECK:           %[[C:.*]] = linalg.index 1 : index
+// CHECK:           %[[VALUE:.*]] = tensor.extract %[[INPUT]][%[[N]], %[[C]], %[[ROW_IDX]], %[[COL_IDX]]] : tensor<1x3x4x4xf32>
+// CHECK:           linalg.yield %[[VALUE]] : f32
+func.func @torch.aten.upsample_nearest2d(%arg0: !torch.vtensor<[1,3,4,4],f32>) -> !torch.vtensor<[1,3,8,8],f32> {
+  %none = torch.constant.none
+  %int8 = torch.constant.int 8
+  %0 = torch.prim.ListConstruct %int8, %int8 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.aten.upsample_nearest2d %arg0, %0, %none, %none : !torch.vtensor<[1,3,4,4],f32>, !torch.list<int>, !torch.none, !torch.none -> !torch.vtensor<[1,3,8,8],f32>
+  return %1 : !torch.vtensor<[1,3,8,8],f32>
+}
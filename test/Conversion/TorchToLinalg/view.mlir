@@ -73,4 +73,55 @@ func.func @torch.aten.view$expandInferredDim(%arg0: !torch.vtensor<[2,6],f32>) -
     %0 = torch.prim.ListConstruct %int3, %int2, %int-1 : (!torch.int, !torch.int, !torch.int) -> !torch.list<int>
     %1 = torch.aten.view %arg0, %0 : !torch.vtensor<[2,6],f32>, !torch.list<int> -> !torch.vtensor<[3,2,2],f32>
     return %1 : !torch.vtensor<[3,2,2],f32>
-  }
\ No newline at end of file
+  }
+// -----
+
+// CHECK-LABEL: func.func @torch.aten.view$collapseMulOfSizes(
+// CHECK:         %[[IN:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[?,?,4],f32> -> tensor<?x?x4xf32>
+// CHECK-NOT:     cf.assert
+// CHECK:         %[[COLLAPSED:.*]] = tensor.collapse_shape %[[IN]] {{\[\[}}0, 1], [2]] : tensor<?x?x4xf32> into tensor<?x4xf32>
+// CHECK:         tensor.cast %[[COLLAPSED]] : tensor<?x4xf32> to tensor<?x4xf32>
+func.func @torch.aten.view$collapseMulOfSizes(%arg0: !torch.vtensor<[?,?,4],f32>) -> !torch.vtensor<[?,4],f32> {
+    %int0 = torch.constant.int 0
+    %int1 = torch.constant.int 1
+    %int4 = torch.constant.int 4
+    %0 = torch.aten.size.int %arg0, %int0 : !torch.vtensor<[?,?,4],f32>, !torch.int -> !torch.int
+    %1 = torch.aten.size.int %arg0, %int1 : !torch.vtensor<[?,?,4],f32>, !torch.int -> !torch.int
+    %2 = torch.aten.mul.int %0, %1 : !torch.int, !torch.int -> !torch.int
+    %3 = torch.prim.ListConstruct %2, %int4 : (!torch.int, !torch.int) -> !torch.list<int>
+    %4 = torch.aten.view %arg0, %3 : !torch.vtensor<[?,?,4],f32>, !torch.list<int> -> !torch.vtensor<[?,4],f32>
+    return %4 : !torch.vtensor<[?,4],f32>
+  }
+
+// -----
+
+// CHECK-LABEL: func.func @torch.aten.view$inferredDimOfDynamicInput(
+// CHECK:         %[[IN:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[?,6],f32> -> tensor<?x6xf32>
+// CHECK:         %[[FLAT:.*]] = tensor.collapse_shape %[[IN]] {{\[\[}}0, 1]] : tensor<?x6xf32> into tensor<?xf32>
+// CHECK:         %[[EXPANDED:.*]] = tensor.expand_shape %[[FLAT]] {{\[\[}}0, 1]] : tensor<?xf32> into tensor<3x?xf32>
+// CHECK:         tensor.cast %[[EXPANDED]] : tensor<3x?xf32> to tensor<3x?xf32>
+// CHECK-NOT:     tensor.reshape
+func.func @torch.aten.view$inferredDimOfDynamicInput(%arg0: !torch.vtensor<[?,6],f32>) -> !torch.vtensor<[3,?],f32> {
+    %int3 = torch.constant.int 3
+    %int-1 = torch.constant.int -1
+    %0 = torch.prim.ListConstruct %int3, %int-1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %1 = torch.aten.view %arg0, %0 : !torch.vtensor<[?,6],f32>, !torch.list<int> -> !torch.vtensor<[3,?],f32>
+    return %1 : !torch.vtensor<[3,?],f32>
+  }
+
+// -----
+
+// CHECK-LABEL: func.func @torch.aten.view$reorderedSizes(
+// CHECK:         %[[IN:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[?,?],f32> -> tensor<?x?xf32>
+// CHECK:         %[[SHAPE:.*]] = tensor.from_elements %{{.*}}, %{{.*}} : tensor<2xindex>
+// CHECK:         %[[RESHAPED:.*]] = tensor.reshape %[[IN]](%[[SHAPE]]) : (tensor<?x?xf32>, tensor<2xindex>) -> tensor<?x?xf32>
+// CHECK:         tensor.cast %[[RESHAPED]] : tensor<?x?xf32> to tensor<?x?xf32>
+func.func @torch.aten.view$reorderedSizes(%arg0: !torch.vtensor<[?,?],f32>) -> !torch.vtensor<[?,?],f32> {
+    %int0 = torch.constant.int 0
+    %int1 = torch.constant.int 1
+    %0 = torch.aten.size.int %arg0, %int0 : !torch.vtensor<[?,?],f32>, !torch.int -> !torch.int
+    %1 = torch.aten.size.int %arg0, %int1 : !torch.vtensor<[?,?],f32>, !torch.int -> !torch.int
+    %2 = torch.prim.ListConstruct %1, %0 : (!torch.int, !torch.int) -> !torch.list<int>
+    %3 = torch.aten.view %arg0, %2 : !torch.vtensor<[?,?],f32>, !torch.list<int> -> !torch.vtensor<[?,?],f32>
+    return %3 : !torch.vtensor<[?,?],f32>
+  }
@@ -214,3 +214,38 @@ func.func @torch.prim.Loop$for_with_multiple_results(%arg0: !torch.int) -> (!tor
   } : (!torch.int, !torch.bool, !torch.float, !torch.float) -> (!torch.float, !torch.float)
   return %0#0, %0#1 : !torch.float, !torch.float
 }
+
+// The carried tensor keeps the static shape that both the initial and the
+// yielded values have.
+// CHECK-LABEL: func.func @torch.prim.Loop$for_with_tensor
+// CHECK-SAME:  (%[[TORCH_ARG0:.*]]: !torch.int, %[[TORCH_ARG1:.*]]: !torch.vtensor<[2,3],f32>, %[[TORCH_ARG2:.*]]: !torch.vtensor<[2,3],f32>) -> !torch.vtensor<[?,3],f32> {
+// CHECK:         %[[TORCH_INIT:.*]] = torch.tensor_static_info_cast %[[TORCH_ARG1]] : !torch.vtensor<[2,3],f32> to !torch.vtensor<[?,3],f32>
+// CHECK:         %[[INIT:.*]] = torch_c.to_builtin_tensor %[[TORCH_INIT]] : !torch.vtensor<[?,3],f32> -> tensor<?x3xf32>
+// CHECK:         %[[INIT_CAST:.*]] = tensor.cast %[[INIT]] : tensor<?x3xf32> to tensor<2x3xf32>
+// CHECK:         %[[LOOP:.*]] = scf.for %[[IV:.*]] = %{{.*}} to %{{.*}} step %{{.*}}
+// CHECK-SAME:      iter_args(%[[ITER_ARG:.*]] = %[[INIT_CAST]]) -> (tensor<2x3xf32>) {
+// CHECK:           %[[CAST:.*]] = tensor.cast %[[ITER_ARG]] : tensor<2x3xf32> to tensor<?x3xf32>
+// CHECK:           %[[TORCH_ITER_ARG:.*]] = torch_c.from_builtin_tensor %[[CAST]] : tensor<?x3xf32> -> !torch.vtensor<[?,3],f32>
+// CHECK:           %[[ADD:.*]] = torch.aten.add.Tensor %[[TORCH_ITER_ARG]], %[[TORCH_ARG2]], %{{.*}} : !torch.vtensor<[?,3],f32>, !torch.vtensor<[2,3],f32>, !torch.int -> !torch.vtensor<[2,3],f32>
+// CHECK:           %[[TANH:.*]] = torch.aten.tanh %[[ADD]] : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+// CHECK:           %[[TORCH_VAL:.*]] = torch.tensor_static_info_cast %[[TANH]] : !torch.vtensor<[2,3],f32> to !torch.vtensor<[?,3],f32>
+// CHECK:           %[[VAL:.*]] = torch_c.to_builtin_tensor %[[TORCH_VAL]] : !torch.vtensor<[?,3],f32> -> tensor<?x3xf32>
+// CHECK:           %[[VAL_CAST:.*]] = tensor.cast %[[VAL]] : tensor<?x3xf32> to tensor<2x3xf32>
+// CHECK:           scf.yield %[[VAL_CAST]] : tensor<2x3xf32>
+// CHECK:         }
+// CHECK:         %[[RESULT:.*]] = tensor.cast %[[LOOP]] : tensor<2x3xf32> to tensor<?x3xf32>
+// CHECK:         %[[TORCH_RESULT:.*]] = torch_c.from_builtin_tensor %[[RESULT]] : tensor<?x3xf32> -> !torch.vtensor<[?,3],f32>
+// CHECK:         return %[[TORCH_RESULT]] : !torch.vtensor<[?,3],f32>
+func.func @torch.prim.Loop$for_with_tensor(%arg0: !torch.int, %arg1: !torch.vtensor<[2,3],f32>, %arg2: !torch.vtensor<[2,3],f32>) -> !torch.vtensor<[?,3],f32> {
+  %true = torch.constant.bool true
+  %int1 = torch.constant.int 1
+  %0 = torch.tensor_static_info_cast %arg1 : !torch.vtensor<[2,3],f32> to !torch.vtensor<[?,3],f32>
+  %1 = torch.prim.Loop %arg0, %true, init(%0) {
+  ^bb0(%arg3: !torch.int, %arg4: !torch.vtensor<[?,3],f32>):
+    %2 = torch.aten.add.Tensor %arg4, %arg2, %int1 : !torch.vtensor<[?,3],f32>, !torch.vtensor<[2,3],f32>, !torch.int -> !torch.vtensor<[2,3],f32>
+    %3 = torch.aten.tanh %2 : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+    %4 = torch.tensor_static_info_cast %3 : !torch.vtensor<[2,3],f32> to !torch.vtensor<[?,3],f32>
+    torch.prim.Loop.condition %true, iter(%4 : !torch.vtensor<[?,3],f32>)
+  } : (!torch.int, !torch.bool, !torch.vtensor<[?,3],f32>) -> !torch.vtensor<[?,3],f32>
+  return %1 : !torch.vtensor<[?,3],f32>
+}
@@ -201,9 +201,9 @@ func.func @torch.aten.batch_norm$inference(%arg0: !torch.vtensor<[?,3,?,?],f32>)
 // CHECK:           %[[VAL_5:.*]] = tensor.dim %[[VAL_1]], %[[VAL_4]] : tensor<?x3x?x?xf32>
 // CHECK:           %[[VAL_6:.*]] = tensor.from_elements %[[VAL_5]] : tensor<1xindex>
 // CHECK:           %[[VAL_7:.*]] = stablehlo.constant dense<1.000000e+00> : tensor<f32>
-// CHECK:           %[[VAL_8:.*]] = stablehlo.dynamic_broadcast_in_dim %[[VAL_7]], %[[VAL_6]], dims = [] : (tensor<f32>, tensor<1xindex>) -> tensor<3xf32>
+// CHECK:           %[[VAL_8:.*]] = stablehlo.broadcast_in_dim %[[VAL_7]], dims = [] : (tensor<f32>) -> tensor<3xf32>
 // CHECK:           %[[VAL_9:.*]] = stablehlo.constant dense<0.000000e+00> : tensor<f32>
-// CHECK:           %[[VAL_10:.*]] = stablehlo.dynamic_broadcast_in_dim %[[VAL_9]], %[[VAL_6]], dims = [] : (tensor<f32>, tensor<1xindex>) -> tensor<3xf32>
+// CHECK:           %[[VAL_10:.*]] = stablehlo.broadcast_in_dim %[[VAL_9]], dims = [] : (tensor<f32>) -> tensor<3xf32>
 // CHECK:           %[[VAL_11:.*]], %[[VAL_12:.*]], %[[VAL_13:.*]] = "stablehlo.batch_norm_training"(%[[VAL_1]], %[[VAL_8]], %[[VAL_10]]) {epsilon = 9.99999974E-6 : f32, feature_index = 1 : i64} : (tensor<?x3x?x?xf32>, tensor<3xf32>, tensor<3xf32>) -> (tensor<?x3x?x?xf32>, tensor<3xf32>, tensor<3xf32>)
 // CHECK:           %[[VAL_14:.*]] = torch_c.from_builtin_tensor %[[VAL_11]] : tensor<?x3x?x?xf32> -> !torch.vtensor<[?,3,?,?],f32>
 // CHECK:           return %[[VAL_14]] : !torch.vtensor<[?,3,?,?],f32>
@@ -334,3 +334,52 @@ func.func @torch.aten.uniform(%arg0: !torch.vtensor<[32, 64],f64>) -> !torch.vte
   %0 = torch.aten.uniform %arg0, %float0, %float1, %none : !torch.vtensor<[32, 64],f64>, !torch.float, !torch.float, !torch.none -> !torch.vtensor<[32, 64],f64>
   return %0 : !torch.vtensor<[32, 64],f64>
 }
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.var.correction(
+// CHECK:           %[[INPUT:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[4,8],f32> -> tensor<4x8xf32>
+// CHECK:           %[[ONES:.*]] = stablehlo.broadcast_in_dim %{{.*}}, dims = [] : (tensor<f32>) -> tensor<4x8xf32>
+// CHECK:           %[[ZEROS:.*]] = stablehlo.broadcast_in_dim %{{.*}}, dims = [] : (tensor<f32>) -> tensor<4x8xf32>
+// CHECK:           %[[REDUCE:.*]]:3 = stablehlo.reduce(%[[ONES]] init: %{{.*}}), (%[[INPUT]] init: %{{.*}}), (%[[ZEROS]] init: %{{.*}}) across dimensions = [1] : (tensor<4x8xf32>, tensor<4x8xf32>, tensor<4x8xf32>, tensor<f32>, tensor<f32>, tensor<f32>) -> (tensor<4xf32>, tensor<4xf32>, tensor<4xf32>)
+// CHECK:           %[[DENOM:.*]] = chlo.broadcast_subtract %[[REDUCE]]#0, %{{.*}} : (tensor<4xf32>, tensor<f32>) -> tensor<4xf32>
+// CHECK:           %[[VAR:.*]] = stablehlo.divide %[[REDUCE]]#2, %[[DENOM]] : tensor<4xf32>
+// CHECK-NOT:       stablehlo.reduce
+// CHECK:           torch_c.from_builtin_tensor %{{.*}} : tensor<4xf32> -> !torch.vtensor<[4],f32>
+func.func @torch.aten.var.correction(%arg0: !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4],f32> {
+  %int1 = torch.constant.int 1
+  %false = torch.constant.bool false
+  %0 = torch.prim.ListConstruct %int1 : (!torch.int) -> !torch.list<int>
+  %1 = torch.aten.var.correction %arg0, %0, %int1, %false : !torch.vtensor<[4,8],f32>, !torch.list<int>, !torch.int, !torch.bool -> !torch.vtensor<[4],f32>
+  return %1 : !torch.vtensor<[4],f32>
+}
+
+// -----
+
+// The variance and the mean come out of the same reduction, accumulated in f32.
+// CHECK-LABEL:   func.func @torch.aten.var_mean.dim$bf16(
+// CHECK:           %[[INPUT:.*]] = stablehlo.convert %{{.*}} : (tensor<4x8xbf16>) -> tensor<4x8xf32>
+// CHECK:           %[[REDUCE:.*]]:3 = stablehlo.reduce(%{{.*}} init: %{{.*}}), (%[[INPUT]] init: %{{.*}}), (%{{.*}} init: %{{.*}}) across dimensions = [0, 1]
+// CHECK:           %[[VAR:.*]] = stablehlo.divide %[[REDUCE]]#2, %{{.*}} : tensor<f32>
+// CHECK:           %[[VAR16:.*]] = stablehlo.convert %[[VAR]] : (tensor<f32>) -> tensor<bf16>
+// CHECK:           stablehlo.dynamic_reshape %[[VAR16]], %{{.*}} : (tensor<bf16>, tensor<2xi64>) -> tensor<1x1xbf16>
+// CHECK:           %[[MEAN16:.*]] = stablehlo.convert %[[REDUCE]]#1 : (tensor<f32>) -> tensor<bf16>
+// CHECK:           stablehlo.dynamic_reshape %[[MEAN16]], %{{.*}} : (tensor<bf16>, tensor<2xi64>) -> tensor<1x1xbf16>
+// CHECK-NOT:       stablehlo.reduce
+func.func @torch.aten.var_mean.dim$bf16(%arg0: !torch.vtensor<[4,8],bf16>) -> (!torch.vtensor<[1,1],bf16>, !torch.vtensor<[1,1],bf16>) {
+  %none = torch.constant.none
+  %true = torch.constant.bool true
+  %0:2 = torch.aten.var_mean.dim %arg0, %none, %true, %true : !torch.vtensor<[4,8],bf16>, !torch.none, !torch.bool, !torch.bool -> !torch.vtensor<[1,1],bf16>, !torch.vtensor<[1,1],bf16>
+  return %0#0, %0#1 : !torch.vtensor<[1,1],bf16>, !torch.vtensor<[1,1],bf16>
+}
+
+// -----
+
+// CHECK-LABEL:  func.func @torch.sharding(
+// CHECK-SAME:         %{{.*}}: !torch.vtensor<[4,8],f32> {mhlo.sharding = "{devices=[2,1]0,1}"},
+// CHECK-SAME:         %{{.*}}: !torch.vtensor<[8],f32>) -> (!torch.vtensor<[4,8],f32> {mhlo.sharding = "{replicated}"}) {
+func.func @torch.sharding(%arg0: !torch.vtensor<[4,8],f32> {torch.sharding = "{devices=[2,1]0,1}"}, %arg1: !torch.vtensor<[8],f32>) -> (!torch.vtensor<[4,8],f32> {torch.sharding = "{replicated}"}) {
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.add.Tensor %arg0, %arg1, %int1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8],f32>, !torch.int -> !torch.vtensor<[4,8],f32>
+  return %0 : !torch.vtensor<[4,8],f32>
+}
@@ -0,0 +1,73 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-stablehlo -split-input-file -verify-diagnostics | FileCheck %s
+
+// CHECK-LABEL:   func.func @torch.c10d_functional.all_reduce(
+// CHECK-SAME:                                                %[[ARG:.*]]: !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4,8],f32> {
+// CHECK:           %[[INPUT:.*]] = torch_c.to_builtin_tensor %[[ARG]] : !torch.vtensor<[4,8],f32> -> tensor<4x8xf32>
+// CHECK:           %[[SUM:.*]] = "stablehlo.all_reduce"(%[[INPUT]]) ({
+// CHECK:           ^bb0(%[[LHS:.*]]: tensor<f32>, %[[RHS:.*]]: tensor<f32>):
+// CHECK:             %[[ADD:.*]] = stablehlo.add %[[LHS]], %[[RHS]] : tensor<f32>
+// CHECK:             stablehlo.return %[[ADD]] : tensor<f32>
+// CHECK:           }) {replica_groups = dense<{{\[\[}}0, 1], [2, 3]]> : tensor<2x2xi64>} : (tensor<4x8xf32>) -> tensor<4x8xf32>
+// CHECK:           %[[RESULT:.*]] = torch_c.from_builtin_tensor %[[SUM]] : tensor<4x8xf32> -> !torch.vtensor<[4,8],f32>
+// CHECK:           return %[[RESULT]] : !torch.vtensor<[4,8],f32>
+func.func @torch.c10d_functional.all_reduce(%arg0: !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4,8],f32> {
+  %str_sum = torch.constant.str "sum"
+  %str = torch.constant.str ""
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %int3 = torch.constant.int 3
+  %0 = torch.prim.ListConstruct %int0, %int1, %int2, %int3 : (!torch.int, !torch.int, !torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.c10d_functional.all_reduce %arg0, %str_sum, %str, %0, %int2 : !torch.vtensor<[4,8],f32>, !torch.str, !torch.str, !torch.list<int>, !torch.int -> !torch.vtensor<[4,8],f32>
+  %2 = torch.c10d_functional.wait_tensor %1 : !torch.vtensor<[4,8],f32> -> !torch.vtensor<[4,8],f32>
+  return %2 : !torch.vtensor<[4,8],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.c10d_functional.all_reduce$avg(
+// CHECK:           %[[SUM:.*]] = "stablehlo.all_reduce"
+// CHECK:             stablehlo.add
+// CHECK:           %[[DIVISOR:.*]] = stablehlo.constant dense<2.000000e+00> : tensor<f32>
+// CHECK:           chlo.broadcast_divide %[[SUM]], %[[DIVISOR]] : (tensor<4xf32>, tensor<f32>) -> tensor<4xf32>
+func.func @torch.c10d_functional.all_reduce$avg(%arg0: !torch.vtensor<[4],f32>) -> !torch.vtensor<[4],f32> {
+  %str_avg = torch.constant.str "avg"
+  %str = torch.constant.str ""
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %0 = torch.prim.ListConstruct %int0, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.c10d_functional.all_reduce %arg0, %str_avg, %str, %0, %int2 : !torch.vtensor<[4],f32>, !torch.str, !torch.str, !torch.list<int>, !torch.int -> !torch.vtensor<[4],f32>
+  return %1 : !torch.vtensor<[4],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.c10d_functional.all_gather_into_tensor(
+// CHECK:           "stablehlo.all_gather"(%{{.*}}) {all_gather_dim = 0 : i64, replica_groups = dense<{{\[\[}}0, 1]]> : tensor<1x2xi64>} : (tensor<2x8xf32>) -> tensor<4x8xf32>
+func.func @torch.c10d_functional.all_gather_into_tensor(%arg0: !torch.vtensor<[2,8],f32>) -> !torch.vtensor<[4,8],f32> {
+  %str = torch.constant.str ""
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %0 = torch.prim.ListConstruct %int0, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.c10d_functional.all_gather_into_tensor %arg0, %str, %0, %int2 : !torch.vtensor<[2,8],f32>, !torch.str, !torch.list<int>, !torch.int -> !torch.vtensor<[4,8],f32>
+  return %1 : !torch.vtensor<[4,8],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.c10d_functional.reduce_scatter_tensor(
+// CHECK:           "stablehlo.reduce_scatter"(%{{.*}}) ({
+// CHECK:             stablehlo.maximum
+// CHECK:           }) {replica_groups = dense<{{\[\[}}0, 1]]> : tensor<1x2xi64>, scatter_dimension = 0 : i64} : (tensor<4x8xf32>) -> tensor<2x8xf32>
+func.func @torch.c10d_functional.reduce_scatter_tensor(%arg0: !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[2,8],f32> {
+  %str_max = torch.constant.str "max"
+  %str = torch.constant.str ""
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %0 = torch.prim.ListConstruct %int0, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.c10d_functional.reduce_scatter_tensor %arg0, %str_max, %str, %0, %int2 : !torch.vtensor<[4,8],f32>, !torch.str, !torch.str, !torch.list<int>, !torch.int -> !torch.vtensor<[2,8],f32>
+  return %1 : !torch.vtensor<[2,8],f32>
+}
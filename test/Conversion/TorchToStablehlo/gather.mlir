@@ -64,3 +64,30 @@ func.func @torch.aten.embedding$rank_two_indices(%weight: !torch.vtensor<[?,?],f
   return %ret: !torch.vtensor<[?,1,?],f32>
 }
 
+
+// Indices produced by an arange with a positive step are in order.
+// CHECK-LABEL:  func.func @torch.aten.index_select$arange_indices(
+// CHECK:         "stablehlo.dynamic_gather"
+// CHECK-SAME:        indices_are_sorted = true
+func.func @torch.aten.index_select$arange_indices(%arg0: !torch.vtensor<[?,4],f32>) -> !torch.vtensor<[2,4],f32> {
+  %none = torch.constant.none
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %0 = torch.aten.arange.start_step %int0, %int2, %int1, %none, %none, %none, %none : !torch.int, !torch.int, !torch.int, !torch.none, !torch.none, !torch.none, !torch.none -> !torch.vtensor<[2],si64>
+  %1 = torch.aten.index_select %arg0, %int0, %0 : !torch.vtensor<[?,4],f32>, !torch.int, !torch.vtensor<[2],si64> -> !torch.vtensor<[2,4],f32>
+  return %1 : !torch.vtensor<[2,4],f32>
+}
+
+// CHECK-LABEL:  func.func @torch.aten.index_select$negative_step_arange(
+// CHECK:         "stablehlo.dynamic_gather"
+// CHECK-SAME:        indices_are_sorted = false
+func.func @torch.aten.index_select$negative_step_arange(%arg0: !torch.vtensor<[?,4],f32>) -> !torch.vtensor<[2,4],f32> {
+  %none = torch.constant.none
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int-1 = torch.constant.int -1
+  %0 = torch.aten.arange.start_step %int1, %int-1, %int-1, %none, %none, %none, %none : !torch.int, !torch.int, !torch.int, !torch.none, !torch.none, !torch.none, !torch.none -> !torch.vtensor<[2],si64>
+  %1 = torch.aten.index_select %arg0, %int0, %0 : !torch.vtensor<[?,4],f32>, !torch.int, !torch.vtensor<[2],si64> -> !torch.vtensor<[2,4],f32>
+  return %1 : !torch.vtensor<[2,4],f32>
+}
@@ -81,15 +81,9 @@ func.func @torch.aten.slice.strided$slice_like(%arg0: !torch.vtensor<[?,?,?],f32
 // CHECK:         %[[T14:.*]] = arith.addi %[[T4]], %[[T13]] : i64
 // CHECK:         %[[T15:.*]] = arith.cmpi sge, %[[T13]], %[[C0_I64_0]] : i64
 // CHECK:         %[[T16:.*]] = arith.select %[[T15]], %[[T13]], %[[T14]] : i64
-// CHECK:         %[[C0_1:.*]] = arith.constant 0 : index
-// CHECK:         %[[DIM_2:.*]] = tensor.dim %[[T0]], %[[C0_1]] : tensor<4x65x256xf32>
-// CHECK:         %[[T17:.*]] = arith.index_cast %[[DIM_2]] : index to i64
-// CHECK:         %[[C1:.*]] = arith.constant 1 : index
-// CHECK:         %[[DIM_3:.*]] = tensor.dim %[[T0]], %[[C1]] : tensor<4x65x256xf32>
-// CHECK:         %[[T18:.*]] = arith.index_cast %[[DIM_3]] : index to i64
-// CHECK:         %[[C2:.*]] = arith.constant 2 : index
-// CHECK:         %[[DIM_4:.*]] = tensor.dim %[[T0]], %[[C2]] : tensor<4x65x256xf32>
-// CHECK:         %[[T19:.*]] = arith.index_cast %[[DIM_4]] : index to i64
+// CHECK:         %[[T17:.*]] = arith.constant 4 : i64
+// CHECK:         %[[T18:.*]] = arith.constant 65 : i64
+// CHECK:         %[[T19:.*]] = arith.constant 256 : i64
 // CHECK:         %[[C0_I64_5:.*]] = arith.constant 0 : i64
 // CHECK:         %[[C1_I64:.*]] = arith.constant 1 : i64
 // CHECK:         %[[T20:.*]] = arith.cmpi eq, %[[T16]], %[[C0_I64_5]] : i64
@@ -191,15 +185,9 @@ func.func @torch.aten.slice.last$slice_like(%arg0: !torch.vtensor<[?,?,?],f32>)
 // CHECK:         %[[T14:.*]] = arith.addi %[[T4]], %[[T13]] : i64
 // CHECK:         %[[T15:.*]] = arith.cmpi sge, %[[T13]], %[[C0_I64_0]] : i64
 // CHECK:         %[[T16:.*]] = arith.select %[[T15]], %[[T13]], %[[T14]] : i64
-// CHECK:         %[[C0:.*]] = arith.constant 0 : index
-// CHECK:         %[[DIM_1:.*]] = tensor.dim %[[T0]], %[[C0]] : tensor<4x65x256xf32>
-// CHECK:         %[[T17:.*]] = arith.index_cast %[[DIM_1]] : index to i64
-// CHECK:         %[[C1_2:.*]] = arith.constant 1 : index
-// CHECK:         %[[DIM_3:.*]] = tensor.dim %[[T0]], %[[C1_2]] : tensor<4x65x256xf32>
-// CHECK:         %[[T18:.*]] = arith.index_cast %[[DIM_3]] : index to i64
-// CHECK:         %[[C2:.*]] = arith.constant 2 : index
-// CHECK:         %[[DIM_4:.*]] = tensor.dim %[[T0]], %[[C2]] : tensor<4x65x256xf32>
-// CHECK:         %[[T19:.*]] = arith.index_cast %[[DIM_4]] : index to i64
+// CHECK:         %[[T17:.*]] = arith.constant 4 : i64
+// CHECK:         %[[T18:.*]] = arith.constant 65 : i64
+// CHECK:         %[[T19:.*]] = arith.constant 256 : i64
 // CHECK:         %[[C0_I64_5:.*]] = arith.constant 0 : i64
 // CHECK:         %[[C1_I64:.*]] = arith.constant 1 : i64
 // CHECK:         %[[T20:.*]] = arith.cmpi eq, %[[T16]], %[[C0_I64_5]] : i64
@@ -271,15 +259,9 @@ func.func @torch.aten.slice.none$slice_like(%arg0: !torch.vtensor<[?,?,?],f32>)
 // CHECK:         %[[DIM:.*]] = tensor.dim %[[T0]], %[[C1]] : tensor<4x65x256xf32>
 // CHECK:         %[[T2:.*]] = arith.index_cast %[[DIM]] : index to i64
 // CHECK:         %[[C0_I64:.*]] = arith.constant 0 : i64
-// CHECK:         %[[C0:.*]] = arith.constant 0 : index
-// CHECK:         %[[DIM_0:.*]] = tensor.dim %[[T0]], %[[C0]] : tensor<4x65x256xf32>
-// CHECK:         %[[T3:.*]] = arith.index_cast %[[DIM_0]] : index to i64
-// CHECK:         %[[C1_1:.*]] = arith.constant 1 : index
-// CHECK:         %[[DIM_2:.*]] = tensor.dim %[[T0]], %[[C1_1]] : tensor<4x65x256xf32>
-// CHECK:         %[[T4:.*]] = arith.index_cast %[[DIM_2]] : index to i64
-// CHECK:         %[[C2:.*]] = arith.constant 2 : index
-// CHECK:         %[[DIM_3:.*]] = tensor.dim %[[T0]], %[[C2]] : tensor<4x65x256xf32>
-// CHECK:         %[[T5:.*]] = arith.index_cast %[[DIM_3]] : index to i64
+// CHECK:         %[[T3:.*]] = arith.constant 4 : i64
+// CHECK:         %[[T4:.*]] = arith.constant 65 : i64
+// CHECK:         %[[T5:.*]] = arith.constant 256 : i64
 // CHECK:         %[[C0_I64_4:.*]] = arith.constant 0 : i64
 // CHECK:         %[[C1_I64:.*]] = arith.constant 1 : i64
 // CHECK:         %[[T6:.*]] = arith.cmpi eq, %[[T2]], %[[C0_I64_4]] : i64
@@ -418,9 +400,7 @@ func.func @torch.aten.squeeze.dim$0$static(%arg0: !torch.vtensor<[2,1,2,1,2],f32
 // CHECK:         %[[C2:.*]] = arith.constant 2 : index
 // CHECK:         %[[DIM_0:.*]] = tensor.dim %[[T0]], %[[C2]] : tensor<?x1x?x1x?xf32>
 // CHECK:         %[[T2:.*]] = arith.index_cast %[[DIM_0]] : index to i64
-// CHECK:         %[[C3:.*]] = arith.constant 3 : index
-// CHECK:         %[[DIM_1:.*]] = tensor.dim %[[T0]], %[[C3]] : tensor<?x1x?x1x?xf32>
-// CHECK:         %[[T3:.*]] = arith.index_cast %[[DIM_1]] : index to i64
+// CHECK:         %[[T3:.*]] = arith.constant 1 : i64
 // CHECK:         %[[C4:.*]] = arith.constant 4 : index
 // CHECK:         %[[DIM_2:.*]] = tensor.dim %[[T0]], %[[C4]] : tensor<?x1x?x1x?xf32>
 // CHECK:         %[[T4:.*]] = arith.index_cast %[[DIM_2]] : index to i64
@@ -443,9 +423,7 @@ func.func @torch.aten.squeeze.dim$1(%arg0: !torch.vtensor<[?,1,?,1,?],f32>) -> !
 // CHECK:         %[[C0:.*]] = arith.constant 0 : index
 // CHECK:         %[[DIM:.*]] = tensor.dim %[[T0]], %[[C0]] : tensor<?x1x?x1x?xf32>
 // CHECK:         %[[T1:.*]] = arith.index_cast %[[DIM]] : index to i64
-// CHECK:         %[[C1:.*]] = arith.constant 1 : index
-// CHECK:         %[[DIM_0:.*]] = tensor.dim %[[T0]], %[[C1]] : tensor<?x1x?x1x?xf32>
-// CHECK:         %[[T2:.*]] = arith.index_cast %[[DIM_0]] : index to i64
+// CHECK:         %[[T2:.*]] = arith.constant 1 : i64
 // CHECK:         %[[C2:.*]] = arith.constant 2 : index
 // CHECK:         %[[DIM_1:.*]] = tensor.dim %[[T0]], %[[C2]] : tensor<?x1x?x1x?xf32>
 // CHECK:         %[[T3:.*]] = arith.index_cast %[[DIM_1]] : index to i64
@@ -467,17 +445,7 @@ func.func @torch.aten.squeeze.dim$from_end(%arg0: !torch.vtensor<[?,1,?,1,?],f32
 // CHECK-LABEL:  func.func @torch.aten.squeeze$static(
 // CHECK-SAME:         %[[ARG0:.*]]: !torch.vtensor<[2,1,2,1,2],f32>) -> !torch.vtensor<[2,2,2],f32> {
 // CHECK:         %[[T0:.*]] = torch_c.to_builtin_tensor %[[ARG0]] : !torch.vtensor<[2,1,2,1,2],f32> -> tensor<2x1x2x1x2xf32>
-// CHECK:         %[[C0:.*]] = arith.constant 0 : index
-// CHECK:         %[[DIM:.*]] = tensor.dim %[[T0]], %[[C0]] : tensor<2x1x2x1x2xf32>
-// CHECK:         %[[T1:.*]] = arith.index_cast %[[DIM]] : index to i64
-// CHECK:         %[[C2:.*]] = arith.constant 2 : index
-// CHECK:         %[[DIM_0:.*]] = tensor.dim %[[T0]], %[[C2]] : tensor<2x1x2x1x2xf32>
-// CHECK:         %[[T2:.*]] = arith.index_cast %[[DIM_0]] : index to i64
-// CHECK:         %[[C4:.*]] = arith.constant 4 : index
-// CHECK:         %[[DIM_1:.*]] = tensor.dim %[[T0]], %[[C4]] : tensor<2x1x2x1x2xf32>
-// CHECK:         %[[T3:.*]] = arith.index_cast %[[DIM_1]] : index to i64
-// CHECK:         %[[FROM_ELEMENTS:.*]] = tensor.from_elements %[[T1]], %[[T2]], %[[T3]] : tensor<3xi64>
-// CHECK:         %[[T4:.*]] = stablehlo.dynamic_reshape %[[T0]], %[[FROM_ELEMENTS]] : (tensor<2x1x2x1x2xf32>, tensor<3xi64>) -> tensor<2x2x2xf32>
+// CHECK:         %[[T4:.*]] = stablehlo.reshape %[[T0]] : (tensor<2x1x2x1x2xf32>) -> tensor<2x2x2xf32>
 // CHECK:         %[[T5:.*]] = torch_c.from_builtin_tensor %[[T4]] : tensor<2x2x2xf32> -> !torch.vtensor<[2,2,2],f32>
 // CHECK:         return %[[T5]] : !torch.vtensor<[2,2,2],f32>
 func.func @torch.aten.squeeze$static(%arg0: !torch.vtensor<[2,1,2,1,2],f32>) -> !torch.vtensor<[2,2,2],f32> {
@@ -0,0 +1,61 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-tmtensor -split-input-file | FileCheck %s
+
+// With constant pooling parameters, each element of the gradient gathers the
+// gradients of the 2x2 taps of the kernel that cover it, in one elementwise
+// linalg.generic.
+// CHECK-LABEL: func.func @constant_params(
+// CHECK-SAME:      %[[ARG0:.*]]: !torch.vtensor<[1,1,2,2],f32>, %[[ARG1:.*]]: !torch.vtensor<[1,1,4,4],f32>, %[[ARG2:.*]]: !torch.vtensor<[1,1,2,2],si64>)
+// CHECK-DAG:     %[[GRAD_OUTPUT:.*]] = torch_c.to_builtin_tensor %[[ARG0]] : !torch.vtensor<[1,1,2,2],f32> -> tensor<1x1x2x2xf32>
+// CHECK-DAG:     %[[INDICES:.*]] = torch_c.to_builtin_tensor %[[ARG2]] : !torch.vtensor<[1,1,2,2],si64> -> tensor<1x1x2x2xi64>
+// CHECK-NOT:     tm_tensor.scatter
+// CHECK:         %[[EMPTY:.*]] = tensor.empty({{.*}}) : tensor<{{.*}}xf32>
+// CHECK:         %[[GRAD_INPUT:.*]] = linalg.generic {{.*}} outs(%[[EMPTY]] : tensor<{{.*}}xf32>) {
+// CHECK-COUNT-4:   arith.divsi
+// CHECK:           tensor.extract %[[INDICES]][{{.*}}] : tensor<1x1x2x2xi64>
+// CHECK:           tensor.extract %[[GRAD_OUTPUT]][{{.*}}] : tensor<1x1x2x2xf32>
+// CHECK:           arith.addf
+// CHECK:           tensor.extract %[[INDICES]][{{.*}}] : tensor<1x1x2x2xi64>
+// CHECK:           tensor.extract %[[GRAD_OUTPUT]][{{.*}}] : tensor<1x1x2x2xf32>
+// CHECK:           arith.addf
+// CHECK:           tensor.extract %[[INDICES]][{{.*}}] : tensor<1x1x2x2xi64>
+// CHECK:           tensor.extract %[[GRAD_OUTPUT]][{{.*}}] : tensor<1x1x2x2xf32>
+// CHECK:           arith.addf
+// CHECK:           tensor.extract %[[INDICES]][{{.*}}] : tensor<1x1x2x2xi64>
+// CHECK:           tensor.extract %[[GRAD_OUTPUT]][{{.*}}] : tensor<1x1x2x2xf32>
+// CHECK:           %[[SUM:.*]] = arith.addf
+// CHECK-NOT:       tensor.extract
+// CHECK:           linalg.yield %[[SUM]] : f32
+// CHECK:         } -> tensor<{{.*}}xf32>
+// CHECK-NOT:     tm_tensor.scatter
+// CHECK:         %[[CAST:.*]] = tensor.cast %[[GRAD_INPUT]] : tensor<{{.*}}xf32> to tensor<1x1x4x4xf32>
+// CHECK:         torch_c.from_builtin_tensor %[[CAST]]
+func.func @constant_params(%grad_output: !torch.vtensor<[1,1,2,2],f32>, %input: !torch.vtensor<[1,1,4,4],f32>, %indices: !torch.vtensor<[1,1,2,2],si64>) -> !torch.vtensor<[1,1,4,4],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %false = torch.constant.bool false
+  %kernel_size = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %stride = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %padding = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %dilation = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.max_pool2d_with_indices_backward %grad_output, %input, %kernel_size, %stride, %padding, %dilation, %false, %indices : !torch.vtensor<[1,1,2,2],f32>, !torch.vtensor<[1,1,4,4],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.vtensor<[1,1,2,2],si64> -> !torch.vtensor<[1,1,4,4],f32>
+  return %0 : !torch.vtensor<[1,1,4,4],f32>
+}
+
+// -----
+
+// Otherwise the gradients are scattered to the positions of the maxima.
+// CHECK-LABEL: func.func @unknown_kernel_size(
+// CHECK:         tm_tensor.scatter
+func.func @unknown_kernel_size(%grad_output: !torch.vtensor<[1,1,2,2],f32>, %input: !torch.vtensor<[1,1,4,4],f32>, %indices: !torch.vtensor<[1,1,2,2],si64>, %kernel: !torch.int) -> !torch.vtensor<[1,1,4,4],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %false = torch.constant.bool false
+  %kernel_size = torch.prim.ListConstruct %kernel, %kernel : (!torch.int, !torch.int) -> !torch.list<int>
+  %stride = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %padding = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %dilation = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.max_pool2d_with_indices_backward %grad_output, %input, %kernel_size, %stride, %padding, %dilation, %false, %indices : !torch.vtensor<[1,1,2,2],f32>, !torch.vtensor<[1,1,4,4],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.vtensor<[1,1,2,2],si64> -> !torch.vtensor<[1,1,4,4],f32>
+  return %0 : !torch.vtensor<[1,1,4,4],f32>
+}
@@ -504,16 +504,15 @@ func.func @torch.aten.reshape$basic(%arg0: !torch.vtensor<[?,?,?,?],f32>) -> !to
 // CHECK-LABEL:   func.func @torch.aten.native_batch_norm$basic(
 // CHECK-SAME:                                             %[[VAL_0:.*]]: !torch.vtensor<[10,4,3],f32>) -> !torch.vtensor<[10,4,3],f32> {
 // CHECK:           %[[VAL_1:.*]] = torch_c.to_builtin_tensor %[[VAL_0]] : !torch.vtensor<[10,4,3],f32> -> tensor<10x4x3xf32>
-// CHECK:           %[[VAL_2:.*]] = "tosa.const"() <{value = dense<[5.000000e-01, 4.000000e-01, 3.000000e-01, 6.000000e-01]> : tensor<4xf32>}> : () -> tensor<4xf32>
-// CHECK:           %[[VAL_3:.*]] = "tosa.const"() <{value = dense<[3.000000e+00, 2.000000e+00, 4.000000e+00, 5.000000e+00]> : tensor<4xf32>}> : () -> tensor<4xf32>
+// CHECK-NOT:       tensor<4xf32>
 // CHECK:           %[[VAL_4:.*]] = torch.constant.float 1.000000e-01
 // CHECK:           %[[VAL_5:.*]] = torch.constant.float 1.000000e-05
 // CHECK:           %[[VAL_6:.*]] = torch.constant.bool true
 // CHECK:           %[[VAL_7:.*]] = torch.constant.bool false
-// CHECK:           %[[VAL_8:.*]] = "tosa.reshape"(%[[VAL_2]]) <{new_shape = array<i64: 4, 1>}> : (tensor<4xf32>) -> tensor<4x1xf32>
-// CHECK:           %[[VAL_9:.*]] = "tosa.reshape"(%[[VAL_3]]) <{new_shape = array<i64: 4, 1>}> : (tensor<4xf32>) -> tensor<4x1xf32>
-// CHECK:           %[[VAL_10:.*]] = "tosa.reshape"(%[[VAL_3]]) <{new_shape = array<i64: 4, 1>}> : (tensor<4xf32>) -> tensor<4x1xf32>
-// CHECK:           %[[VAL_11:.*]] = "tosa.reshape"(%[[VAL_2]]) <{new_shape = array<i64: 4, 1>}> : (tensor<4xf32>) -> tensor<4x1xf32>
+// CHECK:           %[[VAL_8:.*]] = "tosa.const"() <{value = dense<{{\[\[}}5.000000e-01], [4.000000e-01], [3.000000e-01], [6.000000e-01]]> : tensor<4x1xf32>}> : () -> tensor<4x1xf32>
+// CHECK:           %[[VAL_9:.*]] = "tosa.const"() <{value = dense<{{\[\[}}3.000000e+00], [2.000000e+00], [4.000000e+00], [5.000000e+00]]> : tensor<4x1xf32>}> : () -> tensor<4x1xf32>
+// CHECK:           %[[VAL_10:.*]] = "tosa.const"() <{value = dense<{{\[\[}}3.000000e+00], [2.000000e+00], [4.000000e+00], [5.000000e+00]]> : tensor<4x1xf32>}> : () -> tensor<4x1xf32>
+// CHECK:           %[[VAL_11:.*]] = "tosa.const"() <{value = dense<{{\[\[}}5.000000e-01], [4.000000e-01], [3.000000e-01], [6.000000e-01]]> : tensor<4x1xf32>}> : () -> tensor<4x1xf32>
 // CHECK:           %[[VAL_12:.*]] = "tosa.const"() <{value = dense<9.99999974E-6> : tensor<f32>}> : () -> tensor<f32>
 // CHECK:           %[[VAL_13:.*]] = "tosa.sub"(%[[VAL_1]], %[[VAL_8]]) : (tensor<10x4x3xf32>, tensor<4x1xf32>) -> tensor<10x4x3xf32>
 // CHECK:           %[[VAL_14:.*]] = "tosa.add"(%[[VAL_9]], %[[VAL_12]]) : (tensor<4x1xf32>, tensor<f32>) -> tensor<4x1xf32>
@@ -1133,3 +1132,105 @@ func.func @torch.aten.remainder.Scalar(%arg0: !torch.vtensor<[2, 4],f32>) -> !to
   %0 = torch.aten.remainder.Scalar %arg0, %int2 : !torch.vtensor<[2, 4],f32>, !torch.int -> !torch.vtensor<[2, 4],f32>
   return %0 : !torch.vtensor<[2, 4],f32>
 }
+
+// -----
+
+// The LHS transpose only moves a unit dim and is done by the reshape, and the
+// RHS transpose of the second matmul cancels the output transpose of the first.
+// CHECK-LABEL:   func.func @torch.aten.matmul$broadcast_chain(
+// CHECK:           %[[LHS0:.*]] = "tosa.reshape"(%{{.*}}) <{new_shape = array<i64: 4, 5, 6>}> : (tensor<1x4x5x6xf32>) -> tensor<4x5x6xf32>
+// CHECK:           %[[RHS0_PERMS:.*]] = "tosa.const"() <{value = dense<[1, 2, 0, 3]> : tensor<4xi32>}> : () -> tensor<4xi32>
+// CHECK:           %[[RHS0_T:.*]] = "tosa.transpose"(%{{.*}}, %[[RHS0_PERMS]]) : (tensor<3x4x6x7xf32>, tensor<4xi32>) -> tensor<4x6x3x7xf32>
+// CHECK:           %[[RHS0:.*]] = "tosa.reshape"(%[[RHS0_T]]) <{new_shape = array<i64: 4, 6, 21>}> : (tensor<4x6x3x7xf32>) -> tensor<4x6x21xf32>
+// CHECK:           %[[MM0:.*]] = "tosa.matmul"(%[[LHS0]], %[[RHS0]]) : (tensor<4x5x6xf32>, tensor<4x6x21xf32>) -> tensor<4x5x21xf32>
+// CHECK:           %[[OUT0:.*]] = "tosa.reshape"(%[[MM0]]) <{new_shape = array<i64: 4, 5, 3, 7>}> : (tensor<4x5x21xf32>) -> tensor<4x5x3x7xf32>
+// CHECK:           %[[OUT0_PERMS:.*]] = "tosa.const"() <{value = dense<[2, 0, 1, 3]> : tensor<4xi32>}> : () -> tensor<4xi32>
+// CHECK:           "tosa.transpose"(%[[OUT0]], %[[OUT0_PERMS]]) : (tensor<4x5x3x7xf32>, tensor<4xi32>) -> tensor<3x4x5x7xf32>
+// CHECK:           %[[LHS1:.*]] = "tosa.reshape"(%{{.*}}) <{new_shape = array<i64: 4, 2, 5>}> : (tensor<1x4x2x5xf32>) -> tensor<4x2x5xf32>
+// CHECK-NOT:       "tosa.transpose"
+// CHECK:           %[[RHS1:.*]] = "tosa.reshape"(%[[OUT0]]) <{new_shape = array<i64: 4, 5, 21>}> : (tensor<4x5x3x7xf32>) -> tensor<4x5x21xf32>
+// CHECK:           "tosa.matmul"(%[[LHS1]], %[[RHS1]]) : (tensor<4x2x5xf32>, tensor<4x5x21xf32>) -> tensor<4x2x21xf32>
+func.func @torch.aten.matmul$broadcast_chain(%arg0: !torch.vtensor<[1,4,5,6],f32>, %arg1: !torch.vtensor<[3,4,6,7],f32>, %arg2: !torch.vtensor<[1,4,2,5],f32>) -> !torch.vtensor<[3,4,2,7],f32> {
+  %0 = torch.aten.matmul %arg0, %arg1 : !torch.vtensor<[1,4,5,6],f32>, !torch.vtensor<[3,4,6,7],f32> -> !torch.vtensor<[3,4,5,7],f32>
+  %1 = torch.aten.matmul %arg2, %0 : !torch.vtensor<[1,4,2,5],f32>, !torch.vtensor<[3,4,5,7],f32> -> !torch.vtensor<[3,4,2,7],f32>
+  return %1 : !torch.vtensor<[3,4,2,7],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.mm$quantized(
+// CHECK-SAME:                                       %[[ARG0:.*]]: !torch.vtensor<[2,4],si8>, %[[ARG1:.*]]: !torch.vtensor<[4,3],si8>) -> !torch.vtensor<[2,3],!torch.qint8> {
+// CHECK-DAG:       %[[LHS_INT:.*]] = torch_c.to_builtin_tensor %[[ARG0]] : !torch.vtensor<[2,4],si8> -> tensor<2x4xi8>
+// CHECK-DAG:       %[[RHS_INT:.*]] = torch_c.to_builtin_tensor %[[ARG1]] : !torch.vtensor<[4,3],si8> -> tensor<4x3xi8>
+// CHECK:           %[[LHS:.*]] = "tosa.reshape"(%[[LHS_INT]]) <{new_shape = array<i64: 1, 2, 4>}> : (tensor<2x4xi8>) -> tensor<1x2x4xi8>
+// CHECK:           %[[RHS:.*]] = "tosa.reshape"(%[[RHS_INT]]) <{new_shape = array<i64: 1, 4, 3>}> : (tensor<4x3xi8>) -> tensor<1x4x3xi8>
+// CHECK:           %[[ACC:.*]] = "tosa.matmul"(%[[LHS]], %[[RHS]]) {{.*}}a_zp = 3{{.*}}b_zp = 0{{.*}} : (tensor<1x2x4xi8>, tensor<1x4x3xi8>) -> tensor<1x2x3xi32>
+// CHECK:           %[[RESCALED:.*]] = "tosa.rescale"(%[[ACC]]) {{.*}}output_zp = 3{{.*}} : (tensor<1x2x3xi32>) -> tensor<1x2x3xi8>
+// CHECK:           "tosa.reshape"(%[[RESCALED]]) <{new_shape = array<i64: 2, 3>}> : (tensor<1x2x3xi8>) -> tensor<2x3xi8>
+// CHECK-NOT:       torch.aten.dequantize.self
+// CHECK-NOT:       torch.aten.mm
+func.func @torch.aten.mm$quantized(%arg0: !torch.vtensor<[2,4],si8>, %arg1: !torch.vtensor<[4,3],si8>) -> !torch.vtensor<[2,3],!torch.qint8> {
+  %float5.000000e-01 = torch.constant.float 5.000000e-01
+  %float2.500000e-01 = torch.constant.float 2.500000e-01
+  %int0 = torch.constant.int 0
+  %int3 = torch.constant.int 3
+  %int12 = torch.constant.int 12
+  %0 = torch.per_tensor_affine.create %arg0, %float5.000000e-01, %int3 : !torch.vtensor<[2,4],si8>, !torch.float, !torch.int -> !torch.vtensor<[2,4],!torch.qint8>
+  %1 = torch.aten.dequantize.self %0 : !torch.vtensor<[2,4],!torch.qint8> -> !torch.vtensor<[2,4],f32>
+  %2 = torch.per_tensor_affine.create %arg1, %float2.500000e-01, %int0 : !torch.vtensor<[4,3],si8>, !torch.float, !torch.int -> !torch.vtensor<[4,3],!torch.qint8>
+  %3 = torch.aten.dequantize.self %2 : !torch.vtensor<[4,3],!torch.qint8> -> !torch.vtensor<[4,3],f32>
+  %4 = torch.aten.mm %1, %3 : !torch.vtensor<[2,4],f32>, !torch.vtensor<[4,3],f32> -> !torch.vtensor<[2,3],f32>
+  %5 = torch.aten.quantize_per_tensor %4, %float5.000000e-01, %int3, %int12 : !torch.vtensor<[2,3],f32>, !torch.float, !torch.int, !torch.int -> !torch.vtensor<[2,3],!torch.qint8>
+  return %5 : !torch.vtensor<[2,3],!torch.qint8>
+}
+
+// -----
+
+// The bias is quantized with the scale of the accumulator, 0.5 * 0.25.
+// CHECK-LABEL:   func.func @torch.aten.convolution$quantized(
+// CHECK:           %[[BIAS:.*]] = "tosa.const"() <{value = dense<[8, 16]> : tensor<2xi32>}> : () -> tensor<2xi32>
+// CHECK:           %[[INPUT:.*]] = "tosa.transpose"(%{{.*}}, %{{.*}}) : (tensor<1x1x4x4xi8>, tensor<4xi32>) -> tensor<1x4x4x1xi8>
+// CHECK:           %[[WEIGHT:.*]] = "tosa.transpose"(%{{.*}}, %{{.*}}) : (tensor<2x1x3x3xi8>, tensor<4xi32>) -> tensor<2x3x3x1xi8>
+// CHECK:           %[[ACC:.*]] = "tosa.conv2d"(%[[INPUT]], %[[WEIGHT]], %[[BIAS]]) {{.*}}input_zp = 1{{.*}}weight_zp = 0{{.*}} : (tensor<1x4x4x1xi8>, tensor<2x3x3x1xi8>, tensor<2xi32>) -> tensor<1x2x2x2xi32>
+// CHECK:           %[[RESCALED:.*]] = "tosa.rescale"(%[[ACC]]) {{.*}} : (tensor<1x2x2x2xi32>) -> tensor<1x2x2x2xi8>
+// CHECK:           "tosa.transpose"(%[[RESCALED]], %{{.*}}) : (tensor<1x2x2x2xi8>, tensor<4xi32>) -> tensor<1x2x2x2xi8>
+// CHECK-NOT:       torch.aten.dequantize.self
+// CHECK-NOT:       torch.aten.convolution
+func.func @torch.aten.convolution$quantized(%arg0: !torch.vtensor<[1,1,4,4],si8>, %arg1: !torch.vtensor<[2,1,3,3],si8>) -> !torch.vtensor<[1,2,2,2],!torch.qint8> {
+  %float5.000000e-01 = torch.constant.float 5.000000e-01
+  %float2.500000e-01 = torch.constant.float 2.500000e-01
+  %false = torch.constant.bool false
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int12 = torch.constant.int 12
+  %bias = torch.vtensor.literal(dense<[1.000000e+00, 2.000000e+00]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %0 = torch.per_tensor_affine.create %arg0, %float5.000000e-01, %int1 : !torch.vtensor<[1,1,4,4],si8>, !torch.float, !torch.int -> !torch.vtensor<[1,1,4,4],!torch.qint8>
+  %1 = torch.aten.dequantize.self %0 : !torch.vtensor<[1,1,4,4],!torch.qint8> -> !torch.vtensor<[1,1,4,4],f32>
+  %2 = torch.per_tensor_affine.create %arg1, %float2.500000e-01, %int0 : !torch.vtensor<[2,1,3,3],si8>, !torch.float, !torch.int -> !torch.vtensor<[2,1,3,3],!torch.qint8>
+  %3 = torch.aten.dequantize.self %2 : !torch.vtensor<[2,1,3,3],!torch.qint8> -> !torch.vtensor<[2,1,3,3],f32>
+  %stride = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %padding = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %output_padding = torch.prim.ListConstruct  : () -> !torch.list<int>
+  %4 = torch.aten.convolution %1, %3, %bias, %stride, %padding, %stride, %false, %output_padding, %int1 : !torch.vtensor<[1,1,4,4],f32>, !torch.vtensor<[2,1,3,3],f32>, !torch.vtensor<[2],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,2,2,2],f32>
+  %5 = torch.aten.quantize_per_tensor %4, %float5.000000e-01, %int1, %int12 : !torch.vtensor<[1,2,2,2],f32>, !torch.float, !torch.int, !torch.int -> !torch.vtensor<[1,2,2,2],!torch.qint8>
+  return %5 : !torch.vtensor<[1,2,2,2],!torch.qint8>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.convolution$literal_weight(
+// CHECK-NOT:       "tosa.transpose"(%{{.*}}) : (tensor<1x2x1x2xf32>
+// CHECK:           %[[WEIGHT:.*]] = "tosa.const"() <{value = dense<{{\[\[\[\[}}1.000000e+00, 3.000000e+00], [2.000000e+00, 4.000000e+00]]]]> : tensor<1x1x2x2xf32>}> : () -> tensor<1x1x2x2xf32>
+// CHECK:           "tosa.conv2d"(%{{.*}}, %[[WEIGHT]], %{{.*}})
+func.func @torch.aten.convolution$literal_weight(%arg0: !torch.vtensor<[1,2,4,4],f32>) -> !torch.vtensor<[1,1,4,3],f32> {
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %weight = torch.vtensor.literal(dense<[[[[1.000000e+00, 2.000000e+00]], [[3.000000e+00, 4.000000e+00]]]]> : tensor<1x2x1x2xf32>) : !torch.vtensor<[1,2,1,2],f32>
+  %stride = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %padding = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %output_padding = torch.prim.ListConstruct  : () -> !torch.list<int>
+  %0 = torch.aten.convolution %arg0, %weight, %none, %stride, %padding, %stride, %false, %output_padding, %int1 : !torch.vtensor<[1,2,4,4],f32>, !torch.vtensor<[1,2,1,2],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,1,4,3],f32>
+  return %0 : !torch.vtensor<[1,1,4,3],f32>
+}
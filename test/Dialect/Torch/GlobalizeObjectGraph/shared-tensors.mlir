@@ -0,0 +1,78 @@
+// RUN: torch-mlir-opt -torch-globalize-object-graph -split-input-file %s | FileCheck %s
+
+// A tensor held by several private slots that are never written gets a single
+// global slot.
+
+torch.class_type @__torch__.TestModule  {
+  torch.attr private "embedding" : !torch.tensor
+  torch.attr private "lm_head" : !torch.tensor
+  torch.method "forward", @__torch__.TestModule.forward
+}
+
+// CHECK-LABEL:   torch.global_slot.module_initializer {
+// CHECK:           %[[T:.*]] = torch.tensor.literal(dense<1.000000e+00> : tensor<1xf32>) : !torch.tensor
+// CHECK:           torch.initialize.global_slots [
+// CHECK-NEXT:        @embedding(%[[T]] : !torch.tensor)
+// CHECK-NEXT:      ]
+// CHECK:         }
+// CHECK:         torch.global_slot "private" @embedding : !torch.tensor
+// CHECK-NOT:     torch.global_slot
+
+// CHECK-LABEL:   func.func @forward() -> !torch.tensor {
+// CHECK:           %[[E:.*]] = torch.global_slot.get @embedding : !torch.tensor
+// CHECK:           %[[L:.*]] = torch.global_slot.get @embedding : !torch.tensor
+// CHECK:           torch.aten.mul.Tensor %[[E]], %[[L]]
+func.func private @__torch__.TestModule.forward(%arg0: !torch.nn.Module<"__torch__.TestModule">) -> !torch.tensor {
+  %0 = torch.prim.GetAttr %arg0["embedding"] : !torch.nn.Module<"__torch__.TestModule"> -> !torch.tensor
+  %1 = torch.prim.GetAttr %arg0["lm_head"] : !torch.nn.Module<"__torch__.TestModule"> -> !torch.tensor
+  %2 = torch.aten.mul.Tensor %0, %1 : !torch.tensor, !torch.tensor -> !torch.tensor
+  return %2 : !torch.tensor
+}
+
+%t = torch.tensor.literal(dense<1.0> : tensor<1xf32>) : !torch.tensor
+torch.nn_module  {
+  torch.slot "embedding", %t : !torch.tensor
+  torch.slot "lm_head", %t : !torch.tensor
+} : !torch.nn.Module<"__torch__.TestModule">
+
+// -----
+
+// Slots that are written, or public, keep their own global slots.
+
+torch.class_type @__torch__.TestModule  {
+  torch.attr private "a" : !torch.tensor
+  torch.attr private "b" : !torch.tensor
+  torch.attr "c" : !torch.tensor
+  torch.method "forward", @__torch__.TestModule.forward
+}
+
+// CHECK-LABEL:   torch.global_slot.module_initializer {
+// CHECK:           %[[T:.*]] = torch.tensor.literal
+// CHECK:           torch.initialize.global_slots [
+// CHECK-NEXT:        @a(%[[T]] : !torch.tensor)
+// CHECK-NEXT:        @b(%[[T]] : !torch.tensor)
+// CHECK-NEXT:        @c(%[[T]] : !torch.tensor)
+// CHECK-NEXT:      ]
+// CHECK:         }
+// CHECK:         torch.global_slot "private" @a : !torch.tensor
+// CHECK:         torch.global_slot "private" @b : !torch.tensor
+// CHECK:         torch.global_slot @c : !torch.tensor
+
+// CHECK-LABEL:   func.func @forward(
+// CHECK:           torch.global_slot.set @a = %{{.*}} : !torch.tensor
+// CHECK:           torch.global_slot.get @b : !torch.tensor
+// CHECK:           torch.global_slot.get @c : !torch.tensor
+func.func private @__torch__.TestModule.forward(%arg0: !torch.nn.Module<"__torch__.TestModule">, %arg1: !torch.tensor) -> !torch.tensor {
+  torch.prim.SetAttr %arg0["a"] = %arg1 : !torch.nn.Module<"__torch__.TestModule">, !torch.tensor
+  %0 = torch.prim.GetAttr %arg0["b"] : !torch.nn.Module<"__torch__.TestModule"> -> !torch.tensor
+  %1 = torch.prim.GetAttr %arg0["c"] : !torch.nn.Module<"__torch__.TestModule"> -> !torch.tensor
+  %2 = torch.aten.mul.Tensor %0, %1 : !torch.tensor, !torch.tensor -> !torch.tensor
+  return %2 : !torch.tensor
+}
+
+%t = torch.tensor.literal(dense<1.0> : tensor<1xf32>) : !torch.tensor
+torch.nn_module  {
+  torch.slot "a", %t : !torch.tensor
+  torch.slot "b", %t : !torch.tensor
+  torch.slot "c", %t : !torch.tensor
+} : !torch.nn.Module<"__torch__.TestModule">
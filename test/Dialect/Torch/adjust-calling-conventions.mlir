@@ -29,6 +29,14 @@ func.func @call(%arg0: !torch.tensor {torch.type_bound = !torch.vtensor<[2,3,?],
   return %arg0 : !torch.tensor
 }
 
+// The other argument attributes are kept, also when None arguments are
+// dropped.
+// CHECK-LABEL:   func.func @donated_arg(
+// CHECK-SAME:                      %[[ARG:.*]]: !torch.vtensor<[2],f32> {torch.donated}) -> !torch.tensor {
+func.func @donated_arg(%arg0: !torch.none, %arg1: !torch.tensor {torch.donated, torch.type_bound = !torch.vtensor<[2],f32>}) -> !torch.tensor {
+  return %arg1 : !torch.tensor
+}
+
 // CHECK-LABEL:   func.func @none_return() {
 // CHECK:           %[[NONE:.*]] = torch.constant.none
 // CHECK:           return
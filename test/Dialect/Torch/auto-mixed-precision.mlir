@@ -0,0 +1,68 @@
+// RUN: torch-mlir-opt -torch-auto-mixed-precision -split-input-file %s | FileCheck %s
+// RUN: torch-mlir-opt -torch-auto-mixed-precision="dtype=f16 ops=aten.bmm" -split-input-file %s | FileCheck %s --check-prefix=F16
+
+// CHECK-LABEL:   func.func @mm_chain(
+// CHECK-SAME:                        %[[A:.*]]: !torch.vtensor<[4,8],f32>, %[[B:.*]]: !torch.vtensor<[8,4],f32>,
+// CHECK-SAME:                        %[[C:.*]]: !torch.vtensor<[4,4],f32>) -> !torch.vtensor<[4,4],f32> {
+// CHECK:           %[[A16:.*]] = torch.aten.to.dtype %[[A]], %{{.*}}, %{{.*}}, %{{.*}}, %{{.*}} : !torch.vtensor<[4,8],f32>, !torch.int, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[4,8],bf16>
+// CHECK:           %[[B16:.*]] = torch.aten.to.dtype %[[B]], {{.*}} -> !torch.vtensor<[8,4],bf16>
+// CHECK:           %[[MM0:.*]] = torch.aten.mm %[[A16]], %[[B16]] : !torch.vtensor<[4,8],bf16>, !torch.vtensor<[8,4],bf16> -> !torch.vtensor<[4,4],bf16>
+// CHECK:           %[[C16:.*]] = torch.aten.to.dtype %[[C]], {{.*}} -> !torch.vtensor<[4,4],bf16>
+// CHECK:           %[[MM1:.*]] = torch.aten.mm %[[MM0]], %[[C16]] : !torch.vtensor<[4,4],bf16>, !torch.vtensor<[4,4],bf16> -> !torch.vtensor<[4,4],bf16>
+// CHECK:           %[[RESULT:.*]] = torch.aten.to.dtype %[[MM1]], {{.*}} -> !torch.vtensor<[4,4],f32>
+// CHECK:           return %[[RESULT]] : !torch.vtensor<[4,4],f32>
+// F16-LABEL:     func.func @mm_chain(
+// F16-NOT:         torch.aten.to.dtype
+func.func @mm_chain(%arg0: !torch.vtensor<[4,8],f32>, %arg1: !torch.vtensor<[8,4],f32>, %arg2: !torch.vtensor<[4,4],f32>) -> !torch.vtensor<[4,4],f32> {
+  %0 = torch.aten.mm %arg0, %arg1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,4],f32> -> !torch.vtensor<[4,4],f32>
+  %1 = torch.aten.mm %0, %arg2 : !torch.vtensor<[4,4],f32>, !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  return %1 : !torch.vtensor<[4,4],f32>
+}
+
+// -----
+
+// The reduction keeps computing in f32.
+// CHECK-LABEL:   func.func @mm_then_sum(
+// CHECK:           %[[MM:.*]] = torch.aten.mm {{.*}} -> !torch.vtensor<[4,4],bf16>
+// CHECK:           %[[MM32:.*]] = torch.aten.to.dtype %[[MM]], {{.*}} -> !torch.vtensor<[4,4],f32>
+// CHECK:           %[[SUM:.*]] = torch.aten.sum %[[MM32]], %{{.*}} : !torch.vtensor<[4,4],f32>, !torch.none -> !torch.vtensor<[],f32>
+// CHECK:           return %[[SUM]]
+func.func @mm_then_sum(%arg0: !torch.vtensor<[4,8],f32>, %arg1: !torch.vtensor<[8,4],f32>) -> !torch.vtensor<[],f32> {
+  %none = torch.constant.none
+  %0 = torch.aten.mm %arg0, %arg1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,4],f32> -> !torch.vtensor<[4,4],f32>
+  %1 = torch.aten.sum %0, %none : !torch.vtensor<[4,4],f32>, !torch.none -> !torch.vtensor<[],f32>
+  return %1 : !torch.vtensor<[],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @bmm$f16(
+// CHECK:           torch.aten.bmm {{.*}} -> !torch.vtensor<[2,4,4],bf16>
+// F16-LABEL:     func.func @bmm$f16(
+// F16:             %[[BMM:.*]] = torch.aten.bmm {{.*}} : !torch.vtensor<[2,4,8],f16>, !torch.vtensor<[2,8,4],f16> -> !torch.vtensor<[2,4,4],f16>
+// F16:             torch.aten.to.dtype %[[BMM]], {{.*}} -> !torch.vtensor<[2,4,4],f32>
+func.func @bmm$f16(%arg0: !torch.vtensor<[2,4,8],f32>, %arg1: !torch.vtensor<[2,8,4],f32>) -> !torch.vtensor<[2,4,4],f32> {
+  %0 = torch.aten.bmm %arg0, %arg1 : !torch.vtensor<[2,4,8],f32>, !torch.vtensor<[2,8,4],f32> -> !torch.vtensor<[2,4,4],f32>
+  return %0 : !torch.vtensor<[2,4,4],f32>
+}
+
+// -----
+
+// A round trip through a wider dtype is folded, but not one through a narrower
+// dtype.
+// CHECK-LABEL:   func.func @to_dtype_round_trip(
+// CHECK-SAME:                                   %[[ARG0:.*]]: !torch.vtensor<[4],bf16>, %[[ARG1:.*]]: !torch.vtensor<[4],f32>) -> (!torch.vtensor<[4],bf16>, !torch.vtensor<[4],f32>) {
+// CHECK:           %[[NARROW:.*]] = torch.aten.to.dtype %[[ARG1]], {{.*}} -> !torch.vtensor<[4],bf16>
+// CHECK:           %[[WIDE:.*]] = torch.aten.to.dtype %[[NARROW]], {{.*}} -> !torch.vtensor<[4],f32>
+// CHECK:           return %[[ARG0]], %[[WIDE]]
+func.func @to_dtype_round_trip(%arg0: !torch.vtensor<[4],bf16>, %arg1: !torch.vtensor<[4],f32>) -> (!torch.vtensor<[4],bf16>, !torch.vtensor<[4],f32>) {
+  %int6 = torch.constant.int 6
+  %int15 = torch.constant.int 15
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %0 = torch.aten.to.dtype %arg0, %int6, %false, %false, %none : !torch.vtensor<[4],bf16>, !torch.int, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[4],f32>
+  %1 = torch.aten.to.dtype %0, %int15, %false, %false, %none : !torch.vtensor<[4],f32>, !torch.int, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[4],bf16>
+  %2 = torch.aten.to.dtype %arg1, %int15, %false, %false, %none : !torch.vtensor<[4],f32>, !torch.int, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[4],bf16>
+  %3 = torch.aten.to.dtype %2, %int6, %false, %false, %none : !torch.vtensor<[4],bf16>, !torch.int, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[4],f32>
+  return %1, %3 : !torch.vtensor<[4],bf16>, !torch.vtensor<[4],f32>
+}
@@ -1,4 +1,5 @@
 // RUN: torch-mlir-opt %s -canonicalize | FileCheck %s
+// RUN: torch-mlir-opt %s -torch-canonicalize | FileCheck %s
 
 // CHECK-LABEL:   func.func @torch.aten.__range_length$fold() -> (!torch.int, !torch.int, !torch.int, !torch.int) {
 // CHECK:           %[[INT1:.*]] = torch.constant.int 1
@@ -1359,6 +1360,34 @@ func.func @torch.aten.squeeze.dim$zero_rank(%arg0: !torch.tensor<[],f32>) -> !to
   return %0 : !torch.tensor<[],f32>
 }
 
+// CHECK-LABEL:   func.func @torch.aten.dropout$eval(
+// CHECK-SAME:            %[[ARG:.*]]: !torch.vtensor<[?,?],f32>) -> !torch.vtensor<[?,?],f32> {
+// CHECK-NEXT:      return %[[ARG]] : !torch.vtensor<[?,?],f32>
+func.func @torch.aten.dropout$eval(%arg0: !torch.vtensor<[?,?],f32>) -> !torch.vtensor<[?,?],f32> {
+  %float1.000000e-01 = torch.constant.float 1.000000e-01
+  %false = torch.constant.bool false
+  %0 = torch.aten.dropout %arg0, %float1.000000e-01, %false : !torch.vtensor<[?,?],f32>, !torch.float, !torch.bool -> !torch.vtensor<[?,?],f32>
+  return %0 : !torch.vtensor<[?,?],f32>
+}
+
+// CHECK-LABEL:   func.func @torch.aten.dropout$zero_p(
+// CHECK-SAME:            %[[ARG:.*]]: !torch.vtensor<[?,?],f32>, %{{.*}}: !torch.bool) -> !torch.vtensor<[?,?],f32> {
+// CHECK-NEXT:      return %[[ARG]] : !torch.vtensor<[?,?],f32>
+func.func @torch.aten.dropout$zero_p(%arg0: !torch.vtensor<[?,?],f32>, %arg1: !torch.bool) -> !torch.vtensor<[?,?],f32> {
+  %float0.000000e00 = torch.constant.float 0.000000e+00
+  %0 = torch.aten.dropout %arg0, %float0.000000e00, %arg1 : !torch.vtensor<[?,?],f32>, !torch.float, !torch.bool -> !torch.vtensor<[?,?],f32>
+  return %0 : !torch.vtensor<[?,?],f32>
+}
+
+// CHECK-LABEL:   func.func @torch.aten.dropout$train(
+// CHECK:           torch.aten.dropout
+func.func @torch.aten.dropout$train(%arg0: !torch.vtensor<[?,?],f32>) -> !torch.vtensor<[?,?],f32> {
+  %float1.000000e-01 = torch.constant.float 1.000000e-01
+  %true = torch.constant.bool true
+  %0 = torch.aten.dropout %arg0, %float1.000000e-01, %true : !torch.vtensor<[?,?],f32>, !torch.float, !torch.bool -> !torch.vtensor<[?,?],f32>
+  return %0 : !torch.vtensor<[?,?],f32>
+}
+
 // CHECK-LABEL:   func.func @torch.aten.type_as$same(
 // CHECK-SAME:            %[[ARG:.*]]: !torch.tensor<[?,?],f32>) -> !torch.tensor<[?,?],f32> {
 // CHECK-NEXT:      return %[[ARG]] : !torch.tensor<[?,?],f32>
@@ -1969,3 +1998,32 @@ func.func @torch.prims.view_of$fold(%arg0: !torch.vtensor<[3,4,2],f32>) -> !torc
   %0 = torch.prims.view_of %arg0 : !torch.vtensor<[3,4,2],f32> -> !torch.vtensor<[3,4,2],f32>
   return %0 : !torch.vtensor<[3,4,2],f32>
 }
+
+// CHECK-LABEL:   func.func @torch.c10d_functional.wait_tensor$fold(
+// CHECK-SAME:            %[[ARG:.*]]: !torch.vtensor<[3,4],f32>) -> !torch.vtensor<[3,4],f32> {
+// CHECK-NEXT:      return %[[ARG]] : !torch.vtensor<[3,4],f32>
+func.func @torch.c10d_functional.wait_tensor$fold(%arg0: !torch.vtensor<[3,4],f32>) -> !torch.vtensor<[3,4],f32> {
+  %0 = torch.c10d_functional.wait_tensor %arg0 : !torch.vtensor<[3,4],f32> -> !torch.vtensor<[3,4],f32>
+  return %0 : !torch.vtensor<[3,4],f32>
+}
+
+torch.global_slot "private" @slot : !torch.vtensor<[2],f32>
+
+// CHECK-LABEL:   func.func @torch.global_slot.set$canonicalize_write_back(
+// CHECK-NEXT:      %[[VALUE:.*]] = torch.global_slot.get @slot : !torch.vtensor<[2],f32>
+// CHECK-NEXT:      return %[[VALUE]] : !torch.vtensor<[2],f32>
+func.func @torch.global_slot.set$canonicalize_write_back() -> !torch.vtensor<[2],f32> {
+  %0 = torch.global_slot.get @slot : !torch.vtensor<[2],f32>
+  torch.global_slot.set @slot = %0 : !torch.vtensor<[2],f32>
+  return %0 : !torch.vtensor<[2],f32>
+}
+
+// CHECK-LABEL:   func.func @torch.global_slot.set$no_canonicalize_after_set(
+// CHECK:           torch.global_slot.set @slot = %[[ARG:.*]] : !torch.vtensor<[2],f32>
+// CHECK:           torch.global_slot.set @slot = %[[VALUE:.*]] : !torch.vtensor<[2],f32>
+func.func @torch.global_slot.set$no_canonicalize_after_set(%arg0: !torch.vtensor<[2],f32>) {
+  %0 = torch.global_slot.get @slot : !torch.vtensor<[2],f32>
+  torch.global_slot.set @slot = %arg0 : !torch.vtensor<[2],f32>
+  torch.global_slot.set @slot = %0 : !torch.vtensor<[2],f32>
+  return
+}
@@ -0,0 +1,47 @@
+// RUN: torch-mlir-opt -torch-compress-sparse-linear-weights -split-input-file %s | FileCheck %s
+
+// CHECK-LABEL:   func.func @linear(
+// CHECK-SAME:                      %[[INPUT:.*]]: !torch.vtensor<[2,8],f32>) -> !torch.vtensor<[2,1],f32> {
+// CHECK:           %[[NONE:.*]] = torch.constant.none
+// CHECK:           %[[VALUES:.*]] = torch.vtensor.literal(dense<{{\[\[}}1.000000e+00, 2.000000e+00, 3.000000e+00, 0.000000e+00]]> : tensor<1x4xf32>) : !torch.vtensor<[1,4],f32>
+// CHECK:           %[[INDICES:.*]] = torch.vtensor.literal(dense<{{\[\[}}1, 3, 0, 1]]> : tensor<1x4xsi8>) : !torch.vtensor<[1,4],si8>
+// CHECK-NOT:       torch.vtensor.literal
+// CHECK:           %[[RESULT:.*]] = torch.semi_structured_sparse.linear %[[INPUT]], %[[VALUES]], %[[INDICES]], %[[NONE]] : !torch.vtensor<[2,8],f32>, !torch.vtensor<[1,4],f32>, !torch.vtensor<[1,4],si8>, !torch.none -> !torch.vtensor<[2,1],f32>
+// CHECK:           return %[[RESULT]] : !torch.vtensor<[2,1],f32>
+func.func @linear(%arg0: !torch.vtensor<[2,8],f32>) -> !torch.vtensor<[2,1],f32> {
+  %none = torch.constant.none
+  %0 = torch.vtensor.literal(dense<[[0.0, 1.0, 0.0, 2.0, 3.0, 0.0, 0.0, 0.0]]> : tensor<1x8xf32>) : !torch.vtensor<[1,8],f32>
+  %1 = torch.aten.linear %arg0, %0, %none : !torch.vtensor<[2,8],f32>, !torch.vtensor<[1,8],f32>, !torch.none -> !torch.vtensor<[2,1],f32>
+  return %1 : !torch.vtensor<[2,1],f32>
+}
+
+// -----
+
+// A weight shared by several linear ops is compressed once. The bias is kept.
+// CHECK-LABEL:   func.func @shared_weight(
+// CHECK-SAME:                             %[[INPUT:.*]]: !torch.vtensor<[2,4],f16>,
+// CHECK-SAME:                             %[[BIAS:.*]]: !torch.vtensor<[2],f16>) -> (!torch.vtensor<[2,2],f16>, !torch.vtensor<[2,2],f16>) {
+// CHECK:           %[[VALUES:.*]] = torch.vtensor.literal({{.*}} : tensor<2x2xf16>) : !torch.vtensor<[2,2],f16>
+// CHECK:           %[[INDICES:.*]] = torch.vtensor.literal(dense<{{\[\[}}0, 1], [2, 3]]> : tensor<2x2xsi8>) : !torch.vtensor<[2,2],si8>
+// CHECK:           torch.semi_structured_sparse.linear %[[INPUT]], %[[VALUES]], %[[INDICES]], %[[BIAS]]
+// CHECK:           torch.semi_structured_sparse.linear %[[INPUT]], %[[VALUES]], %[[INDICES]]
+func.func @shared_weight(%arg0: !torch.vtensor<[2,4],f16>, %arg1: !torch.vtensor<[2],f16>) -> (!torch.vtensor<[2,2],f16>, !torch.vtensor<[2,2],f16>) {
+  %none = torch.constant.none
+  %0 = torch.vtensor.literal(dense<[[1.0, -1.0, 0.0, 0.0], [0.0, 0.0, 2.0, 1.0]]> : tensor<2x4xf16>) : !torch.vtensor<[2,4],f16>
+  %1 = torch.aten.linear %arg0, %0, %arg1 : !torch.vtensor<[2,4],f16>, !torch.vtensor<[2,4],f16>, !torch.vtensor<[2],f16> -> !torch.vtensor<[2,2],f16>
+  %2 = torch.aten.linear %arg0, %0, %none : !torch.vtensor<[2,4],f16>, !torch.vtensor<[2,4],f16>, !torch.none -> !torch.vtensor<[2,2],f16>
+  return %1, %2 : !torch.vtensor<[2,2],f16>, !torch.vtensor<[2,2],f16>
+}
+
+// -----
+
+// Weights with more than 2 nonzeros in a group of 4 are left as is.
+// CHECK-LABEL:   func.func @dense_weight(
+// CHECK:           torch.vtensor.literal(dense<{{\[\[}}1.000000e+00, 2.000000e+00, 3.000000e+00, 0.000000e+00]]> : tensor<1x4xf32>)
+// CHECK:           torch.aten.linear
+func.func @dense_weight(%arg0: !torch.vtensor<[2,4],f32>) -> !torch.vtensor<[2,1],f32> {
+  %none = torch.constant.none
+  %0 = torch.vtensor.literal(dense<[[1.0, 2.0, 3.0, 0.0]]> : tensor<1x4xf32>) : !torch.vtensor<[1,4],f32>
+  %1 = torch.aten.linear %arg0, %0, %none : !torch.vtensor<[2,4],f32>, !torch.vtensor<[1,4],f32>, !torch.none -> !torch.vtensor<[2,1],f32>
+  return %1 : !torch.vtensor<[2,1],f32>
+}
@@ -0,0 +1,62 @@
+// RUN: torch-mlir-opt -torch-decompose-complex-ops -split-input-file %s | FileCheck %s
+// RUN: torch-mlir-opt -torch-decompose-complex-ops="op-efficiencies=aten.convolution=0.1" -split-input-file %s | FileCheck %s --check-prefix=SLOW-CONV
+// RUN: not torch-mlir-opt -torch-decompose-complex-ops="op-efficiencies=aten.convolution" %s 2>&1 | FileCheck %s --check-prefix=INVALID
+
+// INVALID: expected a positive flops-per-byte and op-efficiencies of the form 'aten.foo=0.5'
+
+// A pointwise convolution is as cheap as a matmul by default, and stays a
+// convolution.
+// CHECK-LABEL:   func.func @conv2d_pointwise(
+// CHECK:           torch.aten.convolution
+// CHECK-NOT:       torch.aten.matmul
+// SLOW-CONV-LABEL: func.func @conv2d_pointwise(
+// SLOW-CONV-SAME:      %[[INPUT:.*]]: !torch.vtensor<[1,64,8,8],f32>, %[[WEIGHT:.*]]: !torch.vtensor<[32,64,1,1],f32>)
+// SLOW-CONV:         %[[FLAT_INPUT:.*]] = torch.aten.view %[[INPUT]], %{{.*}} : !torch.vtensor<[1,64,8,8],f32>, !torch.list<int> -> !torch.vtensor<[1,64,64],f32>
+// SLOW-CONV:         %[[FLAT_WEIGHT:.*]] = torch.aten.view %[[WEIGHT]], %{{.*}} : !torch.vtensor<[32,64,1,1],f32>, !torch.list<int> -> !torch.vtensor<[32,64],f32>
+// SLOW-CONV:         %[[MATMUL:.*]] = torch.aten.matmul %[[FLAT_WEIGHT]], %[[FLAT_INPUT]] : !torch.vtensor<[32,64],f32>, !torch.vtensor<[1,64,64],f32> -> !torch.vtensor<[1,32,64],f32>
+// SLOW-CONV:         %[[RESULT:.*]] = torch.aten.view %[[MATMUL]], %{{.*}} : !torch.vtensor<[1,32,64],f32>, !torch.list<int> -> !torch.vtensor<[1,32,8,8],f32>
+// SLOW-CONV-NOT:     torch.aten.convolution
+// SLOW-CONV:         return %[[RESULT]]
+func.func @conv2d_pointwise(%input: !torch.vtensor<[1,64,8,8],f32>, %weight: !torch.vtensor<[32,64,1,1],f32>) -> !torch.vtensor<[1,32,8,8],f32> {
+  %none = torch.constant.none
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %stride = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %padding = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %dilation = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.conv2d %input, %weight, %none, %stride, %padding, %dilation, %int1 : !torch.vtensor<[1,64,8,8],f32>, !torch.vtensor<[32,64,1,1],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int -> !torch.vtensor<[1,32,8,8],f32>
+  return %0 : !torch.vtensor<[1,32,8,8],f32>
+}
+
+// -----
+
+// Only pointwise convolutions have a matmul decomposition.
+// CHECK-LABEL:   func.func @conv2d_3x3(
+// CHECK:           torch.aten.convolution
+// SLOW-CONV-LABEL: func.func @conv2d_3x3(
+// SLOW-CONV:         torch.aten.convolution
+// SLOW-CONV-NOT:     torch.aten.matmul
+func.func @conv2d_3x3(%input: !torch.vtensor<[1,64,8,8],f32>, %weight: !torch.vtensor<[32,64,3,3],f32>) -> !torch.vtensor<[1,32,6,6],f32> {
+  %none = torch.constant.none
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %stride = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %padding = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %dilation = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.conv2d %input, %weight, %none, %stride, %padding, %dilation, %int1 : !torch.vtensor<[1,64,8,8],f32>, !torch.vtensor<[32,64,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int -> !torch.vtensor<[1,32,6,6],f32>
+  return %0 : !torch.vtensor<[1,32,6,6],f32>
+}
+
+// -----
+
+// A global pooling moves as many bytes as the mean over the spatial dims, and
+// stays a pooling.
+// CHECK-LABEL:   func.func @adaptive_avg_pool2d_global(
+// CHECK:           torch.aten.avg_pool2d
+// CHECK-NOT:       torch.aten.mean.dim
+func.func @adaptive_avg_pool2d_global(%input: !torch.vtensor<[1,64,8,8],f32>) -> !torch.vtensor<[1,64,1,1],f32> {
+  %int1 = torch.constant.int 1
+  %output_size = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.adaptive_avg_pool2d %input, %output_size : !torch.vtensor<[1,64,8,8],f32>, !torch.list<int> -> !torch.vtensor<[1,64,1,1],f32>
+  return %0 : !torch.vtensor<[1,64,1,1],f32>
+}
@@ -79,3 +79,150 @@ func.func @torch.aten.adaptive_avg_pool2d$unit_output_size(%arg0: !torch.vtensor
   %0 = torch.aten.adaptive_avg_pool2d %arg0, %output_size : !torch.vtensor<[?,?,?,?],f32>, !torch.list<int> -> !torch.vtensor<[?,?,?,?],f32>
   return %0 : !torch.vtensor<[?,?,?,?],f32>
 }
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.dropout$train(
+// CHECK-SAME:        %[[INPUT:.*]]: !torch.vtensor<[?,?],f32>, %[[P:.*]]: !torch.float) -> !torch.vtensor<[?,?],f32> {
+// CHECK-DAG:       %[[ONE:.*]] = torch.constant.float 1.000000e+00
+// CHECK:           %[[KEEP_PROB:.*]] = torch.aten.sub.float %[[ONE]], %[[P]] : !torch.float, !torch.float -> !torch.float
+// CHECK:           %[[RAND:.*]] = torch.aten.uniform {{.*}} -> !torch.vtensor<[?,?],f32>
+// CHECK:           %[[KEEP:.*]] = torch.aten.lt.Scalar %[[RAND]], %[[KEEP_PROB]] : !torch.vtensor<[?,?],f32>, !torch.float -> !torch.vtensor<[?,?],i1>
+// CHECK:           %[[SCALED:.*]] = torch.aten.div.Scalar %[[INPUT]], %[[KEEP_PROB]] : !torch.vtensor<[?,?],f32>, !torch.float -> !torch.vtensor<[?,?],f32>
+// CHECK:           %[[RESULT:.*]] = torch.aten.where.self %[[KEEP]], %[[SCALED]], %{{.*}} : !torch.vtensor<[?,?],i1>, !torch.vtensor<[?,?],f32>, !torch.vtensor<[],f32> -> !torch.vtensor<[?,?],f32>
+// CHECK:           return %[[RESULT]] : !torch.vtensor<[?,?],f32>
+func.func @torch.aten.dropout$train(%arg0: !torch.vtensor<[?,?],f32>, %arg1: !torch.float) -> !torch.vtensor<[?,?],f32> {
+  %true = torch.constant.bool true
+  %0 = torch.aten.dropout %arg0, %arg1, %true : !torch.vtensor<[?,?],f32>, !torch.float, !torch.bool -> !torch.vtensor<[?,?],f32>
+  return %0 : !torch.vtensor<[?,?],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @scaled_dot_product_attention(
+// CHECK-SAME:      %[[Q:.*]]: !torch.vtensor<[2,16,8],f32>, %[[K:.*]]: !torch.vtensor<[2,12,8],f32>, %[[V:.*]]: !torch.vtensor<[2,12,4],f32>)
+// CHECK:         %[[KT:.*]] = torch.aten.transpose.int %[[K]], %{{.*}}, %{{.*}} : !torch.vtensor<[2,12,8],f32>, !torch.int, !torch.int -> !torch.vtensor<[2,8,12],f32>
+// CHECK:         %[[QK:.*]] = torch.aten.matmul %[[Q]], %[[KT]] : !torch.vtensor<[2,16,8],f32>, !torch.vtensor<[2,8,12],f32> -> !torch.vtensor<[2,16,12],f32>
+// CHECK:         torch.aten.mul.Scalar %[[QK]], %{{.*}} : !torch.vtensor<[2,16,12],f32>, !torch.float -> !torch.vtensor<[2,16,12],f32>
+// CHECK:         %[[OUT:.*]] = torch.aten.matmul %{{.*}}, %[[V]] : !torch.vtensor<[2,16,12],f32>, !torch.vtensor<[2,12,4],f32> -> !torch.vtensor<[2,16,4],f32>
+// CHECK:         return %[[OUT]]
+func.func @scaled_dot_product_attention(%q: !torch.vtensor<[2,16,8],f32>, %k: !torch.vtensor<[2,12,8],f32>, %v: !torch.vtensor<[2,12,4],f32>) -> !torch.vtensor<[2,16,4],f32> {
+  %none = torch.constant.none
+  %dropout = torch.constant.float 0.000000e+00
+  %false = torch.constant.bool false
+  %0 = torch.aten.scaled_dot_product_attention %q, %k, %v, %none, %dropout, %false, %none : !torch.vtensor<[2,16,8],f32>, !torch.vtensor<[2,12,8],f32>, !torch.vtensor<[2,12,4],f32>, !torch.none, !torch.float, !torch.bool, !torch.none -> !torch.vtensor<[2,16,4],f32>
+  return %0 : !torch.vtensor<[2,16,4],f32>
+}
+
+// -----
+
+// The ops that a decomposition creates are decomposed too, even when none of
+// them was in the function to begin with.
+// CHECK-LABEL:   func.func @torch.aten.var_mean$decomposes_created_ops(
+// CHECK-NOT:       torch.aten.var_mean
+// CHECK-NOT:       torch.aten.var.dim
+// CHECK-NOT:       torch.aten.mean
+// CHECK:           torch.aten.sum
+// CHECK-NOT:       torch.aten.mean
+// CHECK:           return
+func.func @torch.aten.var_mean$decomposes_created_ops(%arg0: !torch.vtensor<[3,4],f32>) -> (!torch.vtensor<[],f32>, !torch.vtensor<[],f32>) {
+  %true = torch.constant.bool true
+  %0:2 = torch.aten.var_mean %arg0, %true : !torch.vtensor<[3,4],f32>, !torch.bool -> !torch.vtensor<[],f32>, !torch.vtensor<[],f32>
+  return %0#0, %0#1 : !torch.vtensor<[],f32>, !torch.vtensor<[],f32>
+}
+
+// -----
+// CHECK-LABEL:   func.func @torch.aten.einsum$matmul(
+// CHECK-SAME:                  %[[LHS:.*]]: !torch.vtensor<[2,3],f32>, %[[RHS:.*]]: !torch.vtensor<[3,4],f32>) -> !torch.vtensor<[2,4],f32> {
+// CHECK:           %[[MM:.*]] = torch.aten.mm %[[LHS]], %[[RHS]] : !torch.vtensor<[2,3],f32>, !torch.vtensor<[3,4],f32> -> !torch.vtensor<[2,4],f32>
+// CHECK:           return %[[MM]] : !torch.vtensor<[2,4],f32>
+func.func @torch.aten.einsum$matmul(%arg0: !torch.vtensor<[2,3],f32>, %arg1: !torch.vtensor<[3,4],f32>) -> !torch.vtensor<[2,4],f32> {
+  %str = torch.constant.str "ij,jk->ik"
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %arg0, %arg1 : (!torch.vtensor<[2,3],f32>, !torch.vtensor<[3,4],f32>) -> !torch.list<vtensor>
+  %1 = torch.aten.einsum %str, %0, %none : !torch.str, !torch.list<vtensor>, !torch.none -> !torch.vtensor<[2,4],f32>
+  return %1 : !torch.vtensor<[2,4],f32>
+}
+
+// -----
+// CHECK-LABEL:   func.func @torch.aten.einsum$batched(
+// CHECK-SAME:                  %[[LHS:.*]]: !torch.vtensor<[2,3,4],f32>, %[[RHS:.*]]: !torch.vtensor<[2,5,4],f32>) -> !torch.vtensor<[2,3,5],f32> {
+// CHECK-DAG:       %[[INT0:.*]] = torch.constant.int 0
+// CHECK-DAG:       %[[INT1:.*]] = torch.constant.int 1
+// CHECK-DAG:       %[[INT2:.*]] = torch.constant.int 2
+// CHECK:           %[[DIMS:.*]] = torch.prim.ListConstruct %[[INT0]], %[[INT2]], %[[INT1]] : (!torch.int, !torch.int, !torch.int) -> !torch.list<int>
+// CHECK:           %[[RHS_T:.*]] = torch.aten.permute %[[RHS]], %[[DIMS]] : !torch.vtensor<[2,5,4],f32>, !torch.list<int> -> !torch.vtensor<[2,4,5],f32>
+// CHECK:           %[[BMM:.*]] = torch.aten.bmm %[[LHS]], %[[RHS_T]] : !torch.vtensor<[2,3,4],f32>, !torch.vtensor<[2,4,5],f32> -> !torch.vtensor<[2,3,5],f32>
+// CHECK:           return %[[BMM]] : !torch.vtensor<[2,3,5],f32>
+func.func @torch.aten.einsum$batched(%arg0: !torch.vtensor<[2,3,4],f32>, %arg1: !torch.vtensor<[2,5,4],f32>) -> !torch.vtensor<[2,3,5],f32> {
+  %str = torch.constant.str "bij,bkj->bik"
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %arg0, %arg1 : (!torch.vtensor<[2,3,4],f32>, !torch.vtensor<[2,5,4],f32>) -> !torch.list<vtensor>
+  %1 = torch.aten.einsum %str, %0, %none : !torch.str, !torch.list<vtensor>, !torch.none -> !torch.vtensor<[2,3,5],f32>
+  return %1 : !torch.vtensor<[2,3,5],f32>
+}
+
+// -----
+// The last two operands are contracted first, which takes the fewest
+// multiply-adds.
+// CHECK-LABEL:   func.func @torch.aten.einsum$contraction_order(
+// CHECK-SAME:                  %[[A:.*]]: !torch.vtensor<[64,16],f32>, %[[B:.*]]: !torch.vtensor<[16,32],f32>, %[[C:.*]]: !torch.vtensor<[32,2],f32>) -> !torch.vtensor<[64,2],f32> {
+// CHECK:           %[[BC:.*]] = torch.aten.mm %[[B]], %[[C]] : !torch.vtensor<[16,32],f32>, !torch.vtensor<[32,2],f32> -> !torch.vtensor<[16,2],f32>
+// CHECK:           %[[ABC:.*]] = torch.aten.mm %[[A]], %[[BC]] : !torch.vtensor<[64,16],f32>, !torch.vtensor<[16,2],f32> -> !torch.vtensor<[64,2],f32>
+// CHECK:           return %[[ABC]] : !torch.vtensor<[64,2],f32>
+func.func @torch.aten.einsum$contraction_order(%arg0: !torch.vtensor<[64,16],f32>, %arg1: !torch.vtensor<[16,32],f32>, %arg2: !torch.vtensor<[32,2],f32>) -> !torch.vtensor<[64,2],f32> {
+  %str = torch.constant.str "ij,jk,kl->il"
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %arg0, %arg1, %arg2 : (!torch.vtensor<[64,16],f32>, !torch.vtensor<[16,32],f32>, !torch.vtensor<[32,2],f32>) -> !torch.list<vtensor>
+  %1 = torch.aten.einsum %str, %0, %none : !torch.str, !torch.list<vtensor>, !torch.none -> !torch.vtensor<[64,2],f32>
+  return %1 : !torch.vtensor<[64,2],f32>
+}
+
+// -----
+// The vector is viewed as a matrix of one column, which is dropped from the
+// result.
+// CHECK-LABEL:   func.func @torch.aten.einsum$matvec(
+// CHECK-SAME:                  %[[LHS:.*]]: !torch.vtensor<[2,3],f32>, %[[RHS:.*]]: !torch.vtensor<[3],f32>) -> !torch.vtensor<[2],f32> {
+// CHECK:           %[[RHS_M:.*]] = torch.aten.view %[[RHS]], %{{.*}} : !torch.vtensor<[3],f32>, !torch.list<int> -> !torch.vtensor<[3,1],f32>
+// CHECK:           %[[MM:.*]] = torch.aten.mm %[[LHS]], %[[RHS_M]] : !torch.vtensor<[2,3],f32>, !torch.vtensor<[3,1],f32> -> !torch.vtensor<[2,1],f32>
+// CHECK:           %[[RESULT:.*]] = torch.aten.view %[[MM]], %{{.*}} : !torch.vtensor<[2,1],f32>, !torch.list<int> -> !torch.vtensor<[2],f32>
+// CHECK:           return %[[RESULT]] : !torch.vtensor<[2],f32>
+func.func @torch.aten.einsum$matvec(%arg0: !torch.vtensor<[2,3],f32>, %arg1: !torch.vtensor<[3],f32>) -> !torch.vtensor<[2],f32> {
+  %str = torch.constant.str "ij,j->i"
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %arg0, %arg1 : (!torch.vtensor<[2,3],f32>, !torch.vtensor<[3],f32>) -> !torch.list<vtensor>
+  %1 = torch.aten.einsum %str, %0, %none : !torch.str, !torch.list<vtensor>, !torch.none -> !torch.vtensor<[2],f32>
+  return %1 : !torch.vtensor<[2],f32>
+}
+
+// -----
+// CHECK-LABEL:   func.func @torch.aten.einsum$batched_dot(
+// CHECK-SAME:                  %[[LHS:.*]]: !torch.vtensor<[2,3],f32>, %[[RHS:.*]]: !torch.vtensor<[2,3],f32>) -> !torch.vtensor<[2],f32> {
+// CHECK:           %[[LHS_M:.*]] = torch.aten.view %[[LHS]], %{{.*}} : !torch.vtensor<[2,3],f32>, !torch.list<int> -> !torch.vtensor<[2,1,3],f32>
+// CHECK:           %[[RHS_M:.*]] = torch.aten.view %[[RHS]], %{{.*}} : !torch.vtensor<[2,3],f32>, !torch.list<int> -> !torch.vtensor<[2,3,1],f32>
+// CHECK:           %[[BMM:.*]] = torch.aten.bmm %[[LHS_M]], %[[RHS_M]] : !torch.vtensor<[2,1,3],f32>, !torch.vtensor<[2,3,1],f32> -> !torch.vtensor<[2,1,1],f32>
+// CHECK:           %[[RESULT:.*]] = torch.aten.view %[[BMM]], %{{.*}} : !torch.vtensor<[2,1,1],f32>, !torch.list<int> -> !torch.vtensor<[2],f32>
+// CHECK:           return %[[RESULT]] : !torch.vtensor<[2],f32>
+func.func @torch.aten.einsum$batched_dot(%arg0: !torch.vtensor<[2,3],f32>, %arg1: !torch.vtensor<[2,3],f32>) -> !torch.vtensor<[2],f32> {
+  %str = torch.constant.str "bi,bi->b"
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %arg0, %arg1 : (!torch.vtensor<[2,3],f32>, !torch.vtensor<[2,3],f32>) -> !torch.list<vtensor>
+  %1 = torch.aten.einsum %str, %0, %none : !torch.str, !torch.list<vtensor>, !torch.none -> !torch.vtensor<[2],f32>
+  return %1 : !torch.vtensor<[2],f32>
+}
+
+// -----
+// CHECK-LABEL:   func.func @torch.aten.einsum$full_contraction(
+// CHECK-SAME:                  %[[LHS:.*]]: !torch.vtensor<[3],f32>, %[[RHS:.*]]: !torch.vtensor<[3],f32>) -> !torch.vtensor<[],f32> {
+// CHECK:           %[[LHS_M:.*]] = torch.aten.view %[[LHS]], %{{.*}} : !torch.vtensor<[3],f32>, !torch.list<int> -> !torch.vtensor<[1,3],f32>
+// CHECK:           %[[RHS_M:.*]] = torch.aten.view %[[RHS]], %{{.*}} : !torch.vtensor<[3],f32>, !torch.list<int> -> !torch.vtensor<[3,1],f32>
+// CHECK:           %[[MM:.*]] = torch.aten.mm %[[LHS_M]], %[[RHS_M]] : !torch.vtensor<[1,3],f32>, !torch.vtensor<[3,1],f32> -> !torch.vtensor<[1,1],f32>
+// CHECK:           %[[RESULT:.*]] = torch.aten.view %[[MM]], %{{.*}} : !torch.vtensor<[1,1],f32>, !torch.list<int> -> !torch.vtensor<[],f32>
+// CHECK:           return %[[RESULT]] : !torch.vtensor<[],f32>
+func.func @torch.aten.einsum$full_contraction(%arg0: !torch.vtensor<[3],f32>, %arg1: !torch.vtensor<[3],f32>) -> !torch.vtensor<[],f32> {
+  %str = torch.constant.str "i,i->"
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %arg0, %arg1 : (!torch.vtensor<[3],f32>, !torch.vtensor<[3],f32>) -> !torch.list<vtensor>
+  %1 = torch.aten.einsum %str, %0, %none : !torch.str, !torch.list<vtensor>, !torch.none -> !torch.vtensor<[],f32>
+  return %1 : !torch.vtensor<[],f32>
+}
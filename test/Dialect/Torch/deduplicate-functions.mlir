@@ -0,0 +1,80 @@
+// RUN: torch-mlir-opt -torch-deduplicate-functions -split-input-file %s | FileCheck %s
+
+// CHECK-LABEL:   func.func private @add(
+// CHECK-NOT:     func.func private @add_copy(
+func.func private @add(%arg0: !torch.int, %arg1: !torch.int) -> !torch.int {
+  %0 = torch.aten.add.int %arg0, %arg1 : !torch.int, !torch.int -> !torch.int
+  return %0 : !torch.int
+}
+func.func private @add_copy(%arg0: !torch.int, %arg1: !torch.int) -> !torch.int {
+  %0 = torch.aten.add.int %arg0, %arg1 : !torch.int, !torch.int -> !torch.int loc("copy")
+  return %0 : !torch.int
+}
+
+// The arguments are used in a different order.
+// CHECK-LABEL:   func.func private @add_swapped(
+func.func private @add_swapped(%arg0: !torch.int, %arg1: !torch.int) -> !torch.int {
+  %0 = torch.aten.add.int %arg1, %arg0 : !torch.int, !torch.int -> !torch.int
+  return %0 : !torch.int
+}
+
+// CHECK-LABEL:   func.func @encode(
+// CHECK:           call @add({{.*}}) : (!torch.int, !torch.int) -> !torch.int
+// CHECK:           call @add_swapped(
+func.func @encode(%arg0: !torch.int) -> !torch.int {
+  %0 = call @add(%arg0, %arg0) : (!torch.int, !torch.int) -> !torch.int
+  %1 = call @add_swapped(%0, %arg0) : (!torch.int, !torch.int) -> !torch.int
+  return %1 : !torch.int
+}
+
+// CHECK-LABEL:   func.func @generate(
+// CHECK:           call @add({{.*}}) : (!torch.int, !torch.int) -> !torch.int
+func.func @generate(%arg0: !torch.int) -> !torch.int {
+  %0 = call @add_copy(%arg0, %arg0) : (!torch.int, !torch.int) -> !torch.int
+  return %0 : !torch.int
+}
+
+// -----
+
+// Merging the callees makes the callers equivalent too.
+// CHECK-LABEL:   func.func private @callee(
+// CHECK-NOT:     func.func private @callee_copy(
+// CHECK-LABEL:   func.func private @caller(
+// CHECK:           call @callee(
+// CHECK-NOT:     func.func private @caller_copy(
+// CHECK-LABEL:   func.func @forward(
+// CHECK:           call @caller(
+// CHECK:           call @caller(
+func.func private @callee(%arg0: !torch.float) -> !torch.float {
+  %0 = torch.aten.mul.float %arg0, %arg0 : !torch.float, !torch.float -> !torch.float
+  return %0 : !torch.float
+}
+func.func private @callee_copy(%arg0: !torch.float) -> !torch.float {
+  %0 = torch.aten.mul.float %arg0, %arg0 : !torch.float, !torch.float -> !torch.float
+  return %0 : !torch.float
+}
+func.func private @caller(%arg0: !torch.float) -> !torch.float {
+  %0 = call @callee(%arg0) : (!torch.float) -> !torch.float
+  return %0 : !torch.float
+}
+func.func private @caller_copy(%arg0: !torch.float) -> !torch.float {
+  %0 = call @callee_copy(%arg0) : (!torch.float) -> !torch.float
+  return %0 : !torch.float
+}
+func.func @forward(%arg0: !torch.float) -> (!torch.float, !torch.float) {
+  %0 = call @caller(%arg0) : (!torch.float) -> !torch.float
+  %1 = call @caller_copy(%arg0) : (!torch.float) -> !torch.float
+  return %0, %1 : !torch.float, !torch.float
+}
+
+// -----
+
+// Public functions are never merged.
+// CHECK-LABEL:   func.func @public(
+// CHECK-LABEL:   func.func @public_copy(
+func.func @public(%arg0: !torch.int) -> !torch.int {
+  return %arg0 : !torch.int
+}
+func.func @public_copy(%arg0: !torch.int) -> !torch.int {
+  return %arg0 : !torch.int
+}
@@ -75,3 +75,28 @@ func.func @shape_calc_in_loop(%arg: !torch.vtensor<[2,?],unk>) -> !torch.vtensor
   return %arg : !torch.vtensor<[2,?],unk>
   // CHECK: return %[[ARG]] : !torch.vtensor<[2,?],unk>
 }
+
+// -----
+
+// CHECK-LABEL:   func.func @memoized_calculation(
+// CHECK-SAME:                     %[[ARG0:.*]]: !torch.vtensor<[2,3],f32>,
+// CHECK-SAME:                     %[[ARG1:.*]]: !torch.vtensor<[2,3],f32>) -> (!torch.vtensor, !torch.vtensor) {
+// CHECK:           %[[TANH0:.*]] = torch.aten.tanh %[[ARG0]] : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+// CHECK:           %[[TANH1:.*]] = torch.aten.tanh %[[ARG1]] : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+// CHECK-NOT:       torch.memoized_calculation
+// CHECK:           %[[ERASED1:.*]] = torch.tensor_static_info_cast %[[TANH1]] : !torch.vtensor<[2,3],f32> to !torch.vtensor
+// CHECK:           return %{{.*}}, %[[ERASED1]] : !torch.vtensor, !torch.vtensor
+func.func @memoized_calculation(%arg0: !torch.vtensor<[2,3],f32>, %arg1: !torch.vtensor<[2,3],f32>) -> (!torch.vtensor, !torch.vtensor) {
+  %0 = torch.shape.calculate {
+    %2 = torch.aten.tanh %arg0 : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+    torch.shape.calculate.yield %2 : !torch.vtensor<[2,3],f32>
+  } shapes {
+    %int2 = torch.constant.int 2
+    %int3 = torch.constant.int 3
+    %2 = torch.prim.ListConstruct %int2, %int3 : (!torch.int, !torch.int) -> !torch.list<int>
+    torch.shape.calculate.yield.shapes %2 : !torch.list<int>
+  } {torch.memoized_calculation = 0 : i64} : !torch.vtensor<[2,3],f32>
+  %1 = torch.aten.tanh %arg1 {torch.memoized_calculation = 0 : i64} : !torch.vtensor<[2,3],f32> -> !torch.vtensor
+  %3 = torch.tensor_static_info_cast %0 : !torch.vtensor<[2,3],f32> to !torch.vtensor
+  return %3, %1 : !torch.vtensor, !torch.vtensor
+}
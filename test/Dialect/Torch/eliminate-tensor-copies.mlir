@@ -0,0 +1,100 @@
+// RUN: torch-mlir-opt -split-input-file -allow-unregistered-dialect %s -torch-eliminate-tensor-copies | FileCheck %s
+
+// CHECK-LABEL:   func.func @overwritten_twice(
+// CHECK-SAME:                                 %[[ARG0:.*]]: !torch.vtensor, %[[ARG1:.*]]: !torch.vtensor, %[[ARG2:.*]]: !torch.vtensor) -> (!torch.vtensor, !torch.vtensor) {
+// CHECK-NOT:       torch.copy
+// CHECK-NOT:       torch.overwrite.tensor.contents
+// CHECK:           return %[[ARG0]], %[[ARG2]] : !torch.vtensor, !torch.vtensor
+func.func @overwritten_twice(%arg0: !torch.vtensor, %arg1: !torch.vtensor, %arg2: !torch.vtensor) -> (!torch.vtensor, !torch.vtensor) {
+  %t = torch.copy.to_tensor %arg0 : !torch.tensor
+  %0 = torch.copy.to_vtensor %t : !torch.vtensor
+  torch.overwrite.tensor.contents %arg1 overwrites %t : !torch.vtensor, !torch.tensor
+  torch.overwrite.tensor.contents %arg2 overwrites %t : !torch.vtensor, !torch.tensor
+  %1 = torch.copy.to_vtensor %t : !torch.vtensor
+  return %0, %1 : !torch.vtensor, !torch.vtensor
+}
+
+// -----
+
+// Overwriting a view only updates part of the tensor, so the copy of the
+// tensor after it stays. MaximizeValueSemantics leaves the whole function
+// alone.
+// CHECK-LABEL:   func.func @overwritten_view(
+// CHECK-SAME:                                %[[ARG0:.*]]: !torch.vtensor<[2,3],f32>, %[[ARG1:.*]]: !torch.vtensor<[1,3],f32>) -> (!torch.vtensor<[2,3],f32>, !torch.vtensor<[2,3],f32>) {
+// CHECK:           %[[T:.*]] = torch.copy.to_tensor %[[ARG0]] : !torch.tensor<[2,3],f32>
+// CHECK:           %[[TANH:.*]] = torch.aten.tanh %[[ARG0]] : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+// CHECK:           torch.overwrite.tensor.contents %[[TANH]] overwrites %[[T]] : !torch.vtensor<[2,3],f32>, !torch.tensor<[2,3],f32>
+// CHECK:           %[[SLICE:.*]] = torch.aten.slice.Tensor %[[T]]
+// CHECK:           torch.overwrite.tensor.contents %[[ARG1]] overwrites %[[SLICE]] : !torch.vtensor<[1,3],f32>, !torch.tensor<[1,3],f32>
+// CHECK:           %[[RESULT:.*]] = torch.copy.to_vtensor %[[T]] : !torch.vtensor<[2,3],f32>
+// CHECK:           return %[[TANH]], %[[RESULT]] : !torch.vtensor<[2,3],f32>, !torch.vtensor<[2,3],f32>
+func.func @overwritten_view(%arg0: !torch.vtensor<[2,3],f32>, %arg1: !torch.vtensor<[1,3],f32>) -> (!torch.vtensor<[2,3],f32>, !torch.vtensor<[2,3],f32>) {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %t = torch.copy.to_tensor %arg0 : !torch.tensor<[2,3],f32>
+  %0 = torch.copy.to_vtensor %t : !torch.vtensor<[2,3],f32>
+  %1 = torch.aten.tanh %0 : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+  torch.overwrite.tensor.contents %1 overwrites %t : !torch.vtensor<[2,3],f32>, !torch.tensor<[2,3],f32>
+  %2 = torch.copy.to_vtensor %t : !torch.vtensor<[2,3],f32>
+  %slice = torch.aten.slice.Tensor %t, %int0, %int0, %int1, %int1 : !torch.tensor<[2,3],f32>, !torch.int, !torch.int, !torch.int, !torch.int -> !torch.tensor<[1,3],f32>
+  torch.overwrite.tensor.contents %arg1 overwrites %slice : !torch.vtensor<[1,3],f32>, !torch.tensor<[1,3],f32>
+  %3 = torch.copy.to_vtensor %t : !torch.vtensor<[2,3],f32>
+  return %2, %3 : !torch.vtensor<[2,3],f32>, !torch.vtensor<[2,3],f32>
+}
+
+// -----
+
+// The copy of a cast of the overwritten tensor gets the overwrite value, cast
+// to its type.
+// CHECK-LABEL:   func.func @cast_of_overwritten(
+// CHECK-SAME:                                   %[[ARG0:.*]]: !torch.vtensor<[2],f32>, %[[ARG1:.*]]: !torch.vtensor<[2],f32>) -> !torch.vtensor {
+// CHECK:           %[[CAST:.*]] = torch.tensor_static_info_cast %[[ARG1]] : !torch.vtensor<[2],f32> to !torch.vtensor
+// CHECK:           return %[[CAST]] : !torch.vtensor
+func.func @cast_of_overwritten(%arg0: !torch.vtensor<[2],f32>, %arg1: !torch.vtensor<[2],f32>) -> !torch.vtensor {
+  %t = torch.copy.to_tensor %arg0 : !torch.tensor<[2],f32>
+  %cast = torch.tensor_static_info_cast %t : !torch.tensor<[2],f32> to !torch.tensor
+  torch.overwrite.tensor.contents %arg1 overwrites %t : !torch.vtensor<[2],f32>, !torch.tensor<[2],f32>
+  %0 = torch.copy.to_vtensor %cast : !torch.vtensor
+  return %0 : !torch.vtensor
+}
+
+// -----
+
+// The region of a torch.prim.If may read and write the tensor.
+// CHECK-LABEL:   func.func @control_flow(
+// CHECK-SAME:                            %[[ARG0:.*]]: !torch.vtensor, %[[ARG1:.*]]: !torch.vtensor, %[[ARG2:.*]]: !torch.vtensor, %[[COND:.*]]: !torch.bool) -> (!torch.vtensor, !torch.vtensor) {
+// CHECK:           %[[T:.*]] = torch.copy.to_tensor %[[ARG0]] : !torch.tensor
+// CHECK:           torch.overwrite.tensor.contents %[[ARG1]] overwrites %[[T]] : !torch.vtensor, !torch.tensor
+// CHECK:           torch.prim.If %[[COND]] -> () {
+// CHECK:             torch.overwrite.tensor.contents %[[ARG2]] overwrites %[[T]] : !torch.vtensor, !torch.tensor
+// CHECK:           %[[RESULT:.*]] = torch.copy.to_vtensor %[[T]] : !torch.vtensor
+// CHECK:           return %[[ARG1]], %[[RESULT]] : !torch.vtensor, !torch.vtensor
+func.func @control_flow(%arg0: !torch.vtensor, %arg1: !torch.vtensor, %arg2: !torch.vtensor, %cond: !torch.bool) -> (!torch.vtensor, !torch.vtensor) {
+  %t = torch.copy.to_tensor %arg0 : !torch.tensor
+  torch.overwrite.tensor.contents %arg1 overwrites %t : !torch.vtensor, !torch.tensor
+  %0 = torch.copy.to_vtensor %t : !torch.vtensor
+  torch.prim.If %cond -> () {
+    torch.overwrite.tensor.contents %arg2 overwrites %t : !torch.vtensor, !torch.tensor
+    torch.prim.If.yield
+  } else {
+    torch.prim.If.yield
+  }
+  %1 = torch.copy.to_vtensor %t : !torch.vtensor
+  return %0, %1 : !torch.vtensor, !torch.vtensor
+}
+
+// -----
+
+// An unknown op could keep an alias of the tensor around.
+// CHECK-LABEL:   func.func @unknown_user(
+// CHECK:           torch.copy.to_tensor
+// CHECK:           torch.overwrite.tensor.contents
+// CHECK:           "some.op"
+// CHECK:           torch.copy.to_vtensor
+func.func @unknown_user(%arg0: !torch.vtensor, %arg1: !torch.vtensor) -> !torch.vtensor {
+  %t = torch.copy.to_tensor %arg0 : !torch.tensor
+  torch.overwrite.tensor.contents %arg1 overwrites %t : !torch.vtensor, !torch.tensor
+  "some.op"(%t) : (!torch.tensor) -> ()
+  %0 = torch.copy.to_vtensor %t : !torch.vtensor
+  return %0 : !torch.vtensor
+}
@@ -0,0 +1,79 @@
+// RUN: torch-mlir-opt -torch-eliminate-tensor-static-info-casts -split-input-file %s | FileCheck %s
+
+// Chains of casts collapse, and the refined type reaches the users.
+// CHECK-LABEL:   func.func @cast_chain(
+// CHECK-SAME:                          %[[ARG:.*]]: !torch.vtensor<[2,3],f32>) -> !torch.vtensor<[2,3],f32> {
+// CHECK:           %[[TANH:.*]] = torch.aten.tanh %[[ARG]] : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+// CHECK-NEXT:      return %[[TANH]] : !torch.vtensor<[2,3],f32>
+func.func @cast_chain(%arg0: !torch.vtensor<[2,3],f32>) -> !torch.vtensor<[2,3],f32> {
+  %0 = torch.tensor_static_info_cast %arg0 : !torch.vtensor<[2,3],f32> to !torch.vtensor<[?,?],f32>
+  %1 = torch.aten.tanh %0 : !torch.vtensor<[?,?],f32> -> !torch.vtensor<[?,?],f32>
+  %2 = torch.tensor_static_info_cast %1 : !torch.vtensor<[?,?],f32> to !torch.vtensor<[2,3],f32>
+  return %2 : !torch.vtensor<[2,3],f32>
+}
+
+// -----
+
+// The refining cast refines the result type of the op it casts, and the
+// erasing cast is then bypassed.
+// CHECK-LABEL:   func.func @refine_producer(
+// CHECK-SAME:                               %[[ARG:.*]]: !torch.vtensor<[?,?],f32>) -> !torch.vtensor<[2,3],f32> {
+// CHECK:           %[[TANH:.*]] = torch.aten.tanh %[[ARG]] : !torch.vtensor<[?,?],f32> -> !torch.vtensor<[2,3],f32>
+// CHECK-NEXT:      %[[EXP:.*]] = torch.aten.exp %[[TANH]] : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+// CHECK-NEXT:      return %[[EXP]] : !torch.vtensor<[2,3],f32>
+func.func @refine_producer(%arg0: !torch.vtensor<[?,?],f32>) -> !torch.vtensor<[2,3],f32> {
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[?,?],f32> -> !torch.vtensor<[?,?],f32>
+  %1 = torch.tensor_static_info_cast %0 : !torch.vtensor<[?,?],f32> to !torch.vtensor<[2,3],f32>
+  %2 = torch.tensor_static_info_cast %1 : !torch.vtensor<[2,3],f32> to !torch.vtensor<[?,?],f32>
+  %3 = torch.aten.exp %2 : !torch.vtensor<[?,?],f32> -> !torch.vtensor<[2,3],f32>
+  return %3 : !torch.vtensor<[2,3],f32>
+}
+
+// -----
+
+// The uses requiring the original type get a cast back to it.
+// CHECK-LABEL:   func.func @cast_back_for_return(
+// CHECK-SAME:                                    %[[ARG:.*]]: !torch.vtensor<[?,?],f32>) -> (!torch.vtensor<[?,?],f32>, !torch.vtensor<[2,3],f32>) {
+// CHECK:           %[[TANH:.*]] = torch.aten.tanh %[[ARG]] : !torch.vtensor<[?,?],f32> -> !torch.vtensor<[2,3],f32>
+// CHECK:           %[[CAST:.*]] = torch.tensor_static_info_cast %[[TANH]] : !torch.vtensor<[2,3],f32> to !torch.vtensor<[?,?],f32>
+// CHECK:           %[[EXP:.*]] = torch.aten.exp %[[TANH]] : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+// CHECK:           return %[[CAST]], %[[EXP]] : !torch.vtensor<[?,?],f32>, !torch.vtensor<[2,3],f32>
+func.func @cast_back_for_return(%arg0: !torch.vtensor<[?,?],f32>) -> (!torch.vtensor<[?,?],f32>, !torch.vtensor<[2,3],f32>) {
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[?,?],f32> -> !torch.vtensor<[?,?],f32>
+  %1 = torch.tensor_static_info_cast %0 : !torch.vtensor<[?,?],f32> to !torch.vtensor<[2,3],f32>
+  %2 = torch.aten.exp %1 : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+  return %0, %2 : !torch.vtensor<[?,?],f32>, !torch.vtensor<[2,3],f32>
+}
+
+// -----
+
+// Function arguments are not refined.
+// CHECK-LABEL:   func.func @argument(
+// CHECK:           torch.tensor_static_info_cast
+func.func @argument(%arg0: !torch.vtensor<[?,?],f32>) -> !torch.vtensor<[2,3],f32> {
+  %0 = torch.tensor_static_info_cast %arg0 : !torch.vtensor<[?,?],f32> to !torch.vtensor<[2,3],f32>
+  %1 = torch.aten.tanh %0 : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+  return %1 : !torch.vtensor<[2,3],f32>
+}
+
+// -----
+
+// A cast in a branch doesn't refine the op it casts, which also computes the
+// value used on the other branch.
+// CHECK-LABEL:   func.func @cast_in_branch(
+// CHECK:           %[[TANH:.*]] = torch.aten.tanh %{{.*}} : !torch.vtensor<[?,?],f32> -> !torch.vtensor<[?,?],f32>
+// CHECK:           torch.prim.If
+// CHECK:             torch.tensor_static_info_cast %[[TANH]] : !torch.vtensor<[?,?],f32> to !torch.vtensor<[2,3],f32>
+// CHECK:           } else {
+// CHECK:             torch.prim.If.yield %[[TANH]] : !torch.vtensor<[?,?],f32>
+func.func @cast_in_branch(%arg0: !torch.vtensor<[?,?],f32>, %arg1: !torch.bool) -> !torch.vtensor<[?,?],f32> {
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[?,?],f32> -> !torch.vtensor<[?,?],f32>
+  %1 = torch.prim.If %arg1 -> (!torch.vtensor<[?,?],f32>) {
+    %2 = torch.tensor_static_info_cast %0 : !torch.vtensor<[?,?],f32> to !torch.vtensor<[2,3],f32>
+    %3 = torch.aten.exp %2 : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[?,?],f32>
+    torch.prim.If.yield %3 : !torch.vtensor<[?,?],f32>
+  } else {
+    torch.prim.If.yield %0 : !torch.vtensor<[?,?],f32>
+  }
+  return %1 : !torch.vtensor<[?,?],f32>
+}
@@ -0,0 +1,28 @@
+// RUN: torch-mlir-opt -torch-estimate-costs -split-input-file %s | FileCheck %s
+// RUN: torch-mlir-opt -torch-estimate-costs=per-op -split-input-file %s | FileCheck %s --check-prefix=PER-OP
+
+// CHECK-LABEL: func.func @mm_relu(
+// CHECK-SAME:    attributes {torch.cost = {activation_bytes = 88 : i64, bytes = 168 : i64, flops = 5.600000e+01 : f64, num_unestimated_ops = 0 : i64, parameter_bytes = 48 : i64}}
+// PER-OP-LABEL: func.func @mm_relu(
+// PER-OP:         torch.vtensor.literal
+// PER-OP-NOT:       torch.cost
+// PER-OP:         torch.aten.mm {{.*}} {torch.cost = {bytes = 104 : i64, flops = 4.800000e+01 : f64}}
+// PER-OP:         torch.aten.relu {{.*}} {torch.cost = {bytes = 64 : i64, flops = 8.000000e+00 : f64}}
+func.func @mm_relu(%arg0: !torch.vtensor<[2,3],f32>) -> !torch.vtensor<[2,4],f32> {
+  %0 = torch.vtensor.literal(dense<1.000000e+00> : tensor<3x4xf32>) : !torch.vtensor<[3,4],f32>
+  %1 = torch.aten.mm %arg0, %0 : !torch.vtensor<[2,3],f32>, !torch.vtensor<[3,4],f32> -> !torch.vtensor<[2,4],f32>
+  %2 = torch.aten.relu %1 : !torch.vtensor<[2,4],f32> -> !torch.vtensor<[2,4],f32>
+  return %2 : !torch.vtensor<[2,4],f32>
+}
+
+// -----
+
+// The dynamic sized ops aren't counted.
+
+// CHECK-LABEL: func.func @dynamic(
+// CHECK-SAME:    attributes {torch.cost = {activation_bytes = 32 : i64, bytes = 32 : i64, flops = 4.000000e+00 : f64, num_unestimated_ops = 1 : i64, parameter_bytes = 0 : i64}}
+func.func @dynamic(%arg0: !torch.vtensor<[?],f32>, %arg1: !torch.vtensor<[4],f32>) -> (!torch.vtensor<[?],f32>, !torch.vtensor<[4],f32>) {
+  %0 = torch.aten.relu %arg0 : !torch.vtensor<[?],f32> -> !torch.vtensor<[?],f32>
+  %1 = torch.aten.relu %arg1 : !torch.vtensor<[4],f32> -> !torch.vtensor<[4],f32>
+  return %0, %1 : !torch.vtensor<[?],f32>, !torch.vtensor<[4],f32>
+}
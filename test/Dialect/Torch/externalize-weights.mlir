@@ -0,0 +1,50 @@
+// RUN: torch-mlir-opt -torch-externalize-weights="weights-file=%t" %s | FileCheck %s
+// RUN: FileCheck %s --check-prefix=FILE --input-file=%t
+
+// The cache is overwritten, so its initial value stays a literal.
+// CHECK-LABEL:   torch.global_slot.module_initializer {
+// CHECK-DAG:       %[[WEIGHT:.*]] = torch.tensor.external "l.weight" : !torch.tensor<[2,3],f32>
+// CHECK-DAG:       %[[BIAS:.*]] = torch.vtensor.external "l.bias" : !torch.vtensor<[2],f32>
+// CHECK-DAG:       %[[MASK:.*]] = torch.tensor.external "mask" : !torch.tensor<[4],i1>
+// CHECK-DAG:       %[[CACHE:.*]] = torch.tensor.literal(dense<0.000000e+00> : tensor<3xf32>) : !torch.tensor
+// CHECK:           torch.initialize.global_slots [
+// CHECK-NEXT:        @l.weight(%[[WEIGHT]] : !torch.tensor<[2,3],f32>)
+// CHECK-NEXT:        @l.bias(%[[BIAS]] : !torch.vtensor<[2],f32>)
+// CHECK-NEXT:        @mask(%[[MASK]] : !torch.tensor<[4],i1>)
+// CHECK-NEXT:        @cache(%[[CACHE]] : !torch.tensor)
+// CHECK-NEXT:      ]
+// CHECK-NOT:       torch.tensor.literal(dense<{{.*}}> : tensor<2x3xf32>)
+
+// The splat weight and the boolean mask are written out element by element.
+// FILE: {"l.bias":{"data_offsets":[24,32],"dtype":"F32","shape":[2]},"l.weight":{"data_offsets":[0,24],"dtype":"F32","shape":[2,3]},"mask":{"data_offsets":[32,36],"dtype":"BOOL","shape":[4]}}
+
+torch.global_slot "private" @l.weight : !torch.tensor
+torch.global_slot "private" @l.bias : !torch.vtensor
+torch.global_slot "private" @mask : !torch.tensor
+torch.global_slot "private" @cache : !torch.tensor
+
+torch.global_slot.module_initializer {
+  %0 = torch.tensor.literal(dense<1.0> : tensor<2x3xf32>) : !torch.tensor
+  %1 = torch.vtensor.literal(dense<[1.0, 2.0]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %2 = torch.tensor.literal(dense<[true, false, true, true]> : tensor<4xi1>) : !torch.tensor
+  %3 = torch.tensor.literal(dense<0.0> : tensor<3xf32>) : !torch.tensor
+  torch.initialize.global_slots [
+    @l.weight(%0 : !torch.tensor)
+    @l.bias(%1 : !torch.vtensor<[2],f32>)
+    @mask(%2 : !torch.tensor)
+    @cache(%3 : !torch.tensor)
+  ]
+}
+
+func.func @forward(%arg0: !torch.tensor, %arg1: !torch.vtensor<[3],f32>) -> (!torch.tensor, !torch.tensor) {
+  %weight = torch.global_slot.get @l.weight : !torch.tensor
+  %bias = torch.global_slot.get @l.bias : !torch.vtensor
+  %weight_t = torch.aten.t %weight : !torch.tensor -> !torch.tensor
+  %mask = torch.global_slot.get @mask : !torch.tensor
+  %0 = torch.aten.matmul %arg0, %weight_t : !torch.tensor, !torch.tensor -> !torch.tensor
+  %1 = torch.aten.where.self %mask, %0, %arg0 : !torch.tensor, !torch.tensor, !torch.tensor -> !torch.tensor
+  %cache = torch.global_slot.get @cache : !torch.tensor
+  torch.overwrite.tensor.contents %arg1 overwrites %cache : !torch.vtensor<[3],f32>, !torch.tensor
+  %2 = torch.copy.to_tensor %bias : !torch.tensor
+  return %1, %2 : !torch.tensor, !torch.tensor
+}
@@ -0,0 +1,89 @@
+// RUN: torch-mlir-opt -torch-fold-batch-norm-into-weights -split-input-file %s | FileCheck %s
+
+// CHECK-LABEL: func.func @convolution_batch_norm(
+// CHECK-SAME:      %[[INPUT:.*]]: !torch.vtensor<[1,1,4,4],f32>)
+// CHECK-DAG:     %[[WEIGHT:.*]] = torch.vtensor.literal(dense<{{\[\[\[\[}}2.000000e+00]]], {{\[\[\[}}6.000000e+00]]]]> : tensor<2x1x1x1xf32>) : !torch.vtensor<[2,1,1,1],f32>
+// CHECK-DAG:     %[[BIAS:.*]] = torch.vtensor.literal(dense<[5.000000e-01, 6.500000e+00]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+// CHECK:         %[[CONV:.*]] = torch.aten.convolution %[[INPUT]], %[[WEIGHT]], %[[BIAS]]
+// CHECK-NOT:     torch.aten.batch_norm
+// CHECK:         return %[[CONV]]
+func.func @convolution_batch_norm(%input: !torch.vtensor<[1,1,4,4],f32>) -> !torch.vtensor<[1,2,4,4],f32> {
+  %weight = torch.vtensor.literal(dense<[[[[1.0]]], [[[2.0]]]]> : tensor<2x1x1x1xf32>) : !torch.vtensor<[2,1,1,1],f32>
+  %bias = torch.vtensor.literal(dense<[1.0, 2.0]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %gamma = torch.vtensor.literal(dense<[4.0, 3.0]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %beta = torch.vtensor.literal(dense<0.5> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %mean = torch.vtensor.literal(dense<[1.0, 0.0]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %var = torch.vtensor.literal(dense<[3.0, 0.0]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %false = torch.constant.bool false
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %float1.000000e-01 = torch.constant.float 1.000000e-01
+  %float1.000000e00 = torch.constant.float 1.000000e+00
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct : () -> !torch.list<int>
+  %3 = torch.aten.convolution %input, %weight, %bias, %0, %1, %0, %false, %2, %int1 : !torch.vtensor<[1,1,4,4],f32>, !torch.vtensor<[2,1,1,1],f32>, !torch.vtensor<[2],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,2,4,4],f32>
+  %4 = torch.aten.batch_norm %3, %gamma, %beta, %mean, %var, %false, %float1.000000e-01, %float1.000000e00, %false : !torch.vtensor<[1,2,4,4],f32>, !torch.vtensor<[2],f32>, !torch.vtensor<[2],f32>, !torch.vtensor<[2],f32>, !torch.vtensor<[2],f32>, !torch.bool, !torch.float, !torch.float, !torch.bool -> !torch.vtensor<[1,2,4,4],f32>
+  return %4 : !torch.vtensor<[1,2,4,4],f32>
+}
+
+// -----
+
+// A per-channel scale and bias after a linear op are folded one after the
+// other, and a bias is created for the linear op.
+// CHECK-LABEL: func.func @linear_scale_bias(
+// CHECK-SAME:      %[[INPUT:.*]]: !torch.vtensor<[4,3],f32>)
+// CHECK-DAG:     %[[WEIGHT:.*]] = torch.vtensor.literal(dense<{{\[\[}}2.000000e+00, 2.000000e+00, 2.000000e+00], [3.000000e+00, 3.000000e+00, 3.000000e+00]]> : tensor<2x3xf32>) : !torch.vtensor<[2,3],f32>
+// CHECK-DAG:     %[[BIAS:.*]] = torch.vtensor.literal(dense<[1.000000e+00, -1.000000e+00]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+// CHECK:         %[[LINEAR:.*]] = torch.aten.linear %[[INPUT]], %[[WEIGHT]], %[[BIAS]]
+// CHECK-NOT:     torch.aten.mul.Tensor
+// CHECK-NOT:     torch.aten.add.Tensor
+// CHECK:         return %[[LINEAR]]
+func.func @linear_scale_bias(%input: !torch.vtensor<[4,3],f32>) -> !torch.vtensor<[4,2],f32> {
+  %weight = torch.vtensor.literal(dense<1.0> : tensor<2x3xf32>) : !torch.vtensor<[2,3],f32>
+  %scale = torch.vtensor.literal(dense<[2.0, 3.0]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %shift = torch.vtensor.literal(dense<[[1.0, -1.0]]> : tensor<1x2xf32>) : !torch.vtensor<[1,2],f32>
+  %none = torch.constant.none
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.linear %input, %weight, %none : !torch.vtensor<[4,3],f32>, !torch.vtensor<[2,3],f32>, !torch.none -> !torch.vtensor<[4,2],f32>
+  %1 = torch.aten.mul.Tensor %0, %scale : !torch.vtensor<[4,2],f32>, !torch.vtensor<[2],f32> -> !torch.vtensor<[4,2],f32>
+  %2 = torch.aten.add.Tensor %1, %shift, %int1 : !torch.vtensor<[4,2],f32>, !torch.vtensor<[1,2],f32>, !torch.int -> !torch.vtensor<[4,2],f32>
+  return %2 : !torch.vtensor<[4,2],f32>
+}
+
+// -----
+
+// The scale must not vary along anything but the output channels.
+// CHECK-LABEL: func.func @linear_non_channel_scale(
+// CHECK:         torch.aten.linear
+// CHECK:         torch.aten.mul.Tensor
+func.func @linear_non_channel_scale(%input: !torch.vtensor<[4,3],f32>) -> !torch.vtensor<[4,2],f32> {
+  %weight = torch.vtensor.literal(dense<1.0> : tensor<2x3xf32>) : !torch.vtensor<[2,3],f32>
+  %scale = torch.vtensor.literal(dense<2.0> : tensor<4x1xf32>) : !torch.vtensor<[4,1],f32>
+  %none = torch.constant.none
+  %0 = torch.aten.linear %input, %weight, %none : !torch.vtensor<[4,3],f32>, !torch.vtensor<[2,3],f32>, !torch.none -> !torch.vtensor<[4,2],f32>
+  %1 = torch.aten.mul.Tensor %0, %scale : !torch.vtensor<[4,2],f32>, !torch.vtensor<[4,1],f32> -> !torch.vtensor<[4,2],f32>
+  return %1 : !torch.vtensor<[4,2],f32>
+}
+
+// -----
+
+// The weights are not literals, so this is left to RecomposeComplexOps.
+// CHECK-LABEL: func.func @convolution_batch_norm_non_literal(
+// CHECK:         torch.aten.conv2d
+// CHECK:         torch.aten.batch_norm
+func.func @convolution_batch_norm_non_literal(%input: !torch.vtensor<[1,1,4,4],f32>, %weight: !torch.vtensor<[2,1,1,1],f32>) -> !torch.vtensor<[1,2,4,4],f32> {
+  %mean = torch.vtensor.literal(dense<0.0> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %var = torch.vtensor.literal(dense<1.0> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %float1.000000e-01 = torch.constant.float 1.000000e-01
+  %float1.000000e-05 = torch.constant.float 1.000000e-05
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.aten.conv2d %input, %weight, %none, %0, %1, %0, %int1 : !torch.vtensor<[1,1,4,4],f32>, !torch.vtensor<[2,1,1,1],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int -> !torch.vtensor<[1,2,4,4],f32>
+  %3 = torch.aten.batch_norm %2, %none, %none, %mean, %var, %false, %float1.000000e-01, %float1.000000e-05, %false : !torch.vtensor<[1,2,4,4],f32>, !torch.none, !torch.none, !torch.vtensor<[2],f32>, !torch.vtensor<[2],f32>, !torch.bool, !torch.float, !torch.float, !torch.bool -> !torch.vtensor<[1,2,4,4],f32>
+  return %3 : !torch.vtensor<[1,2,4,4],f32>
+}
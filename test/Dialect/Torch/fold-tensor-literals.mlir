@@ -0,0 +1,60 @@
+// RUN: torch-mlir-opt -torch-fold-tensor-literals -split-input-file %s | FileCheck %s
+
+// CHECK-LABEL: func.func @mul_scalar_then_add_broadcast(
+// CHECK:         %[[LITERAL:.*]] = torch.vtensor.literal(dense<{{\[\[}}3.000000e+00, 5.000000e+00], [7.000000e+00, 9.000000e+00]]> : tensor<2x2xf32>) : !torch.vtensor<[2,2],f32>
+// CHECK-NOT:     torch.aten
+// CHECK:         return %[[LITERAL]]
+func.func @mul_scalar_then_add_broadcast() -> !torch.vtensor<[2,2],f32> {
+  %int1 = torch.constant.int 1
+  %float2 = torch.constant.float 2.000000e+00
+  %0 = torch.vtensor.literal(dense<[[1.0, 2.0], [3.0, 4.0]]> : tensor<2x2xf32>) : !torch.vtensor<[2,2],f32>
+  %1 = torch.vtensor.literal(dense<1.0> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %2 = torch.aten.mul.Scalar %0, %float2 : !torch.vtensor<[2,2],f32>, !torch.float -> !torch.vtensor<[2,2],f32>
+  %3 = torch.aten.add.Tensor %2, %1, %int1 : !torch.vtensor<[2,2],f32>, !torch.vtensor<[2],f32>, !torch.int -> !torch.vtensor<[2,2],f32>
+  return %3 : !torch.vtensor<[2,2],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @transpose_and_reshape(
+// CHECK:         %[[LITERAL:.*]] = torch.vtensor.literal(dense<[1.000000e+00, 4.000000e+00, 2.000000e+00, 5.000000e+00, 3.000000e+00, 6.000000e+00]> : tensor<6xf32>) : !torch.vtensor<[6],f32>
+// CHECK:         %[[CAST:.*]] = torch.tensor_static_info_cast %[[LITERAL]] : !torch.vtensor<[6],f32> to !torch.vtensor<[?],f32>
+// CHECK:         return %[[CAST]]
+func.func @transpose_and_reshape() -> !torch.vtensor<[?],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int-1 = torch.constant.int -1
+  %0 = torch.vtensor.literal(dense<[[1.0, 2.0, 3.0], [4.0, 5.0, 6.0]]> : tensor<2x3xf32>) : !torch.vtensor<[2,3],f32>
+  %1 = torch.aten.transpose.int %0, %int0, %int1 : !torch.vtensor<[2,3],f32>, !torch.int, !torch.int -> !torch.vtensor<[3,2],f32>
+  %2 = torch.prim.ListConstruct %int-1 : (!torch.int) -> !torch.list<int>
+  %3 = torch.aten.view %1, %2 : !torch.vtensor<[3,2],f32>, !torch.list<int> -> !torch.vtensor<[?],f32>
+  return %3 : !torch.vtensor<[?],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @to_dtype(
+// CHECK:         %[[LITERAL:.*]] = torch.vtensor.literal(dense<[1.000000e+00, 2.500000e+00]> : tensor<2xf16>) : !torch.vtensor<[2],f16>
+// CHECK:         return %[[LITERAL]]
+func.func @to_dtype() -> !torch.vtensor<[2],f16> {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int5 = torch.constant.int 5
+  %0 = torch.vtensor.literal(dense<[1.0, 2.5]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %1 = torch.aten.to.dtype %0, %int5, %false, %false, %none : !torch.vtensor<[2],f32>, !torch.int, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[2],f16>
+  return %1 : !torch.vtensor<[2],f16>
+}
+
+// -----
+
+// Operands that aren't literals or have different dtypes are not folded.
+// CHECK-LABEL: func.func @not_folded(
+// CHECK:         torch.aten.mul.Tensor %arg0
+// CHECK:         torch.aten.mul.Tensor %{{.*}}, %{{.*}} : !torch.vtensor<[2],f32>, !torch.vtensor<[2],f64>
+func.func @not_folded(%arg0: !torch.vtensor<[2],f32>) -> (!torch.vtensor<[2],f32>, !torch.vtensor<[2],f64>) {
+  %0 = torch.vtensor.literal(dense<[1.0, 2.0]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %1 = torch.vtensor.literal(dense<[1.0, 2.0]> : tensor<2xf64>) : !torch.vtensor<[2],f64>
+  %2 = torch.aten.mul.Tensor %arg0, %0 : !torch.vtensor<[2],f32>, !torch.vtensor<[2],f32> -> !torch.vtensor<[2],f32>
+  %3 = torch.aten.mul.Tensor %0, %1 : !torch.vtensor<[2],f32>, !torch.vtensor<[2],f64> -> !torch.vtensor<[2],f64>
+  return %2, %3 : !torch.vtensor<[2],f32>, !torch.vtensor<[2],f64>
+}
@@ -0,0 +1,68 @@
+// RUN: torch-mlir-opt -torch-fuse-sibling-linears -split-input-file %s | FileCheck %s
+
+// The ops without a bias get zeros in the fused bias. Splat weights are
+// expanded.
+// CHECK-LABEL:   func.func @qkv(
+// CHECK-SAME:                   %[[INPUT:.*]]: !torch.vtensor<[3,2],f32>) -> (!torch.vtensor<[3,1],f32>, !torch.vtensor<[3,2],f32>, !torch.vtensor<[3,1],f32>) {
+// CHECK:           %[[WEIGHT:.*]] = torch.vtensor.literal(dense<{{\[\[}}1.000000e+00, 2.000000e+00], [3.000000e+00, 4.000000e+00], [5.000000e+00, 6.000000e+00], [7.000000e+00, 7.000000e+00]]> : tensor<4x2xf32>) : !torch.vtensor<[4,2],f32>
+// CHECK:           %[[BIAS:.*]] = torch.vtensor.literal(dense<[5.000000e+00, 0.000000e+00, 0.000000e+00, 0.000000e+00]> : tensor<4xf32>) : !torch.vtensor<[4],f32>
+// CHECK:           %[[FUSED:.*]] = torch.aten.linear %[[INPUT]], %[[WEIGHT]], %[[BIAS]] : !torch.vtensor<[3,2],f32>, !torch.vtensor<[4,2],f32>, !torch.vtensor<[4],f32> -> !torch.vtensor<[3,4],f32>
+// CHECK:           %[[DIM:.*]] = torch.constant.int 1
+// CHECK:           %[[STEP:.*]] = torch.constant.int 1
+// CHECK:           %[[START0:.*]] = torch.constant.int 0
+// CHECK:           %[[END0:.*]] = torch.constant.int 1
+// CHECK:           %[[Q:.*]] = torch.aten.slice.Tensor %[[FUSED]], %[[DIM]], %[[START0]], %[[END0]], %[[STEP]] : !torch.vtensor<[3,4],f32>, !torch.int, !torch.int, !torch.int, !torch.int -> !torch.vtensor<[3,1],f32>
+// CHECK:           %[[START1:.*]] = torch.constant.int 1
+// CHECK:           %[[END1:.*]] = torch.constant.int 3
+// CHECK:           %[[K:.*]] = torch.aten.slice.Tensor %[[FUSED]], %[[DIM]], %[[START1]], %[[END1]], %[[STEP]] : !torch.vtensor<[3,4],f32>, !torch.int, !torch.int, !torch.int, !torch.int -> !torch.vtensor<[3,2],f32>
+// CHECK:           %[[START2:.*]] = torch.constant.int 3
+// CHECK:           %[[END2:.*]] = torch.constant.int 4
+// CHECK:           %[[V:.*]] = torch.aten.slice.Tensor %[[FUSED]], %[[DIM]], %[[START2]], %[[END2]], %[[STEP]] : !torch.vtensor<[3,4],f32>, !torch.int, !torch.int, !torch.int, !torch.int -> !torch.vtensor<[3,1],f32>
+// CHECK-NOT:       torch.aten.linear
+// CHECK:           return %[[Q]], %[[K]], %[[V]]
+func.func @qkv(%arg0: !torch.vtensor<[3,2],f32>) -> (!torch.vtensor<[3,1],f32>, !torch.vtensor<[3,2],f32>, !torch.vtensor<[3,1],f32>) {
+  %none = torch.constant.none
+  %wq = torch.vtensor.literal(dense<[[1.0, 2.0]]> : tensor<1x2xf32>) : !torch.vtensor<[1,2],f32>
+  %bq = torch.vtensor.literal(dense<[5.0]> : tensor<1xf32>) : !torch.vtensor<[1],f32>
+  %wk = torch.vtensor.literal(dense<[[3.0, 4.0], [5.0, 6.0]]> : tensor<2x2xf32>) : !torch.vtensor<[2,2],f32>
+  %wv = torch.vtensor.literal(dense<7.0> : tensor<1x2xf32>) : !torch.vtensor<[1,2],f32>
+  %q = torch.aten.linear %arg0, %wq, %bq : !torch.vtensor<[3,2],f32>, !torch.vtensor<[1,2],f32>, !torch.vtensor<[1],f32> -> !torch.vtensor<[3,1],f32>
+  %k = torch.aten.linear %arg0, %wk, %none : !torch.vtensor<[3,2],f32>, !torch.vtensor<[2,2],f32>, !torch.none -> !torch.vtensor<[3,2],f32>
+  %v = torch.aten.linear %arg0, %wv, %none : !torch.vtensor<[3,2],f32>, !torch.vtensor<[1,2],f32>, !torch.none -> !torch.vtensor<[3,1],f32>
+  return %q, %k, %v : !torch.vtensor<[3,1],f32>, !torch.vtensor<[3,2],f32>, !torch.vtensor<[3,1],f32>
+}
+
+// -----
+
+// The [K, N] weights of matmuls are concatenated along their columns.
+// CHECK-LABEL:   func.func @matmul(
+// CHECK-SAME:                      %[[INPUT:.*]]: !torch.vtensor<[4,2],f32>) -> (!torch.vtensor<[4,1],f32>, !torch.vtensor<[4,2],f32>) {
+// CHECK:           %[[WEIGHT:.*]] = torch.vtensor.literal(dense<{{\[\[}}1.000000e+00, 3.000000e+00, 4.000000e+00], [2.000000e+00, 5.000000e+00, 6.000000e+00]]> : tensor<2x3xf32>) : !torch.vtensor<[2,3],f32>
+// CHECK:           %[[FUSED:.*]] = torch.aten.matmul %[[INPUT]], %[[WEIGHT]] : !torch.vtensor<[4,2],f32>, !torch.vtensor<[2,3],f32> -> !torch.vtensor<[4,3],f32>
+// CHECK:           torch.aten.slice.Tensor %[[FUSED]], {{.*}} -> !torch.vtensor<[4,1],f32>
+// CHECK:           torch.aten.slice.Tensor %[[FUSED]], {{.*}} -> !torch.vtensor<[4,2],f32>
+// CHECK-NOT:       torch.aten.matmul
+func.func @matmul(%arg0: !torch.vtensor<[4,2],f32>) -> (!torch.vtensor<[4,1],f32>, !torch.vtensor<[4,2],f32>) {
+  %w0 = torch.vtensor.literal(dense<[[1.0], [2.0]]> : tensor<2x1xf32>) : !torch.vtensor<[2,1],f32>
+  %w1 = torch.vtensor.literal(dense<[[3.0, 4.0], [5.0, 6.0]]> : tensor<2x2xf32>) : !torch.vtensor<[2,2],f32>
+  %0 = torch.aten.matmul %arg0, %w0 : !torch.vtensor<[4,2],f32>, !torch.vtensor<[2,1],f32> -> !torch.vtensor<[4,1],f32>
+  %1 = torch.aten.matmul %arg0, %w1 : !torch.vtensor<[4,2],f32>, !torch.vtensor<[2,2],f32> -> !torch.vtensor<[4,2],f32>
+  return %0, %1 : !torch.vtensor<[4,1],f32>, !torch.vtensor<[4,2],f32>
+}
+
+// -----
+
+// Linear ops on different inputs, or with a weight that is not a literal, are
+// left as is.
+// CHECK-LABEL:   func.func @not_fused(
+// CHECK-NOT:       torch.aten.slice.Tensor
+// CHECK-COUNT-3:   torch.aten.linear
+// CHECK-NOT:       torch.aten.slice.Tensor
+func.func @not_fused(%arg0: !torch.vtensor<[3,2],f32>, %arg1: !torch.vtensor<[3,2],f32>, %arg2: !torch.vtensor<[1,2],f32>) -> (!torch.vtensor<[3,1],f32>, !torch.vtensor<[3,1],f32>, !torch.vtensor<[3,1],f32>) {
+  %none = torch.constant.none
+  %w = torch.vtensor.literal(dense<1.0> : tensor<1x2xf32>) : !torch.vtensor<[1,2],f32>
+  %0 = torch.aten.linear %arg0, %w, %none : !torch.vtensor<[3,2],f32>, !torch.vtensor<[1,2],f32>, !torch.none -> !torch.vtensor<[3,1],f32>
+  %1 = torch.aten.linear %arg1, %w, %none : !torch.vtensor<[3,2],f32>, !torch.vtensor<[1,2],f32>, !torch.none -> !torch.vtensor<[3,1],f32>
+  %2 = torch.aten.linear %arg0, %arg2, %none : !torch.vtensor<[3,2],f32>, !torch.vtensor<[1,2],f32>, !torch.none -> !torch.vtensor<[3,1],f32>
+  return %0, %1, %2 : !torch.vtensor<[3,1],f32>, !torch.vtensor<[3,1],f32>, !torch.vtensor<[3,1],f32>
+}
@@ -0,0 +1,48 @@
+// RUN: torch-mlir-opt -torch-inline-abstract-interp-calculations -split-input-file %s | FileCheck %s
+
+// CHECK-NOT: func.func private @__torch_mlir_shape_fn.aten.tanh
+// CHECK-NOT: func.func private @__torch__.torch.jit._shape_functions.unary
+// CHECK-LABEL:   func.func @basic(
+// CHECK-SAME:                     %[[ARG:.*]]: !torch.vtensor) -> !torch.vtensor {
+// CHECK:           %[[RESULT:.*]] = torch.shape.calculate {
+// CHECK:             %[[TANH:.*]] = torch.aten.tanh %[[ARG]]
+// CHECK:             torch.shape.calculate.yield %[[TANH]]
+// CHECK:           } shapes {
+// CHECK-NOT:         call
+// CHECK:             %[[SIZE:.*]] = torch.aten.size %[[ARG]]
+// CHECK:             torch.shape.calculate.yield.shapes %[[SIZE]]
+// CHECK:           } : !torch.vtensor
+// CHECK:           return %[[RESULT]] : !torch.vtensor
+func.func private @__torch__.torch.jit._shape_functions.unary(%arg0: !torch.list<int>) -> !torch.list<int> {
+  return %arg0 : !torch.list<int>
+}
+func.func private @__torch_mlir_shape_fn.aten.tanh(%arg0: !torch.list<int>) -> !torch.list<int> {
+  %0 = call @__torch__.torch.jit._shape_functions.unary(%arg0) : (!torch.list<int>) -> !torch.list<int>
+  return %0 : !torch.list<int>
+}
+func.func @basic(%arg0: !torch.vtensor) -> !torch.vtensor {
+  %0 = torch.shape.calculate {
+    %1 = torch.aten.tanh %arg0 : !torch.vtensor -> !torch.vtensor
+    torch.shape.calculate.yield %1 : !torch.vtensor
+  } shapes {
+    %1 = torch.aten.size %arg0 : !torch.vtensor -> !torch.list<int>
+    %2 = func.call @__torch_mlir_shape_fn.aten.tanh(%1) : (!torch.list<int>) -> !torch.list<int>
+    torch.shape.calculate.yield.shapes %2 : !torch.list<int>
+  } : !torch.vtensor
+  return %0 : !torch.vtensor
+}
+
+// -----
+
+// Calls outside of calculation regions are not inlined.
+
+// CHECK-LABEL:   func.func private @callee(
+// CHECK-LABEL:   func.func @caller(
+// CHECK:           call @callee
+func.func private @callee(%arg0: !torch.vtensor) -> !torch.vtensor {
+  return %arg0 : !torch.vtensor
+}
+func.func @caller(%arg0: !torch.vtensor) -> !torch.vtensor {
+  %0 = call @callee(%arg0) : (!torch.vtensor) -> !torch.vtensor
+  return %0 : !torch.vtensor
+}
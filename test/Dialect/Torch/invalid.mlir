@@ -115,6 +115,11 @@ func.func private @f(%arg0: i32 {torch.type_bound = i32})
 
 // -----
 
+// expected-error @+1 {{'torch.sharding' must be StringAttr}}
+func.func private @f(%arg0: !torch.vtensor<[2],f32> {torch.sharding = 1})
+
+// -----
+
 func.func @derefine(%arg0: !torch.optional<tensor>) -> !torch.tensor {
   // expected-error @+1 {{operand type '!torch.optional<tensor>' and result type '!torch.tensor' are cast incompatible}}
   %0 = torch.derefine %arg0 : !torch.optional<tensor> to !torch.tensor
@@ -136,6 +141,17 @@ func.func private @tensor.invalid_dtype() -> !torch.tensor<*,tuple<>>
 
 // -----
 
+// expected-error @+1 {{for !torch.tensor type, expected a #sparse_tensor.encoding}}
+func.func private @tensor.invalid_sparsity() -> !torch.vtensor<[4],f32,unit>
+
+// -----
+
+#CSR = #sparse_tensor.encoding<{ dimLevelType = [ "dense", "compressed" ] }>
+// expected-error @+1 {{does not match the sizes of the !torch.tensor type}}
+func.func private @tensor.sparsity_rank_mismatch() -> !torch.vtensor<[4],f32,#CSR>
+
+// -----
+
 func.func @torch.tensor() {
   // Incompatible shape.
   // expected-error@+1 {{must be Multi-dimensional array modeling Torch's Tensor type, but got}}
@@ -281,3 +297,11 @@ func.func @torch.tensor_static_info_cast$dtype_mismatch(%arg0: !torch.vtensor<*,
   %0 = torch.tensor_static_info_cast %arg0 : !torch.vtensor<*,f32> to !torch.vtensor<*,f64>
   return %0 : !torch.vtensor<*,f64>
 }
+
+// -----
+
+func.func @torch.vtensor.external$unknown_size() -> !torch.vtensor<[?],f32> {
+  // expected-error@+1 {{'torch.vtensor.external' op result type must have known sizes and dtype}}
+  %0 = torch.vtensor.external "weight" : !torch.vtensor<[?],f32>
+  return %0 : !torch.vtensor<[?],f32>
+}
@@ -69,3 +69,21 @@ func.func @f(%arg0: !torch.bool, %arg1: !torch.vtensor<[],f32>, %arg2: !torch.vt
   }
   return %0 : !torch.vtensor<*,f32>
 }
+
+// -----
+
+// Global slots holding tensor state, initialized by literals, satisfy the
+// backend contract.
+
+torch.global_slot.module_initializer {
+  %0 = torch.vtensor.literal(dense<0.0> : tensor<4xf32>) : !torch.vtensor<[4],f32>
+  torch.initialize.global_slots [
+    @cache(%0 : !torch.vtensor<[4],f32>)
+  ]
+}
+torch.global_slot "private" @cache : !torch.vtensor<[4],f32>
+
+func.func @forward(%arg0: !torch.vtensor<[4],f32>) {
+  torch.global_slot.set @cache = %arg0 : !torch.vtensor<[4],f32>
+  return
+}
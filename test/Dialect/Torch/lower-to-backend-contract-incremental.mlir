@@ -0,0 +1,35 @@
+// RUN: torch-mlir-opt -pass-pipeline='builtin.module(torch-lower-to-backend-contract{incremental=true})' -split-input-file %s | FileCheck %s
+
+// CHECK-LABEL: func.func @needs_decomposition(
+// CHECK-SAME:      %[[ARG:.*]]: !torch.vtensor<[?],f32>) -> !torch.vtensor<[?],f32> {
+// CHECK:         %[[MUL:.*]] = torch.aten.mul.Tensor %[[ARG]], %[[ARG]]
+// CHECK:         return %[[MUL]]
+func.func @needs_decomposition(%arg0: !torch.vtensor<[?],f32>) -> !torch.vtensor<[?],f32> {
+  %0 = torch.aten.square %arg0 : !torch.vtensor<[?],f32> -> !torch.vtensor<[?],f32>
+  return %0 : !torch.vtensor<[?],f32>
+}
+
+// CHECK-LABEL: func.func @already_satisfied(
+// CHECK:         torch.aten.tanh
+func.func @already_satisfied(%arg0: !torch.vtensor<[2],f32>) -> !torch.vtensor<[2],f32> {
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[2],f32> -> !torch.vtensor<[2],f32>
+  return %0 : !torch.vtensor<[2],f32>
+}
+
+// -----
+
+// Functions that reference each other are simplified together.
+
+// CHECK-LABEL: func.func @caller(
+// CHECK:         call @callee
+func.func @caller(%arg0: !torch.vtensor<[2],f32>) -> !torch.vtensor<[2],f32> {
+  %0 = call @callee(%arg0) : (!torch.vtensor<[2],f32>) -> !torch.vtensor<[2],f32>
+  return %0 : !torch.vtensor<[2],f32>
+}
+
+// CHECK-LABEL: func.func @callee(
+// CHECK:         torch.aten.mul.Tensor
+func.func @callee(%arg0: !torch.vtensor<[2],f32>) -> !torch.vtensor<[2],f32> {
+  %0 = torch.aten.square %arg0 : !torch.vtensor<[2],f32> -> !torch.vtensor<[2],f32>
+  return %0 : !torch.vtensor<[2],f32>
+}
@@ -0,0 +1,11 @@
+// RUN: torch-mlir-opt -pass-pipeline='builtin.module(torch-lower-to-backend-contract{report-iterations=true})' %s 2>&1 | FileCheck %s
+
+// CHECK: remark: iteration 1 of the simplification pipeline took {{[0-9]+}} us; 0 ops do not yet satisfy the backend contract
+// CHECK-NOT: remark: iteration 2
+// CHECK: remark: 'torch.aten.square' ops satisfy the backend contract after iteration 1
+// CHECK-LABEL: func.func @needs_decomposition(
+// CHECK:         torch.aten.mul.Tensor
+func.func @needs_decomposition(%arg0: !torch.vtensor<[?],f32>) -> !torch.vtensor<[?],f32> {
+  %0 = torch.aten.square %arg0 : !torch.vtensor<[?],f32> -> !torch.vtensor<[?],f32>
+  return %0 : !torch.vtensor<[?],f32>
+}
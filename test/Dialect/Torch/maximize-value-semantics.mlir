@@ -108,6 +108,24 @@ func.func @control_flow$no_overwrites(%arg0: !torch.vtensor, %arg1: !torch.vtens
   return %new_tensor : !torch.vtensor
 }
 
+// CHECK-LABEL:   func.func @control_flow$viewlike_two_inputs(
+// CHECK-SAME:                                                %[[ARG:.*]]: !torch.vtensor, %[[COND:.*]]: !torch.bool) -> !torch.vtensor {
+// CHECK:             %[[EXPAND_AS:.*]] = torch.aten.expand_as %[[ARG]], %[[ARG]] : !torch.vtensor, !torch.vtensor -> !torch.vtensor
+// CHECK:             torch.prim.If.yield %[[EXPAND_AS]] : !torch.vtensor
+// CHECK:             torch.prim.If.yield %[[ARG]] : !torch.vtensor
+func.func @control_flow$viewlike_two_inputs(%arg0: !torch.vtensor, %cond: !torch.bool) -> (!torch.vtensor) {
+  %tensor = torch.copy.to_tensor %arg0 : !torch.tensor
+  %new_tensor = torch.prim.If %cond -> (!torch.vtensor) {
+    %view = torch.aten.expand_as %tensor, %tensor : !torch.tensor, !torch.tensor -> !torch.tensor
+    %vtensor0 = torch.copy.to_vtensor %view : !torch.vtensor
+    torch.prim.If.yield %vtensor0 : !torch.vtensor
+  } else {
+    %vtensor1 = torch.copy.to_vtensor %tensor : !torch.vtensor
+    torch.prim.If.yield %vtensor1 : !torch.vtensor
+  }
+  return %new_tensor : !torch.vtensor
+}
+
 // We don't yet handle nontrivial cases involving control flow.
 // CHECK-LABEL:   func.func @unimplemented_control_flow(
 // CHECK:           torch.copy.to_vtensor
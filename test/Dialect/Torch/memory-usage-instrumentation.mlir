@@ -0,0 +1,14 @@
+// RUN: torch-mlir-opt %s -symbol-dce -canonicalize -torch-report-pass-memory-usage -torch-large-attribute-count=2 -mlir-disable-threading 2>&1 | FileCheck %s
+
+// CHECK: remark: memory usage after 'symbol-dce': rss {{[0-9.]+}} MiB ({{[-+][0-9.]+}} MiB), peak rss {{[0-9.]+}} MiB (+{{[0-9.]+}} MiB), 0 new attributes with 0.0 MiB of elements{{$}}
+// The folded sum and the attribute dictionary of its constant are new.
+// CHECK: remark: memory usage after 'canonicalize': rss {{[0-9.]+}} MiB ({{[-+][0-9.]+}} MiB), peak rss {{[0-9.]+}} MiB (+{{[0-9.]+}} MiB), 2 new attributes with 0.0 MiB of elements; the pass created many attributes
+// CHECK-LABEL: func.func @forward() -> !torch.int {
+// CHECK:         %[[INT3:.*]] = torch.constant.int 3
+// CHECK:         return %[[INT3]] : !torch.int
+func.func @forward() -> !torch.int {
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %0 = torch.aten.add.int %int1, %int2 : !torch.int, !torch.int -> !torch.int
+  return %0 : !torch.int
+}
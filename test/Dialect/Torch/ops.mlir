@@ -1,4 +1,5 @@
 // RUN: torch-mlir-opt %s | torch-mlir-opt | FileCheck %s
+// RUN: torch-mlir-opt %s -emit-bytecode | torch-mlir-opt | FileCheck %s
 
 // CHECK-LABEL: func.func @torch.operator(
 func.func @torch.operator(%arg0: !torch.tensor, %arg1: !torch.tensor) -> !torch.tensor {
@@ -27,6 +28,9 @@ func.func private @tensor.ranked() -> !torch.tensor<[?,?,?],unk>
 func.func private @tensor.some_sizes_known() -> !torch.tensor<[?,2,?,4],unk>
 // CHECK: @tensor.fully_determined() -> !torch.vtensor<[1,2,3,4],f32>
 func.func private @tensor.fully_determined() -> !torch.vtensor<[1,2,3,4],f32>
+#COO = #sparse_tensor.encoding<{ dimLevelType = [ "compressed-nu", "singleton" ] }>
+// CHECK: @tensor.sparse() -> !torch.vtensor<[4,8],f32,#{{.*}}>
+func.func private @tensor.sparse() -> !torch.vtensor<[4,8],f32,#COO>
 
 // CHECK: @tuple.empty() -> !torch.tuple<>
 func.func private @tuple.empty() -> !torch.tuple<>
@@ -54,6 +58,15 @@ func.func @torch.tensor.literal() {
   return
 }
 
+// CHECK-LABEL:   func.func @torch.tensor.external() {
+func.func @torch.tensor.external() {
+  // CHECK: torch.tensor.external "l1.weight" : !torch.tensor<[3,2],f32>
+  %0 = torch.tensor.external "l1.weight" : !torch.tensor<[3,2],f32>
+  // CHECK: torch.vtensor.external "l1.bias" : !torch.vtensor<[3],f32>
+  %1 = torch.vtensor.external "l1.bias" : !torch.vtensor<[3],f32>
+  return
+}
+
 // CHECK-LABEL:   func.func @torch.vtensor.literal() {
 func.func @torch.vtensor.literal() {
   // CHECK: torch.vtensor.literal(dense<4.200000e+01> : tensor<3x2xf32>) : !torch.vtensor<[3,2],f32>
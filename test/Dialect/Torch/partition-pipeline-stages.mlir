@@ -0,0 +1,56 @@
+// RUN: torch-mlir-opt -torch-partition-pipeline-stages -split-input-file %s | FileCheck %s
+
+// CHECK-LABEL:   func.func @forward(
+// CHECK-SAME:                       %[[ARG0:.*]]: !torch.vtensor<[64,64],f32>,
+// CHECK-SAME:                       %[[ARG1:.*]]: !torch.vtensor<[64,64],f32>) -> !torch.vtensor<[64,64],f32> {
+// CHECK:           %[[STAGE0:.*]] = call @forward_stage0(%[[ARG0]], %[[ARG1]]) {torch.pipeline_stage = 0 : i64} : (!torch.vtensor<[64,64],f32>, !torch.vtensor<[64,64],f32>) -> !torch.vtensor<[64,64],f32>
+// CHECK:           %[[STAGE1:.*]] = call @forward_stage1(%[[STAGE0]], %[[ARG1]]) {torch.pipeline_stage = 1 : i64} : (!torch.vtensor<[64,64],f32>, !torch.vtensor<[64,64],f32>) -> !torch.vtensor<[64,64],f32>
+// CHECK:           return %[[STAGE1]] : !torch.vtensor<[64,64],f32>
+// CHECK:         }
+// CHECK-LABEL:   func.func private @forward_stage0(
+// CHECK-SAME:                                      %[[INPUT:.*]]: !torch.vtensor<[64,64],f32>,
+// CHECK-SAME:                                      %[[WEIGHT:.*]]: !torch.vtensor<[64,64],f32>) -> !torch.vtensor<[64,64],f32> attributes {torch.pipeline_stage = 0 : i64} {
+// CHECK:           %[[MM:.*]] = torch.aten.mm %[[INPUT]], %[[WEIGHT]]
+// CHECK:           %[[TANH:.*]] = torch.aten.tanh %[[MM]]
+// CHECK:           return %[[TANH]] : !torch.vtensor<[64,64],f32>
+// CHECK:         }
+// CHECK-LABEL:   func.func private @forward_stage1(
+// CHECK-SAME:                                      %[[INPUT:.*]]: !torch.vtensor<[64,64],f32>,
+// CHECK-SAME:                                      %[[WEIGHT:.*]]: !torch.vtensor<[64,64],f32>) -> !torch.vtensor<[64,64],f32> attributes {torch.pipeline_stage = 1 : i64} {
+// CHECK:           %[[MM:.*]] = torch.aten.mm %[[INPUT]], %[[WEIGHT]]
+// CHECK:           %[[TANH:.*]] = torch.aten.tanh %[[MM]]
+// CHECK:           return %[[TANH]] : !torch.vtensor<[64,64],f32>
+func.func @forward(%arg0: !torch.vtensor<[64,64],f32>, %arg1: !torch.vtensor<[64,64],f32>) -> !torch.vtensor<[64,64],f32> {
+  %0 = torch.aten.mm %arg0, %arg1 : !torch.vtensor<[64,64],f32>, !torch.vtensor<[64,64],f32> -> !torch.vtensor<[64,64],f32>
+  %1 = torch.aten.tanh %0 : !torch.vtensor<[64,64],f32> -> !torch.vtensor<[64,64],f32>
+  %2 = torch.aten.mm %1, %arg1 : !torch.vtensor<[64,64],f32>, !torch.vtensor<[64,64],f32> -> !torch.vtensor<[64,64],f32>
+  %3 = torch.aten.tanh %2 : !torch.vtensor<[64,64],f32> -> !torch.vtensor<[64,64],f32>
+  return %3 : !torch.vtensor<[64,64],f32>
+}
+
+// -----
+
+// Literals and constants are copied into the stages using them.
+// CHECK-LABEL:   func.func @copies_constants(
+// CHECK-NOT:       torch.vtensor.literal
+// CHECK:           call @copies_constants_stage0
+// CHECK:           call @copies_constants_stage1
+// CHECK-LABEL:   func.func private @copies_constants_stage0(
+// CHECK:           %[[WEIGHT:.*]] = torch.vtensor.literal
+// CHECK:           torch.aten.mm %{{.*}}, %[[WEIGHT]]
+// CHECK-LABEL:   func.func private @copies_constants_stage1(
+// CHECK-SAME:                                               %[[INPUT:.*]]: !torch.vtensor<[4,4],f32>) -> !torch.vtensor<[16],f32>
+// CHECK:           %[[WEIGHT:.*]] = torch.vtensor.literal
+// CHECK:           %[[MM:.*]] = torch.aten.mm %[[INPUT]], %[[WEIGHT]]
+// CHECK:           %[[INT16:.*]] = torch.constant.int 16
+// CHECK:           %[[SIZE:.*]] = torch.prim.ListConstruct %[[INT16]]
+// CHECK:           torch.aten.view %[[MM]], %[[SIZE]]
+func.func @copies_constants(%arg0: !torch.vtensor<[4,4],f32>) -> !torch.vtensor<[16],f32> {
+  %int16 = torch.constant.int 16
+  %0 = torch.vtensor.literal(dense<1.0> : tensor<4x4xf32>) : !torch.vtensor<[4,4],f32>
+  %1 = torch.prim.ListConstruct %int16 : (!torch.int) -> !torch.list<int>
+  %2 = torch.aten.mm %arg0, %0 : !torch.vtensor<[4,4],f32>, !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  %3 = torch.aten.mm %2, %0 : !torch.vtensor<[4,4],f32>, !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  %4 = torch.aten.view %3, %1 : !torch.vtensor<[4,4],f32>, !torch.list<int> -> !torch.vtensor<[16],f32>
+  return %4 : !torch.vtensor<[16],f32>
+}
@@ -0,0 +1,87 @@
+// RUN: torch-mlir-opt -torch-promote-mutable-global-slots -split-input-file %s | FileCheck %s
+
+// CHECK: torch.global_slot "private" @cache : !torch.vtensor<[4],f32>
+torch.global_slot "private" @cache : !torch.tensor
+
+// CHECK-LABEL:   torch.global_slot.module_initializer {
+// CHECK:           %[[INIT:.*]] = torch.vtensor.literal(dense<0.000000e+00> : tensor<4xf32>) : !torch.vtensor<[4],f32>
+// CHECK-NOT:       torch.tensor.literal
+// CHECK:           torch.initialize.global_slots [
+// CHECK-NEXT:        @cache(%[[INIT]] : !torch.vtensor<[4],f32>)
+// CHECK-NEXT:      ]
+torch.global_slot.module_initializer {
+  %0 = torch.tensor.literal(dense<0.0> : tensor<4xf32>) : !torch.tensor
+  torch.initialize.global_slots [
+    @cache(%0 : !torch.tensor)
+  ]
+}
+
+// CHECK-LABEL:   func.func @forward(
+// CHECK-SAME:                       %[[ARG:.*]]: !torch.vtensor<[4],f32>) -> !torch.tensor {
+// CHECK:           %[[VALUE:.*]] = torch.global_slot.get @cache : !torch.vtensor<[4],f32>
+// CHECK:           %[[TENSOR:.*]] = torch.copy.to_tensor %[[VALUE]] : !torch.tensor<[4],f32>
+// CHECK:           %[[CAST:.*]] = torch.tensor_static_info_cast %[[TENSOR]] : !torch.tensor<[4],f32> to !torch.tensor
+// CHECK:           torch.overwrite.tensor.contents %[[ARG]] overwrites %[[CAST]] : !torch.vtensor<[4],f32>, !torch.tensor
+// CHECK-NOT:       torch.global_slot.get
+// CHECK:           %[[NEW_VALUE:.*]] = torch.copy.to_vtensor %[[TENSOR]] : !torch.vtensor<[4],f32>
+// CHECK:           torch.global_slot.set @cache = %[[NEW_VALUE]] : !torch.vtensor<[4],f32>
+// CHECK:           return %[[CAST]] : !torch.tensor
+func.func @forward(%arg0: !torch.vtensor<[4],f32>) -> !torch.tensor {
+  %0 = torch.global_slot.get @cache : !torch.tensor
+  torch.overwrite.tensor.contents %arg0 overwrites %0 : !torch.vtensor<[4],f32>, !torch.tensor
+  %1 = torch.global_slot.get @cache : !torch.tensor
+  return %1 : !torch.tensor
+}
+
+// -----
+
+// Slots read by functions with calls are left alone, since the callees could
+// also access them.
+
+// CHECK: torch.global_slot "private" @cache : !torch.tensor
+torch.global_slot "private" @cache : !torch.tensor
+
+torch.global_slot.module_initializer {
+  %0 = torch.tensor.literal(dense<0.0> : tensor<4xf32>) : !torch.tensor
+  torch.initialize.global_slots [
+    @cache(%0 : !torch.tensor)
+  ]
+}
+
+func.func private @callee()
+
+// CHECK-LABEL:   func.func @forward() -> !torch.tensor {
+// CHECK-NEXT:      %[[CACHE:.*]] = torch.global_slot.get @cache : !torch.tensor
+// CHECK-NEXT:      call @callee() : () -> ()
+// CHECK-NEXT:      return %[[CACHE]] : !torch.tensor
+func.func @forward() -> !torch.tensor {
+  %0 = torch.global_slot.get @cache : !torch.tensor
+  call @callee() : () -> ()
+  return %0 : !torch.tensor
+}
+
+// -----
+
+// Public slots and slots that are set are left alone.
+
+// CHECK: torch.global_slot @public : !torch.tensor
+// CHECK: torch.global_slot "private" @set : !torch.tensor
+torch.global_slot @public : !torch.tensor
+torch.global_slot "private" @set : !torch.tensor
+
+torch.global_slot.module_initializer {
+  %0 = torch.tensor.literal(dense<0.0> : tensor<4xf32>) : !torch.tensor
+  %1 = torch.tensor.literal(dense<0.0> : tensor<4xf32>) : !torch.tensor
+  torch.initialize.global_slots [
+    @public(%0 : !torch.tensor)
+    @set(%1 : !torch.tensor)
+  ]
+}
+
+// CHECK-LABEL:   func.func @forward(
+// CHECK-NOT:       torch.copy.to_tensor
+func.func @forward(%arg0: !torch.tensor) -> !torch.tensor {
+  %0 = torch.global_slot.get @public : !torch.tensor
+  torch.global_slot.set @set = %arg0 : !torch.tensor
+  return %0 : !torch.tensor
+}
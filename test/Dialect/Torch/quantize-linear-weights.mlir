@@ -0,0 +1,54 @@
+// RUN: torch-mlir-opt -torch-quantize-linear-weights="bits=4 group-size=2" -split-input-file %s | FileCheck %s
+// RUN: torch-mlir-opt -torch-quantize-linear-weights="bits=8 group-size=2" -split-input-file %s | FileCheck %s --check-prefix=INT8
+
+// CHECK-LABEL:   func.func @linear(
+// CHECK-SAME:                      %[[INPUT:.*]]: !torch.vtensor<[2,4],f32>) -> !torch.vtensor<[2,1],f32> {
+// CHECK:           %[[NONE:.*]] = torch.constant.none
+// CHECK:           %[[WEIGHT:.*]] = torch.vtensor.literal(dense<{{\[\[}}-41, 39]]> : tensor<1x2xsi8>) : !torch.vtensor<[1,2],si8>
+// CHECK:           %[[SCALES:.*]] = torch.vtensor.literal(dense<{{\[\[}}1.000000e+00, 2.000000e-01]]> : tensor<1x2xf32>) : !torch.vtensor<[1,2],f32>
+// CHECK-NOT:       torch.vtensor.literal
+// CHECK:           %[[BITS:.*]] = torch.constant.int 4
+// CHECK:           %[[GROUP_SIZE:.*]] = torch.constant.int 2
+// CHECK:           %[[RESULT:.*]] = torch.group_quantized.linear %[[INPUT]], %[[WEIGHT]], %[[SCALES]], %[[BITS]], %[[GROUP_SIZE]], %[[NONE]] : !torch.vtensor<[2,4],f32>, !torch.vtensor<[1,2],si8>, !torch.vtensor<[1,2],f32>, !torch.none -> !torch.vtensor<[2,1],f32>
+// CHECK:           return %[[RESULT]] : !torch.vtensor<[2,1],f32>
+// INT8-LABEL:    func.func @linear(
+// INT8:            torch.vtensor.literal(dense<{{\[\[}}127, -54, 127, 36]]> : tensor<1x4xsi8>) : !torch.vtensor<[1,4],si8>
+// INT8:            torch.vtensor.literal({{.*}} : tensor<1x2xf32>) : !torch.vtensor<[1,2],f32>
+// INT8:            torch.constant.int 8
+// INT8:            torch.group_quantized.linear
+func.func @linear(%arg0: !torch.vtensor<[2,4],f32>) -> !torch.vtensor<[2,1],f32> {
+  %none = torch.constant.none
+  %0 = torch.vtensor.literal(dense<[[7.0, -3.0, 1.4, 0.4]]> : tensor<1x4xf32>) : !torch.vtensor<[1,4],f32>
+  %1 = torch.aten.linear %arg0, %0, %none : !torch.vtensor<[2,4],f32>, !torch.vtensor<[1,4],f32>, !torch.none -> !torch.vtensor<[2,1],f32>
+  return %1 : !torch.vtensor<[2,1],f32>
+}
+
+// -----
+
+// A weight shared by several linear ops is quantized once. The bias is kept.
+// CHECK-LABEL:   func.func @shared_weight(
+// CHECK-SAME:                             %[[INPUT:.*]]: !torch.vtensor<[2,2],bf16>,
+// CHECK-SAME:                             %[[BIAS:.*]]: !torch.vtensor<[3],bf16>) -> (!torch.vtensor<[2,3],bf16>, !torch.vtensor<[2,3],bf16>) {
+// CHECK:           %[[WEIGHT:.*]] = torch.vtensor.literal(dense<{{\[\[}}-105], [0], [73]]> : tensor<3x1xsi8>) : !torch.vtensor<[3,1],si8>
+// CHECK:           %[[SCALES:.*]] = torch.vtensor.literal({{.*}} : tensor<3x1xbf16>) : !torch.vtensor<[3,1],bf16>
+// CHECK:           torch.group_quantized.linear %[[INPUT]], %[[WEIGHT]], %[[SCALES]], %{{.*}}, %{{.*}}, %[[BIAS]]
+// CHECK:           torch.group_quantized.linear %[[INPUT]], %[[WEIGHT]], %[[SCALES]]
+func.func @shared_weight(%arg0: !torch.vtensor<[2,2],bf16>, %arg1: !torch.vtensor<[3],bf16>) -> (!torch.vtensor<[2,3],bf16>, !torch.vtensor<[2,3],bf16>) {
+  %none = torch.constant.none
+  %0 = torch.vtensor.literal(dense<[[1.0, -1.0], [0.0, 0.0], [-2.0, 1.0]]> : tensor<3x2xbf16>) : !torch.vtensor<[3,2],bf16>
+  %1 = torch.aten.linear %arg0, %0, %arg1 : !torch.vtensor<[2,2],bf16>, !torch.vtensor<[3,2],bf16>, !torch.vtensor<[3],bf16> -> !torch.vtensor<[2,3],bf16>
+  %2 = torch.aten.linear %arg0, %0, %none : !torch.vtensor<[2,2],bf16>, !torch.vtensor<[3,2],bf16>, !torch.none -> !torch.vtensor<[2,3],bf16>
+  return %1, %2 : !torch.vtensor<[2,3],bf16>, !torch.vtensor<[2,3],bf16>
+}
+
+// -----
+
+// Rows that aren't a multiple of the group size are left as is.
+// CHECK-LABEL:   func.func @partial_group(
+// CHECK:           torch.aten.linear
+func.func @partial_group(%arg0: !torch.vtensor<[2,3],f32>) -> !torch.vtensor<[2,1],f32> {
+  %none = torch.constant.none
+  %0 = torch.vtensor.literal(dense<[[1.0, 2.0, 3.0]]> : tensor<1x3xf32>) : !torch.vtensor<[1,3],f32>
+  %1 = torch.aten.linear %arg0, %0, %none : !torch.vtensor<[2,3],f32>, !torch.vtensor<[1,3],f32>, !torch.none -> !torch.vtensor<[2,1],f32>
+  return %1 : !torch.vtensor<[2,1],f32>
+}
@@ -0,0 +1,308 @@
+// RUN: torch-mlir-opt -torch-recompose-complex-ops -split-input-file %s | FileCheck %s
+
+// CHECK-LABEL: func.func @convolution_batch_norm(
+// CHECK-SAME:      %[[INPUT:.*]]: !torch.vtensor<[1,3,8,8],f32>, %[[WEIGHT:.*]]: !torch.vtensor<[4,3,3,3],f32>, %[[BIAS:.*]]: !torch.vtensor<[4],f32>,
+// CHECK-SAME:      %[[GAMMA:.*]]: !torch.vtensor<[4],f32>, %[[BETA:.*]]: !torch.vtensor<[4],f32>, %[[MEAN:.*]]: !torch.vtensor<[4],f32>, %[[VAR:.*]]: !torch.vtensor<[4],f32>)
+// CHECK:         %[[VAR_EPS:.*]] = torch.aten.add.Scalar %[[VAR]], %{{.*}}, %{{.*}}
+// CHECK:         %[[RSTD:.*]] = torch.aten.rsqrt %[[VAR_EPS]]
+// CHECK:         %[[SCALE:.*]] = torch.aten.mul.Tensor %[[RSTD]], %[[GAMMA]]
+// CHECK:         %[[T0:.*]] = torch.aten.transpose.int %[[WEIGHT]], %{{.*}}, %{{.*}}
+// CHECK:         %[[T1:.*]] = torch.aten.mul.Tensor %[[T0]], %[[SCALE]]
+// CHECK:         %[[NEW_WEIGHT:.*]] = torch.aten.transpose.int %[[T1]], %{{.*}}, %{{.*}} : !torch.vtensor<*,f32>, !torch.int, !torch.int -> !torch.vtensor<[4,3,3,3],f32>
+// CHECK:         %[[CENTERED:.*]] = torch.aten.sub.Tensor %[[BIAS]], %[[MEAN]]
+// CHECK:         %[[SCALED:.*]] = torch.aten.mul.Tensor %[[CENTERED]], %[[SCALE]]
+// CHECK:         %[[NEW_BIAS:.*]] = torch.aten.add.Tensor %[[SCALED]], %[[BETA]]
+// CHECK:         %[[CONV:.*]] = torch.aten.convolution %[[INPUT]], %[[NEW_WEIGHT]], %[[NEW_BIAS]]
+// CHECK-NOT:     torch.aten.batch_norm
+// CHECK:         return %[[CONV]]
+func.func @convolution_batch_norm(%input: !torch.vtensor<[1,3,8,8],f32>, %weight: !torch.vtensor<[4,3,3,3],f32>, %bias: !torch.vtensor<[4],f32>, %gamma: !torch.vtensor<[4],f32>, %beta: !torch.vtensor<[4],f32>, %mean: !torch.vtensor<[4],f32>, %var: !torch.vtensor<[4],f32>) -> !torch.vtensor<[1,4,6,6],f32> {
+  %false = torch.constant.bool false
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %float1.000000e-01 = torch.constant.float 1.000000e-01
+  %float1.000000e-05 = torch.constant.float 1.000000e-05
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct : () -> !torch.list<int>
+  %3 = torch.aten.convolution %input, %weight, %bias, %0, %1, %0, %false, %2, %int1 : !torch.vtensor<[1,3,8,8],f32>, !torch.vtensor<[4,3,3,3],f32>, !torch.vtensor<[4],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,4,6,6],f32>
+  %4 = torch.aten.batch_norm %3, %gamma, %beta, %mean, %var, %false, %float1.000000e-01, %float1.000000e-05, %false : !torch.vtensor<[1,4,6,6],f32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.bool, !torch.float, !torch.float, !torch.bool -> !torch.vtensor<[1,4,6,6],f32>
+  return %4 : !torch.vtensor<[1,4,6,6],f32>
+}
+
+// -----
+
+// A batch_norm in training mode computes its own statistics and is kept.
+// CHECK-LABEL: func.func @convolution_batch_norm_training(
+// CHECK:         torch.aten.convolution
+// CHECK:         torch.aten.batch_norm
+func.func @convolution_batch_norm_training(%input: !torch.vtensor<[1,3,8,8],f32>, %weight: !torch.vtensor<[4,3,3,3],f32>, %gamma: !torch.vtensor<[4],f32>, %beta: !torch.vtensor<[4],f32>, %mean: !torch.vtensor<[4],f32>, %var: !torch.vtensor<[4],f32>) -> !torch.vtensor<[1,4,6,6],f32> {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %true = torch.constant.bool true
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %float1.000000e-01 = torch.constant.float 1.000000e-01
+  %float1.000000e-05 = torch.constant.float 1.000000e-05
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.aten.conv2d %input, %weight, %none, %0, %1, %0, %int1 : !torch.vtensor<[1,3,8,8],f32>, !torch.vtensor<[4,3,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int -> !torch.vtensor<[1,4,6,6],f32>
+  %3 = torch.aten.batch_norm %2, %gamma, %beta, %mean, %var, %true, %float1.000000e-01, %float1.000000e-05, %false : !torch.vtensor<[1,4,6,6],f32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.bool, !torch.float, !torch.float, !torch.bool -> !torch.vtensor<[1,4,6,6],f32>
+  return %3 : !torch.vtensor<[1,4,6,6],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @slice_copy_(
+// CHECK-SAME:      %[[CACHE:.*]]: !torch.tensor<[4,16,8],f32>, %[[UPDATE:.*]]: !torch.tensor<[4,1,8],f32>, %[[POS:.*]]: !torch.int)
+// CHECK:         %[[END:.*]] = torch.aten.add.int %[[POS]], %{{.*}}
+// CHECK:         %[[SLICE:.*]] = torch.aten.slice.Tensor %[[CACHE]], %{{.*}}, %[[POS]], %[[END]], %{{.*}}
+// CHECK:         %[[SCATTER:.*]] = torch.aten.slice_scatter %[[CACHE]], %[[UPDATE]], %{{.*}}, %[[POS]], %[[END]], %{{.*}} : !torch.tensor<[4,16,8],f32>, !torch.tensor<[4,1,8],f32>, !torch.int, !torch.int, !torch.int, !torch.int -> !torch.tensor<[4,16,8],f32>
+// CHECK:         %[[VALUE:.*]] = torch.copy.to_vtensor %[[SCATTER]] : !torch.vtensor<[4,16,8],f32>
+// CHECK:         torch.overwrite.tensor.contents %[[VALUE]] overwrites %[[CACHE]] : !torch.vtensor<[4,16,8],f32>, !torch.tensor<[4,16,8],f32>
+// CHECK-NOT:     torch.aten.copy_
+// CHECK-NOT:     torch.aten._index_put_impl_
+func.func @slice_copy_(%cache: !torch.tensor<[4,16,8],f32>, %update: !torch.tensor<[4,1,8],f32>, %pos: !torch.int) {
+  %false = torch.constant.bool false
+  %int1 = torch.constant.int 1
+  %end = torch.aten.add.int %pos, %int1 : !torch.int, !torch.int -> !torch.int
+  %0 = torch.aten.slice.Tensor %cache, %int1, %pos, %end, %int1 : !torch.tensor<[4,16,8],f32>, !torch.int, !torch.int, !torch.int, !torch.int -> !torch.tensor<[4,1,8],f32>
+  %1 = torch.aten.copy_ %0, %update, %false : !torch.tensor<[4,1,8],f32>, !torch.tensor<[4,1,8],f32>, !torch.bool -> !torch.tensor<[4,1,8],f32>
+  return
+}
+
+// -----
+
+// The src of the copy is converted to the dtype of the slice and broadcast to
+// its shape.
+// CHECK-LABEL: func.func @slice_copy_$broadcast(
+// CHECK-SAME:      %[[CACHE:.*]]: !torch.tensor<[4,16,8],f32>, %[[UPDATE:.*]]: !torch.tensor<[8],f16>)
+// CHECK:         %[[INT6:.*]] = torch.constant.int 6
+// CHECK:         %[[SLICE:.*]] = torch.aten.slice.Tensor %[[CACHE]]
+// CHECK:         %[[CONVERTED:.*]] = torch.aten.to.dtype %[[UPDATE]], %[[INT6]], %{{.*}}, %{{.*}}, %{{.*}} : !torch.tensor<[8],f16>, !torch.int, !torch.bool, !torch.bool, !torch.none -> !torch.tensor
+// CHECK:         %[[EXPANDED:.*]] = torch.aten.expand_as %[[CONVERTED]], %[[SLICE]] : !torch.tensor, !torch.tensor<[4,2,8],f32> -> !torch.tensor<[4,2,8],f32>
+// CHECK:         torch.aten.slice_scatter %[[CACHE]], %[[EXPANDED]]
+func.func @slice_copy_$broadcast(%cache: !torch.tensor<[4,16,8],f32>, %update: !torch.tensor<[8],f16>) {
+  %false = torch.constant.bool false
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %int4 = torch.constant.int 4
+  %0 = torch.aten.slice.Tensor %cache, %int1, %int2, %int4, %int1 : !torch.tensor<[4,16,8],f32>, !torch.int, !torch.int, !torch.int, !torch.int -> !torch.tensor<[4,2,8],f32>
+  %1 = torch.aten.copy_ %0, %update, %false : !torch.tensor<[4,2,8],f32>, !torch.tensor<[8],f16>, !torch.bool -> !torch.tensor<[4,2,8],f32>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func.func @gelu(
+// CHECK-SAME:      %[[X:.*]]: !torch.vtensor<[2,8],f32>) -> !torch.vtensor<[2,8],f32> {
+// CHECK:         %[[NONE:.*]] = torch.constant.str "none"
+// CHECK:         %[[GELU:.*]] = torch.aten.gelu %[[X]], %[[NONE]] : !torch.vtensor<[2,8],f32>, !torch.str -> !torch.vtensor<[2,8],f32>
+// CHECK:         return %[[GELU]]
+func.func @gelu(%x: !torch.vtensor<[2,8],f32>) -> !torch.vtensor<[2,8],f32> {
+  %half = torch.constant.float 5.000000e-01
+  %sqrt1_2 = torch.constant.float 0.70710678118654757
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.mul.Scalar %x, %half : !torch.vtensor<[2,8],f32>, !torch.float -> !torch.vtensor<[2,8],f32>
+  %1 = torch.aten.mul.Scalar %x, %sqrt1_2 : !torch.vtensor<[2,8],f32>, !torch.float -> !torch.vtensor<[2,8],f32>
+  %2 = torch.aten.erf %1 : !torch.vtensor<[2,8],f32> -> !torch.vtensor<[2,8],f32>
+  %3 = torch.aten.add.Scalar %2, %int1, %int1 : !torch.vtensor<[2,8],f32>, !torch.int, !torch.int -> !torch.vtensor<[2,8],f32>
+  %4 = torch.aten.mul.Tensor %0, %3 : !torch.vtensor<[2,8],f32>, !torch.vtensor<[2,8],f32> -> !torch.vtensor<[2,8],f32>
+  return %4 : !torch.vtensor<[2,8],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @gelu$div(
+// CHECK-SAME:      %[[X:.*]]: !torch.vtensor<[2,8],f32>) -> !torch.vtensor<[2,8],f32> {
+// CHECK:         %[[GELU:.*]] = torch.aten.gelu %[[X]]
+// CHECK:         return %[[GELU]]
+func.func @gelu$div(%x: !torch.vtensor<[2,8],f32>) -> !torch.vtensor<[2,8],f32> {
+  %half = torch.constant.float 5.000000e-01
+  %sqrt2 = torch.constant.float 1.4142135623730951
+  %float1 = torch.constant.float 1.000000e+00
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.div.Scalar %x, %sqrt2 : !torch.vtensor<[2,8],f32>, !torch.float -> !torch.vtensor<[2,8],f32>
+  %1 = torch.aten.erf %0 : !torch.vtensor<[2,8],f32> -> !torch.vtensor<[2,8],f32>
+  %2 = torch.aten.add.Scalar %1, %float1, %int1 : !torch.vtensor<[2,8],f32>, !torch.float, !torch.int -> !torch.vtensor<[2,8],f32>
+  %3 = torch.aten.mul.Scalar %2, %half : !torch.vtensor<[2,8],f32>, !torch.float -> !torch.vtensor<[2,8],f32>
+  %4 = torch.aten.mul.Tensor %x, %3 : !torch.vtensor<[2,8],f32>, !torch.vtensor<[2,8],f32> -> !torch.vtensor<[2,8],f32>
+  return %4 : !torch.vtensor<[2,8],f32>
+}
+
+// -----
+
+// The tanh approximation isn't recomposed into the exact gelu.
+// CHECK-LABEL: func.func @gelu$wrong_constant(
+// CHECK-NOT:     torch.aten.gelu
+func.func @gelu$wrong_constant(%x: !torch.vtensor<[2,8],f32>) -> !torch.vtensor<[2,8],f32> {
+  %half = torch.constant.float 5.000000e-01
+  %scale = torch.constant.float 0.79788456080286541
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.mul.Scalar %x, %half : !torch.vtensor<[2,8],f32>, !torch.float -> !torch.vtensor<[2,8],f32>
+  %1 = torch.aten.mul.Scalar %x, %scale : !torch.vtensor<[2,8],f32>, !torch.float -> !torch.vtensor<[2,8],f32>
+  %2 = torch.aten.erf %1 : !torch.vtensor<[2,8],f32> -> !torch.vtensor<[2,8],f32>
+  %3 = torch.aten.add.Scalar %2, %int1, %int1 : !torch.vtensor<[2,8],f32>, !torch.int, !torch.int -> !torch.vtensor<[2,8],f32>
+  %4 = torch.aten.mul.Tensor %0, %3 : !torch.vtensor<[2,8],f32>, !torch.vtensor<[2,8],f32> -> !torch.vtensor<[2,8],f32>
+  return %4 : !torch.vtensor<[2,8],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @layer_norm(
+// CHECK-SAME:      %[[X:.*]]: !torch.vtensor<[2,4,8],f32>, %[[WEIGHT:.*]]: !torch.vtensor<[8],f32>, %[[BIAS:.*]]: !torch.vtensor<[8],f32>)
+// CHECK-DAG:     %[[EPS:.*]] = torch.constant.float 1.000000e-05
+// CHECK-DAG:     %[[INT8:.*]] = torch.constant.int 8
+// CHECK:         %[[SHAPE:.*]] = torch.prim.ListConstruct %[[INT8]] : (!torch.int) -> !torch.list<int>
+// CHECK:         %[[OUT:.*]], %[[MEAN:.*]], %[[RSTD:.*]] = torch.aten.native_layer_norm %[[X]], %[[SHAPE]], %[[WEIGHT]], %[[BIAS]], %[[EPS]] : !torch.vtensor<[2,4,8],f32>, !torch.list<int>, !torch.vtensor<[8],f32>, !torch.vtensor<[8],f32>, !torch.float -> !torch.vtensor<[2,4,8],f32>, !torch.vtensor<[2,4,1],f32>, !torch.vtensor<[2,4,1],f32>
+// CHECK-NOT:     torch.aten.var_mean.correction
+// CHECK:         return %[[OUT]], %[[MEAN]], %[[RSTD]]
+func.func @layer_norm(%x: !torch.vtensor<[2,4,8],f32>, %weight: !torch.vtensor<[8],f32>, %bias: !torch.vtensor<[8],f32>) -> (!torch.vtensor<[2,4,8],f32>, !torch.vtensor<[2,4,1],f32>, !torch.vtensor<[2,4,1],f32>) {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %true = torch.constant.bool true
+  %eps = torch.constant.float 1.000000e-05
+  %dims = torch.prim.ListConstruct %int2 : (!torch.int) -> !torch.list<int>
+  %var, %mean = torch.aten.var_mean.correction %x, %dims, %int0, %true : !torch.vtensor<[2,4,8],f32>, !torch.list<int>, !torch.int, !torch.bool -> !torch.vtensor<[2,4,1],f32>, !torch.vtensor<[2,4,1],f32>
+  %0 = torch.aten.add.Scalar %var, %eps, %int1 : !torch.vtensor<[2,4,1],f32>, !torch.float, !torch.int -> !torch.vtensor<[2,4,1],f32>
+  %rstd = torch.aten.rsqrt %0 : !torch.vtensor<[2,4,1],f32> -> !torch.vtensor<[2,4,1],f32>
+  %1 = torch.aten.sub.Tensor %x, %mean, %int1 : !torch.vtensor<[2,4,8],f32>, !torch.vtensor<[2,4,1],f32>, !torch.int -> !torch.vtensor<[2,4,8],f32>
+  %2 = torch.aten.mul.Tensor %1, %rstd : !torch.vtensor<[2,4,8],f32>, !torch.vtensor<[2,4,1],f32> -> !torch.vtensor<[2,4,8],f32>
+  %3 = torch.aten.mul.Tensor %2, %weight : !torch.vtensor<[2,4,8],f32>, !torch.vtensor<[8],f32> -> !torch.vtensor<[2,4,8],f32>
+  %4 = torch.aten.add.Tensor %3, %bias, %int1 : !torch.vtensor<[2,4,8],f32>, !torch.vtensor<[8],f32>, !torch.int -> !torch.vtensor<[2,4,8],f32>
+  return %4, %mean, %rstd : !torch.vtensor<[2,4,8],f32>, !torch.vtensor<[2,4,1],f32>, !torch.vtensor<[2,4,1],f32>
+}
+
+// -----
+
+// The normalization doesn't need an affine transform.
+// CHECK-LABEL: func.func @layer_norm$no_affine(
+// CHECK-SAME:      %[[X:.*]]: !torch.vtensor<[3,4,8],f32>)
+// CHECK:         %[[NONE:.*]] = torch.constant.none
+// CHECK:         %[[OUT:.*]], %{{.*}}, %{{.*}} = torch.aten.native_layer_norm %[[X]], %{{.*}}, %[[NONE]], %[[NONE]], %{{.*}}
+// CHECK:         return %[[OUT]]
+func.func @layer_norm$no_affine(%x: !torch.vtensor<[3,4,8],f32>) -> !torch.vtensor<[3,4,8],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int-1 = torch.constant.int -1
+  %int-2 = torch.constant.int -2
+  %true = torch.constant.bool true
+  %eps = torch.constant.float 1.000000e-05
+  %dims = torch.prim.ListConstruct %int-1, %int-2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %var, %mean = torch.aten.var_mean.correction %x, %dims, %int0, %true : !torch.vtensor<[3,4,8],f32>, !torch.list<int>, !torch.int, !torch.bool -> !torch.vtensor<[3,1,1],f32>, !torch.vtensor<[3,1,1],f32>
+  %0 = torch.aten.add.Scalar %var, %eps, %int1 : !torch.vtensor<[3,1,1],f32>, !torch.float, !torch.int -> !torch.vtensor<[3,1,1],f32>
+  %rstd = torch.aten.rsqrt %0 : !torch.vtensor<[3,1,1],f32> -> !torch.vtensor<[3,1,1],f32>
+  %1 = torch.aten.sub.Tensor %x, %mean, %int1 : !torch.vtensor<[3,4,8],f32>, !torch.vtensor<[3,1,1],f32>, !torch.int -> !torch.vtensor<[3,4,8],f32>
+  %2 = torch.aten.mul.Tensor %1, %rstd : !torch.vtensor<[3,4,8],f32>, !torch.vtensor<[3,1,1],f32> -> !torch.vtensor<[3,4,8],f32>
+  return %2 : !torch.vtensor<[3,4,8],f32>
+}
+
+// -----
+
+// Normalizing over an outer dim isn't a layer_norm.
+// CHECK-LABEL: func.func @layer_norm$outer_dim(
+// CHECK-NOT:     torch.aten.native_layer_norm
+func.func @layer_norm$outer_dim(%x: !torch.vtensor<[2,4,8],f32>) -> !torch.vtensor<[2,4,8],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %true = torch.constant.bool true
+  %eps = torch.constant.float 1.000000e-05
+  %dims = torch.prim.ListConstruct %int1 : (!torch.int) -> !torch.list<int>
+  %var, %mean = torch.aten.var_mean.correction %x, %dims, %int0, %true : !torch.vtensor<[2,4,8],f32>, !torch.list<int>, !torch.int, !torch.bool -> !torch.vtensor<[2,1,8],f32>, !torch.vtensor<[2,1,8],f32>
+  %0 = torch.aten.add.Scalar %var, %eps, %int1 : !torch.vtensor<[2,1,8],f32>, !torch.float, !torch.int -> !torch.vtensor<[2,1,8],f32>
+  %rstd = torch.aten.rsqrt %0 : !torch.vtensor<[2,1,8],f32> -> !torch.vtensor<[2,1,8],f32>
+  %1 = torch.aten.sub.Tensor %x, %mean, %int1 : !torch.vtensor<[2,4,8],f32>, !torch.vtensor<[2,1,8],f32>, !torch.int -> !torch.vtensor<[2,4,8],f32>
+  %2 = torch.aten.mul.Tensor %1, %rstd : !torch.vtensor<[2,4,8],f32>, !torch.vtensor<[2,1,8],f32> -> !torch.vtensor<[2,4,8],f32>
+  return %2 : !torch.vtensor<[2,4,8],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @scaled_dot_product_attention(
+// CHECK-SAME:      %[[Q:.*]]: !torch.vtensor<[2,4,16,8],f32>, %[[K:.*]]: !torch.vtensor<[2,4,16,8],f32>, %[[V:.*]]: !torch.vtensor<[2,4,16,8],f32>)
+// CHECK-DAG:     %[[NONE:.*]] = torch.constant.none
+// CHECK-DAG:     %[[DROPOUT:.*]] = torch.constant.float 0.000000e+00
+// CHECK-DAG:     %[[FALSE:.*]] = torch.constant.bool false
+// CHECK-DAG:     %[[SCALE:.*]] = torch.constant.float 0.353553
+// CHECK:         %[[ATTN:.*]] = torch.aten.scaled_dot_product_attention %[[Q]], %[[K]], %[[V]], %[[NONE]], %[[DROPOUT]], %[[FALSE]], %[[SCALE]] : !torch.vtensor<[2,4,16,8],f32>, !torch.vtensor<[2,4,16,8],f32>, !torch.vtensor<[2,4,16,8],f32>, !torch.none, !torch.float, !torch.bool, !torch.float -> !torch.vtensor<[2,4,16,8],f32>
+// CHECK:         return %[[ATTN]]
+func.func @scaled_dot_product_attention(%q: !torch.vtensor<[2,4,16,8],f32>, %k: !torch.vtensor<[2,4,16,8],f32>, %v: !torch.vtensor<[2,4,16,8],f32>) -> !torch.vtensor<[2,4,16,8],f32> {
+  %int-1 = torch.constant.int -1
+  %int-2 = torch.constant.int -2
+  %none = torch.constant.none
+  %scale = torch.constant.float 0.35355339059327379
+  %0 = torch.aten.transpose.int %k, %int-2, %int-1 : !torch.vtensor<[2,4,16,8],f32>, !torch.int, !torch.int -> !torch.vtensor<[2,4,8,16],f32>
+  %1 = torch.aten.matmul %q, %0 : !torch.vtensor<[2,4,16,8],f32>, !torch.vtensor<[2,4,8,16],f32> -> !torch.vtensor<[2,4,16,16],f32>
+  %2 = torch.aten.mul.Scalar %1, %scale : !torch.vtensor<[2,4,16,16],f32>, !torch.float -> !torch.vtensor<[2,4,16,16],f32>
+  %3 = torch.aten.softmax.int %2, %int-1, %none : !torch.vtensor<[2,4,16,16],f32>, !torch.int, !torch.none -> !torch.vtensor<[2,4,16,16],f32>
+  %4 = torch.aten.matmul %3, %v : !torch.vtensor<[2,4,16,16],f32>, !torch.vtensor<[2,4,16,8],f32> -> !torch.vtensor<[2,4,16,8],f32>
+  return %4 : !torch.vtensor<[2,4,16,8],f32>
+}
+
+// -----
+
+// Without a scaling of the scores, the attention is recomposed with a scale
+// of 1 rather than the default of 1/sqrt(head dim).
+// CHECK-LABEL: func.func @scaled_dot_product_attention$bmm_unscaled(
+// CHECK-SAME:      %[[Q:.*]]: !torch.vtensor<[8,16,8],f32>, %[[K:.*]]: !torch.vtensor<[8,16,8],f32>, %[[V:.*]]: !torch.vtensor<[8,16,8],f32>)
+// CHECK:         %[[SCALE:.*]] = torch.constant.float 1.000000e+00
+// CHECK:         %[[ATTN:.*]] = torch.aten.scaled_dot_product_attention %[[Q]], %[[K]], %[[V]], %{{.*}}, %{{.*}}, %{{.*}}, %[[SCALE]]
+// CHECK:         return %[[ATTN]]
+func.func @scaled_dot_product_attention$bmm_unscaled(%q: !torch.vtensor<[8,16,8],f32>, %k: !torch.vtensor<[8,16,8],f32>, %v: !torch.vtensor<[8,16,8],f32>) -> !torch.vtensor<[8,16,8],f32> {
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %false = torch.constant.bool false
+  %0 = torch.aten.transpose.int %k, %int1, %int2 : !torch.vtensor<[8,16,8],f32>, !torch.int, !torch.int -> !torch.vtensor<[8,8,16],f32>
+  %1 = torch.aten.bmm %q, %0 : !torch.vtensor<[8,16,8],f32>, !torch.vtensor<[8,8,16],f32> -> !torch.vtensor<[8,16,16],f32>
+  %2 = torch.aten._softmax %1, %int2, %false : !torch.vtensor<[8,16,16],f32>, !torch.int, !torch.bool -> !torch.vtensor<[8,16,16],f32>
+  %3 = torch.aten.bmm %2, %v : !torch.vtensor<[8,16,16],f32>, !torch.vtensor<[8,16,8],f32> -> !torch.vtensor<[8,16,8],f32>
+  return %3 : !torch.vtensor<[8,16,8],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @cross_entropy_loss(
+// CHECK-SAME:      %[[X:.*]]: !torch.vtensor<[8,16],f32>, %[[TARGET:.*]]: !torch.vtensor<[8],si64>, %[[GRAD:.*]]: !torch.vtensor<[],f32>)
+// CHECK-NOT:     torch.aten._log_softmax
+// CHECK:         %[[DTYPE:.*]] = torch.prim.dtype %[[X]]
+// CHECK:         %[[LOSS:.*]] = torch.aten.cross_entropy_loss %[[X]], %[[TARGET]], %{{.*}}, %[[INT1:.*]], %[[IGNORE:.*]], %{{.*}} : !torch.vtensor<[8,16],f32>, !torch.vtensor<[8],si64>, !torch.none, !torch.int, !torch.int, !torch.float -> !torch.vtensor<[],f32>
+// CHECK:         %[[NOT_IGNORED:.*]] = torch.aten.ne.Scalar %[[TARGET]], %[[IGNORE]]
+// CHECK:         %[[TOTAL_WEIGHT:.*]] = torch.aten.sum %[[NOT_IGNORED]], %[[DTYPE]] : !torch.vtensor, !torch.int -> !torch.vtensor<[],f32>
+// CHECK:         %[[GRAD_LOGP:.*]] = torch.aten.nll_loss_backward %[[GRAD]], %[[X]], %[[TARGET]], %{{.*}}, %[[INT1]], %[[IGNORE]], %[[TOTAL_WEIGHT]]
+// CHECK:         %[[MEAN_GRAD:.*]] = torch.aten.div.Tensor %[[GRAD]], %[[TOTAL_WEIGHT]]
+// CHECK:         %[[NOT_IGNORED:.*]] = torch.aten.ne.Scalar %[[TARGET]], %[[IGNORE]]
+// CHECK:         %[[ROW_GRAD:.*]] = torch.aten.mul.Tensor %[[MEAN_GRAD]], %[[NOT_IGNORED]]
+// CHECK:         %[[UNSQUEEZED:.*]] = torch.aten.unsqueeze %[[ROW_GRAD]], %{{.*}}
+// CHECK:         %[[PROBS:.*]] = torch.aten.softmax.int %[[X]], %{{.*}}, %{{.*}}
+// CHECK:         %[[SCALED_PROBS:.*]] = torch.aten.mul.Tensor %[[PROBS]], %[[UNSQUEEZED]]
+// CHECK:         %[[GRAD_X:.*]] = torch.aten.add.Tensor %[[GRAD_LOGP]], %[[SCALED_PROBS]], %{{.*}} : !torch.vtensor<[8,16],f32>, !torch.vtensor, !torch.int -> !torch.vtensor<[8,16],f32>
+// CHECK:         return %[[LOSS]], %[[GRAD_X]]
+func.func @cross_entropy_loss(%x: !torch.vtensor<[8,16],f32>, %target: !torch.vtensor<[8],si64>, %grad: !torch.vtensor<[],f32>) -> (!torch.vtensor<[],f32>, !torch.vtensor<[8,16],f32>) {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int1 = torch.constant.int 1
+  %int6 = torch.constant.int 6
+  %int-100 = torch.constant.int -100
+  %0 = torch.aten._log_softmax %x, %int1, %false : !torch.vtensor<[8,16],f32>, !torch.int, !torch.bool -> !torch.vtensor<[8,16],f32>
+  %output, %total_weight = torch.aten.nll_loss_forward %0, %target, %none, %int1, %int-100 : !torch.vtensor<[8,16],f32>, !torch.vtensor<[8],si64>, !torch.none, !torch.int, !torch.int -> !torch.vtensor<[],f32>, !torch.vtensor<[],f32>
+  %1 = torch.aten.nll_loss_backward %grad, %0, %target, %none, %int1, %int-100, %total_weight : !torch.vtensor<[],f32>, !torch.vtensor<[8,16],f32>, !torch.vtensor<[8],si64>, !torch.none, !torch.int, !torch.int, !torch.vtensor<[],f32> -> !torch.vtensor<[8,16],f32>
+  %2 = torch.aten._log_softmax_backward_data %1, %0, %int1, %int6 : !torch.vtensor<[8,16],f32>, !torch.vtensor<[8,16],f32>, !torch.int, !torch.int -> !torch.vtensor<[8,16],f32>
+  return %output, %2 : !torch.vtensor<[],f32>, !torch.vtensor<[8,16],f32>
+}
+
+// -----
+
+// A log-softmax that is also returned is kept.
+// CHECK-LABEL: func.func @cross_entropy_loss$log_probs_used(
+// CHECK:         torch.aten._log_softmax
+// CHECK:         torch.aten.nll_loss_forward
+// CHECK-NOT:     torch.aten.cross_entropy_loss
+func.func @cross_entropy_loss$log_probs_used(%x: !torch.vtensor<[8,16],f32>, %target: !torch.vtensor<[8],si64>) -> (!torch.vtensor<[],f32>, !torch.vtensor<[8,16],f32>) {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int1 = torch.constant.int 1
+  %int-100 = torch.constant.int -100
+  %0 = torch.aten._log_softmax %x, %int1, %false : !torch.vtensor<[8,16],f32>, !torch.int, !torch.bool -> !torch.vtensor<[8,16],f32>
+  %output, %total_weight = torch.aten.nll_loss_forward %0, %target, %none, %int1, %int-100 : !torch.vtensor<[8,16],f32>, !torch.vtensor<[8],si64>, !torch.none, !torch.int, !torch.int -> !torch.vtensor<[],f32>, !torch.vtensor<[],f32>
+  return %output, %0 : !torch.vtensor<[],f32>, !torch.vtensor<[8,16],f32>
+}
@@ -0,0 +1,91 @@
+// RUN: torch-mlir-opt -torch-reify-shape-calculations="native-fast-path=true" -split-input-file %s | FileCheck %s --check-prefix=SHAPE
+// RUN: torch-mlir-opt -torch-reify-dtype-calculations="native-fast-path=true" -split-input-file %s | FileCheck %s --check-prefix=DTYPE
+
+// SHAPE-LABEL:   func.func @elementwise_and_matmul(
+// SHAPE-SAME:                                      %[[ARG0:.*]]: !torch.vtensor<[2,3],f32>, %[[ARG1:.*]]: !torch.vtensor<[3],f32>,
+// SHAPE-SAME:                                      %[[ARG2:.*]]: !torch.vtensor<[3,4],f32>) -> !torch.vtensor {
+// SHAPE-NOT:       torch.shape.calculate
+// SHAPE:           %[[ADD:.*]] = torch.aten.add.Tensor %[[ARG0]], %[[ARG1]], %{{.*}} : !torch.vtensor<[2,3],f32>, !torch.vtensor<[3],f32>, !torch.int -> !torch.vtensor<[2,3],unk>
+// SHAPE:           %[[MM:.*]] = torch.aten.mm %[[ADD]], %[[ARG2]] : !torch.vtensor<[2,3],unk>, !torch.vtensor<[3,4],f32> -> !torch.vtensor<[2,4],unk>
+// SHAPE:           %[[CAST:.*]] = torch.tensor_static_info_cast %[[MM]] : !torch.vtensor<[2,4],unk> to !torch.vtensor
+// SHAPE:           return %[[CAST]] : !torch.vtensor
+
+// DTYPE-LABEL:   func.func @elementwise_and_matmul(
+// DTYPE-NOT:       torch.dtype.calculate
+// DTYPE:           %[[ADD:.*]] = torch.aten.add.Tensor {{.*}} -> !torch.vtensor<*,f32>
+// DTYPE:           %[[MM:.*]] = torch.aten.mm %[[ADD]], {{.*}} -> !torch.vtensor<*,f32>
+// DTYPE:           %[[CAST:.*]] = torch.tensor_static_info_cast %[[MM]] : !torch.vtensor<*,f32> to !torch.vtensor
+// DTYPE:           return %[[CAST]] : !torch.vtensor
+func.func @elementwise_and_matmul(%arg0: !torch.vtensor<[2,3],f32>, %arg1: !torch.vtensor<[3],f32>, %arg2: !torch.vtensor<[3,4],f32>) -> !torch.vtensor {
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.add.Tensor %arg0, %arg1, %int1 : !torch.vtensor<[2,3],f32>, !torch.vtensor<[3],f32>, !torch.int -> !torch.vtensor
+  %1 = torch.aten.mm %0, %arg2 : !torch.vtensor, !torch.vtensor<[3,4],f32> -> !torch.vtensor
+  return %1 : !torch.vtensor
+}
+
+// -----
+
+// SHAPE-LABEL:   func.func @conv_and_pool(
+// SHAPE-NOT:       torch.shape.calculate
+// SHAPE:           torch.aten.conv2d {{.*}} -> !torch.vtensor<[1,4,8,8],unk>
+// SHAPE:           torch.aten.max_pool2d {{.*}} -> !torch.vtensor<[1,4,4,4],unk>
+
+// DTYPE-LABEL:   func.func @conv_and_pool(
+// DTYPE-NOT:       torch.dtype.calculate
+// DTYPE:           torch.aten.conv2d {{.*}} -> !torch.vtensor<*,f32>
+// DTYPE:           torch.aten.max_pool2d {{.*}} -> !torch.vtensor<*,f32>
+func.func @conv_and_pool(%arg0: !torch.vtensor<[1,3,8,8],f32>, %arg1: !torch.vtensor<[4,3,3,3],f32>) -> !torch.vtensor {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %ones = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %twos = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %zeros = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.conv2d %arg0, %arg1, %none, %ones, %ones, %ones, %int1 : !torch.vtensor<[1,3,8,8],f32>, !torch.vtensor<[4,3,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int -> !torch.vtensor
+  %1 = torch.aten.max_pool2d %0, %twos, %twos, %zeros, %ones, %false : !torch.vtensor, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool -> !torch.vtensor
+  return %1 : !torch.vtensor
+}
+
+// -----
+
+// SHAPE-LABEL:   func.func @reduction_and_view(
+// SHAPE-NOT:       torch.shape.calculate
+// SHAPE:           torch.aten.sum.dim_IntList {{.*}} -> !torch.vtensor<[2,3,1],unk>
+// SHAPE:           torch.aten.view {{.*}} -> !torch.vtensor<[6,1],unk>
+
+// DTYPE-LABEL:   func.func @reduction_and_view(
+// DTYPE-NOT:       torch.dtype.calculate
+// DTYPE:           torch.aten.sum.dim_IntList {{.*}} -> !torch.vtensor<*,f32>
+// DTYPE:           torch.aten.view {{.*}} -> !torch.vtensor<*,f32>
+func.func @reduction_and_view(%arg0: !torch.vtensor<[2,3,4],f32>) -> !torch.vtensor {
+  %none = torch.constant.none
+  %true = torch.constant.bool true
+  %int-1 = torch.constant.int -1
+  %int6 = torch.constant.int 6
+  %dims = torch.prim.ListConstruct %int-1 : (!torch.int) -> !torch.list<int>
+  %sizes = torch.prim.ListConstruct %int6, %int-1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.sum.dim_IntList %arg0, %dims, %true, %none : !torch.vtensor<[2,3,4],f32>, !torch.list<int>, !torch.bool, !torch.none -> !torch.vtensor
+  %1 = torch.aten.view %0, %sizes : !torch.vtensor, !torch.list<int> -> !torch.vtensor
+  return %1 : !torch.vtensor
+}
+
+// -----
+
+// Operands that are not static enough fall back to the library.
+
+// SHAPE-LABEL:   func.func @falls_back_to_library(
+// SHAPE:           torch.shape.calculate
+// SHAPE-NEXT:        torch.aten.tanh
+// SHAPE:           torch.aten.mm {{.*}} : !torch.vtensor<[2,2],si64>, !torch.vtensor<[2,2],si64> -> !torch.vtensor<[2,2],unk>
+
+// DTYPE-LABEL:   func.func @falls_back_to_library(
+// DTYPE:           torch.aten.tanh {{.*}} : !torch.vtensor<[?,3],f32> -> !torch.vtensor<*,f32>
+// DTYPE:           torch.dtype.calculate
+// DTYPE-NEXT:        torch.aten.mm
+func.func @falls_back_to_library(%arg0: !torch.vtensor<[?,3],f32>, %arg1: !torch.vtensor<[2,2],si64>) -> (!torch.vtensor, !torch.vtensor) {
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[?,3],f32> -> !torch.vtensor
+  %1 = torch.aten.mm %arg1, %arg1 : !torch.vtensor<[2,2],si64>, !torch.vtensor<[2,2],si64> -> !torch.vtensor
+  return %0, %1 : !torch.vtensor, !torch.vtensor
+}
@@ -242,3 +242,24 @@ func.func @adjust_shape_function_arg$number(%arg0: !torch.number) -> !torch.vten
   %1 = torch.aten.arange %arg0, %none, %none, %none, %none : !torch.number, !torch.none, !torch.none, !torch.none, !torch.none -> !torch.vtensor
   return %1 : !torch.vtensor
 }
+
+// -----
+
+// Ops with the same static signature share a single calculation.
+
+// CHECK-LABEL:   func.func @memoized_calculation(
+// CHECK-SAME:                     %[[ARG0:.*]]: !torch.vtensor<[2,3],f32>,
+// CHECK-SAME:                     %[[ARG1:.*]]: !torch.vtensor<[2,3],f32>) -> (!torch.vtensor, !torch.vtensor) {
+// CHECK:           %[[TANH0:.*]] = torch.shape.calculate {
+// CHECK:             torch.aten.tanh %[[ARG0]]
+// CHECK:           } shapes {
+// CHECK:             func.call @__torch_mlir_shape_fn.aten.tanh
+// CHECK:           } {torch.memoized_calculation = 0 : i64} : !torch.vtensor
+// CHECK-NOT:       torch.shape.calculate
+// CHECK:           %[[TANH1:.*]] = torch.aten.tanh %[[ARG1]] {torch.memoized_calculation = 0 : i64} : !torch.vtensor<[2,3],f32> -> !torch.vtensor
+// CHECK:           return %[[TANH0]], %[[TANH1]] : !torch.vtensor, !torch.vtensor
+func.func @memoized_calculation(%arg0: !torch.vtensor<[2,3],f32>, %arg1: !torch.vtensor<[2,3],f32>) -> (!torch.vtensor, !torch.vtensor) {
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[2,3],f32> -> !torch.vtensor
+  %1 = torch.aten.tanh %arg1 : !torch.vtensor<[2,3],f32> -> !torch.vtensor
+  return %0, %1 : !torch.vtensor, !torch.vtensor
+}
@@ -0,0 +1,67 @@
+// RUN: torch-mlir-opt -torch-rematerialize -split-input-file %s | FileCheck %s
+// RUN: torch-mlir-opt -torch-rematerialize=memory-budget=3072 -split-input-file %s | FileCheck %s --check-prefix=BUDGET
+
+// `%0` is live across the peak at `%2`, so it is recomputed for its use by
+// `%4` instead.
+
+// CHECK-LABEL: func.func @recompute_tanh(
+// CHECK-SAME:      %[[ARG:.*]]: !torch.vtensor<[256],f32>) -> !torch.vtensor<[256],f32> {
+// CHECK:         %[[TANH:.*]] = torch.aten.tanh %[[ARG]]
+// CHECK-NEXT:    %[[EXP0:.*]] = torch.aten.exp %[[TANH]]
+// CHECK-NEXT:    %[[EXP1:.*]] = torch.aten.exp %[[EXP0]]
+// CHECK-NEXT:    %[[SUM:.*]] = torch.aten.sum %[[EXP1]]
+// CHECK-NEXT:    %[[RECOMPUTED:.*]] = torch.aten.tanh %[[ARG]]
+// CHECK-NEXT:    %[[MUL:.*]] = torch.aten.mul.Tensor %[[RECOMPUTED]], %[[SUM]]
+// CHECK-NEXT:    return %[[MUL]]
+
+// The peak is already within the budget.
+
+// BUDGET-LABEL: func.func @recompute_tanh(
+// BUDGET-COUNT-1: torch.aten.tanh
+// BUDGET-NOT:     torch.aten.tanh
+func.func @recompute_tanh(%arg0: !torch.vtensor<[256],f32>) -> !torch.vtensor<[256],f32> {
+  %none = torch.constant.none
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[256],f32> -> !torch.vtensor<[256],f32>
+  %1 = torch.aten.exp %0 : !torch.vtensor<[256],f32> -> !torch.vtensor<[256],f32>
+  %2 = torch.aten.exp %1 : !torch.vtensor<[256],f32> -> !torch.vtensor<[256],f32>
+  %3 = torch.aten.sum %2, %none : !torch.vtensor<[256],f32>, !torch.none -> !torch.vtensor<[],f32>
+  %4 = torch.aten.mul.Tensor %0, %3 : !torch.vtensor<[256],f32>, !torch.vtensor<[],f32> -> !torch.vtensor<[256],f32>
+  return %4 : !torch.vtensor<[256],f32>
+}
+
+// -----
+
+// A matmul is too expensive to recompute.
+
+// CHECK-LABEL: func.func @keep_mm(
+// CHECK-COUNT-1: torch.aten.mm
+// CHECK-NOT:     torch.aten.mm
+func.func @keep_mm(%arg0: !torch.vtensor<[16,16],f32>) -> !torch.vtensor<[16,16],f32> {
+  %none = torch.constant.none
+  %0 = torch.aten.mm %arg0, %arg0 : !torch.vtensor<[16,16],f32>, !torch.vtensor<[16,16],f32> -> !torch.vtensor<[16,16],f32>
+  %1 = torch.aten.exp %0 : !torch.vtensor<[16,16],f32> -> !torch.vtensor<[16,16],f32>
+  %2 = torch.aten.exp %1 : !torch.vtensor<[16,16],f32> -> !torch.vtensor<[16,16],f32>
+  %3 = torch.aten.sum %2, %none : !torch.vtensor<[16,16],f32>, !torch.none -> !torch.vtensor<[],f32>
+  %4 = torch.aten.mul.Tensor %0, %3 : !torch.vtensor<[16,16],f32>, !torch.vtensor<[],f32> -> !torch.vtensor<[16,16],f32>
+  return %4 : !torch.vtensor<[16,16],f32>
+}
+
+// -----
+
+// `%0` is only used after the peak in another block, where it can't be
+// recomputed.
+
+// CHECK-LABEL: func.func @keep_use_in_other_block(
+// CHECK-COUNT-1: torch.aten.tanh
+// CHECK-NOT:     torch.aten.tanh
+func.func @keep_use_in_other_block(%arg0: !torch.vtensor<[256],f32>) -> !torch.vtensor<[256],f32> {
+  %none = torch.constant.none
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[256],f32> -> !torch.vtensor<[256],f32>
+  %1 = torch.aten.exp %0 : !torch.vtensor<[256],f32> -> !torch.vtensor<[256],f32>
+  %2 = torch.aten.exp %1 : !torch.vtensor<[256],f32> -> !torch.vtensor<[256],f32>
+  %3 = torch.aten.sum %2, %none : !torch.vtensor<[256],f32>, !torch.none -> !torch.vtensor<[],f32>
+  cf.br ^bb1
+^bb1:
+  %4 = torch.aten.mul.Tensor %0, %3 : !torch.vtensor<[256],f32>, !torch.vtensor<[],f32> -> !torch.vtensor<[256],f32>
+  return %4 : !torch.vtensor<[256],f32>
+}
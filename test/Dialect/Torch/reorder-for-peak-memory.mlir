@@ -0,0 +1,49 @@
+// RUN: torch-mlir-opt -pass-pipeline='builtin.module(func.func(torch-reorder-for-peak-memory{report=true}))' -split-input-file %s 2>&1 | FileCheck %s
+
+// The reductions of `%0` and `%1` run as soon as they can, so that `%0` is
+// freed before `%1` is computed.
+
+// CHECK: remark: peak activation memory of 2052 bytes before reordering and 1032 bytes after
+// CHECK-LABEL: func.func @reduce_early(
+// CHECK-SAME:      %[[ARG:.*]]: !torch.vtensor<[256],f32>) -> !torch.vtensor<[],f32> {
+// CHECK:         %[[NONE:.*]] = torch.constant.none
+// CHECK-NEXT:    %[[INT1:.*]] = torch.constant.int 1
+// CHECK-NEXT:    %[[TANH0:.*]] = torch.aten.tanh %[[ARG]]
+// CHECK-NEXT:    %[[SUM0:.*]] = torch.aten.sum %[[TANH0]], %[[NONE]]
+// CHECK-NEXT:    %[[TANH1:.*]] = torch.aten.tanh %[[ARG]]
+// CHECK-NEXT:    %[[SUM1:.*]] = torch.aten.sum %[[TANH1]], %[[NONE]]
+// CHECK-NEXT:    %[[ADD:.*]] = torch.aten.add.Tensor %[[SUM0]], %[[SUM1]], %[[INT1]]
+// CHECK-NEXT:    return %[[ADD]]
+func.func @reduce_early(%arg0: !torch.vtensor<[256],f32>) -> !torch.vtensor<[],f32> {
+  %none = torch.constant.none
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[256],f32> -> !torch.vtensor<[256],f32>
+  %1 = torch.aten.tanh %arg0 : !torch.vtensor<[256],f32> -> !torch.vtensor<[256],f32>
+  %2 = torch.aten.sum %0, %none : !torch.vtensor<[256],f32>, !torch.none -> !torch.vtensor<[],f32>
+  %3 = torch.aten.sum %1, %none : !torch.vtensor<[256],f32>, !torch.none -> !torch.vtensor<[],f32>
+  %4 = torch.aten.add.Tensor %2, %3, %int1 : !torch.vtensor<[],f32>, !torch.vtensor<[],f32>, !torch.int -> !torch.vtensor<[],f32>
+  return %4 : !torch.vtensor<[],f32>
+}
+
+// -----
+
+// Ops with side effects stay in place, and the ops aren't moved across them.
+
+// CHECK: remark: peak activation memory of 2052 bytes before reordering and 2052 bytes after
+// CHECK-LABEL: func.func @side_effect(
+// CHECK:         torch.aten.tanh
+// CHECK-NEXT:    torch.aten.tanh
+// CHECK-NEXT:    torch.prim.Print
+// CHECK-NEXT:    torch.aten.sum
+// CHECK-NEXT:    torch.aten.sum
+func.func @side_effect(%arg0: !torch.vtensor<[256],f32>) -> !torch.vtensor<[],f32> {
+  %none = torch.constant.none
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[256],f32> -> !torch.vtensor<[256],f32>
+  %1 = torch.aten.tanh %arg0 : !torch.vtensor<[256],f32> -> !torch.vtensor<[256],f32>
+  torch.prim.Print(%int1) : !torch.int
+  %2 = torch.aten.sum %0, %none : !torch.vtensor<[256],f32>, !torch.none -> !torch.vtensor<[],f32>
+  %3 = torch.aten.sum %1, %none : !torch.vtensor<[256],f32>, !torch.none -> !torch.vtensor<[],f32>
+  %4 = torch.aten.add.Tensor %2, %3, %int1 : !torch.vtensor<[],f32>, !torch.vtensor<[],f32>, !torch.int -> !torch.vtensor<[],f32>
+  return %4 : !torch.vtensor<[],f32>
+}
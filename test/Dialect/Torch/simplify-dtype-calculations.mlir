@@ -300,3 +300,23 @@ func.func @refine_dtype$complex_type(%arg0: !torch.vtensor<*,f32>) -> !torch.vte
     %1 = torch.tensor_static_info_cast %0 : !torch.vtensor<*,unk> to !torch.vtensor
     return %1 : !torch.vtensor
   }
+
+// -----
+
+// CHECK-LABEL:   func.func @promote_dtypes$float8(
+// CHECK:             {{.*}} = torch.aten.mm {{.*}} -> !torch.vtensor<[2,2],f8E4M3FN>
+func.func @promote_dtypes$float8(%arg0: !torch.vtensor<[2,2],f8E4M3FN>, %arg1: !torch.vtensor<[2,2],f8E4M3FN>) {
+  %int2 = torch.constant.int 2
+  %0 = torch.dtype.calculate {
+    %1 = torch.aten.mm %arg0, %arg1 : !torch.vtensor<[2,2],f8E4M3FN>, !torch.vtensor<[2,2],f8E4M3FN> -> !torch.vtensor<[2,2],unk>
+    torch.dtype.calculate.yield %1 : !torch.vtensor<[2,2],unk>
+  } dtypes {
+    %lhs_dtype = torch.prim.dtype %arg0 : !torch.vtensor<[2,2],f8E4M3FN> -> !torch.int
+    %rhs_dtype = torch.prim.dtype %arg1 : !torch.vtensor<[2,2],f8E4M3FN> -> !torch.int
+    %ranks = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<optional<int>>
+    %dtypes = torch.prim.ListConstruct %lhs_dtype, %rhs_dtype : (!torch.int, !torch.int) -> !torch.list<int>
+    %3 = torch.promote_dtypes %ranks, %dtypes : (!torch.list<optional<int>>, !torch.list<int>) -> !torch.int
+    torch.dtype.calculate.yield.dtypes %3 : !torch.int
+  } : !torch.vtensor<[2,2],unk>
+  return
+}
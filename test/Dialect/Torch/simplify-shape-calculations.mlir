@@ -489,3 +489,47 @@ func.func @shape_calc_with_two_uses(%arg0: !torch.vtensor<[2],f32>) -> !torch.vt
 
   return %arg0 : !torch.vtensor<[2],f32>
 }
+
+// -----
+
+// CHECK-LABEL:   func.func @refine_prim_loop_carried_types(
+// CHECK-SAME:                                              %[[N:.*]]: !torch.int,
+// CHECK-SAME:                                              %[[INIT:.*]]: !torch.vtensor<[2,3],f32>,
+// CHECK-SAME:                                              %[[OTHER:.*]]: !torch.vtensor<[4,3],f32>) -> !torch.vtensor {
+// CHECK:           %[[LOOP:.*]] = torch.prim.Loop %[[N]], %{{.*}}, init(%{{.*}}) {
+// CHECK:           ^bb0(%{{.*}}: !torch.int, %[[CARRIED:.*]]: !torch.vtensor<[?,3],f32>):
+// CHECK:             torch.prim.Loop.condition %{{.*}}, iter(%{{.*}} : !torch.vtensor<[?,3],f32>)
+// CHECK:           } : (!torch.int, !torch.bool, !torch.vtensor<[?,3],f32>) -> !torch.vtensor<[?,3],f32>
+// CHECK:           %[[RESULT:.*]] = torch.tensor_static_info_cast %[[LOOP]] : !torch.vtensor<[?,3],f32> to !torch.vtensor
+// CHECK:           return %[[RESULT]] : !torch.vtensor
+func.func @refine_prim_loop_carried_types(%arg0: !torch.int, %arg1: !torch.vtensor<[2,3],f32>, %arg2: !torch.vtensor<[4,3],f32>) -> !torch.vtensor {
+  %true = torch.constant.bool true
+  %0 = torch.tensor_static_info_cast %arg1 : !torch.vtensor<[2,3],f32> to !torch.vtensor
+  %1 = torch.prim.Loop %arg0, %true, init(%0) {
+  ^bb0(%arg3: !torch.int, %arg4: !torch.vtensor):
+    %2 = torch.tensor_static_info_cast %arg2 : !torch.vtensor<[4,3],f32> to !torch.vtensor
+    torch.prim.Loop.condition %true, iter(%2 : !torch.vtensor)
+  } : (!torch.int, !torch.bool, !torch.vtensor) -> !torch.vtensor
+  return %1 : !torch.vtensor
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @refine_prim_if_result_types(
+// CHECK:           %[[IF:.*]] = torch.prim.If %{{.*}} -> (!torch.vtensor<[?,3],f32>) {
+// CHECK:             torch.prim.If.yield %{{.*}} : !torch.vtensor<[?,3],f32>
+// CHECK:           } else {
+// CHECK:             torch.prim.If.yield %{{.*}} : !torch.vtensor<[?,3],f32>
+// CHECK:           }
+// CHECK:           %[[RESULT:.*]] = torch.tensor_static_info_cast %[[IF]] : !torch.vtensor<[?,3],f32> to !torch.vtensor
+// CHECK:           return %[[RESULT]] : !torch.vtensor
+func.func @refine_prim_if_result_types(%arg0: !torch.bool, %arg1: !torch.vtensor<[2,3],f32>, %arg2: !torch.vtensor<[4,3],f32>) -> !torch.vtensor {
+  %0 = torch.prim.If %arg0 -> (!torch.vtensor) {
+    %1 = torch.tensor_static_info_cast %arg1 : !torch.vtensor<[2,3],f32> to !torch.vtensor
+    torch.prim.If.yield %1 : !torch.vtensor
+  } else {
+    %1 = torch.tensor_static_info_cast %arg2 : !torch.vtensor<[4,3],f32> to !torch.vtensor
+    torch.prim.If.yield %1 : !torch.vtensor
+  }
+  return %0 : !torch.vtensor
+}
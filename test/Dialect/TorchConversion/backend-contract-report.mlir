@@ -0,0 +1,55 @@
+// RUN: torch-mlir-opt -torch-verify-linalg-on-tensors-backend-contract=report=- %s -o /dev/null | FileCheck %s
+
+// CHECK:      "hot_ops": [
+// CHECK-NEXT:   {
+// CHECK-NEXT:     "bytes": 136,
+// CHECK-NEXT:     "flops": 48,
+// CHECK-NEXT:     "location": "loc({{.*}})",
+// CHECK-NEXT:     "op": "linalg.matmul"
+// CHECK-NEXT:   },
+// CHECK-NEXT:   {
+// CHECK-NEXT:     "bytes": 64,
+// CHECK-NEXT:     "flops": 0,
+// CHECK-NEXT:     "location": "loc({{.*}})",
+// CHECK-NEXT:     "op": "linalg.fill"
+// CHECK-NEXT:   },
+// CHECK-NEXT:   {
+// CHECK-NEXT:     "bytes": 64,
+// CHECK-NEXT:     "flops": 0,
+// CHECK-NEXT:     "location": "loc({{.*}})",
+// CHECK-NEXT:     "op": "linalg.generic"
+// CHECK-NEXT:   }
+// CHECK-NEXT: ],
+// CHECK:      "op_counts": {
+// CHECK-DAG:    "arith.constant": 1,
+// CHECK-DAG:    "func.func": 1,
+// CHECK-DAG:    "func.return": 1,
+// CHECK-DAG:    "linalg.fill": 1,
+// CHECK-DAG:    "linalg.generic": 1,
+// CHECK-DAG:    "linalg.matmul": 1,
+// CHECK-DAG:    "tensor.empty": 2
+// CHECK:      },
+// CHECK:      "slow_fallbacks": [
+// CHECK-NEXT:   {
+// CHECK-NEXT:     "location": "loc({{.*}})",
+// CHECK-NEXT:     "op": "linalg.generic"
+// CHECK-NEXT:   }
+// CHECK-NEXT: ],
+// CHECK:      "total_bytes": 264,
+// CHECK:      "total_flops": 48
+
+#map = affine_map<(d0) -> (d0)>
+func.func @report(%arg0: tensor<2x3xf32>, %arg1: tensor<3x4xf32>, %arg2: tensor<4xi64>) -> (tensor<2x4xf32>, tensor<4xf32>) {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<2x4xf32>
+  %1 = linalg.fill ins(%cst : f32) outs(%0 : tensor<2x4xf32>) -> tensor<2x4xf32>
+  %2 = linalg.matmul ins(%arg0, %arg1 : tensor<2x3xf32>, tensor<3x4xf32>) outs(%1 : tensor<2x4xf32>) -> tensor<2x4xf32>
+  %3 = tensor.empty() : tensor<4xf32>
+  %4 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel"]} ins(%arg2 : tensor<4xi64>) outs(%3 : tensor<4xf32>) {
+  ^bb0(%in: i64, %out: f32):
+    %5 = arith.index_cast %in : i64 to index
+    %6 = tensor.extract %arg0[%5, %5] : tensor<2x3xf32>
+    linalg.yield %6 : f32
+  } -> tensor<4xf32>
+  return %2, %4 : tensor<2x4xf32>, tensor<4xf32>
+}
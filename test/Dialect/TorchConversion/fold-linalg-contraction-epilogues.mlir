@@ -0,0 +1,98 @@
+// RUN: torch-mlir-opt %s -torch-fold-linalg-contraction-epilogues -split-input-file | FileCheck %s
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#bias = affine_map<(d0, d1) -> (d1)>
+
+// The bias add and the residual add are both folded into the accumulator of
+// the matmul, and the relu is left as its consumer.
+// CHECK-LABEL: func.func @matmul_bias_residual_relu(
+// CHECK-SAME:      %[[LHS:.*]]: tensor<4x8xf32>, %[[RHS:.*]]: tensor<8x16xf32>, %[[BIAS:.*]]: tensor<16xf32>, %[[RESIDUAL:.*]]: tensor<4x16xf32>)
+// CHECK:         %[[FILL:.*]] = linalg.fill
+// CHECK:         %[[WITH_BIAS:.*]] = linalg.generic
+// CHECK-SAME:        ins(%[[FILL]], %[[BIAS]] : tensor<4x16xf32>, tensor<16xf32>)
+// CHECK:         %[[WITH_RESIDUAL:.*]] = linalg.generic
+// CHECK-SAME:        ins(%[[RESIDUAL]], %[[WITH_BIAS]] : tensor<4x16xf32>, tensor<4x16xf32>)
+// CHECK:         %[[MATMUL:.*]] = linalg.matmul ins(%[[LHS]], %[[RHS]] : tensor<4x8xf32>, tensor<8x16xf32>) outs(%[[WITH_RESIDUAL]] : tensor<4x16xf32>)
+// CHECK:         %[[RELU:.*]] = linalg.generic
+// CHECK-SAME:        ins(%[[MATMUL]] : tensor<4x16xf32>)
+// CHECK:           arith.maxf
+// CHECK:         return %[[RELU]]
+func.func @matmul_bias_residual_relu(%lhs: tensor<4x8xf32>, %rhs: tensor<8x16xf32>, %bias: tensor<16xf32>, %residual: tensor<4x16xf32>) -> tensor<4x16xf32> {
+  %zero = arith.constant 0.000000e+00 : f32
+  %empty = tensor.empty() : tensor<4x16xf32>
+  %fill = linalg.fill ins(%zero : f32) outs(%empty : tensor<4x16xf32>) -> tensor<4x16xf32>
+  %matmul = linalg.matmul ins(%lhs, %rhs : tensor<4x8xf32>, tensor<8x16xf32>) outs(%fill : tensor<4x16xf32>) -> tensor<4x16xf32>
+  %0 = linalg.generic {indexing_maps = [#map, #bias, #map], iterator_types = ["parallel", "parallel"]} ins(%matmul, %bias : tensor<4x16xf32>, tensor<16xf32>) outs(%empty : tensor<4x16xf32>) {
+  ^bb0(%in: f32, %b: f32, %out: f32):
+    %add = arith.addf %in, %b : f32
+    linalg.yield %add : f32
+  } -> tensor<4x16xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]} ins(%residual, %0 : tensor<4x16xf32>, tensor<4x16xf32>) outs(%empty : tensor<4x16xf32>) {
+  ^bb0(%r: f32, %in: f32, %out: f32):
+    %add = arith.addf %r, %in : f32
+    linalg.yield %add : f32
+  } -> tensor<4x16xf32>
+  %2 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%1 : tensor<4x16xf32>) outs(%empty : tensor<4x16xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %max = arith.maxf %in, %zero : f32
+    linalg.yield %max : f32
+  } -> tensor<4x16xf32>
+  return %2 : tensor<4x16xf32>
+}
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+// The matmul result is scaled before the add, so it can't be accumulated into.
+// CHECK-LABEL: func.func @matmul_scaled_add(
+// CHECK:         %[[MATMUL:.*]] = linalg.matmul
+// CHECK:         linalg.generic
+// CHECK-SAME:        ins(%[[MATMUL]], %{{.*}} : tensor<4x16xf32>, tensor<4x16xf32>)
+func.func @matmul_scaled_add(%lhs: tensor<4x8xf32>, %rhs: tensor<8x16xf32>, %other: tensor<4x16xf32>) -> tensor<4x16xf32> {
+  %zero = arith.constant 0.000000e+00 : f32
+  %two = arith.constant 2.000000e+00 : f32
+  %empty = tensor.empty() : tensor<4x16xf32>
+  %fill = linalg.fill ins(%zero : f32) outs(%empty : tensor<4x16xf32>) -> tensor<4x16xf32>
+  %matmul = linalg.matmul ins(%lhs, %rhs : tensor<4x8xf32>, tensor<8x16xf32>) outs(%fill : tensor<4x16xf32>) -> tensor<4x16xf32>
+  %0 = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]} ins(%matmul, %other : tensor<4x16xf32>, tensor<4x16xf32>) outs(%empty : tensor<4x16xf32>) {
+  ^bb0(%in: f32, %o: f32, %out: f32):
+    %scaled = arith.mulf %in, %two : f32
+    %add = arith.addf %scaled, %o : f32
+    linalg.yield %add : f32
+  } -> tensor<4x16xf32>
+  return %0 : tensor<4x16xf32>
+}
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+// Only adds are folded: the matmul result goes through an activation before
+// the add, so the activation and the add are left as its consumer.
+// CHECK-LABEL: func.func @matmul_gelu_add(
+// CHECK:         %[[MATMUL:.*]] = linalg.matmul ins(%{{.*}}, %{{.*}} : tensor<4x8xf32>, tensor<8x16xf32>) outs(%{{.*}} : tensor<4x16xf32>)
+// CHECK:         linalg.generic
+// CHECK-SAME:        ins(%[[MATMUL]], %{{.*}} : tensor<4x16xf32>, tensor<4x16xf32>)
+// CHECK:           math.erf
+// CHECK:           arith.addf
+func.func @matmul_gelu_add(%lhs: tensor<4x8xf32>, %rhs: tensor<8x16xf32>, %other: tensor<4x16xf32>) -> tensor<4x16xf32> {
+  %zero = arith.constant 0.000000e+00 : f32
+  %half = arith.constant 5.000000e-01 : f32
+  %one = arith.constant 1.000000e+00 : f32
+  %rsqrt2 = arith.constant 0.707106769 : f32
+  %empty = tensor.empty() : tensor<4x16xf32>
+  %fill = linalg.fill ins(%zero : f32) outs(%empty : tensor<4x16xf32>) -> tensor<4x16xf32>
+  %matmul = linalg.matmul ins(%lhs, %rhs : tensor<4x8xf32>, tensor<8x16xf32>) outs(%fill : tensor<4x16xf32>) -> tensor<4x16xf32>
+  %0 = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]} ins(%matmul, %other : tensor<4x16xf32>, tensor<4x16xf32>) outs(%empty : tensor<4x16xf32>) {
+  ^bb0(%in: f32, %o: f32, %out: f32):
+    %scaled = arith.mulf %in, %rsqrt2 : f32
+    %erf = math.erf %scaled : f32
+    %shifted = arith.addf %erf, %one : f32
+    %halved = arith.mulf %in, %half : f32
+    %gelu = arith.mulf %halved, %shifted : f32
+    %add = arith.addf %gelu, %o : f32
+    linalg.yield %add : f32
+  } -> tensor<4x16xf32>
+  return %0 : tensor<4x16xf32>
+}
@@ -0,0 +1,81 @@
+// RUN: torch-mlir-opt %s -torch-fold-linalg-producers-into-insert-slices -split-input-file | FileCheck %s
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+// Both parts of the concatenation are computed into their slices of the
+// result.
+// CHECK-LABEL: func.func @cat_elementwise(
+// CHECK-SAME:      %[[ARG0:.*]]: tensor<2x3xf32>, %[[ARG1:.*]]: tensor<2x5xf32>)
+// CHECK:         %[[EMPTY:.*]] = tensor.empty() : tensor<2x8xf32>
+// CHECK:         %[[SLICE0:.*]] = tensor.extract_slice %[[EMPTY]][0, 0] [2, 3] [1, 1] : tensor<2x8xf32> to tensor<2x3xf32>
+// CHECK:         %[[NEG:.*]] = linalg.generic {{.*}} ins(%[[ARG0]] : tensor<2x3xf32>) outs(%[[SLICE0]] : tensor<2x3xf32>)
+// CHECK:         %[[INSERT0:.*]] = tensor.insert_slice %[[NEG]] into %[[EMPTY]][0, 0] [2, 3] [1, 1]
+// CHECK:         %[[SLICE1:.*]] = tensor.extract_slice %[[INSERT0]][0, 3] [2, 5] [1, 1] : tensor<2x8xf32> to tensor<2x5xf32>
+// CHECK:         %[[EXP:.*]] = linalg.generic {{.*}} ins(%[[ARG1]] : tensor<2x5xf32>) outs(%[[SLICE1]] : tensor<2x5xf32>)
+// CHECK:         %[[INSERT1:.*]] = tensor.insert_slice %[[EXP]] into %[[INSERT0]][0, 3] [2, 5] [1, 1]
+// CHECK:         return %[[INSERT1]]
+func.func @cat_elementwise(%arg0: tensor<2x3xf32>, %arg1: tensor<2x5xf32>) -> tensor<2x8xf32> {
+  %empty0 = tensor.empty() : tensor<2x3xf32>
+  %0 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg0 : tensor<2x3xf32>) outs(%empty0 : tensor<2x3xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %neg = arith.negf %in : f32
+    linalg.yield %neg : f32
+  } -> tensor<2x3xf32>
+  %empty1 = tensor.empty() : tensor<2x5xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg1 : tensor<2x5xf32>) outs(%empty1 : tensor<2x5xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %exp = math.exp %in : f32
+    linalg.yield %exp : f32
+  } -> tensor<2x5xf32>
+  %empty = tensor.empty() : tensor<2x8xf32>
+  %2 = tensor.insert_slice %0 into %empty[0, 0] [2, 3] [1, 1] : tensor<2x3xf32> into tensor<2x8xf32>
+  %3 = tensor.insert_slice %1 into %2[0, 3] [2, 5] [1, 1] : tensor<2x5xf32> into tensor<2x8xf32>
+  return %3 : tensor<2x8xf32>
+}
+
+// -----
+
+// The accumulator of the matmul is filled on its slice of the result.
+// CHECK-LABEL: func.func @cat_matmul(
+// CHECK-SAME:      %[[LHS:.*]]: tensor<4x8xf32>, %[[RHS:.*]]: tensor<8x16xf32>, %[[OTHER:.*]]: tensor<4x16xf32>)
+// CHECK:         %[[ZERO:.*]] = arith.constant 0.000000e+00 : f32
+// CHECK:         %[[EMPTY:.*]] = tensor.empty() : tensor<8x16xf32>
+// CHECK:         %[[SLICE:.*]] = tensor.extract_slice %[[EMPTY]][0, 0] [4, 16] [1, 1] : tensor<8x16xf32> to tensor<4x16xf32>
+// CHECK:         %[[FILL:.*]] = linalg.fill ins(%[[ZERO]] : f32) outs(%[[SLICE]] : tensor<4x16xf32>) -> tensor<4x16xf32>
+// CHECK:         %[[MATMUL:.*]] = linalg.matmul ins(%[[LHS]], %[[RHS]] : tensor<4x8xf32>, tensor<8x16xf32>) outs(%[[FILL]] : tensor<4x16xf32>)
+// CHECK:         %[[INSERT0:.*]] = tensor.insert_slice %[[MATMUL]] into %[[EMPTY]][0, 0] [4, 16] [1, 1]
+// CHECK:         tensor.insert_slice %[[OTHER]] into %[[INSERT0]][4, 0] [4, 16] [1, 1]
+func.func @cat_matmul(%lhs: tensor<4x8xf32>, %rhs: tensor<8x16xf32>, %other: tensor<4x16xf32>) -> tensor<8x16xf32> {
+  %zero = arith.constant 0.000000e+00 : f32
+  %init = tensor.empty() : tensor<4x16xf32>
+  %fill = linalg.fill ins(%zero : f32) outs(%init : tensor<4x16xf32>) -> tensor<4x16xf32>
+  %matmul = linalg.matmul ins(%lhs, %rhs : tensor<4x8xf32>, tensor<8x16xf32>) outs(%fill : tensor<4x16xf32>) -> tensor<4x16xf32>
+  %empty = tensor.empty() : tensor<8x16xf32>
+  %0 = tensor.insert_slice %matmul into %empty[0, 0] [4, 16] [1, 1] : tensor<4x16xf32> into tensor<8x16xf32>
+  %1 = tensor.insert_slice %other into %0[4, 0] [4, 16] [1, 1] : tensor<4x16xf32> into tensor<8x16xf32>
+  return %1 : tensor<8x16xf32>
+}
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+// A producer whose result has other uses is left alone.
+// CHECK-LABEL: func.func @cat_multiple_uses(
+// CHECK:         %[[INIT:.*]] = tensor.empty() : tensor<2x3xf32>
+// CHECK:         %[[NEG:.*]] = linalg.generic {{.*}} outs(%[[INIT]] : tensor<2x3xf32>)
+// CHECK-NOT:     tensor.extract_slice
+// CHECK:         tensor.insert_slice %[[NEG]]
+// CHECK:         return %{{.*}}, %[[NEG]]
+func.func @cat_multiple_uses(%arg0: tensor<2x3xf32>) -> (tensor<4x3xf32>, tensor<2x3xf32>) {
+  %init = tensor.empty() : tensor<2x3xf32>
+  %0 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg0 : tensor<2x3xf32>) outs(%init : tensor<2x3xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %neg = arith.negf %in : f32
+    linalg.yield %neg : f32
+  } -> tensor<2x3xf32>
+  %empty = tensor.empty() : tensor<4x3xf32>
+  %1 = tensor.insert_slice %0 into %empty[0, 0] [2, 3] [1, 1] : tensor<2x3xf32> into tensor<4x3xf32>
+  %2 = tensor.insert_slice %arg0 into %1[2, 0] [2, 3] [1, 1] : tensor<2x3xf32> into tensor<4x3xf32>
+  return %2, %0 : tensor<4x3xf32>, tensor<2x3xf32>
+}
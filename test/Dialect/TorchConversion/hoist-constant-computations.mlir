@@ -0,0 +1,61 @@
+// RUN: torch-mlir-opt %s -torch-hoist-constant-computations -split-input-file | FileCheck %s
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d1, d0)>
+
+// The transpose of the weight is computed once by the initializer and loaded
+// from its cache global afterwards.
+// CHECK:         ml_program.global private mutable @__hoisted(dense<0.000000e+00> : tensor<3x2xf32>) : tensor<3x2xf32>
+// CHECK:         ml_program.global private mutable @__hoisted_initialized(dense<false> : tensor<i1>) : tensor<i1>
+// CHECK-LABEL: func.func @forward(
+// CHECK-SAME:      %[[ARG:.*]]: tensor<4x3xf32>) -> tensor<4x2xf32> {
+// CHECK:         %[[FLAG:.*]] = ml_program.global_load @__hoisted_initialized : tensor<i1>
+// CHECK:         %[[INITIALIZED:.*]] = tensor.extract %[[FLAG]][] : tensor<i1>
+// CHECK:         %[[TRUE:.*]] = arith.constant true
+// CHECK:         %[[FIRST_CALL:.*]] = arith.xori %[[INITIALIZED]], %[[TRUE]] : i1
+// CHECK:         scf.if %[[FIRST_CALL]] {
+// CHECK:           func.call @__initialize_hoisted() : () -> ()
+// CHECK:           %[[DONE:.*]] = arith.constant dense<true> : tensor<i1>
+// CHECK:           ml_program.global_store @__hoisted_initialized = %[[DONE]] : tensor<i1>
+// CHECK:         }
+// CHECK:         %[[WEIGHT:.*]] = ml_program.global_load @__hoisted : tensor<3x2xf32>
+// CHECK-NOT:     linalg.generic
+// CHECK:         linalg.matmul ins(%[[ARG]], %[[WEIGHT]] : tensor<4x3xf32>, tensor<3x2xf32>)
+// CHECK-LABEL: func.func private @__initialize_hoisted() {
+// CHECK:         %[[LITERAL:.*]] = arith.constant dense<{{.*}}> : tensor<2x3xf32>
+// CHECK:         %[[EMPTY:.*]] = tensor.empty() : tensor<3x2xf32>
+// CHECK:         %[[TRANSPOSE:.*]] = linalg.generic {{.*}} ins(%[[LITERAL]] : tensor<2x3xf32>) outs(%[[EMPTY]] : tensor<3x2xf32>)
+// CHECK-NOT:     linalg.fill
+// CHECK:         ml_program.global_store @__hoisted = %[[TRANSPOSE]] : tensor<3x2xf32>
+// CHECK:         return
+func.func @forward(%arg0: tensor<4x3xf32>) -> tensor<4x2xf32> {
+  %weight = arith.constant dense<[[1.0, 2.0, 3.0], [4.0, 5.0, 6.0]]> : tensor<2x3xf32>
+  %empty = tensor.empty() : tensor<3x2xf32>
+  %transpose = linalg.generic {indexing_maps = [#map1, #map], iterator_types = ["parallel", "parallel"]} ins(%weight : tensor<2x3xf32>) outs(%empty : tensor<3x2xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    linalg.yield %in : f32
+  } -> tensor<3x2xf32>
+  %zero = arith.constant 0.000000e+00 : f32
+  %init = tensor.empty() : tensor<4x2xf32>
+  %fill = linalg.fill ins(%zero : f32) outs(%init : tensor<4x2xf32>) -> tensor<4x2xf32>
+  %0 = linalg.matmul ins(%arg0, %transpose : tensor<4x3xf32>, tensor<3x2xf32>) outs(%fill : tensor<4x2xf32>) -> tensor<4x2xf32>
+  return %0 : tensor<4x2xf32>
+}
+
+// -----
+
+// The fill of the accumulator only depends on constants, but is cheap to
+// redo, and neither the constants nor the computations on the arguments are
+// cached.
+// CHECK-LABEL: func.func @nothing_to_hoist(
+// CHECK-NOT:     ml_program
+// CHECK-NOT:     func.call
+// CHECK:         linalg.matmul
+func.func @nothing_to_hoist(%arg0: tensor<4x3xf32>) -> tensor<4x2xf32> {
+  %weight = arith.constant dense<[[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]]> : tensor<3x2xf32>
+  %zero = arith.constant 0.000000e+00 : f32
+  %init = tensor.empty() : tensor<4x2xf32>
+  %fill = linalg.fill ins(%zero : f32) outs(%init : tensor<4x2xf32>) -> tensor<4x2xf32>
+  %0 = linalg.matmul ins(%arg0, %weight : tensor<4x3xf32>, tensor<3x2xf32>) outs(%fill : tensor<4x2xf32>) -> tensor<4x2xf32>
+  return %0 : tensor<4x2xf32>
+}
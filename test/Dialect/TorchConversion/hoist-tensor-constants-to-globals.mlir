@@ -0,0 +1,34 @@
+// RUN: torch-mlir-opt %s -torch-hoist-tensor-constants-to-globals="min-elements=4" -split-input-file | FileCheck %s
+
+// The weight used by both functions is stored once.
+// CHECK:         ml_program.global private @[[WEIGHT:.*]](dense<[1.000000e+00, 2.000000e+00, 3.000000e+00, 4.000000e+00]> : tensor<4xf32>) : tensor<4xf32>
+// CHECK-NOT:     ml_program.global
+// CHECK-LABEL: func.func @encode(
+// CHECK:         %[[LOAD:.*]] = ml_program.global_load_const @[[WEIGHT]] : tensor<4xf32>
+// CHECK:         return %[[LOAD]]
+// CHECK-LABEL: func.func @decode(
+// CHECK:         %[[LOAD:.*]] = ml_program.global_load_const @[[WEIGHT]] : tensor<4xf32>
+// CHECK:         return %[[LOAD]]
+func.func @encode() -> tensor<4xf32> {
+  %0 = arith.constant dense<[1.0, 2.0, 3.0, 4.0]> : tensor<4xf32>
+  return %0 : tensor<4xf32>
+}
+func.func @decode() -> tensor<4xf32> {
+  %0 = arith.constant dense<[1.0, 2.0, 3.0, 4.0]> : tensor<4xf32>
+  return %0 : tensor<4xf32>
+}
+
+// -----
+
+// Small and splat constants, and scalars, are left alone.
+// CHECK-NOT:     ml_program.global
+// CHECK-LABEL: func.func @small_constants(
+// CHECK:         arith.constant dense<[1.000000e+00, 2.000000e+00]> : tensor<2xf32>
+// CHECK:         arith.constant dense<1.000000e+00> : tensor<8xf32>
+// CHECK:         arith.constant 1.000000e+00 : f32
+func.func @small_constants() -> (tensor<2xf32>, tensor<8xf32>, f32) {
+  %0 = arith.constant dense<[1.0, 2.0]> : tensor<2xf32>
+  %1 = arith.constant dense<1.0> : tensor<8xf32>
+  %2 = arith.constant 1.0 : f32
+  return %0, %1, %2 : tensor<2xf32>, tensor<8xf32>, f32
+}
@@ -0,0 +1,25 @@
+// RUN: torch-mlir-opt %s -pass-pipeline='builtin.module(torch-backend-to-linalg-on-tensors-backend-pipeline{channels-last=true})' | FileCheck %s
+
+// The activation and the padding between the convolutions stay in the NHWC
+// layout, so the layout only changes at the ends of the chain.
+// CHECK-LABEL: func.func @conv_relu_conv(
+// CHECK-SAME:      %[[INPUT:.*]]: tensor<1x4x8x8xf32>, %[[WEIGHT0:.*]]: tensor<4x4x3x3xf32>, %[[WEIGHT1:.*]]: tensor<4x4x3x3xf32>) -> tensor<1x4x8x8xf32> {
+// CHECK:         %[[CONV0:.*]] = linalg.conv_2d_nhwc_hwcf
+// CHECK-NOT:     linalg.generic {{.*}} ins(%[[CONV0]] : tensor<1x8x8x4xf32>) outs(%{{.*}} : tensor<1x4x8x8xf32>)
+// CHECK:         %[[RELU:.*]] = linalg.generic {{.*}} ins(%[[CONV0]] : tensor<1x8x8x4xf32>) outs(%{{.*}} : tensor<1x8x8x4xf32>)
+// CHECK:         %[[PADDED:.*]] = tensor.pad %[[RELU]] low[0, 1, 1, 0] high[0, 1, 1, 0]
+// CHECK:         %[[CONV1:.*]] = linalg.conv_2d_nhwc_hwcf {{.*}} ins(%[[PADDED]], %{{.*}} : tensor<1x10x10x4xf32>, tensor<3x3x4x4xf32>)
+// CHECK:         %[[RESULT:.*]] = linalg.generic {{.*}} ins(%[[CONV1]] : tensor<1x8x8x4xf32>) outs(%{{.*}} : tensor<1x4x8x8xf32>)
+// CHECK-NOT:     linalg.conv_2d_nchw_fchw
+// CHECK:         return %[[RESULT]] : tensor<1x4x8x8xf32>
+func.func @conv_relu_conv(%input: !torch.vtensor<[1,4,8,8],f32>, %weight0: !torch.vtensor<[4,4,3,3],f32>, %weight1: !torch.vtensor<[4,4,3,3],f32>) -> !torch.vtensor<[1,4,8,8],f32> {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int1 = torch.constant.int 1
+  %ones = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %empty = torch.prim.ListConstruct  : () -> !torch.list<int>
+  %0 = torch.aten.convolution %input, %weight0, %none, %ones, %ones, %ones, %false, %empty, %int1 : !torch.vtensor<[1,4,8,8],f32>, !torch.vtensor<[4,4,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,4,8,8],f32>
+  %1 = torch.aten.relu %0 : !torch.vtensor<[1,4,8,8],f32> -> !torch.vtensor<[1,4,8,8],f32>
+  %2 = torch.aten.convolution %1, %weight1, %none, %ones, %ones, %ones, %false, %empty, %int1 : !torch.vtensor<[1,4,8,8],f32>, !torch.vtensor<[4,4,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,4,8,8],f32>
+  return %2 : !torch.vtensor<[1,4,8,8],f32>
+}
@@ -0,0 +1,19 @@
+// RUN: torch-mlir-opt %s -pass-pipeline='builtin.module(torch-backend-to-linalg-on-tensors-backend-pipeline{fuse-elementwise=true})' | FileCheck %s
+
+// CHECK-LABEL: func.func @elementwise_chain(
+// CHECK-SAME:      %[[ARG0:.*]]: tensor<4x8xf32>, %[[ARG1:.*]]: tensor<4x8xf32>) -> tensor<4x8xf32> {
+// CHECK:         %[[EMPTY:.*]] = tensor.empty() : tensor<4x8xf32>
+// CHECK:         %[[RESULT:.*]] = linalg.generic
+// CHECK-SAME:        ins(%[[ARG0]], %[[ARG1]] : tensor<4x8xf32>, tensor<4x8xf32>) outs(%[[EMPTY]] : tensor<4x8xf32>)
+// CHECK:           math.tanh
+// CHECK:           arith.mulf
+// CHECK:           arith.addf
+// CHECK-NOT:     linalg.generic
+// CHECK:         return %[[RESULT]] : tensor<4x8xf32>
+func.func @elementwise_chain(%arg0: !torch.vtensor<[4,8],f32>, %arg1: !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4,8],f32> {
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[4,8],f32> -> !torch.vtensor<[4,8],f32>
+  %1 = torch.aten.mul.Tensor %0, %arg1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[4,8],f32> -> !torch.vtensor<[4,8],f32>
+  %2 = torch.aten.add.Tensor %1, %arg0, %int1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[4,8],f32>, !torch.int -> !torch.vtensor<[4,8],f32>
+  return %2 : !torch.vtensor<[4,8],f32>
+}
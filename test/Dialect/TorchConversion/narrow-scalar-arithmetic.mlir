@@ -0,0 +1,174 @@
+// RUN: torch-mlir-opt %s -torch-narrow-scalar-arithmetic -split-input-file | FileCheck %s
+
+// The conversion of the multiplier to the type of the elements is done once,
+// outside of the body.
+// CHECK-LABEL: func.func @hoist_scalar_conversion(
+// CHECK-SAME:      %[[ARG:.*]]: tensor<?xf32>, %[[SCALAR:.*]]: f64) -> tensor<?xf32> {
+// CHECK:         %[[MULTIPLIER:.*]] = arith.truncf %[[SCALAR]] : f64 to f32
+// CHECK:         linalg.generic
+// CHECK:         ^bb0(%[[IN:.*]]: f32, %{{.*}}: f32):
+// CHECK-NEXT:      %[[MUL:.*]] = arith.mulf %[[IN]], %[[MULTIPLIER]] : f32
+// CHECK-NEXT:      linalg.yield %[[MUL]] : f32
+#map = affine_map<(d0) -> (d0)>
+func.func @hoist_scalar_conversion(%arg0: tensor<?xf32>, %arg1: f64) -> tensor<?xf32> {
+  %c0 = arith.constant 0 : index
+  %dim = tensor.dim %arg0, %c0 : tensor<?xf32>
+  %0 = tensor.empty(%dim) : tensor<?xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel"]} ins(%arg0 : tensor<?xf32>) outs(%0 : tensor<?xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %2 = arith.truncf %arg1 : f64 to f32
+    %3 = arith.mulf %in, %2 : f32
+    linalg.yield %3 : f32
+  } -> tensor<?xf32>
+  return %1 : tensor<?xf32>
+}
+
+// -----
+
+// The ops that depend on the iteration indices stay in the body.
+// CHECK-LABEL: func.func @keep_index_dependent_ops(
+// CHECK:         linalg.generic
+// CHECK:           linalg.index 0
+// CHECK:           arith.index_cast
+func.func @keep_index_dependent_ops(%arg0: tensor<4xi64>) -> tensor<4xi64> {
+  %1 = linalg.generic {indexing_maps = [affine_map<(d0) -> (d0)>], iterator_types = ["parallel"]} outs(%arg0 : tensor<4xi64>) {
+  ^bb0(%out: i64):
+    %2 = linalg.index 0 : index
+    %3 = arith.index_cast %2 : index to i64
+    linalg.yield %3 : i64
+  } -> tensor<4xi64>
+  return %1 : tensor<4xi64>
+}
+
+// -----
+
+// The ops that can't be executed speculatively stay in the body, since it
+// doesn't run when the iteration domain is empty.
+// CHECK-LABEL: func.func @keep_unspeculatable_ops(
+// CHECK:         linalg.generic
+// CHECK:         ^bb0(%[[IN:.*]]: i64, %{{.*}}: i64):
+// CHECK-NEXT:      %[[DIV:.*]] = arith.divsi
+// CHECK-NEXT:      %[[ADD:.*]] = arith.addi %[[IN]], %[[DIV]] : i64
+// CHECK-NEXT:      linalg.yield %[[ADD]] : i64
+#map = affine_map<(d0) -> (d0)>
+func.func @keep_unspeculatable_ops(%arg0: tensor<?xi64>, %arg1: i64, %arg2: i64) -> tensor<?xi64> {
+  %c0 = arith.constant 0 : index
+  %dim = tensor.dim %arg0, %c0 : tensor<?xi64>
+  %0 = tensor.empty(%dim) : tensor<?xi64>
+  %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel"]} ins(%arg0 : tensor<?xi64>) outs(%0 : tensor<?xi64>) {
+  ^bb0(%in: i64, %out: i64):
+    %2 = arith.divsi %arg1, %arg2 : i64
+    %3 = arith.addi %in, %2 : i64
+    linalg.yield %3 : i64
+  } -> tensor<?xi64>
+  return %1 : tensor<?xi64>
+}
+
+// -----
+
+// A product of two f32 values rounded to f64 and then to f32 is their f32
+// product.
+// CHECK-LABEL: func.func @narrow_float_mul(
+// CHECK-SAME:      %[[A:.*]]: f32, %[[B:.*]]: f32) -> f32 {
+// CHECK:         %[[MUL:.*]] = arith.mulf %[[A]], %[[B]] : f32
+// CHECK:         return %[[MUL]] : f32
+func.func @narrow_float_mul(%arg0: f32, %arg1: f32) -> f32 {
+  %0 = arith.extf %arg0 : f32 to f64
+  %1 = arith.extf %arg1 : f32 to f64
+  %2 = arith.mulf %0, %1 : f64
+  %3 = arith.truncf %2 : f64 to f32
+  return %3 : f32
+}
+
+// -----
+
+// The constants that are exactly representable in f32 are narrowed.
+// CHECK-LABEL: func.func @narrow_float_constant(
+// CHECK-SAME:      %[[A:.*]]: f32) -> f32 {
+// CHECK:         %[[HALF:.*]] = arith.constant 5.000000e-01 : f32
+// CHECK:         %[[MUL:.*]] = arith.mulf %[[A]], %[[HALF]] : f32
+// CHECK:         return %[[MUL]] : f32
+func.func @narrow_float_constant(%arg0: f32) -> f32 {
+  %cst = arith.constant 5.000000e-01 : f64
+  %0 = arith.extf %arg0 : f32 to f64
+  %1 = arith.mulf %0, %cst : f64
+  %2 = arith.truncf %1 : f64 to f32
+  return %2 : f32
+}
+
+// -----
+
+// Neither 0.1 in f64 nor the result of a chain of f64 ops is exactly
+// representable in f32.
+// CHECK-LABEL: func.func @keep_inexact_float_ops(
+// CHECK:         arith.mulf %{{.*}}, %{{.*}} : f64
+// CHECK:         arith.mulf %{{.*}}, %{{.*}} : f64
+// CHECK:         arith.addf %{{.*}}, %{{.*}} : f64
+func.func @keep_inexact_float_ops(%arg0: f32, %arg1: f32) -> (f32, f32) {
+  %cst = arith.constant 1.000000e-01 : f64
+  %0 = arith.extf %arg0 : f32 to f64
+  %1 = arith.extf %arg1 : f32 to f64
+  %2 = arith.mulf %0, %cst : f64
+  %3 = arith.truncf %2 : f64 to f32
+  %4 = arith.mulf %0, %1 : f64
+  %5 = arith.addf %4, %1 : f64
+  %6 = arith.truncf %5 : f64 to f32
+  return %3, %6 : f32, f32
+}
+
+// -----
+
+// The remainder by 7 fits in i32, and so does the sum of it and 1.
+// CHECK-LABEL: func.func @narrow_integer_arithmetic(
+// CHECK-SAME:      %[[ARG:.*]]: i32) -> i64 {
+// CHECK-DAG:     %[[C7:.*]] = arith.constant 7 : i32
+// CHECK-DAG:     %[[C1:.*]] = arith.constant 1 : i32
+// CHECK:         %[[REM:.*]] = arith.remsi %[[ARG]], %[[C7]] : i32
+// CHECK:         %[[ADD:.*]] = arith.addi %[[REM]], %[[C1]] : i32
+// CHECK:         %[[EXT:.*]] = arith.extsi %[[ADD]] : i32 to i64
+// CHECK:         return %[[EXT]] : i64
+func.func @narrow_integer_arithmetic(%arg0: i32) -> i64 {
+  %c7 = arith.constant 7 : i64
+  %c1 = arith.constant 1 : i64
+  %0 = arith.extsi %arg0 : i32 to i64
+  %1 = arith.remsi %0, %c7 : i64
+  %2 = arith.addi %1, %c1 : i64
+  return %2 : i64
+}
+
+// -----
+
+// The sum of two i32 values may not fit in i32, and nothing is known about
+// the range of an i64 argument.
+// CHECK-LABEL: func.func @keep_wide_integer_arithmetic(
+// CHECK:         arith.addi %{{.*}}, %{{.*}} : i64
+// CHECK:         arith.muli %{{.*}}, %{{.*}} : i64
+func.func @keep_wide_integer_arithmetic(%arg0: i32, %arg1: i32, %arg2: i64) -> (i64, i64) {
+  %c2 = arith.constant 2 : i64
+  %0 = arith.extsi %arg0 : i32 to i64
+  %1 = arith.extsi %arg1 : i32 to i64
+  %2 = arith.addi %0, %1 : i64
+  %3 = arith.muli %arg2, %c2 : i64
+  return %2, %3 : i64, i64
+}
+
+// -----
+
+// An i64 in a small range converts exactly to f32.
+// CHECK-LABEL: func.func @narrow_int_to_float(
+// CHECK-SAME:      %[[A:.*]]: f32, %[[ARG:.*]]: i32) -> f32 {
+// CHECK:         %[[REM:.*]] = arith.remsi
+// CHECK:         %[[EXT:.*]] = arith.extsi %[[REM]] : i32 to i64
+// CHECK:         %[[FLOAT:.*]] = arith.sitofp %[[EXT]] : i64 to f32
+// CHECK:         %[[ADD:.*]] = arith.addf %[[A]], %[[FLOAT]] : f32
+// CHECK:         return %[[ADD]] : f32
+func.func @narrow_int_to_float(%arg0: f32, %arg1: i32) -> f32 {
+  %c100 = arith.constant 100 : i64
+  %0 = arith.extsi %arg1 : i32 to i64
+  %1 = arith.remsi %0, %c100 : i64
+  %2 = arith.sitofp %1 : i64 to f64
+  %3 = arith.extf %arg0 : f32 to f64
+  %4 = arith.addf %3, %2 : f64
+  %5 = arith.truncf %4 : f64 to f32
+  return %5 : f32
+}
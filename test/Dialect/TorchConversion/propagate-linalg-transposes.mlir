@@ -0,0 +1,107 @@
+// RUN: torch-mlir-opt %s -torch-propagate-linalg-transposes -split-input-file | FileCheck %s
+
+#map = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+#to_nchw = affine_map<(d0, d1, d2, d3) -> (d0, d3, d1, d2)>
+#to_nhwc = affine_map<(d0, d1, d2, d3) -> (d0, d2, d3, d1)>
+#channel = affine_map<(d0, d1, d2, d3) -> (d1)>
+
+// CHECK-DAG:   #[[MAP:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+// CHECK-DAG:   #[[CHANNEL:.*]] = affine_map<(d0, d1, d2, d3) -> (d3)>
+// CHECK-LABEL: func.func @cancel_through_elementwise(
+// CHECK-SAME:      %[[ARG:.*]]: tensor<1x8x8x16xf32>,
+// CHECK-SAME:      %[[BIAS:.*]]: tensor<16xf32>) -> tensor<1x8x8x16xf32> {
+// CHECK:         %[[EMPTY:.*]] = tensor.empty() : tensor<1x8x8x16xf32>
+// CHECK:         %[[RESULT:.*]] = linalg.generic {indexing_maps = [#[[MAP]], #[[CHANNEL]], #[[MAP]]]
+// CHECK-SAME:        ins(%[[ARG]], %[[BIAS]] : tensor<1x8x8x16xf32>, tensor<16xf32>)
+// CHECK-SAME:        outs(%[[EMPTY]] : tensor<1x8x8x16xf32>)
+// CHECK:           arith.addf
+// CHECK:           arith.maxf
+// CHECK-NOT:     linalg.generic
+// CHECK:         return %[[RESULT]] : tensor<1x8x8x16xf32>
+func.func @cancel_through_elementwise(%arg0: tensor<1x8x8x16xf32>, %bias: tensor<16xf32>) -> tensor<1x8x8x16xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<1x16x8x8xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #to_nchw], iterator_types = ["parallel", "parallel", "parallel", "parallel"]} ins(%arg0 : tensor<1x8x8x16xf32>) outs(%0 : tensor<1x16x8x8xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    linalg.yield %in : f32
+  } -> tensor<1x16x8x8xf32>
+  %2 = tensor.empty() : tensor<1x16x8x8xf32>
+  %3 = linalg.generic {indexing_maps = [#map, #channel, #map], iterator_types = ["parallel", "parallel", "parallel", "parallel"]} ins(%1, %bias : tensor<1x16x8x8xf32>, tensor<16xf32>) outs(%2 : tensor<1x16x8x8xf32>) {
+  ^bb0(%in: f32, %b: f32, %out: f32):
+    %6 = arith.addf %in, %b : f32
+    %7 = arith.maxf %6, %cst : f32
+    linalg.yield %7 : f32
+  } -> tensor<1x16x8x8xf32>
+  %4 = tensor.empty() : tensor<1x8x8x16xf32>
+  %5 = linalg.generic {indexing_maps = [#map, #to_nhwc], iterator_types = ["parallel", "parallel", "parallel", "parallel"]} ins(%3 : tensor<1x16x8x8xf32>) outs(%4 : tensor<1x8x8x16xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    linalg.yield %in : f32
+  } -> tensor<1x8x8x16xf32>
+  return %5 : tensor<1x8x8x16xf32>
+}
+
+// -----
+
+#map = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+#to_nchw = affine_map<(d0, d1, d2, d3) -> (d0, d3, d1, d2)>
+#to_nhwc = affine_map<(d0, d1, d2, d3) -> (d0, d2, d3, d1)>
+
+// CHECK-LABEL: func.func @pad_and_pool(
+// CHECK-SAME:      %[[ARG:.*]]: tensor<1x8x8x16xf32>) -> tensor<1x5x5x16xf32> {
+// CHECK:         %[[PAD:.*]] = tensor.pad %[[ARG]] low[0, 1, 1, 0] high[0, 1, 1, 0]
+// CHECK:         } : tensor<1x8x8x16xf32> to tensor<1x10x10x16xf32>
+// CHECK:         %[[FILL:.*]] = linalg.fill ins(%{{.*}} : f32) outs(%{{.*}} : tensor<1x5x5x16xf32>)
+// CHECK:         %[[POOL:.*]] = linalg.pooling_nhwc_max
+// CHECK-SAME:        ins(%[[PAD]], %{{.*}} : tensor<1x10x10x16xf32>, tensor<2x2xf32>)
+// CHECK-SAME:        outs(%[[FILL]] : tensor<1x5x5x16xf32>)
+// CHECK-NOT:     linalg.generic
+// CHECK:         return %[[POOL]] : tensor<1x5x5x16xf32>
+func.func @pad_and_pool(%arg0: tensor<1x8x8x16xf32>) -> tensor<1x5x5x16xf32> {
+  %cst = arith.constant 0xFF800000 : f32
+  %0 = tensor.empty() : tensor<1x16x8x8xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #to_nchw], iterator_types = ["parallel", "parallel", "parallel", "parallel"]} ins(%arg0 : tensor<1x8x8x16xf32>) outs(%0 : tensor<1x16x8x8xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    linalg.yield %in : f32
+  } -> tensor<1x16x8x8xf32>
+  %padded = tensor.pad %1 low[0, 0, 1, 1] high[0, 0, 1, 1] {
+  ^bb0(%i0: index, %i1: index, %i2: index, %i3: index):
+    tensor.yield %cst : f32
+  } : tensor<1x16x8x8xf32> to tensor<1x16x10x10xf32>
+  %2 = tensor.empty() : tensor<1x16x5x5xf32>
+  %3 = linalg.fill ins(%cst : f32) outs(%2 : tensor<1x16x5x5xf32>) -> tensor<1x16x5x5xf32>
+  %window = tensor.empty() : tensor<2x2xf32>
+  %4 = linalg.pooling_nchw_max {dilations = dense<1> : vector<2xi64>, strides = dense<2> : vector<2xi64>} ins(%padded, %window : tensor<1x16x10x10xf32>, tensor<2x2xf32>) outs(%3 : tensor<1x16x5x5xf32>) -> tensor<1x16x5x5xf32>
+  %5 = tensor.empty() : tensor<1x5x5x16xf32>
+  %6 = linalg.generic {indexing_maps = [#map, #to_nhwc], iterator_types = ["parallel", "parallel", "parallel", "parallel"]} ins(%4 : tensor<1x16x5x5xf32>) outs(%5 : tensor<1x5x5x16xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    linalg.yield %in : f32
+  } -> tensor<1x5x5x16xf32>
+  return %6 : tensor<1x5x5x16xf32>
+}
+
+// -----
+
+#map = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+#to_nhwc = affine_map<(d0, d1, d2, d3) -> (d0, d2, d3, d1)>
+
+// CHECK-DAG:   #[[MAP:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+// CHECK-DAG:   #[[PERM:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d3, d1, d2)>
+// CHECK-LABEL: func.func @compose_transposes(
+// CHECK-SAME:      %[[ARG:.*]]: tensor<1x2x3x4xf32>) -> tensor<1x4x2x3xf32> {
+// CHECK:         %[[RESULT:.*]] = linalg.generic {indexing_maps = [#[[MAP]], #[[PERM]]]
+// CHECK-SAME:        ins(%[[ARG]] : tensor<1x2x3x4xf32>)
+// CHECK-NOT:     linalg.generic
+// CHECK:         return %[[RESULT]] : tensor<1x4x2x3xf32>
+func.func @compose_transposes(%arg0: tensor<1x2x3x4xf32>) -> tensor<1x4x2x3xf32> {
+  %0 = tensor.empty() : tensor<1x3x4x2xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #to_nhwc], iterator_types = ["parallel", "parallel", "parallel", "parallel"]} ins(%arg0 : tensor<1x2x3x4xf32>) outs(%0 : tensor<1x3x4x2xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    linalg.yield %in : f32
+  } -> tensor<1x3x4x2xf32>
+  %2 = tensor.empty() : tensor<1x4x2x3xf32>
+  %3 = linalg.generic {indexing_maps = [#map, #to_nhwc], iterator_types = ["parallel", "parallel", "parallel", "parallel"]} ins(%1 : tensor<1x3x4x2xf32>) outs(%2 : tensor<1x4x2x3xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    linalg.yield %in : f32
+  } -> tensor<1x4x2x3xf32>
+  return %3 : tensor<1x4x2x3xf32>
+}
@@ -0,0 +1,73 @@
+// RUN: torch-mlir-opt %s -torch-propagate-tosa-transposes -split-input-file | FileCheck %s
+
+// CHECK-LABEL: func.func @cancel_through_elementwise(
+// CHECK-SAME:      %[[ARG:.*]]: tensor<1x8x8x16xf32>,
+// CHECK-SAME:      %[[SCALE:.*]]: tensor<1x16x1x1xf32>) -> tensor<1x8x8x16xf32> {
+// CHECK-NOT:     "tosa.transpose"
+// CHECK:         %[[RESHAPED_SCALE:.*]] = "tosa.reshape"(%[[SCALE]]) <{new_shape = array<i64: 1, 1, 1, 16>}> : (tensor<1x16x1x1xf32>) -> tensor<1x1x1x16xf32>
+// CHECK:         %[[MUL:.*]] = "tosa.mul"(%[[ARG]], %[[RESHAPED_SCALE]]) <{shift = 0 : i32}> : (tensor<1x8x8x16xf32>, tensor<1x1x1x16xf32>) -> tensor<1x8x8x16xf32>
+// CHECK:         %[[CLAMP:.*]] = "tosa.clamp"(%[[MUL]]) {{.*}} : (tensor<1x8x8x16xf32>) -> tensor<1x8x8x16xf32>
+// CHECK-NOT:     "tosa.transpose"
+// CHECK:         return %[[CLAMP]] : tensor<1x8x8x16xf32>
+func.func @cancel_through_elementwise(%arg0: tensor<1x8x8x16xf32>, %scale: tensor<1x16x1x1xf32>) -> tensor<1x8x8x16xf32> {
+  %to_nchw = "tosa.const"() <{value = dense<[0, 3, 1, 2]> : tensor<4xi32>}> : () -> tensor<4xi32>
+  %to_nhwc = "tosa.const"() <{value = dense<[0, 2, 3, 1]> : tensor<4xi32>}> : () -> tensor<4xi32>
+  %0 = "tosa.transpose"(%arg0, %to_nchw) : (tensor<1x8x8x16xf32>, tensor<4xi32>) -> tensor<1x16x8x8xf32>
+  %1 = "tosa.mul"(%0, %scale) <{shift = 0 : i32}> : (tensor<1x16x8x8xf32>, tensor<1x16x1x1xf32>) -> tensor<1x16x8x8xf32>
+  %2 = "tosa.clamp"(%1) <{max_fp = 3.40282347E+38 : f32, max_int = 2147483647 : i64, min_fp = 0.000000e+00 : f32, min_int = 0 : i64}> : (tensor<1x16x8x8xf32>) -> tensor<1x16x8x8xf32>
+  %3 = "tosa.transpose"(%2, %to_nhwc) : (tensor<1x16x8x8xf32>, tensor<4xi32>) -> tensor<1x8x8x16xf32>
+  return %3 : tensor<1x8x8x16xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @residual_add(
+// CHECK-SAME:      %[[LHS:.*]]: tensor<1x8x8x16xf32>,
+// CHECK-SAME:      %[[RHS:.*]]: tensor<1x8x8x16xf32>) -> tensor<1x8x8x16xf32> {
+// CHECK-NOT:     "tosa.transpose"
+// CHECK:         %[[ADD:.*]] = "tosa.add"(%[[LHS]], %[[RHS]]) : (tensor<1x8x8x16xf32>, tensor<1x8x8x16xf32>) -> tensor<1x8x8x16xf32>
+// CHECK-NOT:     "tosa.transpose"
+// CHECK:         return %[[ADD]] : tensor<1x8x8x16xf32>
+func.func @residual_add(%arg0: tensor<1x8x8x16xf32>, %arg1: tensor<1x8x8x16xf32>) -> tensor<1x8x8x16xf32> {
+  %to_nchw = "tosa.const"() <{value = dense<[0, 3, 1, 2]> : tensor<4xi32>}> : () -> tensor<4xi32>
+  %to_nhwc = "tosa.const"() <{value = dense<[0, 2, 3, 1]> : tensor<4xi32>}> : () -> tensor<4xi32>
+  %0 = "tosa.transpose"(%arg0, %to_nchw) : (tensor<1x8x8x16xf32>, tensor<4xi32>) -> tensor<1x16x8x8xf32>
+  %1 = "tosa.transpose"(%arg1, %to_nchw) : (tensor<1x8x8x16xf32>, tensor<4xi32>) -> tensor<1x16x8x8xf32>
+  %2 = "tosa.add"(%0, %1) : (tensor<1x16x8x8xf32>, tensor<1x16x8x8xf32>) -> tensor<1x16x8x8xf32>
+  %3 = "tosa.transpose"(%2, %to_nhwc) : (tensor<1x16x8x8xf32>, tensor<4xi32>) -> tensor<1x8x8x16xf32>
+  return %3 : tensor<1x8x8x16xf32>
+}
+
+// -----
+
+// The transpose isn't sunk when another operand would need its own transpose.
+// CHECK-LABEL: func.func @full_operand(
+// CHECK-SAME:      %[[LHS:.*]]: tensor<1x8x8x16xf32>,
+// CHECK-SAME:      %[[RHS:.*]]: tensor<1x16x8x8xf32>) -> tensor<1x16x8x8xf32> {
+// CHECK:         %[[TRANSPOSE:.*]] = "tosa.transpose"(%[[LHS]], %{{.*}}) : (tensor<1x8x8x16xf32>, tensor<4xi32>) -> tensor<1x16x8x8xf32>
+// CHECK:         %[[ADD:.*]] = "tosa.add"(%[[TRANSPOSE]], %[[RHS]]) : (tensor<1x16x8x8xf32>, tensor<1x16x8x8xf32>) -> tensor<1x16x8x8xf32>
+// CHECK:         return %[[ADD]] : tensor<1x16x8x8xf32>
+func.func @full_operand(%arg0: tensor<1x8x8x16xf32>, %arg1: tensor<1x16x8x8xf32>) -> tensor<1x16x8x8xf32> {
+  %to_nchw = "tosa.const"() <{value = dense<[0, 3, 1, 2]> : tensor<4xi32>}> : () -> tensor<4xi32>
+  %0 = "tosa.transpose"(%arg0, %to_nchw) : (tensor<1x8x8x16xf32>, tensor<4xi32>) -> tensor<1x16x8x8xf32>
+  %1 = "tosa.add"(%0, %arg1) : (tensor<1x16x8x8xf32>, tensor<1x16x8x8xf32>) -> tensor<1x16x8x8xf32>
+  return %1 : tensor<1x16x8x8xf32>
+}
+
+// -----
+
+// The transpose isn't sunk when it has other uses, since it would then stay
+// alongside the transpose of the result.
+// CHECK-LABEL: func.func @shared_transpose(
+// CHECK-SAME:      %[[ARG:.*]]: tensor<1x8x8x16xf32>) -> (tensor<1x16x8x8xf32>, tensor<1x16x8x8xf32>) {
+// CHECK:         %[[TRANSPOSE:.*]] = "tosa.transpose"(%[[ARG]], %{{.*}}) : (tensor<1x8x8x16xf32>, tensor<4xi32>) -> tensor<1x16x8x8xf32>
+// CHECK:         %[[TANH:.*]] = "tosa.tanh"(%[[TRANSPOSE]]) : (tensor<1x16x8x8xf32>) -> tensor<1x16x8x8xf32>
+// CHECK:         %[[EXP:.*]] = "tosa.exp"(%[[TRANSPOSE]]) : (tensor<1x16x8x8xf32>) -> tensor<1x16x8x8xf32>
+// CHECK:         return %[[TANH]], %[[EXP]] : tensor<1x16x8x8xf32>, tensor<1x16x8x8xf32>
+func.func @shared_transpose(%arg0: tensor<1x8x8x16xf32>) -> (tensor<1x16x8x8xf32>, tensor<1x16x8x8xf32>) {
+  %to_nchw = "tosa.const"() <{value = dense<[0, 3, 1, 2]> : tensor<4xi32>}> : () -> tensor<4xi32>
+  %0 = "tosa.transpose"(%arg0, %to_nchw) : (tensor<1x8x8x16xf32>, tensor<4xi32>) -> tensor<1x16x8x8xf32>
+  %1 = "tosa.tanh"(%0) : (tensor<1x16x8x8xf32>) -> tensor<1x16x8x8xf32>
+  %2 = "tosa.exp"(%0) : (tensor<1x16x8x8xf32>) -> tensor<1x16x8x8xf32>
+  return %1, %2 : tensor<1x16x8x8xf32>, tensor<1x16x8x8xf32>
+}
@@ -0,0 +1,76 @@
+// RUN: torch-mlir-opt %s -torch-simplify-index-casts -split-input-file | FileCheck %s
+
+// The size computed from the dims of the tensor stays in index.
+// CHECK-LABEL: func.func @size_computation(
+// CHECK-SAME:      %[[ARG:.*]]: tensor<?x?xf32>) -> tensor<?xf32> {
+// CHECK-DAG:     %[[C0:.*]] = arith.constant 0 : index
+// CHECK-DAG:     %[[C1:.*]] = arith.constant 1 : index
+// CHECK:         %[[DIM0:.*]] = tensor.dim %[[ARG]], %[[C0]] : tensor<?x?xf32>
+// CHECK:         %[[DIM1:.*]] = tensor.dim %[[ARG]], %[[C1]] : tensor<?x?xf32>
+// CHECK:         %[[SIZE:.*]] = arith.muli %[[DIM0]], %[[DIM1]] : index
+// CHECK-NOT:     arith.index_cast
+// CHECK:         tensor.empty(%[[SIZE]]) : tensor<?xf32>
+func.func @size_computation(%arg0: tensor<?x?xf32>) -> tensor<?xf32> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %dim0 = tensor.dim %arg0, %c0 : tensor<?x?xf32>
+  %dim0_i64 = arith.index_cast %dim0 : index to i64
+  %dim1 = tensor.dim %arg0, %c1 : tensor<?x?xf32>
+  %dim1_i64 = arith.index_cast %dim1 : index to i64
+  %size_i64 = arith.muli %dim0_i64, %dim1_i64 : i64
+  %size = arith.index_cast %size_i64 : i64 to index
+  %0 = tensor.empty(%size) : tensor<?xf32>
+  return %0 : tensor<?xf32>
+}
+
+// -----
+
+// The comparison of a dim with a constant is done on indices.
+// CHECK-LABEL: func.func @compare_dim(
+// CHECK-DAG:     %[[C0:.*]] = arith.constant 0 : index
+// CHECK-DAG:     %[[C4:.*]] = arith.constant 4 : index
+// CHECK:         %[[DIM:.*]] = tensor.dim %{{.*}}, %[[C0]] : tensor<?xf32>
+// CHECK:         %[[CMP:.*]] = arith.cmpi slt, %[[DIM]], %[[C4]] : index
+// CHECK:         return %[[CMP]] : i1
+func.func @compare_dim(%arg0: tensor<?xf32>) -> i1 {
+  %c0 = arith.constant 0 : index
+  %c4_i64 = arith.constant 4 : i64
+  %dim = tensor.dim %arg0, %c0 : tensor<?xf32>
+  %dim_i64 = arith.index_cast %dim : index to i64
+  %0 = arith.cmpi slt, %dim_i64, %c4_i64 : i64
+  return %0 : i1
+}
+
+// -----
+
+// An integer op with other uses is kept in i64.
+// CHECK-LABEL: func.func @other_uses(
+// CHECK:         %[[SUM:.*]] = arith.addi %{{.*}}, %{{.*}} : i64
+// CHECK:         %[[INDEX:.*]] = arith.index_cast %[[SUM]] : i64 to index
+// CHECK:         return %[[INDEX]], %[[SUM]] : index, i64
+func.func @other_uses(%arg0: i64, %arg1: i64) -> (index, i64) {
+  %0 = arith.addi %arg0, %arg1 : i64
+  %1 = arith.index_cast %0 : i64 to index
+  return %1, %0 : index, i64
+}
+
+// -----
+
+// Integers narrower than index wrap at their own width, so the ops on them
+// are kept.
+// CHECK-LABEL: func.func @narrow_integers(
+// CHECK:         %[[DIM:.*]] = arith.index_cast %{{.*}} : index to i32
+// CHECK:         %[[SUM:.*]] = arith.addi %[[DIM]], %[[DIM]] : i32
+// CHECK:         %[[INDEX:.*]] = arith.index_cast %[[SUM]] : i32 to index
+// CHECK:         %[[CMP:.*]] = arith.cmpi slt, %[[DIM]], %{{.*}} : i32
+// CHECK:         return %[[INDEX]], %[[CMP]] : index, i1
+func.func @narrow_integers(%arg0: tensor<?xf32>) -> (index, i1) {
+  %c0 = arith.constant 0 : index
+  %c4_i32 = arith.constant 4 : i32
+  %dim = tensor.dim %arg0, %c0 : tensor<?xf32>
+  %dim_i32 = arith.index_cast %dim : index to i32
+  %sum_i32 = arith.addi %dim_i32, %dim_i32 : i32
+  %sum = arith.index_cast %sum_i32 : i32 to index
+  %0 = arith.cmpi slt, %dim_i32, %c4_i32 : i32
+  return %sum, %0 : index, i1
+}
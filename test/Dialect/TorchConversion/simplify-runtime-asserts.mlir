@@ -0,0 +1,55 @@
+// RUN: torch-mlir-opt %s -torch-simplify-runtime-asserts -split-input-file | FileCheck %s
+// RUN: torch-mlir-opt %s -torch-simplify-runtime-asserts="trust-shapes=true" -split-input-file | FileCheck %s --check-prefix=TRUST
+
+#map = affine_map<(d0) -> (d0)>
+
+// The result of the generic has the size of %arg0, so comparing the two sizes
+// is known to hold, but not comparing them to the size of %arg1.
+// CHECK-LABEL: func.func @equal_sizes(
+// CHECK-SAME:      %[[ARG0:.*]]: tensor<?xf32>, %[[ARG1:.*]]: tensor<?xf32>)
+// CHECK-NOT:     "same size"
+// CHECK:         %[[CMP:.*]] = arith.cmpi eq
+// CHECK:         cf.assert %[[CMP]], "maybe different sizes"
+// CHECK-NOT:     cf.assert
+// TRUST-LABEL: func.func @equal_sizes(
+// TRUST-NOT:     cf.assert
+func.func @equal_sizes(%arg0: tensor<?xf32>, %arg1: tensor<?xf32>) -> tensor<?xf32> {
+  %c0 = arith.constant 0 : index
+  %dim = tensor.dim %arg0, %c0 : tensor<?xf32>
+  %empty = tensor.empty(%dim) : tensor<?xf32>
+  %0 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel"]} ins(%arg0 : tensor<?xf32>) outs(%empty : tensor<?xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    linalg.yield %in : f32
+  } -> tensor<?xf32>
+  %cast = tensor.cast %0 : tensor<?xf32> to tensor<?xf32>
+  %dim0 = tensor.dim %cast, %c0 : tensor<?xf32>
+  %dim1 = tensor.dim %arg0, %c0 : tensor<?xf32>
+  %dim2 = tensor.dim %arg1, %c0 : tensor<?xf32>
+  %int0 = arith.index_cast %dim0 : index to i64
+  %int1 = arith.index_cast %dim1 : index to i64
+  %same = arith.cmpi eq, %int0, %int1 : i64
+  cf.assert %same, "same size"
+  %maybe = arith.cmpi eq, %dim0, %dim2 : index
+  cf.assert %maybe, "maybe different sizes"
+  return %0 : tensor<?xf32>
+}
+
+// -----
+
+// Sizes are non-negative, and a disjunction holds if one of its operands does.
+// CHECK-LABEL: func.func @non_negative(
+// CHECK-NOT:     cf.assert
+// CHECK:         return
+func.func @non_negative(%arg0: tensor<?xf32>, %arg1: i64) -> tensor<?xf32> {
+  %c0 = arith.constant 0 : index
+  %c0_i64 = arith.constant 0 : i64
+  %dim = tensor.dim %arg0, %c0 : tensor<?xf32>
+  %int = arith.index_cast %dim : index to i64
+  %ge = arith.cmpi sge, %int, %c0_i64 : i64
+  cf.assert %ge, "size is non-negative"
+  %le = arith.cmpi sle, %c0_i64, %int : i64
+  %unknown = arith.cmpi eq, %arg1, %int : i64
+  %or = arith.ori %unknown, %le : i1
+  cf.assert %or, "size equals the argument or is non-negative"
+  return %arg0 : tensor<?xf32>
+}
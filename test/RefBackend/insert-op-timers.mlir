@@ -0,0 +1,45 @@
+// RUN: torch-mlir-opt %s -refback-insert-op-timers -split-input-file | FileCheck %s
+
+#map = affine_map<(d0) -> (d0)>
+
+// CHECK-LABEL: module attributes {refback.op_timer_names = ["linalg.generic loc(\22model.py\22:3:7)", "linalg.fill loc(\22model.py\22:4:7)"]} {
+// CHECK-LABEL:   func.func @forward(
+// CHECK-SAME:        %[[ARG:.*]]: memref<4xf32>, %[[OUT:.*]]: memref<4xf32>) {
+// CHECK:           %[[ID0:.*]] = arith.constant 0 : i64
+// CHECK:           call @refbackend_op_timer_start(%[[ID0]]) : (i64) -> ()
+// CHECK:           linalg.generic
+// CHECK:             math.tanh
+// CHECK-NOT:         call
+// CHECK:             linalg.yield
+// CHECK:           }
+// CHECK:           call @refbackend_op_timer_stop(%[[ID0]]) : (i64) -> ()
+// CHECK:           %[[ID1:.*]] = arith.constant 1 : i64
+// CHECK:           call @refbackend_op_timer_start(%[[ID1]]) : (i64) -> ()
+// CHECK:           linalg.fill
+// CHECK:           call @refbackend_op_timer_stop(%[[ID1]]) : (i64) -> ()
+// CHECK:           return
+// CHECK:         func.func private @refbackend_op_timer_start(i64) attributes {llvm.emit_c_interface}
+// CHECK:         func.func private @refbackend_op_timer_stop(i64) attributes {llvm.emit_c_interface}
+module {
+  func.func @forward(%arg0: memref<4xf32>, %arg1: memref<4xf32>) {
+    linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel"]} ins(%arg0 : memref<4xf32>) outs(%arg1 : memref<4xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %0 = math.tanh %in : f32
+      linalg.yield %0 : f32
+    } loc("model.py":3:7)
+    %cst = arith.constant 0.000000e+00 : f32
+    linalg.fill ins(%cst : f32) outs(%arg0 : memref<4xf32>) loc("model.py":4:7)
+    return
+  }
+}
+
+// -----
+
+// Modules without linalg or TMTensor ops are left alone.
+// CHECK-NOT:     refback.op_timer_names
+// CHECK-LABEL:   func.func @no_ops(
+// CHECK-NOT:       call
+// CHECK-NOT:     refbackend_op_timer_start
+func.func @no_ops(%arg0: memref<4xf32>) -> memref<4xf32> {
+  return %arg0 : memref<4xf32>
+}
@@ -0,0 +1,92 @@
+// RUN: torch-mlir-opt %s -refback-munge-calling-conventions="destination-passing=true" -split-input-file | FileCheck %s
+
+// CHECK-LABEL:   module attributes {refback.destination_passing_results = {alloc_result = [memref<2x3xf32>], returns_arg = [memref<4xi64>]}, refback.donatable_inputs = {alloc_result = {{\[}}[0]], returns_arg = {{\[}}[0]]}, refback.donated_inputs = {alloc_result = [-1], returns_arg = [-1]}} {
+// CHECK-LABEL:   func.func @alloc_result(
+// CHECK-SAME:            %[[ARG0:.*]]: memref<2x3xf32>,
+// CHECK-SAME:            %[[OUT:.*]]: memref<2x3xf32>) attributes {llvm.emit_c_interface} {
+// CHECK-NOT:       memref.alloc
+// CHECK:           linalg.copy ins(%[[ARG0]] : memref<2x3xf32>) outs(%[[OUT]] : memref<2x3xf32>)
+// CHECK-NOT:       memref.copy
+// CHECK:           return
+// CHECK:         }
+func.func @alloc_result(%arg0: memref<2x3xf32>) -> memref<2x3xf32> {
+  %0 = memref.alloc() : memref<2x3xf32>
+  linalg.copy ins(%arg0 : memref<2x3xf32>) outs(%0 : memref<2x3xf32>)
+  return %0 : memref<2x3xf32>
+}
+
+// CHECK-LABEL:   func.func @returns_arg(
+// CHECK-SAME:            %[[ARG0:.*]]: memref<4xi64>,
+// CHECK-SAME:            %[[OUT:.*]]: memref<4xi64>) attributes {llvm.emit_c_interface} {
+// CHECK:           memref.copy %[[ARG0]], %[[OUT]] : memref<4xi64> to memref<4xi64>
+// CHECK:           return
+// CHECK:         }
+func.func @returns_arg(%arg0: memref<4xi64>) -> memref<4xi64> {
+  return %arg0 : memref<4xi64>
+}
+
+// Dynamically shaped functions keep the default calling convention.
+// CHECK-LABEL:   func.func @dynamic(
+// CHECK-SAME:            %[[ARG0:.*]]: memref<*xf32>) attributes {llvm.emit_c_interface} {
+// CHECK:           call @refbackend_consume_func_return_mrf32(
+func.func @dynamic(%arg0: memref<?xf32>) -> memref<?xf32> {
+  return %arg0 : memref<?xf32>
+}
+
+// -----
+
+// Returning the same buffer twice only elides the first copy.
+// CHECK-LABEL:   module attributes {{.*}}refback.donatable_inputs = {same_result_twice = {{\[}}[0], [0]]}, refback.donated_inputs = {same_result_twice = [-1, -1]}} {
+// CHECK-LABEL:   func.func @same_result_twice(
+// CHECK-SAME:            %[[ARG0:.*]]: memref<3xf32>,
+// CHECK-SAME:            %[[OUT0:.*]]: memref<3xf32>,
+// CHECK-SAME:            %[[OUT1:.*]]: memref<3xf32>) attributes {llvm.emit_c_interface} {
+// CHECK:           linalg.copy ins(%[[ARG0]] : memref<3xf32>) outs(%[[OUT0]] : memref<3xf32>)
+// CHECK:           memref.copy %[[OUT0]], %[[OUT1]] : memref<3xf32> to memref<3xf32>
+// CHECK:           return
+func.func @same_result_twice(%arg0: memref<3xf32>) -> (memref<3xf32>, memref<3xf32>) {
+  %0 = memref.alloc() : memref<3xf32>
+  linalg.copy ins(%arg0 : memref<3xf32>) outs(%0 : memref<3xf32>)
+  return %0, %0 : memref<3xf32>, memref<3xf32>
+}
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#transpose = affine_map<(d0, d1) -> (d1, d0)>
+
+// Arguments can only be donated to results written elementwise from them, or
+// after they were last read.
+// CHECK-LABEL:   module attributes {{.*}}refback.donatable_inputs = {read_after_write = {{\[}}[1]], transposed = {{\[}}[]]}, refback.donated_inputs = {read_after_write = [-1], transposed = [-1]}} {
+// CHECK-LABEL:   func.func @transposed(
+func.func @transposed(%arg0: memref<3x3xf32>) -> memref<3x3xf32> {
+  %0 = memref.alloc() : memref<3x3xf32>
+  linalg.generic {indexing_maps = [#transpose, #map], iterator_types = ["parallel", "parallel"]} ins(%arg0 : memref<3x3xf32>) outs(%0 : memref<3x3xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    linalg.yield %in : f32
+  }
+  return %0 : memref<3x3xf32>
+}
+
+// CHECK-LABEL:   func.func @read_after_write(
+func.func @read_after_write(%arg0: memref<3x3xf32>, %arg1: memref<3x3xf32>) -> memref<3x3xf32> {
+  %0 = memref.alloc() : memref<3x3xf32>
+  linalg.copy ins(%arg1 : memref<3x3xf32>) outs(%0 : memref<3x3xf32>)
+  linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg0 : memref<3x3xf32>) outs(%0 : memref<3x3xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %1 = arith.addf %in, %out : f32
+    linalg.yield %1 : f32
+  }
+  return %0 : memref<3x3xf32>
+}
+
+// -----
+
+// Scalar results keep the default calling convention.
+// CHECK-LABEL:   func.func @scalar_result(
+// CHECK-SAME:            %[[ARG0:.*]]: memref<*xi64>) attributes {llvm.emit_c_interface} {
+// CHECK:           call @refbackend_consume_func_return_i64(
+func.func @scalar_result(%arg0: memref<i64>) -> i64 {
+  %0 = memref.load %arg0[] : memref<i64>
+  return %0 : i64
+}
@@ -0,0 +1,35 @@
+// RUN: torch-mlir-opt %s -refback-munge-calling-conventions -split-input-file -verify-diagnostics | FileCheck %s
+
+// Functions with preallocated outputs use destination passing without the
+// option, and their donated arguments are reused for the results they can be
+// donated to, at most once each.
+// CHECK-LABEL:   module attributes {refback.destination_passing_results = {donated = [memref<3xf32>, memref<3xf32>]}, refback.donatable_inputs = {donated = {{\[}}[1], [0, 1]]}, refback.donated_inputs = {donated = [1, -1]}} {
+// CHECK-LABEL:   func.func @donated(
+// CHECK-SAME:            %[[ARG0:.*]]: memref<3xf32>,
+// CHECK-SAME:            %[[ARG1:.*]]: memref<3xf32> {torch.donated},
+// CHECK-SAME:            %[[OUT0:.*]]: memref<3xf32>,
+// CHECK-SAME:            %[[OUT1:.*]]: memref<3xf32>) attributes {llvm.emit_c_interface, torch.preallocated_outputs} {
+func.func @donated(%arg0: memref<3xf32>, %arg1: memref<3xf32> {torch.donated}) -> (memref<3xf32>, memref<3xf32>) attributes {torch.preallocated_outputs} {
+  %0 = memref.alloc() : memref<3xf32>
+  linalg.copy ins(%arg1 : memref<3xf32>) outs(%0 : memref<3xf32>)
+  %1 = memref.alloc() : memref<3xf32>
+  linalg.copy ins(%arg0 : memref<3xf32>) outs(%1 : memref<3xf32>)
+  return %0, %1 : memref<3xf32>, memref<3xf32>
+}
+
+// Other functions keep the default calling convention.
+// CHECK-LABEL:   func.func @not_preallocated(
+// CHECK-SAME:            %[[ARG0:.*]]: memref<*xf32>) attributes {llvm.emit_c_interface} {
+// CHECK:           call @refbackend_consume_func_return_mrf32(
+func.func @not_preallocated(%arg0: memref<3xf32>) -> memref<3xf32> {
+  return %arg0 : memref<3xf32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @dynamic(
+// CHECK-SAME:            %[[ARG0:.*]]: memref<*xf32>) attributes {llvm.emit_c_interface, torch.preallocated_outputs} {
+// expected-warning @+1 {{cannot use destination passing for a function with preallocated outputs}}
+func.func @dynamic(%arg0: memref<?xf32>) -> memref<?xf32> attributes {torch.preallocated_outputs} {
+  return %arg0 : memref<?xf32>
+}
@@ -0,0 +1,69 @@
+// RUN: torch-mlir-opt %s -pass-pipeline='builtin.module(func.func(refback-pack-constant-weights{k-tile-size=2 n-tile-size=2}))' -split-input-file | FileCheck %s
+// RUN: echo '{"linalg.matmul:?x4xi32,4x4xi32,?x4xi32": {"cache_tile_size": 4, "vector_tile_size": 2}}' > %t.json
+// RUN: torch-mlir-opt %s -pass-pipeline='builtin.module(func.func(refback-pack-constant-weights{k-tile-size=2 n-tile-size=2 tuning-db=%t.json}))' -split-input-file | FileCheck %s --check-prefix=TUNED
+
+// CHECK-DAG:   #[[LHS_MAP:.*]] = affine_map<(d0, d1, d2, d3, d4) -> (d0, d2, d3)>
+// CHECK-DAG:   #[[WEIGHT_MAP:.*]] = affine_map<(d0, d1, d2, d3, d4) -> (d1, d2, d3, d4)>
+// CHECK-DAG:   #[[OUT_MAP:.*]] = affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d4)>
+// CHECK-LABEL:   func.func @matmul(
+// CHECK-SAME:        %[[ARG0:.*]]: tensor<?x4xi32>, %[[ARG1:.*]]: tensor<?x4xi32>) -> tensor<?x4xi32> {
+// CHECK:           %[[PACKED:.*]] = arith.constant dense<{{\[\[\[\[}}0, 1], [4, 5]], {{\[\[}}8, 9], [12, 13]]], {{\[\[\[}}2, 3], [6, 7]], {{\[\[}}10, 11], [14, 15]]]]> : tensor<2x2x2x2xi32>
+// CHECK:           %[[LHS:.*]] = tensor.expand_shape %[[ARG0]] {{\[\[}}0], [1, 2]] : tensor<?x4xi32> into tensor<?x2x2xi32>
+// CHECK:           %[[INIT:.*]] = tensor.expand_shape %[[ARG1]] {{\[\[}}0], [1, 2]] : tensor<?x4xi32> into tensor<?x2x2xi32>
+// CHECK:           %[[MATMUL:.*]] = linalg.generic {indexing_maps = [#[[LHS_MAP]], #[[WEIGHT_MAP]], #[[OUT_MAP]]], iterator_types = ["parallel", "parallel", "reduction", "reduction", "parallel"]} ins(%[[LHS]], %[[PACKED]] : tensor<?x2x2xi32>, tensor<2x2x2x2xi32>) outs(%[[INIT]] : tensor<?x2x2xi32>) {
+// CHECK:             arith.muli
+// CHECK:             arith.addi
+// CHECK:           %[[RESULT:.*]] = tensor.collapse_shape %[[MATMUL]] {{\[\[}}0], [1, 2]] : tensor<?x2x2xi32> into tensor<?x4xi32>
+// CHECK:           return %[[RESULT]] : tensor<?x4xi32>
+
+// The tuning database blocks this weight along K by 4 instead.
+// TUNED-LABEL:   func.func @matmul(
+// TUNED:           arith.constant {{.*}} : tensor<2x1x4x2xi32>
+func.func @matmul(%arg0: tensor<?x4xi32>, %arg1: tensor<?x4xi32>) -> tensor<?x4xi32> {
+  %weight = arith.constant dense<[[0, 1, 2, 3], [4, 5, 6, 7], [8, 9, 10, 11], [12, 13, 14, 15]]> : tensor<4x4xi32>
+  %0 = linalg.matmul ins(%arg0, %weight : tensor<?x4xi32>, tensor<4x4xi32>) outs(%arg1 : tensor<?x4xi32>) -> tensor<?x4xi32>
+  return %0 : tensor<?x4xi32>
+}
+
+// -----
+
+// The [N, K] weight of a matmul by a transposed weight is packed like the
+// [K, N] one of a `linalg.matmul`.
+// CHECK-LABEL:   func.func @matmul_transposed_weight(
+// CHECK:           %[[PACKED:.*]] = arith.constant dense<{{\[\[\[\[}}0, 2], [1, 3]]], {{\[\[\[}}4, 6], [5, 7]]]]> : tensor<2x1x2x2xi32>
+// CHECK:           linalg.generic {{.*}} ins(%{{.*}}, %[[PACKED]] : tensor<3x1x2xi32>, tensor<2x1x2x2xi32>) outs(%{{.*}} : tensor<3x2x2xi32>)
+// CHECK-NOT:       tensor<4x2xi32>
+#map = affine_map<(d0, d1, d2) -> (d0, d2)>
+#map1 = affine_map<(d0, d1, d2) -> (d1, d2)>
+#map2 = affine_map<(d0, d1, d2) -> (d0, d1)>
+func.func @matmul_transposed_weight(%arg0: tensor<3x2xi32>, %arg1: tensor<3x4xi32>) -> tensor<3x4xi32> {
+  %weight = arith.constant dense<[[0, 1], [2, 3], [4, 5], [6, 7]]> : tensor<4x2xi32>
+  %0 = linalg.generic {indexing_maps = [#map, #map1, #map2], iterator_types = ["parallel", "parallel", "reduction"]} ins(%arg0, %weight : tensor<3x2xi32>, tensor<4x2xi32>) outs(%arg1 : tensor<3x4xi32>) {
+  ^bb0(%in: i32, %in_0: i32, %out: i32):
+    %1 = arith.muli %in, %in_0 : i32
+    %2 = arith.addi %1, %out : i32
+    linalg.yield %2 : i32
+  } -> tensor<3x4xi32>
+  return %0 : tensor<3x4xi32>
+}
+
+// -----
+
+// A dim that the tile size doesn't divide is left unblocked.
+// CHECK-LABEL:   func.func @matmul_unblocked_k(
+// CHECK:           arith.constant {{.*}} : tensor<2x1x3x2xi32>
+func.func @matmul_unblocked_k(%arg0: tensor<5x3xi32>, %arg1: tensor<5x4xi32>) -> tensor<5x4xi32> {
+  %weight = arith.constant dense<[[0, 1, 2, 3], [4, 5, 6, 7], [8, 9, 10, 11]]> : tensor<3x4xi32>
+  %0 = linalg.matmul ins(%arg0, %weight : tensor<5x3xi32>, tensor<3x4xi32>) outs(%arg1 : tensor<5x4xi32>) -> tensor<5x4xi32>
+  return %0 : tensor<5x4xi32>
+}
+
+// -----
+
+// Matmuls by weights that are not constants are left alone.
+// CHECK-LABEL:   func.func @matmul_variable_weight(
+// CHECK:           linalg.matmul
+func.func @matmul_variable_weight(%arg0: tensor<4x4xi32>, %arg1: tensor<4x4xi32>, %arg2: tensor<4x4xi32>) -> tensor<4x4xi32> {
+  %0 = linalg.matmul ins(%arg0, %arg1 : tensor<4x4xi32>, tensor<4x4xi32>) outs(%arg2 : tensor<4x4xi32>) -> tensor<4x4xi32>
+  return %0 : tensor<4x4xi32>
+}
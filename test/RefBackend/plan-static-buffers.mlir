@@ -0,0 +1,51 @@
+// RUN: torch-mlir-opt %s -split-input-file -pass-pipeline='builtin.module(func.func(refback-plan-static-buffers))' | FileCheck %s
+
+// Buffers that are never live at the same time share storage.
+// CHECK-LABEL:   func.func @chain(
+// CHECK-SAME:            %[[ARG:.*]]: memref<4x4xf32>) -> memref<4x4xf32> {
+// CHECK:           %[[ARENA:.*]] = memref.alloc() {alignment = 64 : i64} : memref<128xi8>
+// CHECK:           %[[OFFSET0:.*]] = arith.constant 0 : index
+// CHECK:           %[[TMP0:.*]] = memref.view %[[ARENA]][%[[OFFSET0]]][] : memref<128xi8> to memref<4x4xf32>
+// CHECK:           linalg.copy ins(%[[ARG]] : memref<4x4xf32>) outs(%[[TMP0]] : memref<4x4xf32>)
+// CHECK:           %[[OFFSET1:.*]] = arith.constant 64 : index
+// CHECK:           %[[TMP1:.*]] = memref.view %[[ARENA]][%[[OFFSET1]]][] : memref<128xi8> to memref<4x4xf32>
+// CHECK:           linalg.copy ins(%[[TMP0]] : memref<4x4xf32>) outs(%[[TMP1]] : memref<4x4xf32>)
+// CHECK:           %[[OFFSET2:.*]] = arith.constant 0 : index
+// CHECK:           %[[TMP2:.*]] = memref.view %[[ARENA]][%[[OFFSET2]]][] : memref<128xi8> to memref<4x4xf32>
+// CHECK:           linalg.copy ins(%[[TMP1]] : memref<4x4xf32>) outs(%[[TMP2]] : memref<4x4xf32>)
+// CHECK:           %[[RESULT:.*]] = memref.alloc() : memref<4x4xf32>
+// CHECK:           linalg.copy ins(%[[TMP2]] : memref<4x4xf32>) outs(%[[RESULT]] : memref<4x4xf32>)
+// CHECK-NOT:       memref.dealloc {{.*}} : memref<4x4xf32>
+// CHECK:           memref.dealloc %[[ARENA]] : memref<128xi8>
+// CHECK:           return %[[RESULT]] : memref<4x4xf32>
+func.func @chain(%arg0: memref<4x4xf32>) -> memref<4x4xf32> {
+  %0 = memref.alloc() : memref<4x4xf32>
+  linalg.copy ins(%arg0 : memref<4x4xf32>) outs(%0 : memref<4x4xf32>)
+  %1 = memref.alloc() : memref<4x4xf32>
+  linalg.copy ins(%0 : memref<4x4xf32>) outs(%1 : memref<4x4xf32>)
+  memref.dealloc %0 : memref<4x4xf32>
+  %2 = memref.alloc() : memref<4x4xf32>
+  linalg.copy ins(%1 : memref<4x4xf32>) outs(%2 : memref<4x4xf32>)
+  memref.dealloc %1 : memref<4x4xf32>
+  %3 = memref.alloc() : memref<4x4xf32>
+  linalg.copy ins(%2 : memref<4x4xf32>) outs(%3 : memref<4x4xf32>)
+  memref.dealloc %2 : memref<4x4xf32>
+  return %3 : memref<4x4xf32>
+}
+
+// -----
+
+// Dynamically shaped buffers keep using the allocator.
+// CHECK-LABEL:   func.func @dynamic(
+// CHECK-NOT:       memref.view
+// CHECK:           %[[TMP:.*]] = memref.alloc(%{{.*}}) : memref<?xf32>
+// CHECK:           memref.dealloc %[[TMP]] : memref<?xf32>
+func.func @dynamic(%arg0: memref<?xf32>, %arg1: memref<?xf32>) {
+  %c0 = arith.constant 0 : index
+  %dim = memref.dim %arg0, %c0 : memref<?xf32>
+  %0 = memref.alloc(%dim) : memref<?xf32>
+  linalg.copy ins(%arg0 : memref<?xf32>) outs(%0 : memref<?xf32>)
+  linalg.copy ins(%0 : memref<?xf32>) outs(%arg1 : memref<?xf32>)
+  memref.dealloc %0 : memref<?xf32>
+  return
+}
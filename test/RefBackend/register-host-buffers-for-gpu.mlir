@@ -0,0 +1,50 @@
+// RUN: torch-mlir-opt %s -refback-register-host-buffers-for-gpu | FileCheck %s
+// RUN: torch-mlir-opt %s -refback-register-host-buffers-for-gpu="register-arguments=false" | FileCheck %s --check-prefix=NO-ARGS
+
+// CHECK:         memref.global "private" @weight : memref<4xf32> = dense<1.000000e+00>
+memref.global "private" constant @weight : memref<4xf32> = dense<1.0>
+
+// CHECK-LABEL:   func.func @forward(
+// CHECK-SAME:                       %[[ARG:.*]]: memref<*xf32>) {
+// CHECK:           gpu.host_register %[[ARG]] : memref<*xf32>
+// CHECK:           %[[WEIGHT:.*]] = memref.get_global @weight : memref<4xf32>
+// CHECK:           %[[WEIGHT_UNRANKED:.*]] = memref.cast %[[WEIGHT]] : memref<4xf32> to memref<*xf32>
+// CHECK:           gpu.host_register %[[WEIGHT_UNRANKED]] : memref<*xf32>
+// CHECK:           memref.get_global @weight : memref<4xf32>
+// CHECK-NOT:       gpu.host_register
+// CHECK:           %[[TEMP:.*]] = memref.alloc() : memref<4xf32>
+// CHECK:           %[[TEMP_UNRANKED:.*]] = memref.cast %[[TEMP]] : memref<4xf32> to memref<*xf32>
+// CHECK:           gpu.host_register %[[TEMP_UNRANKED]] : memref<*xf32>
+// CHECK:           %[[RESULT:.*]] = memref.alloc() : memref<4xf32>
+// CHECK:           %[[RESULT_UNRANKED:.*]] = memref.cast %[[RESULT]] : memref<4xf32> to memref<*xf32>
+// CHECK:           gpu.host_register %[[RESULT_UNRANKED]] : memref<*xf32>
+// CHECK:           gpu.host_unregister %[[TEMP_UNRANKED]] : memref<*xf32>
+// CHECK-NEXT:      memref.dealloc %[[TEMP]] : memref<4xf32>
+// CHECK-NOT:       gpu.host_unregister %[[RESULT_UNRANKED]]
+// CHECK:           call @refbackend_consume_func_return_mrf32
+// CHECK-NEXT:      gpu.host_unregister %[[ARG]] : memref<*xf32>
+// CHECK-NEXT:      gpu.host_unregister %[[WEIGHT_UNRANKED]] : memref<*xf32>
+// CHECK-NEXT:      return
+
+// NO-ARGS-LABEL:   func.func @forward(
+// NO-ARGS-SAME:                       %[[ARG:.*]]: memref<*xf32>) {
+// NO-ARGS-NOT:       gpu.host_register %[[ARG]]
+// NO-ARGS:           gpu.host_register
+// NO-ARGS-NOT:       gpu.host_unregister %[[ARG]]
+// NO-ARGS:           return
+func.func @forward(%arg0: memref<*xf32>) {
+  %0 = memref.get_global @weight : memref<4xf32>
+  %1 = memref.get_global @weight : memref<4xf32>
+  %2 = memref.cast %arg0 : memref<*xf32> to memref<4xf32>
+  %3 = memref.alloc() : memref<4xf32>
+  memref.copy %2, %3 : memref<4xf32> to memref<4xf32>
+  %4 = memref.alloc() : memref<4xf32>
+  memref.copy %3, %4 : memref<4xf32> to memref<4xf32>
+  memref.copy %1, %4 : memref<4xf32> to memref<4xf32>
+  memref.dealloc %3 : memref<4xf32>
+  %5 = memref.cast %4 : memref<4xf32> to memref<*xf32>
+  call @refbackend_consume_func_return_mrf32(%5) : (memref<*xf32>) -> ()
+  return
+}
+
+func.func private @refbackend_consume_func_return_mrf32(memref<*xf32>)
@@ -0,0 +1,25 @@
+// RUN: echo '{"linalg.matmul:32x32xf32,32x32xf32,32x32xf32": {"cache_tile_size": 0, "vector_tile_size": 0}}' > %t.json
+// RUN: torch-mlir-opt %s -pass-pipeline='builtin.module(func.func(refback-tile-and-vectorize{cache-tile-size=16 vector-tile-size=4 tuning-db=%t.json}))' -split-input-file | FileCheck %s
+
+// The tuning database disables tiling of this matmul.
+// CHECK-LABEL:   func.func @tuned(
+// CHECK-NOT:       scf.for
+// CHECK:           linalg.matmul
+func.func @tuned(%arg0: memref<32x32xf32>, %arg1: memref<32x32xf32>, %arg2: memref<32x32xf32>) {
+  linalg.matmul ins(%arg0, %arg1 : memref<32x32xf32>, memref<32x32xf32>) outs(%arg2 : memref<32x32xf32>)
+  return
+}
+
+// -----
+
+// Ops without an entry use the tile sizes of the pass options.
+// CHECK-LABEL:   func.func @untuned(
+// CHECK:           scf.for
+// CHECK:             scf.for
+// CHECK:               scf.for
+// CHECK:                 vector.transfer_read
+// CHECK-NOT:       linalg.matmul
+func.func @untuned(%arg0: memref<32x16xf32>, %arg1: memref<16x32xf32>, %arg2: memref<32x32xf32>) {
+  linalg.matmul ins(%arg0, %arg1 : memref<32x16xf32>, memref<16x32xf32>) outs(%arg2 : memref<32x32xf32>)
+  return
+}
@@ -0,0 +1,30 @@
+// RUN: torch-mlir-opt %s -pass-pipeline='builtin.module(func.func(refback-tile-and-vectorize{cache-tile-size=16 vector-tile-size=4}))' -split-input-file | FileCheck %s
+
+// CHECK-LABEL:   func.func @matmul(
+// CHECK:           scf.for
+// CHECK:             scf.for
+// CHECK:               scf.for
+// CHECK:                 vector.transfer_read
+// CHECK:                 vector.transfer_write
+// CHECK-NOT:       linalg.matmul
+func.func @matmul(%arg0: memref<32x32xf32>, %arg1: memref<32x32xf32>, %arg2: memref<32x32xf32>) {
+  linalg.matmul ins(%arg0, %arg1 : memref<32x32xf32>, memref<32x32xf32>) outs(%arg2 : memref<32x32xf32>)
+  return
+}
+
+// -----
+
+// Tiles that don't have a static shape are left for convert-linalg-to-loops.
+// CHECK-LABEL:   func.func @dynamic(
+// CHECK:           scf.for
+// CHECK:             linalg.generic
+// CHECK-NOT:       vector.transfer_read
+#map = affine_map<(d0) -> (d0)>
+func.func @dynamic(%arg0: memref<?xf32>, %arg1: memref<?xf32>) {
+  linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel"]} ins(%arg0 : memref<?xf32>) outs(%arg1 : memref<?xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %0 = math.tanh %in : f32
+    linalg.yield %0 : f32
+  }
+  return
+}
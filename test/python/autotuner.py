@@ -0,0 +1,52 @@
+import json
+import os
+import tempfile
+
+import numpy as np
+import torch
+import torch_mlir
+from torch_mlir_e2e_test.linalg_on_tensors_backends.autotuner import \
+    autotune, get_tuning_keys
+from torch_mlir_e2e_test.linalg_on_tensors_backends.refbackend import \
+    RefBackendLinalgOnTensorsBackend
+
+
+# RUN: %PYTHON %s | FileCheck %s
+
+
+class MmModule(torch.nn.Module):
+    def forward(self, x, y):
+        return torch.mm(x, y)
+
+
+def compile_mm():
+    return torch_mlir.compile(MmModule(), [torch.ones(16, 8), torch.ones(8, 4)],
+                              output_type="linalg-on-tensors")
+
+
+# CHECK: linalg.fill:f32,16x4xf32
+# CHECK: linalg.matmul:16x8xf32,8x4xf32,16x4xf32
+for key in get_tuning_keys(compile_mm()):
+    print(key)
+
+x = np.random.rand(16, 8).astype(np.float32)
+y = np.random.rand(8, 4).astype(np.float32)
+with tempfile.TemporaryDirectory() as tmp_dir:
+    tuning_db = os.path.join(tmp_dir, "tuning.json")
+    autotune(compile_mm(), [x, y], tuning_db, cache_tile_sizes=[0, 8],
+             vector_tile_sizes=[0, 4], repeats=1)
+    with open(tuning_db) as f:
+        entries = json.load(f)
+    # CHECK: tuned keys: 2
+    print("tuned keys:", len(entries))
+    # CHECK: tile sizes are candidates: True
+    print("tile sizes are candidates:",
+          all(entry["cache_tile_size"] in (0, 8) and
+              entry["vector_tile_size"] in (0, 4)
+              for entry in entries.values()))
+
+    backend = RefBackendLinalgOnTensorsBackend(optimize=True,
+                                               tuning_db=tuning_db)
+    invoker = backend.load(backend.compile(compile_mm()))
+    # CHECK: results match: True
+    print("results match:", np.allclose(invoker.forward(x, y), x @ y))
@@ -0,0 +1,47 @@
+import os
+import tempfile
+
+import torch
+import torch_mlir
+
+
+# RUN: %PYTHON %s | FileCheck %s
+
+
+class TanhModule(torch.nn.Module):
+    def forward(self, x):
+        return torch.tanh(x)
+
+
+with tempfile.TemporaryDirectory() as cache_dir:
+    first = torch_mlir.compile(TanhModule(), torch.ones(2, 3),
+                               output_type="linalg-on-tensors",
+                               cache_dir=cache_dir)
+    # The Torch backend IR is cached along with the linalg-on-tensors IR.
+    # CHECK: entries after first compile: 2
+    print("entries after first compile:", len(os.listdir(cache_dir)))
+
+    second = torch_mlir.compile(TanhModule(), torch.ones(2, 3),
+                                output_type="linalg-on-tensors",
+                                cache_dir=cache_dir)
+    # CHECK: entries after second compile: 2
+    print("entries after second compile:", len(os.listdir(cache_dir)))
+    # CHECK: cached module matches: True
+    print("cached module matches:", str(first) == str(second))
+
+    # A different output type with different backend legal ops is a different
+    # entry.
+    torch_mlir.compile(TanhModule(), torch.ones(2, 3), output_type="torch",
+                       cache_dir=cache_dir)
+    # CHECK: entries after third compile: 3
+    print("entries after third compile:", len(os.listdir(cache_dir)))
+
+    # With the legal ops of the linalg-on-tensors backend, the Torch backend
+    # IR that was cached when compiling for that backend is reused.
+    torch_mlir.compile(
+        TanhModule(), torch.ones(2, 3), output_type="torch",
+        backend_legal_ops=torch_mlir.BACKEND_LEGAL_OPS[
+            torch_mlir.OutputType.LINALG_ON_TENSORS],
+        cache_dir=cache_dir)
+    # CHECK: entries after fourth compile: 3
+    print("entries after fourth compile:", len(os.listdir(cache_dir)))
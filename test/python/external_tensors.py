@@ -0,0 +1,68 @@
+import json
+import os
+import struct
+import tempfile
+
+import torch
+import torch_mlir
+from torch_mlir.external_tensors import save_external_tensors
+
+
+# RUN: %PYTHON %s | FileCheck %s
+
+
+class LinearModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+        torch.manual_seed(0)
+        self.linear = torch.nn.Linear(16, 8)
+        # Not contiguous, so it is written a chunk at a time.
+        self.register_buffer("scale", torch.rand(8, 16).t())
+
+    def forward(self, x):
+        return self.linear(x) * self.scale.sum()
+
+
+def read_safetensors(path):
+    with open(path, "rb") as f:
+        header_size, = struct.unpack("<Q", f.read(8))
+        header = json.loads(f.read(header_size))
+        data = f.read()
+    tensors = {}
+    for name, entry in header.items():
+        begin, end = entry["data_offsets"]
+        assert entry["dtype"] == "F32"
+        tensors[name] = torch.frombuffer(bytearray(data[begin:end]),
+                                         dtype=torch.float32).reshape(
+                                             entry["shape"])
+    return tensors
+
+
+model = LinearModule()
+with tempfile.TemporaryDirectory() as directory:
+    path = os.path.join(directory, "weights.safetensors")
+    module = torch_mlir.compile(model, torch.ones(2, 16),
+                                output_type="torch",
+                                external_tensors_file=path)
+    # The module only references the tensors by name.
+    # CHECK: torch.vtensor.external "linear.weight" : !torch.vtensor<[8,16],f32>
+    # CHECK: torch.vtensor.external "linear.bias" : !torch.vtensor<[8],f32>
+    # CHECK: torch.vtensor.external "scale" : !torch.vtensor<[16,8],f32>
+    print(module)
+
+    tensors = read_safetensors(path)
+    # CHECK: names: ['linear.bias', 'linear.weight', 'scale']
+    print("names:", sorted(tensors))
+    # CHECK: contents match: True
+    print("contents match:",
+          all(torch.equal(tensors[name], tensor)
+              for name, tensor in model.state_dict().items()))
+
+    # Chunks smaller than a row split the rows.
+    save_external_tensors(module, torch.jit.script(model), path,
+                          chunk_bytes=12)
+    tensors = read_safetensors(path)
+    # CHECK: contents match with small chunks: True
+    print("contents match with small chunks:",
+          all(torch.equal(tensors[name], tensor)
+              for name, tensor in model.state_dict().items()))
@@ -45,8 +45,9 @@ annotator.exportPath(class_type, ['s', 'forward'])
 annotator.annotateArgs(class_type, ['forward'], [
     None,
     ((1024, 2), torch.float32, False),
-    ((42, -1, 7), torch.int8, True),
+    ((42, -1, 7), torch.int8, True, True),
 ])
+annotator.annotatePreallocatedOutputs(class_type, ['forward'])
 
 # "Change detector" test + "documentation" for the repr of `ClassAnnotator`.
 # This is semi-load-bearing because users interact with this class and repr
@@ -68,10 +69,12 @@ annotator.annotateArgs(class_type, ['forward'], [
 # CHECK-NEXT:     }
 # CHECK-NEXT:     MethodAnnotation('forward') {
 # CHECK-NEXT:       isExported = true
+# CHECK-NEXT:       hasPreallocatedOutputs = false
 # CHECK-NEXT:       argAnnotations = <none>
 # CHECK-NEXT:     }
 # CHECK-NEXT:     MethodAnnotation('not_exported_method') {
 # CHECK-NEXT:       isExported = false
+# CHECK-NEXT:       hasPreallocatedOutputs = false
 # CHECK-NEXT:       argAnnotations = <none>
 # CHECK-NEXT:     }
 # CHECK-NEXT:   }
@@ -87,21 +90,25 @@ annotator.annotateArgs(class_type, ['forward'], [
 # CHECK-NEXT:     }
 # CHECK-NEXT:     MethodAnnotation('forward') {
 # CHECK-NEXT:       isExported = false
+# CHECK-NEXT:       hasPreallocatedOutputs = true
 # CHECK-NEXT:       argAnnotations =
 # CHECK-NEXT:         ArgAnnotation(0) {
 # CHECK-NEXT:           dtype = <none>
 # CHECK-NEXT:           shape = <none>
 # CHECK-NEXT:           hasValueSemantics = false
+# CHECK-NEXT:           isDonated = false
 # CHECK-NEXT:         }
 # CHECK-NEXT:         ArgAnnotation(1) {
 # CHECK-NEXT:           dtype = Float
 # CHECK-NEXT:           shape = [1024, 2]
 # CHECK-NEXT:           hasValueSemantics = false
+# CHECK-NEXT:           isDonated = false
 # CHECK-NEXT:         }
 # CHECK-NEXT:         ArgAnnotation(2) {
 # CHECK-NEXT:           dtype = Char
 # CHECK-NEXT:           shape = [42, -1, 7]
 # CHECK-NEXT:           hasValueSemantics = true
+# CHECK-NEXT:           isDonated = true
 # CHECK-NEXT:         }
 # CHECK-NEXT:     }
 # CHECK-NEXT:   }
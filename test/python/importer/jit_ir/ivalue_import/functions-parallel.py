@@ -0,0 +1,53 @@
+# -*- Python -*-
+# This file is licensed under a pytorch-style license
+# See LICENSE.pytorch for license information.
+
+import typing
+
+import torch
+from torch_mlir.dialects.torch.importer.jit_ir import ClassAnnotator, ImportOptions, ModuleBuilder
+
+# RUN: %PYTHON %s | FileCheck %s
+
+def add(x, y):
+    return x + y
+
+def mul(x, y):
+    return x * y
+
+class TestModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+    def forward(self, x):
+        return self.first(x) + self.second(x)
+    @torch.jit.export
+    def first(self, x):
+        return add(x, x)
+    @torch.jit.export
+    def second(self, x):
+        return mul(x, x)
+
+test_module = TestModule()
+recursivescriptmodule = torch.jit.script(test_module)
+
+def import_module(in_parallel: bool) -> str:
+    mb = ModuleBuilder()
+    import_options = ImportOptions()
+    import_options.importFunctionsInParallel = in_parallel
+    # TODO: Automatically handle unpacking Python class RecursiveScriptModule into the underlying ScriptModule.
+    mb.import_module(recursivescriptmodule._c, ClassAnnotator(), import_options)
+    return str(mb.module)
+
+serial = import_module(False)
+parallel = import_module(True)
+
+# The functions are the same, in the same order, whether they are imported in
+# parallel or not.
+# CHECK: SAME: True
+print("SAME:", serial == parallel)
+# CHECK-DAG: func.func private @__torch__.TestModule.forward
+# CHECK-DAG: func.func private @__torch__.TestModule.first
+# CHECK-DAG: func.func private @__torch__.TestModule.second
+# CHECK-DAG: func.func private @__torch__.add
+# CHECK-DAG: func.func private @__torch__.mul
+print(parallel)
@@ -21,6 +21,9 @@ class TestModule(torch.nn.Module):
                                                         2,
                                                         bias_=False,
                                                         dtype=torch.qint8)
+        self.per_channel = torch.quantize_per_channel(
+            torch.rand(3, 4), torch.tensor([0.1, 0.2, 0.3], dtype=torch.double),
+            torch.tensor([0, 1, 2]), 0, torch.qint8)
     # CHECK: %[[SCALE:.*]] = torch.constant.float
     # CHECK: %[[ZERO_POINT:.*]] = torch.constant.int 0
     # CHECK: %[[INT_REPR:.*]] = torch.tensor.literal({{.*}}) : !torch.tensor<[2,5],si8>
@@ -36,6 +39,14 @@ class TestModule(torch.nn.Module):
     def test_linear_no_bias(self, t):
         return self.linear_no_bias(t)
 
+    # CHECK: %[[INT_REPR:.*]] = torch.tensor.literal({{.*}}) : !torch.tensor<[3,4],si8>
+    # CHECK: %[[SCALES:.*]] = torch.tensor.literal({{.*}}) : !torch.tensor<[3],f64>
+    # CHECK: %[[ZERO_POINTS:.*]] = torch.tensor.literal({{.*}}) : !torch.tensor<[3],si64>
+    # CHECK: %[[PER_CHANNEL:.*]] = torch.per_channel_affine.create %[[INT_REPR]], %[[SCALES]], %[[ZERO_POINTS]], %{{.*}} : !torch.tensor<[3,4],si8>, !torch.tensor<[3],f64>, !torch.tensor<[3],si64>, !torch.int -> !torch.tensor<[3,4],!torch.qint8>
+    @torch.jit.export
+    def test_per_channel(self):
+        return self.per_channel
+
 
 test_module = TestModule()
 recursivescriptmodule = torch.jit.script(test_module)
@@ -0,0 +1,44 @@
+# -*- Python -*-
+# This file is licensed under a pytorch-style license
+# See LICENSE.pytorch for license information.
+
+import typing
+
+import torch
+from torch_mlir.dialects.torch.importer.jit_ir import ClassAnnotator, ImportOptions, ModuleBuilder
+
+# RUN: %PYTHON %s | torch-mlir-opt | FileCheck %s
+
+mb = ModuleBuilder()
+
+class TestModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+        self.arange = torch.nn.Parameter(torch.arange(3.0))
+        self.ones_bool = torch.ones(1, dtype=torch.bool)
+        self.transposed = torch.ones(2, 3).t()
+
+# CHECK: %[[ARANGE:.*]] = torch.tensor.literal(dense_resource<arange> : tensor<3xf32>) : !torch.tensor<[3],f32>
+# Bool tensors are still copied into a DenseElementsAttr.
+# CHECK: %[[ONES_BOOL:.*]] = torch.tensor.literal(dense<true> : tensor<1xi1>) : !torch.tensor<[1],i1>
+# Non-contiguous tensors are made contiguous first, and that copy is referenced.
+# CHECK: %[[TRANSPOSED:.*]] = torch.tensor.literal(dense_resource<transposed> : tensor<3x2xf32>) : !torch.tensor<[3,2],f32>
+# CHECK: torch.nn_module  {
+# CHECK:   torch.slot "arange", %[[ARANGE]] : !torch.tensor<[3],f32>
+# CHECK:   torch.slot "ones_bool", %[[ONES_BOOL]] : !torch.tensor<[1],i1>
+# CHECK:   torch.slot "transposed", %[[TRANSPOSED]] : !torch.tensor<[3,2],f32>
+# CHECK: }
+# CHECK: {-#
+# CHECK:   dialect_resources: {
+# CHECK:     builtin: {
+# CHECK:       arange: "0x04000000000000000000803F00000040",
+test_module = TestModule()
+recursivescriptmodule = torch.jit.script(test_module)
+
+import_options = ImportOptions()
+import_options.importTensorsAsDenseResources = True
+
+class_annotator = ClassAnnotator()
+
+mb.import_module(recursivescriptmodule._c, class_annotator, import_options)
+mb.module.operation.print()
@@ -0,0 +1,44 @@
+# -*- Python -*-
+# This file is licensed under a pytorch-style license
+# See LICENSE.pytorch for license information.
+
+import typing
+
+import torch
+from torch_mlir.dialects.torch.importer.jit_ir import ClassAnnotator, ImportOptions, ModuleBuilder
+
+# RUN: %PYTHON %s | torch-mlir-opt | FileCheck %s
+
+mb = ModuleBuilder()
+
+class Submodule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+        self.weight = torch.nn.Parameter(torch.ones(4, 3))
+
+class TestModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+        self.l1 = Submodule()
+        self.ones_qint8 = torch.quantize_per_tensor(torch.ones(1), 1.0, 0, torch.qint8)
+        self.tensors = [torch.ones(2), torch.zeros(2)]
+
+# Names are the keys of the tensors in the root module's `state_dict()`.
+# CHECK: %[[WEIGHT:.*]] = torch.tensor.external "l1.weight" : !torch.tensor<[4,3],f32>
+# CHECK: torch.slot "weight", %[[WEIGHT]] : !torch.tensor<[4,3],f32>
+# Quantized tensors only externalize their integer representation.
+# CHECK: %[[ONES_QINT8_DATA:.*]] = torch.tensor.external "ones_qint8" : !torch.tensor<[1],si8>
+# CHECK: torch.per_tensor_affine.create %[[ONES_QINT8_DATA]]
+# Tensors that share an attribute path get unique names.
+# CHECK: torch.tensor.external "tensors" : !torch.tensor<[2],f32>
+# CHECK: torch.tensor.external "tensors_1" : !torch.tensor<[2],f32>
+test_module = TestModule()
+recursivescriptmodule = torch.jit.script(test_module)
+
+import_options = ImportOptions()
+import_options.externalizeTensors = True
+
+class_annotator = ClassAnnotator()
+
+mb.import_module(recursivescriptmodule._c, class_annotator, import_options)
+mb.module.operation.print()
@@ -0,0 +1,41 @@
+# -*- Python -*-
+# This file is licensed under a pytorch-style license
+# See LICENSE.pytorch for license information.
+
+import typing
+
+import torch
+from torch_mlir.dialects.torch.importer.jit_ir import ClassAnnotator, ImportOptions, ModuleBuilder
+
+# RUN: %PYTHON %s | torch-mlir-opt | FileCheck %s
+
+mb = ModuleBuilder()
+
+class TestModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+        dense = torch.tensor([[1.0, 0.0], [0.0, 2.0]])
+        self.coo = dense.to_sparse()
+        self.csr = dense.to_sparse_csr()
+
+# CHECK-DAG: #[[COO:.*]] = #sparse_tensor.encoding<{{.*}}"compressed-nu", "singleton"{{.*}}>
+# CHECK-DAG: #[[CSR:.*]] = #sparse_tensor.encoding<{{.*}}"dense", "compressed"{{.*}}>
+# CHECK: %[[COO_DATA:.*]] = torch.vtensor.literal(dense<{{\[\[}}1.000000e+00, 0.000000e+00], [0.000000e+00, 2.000000e+00]]> : tensor<2x2xf32>) : !torch.vtensor<[2,2],f32>
+# CHECK: %[[COO_TENSOR:.*]] = torch.tensor_static_info_cast %[[COO_DATA]] : !torch.vtensor<[2,2],f32> to !torch.vtensor<[2,2],f32,#[[COO]]>
+# CHECK: %[[CSR_DATA:.*]] = torch.vtensor.literal(dense<{{\[\[}}1.000000e+00, 0.000000e+00], [0.000000e+00, 2.000000e+00]]> : tensor<2x2xf32>) : !torch.vtensor<[2,2],f32>
+# CHECK: %[[CSR_TENSOR:.*]] = torch.tensor_static_info_cast %[[CSR_DATA]] : !torch.vtensor<[2,2],f32> to !torch.vtensor<[2,2],f32,#[[CSR]]>
+# CHECK: torch.nn_module  {
+# CHECK:   torch.slot "coo", %[[COO_TENSOR]] : !torch.vtensor<[2,2],f32,#[[COO]]>
+# CHECK:   torch.slot "csr", %[[CSR_TENSOR]] : !torch.vtensor<[2,2],f32,#[[CSR]]>
+# CHECK: }
+test_module = TestModule()
+recursivescriptmodule = torch.jit.script(test_module)
+
+import_options = ImportOptions()
+import_options.assumeTensorsHaveValueSemantics = True
+
+class_annotator = ClassAnnotator()
+
+# TODO: Automatically handle unpacking Python class RecursiveScriptModule into the underlying ScriptModule.
+mb.import_module(recursivescriptmodule._c, class_annotator, import_options)
+mb.module.operation.print()
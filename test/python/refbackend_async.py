@@ -0,0 +1,46 @@
+import torch
+import torch_mlir
+from torch_mlir_e2e_test.linalg_on_tensors_backends.refbackend import \
+    RefBackendLinalgOnTensorsBackend
+
+
+# RUN: %PYTHON %s | FileCheck %s
+
+
+class MatmulTanhModule(torch.nn.Module):
+    def forward(self, x, y):
+        return torch.tanh(torch.mm(x, y)), x + y
+
+
+def compile_and_run(x, y, **kwargs):
+    backend = RefBackendLinalgOnTensorsBackend(**kwargs)
+    compiled = backend.compile(torch_mlir.compile(
+        MatmulTanhModule(), [x, y], output_type="linalg-on-tensors"))
+    uses_async_runtime = "mlirAsyncRuntime" in str(compiled)
+    return uses_async_runtime, backend.load(compiled).forward(x, y)
+
+
+generator = torch.Generator().manual_seed(0)
+x = torch.rand(64, 48, generator=generator)
+y = torch.rand(48, 64, generator=generator)
+
+# With more than one thread, the parallel loops run as tasks on the async
+# runtime, and compute the same results as the serial lowering.
+uses_async_runtime, (tanh, add) = compile_and_run(x, y, num_threads=4)
+# CHECK: uses async runtime: True
+print("uses async runtime:", uses_async_runtime)
+# CHECK: results match: True
+print("results match:",
+      torch.allclose(tanh, torch.tanh(torch.mm(x, y))) and
+      torch.allclose(add, x + y))
+
+# The loops that are tiled and vectorized stay sequential, but the results of
+# the optimized pipeline still match.
+_, (tanh, add) = compile_and_run(x, y, optimize=True, num_threads=4)
+# CHECK: optimized results match: True
+print("optimized results match:",
+      torch.allclose(tanh, torch.tanh(torch.mm(x, y))) and
+      torch.allclose(add, x + y))
+
+# CHECK: serial uses async runtime: False
+print("serial uses async runtime:", compile_and_run(x, y)[0])
@@ -0,0 +1,42 @@
+import os
+import tempfile
+
+import torch
+import torch_mlir
+from torch_mlir_e2e_test.linalg_on_tensors_backends.refbackend import \
+    RefBackendLinalgOnTensorsBackend
+
+
+# RUN: %PYTHON %s | FileCheck %s
+
+
+class TanhModule(torch.nn.Module):
+    def forward(self, x):
+        return torch.tanh(x)
+
+
+def compile_tanh():
+    return torch_mlir.compile(TanhModule(), torch.ones(2, 3),
+                              output_type="linalg-on-tensors")
+
+
+with tempfile.TemporaryDirectory() as cache_dir:
+    backend = RefBackendLinalgOnTensorsBackend(cache_dir=cache_dir)
+    first = backend.load(backend.compile(compile_tanh()))
+    # CHECK: entries after first compile: 1
+    print("entries after first compile:", len(os.listdir(cache_dir)))
+
+    # A fresh backend, as in another process, finds the lowered module in the
+    # cache, and loading it again reuses the JIT-compiled invoker.
+    backend = RefBackendLinalgOnTensorsBackend(cache_dir=cache_dir)
+    second = backend.load(backend.compile(compile_tanh()))
+    # CHECK: entries after second compile: 1
+    print("entries after second compile:", len(os.listdir(cache_dir)))
+    # CHECK: invoker reused: True
+    print("invoker reused:", first is second)
+
+    x = torch.rand(2, 3)
+    # CHECK: results match: True
+    print("results match:",
+          torch.allclose(torch.from_numpy(second.forward(x.numpy())),
+                         torch.tanh(x)))
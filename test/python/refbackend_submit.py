@@ -0,0 +1,63 @@
+import threading
+
+import torch
+import torch_mlir
+from torch_mlir_e2e_test.linalg_on_tensors_backends.refbackend import \
+    RefBackendLinalgOnTensorsBackend
+
+
+# RUN: %PYTHON %s | FileCheck %s
+
+
+class MatmulTanhModule(torch.nn.Module):
+    def forward(self, x, y):
+        return torch.tanh(torch.mm(x, y)), x + y
+
+
+backend = RefBackendLinalgOnTensorsBackend()
+invoker = backend.load(backend.compile(torch_mlir.compile(
+    MatmulTanhModule(), [torch.ones(16, 16), torch.ones(16, 16)],
+    output_type="linalg-on-tensors")))
+
+generator = torch.Generator().manual_seed(0)
+inputs = [(torch.rand(16, 16, generator=generator),
+           torch.rand(16, 16, generator=generator)) for _ in range(16)]
+
+# The submitted calls complete in the order they were submitted.
+completed = []
+completed_lock = threading.Lock()
+
+
+def record_completion(index):
+    def callback(future):
+        with completed_lock:
+            completed.append(index)
+    return callback
+
+
+futures = []
+for index, (x, y) in enumerate(inputs):
+    future = invoker.submit("forward", x, y)
+    future.add_done_callback(record_completion(index))
+    futures.append(future)
+
+# The worker runs the callbacks of a call before it starts the next one, so
+# those of all the calls above have run once a later call is done.
+invoker.submit("forward", *inputs[0]).result()
+# CHECK: completed in order: True
+print("completed in order:", completed == list(range(len(inputs))))
+
+# A synchronous call runs after the calls submitted before it.
+later_futures = [invoker.submit("forward", x, y) for x, y in inputs]
+invoker.forward(*inputs[0])
+# CHECK: submitted calls done: True
+print("submitted calls done:",
+      all(future.done() for future in later_futures))
+
+# Each future holds the results of its own call.
+# CHECK: results match: True
+print("results match:", all(
+    torch.allclose(tanh, torch.tanh(torch.mm(x, y))) and
+    torch.allclose(add, x + y)
+    for (x, y), (tanh, add) in zip(inputs,
+                                   (future.result() for future in futures))))
@@ -0,0 +1,38 @@
+import concurrent.futures
+
+import torch
+import torch_mlir
+from torch_mlir_e2e_test.linalg_on_tensors_backends.refbackend import \
+    RefBackendLinalgOnTensorsBackend
+
+
+# RUN: %PYTHON %s | FileCheck %s
+
+
+class MatmulTanhModule(torch.nn.Module):
+    def forward(self, x, y):
+        return torch.tanh(torch.mm(x, y)), x + y
+
+
+backend = RefBackendLinalgOnTensorsBackend()
+invoker = backend.load(backend.compile(torch_mlir.compile(
+    MatmulTanhModule(), [torch.ones(16, 16), torch.ones(16, 16)],
+    output_type="linalg-on-tensors")))
+
+
+def call(seed):
+    generator = torch.Generator().manual_seed(seed)
+    x = torch.rand(16, 16, generator=generator)
+    y = torch.rand(16, 16, generator=generator)
+    results = [invoker.forward(x, y) for _ in range(20)]
+    return all(
+        torch.allclose(tanh, torch.tanh(torch.mm(x, y))) and
+        torch.allclose(add, x + y) for tanh, add in results)
+
+
+# Many threads call the same loaded module at once, and each of them gets the
+# results of its own calls.
+with concurrent.futures.ThreadPoolExecutor(max_workers=8) as executor:
+    matches = list(executor.map(call, range(32)))
+# CHECK: concurrent results match: True
+print("concurrent results match:", all(matches))
@@ -0,0 +1,58 @@
+import numpy as np
+import torch
+import torch_mlir
+from torch_mlir_e2e_test.linalg_on_tensors_backends.refbackend import \
+    RefBackendLinalgOnTensorsBackend
+
+
+# RUN: %PYTHON %s | FileCheck %s
+
+
+class LinearModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+        torch.manual_seed(0)
+        self.linear = torch.nn.Linear(4, 3)
+
+    def forward(self, x):
+        return self.linear(x)
+
+
+module = LinearModule()
+compiled_shapes = []
+
+
+def import_linear(placeholders):
+    compiled_shapes.append(tuple(placeholders[0].shape))
+    return torch_mlir.compile(module, placeholders,
+                              output_type="linalg-on-tensors")
+
+
+backend = RefBackendLinalgOnTensorsBackend()
+forward = backend.load_shape_specialized(
+    import_linear, [torch_mlir.TensorPlaceholder([-1, 4], torch.float32)])
+# CHECK: compiled: [(-1, 4)]
+print("compiled:", compiled_shapes)
+
+# The first call with a batch size of 8 runs the dynamic variant, and the
+# second one specializes it.
+x8 = torch.rand(8, 4)
+for _ in range(3):
+    result = forward(x8.numpy())
+# CHECK: compiled: [(-1, 4), (8, 4)]
+print("compiled:", compiled_shapes)
+# CHECK: specialized: [((8, 4),)]
+print("specialized:", forward.specialized_shapes)
+# CHECK: specialized result matches: True
+print("specialized result matches:",
+      torch.allclose(torch.from_numpy(result), module(x8), atol=1e-6))
+
+# A batch size that is only seen once keeps running the dynamic variant, and
+# so does a shape that doesn't match the static sizes of the placeholder.
+x3 = torch.rand(3, 4)
+result = forward(x3.numpy())
+# CHECK: dynamic result matches: True
+print("dynamic result matches:",
+      torch.allclose(torch.from_numpy(result), module(x3), atol=1e-6))
+# CHECK: compiled: [(-1, 4), (8, 4)]
+print("compiled:", compiled_shapes)
@@ -0,0 +1,619 @@
+//===- torch-mlir-bench.cpp - Microbenchmarks of lowered kernels ----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+//
+// Times, with Google Benchmark, the code that the RefBackend produces for
+// small canonical programs in the Torch dialect. Each kernel is lowered to
+// linalg-on-tensors like `torch_mlir.compile` does, then to LLVM with one of
+// the RefBackend pipelines, and called through the ExecutionEngine with the
+// destination-passing calling convention, so that the timings don't include
+// allocating the results.
+//
+// Besides the time per call, each benchmark reports the GFLOP/s and GB/s of
+// its kernel, computed from the nominal number of operations of the kernel
+// and the bytes of its arguments and results.
+//
+// Benchmarks are named `<kernel>/<pipeline>/<shape>`, e.g.
+// `matmul/vectorized/256x256x256`, and can be selected with
+// `--benchmark_filter`.
+//
+// A few passes whose compile time depends on the size of the program are
+// timed too, on generated programs of increasing sizes, as
+// `<pass>/<size>`. For these, Google Benchmark also reports how their time
+// scales with the size.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/ExecutionEngine/ExecutionEngine.h"
+#include "mlir/ExecutionEngine/OptUtils.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/InitAllDialects.h"
+#include "mlir/InitAllPasses.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "mlir/Target/LLVMIR/Dialect/Builtin/BuiltinToLLVMIRTranslation.h"
+#include "mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchTypes.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/InitAll.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/TargetSelect.h"
+
+#include "benchmark/benchmark.h"
+
+#include <cmath>
+#include <random>
+
+using namespace mlir;
+using namespace mlir::torch;
+
+//===----------------------------------------------------------------------===//
+// Pipelines
+//===----------------------------------------------------------------------===//
+
+namespace {
+enum class Pipeline {
+  // Linalg ops are lowered straight to scalar loops.
+  Naive,
+  // Linalg ops are tiled and vectorized.
+  Vectorized,
+};
+} // namespace
+
+static StringRef getPipelineName(Pipeline pipeline) {
+  return pipeline == Pipeline::Naive ? "naive" : "vectorized";
+}
+
+// The ops that `torch_mlir.compile` leaves undecomposed for linalg-on-tensors,
+// see `BACKEND_LEGAL_OPS` in python/torch_mlir/__init__.py, among the ones
+// that the kernels below use.
+static constexpr StringLiteral kBackendLegalOps =
+    "aten.softmax.int,aten.native_layer_norm,"
+    "aten.scaled_dot_product_attention";
+
+// Returns the pipeline lowering a Torch dialect module to LLVM. The RefBackend
+// part mirrors `_get_lowering_passes` in refbackend.py, with destination
+// passing.
+static std::string getLoweringPipeline(Pipeline pipeline,
+                                       StringRef backendLegalOps) {
+  bool optimize = pipeline == Pipeline::Vectorized;
+  std::vector<std::string> passes = {
+      "torch-function-to-torch-backend-pipeline{backend-legal-ops=" +
+          backendLegalOps.str() + "}",
+      "torch-backend-to-linalg-on-tensors-backend-pipeline",
+      "func.func(refback-generalize-tensor-pad)",
+      "func.func(linalg-fuse-elementwise-ops)",
+      "convert-shape-to-std",
+      "func.func(scf-bufferize)",
+      "func.func(tm-tensor-bufferize)",
+      "func.func(empty-tensor-to-alloc-tensor)",
+      "func.func(linalg-bufferize)",
+      "func-bufferize",
+      "arith-bufferize",
+      "refback-mlprogram-bufferize",
+      "func.func(tensor-bufferize)",
+      "func.func(finalizing-bufferize)",
+      "func.func(buffer-deallocation)",
+  };
+  if (optimize)
+    passes.push_back("func.func(refback-plan-static-buffers)");
+  passes.push_back(
+      "refback-munge-calling-conventions{destination-passing=true}");
+  passes.push_back("func.func(tm-tensor-to-loops)");
+  passes.push_back("func.func(refback-munge-memref-copy)");
+  if (optimize) {
+    passes.push_back("func.func(refback-tile-and-vectorize)");
+    passes.push_back("func.func(convert-vector-to-scf)");
+  }
+  for (const char *pass :
+       {"func.func(convert-linalg-to-loops)", "func.func(lower-affine)",
+        "convert-scf-to-cf", "func.func(refback-expand-ops-for-llvm)",
+        "func.func(arith-expand)", "func.func(convert-math-to-llvm)",
+        "convert-math-to-libm", "convert-linalg-to-llvm"})
+    passes.push_back(pass);
+  if (optimize)
+    passes.push_back("convert-vector-to-llvm");
+  for (const char *pass :
+       {"expand-strided-metadata", "finalize-memref-to-llvm", "lower-affine",
+        "func.func(convert-arith-to-llvm)", "convert-func-to-llvm",
+        "convert-cf-to-llvm", "convert-complex-to-llvm",
+        "reconcile-unrealized-casts"})
+    passes.push_back(pass);
+  return "builtin.module(" + llvm::join(passes, ",") + ")";
+}
+
+//===----------------------------------------------------------------------===//
+// Kernels
+//===----------------------------------------------------------------------===//
+
+namespace {
+struct Kernel {
+  std::string name;
+  // The sizes the kernel is instantiated with, e.g. `64x64x64`.
+  std::string shape;
+  // A module with a `forward` function with value semantics and static
+  // shapes, in the Torch dialect.
+  std::string source;
+  // The nominal number of operations of one call to the kernel.
+  double flops;
+  // The bytes of the arguments and results of the kernel.
+  double bytes;
+  // The integer arguments of the kernel are indices, filled with values in
+  // [0, indexBound).
+  int64_t indexBound = 0;
+  std::string backendLegalOps = kBackendLegalOps.str();
+};
+} // namespace
+
+static std::string joinSizes(ArrayRef<int64_t> sizes, StringRef separator) {
+  std::string joined;
+  llvm::raw_string_ostream os(joined);
+  llvm::interleave(sizes, os, separator);
+  return os.str();
+}
+
+static std::string formatShape(ArrayRef<int64_t> sizes) {
+  return joinSizes(sizes, "x");
+}
+
+static std::string vtensor(ArrayRef<int64_t> sizes, StringRef dtype = "f32") {
+  return "!torch.vtensor<[" + joinSizes(sizes, ",") + "]," + dtype.str() + ">";
+}
+
+// Returns a module with a `forward` function, with arguments `%arg<i>` of
+// `argTypes`, results of `resultTypes` and `body`.
+static std::string makeModule(ArrayRef<std::string> argTypes,
+                              StringRef resultTypes, StringRef body) {
+  std::string source;
+  llvm::raw_string_ostream os(source);
+  os << "func.func @forward(";
+  for (size_t i = 0; i < argTypes.size(); i++)
+    os << (i ? ", " : "") << "%arg" << i << ": " << argTypes[i];
+  os << ") -> (" << resultTypes << ") {\n" << body << "}\n";
+  return os.str();
+}
+
+static Kernel matmul(int64_t m, int64_t k, int64_t n) {
+  std::string lhs = vtensor({m, k}), rhs = vtensor({k, n}),
+              result = vtensor({m, n});
+  std::string body = "  %0 = torch.aten.mm %arg0, %arg1 : " + lhs + ", " +
+                     rhs + " -> " + result + "\n  return %0 : " + result +
+                     "\n";
+  return {"matmul", formatShape({m, k, n}),
+          makeModule({lhs, rhs}, result, body), 2.0 * m * k * n,
+          4.0 * (m * k + k * n + m * n)};
+}
+
+// A 3x3 convolution with a padding of 1.
+static Kernel conv2d(int64_t n, int64_t c, int64_t h, int64_t w, int64_t f) {
+  std::string input = vtensor({n, c, h, w}), weight = vtensor({f, c, 3, 3}),
+              result = vtensor({n, f, h, w});
+  std::string body =
+      "  %int0 = torch.constant.int 0\n"
+      "  %int1 = torch.constant.int 1\n"
+      "  %false = torch.constant.bool false\n"
+      "  %none = torch.constant.none\n"
+      "  %ones = torch.prim.ListConstruct %int1, %int1 : "
+      "(!torch.int, !torch.int) -> !torch.list<int>\n"
+      "  %zeros = torch.prim.ListConstruct %int0, %int0 : "
+      "(!torch.int, !torch.int) -> !torch.list<int>\n"
+      "  %0 = torch.aten.convolution %arg0, %arg1, %none, %ones, %ones, "
+      "%ones, %false, %zeros, %int1 : " +
+      input + ", " + weight +
+      ", !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, "
+      "!torch.bool, !torch.list<int>, !torch.int -> " +
+      result + "\n  return %0 : " + result + "\n";
+  return {"conv2d", formatShape({n, c, h, w, f}),
+          makeModule({input, weight}, result, body),
+          2.0 * n * f * h * w * c * 9,
+          4.0 * (n * c * h * w + f * c * 9 + n * f * h * w)};
+}
+
+static Kernel softmax(int64_t b, int64_t n) {
+  std::string type = vtensor({b, n});
+  std::string body = "  %int-1 = torch.constant.int -1\n"
+                     "  %none = torch.constant.none\n"
+                     "  %0 = torch.aten.softmax.int %arg0, %int-1, %none : " +
+                     type + ", !torch.int, !torch.none -> " + type +
+                     "\n  return %0 : " + type + "\n";
+  // A max, a subtraction, an exponential, a sum and a division per element.
+  return {"softmax", formatShape({b, n}), makeModule({type}, type, body),
+          5.0 * b * n, 4.0 * 2 * b * n};
+}
+
+static Kernel layerNorm(int64_t b, int64_t n) {
+  std::string type = vtensor({b, n}), affine = vtensor({n});
+  std::string body =
+      "  %size = torch.constant.int " + std::to_string(n) +
+      "\n"
+      "  %0 = torch.prim.ListConstruct %size : (!torch.int) -> "
+      "!torch.list<int>\n"
+      "  %eps = torch.constant.float 1.000000e-05\n"
+      "  %true = torch.constant.bool true\n"
+      "  %1 = torch.aten.layer_norm %arg0, %0, %arg1, %arg2, %eps, %true : " +
+      type + ", !torch.list<int>, " + affine + ", " + affine +
+      ", !torch.float, !torch.bool -> " + type + "\n  return %1 : " + type +
+      "\n";
+  // Computing the mean and variance, normalizing, scaling and shifting.
+  return {"layer_norm", formatShape({b, n}),
+          makeModule({type, affine, affine}, type, body), 8.0 * b * n,
+          4.0 * (2 * b * n + 2 * n)};
+}
+
+static Kernel embedding(int64_t vocabulary, int64_t dim, int64_t length) {
+  std::string weight = vtensor({vocabulary, dim}),
+              indices = vtensor({length}, "si64"),
+              result = vtensor({length, dim});
+  std::string body = "  %int-1 = torch.constant.int -1\n"
+                     "  %false = torch.constant.bool false\n"
+                     "  %0 = torch.aten.embedding %arg0, %arg1, %int-1, "
+                     "%false, %false : " +
+                     weight + ", " + indices +
+                     ", !torch.int, !torch.bool, !torch.bool -> " + result +
+                     "\n  return %0 : " + result + "\n";
+  // Only the gathered rows of the weight are read.
+  return {"embedding",
+          formatShape({vocabulary, dim, length}),
+          makeModule({weight, indices}, result, body),
+          0,
+          4.0 * 2 * length * dim + 8.0 * length,
+          vocabulary};
+}
+
+// Sums rows of `src` into rows of `self`, along the outermost dim.
+static Kernel scatter(int64_t n, int64_t d, int64_t m) {
+  std::string self = vtensor({n, d}), index = vtensor({m, d}, "si64"),
+              src = vtensor({m, d});
+  std::string body =
+      "  %int0 = torch.constant.int 0\n"
+      "  %str = torch.constant.str \"sum\"\n"
+      "  %true = torch.constant.bool true\n"
+      "  %0 = torch.aten.scatter_reduce.two %arg0, %int0, %arg1, %arg2, "
+      "%str, %true : " +
+      self + ", !torch.int, " + index + ", " + src +
+      ", !torch.str, !torch.bool -> " + self + "\n  return %0 : " + self +
+      "\n";
+  return {"scatter",
+          formatShape({n, d, m}),
+          makeModule({self, index, src}, self, body),
+          1.0 * m * d,
+          4.0 * 2 * n * d + 12.0 * m * d,
+          n};
+}
+
+static Kernel sort(int64_t b, int64_t n) {
+  std::string values = vtensor({b, n}), indices = vtensor({b, n}, "si64");
+  std::string body =
+      "  %int-1 = torch.constant.int -1\n"
+      "  %false = torch.constant.bool false\n"
+      "  %values, %indices = torch.aten.sort %arg0, %int-1, %false : " +
+      values + ", !torch.int, !torch.bool -> " + values + ", " + indices +
+      "\n  return %values, %indices : " + values + ", " + indices + "\n";
+  // The operations are the comparisons of an n log(n) sort of each row.
+  return {"sort", formatShape({b, n}),
+          makeModule({values}, values + ", " + indices, body),
+          b * n * std::log2(static_cast<double>(n)),
+          4.0 * 2 * b * n + 8.0 * b * n};
+}
+
+// With `decompose`, attention is decomposed into two matmuls and a softmax,
+// instead of being lowered to `tm_tensor.attention`.
+static Kernel attention(int64_t b, int64_t s, int64_t d, bool decompose) {
+  std::string type = vtensor({b, s, d});
+  std::string body =
+      "  %none = torch.constant.none\n"
+      "  %float0 = torch.constant.float 0.000000e+00\n"
+      "  %false = torch.constant.bool false\n"
+      "  %0 = torch.aten.scaled_dot_product_attention %arg0, %arg1, %arg2, "
+      "%none, %float0, %false, %none : " +
+      type + ", " + type + ", " + type +
+      ", !torch.none, !torch.float, !torch.bool, !torch.none -> " + type +
+      "\n  return %0 : " + type + "\n";
+  Kernel kernel = {decompose ? "attention_decomposed" : "attention",
+                   formatShape({b, s, d}),
+                   makeModule({type, type, type}, type, body),
+                   4.0 * b * s * s * d, 4.0 * 4 * b * s * d};
+  if (decompose)
+    kernel.backendLegalOps = "aten.softmax.int,aten.native_layer_norm";
+  return kernel;
+}
+
+static std::vector<Kernel> getKernels() {
+  std::vector<Kernel> kernels;
+  for (int64_t size : {64, 256, 512})
+    kernels.push_back(matmul(size, size, size));
+  kernels.push_back(conv2d(1, 16, 32, 32, 32));
+  kernels.push_back(conv2d(8, 32, 32, 32, 64));
+  for (auto [b, n] : {std::pair<int64_t, int64_t>{32, 1024}, {256, 4096}}) {
+    kernels.push_back(softmax(b, n));
+    kernels.push_back(layerNorm(b, n));
+  }
+  kernels.push_back(embedding(1000, 128, 512));
+  kernels.push_back(embedding(32000, 512, 1024));
+  kernels.push_back(scatter(1024, 64, 4096));
+  kernels.push_back(scatter(8192, 128, 32768));
+  kernels.push_back(sort(32, 1024));
+  kernels.push_back(sort(16, 65536));
+  for (bool decompose : {false, true}) {
+    kernels.push_back(attention(8, 128, 64, decompose));
+    kernels.push_back(attention(16, 512, 64, decompose));
+  }
+  return kernels;
+}
+
+//===----------------------------------------------------------------------===//
+// Running kernels
+//===----------------------------------------------------------------------===//
+
+namespace {
+// A buffer passed to a kernel as a ranked memref descriptor, with the layout
+// of `StridedMemRefType` of its rank.
+class Buffer {
+public:
+  Buffer(ArrayRef<int64_t> sizes, int64_t elementBytes) {
+    numElements = 1;
+    for (int64_t size : sizes)
+      numElements *= size;
+    storage.resize(llvm::divideCeil(numElements * elementBytes, 8));
+    auto data = static_cast<int64_t>(
+        reinterpret_cast<intptr_t>(storage.data()));
+    // Allocated and aligned pointers, offset, sizes and strides.
+    descriptor = {data, data, 0};
+    descriptor.append(sizes.begin(), sizes.end());
+    SmallVector<int64_t> strides(sizes.size(), 1);
+    for (int64_t i = static_cast<int64_t>(sizes.size()) - 2; i >= 0; i--)
+      strides[i] = strides[i + 1] * sizes[i + 1];
+    descriptor.append(strides.begin(), strides.end());
+  }
+
+  template <typename T> MutableArrayRef<T> getElements() {
+    return {reinterpret_cast<T *>(storage.data()),
+            static_cast<size_t>(numElements)};
+  }
+  void *getDescriptor() { return descriptor.data(); }
+
+private:
+  int64_t numElements;
+  std::vector<int64_t> storage;
+  SmallVector<int64_t> descriptor;
+};
+
+struct CompiledKernel {
+  std::unique_ptr<ExecutionEngine> engine;
+  // The arguments of the kernel, then its results.
+  std::vector<Buffer> buffers;
+  // The descriptors of `buffers`, and pointers to them, which is how the
+  // packed interface of the kernel takes them.
+  SmallVector<void *> descriptors;
+  SmallVector<void *> packedArgs;
+};
+} // namespace
+
+static MLIRContext &getContext() {
+  static MLIRContext *context = [] {
+    DialectRegistry registry;
+    mlir::registerAllDialects(registry);
+    mlir::torch::registerAllDialects(registry);
+    registerBuiltinDialectTranslation(registry);
+    registerLLVMDialectTranslation(registry);
+    auto *context = new MLIRContext(registry);
+    context->loadAllAvailableDialects();
+    return context;
+  }();
+  return *context;
+}
+
+static llvm::Error makeError(const Twine &message) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(), message);
+}
+
+static llvm::Expected<std::unique_ptr<CompiledKernel>>
+compileKernel(const Kernel &kernel, Pipeline pipeline) {
+  MLIRContext &context = getContext();
+  OwningOpRef<ModuleOp> module =
+      parseSourceString<ModuleOp>(kernel.source, &context);
+  if (!module)
+    return makeError("could not parse the kernel");
+
+  auto compiled = std::make_unique<CompiledKernel>();
+  std::mt19937 generator(0);
+  auto func = module->lookupSymbol<func::FuncOp>("forward");
+  for (Type type : func.getArgumentTypes()) {
+    auto tensorType = type.cast<Torch::ValueTensorType>();
+    Type dtype = tensorType.getDtype();
+    Buffer &buffer = compiled->buffers.emplace_back(
+        tensorType.getSizes(), dtype.getIntOrFloatBitWidth() / 8);
+    if (dtype.isF32()) {
+      std::uniform_real_distribution<float> distribution(-1, 1);
+      for (float &element : buffer.getElements<float>())
+        element = distribution(generator);
+    } else if (dtype.isSignedInteger(64)) {
+      std::uniform_int_distribution<int64_t> distribution(
+          0, kernel.indexBound - 1);
+      for (int64_t &element : buffer.getElements<int64_t>())
+        element = distribution(generator);
+    } else {
+      return makeError("unsupported argument dtype");
+    }
+  }
+
+  PassManager pm(&context);
+  std::string errorMessage;
+  llvm::raw_string_ostream errorStream(errorMessage);
+  if (failed(parsePassPipeline(
+          getLoweringPipeline(pipeline, kernel.backendLegalOps), pm,
+          errorStream)))
+    return makeError("could not parse the pipeline: " + errorStream.str());
+  if (failed(pm.run(*module)))
+    return makeError("lowering the kernel failed");
+
+  // The results are written to buffers allocated here, of the types that
+  // `refback-munge-calling-conventions` records.
+  auto destinationPassingResults = (*module)->getAttrOfType<DictionaryAttr>(
+      "refback.destination_passing_results");
+  auto resultTypes = destinationPassingResults
+                         ? destinationPassingResults.getAs<ArrayAttr>("forward")
+                         : ArrayAttr();
+  if (!resultTypes)
+    return makeError("the kernel doesn't use destination passing");
+  for (Attribute typeAttr : resultTypes) {
+    auto memrefType = typeAttr.cast<TypeAttr>().getValue().cast<MemRefType>();
+    compiled->buffers.emplace_back(
+        memrefType.getShape(),
+        memrefType.getElementType().getIntOrFloatBitWidth() / 8);
+  }
+
+  ExecutionEngineOptions options;
+  options.transformer = makeOptimizingTransformer(
+      /*optLevel=*/3, /*sizeLevel=*/0, /*targetMachine=*/nullptr);
+  auto engine = ExecutionEngine::create(*module, options);
+  if (!engine)
+    return engine.takeError();
+  compiled->engine = std::move(*engine);
+
+  for (Buffer &buffer : compiled->buffers)
+    compiled->descriptors.push_back(buffer.getDescriptor());
+  for (void *&descriptor : compiled->descriptors)
+    compiled->packedArgs.push_back(&descriptor);
+  return compiled;
+}
+
+static void runKernel(benchmark::State &state, const Kernel &kernel,
+                      Pipeline pipeline) {
+  // Google Benchmark runs this repeatedly to choose the number of
+  // iterations, so kernels are only compiled the first time.
+  static llvm::StringMap<std::unique_ptr<CompiledKernel>> compiledKernels;
+  std::string key = kernel.name + "/" + getPipelineName(pipeline).str() +
+                    "/" + kernel.shape;
+  std::unique_ptr<CompiledKernel> &compiled = compiledKernels[key];
+  if (!compiled) {
+    llvm::Expected<std::unique_ptr<CompiledKernel>> result =
+        compileKernel(kernel, pipeline);
+    if (!result) {
+      std::string message = llvm::toString(result.takeError());
+      state.SkipWithError(message.c_str());
+      return;
+    }
+    compiled = std::move(*result);
+  }
+
+  for (auto _ : state) {
+    if (llvm::Error error = compiled->engine->invokePacked(
+            "_mlir_ciface_forward", compiled->packedArgs)) {
+      std::string message = llvm::toString(std::move(error));
+      state.SkipWithError(message.c_str());
+      return;
+    }
+  }
+  if (kernel.flops > 0) {
+    state.counters["GFLOP/s"] = benchmark::Counter(
+        kernel.flops * 1e-9, benchmark::Counter::kIsIterationInvariantRate);
+  }
+  state.counters["GB/s"] = benchmark::Counter(
+      kernel.bytes * 1e-9, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+//===----------------------------------------------------------------------===//
+// Compile time
+//===----------------------------------------------------------------------===//
+
+// Returns a module whose `forward` function updates its argument in place
+// `numUpdates` times, each time through a view, like the IR of a training
+// step after `torch-reduce-op-variants`.
+static std::string inPlaceUpdates(int64_t numUpdates) {
+  std::string body;
+  llvm::raw_string_ostream os(body);
+  std::string flatType = vtensor({64});
+  std::string matrixType = vtensor({8, 8});
+  os << "  %int8 = torch.constant.int 8\n"
+     << "  %int64 = torch.constant.int 64\n"
+     << "  %matrix = torch.prim.ListConstruct %int8, %int8 : "
+        "(!torch.int, !torch.int) -> !torch.list<int>\n"
+     << "  %flat = torch.prim.ListConstruct %int64 : "
+        "(!torch.int) -> !torch.list<int>\n"
+     << "  %t = torch.copy.to_tensor %arg0 : !torch.tensor<[64],f32>\n";
+  for (int64_t i = 0; i < numUpdates; i++) {
+    std::string n = std::to_string(i);
+    os << "  %view" << n << " = torch.aten.view %t, %matrix : "
+       << "!torch.tensor<[64],f32>, !torch.list<int> -> "
+       << "!torch.tensor<[8,8],f32>\n"
+       << "  %value" << n << " = torch.copy.to_vtensor %view" << n << " : "
+       << matrixType << "\n"
+       << "  %tanh" << n << " = torch.aten.tanh %value" << n << " : "
+       << matrixType << " -> " << matrixType << "\n"
+       << "  %update" << n << " = torch.aten.view %tanh" << n << ", %flat : "
+       << matrixType << ", !torch.list<int> -> " << flatType << "\n"
+       << "  torch.overwrite.tensor.contents %update" << n
+       << " overwrites %t : " << flatType << ", !torch.tensor<[64],f32>\n";
+  }
+  os << "  %result = torch.copy.to_vtensor %t : " << flatType << "\n"
+     << "  return %result : " << flatType << "\n";
+  return makeModule({flatType}, flatType, os.str());
+}
+
+static void runMaximizeValueSemantics(benchmark::State &state) {
+  MLIRContext &context = getContext();
+  int64_t numUpdates = state.range(0);
+  OwningOpRef<ModuleOp> module =
+      parseSourceString<ModuleOp>(inPlaceUpdates(numUpdates), &context);
+  if (!module) {
+    state.SkipWithError("could not parse the module");
+    return;
+  }
+
+  // Only running the pass is timed, not copying the module it rewrites, nor
+  // destroying the copy.
+  OwningOpRef<ModuleOp> clone;
+  for (auto _ : state) {
+    state.PauseTiming();
+    clone = module->clone();
+    PassManager pm(&context);
+    pm.addNestedPass<func::FuncOp>(Torch::createMaximizeValueSemanticsPass());
+    state.ResumeTiming();
+    if (failed(pm.run(*clone))) {
+      state.SkipWithError("the pass failed");
+      return;
+    }
+  }
+  state.SetComplexityN(numUpdates);
+}
+
+int main(int argc, char **argv) {
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+  mlir::registerAllPasses();
+  mlir::torch::registerAllPasses();
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  for (const Kernel &kernel : getKernels()) {
+    for (Pipeline pipeline : {Pipeline::Naive, Pipeline::Vectorized}) {
+      std::string name = kernel.name + "/" + getPipelineName(pipeline).str() +
+                         "/" + kernel.shape;
+      benchmark::RegisterBenchmark(name.c_str(),
+                                   [kernel, pipeline](benchmark::State &state) {
+                                     runKernel(state, kernel, pipeline);
+                                   })
+          ->Unit(benchmark::kMicrosecond);
+    }
+  }
+  benchmark::RegisterBenchmark("maximize-value-semantics",
+                               runMaximizeValueSemantics)
+      ->RangeMultiplier(4)
+      ->Range(64, 16384)
+      ->Complexity()
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -9,8 +9,14 @@
 
 #include "mlir/InitAllDialects.h"
 #include "mlir/InitAllPasses.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Support/FileUtilities.h"
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
+#include "torch-mlir/Dialect/Torch/Transforms/MemoryUsageInstrumentation.h"
 #include "torch-mlir/InitAll.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/ToolOutputFile.h"
 
 #ifdef TORCH_MLIR_ENABLE_STABLEHLO
 #include "mhlo/IR/hlo_ops.h"
@@ -20,6 +26,24 @@
 
 using namespace mlir;
 
+static llvm::cl::opt<bool> reportPassMemoryUsage(
+    "torch-report-pass-memory-usage",
+    llvm::cl::desc("Emit a remark with the memory usage of the process, and "
+                   "the attributes added to the IR, after each pass"),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<int64_t> largeAttributeCount(
+    "torch-large-attribute-count",
+    llvm::cl::desc("The number of new attributes from which a pass is "
+                   "reported as creating many attributes"),
+    llvm::cl::init(10000));
+
+static llvm::cl::opt<int64_t> largeAttributeBytes(
+    "torch-large-attribute-bytes",
+    llvm::cl::desc("The bytes of new elements attributes from which a pass "
+                   "is reported as creating many attributes"),
+    llvm::cl::init(64 << 20));
+
 int main(int argc, char **argv) {
   registerAllPasses();
   mlir::torch::registerAllPasses();
@@ -37,6 +61,46 @@ int main(int argc, char **argv) {
   mlir::mhlo::registerHloLegalizeToLinalgPass();
   mlir::mhlo::registerTestUnfuseBatchNormPass();
 #endif
-  return mlir::asMainReturnCode(mlir::MlirOptMain(
-      argc, argv, "MLIR modular optimizer driver\n", registry));
+
+  // This is `MlirOptMain`, with the instrumentation of the pass manager.
+  llvm::InitLLVM y(argc, argv);
+  auto [inputFilename, outputFilename] = registerAndParseCLIOptions(
+      argc, argv, "MLIR modular optimizer driver\n", registry);
+  MlirOptMainConfig config = MlirOptMainConfig::createFromCLI();
+  if (config.shouldShowDialects()) {
+    llvm::outs() << "Available Dialects: ";
+    llvm::interleave(registry.getDialectNames(), llvm::outs(), ",");
+    llvm::outs() << "\n";
+    return EXIT_SUCCESS;
+  }
+  if (reportPassMemoryUsage) {
+    MlirOptMainConfig cliConfig = config;
+    config.setPassPipelineSetupFn([cliConfig](PassManager &pm) {
+      if (failed(cliConfig.setupPassPipeline(pm)))
+        return failure();
+      torch::Torch::MemoryUsageInstrumentationOptions options;
+      options.largeAttributeCount = largeAttributeCount;
+      options.largeAttributeBytes = largeAttributeBytes;
+      torch::Torch::addMemoryUsageInstrumentation(pm, options);
+      return success();
+    });
+  }
+
+  std::string errorMessage;
+  std::unique_ptr<llvm::MemoryBuffer> file =
+      openInputFile(inputFilename, &errorMessage);
+  if (!file) {
+    llvm::errs() << errorMessage << "\n";
+    return EXIT_FAILURE;
+  }
+  std::unique_ptr<llvm::ToolOutputFile> output =
+      openOutputFile(outputFilename, &errorMessage);
+  if (!output) {
+    llvm::errs() << errorMessage << "\n";
+    return EXIT_FAILURE;
+  }
+  if (failed(MlirOptMain(output->os(), std::move(file), registry, config)))
+    return EXIT_FAILURE;
+  output->keep();
+  return EXIT_SUCCESS;
 }